@@ -75,31 +75,56 @@ inline APInt operator-(APInt);
 ///     uses in its IR. This simplifies its use for LLVM.
 ///
 class LLVM_NODISCARD APInt {
-  unsigned BitWidth; ///< The number of bits in this APInt.
-
-  /// This union is used to store the integer value. When the
-  /// integer bit-width <= 64, it uses VAL, otherwise it uses pVal.
-  union {
-    uint64_t VAL;   ///< Used to store the <= 64 bits integer value.
-    uint64_t *pVal; ///< Used to store the >64 bits integer value.
-  };
-
   /// This enum is used to hold the constants we needed for APInt.
   enum {
     /// Bits in a word
     APINT_BITS_PER_WORD =
         static_cast<unsigned int>(sizeof(uint64_t)) * CHAR_BIT,
     /// Byte size of a word
-    APINT_WORD_SIZE = static_cast<unsigned int>(sizeof(uint64_t))
+    APINT_WORD_SIZE = static_cast<unsigned int>(sizeof(uint64_t)),
+    /// Number of words stored inline, without a heap allocation
+    APINT_INLINE_WORDS = 2
+  };
+
+  unsigned BitWidth; ///< The number of bits in this APInt.
+
+  /// This union is used to store the integer value. When the integer
+  /// bit-width <= 64, it uses VAL. Up to 128 bits the words are stored in
+  /// InlineVal (VAL aliases InlineVal[0]), otherwise they are in pVal.
+  union {
+    uint64_t VAL;   ///< Used to store the <= 64 bits integer value.
+    uint64_t *pVal; ///< Used to store the >128 bits integer value.
+    uint64_t InlineVal[APINT_INLINE_WORDS]; ///< Used for <= 128 bits.
   };
 
   friend struct DenseMapAPIntKeyInfo;
 
+  /// Tag for the internal constructor that leaves the value uninitialized.
+  struct UninitializedTag {};
+
   /// \brief Fast internal constructor
   ///
   /// This constructor is used only internally for speed of construction of
-  /// temporaries. It is unsafe for general use so it is not public.
-  APInt(uint64_t *val, unsigned bits) : BitWidth(bits), pVal(val) {}
+  /// temporaries. It allocates storage for \p numBits bits, if needed, but
+  /// does not initialize it.
+  APInt(unsigned numBits, UninitializedTag) : BitWidth(numBits) {
+    if (!isSingleWord())
+      allocateWords(/*Cleared=*/false);
+  }
+
+  /// \brief Determine if the value is stored in the object itself.
+  ///
+  /// \returns true if the number of bits <= 128, false otherwise.
+  bool isInline() const {
+    return BitWidth <= APINT_INLINE_WORDS * APINT_BITS_PER_WORD;
+  }
+
+  /// \brief Get the words of the value, wherever they are stored.
+  uint64_t *getWords() { return isInline() ? InlineVal : pVal; }
+  const uint64_t *getWords() const { return isInline() ? InlineVal : pVal; }
+
+  /// \brief Allocate the storage for getNumWords() words, if it is not inline.
+  void allocateWords(bool Cleared);
 
   /// \brief Determine if this APInt just has one word to store value.
   ///
@@ -151,14 +176,14 @@ class LLVM_NODISCARD APInt {
     if (isSingleWord())
       VAL &= mask;
     else
-      pVal[getNumWords() - 1] &= mask;
+      getWords()[getNumWords() - 1] &= mask;
     return *this;
   }
 
   /// \brief Get the word corresponding to a bit position
   /// \returns the corresponding word for the specified bit position.
   uint64_t getWord(unsigned bitPosition) const {
-    return isSingleWord() ? VAL : pVal[whichWord(bitPosition)];
+    return isSingleWord() ? VAL : getWords()[whichWord(bitPosition)];
   }
 
   /// \brief Convert a char array into an APInt
@@ -288,7 +313,8 @@ public:
   }
 
   /// \brief Move Constructor.
-  APInt(APInt &&that) : BitWidth(that.BitWidth), VAL(that.VAL) {
+  APInt(APInt &&that) : BitWidth(that.BitWidth) {
+    memcpy(InlineVal, that.InlineVal, sizeof(InlineVal));
     that.BitWidth = 0;
   }
 
@@ -306,7 +332,7 @@ public:
   explicit APInt() : BitWidth(1), VAL(0) {}
 
   /// \brief Returns whether this instance allocated memory.
-  bool needsCleanup() const { return !isSingleWord(); }
+  bool needsCleanup() const { return !isInline(); }
 
   /// Used to insert APInt objects, or objects that contain APInt objects, into
   ///  FoldingSets.
@@ -578,7 +604,7 @@ public:
   const uint64_t *getRawData() const {
     if (isSingleWord())
       return &VAL;
-    return &pVal[0];
+    return getWords();
   }
 
   /// @}
@@ -634,7 +660,7 @@ public:
       return !VAL;
 
     for (unsigned i = 0; i != getNumWords(); ++i)
-      if (pVal[i])
+      if (getWords()[i])
         return false;
     return true;
   }
@@ -659,24 +685,20 @@ public:
 
   /// @brief Move assignment operator.
   APInt &operator=(APInt &&that) {
-    if (!isSingleWord()) {
-      // The MSVC STL shipped in 2013 requires that self move assignment be a
-      // no-op.  Otherwise algorithms like stable_sort will produce answers
-      // where half of the output is left in a moved-from state.
-      if (this == &that)
-        return *this;
+    // The MSVC STL shipped in 2013 requires that self move assignment be a
+    // no-op.  Otherwise algorithms like stable_sort will produce answers
+    // where half of the output is left in a moved-from state.
+    if (this == &that)
+      return *this;
+    if (needsCleanup())
       delete[] pVal;
-    }
 
-    // Use memcpy so that type based alias analysis sees both VAL and pVal
-    // as modified.
-    memcpy(&VAL, &that.VAL, sizeof(uint64_t));
+    // Use memcpy so that type based alias analysis sees VAL, pVal and
+    // InlineVal as modified.
+    memcpy(InlineVal, that.InlineVal, sizeof(InlineVal));
 
-    // If 'this == &that', avoid zeroing our own bitwidth by storing to 'that'
-    // first.
-    unsigned ThatBitWidth = that.BitWidth;
+    BitWidth = that.BitWidth;
     that.BitWidth = 0;
-    BitWidth = ThatBitWidth;
 
     return *this;
   }
@@ -716,7 +738,7 @@ public:
       VAL |= RHS;
       clearUnusedBits();
     } else {
-      pVal[0] |= RHS;
+      getWords()[0] |= RHS;
     }
     return *this;
   }
@@ -943,7 +965,7 @@ public:
   bool operator[](unsigned bitPosition) const {
     assert(bitPosition < getBitWidth() && "Bit position out of bounds!");
     return (maskBit(bitPosition) &
-            (isSingleWord() ? VAL : pVal[whichWord(bitPosition)])) !=
+            (isSingleWord() ? VAL : getWords()[whichWord(bitPosition)])) !=
            0;
   }
 
@@ -1206,7 +1228,7 @@ public:
     else {
       // Set all the bits in all the words.
       for (unsigned i = 0; i < getNumWords(); ++i)
-        pVal[i] = UINT64_MAX;
+        getWords()[i] = UINT64_MAX;
     }
     // Clear the unused ones
     clearUnusedBits();
@@ -1222,7 +1244,7 @@ public:
     if (isSingleWord())
       VAL = 0;
     else
-      memset(pVal, 0, getNumWords() * APINT_WORD_SIZE);
+      memset(getWords(), 0, getNumWords() * APINT_WORD_SIZE);
   }
 
   /// \brief Set a given bit to 0.
@@ -1236,7 +1258,7 @@ public:
       VAL ^= UINT64_MAX;
     else {
       for (unsigned i = 0; i < getNumWords(); ++i)
-        pVal[i] ^= UINT64_MAX;
+        getWords()[i] ^= UINT64_MAX;
     }
     clearUnusedBits();
   }
@@ -1310,7 +1332,7 @@ public:
     if (isSingleWord())
       return VAL;
     assert(getActiveBits() <= 64 && "Too many bits for uint64_t");
-    return pVal[0];
+    return getWords()[0];
   }
 
   /// \brief Get sign extended value
@@ -1323,7 +1345,7 @@ public:
       return int64_t(VAL << (APINT_BITS_PER_WORD - BitWidth)) >>
              (APINT_BITS_PER_WORD - BitWidth);
     assert(getMinSignedBits() <= 64 && "Too many bits for int64_t");
-    return int64_t(pVal[0]);
+    return int64_t(getWords()[0]);
   }
 
   /// \brief Get bits required for string value.
@@ -1455,7 +1477,7 @@ public:
       uint64_t I;
       double D;
     } T;
-    T.I = (isSingleWord() ? VAL : pVal[0]);
+    T.I = (isSingleWord() ? VAL : getWords()[0]);
     return T.D;
   }
 
@@ -1469,7 +1491,7 @@ public:
       unsigned I;
       float F;
     } T;
-    T.I = unsigned((isSingleWord() ? VAL : pVal[0]));
+    T.I = unsigned((isSingleWord() ? VAL : getWords()[0]));
     return T.F;
   }
 
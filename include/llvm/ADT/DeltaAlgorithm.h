@@ -45,6 +45,9 @@ private:
   /// since we always reduce following a success.
   std::set<changeset_ty> FailedTestsCache;
 
+  /// The maximum number of tests Search runs at the same time.
+  unsigned TestConcurrency = 1;
+
   /// GetTestResult - Get the test result for the \p Changes from the
   /// cache, executing the test if necessary.
   ///
@@ -52,6 +55,11 @@ private:
   /// \return - The test result.
   bool GetTestResult(const changeset_ty &Changes);
 
+  /// GetTestResults - Get the test results for each of \p Candidates, running
+  /// up to TestConcurrency of the uncached tests at a time.
+  void GetTestResults(const changesetlist_ty &Candidates,
+                      std::vector<bool> &Results);
+
   /// Split - Partition a set of changes \p S into one or two subsets.
   void Split(const changeset_ty &S, changesetlist_ty &Res);
 
@@ -69,6 +77,11 @@ private:
   bool Search(const changeset_ty &Changes, const changesetlist_ty &Sets,
               changeset_ty &Res);
 
+  /// SearchConcurrently - Search, testing batches of candidate subsets at
+  /// the same time. Picks the same subset as the sequential search does.
+  bool SearchConcurrently(const changeset_ty &Changes,
+                          const changesetlist_ty &Sets, changeset_ty &Res);
+
 protected:
   /// UpdatedSearchState - Callback used when the search state changes.
   virtual void UpdatedSearchState(const changeset_ty &Changes,
@@ -77,6 +90,16 @@ protected:
   /// ExecuteOneTest - Execute a single test predicate on the change set \p S.
   virtual bool ExecuteOneTest(const changeset_ty &S) = 0;
 
+  /// setTestConcurrency - Allow up to \p N tests to run at the same time,
+  /// which pays off when each test runs an external program. The search
+  /// then tries several candidate subsets at once, speculatively, but still
+  /// reduces to the same result as with a single test at a time.
+  ///
+  /// Only use this if ExecuteOneTest may be called from several threads at
+  /// once. UpdatedSearchState is still only called from the thread calling
+  /// Run.
+  void setTestConcurrency(unsigned N) { TestConcurrency = N ? N : 1; }
+
   DeltaAlgorithm& operator=(const DeltaAlgorithm&) = default;
 
 public:
@@ -0,0 +1,476 @@
+//===- llvm/ADT/FlatDenseMap.h - Group-probed hash table --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the FlatDenseMap class, an open-addressing hash table that
+// keeps one control byte per slot in a separate array.  A lookup compares a
+// 7-bit fragment of the hash against a whole group of control bytes at once
+// and only touches the key/value slots whose fragment matches.
+//
+// FlatDenseMap uses the same DenseMapInfo traits as DenseMap, but only needs
+// getHashValue and isEqual: keys equal to the empty and tombstone keys may be
+// stored.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATDENSEMAP_H
+#define LLVM_ADT_FLATDENSEMAP_H
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// A group of control bytes probed together.  Full slots hold a 7-bit
+/// fragment of their key's hash; empty and deleted slots have the sign bit set.
+struct FlatDenseMapGroup {
+  enum : unsigned { Width = 16 };
+  enum : int8_t { Empty = -128, Deleted = -2 };
+
+  /// Return a bitmask of the bytes in the group starting at \p Ctrl that are
+  /// equal to \p Byte.
+  static uint32_t match(const int8_t *Ctrl, int8_t Byte) {
+#if defined(__SSE2__)
+    __m128i G = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ctrl));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(G, _mm_set1_epi8(Byte)));
+#else
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Ctrl[I] == Byte) << I;
+    return Mask;
+#endif
+  }
+
+  static uint32_t matchEmpty(const int8_t *Ctrl) { return match(Ctrl, Empty); }
+
+  static uint32_t matchEmptyOrDeleted(const int8_t *Ctrl) {
+#if defined(__SSE2__)
+    return _mm_movemask_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ctrl)));
+#else
+    uint32_t Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= uint32_t(Ctrl[I] < 0) << I;
+    return Mask;
+#endif
+  }
+};
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class FlatDenseMapIterator;
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class FlatDenseMap {
+  typedef detail::FlatDenseMapGroup Group;
+
+public:
+  typedef unsigned size_type;
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef std::pair<KeyT, ValueT> value_type;
+
+  typedef FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, false> iterator;
+  typedef FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, true> const_iterator;
+
+private:
+  int8_t *Ctrl = nullptr;
+  value_type *Slots = nullptr;
+  unsigned NumSlots = 0;
+  unsigned NumEntries = 0;
+  unsigned NumTombstones = 0;
+
+public:
+  /// Create a map that can hold \p InitialReserve entries without growing.
+  explicit FlatDenseMap(unsigned InitialReserve = 0) {
+    if (InitialReserve)
+      rehash(getMinSlotsForEntries(InitialReserve));
+  }
+
+  FlatDenseMap(const FlatDenseMap &Other) { copyFrom(Other); }
+
+  FlatDenseMap(FlatDenseMap &&Other) { swap(Other); }
+
+  ~FlatDenseMap() { destroyAll(); }
+
+  FlatDenseMap &operator=(const FlatDenseMap &Other) {
+    if (&Other != this) {
+      destroyAll();
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  FlatDenseMap &operator=(FlatDenseMap &&Other) {
+    if (&Other == this)
+      return *this;
+    destroyAll();
+    Ctrl = nullptr;
+    Slots = nullptr;
+    NumSlots = NumEntries = NumTombstones = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(FlatDenseMap &Other) {
+    std::swap(Ctrl, Other.Ctrl);
+    std::swap(Slots, Other.Slots);
+    std::swap(NumSlots, Other.NumSlots);
+    std::swap(NumEntries, Other.NumEntries);
+    std::swap(NumTombstones, Other.NumTombstones);
+  }
+
+  iterator begin() { return iterator(Ctrl, Ctrl + NumSlots, Slots); }
+  iterator end() {
+    return iterator(Ctrl + NumSlots, Ctrl + NumSlots, Slots + NumSlots);
+  }
+  const_iterator begin() const {
+    return const_iterator(Ctrl, Ctrl + NumSlots, Slots);
+  }
+  const_iterator end() const {
+    return const_iterator(Ctrl + NumSlots, Ctrl + NumSlots, Slots + NumSlots);
+  }
+
+  bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can hold \p Size entries without growing again.
+  void reserve(size_type Size) {
+    unsigned MinSlots = getMinSlotsForEntries(Size);
+    if (MinSlots > NumSlots)
+      rehash(MinSlots);
+  }
+
+  void clear() {
+    if (NumEntries == 0 && NumTombstones == 0)
+      return;
+    destroyEntries();
+    std::memset(Ctrl, Group::Empty, NumSlots);
+    NumEntries = NumTombstones = 0;
+  }
+
+  size_type count(const KeyT &Key) const { return findSlot(Key) != -1; }
+
+  iterator find(const KeyT &Key) {
+    int Slot = findSlot(Key);
+    return Slot == -1 ? end() : makeIterator(Slot);
+  }
+  const_iterator find(const KeyT &Key) const {
+    int Slot = findSlot(Key);
+    return Slot == -1 ? end()
+                      : const_iterator(Ctrl + Slot, Ctrl + NumSlots,
+                                       Slots + Slot);
+  }
+
+  /// Return the value for \p Key, or a default-constructed value if the key
+  /// is not in the map.
+  ValueT lookup(const KeyT &Key) const {
+    int Slot = findSlot(Key);
+    return Slot == -1 ? ValueT() : Slots[Slot].second;
+  }
+
+  /// Insert the key/value pair if the key is not already in the map.  Return
+  /// an iterator to the entry for the key and whether it was inserted.
+  std::pair<iterator, bool> insert(const value_type &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+  std::pair<iterator, bool> insert(value_type &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    return emplaceImpl(Key, std::forward<Ts>(Args)...);
+  }
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    return emplaceImpl(std::move(Key), std::forward<Ts>(Args)...);
+  }
+
+  ValueT &operator[](const KeyT &Key) { return try_emplace(Key).first->second; }
+  ValueT &operator[](KeyT &&Key) {
+    return try_emplace(std::move(Key)).first->second;
+  }
+
+  bool erase(const KeyT &Key) {
+    int Slot = findSlot(Key);
+    if (Slot == -1)
+      return false;
+    eraseSlot(Slot);
+    return true;
+  }
+
+  /// Erase the entry at \p I.  Other iterators, including ones that follow
+  /// \p I, stay valid.
+  void erase(iterator I) { eraseSlot(I.Slot - Slots); }
+
+  /// Return the number of bytes of heap memory used by the map.
+  size_t getMemorySize() const {
+    return size_t(NumSlots) * (sizeof(int8_t) + sizeof(value_type));
+  }
+
+private:
+  iterator makeIterator(unsigned Slot) {
+    return iterator(Ctrl + Slot, Ctrl + NumSlots, Slots + Slot);
+  }
+
+  /// Mix the DenseMapInfo hash, whose low bits can be weak, into 64 bits.
+  /// The top 7 bits are stored in the control byte and the bits below them
+  /// select the first group to probe.
+  static uint64_t getHash(const KeyT &Key) {
+    return uint64_t(KeyInfoT::getHashValue(Key)) * 0x9E3779B97F4A7C15ULL;
+  }
+  static int8_t getControlByte(uint64_t Hash) { return int8_t(Hash >> 57); }
+
+  static unsigned getMinSlotsForEntries(unsigned Entries) {
+    // Keep the load factor, including tombstones, at or below 7/8 so that
+    // every probe sequence reaches an empty slot.
+    unsigned Slots = uint64_t(Entries) * 8 / 7 + 1;
+    return std::max<unsigned>(Group::Width, NextPowerOf2(Slots - 1));
+  }
+
+  /// Call \p Fn with each group index in the probe sequence for \p Hash until
+  /// it returns true.  Quadratic probing over a power-of-two number of groups
+  /// visits every group.
+  template <typename FnT> void probe(uint64_t Hash, FnT Fn) const {
+    unsigned GroupMask = NumSlots / Group::Width - 1;
+    unsigned G = unsigned(Hash >> 25) & GroupMask;
+    for (unsigned Step = 1; !Fn(G * Group::Width); ++Step)
+      G = (G + Step) & GroupMask;
+  }
+
+  int findSlot(const KeyT &Key) const {
+    if (NumSlots == 0)
+      return -1;
+    uint64_t Hash = getHash(Key);
+    int8_t CtrlByte = getControlByte(Hash);
+    int Result = -1;
+    probe(Hash, [&](unsigned Base) {
+      const int8_t *GroupCtrl = Ctrl + Base;
+      for (uint32_t M = Group::match(GroupCtrl, CtrlByte); M; M &= M - 1) {
+        unsigned Slot = Base + countTrailingZeros(M);
+        if (KeyInfoT::isEqual(Slots[Slot].first, Key)) {
+          Result = Slot;
+          return true;
+        }
+      }
+      return Group::matchEmpty(GroupCtrl) != 0;
+    });
+    return Result;
+  }
+
+  /// Return the first empty or deleted slot in the probe sequence for \p Hash.
+  unsigned findInsertSlot(uint64_t Hash) const {
+    unsigned Result = 0;
+    probe(Hash, [&](unsigned Base) {
+      if (uint32_t M = Group::matchEmptyOrDeleted(Ctrl + Base)) {
+        Result = Base + countTrailingZeros(M);
+        return true;
+      }
+      return false;
+    });
+    return Result;
+  }
+
+  template <typename KeyArgT, typename... Ts>
+  std::pair<iterator, bool> emplaceImpl(KeyArgT &&Key, Ts &&... Args) {
+    int Existing = findSlot(Key);
+    if (Existing != -1)
+      return std::make_pair(makeIterator(Existing), false);
+
+    if (uint64_t(NumEntries + NumTombstones + 1) * 8 > uint64_t(NumSlots) * 7) {
+      // Double the table if live entries account for most of the load,
+      // otherwise just reclaim the tombstones.
+      unsigned NewNumSlots = NumSlots;
+      if (NumSlots == 0)
+        NewNumSlots = Group::Width;
+      else if (uint64_t(NumEntries + 1) * 16 > uint64_t(NumSlots) * 7)
+        NewNumSlots = NumSlots * 2;
+      rehash(NewNumSlots);
+    }
+
+    uint64_t Hash = getHash(Key);
+    unsigned Slot = findInsertSlot(Hash);
+    if (Ctrl[Slot] == Group::Deleted)
+      --NumTombstones;
+    Ctrl[Slot] = getControlByte(Hash);
+    ::new (&Slots[Slot])
+        value_type(std::piecewise_construct,
+                   std::forward_as_tuple(std::forward<KeyArgT>(Key)),
+                   std::forward_as_tuple(std::forward<Ts>(Args)...));
+    ++NumEntries;
+    return std::make_pair(makeIterator(Slot), true);
+  }
+
+  void eraseSlot(unsigned Slot) {
+    assert(Ctrl[Slot] >= 0 && "Erasing a slot that is not full!");
+    Slots[Slot].~value_type();
+    --NumEntries;
+    // Empty bytes are only created by rehashing, so a group that still has
+    // one has never been full and no probe sequence has gone past it.  The
+    // slot can then become empty again instead of a tombstone.
+    unsigned Base = Slot & ~(Group::Width - 1);
+    if (Group::matchEmpty(Ctrl + Base)) {
+      Ctrl[Slot] = Group::Empty;
+    } else {
+      Ctrl[Slot] = Group::Deleted;
+      ++NumTombstones;
+    }
+  }
+
+  void rehash(unsigned NewNumSlots) {
+    assert(isPowerOf2_32(NewNumSlots) && NewNumSlots >= Group::Width &&
+           "Slot count must be a power of two of at least one group!");
+    int8_t *OldCtrl = Ctrl;
+    value_type *OldSlots = Slots;
+    unsigned OldNumSlots = NumSlots;
+
+    Ctrl = new int8_t[NewNumSlots];
+    std::memset(Ctrl, Group::Empty, NewNumSlots);
+    Slots = static_cast<value_type *>(
+        operator new(sizeof(value_type) * NewNumSlots));
+    NumSlots = NewNumSlots;
+    NumTombstones = 0;
+
+    for (unsigned I = 0; I != OldNumSlots; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      uint64_t Hash = getHash(OldSlots[I].first);
+      unsigned Slot = findInsertSlot(Hash);
+      Ctrl[Slot] = getControlByte(Hash);
+      ::new (&Slots[Slot]) value_type(std::move(OldSlots[I]));
+      OldSlots[I].~value_type();
+    }
+
+    delete[] OldCtrl;
+    operator delete(OldSlots);
+  }
+
+  void destroyEntries() {
+    if (std::is_trivially_destructible<value_type>::value)
+      return;
+    for (unsigned I = 0; I != NumSlots; ++I)
+      if (Ctrl[I] >= 0)
+        Slots[I].~value_type();
+  }
+
+  void destroyAll() {
+    if (!Ctrl)
+      return;
+    destroyEntries();
+    delete[] Ctrl;
+    operator delete(Slots);
+  }
+
+  void copyFrom(const FlatDenseMap &Other) {
+    NumSlots = Other.NumSlots;
+    NumEntries = Other.NumEntries;
+    NumTombstones = Other.NumTombstones;
+    if (NumSlots == 0) {
+      Ctrl = nullptr;
+      Slots = nullptr;
+      return;
+    }
+    Ctrl = new int8_t[NumSlots];
+    std::memcpy(Ctrl, Other.Ctrl, NumSlots);
+    Slots = static_cast<value_type *>(
+        operator new(sizeof(value_type) * NumSlots));
+    for (unsigned I = 0; I != NumSlots; ++I)
+      if (Ctrl[I] >= 0)
+        ::new (&Slots[I]) value_type(Other.Slots[I]);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class FlatDenseMapIterator {
+  friend class FlatDenseMap<KeyT, ValueT, KeyInfoT>;
+  friend class FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, true>;
+  friend class FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, false>;
+
+  typedef std::pair<KeyT, ValueT> Bucket;
+
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<IsConst, const Bucket, Bucket>::type
+      value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+
+private:
+  const int8_t *Ctrl = nullptr;
+  const int8_t *End = nullptr;
+  pointer Slot = nullptr;
+
+  FlatDenseMapIterator(const int8_t *Ctrl, const int8_t *End, pointer Slot)
+      : Ctrl(Ctrl), End(End), Slot(Slot) {
+    skipEmptySlots();
+  }
+
+  void skipEmptySlots() {
+    while (Ctrl != End && *Ctrl < 0) {
+      ++Ctrl;
+      ++Slot;
+    }
+  }
+
+public:
+  FlatDenseMapIterator() = default;
+
+  // Allow conversion from iterator to const_iterator.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  FlatDenseMapIterator(
+      const FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, IsConstSrc> &I)
+      : Ctrl(I.Ctrl), End(I.End), Slot(I.Slot) {}
+
+  reference operator*() const { return *Slot; }
+  pointer operator->() const { return Slot; }
+
+  bool operator==(const FlatDenseMapIterator &RHS) const {
+    return Slot == RHS.Slot;
+  }
+  bool operator!=(const FlatDenseMapIterator &RHS) const {
+    return Slot != RHS.Slot;
+  }
+
+  FlatDenseMapIterator &operator++() {
+    assert(Ctrl != End && "Incrementing the end iterator!");
+    ++Ctrl;
+    ++Slot;
+    skipEmptySlots();
+    return *this;
+  }
+  FlatDenseMapIterator operator++(int) {
+    FlatDenseMapIterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_FLATDENSEMAP_H
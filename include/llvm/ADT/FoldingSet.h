@@ -19,6 +19,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/Support/Allocator.h"
+#include <type_traits>
 
 namespace llvm {
 /// This folding set used for two purposes:
@@ -32,10 +33,11 @@ namespace llvm {
 /// node).  The last node points back to the bucket to simplify node removal.
 ///
 /// Any node that is to be included in the folding set must be a subclass of
-/// FoldingSetNode.  The node class must also define a Profile method used to
-/// establish the unique bits of data for the node.  The Profile method is
-/// passed a FoldingSetNodeID object which is used to gather the bits.  Just
-/// call one of the Add* functions defined in the FoldingSetImpl::NodeID class.
+/// FoldingSetNode (or CachedHashFoldingSetNode).  The node class must also
+/// define a Profile method used to establish the unique bits of data for the
+/// node.  The Profile method is passed a FoldingSetNodeID object which is used
+/// to gather the bits.  Just call one of the Add* functions defined in the
+/// FoldingSetImpl::NodeID class.
 /// NOTE: That the folding set does not own the nodes and it is the
 /// responsibility of the user to dispose of the nodes.
 ///
@@ -121,7 +123,11 @@ protected:
   /// is greater than twice the number of buckets.
   unsigned NumNodes;
 
-  explicit FoldingSetImpl(unsigned Log2InitSize = 6);
+  /// CachesNodeHashes - True if the nodes are CachedHashFoldingSetNodes.
+  bool CachesNodeHashes;
+
+  explicit FoldingSetImpl(unsigned Log2InitSize = 6,
+                          bool CachesNodeHashes = false);
   FoldingSetImpl(FoldingSetImpl &&Arg);
   FoldingSetImpl &operator=(FoldingSetImpl &&RHS);
   ~FoldingSetImpl();
@@ -211,6 +217,12 @@ protected:
   /// ComputeNodeHash - Instantiations of the FoldingSet template implement
   /// this function to compute a hash value for the given node.
   virtual unsigned ComputeNodeHash(Node *N, FoldingSetNodeID &TempID) const = 0;
+
+  /// GetNodeHash - Return the hash of a node already in the folding set.
+  unsigned GetNodeHash(Node *N, FoldingSetNodeID &TempID) const;
+
+  /// InsertIntoBucket - Link a node into a bucket of the folding set.
+  static void InsertIntoBucket(Node *N, void **Bucket);
 };
 
 //===----------------------------------------------------------------------===//
@@ -363,6 +375,22 @@ public:
 
 // Convenience type to hide the implementation of the folding set.
 typedef FoldingSetImpl::Node FoldingSetNode;
+
+//===----------------------------------------------------------------------===//
+/// CachedHashFoldingSetNode - This is a subclass of FoldingSetNode which
+/// remembers its hash value while it is in a folding set.  Looking up an ID
+/// then only profiles the nodes of a bucket whose hash matches the ID's, and
+/// neither inserting nodes nor growing the folding set profiles them.  This
+/// trades an unsigned per node (eight bytes for SDNode on 64-bit hosts, once
+/// aligned) for speed when profiles are expensive to compute or buckets are
+/// long.
+class CachedHashFoldingSetNode : public FoldingSetNode {
+  friend class FoldingSetImpl;
+
+  /// Hash - The hash value of the node, set when it is inserted.
+  unsigned Hash = 0;
+};
+
 template<class T> class FoldingSetIterator;
 template<class T> class FoldingSetBucketIterator;
 
@@ -434,7 +462,8 @@ private:
 
 public:
   explicit FoldingSet(unsigned Log2InitSize = 6)
-      : FoldingSetImpl(Log2InitSize) {}
+      : FoldingSetImpl(Log2InitSize,
+                       std::is_base_of<CachedHashFoldingSetNode, T>::value) {}
 
   FoldingSet(FoldingSet &&Arg) : FoldingSetImpl(std::move(Arg)) {}
   FoldingSet &operator=(FoldingSet &&RHS) {
@@ -515,7 +544,9 @@ private:
 
 public:
   explicit ContextualFoldingSet(Ctx Context, unsigned Log2InitSize = 6)
-  : FoldingSetImpl(Log2InitSize), Context(Context)
+  : FoldingSetImpl(Log2InitSize,
+                   std::is_base_of<CachedHashFoldingSetNode, T>::value),
+    Context(Context)
   {}
 
   Ctx getContext() const { return Context; }
@@ -437,17 +437,6 @@ protected:
     return (hl > hr ? hl : hr) + 1;
   }
 
-  static bool compareTreeWithSection(TreeTy* T,
-                                     typename TreeTy::iterator& TI,
-                                     typename TreeTy::iterator& TE) {
-    typename TreeTy::iterator I = T->begin(), E = T->end();
-    for ( ; I!=E ; ++I, ++TI) {
-      if (TI == TE || !I->isElementEqual(&*TI))
-        return false;
-    }
-    return true;
-  }
-
   //===--------------------------------------------------===//
   // "createNode" is used to generate new tree roots that link
   // to other trees.  The functon may also simply move links
@@ -618,12 +607,12 @@ public:
       if (!entry)
         break;
       for (TreeTy *T = entry ; T != nullptr; T = T->next) {
-        // Compare the Contents('T') with Contents('TNew')
-        typename TreeTy::iterator TI = T->begin(), TE = T->end();
-        if (!compareTreeWithSection(TNew, TI, TE))
+        // The bucket is keyed on the masked digest, so first reject trees
+        // whose full (cached) digest differs.  isEqual skips the subtrees
+        // that the two trees share, which is the common case for a tree
+        // derived from a canonical one.
+        if (T->computeDigest() != digest || !TNew->isEqual(*T))
           continue;
-        if (TI != TE)
-          continue; // T has more contents than TNew.
         // Trees did match!  Return 'T'.
         if (TNew->refCount == 0)
           TNew->destroy();
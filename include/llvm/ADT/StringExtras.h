@@ -127,8 +127,15 @@ void SplitString(StringRef Source,
 // better: http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx
 //   X*33+c -> X*33^c
 static inline unsigned HashString(StringRef Str, unsigned Result = 0) {
-  for (StringRef::size_type i = 0, e = Str.size(); i != e; ++i)
-    Result = Result * 33 + (unsigned char)Str[i];
+  const unsigned char *P = Str.bytes_begin(), *E = Str.bytes_end();
+  // Hash four characters per step.  Expanding X*33+c four times yields the
+  // same value, but the per-character products no longer form one long
+  // dependency chain.
+  for (; E - P >= 4; P += 4)
+    Result = Result * (33u * 33 * 33 * 33) + P[0] * (33u * 33 * 33) +
+             P[1] * (33u * 33) + P[2] * 33u + P[3];
+  for (; P != E; ++P)
+    Result = Result * 33 + *P;
   return Result;
 }
 
@@ -189,6 +189,18 @@ public:
   /// alias analysis implementations.
   AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB);
 
+  /// Enable or disable batch mode. While batch mode is enabled, the results
+  /// of alias queries are memoized until it is disabled again. The client
+  /// must not modify the IR in a way that could change the answer to a query
+  /// in the meantime; this includes deleting values, whose addresses may be
+  /// reused. See \c AABatchModeScope.
+  void setBatchMode(bool Enable) {
+    BatchMode = Enable;
+    if (!Enable)
+      BatchCache.clear();
+  }
+  bool isBatchMode() const { return BatchMode; }
+
   /// A convenience wrapper around the primary \c alias interface.
   AliasResult alias(const Value *V1, uint64_t V1Size, const Value *V2,
                     uint64_t V2Size) {
@@ -568,9 +580,32 @@ private:
 
   template <typename T> friend class AAResultBase;
 
+  AliasResult aliasImpl(const MemoryLocation &LocA, const MemoryLocation &LocB);
+
   const TargetLibraryInfo &TLI;
 
   std::vector<std::unique_ptr<Concept>> AAs;
+
+  /// Memoized top-level query results while in batch mode. Queries issued by
+  /// the individual analyses while a query is in flight may depend on that
+  /// query's own assumptions, so only results at depth zero are stored.
+  bool BatchMode = false;
+  unsigned QueryDepth = 0;
+  DenseMap<std::pair<MemoryLocation, MemoryLocation>, AliasResult> BatchCache;
+};
+
+/// Keeps \p AA in batch mode for the lifetime of this object, restoring the
+/// previous mode afterwards.
+class AABatchModeScope {
+  AAResults &AA;
+  bool WasEnabled;
+
+public:
+  explicit AABatchModeScope(AAResults &AA)
+      : AA(AA), WasEnabled(AA.isBatchMode()) {
+    AA.setBatchMode(true);
+  }
+  ~AABatchModeScope() { AA.setBatchMode(WasEnabled); }
 };
 
 /// Temporary typedef for legacy code that uses a generic \c AliasAnalysis
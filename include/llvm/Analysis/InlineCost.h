@@ -16,8 +16,11 @@
 
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include <cassert>
 #include <climits>
+#include <memory>
 
 namespace llvm {
 class AssumptionCacheTracker;
@@ -156,6 +159,28 @@ InlineParams getInlineParams(int Threshold);
 /// the -Oz flag.
 InlineParams getInlineParams(unsigned OptLevel, unsigned SizeOptLevel);
 
+/// \brief Facts about a callee which do not depend on the call site being
+/// analyzed, shared between \c getInlineCost queries so that a callee with
+/// many callers is only summarized once.
+///
+/// The cache does not observe the IR. Its owner must \c invalidate a function
+/// whenever its body changes, and \c clear it before the functions it has
+/// seen can be modified by anything else.
+class InlineCostCache {
+public:
+  /// Get the values in \p F which are only used by @llvm.assume calls and so
+  /// would disappear when compiling the inlined body.
+  const SmallPtrSetImpl<const Value *> &getEphemeralValues(const Function &F,
+                                                           AssumptionCache &AC);
+
+  void invalidate(const Function *F) { EphValues.erase(F); }
+  void clear() { EphValues.clear(); }
+
+private:
+  DenseMap<const Function *, std::unique_ptr<SmallPtrSet<const Value *, 32>>>
+      EphValues;
+};
+
 /// \brief Get an InlineCost object representing the cost of inlining this
 /// callsite.
 ///
@@ -166,12 +191,13 @@ InlineParams getInlineParams(unsigned OptLevel, unsigned SizeOptLevel);
 /// sufficiently low to warrant inlining.
 ///
 /// Also note that calling this function *dynamically* computes the cost of
-/// inlining the callsite. It is an expensive, heavyweight call.
+/// inlining the callsite. It is an expensive, heavyweight call. Passing a
+/// \p Cache lets the call-site independent part of the work be reused.
 InlineCost
 getInlineCost(CallSite CS, const InlineParams &Params,
               TargetTransformInfo &CalleeTTI,
               std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
-              ProfileSummaryInfo *PSI);
+              ProfileSummaryInfo *PSI, InlineCostCache *Cache = nullptr);
 
 /// \brief Get an InlineCost with the callee explicitly specified.
 /// This allows you to calculate the cost of inlining a function via a
@@ -182,7 +208,7 @@ InlineCost
 getInlineCost(CallSite CS, Function *Callee, const InlineParams &Params,
               TargetTransformInfo &CalleeTTI,
               std::function<AssumptionCache &(Function &)> &GetAssumptionCache,
-              ProfileSummaryInfo *PSI);
+              ProfileSummaryInfo *PSI, InlineCostCache *Cache = nullptr);
 
 /// \brief Minimal filter to detect invalid constructs for inlining.
 bool isInlineViable(Function &Callee);
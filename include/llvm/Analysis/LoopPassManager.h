@@ -16,7 +16,13 @@
 #define LLVM_ANALYSIS_LOOPPASSMANAGER_H
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/PassManager.h"
 
 namespace llvm {
@@ -51,6 +57,26 @@ typedef OuterAnalysisManagerProxy<FunctionAnalysisManager, Loop>
 /// Returns the minimum set of Analyses that all loop passes must preserve.
 PreservedAnalyses getLoopPassPreservedAnalyses();
 
+/// The function analyses that most loop passes need.
+///
+/// The loop pass adaptor computes all of them before it runs any loop pass,
+/// and loop passes must keep them valid, so a loop pass can always rely on
+/// them instead of querying the function analysis manager for each one.
+struct LoopStandardAnalysisResults {
+  AAResults &AA;
+  AssumptionCache &AC;
+  DominatorTree &DT;
+  LoopInfo &LI;
+  ScalarEvolution &SE;
+  TargetLibraryInfo &TLI;
+  TargetTransformInfo &TTI;
+};
+
+/// Returns the standard analyses for the function containing \p L. Only
+/// valid while a loop pass is run by a \c FunctionToLoopPassAdaptor.
+LoopStandardAnalysisResults
+getLoopStandardAnalysisResults(Loop &L, LoopAnalysisManager &AM);
+
 /// \brief Adaptor that maps from a function to its loops.
 ///
 /// Designed to allow composition of a LoopPass(Manager) and a
@@ -73,6 +99,19 @@ public:
     // Get the loop structure for this function
     LoopInfo &LI = AM.getResult<LoopAnalysis>(F);
 
+    // Nothing to do for a function without loops.
+    if (LI.empty())
+      return PreservedAnalyses::all();
+
+    // Compute the standard analyses up front, so that every loop pass finds
+    // them in the cache. Loop passes preserve them.
+    AM.getResult<AAManager>(F);
+    AM.getResult<AssumptionAnalysis>(F);
+    AM.getResult<DominatorTreeAnalysis>(F);
+    AM.getResult<TargetLibraryAnalysis>(F);
+    AM.getResult<TargetIRAnalysis>(F);
+    AM.getResult<ScalarEvolutionAnalysis>(F);
+
     PreservedAnalyses PA = PreservedAnalyses::all();
 
     // We want to visit the loops in reverse post-order. We'll build the stack
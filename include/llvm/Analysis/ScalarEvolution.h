@@ -49,6 +49,7 @@ class LLVMContext;
 class Operator;
 class SCEV;
 class SCEVAddRecExpr;
+class SCEVCommutativeExpr;
 class SCEVConstant;
 class SCEVExpander;
 class SCEVPredicate;
@@ -693,9 +694,10 @@ private:
     /// value returned by getMax or zero.
     bool isMaxOrZero(ScalarEvolution *SE) const;
 
-    /// Return true if any backedge taken count expressions refer to the given
-    /// subexpression.
-    bool hasOperand(const SCEV *S, ScalarEvolution *SE) const;
+    /// Return true if any backedge taken count expressions refer to one of the
+    /// given subexpressions.
+    bool hasOperand(const SmallPtrSetImpl<const SCEV *> &Ops,
+                    ScalarEvolution *SE) const;
 
     /// Invalidate this result and free associated memory.
     void clear();
@@ -721,6 +723,41 @@ private:
   DenseMap<const SCEV *, SmallVector<std::pair<const Loop *, const SCEV *>, 2>>
       ValuesAtScopes;
 
+  /// The key of a FoldCache entry: the SCEVTypes of the expression, combined
+  /// with the requested no-wrap flags, and the operands as passed in.
+  typedef std::pair<unsigned, ArrayRef<const SCEV *>> FoldCacheKey;
+
+  /// Memoized getAddExpr and getMulExpr results.  Canonicalizing an operand
+  /// list recursively builds many intermediate expressions, so the same
+  /// requests come up over and over.  The results depend on the loop
+  /// dispositions and ranges of the operands, so the cache is dropped whenever
+  /// those are.
+  DenseMap<FoldCacheKey, const SCEV *> FoldCache;
+
+  /// Holds the operand lists of the FoldCache keys.
+  BumpPtrAllocator FoldCacheAllocator;
+
+  /// Look up the result of folding \p Ops into an expression of kind
+  /// \p SCEVType in the FoldCache, or return null.
+  const SCEV *getFoldCacheEntry(unsigned SCEVType, SCEV::NoWrapFlags Flags,
+                                ArrayRef<const SCEV *> Ops) const;
+
+  /// Remember \p S as the result of folding \p Ops.
+  void setFoldCacheEntry(unsigned SCEVType, SCEV::NoWrapFlags Flags,
+                         ArrayRef<const SCEV *> Ops, const SCEV *S);
+
+  /// Drop all FoldCache entries.
+  void forgetFoldCache() {
+    FoldCache.clear();
+    FoldCacheAllocator.Reset();
+  }
+
+  /// Implementations of getAddExpr and getMulExpr, without the FoldCache.
+  const SCEV *getAddExprImpl(SmallVectorImpl<const SCEV *> &Ops,
+                             SCEV::NoWrapFlags Flags);
+  const SCEV *getMulExprImpl(SmallVectorImpl<const SCEV *> &Ops,
+                             SCEV::NoWrapFlags Flags);
+
   /// Memoized computeLoopDisposition results.
   DenseMap<const SCEV *,
            SmallVector<PointerIntPair<const Loop *, 2, LoopDisposition>, 2>>
@@ -1042,6 +1079,11 @@ private:
   /// Drop memoized information computed for S.
   void forgetMemoizedResults(const SCEV *S);
 
+  /// Drop memoized information computed for all the SCEVs in \p SCEVs. This is
+  /// cheaper than forgetting them one at a time, since the backedge-taken
+  /// caches are only scanned once.
+  void forgetMemoizedResults(ArrayRef<const SCEV *> SCEVs);
+
   /// Return an existing SCEV for V if there is one, otherwise return nullptr.
   const SCEV *getExistingSCEV(Value *V);
 
@@ -1388,7 +1430,16 @@ public:
   ///
   /// We don't have a way to invalidate per-loop dispositions. Clear and
   /// recompute is simpler.
-  void forgetLoopDispositions(const Loop *L) { LoopDispositions.clear(); }
+  void forgetLoopDispositions(const Loop *L) {
+    LoopDispositions.clear();
+    forgetFoldCache();
+  }
+
+  /// Add \p Flags to the no-wrap flags of an existing expression.  Folds
+  /// remembered in the FoldCache may depend on the old flags, so it is
+  /// dropped if this actually adds a flag.
+  void setNoWrapFlags(SCEVAddRecExpr *AddRec, SCEV::NoWrapFlags Flags);
+  void setNoWrapFlags(SCEVCommutativeExpr *S, SCEV::NoWrapFlags Flags);
 
   /// Determine the minimum number of zero bits that S is guaranteed to end in
   /// (at every loop iteration).  It is, at the same time, the minimum number
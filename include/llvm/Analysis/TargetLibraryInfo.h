@@ -12,6 +12,7 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
@@ -23,11 +24,13 @@ template <typename T> class ArrayRef;
 
 /// Describes a possible vectorization of a function.
 /// Function 'VectorFnName' is equivalent to 'ScalarFnName' vectorized
-/// by a factor 'VectorizationFactor'.
+/// by a factor 'VectorizationFactor'. If 'RequiredFeature' is not empty, the
+/// vector function may only be called on subtargets with that feature.
 struct VecDesc {
   StringRef ScalarFnName;
   StringRef VectorFnName;
   unsigned VectorizationFactor;
+  StringRef RequiredFeature;
 };
 
   namespace LibFunc {
@@ -70,6 +73,14 @@ class TargetLibraryInfoImpl {
   /// Scalarization descriptors - same content as VectorDescs but sorted based
   /// on VectorFnName rather than ScalarFnName.
   std::vector<VecDesc> ScalarDescs;
+  /// The index of the first descriptor of each scalar function in
+  /// VectorDescs.
+  StringMap<unsigned> ScalarFnIndex;
+  /// The index of the descriptor of each vector function in ScalarDescs.
+  StringMap<unsigned> VectorFnIndex;
+
+  /// Return the descriptor of F vectorized with factor VF, or null.
+  const VecDesc *findVectorizedFunction(StringRef F, unsigned VF) const;
 
   /// Return true if the function type FTy is valid for the library function
   /// F, regardless of whether the function is available.
@@ -87,7 +98,9 @@ public:
   enum VectorLibrary {
     NoLibrary,  // Don't use any vector library.
     Accelerate, // Use Accelerate framework.
-    SVML        // Intel short vector math library.
+    SVML,       // Intel short vector math library.
+    LIBMVEC,    // GLIBC vector math library.
+    SLEEF       // SLEEF vector math library, GNU ABI names.
   };
 
   TargetLibraryInfoImpl();
@@ -161,6 +174,10 @@ public:
   /// such mapping exists, return the empty string.
   StringRef getVectorizedFunction(StringRef F, unsigned VF) const;
 
+  /// Return the subtarget feature the equivalent of F, vectorized with factor
+  /// VF, needs. Returns the empty string if it needs none or doesn't exist.
+  StringRef getVectorizedFunctionFeature(StringRef F, unsigned VF) const;
+
   /// Return true if the function F has a scalar equivalent, and set VF to be
   /// the vectorization factor.
   bool isFunctionScalarizable(StringRef F, unsigned &VF) const {
@@ -225,6 +242,9 @@ public:
   StringRef getVectorizedFunction(StringRef F, unsigned VF) const {
     return Impl->getVectorizedFunction(F, VF);
   }
+  StringRef getVectorizedFunctionFeature(StringRef F, unsigned VF) const {
+    return Impl->getVectorizedFunctionFeature(F, VF);
+  }
 
   /// Tests if the function is both available and a candidate for optimized code
   /// generation.
@@ -402,6 +402,11 @@ public:
   /// operations, shuffles, or casts.
   bool isFPVectorizationPotentiallyUnsafe() const;
 
+  /// \brief Return true if the subtarget has the named feature, e.g. "avx2".
+  /// Used to check the instruction set required by vector library functions.
+  /// Targets return false for features they don't know about.
+  bool hasTargetFeature(StringRef Feature) const;
+
   /// \brief Determine if the target supports unaligned memory accesses.
   bool allowsMisalignedMemoryAccesses(LLVMContext &Context,
                                       unsigned BitWidth, unsigned AddressSpace = 0,
@@ -475,6 +480,23 @@ public:
   /// \return The size of a cache line in bytes.
   unsigned getCacheLineSize() const;
 
+  /// The possible cache levels
+  enum class CacheLevel {
+    L1D,   // The L1 data cache
+    L2D,   // The L2 data cache
+    L3D    // The L3 data cache, usually shared between cores
+  };
+
+  /// \return The size of the cache level in bytes, if available.
+  Optional<unsigned> getCacheSize(CacheLevel Level) const;
+
+  /// \return The associativity of the cache level, if available.
+  Optional<unsigned> getCacheAssociativity(CacheLevel Level) const;
+
+  /// \return The load-to-use latency in cycles of a hit in the cache level,
+  /// if available.
+  Optional<unsigned> getCacheLatency(CacheLevel Level) const;
+
   /// \return How much before a load we should place the prefetch instruction.
   /// This is currently measured in number of instructions.
   unsigned getPrefetchDistance() const;
@@ -713,6 +735,7 @@ public:
   virtual bool enableAggressiveInterleaving(bool LoopHasReductions) = 0;
   virtual bool enableInterleavedAccessVectorization() = 0;
   virtual bool isFPVectorizationPotentiallyUnsafe() = 0;
+  virtual bool hasTargetFeature(StringRef Feature) = 0;
   virtual bool allowsMisalignedMemoryAccesses(LLVMContext &Context,
                                               unsigned BitWidth,
                                               unsigned AddressSpace,
@@ -731,6 +754,9 @@ public:
   virtual unsigned getNumberOfRegisters(bool Vector) = 0;
   virtual unsigned getRegisterBitWidth(bool Vector) = 0;
   virtual unsigned getCacheLineSize() = 0;
+  virtual Optional<unsigned> getCacheSize(CacheLevel Level) = 0;
+  virtual Optional<unsigned> getCacheAssociativity(CacheLevel Level) = 0;
+  virtual Optional<unsigned> getCacheLatency(CacheLevel Level) = 0;
   virtual unsigned getPrefetchDistance() = 0;
   virtual unsigned getMinPrefetchStride() = 0;
   virtual unsigned getMaxPrefetchIterationsAhead() = 0;
@@ -907,6 +933,9 @@ public:
   bool isFPVectorizationPotentiallyUnsafe() override {
     return Impl.isFPVectorizationPotentiallyUnsafe();
   }
+  bool hasTargetFeature(StringRef Feature) override {
+    return Impl.hasTargetFeature(Feature);
+  }
   bool allowsMisalignedMemoryAccesses(LLVMContext &Context,
                                       unsigned BitWidth, unsigned AddressSpace,
                                       unsigned Alignment, bool *Fast) override {
@@ -945,6 +974,15 @@ public:
   unsigned getCacheLineSize() override {
     return Impl.getCacheLineSize();
   }
+  Optional<unsigned> getCacheSize(CacheLevel Level) override {
+    return Impl.getCacheSize(Level);
+  }
+  Optional<unsigned> getCacheAssociativity(CacheLevel Level) override {
+    return Impl.getCacheAssociativity(Level);
+  }
+  Optional<unsigned> getCacheLatency(CacheLevel Level) override {
+    return Impl.getCacheLatency(Level);
+  }
   unsigned getPrefetchDistance() override { return Impl.getPrefetchDistance(); }
   unsigned getMinPrefetchStride() override {
     return Impl.getMinPrefetchStride();
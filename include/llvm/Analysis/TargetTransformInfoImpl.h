@@ -256,6 +256,8 @@ public:
 
   bool isFPVectorizationPotentiallyUnsafe() { return false; }
 
+  bool hasTargetFeature(StringRef Feature) { return false; }
+
   bool allowsMisalignedMemoryAccesses(LLVMContext &Context,
                                       unsigned BitWidth,
                                       unsigned AddressSpace,
@@ -293,6 +295,20 @@ public:
 
   unsigned getCacheLineSize() { return 0; }
 
+  llvm::Optional<unsigned> getCacheSize(TargetTransformInfo::CacheLevel Level) {
+    return llvm::Optional<unsigned>();
+  }
+
+  llvm::Optional<unsigned>
+  getCacheAssociativity(TargetTransformInfo::CacheLevel Level) {
+    return llvm::Optional<unsigned>();
+  }
+
+  llvm::Optional<unsigned>
+  getCacheLatency(TargetTransformInfo::CacheLevel Level) {
+    return llvm::Optional<unsigned>();
+  }
+
   unsigned getPrefetchDistance() { return 0; }
 
   unsigned getMinPrefetchStride() { return 1; }
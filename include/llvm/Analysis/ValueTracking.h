@@ -15,6 +15,8 @@
 #ifndef LLVM_ANALYSIS_VALUETRACKING_H
 #define LLVM_ANALYSIS_VALUETRACKING_H
 
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/IntrinsicInst.h"
@@ -22,7 +24,6 @@
 
 namespace llvm {
 template <typename T> class ArrayRef;
-  class APInt;
   class AddOperator;
   class AssumptionCache;
   class DataLayout;
@@ -40,9 +41,69 @@ template <typename T> class ArrayRef;
   enum ID : unsigned;
   }
 
+  /// A cache for the results of computeKnownBits and ComputeNumSignBits.
+  ///
+  /// A result is only reused for a query about the same value, with the same
+  /// context instruction and at the same depth, so cached queries give exactly
+  /// the answers uncached ones would. The cache holds no value handles: its
+  /// owner must clear it whenever the IR it has seen may have changed.
+  class KnownBitsCache {
+    typedef std::pair<const Value *, std::pair<const Instruction *, unsigned>>
+        KeyTy;
+
+    static KeyTy getKey(const Value *V, const Instruction *CxtI,
+                        unsigned Depth) {
+      return std::make_pair(V, std::make_pair(CxtI, Depth));
+    }
+
+    DenseMap<KeyTy, std::pair<APInt, APInt>> KnownBits;
+    DenseMap<KeyTy, unsigned> NumSignBits;
+
+  public:
+    bool lookupKnownBits(const Value *V, const Instruction *CxtI,
+                         unsigned Depth, APInt &KnownZero,
+                         APInt &KnownOne) const {
+      auto I = KnownBits.find(getKey(V, CxtI, Depth));
+      if (I == KnownBits.end())
+        return false;
+      KnownZero = I->second.first;
+      KnownOne = I->second.second;
+      return true;
+    }
+
+    void insertKnownBits(const Value *V, const Instruction *CxtI,
+                         unsigned Depth, const APInt &KnownZero,
+                         const APInt &KnownOne) {
+      KnownBits[getKey(V, CxtI, Depth)] = std::make_pair(KnownZero, KnownOne);
+    }
+
+    bool lookupNumSignBits(const Value *V, const Instruction *CxtI,
+                           unsigned Depth, unsigned &Result) const {
+      auto I = NumSignBits.find(getKey(V, CxtI, Depth));
+      if (I == NumSignBits.end())
+        return false;
+      Result = I->second;
+      return true;
+    }
+
+    void insertNumSignBits(const Value *V, const Instruction *CxtI,
+                           unsigned Depth, unsigned Result) {
+      NumSignBits[getKey(V, CxtI, Depth)] = Result;
+    }
+
+    bool empty() const { return KnownBits.empty() && NumSignBits.empty(); }
+
+    void clear() {
+      KnownBits.clear();
+      NumSignBits.clear();
+    }
+  };
+
   /// Determine which bits of V are known to be either zero or one and return
   /// them in the KnownZero/KnownOne bit sets.
   ///
+  /// If \p Cache is given, results are looked up in and added to it.
+  ///
   /// This function is defined on values with integer type, values with pointer
   /// type, and vectors of integers.  In the case
   /// where V is a vector, the known zero and known one values are the
@@ -52,7 +113,8 @@ template <typename T> class ArrayRef;
                         const DataLayout &DL, unsigned Depth = 0,
                         AssumptionCache *AC = nullptr,
                         const Instruction *CxtI = nullptr,
-                        const DominatorTree *DT = nullptr);
+                        const DominatorTree *DT = nullptr,
+                        KnownBitsCache *Cache = nullptr);
   /// Compute known bits from the range metadata.
   /// \p KnownZero the set of bits that are known to be zero
   /// \p KnownOne the set of bits that are known to be one
@@ -71,7 +133,8 @@ template <typename T> class ArrayRef;
                       const DataLayout &DL, unsigned Depth = 0,
                       AssumptionCache *AC = nullptr,
                       const Instruction *CxtI = nullptr,
-                      const DominatorTree *DT = nullptr);
+                      const DominatorTree *DT = nullptr,
+                      KnownBitsCache *Cache = nullptr);
 
   /// Return true if the given value is known to have exactly one bit set when
   /// defined. For vectors return true if every element is known to be a power
@@ -134,7 +197,8 @@ template <typename T> class ArrayRef;
                          const DataLayout &DL,
                          unsigned Depth = 0, AssumptionCache *AC = nullptr,
                          const Instruction *CxtI = nullptr,
-                         const DominatorTree *DT = nullptr);
+                         const DominatorTree *DT = nullptr,
+                         KnownBitsCache *Cache = nullptr);
 
   /// Return the number of times the sign bit of the register is replicated into
   /// the other bits. We know that at least 1 bit is always equal to the sign
@@ -146,7 +210,8 @@ template <typename T> class ArrayRef;
   unsigned ComputeNumSignBits(const Value *Op, const DataLayout &DL,
                               unsigned Depth = 0, AssumptionCache *AC = nullptr,
                               const Instruction *CxtI = nullptr,
-                              const DominatorTree *DT = nullptr);
+                              const DominatorTree *DT = nullptr,
+                              KnownBitsCache *Cache = nullptr);
 
   /// This function computes the integer multiple of Base that equals V. If
   /// successful, it returns true and returns the multiple in Multiple. If
@@ -52,6 +52,11 @@ public:
 private:
   std::unique_ptr<MemoryObject> BitcodeBytes;
 
+  /// When the bytes are already in memory (rather than being streamed in),
+  /// the buffer itself, so that cursors can read words from it directly.
+  const uint8_t *BufferStart = nullptr;
+  size_t BufferSize = 0;
+
   std::vector<BlockInfo> BlockInfoRecords;
 
   /// This is set to true if we don't care about the block/record name
@@ -73,10 +78,17 @@ public:
   void init(const unsigned char *Start, const unsigned char *End) {
     assert(((End-Start) & 3) == 0 &&"Bitcode stream not a multiple of 4 bytes");
     BitcodeBytes.reset(getNonStreamedMemoryObject(Start, End));
+    BufferStart = Start;
+    BufferSize = End - Start;
   }
 
   MemoryObject &getBitcodeBytes() { return *BitcodeBytes; }
 
+  /// Return the start of the in-memory buffer, or null if the bytes are
+  /// streamed.
+  const uint8_t *getBufferStart() const { return BufferStart; }
+  size_t getBufferSize() const { return BufferSize; }
+
   /// This is called by clients that want block/record name information.
   void CollectBlockInfoNames() { IgnoreBlockInfoNames = false; }
   bool isIgnoringBlockInfoNames() { return IgnoreBlockInfoNames; }
@@ -159,6 +171,8 @@ public:
 
   bool canSkipToPos(size_t pos) const {
     // pos can be skipped to if it is a valid address or one byte past the end.
+    if (R->getBufferStart())
+      return pos <= R->getBufferSize();
     return pos == 0 ||
            R->getBitcodeBytes().isValidAddress(static_cast<uint64_t>(pos - 1));
   }
@@ -218,6 +232,8 @@ public:
 
   /// Get a pointer into the bitstream at the specified byte offset.
   const uint8_t *getPointerToByte(uint64_t ByteNo, uint64_t NumBytes) {
+    if (const uint8_t *Start = R->getBufferStart())
+      return Start + ByteNo;
     return R->getBitcodeBytes().getPointer(ByteNo, NumBytes);
   }
 
@@ -233,6 +249,18 @@ public:
     if (Size != 0 && NextChar >= Size)
       report_fatal_error("Unexpected end of file");
 
+    // If the bytes are in memory, load whole words straight from the buffer;
+    // only the final partial word goes through the memory object.
+    if (const uint8_t *Start = R->getBufferStart()) {
+      if (NextChar + sizeof(word_t) <= R->getBufferSize()) {
+        CurWord = support::endian::read<word_t, support::little,
+                                        support::unaligned>(Start + NextChar);
+        NextChar += sizeof(word_t);
+        BitsInCurWord = sizeof(word_t) * 8;
+        return;
+      }
+    }
+
     // Read the next word from the stream.
     uint8_t Array[sizeof(word_t)] = {0};
 
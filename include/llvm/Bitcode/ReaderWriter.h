@@ -21,6 +21,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace llvm {
   class BitstreamWriter;
@@ -85,6 +86,46 @@ namespace llvm {
   getModuleSummaryIndex(MemoryBufferRef Buffer,
                         const DiagnosticHandlerFunction &DiagnosticHandler);
 
+  /// A global value as described by the module-level records of a bitcode
+  /// file.
+  struct BitcodeGlobalValue {
+    std::string Name;
+    /// The comdat of the global value, or of the base object of an alias.
+    std::string Comdat;
+    std::string Section;
+    GlobalValue::LinkageTypes Linkage = GlobalValue::ExternalLinkage;
+    GlobalValue::VisibilityTypes Visibility = GlobalValue::DefaultVisibility;
+    GlobalValue::DLLStorageClassTypes DLLStorageClass =
+        GlobalValue::DefaultStorageClass;
+    GlobalValue::UnnamedAddr UnnamedAddr = GlobalValue::UnnamedAddr::None;
+    /// The CallingConv::ID of a function.
+    unsigned CallingConv = 0;
+    bool IsVariable = false;
+    bool IsConstant = false;
+    bool IsDeclaration = false;
+    bool IsThreadLocal = false;
+  };
+
+  /// The global values of a bitcode module, read without creating it.
+  struct BitcodeSymbolTable {
+    std::string TargetTriple;
+    std::string DataLayout;
+    /// Empty if the module has no source file name record.
+    std::string SourceFileName;
+    bool HasModuleAsm = false;
+    /// The functions, then the global variables, then the aliases, each in
+    /// module order. IFuncs are not listed.
+    std::vector<BitcodeGlobalValue> GlobalValues;
+  };
+
+  /// Read the global values of the first module in the specified bitcode
+  /// buffer from its module-level records only: no types, constants or
+  /// function bodies are parsed. This is much cheaper than creating even a
+  /// lazy Module when only the symbols of a file are needed.
+  ///
+  /// Fails if the module has an alias whose aliasee is not a global value.
+  ErrorOr<BitcodeSymbolTable> readBitcodeSymbolTable(MemoryBufferRef Buffer);
+
   /// \brief Write the specified module to the specified raw output stream.
   ///
   /// For streams where it matters, the given stream should be in "binary"
@@ -108,10 +149,14 @@ namespace llvm {
   /// where it will be written in a new bitcode block. This is used when
   /// writing the combined index file for ThinLTO. When writing a subset of the
   /// index for a distributed backend, provide the \p ModuleToSummariesForIndex
-  /// map.
+  /// map. Calls to functions that have no summary in the written index are
+  /// dropped, unless \p KeepUnsummarizedCallees is set because the index is
+  /// going to be merged with the callees' summaries later, as for a cached
+  /// per-module index.
   void WriteIndexToFile(const ModuleSummaryIndex &Index, raw_ostream &Out,
                         const std::map<std::string, GVSummaryMapTy>
-                            *ModuleToSummariesForIndex = nullptr);
+                            *ModuleToSummariesForIndex = nullptr,
+                        bool KeepUnsummarizedCallees = false);
 
   /// isBitcodeWrapper - Return true if the given bytes are the magic bytes
   /// for an LLVM IR bitcode wrapper.
@@ -90,6 +90,12 @@ private:
     return static_cast<const T *>(this)->getTLI();
   }
 
+  /// Return the machine model's description of \p Level, or nullptr if the
+  /// subtarget's model does not describe it.
+  const MCCacheLevel *getCacheLevel(TTI::CacheLevel Level) const {
+    return getST()->getSchedModel().getCacheLevel(static_cast<unsigned>(Level));
+  }
+
 protected:
   explicit BasicTTIImplBase(const TargetMachine *TM, const DataLayout &DL)
       : BaseT(DL) {}
@@ -298,6 +304,35 @@ public:
 
   unsigned getMaxInterleaveFactor(unsigned VF) { return 1; }
 
+  /// \name Cache parameters from the subtarget's machine model.
+  /// @{
+
+  unsigned getCacheLineSize() {
+    if (const MCCacheLevel *CL = getCacheLevel(TTI::CacheLevel::L1D))
+      return CL->LineSize;
+    return BaseT::getCacheLineSize();
+  }
+
+  Optional<unsigned> getCacheSize(TTI::CacheLevel Level) {
+    if (const MCCacheLevel *CL = getCacheLevel(Level))
+      return CL->Size;
+    return BaseT::getCacheSize(Level);
+  }
+
+  Optional<unsigned> getCacheAssociativity(TTI::CacheLevel Level) {
+    if (const MCCacheLevel *CL = getCacheLevel(Level))
+      return CL->Associativity;
+    return BaseT::getCacheAssociativity(Level);
+  }
+
+  Optional<unsigned> getCacheLatency(TTI::CacheLevel Level) {
+    if (const MCCacheLevel *CL = getCacheLevel(Level))
+      return CL->Latency;
+    return BaseT::getCacheLatency(Level);
+  }
+
+  /// @}
+
   unsigned getArithmeticInstrCost(
       unsigned Opcode, Type *Ty,
       TTI::OperandValueKind Opd1Info = TTI::OK_AnyValue,
@@ -41,6 +41,7 @@ class TargetRegisterClass;
 class TargetRegisterInfo;
 class MachineFunction;
 class MachineMemOperand;
+class IndexListEntry;
 
 //===----------------------------------------------------------------------===//
 /// Representation of each machine instruction.
@@ -100,10 +101,23 @@ private:
   // NumMemRefs - currently 256 - we remove the operands entirely. Note also
   // that this is a non-owning reference to a shared copy on write buffer owned
   // by the MachineFunction and created via MF.allocateMemRefsArray.
-  mmo_iterator MemRefs;
+  //
+  // Most instructions that access memory have exactly one memory operand. It
+  // is stored inline in InlineMemRef instead, which saves allocating a single
+  // element array for it.
+  union {
+    mmo_iterator MemRefs;
+    MachineMemOperand *InlineMemRef;
+  };
 
   DebugLoc debugLoc;                    // Source line information.
 
+  // The SlotIndexes list entry of this instruction, or null if it has not
+  // been numbered. This is owned by SlotIndexes, which keeps it here instead
+  // of in a side table so that instruction index lookups don't need to hash.
+  IndexListEntry *SlotIndexEntry;
+  friend class SlotIndexes;
+
   MachineInstr(const MachineInstr&) = delete;
   void operator=(const MachineInstr&) = delete;
   // Use MachineFunction::DeleteMachineInstr() instead.
@@ -354,9 +368,17 @@ public:
     return I - operands_begin();
   }
 
-  /// Access to memory operands of the instruction
-  mmo_iterator memoperands_begin() const { return MemRefs; }
-  mmo_iterator memoperands_end() const { return MemRefs + NumMemRefs; }
+  /// Access to memory operands of the instruction.  If the instruction has a
+  /// single memory operand, the iterators point into the instruction itself
+  /// and are invalidated when its memory operands are changed.
+  mmo_iterator memoperands_begin() const {
+    if (NumMemRefs == 1)
+      return const_cast<MachineMemOperand **>(&InlineMemRef);
+    return MemRefs;
+  }
+  mmo_iterator memoperands_end() const {
+    return memoperands_begin() + NumMemRefs;
+  }
   /// Return true if we don't have any memory operands which described the the
   /// memory access done by this instruction.  If this is true, calling code
   /// must be conservative.
@@ -1207,7 +1229,10 @@ public:
   /// second is the number of MemoryOperands.  This does not transfer ownership
   /// of the underlying memory.
   void setMemRefs(std::pair<mmo_iterator, unsigned> NewMemRefs) {
-    MemRefs = NewMemRefs.first;
+    if (NewMemRefs.second == 1)
+      InlineMemRef = *NewMemRefs.first;
+    else
+      MemRefs = NewMemRefs.first;
     NumMemRefs = uint8_t(NewMemRefs.second);
     assert(NumMemRefs == NewMemRefs.second &&
            "Too many memrefs - must drop memory operands");
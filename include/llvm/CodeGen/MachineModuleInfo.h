@@ -231,6 +231,9 @@ public:
   void setMachineFunctionInitializer(MachineFunctionInitializer *MFInit) {
     MFInitializer = MFInit;
   }
+  MachineFunctionInitializer *getMachineFunctionInitializer() const {
+    return MFInitializer;
+  }
 
   /// Returns the MachineFunction constructed for the IR function \p F.
   /// Creates a new MachineFunction and runs the MachineFunctionInitializer
@@ -320,8 +320,8 @@ public:
   /// Prepare this SelectionDAG to process code in the given MachineFunction.
   void init(MachineFunction &mf);
 
-  /// Clear state and free memory necessary to make this
-  /// SelectionDAG ready to process a new block.
+  /// Clear state necessary to make this SelectionDAG ready to process a new
+  /// block. Node and operand storage is kept for reuse by the next block.
   void clear();
 
   MachineFunction &getMachineFunction() const { return *MF; }
@@ -20,6 +20,7 @@
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/Pass.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
+#include <memory>
 
 namespace llvm {
   class FastISel;
@@ -36,6 +37,7 @@ namespace llvm {
   class GCFunctionInfo;
   class ScheduleDAGSDNodes;
   class LoadInst;
+  class OptimizationRemarkEmitter;
 
 /// SelectionDAGISel - This is the common base class used for SelectionDAG-based
 /// pattern-matching instruction selectors.
@@ -54,6 +56,10 @@ public:
   const TargetInstrInfo *TII;
   const TargetLowering *TLI;
 
+  /// Current optimization remark emitter.
+  /// Used to report things like FastISel fallbacks.
+  std::unique_ptr<OptimizationRemarkEmitter> ORE;
+
   static char ID;
 
   explicit SelectionDAGISel(TargetMachine &tm,
@@ -304,6 +310,12 @@ private:
   /// state machines that start with a OPC_SwitchOpcode node.
   std::vector<unsigned> OpcodeOffset;
 
+  /// SwitchCaseCache - Maps a (switch index, opcode) pair to the index of the
+  /// matching case for nested OPC_SwitchOpcode nodes with many cases, so that
+  /// repeated dispatch does not rescan the case list.  A value of 0 means that
+  /// no case matched.
+  DenseMap<uint64_t, unsigned> SwitchCaseCache;
+
   void UpdateChains(SDNode *NodeToMatch, SDValue InputChain,
                     const SmallVectorImpl<SDNode *> &ChainNodesMatched,
                     bool isMorphNodeTo);
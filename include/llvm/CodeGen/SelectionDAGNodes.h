@@ -386,7 +386,7 @@ public:
 
 /// Represents one node in the SelectionDAG.
 ///
-class SDNode : public FoldingSetNode, public ilist_node<SDNode> {
+class SDNode : public CachedHashFoldingSetNode, public ilist_node<SDNode> {
 private:
   /// The operation that this node performs.
   int16_t NodeType;
@@ -334,9 +334,6 @@ namespace llvm {
 
     MachineFunction *mf;
 
-    typedef DenseMap<const MachineInstr*, SlotIndex> Mi2IndexMap;
-    Mi2IndexMap mi2iMap;
-
     /// MBBRanges - Map MBB number to (start, stop) indexes.
     SmallVector<std::pair<SlotIndex, SlotIndex>, 8> MBBRanges;
 
@@ -399,15 +396,15 @@ namespace llvm {
     /// Returns true if the given machine instr is mapped to an index,
     /// otherwise returns false.
     bool hasIndex(const MachineInstr &instr) const {
-      return mi2iMap.count(&instr);
+      return instr.SlotIndexEntry;
     }
 
     /// Returns the base index for the given instruction.
     SlotIndex getInstructionIndex(const MachineInstr &MI) const {
       // Instructions inside a bundle have the same number as the bundle itself.
-      Mi2IndexMap::const_iterator itr = mi2iMap.find(&getBundleStart(MI));
-      assert(itr != mi2iMap.end() && "Instruction not found in maps.");
-      return itr->second;
+      IndexListEntry *Entry = getBundleStart(MI).SlotIndexEntry;
+      assert(Entry && "Instruction not found in maps.");
+      return SlotIndex(Entry, SlotIndex::Slot_Block);
     }
 
     /// Returns the instruction for the given index, or null if the given
@@ -439,9 +436,8 @@ namespace llvm {
         if (I == B)
           return getMBBStartIdx(MBB);
         --I;
-        Mi2IndexMap::const_iterator MapItr = mi2iMap.find(&*I);
-        if (MapItr != mi2iMap.end())
-          return MapItr->second;
+        if (IndexListEntry *Entry = I->SlotIndexEntry)
+          return SlotIndex(Entry, SlotIndex::Slot_Block);
       }
     }
 
@@ -456,9 +452,8 @@ namespace llvm {
         ++I;
         if (I == E)
           return getMBBEndIdx(MBB);
-        Mi2IndexMap::const_iterator MapItr = mi2iMap.find(&*I);
-        if (MapItr != mi2iMap.end())
-          return MapItr->second;
+        if (IndexListEntry *Entry = I->SlotIndexEntry)
+          return SlotIndex(Entry, SlotIndex::Slot_Block);
       }
     }
 
@@ -564,7 +559,7 @@ namespace llvm {
     SlotIndex insertMachineInstrInMaps(MachineInstr &MI, bool Late = false) {
       assert(!MI.isInsideBundle() &&
              "Instructions inside bundles should use bundle start's slot.");
-      assert(mi2iMap.find(&MI) == mi2iMap.end() && "Instr already indexed.");
+      assert(!MI.SlotIndexEntry && "Instr already indexed.");
       // Numbering DBG_VALUE instructions could cause code generation to be
       // affected by debug information.
       assert(!MI.isDebugValue() && "Cannot number DBG_VALUE instructions.");
@@ -596,22 +591,19 @@ namespace llvm {
       if (dist == 0)
         renumberIndexes(newItr);
 
-      SlotIndex newIndex(&*newItr, SlotIndex::Slot_Block);
-      mi2iMap.insert(std::make_pair(&MI, newIndex));
-      return newIndex;
+      MI.SlotIndexEntry = &*newItr;
+      return SlotIndex(&*newItr, SlotIndex::Slot_Block);
     }
 
     /// Remove the given machine instruction from the mapping.
     void removeMachineInstrFromMaps(MachineInstr &MI) {
       // remove index -> MachineInstr and
       // MachineInstr -> index mappings
-      Mi2IndexMap::iterator mi2iItr = mi2iMap.find(&MI);
-      if (mi2iItr != mi2iMap.end()) {
-        IndexListEntry *miEntry(mi2iItr->second.listEntry());
+      if (IndexListEntry *miEntry = MI.SlotIndexEntry) {
         assert(miEntry->getInstr() == &MI && "Instruction indexes broken.");
         // FIXME: Eventually we want to actually delete these indexes.
         miEntry->setInstr(nullptr);
-        mi2iMap.erase(mi2iItr);
+        MI.SlotIndexEntry = nullptr;
       }
     }
 
@@ -619,17 +611,15 @@ namespace llvm {
     /// maps used by register allocator. \returns the index where the new
     /// instruction was inserted.
     SlotIndex replaceMachineInstrInMaps(MachineInstr &MI, MachineInstr &NewMI) {
-      Mi2IndexMap::iterator mi2iItr = mi2iMap.find(&MI);
-      if (mi2iItr == mi2iMap.end())
+      IndexListEntry *miEntry = MI.SlotIndexEntry;
+      if (!miEntry)
         return SlotIndex();
-      SlotIndex replaceBaseIndex = mi2iItr->second;
-      IndexListEntry *miEntry(replaceBaseIndex.listEntry());
       assert(miEntry->getInstr() == &MI &&
              "Mismatched instruction in index tables.");
       miEntry->setInstr(&NewMI);
-      mi2iMap.erase(mi2iItr);
-      mi2iMap.insert(std::make_pair(&NewMI, replaceBaseIndex));
-      return replaceBaseIndex;
+      MI.SlotIndexEntry = nullptr;
+      NewMI.SlotIndexEntry = miEntry;
+      return SlotIndex(miEntry, SlotIndex::Slot_Block);
     }
 
     /// Add the given MachineBasicBlock into the maps.
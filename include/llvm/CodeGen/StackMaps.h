@@ -10,6 +10,7 @@
 #ifndef LLVM_CODEGEN_STACKMAPS_H
 #define LLVM_CODEGEN_STACKMAPS_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/MachineInstr.h"
@@ -218,6 +219,8 @@ public:
 
   void reset() {
     CSInfos.clear();
+    CSLocations.clear();
+    CSLiveOuts.clear();
     ConstPool.clear();
     FnInfos.clear();
   }
@@ -251,16 +254,39 @@ private:
     explicit FunctionInfo(uint64_t StackSize) : StackSize(StackSize), RecordCount(1) {}
   };
 
+  /// A location in the form it takes in the stack map section. Statepoint
+  /// heavy code records millions of these, so they are kept in one flat
+  /// array rather than in a vector per callsite.
+  struct EncodedLocation {
+    uint8_t Type;
+    uint8_t Size;
+    uint16_t Reg;
+    int32_t Offset;
+  };
+
+  /// The records of a callsite are CSLocations[FirstLocation, FirstLocation +
+  /// NumLocations) and CSLiveOuts[FirstLiveOut, FirstLiveOut + NumLiveOuts).
   struct CallsiteInfo {
     const MCExpr *CSOffsetExpr;
     uint64_t ID;
-    LocationVec Locations;
-    LiveOutVec LiveOuts;
-    CallsiteInfo() : CSOffsetExpr(nullptr), ID(0) {}
+    unsigned FirstLocation;
+    unsigned NumLocations;
+    unsigned FirstLiveOut;
+    unsigned NumLiveOuts;
     CallsiteInfo(const MCExpr *CSOffsetExpr, uint64_t ID,
-                 LocationVec &&Locations, LiveOutVec &&LiveOuts)
-        : CSOffsetExpr(CSOffsetExpr), ID(ID), Locations(std::move(Locations)),
-          LiveOuts(std::move(LiveOuts)) {}
+                 unsigned FirstLocation, unsigned NumLocations,
+                 unsigned FirstLiveOut, unsigned NumLiveOuts)
+        : CSOffsetExpr(CSOffsetExpr), ID(ID), FirstLocation(FirstLocation),
+          NumLocations(NumLocations), FirstLiveOut(FirstLiveOut),
+          NumLiveOuts(NumLiveOuts) {}
+
+    ArrayRef<EncodedLocation>
+    locations(const std::vector<EncodedLocation> &Pool) const {
+      return makeArrayRef(Pool).slice(FirstLocation, NumLocations);
+    }
+    ArrayRef<LiveOutReg> liveOuts(const std::vector<LiveOutReg> &Pool) const {
+      return makeArrayRef(Pool).slice(FirstLiveOut, NumLiveOuts);
+    }
   };
 
   typedef MapVector<const MCSymbol *, FunctionInfo> FnInfoMap;
@@ -268,6 +294,8 @@ private:
 
   AsmPrinter &AP;
   CallsiteInfoList CSInfos;
+  std::vector<EncodedLocation> CSLocations;
+  std::vector<LiveOutReg> CSLiveOuts;
   ConstantPool ConstPool;
   FnInfoMap FnInfos;
 
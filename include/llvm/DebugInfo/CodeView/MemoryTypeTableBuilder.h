@@ -39,9 +39,30 @@ public:
   ArrayRef<StringRef> getRecords() const { return Records; }
 
 private:
+  /// A record key together with its hash, so that the record contents are
+  /// only hashed once even when a lookup is followed by an insertion.
+  struct HashedRecord {
+    StringRef Data;
+    unsigned Hash;
+  };
+
+  struct HashedRecordInfo {
+    static HashedRecord getEmptyKey() {
+      return {DenseMapInfo<StringRef>::getEmptyKey(), 0};
+    }
+    static HashedRecord getTombstoneKey() {
+      return {DenseMapInfo<StringRef>::getTombstoneKey(), 0};
+    }
+    static unsigned getHashValue(const HashedRecord &R) { return R.Hash; }
+    static bool isEqual(const HashedRecord &LHS, const HashedRecord &RHS) {
+      return LHS.Hash == RHS.Hash &&
+             DenseMapInfo<StringRef>::isEqual(LHS.Data, RHS.Data);
+    }
+  };
+
   std::vector<StringRef> Records;
   BumpPtrAllocator &RecordStorage;
-  DenseMap<StringRef, TypeIndex> HashedRecords;
+  DenseMap<HashedRecord, TypeIndex, HashedRecordInfo> HashedRecords;
 };
 
 } // end namespace codeview
@@ -136,7 +136,8 @@ class DIContext {
 public:
   enum DIContextKind {
     CK_DWARF,
-    CK_PDB
+    CK_PDB,
+    CK_SymbolIndex
   };
   DIContextKind getKind() const { return Kind; }
 
@@ -10,8 +10,10 @@
 #ifndef LLVM_LIB_DEBUGINFO_DWARFABBREVIATIONDECLARATION_H
 #define LLVM_LIB_DEBUGINFO_DWARFABBREVIATIONDECLARATION_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Dwarf.h"
 
 namespace llvm {
 
@@ -47,6 +49,22 @@ public:
   bool extract(DataExtractor Data, uint32_t* OffsetPtr);
   void dump(raw_ostream &OS) const;
 
+  /// The number of leading attributes whose values start at an offset from
+  /// the end of the DIE's abbreviation code that is known without reading the
+  /// DIE, because all the values before them have fixed-size forms.
+  uint32_t getNumFixedOffsetAttributes() const { return FixedOffsets.size(); }
+
+  /// Return the offset of the value of the attribute at \p AttrIdx from the
+  /// end of the abbreviation code, given the fixed form sizes of the unit as
+  /// returned by DWARFFormValue::getFixedFormSizes(). \p AttrIdx must be less
+  /// than getNumFixedOffsetAttributes().
+  uint32_t getFixedAttributeOffset(uint32_t AttrIdx,
+                                   ArrayRef<uint8_t> FixedFormSizes) const {
+    const FixedOffset &O = FixedOffsets[AttrIdx];
+    return O.Bytes + O.NumAddrs * FixedFormSizes[dwarf::DW_FORM_addr] +
+           O.NumRefAddrs * FixedFormSizes[dwarf::DW_FORM_ref_addr];
+  }
+
 private:
   void clear();
 
@@ -55,6 +73,15 @@ private:
   bool HasChildren;
 
   AttributeSpecVector AttributeSpecs;
+
+  /// The sizes of DW_FORM_addr and DW_FORM_ref_addr depend on the unit, so
+  /// they are counted separately from the other fixed-size values.
+  struct FixedOffset {
+    uint32_t Bytes;
+    uint16_t NumAddrs;
+    uint16_t NumRefAddrs;
+  };
+  SmallVector<FixedOffset, 8> FixedOffsets;
 };
 
 }
@@ -40,6 +40,7 @@ class DWARFAcceleratorTable {
   DataExtractor AccelSection;
   DataExtractor StringSection;
   const RelocAddrMap& Relocs;
+  bool IsValid = false;
 public:
   DWARFAcceleratorTable(DataExtractor AccelSection, DataExtractor StringSection,
                         const RelocAddrMap &Relocs)
@@ -47,6 +48,13 @@ public:
 
   bool extract();
   void dump(raw_ostream &OS) const;
+
+  /// Append to \p DIEOffsets the .debug_info offsets of the DIEs the table
+  /// lists under \p Name. This only reads the bucket \p Name hashes to, so
+  /// it is much cheaper than scanning the units. Returns false if the table
+  /// cannot be searched: if extract() failed, or if the table uses an unknown
+  /// hash function or has no DW_ATOM_die_offset atom.
+  bool lookup(StringRef Name, SmallVectorImpl<uint32_t> &DIEOffsets) const;
 };
 
 }
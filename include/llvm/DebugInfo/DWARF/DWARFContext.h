@@ -13,6 +13,7 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/DebugInfo/DIContext.h"
+#include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugAranges.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugFrame.h"
@@ -43,6 +44,7 @@ class DWARFContext : public DIContext {
   std::deque<DWARFUnitSection<DWARFTypeUnit>> TUs;
   std::unique_ptr<DWARFUnitIndex> CUIndex;
   std::unique_ptr<DWARFGdbIndex> GdbIndex;
+  std::unique_ptr<DWARFAcceleratorTable> AppleNames;
   std::unique_ptr<DWARFUnitIndex> TUIndex;
   std::unique_ptr<DWARFDebugAbbrev> Abbrev;
   std::unique_ptr<DWARFDebugLoc> Loc;
@@ -52,6 +54,10 @@ class DWARFContext : public DIContext {
   std::unique_ptr<DWARFDebugFrame> EHFrame;
   std::unique_ptr<DWARFDebugMacro> Macro;
 
+  /// Number of threads used to scan independent units when building lookup
+  /// tables.
+  unsigned ThreadCount = 1;
+
   DWARFUnitSection<DWARFCompileUnit> DWOCUs;
   std::deque<DWARFUnitSection<DWARFTypeUnit>> DWOTUs;
   std::unique_ptr<DWARFDebugAbbrev> AbbrevDWO;
@@ -83,6 +89,11 @@ public:
     return DICtx->getKind() == CK_DWARF;
   }
 
+  /// Allow up to \p Count threads to be used to extract DIEs from independent
+  /// units, e.g. when building the address to unit map. The default of 1 keeps
+  /// everything lazy and on the calling thread.
+  void setThreadCount(unsigned Count) { ThreadCount = std::max(Count, 1u); }
+
   void dump(raw_ostream &OS, DIDumpType DumpType = DIDT_All,
             bool DumpEH = false, bool SummarizeTypes = false) override;
 
@@ -154,6 +165,18 @@ public:
   DWARFGdbIndex &getGdbIndex();
   const DWARFUnitIndex &getTUIndex();
 
+  /// Get the .apple_names accelerator table.
+  const DWARFAcceleratorTable &getAppleNames();
+
+  /// Append to \p DIEs the compile unit DIEs named \p Name, found through the
+  /// .apple_names accelerator table rather than by scanning the units.
+  /// Returns false if there is no usable table, in which case the caller has
+  /// to fall back to a scan.
+  bool findDIEsByName(
+      StringRef Name,
+      SmallVectorImpl<std::pair<DWARFCompileUnit *,
+                                const DWARFDebugInfoEntryMinimal *>> &DIEs);
+
   /// Get a pointer to the parsed DebugAbbrev object.
   const DWARFDebugAbbrev *getDebugAbbrev();
 
@@ -20,7 +20,10 @@ class DWARFContext;
 
 class DWARFDebugAranges {
 public:
-  void generate(DWARFContext *CTX);
+  /// Build the address map of CTX. Compile units that are not described by
+  /// .debug_aranges have their DIEs scanned, using up to \p ThreadCount
+  /// threads when it is greater than one.
+  void generate(DWARFContext *CTX, unsigned ThreadCount = 1);
   uint32_t findAddress(uint64_t Address) const;
 
 private:
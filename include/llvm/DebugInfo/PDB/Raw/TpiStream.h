@@ -18,6 +18,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include "llvm/Support/Error.h"
+#include <vector>
 
 namespace llvm {
 namespace msf {
@@ -51,10 +52,17 @@ public:
 
   iterator_range<codeview::CVTypeArray::Iterator> types(bool *HadError) const;
 
+  /// Return the type record for \p Index without walking the whole stream.
+  /// Record offsets are discovered lazily, starting from the nearest entry
+  /// of the hash stream's index offset table (if present) or from the
+  /// closest record that an earlier lookup already located.
+  Expected<codeview::CVType> getType(codeview::TypeIndex Index) const;
+
   Error commit();
 
 private:
   Error verifyHashValues();
+  Expected<codeview::CVType> readTypeAt(uint32_t Offset) const;
 
   const PDBFile &Pdb;
   std::unique_ptr<msf::MappedBlockStream> Stream;
@@ -66,6 +74,11 @@ private:
   msf::FixedStreamArray<TypeIndexOffset> TypeIndexOffsets;
   msf::FixedStreamArray<TypeIndexOffset> HashAdjustments;
 
+  /// Offset of each type record within TypeRecords, indexed by
+  /// TypeIndex - TypeIndexBegin(), or UnknownOffset if not located yet.
+  mutable std::vector<uint32_t> RecordOffsets;
+  static const uint32_t UnknownOffset = ~0U;
+
   const TpiStreamHeader *Header;
 };
 }
@@ -0,0 +1,101 @@
+//===-- SymbolIndex.h ------------------------------------------- C++ -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares SymbolIndexContext, a DIContext answering symbolization
+// queries from a precomputed index file instead of parsing debug info.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLINDEX_H
+#define LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLINDEX_H
+
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+
+namespace llvm {
+class DWARFContext;
+class raw_ostream;
+
+namespace sys {
+namespace fs {
+class file_status;
+}
+}
+
+namespace symbolize {
+
+/// A symbol index maps each code address described by the debug info of a
+/// binary to its inlining chain: the function names, file names, lines and
+/// columns the symbolizer would compute from the debug info. It is written
+/// once per binary by writeSymbolIndex, and used in place of the debug info
+/// by mapping the file into memory; nothing is parsed when it is opened.
+///
+/// The file consists of a header, an array of address ranges sorted by start
+/// address, an array of frames and a string table. Each range extends to the
+/// start of the next one and refers to the frames of its inlining chain,
+/// innermost first. File names are absolute, and both the short and the
+/// linkage name of each function are recorded.
+class SymbolIndexContext : public DIContext {
+public:
+  /// Open the index in \p Buffer. Fails if it is not a valid index.
+  static ErrorOr<std::unique_ptr<SymbolIndexContext>>
+  create(std::unique_ptr<MemoryBuffer> Buffer);
+
+  /// Return true if the index was built for a binary with status \p Status.
+  /// The size and modification time of the binary are recorded in the index
+  /// so that a stale index is not used after the binary is rebuilt.
+  bool isUpToDate(const sys::fs::file_status &Status) const;
+
+  void dump(raw_ostream &OS, DIDumpType DumpType = DIDT_All,
+            bool DumpEH = false, bool SummarizeTypes = false) override;
+
+  DILineInfo getLineInfoForAddress(
+      uint64_t Address,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+  DILineInfoTable getLineInfoForAddressRange(
+      uint64_t Address, uint64_t Size,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+  DIInliningInfo getInliningInfoForAddress(
+      uint64_t Address,
+      DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
+
+  static bool classof(const DIContext *DICtx) {
+    return DICtx->getKind() == CK_SymbolIndex;
+  }
+
+  struct Header;
+  struct Range;
+  struct Frame;
+
+private:
+  SymbolIndexContext(std::unique_ptr<MemoryBuffer> Buffer);
+
+  /// Return the range containing \p Address, or null.
+  const Range *findRange(uint64_t Address) const;
+  DILineInfo getFrame(const Frame &F, DILineInfoSpecifier Specifier) const;
+  StringRef getString(uint32_t Offset) const;
+
+  std::unique_ptr<MemoryBuffer> Buffer;
+  const Header *Hdr;
+  const Range *Ranges;
+  const Frame *Frames;
+  StringRef Strings;
+};
+
+/// Write the symbol index of the debug info in \p DICtx to \p OS.
+/// \p Status is the status of the binary the index is for.
+void writeSymbolIndex(DWARFContext &DICtx, const sys::fs::file_status &Status,
+                      raw_ostream &OS);
+
+} // namespace symbolize
+} // namespace llvm
+
+#endif // LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLINDEX_H
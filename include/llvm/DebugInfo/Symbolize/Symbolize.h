@@ -36,6 +36,10 @@ public:
     bool RelativeAddresses : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    unsigned DWARFThreads = 1;
+    /// Answer queries from the symbol index of a binary instead of its debug
+    /// info when it has an up to date one (see buildSymbolIndex).
+    bool UseSymbolIndex = true;
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
             bool RelativeAddresses = false, std::string DefaultArch = "")
@@ -56,6 +60,16 @@ public:
   Expected<DIGlobal> symbolizeData(const std::string &ModuleName,
                                    uint64_t ModuleOffset);
   void flush();
+
+  /// Build the symbol index of a module from its debug info, and write it
+  /// next to the binary, to the path given by getSymbolIndexPath. Later
+  /// symbolizers use the index instead of parsing the debug info. Only DWARF
+  /// is supported.
+  Error buildSymbolIndex(const std::string &ModuleName);
+  static std::string getSymbolIndexPath(const std::string &BinaryName) {
+    return BinaryName + ".symidx";
+  }
+
   static std::string DemangleName(const std::string &Name,
                                   const SymbolizableModule *ModInfo);
 
@@ -64,6 +78,10 @@ private:
   // corresponding debug info. These objects can be the same.
   typedef std::pair<ObjectFile*, ObjectFile*> ObjectPair;
 
+  /// Split a module name of the form "path[:arch]".
+  void splitModuleName(const std::string &ModuleName, std::string &BinaryName,
+                       std::string &ArchName) const;
+
   /// Returns a SymbolizableModule or an error if loading debug info failed.
   /// Only one attempt is made to load a module, and errors during loading are
   /// only reported once. Subsequent calls to get module info for a module that
@@ -123,6 +123,9 @@ class ExecutionEngine {
   /// Whether the JIT should verify IR modules during compilation.
   bool VerifyModules;
 
+  /// The number of threads the JIT may use to compile modules.
+  unsigned CompileThreads;
+
   friend class EngineBuilder;  // To allow access to JITCtor and InterpCtor.
 
 protected:
@@ -480,6 +483,17 @@ public:
     return VerifyModules;
   }
 
+  /// Set the number of threads the JIT may use to compile modules that are
+  /// pending at once.  Only modules in different LLVMContexts are compiled
+  /// concurrently.  0, the default, uses one thread per core, and 1 compiles
+  /// every module on the calling thread.
+  void setCompileThreads(unsigned Threads) {
+    CompileThreads = Threads;
+  }
+  unsigned getCompileThreads() const {
+    return CompileThreads;
+  }
+
   /// InstallLazyFunctionCreator - If an unknown function is needed, the
   /// specified function pointer is invoked to create it.  If it returns null,
   /// the JIT will abort.
@@ -531,6 +545,7 @@ private:
   std::string MCPU;
   SmallVector<std::string, 4> MAttrs;
   bool VerifyModules;
+  unsigned CompileThreads;
   bool UseOrcMCJITReplacement;
 
 public:
@@ -619,6 +634,13 @@ public:
     return *this;
   }
 
+  /// setCompileThreads - Set the number of threads the JIT implementation
+  /// may use to compile modules (0 = one per core).
+  EngineBuilder &setCompileThreads(unsigned Threads) {
+    CompileThreads = Threads;
+    return *this;
+  }
+
   /// setMAttrs - Set cpu-specific attributes.
   template<typename StringSequence>
   EngineBuilder &setMAttrs(const StringSequence &mattrs) {
@@ -0,0 +1,82 @@
+//===-- FileObjectCache.h - On-disk ObjectCache -----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares FileObjectCache, an ObjectCache that keeps compiled
+// objects in a directory so they can be reused across runs and processes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_FILEOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_FILEOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include <string>
+
+namespace llvm {
+
+/// A content-addressed ObjectCache stored in a directory on disk.
+///
+/// Each entry is named after a SHA1 of the module's textual IR and of a target
+/// identifier supplied by the client, which should describe everything else
+/// that affects code generation (typically the triple, CPU, features and
+/// optimization level). Entries are written to a temporary file and renamed
+/// into place, so several processes can share one directory. After writing its
+/// first entry, the cache prunes the directory with llvm::CachePruning, using
+/// the policy set below; by default entries unused for a week are removed and
+/// the directory is kept under 75% of the available space.
+///
+/// The cache is best-effort: failures to read or write entries are ignored and
+/// simply cause the module to be compiled.
+class FileObjectCache : public ObjectCache {
+public:
+  FileObjectCache(StringRef CacheDir, StringRef TargetID);
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  /// Return the path of the cache entry for \p M.
+  std::string getEntryPath(const Module &M) const;
+
+  /// Cache policy: interval (seconds) between two prunings of the directory.
+  /// Set to a negative value to disable pruning.
+  void setPruningInterval(int Interval) { PruningInterval = Interval; }
+
+  /// Cache policy: expiration (seconds) of an entry that has not been used.
+  /// A value of 0 disables the expiration.
+  void setEntryExpiration(unsigned Expiration) {
+    this->Expiration = Expiration;
+  }
+
+  /// Cache policy: maximum size of the directory, as a percentage of the
+  /// available space. A value of 0 disables the size limit.
+  void setMaxSizeRelativeToAvailableSpace(unsigned Percentage) {
+    MaxPercentageOfAvailableSpace = Percentage;
+  }
+
+private:
+  std::string CacheDir;
+  std::string TargetID;
+
+  int PruningInterval = 1200;
+  unsigned Expiration = 7 * 24 * 3600;
+  unsigned MaxPercentageOfAvailableSpace = 75;
+
+  /// Whether this cache has pruned the directory already.
+  bool Pruned = false;
+
+  /// Entry paths computed by getObject for modules that missed the cache, so
+  /// that the following notifyObjectCompiled does not rehash the module.
+  DenseMap<const Module *, std::string> PendingEntries;
+};
+
+} // end namespace llvm
+
+#endif
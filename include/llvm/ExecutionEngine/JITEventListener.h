@@ -113,6 +113,14 @@ public:
     return nullptr;
   }
 #endif // USE_OPROFILE
+
+#if LLVM_USE_PERF
+  // Construct a PerfJITEventListener, which writes a perf map and a jitdump
+  // file for the process.
+  static JITEventListener *createPerfJITEventListener();
+#else
+  static JITEventListener *createPerfJITEventListener() { return nullptr; }
+#endif // USE_PERF
 private:
   virtual void anchor();
 };
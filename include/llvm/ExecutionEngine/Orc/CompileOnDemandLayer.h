@@ -252,17 +252,19 @@ public:
   //        implementations).
   // FIXME: Return Error once the JIT APIs are Errorized.
   bool updatePointer(std::string FuncName, JITTargetAddress FnBodyAddr) {
-    //Find out which logical dylib contains our symbol
-    auto LDI = LogicalDylibs.begin();
-    for (auto LDE = LogicalDylibs.end(); LDI != LDE; ++LDI) {
-      if (auto LMResources = LDI->getLogicalModuleResourcesForSymbol(FuncName, false)) {
-        Module &SrcM = LMResources->SourceModule->getResource();
+    // Find out which logical dylib contains our symbol. Stubs are keyed by
+    // mangled name, so mangle with the data layout of each source module.
+    for (auto &LD : LogicalDylibs) {
+      for (auto &SrcModEntry : LD.SourceModules) {
+        Module &SrcM = SrcModEntry.SourceMod->getResource();
         std::string CalledFnName = mangle(FuncName, SrcM.getDataLayout());
-        if (auto EC = LMResources->StubsMgr->updatePointer(CalledFnName, FnBodyAddr)) {
+        if (!LD.StubsMgr->findStub(CalledFnName, false))
+          continue;
+        if (auto EC = LD.StubsMgr->updatePointer(CalledFnName, FnBodyAddr)) {
+          consumeError(std::move(EC));
           return false;
         }
-        else
-          return true;
+        return true;
       }
     }
     return false;
@@ -22,6 +22,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
+#include <mutex>
 
 namespace llvm {
 namespace orc {
@@ -55,11 +56,23 @@ public:
   JITCompileCallbackManager(JITTargetAddress ErrorHandlerAddress)
       : ErrorHandlerAddress(ErrorHandlerAddress) {}
 
+  /// @brief Move a JITCompileCallbackManager. The moved-from manager must not
+  ///        be in use by any other thread.
+  JITCompileCallbackManager(JITCompileCallbackManager &&Other)
+      : ErrorHandlerAddress(Other.ErrorHandlerAddress),
+        ActiveTrampolines(std::move(Other.ActiveTrampolines)),
+        AvailableTrampolines(std::move(Other.AvailableTrampolines)) {}
+
   virtual ~JITCompileCallbackManager() {}
 
   /// @brief Execute the callback for the given trampoline id. Called by the JIT
   ///        to compile functions on demand.
+  ///
+  ///   This may be entered from several JIT'd threads at once. Compile actions
+  /// are run one at a time, since the layers they call into are not
+  /// thread-safe, and may themselves reserve new callbacks.
   JITTargetAddress executeCompileCallback(JITTargetAddress TrampolineAddr) {
+    std::lock_guard<std::recursive_mutex> Lock(CCMgrMutex);
     auto I = ActiveTrampolines.find(TrampolineAddr);
     // FIXME: Also raise an error in the Orc error-handler when we finally have
     //        one.
@@ -86,6 +99,7 @@ public:
 
   /// @brief Reserve a compile callback.
   CompileCallbackInfo getCompileCallback() {
+    std::lock_guard<std::recursive_mutex> Lock(CCMgrMutex);
     JITTargetAddress TrampolineAddr = getAvailableTrampolineAddr();
     auto &Compile = this->ActiveTrampolines[TrampolineAddr];
     return CompileCallbackInfo(TrampolineAddr, Compile);
@@ -93,6 +107,7 @@ public:
 
   /// @brief Get a CompileCallbackInfo for an existing callback.
   CompileCallbackInfo getCompileCallbackInfo(JITTargetAddress TrampolineAddr) {
+    std::lock_guard<std::recursive_mutex> Lock(CCMgrMutex);
     auto I = ActiveTrampolines.find(TrampolineAddr);
     assert(I != ActiveTrampolines.end() && "Not an active trampoline.");
     return CompileCallbackInfo(I->first, I->second);
@@ -104,6 +119,7 @@ public:
   /// only be called to manually release a callback that is not going to
   /// execute.
   void releaseCompileCallback(JITTargetAddress TrampolineAddr) {
+    std::lock_guard<std::recursive_mutex> Lock(CCMgrMutex);
     auto I = ActiveTrampolines.find(TrampolineAddr);
     assert(I != ActiveTrampolines.end() && "Not an active trampoline.");
     ActiveTrampolines.erase(I);
@@ -113,6 +129,10 @@ public:
 protected:
   JITTargetAddress ErrorHandlerAddress;
 
+  /// Guards the trampoline lists and serializes compile actions. Recursive,
+  /// because compile actions reserve callbacks for the code they emit.
+  std::recursive_mutex CCMgrMutex;
+
   typedef std::map<JITTargetAddress, CompileFtor> TrampolineMapT;
   TrampolineMapT ActiveTrampolines;
   std::vector<JITTargetAddress> AvailableTrampolines;
@@ -231,6 +231,9 @@ public:
     bool finalizeMemory(std::string *ErrMsg = nullptr) override {
       DEBUG(dbgs() << "Allocator " << Id << " finalizing:\n");
 
+      // Queue every write, permission change and EH-frame registration, then
+      // flush them to the remote in one batch. The remote handles calls in
+      // order, so each segment is fully written before it is protected.
       for (auto &ObjAllocs : Unfinalized) {
 
         for (auto &Alloc : ObjAllocs.CodeAllocs) {
@@ -238,35 +241,19 @@ public:
                        << static_cast<void *>(Alloc.getLocalAddress()) << " -> "
                        << format("0x%016x", Alloc.getRemoteAddress()) << " ("
                        << Alloc.getSize() << " bytes)\n");
-          if (auto Err =
-                  Client.writeMem(Alloc.getRemoteAddress(),
-                                  Alloc.getLocalAddress(), Alloc.getSize())) {
-            // FIXME: Replace this once finalizeMemory can return an Error.
-            handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-              if (ErrMsg) {
-                raw_string_ostream ErrOut(*ErrMsg);
-                EIB.log(ErrOut);
-              }
-            });
-            return true;
-          }
+          if (auto Err = Client.appendWriteMem(Alloc.getRemoteAddress(),
+                                               Alloc.getLocalAddress(),
+                                               Alloc.getSize()))
+            return reportFinalizeError(std::move(Err), ErrMsg);
         }
 
         if (ObjAllocs.RemoteCodeAddr) {
           DEBUG(dbgs() << "  setting R-X permissions on code block: "
                        << format("0x%016x", ObjAllocs.RemoteCodeAddr) << "\n");
-          if (auto Err = Client.setProtections(Id, ObjAllocs.RemoteCodeAddr,
-                                               sys::Memory::MF_READ |
-                                                   sys::Memory::MF_EXEC)) {
-            // FIXME: Replace this once finalizeMemory can return an Error.
-            handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-              if (ErrMsg) {
-                raw_string_ostream ErrOut(*ErrMsg);
-                EIB.log(ErrOut);
-              }
-            });
-            return true;
-          }
+          if (auto Err = Client.appendSetProtections(
+                  Id, ObjAllocs.RemoteCodeAddr,
+                  sys::Memory::MF_READ | sys::Memory::MF_EXEC))
+            return reportFinalizeError(std::move(Err), ErrMsg);
         }
 
         for (auto &Alloc : ObjAllocs.RODataAllocs) {
@@ -274,35 +261,19 @@ public:
                        << static_cast<void *>(Alloc.getLocalAddress()) << " -> "
                        << format("0x%016x", Alloc.getRemoteAddress()) << " ("
                        << Alloc.getSize() << " bytes)\n");
-          if (auto Err =
-                  Client.writeMem(Alloc.getRemoteAddress(),
-                                  Alloc.getLocalAddress(), Alloc.getSize())) {
-            // FIXME: Replace this once finalizeMemory can return an Error.
-            handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-              if (ErrMsg) {
-                raw_string_ostream ErrOut(*ErrMsg);
-                EIB.log(ErrOut);
-              }
-            });
-            return true;
-          }
+          if (auto Err = Client.appendWriteMem(Alloc.getRemoteAddress(),
+                                               Alloc.getLocalAddress(),
+                                               Alloc.getSize()))
+            return reportFinalizeError(std::move(Err), ErrMsg);
         }
 
         if (ObjAllocs.RemoteRODataAddr) {
           DEBUG(dbgs() << "  setting R-- permissions on ro-data block: "
                        << format("0x%016x", ObjAllocs.RemoteRODataAddr)
                        << "\n");
-          if (auto Err = Client.setProtections(Id, ObjAllocs.RemoteRODataAddr,
-                                               sys::Memory::MF_READ)) {
-            // FIXME: Replace this once finalizeMemory can return an Error.
-            handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-              if (ErrMsg) {
-                raw_string_ostream ErrOut(*ErrMsg);
-                EIB.log(ErrOut);
-              }
-            });
-            return false;
-          }
+          if (auto Err = Client.appendSetProtections(
+                  Id, ObjAllocs.RemoteRODataAddr, sys::Memory::MF_READ))
+            return reportFinalizeError(std::move(Err), ErrMsg);
         }
 
         for (auto &Alloc : ObjAllocs.RWDataAllocs) {
@@ -310,58 +281,48 @@ public:
                        << static_cast<void *>(Alloc.getLocalAddress()) << " -> "
                        << format("0x%016x", Alloc.getRemoteAddress()) << " ("
                        << Alloc.getSize() << " bytes)\n");
-          if (auto Err =
-                  Client.writeMem(Alloc.getRemoteAddress(),
-                                  Alloc.getLocalAddress(), Alloc.getSize())) {
-            // FIXME: Replace this once finalizeMemory can return an Error.
-            handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-              if (ErrMsg) {
-                raw_string_ostream ErrOut(*ErrMsg);
-                EIB.log(ErrOut);
-              }
-            });
-            return false;
-          }
+          if (auto Err = Client.appendWriteMem(Alloc.getRemoteAddress(),
+                                               Alloc.getLocalAddress(),
+                                               Alloc.getSize()))
+            return reportFinalizeError(std::move(Err), ErrMsg);
         }
 
         if (ObjAllocs.RemoteRWDataAddr) {
           DEBUG(dbgs() << "  setting RW- permissions on rw-data block: "
                        << format("0x%016x", ObjAllocs.RemoteRWDataAddr)
                        << "\n");
-          if (auto Err = Client.setProtections(Id, ObjAllocs.RemoteRWDataAddr,
-                                               sys::Memory::MF_READ |
-                                                   sys::Memory::MF_WRITE)) {
-            // FIXME: Replace this once finalizeMemory can return an Error.
-            handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-              if (ErrMsg) {
-                raw_string_ostream ErrOut(*ErrMsg);
-                EIB.log(ErrOut);
-              }
-            });
-            return false;
-          }
+          if (auto Err = Client.appendSetProtections(
+                  Id, ObjAllocs.RemoteRWDataAddr,
+                  sys::Memory::MF_READ | sys::Memory::MF_WRITE))
+            return reportFinalizeError(std::move(Err), ErrMsg);
         }
       }
       Unfinalized.clear();
 
-      for (auto &EHFrame : UnfinalizedEHFrames) {
-        if (auto Err = Client.registerEHFrames(EHFrame.first, EHFrame.second)) {
-          // FIXME: Replace this once finalizeMemory can return an Error.
-          handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
-            if (ErrMsg) {
-              raw_string_ostream ErrOut(*ErrMsg);
-              EIB.log(ErrOut);
-            }
-          });
-          return false;
-        }
-      }
+      for (auto &EHFrame : UnfinalizedEHFrames)
+        if (auto Err = Client.appendRegisterEHFrames(EHFrame.first,
+                                                     EHFrame.second))
+          return reportFinalizeError(std::move(Err), ErrMsg);
       UnfinalizedEHFrames.clear();
 
+      if (auto Err = Client.flushPendingCalls())
+        return reportFinalizeError(std::move(Err), ErrMsg);
+
       return false;
     }
 
   private:
+    // FIXME: Replace this once finalizeMemory can return an Error.
+    static bool reportFinalizeError(Error Err, std::string *ErrMsg) {
+      handleAllErrors(std::move(Err), [&](ErrorInfoBase &EIB) {
+        if (ErrMsg) {
+          raw_string_ostream ErrOut(*ErrMsg);
+          EIB.log(ErrOut);
+        }
+      });
+      return true;
+    }
+
     class Alloc {
     public:
       Alloc(uint64_t Size, unsigned Align)
@@ -789,6 +750,77 @@ private:
     return callST<SetProtections>(Channel, Id, RemoteSegAddr, ProtFlags);
   }
 
+  // Queue a call without flushing the channel. Its result is checked by the
+  // next flushPendingCalls.
+  template <typename Func, typename... ArgTs>
+  Error appendPendingCall(const ArgTs &... Args) {
+    // Check for an 'out-of-band' error, e.g. from an MM destructor.
+    if (ExistingError) {
+      discardPendingCalls();
+      return std::move(ExistingError);
+    }
+
+    static_assert(
+        std::is_same<NonBlockingCallResult<Func>, PendingCallResult>::value,
+        "Only void RPCs can be queued as pending calls");
+
+    auto ResultOrErr = appendCallNB<Func>(Channel, Args...);
+    if (!ResultOrErr) {
+      discardPendingCalls();
+      return ResultOrErr.takeError();
+    }
+    PendingResults.push_back(std::move(*ResultOrErr));
+    return Error::success();
+  }
+
+  Error appendRegisterEHFrames(JITTargetAddress Addr, uint32_t Size) {
+    return appendPendingCall<RegisterEHFrames>(Addr, Size);
+  }
+
+  Error appendSetProtections(ResourceIdMgr::ResourceId Id,
+                             JITTargetAddress RemoteSegAddr,
+                             unsigned ProtFlags) {
+    return appendPendingCall<SetProtections>(Id, RemoteSegAddr, ProtFlags);
+  }
+
+  Error appendWriteMem(JITTargetAddress Addr, const char *Src, uint64_t Size) {
+    return appendPendingCall<WriteMem>(DirectBufferWriter(Src, Addr, Size));
+  }
+
+  // Send all queued calls in one go and wait for their results. Returns the
+  // first failure, if any.
+  Error flushPendingCalls() {
+    if (PendingResults.empty())
+      return Error::success();
+
+    if (auto Err = sendAndWaitForAllResults(Channel)) {
+      discardPendingCalls();
+      return Err;
+    }
+
+    Error Err = Error::success();
+    for (auto &Result : PendingResults) {
+      Error CallErr = Result.get();
+      if (Err)
+        consumeError(std::move(CallErr));
+      else
+        Err = std::move(CallErr);
+    }
+    PendingResults.clear();
+    return Err;
+  }
+
+  // Drop the queued calls after a failure, so that the next flush does not
+  // wait for them. The RPC layer has abandoned those it will not answer; the
+  // results that are already in are consumed.
+  void discardPendingCalls() {
+    for (auto &Result : PendingResults)
+      if (Result.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready)
+        consumeError(Result.get());
+    PendingResults.clear();
+  }
+
   Error writeMem(JITTargetAddress Addr, const char *Src, uint64_t Size) {
     // Check for an 'out-of-band' error, e.g. from an MM destructor.
     if (ExistingError)
@@ -807,6 +839,11 @@ private:
 
   static Error doNothing() { return Error::success(); }
 
+  // The result of a queued call. Every RPC that is batched returns void, so
+  // they all share the same future type.
+  typedef std::future<typename RegisterEHFrames::PErrorReturn>
+      PendingCallResult;
+
   ChannelT &Channel;
   Error ExistingError;
   std::string RemoteTargetTriple;
@@ -816,6 +853,7 @@ private:
   uint32_t RemoteIndirectStubSize = 0;
   ResourceIdMgr AllocatorIds, IndirectStubOwnerIds;
   Optional<RCCompileCallbackManager> CallbackManager;
+  std::vector<PendingCallResult> PendingResults;
 };
 
 } // end namespace remote
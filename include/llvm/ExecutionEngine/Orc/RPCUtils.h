@@ -678,6 +678,44 @@ public:
     return Error::success();
   }
 
+  /// Flush channel C, then block until every outstanding call has received its
+  /// result. While blocked, run HandleOther to handle incoming calls.
+  ///
+  /// Together with appendCallNB this lets a batch of calls share a single
+  /// channel flush and a single wait, rather than costing a round trip each.
+  template <typename HandleOtherFtor>
+  Error sendAndWaitForAllResults(ChannelT &C, HandleOtherFtor &HandleOther) {
+    if (auto Err = C.send()) {
+      abandonOutstandingResults();
+      return Err;
+    }
+
+    while (!OutstandingResults.empty()) {
+      FunctionIdT Id = RPCFunctionIdTraits<FunctionIdT>::InvalidId;
+      if (auto Err = startReceivingFunction(C, Id)) {
+        abandonOutstandingResults();
+        return Err;
+      }
+      if (Id == RPCFunctionIdTraits<FunctionIdT>::ResponseId) {
+        if (auto Err = handleResponse(C)) {
+          abandonOutstandingResults();
+          return Err;
+        }
+      } else if (auto Err = HandleOther(C, Id)) {
+        abandonOutstandingResults();
+        return Err;
+      }
+    }
+
+    return Error::success();
+  }
+
+  /// The same as sendAndWaitForAllResults, except that any incoming call other
+  /// than a response is treated as an error.
+  Error sendAndWaitForAllResults(ChannelT &C) {
+    return sendAndWaitForAllResults(C, handleNone);
+  }
+
   // Default handler for 'other' (non-response) functions when waiting for a
   // result from the channel.
   static Error handleNone(ChannelT &, FunctionIdT) {
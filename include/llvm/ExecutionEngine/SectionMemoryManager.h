@@ -39,7 +39,13 @@ class SectionMemoryManager : public RTDyldMemoryManager {
   void operator=(const SectionMemoryManager&) = delete;
 
 public:
-  SectionMemoryManager() { }
+  /// \brief Create a memory manager.
+  ///
+  /// If \p SlabSize is non-zero, memory is requested from the system in
+  /// blocks of at least that many bytes, and later sections (including those
+  /// of later objects) are packed into the unused part of earlier blocks. This
+  /// reduces the number of mappings for JITs that load many small objects.
+  explicit SectionMemoryManager(uintptr_t SlabSize = 0) : SlabSize(SlabSize) {}
   ~SectionMemoryManager() override;
 
   /// \brief Allocates a memory block of (at least) the given size suitable for
@@ -113,6 +119,7 @@ private:
   std::error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                               unsigned Permissions);
 
+  uintptr_t SlabSize;
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
@@ -16,6 +16,7 @@
 #define LLVM_IR_DIAGNOSTICINFO_H
 
 #include "llvm-c/Types.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
@@ -385,8 +386,12 @@ public:
   struct Argument {
     StringRef Key;
     std::string Val;
+    // If set, the debug location corresponding to the value.
+    DebugLoc DLoc;
 
     explicit Argument(StringRef Str = "") : Key("String"), Val(Str) {}
+    Argument(StringRef Key, StringRef S) : Key(Key), Val(S) {}
+    Argument(StringRef Key, const char *S) : Key(Key), Val(S) {}
     Argument(StringRef Key, Value *V);
     Argument(StringRef Key, int N);
     Argument(StringRef Key, unsigned N);
@@ -459,6 +464,8 @@ public:
   virtual bool isEnabled() const = 0;
 
   StringRef getPassName() const { return PassName; }
+  StringRef getRemarkName() const { return RemarkName; }
+  ArrayRef<Argument> getArgs() const { return Args; }
   std::string getMsg() const;
   Optional<uint64_t> getHotness() const { return Hotness; }
   void setHotness(Optional<uint64_t> H) { Hotness = H; }
@@ -37,6 +37,9 @@ class OptBisect;
 namespace yaml {
 class Output;
 }
+namespace remarks {
+class BinaryRemarkWriter;
+}
 
 /// This is an important class for using LLVM in a threaded context.  It
 /// (opaquely) owns and manages the core "global" data of LLVM's core
@@ -196,6 +199,14 @@ public:
   /// set, the handler is invoked for each diagnostic message.
   void setDiagnosticsOutputFile(yaml::Output *F);
 
+  /// \brief Return the writer used to save optimization diagnostics in the
+  /// binary remark format, or null.
+  remarks::BinaryRemarkWriter *getDiagnosticsBinaryOutput();
+  /// Set the writer used to save optimization diagnostics in the binary
+  /// remark format, taking ownership of it. This works like
+  /// setDiagnosticsOutputFile, and both may be set at once.
+  void setDiagnosticsBinaryOutput(remarks::BinaryRemarkWriter *W);
+
   /// \brief Get the prefix that should be printed in front of a diagnostic of
   ///        the given \p Severity
   static const char *getDiagnosticMessagePrefix(DiagnosticSeverity Severity);
@@ -52,8 +52,11 @@ protected:
   enum StorageType { Uniqued, Distinct, Temporary };
 
   /// \brief Storage flag for non-uniqued, otherwise unowned, metadata.
-  unsigned char Storage;
-  // TODO: expose remaining bits to subclasses.
+  unsigned char Storage : 7;
+
+  /// \brief Whether this node lives in its context's metadata slab, in which
+  /// case its memory is only released along with the context.
+  unsigned char IsSlabAllocated : 1;
 
   unsigned short SubclassData16;
   unsigned SubclassData32;
@@ -66,7 +69,8 @@ public:
 
 protected:
   Metadata(unsigned ID, StorageType Storage)
-      : SubclassID(ID), Storage(Storage), SubclassData16(0), SubclassData32(0) {
+      : SubclassID(ID), Storage(Storage), IsSlabAllocated(false),
+        SubclassData16(0), SubclassData32(0) {
     static_assert(sizeof(*this) == 8, "Metdata fields poorly packed");
   }
   ~Metadata() = default;
@@ -822,6 +826,17 @@ protected:
   void *operator new(size_t Size, unsigned NumOps);
   void operator delete(void *Mem);
 
+  /// \brief Allocate a node from the metadata slab of \p Context.
+  ///
+  /// This avoids a heap allocation per node for long-lived, numerous nodes.
+  /// The caller must set IsSlabAllocated on the constructed node.
+  void *operator new(size_t Size, unsigned NumOps, LLVMContext &Context);
+
+  /// \brief Required by std, but never called.
+  void operator delete(void *, unsigned, LLVMContext &) {
+    llvm_unreachable("Constructor throws?");
+  }
+
   /// \brief Required by std, but never called.
   void operator delete(void *, unsigned) {
     llvm_unreachable("Constructor throws?");
@@ -25,6 +25,9 @@
 #include "llvm/IR/Module.h"
 
 #include <array>
+#include <map>
+#include <set>
+#include <string>
 
 namespace llvm {
 
@@ -252,6 +255,12 @@ private:
   /// List of <CalleeValueInfo, CalleeInfo> call edge pairs from this function.
   std::vector<EdgeTy> CallGraphEdgeList;
 
+  /// Number of references at the end of the reference list to global
+  /// variables that this function only loads from, followed by the number of
+  /// those it only stores to.
+  unsigned ReadOnlyRefCount = 0;
+  unsigned WriteOnlyRefCount = 0;
+
 public:
   /// Summary constructors.
   FunctionSummary(GVFlags Flags, unsigned NumInsts)
@@ -297,6 +306,18 @@ public:
   /// Return the list of <CalleeValueInfo, CalleeInfo> pairs.
   std::vector<EdgeTy> &calls() { return CallGraphEdgeList; }
   const std::vector<EdgeTy> &calls() const { return CallGraphEdgeList; }
+
+  /// Record that the last \p ReadOnly + \p WriteOnly references are to
+  /// global variables that this function only reads, then only writes.
+  void setRefAccessCounts(unsigned ReadOnly, unsigned WriteOnly) {
+    assert(ReadOnly + WriteOnly <= refs().size() &&
+           "More read-only and write-only references than references");
+    ReadOnlyRefCount = ReadOnly;
+    WriteOnlyRefCount = WriteOnly;
+  }
+
+  unsigned readOnlyRefCount() const { return ReadOnlyRefCount; }
+  unsigned writeOnlyRefCount() const { return WriteOnlyRefCount; }
 };
 
 /// \brief Global variable summary information to aid decisions and
@@ -306,6 +327,11 @@ public:
 /// but is a placeholder as additional info may be added to the summary
 /// for variables.
 class GlobalVarSummary : public GlobalValueSummary {
+  /// Set by the thin link when no function in the program writes to (reads
+  /// from) this variable and its address does not escape. Always false in a
+  /// per-module index.
+  bool ReadOnly = false;
+  bool WriteOnly = false;
 
 public:
   /// Summary constructors.
@@ -315,6 +341,11 @@ public:
   static bool classof(const GlobalValueSummary *GVS) {
     return GVS->getSummaryKind() == GlobalVarKind;
   }
+
+  bool isReadOnly() const { return ReadOnly; }
+  bool isWriteOnly() const { return WriteOnly; }
+  void setReadOnly(bool RO) { ReadOnly = RO; }
+  void setWriteOnly(bool WO) { WriteOnly = WO; }
 };
 
 /// 160 bits SHA1
@@ -346,6 +377,23 @@ typedef StringMap<std::pair<uint64_t, ModuleHash>> ModulePathStringTableTy;
 /// a particular module, and provide efficient access to their summary.
 typedef std::map<GlobalValue::GUID, GlobalValueSummary *> GVSummaryMapTy;
 
+/// What the vtables of one type identifier (see !type metadata) hold, as
+/// recorded by every module defining such a vtable. This lets the thin link
+/// and the backends reason about virtual calls across the whole program.
+struct TypeIdSummary {
+  /// Set if some vtable of this type could not be summarized, in which case
+  /// nothing may be assumed about any of its slots.
+  bool Unknown = false;
+
+  /// For each byte offset from the address point, the names of the functions
+  /// found there. An empty name stands for an entry that is not a function
+  /// with a stable name.
+  std::map<uint64_t, std::set<std::string>> SlotTargets;
+};
+
+/// Map of type identifier to its summary.
+typedef std::map<std::string, TypeIdSummary> TypeIdSummaryMapTy;
+
 /// Class to hold module path string table and global value map,
 /// and encapsulate methods for operating on them.
 class ModuleSummaryIndex {
@@ -357,6 +405,12 @@ private:
   /// Holds strings for combined index, mapping to the corresponding module ID.
   ModulePathStringTableTy ModulePathStringTable;
 
+  /// Map from type identifier to the contents of its vtables.
+  TypeIdSummaryMapTy TypeIdMap;
+
+  /// Whether some module has global values without a summary.
+  bool Incomplete = false;
+
 public:
   gvsummary_iterator begin() { return GlobalValueMap.begin(); }
   const_gvsummary_iterator begin() const { return GlobalValueMap.begin(); }
@@ -495,6 +549,31 @@ public:
   /// not invoke mergeFrom.
   void removeEmptySummaryEntries();
 
+  const TypeIdSummaryMapTy &typeIds() const { return TypeIdMap; }
+  TypeIdSummaryMapTy &typeIds() { return TypeIdMap; }
+
+  TypeIdSummary &getOrInsertTypeIdSummary(StringRef TypeId) {
+    return TypeIdMap[TypeId];
+  }
+
+  /// Return the name of the only function that a virtual call through slot
+  /// \p Offset of type identifier \p TypeId can reach, or an empty string if
+  /// there is not exactly one.
+  StringRef getSingleImplementation(StringRef TypeId, uint64_t Offset) const;
+
+  /// Whether some module defines global values that have no summary, e.g.
+  /// functions without a name or the whole module when it cannot be renamed.
+  /// Their references to global variables are then unknown.
+  bool isIncomplete() const { return Incomplete; }
+  void setIncomplete() { Incomplete = true; }
+
+  /// Compute the read-only and write-only attributes of every global variable
+  /// summary from the references recorded by all the summaries. Variables for
+  /// which \p IsPreserved returns true may be accessed from outside the
+  /// index, so nothing is inferred for them. Nothing is inferred at all when
+  /// the index is incomplete.
+  void propagateAttributes(function_ref<bool(GlobalValue::GUID)> IsPreserved);
+
   /// Collect for the given module the list of function it defines
   /// (GUID -> Summary).
   void collectDefinedFunctionsForModule(StringRef ModulePath,
@@ -475,10 +475,17 @@ public:
       dbgs() << "Invalidating all non-preserved analyses for: " << IR.getName()
              << "\n";
 
+    // Nothing is cached for this unit, so there is nothing to invalidate. Look
+    // the list up rather than default-constructing an entry that would only be
+    // erased again below.
+    auto RLI = AnalysisResultLists.find(&IR);
+    if (RLI == AnalysisResultLists.end())
+      return PA;
+
     // Clear all the invalidated results associated specifically with this
     // function.
     SmallVector<void *, 8> InvalidatedPassIDs;
-    AnalysisResultListT &ResultsList = AnalysisResultLists[&IR];
+    AnalysisResultListT &ResultsList = RLI->second;
     for (typename AnalysisResultListT::iterator I = ResultsList.begin(),
                                                 E = ResultsList.end();
          I != E;) {
@@ -507,7 +514,7 @@ public:
       AnalysisResults.erase(
           std::make_pair(InvalidatedPassIDs.pop_back_val(), &IR));
     if (ResultsList.empty())
-      AnalysisResultLists.erase(&IR);
+      AnalysisResultLists.erase(RLI);
 
     return PA;
   }
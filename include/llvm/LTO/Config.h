@@ -64,6 +64,18 @@ struct Config {
   /// with this triple.
   std::string DefaultTriple;
 
+  /// If this field is set, the functions of the regular LTO module are
+  /// reordered before code generation, so that hot functions which call each
+  /// other frequently according to the profile data in the module are placed
+  /// next to each other.
+  bool ProfileFunctionOrder = false;
+
+  /// If this field is set, the hot function order is also written to this
+  /// file, one symbol per line, and ProfileFunctionOrder is implied. This is
+  /// the format of the linker's --symbol-ordering-file option, which is needed
+  /// to apply the order to functions emitted into their own sections.
+  std::string SymbolOrderingFile;
+
   bool ShouldDiscardValueNames = true;
   DiagnosticHandlerFunction DiagHandler;
 
@@ -25,6 +25,7 @@
 #include "llvm/LTO/Config.h"
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/IRObjectFile.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/thread.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
@@ -307,11 +308,54 @@ ThinBackend createInProcessThinBackend(unsigned ParallelismLevel);
 /// prefix of OldPrefix; if so, it replaces that prefix with NewPrefix. It then
 /// appends ".thinlto.bc" and writes the index to that path. If
 /// ShouldEmitImportsFiles is true it also writes a list of imported files to a
-/// similar path with ".imports" appended instead.
+/// similar path with ".imports" appended instead. If WriteFlatIndex is true,
+/// the index is written in the mmap-able FlatSummaryIndex format with a
+/// ".thinlto.fsi" suffix instead of as bitcode.
 ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           std::string NewPrefix,
                                           bool ShouldEmitImportsFiles,
-                                          std::string LinkedObjectsFile);
+                                          std::string LinkedObjectsFile,
+                                          bool WriteFlatIndex = false);
+
+/// Everything a ThinLTO backend needs to compile one module: the module
+/// itself, the index pruned to the summaries it may use, its import list and
+/// the modules it imports from. A job is self-contained, so it can be
+/// serialized with writeThinBackendJob() and run in another process or on
+/// another machine with runThinBackendJob().
+struct ThinBackendJob {
+  unsigned Task = 0;
+  MemoryBufferRef Module;
+  /// Bitcode for the per-module index, as written by WriteIndexToFile().
+  StringRef Index;
+  FunctionImporter::ImportMapTy ImportList;
+  MapVector<StringRef, MemoryBufferRef> ImportedModules;
+};
+
+/// Write \p Job to \p OS in a compact binary form. The job's buffers are
+/// copied, so the result stands on its own.
+void writeThinBackendJob(const ThinBackendJob &Job, raw_ostream &OS);
+
+/// Read a job written by writeThinBackendJob(). The returned job refers into
+/// \p Buffer, which must outlive it.
+Expected<ThinBackendJob> readThinBackendJob(MemoryBufferRef Buffer);
+
+/// Run the ThinLTO backend for \p Job and write the native object to the
+/// stream returned by \p AddStream for the job's task.
+Error runThinBackendJob(Config &C, const ThinBackendJob &Job,
+                        AddStreamFn AddStream);
+
+/// A ThinBackendJobRunner executes one job somewhere else (another process, a
+/// build farm...) and returns the resulting native object. It is called
+/// concurrently from several threads.
+typedef std::function<Expected<std::unique_ptr<MemoryBuffer>>(
+    const ThinBackendJob &Job)>
+    ThinBackendJobRunner;
+
+/// This ThinBackend hands every backend job to \p Runner, keeping at most
+/// \p MaxJobsInFlight of them outstanding at once. Cache lookups happen before
+/// dispatch, so only jobs that miss the cache are handed out.
+ThinBackend createOutOfProcessThinBackend(ThinBackendJobRunner Runner,
+                                          unsigned MaxJobsInFlight);
 
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
@@ -403,6 +447,11 @@ private:
 
     bool UnnamedAddr = true;
 
+    /// True if this global is referenced by a regular object, by llvm.used or
+    /// by the regular LTO partition, so that the ThinLTO summaries do not see
+    /// every access to it.
+    bool VisibleOutsideThinLTO = false;
+
     /// This field keeps track of the partition number of this global. The
     /// regular LTO object is partition 0, while each ThinLTO object has its own
     /// partition number from 1 onwards.
@@ -112,6 +112,8 @@ public:
     int PruningInterval = 1200;          // seconds, -1 to disable pruning.
     unsigned int Expiration = 7 * 24 * 3600;     // seconds (1w default).
     unsigned MaxPercentageOfAvailableSpace = 75; // percentage.
+    bool CacheSummaries = false; // Also cache per-module summary indexes.
+    bool CacheCodeGen = false;   // Also cache objects by optimized module.
   };
 
   /// Provide a path to a directory where to store the cached files for
@@ -150,6 +152,19 @@ public:
       CacheOptions.MaxPercentageOfAvailableSpace = Percentage;
   }
 
+  /// Cache policy: also store the summary index of every input module in the
+  /// cache, keyed on the content of the module. On a subsequent thin-link, an
+  /// unchanged module costs a mapping of the cached summary instead of a parse
+  /// of its bitcode.
+  void setCacheSummaries(bool Enable) { CacheOptions.CacheSummaries = Enable; }
+
+  /// Cache policy: also store every object file in the cache keyed on the
+  /// content of the module after importing and optimization. A module whose
+  /// cache entry was invalidated (for instance because a module it imports
+  /// from changed) then skips code generation if the optimized result is
+  /// unchanged.
+  void setCacheCodeGen(bool Enable) { CacheOptions.CacheCodeGen = Enable; }
+
   /**@}*/
 
   /// Set the path to a directory where to save temporaries at various stages of
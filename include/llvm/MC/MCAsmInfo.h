@@ -363,6 +363,10 @@ protected:
   /// Compress DWARF debug sections. Defaults to no compression.
   DebugCompressionType CompressDebugSections;
 
+  /// The number of threads large debug sections may be compressed on.
+  /// Defaults to 1.
+  unsigned CompressDebugSectionsThreads;
+
   /// True if the integrated assembler should interpret 'a >> b' constant
   /// expressions as logical rather than arithmetic.
   bool UseLogicalShr;
@@ -594,6 +598,14 @@ public:
     this->CompressDebugSections = CompressDebugSections;
   }
 
+  unsigned compressDebugSectionsThreads() const {
+    return CompressDebugSectionsThreads;
+  }
+
+  void setCompressDebugSectionsThreads(unsigned Threads) {
+    CompressDebugSectionsThreads = Threads;
+  }
+
   bool shouldUseLogicalShr() const { return UseLogicalShr; }
 
   bool canRelaxRelocations() const { return RelaxELFRelocations; }
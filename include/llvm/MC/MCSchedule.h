@@ -123,6 +123,15 @@ struct MCSchedClassDesc {
   }
 };
 
+/// Describe one level of the data cache hierarchy. Sizes are in bytes and
+/// Latency is the load-to-use latency in cycles on a hit in this level.
+struct MCCacheLevel {
+  unsigned Size;
+  unsigned Associativity;
+  unsigned LineSize;
+  unsigned Latency;
+};
+
 /// Machine model for scheduling, bundling, and heuristics.
 ///
 /// The machine model directly provides basic information about the
@@ -193,6 +202,10 @@ struct MCSchedModel {
   friend class InstrItineraryData;
   const InstrItinerary *InstrItineraries;
 
+  // Data cache levels ordered from the one closest to the core outwards.
+  const MCCacheLevel *CacheLevels;
+  unsigned NumCacheLevels;
+
   unsigned getProcessorID() const { return ProcID; }
 
   /// Does this machine model include instruction-level scheduling.
@@ -223,6 +236,16 @@ struct MCSchedModel {
     return &SchedClassTable[SchedClassIdx];
   }
 
+  unsigned getNumCacheLevels() const { return NumCacheLevels; }
+
+  /// Return the data cache at \p Level, where level 0 is the L1 data cache,
+  /// or nullptr if the model does not describe that level.
+  const MCCacheLevel *getCacheLevel(unsigned Level) const {
+    if (Level >= NumCacheLevels)
+      return nullptr;
+    return &CacheLevels[Level];
+  }
+
   /// Returns the default initialized model.
   static const MCSchedModel &GetDefaultSchedModel() { return Default; }
   static const MCSchedModel Default;
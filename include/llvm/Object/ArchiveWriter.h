@@ -35,10 +35,13 @@ struct NewArchiveMember {
                                             bool Deterministic);
 };
 
+/// Write an archive of \p NewMembers to \p ArcName. If \p WriteSymtab is
+/// set, the members are scanned for symbols on up to \p Threads threads.
 std::pair<StringRef, std::error_code>
 writeArchive(StringRef ArcName, std::vector<NewArchiveMember> &NewMembers,
              bool WriteSymtab, object::Archive::Kind Kind, bool Deterministic,
-             bool Thin, std::unique_ptr<MemoryBuffer> OldArchiveBuf = nullptr);
+             bool Thin, std::unique_ptr<MemoryBuffer> OldArchiveBuf = nullptr,
+             unsigned Threads = 1);
 }
 
 #endif
@@ -197,6 +197,7 @@ public:
   typedef typename ELFFile<ELFT>::Elf_Rel Elf_Rel;
   typedef typename ELFFile<ELFT>::Elf_Rela Elf_Rela;
   typedef typename ELFFile<ELFT>::Elf_Dyn Elf_Dyn;
+  typedef typename ELFFile<ELFT>::Elf_Sym_Range Elf_Sym_Range;
 
 protected:
   ELFFile<ELFT> EF;
@@ -205,6 +206,17 @@ protected:
   const Elf_Shdr *DotSymtabSec = nullptr; // Symbol table section.
   ArrayRef<Elf_Word> ShndxTable;
 
+  // Section indices, contents and string tables of the two symbol tables.
+  // These are validated once by the constructor so that the per-symbol
+  // accessors don't look up and check the same sections on every call. A
+  // table that fails validation is not cached and is diagnosed on use.
+  unsigned DotDynSymIndex = 0;
+  unsigned DotSymtabIndex = 0;
+  Elf_Sym_Range DotDynSymSyms;
+  Elf_Sym_Range DotSymtabSyms;
+  StringRef DotDynSymStrTab;
+  StringRef DotSymtabStrTab;
+
   void moveSymbolNext(DataRefImpl &Symb) const override;
   Expected<StringRef> getSymbolName(DataRefImpl Symb) const override;
   Expected<uint64_t> getSymbolAddress(DataRefImpl Symb) const override;
@@ -249,7 +261,29 @@ protected:
 
   /// \brief Get the relocation section that contains \a Rel.
   const Elf_Shdr *getRelSection(DataRefImpl Rel) const {
-    return *EF.getSection(Rel.d.a);
+    // Rel.d.a is always the index of a section that exists, see
+    // section_rel_begin.
+    return &EF.sections()[Rel.d.a];
+  }
+
+  /// \brief Get the symbol table that contains \a Sym.
+  const Elf_Shdr *getSymbolTableSection(DataRefImpl Sym) const {
+    if (DotSymtabSec && Sym.d.a == DotSymtabIndex)
+      return DotSymtabSec;
+    if (DotDynSymSec && Sym.d.a == DotDynSymIndex)
+      return DotDynSymSec;
+    return *EF.getSection(Sym.d.a);
+  }
+
+  /// \brief Get the string table of the symbol table that contains \a Sym.
+  Expected<StringRef> getSymbolStringTable(DataRefImpl Sym) const;
+
+  /// \brief Get the first (null) entry of the symbol table \a SymTab.
+  const Elf_Sym *getFirstSymbol(const Elf_Shdr *SymTab,
+                                Elf_Sym_Range Cached) const {
+    if (Cached.data())
+      return Cached.begin();
+    return EF.symbols(SymTab).begin();
   }
 
   DataRefImpl toDRI(const Elf_Shdr *SymTable, unsigned SymbolNum) const {
@@ -304,6 +338,9 @@ protected:
   // have to become an enum.
   bool isDyldELFObject;
 
+  void cacheSymbolTable(const Elf_Shdr &SymTab, Elf_Sym_Range &Syms,
+                        StringRef &StrTab);
+
 public:
   ELFObjectFile(MemoryBufferRef Object, std::error_code &EC);
 
@@ -311,7 +348,7 @@ public:
   const Elf_Rela *getRela(DataRefImpl Rela) const;
 
   const Elf_Sym *getSymbol(DataRefImpl Sym) const {
-    return EF.template getEntry<Elf_Sym>(Sym.d.a, Sym.d.b);
+    return EF.template getEntry<Elf_Sym>(getSymbolTableSection(Sym), Sym.d.b);
   }
 
   const Elf_Shdr *getSection(DataRefImpl Sec) const {
@@ -361,13 +398,27 @@ void ELFObjectFile<ELFT>::moveSymbolNext(DataRefImpl &Sym) const {
   ++Sym.d.b;
 }
 
+template <class ELFT>
+Expected<StringRef>
+ELFObjectFile<ELFT>::getSymbolStringTable(DataRefImpl Sym) const {
+  if (DotSymtabSec && Sym.d.a == DotSymtabIndex && DotSymtabStrTab.data())
+    return DotSymtabStrTab;
+  if (DotDynSymSec && Sym.d.a == DotDynSymIndex && DotDynSymStrTab.data())
+    return DotDynSymStrTab;
+  ErrorOr<StringRef> StrTabOrErr =
+      EF.getStringTableForSymtab(*getSymbolTableSection(Sym));
+  if (std::error_code EC = StrTabOrErr.getError())
+    return errorCodeToError(EC);
+  return *StrTabOrErr;
+}
+
 template <class ELFT>
 Expected<StringRef> ELFObjectFile<ELFT>::getSymbolName(DataRefImpl Sym) const {
   const Elf_Sym *ESym = getSymbol(Sym);
-  const Elf_Shdr *SymTableSec = *EF.getSection(Sym.d.a);
-  const Elf_Shdr *StringTableSec = *EF.getSection(SymTableSec->sh_link);
-  StringRef SymTable = *EF.getStringTable(StringTableSec);
-  return ESym->getName(SymTable);
+  Expected<StringRef> StrTabOrErr = getSymbolStringTable(Sym);
+  if (!StrTabOrErr)
+    return StrTabOrErr.takeError();
+  return ESym->getName(*StrTabOrErr);
 }
 
 template <class ELFT>
@@ -409,7 +460,7 @@ ELFObjectFile<ELFT>::getSymbolAddress(DataRefImpl Symb) const {
   }
 
   const Elf_Ehdr *Header = EF.getHeader();
-  const Elf_Shdr *SymTab = *EF.getSection(Symb.d.a);
+  const Elf_Shdr *SymTab = getSymbolTableSection(Symb);
 
   if (Header->e_type == ELF::ET_REL) {
     ErrorOr<const Elf_Shdr *> SectionOrErr =
@@ -496,8 +547,8 @@ uint32_t ELFObjectFile<ELFT>::getSymbolFlags(DataRefImpl Sym) const {
     Result |= SymbolRef::SF_Absolute;
 
   if (ESym->getType() == ELF::STT_FILE || ESym->getType() == ELF::STT_SECTION ||
-      ESym == EF.symbols(DotSymtabSec).begin() ||
-      ESym == EF.symbols(DotDynSymSec).begin())
+      ESym == getFirstSymbol(DotSymtabSec, DotSymtabSyms) ||
+      ESym == getFirstSymbol(DotDynSymSec, DotDynSymSyms))
     Result |= SymbolRef::SF_FormatSpecific;
 
   if (EF.getHeader()->e_machine == ELF::EM_ARM) {
@@ -550,7 +601,7 @@ template <class ELFT>
 Expected<section_iterator>
 ELFObjectFile<ELFT>::getSymbolSection(DataRefImpl Symb) const {
   const Elf_Sym *Sym = getSymbol(Symb);
-  const Elf_Shdr *SymTab = *EF.getSection(Symb.d.a);
+  const Elf_Shdr *SymTab = getSymbolTableSection(Symb);
   return getSymbolSection(Sym, SymTab);
 }
 
@@ -737,15 +788,17 @@ ELFObjectFile<ELFT>::getRelocationAddend(DataRefImpl Rel) const {
 template <class ELFT>
 const typename ELFObjectFile<ELFT>::Elf_Rel *
 ELFObjectFile<ELFT>::getRel(DataRefImpl Rel) const {
-  assert(getRelSection(Rel)->sh_type == ELF::SHT_REL);
-  return EF.template getEntry<Elf_Rel>(Rel.d.a, Rel.d.b);
+  const Elf_Shdr *RelSec = getRelSection(Rel);
+  assert(RelSec->sh_type == ELF::SHT_REL);
+  return EF.template getEntry<Elf_Rel>(RelSec, Rel.d.b);
 }
 
 template <class ELFT>
 const typename ELFObjectFile<ELFT>::Elf_Rela *
 ELFObjectFile<ELFT>::getRela(DataRefImpl Rela) const {
-  assert(getRelSection(Rela)->sh_type == ELF::SHT_RELA);
-  return EF.template getEntry<Elf_Rela>(Rela.d.a, Rela.d.b);
+  const Elf_Shdr *RelSec = getRelSection(Rela);
+  assert(RelSec->sh_type == ELF::SHT_RELA);
+  return EF.template getEntry<Elf_Rela>(RelSec, Rela.d.b);
 }
 
 template <class ELFT>
@@ -765,6 +818,8 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, std::error_code &EC)
         return;
       }
       DotDynSymSec = &Sec;
+      DotDynSymIndex = &Sec - EF.section_begin();
+      cacheSymbolTable(Sec, DotDynSymSyms, DotDynSymStrTab);
       break;
     }
     case ELF::SHT_SYMTAB: {
@@ -774,6 +829,8 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, std::error_code &EC)
         return;
       }
       DotSymtabSec = &Sec;
+      DotSymtabIndex = &Sec - EF.section_begin();
+      cacheSymbolTable(Sec, DotSymtabSyms, DotSymtabStrTab);
       break;
     }
     case ELF::SHT_SYMTAB_SHNDX: {
@@ -787,6 +844,18 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBufferRef Object, std::error_code &EC)
   }
 }
 
+template <class ELFT>
+void ELFObjectFile<ELFT>::cacheSymbolTable(const Elf_Shdr &SymTab,
+                                           Elf_Sym_Range &Syms,
+                                           StringRef &StrTab) {
+  auto SymsOrErr = EF.template getSectionContentsAsArray<Elf_Sym>(&SymTab);
+  if (SymsOrErr)
+    Syms = *SymsOrErr;
+  ErrorOr<StringRef> StrTabOrErr = EF.getStringTableForSymtab(SymTab);
+  if (StrTabOrErr)
+    StrTab = *StrTabOrErr;
+}
+
 template <class ELFT>
 basic_symbol_iterator ELFObjectFile<ELFT>::symbol_begin_impl() const {
   DataRefImpl Sym = toDRI(DotSymtabSec, 0);
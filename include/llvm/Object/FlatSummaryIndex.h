@@ -0,0 +1,164 @@
+//===- FlatSummaryIndex.h - Flat, mmap-able summary index -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares FlatSummaryIndex, a read-only view of a module summary
+// index stored in an offset-based binary format. Unlike the bitcode form, the
+// flat form needs no deserialization: a backend can map the file and look
+// summaries up by GUID in place. The writer can emit either a whole combined
+// index or the per-backend slice produced by gatherImportedSummariesForModule.
+//
+// The file is a header followed by five tables, all little endian:
+//
+//   modules   [NumModules]   id, path (string table offset/size), hash
+//   summaries [NumSummaries] sorted by (GUID, module); see SummaryEntry
+//   refs      [NumRefs]      referenced GUIDs
+//   calls     [NumCalls]     callee GUID and hotness
+//   strings   [StringTableSize bytes]
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_FLATSUMMARYINDEX_H
+#define LLVM_OBJECT_FLATSUMMARYINDEX_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/ModuleSummaryIndex.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <map>
+
+namespace llvm {
+class raw_ostream;
+
+namespace object {
+
+namespace flat_summary {
+const char Magic[8] = {'L', 'L', 'V', 'M', 'F', 'S', 'I', 0};
+const uint32_t Version = 1;
+
+struct Header {
+  char Magic[8];
+  support::ulittle32_t Version;
+  support::ulittle32_t NumModules;
+  support::ulittle32_t NumSummaries;
+  support::ulittle32_t NumRefs;
+  support::ulittle32_t NumCalls;
+  support::ulittle32_t StringTableSize;
+};
+
+struct ModuleEntry {
+  support::ulittle64_t Id;
+  support::ulittle32_t PathOffset;
+  support::ulittle32_t PathSize;
+  support::ulittle32_t Hash[5];
+};
+
+struct SummaryEntry {
+  support::ulittle64_t GUID;
+  support::ulittle64_t OriginalName;
+  support::ulittle32_t Module;
+  uint8_t Kind;    // GlobalValueSummary::SummaryKind
+  uint8_t Linkage; // GlobalValue::LinkageTypes
+  uint8_t Flags;   // SummaryFlags
+  uint8_t Reserved;
+  support::ulittle32_t InstCount;
+  support::ulittle32_t FirstRef;
+  support::ulittle32_t NumRefs;
+  support::ulittle32_t FirstCall;
+  support::ulittle32_t NumCalls;
+  /// Index of the aliasee in the summary table, for aliases.
+  support::ulittle32_t Aliasee;
+};
+
+enum SummaryFlags : uint8_t {
+  FlagHasSection = 1 << 0,
+  FlagNotViableToInline = 1 << 1,
+  // Computed by the thin link, for global variables only.
+  FlagReadOnly = 1 << 2,
+  FlagWriteOnly = 1 << 3,
+};
+
+struct CallEntry {
+  support::ulittle64_t Callee;
+  uint8_t Hotness; // CalleeInfo::HotnessType
+};
+} // end namespace flat_summary
+
+class FlatSummaryIndex {
+  std::unique_ptr<MemoryBuffer> Owned;
+  MemoryBufferRef Buffer;
+  const flat_summary::Header *Hdr = nullptr;
+  ArrayRef<flat_summary::ModuleEntry> Modules;
+  ArrayRef<flat_summary::SummaryEntry> Summaries;
+  ArrayRef<support::ulittle64_t> Refs;
+  ArrayRef<flat_summary::CallEntry> Calls;
+  StringRef Strings;
+
+  explicit FlatSummaryIndex(MemoryBufferRef Buffer) : Buffer(Buffer) {}
+  Error parse();
+
+public:
+  /// Return true if \p Buffer starts with the flat summary index magic.
+  static bool isFlatSummaryIndex(MemoryBufferRef Buffer);
+
+  /// Create a view of \p Buffer, which must outlive the returned object.
+  /// Only the table bounds are validated; nothing is copied.
+  static Expected<std::unique_ptr<FlatSummaryIndex>>
+  create(MemoryBufferRef Buffer);
+
+  /// Map \p Path and create a view of it.
+  static Expected<std::unique_ptr<FlatSummaryIndex>>
+  createFromFile(StringRef Path);
+
+  /// Write \p Index in the flat format. If \p ModuleToSummariesForIndex is
+  /// non-null, only the summaries it lists are written, along with the modules
+  /// that define them, exactly like WriteIndexToFile().
+  static void write(const ModuleSummaryIndex &Index, raw_ostream &OS,
+                    const std::map<std::string, GVSummaryMapTy>
+                        *ModuleToSummariesForIndex = nullptr);
+
+  unsigned getNumModules() const { return Modules.size(); }
+  StringRef getModulePath(unsigned Module) const;
+  uint64_t getModuleId(unsigned Module) const { return Modules[Module].Id; }
+  ModuleHash getModuleHash(unsigned Module) const;
+
+  ArrayRef<flat_summary::SummaryEntry> summaries() const { return Summaries; }
+
+  /// Return the summaries for \p GUID, one per defining module, in module
+  /// order. This is a binary search over the mapped table.
+  ArrayRef<flat_summary::SummaryEntry>
+  findSummaries(GlobalValue::GUID GUID) const;
+
+  /// Return the summary for \p GUID defined in \p ModulePath, or null.
+  const flat_summary::SummaryEntry *
+  findSummaryInModule(GlobalValue::GUID GUID, StringRef ModulePath) const;
+
+  ArrayRef<support::ulittle64_t>
+  refs(const flat_summary::SummaryEntry &S) const {
+    return Refs.slice(S.FirstRef, S.NumRefs);
+  }
+  ArrayRef<flat_summary::CallEntry>
+  calls(const flat_summary::SummaryEntry &S) const {
+    return Calls.slice(S.FirstCall, S.NumCalls);
+  }
+  const flat_summary::SummaryEntry &
+  getAliasee(const flat_summary::SummaryEntry &S) const {
+    assert(S.Kind == GlobalValueSummary::AliasKind && "Not an alias");
+    return Summaries[S.Aliasee];
+  }
+
+  /// Build an in-memory ModuleSummaryIndex from this view, for clients that
+  /// need the full data structure.
+  std::unique_ptr<ModuleSummaryIndex> materialize() const;
+};
+
+} // end namespace object
+} // end namespace llvm
+
+#endif
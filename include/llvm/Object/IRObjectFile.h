@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_IROBJECTFILE_H
 #define LLVM_OBJECT_IROBJECTFILE_H
 
+#include "llvm/IR/GlobalValue.h"
 #include "llvm/Object/SymbolicFile.h"
 
 namespace llvm {
@@ -25,6 +26,16 @@ class Triple;
 namespace object {
 class ObjectFile;
 
+/// A symbol of an IR object file, with the properties a linker needs for
+/// symbol resolution. See IRObjectFile::readLinkerSymbols().
+struct IRSymbol {
+  std::string Name;
+  uint32_t Flags;
+  GlobalValue::VisibilityTypes Visibility;
+  bool CanOmitFromDynSym;
+  std::string Comdat;
+};
+
 class IRObjectFile : public SymbolicFile {
   std::unique_ptr<Module> M;
   std::unique_ptr<Mangler> Mang;
@@ -77,6 +88,17 @@ public:
 
   static ErrorOr<std::unique_ptr<IRObjectFile>> create(MemoryBufferRef Object,
                                                        LLVMContext &Context);
+
+  /// Read the global, non format-specific symbols of the IR in \p Object, in
+  /// symbol table order, from the bitcode module-level records alone. This is
+  /// the list of symbols lto::InputFile gives, without the cost of creating a
+  /// Module. Fails when the symbols cannot be known without a Module: when
+  /// there is module inline asm, when names need Microsoft calling convention
+  /// mangling, for unnamed symbols, and for aliases of constant expressions.
+  /// The source file name the Module would have is stored in
+  /// \p SourceFileName.
+  static ErrorOr<std::vector<IRSymbol>>
+  readLinkerSymbols(MemoryBufferRef Object, std::string &SourceFileName);
 };
 }
 }
@@ -95,7 +95,8 @@ public:
 }
 
 /// Parse the module summary index out of an IR file and return the module
-/// summary index object if found, or nullptr if not.
+/// summary index object if found, or nullptr if not. Flat summary index files
+/// (see FlatSummaryIndex.h) are accepted as well.
 ErrorOr<std::unique_ptr<ModuleSummaryIndex>> getModuleSummaryIndexForFile(
     StringRef Path, const DiagnosticHandlerFunction &DiagnosticHandler);
 }
@@ -22,7 +22,9 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/PassInfo.h"
 #include "llvm/Support/CBindingWrapping.h"
-#include "llvm/Support/RWMutex.h"
+#include "llvm/Support/Mutex.h"
+#include <atomic>
+#include <memory>
 #include <vector>
 
 namespace llvm {
@@ -34,24 +36,35 @@ struct PassRegistrationListener;
 /// PassRegistry - This class manages the registration and intitialization of
 /// the pass subsystem as application startup, and assists the PassManager
 /// in resolving pass dependencies.
-/// NOTE: PassRegistry is NOT thread-safe.  If you want to use LLVM on multiple
-/// threads simultaneously, you will need to use a separate PassRegistry on
-/// each thread.
+/// Registration is serialized by a lock, while getPassInfo never blocks, so
+/// passes can be looked up from several threads while others register.
 class PassRegistry {
-  mutable sys::SmartRWMutex<true> Lock;
+  /// Lock - Serializes registration. Lookups do not take it.
+  sys::SmartMutex<true> Lock;
 
-  /// PassInfoMap - Keep track of the PassInfo object for each registered pass.
-  typedef DenseMap<const void *, const PassInfo *> MapType;
-  MapType PassInfoMap;
+  /// Passes - Every registered PassInfo, in registration order.
+  std::vector<const PassInfo *> Passes;
 
-  typedef StringMap<const PassInfo *> StringMapType;
-  StringMapType PassInfoStringMap;
+  /// Open-addressed hash tables of the registered passes, indexed by type
+  /// identifier and by argument string. Entries are only ever added, and a
+  /// full table is replaced by a bigger copy rather than resized in place, so
+  /// lookups can read them without taking Lock.
+  struct LookupTable;
+  std::atomic<LookupTable *> IDTable;
+  std::atomic<LookupTable *> ArgTable;
+
+  /// Tables owned by the registry, including the replaced ones, which
+  /// concurrent lookups may still be reading.
+  std::vector<std::unique_ptr<LookupTable>> Tables;
+
+  void insertIntoTable(std::atomic<LookupTable *> &Table, const PassInfo &PI,
+                       bool ByArg);
 
   std::vector<std::unique_ptr<const PassInfo>> ToFree;
   std::vector<PassRegistrationListener *> Listeners;
 
 public:
-  PassRegistry() {}
+  PassRegistry();
   ~PassRegistry();
 
   /// getPassRegistry - Access the global registry object, which is
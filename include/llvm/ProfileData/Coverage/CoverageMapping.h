@@ -422,6 +422,9 @@ public:
 class CoverageMapping {
   StringSet<> FunctionNames;
   std::vector<FunctionRecord> Functions;
+  /// Indices into Functions of the records that mention each filename, so
+  /// per-file queries don't have to scan every function.
+  StringMap<std::vector<unsigned>> FilenameRecordIndices;
   unsigned MismatchedFunctionCount;
 
   CoverageMapping() : MismatchedFunctionCount(0) {}
@@ -433,6 +436,9 @@ class CoverageMapping {
   Error loadFunctionRecord(const CoverageMappingRecord &Record,
                            IndexedInstrProfReader &ProfileReader);
 
+  /// \brief Get the indices of the function records that mention \p Filename.
+  ArrayRef<unsigned> getRecordIndicesForFilename(StringRef Filename) const;
+
 public:
   /// \brief Load the coverage mapping using the given readers.
   static Expected<std::unique_ptr<CoverageMapping>>
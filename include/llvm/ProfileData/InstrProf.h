@@ -152,6 +152,12 @@ inline StringRef getInstrProfNamesRegFuncName() {
 /// has internal linkage and invoked at startup time via init_array.
 inline StringRef getInstrProfInitFuncName() { return "__llvm_profile_init"; }
 
+/// Return the name of the thread local variable that tracks the sampling
+/// period of sampled counter updates.
+inline StringRef getInstrProfSamplingVarName() {
+  return "__llvm_profile_sampling";
+}
+
 /// Return the name of the hook variable defined in profile runtime library.
 /// A reference to the variable causes the linker to link in the runtime
 /// initialization module (which defines the hook variable).
@@ -637,11 +643,14 @@ struct InstrProfRecord {
 
 private:
   std::vector<InstrProfValueSiteRecord> IndirectCallSites;
+  std::vector<InstrProfValueSiteRecord> MemOPSizes;
   const std::vector<InstrProfValueSiteRecord> &
   getValueSitesForKind(uint32_t ValueKind) const {
     switch (ValueKind) {
     case IPVK_IndirectCallTarget:
       return IndirectCallSites;
+    case IPVK_MemOPSize:
+      return MemOPSizes;
     default:
       llvm_unreachable("Unknown value kind!");
     }
@@ -268,7 +268,9 @@ public:
       : HashType(HashType), FormatVersion(FormatVersion),
         ValueProfDataEndianness(support::little) {}
 
-  typedef ArrayRef<InstrProfRecord> data_type;
+  /// The records decoded for a key live in DataBuffer until the next lookup,
+  /// so clients are free to move them out instead of copying them.
+  typedef MutableArrayRef<InstrProfRecord> data_type;
 
   typedef StringRef internal_key_type;
   typedef StringRef external_key_type;
@@ -305,11 +307,12 @@ public:
 
 struct InstrProfReaderIndexBase {
   // Read all the profile records with the same key pointed to the current
-  // iterator.
-  virtual Error getRecords(ArrayRef<InstrProfRecord> &Data) = 0;
-  // Read all the profile records with the key equal to FuncName
+  // iterator. The records stay valid until the next call to getRecords.
+  virtual Error getRecords(MutableArrayRef<InstrProfRecord> &Data) = 0;
+  // Read all the profile records with the key equal to FuncName. The records
+  // stay valid until the next call to getRecords.
   virtual Error getRecords(StringRef FuncName,
-                                     ArrayRef<InstrProfRecord> &Data) = 0;
+                           MutableArrayRef<InstrProfRecord> &Data) = 0;
   virtual void advanceToNextKey() = 0;
   virtual bool atEnd() const = 0;
   virtual void setValueProfDataEndianness(support::endianness Endianness) = 0;
@@ -336,9 +339,9 @@ public:
                        const unsigned char *const Base,
                        IndexedInstrProf::HashT HashType, uint64_t Version);
 
-  Error getRecords(ArrayRef<InstrProfRecord> &Data) override;
+  Error getRecords(MutableArrayRef<InstrProfRecord> &Data) override;
   Error getRecords(StringRef FuncName,
-                   ArrayRef<InstrProfRecord> &Data) override;
+                   MutableArrayRef<InstrProfRecord> &Data) override;
   void advanceToNextKey() override { RecordIterator++; }
   bool atEnd() const override {
     return RecordIterator == HashTable->data_end();
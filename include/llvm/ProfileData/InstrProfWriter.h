@@ -47,7 +47,9 @@ public:
   /// for this function and the hash and number of counts match, each counter is
   /// summed. Optionally scale counts by \p Weight.
   Error addRecord(InstrProfRecord &&I, uint64_t Weight = 1);
-  /// Merge existing function counts from the given writer.
+  /// Merge existing function counts from the given writer. The records are
+  /// released from \p IPW as they are merged, so that the peak memory of a
+  /// merge does not hold both copies of the data.
   Error mergeRecordsFromWriter(InstrProfWriter &&IPW);
   /// Write the profile to \c OS
   void write(raw_fd_ostream &OS);
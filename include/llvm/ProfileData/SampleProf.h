@@ -74,7 +74,7 @@ static inline uint64_t SPMagic() {
          uint64_t('2') << (64 - 56) | uint64_t(0xff);
 }
 
-static inline uint64_t SPVersion() { return 103; }
+static inline uint64_t SPVersion() { return 104; }
 
 /// Represents the relative location of an instruction.
 ///
@@ -160,6 +160,10 @@
 //        A NUL-separated list of SIZE strings.
 //
 // FUNCTION BODY (one for each uninlined function body present in the profile)
+//    SIZE (uint64_t) [only for top-level functions, since version 104]
+//        Number of bytes in the rest of this function body. This lets
+//        readers skip the profiles of functions they do not need without
+//        decoding them.
 //    HEAD_SAMPLES (uint64_t) [only for top-level functions]
 //        Total number of samples collected at the head (prologue) of the
 //        function.
@@ -210,6 +214,7 @@
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Function.h"
@@ -281,6 +286,13 @@ public:
   /// \brief Return all the profiles.
   StringMap<FunctionSamples> &getProfiles() { return Profiles; }
 
+  /// \brief Only read the profiles of the functions defined in \p M.
+  ///
+  /// This must be called before read(). Readers whose format allows it skip
+  /// the profiles of all the other functions without decoding them. Other
+  /// readers still read the whole profile.
+  void collectFuncsToUse(const Module &M);
+
   /// \brief Report a parse error message.
   void reportError(int64_t LineNumber, Twine Msg) const {
     Ctx.diagnose(DiagnosticInfoSampleProfile(Buffer->getBufferIdentifier(),
@@ -315,6 +327,13 @@ protected:
   /// \brief Profile summary information.
   std::unique_ptr<ProfileSummary> Summary;
 
+  /// \brief Names of the functions whose profiles are needed, unless
+  /// UseAllFuncs is set.
+  StringSet<> FuncsToUse;
+
+  /// \brief True if the profiles of all the functions are needed.
+  bool UseAllFuncs = true;
+
   /// \brief Compute summary for this profile.
   void computeSummary();
 };
@@ -380,6 +399,9 @@ protected:
   /// \brief Points to the end of the buffer.
   const uint8_t *End;
 
+  /// \brief Format version of the profile.
+  uint64_t Version = 0;
+
   /// Function name table.
   std::vector<StringRef> NameTable;
 
@@ -0,0 +1,157 @@
+//===- llvm/Support/BinaryRemarks.h - Binary remarks ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a compact binary encoding of optimization remarks, the
+// records that -pass-remarks-output otherwise writes as YAML, together with a
+// writer and a reader for it.
+//
+// A remark file is a sequence of self-contained blocks:
+//
+//   block   ::= "RMRK" version:uleb size:uleb payload[size]
+//   payload ::= count:uleb string[count] remark*
+//   string  ::= length:uleb bytes[length]
+//   remark  ::= kind:byte pass:str name:str function:str flags:uleb
+//               [file:str line:uleb column:uleb]   if flags & HasDebugLoc
+//               [hotness:uleb]                     if flags & HasHotness
+//               count:uleb arg[count]
+//   arg     ::= key:str value:str flags:uleb
+//               [file:str line:uleb column:uleb]   if flags & HasDebugLoc
+//
+// where str is an index into the string table of the same block. Because
+// every block carries its own strings, blocks can be written as soon as they
+// fill up and blocks from several writers can share one file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_BINARYREMARKS_H
+#define LLVM_SUPPORT_BINARYREMARKS_H
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class raw_fd_ostream;
+class raw_ostream;
+
+namespace remarks {
+
+/// The kinds of remarks, in the order of their encoding.
+enum class RemarkKind : uint8_t {
+  Passed,
+  Missed,
+  Analysis,
+  AnalysisFPCommute,
+  AnalysisAliasing,
+  Failure,
+  LastKind = Failure
+};
+
+/// Return the YAML tag of \p Kind, such as "!Passed".
+StringRef getRemarkTag(RemarkKind Kind);
+
+/// One key/value argument of a remark, with the source location of the value
+/// it names, if any. File is empty if there is no location.
+struct Argument {
+  StringRef Key;
+  StringRef Val;
+  StringRef File;
+  unsigned Line = 0;
+  unsigned Column = 0;
+
+  Argument() = default;
+  Argument(StringRef Key, StringRef Val) : Key(Key), Val(Val) {}
+
+  bool operator==(const Argument &RHS) const {
+    return Key == RHS.Key && Val == RHS.Val && File == RHS.File &&
+           Line == RHS.Line && Column == RHS.Column;
+  }
+  bool operator!=(const Argument &RHS) const { return !(*this == RHS); }
+};
+
+/// One remark. The strings are owned by whoever filled it in; for a remark
+/// read by BinaryRemarkReader they point into the remark file.
+struct Remark {
+  RemarkKind Kind = RemarkKind::Analysis;
+  StringRef PassName;
+  StringRef RemarkName;
+  StringRef FunctionName;
+  /// The source location. File is empty if the remark has none.
+  StringRef File;
+  unsigned Line = 0;
+  unsigned Column = 0;
+  Optional<uint64_t> Hotness;
+  /// Key/value pairs in order. Keys, in particular "String", may repeat.
+  SmallVector<Argument, 4> Args;
+};
+
+/// Return true if \p Buffer starts with a binary remark block.
+bool isBinaryRemarkFile(StringRef Buffer);
+
+/// Encodes remarks and writes them out a block at a time.
+///
+/// A writer is not thread-safe; give each thread (or LLVMContext) its own.
+/// Writers on a raw_fd_ostream emit every block with a single
+/// raw_fd_ostream::write_atomic, so several of them can append to the same
+/// file without interleaving blocks.
+class BinaryRemarkWriter {
+public:
+  explicit BinaryRemarkWriter(raw_ostream &OS, size_t BlockSize = 1 << 16);
+  explicit BinaryRemarkWriter(raw_fd_ostream &OS, size_t BlockSize = 1 << 16);
+  /// Flushes the last block.
+  ~BinaryRemarkWriter();
+
+  BinaryRemarkWriter(const BinaryRemarkWriter &) = delete;
+  BinaryRemarkWriter &operator=(const BinaryRemarkWriter &) = delete;
+
+  void write(const Remark &R);
+
+  /// Write out the current block, if it has any remarks.
+  void flush();
+
+private:
+  unsigned getStringID(StringRef S);
+
+  raw_ostream &OS;
+  raw_fd_ostream *FD;
+  size_t BlockSize;
+
+  /// The strings of the current block, by ID.
+  StringMap<unsigned> StringIDs;
+  SmallString<1024> Strings;
+  SmallString<4096> Remarks;
+};
+
+/// Reads the remarks in a buffer holding any number of blocks.
+class BinaryRemarkReader {
+public:
+  explicit BinaryRemarkReader(StringRef Buffer) : Buffer(Buffer) {}
+
+  /// Read the next remark into \p R, whose strings stay valid as long as the
+  /// buffer does. Returns false at the end of the buffer.
+  Expected<bool> next(Remark &R);
+
+private:
+  Error startBlock();
+
+  StringRef Buffer;
+  /// What is left of the current block's remarks.
+  StringRef Block;
+  std::vector<StringRef> Strings;
+};
+
+} // end namespace remarks
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_BINARYREMARKS_H
@@ -43,6 +43,17 @@ bool isAvailable();
 Status compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                 CompressionLevel Level = DefaultCompression);
 
+/// Compress InputBuffer like compress(), but deflate it in independent chunks
+/// of ChunkSize bytes, using up to Threads threads. The chunks are joined into
+/// a single zlib stream that uncompress() reads as usual. Each chunk is primed
+/// with the 32 KiB of input in front of it, so the output is only marginally
+/// larger than compress() would produce. Inputs no larger than ChunkSize are
+/// simply passed to compress().
+Status compressChunked(StringRef InputBuffer,
+                       SmallVectorImpl<char> &CompressedBuffer,
+                       CompressionLevel Level = DefaultCompression,
+                       size_t ChunkSize = 1 << 20, unsigned Threads = 1);
+
 Status uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                   size_t &UncompressedSize);
 
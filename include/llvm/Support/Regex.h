@@ -17,9 +17,11 @@
 #ifndef LLVM_SUPPORT_REGEX_H
 #define LLVM_SUPPORT_REGEX_H
 
+#include <atomic>
 #include <string>
 
 struct llvm_regex;
+struct llvm_regdfa;
 
 namespace llvm {
   class StringRef;
@@ -50,6 +52,7 @@ namespace llvm {
     Regex &operator=(Regex regex) {
       std::swap(preg, regex.preg);
       std::swap(error, regex.error);
+      dfa = regex.dfa.exchange(dfa);
       return *this;
     }
     Regex(Regex &&regex);
@@ -71,6 +74,11 @@ namespace llvm {
     /// the first group is always the entire pattern.
     ///
     /// This returns true on a successful match.
+    ///
+    /// Unless the regex uses back references, whether there is a match is
+    /// decided by a lazily built DFA whose states are cached across calls, so
+    /// that matching takes time linear in the length of \p String. The
+    /// backtracking matcher is only run to find the groups in \p Matches.
     bool match(StringRef String, SmallVectorImpl<StringRef> *Matches = nullptr);
 
     /// sub - Return the result of replacing the first match of the regex in
@@ -96,6 +104,10 @@ namespace llvm {
   private:
     struct llvm_regex *preg;
     int error;
+    /// The DFA cache, or null if there is none. A thread matching the regex
+    /// takes it out of here for the duration of the match; other threads
+    /// matching concurrently fall back to the backtracking matcher.
+    std::atomic<llvm_regdfa *> dfa;
   };
 }
 
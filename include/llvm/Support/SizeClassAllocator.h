@@ -0,0 +1,176 @@
+//===- llvm/Support/SizeClassAllocator.h - Recycle by size -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SizeClassAllocator class template, which recycles
+// memory of any size on top of one of the allocators in Allocator.h.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_SIZECLASSALLOCATOR_H
+#define LLVM_SUPPORT_SIZECLASSALLOCATOR_H
+
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+
+namespace llvm {
+
+/// Helper for SizeClassAllocator::PrintStats.
+void PrintSizeClassStats(size_t ClassSize, size_t NumInUse, size_t NumFree);
+
+namespace detail {
+constexpr unsigned sizeClassLog2(size_t N) {
+  return N <= 1 ? 0 : 1 + sizeClassLog2(N / 2);
+}
+} // end namespace detail
+
+/// An allocator that keeps a free list for every power-of-two size class and
+/// reuses freed blocks of the same class before asking the underlying
+/// allocator for more memory.
+///
+/// This covers what Recycler does for one type and ArrayRecycler does for
+/// arrays of one type, for any mix of objects allocated through the
+/// AllocatorBase interface. Every recycled block is aligned to
+/// MaxRecycledAlign, and the smallest class is that size. Blocks larger than
+/// MaxRecycledSize are passed through to the underlying allocator, and so are
+/// requests for a stricter alignment than MaxRecycledAlign. Like the
+/// allocators it wraps, it is meant to be owned by a single thread or data
+/// structure, and does no locking.
+template <typename AllocatorT = BumpPtrAllocator,
+          size_t MaxRecycledSize = 4096, size_t MaxRecycledAlign = 16>
+class SizeClassAllocator
+    : public AllocatorBase<
+          SizeClassAllocator<AllocatorT, MaxRecycledSize, MaxRecycledAlign>> {
+  struct FreeNode {
+    FreeNode *Next;
+  };
+
+  static_assert((MaxRecycledSize & (MaxRecycledSize - 1)) == 0 &&
+                    (MaxRecycledAlign & (MaxRecycledAlign - 1)) == 0,
+                "Size classes must be powers of two");
+  static_assert(MaxRecycledAlign >= sizeof(FreeNode) &&
+                    MaxRecycledAlign >= alignof(FreeNode) &&
+                    MaxRecycledSize >= MaxRecycledAlign,
+                "Blocks must be able to hold a free list node");
+
+  static const unsigned MinClass = detail::sizeClassLog2(MaxRecycledAlign);
+  static const unsigned NumClasses =
+      detail::sizeClassLog2(MaxRecycledSize) + 1;
+
+  struct SizeClass {
+    FreeNode *FreeList = nullptr;
+    size_t NumInUse = 0;
+    size_t NumFree = 0;
+  };
+  SizeClass Classes[NumClasses];
+
+  /// Number of bytes handed out, counting recycled blocks at their full class
+  /// size, and not yet deallocated.
+  size_t BytesInUse = 0;
+
+  /// Return the size class of a block, or NumClasses if it is not recycled.
+  static unsigned getClass(size_t Size) {
+    if (Size > MaxRecycledSize)
+      return NumClasses;
+    if (Size <= MaxRecycledAlign)
+      return MinClass;
+    return Log2_64_Ceil(Size);
+  }
+
+  static size_t getClassSize(unsigned Class) { return size_t(1) << Class; }
+
+public:
+  /// The underlying allocator that fresh blocks come from.
+  AllocatorT Allocator;
+
+  SizeClassAllocator() = default;
+  SizeClassAllocator(const SizeClassAllocator &) = delete;
+  SizeClassAllocator &operator=(const SizeClassAllocator &) = delete;
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    unsigned Class = getClass(Size);
+    if (Class == NumClasses) {
+      BytesInUse += Size;
+      return Allocator.Allocate(Size, Alignment);
+    }
+
+    size_t ClassSize = getClassSize(Class);
+    SizeClass &SC = Classes[Class];
+    ++SC.NumInUse;
+    BytesInUse += ClassSize;
+    // Blocks on the free lists are only known to be aligned to
+    // MaxRecycledAlign, so an over-aligned request gets a fresh block. It is
+    // still a whole block of its class, and is recycled as one once freed.
+    if (Alignment > MaxRecycledAlign)
+      return Allocator.Allocate(ClassSize, Alignment);
+    if (FreeNode *N = SC.FreeList) {
+      SC.FreeList = N->Next;
+      --SC.NumFree;
+      return N;
+    }
+    return Allocator.Allocate(ClassSize, MaxRecycledAlign);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<SizeClassAllocator>::Allocate;
+
+  /// Return a block to its free list. \p Size must be the size it was
+  /// allocated with.
+  void Deallocate(const void *Ptr, size_t Size) {
+    unsigned Class = getClass(Size);
+    if (Class == NumClasses) {
+      BytesInUse -= Size;
+      Allocator.Deallocate(Ptr, Size);
+      return;
+    }
+
+    SizeClass &SC = Classes[Class];
+    assert(SC.NumInUse && "Deallocating more blocks than were allocated");
+    --SC.NumInUse;
+    ++SC.NumFree;
+    BytesInUse -= getClassSize(Class);
+    auto *N = reinterpret_cast<FreeNode *>(const_cast<void *>(Ptr));
+    N->Next = SC.FreeList;
+    SC.FreeList = N;
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<SizeClassAllocator>::Deallocate;
+
+  /// Forget all blocks, free or in use, and reset the underlying allocator.
+  void Reset() {
+    for (SizeClass &SC : Classes)
+      SC = SizeClass();
+    BytesInUse = 0;
+    Allocator.Reset();
+  }
+
+  size_t getBytesInUse() const { return BytesInUse; }
+
+  /// Return the number of bytes sitting on the free lists.
+  size_t getBytesFree() const {
+    size_t Bytes = 0;
+    for (unsigned Class = MinClass; Class != NumClasses; ++Class)
+      Bytes += Classes[Class].NumFree * getClassSize(Class);
+    return Bytes;
+  }
+
+  void PrintStats() const {
+    for (unsigned Class = MinClass; Class != NumClasses; ++Class)
+      if (Classes[Class].NumInUse || Classes[Class].NumFree)
+        PrintSizeClassStats(getClassSize(Class), Classes[Class].NumInUse,
+                            Classes[Class].NumFree);
+    Allocator.PrintStats();
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_SIZECLASSALLOCATOR_H
@@ -47,9 +47,14 @@ namespace llvm {
 /// threads.
 ///
 /// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// for some work to become available. Tasks are dispatched by priority, and in
+/// submission order within a priority.
 class ThreadPool {
 public:
+  /// Scheduling class of a task. Pending tasks of a higher priority are always
+  /// started before pending tasks of a lower priority.
+  enum class Priority { Low, Normal, High };
+
 #ifndef _MSC_VER
   using VoidTy = void;
   using TaskTy = std::function<void()>;
@@ -94,38 +99,66 @@ public:
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   template <typename Function>
   inline std::shared_future<VoidTy> async(Function &&F) {
+    return asyncWithPriority(Priority::Normal, std::forward<Function>(F));
+  }
+
+  /// Asynchronous submission of a task to the pool with the given priority.
+  /// The returned future can be used to wait for the task to finish and is
+  /// *non-blocking* on destruction.
+  template <typename Function>
+  inline std::shared_future<VoidTy> asyncWithPriority(Priority P,
+                                                      Function &&F) {
 #ifndef _MSC_VER
-    return asyncImpl(std::forward<Function>(F));
+    return asyncImpl(std::forward<Function>(F), P);
 #else
-    return asyncImpl([F] (VoidTy) -> VoidTy { F(); return VoidTy(); });
+    return asyncImpl([F] (VoidTy) -> VoidTy { F(); return VoidTy(); }, P);
 #endif
   }
 
   /// Blocking wait for all the threads to complete and the queue to be empty.
-  /// It is an error to try to add new tasks while blocking on this call.
+  /// It is an error to try to add new tasks while blocking on this call from
+  /// outside the pool.
+  ///
+  /// When called from a task running in the pool, the calling thread does not
+  /// block: it runs pending tasks until all the tasks that are not themselves
+  /// waiting have completed.
   void wait();
 
 private:
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<VoidTy> asyncImpl(TaskTy F);
+  std::shared_future<VoidTy> asyncImpl(TaskTy F,
+                                       Priority P = Priority::Normal);
+
+  /// Return true if a task is waiting for execution. QueueLock must be held.
+  bool hasPendingTasks() const;
+
+  /// Pop the pending task with the highest priority. QueueLock must be held.
+  PackagedTaskTy popTask();
+
+  /// Return true if the calling thread is one of the threads of this pool.
+  bool isWorkerThread() const;
 
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks waiting for execution in the pool, one queue per priority.
+  std::queue<PackagedTaskTy> Tasks[3];
 
-  /// Locking and signaling for accessing the Tasks queue.
+  /// Locking and signaling for accessing the Tasks queues and the thread
+  /// counters below.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
 
-  /// Locking and signaling for job completion
-  std::mutex CompletionLock;
+  /// Signaling for job completion, and for the submission of new tasks to
+  /// threads of the pool waiting in wait().
   std::condition_variable CompletionCondition;
 
   /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
+  unsigned ActiveThreads;
+
+  /// Number of busy threads that are running wait() from inside a task.
+  unsigned NestedWaiters;
 
 #if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
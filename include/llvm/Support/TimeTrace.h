@@ -0,0 +1,72 @@
+//===-- llvm/Support/TimeTrace.h - Trace Event Recording --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Low-overhead recording of nested begin/end events, written out in the
+/// Chrome trace event format (viewable in chrome://tracing).
+///
+/// Each thread records into its own buffer, so recording an event takes no
+/// lock; a lock is only taken the first time a thread records anything.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TIMETRACE_H
+#define LLVM_SUPPORT_TIMETRACE_H
+
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+class raw_ostream;
+
+/// Start recording trace events. Until this is called, the begin and end
+/// functions below return immediately.
+void enableTimeTrace();
+
+/// Stop recording trace events and discard those recorded so far. No thread
+/// may be recording events while this runs.
+void disableTimeTrace();
+
+/// Return true if trace events are being recorded.
+bool isTimeTraceEnabled();
+
+/// Open an event named \p Name on the calling thread. \p Detail is shown as
+/// an argument of the event, e.g. the function a pass runs on. Every call must
+/// be matched by a call to endTimeTraceEvent on the same thread.
+void beginTimeTraceEvent(StringRef Name, StringRef Detail = StringRef());
+
+/// Close the innermost event opened on the calling thread.
+void endTimeTraceEvent();
+
+/// Write the events completed so far on all threads to \p OS as Chrome trace
+/// JSON. No thread may be recording events while this runs.
+void writeTimeTrace(raw_ostream &OS);
+
+/// RAII helper that records one event for the duration of a scope.
+class TimeTraceScope {
+  bool Active;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+      : Active(isTimeTraceEnabled()) {
+    if (Active)
+      beginTimeTraceEvent(Name, Detail);
+  }
+  ~TimeTraceScope() {
+    if (Active)
+      endTimeTraceEvent();
+  }
+
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  TimeTraceScope &operator=(const TimeTraceScope &) = delete;
+};
+
+} // end namespace llvm
+
+#endif
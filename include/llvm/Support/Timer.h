@@ -24,12 +24,28 @@ class TimerGroup;
 class raw_ostream;
 
 class TimeRecord {
+public:
+  /// The hardware performance counters recorded with -track-hw-counters.
+  enum HWCounter {
+    HW_Cycles,
+    HW_Instructions,
+    HW_CacheMisses,
+    HW_BranchMisses,
+    NumHWCounters
+  };
+
+private:
   double WallTime;       ///< Wall clock time elapsed in seconds.
   double UserTime;       ///< User time elapsed.
   double SystemTime;     ///< System time elapsed.
   ssize_t MemUsed;       ///< Memory allocated (in bytes).
+  /// Hardware counter values, or zero if they are not tracked or the host
+  /// can't provide them.
+  int64_t HWCounts[NumHWCounters];
+
 public:
-  TimeRecord() : WallTime(0), UserTime(0), SystemTime(0), MemUsed(0) {}
+  TimeRecord()
+      : WallTime(0), UserTime(0), SystemTime(0), MemUsed(0), HWCounts() {}
 
   /// Get the current time and memory usage.  If Start is true we get the memory
   /// usage before the time, otherwise we get time before memory usage.  This
@@ -42,6 +58,7 @@ public:
   double getSystemTime() const { return SystemTime; }
   double getWallTime() const { return WallTime; }
   ssize_t getMemUsed() const { return MemUsed; }
+  int64_t getHWCount(HWCounter C) const { return HWCounts[C]; }
 
   bool operator<(const TimeRecord &T) const {
     // Sort by Wall Time elapsed, as it is the only thing really accurate
@@ -53,12 +70,16 @@ public:
     UserTime   += RHS.UserTime;
     SystemTime += RHS.SystemTime;
     MemUsed    += RHS.MemUsed;
+    for (unsigned I = 0; I != NumHWCounters; ++I)
+      HWCounts[I] += RHS.HWCounts[I];
   }
   void operator-=(const TimeRecord &RHS) {
     WallTime   -= RHS.WallTime;
     UserTime   -= RHS.UserTime;
     SystemTime -= RHS.SystemTime;
     MemUsed    -= RHS.MemUsed;
+    for (unsigned I = 0; I != NumHWCounters; ++I)
+      HWCounts[I] -= RHS.HWCounts[I];
   }
 
   /// Print the current time record to \p OS, with a breakdown showing
@@ -178,9 +199,17 @@ public:
 
   void setName(StringRef name) { Name.assign(name.begin(), name.end()); }
 
-  /// Print any started timers in this group and zero them.
+  /// Print any started timers in this group and zero them. With -timers-json,
+  /// this is the same as printJSON().
   void print(raw_ostream &OS);
 
+  /// Print any started timers in this group as a single line of JSON and zero
+  /// them:
+  ///   {"group":..., "timers":[{"name":..., "wall":..., "user":...,
+  ///    "sys":..., "mem":...}, ...], "total":{"wall":..., ...}}
+  /// Timers are listed in descending order of time taken.
+  void printJSON(raw_ostream &OS);
+
   /// This static method prints all timers and clears them all out.
   static void printAll(raw_ostream &OS);
 
@@ -189,6 +218,8 @@ private:
   void addTimer(Timer &T);
   void removeTimer(Timer &T);
   void PrintQueuedTimers(raw_ostream &OS);
+  void PrintQueuedTimersJSON(raw_ostream &OS);
+  void queueTriggeredTimers();
 };
 
 } // end namespace llvm
@@ -0,0 +1,58 @@
+//===-- TrigramIndex.h - a heuristic for SpecialCaseList --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// TrigramIndex implements a cheap check to rule out most strings that cannot
+// match any of a set of regular expressions, so that the regular expressions
+// only have to be run on the few that might.
+//
+// Each regular expression is reduced to the trigrams (substrings of length 3)
+// of its literal parts. A string can only match the expression if it contains
+// all of them, which is checked with an index from trigrams to expressions.
+// Only expressions made of literal characters and ".*" wildcards, which is
+// what SpecialCaseList globs turn into, can be reduced this way. If any other
+// expression is inserted, or one without a literal part of at least three
+// characters, the index is "defeated" and rules nothing out.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TRIGRAMINDEX_H
+#define LLVM_SUPPORT_TRIGRAMINDEX_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class TrigramIndex {
+public:
+  /// Inserts a new regular expression into the index.
+  void insert(StringRef Regex);
+
+  /// Returns true if \p Query cannot match any of the inserted expressions,
+  /// false if it might.
+  bool isDefinitelyOut(StringRef Query) const;
+
+  /// Returns true if the index cannot rule out any query.
+  bool isDefeated() const { return Defeated; }
+
+private:
+  /// Set when an expression the index cannot handle has been inserted.
+  bool Defeated = false;
+  /// The number of distinct trigrams of each inserted expression.
+  std::vector<unsigned> Counts;
+  /// Maps each trigram to the expressions containing it.
+  DenseMap<unsigned, SmallVector<unsigned, 4>> Index;
+};
+
+} // namespace llvm
+
+#endif // LLVM_SUPPORT_TRIGRAMINDEX_H
@@ -17,6 +17,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataTypes.h"
+#include <atomic>
 #include <system_error>
 
 namespace llvm {
@@ -347,9 +348,9 @@ class raw_fd_ostream : public raw_pwrite_stream {
 
   /// Error This flag is true if an error of any kind has been detected.
   ///
-  bool Error;
+  std::atomic<bool> Error;
 
-  uint64_t pos;
+  std::atomic<uint64_t> pos;
 
   bool SupportsSeeking;
 
@@ -398,6 +399,13 @@ public:
   /// to the offset specified from the beginning of the file.
   uint64_t seek(uint64_t off);
 
+  /// Write \p Size bytes straight to the file descriptor, bypassing the
+  /// buffer, which must be empty. This may be called from several threads at
+  /// once: each call is a single write system call where the platform allows,
+  /// so the data from concurrent calls does not interleave. See
+  /// atomic_write_ostream for a convenient way to build such records.
+  void write_atomic(const char *Ptr, size_t Size);
+
   raw_ostream &changeColor(enum Colors colors, bool bold=false,
                            bool bg=false) override;
   raw_ostream &resetColor() override;
@@ -525,6 +533,24 @@ public:
   ~buffer_ostream() override { OS << str(); }
 };
 
+/// A raw_ostream that collects a record, such as a diagnostic or a YAML
+/// document, in memory and writes it to a raw_fd_ostream with write_atomic
+/// when it is committed or destroyed. Threads sharing an output file can each
+/// stream into their own atomic_write_ostream without taking a lock, and the
+/// records come out whole.
+class atomic_write_ostream : public raw_svector_ostream {
+  raw_fd_ostream &OS;
+  SmallVector<char, 0> Buffer;
+
+public:
+  atomic_write_ostream(raw_fd_ostream &OS)
+      : raw_svector_ostream(Buffer), OS(OS) {}
+  ~atomic_write_ostream() override { commit(); }
+
+  /// Write out the record collected so far and start a new one.
+  void commit();
+};
+
 } // end llvm namespace
 
 #endif // LLVM_SUPPORT_RAW_OSTREAM_H
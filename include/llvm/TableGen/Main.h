@@ -17,12 +17,19 @@
 namespace llvm {
 
 class RecordKeeper;
+class StringRef;
 class raw_ostream;
 /// \brief Perform the action using Records, and write output to OS.
 /// \returns true on error, false otherwise
 typedef bool TableGenMainFn(raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn);
+/// \brief Make the backend named \p Name the one run by the next call to
+/// the TableGenMainFn. Used for the outputs requested with -emit.
+/// \returns true if there is no such backend, false otherwise
+typedef bool TableGenSelectFn(StringRef Name);
+
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 TableGenSelectFn *SelectFn = nullptr);
 }
 
 #endif
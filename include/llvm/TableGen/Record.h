@@ -1088,6 +1088,9 @@ public:
   }
   static FieldInit *get(Init *R, const std::string &FN);
 
+  Init *getRecord() const { return Rec; }
+  const std::string &getFieldName() const { return FieldName; }
+
   Init *getBit(unsigned Bit) const override;
 
   Init *resolveListElementReference(Record &R, const RecordVal *RV,
@@ -1183,6 +1186,8 @@ public:
 //===----------------------------------------------------------------------===//
 
 class RecordVal {
+  friend class RecordCacheReader;
+
   PointerIntPair<Init *, 1, bool> NameAndPrefix;
   RecTy *Ty;
   Init *Value;
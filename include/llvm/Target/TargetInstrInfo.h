@@ -1492,6 +1492,57 @@ public:
     return false;
   }
 
+  /// How the MachineOutliner may treat an instruction.
+  enum class MachineOutlinerInstrType {
+    /// The instruction may be moved into an outlined function.
+    Legal,
+    /// The instruction must stay in its function.
+    Illegal,
+    /// The instruction emits no code and is ignored when looking for
+    /// repeated sequences.
+    Invisible
+  };
+
+  /// Returns how the MachineOutliner may treat \p MI. The outliner has
+  /// already ruled out calls, terminators, labels and stack object references
+  /// when this is called. By default nothing is outlined.
+  virtual MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const {
+    return MachineOutlinerInstrType::Illegal;
+  }
+
+  /// Returns true if the MachineOutliner may outline instructions from \p MF.
+  virtual bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const {
+    return false;
+  }
+
+  /// Returns the number of instructions that replace an outlined sequence at
+  /// each of its call sites.
+  virtual unsigned getOutliningCallOverhead() const {
+    llvm_unreachable("Target didn't implement getOutliningCallOverhead!");
+  }
+
+  /// Returns the number of instructions an outlined function needs on top of
+  /// the outlined sequence itself.
+  virtual unsigned getOutliningFrameOverhead() const {
+    llvm_unreachable("Target didn't implement getOutliningFrameOverhead!");
+  }
+
+  /// Append the code returning from the outlined function \p MF to its
+  /// only block \p MBB.
+  virtual void insertOutlinerEpilogue(MachineBasicBlock &MBB,
+                                      MachineFunction &MF) const {
+    llvm_unreachable("Target didn't implement insertOutlinerEpilogue!");
+  }
+
+  /// Insert a call to the outlined function \p MF before \p It and return the
+  /// call instruction.
+  virtual MachineBasicBlock::iterator
+  insertOutlinedCall(MachineBasicBlock &MBB, MachineBasicBlock::iterator It,
+                     MachineFunction &MF) const {
+    llvm_unreachable("Target didn't implement insertOutlinedCall!");
+  }
+
 private:
   unsigned CallFrameSetupOpcode, CallFrameDestroyOpcode;
   unsigned CatchRetOpcode;
@@ -210,6 +210,11 @@ public:
   /// \brief Enable the use of the early if conversion pass.
   virtual bool enableEarlyIfConversion() const { return false; }
 
+  /// \brief True if the software pipeliner should model resources with the
+  /// DFA from TargetInstrInfo::CreateTargetScheduleState. Otherwise it uses
+  /// the processor resources or itineraries of the scheduling model.
+  virtual bool useDFAforSMS() const { return true; }
+
   /// \brief Return PBQPConstraint(s) for the target.
   ///
   /// Override to provide custom PBQP constraints.
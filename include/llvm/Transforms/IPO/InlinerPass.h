@@ -80,6 +80,9 @@ protected:
   AssumptionCacheTracker *ACT;
   ProfileSummaryInfo *PSI;
   ImportedFunctionsInliningStatistics ImportedFunctionsStats;
+  /// Callee summaries shared by the cost queries made while inlining a single
+  /// SCC. Only valid within one call to inlineCalls.
+  InlineCostCache CostCache;
 };
 
 } // End llvm namespace
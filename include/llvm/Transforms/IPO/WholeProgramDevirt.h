@@ -28,6 +28,7 @@ template <typename T> class ArrayRef;
 template <typename T> class MutableArrayRef;
 class Function;
 class GlobalVariable;
+class ModuleSummaryIndex;
 
 namespace wholeprogramdevirt {
 
@@ -221,6 +222,14 @@ struct WholeProgramDevirtPass : public PassInfoMixin<WholeProgramDevirtPass> {
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
 };
 
+/// Devirtualize the virtual calls in \p M using the type identifier summaries
+/// in the combined ThinLTO index \p Index. A call through a vtable slot is made
+/// direct when every vtable in the program that is compatible with the call's
+/// type identifier has the same function in that slot. As with the regular
+/// LTO pass, the llvm.assume(llvm.type.test) sequences are removed. Returns
+/// true if the module was changed.
+bool applyThinLTODevirtualization(Module &M, const ModuleSummaryIndex &Index);
+
 } // end namespace llvm
 
 #endif // LLVM_TRANSFORMS_IPO_WHOLEPROGRAMDEVIRT_H
@@ -13,6 +13,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
@@ -27,6 +28,10 @@ namespace llvm {
 class InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
   DenseMap<Instruction*, unsigned> WorklistMap;
+  /// Cleared whenever an instruction is added or removed, since that is how
+  /// the combiner reports changes to the IR. In-place changes made partway
+  /// through a visit clear it directly.
+  KnownBitsCache *KnownBits = nullptr;
 
 public:
   InstCombineWorklist() = default;
@@ -36,9 +41,13 @@ public:
 
   bool isEmpty() const { return Worklist.empty(); }
 
+  void setKnownBitsCache(KnownBitsCache *Cache) { KnownBits = Cache; }
+
   /// Add - Add the specified instruction to the worklist if it isn't already
   /// in it.
   void Add(Instruction *I) {
+    if (KnownBits)
+      KnownBits->clear();
     if (WorklistMap.insert(std::make_pair(I, Worklist.size())).second) {
       DEBUG(dbgs() << "IC: ADD: " << *I << '\n');
       Worklist.push_back(I);
@@ -67,6 +76,8 @@ public:
 
   // Remove - remove I from the worklist if it exists.
   void Remove(Instruction *I) {
+    if (KnownBits)
+      KnownBits->clear();
     DenseMap<Instruction*, unsigned>::iterator It = WorklistMap.find(I);
     if (It == WorklistMap.end()) return; // Not in worklist.
 
@@ -21,6 +21,8 @@
 
 namespace llvm {
 
+class Loop;
+
 /// Instrumentation based profiling lowering pass. This pass lowers
 /// the profile instrumented code generated by FE or the IR based
 /// instrumentation pass.
@@ -32,6 +34,14 @@ public:
   PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
   bool run(Module &M);
 
+  /// Whether counter updates are sampled. Sampling adds control flow around
+  /// each counter update.
+  bool isSamplingEnabled() const;
+
+  /// Whether counter updates in loops are promoted to registers. Promotion
+  /// puts the loops in simplified form first.
+  bool isCounterPromotionEnabled() const;
+
 private:
   InstrProfOptions Options;
   Module *M;
@@ -69,8 +79,22 @@ private:
   /// Replace instrprof_value_profile with a call to runtime library.
   void lowerValueProfileInst(InstrProfValueProfileInst *Ins);
 
+  /// Lower all the instrprof_increment intrinsics of function \p F.
+  void lowerIncrements(Function &F,
+                       ArrayRef<InstrProfIncrementInst *> Increments);
+
   /// Replace instrprof_increment with an increment of the appropriate value.
-  void lowerIncrement(InstrProfIncrementInst *Inc);
+  /// If \p Sampled is non-null the update is only done when it is true.
+  void lowerIncrement(InstrProfIncrementInst *Inc, Value *Sampled = nullptr);
+
+  /// Replace instrprof_increment in loop \p L with an update of a register
+  /// that is added to the counter on the loop exits. Return false if the
+  /// loop is not in a shape that allows this.
+  bool promoteIncrement(InstrProfIncrementInst *Inc, Loop *L);
+
+  /// Advance the sampling period at the entry of \p F and return the
+  /// condition under which the counters of \p F are updated.
+  Value *emitSamplingCheck(Function &F);
 
   /// Force emitting of name vars for unused functions.
   void lowerCoverageData(GlobalVariable *CoverageNamesVar);
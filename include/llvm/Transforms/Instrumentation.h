@@ -84,14 +84,24 @@ ModulePass *createPGOInstrumentationGenLegacyPass();
 ModulePass *
 createPGOInstrumentationUseLegacyPass(StringRef Filename = StringRef(""));
 ModulePass *createPGOIndirectCallPromotionLegacyPass(bool InLTO = false);
+FunctionPass *createPGOMemOPSizeOptLegacyPass();
 
 /// Options for the frontend instrumentation based profiling pass.
 struct InstrProfOptions {
-  InstrProfOptions() : NoRedZone(false) {}
+  InstrProfOptions()
+      : NoRedZone(false), DoCounterPromotion(false), Sampling(false) {}
 
   // Add the 'noredzone' attribute to added runtime library calls.
   bool NoRedZone;
 
+  // Keep the counter updates of a loop in a register and flush them to
+  // memory on the loop exits.
+  bool DoCounterPromotion;
+
+  // Only update the counters during short bursts of function invocations,
+  // trading accuracy for much less memory traffic on the counters.
+  bool Sampling;
+
   // Name of the profile file to use as output
   std::string InstrProfileOutput;
 };
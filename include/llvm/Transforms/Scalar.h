@@ -145,6 +145,13 @@ Pass *createLICMPass();
 //
 Pass *createLoopInterchangePass();
 
+//===----------------------------------------------------------------------===//
+//
+// LoopTiling - This pass tiles perfect loop nests to improve the reuse of
+// the data they access in the cache.
+//
+FunctionPass *createLoopTilingPass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopStrengthReduce - This pass is strength reduces GEP instructions that use
@@ -498,6 +505,12 @@ FunctionPass *createNaryReassociatePass();
 // llvm.loop.distribute.enable metadata data override this default.
 FunctionPass *createLoopDistributePass(bool ProcessAllLoopsByDefault);
 
+//===----------------------------------------------------------------------===//
+//
+// LoopFuse - Fuse adjacent loops with the same trip count.
+//
+FunctionPass *createLoopFusePass();
+
 //===----------------------------------------------------------------------===//
 //
 // LoopLoadElimination - Perform loop-aware load elimination.
@@ -26,6 +26,7 @@
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/PassManager.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 
 namespace llvm {
 
@@ -110,6 +111,11 @@ private:
   AssumptionCache *AC;
   SetVector<BasicBlock *> DeadBlocks;
 
+  /// Optional MemorySSA used to answer non-local load queries that have a
+  /// single dominating clobber without a non-local MemDep walk. It is built
+  /// by GVN itself and dropped as soon as the CFG changes.
+  std::unique_ptr<MemorySSA> MSSA;
+
   ValueTable VN;
 
   /// A mapping from value numbers to lists of Value*'s that
@@ -187,6 +193,7 @@ private:
   // Helper functions of redundant load elimination
   bool processLoad(LoadInst *L);
   bool processNonLocalLoad(LoadInst *L);
+  bool processLoadWithMemorySSA(LoadInst *L);
   bool processAssumeIntrinsic(IntrinsicInst *II);
   /// Given a local dependency (Def or Clobber) determine if a value is
   /// available for the load.  Returns true if an value is known to be
@@ -222,6 +229,7 @@ private:
   bool processFoldableCondBr(BranchInst *BI);
   void addDeadBlock(BasicBlock *BB);
   void assignValNumForDeadCode();
+  void removeFromMemorySSA(Instruction *I);
 };
 
 /// Create a legacy GVN pass. This also allows parameterizing whether or not
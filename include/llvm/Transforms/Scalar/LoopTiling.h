@@ -0,0 +1,29 @@
+//===- LoopTiling.h - Loop Tiling Pass --------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Loop Tiling Pass.  It strip-mines the inner loop
+// of perfect loop nests and moves the strip loop outward, so that the data a
+// strip accesses stays in the cache across the iterations of the outer loop.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
+#define LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
+
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class LoopTilingPass : public PassInfoMixin<LoopTilingPass> {
+public:
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+};
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_SCALAR_LOOPTILING_H
@@ -27,6 +27,13 @@ class StringRef;
 /// Splits the module M into N linkable partitions. The function ModuleCallback
 /// is called N times passing each individual partition as the MPart argument.
 ///
+/// By default, globals that can be separated are distributed by the hash of
+/// their names. If BalanceBySize is set, the partitions are instead balanced by
+/// an estimate of their code generation work, strongly connected call graph
+/// components are kept together, globals are placed near the globals they
+/// reference or are referenced by where balance allows, and the partitions are
+/// passed to ModuleCallback from the heaviest to the lightest.
+///
 /// FIXME: This function does not deal with the somewhat subtle symbol
 /// visibility issues around module splitting, including (but not limited to):
 ///
@@ -37,7 +44,7 @@ class StringRef;
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, bool BalanceBySize = false);
 
 } // End llvm namespace
 
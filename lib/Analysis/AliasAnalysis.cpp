@@ -53,7 +53,9 @@ using namespace llvm;
 static cl::opt<bool> DisableBasicAA("disable-basicaa", cl::Hidden,
                                     cl::init(false));
 
-AAResults::AAResults(AAResults &&Arg) : TLI(Arg.TLI), AAs(std::move(Arg.AAs)) {
+AAResults::AAResults(AAResults &&Arg)
+    : TLI(Arg.TLI), AAs(std::move(Arg.AAs)), BatchMode(Arg.BatchMode),
+      BatchCache(std::move(Arg.BatchCache)) {
   for (auto &AA : AAs)
     AA->setAAResults(this);
 }
@@ -75,6 +77,26 @@ AAResults::~AAResults() {
 
 AliasResult AAResults::alias(const MemoryLocation &LocA,
                              const MemoryLocation &LocB) {
+  if (!BatchMode)
+    return aliasImpl(LocA, LocB);
+
+  // Alias queries are symmetric, so canonicalize the key.
+  auto Key = std::less<const Value *>()(LocB.Ptr, LocA.Ptr)
+                 ? std::make_pair(LocB, LocA)
+                 : std::make_pair(LocA, LocB);
+  auto It = BatchCache.find(Key);
+  if (It != BatchCache.end())
+    return It->second;
+
+  ++QueryDepth;
+  AliasResult Result = aliasImpl(LocA, LocB);
+  if (--QueryDepth == 0)
+    BatchCache[Key] = Result;
+  return Result;
+}
+
+AliasResult AAResults::aliasImpl(const MemoryLocation &LocA,
+                                 const MemoryLocation &LocB) {
   for (const auto &AA : AAs) {
     auto Result = AA->alias(LocA, LocB);
     if (Result != MayAlias)
@@ -716,37 +716,31 @@ Constant *SymbolicallyEvaluateBinop(unsigned Opc, Constant *Op0, Constant *Op1,
 }
 
 /// If array indices are not pointer-sized integers, explicitly cast them so
-/// that they aren't implicitly casted by the getelementptr.
-Constant *CastGEPIndices(Type *SrcElemTy, ArrayRef<Constant *> Ops,
-                         Type *ResultTy, const DataLayout &DL,
-                         const TargetLibraryInfo *TLI) {
+/// that they aren't implicitly casted by the getelementptr. The casts are
+/// folded right away and the new operands returned in NewOps, so that no
+/// intermediate getelementptr expression has to be created. Returns false if
+/// no index needed a cast.
+bool CastGEPIndices(Type *SrcElemTy, ArrayRef<Constant *> Ops,
+                    Type *ResultTy, const DataLayout &DL,
+                    SmallVectorImpl<Constant *> &NewOps) {
   Type *IntPtrTy = DL.getIntPtrType(ResultTy);
 
   bool Any = false;
-  SmallVector<Constant*, 32> NewIdxs;
+  NewOps.push_back(Ops[0]);
   for (unsigned i = 1, e = Ops.size(); i != e; ++i) {
     if ((i == 1 ||
          !isa<StructType>(GetElementPtrInst::getIndexedType(SrcElemTy,
              Ops.slice(1, i - 1)))) &&
         Ops[i]->getType() != IntPtrTy) {
       Any = true;
-      NewIdxs.push_back(ConstantExpr::getCast(CastInst::getCastOpcode(Ops[i],
-                                                                      true,
-                                                                      IntPtrTy,
-                                                                      true),
-                                              Ops[i], IntPtrTy));
+      NewOps.push_back(ConstantFoldCastOperand(
+          CastInst::getCastOpcode(Ops[i], true, IntPtrTy, true), Ops[i],
+          IntPtrTy, DL));
     } else
-      NewIdxs.push_back(Ops[i]);
+      NewOps.push_back(Ops[i]);
   }
 
-  if (!Any)
-    return nullptr;
-
-  Constant *C = ConstantExpr::getGetElementPtr(SrcElemTy, Ops[0], NewIdxs);
-  if (Constant *Folded = ConstantFoldConstant(C, DL, TLI))
-    C = Folded;
-
-  return C;
+  return Any;
 }
 
 /// Strip the pointer casts, but preserve the address space information.
@@ -766,19 +760,14 @@ Constant* StripPtrCastKeepAS(Constant* Ptr, Type *&ElemTy) {
   return Ptr;
 }
 
-/// If we can symbolically evaluate the GEP constant expression, do so.
-Constant *SymbolicallyEvaluateGEP(const GEPOperator *GEP,
-                                  ArrayRef<Constant *> Ops,
-                                  const DataLayout &DL,
-                                  const TargetLibraryInfo *TLI) {
+/// Symbolically evaluate a GEP whose array indices are all pointer-sized.
+Constant *SymbolicallyEvaluateGEPImpl(const GEPOperator *GEP,
+                                      ArrayRef<Constant *> Ops,
+                                      const DataLayout &DL,
+                                      const TargetLibraryInfo *TLI) {
   Type *SrcElemTy = GEP->getSourceElementType();
   Type *ResElemTy = GEP->getResultElementType();
   Type *ResTy = GEP->getType();
-  if (!SrcElemTy->isSized())
-    return nullptr;
-
-  if (Constant *C = CastGEPIndices(SrcElemTy, Ops, ResTy, DL, TLI))
-    return C;
 
   Constant *Ptr = Ops[0];
   if (!Ptr->getType()->isPointerTy())
@@ -938,6 +927,28 @@ Constant *SymbolicallyEvaluateGEP(const GEPOperator *GEP,
   return C;
 }
 
+/// If we can symbolically evaluate the GEP constant expression, do so.
+Constant *SymbolicallyEvaluateGEP(const GEPOperator *GEP,
+                                  ArrayRef<Constant *> Ops,
+                                  const DataLayout &DL,
+                                  const TargetLibraryInfo *TLI) {
+  Type *SrcElemTy = GEP->getSourceElementType();
+  if (!SrcElemTy->isSized())
+    return nullptr;
+
+  SmallVector<Constant *, 8> NewOps;
+  if (!CastGEPIndices(SrcElemTy, Ops, GEP->getType(), DL, NewOps))
+    return SymbolicallyEvaluateGEPImpl(GEP, Ops, DL, TLI);
+
+  if (Constant *C = SymbolicallyEvaluateGEPImpl(GEP, NewOps, DL, TLI))
+    return C;
+
+  // Even if it cannot be simplified further, the GEP with the canonical
+  // index types is the folded form.
+  return ConstantExpr::getGetElementPtr(SrcElemTy, NewOps[0],
+                                        makeArrayRef(NewOps).slice(1));
+}
+
 /// Attempt to constant fold an instruction with the
 /// specified opcode and operands.  If successful, the constant result is
 /// returned, if not, null is returned.  Note that this function can fail when
@@ -1017,8 +1028,8 @@ ConstantFoldConstantImpl(const Constant *C, const DataLayout &DL,
       if (It == FoldedOps.end()) {
         if (auto *FoldedC =
                 ConstantFoldConstantImpl(NewC, DL, TLI, FoldedOps)) {
-          NewC = FoldedC;
           FoldedOps.insert({NewC, FoldedC});
+          NewC = FoldedC;
         } else {
           FoldedOps.insert({NewC, NewC});
         }
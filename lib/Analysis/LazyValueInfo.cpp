@@ -30,6 +30,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/PatternMatch.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -53,6 +54,11 @@ namespace llvm {
 
 char LazyValueAnalysis::PassID;
 
+static cl::opt<unsigned> MaxCacheEntries(
+    "lvi-max-cache-entries", cl::Hidden, cl::init(1u << 20),
+    cl::desc("Flush the lazy value info cache between queries once it holds "
+             "more than this many block values (0 = no limit)"));
+
 //===----------------------------------------------------------------------===//
 //                               LVILatticeVal
 //===----------------------------------------------------------------------===//
@@ -407,29 +413,44 @@ namespace {
         OverDefinedCacheTy;
     OverDefinedCacheTy OverDefinedCache;
 
-    /// Keep track of all blocks that we have ever seen, so we
-    /// don't spend time removing unused blocks from our caches.
-    DenseSet<AssertingVH<BasicBlock> > SeenBlocks;
+    /// Keep track of all blocks that we have ever seen, together with the
+    /// values that have a (non over-defined) entry for them, so that
+    /// erasing a block only touches the entries it has. The values are not
+    /// tracked through value handles: one that has since been deleted just
+    /// isn't found in ValueCache anymore.
+    DenseMap<AssertingVH<BasicBlock>, SmallVector<Value *, 4>> SeenBlocks;
+
+    /// Number of block values and over-defined markers currently cached.
+    unsigned NumEntries = 0;
 
   public:
     void insertResult(Value *Val, BasicBlock *BB, const LVILatticeVal &Result) {
-      SeenBlocks.insert(BB);
+      auto &BlockValues = SeenBlocks[BB];
 
       // Insert over-defined values into their own cache to reduce memory
       // overhead.
-      if (Result.isOverdefined())
-        OverDefinedCache[BB].insert(Val);
-      else {
+      if (Result.isOverdefined()) {
+        if (OverDefinedCache[BB].insert(Val).second)
+          ++NumEntries;
+      } else {
         auto It = ValueCache.find_as(Val);
         if (It == ValueCache.end()) {
           ValueCache[Val] = make_unique<ValueCacheEntryTy>(Val, this);
           It = ValueCache.find_as(Val);
           assert(It != ValueCache.end() && "Val was just added to the map!");
         }
-        It->second->BlockVals[BB] = Result;
+        auto Inserted =
+            It->second->BlockVals.insert(std::make_pair(BB, Result));
+        if (Inserted.second) {
+          BlockValues.push_back(Val);
+          ++NumEntries;
+        } else
+          Inserted.first->second = Result;
       }
     }
 
+    unsigned size() const { return NumEntries; }
+
     bool isOverdefined(Value *V, BasicBlock *BB) const {
       auto ODI = OverDefinedCache.find(BB);
 
@@ -468,6 +489,7 @@ namespace {
       SeenBlocks.clear();
       ValueCache.clear();
       OverDefinedCache.clear();
+      NumEntries = 0;
     }
 
     /// Inform the cache that a given value has been deleted.
@@ -490,15 +512,19 @@ void LazyValueInfoCache::eraseValue(Value *V) {
   SmallVector<AssertingVH<BasicBlock>, 4> ToErase;
   for (auto &I : OverDefinedCache) {
     SmallPtrSetImpl<Value *> &ValueSet = I.second;
-    if (ValueSet.count(V))
-      ValueSet.erase(V);
+    if (ValueSet.erase(V))
+      --NumEntries;
     if (ValueSet.empty())
       ToErase.push_back(I.first);
   }
   for (auto &BB : ToErase)
     OverDefinedCache.erase(BB);
 
-  ValueCache.erase(V);
+  auto VI = ValueCache.find_as(V);
+  if (VI != ValueCache.end()) {
+    NumEntries -= VI->second->BlockVals.size();
+    ValueCache.erase(VI);
+  }
 }
 
 void LVIValueHandle::deleted() {
@@ -509,17 +535,22 @@ void LVIValueHandle::deleted() {
 
 void LazyValueInfoCache::eraseBlock(BasicBlock *BB) {
   // Shortcut if we have never seen this block.
-  DenseSet<AssertingVH<BasicBlock> >::iterator I = SeenBlocks.find(BB);
+  auto I = SeenBlocks.find(BB);
   if (I == SeenBlocks.end())
     return;
-  SeenBlocks.erase(I);
 
   auto ODI = OverDefinedCache.find(BB);
-  if (ODI != OverDefinedCache.end())
+  if (ODI != OverDefinedCache.end()) {
+    NumEntries -= ODI->second.size();
     OverDefinedCache.erase(ODI);
+  }
 
-  for (auto &I : ValueCache)
-    I.second->BlockVals.erase(BB);
+  for (Value *V : I->second) {
+    auto VI = ValueCache.find_as(V);
+    if (VI != ValueCache.end() && VI->second->BlockVals.erase(BB))
+      --NumEntries;
+  }
+  SeenBlocks.erase(I);
 }
 
 void LazyValueInfoCache::threadEdgeImpl(BasicBlock *OldSucc,
@@ -564,6 +595,7 @@ void LazyValueInfoCache::threadEdgeImpl(BasicBlock *OldSucc,
         continue;
 
       ValueSet.erase(V);
+      --NumEntries;
       if (ValueSet.empty())
         OverDefinedCache.erase(OI);
 
@@ -634,6 +666,17 @@ namespace {
 
   void solve();
 
+  /// Drop every cached block value once the cache has grown past its limit.
+  /// This may only happen between queries: the solver expects the results it
+  /// has produced for the current query to stay in the cache.
+  void enforceCacheLimit() {
+    assert(BlockValueStack.empty() && "Flushing the cache during a query!");
+    if (MaxCacheEntries && TheCache.size() > MaxCacheEntries) {
+      DEBUG(dbgs() << "LVI cache limit reached, flushing\n");
+      TheCache.clear();
+    }
+  }
+
   public:
     /// This is the query interface to determine the lattice
     /// value for the specified Value* at the end of the specified block.
@@ -1491,6 +1534,7 @@ LVILatticeVal LazyValueInfoImpl::getValueInBlock(Value *V, BasicBlock *BB,
         << BB->getName() << "'\n");
 
   assert(BlockValueStack.empty() && BlockValueSet.empty());
+  enforceCacheLimit();
   if (!hasBlockValue(V, BB)) {
     pushBlockValue(std::make_pair(BB, V));
     solve();
@@ -1524,6 +1568,7 @@ getValueOnEdge(Value *V, BasicBlock *FromBB, BasicBlock *ToBB,
   DEBUG(dbgs() << "LVI Getting edge value " << *V << " from '"
         << FromBB->getName() << "' to '" << ToBB->getName() << "'\n");
 
+  enforceCacheLimit();
   LVILatticeVal Result;
   if (!getEdgeValue(V, FromBB, ToBB, Result, CxtI)) {
     solve();
@@ -1529,6 +1529,10 @@ void LoopAccessInfo::analyzeLoop(AliasAnalysis *AA, LoopInfo *LI,
                                  DominatorTree *DT) {
   typedef SmallPtrSet<Value*, 16> ValueSet;
 
+  // The analysis doesn't touch the IR, and the alias set tracker and the
+  // runtime check grouping below keep asking about the same pointer pairs.
+  AABatchModeScope BatchAA(*AA);
+
   // Holds the Load and Store instructions.
   SmallVector<LoadInst *, 16> Loads;
   SmallVector<StoreInst *, 16> Stores;
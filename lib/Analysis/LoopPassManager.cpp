@@ -37,3 +37,21 @@ PreservedAnalyses llvm::getLoopPassPreservedAnalyses() {
   PA.preserve<SCEVAA>();
   return PA;
 }
+
+LoopStandardAnalysisResults
+llvm::getLoopStandardAnalysisResults(Loop &L, LoopAnalysisManager &AM) {
+  const auto &FAM =
+      AM.getResult<FunctionAnalysisManagerLoopProxy>(L).getManager();
+  Function &F = *L.getHeader()->getParent();
+
+  auto *AA = FAM.getCachedResult<AAManager>(F);
+  auto *AC = FAM.getCachedResult<AssumptionAnalysis>(F);
+  auto *DT = FAM.getCachedResult<DominatorTreeAnalysis>(F);
+  auto *LI = FAM.getCachedResult<LoopAnalysis>(F);
+  auto *SE = FAM.getCachedResult<ScalarEvolutionAnalysis>(F);
+  auto *TLI = FAM.getCachedResult<TargetLibraryAnalysis>(F);
+  auto *TTI = FAM.getCachedResult<TargetIRAnalysis>(F);
+  assert(AA && AC && DT && LI && SE && TLI && TTI &&
+         "Standard loop analyses not computed by the loop pass adaptor!");
+  return {*AA, *AC, *DT, *LI, *SE, *TLI, *TTI};
+}
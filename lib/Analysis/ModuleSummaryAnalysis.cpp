@@ -64,6 +64,64 @@ static void findRefEdges(const User *CurUser, DenseSet<const Value *> &RefEdges,
   }
 }
 
+namespace {
+/// How the functions of a module access each global variable.
+enum VarAccessKind : unsigned { VarRead = 1, VarWrite = 2, VarOther = 4 };
+typedef DenseMap<std::pair<const Function *, const GlobalVariable *>, unsigned>
+    VarAccessMap;
+} // end anonymous namespace
+
+// Record how every function in the module accesses each global variable:
+// through loads, through stores, or in any other way (e.g. by letting its
+// address escape). Casts and GEPs of the address are looked through.
+static void computeVarAccesses(const Module &M, VarAccessMap &Accesses) {
+  SmallVector<std::pair<const Value *, bool>, 16> Worklist;
+  SmallPtrSet<const Value *, 16> Visited[2];
+  for (const GlobalVariable &GV : M.globals()) {
+    Worklist.push_back({&GV, false});
+    Visited[0].clear();
+    Visited[1].clear();
+    while (!Worklist.empty()) {
+      const Value *V;
+      bool Escaped;
+      std::tie(V, Escaped) = Worklist.pop_back_val();
+      for (const User *U : V->users()) {
+        if (auto *I = dyn_cast<Instruction>(U)) {
+          unsigned &Access = Accesses[{I->getFunction(), &GV}];
+          if (Escaped)
+            Access |= VarOther;
+          else if (auto *LI = dyn_cast<LoadInst>(I))
+            Access |= LI->isSimple() ? VarRead : VarOther;
+          else if (auto *SI = dyn_cast<StoreInst>(I))
+            Access |= SI->isSimple() && SI->getValueOperand() != V ? VarWrite
+                                                                   : VarOther;
+          else if (isa<BitCastInst>(I) || isa<GetElementPtrInst>(I)) {
+            if (Visited[0].insert(I).second)
+              Worklist.push_back({I, false});
+          } else
+            Access |= VarOther;
+          continue;
+        }
+        // A reference from another global's initializer is recorded in that
+        // global's own summary.
+        if (isa<GlobalValue>(U))
+          continue;
+        // Constant expressions are shared by all the functions, so keep
+        // walking to find which ones use them. Anything but an address
+        // computation lets the address escape to its users.
+        bool UserEscapes = Escaped;
+        if (auto *CE = dyn_cast<ConstantExpr>(U))
+          UserEscapes |= CE->getOpcode() != Instruction::BitCast &&
+                         CE->getOpcode() != Instruction::GetElementPtr;
+        else
+          UserEscapes = true;
+        if (Visited[UserEscapes].insert(U).second)
+          Worklist.push_back({U, UserEscapes});
+      }
+    }
+  }
+}
+
 static CalleeInfo::HotnessType getHotness(uint64_t ProfileCount,
                                           ProfileSummaryInfo *PSI) {
   if (!PSI)
@@ -77,11 +135,14 @@ static CalleeInfo::HotnessType getHotness(uint64_t ProfileCount,
 
 static void computeFunctionSummary(ModuleSummaryIndex &Index, const Module &M,
                                    const Function &F, BlockFrequencyInfo *BFI,
-                                   ProfileSummaryInfo *PSI) {
+                                   ProfileSummaryInfo *PSI,
+                                   const VarAccessMap &VarAccesses) {
   // Summary not currently supported for anonymous functions, they must
-  // be renamed.
-  if (!F.hasName())
+  // be renamed. Their accesses to global variables are then unknown.
+  if (!F.hasName()) {
+    Index.setIncomplete();
     return;
+  }
 
   unsigned NumInsts = 0;
   // Map from callee ValueId to profile count. Used to accumulate profile
@@ -150,7 +211,23 @@ static void computeFunctionSummary(ModuleSummaryIndex &Index, const Module &M,
       llvm::make_unique<FunctionSummary>(Flags, NumInsts);
   FuncSummary->addCallGraphEdges(CallGraphEdges);
   FuncSummary->addCallGraphEdges(IndirectCallEdges);
-  FuncSummary->addRefEdges(RefEdges);
+  // Variables only loaded from, then variables only stored to, go last.
+  std::vector<const Value *> ReadOnlyRefs, WriteOnlyRefs;
+  for (const Value *Ref : RefEdges) {
+    auto *GV = dyn_cast<GlobalVariable>(Ref);
+    unsigned Access = GV ? VarAccesses.lookup({&F, GV}) : VarOther;
+    if (Access == VarRead)
+      ReadOnlyRefs.push_back(Ref);
+    else if (Access == VarWrite)
+      WriteOnlyRefs.push_back(Ref);
+    else
+      FuncSummary->addRefEdge(Ref);
+  }
+  for (const Value *Ref : ReadOnlyRefs)
+    FuncSummary->addRefEdge(Ref);
+  for (const Value *Ref : WriteOnlyRefs)
+    FuncSummary->addRefEdge(Ref);
+  FuncSummary->setRefAccessCounts(ReadOnlyRefs.size(), WriteOnlyRefs.size());
   Index.addGlobalValueSummary(F.getName(), std::move(FuncSummary));
 }
 
@@ -166,16 +243,74 @@ static void computeVariableSummary(ModuleSummaryIndex &Index,
   Index.addGlobalValueSummary(V.getName(), std::move(GVarSummary));
 }
 
+// Record what the vtable \p V holds for each type identifier it is a member
+// of, so that the thin link can tell which functions a virtual call may reach.
+static void computeTypeIdSummaries(ModuleSummaryIndex &Index,
+                                   const GlobalVariable &V) {
+  SmallVector<MDNode *, 2> Types;
+  V.getMetadata(LLVMContext::MD_type, Types);
+  if (Types.empty())
+    return;
+
+  const auto *Init =
+      V.isConstant() ? dyn_cast<ConstantArray>(V.getInitializer()) : nullptr;
+  for (MDNode *Type : Types) {
+    // Type identifiers that are not strings are local to this module.
+    auto *TypeId = dyn_cast<MDString>(Type->getOperand(1));
+    if (!TypeId)
+      continue;
+    TypeIdSummary &Summary =
+        Index.getOrInsertTypeIdSummary(TypeId->getString());
+    if (!Init) {
+      Summary.Unknown = true;
+      continue;
+    }
+
+    uint64_t AddressPoint =
+        cast<ConstantInt>(
+            cast<ConstantAsMetadata>(Type->getOperand(0))->getValue())
+            ->getZExtValue();
+    uint64_t ElemSize = V.getParent()->getDataLayout().getTypeAllocSize(
+        Init->getType()->getElementType());
+    for (unsigned I = 0, E = Init->getNumOperands(); I != E; ++I) {
+      if (I * ElemSize < AddressPoint)
+        continue;
+      uint64_t Offset = I * ElemSize - AddressPoint;
+      auto *Fn = dyn_cast<Function>(Init->getOperand(I)->stripPointerCasts());
+      // Calls to pure virtuals are UB, they are no possible target.
+      if (Fn && Fn->getName() == "__cxa_pure_virtual")
+        continue;
+      // Local functions get renamed on promotion, so their names cannot be
+      // shared with other modules.
+      std::string Target;
+      if (Fn && Fn->hasName() && !Fn->hasLocalLinkage())
+        Target = Fn->getName();
+      Summary.SlotTargets[Offset].insert(Target);
+    }
+  }
+}
+
 ModuleSummaryIndex llvm::buildModuleSummaryIndex(
     const Module &M,
     std::function<BlockFrequencyInfo *(const Function &F)> GetBFICallback,
     ProfileSummaryInfo *PSI) {
   ModuleSummaryIndex Index;
+  // Vtables are recorded even when the module gets no summaries: other modules
+  // can only be devirtualized if the thin link sees every vtable.
+  for (const GlobalVariable &G : M.globals())
+    if (!G.isDeclaration())
+      computeTypeIdSummaries(Index, G);
+
   // Check if the module can be promoted, otherwise just disable importing from
   // it by not emitting any summary.
   // FIXME: we could still import *into* it most of the time.
-  if (!moduleCanBeRenamedForThinLTO(M))
+  if (!moduleCanBeRenamedForThinLTO(M)) {
+    Index.setIncomplete();
     return Index;
+  }
+
+  VarAccessMap VarAccesses;
+  computeVarAccesses(M, VarAccesses);
 
   // Compute summaries for all functions defined in module, and save in the
   // index.
@@ -194,7 +329,7 @@ ModuleSummaryIndex llvm::buildModuleSummaryIndex(
       BFI = BFIPtr.get();
     }
 
-    computeFunctionSummary(Index, M, F, BFI, PSI);
+    computeFunctionSummary(Index, M, F, BFI, PSI, VarAccesses);
   }
 
   // Compute summaries for all variables defined in module, and save in the
@@ -20,6 +20,7 @@
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/BinaryRemarks.h"
 
 using namespace llvm;
 
@@ -75,8 +76,11 @@ template <> struct MappingTraits<DiagnosticInfoOptimizationBase *> {
                        OptDiag->getKind() ==
                            DK_OptimizationRemarkAnalysisAliasing))
       ;
+    else if (io.mapTag("!Failure",
+                       OptDiag->getKind() == DK_OptimizationFailure))
+      ;
     else
-      llvm_unreachable("todo");
+      llvm_unreachable("Unknown optimization remark kind");
 
     // These are read-only for now.
     DebugLoc DL = OptDiag->getDebugLoc();
@@ -115,6 +119,8 @@ template <> struct MappingTraits<DiagnosticInfoOptimizationBase::Argument> {
   static void mapping(IO &io, DiagnosticInfoOptimizationBase::Argument &A) {
     assert(io.outputting() && "input not yet implemented");
     io.mapRequired(A.Key.data(), A.Val);
+    if (A.DLoc)
+      io.mapOptional("DebugLoc", A.DLoc);
   }
 };
 
@@ -123,6 +129,52 @@ template <> struct MappingTraits<DiagnosticInfoOptimizationBase::Argument> {
 
 LLVM_YAML_IS_SEQUENCE_VECTOR(DiagnosticInfoOptimizationBase::Argument)
 
+static remarks::RemarkKind getRemarkKind(DiagnosticKind Kind) {
+  switch (Kind) {
+  case DK_OptimizationRemark:
+    return remarks::RemarkKind::Passed;
+  case DK_OptimizationRemarkMissed:
+    return remarks::RemarkKind::Missed;
+  case DK_OptimizationRemarkAnalysis:
+    return remarks::RemarkKind::Analysis;
+  case DK_OptimizationRemarkAnalysisFPCommute:
+    return remarks::RemarkKind::AnalysisFPCommute;
+  case DK_OptimizationRemarkAnalysisAliasing:
+    return remarks::RemarkKind::AnalysisAliasing;
+  case DK_OptimizationFailure:
+    return remarks::RemarkKind::Failure;
+  default:
+    // DiagnosticInfoOptimizationBase::classof admits only the kinds above.
+    llvm_unreachable("Unknown optimization remark kind");
+  }
+}
+
+static void getRemarkLoc(const DebugLoc &DL, StringRef &File, unsigned &Line,
+                         unsigned &Column) {
+  File = cast<DIScope>(DL.getScope())->getFilename();
+  Line = DL.getLine();
+  Column = DL.getCol();
+}
+
+static void writeBinaryRemark(remarks::BinaryRemarkWriter &W,
+                              const DiagnosticInfoOptimizationBase &OptDiag) {
+  remarks::Remark R;
+  R.Kind = getRemarkKind(static_cast<DiagnosticKind>(OptDiag.getKind()));
+  R.PassName = OptDiag.getPassName();
+  R.RemarkName = OptDiag.getRemarkName();
+  R.FunctionName = OptDiag.getFunction().getName();
+  if (const DebugLoc &DL = OptDiag.getDebugLoc())
+    getRemarkLoc(DL, R.File, R.Line, R.Column);
+  R.Hotness = OptDiag.getHotness();
+  for (const auto &Arg : OptDiag.getArgs()) {
+    remarks::Argument A(Arg.Key, Arg.Val);
+    if (Arg.DLoc)
+      getRemarkLoc(Arg.DLoc, A.File, A.Line, A.Column);
+    R.Args.push_back(A);
+  }
+  W.write(R);
+}
+
 void OptimizationRemarkEmitter::computeHotness(
     DiagnosticInfoOptimizationBase &OptDiag) {
   Value *V = OptDiag.getCodeRegion();
@@ -138,6 +190,8 @@ void OptimizationRemarkEmitter::emit(DiagnosticInfoOptimizationBase &OptDiag) {
     auto *P = &const_cast<DiagnosticInfoOptimizationBase &>(OptDiag);
     *Out << P;
   }
+  if (auto *W = F->getContext().getDiagnosticsBinaryOutput())
+    writeBinaryRemark(*W, OptDiag);
   // FIXME: now that IsVerbose is part of DI, filtering for this will be moved
   // from here to clang.
   if (!OptDiag.isVerbose() || shouldEmitVerbose())
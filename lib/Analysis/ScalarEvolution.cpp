@@ -1296,7 +1296,7 @@ static const SCEV *getPreStartForExtend(const SCEVAddRecExpr *AR, Type *Ty,
       // If we know `AR` == {`PreStart`+`Step`,+,`Step`} is `WrapType` (FlagNSW
       // or FlagNUW) and that `PreStart` + `Step` is `WrapType` too, then
       // `PreAR` == {`PreStart`,+,`Step`} is also `WrapType`.  Cache this fact.
-      const_cast<SCEVAddRecExpr *>(PreAR)->setNoWrapFlags(WrapType);
+      SE->setNoWrapFlags(const_cast<SCEVAddRecExpr *>(PreAR), WrapType);
     }
     return PreStart;
   }
@@ -1456,7 +1456,7 @@ const SCEV *ScalarEvolution::getZeroExtendExpr(const SCEV *Op,
 
       if (!AR->hasNoUnsignedWrap()) {
         auto NewFlags = proveNoWrapViaConstantRanges(AR);
-        const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(NewFlags);
+        setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), NewFlags);
       }
 
       // If we have special knowledge that this addrec won't overflow,
@@ -1499,7 +1499,7 @@ const SCEV *ScalarEvolution::getZeroExtendExpr(const SCEV *Op,
                                   getZeroExtendExpr(Step, WideTy)));
           if (ZAdd == OperandExtendedAdd) {
             // Cache knowledge of AR NUW, which is propagated to this AddRec.
-            const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNUW);
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNUW);
             // Return the expression with the addrec on the outside.
             return getAddRecExpr(
                 getExtendAddRecStart<SCEVZeroExtendExpr>(AR, Ty, this),
@@ -1514,7 +1514,7 @@ const SCEV *ScalarEvolution::getZeroExtendExpr(const SCEV *Op,
           if (ZAdd == OperandExtendedAdd) {
             // Cache knowledge of AR NW, which is propagated to this AddRec.
             // Negative step causes unsigned wrap, but it still can't self-wrap.
-            const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNW);
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNW);
             // Return the expression with the addrec on the outside.
             return getAddRecExpr(
                 getExtendAddRecStart<SCEVZeroExtendExpr>(AR, Ty, this),
@@ -1546,7 +1546,7 @@ const SCEV *ScalarEvolution::getZeroExtendExpr(const SCEV *Op,
                                            AR->getPostIncExpr(*this), N))) {
             // Cache knowledge of AR NUW, which is propagated to this
             // AddRec.
-            const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNUW);
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNUW);
             // Return the expression with the addrec on the outside.
             return getAddRecExpr(
                 getExtendAddRecStart<SCEVZeroExtendExpr>(AR, Ty, this),
@@ -1562,7 +1562,7 @@ const SCEV *ScalarEvolution::getZeroExtendExpr(const SCEV *Op,
             // Cache knowledge of AR NW, which is propagated to this
             // AddRec.  Negative step causes unsigned wrap, but it
             // still can't self-wrap.
-            const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNW);
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNW);
             // Return the expression with the addrec on the outside.
             return getAddRecExpr(
                 getExtendAddRecStart<SCEVZeroExtendExpr>(AR, Ty, this),
@@ -1572,7 +1572,7 @@ const SCEV *ScalarEvolution::getZeroExtendExpr(const SCEV *Op,
       }
 
       if (proveNoWrapByVaryingStart<SCEVZeroExtendExpr>(Start, Step, L)) {
-        const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNUW);
+        setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNUW);
         return getAddRecExpr(
             getExtendAddRecStart<SCEVZeroExtendExpr>(AR, Ty, this),
             getZeroExtendExpr(Step, Ty), L, AR->getNoWrapFlags());
@@ -1683,7 +1683,7 @@ const SCEV *ScalarEvolution::getSignExtendExpr(const SCEV *Op,
 
       if (!AR->hasNoSignedWrap()) {
         auto NewFlags = proveNoWrapViaConstantRanges(AR);
-        const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(NewFlags);
+        setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), NewFlags);
       }
 
       // If we have special knowledge that this addrec won't overflow,
@@ -1726,7 +1726,7 @@ const SCEV *ScalarEvolution::getSignExtendExpr(const SCEV *Op,
                                   getSignExtendExpr(Step, WideTy)));
           if (SAdd == OperandExtendedAdd) {
             // Cache knowledge of AR NSW, which is propagated to this AddRec.
-            const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNSW);
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNSW);
             // Return the expression with the addrec on the outside.
             return getAddRecExpr(
                 getExtendAddRecStart<SCEVSignExtendExpr>(AR, Ty, this),
@@ -1747,7 +1747,7 @@ const SCEV *ScalarEvolution::getSignExtendExpr(const SCEV *Op,
             // Thus (AR is not NW => SAdd != OperandExtendedAdd) <=>
             // (SAdd == OperandExtendedAdd => AR is NW)
 
-            const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNW);
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNW);
 
             // Return the expression with the addrec on the outside.
             return getAddRecExpr(
@@ -1781,7 +1781,7 @@ const SCEV *ScalarEvolution::getSignExtendExpr(const SCEV *Op,
               isLoopBackedgeGuardedByCond(L, Pred, AR->getPostIncExpr(*this),
                                           OverflowLimit)))) {
           // Cache knowledge of AR NSW, then propagate NSW to the wide AddRec.
-          const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNSW);
+          setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNSW);
           return getAddRecExpr(
               getExtendAddRecStart<SCEVSignExtendExpr>(AR, Ty, this),
               getSignExtendExpr(Step, Ty), L, AR->getNoWrapFlags());
@@ -1806,7 +1806,7 @@ const SCEV *ScalarEvolution::getSignExtendExpr(const SCEV *Op,
       }
 
       if (proveNoWrapByVaryingStart<SCEVSignExtendExpr>(Start, Step, L)) {
-        const_cast<SCEVAddRecExpr *>(AR)->setNoWrapFlags(SCEV::FlagNSW);
+        setNoWrapFlags(const_cast<SCEVAddRecExpr *>(AR), SCEV::FlagNSW);
         return getAddRecExpr(
             getExtendAddRecStart<SCEVSignExtendExpr>(AR, Ty, this),
             getSignExtendExpr(Step, Ty), L, AR->getNoWrapFlags());
@@ -2021,6 +2021,47 @@ StrengthenNoWrapFlags(ScalarEvolution *SE, SCEVTypes Type,
   return Flags;
 }
 
+static unsigned getFoldCacheKind(unsigned SCEVType, SCEV::NoWrapFlags Flags) {
+  return SCEVType << 3 | Flags;
+}
+
+const SCEV *
+ScalarEvolution::getFoldCacheEntry(unsigned SCEVType, SCEV::NoWrapFlags Flags,
+                                   ArrayRef<const SCEV *> Ops) const {
+  auto I = FoldCache.find(FoldCacheKey(getFoldCacheKind(SCEVType, Flags), Ops));
+  return I == FoldCache.end() ? nullptr : I->second;
+}
+
+void ScalarEvolution::setFoldCacheEntry(unsigned SCEVType,
+                                        SCEV::NoWrapFlags Flags,
+                                        ArrayRef<const SCEV *> Ops,
+                                        const SCEV *S) {
+  const SCEV **O = FoldCacheAllocator.Allocate<const SCEV *>(Ops.size());
+  std::uninitialized_copy(Ops.begin(), Ops.end(), O);
+  FoldCache[FoldCacheKey(getFoldCacheKind(SCEVType, Flags),
+                         makeArrayRef(O, Ops.size()))] = S;
+}
+
+/// Add \p Flags to \p S and report whether that changed its flags.
+template <typename ExprT>
+static bool addNoWrapFlags(ExprT *S, SCEV::NoWrapFlags Flags) {
+  SCEV::NoWrapFlags OldFlags = S->getNoWrapFlags();
+  S->setNoWrapFlags(Flags);
+  return S->getNoWrapFlags() != OldFlags;
+}
+
+void ScalarEvolution::setNoWrapFlags(SCEVAddRecExpr *AddRec,
+                                     SCEV::NoWrapFlags Flags) {
+  if (addNoWrapFlags(AddRec, Flags))
+    forgetFoldCache();
+}
+
+void ScalarEvolution::setNoWrapFlags(SCEVCommutativeExpr *S,
+                                     SCEV::NoWrapFlags Flags) {
+  if (addNoWrapFlags(S, Flags))
+    forgetFoldCache();
+}
+
 /// Get a canonical add expression, or something simpler if possible.
 const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
                                         SCEV::NoWrapFlags Flags) {
@@ -2028,6 +2069,18 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
          "only nuw or nsw allowed");
   assert(!Ops.empty() && "Cannot get empty add!");
   if (Ops.size() == 1) return Ops[0];
+
+  if (const SCEV *S = getFoldCacheEntry(scAddExpr, Flags, Ops))
+    return S;
+  // getAddExprImpl canonicalizes Ops in place, so key on a copy of them.
+  SmallVector<const SCEV *, 8> KeyOps(Ops.begin(), Ops.end());
+  const SCEV *S = getAddExprImpl(Ops, Flags);
+  setFoldCacheEntry(scAddExpr, Flags, KeyOps, S);
+  return S;
+}
+
+const SCEV *ScalarEvolution::getAddExprImpl(SmallVectorImpl<const SCEV *> &Ops,
+                                            SCEV::NoWrapFlags Flags) {
 #ifndef NDEBUG
   Type *ETy = getEffectiveSCEVType(Ops[0]->getType());
   for (unsigned i = 1, e = Ops.size(); i != e; ++i)
@@ -2377,8 +2430,9 @@ const SCEV *ScalarEvolution::getAddExpr(SmallVectorImpl<const SCEV *> &Ops,
     S = new (SCEVAllocator) SCEVAddExpr(ID.Intern(SCEVAllocator),
                                         O, Ops.size());
     UniqueSCEVs.InsertNode(S, IP);
-  }
-  S->setNoWrapFlags(Flags);
+    S->setNoWrapFlags(Flags);
+  } else
+    setNoWrapFlags(S, Flags);
   return S;
 }
 
@@ -2439,6 +2493,18 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
          "only nuw or nsw allowed");
   assert(!Ops.empty() && "Cannot get empty mul!");
   if (Ops.size() == 1) return Ops[0];
+
+  if (const SCEV *S = getFoldCacheEntry(scMulExpr, Flags, Ops))
+    return S;
+  // getMulExprImpl canonicalizes Ops in place, so key on a copy of them.
+  SmallVector<const SCEV *, 8> KeyOps(Ops.begin(), Ops.end());
+  const SCEV *S = getMulExprImpl(Ops, Flags);
+  setFoldCacheEntry(scMulExpr, Flags, KeyOps, S);
+  return S;
+}
+
+const SCEV *ScalarEvolution::getMulExprImpl(SmallVectorImpl<const SCEV *> &Ops,
+                                            SCEV::NoWrapFlags Flags) {
 #ifndef NDEBUG
   Type *ETy = getEffectiveSCEVType(Ops[0]->getType());
   for (unsigned i = 1, e = Ops.size(); i != e; ++i)
@@ -2669,8 +2735,9 @@ const SCEV *ScalarEvolution::getMulExpr(SmallVectorImpl<const SCEV *> &Ops,
     S = new (SCEVAllocator) SCEVMulExpr(ID.Intern(SCEVAllocator),
                                         O, Ops.size());
     UniqueSCEVs.InsertNode(S, IP);
-  }
-  S->setNoWrapFlags(Flags);
+    S->setNoWrapFlags(Flags);
+  } else
+    setNoWrapFlags(S, Flags);
   return S;
 }
 
@@ -2969,8 +3036,9 @@ ScalarEvolution::getAddRecExpr(SmallVectorImpl<const SCEV *> &Operands,
     S = new (SCEVAllocator) SCEVAddRecExpr(ID.Intern(SCEVAllocator),
                                            O, Operands.size(), L);
     UniqueSCEVs.InsertNode(S, IP);
-  }
-  S->setNoWrapFlags(Flags);
+    S->setNoWrapFlags(Flags);
+  } else
+    setNoWrapFlags(S, Flags);
   return S;
 }
 
@@ -5155,8 +5223,8 @@ const SCEV *ScalarEvolution::createSCEV(Value *V) {
           // transfer the no-wrap flags, since an or won't introduce a wrap.
           if (const SCEVAddRecExpr *NewAR = dyn_cast<SCEVAddRecExpr>(S)) {
             const SCEVAddRecExpr *OldAR = cast<SCEVAddRecExpr>(LHS);
-            const_cast<SCEVAddRecExpr *>(NewAR)->setNoWrapFlags(
-                OldAR->getNoWrapFlags());
+            setNoWrapFlags(const_cast<SCEVAddRecExpr *>(NewAR),
+                           OldAR->getNoWrapFlags());
           }
           return S;
         }
@@ -5534,7 +5602,7 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
 void ScalarEvolution::forgetLoop(const Loop *L) {
   // Drop any stored trip count value.
   auto RemoveLoopFromBackedgeMap =
-      [L](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
+      [](DenseMap<const Loop *, BackedgeTakenInfo> &Map, const Loop *L) {
         auto BTCPos = Map.find(L);
         if (BTCPos != Map.end()) {
           BTCPos->second.clear();
@@ -5542,37 +5610,48 @@ void ScalarEvolution::forgetLoop(const Loop *L) {
         }
       };
 
-  RemoveLoopFromBackedgeMap(BackedgeTakenCounts);
-  RemoveLoopFromBackedgeMap(PredicatedBackedgeTakenCounts);
+  SmallVector<const Loop *, 16> LoopWorklist(1, L);
+  SmallVector<Instruction *, 32> Worklist;
+  SmallPtrSet<Instruction *, 16> Visited;
+  // The SCEVs of the dropped values are forgotten in one batch at the end, so
+  // that the backedge-taken caches are scanned once rather than once per SCEV.
+  SmallVector<const SCEV *, 16> ToForget;
 
-  // Drop information about expressions based on loop-header PHIs.
-  SmallVector<Instruction *, 16> Worklist;
-  PushLoopPHIs(L, Worklist);
+  // Iterate over the loop and all its sub-loops.
+  while (!LoopWorklist.empty()) {
+    const Loop *CurrL = LoopWorklist.pop_back_val();
 
-  SmallPtrSet<Instruction *, 8> Visited;
-  while (!Worklist.empty()) {
-    Instruction *I = Worklist.pop_back_val();
-    if (!Visited.insert(I).second)
-      continue;
+    RemoveLoopFromBackedgeMap(BackedgeTakenCounts, CurrL);
+    RemoveLoopFromBackedgeMap(PredicatedBackedgeTakenCounts, CurrL);
 
-    ValueExprMapType::iterator It =
-      ValueExprMap.find_as(static_cast<Value *>(I));
-    if (It != ValueExprMap.end()) {
-      eraseValueFromMap(It->first);
-      forgetMemoizedResults(It->second);
-      if (PHINode *PN = dyn_cast<PHINode>(I))
-        ConstantEvolutionLoopExitValue.erase(PN);
+    // Drop information about expressions based on loop-header PHIs.
+    PushLoopPHIs(CurrL, Worklist);
+
+    while (!Worklist.empty()) {
+      Instruction *I = Worklist.pop_back_val();
+      if (!Visited.insert(I).second)
+        continue;
+
+      ValueExprMapType::iterator It =
+        ValueExprMap.find_as(static_cast<Value *>(I));
+      if (It != ValueExprMap.end()) {
+        ToForget.push_back(It->second);
+        eraseValueFromMap(It->first);
+        if (PHINode *PN = dyn_cast<PHINode>(I))
+          ConstantEvolutionLoopExitValue.erase(PN);
+      }
+
+      PushDefUseChildren(I, Worklist);
     }
 
-    PushDefUseChildren(I, Worklist);
-  }
+    LoopPropertiesCache.erase(CurrL);
 
-  // Forget all contained loops too, to avoid dangling entries in the
-  // ValuesAtScopes map.
-  for (Loop *I : *L)
-    forgetLoop(I);
+    // Forget all contained loops too, to avoid dangling entries in the
+    // ValuesAtScopes map.
+    LoopWorklist.append(CurrL->begin(), CurrL->end());
+  }
 
-  LoopPropertiesCache.erase(L);
+  forgetMemoizedResults(ToForget);
 }
 
 void ScalarEvolution::forgetValue(Value *V) {
@@ -5584,6 +5663,7 @@ void ScalarEvolution::forgetValue(Value *V) {
   Worklist.push_back(I);
 
   SmallPtrSet<Instruction *, 8> Visited;
+  SmallVector<const SCEV *, 8> ToForget;
   while (!Worklist.empty()) {
     I = Worklist.pop_back_val();
     if (!Visited.insert(I).second)
@@ -5592,14 +5672,16 @@ void ScalarEvolution::forgetValue(Value *V) {
     ValueExprMapType::iterator It =
       ValueExprMap.find_as(static_cast<Value *>(I));
     if (It != ValueExprMap.end()) {
+      ToForget.push_back(It->second);
       eraseValueFromMap(It->first);
-      forgetMemoizedResults(It->second);
       if (PHINode *PN = dyn_cast<PHINode>(I))
         ConstantEvolutionLoopExitValue.erase(PN);
     }
 
     PushDefUseChildren(I, Worklist);
   }
+
+  forgetMemoizedResults(ToForget);
 }
 
 /// Get the exact loop backedge taken count considering all loop exits. A
@@ -5667,15 +5749,39 @@ bool ScalarEvolution::BackedgeTakenInfo::isMaxOrZero(ScalarEvolution *SE) const
   return MaxOrZero && !any_of(ExitNotTaken, PredicateNotAlwaysTrue);
 }
 
-bool ScalarEvolution::BackedgeTakenInfo::hasOperand(const SCEV *S,
-                                                    ScalarEvolution *SE) const {
+/// Return true if the expression tree \p S contains one of the nodes in
+/// \p Ops.
+static bool containsAnyOf(const SCEV *S,
+                          const SmallPtrSetImpl<const SCEV *> &Ops) {
+  // Implements SCEVTraversal::Visitor.
+  struct SCEVSearch {
+    const SmallPtrSetImpl<const SCEV *> &Ops;
+    bool IsFound;
+
+    SCEVSearch(const SmallPtrSetImpl<const SCEV *> &Ops)
+        : Ops(Ops), IsFound(false) {}
+
+    bool follow(const SCEV *S) {
+      IsFound |= Ops.count(S) != 0;
+      return !IsFound;
+    }
+    bool isDone() const { return IsFound; }
+  };
+
+  SCEVSearch Search(Ops);
+  visitAll(S, Search);
+  return Search.IsFound;
+}
+
+bool ScalarEvolution::BackedgeTakenInfo::hasOperand(
+    const SmallPtrSetImpl<const SCEV *> &Ops, ScalarEvolution *SE) const {
   if (getMax() && getMax() != SE->getCouldNotCompute() &&
-      SE->hasOperand(getMax(), S))
+      containsAnyOf(getMax(), Ops))
     return true;
 
   for (auto &ENT : ExitNotTaken)
     if (ENT.ExactNotTaken != SE->getCouldNotCompute() &&
-        SE->hasOperand(ENT.ExactNotTaken, S))
+        containsAnyOf(ENT.ExactNotTaken, Ops))
       return true;
 
   return false;
@@ -9554,6 +9660,8 @@ ScalarEvolution::ScalarEvolution(ScalarEvolution &&Arg)
       BlockDispositions(std::move(Arg.BlockDispositions)),
       UnsignedRanges(std::move(Arg.UnsignedRanges)),
       SignedRanges(std::move(Arg.SignedRanges)),
+      FoldCache(std::move(Arg.FoldCache)),
+      FoldCacheAllocator(std::move(Arg.FoldCacheAllocator)),
       UniqueSCEVs(std::move(Arg.UniqueSCEVs)),
       UniquePreds(std::move(Arg.UniquePreds)),
       SCEVAllocator(std::move(Arg.SCEVAllocator)),
@@ -9958,19 +10066,29 @@ bool ScalarEvolution::hasOperand(const SCEV *S, const SCEV *Op) const {
 }
 
 void ScalarEvolution::forgetMemoizedResults(const SCEV *S) {
-  ValuesAtScopes.erase(S);
-  LoopDispositions.erase(S);
-  BlockDispositions.erase(S);
-  UnsignedRanges.erase(S);
-  SignedRanges.erase(S);
-  ExprValueMap.erase(S);
-  HasRecMap.erase(S);
+  forgetMemoizedResults(makeArrayRef(S));
+}
+
+void ScalarEvolution::forgetMemoizedResults(ArrayRef<const SCEV *> SCEVs) {
+  if (SCEVs.empty())
+    return;
+
+  SmallPtrSet<const SCEV *, 8> ToForget(SCEVs.begin(), SCEVs.end());
+  for (const SCEV *S : ToForget) {
+    ValuesAtScopes.erase(S);
+    LoopDispositions.erase(S);
+    BlockDispositions.erase(S);
+    UnsignedRanges.erase(S);
+    SignedRanges.erase(S);
+    ExprValueMap.erase(S);
+    HasRecMap.erase(S);
+  }
 
   auto RemoveSCEVFromBackedgeMap =
-      [S, this](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
+      [&ToForget, this](DenseMap<const Loop *, BackedgeTakenInfo> &Map) {
         for (auto I = Map.begin(), E = Map.end(); I != E;) {
           BackedgeTakenInfo &BEInfo = I->second;
-          if (BEInfo.hasOperand(S, this)) {
+          if (BEInfo.hasOperand(ToForget, this)) {
             BEInfo.clear();
             Map.erase(I++);
           } else
@@ -9980,6 +10098,10 @@ void ScalarEvolution::forgetMemoizedResults(const SCEV *S) {
 
   RemoveSCEVFromBackedgeMap(BackedgeTakenCounts);
   RemoveSCEVFromBackedgeMap(PredicatedBackedgeTakenCounts);
+
+  // Folds involving any of these expressions, or expressions built on them,
+  // may come out differently now.
+  forgetFoldCache();
 }
 
 typedef DenseMap<const Loop *, std::string> VerifyMap;
@@ -24,7 +24,11 @@ static cl::opt<TargetLibraryInfoImpl::VectorLibrary> ClVectorLibrary(
                clEnumValN(TargetLibraryInfoImpl::Accelerate, "Accelerate",
                           "Accelerate framework"),
                clEnumValN(TargetLibraryInfoImpl::SVML, "SVML",
-                          "Intel SVML library")));
+                          "Intel SVML library"),
+               clEnumValN(TargetLibraryInfoImpl::LIBMVEC, "LIBMVEC",
+                          "GLIBC vector math library (x86)"),
+               clEnumValN(TargetLibraryInfoImpl::SLEEF, "SLEEF",
+                          "SLEEF vector math library (AArch64, GNU ABI)")));
 
 StringRef const TargetLibraryInfoImpl::StandardNames[LibFunc::NumLibFuncs] = {
 #define TLI_DEFINE_STRING
@@ -435,14 +439,18 @@ TargetLibraryInfoImpl::TargetLibraryInfoImpl(const TargetLibraryInfoImpl &TLI)
   memcpy(AvailableArray, TLI.AvailableArray, sizeof(AvailableArray));
   VectorDescs = TLI.VectorDescs;
   ScalarDescs = TLI.ScalarDescs;
+  ScalarFnIndex = TLI.ScalarFnIndex;
+  VectorFnIndex = TLI.VectorFnIndex;
 }
 
 TargetLibraryInfoImpl::TargetLibraryInfoImpl(TargetLibraryInfoImpl &&TLI)
     : CustomNames(std::move(TLI.CustomNames)) {
   std::move(std::begin(TLI.AvailableArray), std::end(TLI.AvailableArray),
             AvailableArray);
-  VectorDescs = TLI.VectorDescs;
-  ScalarDescs = TLI.ScalarDescs;
+  VectorDescs = std::move(TLI.VectorDescs);
+  ScalarDescs = std::move(TLI.ScalarDescs);
+  ScalarFnIndex = std::move(TLI.ScalarFnIndex);
+  VectorFnIndex = std::move(TLI.VectorFnIndex);
 }
 
 TargetLibraryInfoImpl &TargetLibraryInfoImpl::operator=(const TargetLibraryInfoImpl &TLI) {
@@ -1017,20 +1025,21 @@ static bool compareByVectorFnName(const VecDesc &LHS, const VecDesc &RHS) {
   return LHS.VectorFnName < RHS.VectorFnName;
 }
 
-static bool compareWithScalarFnName(const VecDesc &LHS, StringRef S) {
-  return LHS.ScalarFnName < S;
-}
-
-static bool compareWithVectorFnName(const VecDesc &LHS, StringRef S) {
-  return LHS.VectorFnName < S;
-}
-
 void TargetLibraryInfoImpl::addVectorizableFunctions(ArrayRef<VecDesc> Fns) {
   VectorDescs.insert(VectorDescs.end(), Fns.begin(), Fns.end());
   std::sort(VectorDescs.begin(), VectorDescs.end(), compareByScalarFnName);
 
   ScalarDescs.insert(ScalarDescs.end(), Fns.begin(), Fns.end());
   std::sort(ScalarDescs.begin(), ScalarDescs.end(), compareByVectorFnName);
+
+  // Rebuild the hashed indices; the vectorizer queries them for every call in
+  // every loop it looks at. insert keeps the first entry for a name.
+  ScalarFnIndex.clear();
+  for (unsigned I = 0, E = VectorDescs.size(); I != E; ++I)
+    ScalarFnIndex.insert(std::make_pair(VectorDescs[I].ScalarFnName, I));
+  VectorFnIndex.clear();
+  for (unsigned I = 0, E = ScalarDescs.size(); I != E; ++I)
+    VectorFnIndex.insert(std::make_pair(ScalarDescs[I].VectorFnName, I));
 }
 
 void TargetLibraryInfoImpl::addVectorizableFunctionsFromVecLib(
@@ -1147,6 +1156,166 @@ void TargetLibraryInfoImpl::addVectorizableFunctionsFromVecLib(
     addVectorizableFunctions(VecFuncs);
     break;
   }
+  case LIBMVEC: {
+    // The SSE (b), AVX2 (d) and AVX-512 (e) variants of glibc's libmvec. The
+    // SSE variants need only SSE2, which every x86-64 target has.
+    const VecDesc VecFuncs[] = {
+        {"sin", "_ZGVbN2v_sin", 2},
+        {"sin", "_ZGVdN4v_sin", 4, "avx2"},
+        {"sin", "_ZGVeN8v_sin", 8, "avx512f"},
+
+        {"llvm.sin.f64", "_ZGVbN2v_sin", 2},
+        {"llvm.sin.f64", "_ZGVdN4v_sin", 4, "avx2"},
+        {"llvm.sin.f64", "_ZGVeN8v_sin", 8, "avx512f"},
+
+        {"sinf", "_ZGVbN4v_sinf", 4},
+        {"sinf", "_ZGVdN8v_sinf", 8, "avx2"},
+        {"sinf", "_ZGVeN16v_sinf", 16, "avx512f"},
+
+        {"llvm.sin.f32", "_ZGVbN4v_sinf", 4},
+        {"llvm.sin.f32", "_ZGVdN8v_sinf", 8, "avx2"},
+        {"llvm.sin.f32", "_ZGVeN16v_sinf", 16, "avx512f"},
+
+        {"cos", "_ZGVbN2v_cos", 2},
+        {"cos", "_ZGVdN4v_cos", 4, "avx2"},
+        {"cos", "_ZGVeN8v_cos", 8, "avx512f"},
+
+        {"llvm.cos.f64", "_ZGVbN2v_cos", 2},
+        {"llvm.cos.f64", "_ZGVdN4v_cos", 4, "avx2"},
+        {"llvm.cos.f64", "_ZGVeN8v_cos", 8, "avx512f"},
+
+        {"cosf", "_ZGVbN4v_cosf", 4},
+        {"cosf", "_ZGVdN8v_cosf", 8, "avx2"},
+        {"cosf", "_ZGVeN16v_cosf", 16, "avx512f"},
+
+        {"llvm.cos.f32", "_ZGVbN4v_cosf", 4},
+        {"llvm.cos.f32", "_ZGVdN8v_cosf", 8, "avx2"},
+        {"llvm.cos.f32", "_ZGVeN16v_cosf", 16, "avx512f"},
+
+        {"pow", "_ZGVbN2vv_pow", 2},
+        {"pow", "_ZGVdN4vv_pow", 4, "avx2"},
+        {"pow", "_ZGVeN8vv_pow", 8, "avx512f"},
+
+        {"llvm.pow.f64", "_ZGVbN2vv_pow", 2},
+        {"llvm.pow.f64", "_ZGVdN4vv_pow", 4, "avx2"},
+        {"llvm.pow.f64", "_ZGVeN8vv_pow", 8, "avx512f"},
+
+        {"powf", "_ZGVbN4vv_powf", 4},
+        {"powf", "_ZGVdN8vv_powf", 8, "avx2"},
+        {"powf", "_ZGVeN16vv_powf", 16, "avx512f"},
+
+        {"llvm.pow.f32", "_ZGVbN4vv_powf", 4},
+        {"llvm.pow.f32", "_ZGVdN8vv_powf", 8, "avx2"},
+        {"llvm.pow.f32", "_ZGVeN16vv_powf", 16, "avx512f"},
+
+        {"exp", "_ZGVbN2v_exp", 2},
+        {"exp", "_ZGVdN4v_exp", 4, "avx2"},
+        {"exp", "_ZGVeN8v_exp", 8, "avx512f"},
+
+        {"llvm.exp.f64", "_ZGVbN2v_exp", 2},
+        {"llvm.exp.f64", "_ZGVdN4v_exp", 4, "avx2"},
+        {"llvm.exp.f64", "_ZGVeN8v_exp", 8, "avx512f"},
+
+        {"expf", "_ZGVbN4v_expf", 4},
+        {"expf", "_ZGVdN8v_expf", 8, "avx2"},
+        {"expf", "_ZGVeN16v_expf", 16, "avx512f"},
+
+        {"llvm.exp.f32", "_ZGVbN4v_expf", 4},
+        {"llvm.exp.f32", "_ZGVdN8v_expf", 8, "avx2"},
+        {"llvm.exp.f32", "_ZGVeN16v_expf", 16, "avx512f"},
+
+        {"log", "_ZGVbN2v_log", 2},
+        {"log", "_ZGVdN4v_log", 4, "avx2"},
+        {"log", "_ZGVeN8v_log", 8, "avx512f"},
+
+        {"llvm.log.f64", "_ZGVbN2v_log", 2},
+        {"llvm.log.f64", "_ZGVdN4v_log", 4, "avx2"},
+        {"llvm.log.f64", "_ZGVeN8v_log", 8, "avx512f"},
+
+        {"logf", "_ZGVbN4v_logf", 4},
+        {"logf", "_ZGVdN8v_logf", 8, "avx2"},
+        {"logf", "_ZGVeN16v_logf", 16, "avx512f"},
+
+        {"llvm.log.f32", "_ZGVbN4v_logf", 4},
+        {"llvm.log.f32", "_ZGVdN8v_logf", 8, "avx2"},
+        {"llvm.log.f32", "_ZGVeN16v_logf", 16, "avx512f"},
+    };
+    addVectorizableFunctions(VecFuncs);
+    break;
+  }
+  case SLEEF: {
+    // The Advanced SIMD variants of SLEEF's GNU ABI library.
+    const VecDesc VecFuncs[] = {
+        {"sin", "_ZGVnN2v_sin", 2},
+        {"llvm.sin.f64", "_ZGVnN2v_sin", 2},
+        {"sinf", "_ZGVnN4v_sinf", 4},
+        {"llvm.sin.f32", "_ZGVnN4v_sinf", 4},
+
+        {"cos", "_ZGVnN2v_cos", 2},
+        {"llvm.cos.f64", "_ZGVnN2v_cos", 2},
+        {"cosf", "_ZGVnN4v_cosf", 4},
+        {"llvm.cos.f32", "_ZGVnN4v_cosf", 4},
+
+        {"tan", "_ZGVnN2v_tan", 2},
+        {"tanf", "_ZGVnN4v_tanf", 4},
+
+        {"asin", "_ZGVnN2v_asin", 2},
+        {"asinf", "_ZGVnN4v_asinf", 4},
+
+        {"acos", "_ZGVnN2v_acos", 2},
+        {"acosf", "_ZGVnN4v_acosf", 4},
+
+        {"atan", "_ZGVnN2v_atan", 2},
+        {"atanf", "_ZGVnN4v_atanf", 4},
+
+        {"atan2", "_ZGVnN2vv_atan2", 2},
+        {"atan2f", "_ZGVnN4vv_atan2f", 4},
+
+        {"sinh", "_ZGVnN2v_sinh", 2},
+        {"sinhf", "_ZGVnN4v_sinhf", 4},
+
+        {"cosh", "_ZGVnN2v_cosh", 2},
+        {"coshf", "_ZGVnN4v_coshf", 4},
+
+        {"tanh", "_ZGVnN2v_tanh", 2},
+        {"tanhf", "_ZGVnN4v_tanhf", 4},
+
+        {"exp", "_ZGVnN2v_exp", 2},
+        {"llvm.exp.f64", "_ZGVnN2v_exp", 2},
+        {"expf", "_ZGVnN4v_expf", 4},
+        {"llvm.exp.f32", "_ZGVnN4v_expf", 4},
+
+        {"exp2", "_ZGVnN2v_exp2", 2},
+        {"llvm.exp2.f64", "_ZGVnN2v_exp2", 2},
+        {"exp2f", "_ZGVnN4v_exp2f", 4},
+        {"llvm.exp2.f32", "_ZGVnN4v_exp2f", 4},
+
+        {"exp10", "_ZGVnN2v_exp10", 2},
+        {"exp10f", "_ZGVnN4v_exp10f", 4},
+
+        {"log", "_ZGVnN2v_log", 2},
+        {"llvm.log.f64", "_ZGVnN2v_log", 2},
+        {"logf", "_ZGVnN4v_logf", 4},
+        {"llvm.log.f32", "_ZGVnN4v_logf", 4},
+
+        {"log2", "_ZGVnN2v_log2", 2},
+        {"llvm.log2.f64", "_ZGVnN2v_log2", 2},
+        {"log2f", "_ZGVnN4v_log2f", 4},
+        {"llvm.log2.f32", "_ZGVnN4v_log2f", 4},
+
+        {"log10", "_ZGVnN2v_log10", 2},
+        {"llvm.log10.f64", "_ZGVnN2v_log10", 2},
+        {"log10f", "_ZGVnN4v_log10f", 4},
+        {"llvm.log10.f32", "_ZGVnN4v_log10f", 4},
+
+        {"pow", "_ZGVnN2vv_pow", 2},
+        {"llvm.pow.f64", "_ZGVnN2vv_pow", 2},
+        {"powf", "_ZGVnN4vv_powf", 4},
+        {"llvm.pow.f32", "_ZGVnN4vv_powf", 4},
+    };
+    addVectorizableFunctions(VecFuncs);
+    break;
+  }
   case NoLibrary:
     break;
   }
@@ -1157,25 +1326,36 @@ bool TargetLibraryInfoImpl::isFunctionVectorizable(StringRef funcName) const {
   if (funcName.empty())
     return false;
 
-  std::vector<VecDesc>::const_iterator I = std::lower_bound(
-      VectorDescs.begin(), VectorDescs.end(), funcName,
-      compareWithScalarFnName);
-  return I != VectorDescs.end() && StringRef(I->ScalarFnName) == funcName;
+  return ScalarFnIndex.count(funcName);
 }
 
-StringRef TargetLibraryInfoImpl::getVectorizedFunction(StringRef F,
-                                                       unsigned VF) const {
+const VecDesc *
+TargetLibraryInfoImpl::findVectorizedFunction(StringRef F, unsigned VF) const {
   F = sanitizeFunctionName(F);
   if (F.empty())
-    return F;
-  std::vector<VecDesc>::const_iterator I = std::lower_bound(
-      VectorDescs.begin(), VectorDescs.end(), F, compareWithScalarFnName);
-  while (I != VectorDescs.end() && StringRef(I->ScalarFnName) == F) {
+    return nullptr;
+  auto Index = ScalarFnIndex.find(F);
+  if (Index == ScalarFnIndex.end())
+    return nullptr;
+  // The descriptors of F are contiguous in VectorDescs.
+  for (auto I = VectorDescs.begin() + Index->second;
+       I != VectorDescs.end() && I->ScalarFnName == F; ++I)
     if (I->VectorizationFactor == VF)
-      return I->VectorFnName;
-    ++I;
-  }
-  return StringRef();
+      return &*I;
+  return nullptr;
+}
+
+StringRef TargetLibraryInfoImpl::getVectorizedFunction(StringRef F,
+                                                       unsigned VF) const {
+  const VecDesc *D = findVectorizedFunction(F, VF);
+  return D ? D->VectorFnName : StringRef();
+}
+
+StringRef
+TargetLibraryInfoImpl::getVectorizedFunctionFeature(StringRef F,
+                                                    unsigned VF) const {
+  const VecDesc *D = findVectorizedFunction(F, VF);
+  return D ? D->RequiredFeature : StringRef();
 }
 
 StringRef TargetLibraryInfoImpl::getScalarizedFunction(StringRef F,
@@ -1184,12 +1364,12 @@ StringRef TargetLibraryInfoImpl::getScalarizedFunction(StringRef F,
   if (F.empty())
     return F;
 
-  std::vector<VecDesc>::const_iterator I = std::lower_bound(
-      ScalarDescs.begin(), ScalarDescs.end(), F, compareWithVectorFnName);
-  if (I == VectorDescs.end() || StringRef(I->VectorFnName) != F)
+  auto Index = VectorFnIndex.find(F);
+  if (Index == VectorFnIndex.end())
     return StringRef();
-  VF = I->VectorizationFactor;
-  return I->ScalarFnName;
+  const VecDesc &D = ScalarDescs[Index->second];
+  VF = D.VectorizationFactor;
+  return D.ScalarFnName;
 }
 
 TargetLibraryInfo TargetLibraryAnalysis::run(Module &M,
@@ -76,6 +76,8 @@ struct Query {
   AssumptionCache *AC;
   const Instruction *CxtI;
   const DominatorTree *DT;
+  /// Results of earlier queries, if the caller keeps them.
+  KnownBitsCache *Cache;
 
   /// Set of assumptions that should be excluded from further queries.
   /// This is because of the potential for mutual recursion to cause
@@ -90,11 +92,12 @@ struct Query {
   unsigned NumExcluded;
 
   Query(const DataLayout &DL, AssumptionCache *AC, const Instruction *CxtI,
-        const DominatorTree *DT)
-      : DL(DL), AC(AC), CxtI(CxtI), DT(DT), NumExcluded(0) {}
+        const DominatorTree *DT, KnownBitsCache *Cache = nullptr)
+      : DL(DL), AC(AC), CxtI(CxtI), DT(DT), Cache(Cache), NumExcluded(0) {}
 
   Query(const Query &Q, const Value *NewExcl)
-      : DL(Q.DL), AC(Q.AC), CxtI(Q.CxtI), DT(Q.DT), NumExcluded(Q.NumExcluded) {
+      : DL(Q.DL), AC(Q.AC), CxtI(Q.CxtI), DT(Q.DT), Cache(Q.Cache),
+        NumExcluded(Q.NumExcluded) {
     Excluded = Q.Excluded;
     Excluded[NumExcluded++] = NewExcl;
     assert(NumExcluded <= Excluded.size());
@@ -131,9 +134,9 @@ static void computeKnownBits(const Value *V, APInt &KnownZero, APInt &KnownOne,
 void llvm::computeKnownBits(const Value *V, APInt &KnownZero, APInt &KnownOne,
                             const DataLayout &DL, unsigned Depth,
                             AssumptionCache *AC, const Instruction *CxtI,
-                            const DominatorTree *DT) {
+                            const DominatorTree *DT, KnownBitsCache *Cache) {
   ::computeKnownBits(V, KnownZero, KnownOne, Depth,
-                     Query(DL, AC, safeCxtI(V, CxtI), DT));
+                     Query(DL, AC, safeCxtI(V, CxtI), DT, Cache));
 }
 
 bool llvm::haveNoCommonBitsSet(const Value *LHS, const Value *RHS,
@@ -158,9 +161,9 @@ static void ComputeSignBit(const Value *V, bool &KnownZero, bool &KnownOne,
 void llvm::ComputeSignBit(const Value *V, bool &KnownZero, bool &KnownOne,
                           const DataLayout &DL, unsigned Depth,
                           AssumptionCache *AC, const Instruction *CxtI,
-                          const DominatorTree *DT) {
+                          const DominatorTree *DT, KnownBitsCache *Cache) {
   ::ComputeSignBit(V, KnownZero, KnownOne, Depth,
-                   Query(DL, AC, safeCxtI(V, CxtI), DT));
+                   Query(DL, AC, safeCxtI(V, CxtI), DT, Cache));
 }
 
 static bool isKnownToBeAPowerOfTwo(const Value *V, bool OrZero, unsigned Depth,
@@ -229,19 +232,24 @@ static bool MaskedValueIsZero(const Value *V, const APInt &Mask, unsigned Depth,
 bool llvm::MaskedValueIsZero(const Value *V, const APInt &Mask,
                              const DataLayout &DL,
                              unsigned Depth, AssumptionCache *AC,
-                             const Instruction *CxtI, const DominatorTree *DT) {
+                             const Instruction *CxtI, const DominatorTree *DT,
+                             KnownBitsCache *Cache) {
   return ::MaskedValueIsZero(V, Mask, Depth,
-                             Query(DL, AC, safeCxtI(V, CxtI), DT));
+                             Query(DL, AC, safeCxtI(V, CxtI), DT, Cache));
 }
 
 static unsigned ComputeNumSignBits(const Value *V, unsigned Depth,
                                    const Query &Q);
+static unsigned ComputeNumSignBitsImpl(const Value *V, unsigned Depth,
+                                       const Query &Q);
 
 unsigned llvm::ComputeNumSignBits(const Value *V, const DataLayout &DL,
                                   unsigned Depth, AssumptionCache *AC,
                                   const Instruction *CxtI,
-                                  const DominatorTree *DT) {
-  return ::ComputeNumSignBits(V, Depth, Query(DL, AC, safeCxtI(V, CxtI), DT));
+                                  const DominatorTree *DT,
+                                  KnownBitsCache *Cache) {
+  return ::ComputeNumSignBits(V, Depth,
+                              Query(DL, AC, safeCxtI(V, CxtI), DT, Cache));
 }
 
 static void computeKnownBitsAddSub(bool Add, const Value *Op0, const Value *Op1,
@@ -1573,6 +1581,13 @@ void computeKnownBits(const Value *V, APInt &KnownZero, APInt &KnownOne,
     return;
   }
 
+  // Queries made while looking through an assume ignore some assumptions, so
+  // their results are neither taken from nor added to the cache.
+  bool UseCache = Q.Cache && Q.NumExcluded == 0;
+  if (UseCache &&
+      Q.Cache->lookupKnownBits(V, Q.CxtI, Depth, KnownZero, KnownOne))
+    return;
+
   if (const Operator *I = dyn_cast<Operator>(V))
     computeKnownBitsFromOperator(I, KnownZero, KnownOne, Depth, Q);
 
@@ -1590,6 +1605,9 @@ void computeKnownBits(const Value *V, APInt &KnownZero, APInt &KnownOne,
   computeKnownBitsFromAssume(V, KnownZero, KnownOne, Depth, Q);
 
   assert((KnownZero & KnownOne) == 0 && "Bits known to be one AND zero?");
+
+  if (UseCache)
+    Q.Cache->insertKnownBits(V, Q.CxtI, Depth, KnownZero, KnownOne);
 }
 
 /// Determine whether the sign bit is known to be zero or one.
@@ -2080,6 +2098,19 @@ static unsigned computeNumSignBitsVectorConstant(const Value *V,
 /// other, so we return 3. For vectors, return the number of sign bits for the
 /// vector element with the mininum number of known sign bits.
 unsigned ComputeNumSignBits(const Value *V, unsigned Depth, const Query &Q) {
+  if (!Q.Cache || Q.NumExcluded != 0 || isa<Constant>(V))
+    return ComputeNumSignBitsImpl(V, Depth, Q);
+
+  unsigned Result;
+  if (!Q.Cache->lookupNumSignBits(V, Q.CxtI, Depth, Result)) {
+    Result = ComputeNumSignBitsImpl(V, Depth, Q);
+    Q.Cache->insertNumSignBits(V, Q.CxtI, Depth, Result);
+  }
+  return Result;
+}
+
+static unsigned ComputeNumSignBitsImpl(const Value *V, unsigned Depth,
+                                       const Query &Q) {
   unsigned TyBits = Q.DL.getTypeSizeInBits(V->getType()->getScalarType());
   unsigned Tmp, Tmp2;
   unsigned FirstAnswer = 1;
@@ -23,6 +23,7 @@
 #include <cassert>
 #include <cctype>
 #include <cstdio>
+#include <cstring>
 
 using namespace llvm;
 
@@ -138,10 +139,51 @@ static void UnEscapeLexed(std::string &Str) {
   Str.resize(BOut-Buffer);
 }
 
+namespace {
+/// Character classes for the lexer's inner loops, which would otherwise call
+/// the <cctype> functions several times per character.
+enum CharClass : uint8_t {
+  CC_Digit = 1,  // [0-9]
+  CC_Letter = 2, // [a-zA-Z]
+  CC_Punct = 4,  // [-$._], allowed in names
+  CC_Space = 8   // [ \t\n\r]
+};
+} // end anonymous namespace
+
+/// The classes of the ASCII characters. Other characters are in none.
+static const uint8_t CharClasses[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, CC_Space, CC_Space, 0, 0, CC_Space, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    CC_Space, 0, 0, 0, CC_Punct, 0, 0, 0,
+    0, 0, 0, 0, 0, CC_Punct, CC_Punct, 0,
+    CC_Digit, CC_Digit, CC_Digit, CC_Digit,
+    CC_Digit, CC_Digit, CC_Digit, CC_Digit,
+    CC_Digit, CC_Digit, 0, 0, 0, 0, 0, 0,
+    0, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, 0, 0, 0, 0, CC_Punct,
+    0, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, CC_Letter,
+    CC_Letter, CC_Letter, CC_Letter, 0, 0, 0, 0, 0,
+};
+
+static bool isCharClass(char C, uint8_t Classes) {
+  return CharClasses[static_cast<unsigned char>(C)] & Classes;
+}
+
 /// isLabelChar - Return true for [-a-zA-Z$._0-9].
 static bool isLabelChar(char C) {
-  return isalnum(static_cast<unsigned char>(C)) || C == '-' || C == '$' ||
-         C == '.' || C == '_';
+  return isCharClass(C, CC_Digit | CC_Letter | CC_Punct);
 }
 
 /// isLabelTail - Return true if this pointer points to a valid end of a label.
@@ -180,6 +222,7 @@ int LLLexer::getNextChar() {
 }
 
 lltok::Kind LLLexer::LexToken() {
+  SkipWhitespaceAndComments();
   TokStart = CurPtr;
 
   int CurChar = getNextChar();
@@ -240,8 +283,28 @@ lltok::Kind LLLexer::LexToken() {
 
 void LLLexer::SkipLineComment() {
   while (true) {
-    if (CurPtr[0] == '\n' || CurPtr[0] == '\r' || getNextChar() == EOF)
+    // strcspn also stops at a nul, which only ends the comment if it is the
+    // end of the buffer.
+    CurPtr += strcspn(CurPtr, "\n\r");
+    if (CurPtr[0] != 0 || CurPtr == CurBuf.end())
       return;
+    ++CurPtr;
+  }
+}
+
+/// Skip everything LexToken would ignore, a whole run at a time.
+void LLLexer::SkipWhitespaceAndComments() {
+  while (true) {
+    while (isCharClass(CurPtr[0], CC_Space))
+      ++CurPtr;
+    if (CurPtr[0] == ';') {
+      ++CurPtr;
+      SkipLineComment();
+    } else if (CurPtr[0] == 0 && CurPtr != CurBuf.end()) {
+      ++CurPtr;
+    } else {
+      return;
+    }
   }
 }
 
@@ -311,13 +374,9 @@ lltok::Kind LLLexer::ReadString(lltok::Kind kind) {
 /// ReadVarName - Read the rest of a token containing a variable name.
 bool LLLexer::ReadVarName() {
   const char *NameStart = CurPtr;
-  if (isalpha(static_cast<unsigned char>(CurPtr[0])) ||
-      CurPtr[0] == '-' || CurPtr[0] == '$' ||
-      CurPtr[0] == '.' || CurPtr[0] == '_') {
+  if (isCharClass(CurPtr[0], CC_Letter | CC_Punct)) {
     ++CurPtr;
-    while (isalnum(static_cast<unsigned char>(CurPtr[0])) ||
-           CurPtr[0] == '-' || CurPtr[0] == '$' ||
-           CurPtr[0] == '.' || CurPtr[0] == '_')
+    while (isLabelChar(CurPtr[0]))
       ++CurPtr;
 
     StrVal.assign(NameStart, CurPtr);
@@ -402,13 +461,9 @@ lltok::Kind LLLexer::LexQuote() {
 ///    !
 lltok::Kind LLLexer::LexExclaim() {
   // Lex a metadata name as a MetadataVar.
-  if (isalpha(static_cast<unsigned char>(CurPtr[0])) ||
-      CurPtr[0] == '-' || CurPtr[0] == '$' ||
-      CurPtr[0] == '.' || CurPtr[0] == '_' || CurPtr[0] == '\\') {
+  if (isCharClass(CurPtr[0], CC_Letter | CC_Punct) || CurPtr[0] == '\\') {
     ++CurPtr;
-    while (isalnum(static_cast<unsigned char>(CurPtr[0])) ||
-           CurPtr[0] == '-' || CurPtr[0] == '$' ||
-           CurPtr[0] == '.' || CurPtr[0] == '_' || CurPtr[0] == '\\')
+    while (isLabelChar(CurPtr[0]) || CurPtr[0] == '\\')
       ++CurPtr;
 
     StrVal.assign(TokStart+1, CurPtr);   // Skip !
@@ -436,57 +491,20 @@ lltok::Kind LLLexer::LexHash() {
   return lltok::Error;
 }
 
-/// Lex a label, integer type, keyword, or hexadecimal integer constant.
-///    Label           [-a-zA-Z$._0-9]+:
-///    IntegerType     i[0-9]+
-///    Keyword         sdiv, float, ...
-///    HexIntConstant  [us]0x[0-9A-Fa-f]+
-lltok::Kind LLLexer::LexIdentifier() {
-  const char *StartChar = CurPtr;
-  const char *IntEnd = CurPtr[-1] == 'i' ? nullptr : StartChar;
-  const char *KeywordEnd = nullptr;
-
-  for (; isLabelChar(*CurPtr); ++CurPtr) {
-    // If we decide this is an integer, remember the end of the sequence.
-    if (!IntEnd && !isdigit(static_cast<unsigned char>(*CurPtr)))
-      IntEnd = CurPtr;
-    if (!KeywordEnd && !isalnum(static_cast<unsigned char>(*CurPtr)) &&
-        *CurPtr != '_')
-      KeywordEnd = CurPtr;
-  }
-
-  // If we stopped due to a colon, this really is a label.
-  if (*CurPtr == ':') {
-    StrVal.assign(StartChar-1, CurPtr++);
-    return lltok::LabelStr;
-  }
-
-  // Otherwise, this wasn't a label.  If this was valid as an integer type,
-  // return it.
-  if (!IntEnd) IntEnd = CurPtr;
-  if (IntEnd != StartChar) {
-    CurPtr = IntEnd;
-    uint64_t NumBits = atoull(StartChar, CurPtr);
-    if (NumBits < IntegerType::MIN_INT_BITS ||
-        NumBits > IntegerType::MAX_INT_BITS) {
-      Error("bitwidth for integer type out of range!");
-      return lltok::Error;
-    }
-    TyVal = IntegerType::get(Context, NumBits);
-    return lltok::Type;
-  }
-
-  // Otherwise, this was a letter sequence.  See which keyword this is.
-  if (!KeywordEnd) KeywordEnd = CurPtr;
-  CurPtr = KeywordEnd;
-  --StartChar;
-  StringRef Keyword(StartChar, CurPtr - StartChar);
-
+namespace {
+/// What a fixed keyword lexes to.
+struct KeywordInfo {
+  lltok::Kind Kind;
+  /// The opcode, for instruction keywords, or 0.
+  unsigned Opcode;
+  /// The type, for type keywords, or null.
+  Type *(*GetType)(LLVMContext &Context);
+};
+} // end anonymous namespace
+
+static void addKeywords(StringMap<KeywordInfo> &Map) {
 #define KEYWORD(STR)                                                           \
-  do {                                                                         \
-    if (Keyword == #STR)                                                       \
-      return lltok::kw_##STR;                                                  \
-  } while (false)
+  Map.insert({#STR, {lltok::kw_##STR, 0, nullptr}})
 
   KEYWORD(true);    KEYWORD(false);
   KEYWORD(declare); KEYWORD(define);
@@ -697,12 +715,8 @@ lltok::Kind LLLexer::LexIdentifier() {
 
   // Keywords for types.
 #define TYPEKEYWORD(STR, LLVMTY)                                               \
-  do {                                                                         \
-    if (Keyword == STR) {                                                      \
-      TyVal = LLVMTY;                                                          \
-      return lltok::Type;                                                      \
-    }                                                                          \
-  } while (false)
+  Map.insert({STR, {lltok::Type, 0,                                            \
+                    [](LLVMContext &Context) -> Type * { return LLVMTY; }}})
 
   TYPEKEYWORD("void",      Type::getVoidTy(Context));
   TYPEKEYWORD("half",      Type::getHalfTy(Context));
@@ -720,12 +734,7 @@ lltok::Kind LLLexer::LexIdentifier() {
 
   // Keywords for instructions.
 #define INSTKEYWORD(STR, Enum)                                                 \
-  do {                                                                         \
-    if (Keyword == #STR) {                                                     \
-      UIntVal = Instruction::Enum;                                             \
-      return lltok::kw_##STR;                                                  \
-    }                                                                          \
-  } while (false)
+  Map.insert({#STR, {lltok::kw_##STR, Instruction::Enum, nullptr}})
 
   INSTKEYWORD(add,   Add);  INSTKEYWORD(fadd,   FAdd);
   INSTKEYWORD(sub,   Sub);  INSTKEYWORD(fsub,   FSub);
@@ -782,6 +791,75 @@ lltok::Kind LLLexer::LexIdentifier() {
   INSTKEYWORD(cleanuppad,   CleanupPad);
 
 #undef INSTKEYWORD
+}
+
+/// Return the table of fixed keywords, built on first use. Looking an
+/// identifier up here is much cheaper than comparing it against every keyword.
+static const StringMap<KeywordInfo> &getKeywords() {
+  static const StringMap<KeywordInfo> Keywords = [] {
+    StringMap<KeywordInfo> Map;
+    addKeywords(Map);
+    return Map;
+  }();
+  return Keywords;
+}
+
+/// Lex a label, integer type, keyword, or hexadecimal integer constant.
+///    Label           [-a-zA-Z$._0-9]+:
+///    IntegerType     i[0-9]+
+///    Keyword         sdiv, float, ...
+///    HexIntConstant  [us]0x[0-9A-Fa-f]+
+lltok::Kind LLLexer::LexIdentifier() {
+  const char *StartChar = CurPtr;
+  const char *IntEnd = CurPtr[-1] == 'i' ? nullptr : StartChar;
+  const char *KeywordEnd = nullptr;
+
+  for (; isLabelChar(*CurPtr); ++CurPtr) {
+    // If we decide this is an integer, remember the end of the sequence.
+    if (!IntEnd && !isCharClass(*CurPtr, CC_Digit))
+      IntEnd = CurPtr;
+    if (!KeywordEnd && !isCharClass(*CurPtr, CC_Digit | CC_Letter) &&
+        *CurPtr != '_')
+      KeywordEnd = CurPtr;
+  }
+
+  // If we stopped due to a colon, this really is a label.
+  if (*CurPtr == ':') {
+    StrVal.assign(StartChar-1, CurPtr++);
+    return lltok::LabelStr;
+  }
+
+  // Otherwise, this wasn't a label.  If this was valid as an integer type,
+  // return it.
+  if (!IntEnd) IntEnd = CurPtr;
+  if (IntEnd != StartChar) {
+    CurPtr = IntEnd;
+    uint64_t NumBits = atoull(StartChar, CurPtr);
+    if (NumBits < IntegerType::MIN_INT_BITS ||
+        NumBits > IntegerType::MAX_INT_BITS) {
+      Error("bitwidth for integer type out of range!");
+      return lltok::Error;
+    }
+    TyVal = IntegerType::get(Context, NumBits);
+    return lltok::Type;
+  }
+
+  // Otherwise, this was a letter sequence.  See which keyword this is.
+  if (!KeywordEnd) KeywordEnd = CurPtr;
+  CurPtr = KeywordEnd;
+  --StartChar;
+  StringRef Keyword(StartChar, CurPtr - StartChar);
+
+  const StringMap<KeywordInfo> &Keywords = getKeywords();
+  auto KI = Keywords.find(Keyword);
+  if (KI != Keywords.end()) {
+    const KeywordInfo &Info = KI->second;
+    if (Info.GetType)
+      TyVal = Info.GetType(Context);
+    else if (Info.Opcode)
+      UIntVal = Info.Opcode;
+    return Info.Kind;
+  }
 
 #define DWKEYWORD(TYPE, TOKEN)                                                 \
   do {                                                                         \
@@ -71,6 +71,7 @@ namespace llvm {
 
     int getNextChar();
     void SkipLineComment();
+    void SkipWhitespaceAndComments();
     lltok::Kind ReadString(lltok::Kind kind);
     bool ReadVarName();
 
@@ -61,6 +61,28 @@ static std::string getTypeString(Type *T) {
   return Tmp.str();
 }
 
+/// Return the forward reference with the smallest name, so that errors about
+/// undefined values do not depend on the hash table's iteration order.
+template <typename T>
+static const StringMapEntry<T> &getFirstForwardRef(const StringMap<T> &Map) {
+  return *std::min_element(
+      Map.begin(), Map.end(),
+      [](const StringMapEntry<T> &A, const StringMapEntry<T> &B) {
+        return A.getKey() < B.getKey();
+      });
+}
+
+/// Return the forward reference with the smallest ID.
+template <typename T>
+static const typename DenseMap<uint64_t, T>::value_type &
+getFirstForwardRef(const DenseMap<uint64_t, T> &Map) {
+  typedef typename DenseMap<uint64_t, T>::value_type EntryTy;
+  return *std::min_element(Map.begin(), Map.end(),
+                           [](const EntryTy &A, const EntryTy &B) {
+                             return A.first < B.first;
+                           });
+}
+
 /// Run: module ::= toplevelentity*
 bool LLParser::Run() {
   // Prime the lexer.
@@ -201,20 +223,23 @@ bool LLParser::ValidateEndOfModule() {
                  "use of undefined comdat '$" +
                      ForwardRefComdats.begin()->first + "'");
 
-  if (!ForwardRefVals.empty())
-    return Error(ForwardRefVals.begin()->second.second,
-                 "use of undefined value '@" + ForwardRefVals.begin()->first +
-                 "'");
+  if (!ForwardRefVals.empty()) {
+    const auto &Ref = getFirstForwardRef(ForwardRefVals);
+    return Error(Ref.second.second,
+                 "use of undefined value '@" + Ref.getKey() + "'");
+  }
 
-  if (!ForwardRefValIDs.empty())
-    return Error(ForwardRefValIDs.begin()->second.second,
-                 "use of undefined value '@" +
-                 Twine(ForwardRefValIDs.begin()->first) + "'");
+  if (!ForwardRefValIDs.empty()) {
+    const auto &Ref = getFirstForwardRef(ForwardRefValIDs);
+    return Error(Ref.second.second,
+                 "use of undefined value '@" + Twine(Ref.first) + "'");
+  }
 
-  if (!ForwardRefMDNodes.empty())
-    return Error(ForwardRefMDNodes.begin()->second.second,
-                 "use of undefined metadata '!" +
-                 Twine(ForwardRefMDNodes.begin()->first) + "'");
+  if (!ForwardRefMDNodes.empty()) {
+    const auto &Ref = getFirstForwardRef(ForwardRefMDNodes);
+    return Error(Ref.second.second,
+                 "use of undefined metadata '!" + Twine(Ref.first) + "'");
+  }
 
   // Resolve metadata cycles.
   for (auto &N : NumberedMetadata) {
@@ -2488,14 +2513,16 @@ LLParser::PerFunctionState::~PerFunctionState() {
 }
 
 bool LLParser::PerFunctionState::FinishFunction() {
-  if (!ForwardRefVals.empty())
-    return P.Error(ForwardRefVals.begin()->second.second,
-                   "use of undefined value '%" + ForwardRefVals.begin()->first +
-                   "'");
-  if (!ForwardRefValIDs.empty())
-    return P.Error(ForwardRefValIDs.begin()->second.second,
-                   "use of undefined value '%" +
-                   Twine(ForwardRefValIDs.begin()->first) + "'");
+  if (!ForwardRefVals.empty()) {
+    const auto &Ref = getFirstForwardRef(ForwardRefVals);
+    return P.Error(Ref.second.second,
+                   "use of undefined value '%" + Ref.getKey() + "'");
+  }
+  if (!ForwardRefValIDs.empty()) {
+    const auto &Ref = getFirstForwardRef(ForwardRefValIDs);
+    return P.Error(Ref.second.second,
+                   "use of undefined value '%" + Twine(Ref.first) + "'");
+  }
   return false;
 }
 
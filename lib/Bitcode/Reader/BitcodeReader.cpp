@@ -10,6 +10,7 @@
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
@@ -90,6 +91,11 @@ static cl::opt<bool> PrintSummaryGUIDs(
     cl::desc(
         "Print the global id for each value when reading the module summary"));
 
+static cl::opt<bool> LazyLoadMetadataRecords(
+    "bitcode-lazy-metadata-records", cl::init(false), cl::Hidden,
+    cl::desc("When module metadata is loaded lazily, only parse the "
+             "metadata records that are actually referenced"));
+
 namespace {
 
 enum {
@@ -162,6 +168,12 @@ class BitcodeReaderMetadataList {
   /// move) on resize, and TrackingMDRef is very expensive to copy.
   SmallVector<TrackingMDRef, 1> MetadataPtrs;
 
+  /// IDs whose records have been indexed but not parsed yet.
+  BitVector PendingIDs;
+
+  /// Pending IDs that a forward reference has been handed out for.
+  SmallVector<unsigned, 16> RequestedIDs;
+
   /// Structures for resolving old type refs.
   struct {
     SmallDenseMap<MDString *, TempMDTuple, 1> Unknown;
@@ -180,7 +192,11 @@ public:
   unsigned size() const { return MetadataPtrs.size(); }
   void resize(unsigned N) { MetadataPtrs.resize(N); }
   void push_back(Metadata *MD) { MetadataPtrs.emplace_back(MD); }
-  void clear() { MetadataPtrs.clear(); }
+  void clear() {
+    MetadataPtrs.clear();
+    PendingIDs.clear();
+    RequestedIDs.clear();
+  }
   Metadata *back() const { return MetadataPtrs.back(); }
   void pop_back() { MetadataPtrs.pop_back(); }
   bool empty() const { return MetadataPtrs.empty(); }
@@ -212,11 +228,37 @@ public:
   /// would give \c false.
   Metadata *getMetadataIfResolved(unsigned Idx);
 
-  MDNode *getMDNodeFwdRefOrNull(unsigned Idx);
   void assignValue(Metadata *MD, unsigned Idx);
   void tryToResolveCycles();
   bool hasFwdRefs() const { return AnyFwdRefs; }
 
+  /// Mark \p Idx as indexed but not yet parsed.
+  void setPending(unsigned Idx) {
+    if (Idx >= PendingIDs.size())
+      PendingIDs.resize(Idx + 1);
+    PendingIDs.set(Idx);
+  }
+  void clearPending(unsigned Idx) { PendingIDs.reset(Idx); }
+  bool isPending(unsigned Idx) const {
+    return Idx < PendingIDs.size() && PendingIDs.test(Idx);
+  }
+
+  /// Pop an ID whose record still needs to be parsed because a forward
+  /// reference to it was created.  Returns false once there are none left.
+  bool popRequestedID(unsigned &Idx) {
+    while (!RequestedIDs.empty()) {
+      Idx = RequestedIDs.pop_back_val();
+      if (isPending(Idx))
+        return true;
+    }
+    return false;
+  }
+
+  /// Like \a tryToResolveCycles(), but only visit \p IDs.  Used after
+  /// loading a handful of lazily parsed nodes, where scanning every forward
+  /// reference slot would be needlessly expensive.
+  void tryToResolveCycles(ArrayRef<unsigned> IDs);
+
   /// Upgrade a type that had an MDString reference.
   void addTypeRef(MDString &UUID, DICompositeType &CT);
 
@@ -300,6 +342,21 @@ BitcodeReaderBase::initLazyStream(std::unique_ptr<DataStreamer> Streamer) {
   return std::error_code();
 }
 
+class PlaceholderQueue {
+  // Placeholders would thrash around when moved, so store in a std::deque
+  // instead of some sort of vector.
+  std::deque<DistinctMDOperandPlaceholder> PHs;
+
+public:
+  bool empty() const { return PHs.empty(); }
+  DistinctMDOperandPlaceholder &getPlaceholderOp(unsigned ID);
+  void flush(BitcodeReaderMetadataList &MetadataList);
+
+  /// Collect the IDs of placeholders whose records are still pending.
+  void getPendingIDs(const BitcodeReaderMetadataList &MetadataList,
+                     SmallVectorImpl<unsigned> &IDs) const;
+};
+
 class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   LLVMContext &Context;
   Module *TheModule = nullptr;
@@ -365,6 +422,21 @@ class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   /// which Metadata blocks are deferred.
   std::vector<uint64_t> DeferredMetadataInfo;
 
+  /// When deferred metadata is materialized, the module-level block is only
+  /// indexed: this cursor is left inside it (with its abbrevs) and
+  /// MetadataRecordOffsets has the bit offset of each node's record, indexed
+  /// by metadata ID.  Records are parsed when the node is first referenced.
+  BitstreamCursor MetadataCursor;
+  std::vector<uint64_t> MetadataRecordOffsets;
+
+  /// IDs parsed on demand since the last call to loadRequestedMetadata(), and
+  /// the placeholders created for their distinct nodes.
+  std::vector<unsigned> LoadedMetadataIDs;
+  PlaceholderQueue LazyPlaceholders;
+  unsigned LazyMetadataDepth = 0;
+  static const unsigned MaxLazyMetadataDepth = 64;
+  std::error_code LazyMetadataError;
+
   /// These are basic blocks forward-referenced by block addresses.  They are
   /// inserted lazily into functions when they're loaded.  The basic block ID is
   /// its index into the vector.
@@ -383,6 +455,11 @@ class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   /// (e.g.) blockaddress forward references.
   bool WillMaterializeAllForwardRefs = false;
 
+  /// True while materializeModule is parsing every function body. Intrinsic
+  /// call upgrades are then done once for the whole module instead of
+  /// rescanning every upgraded intrinsic's users after each body.
+  bool MaterializingModule = false;
+
   /// True if any Metadata block has been materialized.
   bool IsMetadataMaterialized = false;
 
@@ -455,9 +532,23 @@ private:
   }
 
   Metadata *getFnMetadataByID(unsigned ID) {
+    return getMetadataFwdRefOrLoad(ID);
+  }
+
+  /// Return the given metadata, parsing its record first if it has only been
+  /// indexed so far.  Operands are loaded recursively, so past
+  /// MaxLazyMetadataDepth this hands out a forward reference instead, which
+  /// loadRequestedMetadata() will resolve.
+  Metadata *getMetadataFwdRefOrLoad(unsigned ID) {
+    if (MetadataList.isPending(ID) && LazyMetadataDepth < MaxLazyMetadataDepth)
+      loadPendingMetadata(ID);
     return MetadataList.getMetadataFwdRef(ID);
   }
 
+  MDNode *getMDNodeFwdRefOrNull(unsigned ID) {
+    return dyn_cast_or_null<MDNode>(getMetadataFwdRefOrLoad(ID));
+  }
+
   BasicBlock *getBasicBlock(unsigned ID) const {
     if (ID >= FunctionBBs.size()) return nullptr; // Invalid ID
     return FunctionBBs[ID];
@@ -560,6 +651,15 @@ private:
   std::error_code globalCleanup();
   std::error_code resolveGlobalAndIndirectSymbolInits();
   std::error_code parseMetadata(bool ModuleLevel = false);
+  std::error_code indexModuleMetadata();
+  std::error_code parseNamedMetadata(BitstreamCursor &Cursor,
+                                     SmallVectorImpl<uint64_t> &Record);
+  std::error_code parseOneMetadata(
+      SmallVectorImpl<uint64_t> &Record, unsigned Code, StringRef Blob,
+      unsigned &NextMetadataNo, PlaceholderQueue &Placeholders,
+      std::vector<std::pair<DICompileUnit *, Metadata *>> &CUSubprograms);
+  void loadPendingMetadata(unsigned ID);
+  std::error_code loadRequestedMetadata();
   std::error_code parseMetadataStrings(ArrayRef<uint64_t> Record,
                                        StringRef Blob,
                                        unsigned &NextMetadataNo);
@@ -1240,6 +1340,10 @@ Metadata *BitcodeReaderMetadataList::getMetadataFwdRef(unsigned Idx) {
   }
   ++NumFwdRefs;
 
+  // The reader still has to parse the record for a pending ID.
+  if (isPending(Idx))
+    RequestedIDs.push_back(Idx);
+
   // Create and return a placeholder, which will later be RAUW'd.
   Metadata *MD = MDNode::getTemporary(Context, None).release();
   MetadataPtrs[Idx].reset(MD);
@@ -1254,10 +1358,6 @@ Metadata *BitcodeReaderMetadataList::getMetadataIfResolved(unsigned Idx) {
   return MD;
 }
 
-MDNode *BitcodeReaderMetadataList::getMDNodeFwdRefOrNull(unsigned Idx) {
-  return dyn_cast_or_null<MDNode>(getMetadataFwdRef(Idx));
-}
-
 void BitcodeReaderMetadataList::tryToResolveCycles() {
   if (NumFwdRefs)
     // Still forward references... can't resolve cycles.
@@ -1316,6 +1416,21 @@ void BitcodeReaderMetadataList::tryToResolveCycles() {
   AnyFwdRefs = false;
 }
 
+void BitcodeReaderMetadataList::tryToResolveCycles(ArrayRef<unsigned> IDs) {
+  if (NumFwdRefs || !AnyFwdRefs)
+    return;
+
+  for (unsigned I : IDs) {
+    auto *N = dyn_cast_or_null<MDNode>(MetadataPtrs[I].get());
+    if (!N)
+      continue;
+
+    assert(!N->isTemporary() && "Unexpected forward reference");
+    N->resolveCycles();
+  }
+  AnyFwdRefs = false;
+}
+
 void BitcodeReaderMetadataList::addTypeRef(MDString &UUID,
                                            DICompositeType &CT) {
   assert(CT.getRawIdentifier() == &UUID && "Mismatched UUID");
@@ -2187,20 +2302,6 @@ std::error_code BitcodeReader::parseMetadataStrings(ArrayRef<uint64_t> Record,
   return std::error_code();
 }
 
-namespace {
-
-class PlaceholderQueue {
-  // Placeholders would thrash around when moved, so store in a std::deque
-  // instead of some sort of vector.
-  std::deque<DistinctMDOperandPlaceholder> PHs;
-
-public:
-  DistinctMDOperandPlaceholder &getPlaceholderOp(unsigned ID);
-  void flush(BitcodeReaderMetadataList &MetadataList);
-};
-
-} // end anonymous namespace
-
 DistinctMDOperandPlaceholder &PlaceholderQueue::getPlaceholderOp(unsigned ID) {
   PHs.emplace_back(ID);
   return PHs.back();
@@ -2214,6 +2315,14 @@ void PlaceholderQueue::flush(BitcodeReaderMetadataList &MetadataList) {
   }
 }
 
+void PlaceholderQueue::getPendingIDs(
+    const BitcodeReaderMetadataList &MetadataList,
+    SmallVectorImpl<unsigned> &IDs) const {
+  for (const auto &PH : PHs)
+    if (MetadataList.isPending(PH.getID()))
+      IDs.push_back(PH.getID());
+}
+
 /// Parse a METADATA_BLOCK. If ModuleLevel is true then we are parsing
 /// module level metadata.
 std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
@@ -2231,12 +2340,96 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
 
   std::vector<std::pair<DICompileUnit *, Metadata *>> CUSubprograms;
   SmallVector<uint64_t, 64> Record;
-
   PlaceholderQueue Placeholders;
-  bool IsDistinct;
+
+  // Read all the records.
+  while (true) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      // Upgrade old-style CU <-> SP pointers to point from SP to CU.
+      for (auto CU_SP : CUSubprograms)
+        if (auto *SPs = dyn_cast_or_null<MDTuple>(CU_SP.second))
+          for (auto &Op : SPs->operands())
+            if (auto *SP = dyn_cast_or_null<MDNode>(Op))
+              SP->replaceOperandWith(7, CU_SP.first);
+
+      // Function-level blocks may pull in lazily loaded module metadata.
+      // Their distinct nodes hold untracked placeholders for it, so it has
+      // to be loaded (and resolved) before those are flushed below.
+      if (!ModuleLevel) {
+        SmallVector<unsigned, 8> IDs;
+        Placeholders.getPendingIDs(MetadataList, IDs);
+        for (unsigned ID : IDs)
+          if (MetadataList.isPending(ID))
+            loadPendingMetadata(ID);
+      }
+      if (std::error_code EC = loadRequestedMetadata())
+        return EC;
+
+      MetadataList.tryToResolveCycles();
+      Placeholders.flush(MetadataList);
+      return std::error_code();
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    // Read a record.
+    Record.clear();
+    StringRef Blob;
+    unsigned Code = Stream.readRecord(Entry.ID, Record, &Blob);
+    if (Code == bitc::METADATA_NAME) {
+      if (std::error_code EC = parseNamedMetadata(Stream, Record))
+        return EC;
+      continue;
+    }
+    if (std::error_code EC = parseOneMetadata(
+            Record, Code, Blob, NextMetadataNo, Placeholders, CUSubprograms))
+      return EC;
+  }
+}
+
+/// Parse a METADATA_NAME record and the METADATA_NAMED_NODE record that
+/// follows it in \p Cursor.
+std::error_code
+BitcodeReader::parseNamedMetadata(BitstreamCursor &Cursor,
+                                  SmallVectorImpl<uint64_t> &Record) {
+  // Read name of the named metadata.
+  SmallString<8> Name(Record.begin(), Record.end());
+  Record.clear();
+  unsigned Code = Cursor.ReadCode();
+
+  unsigned NextBitCode = Cursor.readRecord(Code, Record);
+  if (NextBitCode != bitc::METADATA_NAMED_NODE)
+    return error("METADATA_NAME not followed by METADATA_NAMED_NODE");
+
+  // Read named metadata elements.
+  unsigned Size = Record.size();
+  NamedMDNode *NMD = TheModule->getOrInsertNamedMetadata(Name);
+  for (unsigned i = 0; i != Size; ++i) {
+    MDNode *MD = getMDNodeFwdRefOrNull(Record[i]);
+    if (!MD)
+      return error("Invalid record");
+    NMD->addOperand(MD);
+  }
+  return std::error_code();
+}
+
+/// Parse a single record of a METADATA_BLOCK, assigning any metadata it
+/// defines starting at \p NextMetadataNo.
+std::error_code BitcodeReader::parseOneMetadata(
+    SmallVectorImpl<uint64_t> &Record, unsigned Code, StringRef Blob,
+    unsigned &NextMetadataNo, PlaceholderQueue &Placeholders,
+    std::vector<std::pair<DICompileUnit *, Metadata *>> &CUSubprograms) {
+  bool IsDistinct = false;
   auto getMD = [&](unsigned ID) -> Metadata * {
     if (!IsDistinct)
-      return MetadataList.getMetadataFwdRef(ID);
+      return getMetadataFwdRefOrLoad(ID);
     if (auto *MD = MetadataList.getMetadataIfResolved(ID))
       return MD;
     return &Placeholders.getPlaceholderOp(ID);
@@ -2265,608 +2458,780 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
 #define GET_OR_DISTINCT(CLASS, ARGS)                                           \
   (IsDistinct ? CLASS::getDistinct ARGS : CLASS::get ARGS)
 
-  // Read all the records.
-  while (true) {
-    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
-
-    switch (Entry.Kind) {
-    case BitstreamEntry::SubBlock: // Handled for us already.
-    case BitstreamEntry::Error:
-      return error("Malformed block");
-    case BitstreamEntry::EndBlock:
-      // Upgrade old-style CU <-> SP pointers to point from SP to CU.
-      for (auto CU_SP : CUSubprograms)
-        if (auto *SPs = dyn_cast_or_null<MDTuple>(CU_SP.second))
-          for (auto &Op : SPs->operands())
-            if (auto *SP = dyn_cast_or_null<MDNode>(Op))
-              SP->replaceOperandWith(7, CU_SP.first);
+  switch (Code) {
+  default:  // Default behavior: ignore.
+    break;
+  case bitc::METADATA_OLD_FN_NODE: {
+    // FIXME: Remove in 4.0.
+    // This is a LocalAsMetadata record, the only type of function-local
+    // metadata.
+    if (Record.size() % 2 == 1)
+      return error("Invalid record");
 
-      MetadataList.tryToResolveCycles();
-      Placeholders.flush(MetadataList);
-      return std::error_code();
-    case BitstreamEntry::Record:
-      // The interesting case.
+    // If this isn't a LocalAsMetadata record, we're dropping it.  This used
+    // to be legal, but there's no upgrade path.
+    auto dropRecord = [&] {
+      MetadataList.assignValue(MDNode::get(Context, None), NextMetadataNo++);
+    };
+    if (Record.size() != 2) {
+      dropRecord();
       break;
     }
 
-    // Read a record.
-    Record.clear();
-    StringRef Blob;
-    unsigned Code = Stream.readRecord(Entry.ID, Record, &Blob);
-    IsDistinct = false;
-    switch (Code) {
-    default:  // Default behavior: ignore.
+    Type *Ty = getTypeByID(Record[0]);
+    if (Ty->isMetadataTy() || Ty->isVoidTy()) {
+      dropRecord();
       break;
-    case bitc::METADATA_NAME: {
-      // Read name of the named metadata.
-      SmallString<8> Name(Record.begin(), Record.end());
-      Record.clear();
-      Code = Stream.ReadCode();
+    }
 
-      unsigned NextBitCode = Stream.readRecord(Code, Record);
-      if (NextBitCode != bitc::METADATA_NAMED_NODE)
-        return error("METADATA_NAME not followed by METADATA_NAMED_NODE");
+    MetadataList.assignValue(
+        LocalAsMetadata::get(ValueList.getValueFwdRef(Record[1], Ty)),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_OLD_NODE: {
+    // FIXME: Remove in 4.0.
+    if (Record.size() % 2 == 1)
+      return error("Invalid record");
 
-      // Read named metadata elements.
-      unsigned Size = Record.size();
-      NamedMDNode *NMD = TheModule->getOrInsertNamedMetadata(Name);
-      for (unsigned i = 0; i != Size; ++i) {
-        MDNode *MD = MetadataList.getMDNodeFwdRefOrNull(Record[i]);
-        if (!MD)
-          return error("Invalid record");
-        NMD->addOperand(MD);
-      }
-      break;
-    }
-    case bitc::METADATA_OLD_FN_NODE: {
-      // FIXME: Remove in 4.0.
-      // This is a LocalAsMetadata record, the only type of function-local
-      // metadata.
-      if (Record.size() % 2 == 1)
+    unsigned Size = Record.size();
+    SmallVector<Metadata *, 8> Elts;
+    for (unsigned i = 0; i != Size; i += 2) {
+      Type *Ty = getTypeByID(Record[i]);
+      if (!Ty)
         return error("Invalid record");
+      if (Ty->isMetadataTy())
+        Elts.push_back(getMD(Record[i + 1]));
+      else if (!Ty->isVoidTy()) {
+        auto *MD =
+            ValueAsMetadata::get(ValueList.getValueFwdRef(Record[i + 1], Ty));
+        assert(isa<ConstantAsMetadata>(MD) &&
+               "Expected non-function-local metadata");
+        Elts.push_back(MD);
+      } else
+        Elts.push_back(nullptr);
+    }
+    MetadataList.assignValue(MDNode::get(Context, Elts), NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_VALUE: {
+    if (Record.size() != 2)
+      return error("Invalid record");
 
-      // If this isn't a LocalAsMetadata record, we're dropping it.  This used
-      // to be legal, but there's no upgrade path.
-      auto dropRecord = [&] {
-        MetadataList.assignValue(MDNode::get(Context, None), NextMetadataNo++);
-      };
-      if (Record.size() != 2) {
-        dropRecord();
-        break;
-      }
+    Type *Ty = getTypeByID(Record[0]);
+    if (Ty->isMetadataTy() || Ty->isVoidTy())
+      return error("Invalid record");
 
-      Type *Ty = getTypeByID(Record[0]);
-      if (Ty->isMetadataTy() || Ty->isVoidTy()) {
-        dropRecord();
-        break;
-      }
+    MetadataList.assignValue(
+        ValueAsMetadata::get(ValueList.getValueFwdRef(Record[1], Ty)),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_DISTINCT_NODE:
+    IsDistinct = true;
+    LLVM_FALLTHROUGH;
+  case bitc::METADATA_NODE: {
+    SmallVector<Metadata *, 8> Elts;
+    Elts.reserve(Record.size());
+    for (unsigned ID : Record)
+      Elts.push_back(getMDOrNull(ID));
+    MetadataList.assignValue(IsDistinct ? MDNode::getDistinct(Context, Elts)
+                                        : MDNode::get(Context, Elts),
+                             NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_LOCATION: {
+    if (Record.size() != 5)
+      return error("Invalid record");
 
-      MetadataList.assignValue(
-          LocalAsMetadata::get(ValueList.getValueFwdRef(Record[1], Ty)),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_OLD_NODE: {
-      // FIXME: Remove in 4.0.
-      if (Record.size() % 2 == 1)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    unsigned Line = Record[1];
+    unsigned Column = Record[2];
+    Metadata *Scope = getMD(Record[3]);
+    Metadata *InlinedAt = getMDOrNull(Record[4]);
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DILocation,
+                        (Context, Line, Column, Scope, InlinedAt)),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_GENERIC_DEBUG: {
+    if (Record.size() < 4)
+      return error("Invalid record");
 
-      unsigned Size = Record.size();
-      SmallVector<Metadata *, 8> Elts;
-      for (unsigned i = 0; i != Size; i += 2) {
-        Type *Ty = getTypeByID(Record[i]);
-        if (!Ty)
-          return error("Invalid record");
-        if (Ty->isMetadataTy())
-          Elts.push_back(getMD(Record[i + 1]));
-        else if (!Ty->isVoidTy()) {
-          auto *MD =
-              ValueAsMetadata::get(ValueList.getValueFwdRef(Record[i + 1], Ty));
-          assert(isa<ConstantAsMetadata>(MD) &&
-                 "Expected non-function-local metadata");
-          Elts.push_back(MD);
-        } else
-          Elts.push_back(nullptr);
-      }
-      MetadataList.assignValue(MDNode::get(Context, Elts), NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_VALUE: {
-      if (Record.size() != 2)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    unsigned Tag = Record[1];
+    unsigned Version = Record[2];
 
-      Type *Ty = getTypeByID(Record[0]);
-      if (Ty->isMetadataTy() || Ty->isVoidTy())
-        return error("Invalid record");
+    if (Tag >= 1u << 16 || Version != 0)
+      return error("Invalid record");
 
-      MetadataList.assignValue(
-          ValueAsMetadata::get(ValueList.getValueFwdRef(Record[1], Ty)),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_DISTINCT_NODE:
-      IsDistinct = true;
-      LLVM_FALLTHROUGH;
-    case bitc::METADATA_NODE: {
-      SmallVector<Metadata *, 8> Elts;
-      Elts.reserve(Record.size());
-      for (unsigned ID : Record)
-        Elts.push_back(getMDOrNull(ID));
-      MetadataList.assignValue(IsDistinct ? MDNode::getDistinct(Context, Elts)
-                                          : MDNode::get(Context, Elts),
-                               NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_LOCATION: {
-      if (Record.size() != 5)
-        return error("Invalid record");
+    auto *Header = getMDString(Record[3]);
+    SmallVector<Metadata *, 8> DwarfOps;
+    for (unsigned I = 4, E = Record.size(); I != E; ++I)
+      DwarfOps.push_back(getMDOrNull(Record[I]));
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(GenericDINode, (Context, Tag, Header, DwarfOps)),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_SUBRANGE: {
+    if (Record.size() != 3)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      unsigned Line = Record[1];
-      unsigned Column = Record[2];
-      Metadata *Scope = getMD(Record[3]);
-      Metadata *InlinedAt = getMDOrNull(Record[4]);
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DILocation,
-                          (Context, Line, Column, Scope, InlinedAt)),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_GENERIC_DEBUG: {
-      if (Record.size() < 4)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DISubrange,
+                        (Context, Record[1], unrotateSign(Record[2]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_ENUMERATOR: {
+    if (Record.size() != 3)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      unsigned Tag = Record[1];
-      unsigned Version = Record[2];
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIEnumerator, (Context, unrotateSign(Record[1]),
+                                       getMDString(Record[2]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_BASIC_TYPE: {
+    if (Record.size() != 6)
+      return error("Invalid record");
 
-      if (Tag >= 1u << 16 || Version != 0)
-        return error("Invalid record");
-
-      auto *Header = getMDString(Record[3]);
-      SmallVector<Metadata *, 8> DwarfOps;
-      for (unsigned I = 4, E = Record.size(); I != E; ++I)
-        DwarfOps.push_back(getMDOrNull(Record[I]));
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(GenericDINode, (Context, Tag, Header, DwarfOps)),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_SUBRANGE: {
-      if (Record.size() != 3)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIBasicType,
+                        (Context, Record[1], getMDString(Record[2]),
+                         Record[3], Record[4], Record[5])),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_DERIVED_TYPE: {
+    if (Record.size() != 12)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DISubrange,
-                          (Context, Record[1], unrotateSign(Record[2]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_ENUMERATOR: {
-      if (Record.size() != 3)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[10]);
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIDerivedType,
+                        (Context, Record[1], getMDString(Record[2]),
+                         getMDOrNull(Record[3]), Record[4],
+                         getDITypeRefOrNull(Record[5]),
+                         getDITypeRefOrNull(Record[6]), Record[7], Record[8],
+                         Record[9], Flags, getDITypeRefOrNull(Record[11]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_COMPOSITE_TYPE: {
+    if (Record.size() != 16)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIEnumerator, (Context, unrotateSign(Record[1]),
-                                         getMDString(Record[2]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_BASIC_TYPE: {
-      if (Record.size() != 6)
-        return error("Invalid record");
+    // If we have a UUID and this is not a forward declaration, lookup the
+    // mapping.
+    IsDistinct = Record[0] & 0x1;
+    bool IsNotUsedInTypeRef = Record[0] >= 2;
+    unsigned Tag = Record[1];
+    MDString *Name = getMDString(Record[2]);
+    Metadata *File = getMDOrNull(Record[3]);
+    unsigned Line = Record[4];
+    Metadata *Scope = getDITypeRefOrNull(Record[5]);
+    Metadata *BaseType = getDITypeRefOrNull(Record[6]);
+    uint64_t SizeInBits = Record[7];
+    if (Record[8] > (uint64_t)std::numeric_limits<uint32_t>::max())
+      return error("Alignment value is too large");
+    uint32_t AlignInBits = Record[8];
+    uint64_t OffsetInBits = Record[9];
+    DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[10]);
+    Metadata *Elements = getMDOrNull(Record[11]);
+    unsigned RuntimeLang = Record[12];
+    Metadata *VTableHolder = getDITypeRefOrNull(Record[13]);
+    Metadata *TemplateParams = getMDOrNull(Record[14]);
+    auto *Identifier = getMDString(Record[15]);
+    DICompositeType *CT = nullptr;
+    if (Identifier)
+      CT = DICompositeType::buildODRType(
+          Context, *Identifier, Tag, Name, File, Line, Scope, BaseType,
+          SizeInBits, AlignInBits, OffsetInBits, Flags, Elements, RuntimeLang,
+          VTableHolder, TemplateParams);
+
+    // Create a node if we didn't get a lazy ODR type.
+    if (!CT)
+      CT = GET_OR_DISTINCT(DICompositeType,
+                           (Context, Tag, Name, File, Line, Scope, BaseType,
+                            SizeInBits, AlignInBits, OffsetInBits, Flags,
+                            Elements, RuntimeLang, VTableHolder,
+                            TemplateParams, Identifier));
+    if (!IsNotUsedInTypeRef && Identifier)
+      MetadataList.addTypeRef(*Identifier, *cast<DICompositeType>(CT));
+
+    MetadataList.assignValue(CT, NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_SUBROUTINE_TYPE: {
+    if (Record.size() < 3 || Record.size() > 4)
+      return error("Invalid record");
+    bool IsOldTypeRefArray = Record[0] < 2;
+    unsigned CC = (Record.size() > 3) ? Record[3] : 0;
+
+    IsDistinct = Record[0] & 0x1;
+    DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[1]);
+    Metadata *Types = getMDOrNull(Record[2]);
+    if (LLVM_UNLIKELY(IsOldTypeRefArray))
+      Types = MetadataList.upgradeTypeRefArray(Types);
+
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DISubroutineType, (Context, Flags, CC, Types)),
+        NextMetadataNo++);
+    break;
+  }
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIBasicType,
-                          (Context, Record[1], getMDString(Record[2]),
-                           Record[3], Record[4], Record[5])),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_DERIVED_TYPE: {
-      if (Record.size() != 12)
-        return error("Invalid record");
+  case bitc::METADATA_MODULE: {
+    if (Record.size() != 6)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[10]);
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIDerivedType,
-                          (Context, Record[1], getMDString(Record[2]),
-                           getMDOrNull(Record[3]), Record[4],
-                           getDITypeRefOrNull(Record[5]),
-                           getDITypeRefOrNull(Record[6]), Record[7], Record[8],
-                           Record[9], Flags, getDITypeRefOrNull(Record[11]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_COMPOSITE_TYPE: {
-      if (Record.size() != 16)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIModule,
+                        (Context, getMDOrNull(Record[1]),
+                         getMDString(Record[2]), getMDString(Record[3]),
+                         getMDString(Record[4]), getMDString(Record[5]))),
+        NextMetadataNo++);
+    break;
+  }
 
-      // If we have a UUID and this is not a forward declaration, lookup the
-      // mapping.
-      IsDistinct = Record[0] & 0x1;
-      bool IsNotUsedInTypeRef = Record[0] >= 2;
-      unsigned Tag = Record[1];
-      MDString *Name = getMDString(Record[2]);
-      Metadata *File = getMDOrNull(Record[3]);
-      unsigned Line = Record[4];
-      Metadata *Scope = getDITypeRefOrNull(Record[5]);
-      Metadata *BaseType = getDITypeRefOrNull(Record[6]);
-      uint64_t SizeInBits = Record[7];
-      if (Record[8] > (uint64_t)std::numeric_limits<uint32_t>::max())
-        return error("Alignment value is too large");
-      uint32_t AlignInBits = Record[8];
-      uint64_t OffsetInBits = Record[9];
-      DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[10]);
-      Metadata *Elements = getMDOrNull(Record[11]);
-      unsigned RuntimeLang = Record[12];
-      Metadata *VTableHolder = getDITypeRefOrNull(Record[13]);
-      Metadata *TemplateParams = getMDOrNull(Record[14]);
-      auto *Identifier = getMDString(Record[15]);
-      DICompositeType *CT = nullptr;
-      if (Identifier)
-        CT = DICompositeType::buildODRType(
-            Context, *Identifier, Tag, Name, File, Line, Scope, BaseType,
-            SizeInBits, AlignInBits, OffsetInBits, Flags, Elements, RuntimeLang,
-            VTableHolder, TemplateParams);
+  case bitc::METADATA_FILE: {
+    if (Record.size() != 3)
+      return error("Invalid record");
 
-      // Create a node if we didn't get a lazy ODR type.
-      if (!CT)
-        CT = GET_OR_DISTINCT(DICompositeType,
-                             (Context, Tag, Name, File, Line, Scope, BaseType,
-                              SizeInBits, AlignInBits, OffsetInBits, Flags,
-                              Elements, RuntimeLang, VTableHolder,
-                              TemplateParams, Identifier));
-      if (!IsNotUsedInTypeRef && Identifier)
-        MetadataList.addTypeRef(*Identifier, *cast<DICompositeType>(CT));
-
-      MetadataList.assignValue(CT, NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_SUBROUTINE_TYPE: {
-      if (Record.size() < 3 || Record.size() > 4)
-        return error("Invalid record");
-      bool IsOldTypeRefArray = Record[0] < 2;
-      unsigned CC = (Record.size() > 3) ? Record[3] : 0;
-
-      IsDistinct = Record[0] & 0x1;
-      DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[1]);
-      Metadata *Types = getMDOrNull(Record[2]);
-      if (LLVM_UNLIKELY(IsOldTypeRefArray))
-        Types = MetadataList.upgradeTypeRefArray(Types);
-
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DISubroutineType, (Context, Flags, CC, Types)),
-          NextMetadataNo++);
-      break;
-    }
-
-    case bitc::METADATA_MODULE: {
-      if (Record.size() != 6)
-        return error("Invalid record");
-
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIModule,
-                          (Context, getMDOrNull(Record[1]),
-                           getMDString(Record[2]), getMDString(Record[3]),
-                           getMDString(Record[4]), getMDString(Record[5]))),
-          NextMetadataNo++);
-      break;
-    }
-
-    case bitc::METADATA_FILE: {
-      if (Record.size() != 3)
-        return error("Invalid record");
-
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIFile, (Context, getMDString(Record[1]),
-                                   getMDString(Record[2]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_COMPILE_UNIT: {
-      if (Record.size() < 14 || Record.size() > 17)
-        return error("Invalid record");
-
-      // Ignore Record[0], which indicates whether this compile unit is
-      // distinct.  It's always distinct.
-      IsDistinct = true;
-      auto *CU = DICompileUnit::getDistinct(
-          Context, Record[1], getMDOrNull(Record[2]), getMDString(Record[3]),
-          Record[4], getMDString(Record[5]), Record[6], getMDString(Record[7]),
-          Record[8], getMDOrNull(Record[9]), getMDOrNull(Record[10]),
-          getMDOrNull(Record[12]), getMDOrNull(Record[13]),
-          Record.size() <= 15 ? nullptr : getMDOrNull(Record[15]),
-          Record.size() <= 14 ? 0 : Record[14],
-          Record.size() <= 16 ? true : Record[16]);
-
-      MetadataList.assignValue(CU, NextMetadataNo++);
-
-      // Move the Upgrade the list of subprograms.
-      if (Metadata *SPs = getMDOrNullWithoutPlaceholders(Record[11]))
-        CUSubprograms.push_back({CU, SPs});
-      break;
-    }
-    case bitc::METADATA_SUBPROGRAM: {
-      if (Record.size() < 18 || Record.size() > 20)
-        return error("Invalid record");
-
-      IsDistinct =
-          (Record[0] & 1) || Record[8]; // All definitions should be distinct.
-      // Version 1 has a Function as Record[15].
-      // Version 2 has removed Record[15].
-      // Version 3 has the Unit as Record[15].
-      // Version 4 added thisAdjustment.
-      bool HasUnit = Record[0] >= 2;
-      if (HasUnit && Record.size() < 19)
-        return error("Invalid record");
-      Metadata *CUorFn = getMDOrNull(Record[15]);
-      unsigned Offset = Record.size() >= 19 ? 1 : 0;
-      bool HasFn = Offset && !HasUnit;
-      bool HasThisAdj = Record.size() >= 20;
-      DISubprogram *SP = GET_OR_DISTINCT(
-          DISubprogram, (Context,
-                         getDITypeRefOrNull(Record[1]),  // scope
-                         getMDString(Record[2]),         // name
-                         getMDString(Record[3]),         // linkageName
-                         getMDOrNull(Record[4]),         // file
-                         Record[5],                      // line
-                         getMDOrNull(Record[6]),         // type
-                         Record[7],                      // isLocal
-                         Record[8],                      // isDefinition
-                         Record[9],                      // scopeLine
-                         getDITypeRefOrNull(Record[10]), // containingType
-                         Record[11],                     // virtuality
-                         Record[12],                     // virtualIndex
-                         HasThisAdj ? Record[19] : 0,    // thisAdjustment
-                         static_cast<DINode::DIFlags>(Record[13] // flags
-                                                      ),
-                         Record[14],                       // isOptimized
-                         HasUnit ? CUorFn : nullptr,       // unit
-                         getMDOrNull(Record[15 + Offset]), // templateParams
-                         getMDOrNull(Record[16 + Offset]), // declaration
-                         getMDOrNull(Record[17 + Offset])  // variables
-                         ));
-      MetadataList.assignValue(SP, NextMetadataNo++);
-
-      // Upgrade sp->function mapping to function->sp mapping.
-      if (HasFn) {
-        if (auto *CMD = dyn_cast_or_null<ConstantAsMetadata>(CUorFn))
-          if (auto *F = dyn_cast<Function>(CMD->getValue())) {
-            if (F->isMaterializable())
-              // Defer until materialized; unmaterialized functions may not have
-              // metadata.
-              FunctionsWithSPs[F] = SP;
-            else if (!F->empty())
-              F->setSubprogram(SP);
-          }
-      }
-      break;
-    }
-    case bitc::METADATA_LEXICAL_BLOCK: {
-      if (Record.size() != 5)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIFile, (Context, getMDString(Record[1]),
+                                 getMDString(Record[2]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_COMPILE_UNIT: {
+    if (Record.size() < 14 || Record.size() > 17)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DILexicalBlock,
-                          (Context, getMDOrNull(Record[1]),
-                           getMDOrNull(Record[2]), Record[3], Record[4])),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_LEXICAL_BLOCK_FILE: {
-      if (Record.size() != 4)
-        return error("Invalid record");
+    // Ignore Record[0], which indicates whether this compile unit is
+    // distinct.  It's always distinct.
+    IsDistinct = true;
+    auto *CU = DICompileUnit::getDistinct(
+        Context, Record[1], getMDOrNull(Record[2]), getMDString(Record[3]),
+        Record[4], getMDString(Record[5]), Record[6], getMDString(Record[7]),
+        Record[8], getMDOrNull(Record[9]), getMDOrNull(Record[10]),
+        getMDOrNull(Record[12]), getMDOrNull(Record[13]),
+        Record.size() <= 15 ? nullptr : getMDOrNull(Record[15]),
+        Record.size() <= 14 ? 0 : Record[14],
+        Record.size() <= 16 ? true : Record[16]);
+
+    MetadataList.assignValue(CU, NextMetadataNo++);
+
+    // Move the Upgrade the list of subprograms.
+    if (Metadata *SPs = getMDOrNullWithoutPlaceholders(Record[11]))
+      CUSubprograms.push_back({CU, SPs});
+    break;
+  }
+  case bitc::METADATA_SUBPROGRAM: {
+    if (Record.size() < 18 || Record.size() > 20)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DILexicalBlockFile,
-                          (Context, getMDOrNull(Record[1]),
-                           getMDOrNull(Record[2]), Record[3])),
-          NextMetadataNo++);
-      break;
+    IsDistinct =
+        (Record[0] & 1) || Record[8]; // All definitions should be distinct.
+    // Version 1 has a Function as Record[15].
+    // Version 2 has removed Record[15].
+    // Version 3 has the Unit as Record[15].
+    // Version 4 added thisAdjustment.
+    bool HasUnit = Record[0] >= 2;
+    if (HasUnit && Record.size() < 19)
+      return error("Invalid record");
+    Metadata *CUorFn = getMDOrNull(Record[15]);
+    unsigned Offset = Record.size() >= 19 ? 1 : 0;
+    bool HasFn = Offset && !HasUnit;
+    bool HasThisAdj = Record.size() >= 20;
+    DISubprogram *SP = GET_OR_DISTINCT(
+        DISubprogram, (Context,
+                       getDITypeRefOrNull(Record[1]),  // scope
+                       getMDString(Record[2]),         // name
+                       getMDString(Record[3]),         // linkageName
+                       getMDOrNull(Record[4]),         // file
+                       Record[5],                      // line
+                       getMDOrNull(Record[6]),         // type
+                       Record[7],                      // isLocal
+                       Record[8],                      // isDefinition
+                       Record[9],                      // scopeLine
+                       getDITypeRefOrNull(Record[10]), // containingType
+                       Record[11],                     // virtuality
+                       Record[12],                     // virtualIndex
+                       HasThisAdj ? Record[19] : 0,    // thisAdjustment
+                       static_cast<DINode::DIFlags>(Record[13] // flags
+                                                    ),
+                       Record[14],                       // isOptimized
+                       HasUnit ? CUorFn : nullptr,       // unit
+                       getMDOrNull(Record[15 + Offset]), // templateParams
+                       getMDOrNull(Record[16 + Offset]), // declaration
+                       getMDOrNull(Record[17 + Offset])  // variables
+                       ));
+    MetadataList.assignValue(SP, NextMetadataNo++);
+
+    // Upgrade sp->function mapping to function->sp mapping.
+    if (HasFn) {
+      if (auto *CMD = dyn_cast_or_null<ConstantAsMetadata>(CUorFn))
+        if (auto *F = dyn_cast<Function>(CMD->getValue())) {
+          if (F->isMaterializable())
+            // Defer until materialized; unmaterialized functions may not have
+            // metadata.
+            FunctionsWithSPs[F] = SP;
+          else if (!F->empty())
+            F->setSubprogram(SP);
+        }
     }
-    case bitc::METADATA_NAMESPACE: {
-      if (Record.size() != 5)
-        return error("Invalid record");
+    break;
+  }
+  case bitc::METADATA_LEXICAL_BLOCK: {
+    if (Record.size() != 5)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DINamespace, (Context, getMDOrNull(Record[1]),
-                                        getMDOrNull(Record[2]),
-                                        getMDString(Record[3]), Record[4])),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_MACRO: {
-      if (Record.size() != 5)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DILexicalBlock,
+                        (Context, getMDOrNull(Record[1]),
+                         getMDOrNull(Record[2]), Record[3], Record[4])),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_LEXICAL_BLOCK_FILE: {
+    if (Record.size() != 4)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIMacro,
-                          (Context, Record[1], Record[2],
-                           getMDString(Record[3]), getMDString(Record[4]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_MACRO_FILE: {
-      if (Record.size() != 5)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DILexicalBlockFile,
+                        (Context, getMDOrNull(Record[1]),
+                         getMDOrNull(Record[2]), Record[3])),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_NAMESPACE: {
+    if (Record.size() != 5)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIMacroFile,
-                          (Context, Record[1], Record[2],
-                           getMDOrNull(Record[3]), getMDOrNull(Record[4]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_TEMPLATE_TYPE: {
-      if (Record.size() != 3)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DINamespace, (Context, getMDOrNull(Record[1]),
+                                      getMDOrNull(Record[2]),
+                                      getMDString(Record[3]), Record[4])),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_MACRO: {
+    if (Record.size() != 5)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(GET_OR_DISTINCT(DITemplateTypeParameter,
-                                               (Context, getMDString(Record[1]),
-                                                getDITypeRefOrNull(Record[2]))),
-                               NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_TEMPLATE_VALUE: {
-      if (Record.size() != 5)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIMacro,
+                        (Context, Record[1], Record[2],
+                         getMDString(Record[3]), getMDString(Record[4]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_MACRO_FILE: {
+    if (Record.size() != 5)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DITemplateValueParameter,
-                          (Context, Record[1], getMDString(Record[2]),
-                           getDITypeRefOrNull(Record[3]),
-                           getMDOrNull(Record[4]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_GLOBAL_VAR: {
-      if (Record.size() < 11 || Record.size() > 12)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIMacroFile,
+                        (Context, Record[1], Record[2],
+                         getMDOrNull(Record[3]), getMDOrNull(Record[4]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_TEMPLATE_TYPE: {
+    if (Record.size() != 3)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
+    IsDistinct = Record[0];
+    MetadataList.assignValue(GET_OR_DISTINCT(DITemplateTypeParameter,
+                                             (Context, getMDString(Record[1]),
+                                              getDITypeRefOrNull(Record[2]))),
+                             NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_TEMPLATE_VALUE: {
+    if (Record.size() != 5)
+      return error("Invalid record");
 
-      // Upgrade old metadata, which stored a global variable reference or a
-      // ConstantInt here.
-      Metadata *Expr = getMDOrNull(Record[9]);
-      uint64_t AlignInBits = (Record.size() > 11) ? Record[11] : 0;
-      GlobalVariable *Attach = nullptr;
-      if (auto *CMD = dyn_cast_or_null<ConstantAsMetadata>(Expr)) {
-        if (auto *GV = dyn_cast<GlobalVariable>(CMD->getValue())) {
-          Attach = GV;
-          Expr = nullptr;
-        } else if (auto *CI = dyn_cast<ConstantInt>(CMD->getValue())) {
-          Expr = DIExpression::get(Context,
-                                   {dwarf::DW_OP_constu, CI->getZExtValue(),
-                                    dwarf::DW_OP_stack_value});
-        } else {
-          Expr = nullptr;
-        }
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DITemplateValueParameter,
+                        (Context, Record[1], getMDString(Record[2]),
+                         getDITypeRefOrNull(Record[3]),
+                         getMDOrNull(Record[4]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_GLOBAL_VAR: {
+    if (Record.size() < 11 || Record.size() > 12)
+      return error("Invalid record");
+
+    IsDistinct = Record[0];
+
+    // Upgrade old metadata, which stored a global variable reference or a
+    // ConstantInt here.
+    Metadata *Expr = getMDOrNull(Record[9]);
+    uint64_t AlignInBits = (Record.size() > 11) ? Record[11] : 0;
+    GlobalVariable *Attach = nullptr;
+    if (auto *CMD = dyn_cast_or_null<ConstantAsMetadata>(Expr)) {
+      if (auto *GV = dyn_cast<GlobalVariable>(CMD->getValue())) {
+        Attach = GV;
+        Expr = nullptr;
+      } else if (auto *CI = dyn_cast<ConstantInt>(CMD->getValue())) {
+        Expr = DIExpression::get(Context,
+                                 {dwarf::DW_OP_constu, CI->getZExtValue(),
+                                  dwarf::DW_OP_stack_value});
+      } else {
+        Expr = nullptr;
       }
+    }
 
-      DIGlobalVariable *DGV = GET_OR_DISTINCT(
-          DIGlobalVariable,
-          (Context, getMDOrNull(Record[1]), getMDString(Record[2]),
-           getMDString(Record[3]), getMDOrNull(Record[4]), Record[5],
-           getDITypeRefOrNull(Record[6]), Record[7], Record[8], Expr,
-           getMDOrNull(Record[10]), AlignInBits));
-      MetadataList.assignValue(DGV, NextMetadataNo++);
+    DIGlobalVariable *DGV = GET_OR_DISTINCT(
+        DIGlobalVariable,
+        (Context, getMDOrNull(Record[1]), getMDString(Record[2]),
+         getMDString(Record[3]), getMDOrNull(Record[4]), Record[5],
+         getDITypeRefOrNull(Record[6]), Record[7], Record[8], Expr,
+         getMDOrNull(Record[10]), AlignInBits));
+    MetadataList.assignValue(DGV, NextMetadataNo++);
 
-      if (Attach)
-        Attach->addDebugInfo(DGV);
+    if (Attach)
+      Attach->addDebugInfo(DGV);
 
-      break;
-    }
-    case bitc::METADATA_LOCAL_VAR: {
-      // 10th field is for the obseleted 'inlinedAt:' field.
-      if (Record.size() < 8 || Record.size() > 10)
-        return error("Invalid record");
+    break;
+  }
+  case bitc::METADATA_LOCAL_VAR: {
+    // 10th field is for the obseleted 'inlinedAt:' field.
+    if (Record.size() < 8 || Record.size() > 10)
+      return error("Invalid record");
 
-      IsDistinct = Record[0] & 1;
-      bool HasAlignment = Record[0] & 2;
-      // 2nd field used to be an artificial tag, either DW_TAG_auto_variable or
-      // DW_TAG_arg_variable, if we have alignment flag encoded it means, that
-      // this is newer version of record which doesn't have artifical tag.
-      bool HasTag = !HasAlignment && Record.size() > 8;
-      DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[7 + HasTag]);
-      uint64_t AlignInBits = HasAlignment ? Record[8 + HasTag] : 0;
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DILocalVariable,
-                          (Context, getMDOrNull(Record[1 + HasTag]),
-                           getMDString(Record[2 + HasTag]),
-                           getMDOrNull(Record[3 + HasTag]), Record[4 + HasTag],
-                           getDITypeRefOrNull(Record[5 + HasTag]),
-                           Record[6 + HasTag], Flags, AlignInBits)),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_EXPRESSION: {
-      if (Record.size() < 1)
-        return error("Invalid record");
+    IsDistinct = Record[0] & 1;
+    bool HasAlignment = Record[0] & 2;
+    // 2nd field used to be an artificial tag, either DW_TAG_auto_variable or
+    // DW_TAG_arg_variable, if we have alignment flag encoded it means, that
+    // this is newer version of record which doesn't have artifical tag.
+    bool HasTag = !HasAlignment && Record.size() > 8;
+    DINode::DIFlags Flags = static_cast<DINode::DIFlags>(Record[7 + HasTag]);
+    uint64_t AlignInBits = HasAlignment ? Record[8 + HasTag] : 0;
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DILocalVariable,
+                        (Context, getMDOrNull(Record[1 + HasTag]),
+                         getMDString(Record[2 + HasTag]),
+                         getMDOrNull(Record[3 + HasTag]), Record[4 + HasTag],
+                         getDITypeRefOrNull(Record[5 + HasTag]),
+                         Record[6 + HasTag], Flags, AlignInBits)),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_EXPRESSION: {
+    if (Record.size() < 1)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIExpression,
-                          (Context, makeArrayRef(Record).slice(1))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_OBJC_PROPERTY: {
-      if (Record.size() != 8)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIExpression,
+                        (Context, makeArrayRef(Record).slice(1))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_OBJC_PROPERTY: {
+    if (Record.size() != 8)
+      return error("Invalid record");
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIObjCProperty,
-                          (Context, getMDString(Record[1]),
-                           getMDOrNull(Record[2]), Record[3],
-                           getMDString(Record[4]), getMDString(Record[5]),
-                           Record[6], getDITypeRefOrNull(Record[7]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_IMPORTED_ENTITY: {
-      if (Record.size() != 6)
-        return error("Invalid record");
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIObjCProperty,
+                        (Context, getMDString(Record[1]),
+                         getMDOrNull(Record[2]), Record[3],
+                         getMDString(Record[4]), getMDString(Record[5]),
+                         Record[6], getDITypeRefOrNull(Record[7]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_IMPORTED_ENTITY: {
+    if (Record.size() != 6)
+      return error("Invalid record");
+
+    IsDistinct = Record[0];
+    MetadataList.assignValue(
+        GET_OR_DISTINCT(DIImportedEntity,
+                        (Context, Record[1], getMDOrNull(Record[2]),
+                         getDITypeRefOrNull(Record[3]), Record[4],
+                         getMDString(Record[5]))),
+        NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_STRING_OLD: {
+    std::string String(Record.begin(), Record.end());
+
+    // Test for upgrading !llvm.loop.
+    HasSeenOldLoopTags |= mayBeOldLoopAttachmentTag(String);
+
+    Metadata *MD = MDString::get(Context, String);
+    MetadataList.assignValue(MD, NextMetadataNo++);
+    break;
+  }
+  case bitc::METADATA_STRINGS:
+    if (std::error_code EC =
+            parseMetadataStrings(Record, Blob, NextMetadataNo))
+      return EC;
+    break;
+  case bitc::METADATA_GLOBAL_DECL_ATTACHMENT: {
+    if (Record.size() % 2 == 0)
+      return error("Invalid record");
+    unsigned ValueID = Record[0];
+    if (ValueID >= ValueList.size())
+      return error("Invalid record");
+    if (auto *GO = dyn_cast<GlobalObject>(ValueList[ValueID]))
+      parseGlobalObjectAttachment(*GO, ArrayRef<uint64_t>(Record).slice(1));
+    break;
+  }
+  case bitc::METADATA_KIND: {
+    // Support older bitcode files that had METADATA_KIND records in a
+    // block with METADATA_BLOCK_ID.
+    if (std::error_code EC = parseMetadataKindRecord(Record))
+      return EC;
+    break;
+  }
+  }
+  return std::error_code();
+
+#undef GET_OR_DISTINCT
+}
 
-      IsDistinct = Record[0];
-      MetadataList.assignValue(
-          GET_OR_DISTINCT(DIImportedEntity,
-                          (Context, Record[1], getMDOrNull(Record[2]),
-                           getDITypeRefOrNull(Record[3]), Record[4],
-                           getMDString(Record[5]))),
-          NextMetadataNo++);
-      break;
-    }
-    case bitc::METADATA_STRING_OLD: {
-      std::string String(Record.begin(), Record.end());
+/// Index a module-level METADATA_BLOCK instead of parsing it.  Strings are
+/// read right away, named metadata and global attachments once the block has
+/// been scanned, and every other node when it is first referenced.  Blocks
+/// that need upgrades spanning several records are parsed eagerly.
+std::error_code BitcodeReader::indexModuleMetadata() {
+  uint64_t BlockBit = Stream.GetCurrentBitNo();
+  if (Stream.EnterSubBlock(bitc::METADATA_BLOCK_ID))
+    return error("Invalid record");
 
-      // Test for upgrading !llvm.loop.
-      HasSeenOldLoopTags |= mayBeOldLoopAttachmentTag(String);
+  unsigned FirstMetadataNo = MetadataList.size();
+  unsigned NextMetadataNo = FirstMetadataNo;
+  std::vector<uint64_t> Offsets(NextMetadataNo);
+  SmallVector<uint64_t, 8> DeferredRecords;
+  BitVector IsValue;
+  SmallVector<uint64_t, 64> Record;
+  bool NeedsEagerParse = false;
 
-      Metadata *MD = MDString::get(Context, String);
-      MetadataList.assignValue(MD, NextMetadataNo++);
+  while (true) {
+    uint64_t RecordBit = Stream.GetCurrentBitNo();
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks(
+        BitstreamCursor::AF_DontPopBlockAtEnd |
+        BitstreamCursor::AF_DontAutoprocessAbbrevs);
+    if (Entry.Kind == BitstreamEntry::EndBlock)
       break;
+    if (Entry.Kind != BitstreamEntry::Record)
+      return error("Malformed block");
+    if (Entry.ID == bitc::DEFINE_ABBREV) {
+      Stream.ReadAbbrevRecord();
+      continue;
+    }
+    if (NeedsEagerParse) {
+      Stream.skipRecord(Entry.ID);
+      continue;
     }
+
+    Record.clear();
+    StringRef Blob;
+    unsigned Code = Stream.readRecord(Entry.ID, Record, &Blob);
+    switch (Code) {
+    default: // Default behavior: ignore.
+      continue;
     case bitc::METADATA_STRINGS:
       if (std::error_code EC =
               parseMetadataStrings(Record, Blob, NextMetadataNo))
         return EC;
-      break;
-    case bitc::METADATA_GLOBAL_DECL_ATTACHMENT: {
-      if (Record.size() % 2 == 0)
-        return error("Invalid record");
-      unsigned ValueID = Record[0];
-      if (ValueID >= ValueList.size())
-        return error("Invalid record");
-      if (auto *GO = dyn_cast<GlobalObject>(ValueList[ValueID]))
-        parseGlobalObjectAttachment(*GO, ArrayRef<uint64_t>(Record).slice(1));
-      break;
-    }
-    case bitc::METADATA_KIND: {
-      // Support older bitcode files that had METADATA_KIND records in a
-      // block with METADATA_BLOCK_ID.
-      if (std::error_code EC = parseMetadataKindRecord(Record))
-        return EC;
-      break;
-    }
+      Offsets.resize(NextMetadataNo);
+      continue;
+    case bitc::METADATA_NAME: {
+      DeferredRecords.push_back(RecordBit);
+      // Skip the METADATA_NAMED_NODE that follows.
+      unsigned AbbrevID = Stream.ReadCode();
+      if (Stream.readRecord(AbbrevID, Record) != bitc::METADATA_NAMED_NODE)
+        return error("METADATA_NAME not followed by METADATA_NAMED_NODE");
+      continue;
     }
+    case bitc::METADATA_KIND:
+    case bitc::METADATA_GLOBAL_DECL_ATTACHMENT:
+      DeferredRecords.push_back(RecordBit);
+      continue;
+
+    // These records are upgraded in ways that need to see the whole block.
+    case bitc::METADATA_STRING_OLD:
+    case bitc::METADATA_OLD_NODE:
+    case bitc::METADATA_OLD_FN_NODE:
+      NeedsEagerParse = true;
+      continue;
+    case bitc::METADATA_COMPOSITE_TYPE:
+      // Old-style type refs.
+      if (Record.size() == 16 && Record[0] < 2 && Record[15])
+        NeedsEagerParse = true;
+      break;
+    case bitc::METADATA_SUBROUTINE_TYPE:
+      // Old-style type ref arrays.
+      if (!Record.empty() && Record[0] < 2)
+        NeedsEagerParse = true;
+      break;
+    case bitc::METADATA_COMPILE_UNIT:
+      // Old-style CU -> SP pointers.
+      if (Record.size() > 11 && Record[11])
+        NeedsEagerParse = true;
+      break;
+    case bitc::METADATA_SUBPROGRAM:
+      // Old-style SP -> function pointers.
+      if (Record.size() >= 19 && Record[0] < 2)
+        NeedsEagerParse = true;
+      break;
+    case bitc::METADATA_GLOBAL_VAR:
+      // Old-style references to a global variable or constant.
+      if (Record.size() > 9 && Record[9] &&
+          (Record[9] > NextMetadataNo ||
+           (Record[9] - 1 < IsValue.size() && IsValue.test(Record[9] - 1))))
+        NeedsEagerParse = true;
+      break;
+    case bitc::METADATA_VALUE:
+      IsValue.resize(NextMetadataNo + 1);
+      IsValue.set(NextMetadataNo);
+      break;
+    case bitc::METADATA_NODE:
+    case bitc::METADATA_DISTINCT_NODE:
+    case bitc::METADATA_LOCATION:
+    case bitc::METADATA_GENERIC_DEBUG:
+    case bitc::METADATA_SUBRANGE:
+    case bitc::METADATA_ENUMERATOR:
+    case bitc::METADATA_BASIC_TYPE:
+    case bitc::METADATA_DERIVED_TYPE:
+    case bitc::METADATA_MODULE:
+    case bitc::METADATA_FILE:
+    case bitc::METADATA_LEXICAL_BLOCK:
+    case bitc::METADATA_LEXICAL_BLOCK_FILE:
+    case bitc::METADATA_NAMESPACE:
+    case bitc::METADATA_MACRO:
+    case bitc::METADATA_MACRO_FILE:
+    case bitc::METADATA_TEMPLATE_TYPE:
+    case bitc::METADATA_TEMPLATE_VALUE:
+    case bitc::METADATA_LOCAL_VAR:
+    case bitc::METADATA_EXPRESSION:
+    case bitc::METADATA_OBJC_PROPERTY:
+    case bitc::METADATA_IMPORTED_ENTITY:
+      break;
+    }
+
+    // This record defines the next node.
+    Offsets.push_back(RecordBit);
+    ++NextMetadataNo;
   }
 
-#undef GET_OR_DISTINCT
+  // Keep a cursor with the block's abbrevs installed before leaving it.
+  if (!NeedsEagerParse)
+    MetadataCursor = Stream;
+  if (Stream.ReadBlockEnd())
+    return error("Malformed block");
+
+  if (NeedsEagerParse) {
+    MetadataList.shrinkTo(FirstMetadataNo);
+    Stream.JumpToBit(BlockBit);
+    return parseMetadata(true);
+  }
+
+  IsMetadataMaterialized = true;
+  MetadataList.resize(NextMetadataNo);
+  for (unsigned ID = FirstMetadataNo; ID != NextMetadataNo; ++ID)
+    if (Offsets[ID])
+      MetadataList.setPending(ID);
+  MetadataRecordOffsets = std::move(Offsets);
+
+  // Named metadata and global attachments are the roots that keep module
+  // metadata alive; load them and whatever they reference.
+  std::vector<std::pair<DICompileUnit *, Metadata *>> CUSubprograms;
+  for (uint64_t Bit : DeferredRecords) {
+    MetadataCursor.JumpToBit(Bit);
+    Record.clear();
+    StringRef Blob;
+    unsigned Code =
+        MetadataCursor.readRecord(MetadataCursor.ReadCode(), Record, &Blob);
+    std::error_code EC =
+        Code == bitc::METADATA_NAME
+            ? parseNamedMetadata(MetadataCursor, Record)
+            : parseOneMetadata(Record, Code, Blob, NextMetadataNo,
+                               LazyPlaceholders, CUSubprograms);
+    if (EC)
+      return EC;
+  }
+  return loadRequestedMetadata();
+}
+
+/// Parse the record for the indexed metadata \p ID.  Errors are reported by
+/// the next call to loadRequestedMetadata().
+void BitcodeReader::loadPendingMetadata(unsigned ID) {
+  MetadataList.clearPending(ID);
+  if (LazyMetadataError)
+    return;
+
+  SmallVector<uint64_t, 64> Record;
+  StringRef Blob;
+  MetadataCursor.JumpToBit(MetadataRecordOffsets[ID]);
+  unsigned Code =
+      MetadataCursor.readRecord(MetadataCursor.ReadCode(), Record, &Blob);
+
+  unsigned NextMetadataNo = ID;
+  std::vector<std::pair<DICompileUnit *, Metadata *>> CUSubprograms;
+  ++LazyMetadataDepth;
+  std::error_code EC = parseOneMetadata(Record, Code, Blob, NextMetadataNo,
+                                        LazyPlaceholders, CUSubprograms);
+  --LazyMetadataDepth;
+  if (EC) {
+    LazyMetadataError = EC;
+    return;
+  }
+  assert(NextMetadataNo == ID + 1 && "Expected a single metadata node");
+  assert(CUSubprograms.empty() && "Unexpected old-style compile unit");
+  LoadedMetadataIDs.push_back(ID);
+}
+
+/// Parse the records of any indexed metadata that forward references or
+/// distinct node placeholders have been handed out for, then resolve it.
+std::error_code BitcodeReader::loadRequestedMetadata() {
+  if (MetadataRecordOffsets.empty())
+    return std::error_code();
+
+  SmallVector<unsigned, 8> IDs;
+  while (true) {
+    unsigned ID;
+    while (!LazyMetadataError && MetadataList.popRequestedID(ID))
+      loadPendingMetadata(ID);
+    if (LazyMetadataError)
+      return LazyMetadataError;
+
+    IDs.clear();
+    LazyPlaceholders.getPendingIDs(MetadataList, IDs);
+    if (IDs.empty())
+      break;
+    for (unsigned ID : IDs)
+      if (MetadataList.isPending(ID))
+        loadPendingMetadata(ID);
+  }
+
+  MetadataList.tryToResolveCycles(LoadedMetadataIDs);
+  LoadedMetadataIDs.clear();
+  LazyPlaceholders.flush(MetadataList);
+  return std::error_code();
 }
 
 /// Parse the metadata kinds out of the METADATA_KIND_BLOCK.
@@ -3555,10 +3920,13 @@ std::error_code BitcodeReader::rememberAndSkipMetadata() {
 }
 
 std::error_code BitcodeReader::materializeMetadata() {
+  // A single module-level block can be indexed and loaded on demand.
+  bool Index = LazyLoadMetadataRecords && DeferredMetadataInfo.size() == 1;
   for (uint64_t BitPos : DeferredMetadataInfo) {
     // Move the bit stream to the saved position.
     Stream.JumpToBit(BitPos);
-    if (std::error_code EC = parseMetadata(true))
+    std::error_code EC = Index ? indexModuleMetadata() : parseMetadata(true);
+    if (EC)
       return EC;
   }
   DeferredMetadataInfo.clear();
@@ -4347,7 +4715,7 @@ std::error_code BitcodeReader::parseGlobalObjectAttachment(
     auto K = MDKindMap.find(Record[I]);
     if (K == MDKindMap.end())
       return error("Invalid ID");
-    MDNode *MD = MetadataList.getMDNodeFwdRefOrNull(Record[I + 1]);
+    MDNode *MD = getMDNodeFwdRefOrNull(Record[I + 1]);
     if (!MD)
       return error("Invalid metadata attachment");
     GO.addMetadata(K->second, *MD);
@@ -4476,6 +4844,12 @@ std::error_code BitcodeReader::parseMetadataAttachment(Function &F) {
           MDKindMap.find(Kind);
         if (I == MDKindMap.end())
           return error("Invalid ID");
+        // Operands nested deeper than MaxLazyMetadataDepth are only forward
+        // references so far. Finish loading them so that the node is resolved
+        // before it is upgraded and attached.
+        getMetadataFwdRefOrLoad(Record[i + 1]);
+        if (std::error_code EC = loadRequestedMetadata())
+          return EC;
         Metadata *Node = MetadataList.getMetadataFwdRef(Record[i + 1]);
         if (isa<LocalAsMetadata>(Node))
           // Drop the attachment.  This used to be legal, but there's no
@@ -4657,12 +5031,12 @@ std::error_code BitcodeReader::parseFunctionBody(Function *F) {
 
       MDNode *Scope = nullptr, *IA = nullptr;
       if (ScopeID) {
-        Scope = MetadataList.getMDNodeFwdRefOrNull(ScopeID - 1);
+        Scope = getMDNodeFwdRefOrNull(ScopeID - 1);
         if (!Scope)
           return error("Invalid record");
       }
       if (IAID) {
-        IA = MetadataList.getMDNodeFwdRefOrNull(IAID - 1);
+        IA = getMDNodeFwdRefOrNull(IAID - 1);
         if (!IA)
           return error("Invalid record");
       }
@@ -5790,6 +6164,10 @@ OutOfRecordLoop:
     }
   }
 
+  // Finish loading any module metadata the body referenced.
+  if (std::error_code EC = loadRequestedMetadata())
+    return EC;
+
   // Unexpected unresolved metadata about to be dropped.
   if (MetadataList.hasFwdRefs())
     return error("Invalid function metadata: outgoing forward refs");
@@ -5853,23 +6231,29 @@ std::error_code BitcodeReader::materialize(GlobalValue *GV) {
   if (StripDebugInfo)
     stripDebugInfo(*F);
 
-  // Upgrade any old intrinsic calls in the function.
-  for (auto &I : UpgradedIntrinsics) {
-    for (auto UI = I.first->materialized_user_begin(), UE = I.first->user_end();
-         UI != UE;) {
-      User *U = *UI;
-      ++UI;
-      if (CallInst *CI = dyn_cast<CallInst>(U))
-        UpgradeIntrinsicCall(CI, I.second);
+  // Upgrade any old intrinsic calls in the function. When the whole module is
+  // being materialized this is left to materializeModule, which handles all
+  // calls at once.
+  if (!MaterializingModule) {
+    for (auto &I : UpgradedIntrinsics) {
+      for (auto UI = I.first->materialized_user_begin(),
+                UE = I.first->user_end();
+           UI != UE;) {
+        User *U = *UI;
+        ++UI;
+        if (CallInst *CI = dyn_cast<CallInst>(U))
+          UpgradeIntrinsicCall(CI, I.second);
+      }
     }
-  }
 
-  // Update calls to the remangled intrinsics
-  for (auto &I : RemangledIntrinsics)
-    for (auto UI = I.first->materialized_user_begin(), UE = I.first->user_end();
-         UI != UE;)
-      // Don't expect any other users than call sites
-      CallSite(*UI++).setCalledFunction(I.second);
+    // Update calls to the remangled intrinsics
+    for (auto &I : RemangledIntrinsics)
+      for (auto UI = I.first->materialized_user_begin(),
+                UE = I.first->user_end();
+           UI != UE;)
+        // Don't expect any other users than call sites
+        CallSite(*UI++).setCalledFunction(I.second);
+  }
 
   // Finish fn->subprogram upgrade for materialized functions.
   if (DISubprogram *SP = FunctionsWithSPs.lookup(F))
@@ -5889,10 +6273,14 @@ std::error_code BitcodeReader::materializeModule() {
 
   // Iterate over the module, deserializing any functions that are still on
   // disk.
+  MaterializingModule = true;
   for (Function &F : *TheModule) {
-    if (std::error_code EC = materialize(&F))
+    if (std::error_code EC = materialize(&F)) {
+      MaterializingModule = false;
       return EC;
+    }
   }
+  MaterializingModule = false;
   // At this point, if there are any function bodies, parse the rest of
   // the bits in the module past the last function block we have recorded
   // through either lazy scanning or the VST.
@@ -5905,12 +6293,15 @@ std::error_code BitcodeReader::materializeModule() {
   if (!BasicBlockFwdRefs.empty())
     return error("Never resolved function from blockaddress");
 
-  // Upgrade any intrinsic calls that slipped through (should not happen!) and
+  // Upgrade all calls to the old intrinsics in one pass over their users and
   // delete the old functions to clean up. We can't do this unless the entire
   // module is materialized because there could always be another function body
   // with calls to the old function.
   for (auto &I : UpgradedIntrinsics) {
-    for (auto *U : I.first->users()) {
+    for (auto UI = I.first->user_begin(), UE = I.first->user_end();
+         UI != UE;) {
+      User *U = *UI;
+      ++UI;
       if (CallInst *CI = dyn_cast<CallInst>(U))
         UpgradeIntrinsicCall(CI, I.second);
     }
@@ -6228,9 +6619,12 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
   }
   const uint64_t Version = Record[0];
   const bool IsOldProfileFormat = Version == 1;
-  if (!IsOldProfileFormat && Version != 2)
+  if (Version < 1 || Version > 3)
     return error("Invalid summary version " + Twine(Version) +
-                 ", 1 or 2 expected");
+                 ", 1, 2 or 3 expected");
+  // Version 3 added the read-only and write-only reference counts, and the
+  // flags of global variables in the combined index.
+  const bool HasRefAccessCounts = Version >= 3;
   Record.clear();
 
   // Keep around the last seen summary to be used when we see an optional
@@ -6274,10 +6668,10 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
     switch (BitCode) {
     default: // Default behavior: ignore.
       break;
-    // FS_PERMODULE: [valueid, flags, instcount, numrefs, numrefs x valueid,
-    //                n x (valueid)]
-    // FS_PERMODULE_PROFILE: [valueid, flags, instcount, numrefs,
-    //                        numrefs x valueid,
+    // FS_PERMODULE: [valueid, flags, instcount, numrefs, rorefcnt, worefcnt,
+    //                numrefs x valueid, n x (valueid)]
+    // FS_PERMODULE_PROFILE: [valueid, flags, instcount, numrefs, rorefcnt,
+    //                        worefcnt, numrefs x valueid,
     //                        n x (valueid, hotness)]
     case bitc::FS_PERMODULE:
     case bitc::FS_PERMODULE_PROFILE: {
@@ -6285,6 +6679,15 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       uint64_t RawFlags = Record[1];
       unsigned InstCount = Record[2];
       unsigned NumRefs = Record[3];
+      unsigned RefListStartIndex = 4;
+      unsigned NumReadOnlyRefs = 0, NumWriteOnlyRefs = 0;
+      if (HasRefAccessCounts) {
+        NumReadOnlyRefs = Record[4];
+        NumWriteOnlyRefs = Record[5];
+        RefListStartIndex = 6;
+        if (NumReadOnlyRefs + NumWriteOnlyRefs > NumRefs)
+          return error("Invalid record");
+      }
       auto Flags = getDecodedGVSummaryFlags(RawFlags, Version);
       std::unique_ptr<FunctionSummary> FS =
           llvm::make_unique<FunctionSummary>(Flags, InstCount);
@@ -6295,15 +6698,16 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       // ownership.
       FS->setModulePath(
           TheIndex->addModulePath(Buffer->getBufferIdentifier(), 0)->first());
-      static int RefListStartIndex = 4;
       int CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
       assert(Record.size() >= RefListStartIndex + NumRefs &&
              "Record size inconsistent with number of references");
-      for (unsigned I = 4, E = CallGraphEdgeStartIndex; I != E; ++I) {
+      for (unsigned I = RefListStartIndex, E = CallGraphEdgeStartIndex; I != E;
+           ++I) {
         unsigned RefValueId = Record[I];
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
         FS->addRefEdge(RefGUID);
       }
+      FS->setRefAccessCounts(NumReadOnlyRefs, NumWriteOnlyRefs);
       bool HasProfile = (BitCode == bitc::FS_PERMODULE_PROFILE);
       for (unsigned I = CallGraphEdgeStartIndex, E = Record.size(); I != E;
            ++I) {
@@ -6365,10 +6769,11 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       TheIndex->addGlobalValueSummary(GUID.first, std::move(FS));
       break;
     }
-    // FS_COMBINED: [valueid, modid, flags, instcount, numrefs,
-    //               numrefs x valueid, n x (valueid)]
+    // FS_COMBINED: [valueid, modid, flags, instcount, numrefs, rorefcnt,
+    //               worefcnt, numrefs x valueid, n x (valueid)]
     // FS_COMBINED_PROFILE: [valueid, modid, flags, instcount, numrefs,
-    //                       numrefs x valueid, n x (valueid, hotness)]
+    //                       rorefcnt, worefcnt, numrefs x valueid,
+    //                       n x (valueid, hotness)]
     case bitc::FS_COMBINED:
     case bitc::FS_COMBINED_PROFILE: {
       unsigned ValueID = Record[0];
@@ -6376,12 +6781,20 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       uint64_t RawFlags = Record[2];
       unsigned InstCount = Record[3];
       unsigned NumRefs = Record[4];
+      unsigned RefListStartIndex = 5;
+      unsigned NumReadOnlyRefs = 0, NumWriteOnlyRefs = 0;
+      if (HasRefAccessCounts) {
+        NumReadOnlyRefs = Record[5];
+        NumWriteOnlyRefs = Record[6];
+        RefListStartIndex = 7;
+        if (NumReadOnlyRefs + NumWriteOnlyRefs > NumRefs)
+          return error("Invalid record");
+      }
       auto Flags = getDecodedGVSummaryFlags(RawFlags, Version);
       std::unique_ptr<FunctionSummary> FS =
           llvm::make_unique<FunctionSummary>(Flags, InstCount);
       LastSeenSummary = FS.get();
       FS->setModulePath(ModuleIdMap[ModuleId]);
-      static int RefListStartIndex = 5;
       int CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
       assert(Record.size() >= RefListStartIndex + NumRefs &&
              "Record size inconsistent with number of references");
@@ -6391,6 +6804,7 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
         FS->addRefEdge(RefGUID);
       }
+      FS->setRefAccessCounts(NumReadOnlyRefs, NumWriteOnlyRefs);
       bool HasProfile = (BitCode == bitc::FS_COMBINED_PROFILE);
       for (unsigned I = CallGraphEdgeStartIndex, E = Record.size(); I != E;
            ++I) {
@@ -6430,7 +6844,8 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       Combined = true;
       break;
     }
-    // FS_COMBINED_GLOBALVAR_INIT_REFS: [valueid, modid, flags, n x valueid]
+    // FS_COMBINED_GLOBALVAR_INIT_REFS: [valueid, modid, flags, varflags,
+    //                                   n x valueid]
     case bitc::FS_COMBINED_GLOBALVAR_INIT_REFS: {
       unsigned ValueID = Record[0];
       uint64_t ModuleId = Record[1];
@@ -6440,7 +6855,14 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
           llvm::make_unique<GlobalVarSummary>(Flags);
       LastSeenSummary = FS.get();
       FS->setModulePath(ModuleIdMap[ModuleId]);
-      for (unsigned I = 3, E = Record.size(); I != E; ++I) {
+      unsigned RefListStartIndex = 3;
+      if (HasRefAccessCounts) {
+        uint64_t RawVarFlags = Record[3];
+        FS->setReadOnly(RawVarFlags & 0x1);
+        FS->setWriteOnly(RawVarFlags & 0x2);
+        RefListStartIndex = 4;
+      }
+      for (unsigned I = RefListStartIndex, E = Record.size(); I != E; ++I) {
         unsigned RefValueId = Record[I];
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
         FS->addRefEdge(RefGUID);
@@ -6458,7 +6880,44 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseEntireSummary() {
       LastSeenSummary->setOriginalName(OriginalName);
       // Reset the LastSeenSummary
       LastSeenSummary = nullptr;
+      break;
+    }
+    // FS_TYPE_ID: [unknown, typeidlen, typeid x char,
+    //              n x (offset, numtargets, numtargets x (len, x char))]
+    case bitc::FS_TYPE_ID: {
+      unsigned I = 1, E = Record.size();
+      auto ReadString = [&](std::string &Str) {
+        if (I == E || Record[I] > E - I - 1)
+          return false;
+        uint64_t Len = Record[I++];
+        Str.assign(Record.begin() + I, Record.begin() + I + Len);
+        I += Len;
+        return true;
+      };
+      std::string TypeIdName;
+      if (E == 0 || !ReadString(TypeIdName))
+        return error("Invalid record");
+      TypeIdSummary &TypeId = TheIndex->getOrInsertTypeIdSummary(TypeIdName);
+      TypeId.Unknown |= Record[0] != 0;
+      while (I != E) {
+        if (E - I < 2)
+          return error("Invalid record");
+        uint64_t Offset = Record[I++];
+        uint64_t NumTargets = Record[I++];
+        std::set<std::string> &Targets = TypeId.SlotTargets[Offset];
+        for (uint64_t T = 0; T != NumTargets; ++T) {
+          std::string Target;
+          if (!ReadString(Target))
+            return error("Invalid record");
+          Targets.insert(Target);
+        }
+      }
+      break;
     }
+    // FS_INCOMPLETE: []
+    case bitc::FS_INCOMPLETE:
+      TheIndex->setIncomplete();
+      break;
     }
   }
   llvm_unreachable("Exit infinite loop");
@@ -6581,6 +7040,352 @@ std::error_code ModuleSummaryIndexBitcodeReader::parseSummaryIndexInto(
 
 namespace {
 
+/// Reads the module-level records describing global values, without creating
+/// a Module. See readBitcodeSymbolTable().
+class BitcodeSymbolTableReader : public BitcodeReaderBase {
+  BitcodeSymbolTable &Symtab;
+
+  /// The global values in value id order.
+  enum GlobalKind { FunctionKind, VariableKind, AliasKind, IFuncKind };
+  struct GlobalEntry {
+    GlobalKind Kind;
+    BitcodeGlobalValue GV;
+    /// For aliases, the value id of the aliasee.
+    uint64_t AliaseeID = 0;
+    /// Old bitcode gave some linkages a comdat named after the global value.
+    bool HasImplicitComdat = false;
+  };
+  std::vector<GlobalEntry> Globals;
+  std::vector<std::string> SectionTable;
+  std::vector<std::string> ComdatList;
+
+public:
+  BitcodeSymbolTableReader(MemoryBuffer *Buffer, BitcodeSymbolTable &Symtab)
+      : BitcodeReaderBase(Buffer), Symtab(Symtab) {}
+  ~BitcodeSymbolTableReader() override { Buffer.release(); }
+
+  std::error_code read();
+
+private:
+  std::error_code error(const Twine &Message) override {
+    return make_error_code(BitcodeError::CorruptedBitcode);
+  }
+
+  std::error_code parseModule();
+  std::error_code parseGlobalRecord(unsigned BitCode,
+                                    ArrayRef<uint64_t> Record);
+  std::error_code parseValueSymbolTable();
+  std::error_code collectGlobalValues();
+  std::string getSection(uint64_t ID) const {
+    return ID && ID <= SectionTable.size() ? SectionTable[ID - 1] : "";
+  }
+};
+
+} // end anonymous namespace
+
+std::error_code BitcodeSymbolTableReader::read() {
+  if (std::error_code EC = initStreamFromBuffer())
+    return EC;
+
+  if (!hasValidBitcodeHeader(Stream))
+    return error("Invalid bitcode signature");
+
+  while (true) {
+    if (Stream.AtEndOfStream())
+      return error("Malformed block");
+
+    BitstreamEntry Entry =
+        Stream.advance(BitstreamCursor::AF_DontAutoprocessAbbrevs);
+    if (Entry.Kind != BitstreamEntry::SubBlock)
+      return error("Malformed block");
+
+    if (Entry.ID == bitc::MODULE_BLOCK_ID)
+      return parseModule();
+
+    if (Stream.SkipBlock())
+      return error("Invalid record");
+  }
+}
+
+std::error_code BitcodeSymbolTableReader::parseModule() {
+  if (Stream.EnterSubBlock(bitc::MODULE_BLOCK_ID))
+    return error("Invalid record");
+
+  SmallVector<uint64_t, 64> Record;
+  while (true) {
+    BitstreamEntry Entry = Stream.advance();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      return collectGlobalValues();
+
+    case BitstreamEntry::SubBlock:
+      switch (Entry.ID) {
+      default: // Everything else, including function bodies, is skipped.
+        if (Stream.SkipBlock())
+          return error("Invalid record");
+        break;
+      case bitc::BLOCKINFO_BLOCK_ID:
+        // Needed for the abbrevs of the VST.
+        if (Stream.ReadBlockInfoBlock())
+          return error("Malformed block");
+        break;
+      case bitc::VALUE_SYMTAB_BLOCK_ID:
+        // Whether or not there is a VST forward declaration, the module-level
+        // VST is found in the stream once every function block is skipped.
+        if (std::error_code EC = parseValueSymbolTable())
+          return EC;
+        break;
+      }
+      continue;
+
+    case BitstreamEntry::Record:
+      break;
+    }
+
+    Record.clear();
+    auto BitCode = Stream.readRecord(Entry.ID, Record);
+    switch (BitCode) {
+    default:
+      if (std::error_code EC = parseGlobalRecord(BitCode, Record))
+        return EC;
+      break;
+    case bitc::MODULE_CODE_TRIPLE: // TRIPLE: [strchr x N]
+      if (convertToString(Record, 0, Symtab.TargetTriple))
+        return error("Invalid record");
+      break;
+    case bitc::MODULE_CODE_DATALAYOUT: // DATALAYOUT: [strchr x N]
+      if (convertToString(Record, 0, Symtab.DataLayout))
+        return error("Invalid record");
+      break;
+    case bitc::MODULE_CODE_ASM: // ASM: [strchr x N]
+      Symtab.HasModuleAsm |= !Record.empty();
+      break;
+    case bitc::MODULE_CODE_SOURCE_FILENAME: // SOURCE_FILENAME: [namechar x N]
+      if (convertToString(Record, 0, Symtab.SourceFileName))
+        return error("Invalid record");
+      break;
+    case bitc::MODULE_CODE_SECTIONNAME: { // SECTIONNAME: [strchr x N]
+      std::string S;
+      if (convertToString(Record, 0, S))
+        return error("Invalid record");
+      SectionTable.push_back(S);
+      break;
+    }
+    case bitc::MODULE_CODE_COMDAT: { // COMDAT: [selection_kind, name]
+      if (Record.size() < 2 || Record.size() < 2 + Record[1])
+        return error("Invalid record");
+      std::string ComdatName;
+      for (unsigned i = 0; i != Record[1]; ++i)
+        ComdatName += (char)Record[2 + i];
+      ComdatList.push_back(ComdatName);
+      break;
+    }
+    }
+  }
+}
+
+// Mirror the parts of BitcodeReader::parseModule() that describe how a global
+// value appears to a linker. Every global value takes a value id, in record
+// order.
+std::error_code
+BitcodeSymbolTableReader::parseGlobalRecord(unsigned BitCode,
+                                            ArrayRef<uint64_t> Record) {
+  GlobalEntry E;
+  BitcodeGlobalValue &GV = E.GV;
+  uint64_t RawLinkage;
+  uint64_t ComdatID = 0;
+  bool HasComdatField;
+
+  switch (BitCode) {
+  default: // Not a global value.
+    return std::error_code();
+  // GLOBALVAR: [pointer type, isconst, initid,
+  //             linkage, alignment, section, visibility, threadlocal,
+  //             unnamed_addr, externally_initialized, dllstorageclass,
+  //             comdat]
+  case bitc::MODULE_CODE_GLOBALVAR:
+    if (Record.size() < 6)
+      return error("Invalid record");
+    E.Kind = VariableKind;
+    GV.IsVariable = true;
+    GV.IsConstant = Record[1] & 1;
+    GV.IsDeclaration = !Record[2];
+    RawLinkage = Record[3];
+    GV.Section = getSection(Record[5]);
+    if (Record.size() > 6)
+      GV.Visibility = getDecodedVisibility(Record[6]);
+    if (Record.size() > 7)
+      GV.IsThreadLocal =
+          getDecodedThreadLocalMode(Record[7]) != GlobalValue::NotThreadLocal;
+    if (Record.size() > 8)
+      GV.UnnamedAddr = getDecodedUnnamedAddrType(Record[8]);
+    if (Record.size() > 10)
+      GV.DLLStorageClass = getDecodedDLLStorageClass(Record[10]);
+    HasComdatField = Record.size() > 11;
+    if (HasComdatField)
+      ComdatID = Record[11];
+    break;
+  // FUNCTION:  [type, callingconv, isproto, linkage, paramattr,
+  //             alignment, section, visibility, gc, unnamed_addr,
+  //             prologuedata, dllstorageclass, comdat, prefixdata]
+  case bitc::MODULE_CODE_FUNCTION:
+    if (Record.size() < 8)
+      return error("Invalid record");
+    E.Kind = FunctionKind;
+    GV.CallingConv = Record[1];
+    GV.IsDeclaration = Record[2];
+    RawLinkage = Record[3];
+    GV.Section = getSection(Record[6]);
+    GV.Visibility = getDecodedVisibility(Record[7]);
+    if (Record.size() > 9)
+      GV.UnnamedAddr = getDecodedUnnamedAddrType(Record[9]);
+    if (Record.size() > 11)
+      GV.DLLStorageClass = getDecodedDLLStorageClass(Record[11]);
+    HasComdatField = Record.size() > 12;
+    if (HasComdatField)
+      ComdatID = Record[12];
+    break;
+  // ALIAS: [alias type, addrspace, aliasee val#, linkage, visibility,
+  //         dllstorageclass, threadlocal, unnamed_addr]
+  // IFUNC: [alias type, addrspace, aliasee val#, linkage, visibility,
+  //         dllstorageclass, threadlocal, unnamed_addr]
+  // ALIAS_OLD: [alias type, aliasee val#, linkage, visibility, ...]
+  case bitc::MODULE_CODE_IFUNC:
+  case bitc::MODULE_CODE_ALIAS:
+  case bitc::MODULE_CODE_ALIAS_OLD: {
+    bool NewRecord = BitCode != bitc::MODULE_CODE_ALIAS_OLD;
+    if (Record.size() < (3 + (unsigned)NewRecord))
+      return error("Invalid record");
+    unsigned OpNum = NewRecord ? 2 : 1;
+    E.Kind = BitCode == bitc::MODULE_CODE_IFUNC ? IFuncKind : AliasKind;
+    E.AliaseeID = Record[OpNum++];
+    RawLinkage = Record[OpNum++];
+    if (OpNum != Record.size())
+      GV.Visibility = getDecodedVisibility(Record[OpNum++]);
+    if (OpNum != Record.size())
+      GV.DLLStorageClass = getDecodedDLLStorageClass(Record[OpNum++]);
+    if (OpNum != Record.size())
+      GV.IsThreadLocal = getDecodedThreadLocalMode(Record[OpNum++]) !=
+                         GlobalValue::NotThreadLocal;
+    if (OpNum != Record.size())
+      GV.UnnamedAddr = getDecodedUnnamedAddrType(Record[OpNum++]);
+    // Aliases take the comdat of their base object.
+    HasComdatField = true;
+    break;
+  }
+  }
+
+  GV.Linkage = getDecodedLinkage(RawLinkage);
+  // Local linkage must have default visibility.
+  if (GlobalValue::isLocalLinkage(GV.Linkage))
+    GV.Visibility = GlobalValue::DefaultVisibility;
+  if (GV.DLLStorageClass == GlobalValue::DefaultStorageClass) {
+    if (RawLinkage == 5)
+      GV.DLLStorageClass = GlobalValue::DLLImportStorageClass;
+    else if (RawLinkage == 6)
+      GV.DLLStorageClass = GlobalValue::DLLExportStorageClass;
+  }
+  if (ComdatID) {
+    if (ComdatID > ComdatList.size())
+      return error("Invalid comdat ID");
+    GV.Comdat = ComdatList[ComdatID - 1];
+  } else if (!HasComdatField && hasImplicitComdat(RawLinkage)) {
+    // Filled in with the name of the global value once the VST is read.
+    E.HasImplicitComdat = true;
+  }
+
+  Globals.push_back(std::move(E));
+  return std::error_code();
+}
+
+std::error_code BitcodeSymbolTableReader::parseValueSymbolTable() {
+  if (Stream.EnterSubBlock(bitc::VALUE_SYMTAB_BLOCK_ID))
+    return error("Invalid record");
+
+  SmallVector<uint64_t, 64> Record;
+  while (true) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      return std::error_code();
+    case BitstreamEntry::Record:
+      break;
+    }
+
+    Record.clear();
+    unsigned NameIdx;
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default: // Ignore other records.
+      continue;
+    case bitc::VST_CODE_ENTRY: // VST_CODE_ENTRY: [valueid, namechar x N]
+      NameIdx = 1;
+      break;
+    case bitc::VST_CODE_FNENTRY: // [valueid, offset, namechar x N]
+      NameIdx = 2;
+      break;
+    }
+    if (Record.empty())
+      return error("Invalid record");
+    // Value ids past the global values belong to constants.
+    if (Record[0] >= Globals.size())
+      continue;
+    std::string &Name = Globals[Record[0]].GV.Name;
+    Name.clear();
+    if (convertToString(Record, NameIdx, Name))
+      return error("Invalid record");
+  }
+}
+
+std::error_code BitcodeSymbolTableReader::collectGlobalValues() {
+  for (GlobalEntry &E : Globals)
+    if (E.HasImplicitComdat)
+      E.GV.Comdat = E.GV.Name;
+
+  std::vector<BitcodeGlobalValue> Functions, Variables, Aliases;
+  for (GlobalEntry &E : Globals) {
+    switch (E.Kind) {
+    case FunctionKind:
+      Functions.push_back(E.GV);
+      break;
+    case VariableKind:
+      Variables.push_back(E.GV);
+      break;
+    case AliasKind: {
+      // Find the base object through the chain of aliases. An aliasee that
+      // is a constant expression would need the constants to be parsed.
+      const GlobalEntry *Base = &E;
+      for (unsigned Steps = 0; Base->Kind == AliasKind; ++Steps) {
+        if (Base->AliaseeID >= Globals.size() || Steps == Globals.size())
+          return error("Aliasee is not a global value");
+        Base = &Globals[Base->AliaseeID];
+      }
+      if (Base->Kind == IFuncKind)
+        return error("Aliasee is not a global object");
+      E.GV.Comdat = Base->GV.Comdat;
+      Aliases.push_back(E.GV);
+      break;
+    }
+    case IFuncKind:
+      break;
+    }
+  }
+
+  auto &GVs = Symtab.GlobalValues;
+  GVs.reserve(Functions.size() + Variables.size() + Aliases.size());
+  for (auto *List : {&Functions, &Variables, &Aliases})
+    std::move(List->begin(), List->end(), std::back_inserter(GVs));
+  return std::error_code();
+}
+
+namespace {
+
 // FIXME: This class is only here to support the transition to llvm::Error. It
 // will be removed once this transition is complete. Clients should prefer to
 // deal with the Error value directly, rather than converting to error_code.
@@ -6760,3 +7565,13 @@ bool llvm::hasGlobalValueSummary(
   Buf.release(); // The ModuleSummaryIndexBitcodeReader owns it now.
   return R.foundGlobalValSummary();
 }
+
+ErrorOr<BitcodeSymbolTable>
+llvm::readBitcodeSymbolTable(MemoryBufferRef Buffer) {
+  std::unique_ptr<MemoryBuffer> Buf = MemoryBuffer::getMemBuffer(Buffer, false);
+  BitcodeSymbolTable Symtab;
+  BitcodeSymbolTableReader R(Buf.get(), Symtab);
+  if (std::error_code EC = R.read())
+    return EC;
+  return std::move(Symtab);
+}
@@ -318,6 +318,10 @@ class IndexBitcodeWriter : public BitcodeWriter {
   /// provides a map of modules to the corresponding GUIDs/summaries to write.
   const std::map<std::string, GVSummaryMapTy> *ModuleToSummariesForIndex;
 
+  /// Whether to write call edges to functions that have no summary in the
+  /// index being written.
+  bool KeepUnsummarizedCallees;
+
   /// Map that holds the correspondence between the GUID used in the combined
   /// index and a value id generated by this class to use in references.
   std::map<GlobalValue::GUID, unsigned> GUIDToValueIdMap;
@@ -332,9 +336,11 @@ public:
   IndexBitcodeWriter(SmallVectorImpl<char> &Buffer,
                      const ModuleSummaryIndex &Index,
                      const std::map<std::string, GVSummaryMapTy>
-                         *ModuleToSummariesForIndex = nullptr)
+                         *ModuleToSummariesForIndex = nullptr,
+                     bool KeepUnsummarizedCallees = false)
       : BitcodeWriter(Buffer), Index(Index),
-        ModuleToSummariesForIndex(ModuleToSummariesForIndex) {
+        ModuleToSummariesForIndex(ModuleToSummariesForIndex),
+        KeepUnsummarizedCallees(KeepUnsummarizedCallees) {
     // Assign unique value ids to all summaries to be written, for use
     // in writing out the call graph edges. Save the mapping from GUID
     // to the new global value id to use when writing those edges, which
@@ -1000,6 +1006,11 @@ static uint64_t getEncodedGVSummaryFlags(GlobalValueSummary::GVFlags Flags) {
   return RawFlags;
 }
 
+// Encode the flags computed by the thin link for a global variable.
+static uint64_t getEncodedGVarFlags(const GlobalVarSummary &VS) {
+  return uint64_t(VS.isReadOnly()) | (uint64_t(VS.isWriteOnly()) << 1);
+}
+
 static unsigned getEncodedVisibility(const GlobalValue &GV) {
   switch (GV.getVisibility()) {
   case GlobalValue::DefaultVisibility:   return 0;
@@ -3292,13 +3303,23 @@ void ModuleBitcodeWriter::writePerModuleFunctionSummaryRecord(
   NameVals.push_back(getEncodedGVSummaryFlags(FS->flags()));
   NameVals.push_back(FS->instCount());
   NameVals.push_back(FS->refs().size());
+  NameVals.push_back(FS->readOnlyRefCount());
+  NameVals.push_back(FS->writeOnlyRefCount());
 
-  unsigned SizeBeforeRefs = NameVals.size();
-  for (auto &RI : FS->refs())
-    NameVals.push_back(VE.getValueID(RI.getValue()));
   // Sort the refs for determinism output, the vector returned by FS->refs() has
-  // been initialized from a DenseSet.
-  std::sort(NameVals.begin() + SizeBeforeRefs, NameVals.end());
+  // been initialized from a DenseSet. The read-only and write-only references
+  // at the end are sorted separately to keep them grouped.
+  unsigned NumOtherRefs = FS->refs().size() - FS->readOnlyRefCount() -
+                          FS->writeOnlyRefCount();
+  unsigned GroupSizes[] = {NumOtherRefs, FS->readOnlyRefCount(),
+                           FS->writeOnlyRefCount()};
+  auto RI = FS->refs().begin();
+  for (unsigned GroupSize : GroupSizes) {
+    unsigned SizeBeforeRefs = NameVals.size();
+    for (unsigned I = 0; I != GroupSize; ++I, ++RI)
+      NameVals.push_back(VE.getValueID(RI->getValue()));
+    std::sort(NameVals.begin() + SizeBeforeRefs, NameVals.end());
+  }
 
   std::vector<FunctionSummary::EdgeTy> Calls = FS->calls();
   std::sort(Calls.begin(), Calls.end(),
@@ -3350,7 +3371,31 @@ void ModuleBitcodeWriter::writeModuleLevelReferences(
 // Current version for the summary.
 // This is bumped whenever we introduce changes in the way some record are
 // interpreted, like flags for instance.
-static const uint64_t INDEX_VERSION = 2;
+// Version 3 added the read-only and write-only reference counts to function
+// records and the variable flags to combined global variable records.
+static const uint64_t INDEX_VERSION = 3;
+
+/// Emit one FS_TYPE_ID record for each type identifier in \p Index.
+static void writeTypeIdSummaries(BitstreamWriter &Stream,
+                                 const ModuleSummaryIndex &Index) {
+  SmallVector<uint64_t, 64> Record;
+  auto AddString = [&](StringRef Str) {
+    Record.push_back(Str.size());
+    Record.append(Str.bytes_begin(), Str.bytes_end());
+  };
+  for (auto &TypeId : Index.typeIds()) {
+    Record.push_back(TypeId.second.Unknown);
+    AddString(TypeId.first);
+    for (auto &Slot : TypeId.second.SlotTargets) {
+      Record.push_back(Slot.first);
+      Record.push_back(Slot.second.size());
+      for (const std::string &Target : Slot.second)
+        AddString(Target);
+    }
+    Stream.EmitRecord(bitc::FS_TYPE_ID, Record);
+    Record.clear();
+  }
+}
 
 /// Emit the per-module summary section alongside the rest of
 /// the module's bitcode.
@@ -3358,6 +3403,9 @@ void ModuleBitcodeWriter::writePerModuleGlobalValueSummary() {
   Stream.EnterSubblock(bitc::GLOBALVAL_SUMMARY_BLOCK_ID, 4);
 
   Stream.EmitRecord(bitc::FS_VERSION, ArrayRef<uint64_t>{INDEX_VERSION});
+  writeTypeIdSummaries(Stream, *Index);
+  if (Index->isIncomplete())
+    Stream.EmitRecord(bitc::FS_INCOMPLETE, ArrayRef<uint64_t>{});
 
   if (Index->begin() == Index->end()) {
     Stream.ExitBlock();
@@ -3371,6 +3419,8 @@ void ModuleBitcodeWriter::writePerModuleGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // rorefcnt
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // worefcnt
   // numrefs x valueid, n x (valueid)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
@@ -3383,6 +3433,8 @@ void ModuleBitcodeWriter::writePerModuleGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // rorefcnt
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // worefcnt
   // numrefs x valueid, n x (valueid, hotness)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
@@ -3447,6 +3499,11 @@ void ModuleBitcodeWriter::writePerModuleGlobalValueSummary() {
 void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Stream.EnterSubblock(bitc::GLOBALVAL_SUMMARY_BLOCK_ID, 3);
   Stream.EmitRecord(bitc::FS_VERSION, ArrayRef<uint64_t>{INDEX_VERSION});
+  // Backends need every vtable to reason about a virtual call, so the type
+  // identifiers are not pruned for distributed backends.
+  writeTypeIdSummaries(Stream, Index);
+  if (Index.isIncomplete())
+    Stream.EmitRecord(bitc::FS_INCOMPLETE, ArrayRef<uint64_t>{});
 
   // Abbrev for FS_COMBINED.
   BitCodeAbbrev *Abbv = new BitCodeAbbrev();
@@ -3456,6 +3513,8 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // rorefcnt
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // worefcnt
   // numrefs x valueid, n x (valueid)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
@@ -3469,6 +3528,8 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // instcount
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // numrefs
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // rorefcnt
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 4));   // worefcnt
   // numrefs x valueid, n x (valueid, hotness)
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
@@ -3480,6 +3541,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // valueid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));   // modid
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));   // flags
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 2)); // varflags
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));    // valueids
   Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
   unsigned FSModRefsAbbrev = Stream.EmitAbbrev(Abbv);
@@ -3531,6 +3593,7 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
       NameVals.push_back(ValueId);
       NameVals.push_back(Index.getModuleId(VS->modulePath()));
       NameVals.push_back(getEncodedGVSummaryFlags(VS->flags()));
+      NameVals.push_back(getEncodedGVarFlags(*VS));
       for (auto &RI : VS->refs()) {
         NameVals.push_back(getValueId(RI.getGUID()));
       }
@@ -3549,6 +3612,8 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
     NameVals.push_back(getEncodedGVSummaryFlags(FS->flags()));
     NameVals.push_back(FS->instCount());
     NameVals.push_back(FS->refs().size());
+    NameVals.push_back(FS->readOnlyRefCount());
+    NameVals.push_back(FS->writeOnlyRefCount());
 
     for (auto &RI : FS->refs()) {
       NameVals.push_back(getValueId(RI.getGUID()));
@@ -3563,8 +3628,9 @@ void IndexBitcodeWriter::writeCombinedGlobalValueSummary() {
 
     for (auto &EI : FS->calls()) {
       // If this GUID doesn't have a value id, it doesn't have a function
-      // summary and we don't need to record any calls to it.
-      if (!hasValueId(EI.first.getGUID()))
+      // summary and we don't need to record any calls to it, unless the
+      // index is merged with the callee's summary later.
+      if (!KeepUnsummarizedCallees && !hasValueId(EI.first.getGUID()))
         continue;
       NameVals.push_back(getValueId(EI.first.getGUID()));
       if (HasProfileData)
@@ -3856,11 +3922,13 @@ void IndexBitcodeWriter::writeIndex() {
 // index for a distributed backend, provide a \p ModuleToSummariesForIndex map.
 void llvm::WriteIndexToFile(
     const ModuleSummaryIndex &Index, raw_ostream &Out,
-    const std::map<std::string, GVSummaryMapTy> *ModuleToSummariesForIndex) {
+    const std::map<std::string, GVSummaryMapTy> *ModuleToSummariesForIndex,
+    bool KeepUnsummarizedCallees) {
   SmallVector<char, 0> Buffer;
   Buffer.reserve(256 * 1024);
 
-  IndexBitcodeWriter IndexWriter(Buffer, Index, ModuleToSummariesForIndex);
+  IndexBitcodeWriter IndexWriter(Buffer, Index, ModuleToSummariesForIndex,
+                                 KeepUnsummarizedCallees);
   IndexWriter.write();
 
   Out.write((char *)&Buffer.front(), Buffer.size());
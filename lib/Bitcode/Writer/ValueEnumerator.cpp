@@ -914,6 +914,16 @@ void ValueEnumerator::incorporateFunction(const Function &F) {
   // LocalAsMetadata.
   incorporateFunctionMetadata(F);
 
+  // Every argument, basic block and non-void instruction gets a slot in the
+  // value map, so size it once up front instead of rehashing repeatedly while
+  // enumerating large function bodies.
+  unsigned NumLocalValues = F.arg_size();
+  for (const BasicBlock &BB : F)
+    NumLocalValues += BB.size() + 1;
+  ValueMap.reserve(ValueMap.size() + NumLocalValues);
+  Values.reserve(Values.size() + NumLocalValues);
+  BasicBlocks.reserve(F.size());
+
   // Adding function arguments to the value table.
   for (const auto &I : F.args())
     EnumerateValue(&I);
@@ -42,6 +42,7 @@
 #include "llvm/MC/MCValue.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Timer.h"
@@ -1940,7 +1941,21 @@ static void emitGlobalConstantDataSequential(const DataLayout &DL,
 
   // Otherwise, emit the values in successive locations.
   unsigned ElementByteSize = CDS->getElementByteSize();
-  if (isa<IntegerType>(CDS->getElementType())) {
+  if (!AP.OutStreamer->hasRawTextSupport()) {
+    // When writing an object file, emit the elements in one piece, in the
+    // byte order of the target. This is what emitting them one by one would
+    // produce, and tables with millions of elements are not unusual.
+    StringRef Data = CDS->getRawDataValues();
+    if (DL.isLittleEndian() == sys::IsLittleEndianHost) {
+      AP.OutStreamer->EmitBytes(Data);
+    } else {
+      std::string Swapped = Data.str();
+      for (size_t I = 0, E = Swapped.size(); I != E; I += ElementByteSize)
+        std::reverse(Swapped.begin() + I,
+                     Swapped.begin() + I + ElementByteSize);
+      AP.OutStreamer->EmitBytes(Swapped);
+    }
+  } else if (isa<IntegerType>(CDS->getElementType())) {
     for (unsigned i = 0, e = CDS->getNumElements(); i != e; ++i) {
       if (AP.isVerbose())
         AP.OutStreamer->GetCommentOS() << format("0x%" PRIx64 "\n",
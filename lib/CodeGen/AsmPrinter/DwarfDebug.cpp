@@ -511,22 +511,23 @@ void DwarfDebug::beginModule() {
 }
 
 void DwarfDebug::finishVariableDefinitions() {
-  for (const auto &Var : ConcreteVariables) {
-    DIE *VariableDie = Var->getDIE();
-    assert(VariableDie);
+  for (const auto &Var : ConcreteVariableDIEs) {
+    DIE *VariableDie = Var.Die;
     // FIXME: Consider the time-space tradeoff of just storing the unit pointer
-    // in the ConcreteVariables list, rather than looking it up again here.
+    // in the ConcreteVariableDIEs list, rather than looking it up again here.
     // DIE::getUnit isn't simple - it walks parent pointers, etc.
     DwarfCompileUnit *Unit = lookupUnit(VariableDie->getUnit());
     assert(Unit);
-    DbgVariable *AbsVar = getExistingAbstractVariable(
-        InlinedVariable(Var->getVariable(), Var->getInlinedAt()));
+    DbgVariable *AbsVar =
+        getExistingAbstractVariable(InlinedVariable(Var.Var, Var.IA));
     if (AbsVar && AbsVar->getDIE()) {
       Unit->addDIEEntry(*VariableDie, dwarf::DW_AT_abstract_origin,
                         *AbsVar->getDIE());
     } else
-      Unit->applyVariableAttributes(*Var, *VariableDie);
+      Unit->applyVariableAttributes(DbgVariable(Var.Var, Var.IA),
+                                    *VariableDie);
   }
+  ConcreteVariableDIEs.clear();
 }
 
 void DwarfDebug::finishSubprogramDefinitions() {
@@ -1167,11 +1168,19 @@ void DwarfDebug::endFunction(const MachineFunction *MF) {
         TheCU.getCUNode()->getSplitDebugInlining())
       SkelCU->constructSubprogramScopeDIE(FnScope);
 
+  // Only the DIEs of the concrete variables are needed from here on.
+  for (const auto &Var : ConcreteVariables) {
+    assert(Var->getDIE() && "concrete variable without a DIE");
+    ConcreteVariableDIEs.push_back(
+        {Var->getDIE(), Var->getVariable(), Var->getInlinedAt()});
+  }
+
   // Clear debug info
   // Ownership of DbgVariables is a bit subtle - ScopeVariables owns all the
   // DbgVariables except those that are also in AbstractVariables (since they
   // can be used cross-function)
   InfoHolder.getScopeVariables().clear();
+  ConcreteVariables.clear();
   PrevLabel = nullptr;
   CurFn = nullptr;
   DebugHandlerBase::endFunction(MF);
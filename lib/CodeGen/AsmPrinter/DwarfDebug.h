@@ -208,8 +208,20 @@ class DwarfDebug : public DebugHandlerBase {
 
   /// Collection of abstract variables.
   DenseMap<const MDNode *, std::unique_ptr<DbgVariable>> AbstractVariables;
+  /// Concrete variables of the current function.
   SmallVector<std::unique_ptr<DbgVariable>, 64> ConcreteVariables;
 
+  /// A concrete variable DIE whose attributes are added by
+  /// finishVariableDefinitions, once it is known whether the variable has an
+  /// abstract DIE. The DbgVariables themselves are released at the end of
+  /// each function, so this is all that is kept for the rest of the module.
+  struct ConcreteVariableDIE {
+    DIE *Die;
+    const DILocalVariable *Var;
+    const DILocation *IA;
+  };
+  std::vector<ConcreteVariableDIE> ConcreteVariableDIEs;
+
   /// Collection of DebugLocEntry. Stored in a linked list so that DIELocLists
   /// can refer to them in spite of insertions into this list.
   DebugLocStream DebugLocs;
@@ -49,6 +49,17 @@ void InterferenceCache::init(MachineFunction *mf,
   LIUArray = liuarray;
   TRI = tri;
   reinitPhysRegEntries();
+
+  unsigned LargestClass = 0;
+  for (TargetRegisterInfo::regclass_iterator I = TRI->regclass_begin(),
+                                             E = TRI->regclass_end();
+       I != E; ++I)
+    if ((*I)->isAllocatable())
+      LargestClass = std::max(LargestClass, (*I)->getNumRegs());
+  CacheEntries = std::min<unsigned>(
+      std::max<unsigned>(LargestClass, MinCacheEntries), MaxCacheEntries);
+  RoundRobin = 0;
+
   for (unsigned i = 0; i != CacheEntries; ++i)
     Entries[i].clear(mf, indexes, lis);
 }
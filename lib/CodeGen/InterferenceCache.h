@@ -130,9 +130,11 @@ class LLVM_LIBRARY_VISIBILITY InterferenceCache {
   };
 
   // We don't keep a cache entry for every physical register, that would use too
-  // much memory. Instead, a fixed number of cache entries are used in a round-
-  // robin manner.
-  enum { CacheEntries = 32 };
+  // much memory. Instead, a limited number of cache entries are used in a
+  // round-robin manner. There are enough of them to hold every register of the
+  // largest allocatable class, within these bounds, so that region splitting
+  // can try all of a class's registers without the entries thrashing.
+  enum { MinCacheEntries = 32, MaxCacheEntries = 64 };
 
   // Point to an entry for each physreg. The entry pointed to may not be up to
   // date, and it may have been reused for a different physreg.
@@ -143,7 +145,10 @@ class LLVM_LIBRARY_VISIBILITY InterferenceCache {
   unsigned RoundRobin;
 
   // The actual cache entries.
-  Entry Entries[CacheEntries];
+  Entry Entries[MaxCacheEntries];
+
+  // The number of entries in use for the current target.
+  unsigned CacheEntries;
 
   // get - Get a valid entry for PhysReg.
   Entry *get(unsigned PhysReg);
@@ -151,7 +156,7 @@ class LLVM_LIBRARY_VISIBILITY InterferenceCache {
 public:
   InterferenceCache()
     : TRI(nullptr), LIUArray(nullptr), MF(nullptr), PhysRegEntries(nullptr),
-      PhysRegEntriesCount(0), RoundRobin(0) {}
+      PhysRegEntriesCount(0), RoundRobin(0), CacheEntries(MinCacheEntries) {}
 
   ~InterferenceCache() {
     free(PhysRegEntries);
@@ -22,8 +22,16 @@ using namespace llvm;
 
 void LiveRangeCalc::resetLiveOutMap() {
   unsigned NumBlocks = MF->getNumBlockIDs();
-  Seen.clear();
-  Seen.resize(NumBlocks);
+  if (Seen.size() != NumBlocks) {
+    Seen.clear();
+    Seen.resize(NumBlocks);
+  } else if (SeenBlocks.size() > NumBlocks / 64) {
+    Seen.reset();
+  } else {
+    for (unsigned N : SeenBlocks)
+      Seen.reset(N);
+  }
+  SeenBlocks.clear();
   EntryInfoMap.clear();
   Map.resize(NumBlocks);
 }
@@ -25,6 +25,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/IndexedMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/LiveInterval.h"
 
 namespace llvm {
@@ -54,6 +55,12 @@ class LiveRangeCalc {
   /// when switching live ranges.
   BitVector Seen;
 
+  /// Numbers of the blocks whose Seen bit is set. LiveIntervals resets the
+  /// calculator once per virtual register, and most registers only touch a
+  /// few blocks, so clearing just these bits keeps the reset from costing
+  /// O(NumBlocks) per register on large functions.
+  SmallVector<unsigned, 16> SeenBlocks;
+
   /// Map LiveRange to sets of blocks (represented by bit vectors) that
   /// in the live range are defined on entry and undefined on entry.
   /// A block is defined on entry if there is a path from at least one of
@@ -248,7 +255,11 @@ public:
   /// VNI may be null only if MBB is a live-through block also passed to
   /// addLiveInBlock().
   void setLiveOutValue(MachineBasicBlock *MBB, VNInfo *VNI) {
-    Seen.set(MBB->getNumber());
+    unsigned N = MBB->getNumber();
+    if (!Seen.test(N)) {
+      Seen.set(N);
+      SeenBlocks.push_back(N);
+    }
     Map[MBB] = LiveOutPair(VNI, nullptr);
   }
 
@@ -101,6 +101,18 @@ static cl::opt<unsigned> LoopToColdBlockRatio(
              "(frequency of block) is greater than this ratio"),
     cl::init(5), cl::Hidden);
 
+static cl::opt<bool> MoveColdBlocksToEnd(
+    "move-cold-blocks-to-end",
+    cl::desc("When profile data is available, place the blocks it shows to be "
+             "cold after all of the other blocks of the function"),
+    cl::init(false), cl::Hidden);
+
+static cl::opt<unsigned> EntryToColdBlockRatio(
+    "entry-to-cold-block-ratio",
+    cl::desc("Treat a block as cold if (frequency of function entry) / "
+             "(frequency of block) is greater than this ratio"),
+    cl::init(1000), cl::Hidden);
+
 static cl::opt<bool>
     PreciseRotationCost("precise-rotation-cost",
                         cl::desc("Model the cost of loop rotation more "
@@ -302,6 +314,10 @@ class MachineBlockPlacement : public MachineFunctionPass {
   /// all terminators of the MachineFunction.
   SmallPtrSet<MachineBasicBlock *, 4> UnavoidableBlocks;
 
+  /// \brief A set of blocks that must stay right after their current layout
+  /// predecessor, because that predecessor has an unanalyzable fallthrough.
+  SmallPtrSet<MachineBasicBlock *, 4> FallthroughBlocks;
+
   /// \brief Allocator and owner of BlockChain structures.
   ///
   /// We build BlockChains lazily while processing the loop structure of
@@ -387,6 +403,7 @@ class MachineBlockPlacement : public MachineFunctionPass {
   void rotateLoopWithProfile(BlockChain &LoopChain, MachineLoop &L,
                              const BlockFilterSet &LoopBlockSet);
   void collectMustExecuteBBs();
+  void moveColdBlocksToEnd(BlockChain &FunctionChain);
   void buildCFGChains();
   void optimizeBranches();
   void alignBlocks();
@@ -1559,6 +1576,53 @@ void MachineBlockPlacement::collectMustExecuteBBs() {
   }
 }
 
+/// \brief Move the cold blocks of the function chain behind the others.
+///
+/// When the function has profile data, blocks whose frequency is far below
+/// the frequency of the function entry are moved to the end of the function,
+/// keeping their relative order. This keeps the hot part of the function
+/// dense in the instruction cache, rather than interleaving it with error
+/// handling and other paths which are (almost) never executed. Blocks which
+/// must stay after an unanalyzable fallthrough are moved together with their
+/// layout predecessor, and only if all of them are cold.
+void MachineBlockPlacement::moveColdBlocksToEnd(BlockChain &FunctionChain) {
+  if (!F->getFunction()->getEntryCount())
+    return;
+
+  BlockFrequency EntryFreq = MBFI->getBlockFreq(&F->front());
+  BranchProbability ColdProb(1, EntryToColdBlockRatio);
+  BlockFrequency ColdFreq = EntryFreq * ColdProb;
+
+  // Split the chain into segments which must be laid out contiguously.
+  SmallVector<MachineBasicBlock *, 16> HotBlocks, ColdBlocks, Segment;
+  bool SegmentIsCold = false;
+  auto FlushSegment = [&]() {
+    auto &Blocks = SegmentIsCold ? ColdBlocks : HotBlocks;
+    Blocks.append(Segment.begin(), Segment.end());
+    Segment.clear();
+  };
+  for (MachineBasicBlock *ChainBB : FunctionChain) {
+    bool IsCold = ChainBB != &F->front() &&
+                  MBFI->getBlockFreq(ChainBB) < ColdFreq;
+    if (!FallthroughBlocks.count(ChainBB)) {
+      FlushSegment();
+      SegmentIsCold = IsCold;
+    } else
+      SegmentIsCold &= IsCold;
+    Segment.push_back(ChainBB);
+  }
+  FlushSegment();
+
+  if (ColdBlocks.empty())
+    return;
+  DEBUG(for (MachineBasicBlock *ColdBB : ColdBlocks)
+          dbgs() << "Moving cold block " << getBlockName(ColdBB)
+                 << " to the end of the function\n");
+  std::copy(ColdBlocks.begin(), ColdBlocks.end(),
+            std::copy(HotBlocks.begin(), HotBlocks.end(),
+                      FunctionChain.begin()));
+}
+
 void MachineBlockPlacement::buildCFGChains() {
   // Ensure that every BB in the function has an associated chain to simplify
   // the assumptions of the remaining algorithm.
@@ -1585,6 +1649,7 @@ void MachineBlockPlacement::buildCFGChains() {
                    << getBlockName(BB) << " -> " << getBlockName(NextBB)
                    << "\n");
       Chain->merge(NextBB, nullptr);
+      FallthroughBlocks.insert(NextBB);
       FI = NextFI;
       BB = NextBB;
     }
@@ -1607,6 +1672,9 @@ void MachineBlockPlacement::buildCFGChains() {
   BlockChain &FunctionChain = *BlockToChain[&F->front()];
   buildChain(&F->front(), FunctionChain);
 
+  if (MoveColdBlocksToEnd)
+    moveColdBlocksToEnd(FunctionChain);
+
 #ifndef NDEBUG
   typedef SmallPtrSet<MachineBasicBlock *, 16> FunctionBlockSetType;
 #endif
@@ -1689,6 +1757,7 @@ void MachineBlockPlacement::buildCFGChains() {
 
   BlockWorkList.clear();
   EHPadWorkList.clear();
+  FallthroughBlocks.clear();
 }
 
 void MachineBlockPlacement::optimizeBranches() {
@@ -700,7 +700,7 @@ MachineInstr::MachineInstr(MachineFunction &MF, const MCInstrDesc &tid,
                            DebugLoc dl, bool NoImp)
     : MCID(&tid), Parent(nullptr), Operands(nullptr), NumOperands(0), Flags(0),
       AsmPrinterFlags(0), NumMemRefs(0), MemRefs(nullptr),
-      debugLoc(std::move(dl)) {
+      debugLoc(std::move(dl)), SlotIndexEntry(nullptr) {
   assert(debugLoc.hasTrivialDestructor() && "Expected trivial destructor");
 
   // Reserve space for the expected number of operands.
@@ -718,10 +718,12 @@ MachineInstr::MachineInstr(MachineFunction &MF, const MCInstrDesc &tid,
 ///
 MachineInstr::MachineInstr(MachineFunction &MF, const MachineInstr &MI)
     : MCID(&MI.getDesc()), Parent(nullptr), Operands(nullptr), NumOperands(0),
-      Flags(0), AsmPrinterFlags(0), NumMemRefs(MI.NumMemRefs),
-      MemRefs(MI.MemRefs), debugLoc(MI.getDebugLoc()) {
+      Flags(0), AsmPrinterFlags(0), NumMemRefs(0), MemRefs(nullptr),
+      debugLoc(MI.getDebugLoc()), SlotIndexEntry(nullptr) {
   assert(debugLoc.hasTrivialDestructor() && "Expected trivial destructor");
 
+  setMemRefs(MI.memoperands_begin(), MI.memoperands_end());
+
   CapOperands = OperandCapacity::get(MI.getNumOperands());
   Operands = MF.allocateOperandArray(CapOperands);
 
@@ -907,7 +909,14 @@ void MachineInstr::RemoveOperand(unsigned OpNo) {
 /// is the primary method for setting up a MachineInstr's MemRefs list.
 void MachineInstr::addMemOperand(MachineFunction &MF,
                                  MachineMemOperand *MO) {
-  mmo_iterator OldMemRefs = MemRefs;
+  // The first memory operand is stored inline.
+  if (NumMemRefs == 0) {
+    InlineMemRef = MO;
+    NumMemRefs = 1;
+    return;
+  }
+
+  mmo_iterator OldMemRefs = memoperands_begin();
   unsigned OldNumMemRefs = NumMemRefs;
 
   unsigned NewNum = NumMemRefs + 1;
@@ -945,7 +954,7 @@ MachineInstr::mergeMemRefsWith(const MachineInstr& Other) {
   // like pairs of loads from the same location, this catches a large number of
   // cases in practice.
   if (hasIdenticalMMOs(*this, Other))
-    return std::make_pair(MemRefs, NumMemRefs);
+    return std::make_pair(memoperands_begin(), NumMemRefs);
 
   // TODO: consider uniquing elements within the operand lists to reduce
   // space usage and fall back to conservative information less often.
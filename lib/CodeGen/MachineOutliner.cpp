@@ -0,0 +1,614 @@
+//===- MachineOutliner.cpp - Outline repeated instruction sequences -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass replaces repeated sequences of machine instructions by calls to
+// new functions holding a single copy of each sequence, which reduces code
+// size at the cost of a call and a return per executed sequence.
+//
+// Every basic block of every function in the module is mapped to a string of
+// integers. Identical instructions the target allows to be outlined map to
+// the same integer, anything else maps to an integer of its own, and every
+// block ends with a unique separator, so that only legal sequences within a
+// block can repeat. A suffix tree of the whole string then yields the
+// repeated sequences in time linear in the size of the module: each internal
+// node is a repeated sequence and its leaf children are where it starts. The
+// occurrences that are extensions of a longer repeated sequence are found
+// through the longer sequence's node instead, which keeps the number of
+// occurrences considered linear as well.
+//
+// Sequences are outlined greedily in order of estimated size savings, and an
+// occurrence is dropped if an earlier choice already took any of its
+// instructions. Blocks that the profile says are hot are left alone, since a
+// call and a return in hot code cost more than the size savings are worth.
+//
+// The pass runs after register allocation and frame lowering, right before
+// code emission, and outlines whole machine instructions with their physical
+// registers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-outliner"
+
+STATISTIC(NumOutlined, "Number of sequences replaced by calls");
+STATISTIC(NumFunctionsCreated, "Number of outlined functions created");
+
+namespace {
+
+typedef TargetInstrInfo::MachineOutlinerInstrType InstrType;
+
+/// A node in a suffix tree. The edge into the node is labelled with the
+/// substring [StartIdx, *EndIdx] of the tree's string.
+struct SuffixTreeNode {
+  /// Children of the node, by the first character of their edge.
+  DenseMap<unsigned, SuffixTreeNode *> Children;
+
+  /// Start of the edge label. The root has EmptyIdx.
+  unsigned StartIdx;
+
+  /// End of the edge label, inclusive. All leaves share the tree's
+  /// LeafEndIdx, which grows with the tree during construction.
+  unsigned *EndIdx;
+
+  /// For leaves, the start of the suffix the leaf represents.
+  unsigned SuffixIdx;
+
+  /// Suffix link of an internal node: the node for this node's string minus
+  /// its first character.
+  SuffixTreeNode *Link = nullptr;
+
+  /// Length of the string from the root to the end of this node.
+  unsigned ConcatLen = 0;
+
+  static const unsigned EmptyIdx = ~0U;
+
+  SuffixTreeNode(unsigned StartIdx, unsigned *EndIdx)
+      : StartIdx(StartIdx), EndIdx(EndIdx), SuffixIdx(EmptyIdx) {}
+
+  bool isRoot() const { return StartIdx == EmptyIdx; }
+  bool isLeaf() const { return SuffixIdx != EmptyIdx; }
+
+  /// Length of the edge label.
+  unsigned size() const { return isRoot() ? 0 : *EndIdx - StartIdx + 1; }
+};
+
+/// A sequence that occurs more than once in a suffix tree's string.
+struct RepeatedSequence {
+  unsigned Length;
+  /// Where the sequence starts in the string, in increasing order.
+  std::vector<unsigned> StartIndices;
+};
+
+/// A suffix tree over a string of unsigned integers, built with Ukkonen's
+/// algorithm in time linear in the length of the string. The last character
+/// of the string must be unique, so that every suffix ends in a leaf.
+class SuffixTree {
+  ArrayRef<unsigned> Str;
+  SpecificBumpPtrAllocator<SuffixTreeNode> NodeAllocator;
+  BumpPtrAllocator EndIdxAllocator;
+  SuffixTreeNode *Root = nullptr;
+  unsigned LeafEndIdx = ~0U;
+
+  /// The point where the next suffix is inserted: Len characters down the
+  /// edge of Node's child starting with Str[Idx].
+  struct {
+    SuffixTreeNode *Node;
+    unsigned Idx = 0;
+    unsigned Len = 0;
+  } Active;
+
+  SuffixTreeNode *insertLeaf(SuffixTreeNode &Parent, unsigned StartIdx,
+                             unsigned Edge) {
+    SuffixTreeNode *N =
+        new (NodeAllocator.Allocate()) SuffixTreeNode(StartIdx, &LeafEndIdx);
+    Parent.Children[Edge] = N;
+    return N;
+  }
+
+  SuffixTreeNode *insertInternalNode(SuffixTreeNode *Parent, unsigned StartIdx,
+                                     unsigned EndIdx, unsigned Edge) {
+    unsigned *E = new (EndIdxAllocator) unsigned(EndIdx);
+    SuffixTreeNode *N =
+        new (NodeAllocator.Allocate()) SuffixTreeNode(StartIdx, E);
+    N->Link = Root;
+    if (Parent)
+      Parent->Children[Edge] = N;
+    return N;
+  }
+
+  /// Add the suffixes of Str[0, EndIdx] that are not in the tree yet, of
+  /// which there are \p SuffixesToAdd. Returns how many of them are still
+  /// implicit in the tree afterwards.
+  unsigned extend(unsigned EndIdx, unsigned SuffixesToAdd) {
+    SuffixTreeNode *NeedsLink = nullptr;
+
+    while (SuffixesToAdd > 0) {
+      if (Active.Len == 0)
+        Active.Idx = EndIdx;
+      assert(Active.Idx <= EndIdx && "Active point is past the end!");
+
+      unsigned FirstChar = Str[Active.Idx];
+      auto ChildIt = Active.Node->Children.find(FirstChar);
+
+      if (ChildIt == Active.Node->Children.end()) {
+        // Nothing starts with FirstChar yet; hang a new leaf off the node.
+        insertLeaf(*Active.Node, EndIdx, FirstChar);
+        if (NeedsLink) {
+          NeedsLink->Link = Active.Node;
+          NeedsLink = nullptr;
+        }
+      } else {
+        SuffixTreeNode *NextNode = ChildIt->second;
+        unsigned EdgeLen = NextNode->size();
+
+        // Walk down past edges the active point lies beyond.
+        if (Active.Len >= EdgeLen) {
+          Active.Idx += EdgeLen;
+          Active.Len -= EdgeLen;
+          Active.Node = NextNode;
+          continue;
+        }
+
+        // If the new character is already on the edge, the remaining
+        // suffixes are implicit in the tree until the next character.
+        unsigned LastChar = Str[EndIdx];
+        if (Str[NextNode->StartIdx + Active.Len] == LastChar) {
+          if (NeedsLink && !Active.Node->isRoot()) {
+            NeedsLink->Link = Active.Node;
+            NeedsLink = nullptr;
+          }
+          ++Active.Len;
+          break;
+        }
+
+        // Otherwise split the edge at the active point and hang a new leaf
+        // off the split.
+        SuffixTreeNode *SplitNode =
+            insertInternalNode(Active.Node, NextNode->StartIdx,
+                               NextNode->StartIdx + Active.Len - 1, FirstChar);
+        insertLeaf(*SplitNode, EndIdx, LastChar);
+        NextNode->StartIdx += Active.Len;
+        SplitNode->Children[Str[NextNode->StartIdx]] = NextNode;
+
+        if (NeedsLink)
+          NeedsLink->Link = SplitNode;
+        NeedsLink = SplitNode;
+      }
+
+      --SuffixesToAdd;
+
+      // Move on to the next shorter suffix.
+      if (Active.Node->isRoot()) {
+        if (Active.Len > 0) {
+          --Active.Len;
+          Active.Idx = EndIdx - SuffixesToAdd + 1;
+        }
+      } else {
+        Active.Node = Active.Node->Link;
+      }
+    }
+
+    return SuffixesToAdd;
+  }
+
+  /// Compute the string length of every node and the suffix of every leaf.
+  void setSuffixIndices() {
+    SmallVector<SuffixTreeNode *, 32> Worklist;
+    Worklist.push_back(Root);
+    while (!Worklist.empty()) {
+      SuffixTreeNode *N = Worklist.pop_back_val();
+      if (N->Children.empty()) {
+        N->SuffixIdx = Str.size() - N->ConcatLen;
+        continue;
+      }
+      for (auto &Child : N->Children) {
+        Child.second->ConcatLen = N->ConcatLen + Child.second->size();
+        Worklist.push_back(Child.second);
+      }
+    }
+  }
+
+public:
+  explicit SuffixTree(ArrayRef<unsigned> Str) : Str(Str) {
+    Root = insertInternalNode(nullptr, SuffixTreeNode::EmptyIdx,
+                              SuffixTreeNode::EmptyIdx, 0);
+    Active.Node = Root;
+
+    unsigned SuffixesToAdd = 0;
+    for (unsigned EndIdx = 0, E = Str.size(); EndIdx != E; ++EndIdx) {
+      ++SuffixesToAdd;
+      LeafEndIdx = EndIdx;
+      SuffixesToAdd = extend(EndIdx, SuffixesToAdd);
+    }
+    assert(SuffixesToAdd == 0 && "Last character of the string isn't unique!");
+
+    setSuffixIndices();
+  }
+
+  /// Append the repeated sequences of at least \p MinLength characters to
+  /// \p Sequences. The start indices of a sequence are those of the leaf
+  /// children of its node.
+  void findRepeatedSequences(unsigned MinLength,
+                             std::vector<RepeatedSequence> &Sequences) const {
+    SmallVector<SuffixTreeNode *, 32> Worklist;
+    Worklist.push_back(Root);
+    while (!Worklist.empty()) {
+      SuffixTreeNode *N = Worklist.pop_back_val();
+      std::vector<unsigned> StartIndices;
+      for (auto &Child : N->Children) {
+        if (!Child.second->isLeaf())
+          Worklist.push_back(Child.second);
+        else if (N->ConcatLen >= MinLength)
+          StartIndices.push_back(Child.second->SuffixIdx);
+      }
+      if (N->isRoot() || StartIndices.size() < 2)
+        continue;
+      std::sort(StartIndices.begin(), StartIndices.end());
+      Sequences.push_back({N->ConcatLen, std::move(StartIndices)});
+    }
+  }
+};
+
+/// Maps the instructions of the module to a string of integers for the
+/// suffix tree.
+struct InstructionMapper {
+  /// The integer of the next legal instruction that isn't identical to any
+  /// mapped so far. Counts up.
+  unsigned LegalInstrNumber = 0;
+
+  /// The integer of the next illegal instruction or block separator. Counts
+  /// down, staying clear of DenseMap's empty and tombstone keys.
+  unsigned IllegalInstrNumber = ~0U - 2;
+
+  DenseMap<MachineInstr *, unsigned, MachineInstrExpressionTrait>
+      InstructionIntegerMap;
+
+  /// The string, and the instruction each character stands for. Separators
+  /// stand for the end of their block.
+  std::vector<unsigned> UnsignedVec;
+  std::vector<MachineBasicBlock::iterator> InstrList;
+
+  void mapLegal(MachineBasicBlock::iterator It) {
+    auto Result = InstructionIntegerMap.insert(
+        std::make_pair(&*It, LegalInstrNumber));
+    if (Result.second)
+      ++LegalInstrNumber;
+    UnsignedVec.push_back(Result.first->second);
+    InstrList.push_back(It);
+  }
+
+  void mapIllegal(MachineBasicBlock::iterator It) {
+    UnsignedVec.push_back(IllegalInstrNumber--);
+    InstrList.push_back(It);
+    assert(LegalInstrNumber < IllegalInstrNumber &&
+           "Ran out of integers for instructions!");
+  }
+};
+
+class MachineOutliner : public ModulePass {
+public:
+  static char ID;
+
+  MachineOutliner() : ModulePass(ID) {
+    initializeMachineOutlinerPass(*PassRegistry::getPassRegistry());
+  }
+
+  StringRef getPassName() const override { return "Machine Outliner"; }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineModuleInfo>();
+    AU.addPreserved<MachineModuleInfo>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.setPreservesAll();
+    ModulePass::getAnalysisUsage(AU);
+  }
+
+  bool runOnModule(Module &M) override;
+
+private:
+  InstrType getOutliningType(const TargetInstrInfo &TII,
+                             const MachineInstr &MI) const;
+  bool isBlockHot(const MachineBasicBlock &MBB, ProfileSummaryInfo &PSI,
+                  BlockFrequencyInfo *BFI) const;
+  void mapFunction(MachineFunction &MF, InstructionMapper &Mapper,
+                   ProfileSummaryInfo &PSI, BlockFrequencyInfo *BFI) const;
+  MachineFunction &createOutlinedFunction(Module &M, MachineModuleInfo &MMI,
+                                          MachineBasicBlock::iterator StartIt,
+                                          MachineBasicBlock::iterator EndIt);
+  void replaceWithCall(MachineBasicBlock::iterator StartIt,
+                       MachineBasicBlock::iterator EndIt,
+                       MachineFunction &OutlinedMF) const;
+
+  unsigned OutlinedFunctionNum = 0;
+};
+
+} // end anonymous namespace
+
+char MachineOutliner::ID = 0;
+INITIALIZE_PASS_BEGIN(MachineOutliner, "machine-outliner",
+                      "Machine Function Outliner", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineModuleInfo)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_END(MachineOutliner, "machine-outliner",
+                    "Machine Function Outliner", false, false)
+
+ModulePass *llvm::createMachineOutlinerPass() { return new MachineOutliner(); }
+
+InstrType MachineOutliner::getOutliningType(const TargetInstrInfo &TII,
+                                            const MachineInstr &MI) const {
+  if (MI.isDebugValue() || MI.isKill() || MI.isImplicitDef())
+    return InstrType::Invisible;
+
+  // Control flow, labels and anything the prologue and epilogue rely on stay
+  // where they are.
+  if (MI.isCall() || MI.isTerminator() || MI.isReturn() || MI.isPosition() ||
+      MI.isInlineAsm() || MI.isBundle() || MI.hasUnmodeledSideEffects() ||
+      MI.getFlag(MachineInstr::FrameSetup) ||
+      MI.getFlag(MachineInstr::FrameDestroy))
+    return InstrType::Illegal;
+
+  // So do references to anything that belongs to the function.
+  for (const MachineOperand &MO : MI.operands())
+    if (MO.isFI() || MO.isCPI() || MO.isJTI() || MO.isTargetIndex() ||
+        MO.isMBB() || MO.isMCSymbol() || MO.isCFIIndex() || MO.isRegMask())
+      return InstrType::Illegal;
+
+  return TII.getOutliningType(MI);
+}
+
+bool MachineOutliner::isBlockHot(const MachineBasicBlock &MBB,
+                                 ProfileSummaryInfo &PSI,
+                                 BlockFrequencyInfo *BFI) const {
+  if (!BFI)
+    return false;
+  // Blocks created during code generation have no IR block to ask about;
+  // judge them by the function entry.
+  const BasicBlock *BB = MBB.getBasicBlock();
+  if (!BB)
+    return PSI.isFunctionEntryHot(MBB.getParent()->getFunction());
+  Optional<uint64_t> Count = BFI->getBlockProfileCount(BB);
+  return Count && PSI.isHotCount(*Count);
+}
+
+void MachineOutliner::mapFunction(MachineFunction &MF,
+                                  InstructionMapper &Mapper,
+                                  ProfileSummaryInfo &PSI,
+                                  BlockFrequencyInfo *BFI) const {
+  const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+  for (MachineBasicBlock &MBB : MF) {
+    if (!isBlockHot(MBB, PSI, BFI)) {
+      for (auto It = MBB.begin(), E = MBB.end(); It != E; ++It) {
+        switch (getOutliningType(TII, *It)) {
+        case InstrType::Legal:
+          Mapper.mapLegal(It);
+          break;
+        case InstrType::Illegal:
+          Mapper.mapIllegal(It);
+          break;
+        case InstrType::Invisible:
+          break;
+        }
+      }
+    }
+    // Keep sequences from running across blocks.
+    Mapper.mapIllegal(MBB.end());
+  }
+}
+
+MachineFunction &
+MachineOutliner::createOutlinedFunction(Module &M, MachineModuleInfo &MMI,
+                                        MachineBasicBlock::iterator StartIt,
+                                        MachineBasicBlock::iterator EndIt) {
+  const Function *Caller = StartIt->getParent()->getParent()->getFunction();
+  LLVMContext &C = M.getContext();
+
+  Function *F = Function::Create(
+      FunctionType::get(Type::getVoidTy(C), false),
+      GlobalValue::InternalLinkage,
+      "OUTLINED_FUNCTION_" + Twine(OutlinedFunctionNum++), &M);
+  F->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+  F->addFnAttr(Attribute::NoUnwind);
+  F->addFnAttr(Attribute::OptimizeForSize);
+  F->addFnAttr(Attribute::MinSize);
+  // The instructions were selected for the caller's subtarget.
+  for (StringRef Kind : {"target-cpu", "target-features"})
+    if (Caller->hasFnAttribute(Kind))
+      F->addFnAttr(Caller->getFnAttribute(Kind));
+  ReturnInst::Create(C, BasicBlock::Create(C, "entry", F));
+
+  // A MIR parser set up as the initializer only knows the functions it read.
+  MachineFunctionInitializer *MFInitializer =
+      MMI.getMachineFunctionInitializer();
+  MMI.setMachineFunctionInitializer(nullptr);
+  MachineFunction &MF = MMI.getMachineFunction(*F);
+  MMI.setMachineFunctionInitializer(MFInitializer);
+
+  MF.getProperties()
+      .reset(MachineFunctionProperties::Property::IsSSA)
+      .reset(MachineFunctionProperties::Property::TracksLiveness)
+      .set(MachineFunctionProperties::Property::NoPHIs)
+      .set(MachineFunctionProperties::Property::NoVRegs);
+  MF.getRegInfo().freezeReservedRegs(MF);
+
+  MachineBasicBlock *MBB = MF.CreateMachineBasicBlock();
+  MF.insert(MF.end(), MBB);
+  for (MachineInstr &MI : make_range(StartIt, std::next(EndIt))) {
+    if (MI.isDebugValue())
+      continue;
+    MachineInstr *NewMI = MF.CloneMachineInstr(&MI);
+    // The memory operands live as long as the caller's MachineFunction, and
+    // the debug locations point into the caller's scopes.
+    NewMI->dropMemRefs();
+    NewMI->setDebugLoc(DebugLoc());
+    MBB->insert(MBB->end(), NewMI);
+  }
+  MF.getSubtarget().getInstrInfo()->insertOutlinerEpilogue(*MBB, MF);
+
+  ++NumFunctionsCreated;
+  return MF;
+}
+
+void MachineOutliner::replaceWithCall(MachineBasicBlock::iterator StartIt,
+                                      MachineBasicBlock::iterator EndIt,
+                                      MachineFunction &OutlinedMF) const {
+  MachineBasicBlock &MBB = *StartIt->getParent();
+  MachineFunction &MF = *MBB.getParent();
+  auto Range = make_range(StartIt, std::next(EndIt));
+
+  // The call reads whatever the sequence read before writing it, and writes
+  // whatever the sequence wrote.
+  SmallSetVector<unsigned, 8> Uses, Defs;
+  for (MachineInstr &MI : Range) {
+    for (const MachineOperand &MO : MI.operands())
+      if (MO.isReg() && MO.getReg() && MO.isUse() && !MO.isUndef() &&
+          !Defs.count(MO.getReg()))
+        Uses.insert(MO.getReg());
+    for (const MachineOperand &MO : MI.operands())
+      if (MO.isReg() && MO.getReg() && MO.isDef())
+        Defs.insert(MO.getReg());
+  }
+
+  const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+  MachineBasicBlock::iterator Call =
+      TII.insertOutlinedCall(MBB, StartIt, OutlinedMF);
+  for (unsigned Reg : Uses)
+    Call->addOperand(MF, MachineOperand::CreateReg(Reg, /*isDef=*/false,
+                                                   /*isImp=*/true));
+  for (unsigned Reg : Defs)
+    Call->addOperand(MF, MachineOperand::CreateReg(Reg, /*isDef=*/true,
+                                                   /*isImp=*/true));
+
+  MBB.erase(StartIt, std::next(EndIt));
+  ++NumOutlined;
+}
+
+bool MachineOutliner::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+
+  MachineModuleInfo &MMI = getAnalysis<MachineModuleInfo>();
+  ProfileSummaryInfo &PSI =
+      *getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+
+  InstructionMapper Mapper;
+  const TargetInstrInfo *TII = nullptr;
+  for (Function &F : M) {
+    if (F.isDeclaration() || F.hasAvailableExternallyLinkage())
+      continue;
+    MachineFunction &MF = MMI.getMachineFunction(F);
+    if (MF.empty() ||
+        !MF.getSubtarget().getInstrInfo()->isFunctionSafeToOutlineFrom(MF))
+      continue;
+    TII = MF.getSubtarget().getInstrInfo();
+    BlockFrequencyInfo *BFI = nullptr;
+    if (F.getEntryCount())
+      BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    mapFunction(MF, Mapper, PSI, BFI);
+  }
+  if (!TII)
+    return false;
+
+  std::vector<RepeatedSequence> Sequences;
+  SuffixTree(Mapper.UnsignedVec).findRepeatedSequences(2, Sequences);
+
+  // Estimate the instructions saved by outlining a sequence of Length
+  // instructions at Occurrences places.
+  const int64_t CallOverhead = TII->getOutliningCallOverhead();
+  const int64_t FrameOverhead = TII->getOutliningFrameOverhead();
+  auto getBenefit = [&](unsigned Length, size_t Occurrences) {
+    return int64_t(Length) * Occurrences -
+           (CallOverhead * Occurrences + Length + FrameOverhead);
+  };
+
+  // Try the most profitable sequences first.
+  std::stable_sort(Sequences.begin(), Sequences.end(),
+                   [&](const RepeatedSequence &A, const RepeatedSequence &B) {
+                     int64_t BenefitA =
+                         getBenefit(A.Length, A.StartIndices.size());
+                     int64_t BenefitB =
+                         getBenefit(B.Length, B.StartIndices.size());
+                     if (BenefitA != BenefitB)
+                       return BenefitA > BenefitB;
+                     return A.StartIndices[0] < B.StartIndices[0];
+                   });
+
+  // Drop the occurrences that overlap ones chosen before, and keep what is
+  // still profitable.
+  BitVector Taken(Mapper.UnsignedVec.size());
+  auto isFree = [&](unsigned Start, unsigned Length) {
+    if (Taken.test(Start))
+      return false;
+    int NextTaken = Taken.find_next(Start);
+    return NextTaken == -1 || unsigned(NextTaken) >= Start + Length;
+  };
+  std::vector<RepeatedSequence> Chosen;
+  for (RepeatedSequence &RS : Sequences) {
+    if (getBenefit(RS.Length, RS.StartIndices.size()) <= 0)
+      break;
+    std::vector<unsigned> StartIndices;
+    for (unsigned Start : RS.StartIndices) {
+      if (!isFree(Start, RS.Length))
+        continue;
+      StartIndices.push_back(Start);
+      Taken.set(Start, Start + RS.Length);
+    }
+    if (StartIndices.size() < 2 ||
+        getBenefit(RS.Length, StartIndices.size()) <= 0) {
+      for (unsigned Start : StartIndices)
+        Taken.reset(Start, Start + RS.Length);
+      continue;
+    }
+    Chosen.push_back({RS.Length, std::move(StartIndices)});
+  }
+
+  // Occurrences don't overlap, so replacing one leaves the iterators of the
+  // others valid.
+  for (RepeatedSequence &RS : Chosen) {
+    auto getRange = [&](unsigned Start) {
+      return std::make_pair(Mapper.InstrList[Start],
+                            Mapper.InstrList[Start + RS.Length - 1]);
+    };
+    auto FirstRange = getRange(RS.StartIndices[0]);
+    MachineFunction &OutlinedMF =
+        createOutlinedFunction(M, MMI, FirstRange.first, FirstRange.second);
+    DEBUG(dbgs() << "Outlining " << RS.StartIndices.size()
+                 << " occurrences of " << RS.Length << " instructions into "
+                 << OutlinedMF.getName() << "\n");
+    for (unsigned Start : RS.StartIndices) {
+      auto Range = getRange(Start);
+      replaceWithCall(Range.first, Range.second, OutlinedMF);
+    }
+  }
+
+  return !Chosen.empty();
+}
@@ -50,7 +50,9 @@
 // nodes. We also perform several passes over the DAG to eliminate unnecessary
 // edges that inhibit the ability to pipeline. The implementation uses the
 // DFAPacketizer class to compute the minimum initiation interval and the check
-// where an instruction may be inserted in the pipelined schedule.
+// where an instruction may be inserted in the pipelined schedule. Targets
+// without a DFA can use the resources of their scheduling model instead, see
+// TargetSubtargetInfo::useDFAforSMS.
 //
 // In order for the SMS pass to work, several target specific hooks need to be
 // implemented to get information about the loop structure and to rewrite
@@ -89,6 +91,7 @@
 #include "llvm/CodeGen/RegisterPressure.h"
 #include "llvm/CodeGen/ScheduleDAG.h"
 #include "llvm/CodeGen/ScheduleDAGInstrs.h"
+#include "llvm/CodeGen/TargetSchedule.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/DebugLoc.h"
 #include "llvm/MC/MCInstrItineraries.h"
@@ -164,6 +167,17 @@ static cl::opt<bool> SwpIgnoreRecMII("pipeliner-ignore-recmii",
                                      cl::ReallyHidden, cl::init(false),
                                      cl::ZeroOrMore, cl::desc("Ignore RecMII"));
 
+/// A command line option to model resources with the scheduling model even if
+/// the target provides a DFA. This is used for testing.
+static cl::opt<bool> SwpForceSchedModel(
+    "pipeliner-force-sched-model", cl::Hidden, cl::init(false),
+    cl::desc("Model resources with the scheduling model instead of the DFA"));
+
+/// Return true if the resources of \p ST are modelled with its DFA.
+static bool useDFAforSMS(const TargetSubtargetInfo &ST) {
+  return !SwpForceSchedModel && ST.useDFAforSMS();
+}
+
 namespace {
 
 class NodeSet;
@@ -544,6 +558,57 @@ public:
   void dump() const { print(dbgs()); }
 };
 
+/// Models the resources of the pipelined loop with the scheduling model, for
+/// targets that don't use a DFA. An instruction holds a unit of each processor
+/// resource it writes for the given number of cycles. With an itinerary, each
+/// stage holds one of the functional units it may issue to, and the set of
+/// those units is treated as one resource. Every instruction also takes its
+/// micro-ops from the issue width in the cycle it issues.
+class SchedModelResources {
+public:
+  struct ResourceUse {
+    /// The processor resource index, or the functional units bit mask in the
+    /// upper half for an itinerary stage.
+    uint64_t Resource;
+    unsigned NumUnits;
+    /// The cycle the resource is taken in, relative to the issue cycle, and
+    /// for how many cycles.
+    unsigned StartCycle;
+    unsigned Cycles;
+  };
+
+private:
+  TargetSchedModel SchedModel;
+  const TargetInstrInfo *TII;
+
+public:
+  SchedModelResources(const TargetSubtargetInfo &ST)
+      : TII(ST.getInstrInfo()) {
+    SchedModel.init(ST.getSchedModel(), &ST, TII);
+  }
+
+  /// Append the resources \p MI holds to \p Uses.
+  void getResourceUses(const MachineInstr &MI,
+                       SmallVectorImpl<ResourceUse> &Uses) const;
+
+  unsigned getNumMicroOps(const MachineInstr &MI) const {
+    return SchedModel.getNumMicroOps(&MI);
+  }
+
+  unsigned getIssueWidth() const { return SchedModel.getIssueWidth(); }
+
+  /// Return the smallest II in which the resources of the instructions in
+  /// [\p Begin, \p End) fit, ignoring dependences.
+  unsigned calculateResMII(MachineBasicBlock::iterator Begin,
+                           MachineBasicBlock::iterator End) const;
+
+  /// Return true if the resources \p MI holds when issued at \p Cycle are
+  /// still free in a schedule with the initiation interval \p II, in which
+  /// \p Scheduled are issued at the given cycles.
+  bool canReserveResources(const MachineInstr &MI, int Cycle, int II,
+                           const std::map<SUnit *, int> &Scheduled) const;
+};
+
 /// This class repesents the scheduled code.  The main data structure is a
 /// map from scheduled cycle to instructions.  During scheduling, the
 /// data structure explicitly represents all stages/iterations.   When
@@ -582,12 +647,20 @@ private:
   /// Virtual register information.
   MachineRegisterInfo &MRI;
 
+  /// The target's DFA, or null if resources are modelled with SchedResources.
   DFAPacketizer *Resources;
 
+  SchedModelResources SchedResources;
+
+  bool canReserveResources(SUnit *SU, int Cycle, int II);
+
 public:
   SMSchedule(MachineFunction *mf)
       : ST(mf->getSubtarget()), MRI(mf->getRegInfo()),
-        Resources(ST.getInstrInfo()->CreateTargetScheduleState(ST)) {
+        Resources(useDFAforSMS(ST)
+                      ? ST.getInstrInfo()->CreateTargetScheduleState(ST)
+                      : nullptr),
+        SchedResources(ST) {
     FirstCycle = 0;
     LastCycle = 0;
     InitiationInterval = 0;
@@ -1305,8 +1378,12 @@ struct FuncUnitSorter {
 /// to add it to each existing DFA, until a legal space is found. If the
 /// instruction cannot be reserved in an existing DFA, we create a new one.
 unsigned SwingSchedulerDAG::calculateResMII() {
-  SmallVector<DFAPacketizer *, 8> Resources;
   MachineBasicBlock *MBB = Loop.getHeader();
+  if (!useDFAforSMS(MF.getSubtarget()))
+    return SchedModelResources(MF.getSubtarget())
+        .calculateResMII(MBB->getFirstNonPHI(), MBB->getFirstTerminator());
+
+  SmallVector<DFAPacketizer *, 8> Resources;
   Resources.push_back(TII->CreateTargetScheduleState(MF.getSubtarget()));
 
   // Sort the instructions by the number of available choices for scheduling,
@@ -3487,24 +3564,8 @@ bool SMSchedule::insert(SUnit *SU, int StartCycle, int EndCycle, int II) {
   for (int curCycle = StartCycle; curCycle != termCycle;
        forward ? ++curCycle : --curCycle) {
 
-    // Add the already scheduled instructions at the specified cycle to the DFA.
-    Resources->clearResources();
-    for (int checkCycle = FirstCycle + ((curCycle - FirstCycle) % II);
-         checkCycle <= LastCycle; checkCycle += II) {
-      std::deque<SUnit *> &cycleInstrs = ScheduledInstrs[checkCycle];
-
-      for (std::deque<SUnit *>::iterator I = cycleInstrs.begin(),
-                                         E = cycleInstrs.end();
-           I != E; ++I) {
-        if (ST.getInstrInfo()->isZeroCost((*I)->getInstr()->getOpcode()))
-          continue;
-        assert(Resources->canReserveResources(*(*I)->getInstr()) &&
-               "These instructions have already been scheduled.");
-        Resources->reserveResources(*(*I)->getInstr());
-      }
-    }
     if (ST.getInstrInfo()->isZeroCost(SU->getInstr()->getOpcode()) ||
-        Resources->canReserveResources(*SU->getInstr())) {
+        canReserveResources(SU, curCycle, II)) {
       DEBUG({
         dbgs() << "\tinsert at cycle " << curCycle << " ";
         SU->getInstr()->dump();
@@ -3526,6 +3587,133 @@ bool SMSchedule::insert(SUnit *SU, int StartCycle, int EndCycle, int II) {
   return false;
 }
 
+/// Return true if the resources SU needs are free at the specified cycle.
+bool SMSchedule::canReserveResources(SUnit *SU, int Cycle, int II) {
+  if (!Resources)
+    return SchedResources.canReserveResources(*SU->getInstr(), Cycle, II,
+                                              InstrToCycle);
+
+  // Add the already scheduled instructions at the specified cycle to the DFA.
+  Resources->clearResources();
+  for (int checkCycle = FirstCycle + ((Cycle - FirstCycle) % II);
+       checkCycle <= LastCycle; checkCycle += II) {
+    std::deque<SUnit *> &cycleInstrs = ScheduledInstrs[checkCycle];
+
+    for (std::deque<SUnit *>::iterator I = cycleInstrs.begin(),
+                                       E = cycleInstrs.end();
+         I != E; ++I) {
+      if (ST.getInstrInfo()->isZeroCost((*I)->getInstr()->getOpcode()))
+        continue;
+      assert(Resources->canReserveResources(*(*I)->getInstr()) &&
+             "These instructions have already been scheduled.");
+      Resources->reserveResources(*(*I)->getInstr());
+    }
+  }
+  return Resources->canReserveResources(*SU->getInstr());
+}
+
+void SchedModelResources::getResourceUses(
+    const MachineInstr &MI, SmallVectorImpl<ResourceUse> &Uses) const {
+  if (SchedModel.hasInstrSchedModel()) {
+    const MCSchedClassDesc *SC = SchedModel.resolveSchedClass(&MI);
+    if (!SC->isValid())
+      return;
+    for (const MCWriteProcResEntry &PRE :
+         make_range(SchedModel.getWriteProcResBegin(SC),
+                    SchedModel.getWriteProcResEnd(SC))) {
+      unsigned NumUnits =
+          SchedModel.getProcResource(PRE.ProcResourceIdx)->NumUnits;
+      if (NumUnits && PRE.Cycles)
+        Uses.push_back({PRE.ProcResourceIdx, NumUnits, 0, PRE.Cycles});
+    }
+    return;
+  }
+
+  if (!SchedModel.hasInstrItineraries())
+    return;
+  const InstrItineraryData *IID = SchedModel.getInstrItineraries();
+  unsigned SchedClass = MI.getDesc().getSchedClass();
+  unsigned StartCycle = 0;
+  for (const InstrStage *IS = IID->beginStage(SchedClass),
+                        *IE = IID->endStage(SchedClass);
+       IS != IE; ++IS) {
+    unsigned Units = IS->getUnits();
+    if (Units && IS->getCycles())
+      Uses.push_back({uint64_t(Units) << 32, countPopulation(Units), StartCycle,
+                      IS->getCycles()});
+    StartCycle += IS->getNextCycles();
+  }
+}
+
+unsigned
+SchedModelResources::calculateResMII(MachineBasicBlock::iterator Begin,
+                                     MachineBasicBlock::iterator End) const {
+  // Each resource needs at least as many cycles as its units are held for,
+  // divided by the number of units, and the same goes for the issue width.
+  DenseMap<uint64_t, std::pair<unsigned, unsigned>> CyclesAndUnits;
+  unsigned NumMicroOps = 0;
+  SmallVector<ResourceUse, 8> Uses;
+  for (MachineBasicBlock::iterator I = Begin; I != End; ++I) {
+    if (TII->isZeroCost(I->getOpcode()))
+      continue;
+    NumMicroOps += getNumMicroOps(*I);
+    Uses.clear();
+    getResourceUses(*I, Uses);
+    for (const ResourceUse &U : Uses) {
+      auto &Entry = CyclesAndUnits[U.Resource];
+      Entry.first += U.Cycles;
+      Entry.second = U.NumUnits;
+    }
+  }
+
+  unsigned ResMII = 1;
+  if (unsigned IssueWidth = getIssueWidth())
+    ResMII = std::max(ResMII, (NumMicroOps + IssueWidth - 1) / IssueWidth);
+  for (const auto &Entry : CyclesAndUnits) {
+    unsigned Cycles = Entry.second.first, NumUnits = Entry.second.second;
+    ResMII = std::max(ResMII, (Cycles + NumUnits - 1) / NumUnits);
+  }
+  return ResMII;
+}
+
+bool SchedModelResources::canReserveResources(
+    const MachineInstr &MI, int Cycle, int II,
+    const std::map<SUnit *, int> &Scheduled) const {
+  // Count the units of each resource taken in each cycle of the II, starting
+  // with the new instruction's own needs, and check them against the number
+  // of units once the scheduled instructions are added.
+  auto Slot = [II](int C) { return ((C % II) + II) % II; };
+  DenseMap<std::pair<int, uint64_t>, unsigned> UnitsTaken;
+  SmallVector<unsigned, 4> MicroOpsTaken(II);
+  SmallVector<ResourceUse, 8> Uses;
+  getResourceUses(MI, Uses);
+  for (const ResourceUse &U : Uses)
+    for (unsigned C = 0; C != U.Cycles; ++C)
+      if (++UnitsTaken[std::make_pair(Slot(Cycle + U.StartCycle + C),
+                                      U.Resource)] > U.NumUnits)
+        return false;
+  MicroOpsTaken[Slot(Cycle)] = getNumMicroOps(MI);
+
+  unsigned IssueWidth = getIssueWidth();
+  for (const auto &S : Scheduled) {
+    const MachineInstr &SMI = *S.first->getInstr();
+    if (TII->isZeroCost(SMI.getOpcode()))
+      continue;
+    MicroOpsTaken[Slot(S.second)] += getNumMicroOps(SMI);
+    Uses.clear();
+    getResourceUses(SMI, Uses);
+    for (const ResourceUse &U : Uses)
+      for (unsigned C = 0; C != U.Cycles; ++C) {
+        auto I = UnitsTaken.find(std::make_pair(
+            Slot(S.second + U.StartCycle + C), U.Resource));
+        // Only the resources the new instruction needs matter.
+        if (I != UnitsTaken.end() && ++I->second > U.NumUnits)
+          return false;
+      }
+  }
+  return !IssueWidth || MicroOpsTaken[Slot(Cycle)] <= IssueWidth;
+}
+
 // Return the cycle of the earliest scheduled instruction in the chain.
 int SMSchedule::earliestCycleInChain(const SDep &Dep) {
   SmallPtrSet<SUnit *, 8> Visited;
@@ -70,6 +70,18 @@ static bool ViewMISchedDAGs = false;
 static cl::opt<unsigned> ReadyListLimit("misched-limit", cl::Hidden,
   cl::desc("Limit ready list to N instructions"), cl::init(256));
 
+// Building the DAG is superlinear in the region size, so very long
+// straight-line regions are split into windows that are scheduled separately.
+static cl::opt<unsigned> MaxRegionInstrs("misched-window-size", cl::Hidden,
+  cl::desc("Split scheduling regions longer than N instructions into windows "
+           "of N instructions (0 = no limit)"), cl::init(2048));
+
+// Bidirectional scheduling compares candidates from both boundaries for every
+// pick, so long regions fall back to the cheaper bottom-up strategy.
+static cl::opt<unsigned> MaxBidirectionalInstrs("misched-bidirectional-limit",
+  cl::Hidden, cl::desc("Schedule regions longer than N instructions bottom-up "
+                       "only (0 = no limit)"), cl::init(1024));
+
 static cl::opt<bool> EnableRegPressure("misched-regpressure", cl::Hidden,
   cl::desc("Enable register pressure scheduling."), cl::init(true));
 
@@ -440,25 +452,38 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler,
     //
     // MBB::size() uses instr_iterator to count. Here we need a bundle to count
     // as a single instruction.
+    //
+    // A region that was cut off at the window size (see MaxRegionInstrs) has
+    // no boundary instruction above it: the next region then ends right at
+    // the top of the previous one instead of at the instruction above it.
+    bool SplitAtWindow = false;
     for(MachineBasicBlock::iterator RegionEnd = MBB->end();
         RegionEnd != MBB->begin(); RegionEnd = Scheduler.begin()) {
 
       // Avoid decrementing RegionEnd for blocks with no terminator.
-      if (RegionEnd != MBB->end() ||
-          isSchedBoundary(&*std::prev(RegionEnd), &*MBB, MF, TII)) {
+      if (!SplitAtWindow &&
+          (RegionEnd != MBB->end() ||
+           isSchedBoundary(&*std::prev(RegionEnd), &*MBB, MF, TII))) {
         --RegionEnd;
       }
 
       // The next region starts above the previous region. Look backward in the
-      // instruction stream until we find the nearest boundary.
+      // instruction stream until we find the nearest boundary, or until the
+      // region is as large as we are willing to build a DAG for.
       unsigned NumRegionInstrs = 0;
+      SplitAtWindow = false;
       MachineBasicBlock::iterator I = RegionEnd;
       for (;I != MBB->begin(); --I) {
         MachineInstr &MI = *std::prev(I);
         if (isSchedBoundary(&MI, &*MBB, MF, TII))
           break;
-        if (!MI.isDebugValue())
-          ++NumRegionInstrs;
+        if (MI.isDebugValue())
+          continue;
+        if (MaxRegionInstrs && NumRegionInstrs == MaxRegionInstrs) {
+          SplitAtWindow = true;
+          break;
+        }
+        ++NumRegionInstrs;
       }
       // Notify the scheduler of the region, even if we may skip scheduling
       // it. Perhaps it still needs to be bundled.
@@ -2605,6 +2630,12 @@ void GenericScheduler::initPolicy(MachineBasicBlock::iterator Begin,
   // Allow the subtarget to override default policy.
   MF.getSubtarget().overrideSchedPolicy(RegionPolicy, NumRegionInstrs);
 
+  // Keep the compile time of long regions down by scheduling them in one
+  // direction only, unless the subtarget asked for top-down.
+  if (MaxBidirectionalInstrs && NumRegionInstrs > MaxBidirectionalInstrs &&
+      !RegionPolicy.OnlyTopDown)
+    RegionPolicy.OnlyBottomUp = true;
+
   // After subtarget overrides, apply command line options.
   if (!EnableRegPressure)
     RegionPolicy.ShouldTrackPressure = false;
@@ -50,14 +50,28 @@ std::unique_ptr<Module> llvm::splitCodeGen(
   }
 
   // Create ThreadPool in nested scope so that threads will be joined
-  // on destruction.
+  // on destruction. The last partition is code generated on the calling
+  // thread, so the pool only needs one thread per remaining partition.
+  // SplitModule balances the partitions by size and hands them out heaviest
+  // first, so the pool starts on the big ones and the calling thread gets the
+  // smallest.
   {
-    ThreadPool CodegenThreadPool(OSs.size());
-    int ThreadCount = 0;
+    ThreadPool CodegenThreadPool(OSs.size() - 1);
+    unsigned ThreadCount = 0;
 
     SplitModule(
         std::move(M), OSs.size(),
         [&](std::unique_ptr<Module> MPart) {
+          // The last partition is emitted directly from the original context
+          // on this thread, which would otherwise sit idle waiting for the
+          // pool. This saves a bitcode round trip for one of the partitions.
+          if (ThreadCount == OSs.size() - 1) {
+            if (!BCOSs.empty())
+              WriteBitcodeToFile(MPart.get(), *BCOSs[ThreadCount]);
+            codegen(MPart.get(), *OSs[ThreadCount++], TMFactory, FileType);
+            return;
+          }
+
           // We want to clone the module in a new context to multi-thread the
           // codegen. We do it by serializing partition modules to bitcode
           // (while still on the main thread, in order to avoid data races) and
@@ -92,7 +106,7 @@ std::unique_ptr<Module> llvm::splitCodeGen(
               // copied into the thread's context.
               std::move(BC));
         },
-        PreserveLocals);
+        PreserveLocals, /*BalanceBySize=*/true);
   }
 
   return {};
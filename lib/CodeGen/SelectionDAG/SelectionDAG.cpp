@@ -877,6 +877,13 @@ void SelectionDAG::init(MachineFunction &mf) {
   TLI = getSubtarget().getTargetLowering();
   TSI = getSubtarget().getSelectionDAGInfo();
   Context = &mf.getFunction()->getContext();
+
+  // Operand arrays are kept for reuse across the blocks of a function, see
+  // clear(). Release them between functions so a single huge block doesn't pin
+  // its memory for the rest of the module.
+  assert(AllNodes.size() == 1 && "DAG not cleared before a new function");
+  OperandRecycler.clear(OperandAllocator);
+  OperandAllocator.Reset();
 }
 
 SelectionDAG::~SelectionDAG() {
@@ -960,9 +967,12 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
 }
 
 void SelectionDAG::clear() {
+  // The operand arrays of the deleted nodes go back to OperandRecycler, where
+  // they are picked up again by the nodes of the next block. Like the node
+  // memory itself, the slabs they live in are not freed until the next
+  // function, so that a large function doesn't go back to malloc for every
+  // one of its blocks.
   allnodes_clear();
-  OperandRecycler.clear(OperandAllocator);
-  OperandAllocator.Reset();
   CSEMap.clear();
 
   ExtendedValueTypeNodes.clear();
@@ -20,6 +20,7 @@
 #include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/EHPersonalities.h"
+#include "llvm/Analysis/OptimizationDiagnosticInfo.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/CodeGen/FastISel.h"
 #include "llvm/CodeGen/FunctionLoweringInfo.h"
@@ -73,12 +74,6 @@ STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
 
-#ifndef NDEBUG
-static cl::opt<bool>
-EnableFastISelVerbose2("fast-isel-verbose2", cl::Hidden,
-          cl::desc("Enable extra verbose messages in the \"fast\" "
-                   "instruction selector"));
-
   // Terminators
 STATISTIC(NumFastIselFailRet,"Fast isel fails on Ret");
 STATISTIC(NumFastIselFailBr,"Fast isel fails on Br");
@@ -165,7 +160,13 @@ STATISTIC(NumFastIselFailFrameaddress, "Fast isel fails on Frameaddress");
 STATISTIC(NumFastIselFailSqrt, "Fast isel fails on sqrt call");
 STATISTIC(NumFastIselFailStackMap, "Fast isel fails on StackMap call");
 STATISTIC(NumFastIselFailPatchPoint, "Fast isel fails on PatchPoint call");
-#endif
+STATISTIC(NumFastIselFailOther, "Fast isel fails on other instructions");
+
+// Types that commonly defeat fast isel, independently of the opcode.
+STATISTIC(NumFastIselFailVectorTy,
+          "Fast isel fails on instructions with vector types");
+STATISTIC(NumFastIselFailWideIntTy,
+          "Fast isel fails on instructions with integers wider than 64 bits");
 
 static cl::opt<bool>
 EnableFastISelVerbose("fast-isel-verbose", cl::Hidden,
@@ -462,6 +463,8 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
 
   SplitCriticalSideEffectEdges(const_cast<Function &>(Fn));
 
+  ORE = make_unique<OptimizationRemarkEmitter>(const_cast<Function *>(&Fn));
+
   CurDAG->init(*MF);
   FuncInfo->set(Fn, *MF, CurDAG);
 
@@ -1039,14 +1042,25 @@ static bool isFoldedOrDeadInstruction(const Instruction *I,
          !FuncInfo->isExportedInst(I); // Exported instrs must be computed.
 }
 
-#ifndef NDEBUG
 // Collect per Instruction statistics for fast-isel misses.  Only those
 // instructions that cause the bail are accounted for.  It does not account for
 // instructions higher in the block.  Thus, summing the per instructions stats
 // will not add up to what is reported by NumFastIselFailures.
 static void collectFailStats(const Instruction *I) {
+  auto HasType = [I](function_ref<bool(const Type *)> Pred) {
+    return Pred(I->getType()) ||
+           any_of(I->operands(),
+                  [&](const Use &U) { return Pred(U->getType()); });
+  };
+  if (HasType([](const Type *Ty) { return Ty->isVectorTy(); }))
+    NumFastIselFailVectorTy++;
+  if (HasType([](const Type *Ty) {
+        return Ty->isIntegerTy() && Ty->getIntegerBitWidth() > 64;
+      }))
+    NumFastIselFailWideIntTy++;
+
   switch (I->getOpcode()) {
-  default: assert (0 && "<Invalid operator> ");
+  default:                       NumFastIselFailOther++; return;
 
   // Terminators
   case Instruction::Ret:         NumFastIselFailRet++; return;
@@ -1147,7 +1161,31 @@ static void collectFailStats(const Instruction *I) {
   case Instruction::LandingPad:     NumFastIselFailLandingPad++; return;
   }
 }
-#endif // NDEBUG
+
+/// Emit a missed-optimization remark for an instruction FastISel could not
+/// select, so that fallbacks to SelectionDAG can be tracked with
+/// -pass-remarks-missed=sdagisel or the remark YAML file.
+static void reportFastISelMiss(OptimizationRemarkEmitter &ORE,
+                               const Instruction *I) {
+  OptimizationRemarkMissed R("sdagisel", "FastISelFailure", I->getDebugLoc(),
+                             const_cast<BasicBlock *>(I->getParent()));
+  typedef DiagnosticInfoOptimizationBase::Argument Arg;
+  R << "FastISel missed " << Arg("Opcode", I->getOpcodeName());
+  if (const auto *CI = dyn_cast<CallInst>(I))
+    if (Function *Callee = CI->getCalledFunction())
+      R << " to " << Arg("Callee", Callee);
+  // Printing the whole instruction would need a slot tracker; the type is
+  // usually what FastISel chokes on anyway. Use the stored value for stores
+  // and the like.
+  Type *Ty = I->getType();
+  if (Ty->isVoidTy() && I->getNumOperands())
+    Ty = I->getOperand(0)->getType();
+  std::string TypeStr;
+  raw_string_ostream OS(TypeStr);
+  Ty->print(OS);
+  R << " of type " << Arg("Type", OS.str());
+  ORE.emit(R);
+}
 
 /// Set up SwiftErrorVals by going through the function. If the function has
 /// swifterror argument, it will be the first entry.
@@ -1403,6 +1441,11 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           if (EnableFastISelAbort > 1)
             report_fatal_error("FastISel didn't lower all arguments");
 
+          OptimizationRemarkMissed R("sdagisel", "FastISelFailure", DebugLoc(),
+                                     const_cast<BasicBlock *>(LLVMBB));
+          R << "FastISel didn't lower all arguments";
+          ORE->emit(R);
+
           // Use SelectionDAG argument lowering
           LowerArguments(Fn);
           CurDAG->setRoot(SDB->getControlRoot());
@@ -1458,10 +1501,8 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           continue;
         }
 
-#ifndef NDEBUG
-        if (EnableFastISelVerbose2)
+        if (AreStatisticsEnabled())
           collectFailStats(Inst);
-#endif
 
         // Then handle certain instructions as single-LLVM-Instruction blocks.
         if (isa<CallInst>(Inst)) {
@@ -1474,6 +1515,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
             // FastISel selector couldn't handle something and bailed.
             // For the purpose of debugging, just abort.
             report_fatal_error("FastISel didn't select the entire block");
+          reportFastISelMiss(*ORE, Inst);
 
           if (!Inst->getType()->isVoidTy() && !Inst->getType()->isTokenTy() &&
               !Inst->use_empty()) {
@@ -1518,6 +1560,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           // FastISel selector couldn't handle something and bailed.
           // For the purpose of debugging, just abort.
           report_fatal_error("FastISel didn't select the entire block");
+        reportFastISelMiss(*ORE, Inst);
 
         NumFastIselFailures += NumFastIselRemaining;
         break;
@@ -3095,8 +3138,22 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
 
     case OPC_SwitchOpcode: {
       unsigned CurNodeOpcode = N.getOpcode();
-      unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
+      unsigned SwitchStart = MatcherIndex-1;
+      uint64_t CacheKey = ((uint64_t)SwitchStart << 32) | CurNodeOpcode;
+
+      // If this switch was dispatched on this opcode before, jump straight to
+      // the case we found then.
+      auto Cached = SwitchCaseCache.find(CacheKey);
+      if (Cached != SwitchCaseCache.end()) {
+        if (Cached->second == 0) break;
+        MatcherIndex = Cached->second;
+        DEBUG(dbgs() << "  OpcodeSwitch from " << SwitchStart
+                     << " to " << MatcherIndex << " (cached)\n");
+        continue;
+      }
+
       unsigned CaseSize;
+      unsigned NumCasesSkipped = 0;
       while (1) {
         // Get the size of this case.
         CaseSize = MatcherTable[MatcherIndex++];
@@ -3113,8 +3170,14 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
 
         // Otherwise, skip over this case.
         MatcherIndex += CaseSize;
+        ++NumCasesSkipped;
       }
 
+      // Scanning a handful of cases is cheaper than a hash lookup, so only
+      // remember the outcome for switches that took a while to resolve.
+      if (NumCasesSkipped >= 4)
+        SwitchCaseCache[CacheKey] = CaseSize ? MatcherIndex : 0;
+
       // If no cases matched, bail out.
       if (CaseSize == 0) break;
 
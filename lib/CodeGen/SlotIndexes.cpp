@@ -31,7 +31,8 @@ void SlotIndexes::getAnalysisUsage(AnalysisUsage &au) const {
 }
 
 void SlotIndexes::releaseMemory() {
-  mi2iMap.clear();
+  // The instructions may have been deleted by now, so their SlotIndexEntry
+  // fields are left dangling. runOnMachineFunction resets them.
   MBBRanges.clear();
   idx2MBBMap.clear();
   indexList.clear();
@@ -48,7 +49,7 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
   // At each iteration assert that the instruction pointed to in the index
   // is the same one pointed to by the MI iterator. This
 
-  // FIXME: This can be simplified. The mi2iMap_, Idx2MBBMap, etc. should
+  // FIXME: This can be simplified. The Idx2MBBMap, etc. should
   // only need to be set up once after the first numbering is computed.
 
   mf = &fn;
@@ -59,8 +60,6 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
          "Index -> MBB mapping non-empty at initial numbering?");
   assert(MBBRanges.empty() &&
          "MBB -> Index mapping non-empty at initial numbering?");
-  assert(mi2iMap.empty() &&
-         "MachineInstr -> Index mapping non-empty at initial numbering?");
 
   unsigned index = 0;
   MBBRanges.resize(mf->getNumBlockIDs());
@@ -73,6 +72,11 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
     // Insert an index for the MBB start.
     SlotIndex blockStartIndex(&indexList.back(), SlotIndex::Slot_Block);
 
+    // Forget any numbering left from an earlier run, including that of
+    // instructions which are not numbered this time.
+    for (MachineInstr &MI : MBB.instrs())
+      MI.SlotIndexEntry = nullptr;
+
     for (MachineInstr &MI : MBB) {
       if (MI.isDebugValue())
         continue;
@@ -80,9 +84,8 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
       // Insert a store index for the instr.
       indexList.push_back(createEntry(&MI, index += SlotIndex::InstrDist));
 
-      // Save this base index in the maps.
-      mi2iMap.insert(std::make_pair(
-          &MI, SlotIndex(&indexList.back(), SlotIndex::Slot_Block)));
+      // Save this base index in the instruction.
+      MI.SlotIndexEntry = &indexList.back();
     }
 
     // We insert one blank instructions between basic blocks.
@@ -186,7 +189,7 @@ void SlotIndexes::repairIndexesInRange(MachineBasicBlock *MBB,
         --MBBI;
       else
         pastStart = true;
-    } else if (MI && mi2iMap.find(MI) == mi2iMap.end()) {
+    } else if (MI && !hasIndex(*MI)) {
       if (MBBI != Begin)
         --MBBI;
       else
@@ -203,7 +206,7 @@ void SlotIndexes::repairIndexesInRange(MachineBasicBlock *MBB,
   for (MachineBasicBlock::iterator I = End; I != Begin;) {
     --I;
     MachineInstr &MI = *I;
-    if (!MI.isDebugValue() && mi2iMap.find(&MI) == mi2iMap.end())
+    if (!MI.isDebugValue() && !hasIndex(MI))
       insertMachineInstrInMaps(MI);
   }
 }
@@ -19,6 +19,7 @@
 #include "llvm/MC/MCSectionMachO.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOpcodes.h"
 #include "llvm/Target/TargetRegisterInfo.h"
@@ -165,8 +166,8 @@ void StackMaps::print(raw_ostream &OS) {
       AP.MF ? AP.MF->getSubtarget().getRegisterInfo() : nullptr;
   OS << WSMP << "callsites:\n";
   for (const auto &CSI : CSInfos) {
-    const LocationVec &CSLocs = CSI.Locations;
-    const LiveOutVec &LiveOuts = CSI.LiveOuts;
+    ArrayRef<EncodedLocation> CSLocs = CSI.locations(CSLocations);
+    ArrayRef<LiveOutReg> LiveOuts = CSI.liveOuts(CSLiveOuts);
 
     OS << WSMP << "callsite " << CSI.ID << "\n";
     OS << WSMP << "  has " << CSLocs.size() << " locations\n";
@@ -174,7 +175,7 @@ void StackMaps::print(raw_ostream &OS) {
     unsigned Idx = 0;
     for (const auto &Loc : CSLocs) {
       OS << WSMP << "\t\tLoc " << Idx << ": ";
-      switch (Loc.Type) {
+      switch ((Location::LocationType)Loc.Type) {
       case Location::Unprocessed:
         OS << "<Unprocessed operand>";
         break;
@@ -209,8 +210,9 @@ void StackMaps::print(raw_ostream &OS) {
         OS << "Constant Index " << Loc.Offset;
         break;
       }
-      OS << "\t[encoding: .byte " << Loc.Type << ", .byte " << Loc.Size
-         << ", .short " << Loc.Reg << ", .int " << Loc.Offset << "]\n";
+      OS << "\t[encoding: .byte " << unsigned(Loc.Type) << ", .byte "
+         << unsigned(Loc.Size) << ", .short " << Loc.Reg << ", .int "
+         << Loc.Offset << "]\n";
       Idx++;
     }
 
@@ -305,7 +307,9 @@ void StackMaps::recordStackMapOpers(const MachineInstr &MI, uint64_t ID,
     MOI = parseOperand(MOI, MOE, Locations, LiveOuts);
   }
 
-  // Move large constants into the constant pool.
+  // Move large constants into the constant pool and append the encoded
+  // locations to the shared list.
+  unsigned FirstLocation = CSLocations.size();
   for (auto &Loc : Locations) {
     // Constants are encoded as sign-extended integers.
     // -1 is directly encoded as .long 0xFFFFFFFF with no constant pool.
@@ -324,7 +328,18 @@ void StackMaps::recordStackMapOpers(const MachineInstr &MI, uint64_t ID,
       auto Result = ConstPool.insert(std::make_pair(Loc.Offset, Loc.Offset));
       Loc.Offset = Result.first - ConstPool.begin();
     }
+    // The encoding has fixed width fields.
+    if (!isUInt<8>(Loc.Size))
+      report_fatal_error("stackmap location size does not fit in 8 bits");
+    if (!isUInt<16>(Loc.Reg))
+      report_fatal_error("stackmap location register does not fit in 16 bits");
+    if (!isInt<32>(Loc.Offset))
+      report_fatal_error("stackmap location offset does not fit in 32 bits");
+    CSLocations.push_back({uint8_t(Loc.Type), uint8_t(Loc.Size),
+                           uint16_t(Loc.Reg), int32_t(Loc.Offset)});
   }
+  unsigned FirstLiveOut = CSLiveOuts.size();
+  CSLiveOuts.insert(CSLiveOuts.end(), LiveOuts.begin(), LiveOuts.end());
 
   // Create an expression to calculate the offset of the callsite from function
   // entry.
@@ -332,8 +347,8 @@ void StackMaps::recordStackMapOpers(const MachineInstr &MI, uint64_t ID,
       MCSymbolRefExpr::create(MILabel, OutContext),
       MCSymbolRefExpr::create(AP.CurrentFnSymForSize, OutContext), OutContext);
 
-  CSInfos.emplace_back(CSOffsetExpr, ID, std::move(Locations),
-                       std::move(LiveOuts));
+  CSInfos.emplace_back(CSOffsetExpr, ID, FirstLocation, Locations.size(),
+                       FirstLiveOut, LiveOuts.size());
 
   // Record the stack size of the current function and update callsite count.
   const MachineFrameInfo &MFI = AP.MF->getFrameInfo();
@@ -369,7 +384,7 @@ void StackMaps::recordPatchPoint(const MachineInstr &MI) {
 
 #ifndef NDEBUG
   // verify anyregcc
-  auto &Locations = CSInfos.back().Locations;
+  auto Locations = CSInfos.back().locations(CSLocations);
   if (opers.isAnyReg()) {
     unsigned NArgs = opers.getNumCallArgs();
     for (unsigned i = 0, e = (opers.hasDef() ? NArgs + 1 : NArgs); i != e; ++i)
@@ -481,8 +496,8 @@ void StackMaps::emitCallsiteEntries(MCStreamer &OS) {
   DEBUG(print(dbgs()));
   // Callsite entries.
   for (const auto &CSI : CSInfos) {
-    const LocationVec &CSLocs = CSI.Locations;
-    const LiveOutVec &LiveOuts = CSI.LiveOuts;
+    ArrayRef<EncodedLocation> CSLocs = CSI.locations(CSLocations);
+    ArrayRef<LiveOutReg> LiveOuts = CSI.liveOuts(CSLiveOuts);
 
     // Verify stack map entry. It's better to communicate a problem to the
     // runtime than crash in case of in-process compilation. Currently, we do
@@ -559,5 +574,7 @@ void StackMaps::serializeToStackMapSection() {
 
   // Clean up.
   CSInfos.clear();
+  CSLocations.clear();
+  CSLiveOuts.clear();
   ConstPool.clear();
 }
@@ -15,7 +15,8 @@ using namespace codeview;
 
 TypeIndex MemoryTypeTableBuilder::writeRecord(StringRef Data) {
   assert(Data.size() <= UINT16_MAX);
-  auto I = HashedRecords.find(Data);
+  HashedRecord Key = {Data, DenseMapInfo<StringRef>::getHashValue(Data)};
+  auto I = HashedRecords.find(Key);
   if (I != HashedRecords.end()) {
     return I->second;
   }
@@ -39,7 +40,8 @@ TypeIndex MemoryTypeTableBuilder::writeRecord(StringRef Data) {
 
   // Use only the data supplied by the user as a key to the hash table, so that
   // future lookups will succeed.
-  HashedRecords.insert(std::make_pair(StringRef(Mem + SizeOfRecLen, Data.size()), TI));
+  Key.Data = StringRef(Mem + SizeOfRecLen, Data.size());
+  HashedRecords.insert(std::make_pair(Key, TI));
   Records.push_back(StringRef(Mem, TotalSize));
 
   return TI;
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/DWARF/DWARFAbbreviationDeclaration.h"
+#include "llvm/DebugInfo/DWARF/DWARFFormValue.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
@@ -19,6 +20,7 @@ void DWARFAbbreviationDeclaration::clear() {
   Tag = 0;
   HasChildren = false;
   AttributeSpecs.clear();
+  FixedOffsets.clear();
 }
 
 DWARFAbbreviationDeclaration::DWARFAbbreviationDeclaration() {
@@ -58,6 +60,26 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data, uint32_t* OffsetPtr) {
     clear();
     return false;
   }
+
+  // Record where the values of the leading attributes start, up to and
+  // including the first one whose predecessors aren't all of a fixed size.
+  // Apart from DW_FORM_addr and DW_FORM_ref_addr, the fixed form sizes are
+  // the same for all units.
+  ArrayRef<uint8_t> FixedFormSizes = DWARFFormValue::getFixedFormSizes(8, 4);
+  FixedOffset Cur = {0, 0, 0};
+  for (const AttributeSpec &Spec : AttributeSpecs) {
+    FixedOffsets.push_back(Cur);
+    if (Spec.Form == DW_FORM_addr)
+      ++Cur.NumAddrs;
+    else if (Spec.Form == DW_FORM_ref_addr)
+      ++Cur.NumRefAddrs;
+    else if (Spec.Form == DW_FORM_flag_present)
+      continue;
+    else if (Spec.Form < FixedFormSizes.size() && FixedFormSizes[Spec.Form])
+      Cur.Bytes += FixedFormSizes[Spec.Form];
+    else
+      break;
+  }
   return true;
 }
 
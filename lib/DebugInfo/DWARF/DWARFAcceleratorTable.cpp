@@ -43,6 +43,78 @@ bool DWARFAcceleratorTable::extract() {
     HdrData.Atoms.push_back(std::make_pair(AtomType, AtomForm));
   }
 
+  IsValid = true;
+  return true;
+}
+
+/// The hash function of the tables, DW_hash_function_djb.
+static uint32_t djbHash(StringRef Name) {
+  uint32_t H = 5381;
+  for (unsigned char C : Name)
+    H = (H << 5) + H + C;
+  return H;
+}
+
+bool DWARFAcceleratorTable::lookup(
+    StringRef Name, SmallVectorImpl<uint32_t> &DIEOffsets) const {
+  if (!IsValid || Hdr.HashFunction != dwarf::DW_hash_function_djb ||
+      !Hdr.NumBuckets)
+    return false;
+
+  SmallVector<DWARFFormValue, 3> AtomForms;
+  int DIEOffsetAtom = -1;
+  for (const auto &Atom : HdrData.Atoms) {
+    if (Atom.first == dwarf::DW_ATOM_die_offset)
+      DIEOffsetAtom = AtomForms.size();
+    AtomForms.push_back(DWARFFormValue(Atom.second));
+  }
+  if (DIEOffsetAtom < 0)
+    return false;
+
+  uint32_t Hash = djbHash(Name);
+  uint32_t Bucket = Hash % Hdr.NumBuckets;
+  uint32_t BucketsBase = sizeof(Hdr) + Hdr.HeaderDataLength;
+  uint32_t HashesBase = BucketsBase + Hdr.NumBuckets * 4;
+  uint32_t OffsetsBase = HashesBase + Hdr.NumHashes * 4;
+
+  uint32_t Offset = BucketsBase + Bucket * 4;
+  uint32_t Index = AccelSection.getU32(&Offset);
+  if (Index == UINT32_MAX)
+    return true;
+
+  // The hashes of a bucket are contiguous, starting at its index.
+  for (uint32_t HashIdx = Index; HashIdx < Hdr.NumHashes; ++HashIdx) {
+    uint32_t HashOffset = HashesBase + HashIdx * 4;
+    uint32_t CurHash = AccelSection.getU32(&HashOffset);
+    if (CurHash % Hdr.NumBuckets != Bucket)
+      break;
+    if (CurHash != Hash)
+      continue;
+
+    uint32_t OffsetsOffset = OffsetsBase + HashIdx * 4;
+    uint32_t DataOffset = AccelSection.getU32(&OffsetsOffset);
+    // The data of a hash is a list of names, each followed by its DIEs.
+    while (AccelSection.isValidOffsetForDataOfSize(DataOffset, 4)) {
+      uint32_t StringOffset = AccelSection.getU32(&DataOffset);
+      RelocAddrMap::const_iterator Reloc = Relocs.find(DataOffset - 4);
+      if (Reloc != Relocs.end())
+        StringOffset += Reloc->second.second;
+      if (!StringOffset)
+        break;
+      bool Matches = Name == StringSection.getCStr(&StringOffset);
+      uint32_t NumData = AccelSection.getU32(&DataOffset);
+      for (uint32_t Data = 0; Data < NumData; ++Data) {
+        for (unsigned I = 0, E = AtomForms.size(); I != E; ++I) {
+          DWARFFormValue &Atom = AtomForms[I];
+          if (!Atom.extractValue(AccelSection, &DataOffset, nullptr))
+            return true;
+          if (Matches && (int)I == DIEOffsetAtom)
+            if (Optional<uint64_t> DIEOffset = Atom.getAsUnsignedConstant())
+              DIEOffsets.push_back(HdrData.DIEOffsetBase + *DIEOffset);
+        }
+      }
+    }
+  }
   return true;
 }
 
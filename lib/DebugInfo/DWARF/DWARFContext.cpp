@@ -314,6 +314,37 @@ DWARFGdbIndex &DWARFContext::getGdbIndex() {
   return *GdbIndex;
 }
 
+const DWARFAcceleratorTable &DWARFContext::getAppleNames() {
+  if (AppleNames)
+    return *AppleNames;
+
+  const DWARFSection &Section = getAppleNamesSection();
+  DataExtractor AccelSection(Section.Data, isLittleEndian(), 0);
+  DataExtractor StrData(getStringSection(), isLittleEndian(), 0);
+  AppleNames = llvm::make_unique<DWARFAcceleratorTable>(AccelSection, StrData,
+                                                        Section.Relocs);
+  AppleNames->extract();
+  return *AppleNames;
+}
+
+bool DWARFContext::findDIEsByName(
+    StringRef Name,
+    SmallVectorImpl<std::pair<DWARFCompileUnit *,
+                              const DWARFDebugInfoEntryMinimal *>> &DIEs) {
+  SmallVector<uint32_t, 4> Offsets;
+  if (!getAppleNames().lookup(Name, Offsets))
+    return false;
+  for (uint32_t Offset : Offsets) {
+    DWARFCompileUnit *CU = getCompileUnitForOffset(Offset);
+    if (!CU)
+      continue;
+    const DWARFDebugInfoEntryMinimal *Die = CU->getDIEForOffset(Offset);
+    if (Die && Die->getOffset() == Offset)
+      DIEs.push_back(std::make_pair(CU, Die));
+  }
+  return true;
+}
+
 const DWARFDebugAbbrev *DWARFContext::getDebugAbbrev() {
   if (Abbrev)
     return Abbrev.get();
@@ -362,7 +393,7 @@ const DWARFDebugAranges *DWARFContext::getDebugAranges() {
     return Aranges.get();
 
   Aranges.reset(new DWARFDebugAranges());
-  Aranges->generate(this);
+  Aranges->generate(this, ThreadCount);
   return Aranges.get();
 }
 
@@ -12,6 +12,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugArangeSet.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -35,7 +36,7 @@ void DWARFDebugAranges::extract(DataExtractor DebugArangesData) {
   }
 }
 
-void DWARFDebugAranges::generate(DWARFContext *CTX) {
+void DWARFDebugAranges::generate(DWARFContext *CTX, unsigned ThreadCount) {
   clear();
   if (!CTX)
     return;
@@ -47,15 +48,29 @@ void DWARFDebugAranges::generate(DWARFContext *CTX) {
   // Generate aranges from DIEs: even if .debug_aranges section is present,
   // it may describe only a small subset of compilation units, so we need to
   // manually build aranges for the rest of them.
-  for (const auto &CU : CTX->compile_units()) {
-    uint32_t CUOffset = CU->getOffset();
-    if (ParsedCUOffsets.insert(CUOffset).second) {
-      DWARFAddressRangesVector CURanges;
-      CU->collectAddressRanges(CURanges);
-      for (const auto &R : CURanges) {
-        appendRange(CUOffset, R.first, R.second);
-      }
-    }
+  std::vector<DWARFCompileUnit *> CUsToScan;
+  for (const auto &CU : CTX->compile_units())
+    if (ParsedCUOffsets.insert(CU->getOffset()).second)
+      CUsToScan.push_back(CU.get());
+
+  // Units only touch their own DIEs while collecting their ranges, so they can
+  // be scanned concurrently. The ranges are appended in unit order afterwards
+  // to keep the result deterministic.
+  std::vector<DWARFAddressRangesVector> CURanges(CUsToScan.size());
+  if (ThreadCount > 1 && CUsToScan.size() > 1) {
+    ThreadPool Pool(std::min<size_t>(ThreadCount, CUsToScan.size()));
+    for (size_t I = 0, E = CUsToScan.size(); I != E; ++I)
+      Pool.async([&, I] { CUsToScan[I]->collectAddressRanges(CURanges[I]); });
+    Pool.wait();
+  } else {
+    for (size_t I = 0, E = CUsToScan.size(); I != E; ++I)
+      CUsToScan[I]->collectAddressRanges(CURanges[I]);
+  }
+
+  for (size_t I = 0, E = CUsToScan.size(); I != E; ++I) {
+    uint32_t CUOffset = CUsToScan[I]->getOffset();
+    for (const auto &R : CURanges[I])
+      appendRange(CUOffset, R.first, R.second);
   }
 
   construct();
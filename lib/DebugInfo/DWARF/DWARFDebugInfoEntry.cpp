@@ -247,8 +247,18 @@ bool DWARFDebugInfoEntryMinimal::getAttributeValue(
   // Skip the abbreviation code so we are at the data for the attributes
   DebugInfoData.getULEB128(&DebugInfoOffset);
 
-  // Skip preceding attribute values.
-  for (uint32_t i = 0; i < AttrIdx; ++i) {
+  // Jump over the leading values whose sizes are known from the abbreviation,
+  // then skip the remaining preceding attribute values one by one.
+  uint32_t FirstIdx = 0;
+  ArrayRef<uint8_t> FixedFormSizes = DWARFFormValue::getFixedFormSizes(
+      U->getAddressByteSize(), U->getVersion());
+  if (!FixedFormSizes.empty() && AbbrevDecl->getNumFixedOffsetAttributes()) {
+    FirstIdx =
+        std::min(AttrIdx, AbbrevDecl->getNumFixedOffsetAttributes() - 1);
+    DebugInfoOffset +=
+        AbbrevDecl->getFixedAttributeOffset(FirstIdx, FixedFormSizes);
+  }
+  for (uint32_t i = FirstIdx; i < AttrIdx; ++i) {
     DWARFFormValue::skipValue(AbbrevDecl->getFormByIndex(i),
                               DebugInfoData, &DebugInfoOffset, U);
   }
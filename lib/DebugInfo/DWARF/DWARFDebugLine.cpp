@@ -520,6 +520,11 @@ bool DWARFDebugLine::LineTable::parse(DataExtractor debug_line_data,
     // rudimentary sequences for address ranges [0x0, 0xsomething).
   }
 
+  // Parsed tables are kept for the lifetime of the context, so don't keep the
+  // slack from growing the vectors row by row.
+  Rows.shrink_to_fit();
+  Sequences.shrink_to_fit();
+
   return end_offset;
 }
 
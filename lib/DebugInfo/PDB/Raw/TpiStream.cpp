@@ -53,6 +53,7 @@ Error TpiStream::verifyHashValues() {
 
 Error TpiStream::reload() {
   StreamReader Reader(*Stream);
+  RecordOffsets.clear();
 
   if (Reader.bytesRemaining() < sizeof(TpiStreamHeader))
     return make_error<RawError>(raw_error_code::corrupt_file,
@@ -173,4 +174,54 @@ TpiStream::types(bool *HadError) const {
   return llvm::make_range(TypeRecords.begin(HadError), TypeRecords.end());
 }
 
+Expected<CVType> TpiStream::readTypeAt(uint32_t Offset) const {
+  ReadableStreamRef Records = TypeRecords.getUnderlyingStream();
+  if (Offset >= Records.getLength())
+    return make_error<RawError>(raw_error_code::corrupt_file,
+                                "Type record offset is out of bounds.");
+  CVType Record;
+  uint32_t Len;
+  if (auto EC = TypeRecords.getExtractor()(Records.drop_front(Offset), Len,
+                                           Record))
+    return std::move(EC);
+  return Record;
+}
+
+Expected<CVType> TpiStream::getType(TypeIndex Index) const {
+  if (Index.getIndex() < TypeIndexBegin() ||
+      Index.getIndex() >= TypeIndexEnd())
+    return make_error<RawError>(raw_error_code::index_out_of_bounds,
+                                "Type index is not in the TPI stream.");
+
+  if (RecordOffsets.empty()) {
+    RecordOffsets.assign(NumTypeRecords(), UnknownOffset);
+    RecordOffsets[0] = 0;
+    // Seed the table with the offsets the hash stream provides. They are
+    // spaced out through the stream so that no lookup has to walk far.
+    for (const TypeIndexOffset &IO : TypeIndexOffsets) {
+      uint32_t I = IO.Type.getIndex();
+      if (I >= TypeIndexBegin() && I < TypeIndexEnd())
+        RecordOffsets[I - TypeIndexBegin()] = IO.Offset;
+    }
+  }
+
+  uint32_t Target = Index.getIndex() - TypeIndexBegin();
+  uint32_t I = Target;
+  while (RecordOffsets[I] == UnknownOffset)
+    --I;
+
+  // Walk forward from the closest known record, remembering the offsets
+  // of the records we pass over.
+  uint32_t Offset = RecordOffsets[I];
+  while (true) {
+    auto ExpectedRecord = readTypeAt(Offset);
+    if (!ExpectedRecord)
+      return ExpectedRecord.takeError();
+    if (I == Target)
+      return *ExpectedRecord;
+    Offset += ExpectedRecord->length();
+    RecordOffsets[++I] = Offset;
+  }
+}
+
 Error TpiStream::commit() { return Error::success(); }
@@ -0,0 +1,342 @@
+//===-- SymbolIndex.cpp ---------------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of the symbol index reader and writer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/Symbolize/SymbolIndex.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/Object/Error.h"
+#include "llvm/Support/Dwarf.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace llvm {
+namespace symbolize {
+
+typedef DILineInfoSpecifier::FileLineInfoKind FileLineInfoKind;
+typedef DILineInfoSpecifier::FunctionNameKind FunctionNameKind;
+
+static const char SymbolIndexMagic[] = "LLVMSYMX";
+static const uint32_t SymbolIndexVersion = 1;
+
+struct SymbolIndexContext::Header {
+  char Magic[8];
+  support::ulittle32_t Version;
+  support::ulittle32_t NumRanges;
+  support::ulittle32_t NumFrames;
+  support::ulittle32_t StringsSize;
+  support::ulittle64_t ObjectSize;
+  // In nanoseconds since the epoch.
+  support::ulittle64_t ObjectModificationTime;
+};
+
+struct SymbolIndexContext::Range {
+  support::ulittle64_t Start;
+  support::ulittle32_t FirstFrame;
+  // Zero for addresses without debug info.
+  support::ulittle32_t NumFrames;
+};
+
+struct SymbolIndexContext::Frame {
+  // Offsets into the string table.
+  support::ulittle32_t FileName;
+  support::ulittle32_t ShortName;
+  support::ulittle32_t LinkageName;
+  support::ulittle32_t Line;
+  support::ulittle32_t Column;
+};
+
+static uint64_t getModificationTime(const sys::fs::file_status &Status) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Status.getLastModificationTime().time_since_epoch())
+      .count();
+}
+
+SymbolIndexContext::SymbolIndexContext(std::unique_ptr<MemoryBuffer> Buffer)
+    : DIContext(CK_SymbolIndex), Buffer(std::move(Buffer)) {
+  const char *Start = this->Buffer->getBufferStart();
+  Hdr = reinterpret_cast<const Header *>(Start);
+  Ranges = reinterpret_cast<const Range *>(Start + sizeof(Header));
+  Frames = reinterpret_cast<const Frame *>(Ranges + Hdr->NumRanges);
+  Strings = StringRef(reinterpret_cast<const char *>(Frames + Hdr->NumFrames),
+                      Hdr->StringsSize);
+}
+
+ErrorOr<std::unique_ptr<SymbolIndexContext>>
+SymbolIndexContext::create(std::unique_ptr<MemoryBuffer> Buffer) {
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < sizeof(Header))
+    return object::object_error::parse_failed;
+  const auto *Hdr = reinterpret_cast<const Header *>(Data.data());
+  if (memcmp(Hdr->Magic, SymbolIndexMagic, sizeof(Hdr->Magic)) != 0 ||
+      Hdr->Version != SymbolIndexVersion)
+    return object::object_error::parse_failed;
+  uint64_t Size = sizeof(Header) + uint64_t(Hdr->NumRanges) * sizeof(Range) +
+                  uint64_t(Hdr->NumFrames) * sizeof(Frame) + Hdr->StringsSize;
+  // The string table must end with a null terminator so that the strings can
+  // be used in place.
+  if (Data.size() != Size || Hdr->StringsSize == 0 || Data.back() != '\0')
+    return object::object_error::parse_failed;
+  return std::unique_ptr<SymbolIndexContext>(
+      new SymbolIndexContext(std::move(Buffer)));
+}
+
+bool SymbolIndexContext::isUpToDate(const sys::fs::file_status &Status) const {
+  return Hdr->ObjectSize == Status.getSize() &&
+         Hdr->ObjectModificationTime == getModificationTime(Status);
+}
+
+const SymbolIndexContext::Range *
+SymbolIndexContext::findRange(uint64_t Address) const {
+  const Range *End = Ranges + Hdr->NumRanges;
+  const Range *R = std::upper_bound(
+      Ranges, End, Address,
+      [](uint64_t Address, const Range &R) { return Address < R.Start; });
+  if (R == Ranges)
+    return nullptr;
+  --R;
+  if (R->NumFrames == 0 ||
+      uint64_t(R->FirstFrame) + R->NumFrames > Hdr->NumFrames)
+    return nullptr;
+  return R;
+}
+
+StringRef SymbolIndexContext::getString(uint32_t Offset) const {
+  if (Offset >= Strings.size())
+    return StringRef();
+  return StringRef(Strings.data() + Offset);
+}
+
+DILineInfo SymbolIndexContext::getFrame(const Frame &F,
+                                        DILineInfoSpecifier Specifier) const {
+  DILineInfo Result;
+  if (Specifier.FNKind == FunctionNameKind::ShortName)
+    Result.FunctionName = getString(F.ShortName);
+  else if (Specifier.FNKind == FunctionNameKind::LinkageName)
+    Result.FunctionName = getString(F.LinkageName);
+  if (Specifier.FLIKind != FileLineInfoKind::None) {
+    Result.FileName = getString(F.FileName);
+    Result.Line = F.Line;
+    Result.Column = F.Column;
+  }
+  return Result;
+}
+
+DILineInfo
+SymbolIndexContext::getLineInfoForAddress(uint64_t Address,
+                                          DILineInfoSpecifier Specifier) {
+  if (const Range *R = findRange(Address))
+    return getFrame(Frames[R->FirstFrame], Specifier);
+  return DILineInfo();
+}
+
+DILineInfoTable
+SymbolIndexContext::getLineInfoForAddressRange(uint64_t Address, uint64_t Size,
+                                               DILineInfoSpecifier Specifier) {
+  DILineInfoTable Lines;
+  const Range *End = Ranges + Hdr->NumRanges;
+  const Range *R = std::upper_bound(
+      Ranges, End, Address,
+      [](uint64_t Address, const Range &R) { return Address < R.Start; });
+  if (R != Ranges)
+    --R;
+  for (; R != End && R->Start < Address + Size; ++R) {
+    if (R->NumFrames == 0 ||
+        uint64_t(R->FirstFrame) + R->NumFrames > Hdr->NumFrames)
+      continue;
+    Lines.push_back(std::make_pair(std::max<uint64_t>(R->Start, Address),
+                                   getFrame(Frames[R->FirstFrame], Specifier)));
+  }
+  return Lines;
+}
+
+DIInliningInfo
+SymbolIndexContext::getInliningInfoForAddress(uint64_t Address,
+                                              DILineInfoSpecifier Specifier) {
+  DIInliningInfo InliningInfo;
+  if (const Range *R = findRange(Address))
+    for (uint32_t I = 0; I != R->NumFrames; ++I)
+      InliningInfo.addFrame(getFrame(Frames[R->FirstFrame + I], Specifier));
+  return InliningInfo;
+}
+
+void SymbolIndexContext::dump(raw_ostream &OS, DIDumpType DumpType,
+                              bool DumpEH, bool SummarizeTypes) {
+  OS << "Symbol index: " << Hdr->NumRanges << " ranges, " << Hdr->NumFrames
+     << " frames, " << Hdr->StringsSize << " bytes of strings\n";
+  for (uint32_t I = 0; I != Hdr->NumRanges; ++I) {
+    const Range &R = Ranges[I];
+    OS << format("0x%016" PRIx64 ":", uint64_t(R.Start));
+    if (R.NumFrames == 0 ||
+        uint64_t(R.FirstFrame) + R.NumFrames > Hdr->NumFrames) {
+      OS << " <no debug info>\n";
+      continue;
+    }
+    OS << '\n';
+    for (uint32_t J = 0; J != R.NumFrames; ++J) {
+      const Frame &F = Frames[R.FirstFrame + J];
+      OS << "  " << getString(F.LinkageName) << ' ' << getString(F.FileName)
+         << ':' << F.Line << ':' << F.Column << '\n';
+    }
+  }
+}
+
+namespace {
+/// A frame of the index being written.
+struct IndexFrame {
+  uint32_t FileName;
+  uint32_t ShortName;
+  uint32_t LinkageName;
+  uint32_t Line;
+  uint32_t Column;
+
+  bool operator==(const IndexFrame &RHS) const {
+    return std::tie(FileName, ShortName, LinkageName, Line, Column) ==
+           std::tie(RHS.FileName, RHS.ShortName, RHS.LinkageName, RHS.Line,
+                    RHS.Column);
+  }
+};
+
+/// A string table in which each string is stored once.
+class IndexStringTable {
+  StringMap<uint32_t> Offsets;
+  std::string Data;
+
+public:
+  uint32_t add(StringRef S) {
+    auto Ins = Offsets.insert(std::make_pair(S, Data.size()));
+    if (Ins.second) {
+      Data += S;
+      Data += '\0';
+    }
+    return Ins.first->second;
+  }
+  StringRef getData() const { return Data; }
+};
+}
+
+/// Collect the addresses at which the result of a symbolization query may
+/// change: the addresses of the line table rows, and the bounds of the
+/// address ranges of units, functions and inlined calls. Queries return the
+/// same result at every address up to the next one.
+static std::vector<uint64_t> collectBoundaries(DWARFContext &DICtx) {
+  std::vector<uint64_t> Boundaries;
+  for (const auto &CU : DICtx.compile_units()) {
+    if (const DWARFDebugLine::LineTable *LineTable =
+            DICtx.getLineTableForUnit(CU.get()))
+      for (const DWARFDebugLine::Row &Row : LineTable->Rows)
+        Boundaries.push_back(Row.Address);
+    for (unsigned I = 0, E = CU->getNumDIEs(); I != E; ++I) {
+      const DWARFDebugInfoEntryMinimal *Die = CU->getDIEAtIndex(I);
+      if (Die->getTag() != dwarf::DW_TAG_compile_unit &&
+          Die->getTag() != dwarf::DW_TAG_subprogram &&
+          Die->getTag() != dwarf::DW_TAG_inlined_subroutine)
+        continue;
+      for (const auto &R : Die->getAddressRanges(CU.get())) {
+        Boundaries.push_back(R.first);
+        Boundaries.push_back(R.second);
+      }
+    }
+  }
+  std::sort(Boundaries.begin(), Boundaries.end());
+  Boundaries.erase(std::unique(Boundaries.begin(), Boundaries.end()),
+                   Boundaries.end());
+  return Boundaries;
+}
+
+template <typename T> static void writeStruct(raw_ostream &OS, const T &S) {
+  OS.write(reinterpret_cast<const char *>(&S), sizeof(S));
+}
+
+void writeSymbolIndex(DWARFContext &DICtx, const sys::fs::file_status &Status,
+                      raw_ostream &OS) {
+  typedef SymbolIndexContext::Header Header;
+  typedef SymbolIndexContext::Range Range;
+  typedef SymbolIndexContext::Frame Frame;
+
+  // These are the queries the symbolizer makes.
+  DILineInfoSpecifier LinkageSpec(FileLineInfoKind::AbsoluteFilePath,
+                                  FunctionNameKind::LinkageName);
+  DILineInfoSpecifier ShortSpec(FileLineInfoKind::AbsoluteFilePath,
+                                FunctionNameKind::ShortName);
+
+  IndexStringTable Strings;
+  std::vector<std::pair<uint64_t, std::pair<uint32_t, uint32_t>>> Ranges;
+  std::vector<IndexFrame> Frames;
+  std::vector<IndexFrame> Chain;
+  for (uint64_t Address : collectBoundaries(DICtx)) {
+    DIInliningInfo Linkage = DICtx.getInliningInfoForAddress(Address,
+                                                             LinkageSpec);
+    DIInliningInfo Short = DICtx.getInliningInfoForAddress(Address, ShortSpec);
+    assert(Linkage.getNumberOfFrames() == Short.getNumberOfFrames());
+    Chain.clear();
+    for (uint32_t I = 0, E = Linkage.getNumberOfFrames(); I != E; ++I) {
+      DILineInfo LinkageFrame = Linkage.getFrame(I);
+      IndexFrame F;
+      F.FileName = Strings.add(LinkageFrame.FileName);
+      F.ShortName = Strings.add(Short.getFrame(I).FunctionName);
+      F.LinkageName = Strings.add(LinkageFrame.FunctionName);
+      F.Line = LinkageFrame.Line;
+      F.Column = LinkageFrame.Column;
+      Chain.push_back(F);
+    }
+
+    // Extend the previous range if nothing changed.
+    if (Ranges.empty() ? Chain.empty()
+                       : Ranges.back().second.second == Chain.size() &&
+                             std::equal(Chain.begin(), Chain.end(),
+                                        Frames.begin() +
+                                            Ranges.back().second.first))
+      continue;
+    Ranges.push_back(std::make_pair(
+        Address,
+        std::make_pair(uint32_t(Frames.size()), uint32_t(Chain.size()))));
+    Frames.insert(Frames.end(), Chain.begin(), Chain.end());
+  }
+  // Keep the string table non-empty; readers rely on its null terminator.
+  Strings.add("");
+
+  Header H;
+  memcpy(H.Magic, SymbolIndexMagic, sizeof(H.Magic));
+  H.Version = SymbolIndexVersion;
+  H.NumRanges = Ranges.size();
+  H.NumFrames = Frames.size();
+  H.StringsSize = Strings.getData().size();
+  H.ObjectSize = Status.getSize();
+  H.ObjectModificationTime = getModificationTime(Status);
+  writeStruct(OS, H);
+  for (const auto &R : Ranges) {
+    Range Out;
+    Out.Start = R.first;
+    Out.FirstFrame = R.second.first;
+    Out.NumFrames = R.second.second;
+    writeStruct(OS, Out);
+  }
+  for (const IndexFrame &F : Frames) {
+    Frame Out;
+    Out.FileName = F.FileName;
+    Out.ShortName = F.ShortName;
+    Out.LinkageName = F.LinkageName;
+    Out.Line = F.Line;
+    Out.Column = F.Column;
+    writeStruct(OS, Out);
+  }
+  OS << Strings.getData();
+}
+
+} // namespace symbolize
+} // namespace llvm
@@ -20,6 +20,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/PDB/PDB.h"
 #include "llvm/DebugInfo/PDB/PDBContext.h"
+#include "llvm/DebugInfo/Symbolize/SymbolIndex.h"
 #include "llvm/Object/COFF.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/MachO.h"
@@ -32,6 +33,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
@@ -361,14 +363,11 @@ LLVMSymbolizer::getOrCreateObject(const std::string &Path,
   return errorCodeToError(object_error::arch_not_found);
 }
 
-Expected<SymbolizableModule *>
-LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
-  const auto &I = Modules.find(ModuleName);
-  if (I != Modules.end()) {
-    return I->second.get();
-  }
-  std::string BinaryName = ModuleName;
-  std::string ArchName = Opts.DefaultArch;
+void LLVMSymbolizer::splitModuleName(const std::string &ModuleName,
+                                     std::string &BinaryName,
+                                     std::string &ArchName) const {
+  BinaryName = ModuleName;
+  ArchName = Opts.DefaultArch;
   size_t ColonPos = ModuleName.find_last_of(':');
   // Verify that substring after colon form a valid arch name.
   if (ColonPos != std::string::npos) {
@@ -378,6 +377,34 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       ArchName = ArchStr;
     }
   }
+}
+
+/// Return the symbol index of the binary at \p Path, if it has an up to date
+/// one.
+static std::unique_ptr<DIContext> loadSymbolIndex(const std::string &Path) {
+  sys::fs::file_status Status;
+  if (sys::fs::status(Path, Status))
+    return nullptr;
+  // Map the index into memory rather than reading it, whatever its size.
+  auto BufOrErr =
+      MemoryBuffer::getFile(LLVMSymbolizer::getSymbolIndexPath(Path), -1,
+                            /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    return nullptr;
+  auto IndexOrErr = SymbolIndexContext::create(std::move(BufOrErr.get()));
+  if (!IndexOrErr || !IndexOrErr.get()->isUpToDate(Status))
+    return nullptr;
+  return std::move(IndexOrErr.get());
+}
+
+Expected<SymbolizableModule *>
+LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
+  const auto &I = Modules.find(ModuleName);
+  if (I != Modules.end()) {
+    return I->second.get();
+  }
+  std::string BinaryName, ArchName;
+  splitModuleName(ModuleName, BinaryName, ArchName);
   auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
   if (!ObjectsOrErr) {
     // Failed to find valid object file.
@@ -388,9 +415,15 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   ObjectPair Objects = ObjectsOrErr.get();
 
   std::unique_ptr<DIContext> Context;
+  // Prefer a prebuilt symbol index to the debug info. An index is written for
+  // a path, so it would be ambiguous for a universal binary.
+  if (Opts.UseSymbolIndex &&
+      !isa<MachOUniversalBinary>(BinaryForPath[BinaryName].getBinary()))
+    Context = loadSymbolIndex(BinaryName);
   // If this is a COFF object containing PDB info, use a PDBContext to
   // symbolize. Otherwise, use DWARF.
-  if (auto CoffObject = dyn_cast<COFFObjectFile>(Objects.first)) {
+  auto *CoffObject = dyn_cast<COFFObjectFile>(Objects.first);
+  if (!Context && CoffObject) {
     const codeview::DebugInfo *DebugInfo;
     StringRef PDBFileName;
     auto EC = CoffObject->getDebugPDBInfo(DebugInfo, PDBFileName);
@@ -406,8 +439,11 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       Context.reset(new PDBContext(*CoffObject, std::move(Session)));
     }
   }
-  if (!Context)
-    Context.reset(new DWARFContextInMemory(*Objects.second));
+  if (!Context) {
+    auto *DWARFCtx = new DWARFContextInMemory(*Objects.second);
+    DWARFCtx->setThreadCount(Opts.DWARFThreads);
+    Context.reset(DWARFCtx);
+  }
   assert(Context);
   auto InfoOrErr =
       SymbolizableObjectFile::create(Objects.first, std::move(Context));
@@ -422,6 +458,26 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   return InsertResult.first->second.get();
 }
 
+Error LLVMSymbolizer::buildSymbolIndex(const std::string &ModuleName) {
+  std::string BinaryName, ArchName;
+  splitModuleName(ModuleName, BinaryName, ArchName);
+  auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
+  if (!ObjectsOrErr)
+    return ObjectsOrErr.takeError();
+  sys::fs::file_status Status;
+  if (auto EC = sys::fs::status(BinaryName, Status))
+    return errorCodeToError(EC);
+
+  DWARFContextInMemory DICtx(*ObjectsOrErr->second);
+  DICtx.setThreadCount(Opts.DWARFThreads);
+  std::error_code EC;
+  raw_fd_ostream OS(getSymbolIndexPath(BinaryName), EC, sys::fs::F_None);
+  if (EC)
+    return errorCodeToError(EC);
+  writeSymbolIndex(DICtx, Status, OS);
+  return Error::success();
+}
+
 namespace {
 
 // Undo these various manglings for Win32 extern "C" functions:
@@ -69,6 +69,7 @@ void ExecutionEngine::Init(std::unique_ptr<Module> M) {
   CompilingLazily         = false;
   GVCompilationDisabled   = false;
   SymbolSearchingDisabled = false;
+  CompileThreads          = 0;
 
   // IR module verification is enabled by default in debug builds, and disabled
   // by default in release builds.
@@ -476,7 +477,8 @@ EngineBuilder::EngineBuilder() : EngineBuilder(nullptr) {}
 EngineBuilder::EngineBuilder(std::unique_ptr<Module> M)
     : M(std::move(M)), WhichEngine(EngineKind::Either), ErrorStr(nullptr),
       OptLevel(CodeGenOpt::Default), MemMgr(nullptr), Resolver(nullptr),
-      CMModel(CodeModel::JITDefault), UseOrcMCJITReplacement(false) {
+      CMModel(CodeModel::JITDefault), CompileThreads(0),
+      UseOrcMCJITReplacement(false) {
 // IR module verification is enabled by default in debug builds, and disabled
 // by default in release builds.
 #ifndef NDEBUG
@@ -551,6 +553,7 @@ ExecutionEngine *EngineBuilder::create(TargetMachine *TM) {
 
     if (EE) {
       EE->setVerifyModules(VerifyModules);
+      EE->setCompileThreads(CompileThreads);
       return EE;
     }
   }
@@ -0,0 +1,121 @@
+//===-- FileObjectCache.cpp - On-disk ObjectCache -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements FileObjectCache, an ObjectCache that keeps compiled
+// objects in a directory so they can be reused across runs and processes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/FileObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+namespace {
+/// A raw_ostream that feeds everything written to it into a SHA1, so that a
+/// module can be hashed without materializing its printed form.
+class SHA1Stream : public raw_ostream {
+  SHA1 &Hasher;
+  uint64_t Pos = 0;
+
+  void write_impl(const char *Ptr, size_t Size) override {
+    Hasher.update(
+        ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(Ptr), Size));
+    Pos += Size;
+  }
+  uint64_t current_pos() const override { return Pos; }
+
+public:
+  explicit SHA1Stream(SHA1 &Hasher) : Hasher(Hasher) {}
+  ~SHA1Stream() override { flush(); }
+};
+} // end anonymous namespace
+
+FileObjectCache::FileObjectCache(StringRef CacheDir, StringRef TargetID)
+    : CacheDir(CacheDir), TargetID(TargetID) {}
+
+std::string FileObjectCache::getEntryPath(const Module &M) const {
+  SHA1 Hasher;
+  Hasher.update(TargetID);
+  // Separate the target identifier from the IR.
+  Hasher.update(StringRef("\0", 1));
+  {
+    SHA1Stream OS(Hasher);
+    M.print(OS, nullptr);
+  }
+
+  SmallString<128> EntryPath(CacheDir);
+  sys::path::append(EntryPath, "llvmobj-" + toHex(Hasher.result()) + ".o");
+  return EntryPath.str();
+}
+
+std::unique_ptr<MemoryBuffer> FileObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getEntryPath(*M);
+  auto Buffer = MemoryBuffer::getFile(EntryPath, /*FileSize=*/-1,
+                                      /*RequiresNullTerminator=*/false);
+  if (Buffer)
+    return std::move(*Buffer);
+
+  PendingEntries[M] = std::move(EntryPath);
+  return nullptr;
+}
+
+void FileObjectCache::notifyObjectCompiled(const Module *M,
+                                           MemoryBufferRef Obj) {
+  std::string EntryPath;
+  auto I = PendingEntries.find(M);
+  if (I != PendingEntries.end()) {
+    EntryPath = std::move(I->second);
+    PendingEntries.erase(I);
+  } else {
+    EntryPath = getEntryPath(*M);
+  }
+
+  if (sys::fs::create_directories(CacheDir))
+    return;
+
+  // Write to a temporary file in the cache directory and rename it into place,
+  // so that concurrent readers never see a partially written entry.
+  SmallString<128> TempPath(CacheDir);
+  sys::path::append(TempPath, "llvmobj-%%%%%%.tmp");
+  int TempFD;
+  if (sys::fs::createUniqueFile(TempPath, TempFD, TempPath))
+    return;
+  {
+    raw_fd_ostream OS(TempFD, /*shouldClose=*/true);
+    OS << Obj.getBuffer();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, EntryPath)) {
+    sys::fs::remove(TempPath);
+    return;
+  }
+
+  // Keep the directory in check. Pruning walks the whole directory, so a
+  // cache only does it once.
+  if (Pruned || PruningInterval < 0)
+    return;
+  Pruned = true;
+  CachePruning(CacheDir)
+      .setPruningInterval(std::chrono::seconds(PruningInterval))
+      .setEntryExpiration(std::chrono::seconds(Expiration))
+      .setMaxSize(MaxPercentageOfAvailableSpace)
+      .prune();
+}
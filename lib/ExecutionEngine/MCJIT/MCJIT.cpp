@@ -26,6 +26,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include <atomic>
 
 using namespace llvm;
 
@@ -143,13 +146,10 @@ void MCJIT::setObjectCache(ObjectCache* NewCache) {
   ObjCache = NewCache;
 }
 
-std::unique_ptr<MemoryBuffer> MCJIT::emitObject(Module *M) {
-  MutexGuard locked(lock);
-
-  // This must be a module which has already been added but not loaded to this
-  // MCJIT instance, since these conditions are tested by our caller,
-  // generateCodeForModule.
-
+/// Generate an object in memory for \p M with \p TM.
+static std::unique_ptr<MemoryBuffer> compileModule(TargetMachine &TM,
+                                                   MCContext *&Ctx, Module &M,
+                                                   bool VerifyModules) {
   legacy::PassManager PM;
 
   // The RuntimeDyld will take ownership of this shortly
@@ -158,15 +158,36 @@ std::unique_ptr<MemoryBuffer> MCJIT::emitObject(Module *M) {
 
   // Turn the machine code intermediate representation into bytes in memory
   // that may be executed.
-  if (TM->addPassesToEmitMC(PM, Ctx, ObjStream, !getVerifyModules()))
+  if (TM.addPassesToEmitMC(PM, Ctx, ObjStream, !VerifyModules))
     report_fatal_error("Target does not support MC emission!");
 
   // Initialize passes.
-  PM.run(*M);
+  PM.run(M);
   // Flush the output buffer to get the generated code into memory
 
-  std::unique_ptr<MemoryBuffer> CompiledObjBuffer(
-                                new ObjectMemoryBuffer(std::move(ObjBufferSV)));
+  return std::unique_ptr<MemoryBuffer>(
+      new ObjectMemoryBuffer(std::move(ObjBufferSV)));
+}
+
+/// Create a TargetMachine configured like \p TM, for use on another thread.
+static std::unique_ptr<TargetMachine> cloneTargetMachine(TargetMachine &TM) {
+  std::unique_ptr<TargetMachine> Clone(TM.getTarget().createTargetMachine(
+      TM.getTargetTriple().str(), TM.getTargetCPU(),
+      TM.getTargetFeatureString(), TM.Options, TM.getRelocationModel(),
+      TM.getCodeModel(), TM.getOptLevel()));
+  Clone->setO0WantsFastISel(TM.getO0WantsFastISel());
+  return Clone;
+}
+
+std::unique_ptr<MemoryBuffer> MCJIT::emitObject(Module *M) {
+  MutexGuard locked(lock);
+
+  // This must be a module which has already been added but not loaded to this
+  // MCJIT instance, since these conditions are tested by our caller,
+  // generateCodeForModule.
+
+  std::unique_ptr<MemoryBuffer> CompiledObjBuffer =
+      compileModule(*TM, Ctx, *M, getVerifyModules());
 
   // If we have an object cache, tell it about the new object.
   // Note that we're using the compiled image, not the loaded image (as below).
@@ -205,6 +226,79 @@ void MCJIT::generateCodeForModule(Module *M) {
     assert(ObjectToLoad && "Compilation did not produce an object.");
   }
 
+  loadModuleObject(M, std::move(ObjectToLoad));
+}
+
+std::vector<std::unique_ptr<MemoryBuffer>>
+MCJIT::emitObjects(ArrayRef<Module *> Ms) {
+  MutexGuard locked(lock);
+
+  // Try to load the pre-compiled objects from cache if possible. The cache is
+  // only ever called from this thread.
+  std::vector<std::unique_ptr<MemoryBuffer>> Objects(Ms.size());
+  if (ObjCache)
+    for (unsigned I = 0, E = Ms.size(); I != E; ++I)
+      Objects[I] = ObjCache->getObject(Ms[I]);
+
+  // An LLVMContext cannot be used by several threads at once, so the modules
+  // of each context are compiled in sequence, by the same thread.
+  DenseMap<LLVMContext *, unsigned> GroupOfContext;
+  std::vector<std::vector<unsigned>> Groups;
+  for (unsigned I = 0, E = Ms.size(); I != E; ++I) {
+    if (Objects[I])
+      continue;
+    assert(Ms[I]->getDataLayout() == getDataLayout() && "DataLayout Mismatch");
+    auto Inserted =
+        GroupOfContext.insert(std::make_pair(&Ms[I]->getContext(),
+                                             Groups.size()));
+    if (Inserted.second)
+      Groups.emplace_back();
+    Groups[Inserted.first->second].push_back(I);
+  }
+
+  unsigned NumThreads = getCompileThreads() ? getCompileThreads()
+                                           : thread::hardware_concurrency();
+  NumThreads = std::min<unsigned>(NumThreads, Groups.size());
+  if (NumThreads < 2) {
+    for (unsigned I = 0, E = Ms.size(); I != E; ++I)
+      if (!Objects[I])
+        Objects[I] = emitObject(Ms[I]);
+    return Objects;
+  }
+
+  // Each thread takes groups of modules until there are none left, and
+  // compiles them with its own TargetMachine, as codegen mutates it.
+  std::vector<std::unique_ptr<TargetMachine>> TMs;
+  for (unsigned T = 0; T != NumThreads; ++T)
+    TMs.push_back(cloneTargetMachine(*TM));
+  bool VerifyModules = getVerifyModules();
+  std::atomic<unsigned> NextGroup(0);
+  ThreadPool Pool(NumThreads);
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    TargetMachine *ThreadTM = TMs[T].get();
+    Pool.async([&, ThreadTM] {
+      MCContext *ThreadCtx = nullptr;
+      for (unsigned G = NextGroup++; G < Groups.size(); G = NextGroup++)
+        for (unsigned I : Groups[G])
+          Objects[I] = compileModule(*ThreadTM, ThreadCtx, *Ms[I],
+                                     VerifyModules);
+    });
+  }
+  Pool.wait();
+
+  // Tell the object cache about the new objects.
+  if (ObjCache)
+    for (auto &Group : Groups)
+      for (unsigned I : Group)
+        ObjCache->notifyObjectCompiled(Ms[I], Objects[I]->getMemBufferRef());
+
+  return Objects;
+}
+
+void MCJIT::loadModuleObject(Module *M,
+                             std::unique_ptr<MemoryBuffer> ObjectToLoad) {
+  MutexGuard locked(lock);
+
   // Load the object into the dynamic linker.
   // MCJIT now owns the ObjectImage pointer (via its LoadedObjects list).
   Expected<std::unique_ptr<object::ObjectFile>> LoadedObject =
@@ -255,8 +349,11 @@ void MCJIT::finalizeObject() {
   for (auto M : OwnedModules.added())
     ModsToAdd.push_back(M);
 
-  for (auto M : ModsToAdd)
-    generateCodeForModule(M);
+  // Compile all the modules first, concurrently where possible, then load
+  // the objects in order.
+  std::vector<std::unique_ptr<MemoryBuffer>> Objects = emitObjects(ModsToAdd);
+  for (unsigned I = 0, E = ModsToAdd.size(); I != E; ++I)
+    loadModuleObject(ModsToAdd[I], std::move(Objects[I]));
 
   finalizeLoadedModules();
 }
@@ -331,6 +331,17 @@ protected:
   /// the future.
   std::unique_ptr<MemoryBuffer> emitObject(Module *M);
 
+  /// emitObjects -- Get objects for the modules in \p Ms, which must have
+  /// been added but not loaded, from the object cache or by compiling them.
+  /// Modules in different LLVMContexts are compiled concurrently, each thread
+  /// using its own copy of the TargetMachine. The object for Ms[I] is
+  /// returned in element I.
+  std::vector<std::unique_ptr<MemoryBuffer>> emitObjects(ArrayRef<Module *> Ms);
+
+  /// loadModuleObject -- Load the object generated for \p M into the dynamic
+  /// linker and mark \p M as loaded.
+  void loadModuleObject(Module *M, std::unique_ptr<MemoryBuffer> ObjectToLoad);
+
   void NotifyObjectEmitted(const object::ObjectFile& Obj,
                            const RuntimeDyld::LoadedObjectInfo &L);
   void NotifyFreeingObject(const object::ObjectFile& Obj);
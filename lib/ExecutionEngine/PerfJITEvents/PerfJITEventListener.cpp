@@ -0,0 +1,401 @@
+//===-- PerfJITEventListener.cpp - Tell Linux's perf about JITted code ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a JITEventListener object that tells perf about JITted
+// functions, both through a /tmp/perf-<pid>.map symbol map, which "perf report"
+// reads directly, and through the jitdump format, which "perf inject --jit"
+// turns into one ELF image per function, including source line information.
+//
+// The jitdump file is only picked up by perf if it was recorded with a
+// monotonic clock, i.e. with "perf record -k 1".
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Config/config.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ExecutionEngine/RuntimeDyld.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/Errno.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace llvm;
+using namespace llvm::object;
+
+#define DEBUG_TYPE "perf-jit-event-listener"
+
+namespace {
+
+// The jitdump format, as described in tools/perf/Documentation/jitdump-
+// specification.txt of the Linux sources. All fields are in host byte order.
+enum : uint32_t {
+  JitDumpMagic = 0x4A695444, // "JiTD"
+  JitDumpVersion = 1
+};
+
+enum JitDumpRecordType : uint32_t {
+  JIT_CODE_LOAD = 0,
+  JIT_CODE_MOVE = 1,
+  JIT_CODE_DEBUG_INFO = 2,
+  JIT_CODE_CLOSE = 3
+};
+
+struct JitDumpHeader {
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t TotalSize;
+  uint32_t ElfMach;
+  uint32_t Pad1;
+  uint32_t Pid;
+  uint64_t Timestamp;
+  uint64_t Flags;
+};
+
+struct JitDumpRecordHeader {
+  uint32_t Id;
+  uint32_t TotalSize;
+  uint64_t Timestamp;
+};
+
+// Followed by the null-terminated function name and the code.
+struct JitDumpCodeLoad {
+  JitDumpRecordHeader Prefix;
+  uint32_t Pid;
+  uint32_t Tid;
+  uint64_t Vma;
+  uint64_t CodeAddr;
+  uint64_t CodeSize;
+  uint64_t CodeIndex;
+};
+
+// Followed by NrEntry entries.
+struct JitDumpDebugInfo {
+  JitDumpRecordHeader Prefix;
+  uint64_t CodeAddr;
+  uint64_t NrEntry;
+};
+
+// Followed by the null-terminated file name.
+struct JitDumpDebugEntry {
+  uint64_t Addr;
+  uint32_t Lineno;
+  uint32_t Discrim;
+};
+
+class PerfJITEventListener : public JITEventListener {
+public:
+  PerfJITEventListener();
+  ~PerfJITEventListener() override;
+
+  void NotifyObjectEmitted(const ObjectFile &Obj,
+                           const RuntimeDyld::LoadedObjectInfo &L) override;
+  void NotifyFreeingObject(const ObjectFile &Obj) override;
+
+private:
+  bool openPerfMap();
+  bool openJitDump();
+  void closeJitDump();
+
+  void writeRecordHeader(JitDumpRecordHeader &Prefix, JitDumpRecordType Id,
+                         uint64_t Size);
+  void writeDebugInfo(uint64_t CodeAddr, const DILineInfoTable &Lines);
+  void writeCodeLoad(StringRef Name, uint64_t CodeAddr, uint64_t CodeSize);
+
+  // Both files are written through buffered streams, flushed once per
+  // emitted object.
+  std::unique_ptr<raw_fd_ostream> PerfMap;
+  std::unique_ptr<raw_fd_ostream> JitDump;
+
+  // perf notices the jitdump file through this executable mapping of it.
+  void *Marker = nullptr;
+  size_t MarkerSize = 0;
+
+  uint32_t Pid;
+  uint64_t CodeIndex = 0;
+
+  // Objects may be emitted from several threads at once.
+  sys::Mutex Lock;
+};
+
+static uint64_t getTimestamp() {
+  struct timespec TS;
+  if (clock_gettime(CLOCK_MONOTONIC, &TS))
+    return 0;
+  return uint64_t(TS.tv_sec) * 1000000000 + TS.tv_nsec;
+}
+
+static uint32_t getThreadId() { return ::syscall(SYS_gettid); }
+
+/// Return the ELF machine of the running executable, which is also the one of
+/// the code it JITs.
+static uint32_t getElfMachine() {
+  int FD;
+  if (sys::fs::openFileForRead("/proc/self/exe", FD))
+    return ELF::EM_NONE;
+  unsigned char Ident[20];
+  ssize_t Read = ::read(FD, Ident, sizeof(Ident));
+  ::close(FD);
+  if (Read != sizeof(Ident) || memcmp(Ident, ELF::ElfMagic, 4) != 0)
+    return ELF::EM_NONE;
+  uint16_t Machine;
+  memcpy(&Machine, Ident + 18, sizeof(Machine));
+  return Machine;
+}
+
+PerfJITEventListener::PerfJITEventListener() : Pid(::getpid()) {
+  if (!openPerfMap())
+    PerfMap.reset();
+  if (!openJitDump())
+    closeJitDump();
+}
+
+PerfJITEventListener::~PerfJITEventListener() {
+  MutexGuard Guard(Lock);
+  if (PerfMap) {
+    PerfMap->flush();
+    PerfMap->clear_error();
+  }
+  if (JitDump) {
+    JitDumpRecordHeader Close;
+    writeRecordHeader(Close, JIT_CODE_CLOSE, sizeof(Close));
+    JitDump->write(reinterpret_cast<const char *>(&Close), sizeof(Close));
+  }
+  closeJitDump();
+}
+
+bool PerfJITEventListener::openPerfMap() {
+  SmallString<64> Path;
+  ("/tmp/perf-" + Twine(Pid) + ".map").toVector(Path);
+  std::error_code EC;
+  PerfMap = llvm::make_unique<raw_fd_ostream>(Path, EC, sys::fs::F_Text);
+  if (EC) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << EC.message() << "\n");
+    return false;
+  }
+  return true;
+}
+
+bool PerfJITEventListener::openJitDump() {
+  // perf expects the file to be named jit-<pid>.dump, but it may live
+  // anywhere; use the same default directory as other JITs.
+  SmallString<128> Dir;
+  if (const char *JitDumpDir = getenv("JITDUMPDIR")) {
+    Dir = JitDumpDir;
+  } else if (const char *Home = getenv("HOME")) {
+    Dir = Home;
+    sys::path::append(Dir, ".debug", "jit");
+  } else {
+    Dir = "/tmp";
+  }
+  if (std::error_code EC = sys::fs::create_directories(Dir)) {
+    DEBUG(dbgs() << "Failed to create " << Dir << ": " << EC.message()
+                 << "\n");
+    return false;
+  }
+
+  SmallString<128> Path(Dir);
+  sys::path::append(Path, "jit-" + Twine(Pid) + ".dump");
+  int FD;
+  if (std::error_code EC =
+          sys::fs::openFileForWrite(Path, FD, sys::fs::F_RW)) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << EC.message() << "\n");
+    return false;
+  }
+  JitDump = llvm::make_unique<raw_fd_ostream>(FD, /*shouldClose=*/true);
+
+  MarkerSize = sys::Process::getPageSize();
+  Marker = ::mmap(nullptr, MarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, FD,
+                  0);
+  if (Marker == MAP_FAILED) {
+    Marker = nullptr;
+    DEBUG(dbgs() << "Failed to map " << Path << ": " << sys::StrError()
+                 << "\n");
+    return false;
+  }
+
+  JitDumpHeader Header;
+  memset(&Header, 0, sizeof(Header));
+  Header.Magic = JitDumpMagic;
+  Header.Version = JitDumpVersion;
+  Header.TotalSize = sizeof(Header);
+  Header.ElfMach = getElfMachine();
+  Header.Pid = Pid;
+  Header.Timestamp = getTimestamp();
+  JitDump->write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  JitDump->flush();
+  return !JitDump->has_error();
+}
+
+void PerfJITEventListener::closeJitDump() {
+  if (JitDump) {
+    JitDump->close();
+    JitDump->clear_error();
+    JitDump.reset();
+  }
+  if (Marker) {
+    ::munmap(Marker, MarkerSize);
+    Marker = nullptr;
+  }
+}
+
+void PerfJITEventListener::writeRecordHeader(JitDumpRecordHeader &Prefix,
+                                             JitDumpRecordType Id,
+                                             uint64_t Size) {
+  Prefix.Id = Id;
+  Prefix.TotalSize = Size;
+  Prefix.Timestamp = getTimestamp();
+}
+
+void PerfJITEventListener::writeDebugInfo(uint64_t CodeAddr,
+                                          const DILineInfoTable &Lines) {
+  JitDumpDebugInfo Info;
+  Info.CodeAddr = CodeAddr;
+  Info.NrEntry = Lines.size();
+
+  uint64_t Size = sizeof(Info);
+  for (const auto &Line : Lines)
+    Size += sizeof(JitDumpDebugEntry) + Line.second.FileName.size() + 1;
+  writeRecordHeader(Info.Prefix, JIT_CODE_DEBUG_INFO, Size);
+  JitDump->write(reinterpret_cast<const char *>(&Info), sizeof(Info));
+
+  for (const auto &Line : Lines) {
+    JitDumpDebugEntry Entry;
+    // perf places the code of each function right after the ELF header of the
+    // image it creates for it, and does not account for that in the addresses
+    // of the line table.
+    Entry.Addr = Line.first + 0x40;
+    Entry.Lineno = Line.second.Line;
+    Entry.Discrim = 0;
+    JitDump->write(reinterpret_cast<const char *>(&Entry), sizeof(Entry));
+    JitDump->write(Line.second.FileName.c_str(),
+                   Line.second.FileName.size() + 1);
+  }
+}
+
+void PerfJITEventListener::writeCodeLoad(StringRef Name, uint64_t CodeAddr,
+                                         uint64_t CodeSize) {
+  JitDumpCodeLoad Load;
+  Load.Pid = Pid;
+  Load.Tid = getThreadId();
+  Load.Vma = CodeAddr;
+  Load.CodeAddr = CodeAddr;
+  Load.CodeSize = CodeSize;
+  Load.CodeIndex = CodeIndex++;
+  writeRecordHeader(Load.Prefix, JIT_CODE_LOAD,
+                    sizeof(Load) + Name.size() + 1 + CodeSize);
+  JitDump->write(reinterpret_cast<const char *>(&Load), sizeof(Load));
+  JitDump->write(Name.data(), Name.size());
+  JitDump->write('\0');
+  // The code is copied from where it was loaded, which is only this process
+  // for in-process JITs.
+  JitDump->write(reinterpret_cast<const char *>(CodeAddr), CodeSize);
+}
+
+void PerfJITEventListener::NotifyObjectEmitted(
+    const ObjectFile &Obj, const RuntimeDyld::LoadedObjectInfo &L) {
+  if (!PerfMap && !JitDump)
+    return;
+
+  OwningBinary<ObjectFile> DebugObjOwner = L.getObjectForDebug(Obj);
+  const ObjectFile &DebugObj = *DebugObjOwner.getBinary();
+  DWARFContextInMemory Context(DebugObj);
+  DILineInfoSpecifier Specifier(
+      DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath,
+      DILineInfoSpecifier::FunctionNameKind::None);
+
+  MutexGuard Guard(Lock);
+
+  // Use symbol info to iterate functions in the object.
+  for (const std::pair<SymbolRef, uint64_t> &P : computeSymbolSizes(DebugObj)) {
+    SymbolRef Sym = P.first;
+    Expected<SymbolRef::Type> SymTypeOrErr = Sym.getType();
+    if (!SymTypeOrErr) {
+      consumeError(SymTypeOrErr.takeError());
+      continue;
+    }
+    if (*SymTypeOrErr != SymbolRef::ST_Function)
+      continue;
+
+    Expected<StringRef> Name = Sym.getName();
+    if (!Name) {
+      consumeError(Name.takeError());
+      continue;
+    }
+
+    Expected<uint64_t> AddrOrErr = Sym.getAddress();
+    if (!AddrOrErr) {
+      consumeError(AddrOrErr.takeError());
+      continue;
+    }
+    uint64_t Addr = *AddrOrErr;
+    uint64_t Size = P.second;
+    if (!Size)
+      continue;
+
+    if (PerfMap) {
+      PerfMap->write_hex(Addr) << ' ';
+      PerfMap->write_hex(Size) << ' ' << *Name << '\n';
+    }
+
+    if (JitDump) {
+      // perf expects the line table of a function before its code.
+      DILineInfoTable Lines =
+          Context.getLineInfoForAddressRange(Addr, Size, Specifier);
+      if (!Lines.empty())
+        writeDebugInfo(Addr, Lines);
+      writeCodeLoad(*Name, Addr, Size);
+    }
+  }
+
+  if (PerfMap) {
+    PerfMap->flush();
+    if (PerfMap->has_error()) {
+      DEBUG(dbgs() << "Failed to write perf map entry\n");
+      PerfMap->clear_error();
+      PerfMap.reset();
+    }
+  }
+  if (JitDump) {
+    JitDump->flush();
+    if (JitDump->has_error()) {
+      DEBUG(dbgs() << "Failed to write jitdump record\n");
+      closeJitDump();
+    }
+  }
+}
+
+void PerfJITEventListener::NotifyFreeingObject(const ObjectFile &Obj) {
+  // Neither format can describe unloaded code; perf attributes samples by
+  // time, so later code at the same addresses is still resolved correctly
+  // in the jitdump file.
+}
+
+} // anonymous namespace.
+
+namespace llvm {
+JITEventListener *JITEventListener::createPerfJITEventListener() {
+  return new PerfJITEventListener();
+}
+
+} // namespace llvm
@@ -918,17 +918,26 @@ void RuntimeDyldImpl::resolveRelocationList(const RelocationList &Relocs,
 }
 
 void RuntimeDyldImpl::resolveExternalSymbols() {
+  // Take the pending relocations a batch at a time rather than erasing from
+  // the front of the map: StringMap::begin() scans for the first live bucket,
+  // so doing that once per symbol is quadratic in the number of externals.
+  // Looking up a symbol may load further modules, which add new entries to
+  // ExternalSymbolRelocations; those are handled by the next batch.
   while (!ExternalSymbolRelocations.empty()) {
-    StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin();
-
-    StringRef Name = i->first();
-    if (Name.size() == 0) {
-      // This is an absolute symbol, use an address of zero.
-      DEBUG(dbgs() << "Resolving absolute relocations."
-                   << "\n");
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, 0);
-    } else {
+    StringMap<RelocationList> Batch = std::move(ExternalSymbolRelocations);
+    ExternalSymbolRelocations.clear();
+
+    for (auto &Entry : Batch) {
+      StringRef Name = Entry.first();
+      RelocationList &Relocs = Entry.second;
+      if (Name.size() == 0) {
+        // This is an absolute symbol, use an address of zero.
+        DEBUG(dbgs() << "Resolving absolute relocations."
+                     << "\n");
+        resolveRelocationList(Relocs, 0);
+        continue;
+      }
+
       uint64_t Addr = 0;
       RTDyldSymbolTable::const_iterator Loc = GlobalSymbolTable.find(Name);
       if (Loc == GlobalSymbolTable.end()) {
@@ -940,12 +949,13 @@ void RuntimeDyldImpl::resolveExternalSymbols() {
         if (!Addr)
           Addr = Resolver.findSymbol(Name.data()).getAddress();
         // The call to getSymbolAddress may have caused additional modules to
-        // be loaded, which may have added new entries to the
-        // ExternalSymbolRelocations map.  Consquently, we need to update our
-        // iterator.  This is also why retrieval of the relocation list
-        // associated with this symbol is deferred until below this point.
-        // New entries may have been added to the relocation list.
-        i = ExternalSymbolRelocations.find(Name);
+        // be loaded, which may have added new relocations against this
+        // symbol. Fold those into this batch so they are resolved together.
+        auto NewRelocs = ExternalSymbolRelocations.find(Name);
+        if (NewRelocs != ExternalSymbolRelocations.end()) {
+          Relocs.append(NewRelocs->second.begin(), NewRelocs->second.end());
+          ExternalSymbolRelocations.erase(NewRelocs);
+        }
       } else {
         // We found the symbol in our global table.  It was probably in a
         // Module that we loaded previously.
@@ -964,14 +974,9 @@ void RuntimeDyldImpl::resolveExternalSymbols() {
       if (Addr != UINT64_MAX) {
         DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
                      << format("0x%lx", Addr) << "\n");
-        // This list may have been updated when we called getSymbolAddress, so
-        // don't change this code to get the list earlier.
-        RelocationList &Relocs = i->second;
         resolveRelocationList(Relocs, Addr);
       }
     }
-
-    ExternalSymbolRelocations.erase(i);
   }
 }
 
@@ -16,6 +16,7 @@
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Process.h"
+#include <algorithm>
 
 namespace llvm {
 
@@ -78,13 +79,14 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   // Note that all sections get allocated as read-write.  The permissions will
   // be updated later based on memory group.
   //
-  // FIXME: It would be useful to define a default allocation size (or add
-  // it as a constructor parameter) to minimize the number of allocations.
+  // Request at least SlabSize bytes, so that the rest of the block can serve
+  // later allocations.
   //
   // FIXME: Initialize the Near member for each memory group to avoid
   // interleaving.
   std::error_code ec;
-  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
+  uintptr_t AllocSize = std::max(RequiredSize, SlabSize);
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(AllocSize,
                                                           &MemGroup.Near,
                                                           sys::Memory::MF_READ |
                                                             sys::Memory::MF_WRITE,
@@ -110,7 +112,7 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
 
   // The allocateMappedMemory may allocate much more memory than we need. In
   // this case, we store the unused memory as a free memory block.
-  unsigned FreeSize = EndOfBlock-Addr-Size;
+  uintptr_t FreeSize = EndOfBlock-Addr-Size;
   if (FreeSize > 16) {
     FreeMemBlock FreeMB;
     FreeMB.Free = sys::MemoryBlock((void*)(Addr + Size), FreeSize);
@@ -177,9 +179,44 @@ static sys::MemoryBlock trimBlockToPageSize(sys::MemoryBlock M) {
 }
 
 
+/// Sort \p Blocks by address and merge the ones whose page ranges touch, so
+/// that the permissions of each merged range can be changed with one call.
+static void coalesceByPage(SmallVectorImpl<sys::MemoryBlock> &Blocks) {
+  static const uintptr_t PageSize = sys::Process::getPageSize();
+  if (Blocks.empty())
+    return;
+
+  std::sort(Blocks.begin(), Blocks.end(),
+            [](const sys::MemoryBlock &LHS, const sys::MemoryBlock &RHS) {
+              return LHS.base() < RHS.base();
+            });
+
+  unsigned Last = 0;
+  for (unsigned I = 1, E = Blocks.size(); I != E; ++I) {
+    uintptr_t LastStart = (uintptr_t)Blocks[Last].base();
+    uintptr_t LastEnd = alignTo(LastStart + Blocks[Last].size(), PageSize);
+    uintptr_t Start = (uintptr_t)Blocks[I].base();
+    uintptr_t End = Start + Blocks[I].size();
+    if ((Start & ~(PageSize - 1)) <= LastEnd) {
+      Blocks[Last] = sys::MemoryBlock(
+          (void *)LastStart, std::max(LastStart + Blocks[Last].size(), End) -
+                                 LastStart);
+      continue;
+    }
+    Blocks[++Last] = Blocks[I];
+  }
+  Blocks.resize(Last + 1);
+}
+
 std::error_code
 SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                                   unsigned Permissions) {
+  // Sections of one object are often adjacent, so protect them in as few
+  // calls as possible. This reorders PendingMem, so the prefix indices of the
+  // free blocks no longer apply.
+  coalesceByPage(MemGroup.PendingMem);
+  for (FreeMemBlock &FreeMB : MemGroup.FreeMem)
+    FreeMB.PendingPrefixIndex = (unsigned)-1;
   for (sys::MemoryBlock &MB : MemGroup.PendingMem)
     if (std::error_code EC = sys::Memory::protectMappedMemory(MB, Permissions))
       return EC;
@@ -190,8 +227,6 @@ SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
   // page because one of the pending blocks may have overlapped it.
   for (FreeMemBlock &FreeMB : MemGroup.FreeMem) {
     FreeMB.Free = trimBlockToPageSize(FreeMB.Free);
-    // We cleared the PendingMem list, so all these pointers are now invalid
-    FreeMB.PendingPrefixIndex = (unsigned)-1;
   }
 
   // Remove all blocks which are now empty
@@ -240,6 +240,15 @@ static int RunInMultipleProcesses(const std::vector<std::string> &Args,
   std::atomic<int> Counter(0);
   std::atomic<bool> HasErrors(false);
   std::string Cmd = CloneArgsWithoutX(Args, "jobs", "workers");
+  // Let the workers pass new units to each other through shared memory.
+  std::string SharedCorpusPath;
+  if (!Flags.shared_corpus && Flags.reload && NumWorkers > 1) {
+    const char *TmpDir = getenv("TMPDIR");
+    SharedCorpusPath = DirPlusFile(TmpDir ? TmpDir : "/tmp",
+                                   "libFuzzerSharedCorpus." +
+                                       std::to_string(GetPid()));
+    Cmd += "-shared_corpus=" + SharedCorpusPath + " ";
+  }
   std::vector<std::thread> V;
   std::thread Pulse(PulseThread);
   Pulse.detach();
@@ -247,6 +256,8 @@ static int RunInMultipleProcesses(const std::vector<std::string> &Args,
     V.push_back(std::thread(WorkerThread, Cmd, &Counter, NumJobs, &HasErrors));
   for (auto &T : V)
     T.join();
+  if (!SharedCorpusPath.empty())
+    DeleteFile(SharedCorpusPath);
   return HasErrors ? 1 : 0;
 }
 
@@ -404,9 +415,12 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
   Options.ShuffleAtStartUp = Flags.shuffle;
   Options.PreferSmall = Flags.prefer_small;
   Options.ReloadIntervalSec = Flags.reload;
+  if (Flags.shared_corpus)
+    Options.SharedCorpus = Flags.shared_corpus;
   Options.OnlyASCII = Flags.only_ascii;
   Options.OutputCSV = Flags.output_csv;
   Options.DetectLeaks = Flags.detect_leaks;
+  Options.ForkInputs = Flags.fork_inputs;
   Options.TraceMalloc = Flags.trace_malloc;
   Options.RssLimitMb = Flags.rss_limit_mb;
   if (Flags.runs >= 0)
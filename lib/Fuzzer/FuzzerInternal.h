@@ -23,6 +23,8 @@
 #include "FuzzerExtFunctions.h"
 #include "FuzzerInterface.h"
 #include "FuzzerOptions.h"
+#include "FuzzerSharedCorpus.h"
+#include "FuzzerTracePC.h"
 #include "FuzzerValueBitMap.h"
 
 namespace fuzzer {
@@ -85,11 +87,17 @@ public:
 
   void ExecuteCallback(const uint8_t *Data, size_t Size);
   size_t RunOne(const uint8_t *Data, size_t Size);
+  int ExecuteCallbackInChild(const uint8_t *Data, size_t Size);
+  void CheckForkedChildLimits();
 
   // Merge Corpora[1:] into Corpora[0].
   void Merge(const std::vector<std::string> &Corpora);
   // Returns a subset of 'Extra' that adds coverage to 'Initial'.
   UnitVector FindExtraUnits(const UnitVector &Initial, const UnitVector &Extra);
+  // Same, but picks the units by set cover over the features of each unit.
+  // Requires trace-pc-guard.
+  UnitVector FindExtraUnitsBySetCover(const UnitVector &Initial,
+                                      const UnitVector &Extra);
   MutationDispatcher &GetMD() { return MD; }
   void PrintFinalStats();
   void SetMaxInputLen(size_t MaxInputLen);
@@ -160,6 +168,7 @@ private:
   system_clock::time_point UnitStartTime, UnitStopTime;
   long TimeOfLongestUnitInSeconds = 0;
   long EpochOfLastReadOfOutputCorpus = 0;
+  SharedCorpus SharedUnits;
 
   // Maximum recorded coverage.
   Coverage MaxCoverage;
@@ -171,6 +180,12 @@ private:
   static thread_local bool IsMyThread;
 
   bool InMergeMode = false;
+
+  // With -fork_inputs, the process running the current input, and the shared
+  // memory it copies its coverage to.
+  int ForkedChildPid = 0;
+  TracePC::Snapshot *ForkedTrace = nullptr;
+  size_t *ForkedLeakChecks = nullptr;
 };
 
 }; // namespace fuzzer
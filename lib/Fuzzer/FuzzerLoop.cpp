@@ -11,13 +11,20 @@
 
 #include "FuzzerInternal.h"
 #include "FuzzerCorpus.h"
+#include "FuzzerMerge.h"
 #include "FuzzerMutate.h"
 #include "FuzzerTracePC.h"
 #include "FuzzerRandom.h"
 
 #include <algorithm>
 #include <cstring>
+#include <errno.h>
 #include <memory>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
 
 #if defined(__has_include)
 #if __has_include(<sanitizer / coverage_interface.h>)
@@ -169,11 +176,20 @@ Fuzzer::Fuzzer(UserCallback CB, InputCorpus &Corpus, MutationDispatcher &MD,
     EF->__sanitizer_install_malloc_and_free_hooks(MallocHook, FreeHook);
   TPC.SetUseCounters(Options.UseCounters);
   TPC.SetUseValueProfile(Options.UseValueProfile);
+  if (Options.ForkInputs && !TPC.UsingTracePcGuard()) {
+    Printf("WARNING: -fork_inputs requires -fsanitize-coverage=trace-pc-guard;"
+           " running inputs in-process\n");
+    this->Options.ForkInputs = false;
+  }
 
   if (Options.Verbosity)
     TPC.PrintModuleInfo();
   if (!Options.OutputCorpus.empty() && Options.ReloadIntervalSec)
     EpochOfLastReadOfOutputCorpus = GetEpoch(Options.OutputCorpus);
+  if (!Options.SharedCorpus.empty() &&
+      !SharedUnits.Open(Options.SharedCorpus))
+    Printf("WARNING: failed to open the shared corpus %s\n",
+           Options.SharedCorpus.c_str());
   MaxInputLen = MaxMutationLen = Options.MaxLen;
   AllocateCurrentUnitData();
 }
@@ -287,6 +303,8 @@ void Fuzzer::AlarmCallback() {
       EF->__sanitizer_print_stack_trace();
     Printf("SUMMARY: libFuzzer: timeout\n");
     PrintFinalStats();
+    if (ForkedChildPid)
+      kill(ForkedChildPid, SIGKILL);
     _Exit(Options.TimeoutExitCode); // Stop right now.
   }
 }
@@ -403,11 +421,19 @@ void Fuzzer::CheckExitOnSrcPosOrItem() {
 }
 
 void Fuzzer::RereadOutputCorpus(size_t MaxSize) {
-  if (Options.OutputCorpus.empty() || !Options.ReloadIntervalSec) return;
+  if ((Options.OutputCorpus.empty() && !SharedUnits.IsOpen()) ||
+      !Options.ReloadIntervalSec)
+    return;
   std::vector<Unit> AdditionalCorpus;
-  ReadDirToVectorOfUnits(Options.OutputCorpus.c_str(), &AdditionalCorpus,
-                         &EpochOfLastReadOfOutputCorpus, MaxSize,
-                         /*ExitOnError*/ false);
+  // The shared log has the units other workers found since the last reload.
+  // The directory is still rescanned for units added in any other way, or
+  // lost to a full log or a writer that died; HasUnit skips the duplicates.
+  if (SharedUnits.IsOpen())
+    SharedUnits.ReadNew(&AdditionalCorpus, MaxSize);
+  if (!Options.OutputCorpus.empty())
+    ReadDirToVectorOfUnits(Options.OutputCorpus.c_str(), &AdditionalCorpus,
+                           &EpochOfLastReadOfOutputCorpus, MaxSize,
+                           /*ExitOnError*/ false);
   if (Options.Verbosity >= 2)
     Printf("Reload: read %zd new units.\n", AdditionalCorpus.size());
   bool Reloaded = false;
@@ -518,7 +544,8 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
     TPC.ResetTORC();
   if (Options.UseCounters)
     TPC.ResetGuards();
-  int Res = CB(DataCopy, Size);
+  int Res = Options.ForkInputs ? ExecuteCallbackInChild(DataCopy, Size)
+                               : CB(DataCopy, Size);
   UnitStopTime = system_clock::now();
   (void)Res;
   assert(Res == 0);
@@ -527,6 +554,96 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
   delete[] DataCopy;
 }
 
+// Runs the callback in a copy of this process, so that whatever the target
+// changes in its own state is thrown away with the copy. The child hands the
+// trace of the input back through shared memory. If it dies instead, it has
+// already reported the problem and saved the input, so just exit the same way.
+int Fuzzer::ExecuteCallbackInChild(const uint8_t *Data, size_t Size) {
+  if (!ForkedTrace) {
+    // The trace is followed by the number of leak checks the children made.
+    void *Map = mmap(nullptr, TracePC::SnapshotSize() + sizeof(size_t),
+                     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (Map == MAP_FAILED) {
+      Printf("ERROR: -fork_inputs: mmap failed with %d\n", errno);
+      exit(1);
+    }
+    ForkedTrace = static_cast<TracePC::Snapshot *>(Map);
+    ForkedLeakChecks = reinterpret_cast<size_t *>(
+        static_cast<char *>(Map) + TracePC::SnapshotSize());
+  }
+
+  int Pid = fork();
+  if (Pid < 0) {
+    Printf("ERROR: -fork_inputs: fork failed with %d\n", errno);
+    exit(1);
+  }
+  if (Pid == 0) {
+    // The RSS limit thread is not forked with us, so watch this copy too.
+    // Starting the thread allocates, so don't count that against the input.
+    if (Options.RssLimitMb > 0) {
+      std::thread([this] {
+        while (true) {
+          SleepSeconds(1);
+          if (GetPeakRSSMb() > static_cast<size_t>(Options.RssLimitMb))
+            RssLimitCallback();
+        }
+      }).detach();
+      AllocTracer.Start(Options.TraceMalloc);
+    }
+    int Res = CB(Data, Size);
+    CheckForkedChildLimits();
+    TPC.SaveSnapshot(ForkedTrace);
+    _Exit(Res);
+  }
+
+  ForkedChildPid = Pid;
+  int Status;
+  while (waitpid(Pid, &Status, 0) < 0 && errno == EINTR) {}
+  ForkedChildPid = 0;
+  if (WIFEXITED(Status) && WEXITSTATUS(Status) == 0) {
+    TPC.RestoreSnapshot(*ForkedTrace);
+    return 0;
+  }
+
+  if (WIFSIGNALED(Status)) {
+    // The child's own handlers did not get to run, so save the input here.
+    Printf("==%d== ERROR: libFuzzer: child %d killed by signal %d\n", GetPid(),
+           Pid, WTERMSIG(Status));
+    DumpCurrentUnit("crash-");
+  }
+  PrintFinalStats();
+  _Exit(WIFEXITED(Status) ? WEXITSTATUS(Status) : Options.ErrorExitCode);
+}
+
+// The allocations of an input run with -fork_inputs only happen in the child,
+// so the child checks the RSS limit and looks for leaks itself before handing
+// its trace back.
+void Fuzzer::CheckForkedChildLimits() {
+  if (Options.RssLimitMb > 0 &&
+      GetPeakRSSMb() > static_cast<size_t>(Options.RssLimitMb))
+    RssLimitCallback();
+
+  if (!AllocTracer.Stop()) return;  // mallocs==frees, a leak is unlikely.
+  if (!Options.DetectLeaks || !(EF->__lsan_do_recoverable_leak_check))
+    return;
+  // The count lives in shared memory so that it survives this child.
+  if ((*ForkedLeakChecks)++ > 1000) {
+    if (*ForkedLeakChecks == 1002)
+      Printf("INFO: libFuzzer disabled leak detection after every mutation.\n"
+             "      Most likely the target function accumulates allocated\n"
+             "      memory in a global state w/o actually leaking it.\n"
+             "      You may try running this binary with -trace_malloc=[12]"
+             "      to get a trace of mallocs and frees.\n");
+    return;
+  }
+  if (EF->__lsan_do_recoverable_leak_check()) { // Leak is found, report it.
+    Printf("INFO: to ignore leaks on libFuzzer side use -detect_leaks=0.\n\n");
+    DumpCurrentUnit("leak-");
+    PrintFinalStats();
+    _Exit(Options.ErrorExitCode);  // not exit() to disable lsan further on.
+  }
+}
+
 void Fuzzer::WriteToOutputCorpus(const Unit &U) {
   if (Options.OnlyASCII)
     assert(IsASCII(U));
@@ -580,6 +697,8 @@ void Fuzzer::ReportNewCoverage(InputInfo *II, const Unit &U) {
   MD.RecordSuccessfulMutationSequence();
   PrintStatusForNewUnit(U);
   WriteToOutputCorpus(U);
+  if (SharedUnits.IsOpen())
+    SharedUnits.Append(U);
   NumberOfNewUnitsAdded++;
   PrintNewPCs();
 }
@@ -629,6 +748,45 @@ UnitVector Fuzzer::FindExtraUnits(const UnitVector &Initial,
   return Res;
 }
 
+// Runs every unit once, records the features each one has, and picks the
+// units of 'Extra' by weighted set cover, with the size of a unit as its cost.
+// Unlike FindExtraUnits this does not depend on the order the units are run
+// in, so one pass is enough and the result is the same from run to run.
+UnitVector Fuzzer::FindExtraUnitsBySetCover(const UnitVector &Initial,
+                                            const UnitVector &Extra) {
+  auto CollectFeatures = [&](const Unit &U, std::vector<uint32_t> *Features) {
+    if (U.empty()) return;
+    TotalNumberOfRuns++;
+    TPC.ResetGuards();
+    ExecuteCallback(U.data(), U.size());
+    TPC.CollectFeatures(Features);
+  };
+
+  std::vector<bool> Covered;
+  std::vector<uint32_t> Features;
+  for (auto &U : Initial) {
+    CollectFeatures(U, &Features);
+    for (uint32_t F : Features) {
+      if (F >= Covered.size())
+        Covered.resize(F + 1);
+      Covered[F] = true;
+    }
+  }
+
+  std::vector<std::vector<uint32_t>> ExtraFeatures(Extra.size());
+  std::vector<size_t> Costs(Extra.size());
+  for (size_t i = 0; i < Extra.size(); i++) {
+    CollectFeatures(Extra[i], &ExtraFeatures[i]);
+    Costs[i] = Extra[i].size();
+  }
+  PrintStats("COVER ", "\n", Extra.size());
+
+  UnitVector Res;
+  for (size_t Idx : GreedySetCover(ExtraFeatures, Costs, &Covered))
+    Res.push_back(Extra[Idx]);
+  return Res;
+}
+
 void Fuzzer::Merge(const std::vector<std::string> &Corpora) {
   if (Corpora.size() <= 1) {
     Printf("Merge requires two or more corpus dirs\n");
@@ -643,6 +801,16 @@ void Fuzzer::Merge(const std::vector<std::string> &Corpora) {
   for (auto &C : ExtraCorpora)
     ReadDirToVectorOfUnits(C.c_str(), &Extra, nullptr, MaxInputLen, true);
 
+  if (TPC.UsingTracePcGuard()) {
+    Printf("=== Merging extra %zd units into %zd units by set cover\n",
+           Extra.size(), Initial.size());
+    auto Res = FindExtraUnitsBySetCover(Initial, Extra);
+    for (auto &U : Res)
+      WriteToOutputCorpus(U);
+    Printf("=== Merge: written %zd units\n", Res.size());
+    return;
+  }
+
   if (!Initial.empty()) {
     Printf("=== Minimizing the initial corpus of %zd units\n", Initial.size());
     Initial = FindExtraUnits({}, Initial);
@@ -0,0 +1,66 @@
+//===- FuzzerMerge.cpp - Corpus merging -----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+// Corpus merging by set cover.
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerMerge.h"
+
+#include <queue>
+
+namespace fuzzer {
+
+static size_t CountUncovered(const std::vector<uint32_t> &Features,
+                             const std::vector<bool> &Covered) {
+  size_t Res = 0;
+  for (uint32_t F : Features)
+    if (F >= Covered.size() || !Covered[F])
+      Res++;
+  return Res;
+}
+
+std::vector<size_t>
+GreedySetCover(const std::vector<std::vector<uint32_t>> &Features,
+               const std::vector<size_t> &Costs, std::vector<bool> *Covered) {
+  assert(Features.size() == Costs.size());
+  // The number of features an input adds only goes down as others are
+  // picked, so a score taken from the queue is an upper bound. Recompute it
+  // when an input reaches the top, and take the input only if it still beats
+  // the next best bound ("lazy greedy").
+  typedef std::pair<double, size_t> ScoreAndIdx;
+  std::priority_queue<ScoreAndIdx> Queue;
+  auto Score = [&](size_t Idx, size_t NumNew) {
+    return static_cast<double>(NumNew) / (Costs[Idx] + 1);
+  };
+  for (size_t i = 0; i < Features.size(); i++)
+    if (size_t NumNew = CountUncovered(Features[i], *Covered))
+      Queue.push({Score(i, NumNew), i});
+
+  std::vector<size_t> Res;
+  while (!Queue.empty()) {
+    size_t Idx = Queue.top().second;
+    Queue.pop();
+    size_t NumNew = CountUncovered(Features[Idx], *Covered);
+    if (!NumNew)
+      continue;
+    double S = Score(Idx, NumNew);
+    if (!Queue.empty() && S < Queue.top().first) {
+      Queue.push({S, Idx});
+      continue;
+    }
+    Res.push_back(Idx);
+    for (uint32_t F : Features[Idx]) {
+      if (F >= Covered->size())
+        Covered->resize(F + 1);
+      (*Covered)[F] = true;
+    }
+  }
+  return Res;
+}
+
+}  // namespace fuzzer
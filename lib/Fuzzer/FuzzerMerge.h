@@ -0,0 +1,32 @@
+//===- FuzzerMerge.h - Internal header for the Fuzzer -----------*- C++ -* ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+// Corpus merging by set cover.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_FUZZER_MERGE_H
+#define LLVM_FUZZER_MERGE_H
+
+#include "FuzzerDefs.h"
+
+namespace fuzzer {
+
+// Picks a subset of the inputs that together cover every feature the inputs
+// have and 'Covered' does not, using the greedy algorithm for weighted set
+// cover: the next input taken is always the one with the lowest cost per
+// newly covered feature. Features[i] holds the features of input i, and
+// Costs[i] its cost. Features are small integers; 'Covered' may be shorter
+// than the largest one and is updated to include the chosen inputs.
+// Returns the indices of the chosen inputs in the order they were picked.
+std::vector<size_t>
+GreedySetCover(const std::vector<std::vector<uint32_t>> &Features,
+               const std::vector<size_t> &Costs, std::vector<bool> *Covered);
+
+}  // namespace fuzzer
+
+#endif  // LLVM_FUZZER_MERGE_H
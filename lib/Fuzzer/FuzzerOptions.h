@@ -40,6 +40,7 @@ struct FuzzingOptions {
   int ReportSlowUnits = 10;
   bool OnlyASCII = false;
   std::string OutputCorpus;
+  std::string SharedCorpus;
   std::string ArtifactPrefix = "./";
   std::string ExactArtifactPath;
   std::string ExitOnSrcPos;
@@ -52,6 +53,7 @@ struct FuzzingOptions {
   bool PrintCorpusStats = false;
   bool PrintCoverage = false;
   bool DetectLeaks = true;
+  bool ForkInputs = false;
   int  TraceMalloc = 0;
 };
 
@@ -0,0 +1,136 @@
+//===- FuzzerSharedCorpus.cpp - Corpus shared between processes -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+// A log of new units in shared memory, used by -jobs workers.
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerSharedCorpus.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace fuzzer {
+
+// The file starts with this header, followed by the records. The file is
+// created sparse and zero-filled, so a fresh log is empty.
+struct SharedCorpus::LogHeader {
+  // Offset past the last reserved record. It can exceed the capacity, which
+  // means the log is full.
+  std::atomic<uint64_t> End;
+  uint64_t Padding[7];
+};
+
+// A record header holds the unit size plus one, shifted left by one, with
+// kPublished in the low bit. Zero means the writer has reserved the record
+// but not yet stored the size. The unit data follows, padded to 8 bytes.
+struct SharedCorpus::RecordHeader {
+  std::atomic<uint64_t> Word;
+};
+
+namespace {
+const uint64_t kPublished = 1;
+
+size_t RecordSize(size_t UnitSize) {
+  return (sizeof(uint64_t) + UnitSize + 7) & ~size_t(7);
+}
+}  // namespace
+
+SharedCorpus::~SharedCorpus() {
+  if (Header)
+    munmap(Header, kLogSize);
+}
+
+bool SharedCorpus::Open(const std::string &Path) {
+  assert(!Header);
+  int Fd = open(Path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (Fd < 0)
+    return false;
+  // Every process sets the same size, so this never truncates a live log.
+  void *Map = MAP_FAILED;
+  if (ftruncate(Fd, kLogSize) == 0)
+    Map = mmap(nullptr, kLogSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+  close(Fd);
+  if (Map == MAP_FAILED)
+    return false;
+  Header = static_cast<LogHeader *>(Map);
+  Records = static_cast<uint8_t *>(Map) + sizeof(LogHeader);
+  Capacity = kLogSize - sizeof(LogHeader);
+  ReadOffset = Min<size_t>(Header->End.load(std::memory_order_acquire),
+                           Capacity);
+  return true;
+}
+
+bool SharedCorpus::IsFull() const {
+  return Header->End.load(std::memory_order_relaxed) >= Capacity;
+}
+
+SharedCorpus::RecordHeader *SharedCorpus::Reserve(const Unit &U) {
+  size_t Size = RecordSize(U.size());
+  uint64_t Offset = Header->End.fetch_add(Size, std::memory_order_relaxed);
+  // If the log is full, End now exceeds the capacity, which IsFull reports.
+  if (Offset + Size > Capacity)
+    return nullptr;
+  auto *R = reinterpret_cast<RecordHeader *>(Records + Offset);
+  // Store the size first, so that readers can skip the record if this
+  // process dies before publishing it.
+  R->Word.store((U.size() + 1) << 1, std::memory_order_relaxed);
+  memcpy(Records + Offset + sizeof(RecordHeader), U.data(), U.size());
+  return R;
+}
+
+void SharedCorpus::Append(const Unit &U) {
+  if (RecordHeader *R = Reserve(U))
+    R->Word.store(((U.size() + 1) << 1) | kPublished,
+                  std::memory_order_release);
+}
+
+bool SharedCorpus::AppendWithoutPublishing(const Unit &U) {
+  return Reserve(U) != nullptr;
+}
+
+void SharedCorpus::ReadNew(UnitVector *V, size_t MaxSize) {
+  if (Broken)
+    return;
+  size_t End = Min<size_t>(Header->End.load(std::memory_order_acquire),
+                           Capacity);
+  while (ReadOffset < End) {
+    auto *R = reinterpret_cast<RecordHeader *>(Records + ReadOffset);
+    uint64_t Word = R->Word.load(std::memory_order_acquire);
+    if (!(Word & kPublished)) {
+      // Another process is still copying this one in; pick it up next time,
+      // unless it has been at it for so long that it must have died.
+      auto Now = std::chrono::steady_clock::now();
+      if (StalledOffset != ReadOffset) {
+        StalledOffset = ReadOffset;
+        StalledSince = Now;
+        break;
+      }
+      if (std::chrono::duration<double>(Now - StalledSince).count() <
+          StaleReservationSec)
+        break;
+      if (!Word) {
+        // The writer died before storing the size; nothing after this record
+        // can be found. The directory rescan still picks those units up.
+        Broken = true;
+        break;
+      }
+      ReadOffset += RecordSize((Word >> 1) - 1);
+      continue;
+    }
+    size_t Size = (Word >> 1) - 1;
+    if (ReadOffset + RecordSize(Size) > Capacity)
+      break;
+    const uint8_t *Data = Records + ReadOffset + sizeof(RecordHeader);
+    V->push_back(Unit(Data, Data + Min(Size, MaxSize)));
+    ReadOffset += RecordSize(Size);
+  }
+}
+
+}  // namespace fuzzer
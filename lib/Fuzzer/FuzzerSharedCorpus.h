@@ -0,0 +1,71 @@
+//===- FuzzerSharedCorpus.h - Internal header for the Fuzzer ----*- C++ -* ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+// fuzzer::SharedCorpus
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_FUZZER_SHARED_CORPUS
+#define LLVM_FUZZER_SHARED_CORPUS
+
+#include "FuzzerDefs.h"
+
+#include <chrono>
+
+namespace fuzzer {
+
+// An append-only log of units in a file mapped into every process that fuzzes
+// the same target. Each process appends the units that gave it new coverage,
+// and picks up the ones found by the others by reading the log from where it
+// stopped last time, without waiting for the next rescan of the corpus
+// directory. Appending reserves space with an atomic add, so no locks are
+// needed. Once the log is full, nothing more is added.
+class SharedCorpus {
+ public:
+  // A record that stays unpublished for StaleReservationSec is taken to
+  // belong to a writer that died, and readers stop waiting for it.
+  explicit SharedCorpus(double StaleReservationSec = 10)
+      : StaleReservationSec(StaleReservationSec) {}
+  ~SharedCorpus();
+  // Maps the log at Path, creating it if needed. Units appended before this
+  // call are not returned by ReadNew: they are expected to be in the corpus
+  // directory already.
+  bool Open(const std::string &Path);
+  bool IsOpen() const { return Header != nullptr; }
+  bool IsFull() const;
+  void Append(const Unit &U);
+  // Reserves a record for U and copies U into it, but leaves it unpublished,
+  // as a writer that dies halfway through Append would. Returns false if the
+  // log is full. Only for tests.
+  bool AppendWithoutPublishing(const Unit &U);
+  // Appends to V the units added by any process since the last call,
+  // truncated to MaxSize bytes.
+  void ReadNew(UnitVector *V, size_t MaxSize);
+
+  static const size_t kLogSize = 1 << 28;
+
+ private:
+  struct LogHeader;
+  struct RecordHeader;
+  RecordHeader *Reserve(const Unit &U);
+
+  LogHeader *Header = nullptr;
+  uint8_t *Records = nullptr;
+  size_t Capacity = 0;
+  size_t ReadOffset = 0;
+  // The unpublished record ReadNew last stopped at, and when it first did.
+  size_t StalledOffset = SIZE_MAX;
+  std::chrono::steady_clock::time_point StalledSince;
+  double StaleReservationSec;
+  // Set when a dead writer left a record whose size is unknown, so the
+  // records after it cannot be found.
+  bool Broken = false;
+};
+
+}  // namespace fuzzer
+
+#endif  // LLVM_FUZZER_SHARED_CORPUS
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include <sstream>
@@ -75,9 +76,7 @@ void TracePC::ResetGuards() {
   assert(N == NumGuards);
 }
 
-size_t TracePC::FinalizeTrace(InputCorpus *C, size_t InputSize, bool Shrink) {
-  if (!UsingTracePcGuard()) return 0;
-  size_t Res = 0;
+template <class Callback> void TracePC::CollectFeatures(Callback CB) {
   const size_t Step = 8;
   assert(reinterpret_cast<uintptr_t>(Counters) % Step == 0);
   size_t N = Min(kNumCounters, NumGuards + 1);
@@ -97,19 +96,69 @@ size_t TracePC::FinalizeTrace(InputCorpus *C, size_t InputSize, bool Shrink) {
       else if (Counter >= 4) Bit = 3;
       else if (Counter >= 3) Bit = 2;
       else if (Counter >= 2) Bit = 1;
-      size_t Feature = (i * 8 + Bit);
-      if (C->AddFeature(Feature, InputSize, Shrink))
-        Res++;
+      CB(i * 8 + Bit);
     }
   }
   if (UseValueProfile)
-    ValueProfileMap.ForEach([&](size_t Idx) {
-      if (C->AddFeature(NumGuards + Idx, InputSize, Shrink))
-        Res++;
-    });
+    ValueProfileMap.ForEach([&](size_t Idx) { CB(NumGuards + Idx); });
+}
+
+size_t TracePC::FinalizeTrace(InputCorpus *C, size_t InputSize, bool Shrink) {
+  if (!UsingTracePcGuard()) return 0;
+  size_t Res = 0;
+  CollectFeatures([&](size_t Feature) {
+    if (C->AddFeature(Feature, InputSize, Shrink))
+      Res++;
+  });
   return Res;
 }
 
+void TracePC::CollectFeatures(std::vector<uint32_t> *Features) {
+  Features->clear();
+  if (!UsingTracePcGuard()) return;
+  CollectFeatures([&](size_t Feature) { Features->push_back(Feature); });
+  std::sort(Features->begin(), Features->end());
+}
+
+struct TracePC::Snapshot {
+  uint8_t Counters[kNumCounters];
+  ValueBitMap ValueProfileMap;
+  TableOfRecentCompares<uint32_t, kTORCSize> TORC4;
+  TableOfRecentCompares<uint64_t, kTORCSize> TORC8;
+  size_t NumNewPCIDs;
+  uintptr_t NewPCIDs[kMaxNewPCIDs];
+  uintptr_t NewPCs[kMaxNewPCIDs];
+};
+
+size_t TracePC::SnapshotSize() { return sizeof(Snapshot); }
+
+void TracePC::SaveSnapshot(Snapshot *S) const {
+  memcpy(S->Counters, Counters, sizeof(Counters));
+  S->ValueProfileMap = ValueProfileMap;
+  S->TORC4 = TORC4;
+  S->TORC8 = TORC8;
+  S->NumNewPCIDs = Min(kMaxNewPCIDs, NumNewPCIDs);
+  for (size_t i = 0; i < S->NumNewPCIDs; i++) {
+    S->NewPCIDs[i] = NewPCIDs[i];
+    S->NewPCs[i] = PCs[NewPCIDs[i] % kNumPCs];
+  }
+}
+
+void TracePC::RestoreSnapshot(const Snapshot &S) {
+  memcpy(Counters, S.Counters, sizeof(Counters));
+  ValueProfileMap = S.ValueProfileMap;
+  TORC4 = S.TORC4;
+  TORC8 = S.TORC8;
+  // Replay what HandleTrace did for PCs the child saw first.
+  for (size_t i = 0; i < S.NumNewPCIDs; i++) {
+    uintptr_t Idx = S.NewPCIDs[i];
+    if (PCs[Idx % kNumPCs]) continue;
+    AddNewPCID(Idx);
+    TotalPCCoverage++;
+    PCs[Idx % kNumPCs] = S.NewPCs[i];
+  }
+}
+
 void TracePC::HandleCallerCallee(uintptr_t Caller, uintptr_t Callee) {
   const uintptr_t kBits = 12;
   const uintptr_t kMask = (1 << kBits) - 1;
@@ -50,6 +50,9 @@ class TracePC {
   void SetUseCounters(bool UC) { UseCounters = UC; }
   void SetUseValueProfile(bool VP) { UseValueProfile = VP; }
   size_t FinalizeTrace(InputCorpus *C, size_t InputSize, bool Shrink);
+  // Puts the features of the last input into Features, sorted, and clears
+  // the counters like FinalizeTrace does.
+  void CollectFeatures(std::vector<uint32_t> *Features);
   bool UpdateValueProfileMap(ValueBitMap *MaxValueProfileMap) {
     return UseValueProfile && MaxValueProfileMap->MergeFrom(ValueProfileMap);
   }
@@ -90,6 +93,13 @@ class TracePC {
 
   void ProcessTORC(Dictionary *Dict, const uint8_t *Data, size_t Size);
 
+  // The per-input state that -fork_inputs copies from the child process that
+  // ran an input back to the fuzzer.
+  struct Snapshot;
+  static size_t SnapshotSize();
+  void SaveSnapshot(Snapshot *S) const;
+  void RestoreSnapshot(const Snapshot &S);
+
 private:
   bool UseCounters = false;
   bool UseValueProfile = false;
@@ -129,6 +139,8 @@ private:
     TORC8.Insert(Idx, Arg1, Arg2);
   }
 
+  template <class Callback> void CollectFeatures(Callback CB);
+
   template <class T>
   void TORCToDict(const TableOfRecentCompares<T, kTORCSize> &TORC,
                   Dictionary *Dict, const uint8_t *Data, size_t Size);
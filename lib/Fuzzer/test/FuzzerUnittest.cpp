@@ -7,6 +7,7 @@
 
 #include "FuzzerCorpus.h"
 #include "FuzzerInternal.h"
+#include "FuzzerMerge.h"
 #include "FuzzerDictionary.h"
 #include "FuzzerMutate.h"
 #include "FuzzerRandom.h"
@@ -598,3 +599,82 @@ TEST(Corpus, Distribution) {
     EXPECT_GT(Hist[i], TriesPerUnit / N / 3);
   }
 }
+
+static std::string SharedCorpusTestPath() {
+  const char *TmpDir = getenv("TMPDIR");
+  return DirPlusFile(TmpDir ? TmpDir : "/tmp",
+                     "libFuzzerSharedCorpusTest." + std::to_string(GetPid()));
+}
+
+TEST(SharedCorpus, AppendAndReadNew) {
+  std::string Path = SharedCorpusTestPath();
+  SharedCorpus A, B;
+  ASSERT_TRUE(A.Open(Path));
+  A.Append({1, 2, 3});
+  // B only sees what is appended after it opens the log.
+  ASSERT_TRUE(B.Open(Path));
+  A.Append({});
+  A.Append({4, 5, 6, 7, 8, 9, 10, 11, 12});
+  B.Append({13});
+  DeleteFile(Path);
+
+  UnitVector V;
+  B.ReadNew(&V, 4);
+  ASSERT_EQ(3UL, V.size());
+  EXPECT_EQ(Unit(), V[0]);
+  EXPECT_EQ(Unit({4, 5, 6, 7}), V[1]);
+  EXPECT_EQ(Unit({13}), V[2]);
+  V.clear();
+  B.ReadNew(&V, 4);
+  EXPECT_TRUE(V.empty());
+
+  A.ReadNew(&V, 100);
+  EXPECT_EQ(4UL, V.size());
+  EXPECT_FALSE(A.IsFull());
+}
+
+TEST(Merge, GreedySetCover) {
+  std::vector<bool> Covered(2);
+  Covered[1] = true;
+  std::vector<size_t> Res = GreedySetCover(
+      {{1}, {2, 3}, {2, 3, 4, 5}, {2, 3, 4, 5}, {6}, {5, 6}},
+      {1, 10, 10, 1, 1, 100}, &Covered);
+  // {2, 3, 4, 5} is cheaper as input 3, {6} costs less than {5, 6}, and
+  // nothing else adds anything.
+  EXPECT_EQ(std::vector<size_t>({3, 4}), Res);
+  EXPECT_EQ(7UL, Covered.size());
+  for (size_t F = 1; F < Covered.size(); F++)
+    EXPECT_TRUE(Covered[F]);
+  EXPECT_FALSE(Covered[0]);
+
+  // Everything is covered now.
+  EXPECT_TRUE(GreedySetCover({{1, 2}, {6}}, {1, 1}, &Covered).empty());
+}
+
+TEST(SharedCorpus, DeadWriter) {
+  std::string Path = SharedCorpusTestPath();
+  SharedCorpus A, B(/*StaleReservationSec=*/0);
+  ASSERT_TRUE(A.Open(Path));
+  ASSERT_TRUE(B.Open(Path));
+  A.Append({1});
+  ASSERT_TRUE(A.AppendWithoutPublishing({2, 3}));
+  A.Append({4});
+  DeleteFile(Path);
+
+  // The first read stops at the unpublished record; once it has been
+  // unpublished for longer than the timeout, readers skip it.
+  UnitVector V;
+  B.ReadNew(&V, 100);
+  ASSERT_EQ(1UL, V.size());
+  EXPECT_EQ(Unit({1}), V[0]);
+  B.ReadNew(&V, 100);
+  ASSERT_EQ(2UL, V.size());
+  EXPECT_EQ(Unit({4}), V[1]);
+
+  // A reader with the default timeout keeps waiting for it.
+  V.clear();
+  A.ReadNew(&V, 100);
+  A.ReadNew(&V, 100);
+  ASSERT_EQ(1UL, V.size());
+  EXPECT_EQ(Unit({1}), V[0]);
+}
@@ -37,17 +37,25 @@
 #include "llvm/IR/TypeFinder.h"
 #include "llvm/IR/UseListOrder.h"
 #include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
 using namespace llvm;
 
+static cl::opt<unsigned> AsmWriterThreads(
+    "asm-writer-threads", cl::Hidden, cl::init(1),
+    cl::desc("Number of threads to print function bodies of textual IR on "
+             "(0 = hardware concurrency)"));
+
 // Make virtual table appear in this compilation unit.
 AssemblyAnnotationWriter::~AssemblyAnnotationWriter() {}
 
@@ -591,6 +599,10 @@ private:
   bool FunctionProcessed;
   bool ShouldInitializeAllMetadata;
 
+  /// ModuleSlots - If set, the tracker that owns the module level slots, which
+  /// this one only holds the function level slots for.
+  const SlotTracker *ModuleSlots;
+
   /// mMap - The slot map for the module level data.
   ValueMap mMap;
   unsigned mNext;
@@ -621,6 +633,10 @@ public:
   /// within a function (even if no functions have been initialized).
   explicit SlotTracker(const Function *F,
                        bool ShouldInitializeAllMetadata = false);
+  /// Construct a tracker for the local slots of \p F that shares the module
+  /// level slots of \p ModuleSlots, on which processAllFunctions must have
+  /// been called. Any number of these can be used concurrently.
+  SlotTracker(const SlotTracker &ModuleSlots, const Function *F);
 
   /// Return the slot number of the specified value in it's type
   /// plane.  If something is not in the SlotTracker, return -1.
@@ -660,6 +676,10 @@ public:
   /// This function does the actual initialization.
   inline void initialize();
 
+  /// Create the module level slots, such as those of metadata and call
+  /// attributes, that the functions of \p M would add as they are printed.
+  void processAllFunctions(const Module &M);
+
   // Implementation Details
 private:
   /// CreateModuleSlot - Insert the specified GlobalValue* into the slot table.
@@ -690,6 +710,9 @@ private:
   /// Add all of the metadata from an instruction.
   void processInstructionMetadata(const Instruction &I);
 
+  /// Add the function attributes of a call or invoke.
+  void processCallAttributes(const Instruction &I);
+
   SlotTracker(const SlotTracker &) = delete;
   void operator=(const SlotTracker &) = delete;
 };
@@ -772,16 +795,26 @@ static SlotTracker *createSlotTracker(const Value *V) {
 // to be added to the slot table.
 SlotTracker::SlotTracker(const Module *M, bool ShouldInitializeAllMetadata)
     : TheModule(M), TheFunction(nullptr), FunctionProcessed(false),
-      ShouldInitializeAllMetadata(ShouldInitializeAllMetadata), mNext(0),
-      fNext(0), mdnNext(0), asNext(0) {}
+      ShouldInitializeAllMetadata(ShouldInitializeAllMetadata),
+      ModuleSlots(nullptr), mNext(0), fNext(0), mdnNext(0), asNext(0) {}
 
 // Function level constructor. Causes the contents of the Module and the one
 // function provided to be added to the slot table.
 SlotTracker::SlotTracker(const Function *F, bool ShouldInitializeAllMetadata)
     : TheModule(F ? F->getParent() : nullptr), TheFunction(F),
       FunctionProcessed(false),
-      ShouldInitializeAllMetadata(ShouldInitializeAllMetadata), mNext(0),
-      fNext(0), mdnNext(0), asNext(0) {}
+      ShouldInitializeAllMetadata(ShouldInitializeAllMetadata),
+      ModuleSlots(nullptr), mNext(0), fNext(0), mdnNext(0), asNext(0) {}
+
+// Function level constructor sharing the module level slots of another
+// tracker, which must not change while this one is in use.
+SlotTracker::SlotTracker(const SlotTracker &ModuleSlots, const Function *F)
+    : TheModule(nullptr), TheFunction(F), FunctionProcessed(false),
+      ShouldInitializeAllMetadata(ModuleSlots.ShouldInitializeAllMetadata),
+      ModuleSlots(&ModuleSlots), mNext(0), fNext(0), mdnNext(0), asNext(0) {
+  assert(!ModuleSlots.TheModule && !ModuleSlots.ModuleSlots &&
+         "Module level slots are not ready to share");
+}
 
 inline void SlotTracker::initialize() {
   if (TheModule) {
@@ -845,7 +878,7 @@ void SlotTracker::processFunction() {
   fNext = 0;
 
   // Process function metadata if it wasn't hit at the module-level.
-  if (!ShouldInitializeAllMetadata)
+  if (!ShouldInitializeAllMetadata && !ModuleSlots)
     processFunctionMetadata(*TheFunction);
 
   // Add all the function arguments with no names.
@@ -865,19 +898,8 @@ void SlotTracker::processFunction() {
       if (!I.getType()->isVoidTy() && !I.hasName())
         CreateFunctionSlot(&I);
 
-      // We allow direct calls to any llvm.foo function here, because the
-      // target may not be linked into the optimizer.
-      if (const CallInst *CI = dyn_cast<CallInst>(&I)) {
-        // Add all the call attributes to the table.
-        AttributeSet Attrs = CI->getAttributes().getFnAttributes();
-        if (Attrs.hasAttributes(AttributeSet::FunctionIndex))
-          CreateAttributeSetSlot(Attrs);
-      } else if (const InvokeInst *II = dyn_cast<InvokeInst>(&I)) {
-        // Add all the call attributes to the table.
-        AttributeSet Attrs = II->getAttributes().getFnAttributes();
-        if (Attrs.hasAttributes(AttributeSet::FunctionIndex))
-          CreateAttributeSetSlot(Attrs);
-      }
+      if (!ModuleSlots)
+        processCallAttributes(I);
     }
   }
 
@@ -886,6 +908,21 @@ void SlotTracker::processFunction() {
   ST_DEBUG("end processFunction!\n");
 }
 
+// Do the module level part of processFunction for every function up front, in
+// the same order that printing the functions one by one would.
+void SlotTracker::processAllFunctions(const Module &M) {
+  initialize();
+  assert(!TheFunction && "Cannot process all functions while in one");
+
+  for (const Function &F : M) {
+    if (!ShouldInitializeAllMetadata)
+      processFunctionMetadata(F);
+    for (auto &BB : F)
+      for (auto &I : BB)
+        processCallAttributes(I);
+  }
+}
+
 void SlotTracker::processGlobalObjectMetadata(const GlobalObject &GO) {
   SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
   GO.getAllMetadata(MDs);
@@ -901,6 +938,22 @@ void SlotTracker::processFunctionMetadata(const Function &F) {
   }
 }
 
+void SlotTracker::processCallAttributes(const Instruction &I) {
+  // We allow direct calls to any llvm.foo function here, because the
+  // target may not be linked into the optimizer.
+  if (const CallInst *CI = dyn_cast<CallInst>(&I)) {
+    // Add all the call attributes to the table.
+    AttributeSet Attrs = CI->getAttributes().getFnAttributes();
+    if (Attrs.hasAttributes(AttributeSet::FunctionIndex))
+      CreateAttributeSetSlot(Attrs);
+  } else if (const InvokeInst *II = dyn_cast<InvokeInst>(&I)) {
+    // Add all the call attributes to the table.
+    AttributeSet Attrs = II->getAttributes().getFnAttributes();
+    if (Attrs.hasAttributes(AttributeSet::FunctionIndex))
+      CreateAttributeSetSlot(Attrs);
+  }
+}
+
 void SlotTracker::processInstructionMetadata(const Instruction &I) {
   // Process metadata used directly by intrinsics.
   if (const CallInst *CI = dyn_cast<CallInst>(&I))
@@ -935,8 +988,9 @@ int SlotTracker::getGlobalSlot(const GlobalValue *V) {
   initialize();
 
   // Find the value in the module map
-  ValueMap::iterator MI = mMap.find(V);
-  return MI == mMap.end() ? -1 : (int)MI->second;
+  const ValueMap &Map = ModuleSlots ? ModuleSlots->mMap : mMap;
+  ValueMap::const_iterator MI = Map.find(V);
+  return MI == Map.end() ? -1 : (int)MI->second;
 }
 
 /// getMetadataSlot - Get the slot number of a MDNode.
@@ -945,8 +999,9 @@ int SlotTracker::getMetadataSlot(const MDNode *N) {
   initialize();
 
   // Find the MDNode in the module map
-  mdn_iterator MI = mdnMap.find(N);
-  return MI == mdnMap.end() ? -1 : (int)MI->second;
+  const auto &Map = ModuleSlots ? ModuleSlots->mdnMap : mdnMap;
+  auto MI = Map.find(N);
+  return MI == Map.end() ? -1 : (int)MI->second;
 }
 
 
@@ -966,8 +1021,9 @@ int SlotTracker::getAttributeGroupSlot(AttributeSet AS) {
   initialize();
 
   // Find the AttributeSet in the module map.
-  as_iterator AI = asMap.find(AS);
-  return AI == asMap.end() ? -1 : (int)AI->second;
+  const auto &Map = ModuleSlots ? ModuleSlots->asMap : asMap;
+  auto AI = Map.find(AS);
+  return AI == Map.end() ? -1 : (int)AI->second;
 }
 
 /// CreateModuleSlot - Insert the specified GlobalValue* into the slot table.
@@ -2035,7 +2091,8 @@ class AssemblyWriter {
   const Module *TheModule;
   std::unique_ptr<SlotTracker> SlotTrackerStorage;
   SlotTracker &Machine;
-  TypePrinting TypePrinter;
+  TypePrinting TypePrinterStorage;
+  TypePrinting &TypePrinter;
   AssemblyAnnotationWriter *AnnotationWriter;
   SetVector<const Comdat *> Comdats;
   bool IsForDebug;
@@ -2049,6 +2106,12 @@ public:
                  AssemblyAnnotationWriter *AAW, bool IsForDebug,
                  bool ShouldPreserveUseListOrder = false);
 
+  /// Construct an AssemblyWriter that prints functions of the module that
+  /// \p Parent prints, using the local slots in \p Mac and sharing the types
+  /// of \p Parent.
+  AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
+                 AssemblyWriter &Parent);
+
   void printMDNodeBody(const MDNode *MD);
   void printNamedMDNode(const NamedMDNode *NMD);
 
@@ -2071,6 +2134,7 @@ public:
   void printIndirectSymbol(const GlobalIndirectSymbol *GIS);
   void printComdat(const Comdat *C);
   void printFunction(const Function *F);
+  void printFunctionsInParallel(const Module *M, unsigned NumThreads);
   void printArgument(const Argument *FA, AttributeSet Attrs, unsigned Idx);
   void printBasicBlock(const BasicBlock *BB);
   void printInstructionLine(const Instruction &I);
@@ -2098,8 +2162,8 @@ private:
 AssemblyWriter::AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
                                const Module *M, AssemblyAnnotationWriter *AAW,
                                bool IsForDebug, bool ShouldPreserveUseListOrder)
-    : Out(o), TheModule(M), Machine(Mac), AnnotationWriter(AAW),
-      IsForDebug(IsForDebug),
+    : Out(o), TheModule(M), Machine(Mac), TypePrinter(TypePrinterStorage),
+      AnnotationWriter(AAW), IsForDebug(IsForDebug),
       ShouldPreserveUseListOrder(ShouldPreserveUseListOrder) {
   if (!TheModule)
     return;
@@ -2109,6 +2173,12 @@ AssemblyWriter::AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
       Comdats.insert(C);
 }
 
+AssemblyWriter::AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
+                               AssemblyWriter &Parent)
+    : Out(o), TheModule(Parent.TheModule), Machine(Mac),
+      TypePrinter(Parent.TypePrinter), AnnotationWriter(nullptr),
+      IsForDebug(Parent.IsForDebug), ShouldPreserveUseListOrder(false) {}
+
 void AssemblyWriter::writeOperand(const Value *Operand, bool PrintType) {
   if (!Operand) {
     Out << "<null operand!>";
@@ -2274,9 +2344,16 @@ void AssemblyWriter::printModule(const Module *M) {
   // Output global use-lists.
   printUseLists(nullptr);
 
-  // Output all of the functions.
-  for (const Function &F : *M)
-    printFunction(&F);
+  // Output all of the functions. Annotation writers and use-list orders expect
+  // the functions in order, so they are not printed in parallel.
+  unsigned NumThreads = AsmWriterThreads ? unsigned(AsmWriterThreads)
+                                         : heavyweight_hardware_concurrency();
+  if (NumThreads > 1 && M->size() > 1 && !AnnotationWriter &&
+      !ShouldPreserveUseListOrder)
+    printFunctionsInParallel(M, NumThreads);
+  else
+    for (const Function &F : *M)
+      printFunction(&F);
   assert(UseListOrders.empty() && "All use-lists should have been consumed");
 
   // Output all attribute groups.
@@ -2699,6 +2776,45 @@ void AssemblyWriter::printFunction(const Function *F) {
   Machine.purgeFunction();
 }
 
+/// printFunctionsInParallel - Print all the functions of \p M, formatting
+/// their bodies on \p NumThreads threads. The output is the same as printing
+/// them one by one.
+void AssemblyWriter::printFunctionsInParallel(const Module *M,
+                                              unsigned NumThreads) {
+  // Number everything the functions refer to at module level first, so that
+  // the function level trackers only have to read the shared slots.
+  Machine.processAllFunctions(*M);
+
+  std::vector<const Function *> Functions;
+  Functions.reserve(M->size());
+  for (const Function &F : *M)
+    Functions.push_back(&F);
+
+  // Print in batches, to bound the number of function bodies held in memory.
+  ThreadPool Pool(NumThreads);
+  const size_t BatchSize = 16 * NumThreads;
+  std::vector<std::string> Bodies(std::min(BatchSize, Functions.size()));
+  for (size_t Begin = 0, E = Functions.size(); Begin < E; Begin += BatchSize) {
+    size_t End = std::min(Begin + BatchSize, E);
+    for (size_t I = Begin; I != End; ++I)
+      Pool.async([this, &Functions, &Bodies, Begin, I] {
+        const Function *F = Functions[I];
+        raw_string_ostream OS(Bodies[I - Begin]);
+        formatted_raw_ostream FOS(OS);
+        SlotTracker Locals(Machine, F);
+        AssemblyWriter W(FOS, Locals, *this);
+        W.printFunction(F);
+      });
+    Pool.wait();
+
+    for (size_t I = Begin; I != End; ++I) {
+      std::string &Body = Bodies[I - Begin];
+      Out << Body;
+      Body.clear();
+    }
+  }
+}
+
 /// printArgument - This member is called for every argument that is passed into
 /// the function.  Simply print it out
 ///
@@ -21,6 +21,7 @@
 #include "llvm/IR/Attributes.h"
 #include "AttributeSetNode.h"
 #include "llvm/Support/DataTypes.h"
+#include <algorithm>
 #include <climits>
 #include <string>
 
@@ -159,6 +160,9 @@ private:
   unsigned NumSlots; ///< Number of entries in this set.
   /// Bitset with a bit for each available attribute Attribute::AttrKind.
   uint64_t AvailableFunctionAttrs;
+  /// Bitset with a bit for each attribute Attribute::AttrKind available on
+  /// any slot.
+  uint64_t AvailableSomewhereAttrs;
 
   // Helper fn for TrailingObjects class.
   size_t numTrailingObjects(OverloadToken<IndexAttrPair>) { return NumSlots; }
@@ -174,7 +178,8 @@ private:
 public:
   AttributeSetImpl(LLVMContext &C,
                    ArrayRef<std::pair<unsigned, AttributeSetNode *> > Slots)
-      : Context(C), NumSlots(Slots.size()), AvailableFunctionAttrs(0) {
+      : Context(C), NumSlots(Slots.size()), AvailableFunctionAttrs(0),
+        AvailableSomewhereAttrs(0) {
     static_assert(Attribute::EndAttrKinds <=
                       sizeof(AvailableFunctionAttrs) * CHAR_BIT,
                   "Too many attributes");
@@ -191,7 +196,12 @@ public:
     // There's memory after the node where we can store the entries in.
     std::copy(Slots.begin(), Slots.end(), getTrailingObjects<IndexAttrPair>());
 
-    // Initialize AvailableFunctionAttrs summary bitset.
+    // Initialize the AvailableFunctionAttrs and AvailableSomewhereAttrs
+    // summary bitsets.
+    for (const auto &Slot : Slots)
+      for (Attribute I : *Slot.second)
+        if (!I.isStringAttribute())
+          AvailableSomewhereAttrs |= ((uint64_t)1) << I.getKindAsEnum();
     if (NumSlots > 0) {
       static_assert(AttributeSet::FunctionIndex == ~0u,
                     "FunctionIndex should be biggest possible index");
@@ -237,12 +247,31 @@ public:
     return getNode(Slot)->second;
   }
 
+  /// \brief Retrieve the attribute set node for the return value, parameter
+  /// or function with the given index, or null if it has no attributes.
+  AttributeSetNode *getNodeForIndex(unsigned Index) const {
+    // The slots are sorted by index.
+    const IndexAttrPair *Begin = getNode(0), *End = Begin + NumSlots;
+    const IndexAttrPair *I = std::lower_bound(
+        Begin, End, Index,
+        [](const IndexAttrPair &Node, unsigned Index) {
+          return Node.first < Index;
+        });
+    return I != End && I->first == Index ? I->second : nullptr;
+  }
+
   /// \brief Return true if the AttributeSetNode for the FunctionIndex has an
   /// enum attribute of the given kind.
   bool hasFnAttribute(Attribute::AttrKind Kind) const {
     return AvailableFunctionAttrs & ((uint64_t)1) << Kind;
   }
 
+  /// \brief Return true if the AttributeSetNode of any slot has an enum
+  /// attribute of the given kind.
+  bool hasAttrSomewhere(Attribute::AttrKind Kind) const {
+    return AvailableSomewhereAttrs & ((uint64_t)1) << Kind;
+  }
+
   typedef AttributeSetNode::iterator iterator;
   iterator begin(unsigned Slot) const { return getSlotNode(Slot)->begin(); }
   iterator end(unsigned Slot) const { return getSlotNode(Slot)->end(); }
@@ -27,7 +27,7 @@ namespace llvm {
 /// \brief This class represents a group of attributes that apply to one
 /// element: function, return type, or parameter.
 class AttributeSetNode final
-    : public FoldingSetNode,
+    : public CachedHashFoldingSetNode,
       private TrailingObjects<AttributeSetNode, Attribute> {
   friend TrailingObjects;
 
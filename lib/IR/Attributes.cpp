@@ -604,35 +604,45 @@ Attribute AttributeSetNode::getAttribute(StringRef Kind) const {
 }
 
 unsigned AttributeSetNode::getAlignment() const {
+  if (!hasAttribute(Attribute::Alignment))
+    return 0;
   for (Attribute I : *this)
     if (I.hasAttribute(Attribute::Alignment))
       return I.getAlignment();
-  return 0;
+  llvm_unreachable("Attribute summary bitset out of sync");
 }
 
 unsigned AttributeSetNode::getStackAlignment() const {
+  if (!hasAttribute(Attribute::StackAlignment))
+    return 0;
   for (Attribute I : *this)
     if (I.hasAttribute(Attribute::StackAlignment))
       return I.getStackAlignment();
-  return 0;
+  llvm_unreachable("Attribute summary bitset out of sync");
 }
 
 uint64_t AttributeSetNode::getDereferenceableBytes() const {
+  if (!hasAttribute(Attribute::Dereferenceable))
+    return 0;
   for (Attribute I : *this)
     if (I.hasAttribute(Attribute::Dereferenceable))
       return I.getDereferenceableBytes();
-  return 0;
+  llvm_unreachable("Attribute summary bitset out of sync");
 }
 
 uint64_t AttributeSetNode::getDereferenceableOrNullBytes() const {
+  if (!hasAttribute(Attribute::DereferenceableOrNull))
+    return 0;
   for (Attribute I : *this)
     if (I.hasAttribute(Attribute::DereferenceableOrNull))
       return I.getDereferenceableOrNullBytes();
-  return 0;
+  llvm_unreachable("Attribute summary bitset out of sync");
 }
 
 std::pair<unsigned, Optional<unsigned>>
 AttributeSetNode::getAllocSizeArgs() const {
+  if (!hasAttribute(Attribute::AllocSize))
+    return std::make_pair(0, 0);
   for (Attribute I : *this)
     if (I.hasAttribute(Attribute::AllocSize))
       return I.getAllocSizeArgs();
@@ -1121,17 +1131,15 @@ bool AttributeSet::hasFnAttribute(StringRef Kind) const {
 
 bool AttributeSet::hasAttrSomewhere(Attribute::AttrKind Attr,
                                     unsigned *Index) const {
-  if (!pImpl) return false;
+  if (!pImpl || !pImpl->hasAttrSomewhere(Attr)) return false;
 
   for (unsigned I = 0, E = pImpl->getNumSlots(); I != E; ++I)
-    for (AttributeSetImpl::iterator II = pImpl->begin(I),
-           IE = pImpl->end(I); II != IE; ++II)
-      if (II->hasAttribute(Attr)) {
-        if (Index) *Index = pImpl->getSlotIndex(I);
-        return true;
-      }
+    if (pImpl->getSlotNode(I)->hasAttribute(Attr)) {
+      if (Index) *Index = pImpl->getSlotIndex(I);
+      return true;
+    }
 
-  return false;
+  llvm_unreachable("Attribute summary bitset out of sync");
 }
 
 Attribute AttributeSet::getAttribute(unsigned Index,
@@ -1179,13 +1187,7 @@ std::string AttributeSet::getAsString(unsigned Index, bool InAttrGrp) const {
 
 AttributeSetNode *AttributeSet::getAttributes(unsigned Index) const {
   if (!pImpl) return nullptr;
-
-  // Loop through to find the attribute node we want.
-  for (unsigned I = 0, E = pImpl->getNumSlots(); I != E; ++I)
-    if (pImpl->getSlotIndex(I) == Index)
-      return pImpl->getSlotNode(I);
-
-  return nullptr;
+  return pImpl->getNodeForIndex(Index);
 }
 
 AttributeSet::iterator AttributeSet::begin(unsigned Slot) const {
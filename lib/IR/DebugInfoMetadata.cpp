@@ -60,6 +60,14 @@ DILocation *DILocation::getImpl(LLVMContext &Context, unsigned Line,
   Ops.push_back(Scope);
   if (InlinedAt)
     Ops.push_back(InlinedAt);
+  // Uniqued locations are by far the most numerous debug info nodes and
+  // normally live as long as the context, so allocate them from its slab.
+  if (Storage == Uniqued) {
+    auto *N = new (Ops.size(), Context)
+        DILocation(Context, Storage, Line, Column, Ops);
+    N->IsSlabAllocated = true;
+    return storeImpl(N, Storage, Context.pImpl->DILocations);
+  }
   return storeImpl(new (Ops.size())
                        DILocation(Context, Storage, Line, Column, Ops),
                    Storage, Context.pImpl->DILocations);
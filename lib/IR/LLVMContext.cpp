@@ -216,6 +216,14 @@ void LLVMContext::setDiagnosticsOutputFile(yaml::Output *F) {
   pImpl->DiagnosticsOutputFile.reset(F);
 }
 
+remarks::BinaryRemarkWriter *LLVMContext::getDiagnosticsBinaryOutput() {
+  return pImpl->DiagnosticsBinaryOutput.get();
+}
+
+void LLVMContext::setDiagnosticsBinaryOutput(remarks::BinaryRemarkWriter *W) {
+  pImpl->DiagnosticsBinaryOutput.reset(W);
+}
+
 LLVMContext::DiagnosticHandlerTy LLVMContext::getDiagnosticHandler() const {
   return pImpl->DiagnosticHandler;
 }
@@ -32,6 +32,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/BinaryRemarks.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/YAMLTraits.h"
 #include <vector>
@@ -50,12 +51,12 @@ class Value;
 
 struct DenseMapAPIntKeyInfo {
   static inline APInt getEmptyKey() {
-    APInt V(nullptr, 0);
+    APInt V(0, APInt::UninitializedTag());
     V.VAL = 0;
     return V;
   }
   static inline APInt getTombstoneKey() {
-    APInt V(nullptr, 0);
+    APInt V(0, APInt::UninitializedTag());
     V.VAL = 1;
     return V;
   }
@@ -1066,6 +1067,7 @@ public:
   bool RespectDiagnosticFilters;
   bool DiagnosticHotnessRequested;
   std::unique_ptr<yaml::Output> DiagnosticsOutputFile;
+  std::unique_ptr<remarks::BinaryRemarkWriter> DiagnosticsBinaryOutput;
 
   LLVMContext::YieldCallbackTy YieldCallback;
   void *YieldOpaqueHandle;
@@ -1083,6 +1085,9 @@ public:
   FoldingSet<AttributeSetNode> AttrsSetNodes;
 
   StringMap<MDString, BumpPtrAllocator> MDStringCache;
+
+  /// Allocator for long-lived metadata nodes, see MDNode::operator new.
+  BumpPtrAllocator MetadataSlab;
   DenseMap<Value *, ValueAsMetadata *> ValuesAsMetadata;
   DenseMap<Metadata *, MetadataAsValue *> MetadataAsValues;
 
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -21,8 +22,11 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeTrace.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -482,6 +486,117 @@ public:
 
 static TimingInfo *TheTimeInfo;
 
+static cl::opt<std::string>
+PassTraceFile("pass-trace-file", cl::value_desc("filename"),
+              cl::desc("Record the execution of each pass and write it to "
+                       "the given file on exit, in Chrome trace format"));
+
+namespace {
+/// PassTraceWriter - Writes the events recorded for -pass-trace-file when it
+/// is destroyed at shutdown.
+struct PassTraceWriter {
+  PassTraceWriter() { enableTimeTrace(); }
+  ~PassTraceWriter() {
+    std::error_code EC;
+    raw_fd_ostream OS(PassTraceFile, EC, sys::fs::F_Text);
+    if (EC) {
+      errs() << "Error opening pass trace file '" << PassTraceFile
+             << "': " << EC.message() << '\n';
+      return;
+    }
+    writeTimeTrace(OS);
+  }
+};
+} // End of anon namespace
+
+// createThePassTrace - Start recording pass execution events the first time a
+// pass manager runs, iff -pass-trace-file is given.
+static void createThePassTrace() {
+  if (PassTraceFile.empty())
+    return;
+  static ManagedStatic<PassTraceWriter> PTW;
+  (void)*PTW;
+}
+
+static cl::opt<bool>
+TrackPassMemory("track-pass-memory",
+                cl::desc("Sample malloc usage around each pass and report "
+                         "which pass reached the peak on exit"));
+
+namespace {
+/// PassMemoryTracker - Records the malloc usage after every pass run and the
+/// pass and IR unit responsible for the highest usage and the largest growth.
+/// This only happens when -track-pass-memory is enabled.
+class PassMemoryTracker {
+  sys::SmartMutex<true> Lock;
+  size_t PeakUsage = 0;
+  std::string PeakPass, PeakUnit;
+  ssize_t MaxGrowth = 0;
+  std::string GrowthPass, GrowthUnit;
+
+public:
+  // Print the report from the destructor, like TimingInfo.
+  ~PassMemoryTracker() {
+    std::unique_ptr<raw_ostream> OS = CreateInfoOutputFile();
+    *OS << "===" << std::string(73, '-') << "===\n"
+        << "                      ... Pass memory usage report ...\n"
+        << "===" << std::string(73, '-') << "===\n\n"
+        << "Peak malloc usage: " << PeakUsage << " bytes, after '"
+        << PeakPass << "' on '" << PeakUnit << "'\n"
+        << "Largest growth: " << MaxGrowth << " bytes, during '"
+        << GrowthPass << "' on '" << GrowthUnit << "'\n\n";
+  }
+
+  void record(Pass *P, StringRef Unit, size_t Before, size_t After) {
+    sys::SmartScopedLock<true> Guard(Lock);
+    if (After > PeakUsage) {
+      PeakUsage = After;
+      PeakPass = P->getPassName();
+      PeakUnit = Unit;
+    }
+    ssize_t Growth = (ssize_t)After - (ssize_t)Before;
+    if (Growth > MaxGrowth) {
+      MaxGrowth = Growth;
+      GrowthPass = P->getPassName();
+      GrowthUnit = Unit;
+    }
+  }
+};
+} // End of anon namespace
+
+static PassMemoryTracker *ThePassMemoryTracker;
+
+static void createThePassMemoryTracker() {
+  if (!TrackPassMemory || ThePassMemoryTracker)
+    return;
+  static ManagedStatic<PassMemoryTracker> PMT;
+  ThePassMemoryTracker = &*PMT;
+}
+
+namespace {
+/// PassMemoryRegion - Samples malloc usage around the run of one pass when
+/// -track-pass-memory is enabled.
+class PassMemoryRegion {
+  Pass *P;
+  std::string Unit;
+  size_t Before = 0;
+
+public:
+  PassMemoryRegion(Pass *P, StringRef UnitName) : P(P) {
+    if (!ThePassMemoryTracker || P->getAsPMDataManager())
+      return;
+    Unit = UnitName;
+    Before = sys::Process::GetMallocUsage();
+  }
+  ~PassMemoryRegion() {
+    if (!ThePassMemoryTracker || P->getAsPMDataManager())
+      return;
+    ThePassMemoryTracker->record(P, Unit, Before,
+                                 sys::Process::GetMallocUsage());
+  }
+};
+} // End of anon namespace
+
 //===----------------------------------------------------------------------===//
 // PMTopLevelManager implementation
 
@@ -1290,6 +1405,8 @@ bool BBPassManager::runOnFunction(Function &F) {
         // If the pass crashes, remember this.
         PassManagerPrettyStackEntry X(BP, *I);
         TimeRegion PassTimer(getPassTimer(BP));
+        TimeTraceScope TraceScope(BP->getPassName(), F.getName());
+        PassMemoryRegion MemRegion(BP, F.getName());
 
         LocalChanged |= BP->runOnBasicBlock(*I);
       }
@@ -1453,6 +1570,8 @@ void FunctionPassManagerImpl::releaseMemoryOnTheFly() {
 bool FunctionPassManagerImpl::run(Function &F) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  createThePassTrace();
+  createThePassMemoryTracker();
 
   initializeAllAnalysisInfo();
   for (unsigned Index = 0; Index < getNumContainedManagers(); ++Index) {
@@ -1506,6 +1625,8 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      TimeTraceScope TraceScope(FP->getPassName(), F.getName());
+      PassMemoryRegion MemRegion(FP, F.getName());
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1583,6 +1704,8 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      TimeTraceScope TraceScope(MP->getPassName(), M.getModuleIdentifier());
+      PassMemoryRegion MemRegion(MP, M.getModuleIdentifier());
 
       LocalChanged |= MP->runOnModule(M);
     }
@@ -1678,6 +1801,8 @@ Pass* MPPassManager::getOnTheFlyPass(Pass *MP, AnalysisID PI, Function &F){
 bool PassManagerImpl::run(Module &M) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  createThePassTrace();
+  createThePassMemoryTracker();
 
   dumpArguments();
   dumpPasses();
@@ -438,16 +438,30 @@ StringRef MDString::getString() const {
       "Alignment is insufficient after objects prepended to " #CLASS);
 #include "llvm/IR/Metadata.def"
 
+// Construct the hung-off operands at the start of Mem and return the address
+// where the node itself goes.
+static void *initHungOffOperands(void *Mem, size_t OpSize, unsigned NumOps) {
+  void *Ptr = reinterpret_cast<char *>(Mem) + OpSize;
+  MDOperand *O = static_cast<MDOperand *>(Ptr);
+  for (MDOperand *E = O - NumOps; O != E; --O)
+    (void)new (O - 1) MDOperand;
+  return Ptr;
+}
+
 void *MDNode::operator new(size_t Size, unsigned NumOps) {
   size_t OpSize = NumOps * sizeof(MDOperand);
   // uint64_t is the most aligned type we need support (ensured by static_assert
   // above)
   OpSize = alignTo(OpSize, alignof(uint64_t));
-  void *Ptr = reinterpret_cast<char *>(::operator new(OpSize + Size)) + OpSize;
-  MDOperand *O = static_cast<MDOperand *>(Ptr);
-  for (MDOperand *E = O - NumOps; O != E; --O)
-    (void)new (O - 1) MDOperand;
-  return Ptr;
+  return initHungOffOperands(::operator new(OpSize + Size), OpSize, NumOps);
+}
+
+void *MDNode::operator new(size_t Size, unsigned NumOps,
+                           LLVMContext &Context) {
+  size_t OpSize = alignTo(NumOps * sizeof(MDOperand), alignof(uint64_t));
+  void *Mem = Context.pImpl->MetadataSlab.Allocate(OpSize + Size,
+                                                   alignof(uint64_t));
+  return initHungOffOperands(Mem, OpSize, NumOps);
 }
 
 void MDNode::operator delete(void *Mem) {
@@ -458,7 +472,9 @@ void MDNode::operator delete(void *Mem) {
   MDOperand *O = static_cast<MDOperand *>(Mem);
   for (MDOperand *E = O - N->NumOperands; O != E; --O)
     (O - 1)->~MDOperand();
-  ::operator delete(reinterpret_cast<char *>(Mem) - OpSize);
+  // Slab memory is released with the context.
+  if (!N->IsSlabAllocated)
+    ::operator delete(reinterpret_cast<char *>(Mem) - OpSize);
 }
 
 MDNode::MDNode(LLVMContext &Context, unsigned ID, StorageType Storage,
@@ -20,6 +20,17 @@ using namespace llvm;
 // per-module instances.
 void ModuleSummaryIndex::mergeFrom(std::unique_ptr<ModuleSummaryIndex> Other,
                                    uint64_t NextModuleId) {
+  // Vtables are recorded even for modules that have no summaries of their
+  // own, so merge them first.
+  for (auto &OtherTypeId : Other->typeIds()) {
+    TypeIdSummary &TypeId = TypeIdMap[OtherTypeId.first];
+    TypeId.Unknown |= OtherTypeId.second.Unknown;
+    for (auto &Slot : OtherTypeId.second.SlotTargets)
+      TypeId.SlotTargets[Slot.first].insert(Slot.second.begin(),
+                                            Slot.second.end());
+  }
+  Incomplete |= Other->isIncomplete();
+
   if (Other->modulePaths().empty())
     return;
 
@@ -104,3 +115,76 @@ ModuleSummaryIndex::getGlobalValueSummary(uint64_t ValueGUID,
   auto &Summary = SummaryList->second[0];
   return Summary.get();
 }
+
+void ModuleSummaryIndex::propagateAttributes(
+    function_ref<bool(GlobalValue::GUID)> IsPreserved) {
+  // Some accesses were not summarized, any variable may be written or read.
+  if (Incomplete)
+    return;
+
+  // Start from the optimistic answer for every variable whose accesses are all
+  // visible here. An interposable definition may not be the one the program
+  // ends up using, so it is left alone.
+  for (auto &P : GlobalValueMap) {
+    bool Candidate = !IsPreserved(P.first);
+    for (auto &S : P.second)
+      if (auto *GVS = dyn_cast<GlobalVarSummary>(S.get())) {
+        bool IsCandidate = Candidate && !GVS->hasSection() &&
+                           !GlobalValue::isInterposableLinkage(GVS->linkage());
+        GVS->setReadOnly(IsCandidate);
+        GVS->setWriteOnly(IsCandidate);
+      }
+  }
+
+  auto ClearAttributes = [&](GlobalValue::GUID GUID, bool ClearReadOnly,
+                             bool ClearWriteOnly) {
+    auto I = GlobalValueMap.find(GUID);
+    if (I == GlobalValueMap.end())
+      return;
+    for (auto &S : I->second)
+      if (auto *GVS = dyn_cast<GlobalVarSummary>(S.get())) {
+        if (ClearReadOnly)
+          GVS->setReadOnly(false);
+        if (ClearWriteOnly)
+          GVS->setWriteOnly(false);
+      }
+  };
+
+  for (auto &P : GlobalValueMap)
+    for (auto &S : P.second) {
+      // An alias lets the aliasee be accessed in any way.
+      if (auto *AS = dyn_cast<AliasSummary>(S.get())) {
+        if (auto *GVS = dyn_cast<GlobalVarSummary>(&AS->getAliasee())) {
+          GVS->setReadOnly(false);
+          GVS->setWriteOnly(false);
+        }
+        continue;
+      }
+      // Only functions classify their references; a reference from a
+      // variable's initializer makes the address escape.
+      auto *FS = dyn_cast<FunctionSummary>(S.get());
+      const auto &Refs = S->refs();
+      unsigned FirstReadOnly =
+          FS ? Refs.size() - FS->readOnlyRefCount() - FS->writeOnlyRefCount()
+             : Refs.size();
+      unsigned FirstWriteOnly =
+          FS ? FirstReadOnly + FS->readOnlyRefCount() : Refs.size();
+      for (unsigned I = 0, E = Refs.size(); I != E; ++I)
+        ClearAttributes(Refs[I].getGUID(),
+                        /*ClearReadOnly=*/I < FirstReadOnly ||
+                            I >= FirstWriteOnly,
+                        /*ClearWriteOnly=*/I < FirstWriteOnly);
+    }
+}
+
+StringRef ModuleSummaryIndex::getSingleImplementation(StringRef TypeId,
+                                                      uint64_t Offset) const {
+  auto I = TypeIdMap.find(TypeId);
+  if (I == TypeIdMap.end() || I->second.Unknown)
+    return "";
+  auto Slot = I->second.SlotTargets.find(Offset);
+  if (Slot == I->second.SlotTargets.end() || Slot->second.size() != 1)
+    return "";
+  // An empty name means some vtable holds something we cannot call directly.
+  return *Slot->second.begin();
+}
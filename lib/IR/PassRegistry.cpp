@@ -13,6 +13,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/PassRegistry.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/PassSupport.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -29,22 +31,112 @@ PassRegistry *PassRegistry::getPassRegistry() {
   return &*PassRegistryObj;
 }
 
+//===----------------------------------------------------------------------===//
+// Lookup tables
+//
+
+/// A table of PassInfo pointers with linear probing. Each bucket is written
+/// once while empty, or overwritten with a pass of the same key, with release
+/// semantics, so a reader that sees a PassInfo also sees its contents.
+struct PassRegistry::LookupTable {
+  unsigned NumBuckets;
+  unsigned NumEntries = 0;
+  std::unique_ptr<std::atomic<const PassInfo *>[]> Buckets;
+
+  explicit LookupTable(unsigned NumBuckets)
+      : NumBuckets(NumBuckets),
+        Buckets(new std::atomic<const PassInfo *>[NumBuckets]) {
+    for (unsigned i = 0; i != NumBuckets; ++i)
+      Buckets[i].store(nullptr, std::memory_order_relaxed);
+  }
+};
+
+static unsigned getKeyHash(const void *TI) {
+  return DenseMapInfo<const void *>::getHashValue(TI);
+}
+
+static unsigned getKeyHash(StringRef Arg) { return hash_value(Arg); }
+
+static bool hasKey(const PassInfo *PI, const void *TI) {
+  return PI->getTypeInfo() == TI;
+}
+
+static bool hasKey(const PassInfo *PI, StringRef Arg) {
+  return PI->getPassArgument() == Arg;
+}
+
+template <typename TableT, typename KeyT>
+static const PassInfo *lookupInTable(const std::atomic<TableT *> &Table,
+                                     KeyT Key) {
+  const TableT *T = Table.load(std::memory_order_acquire);
+  if (!T)
+    return nullptr;
+  unsigned Mask = T->NumBuckets - 1;
+  for (unsigned Bucket = getKeyHash(Key) & Mask;;
+       Bucket = (Bucket + 1) & Mask) {
+    const PassInfo *PI = T->Buckets[Bucket].load(std::memory_order_acquire);
+    if (!PI || hasKey(PI, Key))
+      return PI;
+  }
+}
+
+/// Put \p PI in the bucket for \p Key in \p T, replacing any pass with the
+/// same key. Returns true if the bucket was empty.
+template <typename TableT, typename KeyT>
+static bool insertIntoBucket(TableT &T, KeyT Key, const PassInfo &PI) {
+  unsigned Mask = T.NumBuckets - 1;
+  for (unsigned Bucket = getKeyHash(Key) & Mask;;
+       Bucket = (Bucket + 1) & Mask) {
+    const PassInfo *Old = T.Buckets[Bucket].load(std::memory_order_relaxed);
+    if (Old && !hasKey(Old, Key))
+      continue;
+    T.Buckets[Bucket].store(&PI, std::memory_order_release);
+    return !Old;
+  }
+}
+
+template <typename TableT>
+static bool insertPass(TableT &T, const PassInfo &PI, bool ByArg) {
+  if (ByArg)
+    return insertIntoBucket(T, PI.getPassArgument(), PI);
+  return insertIntoBucket(T, PI.getTypeInfo(), PI);
+}
+
+void PassRegistry::insertIntoTable(std::atomic<LookupTable *> &Table,
+                                   const PassInfo &PI, bool ByArg) {
+  LookupTable *T = Table.load(std::memory_order_relaxed);
+
+  // Keep the load factor under 3/4. Readers may be probing the old table, so
+  // fill a bigger copy and publish it once it is complete.
+  if (!T || (T->NumEntries + 1) * 4 > T->NumBuckets * 3) {
+    Tables.push_back(make_unique<LookupTable>(T ? T->NumBuckets * 2 : 256));
+    LookupTable *NewT = Tables.back().get();
+    if (T)
+      for (unsigned i = 0; i != T->NumBuckets; ++i)
+        if (const PassInfo *Old =
+                T->Buckets[i].load(std::memory_order_relaxed))
+          NewT->NumEntries += insertPass(*NewT, *Old, ByArg);
+    Table.store(NewT, std::memory_order_release);
+    T = NewT;
+  }
+
+  T->NumEntries += insertPass(*T, PI, ByArg);
+}
+
 //===----------------------------------------------------------------------===//
 // Accessors
 //
 
+PassRegistry::PassRegistry() : IDTable(nullptr), ArgTable(nullptr) {}
+
 PassRegistry::~PassRegistry() {}
 
 const PassInfo *PassRegistry::getPassInfo(const void *TI) const {
-  sys::SmartScopedReader<true> Guard(Lock);
-  MapType::const_iterator I = PassInfoMap.find(TI);
-  return I != PassInfoMap.end() ? I->second : nullptr;
+  return lookupInTable(IDTable, TI);
 }
 
 const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
-  sys::SmartScopedReader<true> Guard(Lock);
-  StringMapType::const_iterator I = PassInfoStringMap.find(Arg);
-  return I != PassInfoStringMap.end() ? I->second : nullptr;
+  return lookupInTable(ArgTable, Arg);
 }
 
 //===----------------------------------------------------------------------===//
@@ -52,12 +144,11 @@ const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
 //
 
 void PassRegistry::registerPass(const PassInfo &PI, bool ShouldFree) {
-  sys::SmartScopedWriter<true> Guard(Lock);
-  bool Inserted =
-      PassInfoMap.insert(std::make_pair(PI.getTypeInfo(), &PI)).second;
-  assert(Inserted && "Pass registered multiple times!");
-  (void)Inserted;
-  PassInfoStringMap[PI.getPassArgument()] = &PI;
+  sys::SmartScopedLock<true> Guard(Lock);
+  assert(!getPassInfo(PI.getTypeInfo()) && "Pass registered multiple times!");
+  Passes.push_back(&PI);
+  insertIntoTable(IDTable, PI, /*ByArg=*/false);
+  insertIntoTable(ArgTable, PI, /*ByArg=*/true);
 
   // Notify any listeners.
   for (auto *Listener : Listeners)
@@ -68,9 +159,9 @@ void PassRegistry::registerPass(const PassInfo &PI, bool ShouldFree) {
 }
 
 void PassRegistry::enumerateWith(PassRegistrationListener *L) {
-  sys::SmartScopedReader<true> Guard(Lock);
-  for (auto PassInfoPair : PassInfoMap)
-    L->passEnumerate(PassInfoPair.second);
+  sys::SmartScopedLock<true> Guard(Lock);
+  for (const PassInfo *PI : Passes)
+    L->passEnumerate(PI);
 }
 
 /// Analysis Group Mechanisms.
@@ -92,7 +183,7 @@ void PassRegistry::registerAnalysisGroup(const void *InterfaceID,
     assert(ImplementationInfo &&
            "Must register pass before adding to AnalysisGroup!");
 
-    sys::SmartScopedWriter<true> Guard(Lock);
+    sys::SmartScopedLock<true> Guard(Lock);
 
     // Make sure we keep track of the fact that the implementation implements
     // the interface.
@@ -115,12 +206,12 @@ void PassRegistry::registerAnalysisGroup(const void *InterfaceID,
 }
 
 void PassRegistry::addRegistrationListener(PassRegistrationListener *L) {
-  sys::SmartScopedWriter<true> Guard(Lock);
+  sys::SmartScopedLock<true> Guard(Lock);
   Listeners.push_back(L);
 }
 
 void PassRegistry::removeRegistrationListener(PassRegistrationListener *L) {
-  sys::SmartScopedWriter<true> Guard(Lock);
+  sys::SmartScopedLock<true> Guard(Lock);
 
   auto I = find(Listeners, L);
   Listeners.erase(I);
@@ -367,6 +367,13 @@ static bool contains(Value *Expr, Value *V) {
 }
 #endif // NDEBUG
 
+// Constants are uniqued, so a constant user cannot simply have its operand
+// reset; it has to be rebuilt by Constant::handleOperandChange.
+static bool hasNonGlobalConstantUser(const Use &U) {
+  auto *C = dyn_cast<Constant>(U.getUser());
+  return C && !isa<GlobalValue>(C);
+}
+
 void Value::replaceAllUsesWith(Value *New) {
   assert(New && "Value::replaceAllUsesWith(<null>) is invalid!");
   assert(!contains(New, this) &&
@@ -381,17 +388,31 @@ void Value::replaceAllUsesWith(Value *New) {
     ValueAsMetadata::handleRAUW(this, New);
 
   while (!use_empty()) {
-    Use &U = *UseList;
-    // Must handle Constants specially, we cannot call replaceUsesOfWith on a
-    // constant because they are uniqued.
-    if (auto *C = dyn_cast<Constant>(U.getUser())) {
-      if (!isa<GlobalValue>(C)) {
-        C->handleOperandChange(this, New);
-        continue;
-      }
+    if (hasNonGlobalConstantUser(*UseList)) {
+      cast<Constant>(UseList->getUser())->handleOperandChange(this, New);
+      continue;
     }
 
-    U.set(New);
+    // Move the run of uses up to the next constant user over to New in a
+    // single pass.  Each use is pushed onto the front of New's list in turn,
+    // which gives the same use-list order as calling Use::set on each, but
+    // skips re-linking this value's list after every use.
+    Use *NewHead = New->UseList;
+    Use *U = UseList;
+    do {
+      Use *Next = U->Next;
+      U->Val = New;
+      U->Next = NewHead;
+      if (NewHead)
+        NewHead->setPrev(&U->Next);
+      NewHead = U;
+      U = Next;
+    } while (U && !hasNonGlobalConstantUser(*U));
+    New->UseList = NewHead;
+    NewHead->setPrev(&New->UseList);
+    UseList = U;
+    if (U)
+      U->setPrev(&UseList);
   }
 
   if (BasicBlock *BB = dyn_cast<BasicBlock>(this))
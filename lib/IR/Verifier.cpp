@@ -94,6 +94,7 @@
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Statepoint.h"
 #include "llvm/IR/Type.h"
+#include "llvm/IR/TypeFinder.h"
 #include "llvm/IR/Use.h"
 #include "llvm/IR/User.h"
 #include "llvm/IR/Value.h"
@@ -105,11 +106,14 @@
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -117,6 +121,11 @@ using namespace llvm;
 
 static cl::opt<bool> VerifyDebugInfo("verify-debug-info", cl::init(true));
 
+static cl::opt<unsigned> VerifyThreads(
+    "verify-threads", cl::Hidden, cl::init(1),
+    cl::desc("Number of threads verifyModule checks functions on "
+             "(0 = hardware concurrency)"));
+
 namespace {
 
 struct VerifierSupport {
@@ -285,6 +294,22 @@ class Verifier : public InstVisitor<Verifier>, VerifierSupport {
   // constant expressions, we can arrive at a particular user many times.
   SmallPtrSet<const Value *, 32> GlobalValueVisited;
 
+  /// If functions are verified on several threads, the mutex that guards the
+  /// few checks that may create types or attribute sets in the context.
+  std::mutex *ContextMutex = nullptr;
+
+  std::unique_lock<std::mutex> lockContext() {
+    return ContextMutex ? std::unique_lock<std::mutex>(*ContextMutex)
+                        : std::unique_lock<std::mutex>();
+  }
+
+  /// Whether metadata nodes reached from functions are only collected in
+  /// DeferredMDNodes, to be checked by the verifier of the whole module, rather
+  /// than checked here. A node shared by functions verified on different
+  /// threads is then checked, and reported, once.
+  bool DeferMDNodes = false;
+  SmallVector<const MDNode *, 16> DeferredMDNodes;
+
   void checkAtomicMemAccessSize(Type *Ty, const Instruction *I);
 
 public:
@@ -297,6 +322,25 @@ public:
 
   bool hasBrokenDebugInfo() const { return BrokenDebugInfo; }
 
+  void setContextMutex(std::mutex *M) { ContextMutex = M; }
+  void setDeferMDNodes() { DeferMDNodes = true; }
+
+  /// Fold the module level state that \p V collected while verifying
+  /// functions into this verifier, as if it had verified them itself. This
+  /// checks the metadata nodes \p V deferred.
+  void mergeFunctionState(const Verifier &V) {
+    for (const MDNode *N : V.DeferredMDNodes)
+      visitMDNode(*N);
+    MDNodes.insert(V.MDNodes.begin(), V.MDNodes.end());
+    CUVisited.insert(V.CUVisited.begin(), V.CUVisited.end());
+    for (const auto &Counts : V.FrameEscapeInfo) {
+      auto &Entry = FrameEscapeInfo[Counts.first];
+      Entry.first = std::max(Entry.first, Counts.second.first);
+      Entry.second = std::max(Entry.second, Counts.second.second);
+    }
+    BrokenDebugInfo |= V.BrokenDebugInfo;
+  }
+
   bool verify(const Function &F) {
     assert(F.getParent() == &M &&
            "An instance of this class only works with a specific module!");
@@ -720,6 +764,10 @@ void Verifier::visitMDNode(const MDNode &MD) {
   // avoids infinite recursion here, as well as being an optimization.
   if (!MDNodes.insert(&MD).second)
     return;
+  if (DeferMDNodes) {
+    DeferredMDNodes.push_back(&MD);
+    return;
+  }
 
   switch (MD.getMetadataID()) {
   default:
@@ -1426,12 +1474,16 @@ void Verifier::verifyParameterAttrs(AttributeSet Attrs, unsigned Idx, Type *Ty,
          "'noinline and alwaysinline' are incompatible!",
          V);
 
-  Assert(
-      !AttrBuilder(Attrs, Idx).overlaps(AttributeFuncs::typeIncompatible(Ty)),
-      "Wrong types for attribute: " +
-          AttributeSet::get(Context, Idx, AttributeFuncs::typeIncompatible(Ty))
-              .getAsString(Idx),
-      V);
+  if (AttrBuilder(Attrs, Idx).overlaps(AttributeFuncs::typeIncompatible(Ty))) {
+    auto Lock = lockContext();
+    CheckFailed(
+        "Wrong types for attribute: " +
+            AttributeSet::get(Context, Idx,
+                              AttributeFuncs::typeIncompatible(Ty))
+                .getAsString(Idx),
+        V);
+    return;
+  }
 
   if (PointerType *PTy = dyn_cast<PointerType>(Ty)) {
     SmallPtrSet<Type*, 4> Visited;
@@ -3835,13 +3887,17 @@ void Verifier::visitIntrinsicCallSite(Intrinsic::ID ID, CallSite CS) {
   ArrayRef<Intrinsic::IITDescriptor> TableRef = Table;
 
   SmallVector<Type *, 4> ArgTys;
-  Assert(!Intrinsic::matchIntrinsicType(IFTy->getReturnType(),
-                                        TableRef, ArgTys),
-         "Intrinsic has incorrect return type!", IF);
-  for (unsigned i = 0, e = IFTy->getNumParams(); i != e; ++i)
-    Assert(!Intrinsic::matchIntrinsicType(IFTy->getParamType(i),
+  {
+    // Matching may create the vector types it compares against.
+    auto Lock = lockContext();
+    Assert(!Intrinsic::matchIntrinsicType(IFTy->getReturnType(),
                                           TableRef, ArgTys),
-           "Intrinsic has incorrect argument type!", IF);
+           "Intrinsic has incorrect return type!", IF);
+    for (unsigned i = 0, e = IFTy->getNumParams(); i != e; ++i)
+      Assert(!Intrinsic::matchIntrinsicType(IFTy->getParamType(i),
+                                            TableRef, ArgTys),
+             "Intrinsic has incorrect argument type!", IF);
+  }
 
   // Verify if the intrinsic call matches the vararg property.
   if (IsVarArg)
@@ -4377,14 +4433,80 @@ bool llvm::verifyFunction(const Function &f, raw_ostream *OS) {
   return !V.verify(F);
 }
 
+/// Verify the functions of \p M on \p NumThreads threads and fold the module
+/// level state they collect into \p V. Each thread verifies a contiguous range
+/// of functions with its own Verifier. Once all are done, each range's messages
+/// are written out and the metadata it reached is checked by \p V, in function
+/// order, so the output does not depend on scheduling and a node shared by
+/// several ranges is reported once.
+static bool verifyFunctionsInParallel(const Module &M, raw_ostream *OS,
+                                      bool TreatBrokenDebugInfoAsError,
+                                      Verifier &V, unsigned NumThreads) {
+  std::vector<const Function *> Functions;
+  Functions.reserve(M.size());
+  for (const Function &F : M)
+    Functions.push_back(&F);
+
+  // Some EH pad checks compare against the token none constant, and
+  // Type::isSized caches its answer in struct types. Do both before any
+  // thread does.
+  ConstantTokenNone::get(M.getContext());
+  TypeFinder StructTypes;
+  StructTypes.run(M, /*onlyNamed=*/false);
+  for (StructType *STy : StructTypes)
+    STy->isSized();
+
+  const size_t NumRanges = std::min<size_t>(4 * NumThreads, Functions.size());
+  std::vector<std::string> Messages(NumRanges);
+  std::vector<std::unique_ptr<raw_string_ostream>> RangeOS;
+  std::vector<std::unique_ptr<Verifier>> RangeVs;
+  std::vector<char> RangeBroken(NumRanges);
+  std::mutex ContextMutex;
+  for (size_t I = 0; I != NumRanges; ++I) {
+    RangeOS.push_back(llvm::make_unique<raw_string_ostream>(Messages[I]));
+    // Don't use a raw_null_ostream.  Printing IR is expensive.
+    RangeVs.push_back(llvm::make_unique<Verifier>(
+        OS ? RangeOS.back().get() : nullptr, TreatBrokenDebugInfoAsError, M));
+    RangeVs.back()->setContextMutex(&ContextMutex);
+    RangeVs.back()->setDeferMDNodes();
+  }
+
+  {
+    ThreadPool Pool(NumThreads);
+    for (size_t I = 0; I != NumRanges; ++I)
+      Pool.async([&, I] {
+        size_t Begin = Functions.size() * I / NumRanges;
+        size_t End = Functions.size() * (I + 1) / NumRanges;
+        for (size_t F = Begin; F != End; ++F)
+          RangeBroken[I] |= !RangeVs[I]->verify(*Functions[F]);
+      });
+  }
+
+  bool Broken = false;
+  for (size_t I = 0; I != NumRanges; ++I) {
+    RangeOS[I]->flush();
+    if (OS)
+      *OS << Messages[I];
+    Broken |= RangeBroken[I];
+    V.mergeFunctionState(*RangeVs[I]);
+  }
+  return Broken;
+}
+
 bool llvm::verifyModule(const Module &M, raw_ostream *OS,
                         bool *BrokenDebugInfo) {
   // Don't use a raw_null_ostream.  Printing IR is expensive.
   Verifier V(OS, /*ShouldTreatBrokenDebugInfoAsError=*/!BrokenDebugInfo, M);
 
   bool Broken = false;
-  for (const Function &F : M)
-    Broken |= !V.verify(F);
+  unsigned NumThreads = VerifyThreads ? unsigned(VerifyThreads)
+                                      : heavyweight_hardware_concurrency();
+  if (NumThreads > 1 && M.size() > 1)
+    Broken |=
+        verifyFunctionsInParallel(M, OS, !BrokenDebugInfo, V, NumThreads);
+  else
+    for (const Function &F : M)
+      Broken |= !V.verify(F);
 
   Broken |= !V.verify();
   if (BrokenDebugInfo)
@@ -21,7 +21,9 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/LTO/LTOBackend.h"
 #include "llvm/Linker/IRMover.h"
+#include "llvm/Object/FlatSummaryIndex.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -95,6 +97,23 @@ static void computeCacheKey(
         ArrayRef<uint8_t>((const uint8_t *)&Linkage, sizeof(Linkage)));
   }
 
+  // Include the attributes the thin link computed for the variables defined
+  // or imported by the module, as they depend on what every module does.
+  auto AddVarFlags = [&](GlobalValue::GUID GUID, const GlobalValueSummary *S) {
+    auto *GVS = dyn_cast_or_null<GlobalVarSummary>(S);
+    if (!GVS)
+      return;
+    uint8_t Flags = GVS->isReadOnly() | (GVS->isWriteOnly() << 1);
+    Hasher.update(ArrayRef<uint8_t>((const uint8_t *)&GUID, sizeof(GUID)));
+    Hasher.update(ArrayRef<uint8_t>(&Flags, 1));
+  };
+  for (auto &GS : DefinedGlobals)
+    AddVarFlags(GS.first, GS.second);
+  for (auto &Entry : ImportList)
+    for (auto &Import : Entry.second)
+      AddVarFlags(Import.first,
+                  Index.findSummaryInModule(Import.first, Entry.first()));
+
   Key = toHex(Hasher.result());
 }
 
@@ -251,6 +270,8 @@ void LTO::addSymbolToGlobalRes(IRObjectFile *Obj,
     if (Res.Prevailing)
       GlobalRes.IRName = GV->getName();
   }
+  if (Res.VisibleToRegularObj || (GV && Used.count(GV)) || Partition == 0)
+    GlobalRes.VisibleOutsideThinLTO = true;
   if (Res.VisibleToRegularObj || (GV && Used.count(GV)) ||
       (GlobalRes.Partition != GlobalResolution::Unknown &&
        GlobalRes.Partition != Partition))
@@ -499,6 +520,9 @@ public:
         ModuleToDefinedGVSummaries(ModuleToDefinedGVSummaries) {}
 
   virtual ~ThinBackendProc() {}
+  /// The number of threads the backend runs jobs on. The work that prepares
+  /// those jobs uses as many.
+  virtual unsigned getThreadCount() const { return 1; }
   virtual Error start(
       unsigned Task, MemoryBufferRef MBRef,
       const FunctionImporter::ImportMapTy &ImportList,
@@ -509,6 +533,7 @@ public:
 };
 
 class InProcessThinBackend : public ThinBackendProc {
+  unsigned ThreadCount;
   ThreadPool BackendThreadPool;
   AddStreamFn AddStream;
   NativeObjectCache Cache;
@@ -523,9 +548,12 @@ public:
       const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
       AddStreamFn AddStream, NativeObjectCache Cache)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        ThreadCount(ThinLTOParallelismLevel),
         BackendThreadPool(ThinLTOParallelismLevel),
         AddStream(std::move(AddStream)), Cache(std::move(Cache)) {}
 
+  unsigned getThreadCount() const override { return ThreadCount; }
+
   Error runThinLTOBackendThread(
       AddStreamFn AddStream, NativeObjectCache Cache, unsigned Task,
       MemoryBufferRef MBRef, ModuleSummaryIndex &CombinedIndex,
@@ -640,6 +668,7 @@ std::string lto::getThinLTOOutputFile(const std::string &Path,
 class WriteIndexesThinBackend : public ThinBackendProc {
   std::string OldPrefix, NewPrefix;
   bool ShouldEmitImportsFiles;
+  bool WriteFlatIndex;
 
   std::string LinkedObjectsFileName;
   std::unique_ptr<llvm::raw_fd_ostream> LinkedObjectsFile;
@@ -649,10 +678,11 @@ public:
       Config &Conf, ModuleSummaryIndex &CombinedIndex,
       const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
       std::string OldPrefix, std::string NewPrefix, bool ShouldEmitImportsFiles,
-      std::string LinkedObjectsFileName)
+      std::string LinkedObjectsFileName, bool WriteFlatIndex)
       : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
         OldPrefix(OldPrefix), NewPrefix(NewPrefix),
         ShouldEmitImportsFiles(ShouldEmitImportsFiles),
+        WriteFlatIndex(WriteFlatIndex),
         LinkedObjectsFileName(LinkedObjectsFileName) {}
 
   Error start(
@@ -680,11 +710,15 @@ public:
     gatherImportedSummariesForModule(ModulePath, ModuleToDefinedGVSummaries,
                                      ImportList, ModuleToSummariesForIndex);
 
-    raw_fd_ostream OS(NewModulePath + ".thinlto.bc", EC,
-                      sys::fs::OpenFlags::F_None);
+    raw_fd_ostream OS(NewModulePath +
+                          (WriteFlatIndex ? ".thinlto.fsi" : ".thinlto.bc"),
+                      EC, sys::fs::OpenFlags::F_None);
     if (EC)
       return errorCodeToError(EC);
-    WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    if (WriteFlatIndex)
+      FlatSummaryIndex::write(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    else
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
 
     if (ShouldEmitImportsFiles)
       return errorCodeToError(
@@ -698,13 +732,290 @@ public:
 ThinBackend lto::createWriteIndexesThinBackend(std::string OldPrefix,
                                                std::string NewPrefix,
                                                bool ShouldEmitImportsFiles,
-                                               std::string LinkedObjectsFile) {
+                                               std::string LinkedObjectsFile,
+                                               bool WriteFlatIndex) {
   return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
              const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
              AddStreamFn AddStream, NativeObjectCache Cache) {
     return llvm::make_unique<WriteIndexesThinBackend>(
         Conf, CombinedIndex, ModuleToDefinedGVSummaries, OldPrefix, NewPrefix,
-        ShouldEmitImportsFiles, LinkedObjectsFile);
+        ShouldEmitImportsFiles, LinkedObjectsFile, WriteFlatIndex);
+  };
+}
+
+// A serialized ThinBackendJob is the magic string, the task number and the
+// number of entries, followed by the entries. Each entry is a kind byte, a
+// name and a blob of data; all integers are little endian.
+static const char ThinBackendJobMagic[8] = {'T', 'L', 'T', 'O',
+                                            'J', 'O', 'B', 1};
+
+namespace {
+enum ThinBackendJobEntryKind : uint8_t {
+  JOB_MODULE = 0,          // name: module ID, data: bitcode
+  JOB_INDEX = 1,           // data: per-module index bitcode
+  JOB_IMPORTED_MODULE = 2, // name: module ID, data: bitcode
+  JOB_IMPORT_LIST = 3,     // name: module ID, data: [guid u64, threshold u32]*
+};
+}
+
+void lto::writeThinBackendJob(const ThinBackendJob &Job, raw_ostream &OS) {
+  support::endian::Writer<support::little> W(OS);
+  auto WriteEntry = [&](ThinBackendJobEntryKind Kind, StringRef Name,
+                        StringRef Data) {
+    W.write<uint8_t>(Kind);
+    W.write<uint32_t>(Name.size());
+    OS << Name;
+    W.write<uint64_t>(Data.size());
+    OS << Data;
+  };
+
+  OS << StringRef(ThinBackendJobMagic, sizeof(ThinBackendJobMagic));
+  W.write<uint32_t>(Job.Task);
+  W.write<uint32_t>(2 + Job.ImportedModules.size() + Job.ImportList.size());
+  WriteEntry(JOB_MODULE, Job.Module.getBufferIdentifier(),
+             Job.Module.getBuffer());
+  WriteEntry(JOB_INDEX, "", Job.Index);
+  for (auto &I : Job.ImportedModules)
+    WriteEntry(JOB_IMPORTED_MODULE, I.first, I.second.getBuffer());
+
+  // Emit the import list in a stable order so that identical jobs serialize
+  // identically.
+  std::vector<StringRef> ImportedFrom;
+  for (auto &I : Job.ImportList)
+    ImportedFrom.push_back(I.first());
+  std::sort(ImportedFrom.begin(), ImportedFrom.end());
+  for (StringRef Name : ImportedFrom) {
+    std::string Data;
+    raw_string_ostream DataOS(Data);
+    support::endian::Writer<support::little> DataW(DataOS);
+    for (auto &F : Job.ImportList.find(Name)->second) {
+      DataW.write<uint64_t>(F.first);
+      DataW.write<uint32_t>(F.second);
+    }
+    WriteEntry(JOB_IMPORT_LIST, Name, DataOS.str());
+  }
+}
+
+template <typename T> static bool readJobInt(StringRef &Data, T &V) {
+  if (Data.size() < sizeof(T))
+    return false;
+  V = support::endian::read<T, support::little>(Data.data());
+  Data = Data.drop_front(sizeof(T));
+  return true;
+}
+
+template <typename T>
+static bool readJobString(StringRef &Data, StringRef &S) {
+  T Size;
+  if (!readJobInt(Data, Size) || Data.size() < Size)
+    return false;
+  S = Data.take_front(Size);
+  Data = Data.drop_front(Size);
+  return true;
+}
+
+Expected<ThinBackendJob> lto::readThinBackendJob(MemoryBufferRef Buffer) {
+  auto Malformed = [&]() {
+    return make_error<StringError>("malformed ThinLTO backend job '" +
+                                       Buffer.getBufferIdentifier() + "'",
+                                   inconvertibleErrorCode());
+  };
+
+  StringRef Data = Buffer.getBuffer();
+  StringRef Magic(ThinBackendJobMagic, sizeof(ThinBackendJobMagic));
+  if (!Data.startswith(Magic))
+    return Malformed();
+  Data = Data.drop_front(Magic.size());
+
+  ThinBackendJob Job;
+  uint32_t Task, NumEntries;
+  if (!readJobInt(Data, Task) || !readJobInt(Data, NumEntries))
+    return Malformed();
+  Job.Task = Task;
+
+  bool SeenModule = false, SeenIndex = false;
+  for (uint32_t I = 0; I != NumEntries; ++I) {
+    uint8_t Kind;
+    StringRef Name, Blob;
+    if (!readJobInt(Data, Kind) || !readJobString<uint32_t>(Data, Name) ||
+        !readJobString<uint64_t>(Data, Blob))
+      return Malformed();
+
+    switch (Kind) {
+    case JOB_MODULE:
+      if (SeenModule)
+        return Malformed();
+      SeenModule = true;
+      Job.Module = MemoryBufferRef(Blob, Name);
+      break;
+    case JOB_INDEX:
+      if (SeenIndex)
+        return Malformed();
+      SeenIndex = true;
+      Job.Index = Blob;
+      break;
+    case JOB_IMPORTED_MODULE:
+      Job.ImportedModules[Name] = MemoryBufferRef(Blob, Name);
+      break;
+    case JOB_IMPORT_LIST: {
+      FunctionImporter::FunctionsToImportTy &Functions = Job.ImportList[Name];
+      while (!Blob.empty()) {
+        uint64_t GUID;
+        uint32_t Threshold;
+        if (!readJobInt(Blob, GUID) || !readJobInt(Blob, Threshold))
+          return Malformed();
+        Functions[GUID] = Threshold;
+      }
+      break;
+    }
+    default:
+      return Malformed();
+    }
+  }
+
+  if (!SeenModule || !SeenIndex || !Data.empty())
+    return Malformed();
+  return std::move(Job);
+}
+
+Error lto::runThinBackendJob(Config &C, const ThinBackendJob &Job,
+                             AddStreamFn AddStream) {
+  StringRef ModulePath = Job.Module.getBufferIdentifier();
+  ErrorOr<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+      getModuleSummaryIndex(MemoryBufferRef(Job.Index, ModulePath),
+                            C.DiagHandler);
+  if (!IndexOrErr)
+    return errorCodeToError(IndexOrErr.getError());
+  ModuleSummaryIndex &Index = **IndexOrErr;
+
+  StringMap<GVSummaryMapTy> ModuleToDefinedGVSummaries;
+  Index.collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
+
+  LTOLLVMContext BackendContext(C);
+  ErrorOr<std::unique_ptr<Module>> MOrErr =
+      parseBitcodeFile(Job.Module, BackendContext);
+  if (!MOrErr)
+    return errorCodeToError(MOrErr.getError());
+
+  MapVector<StringRef, MemoryBufferRef> ModuleMap = Job.ImportedModules;
+  return thinBackend(C, Job.Task, AddStream, **MOrErr, Index, Job.ImportList,
+                     ModuleToDefinedGVSummaries[ModulePath], ModuleMap);
+}
+
+class OutOfProcessThinBackend : public ThinBackendProc {
+  unsigned ThreadCount;
+  ThreadPool BackendThreadPool;
+  AddStreamFn AddStream;
+  NativeObjectCache Cache;
+  ThinBackendJobRunner Runner;
+
+  Optional<Error> Err;
+  std::mutex ErrMu;
+
+public:
+  OutOfProcessThinBackend(
+      Config &Conf, ModuleSummaryIndex &CombinedIndex,
+      const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+      AddStreamFn AddStream, NativeObjectCache Cache,
+      ThinBackendJobRunner Runner, unsigned MaxJobsInFlight)
+      : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        ThreadCount(MaxJobsInFlight), BackendThreadPool(MaxJobsInFlight),
+        AddStream(std::move(AddStream)), Cache(std::move(Cache)),
+        Runner(std::move(Runner)) {}
+
+  unsigned getThreadCount() const override { return ThreadCount; }
+
+  Error runJob(AddStreamFn OutStream, unsigned Task, MemoryBufferRef MBRef,
+               const FunctionImporter::ImportMapTy &ImportList,
+               const MapVector<StringRef, MemoryBufferRef> &ModuleMap) {
+    // Prune the combined index down to what this backend will look at, the
+    // same way WriteIndexesThinBackend does for distributed builds.
+    std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+    gatherImportedSummariesForModule(MBRef.getBufferIdentifier(),
+                                     ModuleToDefinedGVSummaries, ImportList,
+                                     ModuleToSummariesForIndex);
+    SmallString<0> IndexBuffer;
+    {
+      raw_svector_ostream OS(IndexBuffer);
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    }
+
+    ThinBackendJob Job;
+    Job.Task = Task;
+    Job.Module = MBRef;
+    Job.Index = IndexBuffer;
+    Job.ImportList = ImportList;
+    for (auto &Entry : ImportList) {
+      auto I = ModuleMap.find(Entry.first());
+      assert(I != ModuleMap.end() && "Importing from an unknown module?");
+      Job.ImportedModules.insert(*I);
+    }
+
+    Expected<std::unique_ptr<MemoryBuffer>> ObjOrErr = Runner(Job);
+    if (!ObjOrErr)
+      return ObjOrErr.takeError();
+    *OutStream(Task)->OS << (*ObjOrErr)->getBuffer();
+    return Error();
+  }
+
+  Error start(
+      unsigned Task, MemoryBufferRef MBRef,
+      const FunctionImporter::ImportMapTy &ImportList,
+      const FunctionImporter::ExportSetTy &ExportList,
+      const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
+      MapVector<StringRef, MemoryBufferRef> &ModuleMap) override {
+    StringRef ModulePath = MBRef.getBufferIdentifier();
+    assert(ModuleToDefinedGVSummaries.count(ModulePath));
+    const GVSummaryMapTy &DefinedGlobals =
+        ModuleToDefinedGVSummaries.find(ModulePath)->second;
+
+    // Consult the cache up front: a hit needs no job at all.
+    AddStreamFn OutStream = AddStream;
+    if (Cache && CombinedIndex.modulePaths().count(ModulePath) &&
+        !all_of(CombinedIndex.getModuleHash(ModulePath),
+                [](uint32_t V) { return V == 0; })) {
+      SmallString<40> Key;
+      computeCacheKey(Key, CombinedIndex, ModulePath, ImportList, ExportList,
+                      ResolvedODR, DefinedGlobals);
+      OutStream = Cache(Task, Key);
+      if (!OutStream)
+        return Error();
+    }
+
+    BackendThreadPool.async(
+        [=](MemoryBufferRef MBRef,
+            const FunctionImporter::ImportMapTy &ImportList,
+            const MapVector<StringRef, MemoryBufferRef> &ModuleMap) {
+          Error E = runJob(OutStream, Task, MBRef, ImportList, ModuleMap);
+          if (E) {
+            std::unique_lock<std::mutex> L(ErrMu);
+            if (Err)
+              Err = joinErrors(std::move(*Err), std::move(E));
+            else
+              Err = std::move(E);
+          }
+        },
+        MBRef, std::ref(ImportList), std::cref(ModuleMap));
+    return Error();
+  }
+
+  Error wait() override {
+    BackendThreadPool.wait();
+    if (Err)
+      return std::move(*Err);
+    else
+      return Error();
+  }
+};
+
+ThinBackend lto::createOutOfProcessThinBackend(ThinBackendJobRunner Runner,
+                                               unsigned MaxJobsInFlight) {
+  return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return llvm::make_unique<OutOfProcessThinBackend>(
+        Conf, CombinedIndex, ModuleToDefinedGVSummaries, AddStream, Cache,
+        Runner, MaxJobsInFlight);
   };
 }
 
@@ -733,13 +1044,6 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
     if (!ModuleToDefinedGVSummaries.count(Mod.first))
       ModuleToDefinedGVSummaries.try_emplace(Mod.first);
 
-  StringMap<FunctionImporter::ImportMapTy> ImportLists(
-      ThinLTO.ModuleMap.size());
-  StringMap<FunctionImporter::ExportSetTy> ExportLists(
-      ThinLTO.ModuleMap.size());
-  ComputeCrossModuleImport(ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
-                           ImportLists, ExportLists);
-
   std::set<GlobalValue::GUID> ExportedGUIDs;
   for (auto &Res : GlobalResolutions) {
     if (!Res.second.IRName.empty() &&
@@ -747,6 +1051,43 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
       ExportedGUIDs.insert(GlobalValue::getGUID(Res.second.IRName));
   }
 
+  // Find the global variables that are only read or only written, which
+  // requires a summary of every access. Cross-module references between
+  // ThinLTO modules are visible in the summaries, so only symbols used outside
+  // of the ThinLTO partitions need to be preserved.
+  if (ThinLTO.CombinedIndex.modulePaths().size() == ThinLTO.ModuleMap.size()) {
+    DenseSet<GlobalValue::GUID> VisibleOutsideThinLTO;
+    for (auto &Res : GlobalResolutions)
+      if (!Res.second.IRName.empty() && Res.second.VisibleOutsideThinLTO)
+        VisibleOutsideThinLTO.insert(GlobalValue::getGUID(Res.second.IRName));
+    ThinLTO.CombinedIndex.propagateAttributes([&](GlobalValue::GUID GUID) {
+      return VisibleOutsideThinLTO.count(GUID);
+    });
+  }
+
+  std::unique_ptr<ThinBackendProc> BackendProc =
+      ThinLTO.Backend(Conf, ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
+                      AddStream, Cache);
+
+  StringMap<FunctionImporter::ImportMapTy> ImportLists(
+      ThinLTO.ModuleMap.size());
+  StringMap<FunctionImporter::ExportSetTy> ExportLists(
+      ThinLTO.ModuleMap.size());
+  ComputeCrossModuleImport(ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
+                           ImportLists, ExportLists,
+                           BackendProc->getThreadCount());
+
+  // The backends devirtualize calls using the type identifiers in the combined
+  // index, which only describe the whole program if no vtable was sent to the
+  // regular LTO partition. Otherwise, the targets they name may be referenced
+  // from any module and must survive internalization.
+  if (HasRegularLTO)
+    ThinLTO.CombinedIndex.typeIds().clear();
+  for (auto &TypeId : ThinLTO.CombinedIndex.typeIds())
+    for (auto &Slot : TypeId.second.SlotTargets)
+      if (Slot.second.size() == 1 && !Slot.second.begin()->empty())
+        ExportedGUIDs.insert(GlobalValue::getGUID(*Slot.second.begin()));
+
   auto isPrevailing = [&](GlobalValue::GUID GUID, const GlobalValueSummary *S) {
     return ThinLTO.PrevailingModuleForGUID[GUID] == S->modulePath();
   };
@@ -768,10 +1109,6 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
   thinLTOResolveWeakForLinkerInIndex(ThinLTO.CombinedIndex, isPrevailing,
                                      recordNewLinkage);
 
-  std::unique_ptr<ThinBackendProc> BackendProc =
-      ThinLTO.Backend(Conf, ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
-                      AddStream, Cache);
-
   // Partition numbers for ThinLTO jobs start at 1 (see comments for
   // GlobalResolution in LTO.h). Task numbers, however, start at
   // ParallelCodeGenParallelismLevel if an LTO module is present, as tasks 0
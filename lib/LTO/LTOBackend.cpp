@@ -16,12 +16,18 @@
 
 #include "llvm/LTO/LTOBackend.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/LoopPassManager.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Mangler.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/LTO/LTO.h"
@@ -35,12 +41,18 @@
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/IPO/WholeProgramDevirt.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
 
 using namespace llvm;
 using namespace lto;
 
+static cl::opt<unsigned> FunctionOrderClusterSize(
+    "lto-function-order-cluster-size", cl::init(1024), cl::Hidden,
+    cl::desc("Maximum number of IR instructions in a cluster of functions "
+             "formed for profile-guided function ordering"));
+
 LLVM_ATTRIBUTE_NORETURN static void reportOpenError(StringRef Path, Twine Msg) {
   errs() << "failed to open " << Path << ": " << Msg << '\n';
   errs().flush();
@@ -252,7 +264,9 @@ void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
             // copied into the thread's context.
             std::move(BC), ThreadCount++);
       },
-      false);
+      // Balance the partitions by size. They come heaviest first, so the
+      // pool starts on the ones that take longest.
+      false, /*BalanceBySize=*/true);
 
   // Because the inner lambda (which runs in a worker thread) captures our local
   // variables, we need to wait for the worker threads to terminate before we
@@ -275,6 +289,139 @@ Expected<const Target *> initAndLookupTarget(Config &C, Module &Mod) {
 
 }
 
+namespace {
+/// A sequence of functions which are laid out next to each other.
+struct FunctionCluster {
+  std::vector<Function *> Functions;
+  uint64_t Size = 0;
+  uint64_t Count = 0;
+};
+}
+
+/// Compute an order for the functions of Mod which have a non-zero entry
+/// count, using call-chain clustering (C3, "Optimizing Function Placement for
+/// Large-Scale Data-Center Applications", Ottoni and Maher, CGO 2017).
+///
+/// Every hot function starts in its own cluster. Going from the hottest to the
+/// coldest function, the cluster of each function is appended to the cluster
+/// of its most frequent caller, unless the merged cluster would grow larger
+/// than FunctionOrderClusterSize. The clusters are then sorted by decreasing
+/// density, i.e. entry count per instruction.
+static std::vector<Function *> computeHotFunctionOrder(Module &Mod) {
+  std::vector<Function *> HotFunctions;
+  for (Function &F : Mod) {
+    if (F.isDeclaration())
+      continue;
+    Optional<uint64_t> EntryCount = F.getEntryCount();
+    if (EntryCount && *EntryCount)
+      HotFunctions.push_back(&F);
+  }
+
+  // Create the initial clusters and find the most frequent caller of each hot
+  // function. The weight of a call edge is the profile count of the block
+  // containing the call.
+  std::vector<FunctionCluster> Clusters(HotFunctions.size());
+  DenseMap<Function *, FunctionCluster *> FunctionToCluster;
+  DenseMap<Function *, std::pair<Function *, uint64_t>> HottestCaller;
+  for (unsigned I = 0, E = HotFunctions.size(); I != E; ++I) {
+    Function *Caller = HotFunctions[I];
+    FunctionCluster &C = Clusters[I];
+    C.Functions.push_back(Caller);
+    C.Count = *Caller->getEntryCount();
+    FunctionToCluster[Caller] = &C;
+
+    DominatorTree DT(*Caller);
+    LoopInfo LI(DT);
+    BranchProbabilityInfo BPI(*Caller, LI);
+    BlockFrequencyInfo BFI(*Caller, BPI, LI);
+    for (BasicBlock &BB : *Caller) {
+      C.Size += BB.size();
+      Optional<uint64_t> BlockCount = BFI.getBlockProfileCount(&BB);
+      if (!BlockCount || !*BlockCount)
+        continue;
+      for (Instruction &Inst : BB) {
+        CallSite CS(&Inst);
+        if (!CS)
+          continue;
+        Function *Callee = CS.getCalledFunction();
+        if (!Callee || Callee == Caller || Callee->isDeclaration())
+          continue;
+        auto &Hottest = HottestCaller[Callee];
+        if (*BlockCount > Hottest.second)
+          Hottest = std::make_pair(Caller, *BlockCount);
+      }
+    }
+  }
+
+  std::stable_sort(HotFunctions.begin(), HotFunctions.end(),
+                   [](Function *A, Function *B) {
+                     return *A->getEntryCount() > *B->getEntryCount();
+                   });
+  for (Function *F : HotFunctions) {
+    Function *Caller = HottestCaller.lookup(F).first;
+    if (!Caller || !FunctionToCluster.count(Caller))
+      continue;
+    FunctionCluster *CallerC = FunctionToCluster[Caller];
+    FunctionCluster *CalleeC = FunctionToCluster[F];
+    if (CallerC == CalleeC ||
+        CallerC->Size + CalleeC->Size > FunctionOrderClusterSize)
+      continue;
+    for (Function *CalleeF : CalleeC->Functions) {
+      CallerC->Functions.push_back(CalleeF);
+      FunctionToCluster[CalleeF] = CallerC;
+    }
+    CallerC->Size += CalleeC->Size;
+    CallerC->Count += CalleeC->Count;
+    CalleeC->Functions.clear();
+  }
+
+  std::vector<FunctionCluster *> SortedClusters;
+  for (FunctionCluster &C : Clusters)
+    if (!C.Functions.empty())
+      SortedClusters.push_back(&C);
+  std::stable_sort(SortedClusters.begin(), SortedClusters.end(),
+                   [](FunctionCluster *A, FunctionCluster *B) {
+                     // Compare A.Count / A.Size > B.Count / B.Size without
+                     // dividing.
+                     return (double)A->Count * std::max<uint64_t>(B->Size, 1) >
+                            (double)B->Count * std::max<uint64_t>(A->Size, 1);
+                   });
+
+  std::vector<Function *> Order;
+  for (FunctionCluster *C : SortedClusters)
+    Order.insert(Order.end(), C->Functions.begin(), C->Functions.end());
+  return Order;
+}
+
+/// Move the hot functions of Mod to the start of the module in the order
+/// computed by computeHotFunctionOrder, and write that order to the symbol
+/// ordering file if one was requested.
+static void orderFunctionsByProfile(Config &C, Module &Mod) {
+  std::vector<Function *> Order = computeHotFunctionOrder(Mod);
+
+  Module::FunctionListType &Functions = Mod.getFunctionList();
+  Module::iterator InsertPt = Functions.begin();
+  for (Function *F : Order) {
+    if (InsertPt == F->getIterator())
+      ++InsertPt;
+    else
+      Functions.splice(InsertPt, Functions, F->getIterator());
+  }
+
+  if (C.SymbolOrderingFile.empty())
+    return;
+  std::error_code EC;
+  raw_fd_ostream OS(C.SymbolOrderingFile, EC, sys::fs::OpenFlags::F_Text);
+  if (EC)
+    reportOpenError(C.SymbolOrderingFile, EC.message());
+  Mangler Mang;
+  for (Function *F : Order) {
+    SmallString<64> Name;
+    Mang.getNameWithPrefix(Name, F, /*CannotUsePrivateLabel=*/false);
+    OS << Name << '\n';
+  }
+}
+
 static void handleAsmUndefinedRefs(Module &Mod, TargetMachine &TM) {
   // Collect the list of undefined symbols used in asm and update
   // llvm.compiler.used to prevent optimization to drop these from the output.
@@ -304,6 +451,9 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     if (!opt(C, TM.get(), 0, *Mod, /*IsThinLto=*/false))
       return Error();
 
+  if (C.ProfileFunctionOrder || !C.SymbolOrderingFile.empty())
+    orderFunctionsByProfile(C, *Mod);
+
   if (ParallelCodeGenParallelismLevel == 1) {
     codegen(C, TM.get(), AddStream, 0, *Mod);
   } else {
@@ -362,6 +512,8 @@ Error lto::thinBackend(Config &Conf, unsigned Task, AddStreamFn AddStream,
   FunctionImporter Importer(CombinedIndex, ModuleLoader);
   Importer.importFunctions(Mod, ImportList);
 
+  applyThinLTODevirtualization(Mod, CombinedIndex);
+
   if (Conf.PostImportModuleHook && !Conf.PostImportModuleHook(Task, Mod))
     return Error();
 
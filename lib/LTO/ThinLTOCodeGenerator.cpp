@@ -49,6 +49,7 @@
 #include "llvm/Transforms/IPO/FunctionImport.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/IPO/WholeProgramDevirt.h"
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
@@ -153,6 +154,7 @@ crossImportIntoModule(Module &TheModule, const ModuleSummaryIndex &Index,
   ModuleLoader Loader(TheModule.getContext(), ModuleMap);
   FunctionImporter Importer(Index, Loader);
   Importer.importFunctions(TheModule, ImportList);
+  applyThinLTODevirtualization(TheModule, Index);
 }
 
 static void optimizeModule(Module &TheModule, TargetMachine &TM) {
@@ -193,6 +195,21 @@ computeGUIDPreservedSymbols(const StringSet<> &PreservedSymbols,
   return GUIDPreservedSymbols;
 }
 
+// Devirtualized calls may refer to a target defined in any module, so all the
+// single implementations named by the index must survive internalization.
+// Nothing is internalized when the client did not preserve any symbol, so the
+// set is left empty in that case.
+static void
+addDevirtualizationTargets(const ModuleSummaryIndex &Index,
+                           DenseSet<GlobalValue::GUID> &GUIDPreservedSymbols) {
+  if (GUIDPreservedSymbols.empty())
+    return;
+  for (auto &TypeId : Index.typeIds())
+    for (auto &Slot : TypeId.second.SlotTargets)
+      if (Slot.second.size() == 1 && !Slot.second.begin()->empty())
+        GUIDPreservedSymbols.insert(GlobalValue::getGUID(*Slot.second.begin()));
+}
+
 std::unique_ptr<MemoryBuffer> codegenModule(Module &TheModule,
                                             TargetMachine &TM) {
   SmallVector<char, 128> OutputBuffer;
@@ -217,6 +234,35 @@ std::unique_ptr<MemoryBuffer> codegenModule(Module &TheModule,
   return make_unique<ObjectMemoryBuffer>(std::move(OutputBuffer));
 }
 
+/// Write \p Buffer to the cache entry at \p EntryPath. The content is first
+/// written to a temporary file which is then moved into place, so that a
+/// concurrent reader never observes a partially written entry.
+static void writeCacheEntry(StringRef EntryPath, StringRef Buffer) {
+  // Write to a temporary to avoid race condition
+  SmallString<128> TempFilename;
+  int TempFD;
+  std::error_code EC =
+      sys::fs::createTemporaryFile("Thin", "tmp.o", TempFD, TempFilename);
+  if (EC) {
+    errs() << "Error: " << EC.message() << "\n";
+    report_fatal_error("ThinLTO: Can't get a temporary file");
+  }
+  {
+    raw_fd_ostream OS(TempFD, /* ShouldClose */ true);
+    OS << Buffer;
+  }
+  // Rename to final destination (hopefully race condition won't matter here)
+  EC = sys::fs::rename(TempFilename, EntryPath);
+  if (EC) {
+    sys::fs::remove(TempFilename);
+    raw_fd_ostream OS(EntryPath, EC, sys::fs::F_None);
+    if (EC)
+      report_fatal_error(Twine("Failed to open ") + EntryPath +
+                         " to save cached entry\n");
+    OS << Buffer;
+  }
+}
+
 /// Manage caching for a single Module.
 class ModuleCacheEntry {
   SmallString<128> EntryPath;
@@ -285,6 +331,24 @@ public:
             ArrayRef<uint8_t>((const uint8_t *)&Entry, sizeof(GlobalValue::GUID)));
     }
 
+    // Include the attributes the thin link computed for the variables defined
+    // or imported by the module, as they depend on what every module does.
+    auto AddVarFlags = [&](GlobalValue::GUID GUID,
+                           const GlobalValueSummary *S) {
+      auto *GVS = dyn_cast_or_null<GlobalVarSummary>(S);
+      if (!GVS)
+        return;
+      uint8_t Flags = GVS->isReadOnly() | (GVS->isWriteOnly() << 1);
+      Hasher.update(ArrayRef<uint8_t>((const uint8_t *)&GUID, sizeof(GUID)));
+      Hasher.update(ArrayRef<uint8_t>(&Flags, 1));
+    };
+    for (auto &GS : DefinedFunctions)
+      AddVarFlags(GS.first, GS.second);
+    for (auto &Entry : ImportList)
+      for (auto &Import : Entry.second)
+        AddVarFlags(Import.first,
+                    Index.findSummaryInModule(Import.first, Entry.first()));
+
     sys::path::append(EntryPath, CachePath, toHex(Hasher.result()));
   }
 
@@ -304,29 +368,7 @@ public:
     if (EntryPath.empty())
       return OutputBuffer;
 
-    // Write to a temporary to avoid race condition
-    SmallString<128> TempFilename;
-    int TempFD;
-    std::error_code EC =
-        sys::fs::createTemporaryFile("Thin", "tmp.o", TempFD, TempFilename);
-    if (EC) {
-      errs() << "Error: " << EC.message() << "\n";
-      report_fatal_error("ThinLTO: Can't get a temporary file");
-    }
-    {
-      raw_fd_ostream OS(TempFD, /* ShouldClose */ true);
-      OS << OutputBuffer->getBuffer();
-    }
-    // Rename to final destination (hopefully race condition won't matter here)
-    EC = sys::fs::rename(TempFilename, EntryPath);
-    if (EC) {
-      sys::fs::remove(TempFilename);
-      raw_fd_ostream OS(EntryPath, EC, sys::fs::F_None);
-      if (EC)
-        report_fatal_error(Twine("Failed to open ") + EntryPath +
-                           " to save cached entry\n");
-      OS << OutputBuffer->getBuffer();
-    }
+    writeCacheEntry(EntryPath, OutputBuffer->getBuffer());
     auto ReloadedBufferOrErr = MemoryBuffer::getFile(EntryPath);
     if (auto EC = ReloadedBufferOrErr.getError()) {
       // FIXME diagnose
@@ -338,6 +380,161 @@ public:
   }
 };
 
+/// Manage caching for the summary index of a single input Module.
+class SummaryCacheEntry {
+  SmallString<128> EntryPath;
+
+public:
+  // Create a cache entry for the summary of the module in ModuleBuffer. The key
+  // covers the compiler version, the module identifier (which is recorded in
+  // the index as the module path), and the content of the bitcode, so that any
+  // change to the input invalidates the entry.
+  SummaryCacheEntry(StringRef CachePath, MemoryBufferRef ModuleBuffer) {
+    if (CachePath.empty())
+      return;
+
+    SHA1 Hasher;
+    Hasher.update(LLVM_VERSION_STRING);
+#ifdef HAVE_LLVM_REVISION
+    Hasher.update(LLVM_REVISION);
+#endif
+    Hasher.update(ModuleBuffer.getBufferIdentifier());
+    Hasher.update(ModuleBuffer.getBuffer());
+
+    sys::path::append(EntryPath, CachePath,
+                      "summary-" + toHex(Hasher.result()));
+  }
+
+  // Access the path to this entry in the cache.
+  StringRef getEntryPath() { return EntryPath; }
+
+  // Try loading the summary index for this cache entry.
+  std::unique_ptr<ModuleSummaryIndex>
+  tryLoadingIndex(const DiagnosticHandlerFunction &DiagnosticHandler) {
+    if (EntryPath.empty() || !sys::fs::exists(EntryPath))
+      return nullptr;
+    ErrorOr<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+        getModuleSummaryIndexForFile(EntryPath, DiagnosticHandler);
+    if (!IndexOrErr)
+      return nullptr;
+    return std::move(*IndexOrErr);
+  }
+
+  // Cache the summary index of the module.
+  void write(const ModuleSummaryIndex &Index) {
+    if (EntryPath.empty())
+      return;
+
+    SmallString<0> Buffer;
+    raw_svector_ostream OS(Buffer);
+    // Calls into other modules have to survive until the thin-link merges
+    // this summary with theirs.
+    WriteIndexToFile(Index, OS, /*ModuleToSummariesForIndex=*/nullptr,
+                     /*KeepUnsummarizedCallees=*/true);
+    writeCacheEntry(EntryPath, Buffer);
+  }
+};
+
+/// Manage caching for the code generation of a single optimized Module.
+class CodeGenCacheEntry {
+  SmallString<128> EntryPath;
+
+public:
+  // Create a cache entry for the object produced from TheModule by TM. The key
+  // covers the compiler version, the target configuration (including the
+  // target options and the relocation and code models), and the bitcode of
+  // the module as it is handed to the code generator, so it does not depend on
+  // how the module got there.
+  CodeGenCacheEntry(StringRef CachePath, const Module &TheModule,
+                    const TargetMachine &TM) {
+    if (CachePath.empty())
+      return;
+
+    SmallVector<char, 128> Bitcode;
+    {
+      raw_svector_ostream OS(Bitcode);
+      WriteBitcodeToFile(&TheModule, OS);
+    }
+
+    SHA1 Hasher;
+    Hasher.update(LLVM_VERSION_STRING);
+#ifdef HAVE_LLVM_REVISION
+    Hasher.update(LLVM_REVISION);
+#endif
+    Hasher.update(TM.getTargetTriple().str());
+    Hasher.update(TM.getTargetCPU());
+    Hasher.update(TM.getTargetFeatureString());
+    auto AddUnsigned = [&](unsigned I) {
+      Hasher.update(ArrayRef<uint8_t>((const uint8_t *)&I, sizeof(I)));
+    };
+    AddUnsigned(TM.getOptLevel());
+    AddUnsigned(TM.getRelocationModel());
+    AddUnsigned(TM.getCodeModel());
+
+    // Every target option that can change the generated object.
+    const TargetOptions &Options = TM.Options;
+    AddUnsigned(Options.LessPreciseFPMADOption);
+    AddUnsigned(Options.UnsafeFPMath);
+    AddUnsigned(Options.NoInfsFPMath);
+    AddUnsigned(Options.NoNaNsFPMath);
+    AddUnsigned(Options.NoTrappingFPMath);
+    AddUnsigned(Options.HonorSignDependentRoundingFPMathOption);
+    AddUnsigned(Options.NoZerosInBSS);
+    AddUnsigned(Options.GuaranteedTailCallOpt);
+    AddUnsigned(Options.StackAlignmentOverride);
+    AddUnsigned(Options.StackSymbolOrdering);
+    AddUnsigned(Options.EnableFastISel);
+    AddUnsigned(Options.UseInitArray);
+    AddUnsigned(Options.DisableIntegratedAS);
+    AddUnsigned(Options.CompressDebugSections);
+    AddUnsigned(Options.RelaxELFRelocations);
+    AddUnsigned(Options.FunctionSections);
+    AddUnsigned(Options.DataSections);
+    AddUnsigned(Options.UniqueSectionNames);
+    AddUnsigned(Options.TrapUnreachable);
+    AddUnsigned(Options.EmulatedTLS);
+    AddUnsigned(Options.EnableIPRA);
+    AddUnsigned(Options.FloatABIType);
+    AddUnsigned(Options.AllowFPOpFusion);
+    AddUnsigned(Options.JTType);
+    AddUnsigned(Options.ThreadModel);
+    AddUnsigned(unsigned(Options.EABIVersion));
+    AddUnsigned(unsigned(Options.DebuggerTuning));
+    AddUnsigned(Options.FPDenormalMode);
+    AddUnsigned(unsigned(Options.ExceptionModel));
+    const MCTargetOptions &MCOptions = Options.MCOptions;
+    AddUnsigned(MCOptions.SanitizeAddress);
+    AddUnsigned(MCOptions.MCRelaxAll);
+    AddUnsigned(MCOptions.MCNoExecStack);
+    AddUnsigned(MCOptions.MCIncrementalLinkerCompatible);
+    AddUnsigned(MCOptions.MCPIECopyRelocations);
+    AddUnsigned(MCOptions.DwarfVersion);
+    Hasher.update(MCOptions.ABIName);
+
+    Hasher.update(StringRef(Bitcode.data(), Bitcode.size()));
+
+    sys::path::append(EntryPath, CachePath,
+                      "codegen-" + toHex(Hasher.result()));
+  }
+
+  // Access the path to this entry in the cache.
+  StringRef getEntryPath() { return EntryPath; }
+
+  // Try loading the buffer for this cache entry.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> tryLoadingBuffer() {
+    if (EntryPath.empty())
+      return std::error_code();
+    return MemoryBuffer::getFile(EntryPath);
+  }
+
+  // Cache the produced object file.
+  void write(const MemoryBuffer &OutputBuffer) {
+    if (EntryPath.empty())
+      return;
+    writeCacheEntry(EntryPath, OutputBuffer.getBuffer());
+  }
+};
+
 static std::unique_ptr<MemoryBuffer>
 ProcessThinLTOModule(Module &TheModule, ModuleSummaryIndex &Index,
                      StringMap<MemoryBufferRef> &ModuleMap, TargetMachine &TM,
@@ -395,7 +592,23 @@ ProcessThinLTOModule(Module &TheModule, ModuleSummaryIndex &Index,
     return make_unique<ObjectMemoryBuffer>(std::move(OutputBuffer));
   }
 
-  return codegenModule(TheModule, TM);
+  // The optimized module can be identical to one we already generated code
+  // for even though the inputs changed, for instance when an imported module
+  // was modified in a function this module doesn't use.
+  CodeGenCacheEntry CodeGenCache(
+      CacheOptions.CacheCodeGen ? CacheOptions.Path : "", TheModule, TM);
+  {
+    auto ErrOrBuffer = CodeGenCache.tryLoadingBuffer();
+    DEBUG(if (!CodeGenCache.getEntryPath().empty()) dbgs()
+          << "CodeGen cache " << (ErrOrBuffer ? "hit" : "miss") << " '"
+          << CodeGenCache.getEntryPath() << "' for buffer " << count << "\n");
+    if (ErrOrBuffer)
+      return std::move(*ErrOrBuffer);
+  }
+
+  auto OutputBuffer = codegenModule(TheModule, TM);
+  CodeGenCache.write(*OutputBuffer);
+  return OutputBuffer;
 }
 
 /// Resolve LinkOnce/Weak symbols. Record resolutions in the \p ResolvedODR map
@@ -502,16 +715,27 @@ std::unique_ptr<ModuleSummaryIndex> ThinLTOCodeGenerator::linkCombinedIndex() {
   std::unique_ptr<ModuleSummaryIndex> CombinedIndex;
   uint64_t NextModuleId = 0;
   for (auto &ModuleBuffer : Modules) {
-    ErrorOr<std::unique_ptr<object::ModuleSummaryIndexObjectFile>> ObjOrErr =
-        object::ModuleSummaryIndexObjectFile::create(ModuleBuffer,
-                                                     diagnosticHandler);
-    if (std::error_code EC = ObjOrErr.getError()) {
-      // FIXME diagnose
-      errs() << "error: can't create ModuleSummaryIndexObjectFile for buffer: "
-             << EC.message() << "\n";
-      return nullptr;
+    SummaryCacheEntry CacheEntry(
+        CacheOptions.CacheSummaries ? CacheOptions.Path : "", ModuleBuffer);
+    auto Index = CacheEntry.tryLoadingIndex(diagnosticHandler);
+    DEBUG(if (!CacheEntry.getEntryPath().empty()) dbgs()
+          << "Summary cache " << (Index ? "hit" : "miss") << " '"
+          << CacheEntry.getEntryPath() << "' for buffer '"
+          << ModuleBuffer.getBufferIdentifier() << "'\n");
+    if (!Index) {
+      ErrorOr<std::unique_ptr<object::ModuleSummaryIndexObjectFile>> ObjOrErr =
+          object::ModuleSummaryIndexObjectFile::create(ModuleBuffer,
+                                                       diagnosticHandler);
+      if (std::error_code EC = ObjOrErr.getError()) {
+        // FIXME diagnose
+        errs()
+            << "error: can't create ModuleSummaryIndexObjectFile for buffer: "
+            << EC.message() << "\n";
+        return nullptr;
+      }
+      Index = (*ObjOrErr)->takeIndex();
+      CacheEntry.write(*Index);
     }
-    auto Index = (*ObjOrErr)->takeIndex();
     if (CombinedIndex) {
       CombinedIndex->mergeFrom(std::move(Index), ++NextModuleId);
     } else {
@@ -537,7 +761,7 @@ void ThinLTOCodeGenerator::promote(Module &TheModule,
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
+                           ExportLists, ThreadCount);
 
   // Resolve LinkOnce/Weak symbols.
   StringMap<std::map<GlobalValue::GUID, GlobalValue::LinkageTypes>> ResolvedODR;
@@ -565,7 +789,7 @@ void ThinLTOCodeGenerator::crossModuleImport(Module &TheModule,
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
+                           ExportLists, ThreadCount);
   auto &ImportList = ImportLists[TheModule.getModuleIdentifier()];
 
   crossImportIntoModule(TheModule, Index, ModuleMap, ImportList);
@@ -587,7 +811,7 @@ void ThinLTOCodeGenerator::gatherImportedSummariesForModule(
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
+                           ExportLists, ThreadCount);
 
   llvm::gatherImportedSummariesForModule(ModulePath, ModuleToDefinedGVSummaries,
                                          ImportLists[ModulePath],
@@ -610,7 +834,7 @@ void ThinLTOCodeGenerator::emitImports(StringRef ModulePath,
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
+                           ExportLists, ThreadCount);
 
   std::error_code EC;
   if ((EC = EmitImportsFiles(ModulePath, OutputName, ImportLists[ModulePath])))
@@ -639,13 +863,14 @@ void ThinLTOCodeGenerator::internalize(Module &TheModule,
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
+                           ExportLists, ThreadCount);
   auto &ExportList = ExportLists[ModuleIdentifier];
 
   // Be friendly and don't nuke totally the module when the client didn't
   // supply anything to preserve.
   if (ExportList.empty() && GUIDPreservedSymbols.empty())
     return;
+  addDevirtualizationTargets(Index, GUIDPreservedSymbols);
 
   // Internalization
   auto isExported = [&](StringRef ModuleIdentifier, GlobalValue::GUID GUID) {
@@ -727,17 +952,27 @@ void ThinLTOCodeGenerator::run() {
   StringMap<GVSummaryMapTy> ModuleToDefinedGVSummaries(ModuleCount);
   Index->collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
 
+  // Convert the preserved symbols set from string to GUID, this is needed for
+  // computing the caching hash and the internalization.
+  auto GUIDPreservedSymbols =
+      computeGUIDPreservedSymbols(PreservedSymbols, TMBuilder.TheTriple);
+  addDevirtualizationTargets(*Index, GUIDPreservedSymbols);
+
+  // Find the global variables that are only read or only written. This needs
+  // every access to be visible: the client must have listed the symbols used
+  // outside of the link, and every module must have a summary.
+  if (!GUIDPreservedSymbols.empty() &&
+      Index->modulePaths().size() == Modules.size())
+    Index->propagateAttributes([&](GlobalValue::GUID GUID) {
+      return GUIDPreservedSymbols.count(GUID);
+    });
+
   // Collect the import/export lists for all modules from the call-graph in the
   // combined index.
   StringMap<FunctionImporter::ImportMapTy> ImportLists(ModuleCount);
   StringMap<FunctionImporter::ExportSetTy> ExportLists(ModuleCount);
   ComputeCrossModuleImport(*Index, ModuleToDefinedGVSummaries, ImportLists,
-                           ExportLists);
-
-  // Convert the preserved symbols set from string to GUID, this is needed for
-  // computing the caching hash and the internalization.
-  auto GUIDPreservedSymbols =
-      computeGUIDPreservedSymbols(PreservedSymbols, TMBuilder.TheTriple);
+                           ExportLists, ThreadCount);
 
   // We use a std::map here to be able to have a defined ordering when
   // producing a hash for the cache entry.
@@ -102,6 +102,10 @@ class ELFObjectWriter : public MCObjectWriter {
   llvm::DenseMap<const MCSectionELF *, std::vector<ELFRelocationEntry>>
       Relocations;
 
+  /// Scratch buffer the relocations of a section are encoded into before
+  /// being written, reused across sections.
+  SmallVector<char, 0> RelocationBuffer;
+
   /// @}
   /// @name Symbol Table Data
   /// @{
@@ -168,6 +172,16 @@ public:
       support::endian::Writer<support::big>(getStream()).write(Val);
   }
 
+  /// Encode \p Val in the byte order of the target at \p Out, and advance
+  /// \p Out past it.
+  template <typename T> void encode(char *&Out, T Val) {
+    if (IsLittleEndian)
+      support::endian::write<T, support::little, support::unaligned>(Out, Val);
+    else
+      support::endian::write<T, support::big, support::unaligned>(Out, Val);
+    Out += sizeof(T);
+  }
+
   void writeHeader(const MCAssembler &Asm);
 
   void writeSymbol(SymbolTableWriter &Writer, uint32_t StringIndex,
@@ -1034,10 +1048,14 @@ void ELFObjectWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
   Asm.writeSectionData(&Section, Layout);
   setStream(OldStream);
 
+  // Large debug sections are deflated in chunks, in parallel if the client
+  // allows it; small ones come out exactly as zlib::compress would produce
+  // them.
   SmallVector<char, 128> CompressedContents;
-  zlib::Status Success = zlib::compress(
+  zlib::Status Success = zlib::compressChunked(
       StringRef(UncompressedData.data(), UncompressedData.size()),
-      CompressedContents);
+      CompressedContents, zlib::DefaultCompression, 1 << 20,
+      Asm.getContext().getAsmInfo()->compressDebugSectionsThreads());
   if (Success != zlib::StatusOK) {
     getStream() << UncompressedData;
     return;
@@ -1092,37 +1110,50 @@ void ELFObjectWriter::writeRelocations(const MCAssembler &Asm,
   // Sort the relocation entries. MIPS needs this.
   TargetObjectWriter->sortRelocs(Asm, Relocs);
 
+  // Encode all the entries into a buffer and write it at once rather than
+  // field by field: with -ffunction-sections there are very many of them.
+  unsigned EntrySize;
+  if (hasRelocationAddend())
+    EntrySize = is64Bit() ? sizeof(ELF::Elf64_Rela) : sizeof(ELF::Elf32_Rela);
+  else
+    EntrySize = is64Bit() ? sizeof(ELF::Elf64_Rel) : sizeof(ELF::Elf32_Rel);
+  RelocationBuffer.resize(Relocs.size() * EntrySize);
+  char *Out = RelocationBuffer.data();
+
   for (unsigned i = 0, e = Relocs.size(); i != e; ++i) {
     const ELFRelocationEntry &Entry = Relocs[e - i - 1];
     unsigned Index = Entry.Symbol ? Entry.Symbol->getIndex() : 0;
 
     if (is64Bit()) {
-      write(Entry.Offset);
+      encode(Out, Entry.Offset);
       if (TargetObjectWriter->isN64()) {
-        write(uint32_t(Index));
+        encode(Out, uint32_t(Index));
 
-        write(TargetObjectWriter->getRSsym(Entry.Type));
-        write(TargetObjectWriter->getRType3(Entry.Type));
-        write(TargetObjectWriter->getRType2(Entry.Type));
-        write(TargetObjectWriter->getRType(Entry.Type));
+        encode(Out, TargetObjectWriter->getRSsym(Entry.Type));
+        encode(Out, TargetObjectWriter->getRType3(Entry.Type));
+        encode(Out, TargetObjectWriter->getRType2(Entry.Type));
+        encode(Out, TargetObjectWriter->getRType(Entry.Type));
       } else {
         struct ELF::Elf64_Rela ERE64;
         ERE64.setSymbolAndType(Index, Entry.Type);
-        write(ERE64.r_info);
+        encode(Out, ERE64.r_info);
       }
       if (hasRelocationAddend())
-        write(Entry.Addend);
+        encode(Out, Entry.Addend);
     } else {
-      write(uint32_t(Entry.Offset));
+      encode(Out, uint32_t(Entry.Offset));
 
       struct ELF::Elf32_Rela ERE32;
       ERE32.setSymbolAndType(Index, Entry.Type);
-      write(ERE32.r_info);
+      encode(Out, ERE32.r_info);
 
       if (hasRelocationAddend())
-        write(uint32_t(Entry.Addend));
+        encode(Out, uint32_t(Entry.Addend));
     }
   }
+  assert(Out == RelocationBuffer.data() + RelocationBuffer.size() &&
+         "Relocation entries don't match their size");
+  getStream().write(RelocationBuffer.data(), RelocationBuffer.size());
 }
 
 const MCSectionELF *ELFObjectWriter::createStringTable(MCContext &Ctx) {
@@ -109,6 +109,7 @@ MCAsmInfo::MCAsmInfo() {
   PreserveAsmComments = true;
 
   CompressDebugSections = DebugCompressionType::DCT_None;
+  CompressDebugSectionsThreads = 1;
 }
 
 MCAsmInfo::~MCAsmInfo() {
@@ -848,13 +848,13 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
 }
 
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
-  // Holds the first fragment which needed relaxing during this layout. It will
-  // remain NULL if none were relaxed.
-  // When a fragment is relaxed, all the fragments following it should get
-  // invalidated because their offset is going to change.
-  MCFragment *FirstRelaxedFragment = nullptr;
+  bool WasRelaxed = false;
 
-  // Attempt to relax all the fragments in the section.
+  // Attempt to relax all the fragments in the section. When a fragment is
+  // relaxed, all the fragments following it are invalidated right away because
+  // their offset is going to change. That way the rest of this pass already
+  // sees the new offsets, instead of relaxing against stale ones and needing
+  // another pass over the whole section to catch up.
   for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
@@ -886,14 +886,12 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
       RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
       break;
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
-  }
-  if (FirstRelaxedFragment) {
-    Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
-    return true;
+    if (RelaxedFrag) {
+      Layout.invalidateFragmentsFrom(&*I);
+      WasRelaxed = true;
+    }
   }
-  return false;
+  return WasRelaxed;
 }
 
 bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
@@ -448,17 +448,18 @@ void MCMachOStreamer::EmitInstToData(const MCInst &Inst,
                                      const MCSubtargetInfo &STI) {
   MCDataFragment *DF = getOrCreateDataFragment();
 
+  // Encode straight into the fragment; the fixup offsets the emitter reports
+  // are relative to the start of the instruction.
   SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
+  uint64_t InstOffset = DF->getContents().size();
+  raw_svector_ostream VecOS(DF->getContents());
   getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
 
-  // Add the fixups and data.
+  // Add the fixups.
   for (MCFixup &Fixup : Fixups) {
-    Fixup.setOffset(Fixup.getOffset() + DF->getContents().size());
+    Fixup.setOffset(Fixup.getOffset() + InstOffset);
     DF->getFixups().push_back(Fixup);
   }
-  DF->getContents().append(Code.begin(), Code.end());
 }
 
 void MCMachOStreamer::FinishImpl() {
@@ -250,6 +250,19 @@ static unsigned doLookAhead(const char *&CurPtr, unsigned DefaultRadix) {
   return DefaultRadix;
 }
 
+/// Convert the digits of an integer literal in \p Radix, as getAsInteger
+/// does. Values that fit in 64 bits, which are nearly all of them, are
+/// converted without 128-bit APInt arithmetic, which dominates the lexing of
+/// large data tables otherwise.
+static bool getIntegerValue(StringRef Digits, unsigned Radix, APInt &Value) {
+  unsigned long long Small;
+  if (!Digits.getAsInteger(Radix, Small)) {
+    Value = APInt(64, Small);
+    return false;
+  }
+  return Digits.getAsInteger(Radix, Value);
+}
+
 static AsmToken intToken(StringRef Ref, APInt &Value)
 {
   if (Value.isIntN(64))
@@ -290,7 +303,7 @@ AsmToken AsmLexer::LexDigit() {
       StringRef Result(TokStart, CurPtr - TokStart);
       APInt Value(128, 0, true);
 
-      if (Result.drop_back().getAsInteger(Radix, Value))
+      if (getIntegerValue(Result.drop_back(), Radix, Value))
         return ReturnError(TokStart, Radix == 2 ? "invalid binary number" :
                              "invalid hexdecimal number");
 
@@ -317,7 +330,7 @@ AsmToken AsmLexer::LexDigit() {
     StringRef Result(TokStart, CurPtr - TokStart);
 
     APInt Value(128, 0, true);
-    if (Result.getAsInteger(Radix, Value))
+    if (getIntegerValue(Result, Radix, Value))
       return ReturnError(TokStart, !isHex ? "invalid decimal number" :
                            "invalid hexdecimal number");
 
@@ -351,7 +364,7 @@ AsmToken AsmLexer::LexDigit() {
     StringRef Result(TokStart, CurPtr - TokStart);
 
     APInt Value(128, 0, true);
-    if (Result.substr(2).getAsInteger(2, Value))
+    if (getIntegerValue(Result.substr(2), 2, Value))
       return ReturnError(TokStart, "invalid binary number");
 
     // The darwin/x86 (and x86-64) assembler accepts and ignores ULL and LL
@@ -377,7 +390,7 @@ AsmToken AsmLexer::LexDigit() {
       return ReturnError(CurPtr-2, "invalid hexadecimal number");
 
     APInt Result(128, 0);
-    if (StringRef(TokStart, CurPtr - TokStart).getAsInteger(0, Result))
+    if (getIntegerValue(StringRef(TokStart, CurPtr - TokStart), 0, Result))
       return ReturnError(TokStart, "invalid hexadecimal number");
 
     // Consume the optional [hH].
@@ -396,7 +409,7 @@ AsmToken AsmLexer::LexDigit() {
   unsigned Radix = doLookAhead(CurPtr, 8);
   bool isHex = Radix == 16;
   StringRef Result(TokStart, CurPtr - TokStart);
-  if (Result.getAsInteger(Radix, Value))
+  if (getIntegerValue(Result, Radix, Value))
     return ReturnError(TokStart, !isHex ? "invalid octal number" :
                        "invalid hexdecimal number");
 
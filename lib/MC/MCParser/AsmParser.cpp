@@ -2774,20 +2774,34 @@ bool AsmParser::parseDirectiveReloc(SMLoc DirectiveLoc) {
 /// parseDirectiveValue
 ///  ::= (.byte | .short | ... ) [ expression (, expression)* ]
 bool AsmParser::parseDirectiveValue(StringRef IDVal, unsigned Size) {
+  assert(Size <= 8 && "Invalid size");
+  auto emitIntValue = [&](uint64_t IntValue, SMLoc ExprLoc) -> bool {
+    if (!isUIntN(8 * Size, IntValue) && !isIntN(8 * Size, IntValue))
+      return Error(ExprLoc, "out of range literal value");
+    getStreamer().EmitIntValue(IntValue, Size);
+    return false;
+  };
   auto parseOp = [&]() -> bool {
     const MCExpr *Value;
     SMLoc ExprLoc = getLexer().getLoc();
-    if (checkForValidSection() || parseExpression(Value))
+    if (checkForValidSection())
+      return true;
+    // Data tables are mostly lists of plain integers. Emit those directly
+    // rather than creating (and folding) an expression for each of them.
+    if (getTok().is(AsmToken::Integer)) {
+      AsmToken::TokenKind Next = Lexer.peekTok().getKind();
+      if (Next == AsmToken::Comma || Next == AsmToken::EndOfStatement) {
+        uint64_t IntValue = getTok().getIntVal();
+        Lex();
+        return emitIntValue(IntValue, ExprLoc);
+      }
+    }
+    if (parseExpression(Value))
       return true;
     // Special case constant expressions to match code generator.
-    if (const MCConstantExpr *MCE = dyn_cast<MCConstantExpr>(Value)) {
-      assert(Size <= 8 && "Invalid size");
-      uint64_t IntValue = MCE->getValue();
-      if (!isUIntN(8 * Size, IntValue) && !isIntN(8 * Size, IntValue))
-        return Error(ExprLoc, "out of range literal value");
-      getStreamer().EmitIntValue(IntValue, Size);
-    } else
-      getStreamer().EmitValue(Value, Size, ExprLoc);
+    if (const MCConstantExpr *MCE = dyn_cast<MCConstantExpr>(Value))
+      return emitIntValue(MCE->getValue(), ExprLoc);
+    getStreamer().EmitValue(Value, Size, ExprLoc);
     return false;
   };
 
@@ -31,4 +31,6 @@ const MCSchedModel MCSchedModel::Default = {DefaultIssueWidth,
                                             nullptr,
                                             0,
                                             0,
-                                            nullptr};
+                                            nullptr,
+                                            nullptr,
+                                            0};
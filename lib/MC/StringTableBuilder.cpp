@@ -66,27 +66,64 @@ void StringTableBuilder::write(uint8_t *Buf) const {
   support::endian::write32le(Buf, Size);
 }
 
+namespace {
+// A string being sorted for tail merging. The StringRef is copied out of its
+// StringIndexMap entry so that the sort only touches this array, rather than
+// chasing a pointer into the hash table for every character it compares.
+struct SortEntry {
+  StringRef Str;
+  StringPair *Pair;
+};
+} // end anonymous namespace
+
 // Returns the character at Pos from end of a string.
-static int charTailAt(StringPair *P, size_t Pos) {
-  StringRef S = P->first.val();
+static int charTailAt(const SortEntry &E, size_t Pos) {
+  StringRef S = E.Str;
   if (Pos >= S.size())
     return -1;
   return (unsigned char)S[S.size() - Pos - 1];
 }
 
+// Sort [Begin, End) by reversed string, knowing that the last Pos characters
+// of all of them are the same. Used for ranges too small to be worth
+// partitioning.
+static void insertionSortTail(SortEntry *Begin, SortEntry *End, int Pos) {
+  for (SortEntry *I = Begin + 1; I < End; ++I) {
+    SortEntry Tmp = *I;
+    StringRef T = Tmp.Str;
+    SortEntry *J = I;
+    for (; J != Begin; --J) {
+      StringRef S = J[-1].Str;
+      // Compare the reversed strings below Pos; longer wins on equal prefixes.
+      size_t K = Pos;
+      while (K < S.size() && K < T.size() &&
+             S[S.size() - K - 1] == T[T.size() - K - 1])
+        ++K;
+      int CS = K < S.size() ? (unsigned char)S[S.size() - K - 1] : -1;
+      int CT = K < T.size() ? (unsigned char)T[T.size() - K - 1] : -1;
+      if (CS >= CT)
+        break;
+      *J = J[-1];
+    }
+    *J = Tmp;
+  }
+}
+
 // Three-way radix quicksort. This is much faster than std::sort with strcmp
 // because it does not compare characters that we already know the same.
-static void multikey_qsort(StringPair **Begin, StringPair **End, int Pos) {
+static void multikey_qsort(SortEntry *Begin, SortEntry *End, int Pos) {
 tailcall:
-  if (End - Begin <= 1)
+  if (End - Begin <= 16) {
+    insertionSortTail(Begin, End, Pos);
     return;
+  }
 
   // Partition items. Items in [Begin, P) are greater than the pivot,
   // [P, Q) are the same as the pivot, and [Q, End) are less than the pivot.
   int Pivot = charTailAt(*Begin, Pos);
-  StringPair **P = Begin;
-  StringPair **Q = End;
-  for (StringPair **R = Begin + 1; R < Q;) {
+  SortEntry *P = Begin;
+  SortEntry *Q = End;
+  for (SortEntry *R = Begin + 1; R < Q;) {
     int C = charTailAt(*R, Pos);
     if (C > Pivot)
       std::swap(*P++, *R++);
@@ -119,10 +156,10 @@ void StringTableBuilder::finalizeStringTable(bool Optimize) {
   Finalized = true;
 
   if (Optimize) {
-    std::vector<StringPair *> Strings;
+    std::vector<SortEntry> Strings;
     Strings.reserve(StringIndexMap.size());
     for (StringPair &P : StringIndexMap)
-      Strings.push_back(&P);
+      Strings.push_back({P.first.val(), &P});
 
     if (!Strings.empty()) {
       // If we're optimizing, sort by name. If not, sort by previously assigned
@@ -133,8 +170,9 @@ void StringTableBuilder::finalizeStringTable(bool Optimize) {
     initSize();
 
     StringRef Previous;
-    for (StringPair *P : Strings) {
-      StringRef S = P->first.val();
+    for (SortEntry &E : Strings) {
+      StringPair *P = E.Pair;
+      StringRef S = E.Str;
       if (Previous.endswith(S)) {
         size_t Pos = Size - S.size() - (K != RAW);
         if (!(Pos & (Alignment - 1))) {
@@ -45,18 +45,18 @@ void MCWinCOFFStreamer::EmitInstToData(const MCInst &Inst,
                                        const MCSubtargetInfo &STI) {
   MCDataFragment *DF = getOrCreateDataFragment();
 
+  // Encode straight into the fragment; the fixup offsets the emitter reports
+  // are relative to the start of the instruction.
   SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
+  uint64_t InstOffset = DF->getContents().size();
+  raw_svector_ostream VecOS(DF->getContents());
   getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
 
-  // Add the fixups and data.
-  for (unsigned i = 0, e = Fixups.size(); i != e; ++i) {
-    Fixups[i].setOffset(Fixups[i].getOffset() + DF->getContents().size());
-    DF->getFixups().push_back(Fixups[i]);
+  // Add the fixups.
+  for (MCFixup &Fixup : Fixups) {
+    Fixup.setOffset(Fixup.getOffset() + InstOffset);
+    DF->getFixups().push_back(Fixup);
   }
-
-  DF->getContents().append(Code.begin(), Code.end());
 }
 
 void MCWinCOFFStreamer::InitSections(bool NoExecStack) {
@@ -23,6 +23,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -250,27 +251,85 @@ static sys::TimePoint<std::chrono::seconds> now(bool Deterministic) {
   return sys::TimePoint<seconds>();
 }
 
+namespace {
+// The symbol table entries contributed by a single archive member.
+struct MemberSymbols {
+  // False if the member is not a symbolic file.
+  bool IsSymbolic = false;
+  // The member's global defined symbol names, each terminated by a NUL.
+  std::string Names;
+  unsigned NumSymbols = 0;
+  std::error_code EC;
+};
+} // end anonymous namespace
+
+// Collect the symbols of a member that go into the archive symbol table. Each
+// member gets its own LLVMContext so that members can be scanned concurrently.
+static void computeMemberSymbols(MemoryBufferRef MemberBuffer,
+                                 MemberSymbols &Syms) {
+  LLVMContext Context;
+  Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
+      object::SymbolicFile::createSymbolicFile(
+          MemberBuffer, sys::fs::file_magic::unknown, &Context);
+  if (!ObjOrErr) {
+    // FIXME: check only for "not an object file" errors.
+    consumeError(ObjOrErr.takeError());
+    return;
+  }
+  object::SymbolicFile &Obj = *ObjOrErr.get();
+  Syms.IsSymbolic = true;
+
+  raw_string_ostream NameOS(Syms.Names);
+  for (const object::BasicSymbolRef &S : Obj.symbols()) {
+    uint32_t Symflags = S.getFlags();
+    if (Symflags & object::SymbolRef::SF_FormatSpecific)
+      continue;
+    if (!(Symflags & object::SymbolRef::SF_Global))
+      continue;
+    if (Symflags & object::SymbolRef::SF_Undefined)
+      continue;
+
+    if ((Syms.EC = S.printName(NameOS)))
+      return;
+    NameOS << '\0';
+    ++Syms.NumSymbols;
+  }
+  NameOS.flush();
+}
+
 // Returns the offset of the first reference to a member offset.
 static ErrorOr<unsigned>
 writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
                  ArrayRef<NewArchiveMember> Members,
-                 std::vector<unsigned> &MemberOffsetRefs, bool Deterministic) {
+                 std::vector<unsigned> &MemberOffsetRefs, bool Deterministic,
+                 unsigned Threads) {
+  // Opening a member is independent of every other member, and for bitcode
+  // members it means parsing the module, so the caller may let us scan them
+  // concurrently. The results are emitted in member order to keep the table
+  // deterministic.
+  std::vector<MemberSymbols> Syms(Members.size());
+  if (Threads > 1 && Members.size() > 1) {
+    ThreadPool Pool(std::min<size_t>(Threads, Members.size()));
+    for (size_t I = 0, E = Members.size(); I != E; ++I)
+      Pool.async([&, I] {
+        computeMemberSymbols(Members[I].Buf->getMemBufferRef(), Syms[I]);
+      });
+    Pool.wait();
+  } else {
+    for (size_t I = 0, E = Members.size(); I != E; ++I)
+      computeMemberSymbols(Members[I].Buf->getMemBufferRef(), Syms[I]);
+  }
+
   unsigned HeaderStartOffset = 0;
   unsigned BodyStartOffset = 0;
   SmallString<128> NameBuf;
   raw_svector_ostream NameOS(NameBuf);
-  LLVMContext Context;
   for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N; ++MemberNum) {
-    MemoryBufferRef MemberBuffer = Members[MemberNum].Buf->getMemBufferRef();
-    Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
-        object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, sys::fs::file_magic::unknown, &Context);
-    if (!ObjOrErr) {
-      // FIXME: check only for "not an object file" errors.
-      consumeError(ObjOrErr.takeError());
+    const MemberSymbols &MS = Syms[MemberNum];
+    if (MS.EC)
+      return MS.EC;
+    if (!MS.IsSymbolic)
       continue;
-    }
-    object::SymbolicFile &Obj = *ObjOrErr.get();
 
     if (!HeaderStartOffset) {
       HeaderStartOffset = Out.tell();
@@ -282,19 +341,13 @@ writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
       print32(Out, Kind, 0); // number of entries or bytes
     }
 
-    for (const object::BasicSymbolRef &S : Obj.symbols()) {
-      uint32_t Symflags = S.getFlags();
-      if (Symflags & object::SymbolRef::SF_FormatSpecific)
-        continue;
-      if (!(Symflags & object::SymbolRef::SF_Global))
-        continue;
-      if (Symflags & object::SymbolRef::SF_Undefined)
-        continue;
+    StringRef Names = MS.Names;
+    for (unsigned I = 0; I != MS.NumSymbols; ++I) {
+      StringRef Name = Names.substr(0, Names.find('\0'));
+      Names = Names.drop_front(Name.size() + 1);
 
       unsigned NameOffset = NameOS.tell();
-      if (auto EC = S.printName(NameOS))
-        return EC;
-      NameOS << '\0';
+      NameOS << Name << '\0';
       MemberOffsetRefs.push_back(MemberNum);
       if (Kind == object::Archive::K_BSD)
         print32(Out, Kind, NameOffset);
@@ -339,7 +392,8 @@ llvm::writeArchive(StringRef ArcName,
                    std::vector<NewArchiveMember> &NewMembers,
                    bool WriteSymtab, object::Archive::Kind Kind,
                    bool Deterministic, bool Thin,
-                   std::unique_ptr<MemoryBuffer> OldArchiveBuf) {
+                   std::unique_ptr<MemoryBuffer> OldArchiveBuf,
+                   unsigned Threads) {
   assert((!Thin || Kind == object::Archive::K_GNU) &&
          "Only the gnu format has a thin mode");
   SmallString<128> TmpArchive;
@@ -364,7 +418,7 @@ llvm::writeArchive(StringRef ArcName,
   unsigned MemberReferenceOffset = 0;
   if (WriteSymtab) {
     ErrorOr<unsigned> MemberReferenceOffsetOrErr = writeSymbolTable(
-        Out, Kind, NewMembers, MemberOffsetRefs, Deterministic);
+        Out, Kind, NewMembers, MemberOffsetRefs, Deterministic, Threads);
     if (auto EC = MemberReferenceOffsetOrErr.getError())
       return std::make_pair(ArcName, EC);
     MemberReferenceOffset = MemberReferenceOffsetOrErr.get();
@@ -0,0 +1,326 @@
+//===- FlatSummaryIndex.cpp - Flat, mmap-able module summary index --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the writer and the in-place reader for the flat
+// module summary index format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/FlatSummaryIndex.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Object/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace object;
+using namespace flat_summary;
+
+static_assert(sizeof(Header) == 32 && sizeof(ModuleEntry) == 36 &&
+                  sizeof(SummaryEntry) == 48 && sizeof(CallEntry) == 9,
+              "flat summary index records must not be padded");
+
+static Error malformed(MemoryBufferRef Buffer, const Twine &Why) {
+  return make_error<GenericBinaryError>("malformed flat summary index '" +
+                                            Buffer.getBufferIdentifier() +
+                                            "': " + Why,
+                                        object_error::parse_failed);
+}
+
+static GlobalValue::GUID getGUID(const ValueInfo &VI) {
+  if (VI.isGUID())
+    return VI.getGUID();
+  return cast<GlobalValue>(VI.getValue())->getGUID();
+}
+
+template <typename T> static void writeRaw(raw_ostream &OS, const T &V) {
+  OS.write(reinterpret_cast<const char *>(&V), sizeof(T));
+}
+
+void FlatSummaryIndex::write(
+    const ModuleSummaryIndex &Index, raw_ostream &OS,
+    const std::map<std::string, GVSummaryMapTy> *ModuleToSummariesForIndex) {
+  std::vector<std::pair<GlobalValue::GUID, GlobalValueSummary *>> Entries;
+  std::vector<StringRef> Paths;
+  if (ModuleToSummariesForIndex) {
+    for (auto &M : *ModuleToSummariesForIndex) {
+      Paths.push_back(M.first);
+      for (auto &S : M.second)
+        Entries.push_back(S);
+    }
+  } else {
+    for (auto &M : Index.modulePaths())
+      Paths.push_back(M.first());
+    for (auto &I : Index)
+      for (auto &S : I.second)
+        Entries.push_back({I.first, S.get()});
+  }
+  std::sort(Paths.begin(), Paths.end());
+
+  DenseMap<StringRef, unsigned> ModuleNumbers;
+  for (unsigned I = 0, E = Paths.size(); I != E; ++I)
+    ModuleNumbers[Paths[I]] = I;
+  auto getModuleNumber = [&](const GlobalValueSummary *S) {
+    auto It = ModuleNumbers.find(S->modulePath());
+    assert(It != ModuleNumbers.end() && "Summary for an unlisted module");
+    return It->second;
+  };
+
+  std::sort(Entries.begin(), Entries.end(),
+            [&](const std::pair<GlobalValue::GUID, GlobalValueSummary *> &A,
+                const std::pair<GlobalValue::GUID, GlobalValueSummary *> &B) {
+              if (A.first != B.first)
+                return A.first < B.first;
+              return getModuleNumber(A.second) < getModuleNumber(B.second);
+            });
+  DenseMap<const GlobalValueSummary *, unsigned> SummaryNumbers;
+  for (unsigned I = 0, E = Entries.size(); I != E; ++I)
+    SummaryNumbers[Entries[I].second] = I;
+
+  std::string Strings;
+  std::vector<ModuleEntry> ModuleTable(Paths.size());
+  for (unsigned I = 0, E = Paths.size(); I != E; ++I) {
+    auto It = Index.modulePaths().find(Paths[I]);
+    assert(It != Index.modulePaths().end() && "Module not registered");
+    ModuleEntry &M = ModuleTable[I];
+    M.Id = It->second.first;
+    M.PathOffset = Strings.size();
+    M.PathSize = Paths[I].size();
+    for (unsigned J = 0; J != 5; ++J)
+      M.Hash[J] = It->second.second[J];
+    Strings += Paths[I];
+  }
+
+  std::vector<SummaryEntry> SummaryTable(Entries.size());
+  std::vector<support::ulittle64_t> RefTable;
+  std::vector<CallEntry> CallTable;
+  for (unsigned I = 0, E = Entries.size(); I != E; ++I) {
+    GlobalValueSummary *S = Entries[I].second;
+    SummaryEntry &Entry = SummaryTable[I];
+    Entry.GUID = Entries[I].first;
+    Entry.OriginalName =
+        GlobalValue::isLocalLinkage(S->linkage()) ? S->getOriginalName() : 0;
+    Entry.Module = getModuleNumber(S);
+    Entry.Kind = S->getSummaryKind();
+    Entry.Linkage = S->linkage();
+    Entry.Flags = (S->hasSection() ? FlagHasSection : 0) |
+                  (S->isNotViableToInline() ? FlagNotViableToInline : 0);
+    if (auto *VS = dyn_cast<GlobalVarSummary>(S))
+      Entry.Flags |= (VS->isReadOnly() ? FlagReadOnly : 0) |
+                     (VS->isWriteOnly() ? FlagWriteOnly : 0);
+    Entry.Reserved = 0;
+    Entry.InstCount = 0;
+    Entry.Aliasee = 0;
+
+    Entry.FirstRef = RefTable.size();
+    Entry.NumRefs = S->refs().size();
+    for (const ValueInfo &VI : S->refs())
+      RefTable.push_back(support::ulittle64_t(getGUID(VI)));
+
+    Entry.FirstCall = CallTable.size();
+    Entry.NumCalls = 0;
+    if (auto *FS = dyn_cast<FunctionSummary>(S)) {
+      Entry.InstCount = FS->instCount();
+      Entry.NumCalls = FS->calls().size();
+      for (const FunctionSummary::EdgeTy &Call : FS->calls()) {
+        CallEntry C;
+        C.Callee = getGUID(Call.first);
+        C.Hotness = static_cast<uint8_t>(Call.second.Hotness);
+        CallTable.push_back(C);
+      }
+    } else if (auto *AS = dyn_cast<AliasSummary>(S)) {
+      auto It = SummaryNumbers.find(&AS->getAliasee());
+      assert(It != SummaryNumbers.end() && "Aliasee missing from the index");
+      Entry.Aliasee = It->second;
+    }
+  }
+
+  Header Hdr;
+  std::copy(std::begin(Magic), std::end(Magic), Hdr.Magic);
+  Hdr.Version = Version;
+  Hdr.NumModules = ModuleTable.size();
+  Hdr.NumSummaries = SummaryTable.size();
+  Hdr.NumRefs = RefTable.size();
+  Hdr.NumCalls = CallTable.size();
+  Hdr.StringTableSize = Strings.size();
+
+  writeRaw(OS, Hdr);
+  for (const ModuleEntry &M : ModuleTable)
+    writeRaw(OS, M);
+  for (const SummaryEntry &S : SummaryTable)
+    writeRaw(OS, S);
+  for (const support::ulittle64_t &R : RefTable)
+    writeRaw(OS, R);
+  for (const CallEntry &C : CallTable)
+    writeRaw(OS, C);
+  OS << Strings;
+}
+
+bool FlatSummaryIndex::isFlatSummaryIndex(MemoryBufferRef Buffer) {
+  return Buffer.getBuffer().startswith(StringRef(Magic, sizeof(Magic)));
+}
+
+template <typename T>
+static bool getTable(StringRef Data, uint64_t &Offset, uint64_t Count,
+                     ArrayRef<T> &Table) {
+  uint64_t Size = Count * sizeof(T);
+  if (Offset + Size > Data.size())
+    return false;
+  Table =
+      makeArrayRef(reinterpret_cast<const T *>(Data.data() + Offset), Count);
+  Offset += Size;
+  return true;
+}
+
+Error FlatSummaryIndex::parse() {
+  StringRef Data = Buffer.getBuffer();
+  if (Data.size() < sizeof(Header) || !isFlatSummaryIndex(Buffer))
+    return malformed(Buffer, "bad magic");
+  Hdr = reinterpret_cast<const Header *>(Data.data());
+  if (Hdr->Version != Version)
+    return malformed(Buffer, "unsupported version " + Twine(Hdr->Version));
+
+  uint64_t Offset = sizeof(Header);
+  if (!getTable(Data, Offset, Hdr->NumModules, Modules) ||
+      !getTable(Data, Offset, Hdr->NumSummaries, Summaries) ||
+      !getTable(Data, Offset, Hdr->NumRefs, Refs) ||
+      !getTable(Data, Offset, Hdr->NumCalls, Calls) ||
+      Offset + Hdr->StringTableSize != Data.size())
+    return malformed(Buffer, "truncated tables");
+  Strings = Data.substr(Offset);
+
+  // Check every offset once up front so that queries need no bounds checks.
+  for (const ModuleEntry &M : Modules)
+    if (uint64_t(M.PathOffset) + M.PathSize > Strings.size())
+      return malformed(Buffer, "module path out of range");
+  for (const SummaryEntry &S : Summaries) {
+    if (S.Module >= Modules.size() ||
+        S.Kind > GlobalValueSummary::GlobalVarKind ||
+        S.Linkage > GlobalValue::CommonLinkage ||
+        uint64_t(S.FirstRef) + S.NumRefs > Refs.size() ||
+        uint64_t(S.FirstCall) + S.NumCalls > Calls.size() ||
+        (S.Kind == GlobalValueSummary::AliasKind &&
+         S.Aliasee >= Summaries.size()))
+      return malformed(Buffer, "summary out of range");
+  }
+  return Error::success();
+}
+
+Expected<std::unique_ptr<FlatSummaryIndex>>
+FlatSummaryIndex::create(MemoryBufferRef Buffer) {
+  std::unique_ptr<FlatSummaryIndex> Index(new FlatSummaryIndex(Buffer));
+  if (Error E = Index->parse())
+    return std::move(E);
+  return std::move(Index);
+}
+
+Expected<std::unique_ptr<FlatSummaryIndex>>
+FlatSummaryIndex::createFromFile(StringRef Path) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    return errorCodeToError(BufOrErr.getError());
+  Expected<std::unique_ptr<FlatSummaryIndex>> IndexOrErr =
+      create((*BufOrErr)->getMemBufferRef());
+  if (IndexOrErr)
+    (*IndexOrErr)->Owned = std::move(*BufOrErr);
+  return IndexOrErr;
+}
+
+StringRef FlatSummaryIndex::getModulePath(unsigned Module) const {
+  const ModuleEntry &M = Modules[Module];
+  return Strings.substr(M.PathOffset, M.PathSize);
+}
+
+ModuleHash FlatSummaryIndex::getModuleHash(unsigned Module) const {
+  ModuleHash Hash;
+  for (unsigned I = 0; I != 5; ++I)
+    Hash[I] = Modules[Module].Hash[I];
+  return Hash;
+}
+
+namespace {
+struct CompareGUID {
+  bool operator()(const SummaryEntry &S, GlobalValue::GUID GUID) const {
+    return S.GUID < GUID;
+  }
+  bool operator()(GlobalValue::GUID GUID, const SummaryEntry &S) const {
+    return GUID < S.GUID;
+  }
+};
+}
+
+ArrayRef<SummaryEntry>
+FlatSummaryIndex::findSummaries(GlobalValue::GUID GUID) const {
+  auto Range =
+      std::equal_range(Summaries.begin(), Summaries.end(), GUID, CompareGUID());
+  return makeArrayRef(Range.first, Range.second);
+}
+
+const SummaryEntry *
+FlatSummaryIndex::findSummaryInModule(GlobalValue::GUID GUID,
+                                      StringRef ModulePath) const {
+  for (const SummaryEntry &S : findSummaries(GUID))
+    if (getModulePath(S.Module) == ModulePath)
+      return &S;
+  return nullptr;
+}
+
+std::unique_ptr<ModuleSummaryIndex> FlatSummaryIndex::materialize() const {
+  auto Index = llvm::make_unique<ModuleSummaryIndex>();
+
+  std::vector<StringRef> Paths;
+  for (unsigned I = 0, E = Modules.size(); I != E; ++I)
+    Paths.push_back(
+        Index->addModulePath(getModulePath(I), getModuleId(I),
+                             getModuleHash(I))->first());
+
+  std::vector<GlobalValueSummary *> Materialized;
+  for (const SummaryEntry &S : Summaries) {
+    GlobalValueSummary::GVFlags Flags(
+        static_cast<GlobalValue::LinkageTypes>(S.Linkage),
+        S.Flags & FlagHasSection, S.Flags & FlagNotViableToInline);
+    std::unique_ptr<GlobalValueSummary> Summary;
+    switch (S.Kind) {
+    case GlobalValueSummary::FunctionKind: {
+      auto FS = llvm::make_unique<FunctionSummary>(Flags, S.InstCount);
+      for (const CallEntry &C : calls(S))
+        FS->addCallGraphEdge(
+            GlobalValue::GUID(C.Callee),
+            CalleeInfo(static_cast<CalleeInfo::HotnessType>(C.Hotness)));
+      Summary = std::move(FS);
+      break;
+    }
+    case GlobalValueSummary::GlobalVarKind: {
+      auto VS = llvm::make_unique<GlobalVarSummary>(Flags);
+      VS->setReadOnly(S.Flags & FlagReadOnly);
+      VS->setWriteOnly(S.Flags & FlagWriteOnly);
+      Summary = std::move(VS);
+      break;
+    }
+    case GlobalValueSummary::AliasKind:
+      Summary = llvm::make_unique<AliasSummary>(Flags);
+      break;
+    }
+    for (GlobalValue::GUID Ref : refs(S))
+      Summary->addRefEdge(Ref);
+    Summary->setModulePath(Paths[S.Module]);
+    Summary->setOriginalName(S.OriginalName);
+    Materialized.push_back(Summary.get());
+    Index->addGlobalValueSummary(GlobalValue::GUID(S.GUID), std::move(Summary));
+  }
+
+  for (unsigned I = 0, E = Summaries.size(); I != E; ++I)
+    if (auto *AS = dyn_cast<AliasSummary>(Materialized[I]))
+      AS->setAliasee(Materialized[Summaries[I].Aliasee]);
+
+  return Index;
+}
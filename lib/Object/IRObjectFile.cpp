@@ -261,6 +261,97 @@ uint32_t IRObjectFile::getSymbolFlags(DataRefImpl Symb) const {
 
 GlobalValue *IRObjectFile::getSymbolGV(DataRefImpl Symb) { return getGV(Symb); }
 
+// Keep in sync with getSymbolFlags() above, and with
+// llvm::canBeOmittedFromSymbolTable().
+static IRSymbol getLinkerSymbol(const BitcodeGlobalValue &GV,
+                                const DataLayout &DL) {
+  IRSymbol Sym;
+  Sym.Flags = BasicSymbolRef::SF_None;
+  if (GV.IsDeclaration ||
+      GV.Linkage == GlobalValue::AvailableExternallyLinkage)
+    Sym.Flags |= BasicSymbolRef::SF_Undefined;
+  else if (GV.Visibility == GlobalValue::HiddenVisibility &&
+           !GlobalValue::isLocalLinkage(GV.Linkage))
+    Sym.Flags |= BasicSymbolRef::SF_Hidden;
+  if (GV.IsVariable && GV.IsConstant)
+    Sym.Flags |= BasicSymbolRef::SF_Const;
+  if (GV.Linkage == GlobalValue::PrivateLinkage)
+    Sym.Flags |= BasicSymbolRef::SF_FormatSpecific;
+  if (!GlobalValue::isLocalLinkage(GV.Linkage))
+    Sym.Flags |= BasicSymbolRef::SF_Global;
+  if (GV.Linkage == GlobalValue::CommonLinkage)
+    Sym.Flags |= BasicSymbolRef::SF_Common;
+  if (GlobalValue::isLinkOnceLinkage(GV.Linkage) ||
+      GlobalValue::isWeakLinkage(GV.Linkage) ||
+      GV.Linkage == GlobalValue::ExternalWeakLinkage)
+    Sym.Flags |= BasicSymbolRef::SF_Weak;
+  if (StringRef(GV.Name).startswith("llvm.") ||
+      (GV.IsVariable && GV.Section == "llvm.metadata"))
+    Sym.Flags |= BasicSymbolRef::SF_FormatSpecific;
+
+  raw_string_ostream OS(Sym.Name);
+  if (GV.DLLStorageClass == GlobalValue::DLLImportStorageClass)
+    OS << "__imp_";
+  Mangler::getNameWithPrefix(OS, GV.Name, DL);
+  OS.flush();
+
+  Sym.Visibility = GV.Visibility;
+  Sym.CanOmitFromDynSym =
+      GV.Linkage == GlobalValue::LinkOnceODRLinkage &&
+      (GV.UnnamedAddr == GlobalValue::UnnamedAddr::Global ||
+       ((!GV.IsVariable || GV.IsConstant) &&
+        GV.UnnamedAddr == GlobalValue::UnnamedAddr::Local));
+  Sym.Comdat = GV.Comdat;
+  return Sym;
+}
+
+ErrorOr<std::vector<IRSymbol>>
+IRObjectFile::readLinkerSymbols(MemoryBufferRef Object,
+                                std::string &SourceFileName) {
+  ErrorOr<MemoryBufferRef> BCOrErr = findBitcodeInMemBuffer(Object);
+  if (!BCOrErr)
+    return BCOrErr.getError();
+  ErrorOr<BitcodeSymbolTable> SymtabOrErr = readBitcodeSymbolTable(*BCOrErr);
+  if (!SymtabOrErr)
+    return SymtabOrErr.getError();
+  const BitcodeSymbolTable &Symtab = *SymtabOrErr;
+
+  // Module asm symbols need the target's asm parser.
+  if (Symtab.HasModuleAsm)
+    return make_error_code(std::errc::not_supported);
+
+  DataLayout DL(Symtab.DataLayout);
+  std::vector<IRSymbol> Symbols;
+  for (const BitcodeGlobalValue &GV : Symtab.GlobalValues) {
+    if (GV.Name.empty()) {
+      if (GlobalValue::isLocalLinkage(GV.Linkage))
+        continue;
+      // The Mangler numbers unnamed global values.
+      return make_error_code(std::errc::not_supported);
+    }
+    // Microsoft calling conventions add the size of the arguments, which
+    // needs the function type, to the mangled name.
+    bool IsMSCallingConv =
+        GV.CallingConv == CallingConv::X86_VectorCall ||
+        (DL.hasMicrosoftFastStdCallMangling() &&
+         (GV.CallingConv == CallingConv::X86_StdCall ||
+          GV.CallingConv == CallingConv::X86_FastCall));
+    if (IsMSCallingConv && GV.Name[0] != '\1')
+      return make_error_code(std::errc::not_supported);
+
+    IRSymbol Sym = getLinkerSymbol(GV, DL);
+    if (!(Sym.Flags & BasicSymbolRef::SF_Global) ||
+        (Sym.Flags & BasicSymbolRef::SF_FormatSpecific))
+      continue;
+    Symbols.push_back(std::move(Sym));
+  }
+
+  SourceFileName = Symtab.SourceFileName.empty()
+                       ? BCOrErr->getBufferIdentifier().str()
+                       : Symtab.SourceFileName;
+  return std::move(Symbols);
+}
+
 std::unique_ptr<Module> IRObjectFile::takeModule() { return std::move(M); }
 
 basic_symbol_iterator IRObjectFile::symbol_begin_impl() const {
@@ -16,6 +16,7 @@
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Object/FlatSummaryIndex.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -114,6 +115,13 @@ ErrorOr<std::unique_ptr<ModuleSummaryIndex>> llvm::getModuleSummaryIndexForFile(
   if (EC)
     return EC;
   MemoryBufferRef BufferRef = (FileOrErr.get())->getMemBufferRef();
+  if (object::FlatSummaryIndex::isFlatSummaryIndex(BufferRef)) {
+    Expected<std::unique_ptr<object::FlatSummaryIndex>> FlatOrErr =
+        object::FlatSummaryIndex::create(BufferRef);
+    if (!FlatOrErr)
+      return errorToErrorCode(FlatOrErr.takeError());
+    return (*FlatOrErr)->materialize();
+  }
   ErrorOr<std::unique_ptr<object::ModuleSummaryIndexObjectFile>> ObjOrErr =
       object::ModuleSummaryIndexObjectFile::create(BufferRef,
                                                    DiagnosticHandler);
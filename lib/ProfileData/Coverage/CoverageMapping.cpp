@@ -227,10 +227,26 @@ Error CoverageMapping::loadFunctionRecord(
     return Error::success();
   }
 
+  // Index the record under each distinct filename it mentions.
+  unsigned RecordIndex = Functions.size();
+  for (StringRef Filename : Function.Filenames) {
+    std::vector<unsigned> &Indices = FilenameRecordIndices[Filename];
+    if (Indices.empty() || Indices.back() != RecordIndex)
+      Indices.push_back(RecordIndex);
+  }
+
   Functions.push_back(std::move(Function));
   return Error::success();
 }
 
+ArrayRef<unsigned>
+CoverageMapping::getRecordIndicesForFilename(StringRef Filename) const {
+  auto I = FilenameRecordIndices.find(Filename);
+  if (I == FilenameRecordIndices.end())
+    return None;
+  return I->second;
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(CoverageMappingReader &CoverageReader,
                       IndexedInstrProfReader &ProfileReader) {
@@ -441,12 +457,10 @@ public:
 
 std::vector<StringRef> CoverageMapping::getUniqueSourceFiles() const {
   std::vector<StringRef> Filenames;
-  for (const auto &Function : getCoveredFunctions())
-    Filenames.insert(Filenames.end(), Function.Filenames.begin(),
-                     Function.Filenames.end());
+  Filenames.reserve(FilenameRecordIndices.size());
+  for (const auto &Entry : FilenameRecordIndices)
+    Filenames.push_back(Entry.getKey());
   std::sort(Filenames.begin(), Filenames.end());
-  auto Last = std::unique(Filenames.begin(), Filenames.end());
-  Filenames.erase(Last, Filenames.end());
   return Filenames;
 }
 
@@ -489,7 +503,8 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
   CoverageData FileCoverage(Filename);
   std::vector<coverage::CountedRegion> Regions;
 
-  for (const auto &Function : Functions) {
+  for (unsigned RecordIndex : getRecordIndicesForFilename(Filename)) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     auto FileIDs = gatherFileIDs(Filename, Function);
     for (const auto &CR : Function.CountedRegions)
@@ -509,7 +524,8 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
 std::vector<const FunctionRecord *>
 CoverageMapping::getInstantiations(StringRef Filename) const {
   FunctionInstantiationSetCollector InstantiationSetCollector;
-  for (const auto &Function : Functions) {
+  for (unsigned RecordIndex : getRecordIndicesForFilename(Filename)) {
+    const FunctionRecord &Function = Functions[RecordIndex];
     auto MainFileID = findMainViewFileID(Filename, Function);
     if (!MainFileID)
       continue;
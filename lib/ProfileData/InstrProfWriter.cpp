@@ -170,7 +170,9 @@ void InstrProfWriter::setOutputSparse(bool Sparse) {
 }
 
 Error InstrProfWriter::addRecord(InstrProfRecord &&I, uint64_t Weight) {
-  auto &ProfileDataMap = FunctionData[I.Name];
+  auto &Entry = *FunctionData.insert(std::make_pair(I.Name, ProfilingData()))
+                     .first;
+  auto &ProfileDataMap = Entry.getValue();
 
   bool NewFunc;
   ProfilingData::iterator Where;
@@ -182,7 +184,7 @@ Error InstrProfWriter::addRecord(InstrProfRecord &&I, uint64_t Weight) {
     // We've never seen a function with this name and hash, add it.
     Dest = std::move(I);
     // Fix up the name to avoid dangling reference.
-    Dest.Name = FunctionData.find(Dest.Name)->getKey();
+    Dest.Name = Entry.getKey();
     if (Weight > 1)
       Dest.scale(Weight);
   } else {
@@ -196,10 +198,17 @@ Error InstrProfWriter::addRecord(InstrProfRecord &&I, uint64_t Weight) {
 }
 
 Error InstrProfWriter::mergeRecordsFromWriter(InstrProfWriter &&IPW) {
-  for (auto &I : IPW.FunctionData)
-    for (auto &Func : I.getValue())
+  for (auto I = IPW.FunctionData.begin(), IE = IPW.FunctionData.end();
+       I != IE;) {
+    for (auto &Func : I->getValue())
       if (Error E = addRecord(std::move(Func.second), 1))
         return E;
+    // The merged records now live in this writer, drop the moved-from
+    // entries right away rather than when IPW is destroyed.
+    auto Merged = I;
+    ++I;
+    IPW.FunctionData.erase(Merged);
+  }
   return Error::success();
 }
 
@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
@@ -364,6 +365,18 @@ SampleProfileReaderBinary::readProfile(FunctionSamples &FProfile) {
 
 std::error_code SampleProfileReaderBinary::read() {
   while (!at_eof()) {
+    // Since version 104, every function body starts with its size, so the
+    // bodies of functions that are not needed can be skipped.
+    const uint8_t *Next = nullptr;
+    if (Version >= 104) {
+      auto Size = readNumber<uint64_t>();
+      if (std::error_code EC = Size.getError())
+        return EC;
+      if (*Size > uint64_t(End - Data))
+        return sampleprof_error::truncated;
+      Next = Data + *Size;
+    }
+
     auto NumHeadSamples = readNumber<uint64_t>();
     if (std::error_code EC = NumHeadSamples.getError())
       return EC;
@@ -372,6 +385,11 @@ std::error_code SampleProfileReaderBinary::read() {
     if (std::error_code EC = FName.getError())
       return EC;
 
+    if (Next && !UseAllFuncs && !FuncsToUse.count(*FName)) {
+      Data = Next;
+      continue;
+    }
+
     Profiles[*FName] = FunctionSamples();
     FunctionSamples &FProfile = Profiles[*FName];
     FProfile.setName(*FName);
@@ -380,6 +398,8 @@ std::error_code SampleProfileReaderBinary::read() {
 
     if (std::error_code EC = readProfile(FProfile))
       return EC;
+    if (Next)
+      Data = Next;
   }
 
   return sampleprof_error::success;
@@ -396,12 +416,14 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   else if (*Magic != SPMagic())
     return sampleprof_error::bad_magic;
 
-  // Read the version number.
-  auto Version = readNumber<uint64_t>();
-  if (std::error_code EC = Version.getError())
+  // Read the version number. Version 103 only differs in not having the
+  // size of each function body.
+  auto VersionOrErr = readNumber<uint64_t>();
+  if (std::error_code EC = VersionOrErr.getError())
     return EC;
-  else if (*Version != SPVersion())
+  else if (*VersionOrErr != SPVersion() && *VersionOrErr != 103)
     return sampleprof_error::unsupported_version;
+  Version = *VersionOrErr;
 
   if (std::error_code EC = readSummary())
     return EC;
@@ -790,6 +812,14 @@ SampleProfileReader::create(std::unique_ptr<MemoryBuffer> &B, LLVMContext &C) {
   return std::move(Reader);
 }
 
+void SampleProfileReader::collectFuncsToUse(const Module &M) {
+  UseAllFuncs = false;
+  FuncsToUse.clear();
+  for (const Function &F : M)
+    if (!F.isDeclaration())
+      FuncsToUse.insert(F.getName());
+}
+
 // For text and GCC file formats, we compute the summary after reading the
 // profile. Binary format has the profile summary in its header.
 void SampleProfileReader::computeSummary() {
@@ -196,8 +196,20 @@ std::error_code SampleProfileWriterBinary::writeBody(const FunctionSamples &S) {
 ///
 /// \returns true if the samples were written successfully, false otherwise.
 std::error_code SampleProfileWriterBinary::write(const FunctionSamples &S) {
+  // Emit the function body into a buffer first, so that it can be preceded
+  // by its size.
+  SmallString<256> Body;
+  std::unique_ptr<raw_ostream> BodyOS(new raw_svector_ostream(Body));
+  std::swap(OutputStream, BodyOS);
   encodeULEB128(S.getHeadSamples(), *OutputStream);
-  return writeBody(S);
+  std::error_code EC = writeBody(S);
+  std::swap(OutputStream, BodyOS);
+  if (EC)
+    return EC;
+
+  encodeULEB128(Body.size(), *OutputStream);
+  *OutputStream << Body;
+  return sampleprof_error::success;
 }
 
 /// \brief Create a sample profile file writer based on the specified format.
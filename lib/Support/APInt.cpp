@@ -47,6 +47,21 @@ inline static uint64_t* getMemory(unsigned numWords) {
   return result;
 }
 
+#ifdef __SIZEOF_INT128__
+/// Values of 65 to 128 bits are two words, which the compiler can operate on
+/// natively as a 128-bit integer.
+typedef unsigned __int128 uint128;
+
+inline static uint128 getInt128(const uint64_t *Words) {
+  return (uint128)Words[1] << 64 | Words[0];
+}
+
+inline static void setInt128(uint64_t *Words, uint128 Val) {
+  Words[0] = (uint64_t)Val;
+  Words[1] = (uint64_t)(Val >> 64);
+}
+#endif
+
 /// A utility function that converts a character to a digit.
 inline static unsigned getDigit(char cdigit, uint8_t radix) {
   unsigned r;
@@ -75,17 +90,26 @@ inline static unsigned getDigit(char cdigit, uint8_t radix) {
 }
 
 
+void APInt::allocateWords(bool Cleared) {
+  if (isInline()) {
+    if (Cleared)
+      memset(InlineVal, 0, sizeof(InlineVal));
+    return;
+  }
+  pVal = Cleared ? getClearedMemory(getNumWords()) : getMemory(getNumWords());
+}
+
 void APInt::initSlowCase(uint64_t val, bool isSigned) {
-  pVal = getClearedMemory(getNumWords());
-  pVal[0] = val;
+  allocateWords(/*Cleared=*/true);
+  getWords()[0] = val;
   if (isSigned && int64_t(val) < 0)
     for (unsigned i = 1; i < getNumWords(); ++i)
-      pVal[i] = -1ULL;
+      getWords()[i] = -1ULL;
 }
 
 void APInt::initSlowCase(const APInt& that) {
-  pVal = getMemory(getNumWords());
-  memcpy(pVal, that.pVal, getNumWords() * APINT_WORD_SIZE);
+  allocateWords(/*Cleared=*/false);
+  memcpy(getWords(), that.getWords(), getNumWords() * APINT_WORD_SIZE);
 }
 
 void APInt::initFromArray(ArrayRef<uint64_t> bigVal) {
@@ -95,11 +119,11 @@ void APInt::initFromArray(ArrayRef<uint64_t> bigVal) {
     VAL = bigVal[0];
   else {
     // Get memory, cleared to 0
-    pVal = getClearedMemory(getNumWords());
+    allocateWords(/*Cleared=*/true);
     // Calculate the number of words to copy
     unsigned words = std::min<unsigned>(bigVal.size(), getNumWords());
-    // Copy the words from bigVal to pVal
-    memcpy(pVal, bigVal.data(), words * APINT_WORD_SIZE);
+    // Copy the words from bigVal to our storage
+    memcpy(getWords(), bigVal.data(), words * APINT_WORD_SIZE);
   }
   // Make sure unused high bits are cleared
   clearUnusedBits();
@@ -126,30 +150,24 @@ APInt& APInt::AssignSlowCase(const APInt& RHS) {
   if (this == &RHS)
     return *this;
 
-  if (BitWidth == RHS.getBitWidth()) {
-    // assume same bit-width single-word case is already handled
+  if (getNumWords() == RHS.getNumWords()) {
+    // assume case where both are single words is already handled
     assert(!isSingleWord());
-    memcpy(pVal, RHS.pVal, getNumWords() * APINT_WORD_SIZE);
-    return *this;
+    // The storage, inline or on the heap, can be reused.
+    BitWidth = RHS.BitWidth;
+    memcpy(getWords(), RHS.getWords(), getNumWords() * APINT_WORD_SIZE);
+    return clearUnusedBits();
   }
 
-  if (isSingleWord()) {
-    // assume case where both are single words is already handled
-    assert(!RHS.isSingleWord());
-    VAL = 0;
-    pVal = getMemory(RHS.getNumWords());
-    memcpy(pVal, RHS.pVal, RHS.getNumWords() * APINT_WORD_SIZE);
-  } else if (getNumWords() == RHS.getNumWords())
-    memcpy(pVal, RHS.pVal, RHS.getNumWords() * APINT_WORD_SIZE);
-  else if (RHS.isSingleWord()) {
+  if (needsCleanup())
     delete [] pVal;
+  BitWidth = RHS.BitWidth;
+  if (isSingleWord()) {
     VAL = RHS.VAL;
   } else {
-    delete [] pVal;
-    pVal = getMemory(RHS.getNumWords());
-    memcpy(pVal, RHS.pVal, RHS.getNumWords() * APINT_WORD_SIZE);
+    allocateWords(/*Cleared=*/false);
+    memcpy(getWords(), RHS.getWords(), getNumWords() * APINT_WORD_SIZE);
   }
-  BitWidth = RHS.BitWidth;
   return clearUnusedBits();
 }
 
@@ -157,8 +175,8 @@ APInt& APInt::operator=(uint64_t RHS) {
   if (isSingleWord())
     VAL = RHS;
   else {
-    pVal[0] = RHS;
-    memset(pVal+1, 0, (getNumWords() - 1) * APINT_WORD_SIZE);
+    getWords()[0] = RHS;
+    memset(getWords()+1, 0, (getNumWords() - 1) * APINT_WORD_SIZE);
   }
   return clearUnusedBits();
 }
@@ -174,7 +192,7 @@ void APInt::Profile(FoldingSetNodeID& ID) const {
 
   unsigned NumWords = getNumWords();
   for (unsigned i = 0; i < NumWords; ++i)
-    ID.AddInteger(pVal[i]);
+    ID.AddInteger(getWords()[i]);
 }
 
 /// This function adds a single "digit" integer, y, to the multiple
@@ -199,7 +217,7 @@ APInt& APInt::operator++() {
   if (isSingleWord())
     ++VAL;
   else
-    add_1(pVal, pVal, getNumWords(), 1);
+    add_1(getWords(), getWords(), getNumWords(), 1);
   return clearUnusedBits();
 }
 
@@ -228,7 +246,7 @@ APInt& APInt::operator--() {
   if (isSingleWord())
     --VAL;
   else
-    sub_1(pVal, getNumWords(), 1);
+    sub_1(getWords(), getNumWords(), 1);
   return clearUnusedBits();
 }
 
@@ -255,7 +273,7 @@ APInt& APInt::operator+=(const APInt& RHS) {
   if (isSingleWord())
     VAL += RHS.VAL;
   else {
-    add(pVal, pVal, RHS.pVal, getNumWords());
+    add(getWords(), getWords(), RHS.getWords(), getNumWords());
   }
   return clearUnusedBits();
 }
@@ -264,7 +282,7 @@ APInt& APInt::operator+=(uint64_t RHS) {
   if (isSingleWord())
     VAL += RHS;
   else
-    add_1(pVal, pVal, getNumWords(), RHS);
+    add_1(getWords(), getWords(), getNumWords(), RHS);
   return clearUnusedBits();
 }
 
@@ -290,7 +308,7 @@ APInt& APInt::operator-=(const APInt& RHS) {
   if (isSingleWord())
     VAL -= RHS.VAL;
   else
-    sub(pVal, pVal, RHS.pVal, getNumWords());
+    sub(getWords(), getWords(), RHS.getWords(), getNumWords());
   return clearUnusedBits();
 }
 
@@ -298,7 +316,7 @@ APInt& APInt::operator-=(uint64_t RHS) {
   if (isSingleWord())
     VAL -= RHS;
   else
-    sub_1(pVal, getNumWords(), RHS);
+    sub_1(getWords(), getNumWords(), RHS);
   return clearUnusedBits();
 }
 
@@ -306,7 +324,8 @@ APInt& APInt::operator-=(uint64_t RHS) {
 /// into dest.
 /// @returns the carry out of the multiplication.
 /// @brief Multiply a multi-digit APInt by a single digit (64-bit) integer.
-static uint64_t mul_1(uint64_t dest[], uint64_t x[], unsigned len, uint64_t y) {
+static uint64_t mul_1(uint64_t dest[], const uint64_t x[], unsigned len,
+                      uint64_t y) {
   // Split y into high 32-bit part (hy)  and low 32-bit part (ly)
   uint64_t ly = y & 0xffffffffULL, hy = y >> 32;
   uint64_t carry = 0;
@@ -340,8 +359,8 @@ static uint64_t mul_1(uint64_t dest[], uint64_t x[], unsigned len, uint64_t y) {
 /// Multiplies integer array x by integer array y and stores the result into
 /// the integer array dest. Note that dest's size must be >= xlen + ylen.
 /// @brief Generalized multiplicate of integer arrays.
-static void mul(uint64_t dest[], uint64_t x[], unsigned xlen, uint64_t y[],
-                unsigned ylen) {
+static void mul(uint64_t dest[], const uint64_t x[], unsigned xlen,
+                const uint64_t y[], unsigned ylen) {
   dest[xlen] = mul_1(dest, x, xlen, y[0]);
   for (unsigned i = 1; i < ylen; ++i) {
     uint64_t ly = y[i] & 0xffffffffULL, hy = y[i] >> 32;
@@ -378,6 +397,13 @@ APInt& APInt::operator*=(const APInt& RHS) {
     return *this;
   }
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    setInt128(getWords(), getInt128(getWords()) * getInt128(RHS.getWords()));
+    return clearUnusedBits();
+  }
+#endif
+
   // Get some bit facts about LHS and check for zero
   unsigned lhsBits = getActiveBits();
   unsigned lhsWords = !lhsBits ? 0 : whichWord(lhsBits - 1) + 1;
@@ -399,12 +425,12 @@ APInt& APInt::operator*=(const APInt& RHS) {
   uint64_t *dest = getMemory(destWords);
 
   // Perform the long multiply
-  mul(dest, pVal, lhsWords, RHS.pVal, rhsWords);
+  mul(dest, getWords(), lhsWords, RHS.getWords(), rhsWords);
 
   // Copy result back into *this
   clearAllBits();
   unsigned wordsToCopy = destWords >= getNumWords() ? getNumWords() : destWords;
-  memcpy(pVal, dest, wordsToCopy * APINT_WORD_SIZE);
+  memcpy(getWords(), dest, wordsToCopy * APINT_WORD_SIZE);
   clearUnusedBits();
 
   // delete dest array and return
@@ -420,7 +446,7 @@ APInt& APInt::operator&=(const APInt& RHS) {
   }
   unsigned numWords = getNumWords();
   for (unsigned i = 0; i < numWords; ++i)
-    pVal[i] &= RHS.pVal[i];
+    getWords()[i] &= RHS.getWords()[i];
   return *this;
 }
 
@@ -432,7 +458,7 @@ APInt& APInt::operator|=(const APInt& RHS) {
   }
   unsigned numWords = getNumWords();
   for (unsigned i = 0; i < numWords; ++i)
-    pVal[i] |= RHS.pVal[i];
+    getWords()[i] |= RHS.getWords()[i];
   return *this;
 }
 
@@ -445,33 +471,32 @@ APInt& APInt::operator^=(const APInt& RHS) {
   }
   unsigned numWords = getNumWords();
   for (unsigned i = 0; i < numWords; ++i)
-    pVal[i] ^= RHS.pVal[i];
+    getWords()[i] ^= RHS.getWords()[i];
   return clearUnusedBits();
 }
 
 APInt APInt::AndSlowCase(const APInt& RHS) const {
   unsigned numWords = getNumWords();
-  uint64_t* val = getMemory(numWords);
+  APInt Result(BitWidth, UninitializedTag());
   for (unsigned i = 0; i < numWords; ++i)
-    val[i] = pVal[i] & RHS.pVal[i];
-  return APInt(val, getBitWidth());
+    Result.getWords()[i] = getWords()[i] & RHS.getWords()[i];
+  return Result;
 }
 
 APInt APInt::OrSlowCase(const APInt& RHS) const {
   unsigned numWords = getNumWords();
-  uint64_t *val = getMemory(numWords);
+  APInt Result(BitWidth, UninitializedTag());
   for (unsigned i = 0; i < numWords; ++i)
-    val[i] = pVal[i] | RHS.pVal[i];
-  return APInt(val, getBitWidth());
+    Result.getWords()[i] = getWords()[i] | RHS.getWords()[i];
+  return Result;
 }
 
 APInt APInt::XorSlowCase(const APInt& RHS) const {
   unsigned numWords = getNumWords();
-  uint64_t *val = getMemory(numWords);
+  APInt Result(BitWidth, UninitializedTag());
   for (unsigned i = 0; i < numWords; ++i)
-    val[i] = pVal[i] ^ RHS.pVal[i];
+    Result.getWords()[i] = getWords()[i] ^ RHS.getWords()[i];
 
-  APInt Result(val, getBitWidth());
   // 0^0==1 so clear the high bits in case they got set.
   Result.clearUnusedBits();
   return Result;
@@ -487,13 +512,13 @@ APInt APInt::operator*(const APInt& RHS) const {
 }
 
 bool APInt::EqualSlowCase(const APInt& RHS) const {
-  return std::equal(pVal, pVal + getNumWords(), RHS.pVal);
+  return std::equal(getWords(), getWords() + getNumWords(), RHS.getWords());
 }
 
 bool APInt::EqualSlowCase(uint64_t Val) const {
   unsigned n = getActiveBits();
   if (n <= APINT_BITS_PER_WORD)
-    return pVal[0] == Val;
+    return getWords()[0] == Val;
   else
     return false;
 }
@@ -517,14 +542,14 @@ bool APInt::ult(const APInt& RHS) const {
 
   // If they bot fit in a word, just compare the low order word
   if (n1 <= APINT_BITS_PER_WORD && n2 <= APINT_BITS_PER_WORD)
-    return pVal[0] < RHS.pVal[0];
+    return getWords()[0] < RHS.getWords()[0];
 
   // Otherwise, compare all words
   unsigned topWord = whichWord(std::max(n1,n2)-1);
   for (int i = topWord; i >= 0; --i) {
-    if (pVal[i] > RHS.pVal[i])
+    if (getWords()[i] > RHS.getWords()[i])
       return false;
-    if (pVal[i] < RHS.pVal[i])
+    if (getWords()[i] < RHS.getWords()[i])
       return true;
   }
   return false;
@@ -554,7 +579,7 @@ void APInt::setBit(unsigned bitPosition) {
   if (isSingleWord())
     VAL |= maskBit(bitPosition);
   else
-    pVal[whichWord(bitPosition)] |= maskBit(bitPosition);
+    getWords()[whichWord(bitPosition)] |= maskBit(bitPosition);
 }
 
 /// Set the given bit to 0 whose position is given as "bitPosition".
@@ -563,7 +588,7 @@ void APInt::clearBit(unsigned bitPosition) {
   if (isSingleWord())
     VAL &= ~maskBit(bitPosition);
   else
-    pVal[whichWord(bitPosition)] &= ~maskBit(bitPosition);
+    getWords()[whichWord(bitPosition)] &= ~maskBit(bitPosition);
 }
 
 /// @brief Toggle every bit to its opposite value.
@@ -634,7 +659,7 @@ hash_code llvm::hash_value(const APInt &Arg) {
   if (Arg.isSingleWord())
     return hash_combine(Arg.VAL);
 
-  return hash_combine_range(Arg.pVal, Arg.pVal + Arg.getNumWords());
+  return hash_combine_range(Arg.getWords(), Arg.getWords() + Arg.getNumWords());
 }
 
 bool APInt::isSplat(unsigned SplatSizeInBits) const {
@@ -659,7 +684,7 @@ APInt APInt::getLoBits(unsigned numBits) const {
 unsigned APInt::countLeadingZerosSlowCase() const {
   unsigned Count = 0;
   for (int i = getNumWords()-1; i >= 0; --i) {
-    integerPart V = pVal[i];
+    integerPart V = getWords()[i];
     if (V == 0)
       Count += APINT_BITS_PER_WORD;
     else {
@@ -686,13 +711,13 @@ unsigned APInt::countLeadingOnes() const {
     shift = APINT_BITS_PER_WORD - highWordBits;
   }
   int i = getNumWords() - 1;
-  unsigned Count = llvm::countLeadingOnes(pVal[i] << shift);
+  unsigned Count = llvm::countLeadingOnes(getWords()[i] << shift);
   if (Count == highWordBits) {
     for (i--; i >= 0; --i) {
-      if (pVal[i] == -1ULL)
+      if (getWords()[i] == -1ULL)
         Count += APINT_BITS_PER_WORD;
       else {
-        Count += llvm::countLeadingOnes(pVal[i]);
+        Count += llvm::countLeadingOnes(getWords()[i]);
         break;
       }
     }
@@ -705,33 +730,33 @@ unsigned APInt::countTrailingZeros() const {
     return std::min(unsigned(llvm::countTrailingZeros(VAL)), BitWidth);
   unsigned Count = 0;
   unsigned i = 0;
-  for (; i < getNumWords() && pVal[i] == 0; ++i)
+  for (; i < getNumWords() && getWords()[i] == 0; ++i)
     Count += APINT_BITS_PER_WORD;
   if (i < getNumWords())
-    Count += llvm::countTrailingZeros(pVal[i]);
+    Count += llvm::countTrailingZeros(getWords()[i]);
   return std::min(Count, BitWidth);
 }
 
 unsigned APInt::countTrailingOnesSlowCase() const {
   unsigned Count = 0;
   unsigned i = 0;
-  for (; i < getNumWords() && pVal[i] == -1ULL; ++i)
+  for (; i < getNumWords() && getWords()[i] == -1ULL; ++i)
     Count += APINT_BITS_PER_WORD;
   if (i < getNumWords())
-    Count += llvm::countTrailingOnes(pVal[i]);
+    Count += llvm::countTrailingOnes(getWords()[i]);
   return std::min(Count, BitWidth);
 }
 
 unsigned APInt::countPopulationSlowCase() const {
   unsigned Count = 0;
   for (unsigned i = 0; i < getNumWords(); ++i)
-    Count += llvm::countPopulation(pVal[i]);
+    Count += llvm::countPopulation(getWords()[i]);
   return Count;
 }
 
 /// Perform a logical right-shift from Src to Dst, which must be equal or
 /// non-overlapping, of Words words, by Shift, which must be less than 64.
-static void lshrNear(uint64_t *Dst, uint64_t *Src, unsigned Words,
+static void lshrNear(uint64_t *Dst, const uint64_t *Src, unsigned Words,
                      unsigned Shift) {
   uint64_t Carry = 0;
   for (int I = Words - 1; I >= 0; --I) {
@@ -759,9 +784,9 @@ APInt APInt::byteSwap() const {
 
   APInt Result(getNumWords() * APINT_BITS_PER_WORD, 0);
   for (unsigned I = 0, N = getNumWords(); I != N; ++I)
-    Result.pVal[I] = ByteSwap_64(pVal[N - I - 1]);
+    Result.getWords()[I] = ByteSwap_64(getWords()[N - I - 1]);
   if (Result.BitWidth != BitWidth) {
-    lshrNear(Result.pVal, Result.pVal, getNumWords(),
+    lshrNear(Result.getWords(), Result.getWords(), getNumWords(),
              Result.BitWidth - BitWidth);
     Result.BitWidth = BitWidth;
   }
@@ -888,17 +913,18 @@ double APInt::roundToDouble(bool isSigned) const {
   exp += 1023; // Increment for 1023 bias
 
   // Number of bits in mantissa is 52. To obtain the mantissa value, we must
-  // extract the high 52 bits from the correct words in pVal.
+  // extract the high 52 bits from the correct words of Tmp.
   uint64_t mantissa;
   unsigned hiWord = whichWord(n-1);
   if (hiWord == 0) {
-    mantissa = Tmp.pVal[0];
+    mantissa = Tmp.getWords()[0];
     if (n > 52)
       mantissa >>= n - 52; // shift down, we want the top 52 bits.
   } else {
     assert(hiWord > 0 && "huh?");
-    uint64_t hibits = Tmp.pVal[hiWord] << (52 - n % APINT_BITS_PER_WORD);
-    uint64_t lobits = Tmp.pVal[hiWord-1] >> (11 + n % APINT_BITS_PER_WORD);
+    uint64_t hibits = Tmp.getWords()[hiWord] << (52 - n % APINT_BITS_PER_WORD);
+    uint64_t lobits =
+        Tmp.getWords()[hiWord-1] >> (11 + n % APINT_BITS_PER_WORD);
     mantissa = hibits | lobits;
   }
 
@@ -920,17 +946,17 @@ APInt APInt::trunc(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, getRawData()[0]);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, UninitializedTag());
 
   // Copy full words.
   unsigned i;
   for (i = 0; i != width / APINT_BITS_PER_WORD; i++)
-    Result.pVal[i] = pVal[i];
+    Result.getWords()[i] = getWords()[i];
 
   // Truncate and copy any partial word.
   unsigned bits = (0 - width) % APINT_BITS_PER_WORD;
   if (bits != 0)
-    Result.pVal[i] = pVal[i] << bits >> bits;
+    Result.getWords()[i] = getWords()[i] << bits >> bits;
 
   return Result;
 }
@@ -945,14 +971,14 @@ APInt APInt::sext(unsigned width) const {
     return APInt(width, val >> (APINT_BITS_PER_WORD - width));
   }
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, UninitializedTag());
 
   // Copy full words.
   unsigned i;
   uint64_t word = 0;
   for (i = 0; i != BitWidth / APINT_BITS_PER_WORD; i++) {
     word = getRawData()[i];
-    Result.pVal[i] = word;
+    Result.getWords()[i] = word;
   }
 
   // Read and sign-extend any partial word.
@@ -964,14 +990,14 @@ APInt APInt::sext(unsigned width) const {
 
   // Write remaining full words.
   for (; i != width / APINT_BITS_PER_WORD; i++) {
-    Result.pVal[i] = word;
+    Result.getWords()[i] = word;
     word = (int64_t)word >> (APINT_BITS_PER_WORD - 1);
   }
 
   // Write any partial word.
   bits = (0 - width) % APINT_BITS_PER_WORD;
   if (bits != 0)
-    Result.pVal[i] = word << bits >> bits;
+    Result.getWords()[i] = word << bits >> bits;
 
   return Result;
 }
@@ -983,15 +1009,16 @@ APInt APInt::zext(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, VAL);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, UninitializedTag());
 
   // Copy words.
   unsigned i;
   for (i = 0; i != getNumWords(); i++)
-    Result.pVal[i] = getRawData()[i];
+    Result.getWords()[i] = getRawData()[i];
 
   // Zero remaining words.
-  memset(&Result.pVal[i], 0, (Result.getNumWords() - i) * APINT_WORD_SIZE);
+  memset(&Result.getWords()[i], 0,
+         (Result.getNumWords() - i) * APINT_WORD_SIZE);
 
   return Result;
 }
@@ -1055,8 +1082,20 @@ APInt APInt::ashr(unsigned shiftAmt) const {
       return APInt(BitWidth, 0);
   }
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    // Sign extend to 128 bits, then use the native arithmetic shift.
+    unsigned SignShift = 128 - BitWidth;
+    __int128 Val = (__int128)(getInt128(getWords()) << SignShift) >> SignShift;
+    APInt Result(BitWidth, UninitializedTag());
+    setInt128(Result.getWords(), (uint128)(Val >> shiftAmt));
+    return Result.clearUnusedBits();
+  }
+#endif
+
   // Create some space for the result.
-  uint64_t * val = new uint64_t[getNumWords()];
+  APInt Result(BitWidth, UninitializedTag());
+  uint64_t *val = Result.getWords();
 
   // Compute some values needed by the following shift algorithms
   unsigned wordShift = shiftAmt % APINT_BITS_PER_WORD; // bits to shift per word
@@ -1070,7 +1109,7 @@ APInt APInt::ashr(unsigned shiftAmt) const {
   if (wordShift == 0) {
     // Move the words containing significant bits
     for (unsigned i = 0; i <= breakWord; ++i)
-      val[i] = pVal[i+offset]; // move whole word
+      val[i] = getWords()[i+offset]; // move whole word
 
     // Adjust the top significant word for sign bit fill, if negative
     if (isNegative())
@@ -1081,13 +1120,13 @@ APInt APInt::ashr(unsigned shiftAmt) const {
     for (unsigned i = 0; i < breakWord; ++i) {
       // This combines the shifted corresponding word with the low bits from
       // the next word (shifted into this word's high bits).
-      val[i] = (pVal[i+offset] >> wordShift) |
-               (pVal[i+offset+1] << (APINT_BITS_PER_WORD - wordShift));
+      val[i] = (getWords()[i+offset] >> wordShift) |
+               (getWords()[i+offset+1] << (APINT_BITS_PER_WORD - wordShift));
     }
 
     // Shift the break word. In this case there are no bits from the next word
     // to include in this word.
-    val[breakWord] = pVal[breakWord+offset] >> wordShift;
+    val[breakWord] = getWords()[breakWord+offset] >> wordShift;
 
     // Deal with sign extension in the break word, and possibly the word before
     // it.
@@ -1106,7 +1145,6 @@ APInt APInt::ashr(unsigned shiftAmt) const {
   uint64_t fillValue = (isNegative() ? -1ULL : 0);
   for (unsigned i = breakWord+1; i < getNumWords(); ++i)
     val[i] = fillValue;
-  APInt Result(val, BitWidth);
   Result.clearUnusedBits();
   return Result;
 }
@@ -1139,13 +1177,21 @@ APInt APInt::lshr(unsigned shiftAmt) const {
   if (shiftAmt == 0)
     return *this;
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    APInt Result(BitWidth, UninitializedTag());
+    setInt128(Result.getWords(), getInt128(getWords()) >> shiftAmt);
+    return Result;
+  }
+#endif
+
   // Create some space for the result.
-  uint64_t * val = new uint64_t[getNumWords()];
+  APInt Result(BitWidth, UninitializedTag());
+  uint64_t *val = Result.getWords();
 
   // If we are shifting less than a word, compute the shift with a simple carry
   if (shiftAmt < APINT_BITS_PER_WORD) {
-    lshrNear(val, pVal, getNumWords(), shiftAmt);
-    APInt Result(val, BitWidth);
+    lshrNear(val, getWords(), getNumWords(), shiftAmt);
     Result.clearUnusedBits();
     return Result;
   }
@@ -1157,10 +1203,9 @@ APInt APInt::lshr(unsigned shiftAmt) const {
   // If we are shifting whole words, just move whole words
   if (wordShift == 0) {
     for (unsigned i = 0; i < getNumWords() - offset; ++i)
-      val[i] = pVal[i+offset];
+      val[i] = getWords()[i+offset];
     for (unsigned i = getNumWords()-offset; i < getNumWords(); i++)
       val[i] = 0;
-    APInt Result(val, BitWidth);
     Result.clearUnusedBits();
     return Result;
   }
@@ -1168,15 +1213,14 @@ APInt APInt::lshr(unsigned shiftAmt) const {
   // Shift the low order words
   unsigned breakWord = getNumWords() - offset -1;
   for (unsigned i = 0; i < breakWord; ++i)
-    val[i] = (pVal[i+offset] >> wordShift) |
-             (pVal[i+offset+1] << (APINT_BITS_PER_WORD - wordShift));
+    val[i] = (getWords()[i+offset] >> wordShift) |
+             (getWords()[i+offset+1] << (APINT_BITS_PER_WORD - wordShift));
   // Shift the break word.
-  val[breakWord] = pVal[breakWord+offset] >> wordShift;
+  val[breakWord] = getWords()[breakWord+offset] >> wordShift;
 
   // Remaining words are 0
   for (unsigned i = breakWord+1; i < getNumWords(); ++i)
     val[i] = 0;
-  APInt Result(val, BitWidth);
   Result.clearUnusedBits();
   return Result;
 }
@@ -1201,17 +1245,25 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
   if (shiftAmt == 0)
     return *this;
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    APInt Result(BitWidth, UninitializedTag());
+    setInt128(Result.getWords(), getInt128(getWords()) << shiftAmt);
+    return Result.clearUnusedBits();
+  }
+#endif
+
   // Create some space for the result.
-  uint64_t * val = new uint64_t[getNumWords()];
+  APInt Result(BitWidth, UninitializedTag());
+  uint64_t *val = Result.getWords();
 
   // If we are shifting less than a word, do it the easy way
   if (shiftAmt < APINT_BITS_PER_WORD) {
     uint64_t carry = 0;
     for (unsigned i = 0; i < getNumWords(); i++) {
-      val[i] = pVal[i] << shiftAmt | carry;
-      carry = pVal[i] >> (APINT_BITS_PER_WORD - shiftAmt);
+      val[i] = getWords()[i] << shiftAmt | carry;
+      carry = getWords()[i] >> (APINT_BITS_PER_WORD - shiftAmt);
     }
-    APInt Result(val, BitWidth);
     Result.clearUnusedBits();
     return Result;
   }
@@ -1225,8 +1277,7 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
     for (unsigned i = 0; i < offset; i++)
       val[i] = 0;
     for (unsigned i = offset; i < getNumWords(); i++)
-      val[i] = pVal[i-offset];
-    APInt Result(val, BitWidth);
+      val[i] = getWords()[i-offset];
     Result.clearUnusedBits();
     return Result;
   }
@@ -1234,12 +1285,11 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
   // Copy whole words from this to Result.
   unsigned i = getNumWords() - 1;
   for (; i > offset; --i)
-    val[i] = pVal[i-offset] << wordShift |
-             pVal[i-offset-1] >> (APINT_BITS_PER_WORD - wordShift);
-  val[offset] = pVal[0] << wordShift;
+    val[i] = getWords()[i-offset] << wordShift |
+             getWords()[i-offset-1] >> (APINT_BITS_PER_WORD - wordShift);
+  val[offset] = getWords()[0] << wordShift;
   for (i = 0; i < offset; ++i)
     val[i] = 0;
-  APInt Result(val, BitWidth);
   Result.clearUnusedBits();
   return Result;
 }
@@ -1290,7 +1340,7 @@ APInt APInt::sqrt() const {
       /* 21-30 */ 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
       /*    31 */ 6
     };
-    return APInt(BitWidth, results[ (isSingleWord() ? VAL : pVal[0]) ]);
+    return APInt(BitWidth, results[ (isSingleWord() ? VAL : getWords()[0]) ]);
   }
 
   // If the magnitude of the value fits in less than 52 bits (the precision of
@@ -1298,8 +1348,8 @@ APInt APInt::sqrt() const {
   // libc sqrt function which will probably use a hardware sqrt computation.
   // This should be faster than the algorithm below.
   if (magnitude < 52) {
-    return APInt(BitWidth,
-                 uint64_t(::round(::sqrt(double(isSingleWord()?VAL:pVal[0])))));
+    uint64_t Val = isSingleWord() ? VAL : getWords()[0];
+    return APInt(BitWidth, uint64_t(::round(::sqrt(double(Val)))));
   }
 
   // Okay, all the short cuts are exhausted. We must compute it. The following
@@ -1677,7 +1727,7 @@ void APInt::divide(const APInt &LHS, unsigned lhsWords, const APInt &RHS,
   // Initialize the dividend
   memset(U, 0, (m+n+1)*sizeof(unsigned));
   for (unsigned i = 0; i < lhsWords; ++i) {
-    uint64_t tmp = (LHS.getNumWords() == 1 ? LHS.VAL : LHS.pVal[i]);
+    uint64_t tmp = (LHS.getNumWords() == 1 ? LHS.VAL : LHS.getWords()[i]);
     U[i * 2] = (unsigned)(tmp & mask);
     U[i * 2 + 1] = (unsigned)(tmp >> (sizeof(unsigned)*CHAR_BIT));
   }
@@ -1686,7 +1736,7 @@ void APInt::divide(const APInt &LHS, unsigned lhsWords, const APInt &RHS,
   // Initialize the divisor
   memset(V, 0, (n)*sizeof(unsigned));
   for (unsigned i = 0; i < rhsWords; ++i) {
-    uint64_t tmp = (RHS.getNumWords() == 1 ? RHS.VAL : RHS.pVal[i]);
+    uint64_t tmp = (RHS.getNumWords() == 1 ? RHS.VAL : RHS.getWords()[i]);
     V[i * 2] = (unsigned)(tmp & mask);
     V[i * 2 + 1] = (unsigned)(tmp >> (sizeof(unsigned)*CHAR_BIT));
   }
@@ -1745,13 +1795,13 @@ void APInt::divide(const APInt &LHS, unsigned lhsWords, const APInt &RHS,
   if (Quotient) {
     // Set up the Quotient value's memory.
     if (Quotient->BitWidth != LHS.BitWidth) {
+      if (Quotient->needsCleanup())
+        delete [] Quotient->pVal;
+      Quotient->BitWidth = LHS.BitWidth;
       if (Quotient->isSingleWord())
         Quotient->VAL = 0;
       else
-        delete [] Quotient->pVal;
-      Quotient->BitWidth = LHS.BitWidth;
-      if (!Quotient->isSingleWord())
-        Quotient->pVal = getClearedMemory(Quotient->getNumWords());
+        Quotient->allocateWords(/*Cleared=*/true);
     } else
       Quotient->clearAllBits();
 
@@ -1765,11 +1815,11 @@ void APInt::divide(const APInt &LHS, unsigned lhsWords, const APInt &RHS,
       if (Quotient->isSingleWord())
         Quotient->VAL = tmp;
       else
-        Quotient->pVal[0] = tmp;
+        Quotient->getWords()[0] = tmp;
     } else {
       assert(!Quotient->isSingleWord() && "Quotient APInt not large enough");
       for (unsigned i = 0; i < lhsWords; ++i)
-        Quotient->pVal[i] =
+        Quotient->getWords()[i] =
           uint64_t(Q[i*2]) | (uint64_t(Q[i*2+1]) << (APINT_BITS_PER_WORD / 2));
     }
   }
@@ -1778,13 +1828,13 @@ void APInt::divide(const APInt &LHS, unsigned lhsWords, const APInt &RHS,
   if (Remainder) {
     // Set up the Remainder value's memory.
     if (Remainder->BitWidth != RHS.BitWidth) {
+      if (Remainder->needsCleanup())
+        delete [] Remainder->pVal;
+      Remainder->BitWidth = RHS.BitWidth;
       if (Remainder->isSingleWord())
         Remainder->VAL = 0;
       else
-        delete [] Remainder->pVal;
-      Remainder->BitWidth = RHS.BitWidth;
-      if (!Remainder->isSingleWord())
-        Remainder->pVal = getClearedMemory(Remainder->getNumWords());
+        Remainder->allocateWords(/*Cleared=*/true);
     } else
       Remainder->clearAllBits();
 
@@ -1796,11 +1846,11 @@ void APInt::divide(const APInt &LHS, unsigned lhsWords, const APInt &RHS,
       if (Remainder->isSingleWord())
         Remainder->VAL = tmp;
       else
-        Remainder->pVal[0] = tmp;
+        Remainder->getWords()[0] = tmp;
     } else {
       assert(!Remainder->isSingleWord() && "Remainder APInt not large enough");
       for (unsigned i = 0; i < rhsWords; ++i)
-        Remainder->pVal[i] =
+        Remainder->getWords()[i] =
           uint64_t(R[i*2]) | (uint64_t(R[i*2+1]) << (APINT_BITS_PER_WORD / 2));
     }
   }
@@ -1823,6 +1873,16 @@ APInt APInt::udiv(const APInt& RHS) const {
     return APInt(BitWidth, VAL / RHS.VAL);
   }
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    assert(RHS != 0 && "Divide by zero?");
+    APInt Result(BitWidth, UninitializedTag());
+    setInt128(Result.getWords(),
+              getInt128(getWords()) / getInt128(RHS.getWords()));
+    return Result;
+  }
+#endif
+
   // Get some facts about the LHS and RHS number of bits and words
   unsigned rhsBits = RHS.getActiveBits();
   unsigned rhsWords = !rhsBits ? 0 : (APInt::whichWord(rhsBits - 1) + 1);
@@ -1842,7 +1902,7 @@ APInt APInt::udiv(const APInt& RHS) const {
     return APInt(BitWidth, 1);
   } else if (lhsWords == 1 && rhsWords == 1) {
     // All high words are zero, just use native divide
-    return APInt(BitWidth, this->pVal[0] / RHS.pVal[0]);
+    return APInt(BitWidth, this->getWords()[0] / RHS.getWords()[0]);
   }
 
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
@@ -1869,6 +1929,16 @@ APInt APInt::urem(const APInt& RHS) const {
     return APInt(BitWidth, VAL % RHS.VAL);
   }
 
+#ifdef __SIZEOF_INT128__
+  if (getNumWords() == 2) {
+    assert(RHS != 0 && "Remainder by zero?");
+    APInt Result(BitWidth, UninitializedTag());
+    setInt128(Result.getWords(),
+              getInt128(getWords()) % getInt128(RHS.getWords()));
+    return Result;
+  }
+#endif
+
   // Get some facts about the LHS
   unsigned lhsBits = getActiveBits();
   unsigned lhsWords = !lhsBits ? 0 : (whichWord(lhsBits - 1) + 1);
@@ -1890,7 +1960,7 @@ APInt APInt::urem(const APInt& RHS) const {
     return APInt(BitWidth, 0);
   } else if (lhsWords == 1) {
     // All high words are zero, just use native remainder
-    return APInt(BitWidth, pVal[0] % RHS.pVal[0]);
+    return APInt(BitWidth, getWords()[0] % RHS.getWords()[0]);
   }
 
   // We have to compute it the hard way. Invoke the Knuth divide algorithm.
@@ -1924,6 +1994,19 @@ void APInt::udivrem(const APInt &LHS, const APInt &RHS,
     return;
   }
 
+#ifdef __SIZEOF_INT128__
+  if (LHS.getNumWords() == 2) {
+    assert(RHS != 0 && "Divide by zero?");
+    uint128 LHSVal = getInt128(LHS.getWords());
+    uint128 RHSVal = getInt128(RHS.getWords());
+    Quotient = APInt(LHS.BitWidth, UninitializedTag());
+    Remainder = APInt(LHS.BitWidth, UninitializedTag());
+    setInt128(Quotient.getWords(), LHSVal / RHSVal);
+    setInt128(Remainder.getWords(), LHSVal % RHSVal);
+    return;
+  }
+#endif
+
   // Get some size facts about the dividend and divisor
   unsigned lhsBits  = LHS.getActiveBits();
   unsigned lhsWords = !lhsBits ? 0 : (APInt::whichWord(lhsBits - 1) + 1);
@@ -1951,8 +2034,8 @@ void APInt::udivrem(const APInt &LHS, const APInt &RHS,
 
   if (lhsWords == 1 && rhsWords == 1) {
     // There is only one word to consider so use the native versions.
-    uint64_t lhsValue = LHS.isSingleWord() ? LHS.VAL : LHS.pVal[0];
-    uint64_t rhsValue = RHS.isSingleWord() ? RHS.VAL : RHS.pVal[0];
+    uint64_t lhsValue = LHS.isSingleWord() ? LHS.VAL : LHS.getWords()[0];
+    uint64_t rhsValue = RHS.isSingleWord() ? RHS.VAL : RHS.getWords()[0];
     Quotient = APInt(LHS.getBitWidth(), lhsValue / rhsValue);
     Remainder = APInt(LHS.getBitWidth(), lhsValue % rhsValue);
     return;
@@ -2081,7 +2164,7 @@ void APInt::fromString(unsigned numbits, StringRef str, uint8_t radix) {
 
   // Allocate memory
   if (!isSingleWord())
-    pVal = getClearedMemory(getNumWords());
+    allocateWords(/*Cleared=*/true);
 
   // Figure out if we can shift instead of multiply
   unsigned shift = (radix == 16 ? 4 : radix == 8 ? 3 : radix == 2 ? 1 : 0);
@@ -2108,7 +2191,7 @@ void APInt::fromString(unsigned numbits, StringRef str, uint8_t radix) {
     if (apdigit.isSingleWord())
       apdigit.VAL = digit;
     else
-      apdigit.pVal[0] = digit;
+      apdigit.getWords()[0] = digit;
     *this += apdigit;
   }
   // If its negative, put it in two's complement form
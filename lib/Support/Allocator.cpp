@@ -37,4 +37,9 @@ void PrintRecyclerStats(size_t Size,
          << "Number of elements free for recycling: " << FreeListSize << '\n';
 }
 
+void PrintSizeClassStats(size_t ClassSize, size_t NumInUse, size_t NumFree) {
+  errs() << "Size class " << ClassSize << ": " << NumInUse << " in use, "
+         << NumFree << " free for recycling\n";
+}
+
 }
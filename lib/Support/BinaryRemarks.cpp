@@ -0,0 +1,238 @@
+//===- BinaryRemarks.cpp - Binary optimization remarks --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the writer and reader of binary optimization remarks.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/BinaryRemarks.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+static const char BlockMagic[] = {'R', 'M', 'R', 'K'};
+static const unsigned Version = 2;
+
+enum RemarkFlags { HasDebugLoc = 1, HasHotness = 2 };
+
+StringRef remarks::getRemarkTag(RemarkKind Kind) {
+  switch (Kind) {
+  case RemarkKind::Passed:
+    return "!Passed";
+  case RemarkKind::Missed:
+    return "!Missed";
+  case RemarkKind::Analysis:
+    return "!Analysis";
+  case RemarkKind::AnalysisFPCommute:
+    return "!AnalysisFPCommute";
+  case RemarkKind::AnalysisAliasing:
+    return "!AnalysisAliasing";
+  case RemarkKind::Failure:
+    return "!Failure";
+  }
+  llvm_unreachable("Unknown remark kind");
+}
+
+bool remarks::isBinaryRemarkFile(StringRef Buffer) {
+  return Buffer.startswith(StringRef(BlockMagic, sizeof(BlockMagic)));
+}
+
+BinaryRemarkWriter::BinaryRemarkWriter(raw_ostream &OS, size_t BlockSize)
+    : OS(OS), FD(nullptr), BlockSize(BlockSize) {}
+
+BinaryRemarkWriter::BinaryRemarkWriter(raw_fd_ostream &OS, size_t BlockSize)
+    : OS(OS), FD(&OS), BlockSize(BlockSize) {}
+
+BinaryRemarkWriter::~BinaryRemarkWriter() { flush(); }
+
+unsigned BinaryRemarkWriter::getStringID(StringRef S) {
+  auto Ins = StringIDs.insert(std::make_pair(S, StringIDs.size()));
+  if (Ins.second) {
+    raw_svector_ostream SOS(Strings);
+    encodeULEB128(S.size(), SOS);
+    SOS << S;
+  }
+  return Ins.first->second;
+}
+
+void BinaryRemarkWriter::write(const Remark &R) {
+  raw_svector_ostream ROS(Remarks);
+  ROS << static_cast<char>(R.Kind);
+  encodeULEB128(getStringID(R.PassName), ROS);
+  encodeULEB128(getStringID(R.RemarkName), ROS);
+  encodeULEB128(getStringID(R.FunctionName), ROS);
+  unsigned Flags = 0;
+  if (!R.File.empty())
+    Flags |= HasDebugLoc;
+  if (R.Hotness)
+    Flags |= HasHotness;
+  encodeULEB128(Flags, ROS);
+  if (Flags & HasDebugLoc) {
+    encodeULEB128(getStringID(R.File), ROS);
+    encodeULEB128(R.Line, ROS);
+    encodeULEB128(R.Column, ROS);
+  }
+  if (Flags & HasHotness)
+    encodeULEB128(*R.Hotness, ROS);
+  encodeULEB128(R.Args.size(), ROS);
+  for (const Argument &Arg : R.Args) {
+    encodeULEB128(getStringID(Arg.Key), ROS);
+    encodeULEB128(getStringID(Arg.Val), ROS);
+    encodeULEB128(Arg.File.empty() ? 0 : HasDebugLoc, ROS);
+    if (!Arg.File.empty()) {
+      encodeULEB128(getStringID(Arg.File), ROS);
+      encodeULEB128(Arg.Line, ROS);
+      encodeULEB128(Arg.Column, ROS);
+    }
+  }
+
+  if (Strings.size() + Remarks.size() >= BlockSize)
+    flush();
+}
+
+void BinaryRemarkWriter::flush() {
+  if (Remarks.empty())
+    return;
+
+  SmallString<16> Count;
+  raw_svector_ostream COS(Count);
+  encodeULEB128(StringIDs.size(), COS);
+
+  SmallString<0> Block;
+  raw_svector_ostream BOS(Block);
+  BOS.write(BlockMagic, sizeof(BlockMagic));
+  encodeULEB128(Version, BOS);
+  encodeULEB128(Count.size() + Strings.size() + Remarks.size(), BOS);
+  BOS << Count << Strings << Remarks;
+
+  if (FD)
+    FD->write_atomic(Block.data(), Block.size());
+  else
+    OS << Block;
+
+  StringIDs.clear();
+  Strings.clear();
+  Remarks.clear();
+}
+
+static Error makeError(const Twine &Msg) {
+  return make_error<StringError>("malformed remark file: " + Msg,
+                                 inconvertibleErrorCode());
+}
+
+static bool readULEB(StringRef &Data, uint64_t &Value) {
+  Value = 0;
+  for (unsigned Shift = 0; !Data.empty() && Shift < 64; Shift += 7) {
+    uint8_t Byte = Data.front();
+    Data = Data.drop_front();
+    Value |= uint64_t(Byte & 0x7f) << Shift;
+    if (Byte < 0x80)
+      return true;
+  }
+  return false;
+}
+
+Error BinaryRemarkReader::startBlock() {
+  if (!isBinaryRemarkFile(Buffer))
+    return makeError("bad block magic");
+  Buffer = Buffer.drop_front(sizeof(BlockMagic));
+
+  uint64_t BlockVersion, Size;
+  if (!readULEB(Buffer, BlockVersion) || BlockVersion != Version)
+    return makeError("unsupported version");
+  if (!readULEB(Buffer, Size) || Size > Buffer.size())
+    return makeError("truncated block");
+  Block = Buffer.take_front(Size);
+  Buffer = Buffer.drop_front(Size);
+
+  uint64_t Count;
+  if (!readULEB(Block, Count) || Count > Block.size())
+    return makeError("bad string table");
+  Strings.clear();
+  Strings.reserve(Count);
+  for (uint64_t I = 0; I != Count; ++I) {
+    uint64_t Length;
+    if (!readULEB(Block, Length) || Length > Block.size())
+      return makeError("bad string table");
+    Strings.push_back(Block.take_front(Length));
+    Block = Block.drop_front(Length);
+  }
+  return Error::success();
+}
+
+Expected<bool> BinaryRemarkReader::next(Remark &R) {
+  while (Block.empty()) {
+    if (Buffer.empty())
+      return false;
+    if (Error E = startBlock())
+      return std::move(E);
+  }
+
+  auto ReadString = [&](StringRef &S) {
+    uint64_t ID;
+    if (!readULEB(Block, ID) || ID >= Strings.size())
+      return false;
+    S = Strings[ID];
+    return true;
+  };
+  auto ReadUnsigned = [&](unsigned &N) {
+    uint64_t V;
+    if (!readULEB(Block, V) || V > UINT32_MAX)
+      return false;
+    N = V;
+    return true;
+  };
+
+  uint8_t Kind = Block.front();
+  Block = Block.drop_front();
+  if (Kind > static_cast<uint8_t>(RemarkKind::LastKind))
+    return makeError("unknown remark kind");
+  R.Kind = static_cast<RemarkKind>(Kind);
+
+  uint64_t Flags;
+  if (!ReadString(R.PassName) || !ReadString(R.RemarkName) ||
+      !ReadString(R.FunctionName) || !readULEB(Block, Flags))
+    return makeError("truncated remark");
+
+  R.File = StringRef();
+  R.Line = R.Column = 0;
+  if ((Flags & HasDebugLoc) &&
+      (!ReadString(R.File) || !ReadUnsigned(R.Line) ||
+       !ReadUnsigned(R.Column)))
+    return makeError("bad debug location");
+
+  R.Hotness = None;
+  if (Flags & HasHotness) {
+    uint64_t Hotness;
+    if (!readULEB(Block, Hotness))
+      return makeError("bad hotness");
+    R.Hotness = Hotness;
+  }
+
+  uint64_t NumArgs;
+  if (!readULEB(Block, NumArgs) || NumArgs > Block.size())
+    return makeError("bad arguments");
+  R.Args.clear();
+  for (uint64_t I = 0; I != NumArgs; ++I) {
+    Argument Arg;
+    uint64_t ArgFlags;
+    if (!ReadString(Arg.Key) || !ReadString(Arg.Val) ||
+        !readULEB(Block, ArgFlags))
+      return makeError("bad arguments");
+    if ((ArgFlags & HasDebugLoc) &&
+        (!ReadString(Arg.File) || !ReadUnsigned(Arg.Line) ||
+         !ReadUnsigned(Arg.Column)))
+      return makeError("bad debug location");
+    R.Args.push_back(Arg);
+  }
+  return true;
+}
@@ -103,6 +103,14 @@ public:
   // This collects the different subcommands that have been registered.
   SmallPtrSet<SubCommand *, 4> RegisteredSubCommands;
 
+  // Options are queued here when they are constructed and only added to the
+  // option maps when something looks at those. Most options are static
+  // objects, and a process that never parses a command line should not pay
+  // for hashing thousands of option names during static initialization. Each
+  // entry holds the name of a literal option, or no name for the option
+  // itself.
+  std::vector<std::pair<Option *, StringRef>> PendingOptions;
+
   CommandLineParser() : ActiveSubCommand(nullptr) {
     registerSubCommand(&*TopLevelSubCommand);
     registerSubCommand(&*AllSubCommands);
@@ -184,6 +192,22 @@ public:
     }
   }
 
+  void queueOption(Option *O, StringRef LiteralName = StringRef()) {
+    PendingOptions.push_back(std::make_pair(O, LiteralName));
+  }
+
+  /// Add the queued options to the option maps, in the order they were
+  /// registered.
+  void addPendingOptions() {
+    for (const auto &P : PendingOptions) {
+      if (P.second.empty())
+        addOption(P.first);
+      else
+        addLiteralOption(*P.first, P.second);
+    }
+    PendingOptions.clear();
+  }
+
   void addOption(Option *O) {
     if (O->Subs.empty()) {
       addOption(O, &*TopLevelSubCommand);
@@ -223,6 +247,7 @@ public:
   }
 
   void removeOption(Option *O) {
+    addPendingOptions();
     if (O->Subs.empty())
       removeOption(O, &*TopLevelSubCommand);
     else {
@@ -262,9 +287,13 @@ public:
   }
 
   void updateArgStr(Option *O, StringRef NewName) {
+    addPendingOptions();
     if (O->Subs.empty())
       updateArgStr(O, NewName, &*TopLevelSubCommand);
-    else {
+    else if (O->isInAllSubCommands()) {
+      for (auto SC : RegisteredSubCommands)
+        updateArgStr(O, NewName, SC);
+    } else {
       for (auto SC : O->Subs)
         updateArgStr(O, NewName, SC);
     }
@@ -292,7 +321,8 @@ public:
     RegisteredSubCommands.insert(sub);
 
     // For all options that have been registered for all subcommands, add the
-    // option to this subcommand now.
+    // option to this subcommand now. Queued options are added to it along
+    // with the other registered subcommands later.
     if (sub != &*AllSubCommands) {
       for (auto &E : AllSubCommands->OptionsMap) {
         Option *O = E.second;
@@ -306,6 +336,8 @@ public:
   }
 
   void unregisterSubCommand(SubCommand *sub) {
+    // Queued options may refer to this subcommand.
+    addPendingOptions();
     RegisteredSubCommands.erase(sub);
   }
 
@@ -344,7 +376,7 @@ private:
 static ManagedStatic<CommandLineParser> GlobalParser;
 
 void cl::AddLiteralOption(Option &O, StringRef Name) {
-  GlobalParser->addLiteralOption(O, Name);
+  GlobalParser->queueOption(&O, Name);
 }
 
 extrahelp::extrahelp(StringRef Help) : morehelp(Help) {
@@ -352,7 +384,7 @@ extrahelp::extrahelp(StringRef Help) : morehelp(Help) {
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
+  GlobalParser->queueOption(this);
   FullyInitialized = true;
 }
 
@@ -411,6 +443,10 @@ Option *CommandLineParser::LookupOption(SubCommand &Sub, StringRef &Arg,
     return nullptr;
   assert(&Sub != &*AllSubCommands);
 
+  // A plugin loaded by an earlier argument (-load) has only queued its
+  // options.
+  addPendingOptions();
+
   size_t EqualPos = Arg.find('=');
 
   // If we have an equals sign, remember the value.
@@ -984,6 +1020,7 @@ bool cl::ParseCommandLineOptions(int argc, const char *const *argv,
 }
 
 void CommandLineParser::ResetAllOptionOccurrences() {
+  addPendingOptions();
   // So that we can parse different command lines multiple times in succession
   // we reset all option values to look like they have never been seen before.
   for (auto SC : RegisteredSubCommands) {
@@ -996,8 +1033,6 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
                                                 const char *const *argv,
                                                 StringRef Overview,
                                                 bool IgnoreErrors) {
-  assert(hasOptions() && "No options specified!");
-
   // Expand response files.
   SmallVector<const char *, 20> newArgv(argv, argv + argc);
   BumpPtrAllocator A;
@@ -1009,6 +1044,11 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
   // Copy the program name into ProgName, making sure not to overflow it.
   ProgramName = sys::path::filename(StringRef(argv[0]));
 
+  // Options registered twice are diagnosed here, now that the program name
+  // is known.
+  addPendingOptions();
+  assert(hasOptions() && "No options specified!");
+
   ProgramOverview = Overview;
   bool ErrorParsing = false;
 
@@ -1742,6 +1782,7 @@ public:
     if (!Value)
       return;
 
+    GlobalParser->addPendingOptions();
     SubCommand *Sub = GlobalParser->getActiveSubCommand();
     auto &OptionsMap = Sub->OptionsMap;
     auto &PositionalOpts = Sub->PositionalOpts;
@@ -1998,6 +2039,7 @@ void CommandLineParser::printOptionValues() {
   if (!PrintOptions && !PrintAllOptions)
     return;
 
+  addPendingOptions();
   SmallVector<std::pair<const char *, Option *>, 128> Opts;
   sortOpts(ActiveSubCommand->OptionsMap, Opts, /*ShowHidden*/ true);
 
@@ -2109,6 +2151,7 @@ void cl::AddExtraVersionPrinter(void (*func)()) {
 }
 
 StringMap<Option *> &cl::getRegisteredOptions(SubCommand &Sub) {
+  GlobalParser->addPendingOptions();
   auto &Subs = GlobalParser->RegisteredSubCommands;
   (void)Subs;
   assert(is_contained(Subs, &Sub));
@@ -2121,6 +2164,7 @@ cl::getRegisteredSubcommands() {
 }
 
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
+  GlobalParser->addPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     if (I.second->Category != &Category &&
         I.second->Category != &GenericCategory)
@@ -2132,6 +2176,7 @@ void cl::HideUnrelatedOptions(ArrayRef<const cl::OptionCategory *> Categories,
                               SubCommand &Sub) {
   auto CategoriesBegin = Categories.begin();
   auto CategoriesEnd = Categories.end();
+  GlobalParser->addPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     if (std::find(CategoriesBegin, CategoriesEnd, I.second->Category) ==
             CategoriesEnd &&
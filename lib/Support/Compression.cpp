@@ -17,6 +17,10 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -62,6 +66,109 @@ zlib::Status zlib::compress(StringRef InputBuffer,
   return Res;
 }
 
+// The size of deflate's sliding window.
+static const size_t ZlibWindowSize = 1 << 15;
+
+// The fewest chunks worth handing to a thread pool.
+static const size_t MinParallelChunks = 4;
+
+// Deflate Chunk as a raw (headerless) deflate stream into Out, with Dict as
+// the preceding history. Unless Last is set the stream is ended with a sync
+// flush rather than a final block, so another chunk can be appended to it.
+static int deflateChunk(StringRef Chunk, StringRef Dict, bool Last, int CLevel,
+                        SmallVectorImpl<char> &Out) {
+  z_stream Stream;
+  memset(&Stream, 0, sizeof(Stream));
+  int Res = ::deflateInit2(&Stream, CLevel, Z_DEFLATED, -15, 8,
+                           Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return Res;
+  if (!Dict.empty()) {
+    Res = ::deflateSetDictionary(&Stream, (const Bytef *)Dict.data(),
+                                 Dict.size());
+    if (Res != Z_OK) {
+      ::deflateEnd(&Stream);
+      return Res;
+    }
+  }
+
+  // A sync flush adds an empty stored block that deflateBound does not count.
+  Out.resize(::deflateBound(&Stream, Chunk.size()) + 16);
+  Stream.next_in = (Bytef *)Chunk.data();
+  Stream.avail_in = Chunk.size();
+  Stream.next_out = (Bytef *)Out.data();
+  Stream.avail_out = Out.size();
+  Res = ::deflate(&Stream, Last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool Done = Last ? Res == Z_STREAM_END
+                   : Res == Z_OK && Stream.avail_in == 0 &&
+                         Stream.avail_out != 0;
+  Out.resize(Stream.total_out);
+  ::deflateEnd(&Stream);
+  return Done ? Z_OK : Z_BUF_ERROR;
+}
+
+zlib::Status zlib::compressChunked(StringRef InputBuffer,
+                                   SmallVectorImpl<char> &CompressedBuffer,
+                                   CompressionLevel Level, size_t ChunkSize,
+                                   unsigned Threads) {
+  if (ChunkSize == 0 || InputBuffer.size() <= ChunkSize)
+    return compress(InputBuffer, CompressedBuffer, Level);
+
+  int CLevel = encodeZlibCompressionLevel(Level);
+  size_t NumChunks = (InputBuffer.size() + ChunkSize - 1) / ChunkSize;
+  std::vector<SmallVector<char, 0>> Chunks(NumChunks);
+  std::vector<int> Results(NumChunks, Z_OK);
+  std::vector<uLong> Adlers(NumChunks);
+  auto DeflateOne = [&](size_t I) {
+    size_t Begin = I * ChunkSize;
+    StringRef Chunk = InputBuffer.substr(Begin, ChunkSize);
+    size_t DictBegin = Begin > ZlibWindowSize ? Begin - ZlibWindowSize : 0;
+    StringRef Dict = InputBuffer.slice(DictBegin, Begin);
+    Results[I] =
+        deflateChunk(Chunk, Dict, I + 1 == NumChunks, CLevel, Chunks[I]);
+    Adlers[I] = ::adler32(::adler32(0, nullptr, 0),
+                          (const Bytef *)Chunk.data(), Chunk.size());
+  };
+
+  // Spinning up threads costs more than it saves for a handful of chunks, and
+  // without thread support a pool would only run the tasks serially anyway.
+  unsigned NumThreads = std::min<size_t>(NumChunks, Threads);
+  if (!LLVM_ENABLE_THREADS || NumChunks < MinParallelChunks ||
+      NumThreads < 2) {
+    for (size_t I = 0; I != NumChunks; ++I)
+      DeflateOne(I);
+  } else {
+    ThreadPool Pool(NumThreads);
+    for (size_t I = 0; I != NumChunks; ++I)
+      Pool.async(DeflateOne, I);
+    Pool.wait();
+  }
+
+  for (int Res : Results)
+    if (Res != Z_OK)
+      return encodeZlibReturnValue(Res);
+
+  // Wrap the chunks in the zlib header and trailer, as compress2 would.
+  CompressedBuffer.clear();
+  int L = CLevel == Z_DEFAULT_COMPRESSION ? 6 : CLevel;
+  unsigned FLevel = L < 2 ? 0 : L < 6 ? 1 : L == 6 ? 2 : 3;
+  unsigned Header = (Z_DEFLATED | (7 << 4)) << 8 | FLevel << 6;
+  Header += 31 - Header % 31;
+  CompressedBuffer.push_back(Header >> 8);
+  CompressedBuffer.push_back(Header & 0xff);
+
+  uLong Adler = Adlers[0];
+  CompressedBuffer.append(Chunks[0].begin(), Chunks[0].end());
+  for (size_t I = 1; I != NumChunks; ++I) {
+    size_t Size = std::min(ChunkSize, InputBuffer.size() - I * ChunkSize);
+    Adler = ::adler32_combine(Adler, Adlers[I], Size);
+    CompressedBuffer.append(Chunks[I].begin(), Chunks[I].end());
+  }
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back((Adler >> Shift) & 0xff);
+  return StatusOK;
+}
+
 zlib::Status zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                               size_t &UncompressedSize) {
   Status Res = encodeZlibReturnValue(
@@ -94,6 +201,12 @@ zlib::Status zlib::compress(StringRef InputBuffer,
                             CompressionLevel Level) {
   return zlib::StatusUnsupported;
 }
+zlib::Status zlib::compressChunked(StringRef InputBuffer,
+                                   SmallVectorImpl<char> &CompressedBuffer,
+                                   CompressionLevel Level, size_t ChunkSize,
+                                   unsigned Threads) {
+  return zlib::StatusUnsupported;
+}
 zlib::Status zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                               size_t &UncompressedSize) {
   return zlib::StatusUnsupported;
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/DeltaAlgorithm.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <iterator>
 #include <set>
@@ -26,6 +27,36 @@ bool DeltaAlgorithm::GetTestResult(const changeset_ty &Changes) {
   return Result;
 }
 
+void DeltaAlgorithm::GetTestResults(const changesetlist_ty &Candidates,
+                                    std::vector<bool> &Results) {
+  Results.assign(Candidates.size(), false);
+
+  // Only run the tests which aren't known to fail.
+  std::vector<unsigned> ToRun;
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i)
+    if (!FailedTestsCache.count(Candidates[i]))
+      ToRun.push_back(i);
+  if (ToRun.empty())
+    return;
+
+  // std::vector<bool> elements can't be written from several threads.
+  std::vector<char> Passed(Candidates.size(), false);
+  {
+    ThreadPool Pool(std::min<unsigned>(TestConcurrency, ToRun.size()));
+    for (unsigned i : ToRun)
+      Pool.async([this, &Candidates, &Passed, i] {
+        Passed[i] = ExecuteOneTest(Candidates[i]);
+      });
+    Pool.wait();
+  }
+
+  for (unsigned i : ToRun) {
+    Results[i] = Passed[i];
+    if (!Passed[i])
+      FailedTestsCache.insert(Candidates[i]);
+  }
+}
+
 void DeltaAlgorithm::Split(const changeset_ty &S, changesetlist_ty &Res) {
   // FIXME: Allow clients to provide heuristics for improved splitting.
 
@@ -70,7 +101,9 @@ DeltaAlgorithm::Delta(const changeset_ty &Changes,
 bool DeltaAlgorithm::Search(const changeset_ty &Changes,
                             const changesetlist_ty &Sets,
                             changeset_ty &Res) {
-  // FIXME: Parallelize.
+  if (TestConcurrency > 1)
+    return SearchConcurrently(Changes, Sets, Res);
+
   for (changesetlist_ty::const_iterator it = Sets.begin(),
          ie = Sets.end(); it != ie; ++it) {
     // If the test passes on this subset alone, recurse.
@@ -102,6 +135,60 @@ bool DeltaAlgorithm::Search(const changeset_ty &Changes,
   return false;
 }
 
+bool DeltaAlgorithm::SearchConcurrently(const changeset_ty &Changes,
+                                        const changesetlist_ty &Sets,
+                                        changeset_ty &Res) {
+  // List the candidates in the order Search tries them: each subset,
+  // followed by its complement if there are more than two subsets.
+  bool TryComplements = Sets.size() > 2;
+  unsigned Stride = TryComplements ? 2 : 1;
+  changesetlist_ty Candidates;
+  for (const changeset_ty &S : Sets) {
+    Candidates.push_back(S);
+    if (TryComplements) {
+      changeset_ty Complement;
+      std::set_difference(
+        Changes.begin(), Changes.end(), S.begin(), S.end(),
+        std::insert_iterator<changeset_ty>(Complement, Complement.begin()));
+      Candidates.push_back(Complement);
+    }
+  }
+
+  // Test the candidates a batch at a time and pick the first passing one,
+  // which is the one the sequential search would have found.
+  std::vector<bool> Results;
+  for (unsigned Begin = 0, End = Candidates.size(); Begin != End;) {
+    unsigned BatchEnd = std::min(End, Begin + TestConcurrency);
+    changesetlist_ty Batch(Candidates.begin() + Begin,
+                           Candidates.begin() + BatchEnd);
+    GetTestResults(Batch, Results);
+
+    for (unsigned i = 0, e = Batch.size(); i != e; ++i) {
+      if (!Results[i])
+        continue;
+      unsigned SetIdx = (Begin + i) / Stride;
+      if ((Begin + i) % Stride == 0) {
+        // The test passes on this subset alone; recurse.
+        changesetlist_ty SubSets;
+        Split(Batch[i], SubSets);
+        Res = Delta(Batch[i], SubSets);
+      } else {
+        // The test passes on the complement of this subset.
+        changesetlist_ty ComplementSets;
+        ComplementSets.insert(ComplementSets.end(), Sets.begin(),
+                              Sets.begin() + SetIdx);
+        ComplementSets.insert(ComplementSets.end(), Sets.begin() + SetIdx + 1,
+                              Sets.end());
+        Res = Delta(Batch[i], ComplementSets);
+      }
+      return true;
+    }
+    Begin = BatchEnd;
+  }
+
+  return false;
+}
+
 DeltaAlgorithm::changeset_ty DeltaAlgorithm::Run(const changeset_ty &Changes) {
   // Check empty set first to quickly find poor test functions.
   if (GetTestResult(changeset_ty()))
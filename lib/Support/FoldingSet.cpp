@@ -225,7 +225,8 @@ static void **AllocateBuckets(unsigned NumBuckets) {
 
 void FoldingSetImpl::anchor() {}
 
-FoldingSetImpl::FoldingSetImpl(unsigned Log2InitSize) {
+FoldingSetImpl::FoldingSetImpl(unsigned Log2InitSize, bool CachesNodeHashes)
+    : CachesNodeHashes(CachesNodeHashes) {
   assert(5 < Log2InitSize && Log2InitSize < 32 &&
          "Initial hash table size out of range");
   NumBuckets = 1 << Log2InitSize;
@@ -234,7 +235,8 @@ FoldingSetImpl::FoldingSetImpl(unsigned Log2InitSize) {
 }
 
 FoldingSetImpl::FoldingSetImpl(FoldingSetImpl &&Arg)
-    : Buckets(Arg.Buckets), NumBuckets(Arg.NumBuckets), NumNodes(Arg.NumNodes) {
+    : Buckets(Arg.Buckets), NumBuckets(Arg.NumBuckets), NumNodes(Arg.NumNodes),
+      CachesNodeHashes(Arg.CachesNodeHashes) {
   Arg.Buckets = nullptr;
   Arg.NumBuckets = 0;
   Arg.NumNodes = 0;
@@ -245,6 +247,7 @@ FoldingSetImpl &FoldingSetImpl::operator=(FoldingSetImpl &&RHS) {
   Buckets = RHS.Buckets;
   NumBuckets = RHS.NumBuckets;
   NumNodes = RHS.NumNodes;
+  CachesNodeHashes = RHS.CachesNodeHashes;
   RHS.Buckets = nullptr;
   RHS.NumBuckets = 0;
   RHS.NumNodes = 0;
@@ -288,9 +291,11 @@ void FoldingSetImpl::GrowBucketCount(unsigned NewBucketCount) {
       NodeInBucket->SetNextInBucket(nullptr);
 
       // Insert the node into the new bucket, after recomputing the hash.
-      InsertNode(NodeInBucket,
-                 GetBucketFor(ComputeNodeHash(NodeInBucket, TempID),
-                              Buckets, NumBuckets));
+      // Cached hashes are still valid, since the nodes were not changed.
+      ++NumNodes;
+      InsertIntoBucket(NodeInBucket, GetBucketFor(GetNodeHash(NodeInBucket,
+                                                              TempID),
+                                                  Buckets, NumBuckets));
       TempID.clear();
     }
   }
@@ -313,6 +318,19 @@ void FoldingSetImpl::reserve(unsigned EltCount) {
   GrowBucketCount(PowerOf2Floor(EltCount));
 }
 
+/// GetNodeHash - Return the hash of a node in the folding set, which is
+/// remembered if the nodes cache their hashes and recomputed otherwise.
+unsigned FoldingSetImpl::GetNodeHash(Node *N, FoldingSetNodeID &TempID) const {
+  if (CachesNodeHashes)
+    return static_cast<CachedHashFoldingSetNode *>(N)->Hash;
+  return ComputeNodeHash(N, TempID);
+}
+
+/// The cached hashes drop the top bit of the hash value, so that an insert
+/// position can carry one in a non-null pointer on every host.  The buckets
+/// are still selected by the low bits.
+static unsigned GetCachedHash(unsigned Hash) { return Hash & 0x7fffffff; }
+
 /// FindNodeOrInsertPos - Look up the node specified by ID.  If it exists,
 /// return it.  If not, return the insertion token that will make insertion
 /// faster.
@@ -327,15 +345,25 @@ FoldingSetImpl::Node
   
   FoldingSetNodeID TempID;
   while (Node *NodeInBucket = GetNextPtr(Probe)) {
-    if (NodeEquals(NodeInBucket, ID, IDHash, TempID))
+    // Only profile the node if its hash, when known, matches.
+    if ((!CachesNodeHashes ||
+         static_cast<CachedHashFoldingSetNode *>(NodeInBucket)->Hash ==
+             GetCachedHash(IDHash)) &&
+        NodeEquals(NodeInBucket, ID, IDHash, TempID))
       return NodeInBucket;
     TempID.clear();
 
     Probe = NodeInBucket->getNextInBucket();
   }
   
-  // Didn't find the node, return null with the bucket as the InsertPos.
-  InsertPos = Bucket;
+  // Didn't find the node, return null with the bucket as the InsertPos.  If
+  // the nodes cache their hashes, return the hash instead, tagged with the
+  // low bit; InsertNode finds the bucket from it.
+  if (CachesNodeHashes)
+    InsertPos = reinterpret_cast<void *>(
+        (static_cast<uintptr_t>(GetCachedHash(IDHash)) << 1) | 1);
+  else
+    InsertPos = Bucket;
   return nullptr;
 }
 
@@ -344,18 +372,32 @@ FoldingSetImpl::Node
 /// FindNodeOrInsertPos.
 void FoldingSetImpl::InsertNode(Node *N, void *InsertPos) {
   assert(!N->getNextInBucket());
+  // Remember the hash that FindNodeOrInsertPos passed in the insert position.
+  // It is set on every insertion, so a node may be changed while it is out of
+  // the folding set.  This is the hash of the ID the node was looked up with,
+  // which is also the one that picked its bucket; some clients insert nodes
+  // whose own profile differs from that ID.
+  if (CachesNodeHashes) {
+    unsigned Hash = reinterpret_cast<uintptr_t>(InsertPos) >> 1;
+    static_cast<CachedHashFoldingSetNode *>(N)->Hash = Hash;
+    InsertPos = GetBucketFor(Hash, Buckets, NumBuckets);
+  }
+
   // Do we need to grow the hashtable?
   if (NumNodes+1 > capacity()) {
     GrowHashTable();
     FoldingSetNodeID TempID;
-    InsertPos = GetBucketFor(ComputeNodeHash(N, TempID), Buckets, NumBuckets);
+    InsertPos = GetBucketFor(GetNodeHash(N, TempID), Buckets, NumBuckets);
   }
 
   ++NumNodes;
   
   /// The insert position is actually a bucket pointer.
-  void **Bucket = static_cast<void**>(InsertPos);
-  
+  InsertIntoBucket(N, static_cast<void**>(InsertPos));
+}
+
+/// InsertIntoBucket - Link N in at the head of the given bucket.
+void FoldingSetImpl::InsertIntoBucket(Node *N, void **Bucket) {
   void *Next = *Bucket;
   
   // If this is the first insertion into this bucket, its next pointer will be
@@ -19,7 +19,7 @@
 #include <string>
 using namespace llvm;
 
-Regex::Regex() : preg(nullptr), error(REG_BADPAT) {}
+Regex::Regex() : preg(nullptr), error(REG_BADPAT), dfa(nullptr) {}
 
 Regex::Regex(StringRef regex, unsigned Flags) {
   unsigned flags = 0;
@@ -32,9 +32,10 @@ Regex::Regex(StringRef regex, unsigned Flags) {
   if (!(Flags & BasicRegex))
     flags |= REG_EXTENDED;
   error = llvm_regcomp(preg, regex.data(), flags|REG_PEND);
+  dfa = error ? nullptr : llvm_regdfanew(preg);
 }
 
-Regex::Regex(Regex &&regex) {
+Regex::Regex(Regex &&regex) : dfa(regex.dfa.exchange(nullptr)) {
   preg = regex.preg;
   error = regex.error;
   regex.preg = nullptr;
@@ -42,6 +43,7 @@ Regex::Regex(Regex &&regex) {
 }
 
 Regex::~Regex() {
+  llvm_regdfafree(dfa);
   if (preg) {
     llvm_regfree(preg);
     delete preg;
@@ -69,6 +71,17 @@ bool Regex::match(StringRef String, SmallVectorImpl<StringRef> *Matches){
   if (error)
     return false;
 
+  // Rule out a mismatch with the DFA first, if it is not in use by another
+  // thread. If there is a match and the groups are not needed, we are done.
+  if (llvm_regdfa *D = dfa.exchange(nullptr)) {
+    int rc = llvm_regdfaexec(D, String.begin(), String.end());
+    dfa = D;
+    if (rc == REG_NOMATCH)
+      return false;
+    if (rc == 0 && !Matches)
+      return true;
+  }
+
   unsigned nmatch = Matches ? preg->re_nsub+1 : 0;
 
   // pmatch needs to have at least one element.
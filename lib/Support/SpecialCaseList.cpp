@@ -16,27 +16,55 @@
 
 #include "llvm/Support/SpecialCaseList.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Regex.h"
+#include "llvm/Support/TrigramIndex.h"
 #include <string>
 #include <system_error>
 #include <utility>
 
+#define DEBUG_TYPE "special-case-list"
+
+STATISTIC(NumQueries, "Number of special case list queries");
+STATISTIC(NumLiteralMatches, "Number of queries matching a literal entry");
+STATISTIC(NumTrigramRejects, "Number of queries ruled out by trigrams");
+STATISTIC(NumRegexQueries, "Number of queries matched against a regex");
+STATISTIC(NumRegexMatches, "Number of queries matching a regex");
+
 namespace llvm {
 
 /// Represents a set of regular expressions.  Regular expressions which are
 /// "literal" (i.e. no regex metacharacters) are stored in Strings, while all
 /// others are represented as a single pipe-separated regex in RegEx.  The
 /// reason for doing so is efficiency; StringSet is much faster at matching
-/// literal strings than Regex.
+/// literal strings than Regex.  Before running RegEx, queries are checked
+/// against the trigrams of its alternatives, which rules out most of them
+/// when the entries are simple globs.
 struct SpecialCaseList::Entry {
   StringSet<> Strings;
+  TrigramIndex Trigrams;
   std::unique_ptr<Regex> RegEx;
 
   bool match(StringRef Query) const {
-    return Strings.count(Query) || (RegEx && RegEx->match(Query));
+    ++NumQueries;
+    if (Strings.count(Query)) {
+      ++NumLiteralMatches;
+      return true;
+    }
+    if (!RegEx)
+      return false;
+    if (Trigrams.isDefinitelyOut(Query)) {
+      ++NumTrigramRejects;
+      return false;
+    }
+    ++NumRegexQueries;
+    if (!RegEx->match(Query))
+      return false;
+    ++NumRegexMatches;
+    return true;
   }
 };
 
@@ -125,6 +153,7 @@ bool SpecialCaseList::parse(const MemoryBuffer *MB, std::string &Error) {
     }
 
     // Add this regexp into the proper group by its prefix.
+    Entries[Prefix][Category].Trigrams.insert(Regexp);
     if (!Regexps[Prefix][Category].empty())
       Regexps[Prefix][Category] += "|";
     Regexps[Prefix][Category] += "^" + Regexp + "$";
@@ -13,18 +13,40 @@
 
 #include "llvm/Support/ThreadPool.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+bool ThreadPool::hasPendingTasks() const {
+  for (const auto &Queue : Tasks)
+    if (!Queue.empty())
+      return true;
+  return false;
+}
+
+ThreadPool::PackagedTaskTy ThreadPool::popTask() {
+  // Queues are indexed by priority, start with the highest.
+  for (unsigned I = array_lengthof(Tasks); I != 0; --I) {
+    auto &Queue = Tasks[I - 1];
+    if (Queue.empty())
+      continue;
+    PackagedTaskTy Task = std::move(Queue.front());
+    Queue.pop();
+    return Task;
+  }
+  llvm_unreachable("No pending task");
+}
+
 #if LLVM_ENABLE_THREADS
 
 // Default to std::thread::hardware_concurrency
 ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency()) {}
 
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0), EnableFlag(true) {
+    : ActiveThreads(0), NestedWaiters(0), EnableFlag(true) {
   // Create ThreadCount threads that will loop forever, wait on QueueCondition
   // for tasks to be queued or the Pool to be destroyed.
   Threads.reserve(ThreadCount);
@@ -36,21 +58,17 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
           std::unique_lock<std::mutex> LockGuard(QueueLock);
           // Wait for tasks to be pushed in the queue
           QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
+                              [&] { return !EnableFlag || hasPendingTasks(); });
           // Exit condition
-          if (!EnableFlag && Tasks.empty())
+          if (!EnableFlag && !hasPendingTasks())
             return;
           // Yeah, we have a task, grab it and release the lock on the queue
 
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
+          // We signal that we are active while still holding the lock, in
+          // order for wait() to properly detect that even if the queue is
           // empty, there is still a task in flight.
-          {
-            ++ActiveThreads;
-            std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
+          ++ActiveThreads;
+          Task = popTask();
         }
         // Run the task we just grabbed
 #ifndef _MSC_VER
@@ -61,7 +79,7 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
 
         {
           // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::unique_lock<std::mutex> LockGuard(CompletionLock);
+          std::unique_lock<std::mutex> LockGuard(QueueLock);
           --ActiveThreads;
         }
 
@@ -72,20 +90,53 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
   }
 }
 
+bool ThreadPool::isWorkerThread() const {
+  std::thread::id CurrentThreadId = std::this_thread::get_id();
+  for (const llvm::thread &Thread : Threads)
+    if (CurrentThreadId == Thread.get_id())
+      return true;
+  return false;
+}
+
 void ThreadPool::wait() {
-  // Wait for all threads to complete and the queue to be empty
-  std::unique_lock<std::mutex> LockGuard(CompletionLock);
-  // The order of the checks for ActiveThreads and Tasks.empty() matters because
-  // any active threads might be modifying the Tasks queue, and this would be a
-  // race.
-  CompletionCondition.wait(LockGuard,
-                           [&] { return !ActiveThreads && Tasks.empty(); });
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
+  if (!isWorkerThread()) {
+    // Wait for all threads to complete and the queue to be empty
+    CompletionCondition.wait(
+        LockGuard, [&] { return !ActiveThreads && !hasPendingTasks(); });
+    return;
+  }
+
+  // We are running inside a task of this pool: blocking would deadlock if the
+  // tasks we wait for are still queued and every thread is busy waiting.
+  // Instead, run the pending tasks on this thread until the only busy threads
+  // left are the ones waiting like us.
+  ++NestedWaiters;
+  while (true) {
+    if (hasPendingTasks()) {
+      PackagedTaskTy Task = popTask();
+      LockGuard.unlock();
+#ifndef _MSC_VER
+      Task();
+#else
+      Task(/* unused */ false);
+#endif
+      LockGuard.lock();
+      continue;
+    }
+    if (ActiveThreads == NestedWaiters)
+      break;
+    CompletionCondition.wait(LockGuard);
+  }
+  --NestedWaiters;
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task,
+                                                             Priority P) {
   /// Wrap the Task in a packaged_task to return a future object.
   PackagedTaskTy PackagedTask(std::move(Task));
   auto Future = PackagedTask.get_future();
+  bool HasNestedWaiters;
   {
     // Lock the queue and push the new task
     std::unique_lock<std::mutex> LockGuard(QueueLock);
@@ -93,9 +144,13 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
     // Don't allow enqueueing after disabling the pool
     assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
 
-    Tasks.push(std::move(PackagedTask));
+    Tasks[static_cast<unsigned>(P)].push(std::move(PackagedTask));
+    HasNestedWaiters = NestedWaiters != 0;
   }
   QueueCondition.notify_one();
+  // Threads of the pool blocked in wait() can pick up the new task as well.
+  if (HasNestedWaiters)
+    CompletionCondition.notify_all();
   return Future.share();
 }
 
@@ -116,18 +171,19 @@ ThreadPool::ThreadPool() : ThreadPool(0) {}
 
 // No threads are launched, issue a warning if ThreadCount is not 0
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0) {
+    : ActiveThreads(0), NestedWaiters(0) {
   if (ThreadCount) {
     errs() << "Warning: request a ThreadPool with " << ThreadCount
            << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
   }
 }
 
+bool ThreadPool::isWorkerThread() const { return false; }
+
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
-  while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
+  while (hasPendingTasks()) {
+    auto Task = popTask();
 #ifndef _MSC_VER
         Task();
 #else
@@ -136,7 +192,8 @@ void ThreadPool::wait() {
   }
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task,
+                                                             Priority P) {
 #ifndef _MSC_VER
   // Get a Future with launch::deferred execution using std::async
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
@@ -147,7 +204,7 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
   auto Future = std::async(std::launch::deferred, std::move(Task), false).share();
   PackagedTaskTy PackagedTask([Future](bool) -> bool { Future.get(); return false; });
 #endif
-  Tasks.push(std::move(PackagedTask));
+  Tasks[static_cast<unsigned>(P)].push(std::move(PackagedTask));
   return Future;
 }
 
@@ -0,0 +1,154 @@
+//===-- TimeTrace.cpp - Trace Event Recording -----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file Recording of begin/end events in per-thread buffers and their output
+/// in the Chrome trace event format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeTrace.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace llvm;
+
+namespace {
+typedef std::chrono::steady_clock ClockTy;
+
+struct TraceEvent {
+  std::string Name;
+  std::string Detail;
+  ClockTy::time_point Start;
+  ClockTy::duration Duration;
+};
+
+/// The events recorded by one thread. Only the owning thread touches a buffer
+/// until the trace is written out.
+struct ThreadTraceBuffer {
+  unsigned TID;
+  std::vector<TraceEvent> Completed;
+  std::vector<TraceEvent> Open;
+
+  explicit ThreadTraceBuffer(unsigned TID) : TID(TID) {}
+};
+
+/// All per-thread buffers ever created, in creation order.
+struct TraceRegistry {
+  sys::SmartMutex<true> Lock;
+  std::vector<std::unique_ptr<ThreadTraceBuffer>> Buffers;
+  ClockTy::time_point StartTime = ClockTy::now();
+};
+} // end anonymous namespace
+
+static ManagedStatic<TraceRegistry> Registry;
+static std::atomic<bool> TraceEnabled(false);
+static LLVM_THREAD_LOCAL ThreadTraceBuffer *CurrentThreadBuffer = nullptr;
+
+static ThreadTraceBuffer &getThreadBuffer() {
+  if (!CurrentThreadBuffer) {
+    sys::SmartScopedLock<true> Guard(Registry->Lock);
+    Registry->Buffers.emplace_back(
+        new ThreadTraceBuffer(Registry->Buffers.size()));
+    CurrentThreadBuffer = Registry->Buffers.back().get();
+  }
+  return *CurrentThreadBuffer;
+}
+
+void llvm::enableTimeTrace() {
+  // Construct the registry now, so that a ManagedStatic created by the caller
+  // afterwards to write out the trace is destroyed before it.
+  (void)*Registry;
+  TraceEnabled.store(true, std::memory_order_release);
+}
+
+void llvm::disableTimeTrace() {
+  TraceEnabled.store(false, std::memory_order_release);
+  sys::SmartScopedLock<true> Guard(Registry->Lock);
+  for (const auto &Buffer : Registry->Buffers) {
+    Buffer->Completed.clear();
+    Buffer->Open.clear();
+  }
+}
+
+bool llvm::isTimeTraceEnabled() {
+  return TraceEnabled.load(std::memory_order_relaxed);
+}
+
+void llvm::beginTimeTraceEvent(StringRef Name, StringRef Detail) {
+  if (!isTimeTraceEnabled())
+    return;
+  ThreadTraceBuffer &Buffer = getThreadBuffer();
+  Buffer.Open.push_back(
+      TraceEvent{Name, Detail, ClockTy::now(), ClockTy::duration()});
+}
+
+void llvm::endTimeTraceEvent() {
+  if (!isTimeTraceEnabled())
+    return;
+  ThreadTraceBuffer &Buffer = getThreadBuffer();
+  assert(!Buffer.Open.empty() && "Unbalanced trace events!");
+  TraceEvent E = std::move(Buffer.Open.back());
+  Buffer.Open.pop_back();
+  E.Duration = ClockTy::now() - E.Start;
+  Buffer.Completed.push_back(std::move(E));
+}
+
+/// Write \p S as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (unsigned char C : S) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void llvm::writeTimeTrace(raw_ostream &OS) {
+  sys::SmartScopedLock<true> Guard(Registry->Lock);
+  auto toMicroseconds = [](ClockTy::duration D) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(D).count();
+  };
+
+  OS << "{\"traceEvents\":[";
+  bool First = true;
+  for (const auto &Buffer : Registry->Buffers) {
+    for (const TraceEvent &E : Buffer->Completed) {
+      OS << (First ? "\n" : ",\n");
+      First = false;
+      OS << "{\"pid\":1,\"tid\":" << Buffer->TID << ",\"ph\":\"X\",\"ts\":"
+         << toMicroseconds(E.Start - Registry->StartTime)
+         << ",\"dur\":" << toMicroseconds(E.Duration) << ",\"name\":";
+      writeJSONString(OS, E.Name);
+      if (!E.Detail.empty()) {
+        OS << ",\"args\":{\"detail\":";
+        writeJSONString(OS, E.Detail);
+        OS << '}';
+      }
+      OS << '}';
+    }
+  }
+  OS << "\n]}\n";
+}
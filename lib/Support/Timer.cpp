@@ -21,6 +21,14 @@
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Config/config.h"
+#include <cstring>
+#include <thread>
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 using namespace llvm;
 
 // This ugly hack is brought to you courtesy of constructor/destructor ordering
@@ -47,6 +55,18 @@ namespace {
   InfoOutputFilename("info-output-file", cl::value_desc("filename"),
                      cl::desc("File to append -stats and -timer output to"),
                    cl::Hidden, cl::location(getLibSupportInfoOutputFilename()));
+
+  static cl::opt<bool>
+  TrackHWCounters("track-hw-counters",
+                  cl::desc("Enable -time-passes hardware performance "
+                           "counters (cycles, instructions, cache and branch "
+                           "misses); only supported on Linux"),
+                  cl::Hidden);
+
+  static cl::opt<bool>
+  TimersAsJSON("timers-json",
+               cl::desc("Print timer reports as JSON, one line per group"),
+               cl::Hidden);
 }
 
 std::unique_ptr<raw_fd_ostream> llvm::CreateInfoOutputFile() {
@@ -115,6 +135,77 @@ static inline size_t getMemUsage() {
   return sys::Process::GetMallocUsage();
 }
 
+namespace {
+/// The hardware counters read by -track-hw-counters. They are opened for the
+/// thread that first reads them and count user-space events only, so they
+/// read as zero on any other thread. Counters the kernel or the CPU does not
+/// provide, or that the process is not allowed to open, read as zero too,
+/// which leaves just the times in the reports.
+class HWCounters {
+  int FDs[TimeRecord::NumHWCounters];
+  std::thread::id Owner;
+
+public:
+  HWCounters();
+  ~HWCounters();
+  void read(int64_t *Counts) const;
+};
+}
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+static int openHWCounter(uint64_t Config) {
+  perf_event_attr Attr;
+  memset(&Attr, 0, sizeof(Attr));
+  Attr.size = sizeof(Attr);
+  Attr.type = PERF_TYPE_HARDWARE;
+  Attr.config = Config;
+  Attr.exclude_kernel = 1;
+  Attr.exclude_hv = 1;
+#ifdef PERF_FLAG_FD_CLOEXEC
+  unsigned long Flags = PERF_FLAG_FD_CLOEXEC;
+#else
+  unsigned long Flags = 0;
+#endif
+  return syscall(__NR_perf_event_open, &Attr, /*pid=*/0, /*cpu=*/-1,
+                 /*group_fd=*/-1, Flags);
+}
+
+HWCounters::HWCounters() : Owner(std::this_thread::get_id()) {
+  static const uint64_t Configs[TimeRecord::NumHWCounters] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  for (unsigned I = 0; I != TimeRecord::NumHWCounters; ++I)
+    FDs[I] = openHWCounter(Configs[I]);
+}
+
+HWCounters::~HWCounters() {
+  for (int FD : FDs)
+    if (FD >= 0)
+      ::close(FD);
+}
+
+void HWCounters::read(int64_t *Counts) const {
+  if (std::this_thread::get_id() != Owner)
+    return;
+  for (unsigned I = 0; I != TimeRecord::NumHWCounters; ++I) {
+    uint64_t Value;
+    if (FDs[I] >= 0 && ::read(FDs[I], &Value, sizeof(Value)) == sizeof(Value))
+      Counts[I] = Value;
+  }
+}
+#else
+HWCounters::HWCounters() {}
+HWCounters::~HWCounters() {}
+void HWCounters::read(int64_t *) const {}
+#endif
+
+static ManagedStatic<HWCounters> TheHWCounters;
+
+static inline void readHWCounters(int64_t *Counts) {
+  if (TrackHWCounters)
+    TheHWCounters->read(Counts);
+}
+
 TimeRecord TimeRecord::getCurrentTime(bool Start) {
   using Seconds = std::chrono::duration<double, std::ratio<1>>;
   TimeRecord Result;
@@ -124,7 +215,9 @@ TimeRecord TimeRecord::getCurrentTime(bool Start) {
   if (Start) {
     Result.MemUsed = getMemUsage();
     sys::Process::GetTimeUsage(now, user, sys);
+    readHWCounters(Result.HWCounts);
   } else {
+    readHWCounters(Result.HWCounts);
     sys::Process::GetTimeUsage(now, user, sys);
     Result.MemUsed = getMemUsage();
   }
@@ -173,6 +266,10 @@ void TimeRecord::print(const TimeRecord &Total, raw_ostream &OS) const {
 
   if (Total.getMemUsed())
     OS << format("%9" PRId64 "  ", (int64_t)getMemUsed());
+
+  for (unsigned I = 0; I != NumHWCounters; ++I)
+    if (Total.getHWCount(HWCounter(I)))
+      OS << format("%12" PRId64 "  ", getHWCount(HWCounter(I)));
 }
 
 
@@ -299,6 +396,11 @@ void TimerGroup::addTimer(Timer &T) {
 }
 
 void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
+  if (TimersAsJSON) {
+    PrintQueuedTimersJSON(OS);
+    return;
+  }
+
   // Sort the timers in descending order by amount of time taken.
   std::sort(TimersToPrint.begin(), TimersToPrint.end());
 
@@ -331,6 +433,11 @@ void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
   OS << "   ---Wall Time---";
   if (Total.getMemUsed())
     OS << "  ---Mem---";
+  static const char *const HWCounterHeaders[TimeRecord::NumHWCounters] = {
+      "  ---Cycles---", "  ---Instrs---", "  -CacheMisses", "  -BranchMiss-"};
+  for (unsigned I = 0; I != TimeRecord::NumHWCounters; ++I)
+    if (Total.getHWCount(TimeRecord::HWCounter(I)))
+      OS << HWCounterHeaders[I];
   OS << "  --- Name ---\n";
 
   // Loop through all of the timing data, printing it out.
@@ -347,9 +454,59 @@ void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
   TimersToPrint.clear();
 }
 
-void TimerGroup::print(raw_ostream &OS) {
-  sys::SmartScopedLock<true> L(*TimerLock);
+static void printJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static void printJSONTimeRecord(raw_ostream &OS, const TimeRecord &Time) {
+  OS << format("\"wall\":%.6f,\"user\":%.6f,\"sys\":%.6f,\"mem\":",
+               Time.getWallTime(), Time.getUserTime(), Time.getSystemTime())
+     << int64_t(Time.getMemUsed());
+  static const char *const HWCounterNames[TimeRecord::NumHWCounters] = {
+      "cycles", "instructions", "cache-misses", "branch-misses"};
+  if (TrackHWCounters)
+    for (unsigned I = 0; I != TimeRecord::NumHWCounters; ++I)
+      OS << ",\"" << HWCounterNames[I]
+         << "\":" << Time.getHWCount(TimeRecord::HWCounter(I));
+}
+
+void TimerGroup::PrintQueuedTimersJSON(raw_ostream &OS) {
+  // Sort the timers in descending order by amount of time taken.
+  std::sort(TimersToPrint.begin(), TimersToPrint.end());
+
+  TimeRecord Total;
+  OS << "{\"group\":";
+  printJSONString(OS, Name);
+  OS << ",\"timers\":[";
+  for (unsigned i = 0, e = TimersToPrint.size(); i != e; ++i) {
+    const std::pair<TimeRecord, std::string> &Entry = TimersToPrint[e-i-1];
+    Total += Entry.first;
+    if (i)
+      OS << ',';
+    OS << "{\"name\":";
+    printJSONString(OS, Entry.second);
+    OS << ',';
+    printJSONTimeRecord(OS, Entry.first);
+    OS << '}';
+  }
+  OS << "],\"total\":{";
+  printJSONTimeRecord(OS, Total);
+  OS << "}}\n";
+  OS.flush();
 
+  TimersToPrint.clear();
+}
+
+void TimerGroup::queueTriggeredTimers() {
   // See if any of our timers were started, if so add them to TimersToPrint and
   // reset them.
   for (Timer *T = FirstTimer; T; T = T->Next) {
@@ -359,12 +516,27 @@ void TimerGroup::print(raw_ostream &OS) {
     // Clear out the time.
     T->clear();
   }
+}
+
+void TimerGroup::print(raw_ostream &OS) {
+  sys::SmartScopedLock<true> L(*TimerLock);
+
+  queueTriggeredTimers();
 
   // If any timers were started, print the group.
   if (!TimersToPrint.empty())
     PrintQueuedTimers(OS);
 }
 
+void TimerGroup::printJSON(raw_ostream &OS) {
+  sys::SmartScopedLock<true> L(*TimerLock);
+
+  queueTriggeredTimers();
+
+  if (!TimersToPrint.empty())
+    PrintQueuedTimersJSON(OS);
+}
+
 void TimerGroup::printAll(raw_ostream &OS) {
   sys::SmartScopedLock<true> L(*TimerLock);
 
@@ -0,0 +1,93 @@
+//===-- TrigramIndex.cpp - a heuristic for SpecialCaseList ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TrigramIndex.h"
+#include "llvm/ADT/STLExtras.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace llvm;
+
+/// Metacharacters the index cannot handle, the '.' of ".*" aside.
+static const char RegexAdvancedMetachars[] = "()^$|*+?.[]{}";
+
+static unsigned makeTrigram(unsigned char C0, unsigned char C1,
+                            unsigned char C2) {
+  return (unsigned)C0 << 16 | (unsigned)C1 << 8 | C2;
+}
+
+void TrigramIndex::insert(StringRef Regex) {
+  if (Defeated)
+    return;
+
+  SmallVector<unsigned, 16> Trigrams;
+  // The last three characters of the current literal run, and its length.
+  unsigned char Chars[3] = {0, 0, 0};
+  unsigned Len = 0;
+  for (unsigned I = 0, E = Regex.size(); I != E; ++I) {
+    char C = Regex[I];
+    if (C == '.' && I + 1 != E && Regex[I + 1] == '*') {
+      // A wildcard ends the current literal run.
+      ++I;
+      Len = 0;
+      continue;
+    }
+    if (C == '\\') {
+      // An escaped character stands for itself, except for back references.
+      if (I + 1 == E || isdigit(static_cast<unsigned char>(Regex[I + 1]))) {
+        Defeated = true;
+        return;
+      }
+      C = Regex[++I];
+    } else if (std::strchr(RegexAdvancedMetachars, C)) {
+      Defeated = true;
+      return;
+    }
+
+    Chars[0] = Chars[1];
+    Chars[1] = Chars[2];
+    Chars[2] = C;
+    if (++Len >= 3)
+      Trigrams.push_back(makeTrigram(Chars[0], Chars[1], Chars[2]));
+  }
+
+  // Without a trigram, the expression could match any string.
+  if (Trigrams.empty()) {
+    Defeated = true;
+    return;
+  }
+
+  array_pod_sort(Trigrams.begin(), Trigrams.end());
+  Trigrams.erase(std::unique(Trigrams.begin(), Trigrams.end()),
+                 Trigrams.end());
+  unsigned ID = Counts.size();
+  Counts.push_back(Trigrams.size());
+  for (unsigned Trigram : Trigrams)
+    Index[Trigram].push_back(ID);
+}
+
+bool TrigramIndex::isDefinitelyOut(StringRef Query) const {
+  if (Defeated)
+    return false;
+
+  // A trigram occurring several times in Query is counted each time, so this
+  // may answer "maybe" for a query lacking some trigram of an expression.
+  // That only costs a regex match; it never rules out a real match.
+  std::vector<unsigned> CurCounts(Counts.size());
+  for (unsigned I = 2, E = Query.size(); I < E; ++I) {
+    auto It = Index.find(makeTrigram(Query[I - 2], Query[I - 1], Query[I]));
+    if (It == Index.end())
+      continue;
+    for (unsigned ID : It->second)
+      if (++CurCounts[ID] == Counts[ID])
+        return false;
+  }
+  return true;
+}
@@ -493,6 +493,14 @@ void raw_fd_ostream::write_impl(const char *Ptr, size_t Size) {
   } while (Size > 0);
 }
 
+void raw_fd_ostream::write_atomic(const char *Ptr, size_t Size) {
+  assert(GetNumBytesInBuffer() == 0 &&
+         "write_atomic would reorder the output with the buffered data");
+  // write_impl only touches atomic members, so it is safe to call from several
+  // threads as long as nobody uses the buffer meanwhile.
+  write_impl(Ptr, Size);
+}
+
 void raw_fd_ostream::close() {
   assert(ShouldClose);
   ShouldClose = false;
@@ -647,6 +655,17 @@ void raw_svector_ostream::pwrite_impl(const char *Ptr, size_t Size,
   memcpy(OS.data() + Offset, Ptr, Size);
 }
 
+//===----------------------------------------------------------------------===//
+//  atomic_write_ostream
+//===----------------------------------------------------------------------===//
+
+void atomic_write_ostream::commit() {
+  if (Buffer.empty())
+    return;
+  OS.write_atomic(Buffer.data(), Buffer.size());
+  Buffer.clear();
+}
+
 //===----------------------------------------------------------------------===//
 //  raw_null_ostream
 //===----------------------------------------------------------------------===//
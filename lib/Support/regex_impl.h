@@ -101,6 +101,11 @@ int	llvm_regexec(const llvm_regex_t *, const char *, size_t,
 void	llvm_regfree(llvm_regex_t *);
 size_t  llvm_strlcpy(char *dst, const char *src, size_t siz);
 
+struct llvm_regdfa;
+struct llvm_regdfa *llvm_regdfanew(const llvm_regex_t *);
+int	llvm_regdfaexec(struct llvm_regdfa *, const char *, const char *);
+void	llvm_regdfafree(struct llvm_regdfa *);
+
 #ifdef __cplusplus
 }
 #endif
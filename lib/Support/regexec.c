@@ -130,6 +130,286 @@
 
 #include "regengine.inc"
 
+/*
+ * Lazily built DFA.  Each DFA state is a set of states of the strip, as
+ * computed by lstep(), together with the class of the character preceding
+ * it, which is all that the ^, $ and word boundary handling of lfast()
+ * needs to know about the past.  Transitions are computed on demand and
+ * cached, so that matching costs one table lookup per character once the
+ * states visited by the input have been built.  The cache is bounded; when
+ * it fills up it is thrown away and rebuilt from scratch.
+ *
+ * The DFA only tells whether there is a match.  Back references cannot be
+ * handled this way, so no DFA is built for expressions using them.
+ */
+#define	DFA_MAXMEM	(2*1024*1024)	/* bound on the size of the cache */
+#define	DFA_MINSTATES	16		/* not worth it with fewer */
+#define	DFA_NBUCKETS	1024		/* size of the hash table */
+#define	DFA_UNKNOWN	(-1)		/* transition not computed yet */
+#define	DFA_MATCH	(-2)		/* transition completes a match */
+
+/* classes of the character preceding a position */
+#define	DFA_CLS_OUT	0		/* beginning of string */
+#define	DFA_CLS_NL	1		/* newline, under REG_NEWLINE */
+#define	DFA_CLS_WORD	2		/* word character */
+#define	DFA_CLS_OTHER	3		/* anything else */
+
+struct dfastate {
+	int next[UCHAR_MAX+1];	/* transitions, or DFA_UNKNOWN/DFA_MATCH */
+	int endmatch;		/* matches at end of string? -1 if unknown */
+	int cls;		/* class of preceding character */
+	unsigned hash;
+	int hnext;		/* next state in hash chain, or -1 */
+};
+
+struct llvm_regdfa {
+	struct re_guts *g;
+	sopno nstates;		/* size of a state set */
+	int maxstates;		/* number of states the cache can hold */
+	int nused;		/* number of states in the cache */
+	int nalloc;		/* number of states allocated */
+	struct dfastate *dstates;	/* -> struct dfastate[nalloc] */
+	char *sets;		/* -> char[nalloc][nstates] */
+	int initial;		/* initial state, or -1 */
+	int buckets[DFA_NBUCKETS];
+	char *fresh;		/* set for a fresh start */
+	char *st;		/* scratch sets */
+	char *tmp;
+};
+
+#define	DFASET(d, i)	(&(d)->sets[(size_t)(i) * (d)->nstates])
+
+static int
+dfaclass(struct re_guts *g, int c)
+{
+	if (c == '\n' && g->cflags&REG_NEWLINE)
+		return(DFA_CLS_NL);
+	return(ISWORD(c) ? DFA_CLS_WORD : DFA_CLS_OTHER);
+}
+
+static unsigned
+dfahash(const char *set, sopno n, int cls)
+{
+	unsigned h = (unsigned)cls;
+	sopno i;
+
+	for (i = 0; i < n; i++)
+		h = h*31 + (unsigned char)set[i];
+	return(h);
+}
+
+/*
+ - dfaflags - take the ^, $ and word boundaries before c into account,
+ - exactly like lfast() does
+ */
+static void
+dfaflags(struct re_guts *g, char *st, int cls, int c)
+{
+	const sopno gf = g->firststate+1;
+	const sopno gl = g->laststate;
+	int flagch = '\0';
+	int i = 0;
+
+	if (cls == DFA_CLS_NL || cls == DFA_CLS_OUT) {
+		flagch = BOL;
+		i = g->nbol;
+	}
+	if ((c == '\n' && g->cflags&REG_NEWLINE) || c == OUT) {
+		flagch = (flagch == BOL) ? BOLEOL : EOL;
+		i += g->neol;
+	}
+	for (; i > 0; i--)
+		(void)lstep(g, gf, gl, st, flagch, st);
+
+	if ((flagch == BOL || cls == DFA_CLS_NL || cls == DFA_CLS_OTHER) &&
+	    (c != OUT && ISWORD(c)))
+		flagch = BOW;
+	if (cls == DFA_CLS_WORD &&
+	    (flagch == EOL || (c != OUT && !ISWORD(c))))
+		flagch = EOW;
+	if (flagch == BOW || flagch == EOW)
+		(void)lstep(g, gf, gl, st, flagch, st);
+}
+
+/*
+ - dfaflush - throw away all the states in the cache
+ */
+static void
+dfaflush(struct llvm_regdfa *d)
+{
+	int i;
+
+	d->nused = 0;
+	d->initial = -1;
+	for (i = 0; i < DFA_NBUCKETS; i++)
+		d->buckets[i] = -1;
+}
+
+/*
+ - dfalookup - find or add the state for set and cls
+ * Returns the index of the state, or -1 if out of memory.  Adding a state
+ * may flush the cache, invalidating all other state indices.
+ */
+static int
+dfalookup(struct llvm_regdfa *d, const char *set, int cls)
+{
+	unsigned h = dfahash(set, d->nstates, cls);
+	struct dfastate *s;
+	int i, c;
+
+	for (i = d->buckets[h % DFA_NBUCKETS]; i >= 0; i = d->dstates[i].hnext) {
+		s = &d->dstates[i];
+		if (s->hash == h && s->cls == cls &&
+		    memcmp(DFASET(d, i), set, d->nstates) == 0)
+			return(i);
+	}
+
+	if (d->nused == d->maxstates)
+		dfaflush(d);
+	if (d->nused == d->nalloc) {
+		int n = d->nalloc ? d->nalloc * 2 : DFA_MINSTATES;
+		struct dfastate *ds;
+		char *sets;
+
+		if (n > d->maxstates)
+			n = d->maxstates;
+		ds = realloc(d->dstates, n * sizeof(struct dfastate));
+		if (ds == NULL)
+			return(-1);
+		d->dstates = ds;
+		sets = realloc(d->sets, (size_t)n * d->nstates);
+		if (sets == NULL)
+			return(-1);
+		d->sets = sets;
+		d->nalloc = n;
+	}
+
+	i = d->nused++;
+	s = &d->dstates[i];
+	for (c = 0; c <= UCHAR_MAX; c++)
+		s->next[c] = DFA_UNKNOWN;
+	s->endmatch = -1;
+	s->cls = cls;
+	s->hash = h;
+	s->hnext = d->buckets[h % DFA_NBUCKETS];
+	d->buckets[h % DFA_NBUCKETS] = i;
+	memcpy(DFASET(d, i), set, d->nstates);
+	return(i);
+}
+
+/*
+ - llvm_regdfanew - set up a DFA cache for a compiled expression
+ * Returns NULL if the expression cannot be matched by a DFA.
+ */
+struct llvm_regdfa *
+llvm_regdfanew(const llvm_regex_t *preg)
+{
+	struct re_guts *g = preg->re_g;
+	struct llvm_regdfa *d;
+	size_t statesize;
+
+	if (preg->re_magic != MAGIC1 || g->magic != MAGIC2 ||
+	    g->iflags&REGEX_BAD || g->backrefs)
+		return(NULL);
+	statesize = sizeof(struct dfastate) + g->nstates;
+	if (DFA_MAXMEM / statesize < DFA_MINSTATES)
+		return(NULL);
+
+	d = calloc(1, sizeof(struct llvm_regdfa));
+	if (d == NULL)
+		return(NULL);
+	d->g = g;
+	d->nstates = g->nstates;
+	d->maxstates = DFA_MAXMEM / statesize;
+	d->fresh = malloc(3 * g->nstates);
+	if (d->fresh == NULL) {
+		free(d);
+		return(NULL);
+	}
+	d->st = d->fresh + g->nstates;
+	d->tmp = d->st + g->nstates;
+	dfaflush(d);
+
+	memset(d->fresh, 0, g->nstates);
+	d->fresh[g->firststate+1] = 1;
+	(void)lstep(g, g->firststate+1, g->laststate, d->fresh, NOTHING,
+	    d->fresh);
+	return(d);
+}
+
+/*
+ - llvm_regdfafree - free a DFA cache
+ */
+void
+llvm_regdfafree(struct llvm_regdfa *d)
+{
+	if (d == NULL)
+		return;
+	free(d->dstates);
+	free(d->sets);
+	free(d->fresh);
+	free(d);
+}
+
+/*
+ - llvm_regdfaexec - does the expression match anywhere in [start, stop)?
+ * Returns 0 on a match, REG_NOMATCH or REG_ESPACE.  The string is matched
+ * as with REG_STARTEND and no REG_NOTBOL or REG_NOTEOL.
+ */
+int
+llvm_regdfaexec(struct llvm_regdfa *d, const char *start, const char *stop)
+{
+	struct re_guts *g = d->g;
+	const sopno gf = g->firststate+1;
+	const sopno gl = g->laststate;
+	const char *p;
+	int cur, next, nused;
+	unsigned char uc;
+
+	if (d->initial < 0) {
+		d->initial = dfalookup(d, d->fresh, DFA_CLS_OUT);
+		if (d->initial < 0)
+			return(REG_ESPACE);
+	}
+	cur = d->initial;
+
+	for (p = start; p != stop; p++) {
+		uc = (unsigned char)*p;
+		next = d->dstates[cur].next[uc];
+		if (next >= 0) {
+			cur = next;
+			continue;
+		}
+		if (next == DFA_MATCH)
+			return(0);
+
+		/* compute the transition, as in lfast() */
+		memcpy(d->tmp, DFASET(d, cur), d->nstates);
+		dfaflags(g, d->tmp, d->dstates[cur].cls, *p);
+		if (d->tmp[gl]) {
+			d->dstates[cur].next[uc] = DFA_MATCH;
+			return(0);
+		}
+		memcpy(d->st, d->fresh, d->nstates);
+		(void)lstep(g, gf, gl, d->tmp, *p, d->st);
+
+		nused = d->nused;
+		next = dfalookup(d, d->st, dfaclass(g, *p));
+		if (next < 0)
+			return(REG_ESPACE);
+		if (d->nused >= nused)		/* the cache was not flushed */
+			d->dstates[cur].next[uc] = next;
+		cur = next;
+	}
+
+	if (d->dstates[cur].endmatch < 0) {
+		memcpy(d->tmp, DFASET(d, cur), d->nstates);
+		dfaflags(g, d->tmp, d->dstates[cur].cls, OUT);
+		d->dstates[cur].endmatch = d->tmp[gl] != 0;
+	}
+	return(d->dstates[cur].endmatch ? 0 : REG_NOMATCH);
+}
+
 /*
  - llvm_regexec - interface for matching
  *
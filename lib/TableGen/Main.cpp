@@ -16,8 +16,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/TableGen/Main.h"
+#include "RecordCache.h"
 #include "TGParser.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -26,8 +29,11 @@
 #include <algorithm>
 #include <cstdio>
 #include <system_error>
+#include <tuple>
 using namespace llvm;
 
+#define DEBUG_TYPE "record-cache"
+
 static cl::opt<std::string>
 OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
                cl::init("-"));
@@ -45,11 +51,25 @@ static cl::list<std::string>
 IncludeDirs("I", cl::desc("Directory of include files"),
             cl::value_desc("directory"), cl::Prefix);
 
+static cl::list<std::string>
+ExtraOutputs("emit",
+             cl::desc("Also run the backend <action> and write its output "
+                      "to <file>, reusing the parsed records"),
+             cl::value_desc("action=file"));
+
+static cl::opt<std::string>
+RecordCacheFilename("record-cache",
+                    cl::desc("Load the parsed records from <file> if no input "
+                             "file changed since it was written, and update "
+                             "it otherwise"),
+                    cl::value_desc("file"), cl::init(""));
+
 /// \brief Create a dependency file for `-d` option.
 ///
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
-static int createDependencyFile(const TGParser &Parser, const char *argv0) {
+static int createDependencyFile(ArrayRef<std::string> Dependencies,
+                                const char *argv0) {
   if (OutputFilename == "-") {
     errs() << argv0 << ": the option -d must be used together with -o\n";
     return 1;
@@ -62,15 +82,82 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
     return 1;
   }
   DepOut.os() << OutputFilename << ":";
-  for (const auto &Dep : Parser.getDependencies()) {
-    DepOut.os() << ' ' << Dep.first;
+  for (const std::string &Dep : Dependencies) {
+    DepOut.os() << ' ' << Dep;
   }
   DepOut.os() << "\n";
   DepOut.keep();
   return 0;
 }
 
-int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+/// \brief Return what the record cache depends on besides the contents of the
+/// input files: the include path, and the TableGen binary that wrote it.
+static std::string getRecordCacheKey(const char *argv0) {
+  std::string Key;
+  raw_string_ostream OS(Key);
+  std::string Exe =
+      sys::fs::getMainExecutable(argv0, (void *)(intptr_t)&TableGenMain);
+  sys::fs::file_status Status;
+  if (!sys::fs::status(Exe, Status))
+    OS << Exe << ':' << Status.getSize() << ':'
+       << sys::toTimeT(Status.getLastModificationTime());
+  for (const std::string &Dir : IncludeDirs)
+    OS << '\0' << Dir;
+  return OS.str();
+}
+
+/// \brief Write \p Records to the record cache. The cache is written to a
+/// temporary file and renamed into place, so that concurrent runs never see
+/// it half written. Failing to update it only costs the next run a parse.
+static void updateRecordCache(const char *argv0, const RecordKeeper &Records,
+                              StringRef Key) {
+  int FD;
+  SmallString<128> TempPath;
+  if (std::error_code EC = sys::fs::createUniqueFile(
+          RecordCacheFilename + "-%%%%%%%%", FD, TempPath)) {
+    errs() << argv0 << ": warning: could not create the record cache: "
+           << EC.message() << "\n";
+    return;
+  }
+
+  bool Written;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    writeRecordCache(OS, Records, Key);
+    OS.close();
+    Written = !OS.has_error();
+    OS.clear_error();
+  }
+  if (!Written || sys::fs::rename(TempPath, RecordCacheFilename))
+    sys::fs::remove(TempPath);
+}
+
+/// \brief Run \p MainFn on \p Records and write the result to \p Filename.
+static int emitOutput(const char *argv0, TableGenMainFn *MainFn,
+                      RecordKeeper &Records, StringRef Filename) {
+  std::error_code EC;
+  tool_output_file Out(Filename, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << argv0 << ": error opening " << Filename << ":"
+           << EC.message() << "\n";
+    return 1;
+  }
+
+  if (MainFn(Out.os(), Records))
+    return 1;
+
+  if (ErrorsPrinted > 0) {
+    errs() << argv0 << ": " << ErrorsPrinted << " errors.\n";
+    return 1;
+  }
+
+  // Declare success.
+  Out.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                       TableGenSelectFn *SelectFn) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -90,31 +177,69 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   SrcMgr.setIncludeDirs(IncludeDirs);
 
   TGParser Parser(SrcMgr, Records);
+  std::vector<std::unique_ptr<Record>> CachedParserRecords;
+  std::vector<std::string> Dependencies;
+
+  // The cache cannot tell whether standard input changed.
+  bool UseCache = !RecordCacheFilename.empty() && InputFilename != "-";
+  std::string CacheKey = UseCache ? getRecordCacheKey(argv0) : "";
+  bool LoadedCache = false;
+  if (UseCache) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> CacheOrErr =
+        MemoryBuffer::getFile(RecordCacheFilename, -1,
+                              /*RequiresNullTerminator=*/false);
+    LoadedCache =
+        CacheOrErr &&
+        loadRecordCache((*CacheOrErr)->getMemBufferRef(), Records, CacheKey,
+                        CachedParserRecords, Dependencies);
+    DEBUG(dbgs() << (LoadedCache ? "Loaded records from "
+                                 : "Could not use the record cache ")
+                 << RecordCacheFilename << "\n");
+    // Keep the dependency file in the order the parser would produce.
+    std::sort(Dependencies.begin(), Dependencies.end());
+  }
 
-  if (Parser.ParseFile())
-    return 1;
+  if (!LoadedCache) {
+    if (Parser.ParseFile())
+      return 1;
+    for (const auto &Dep : Parser.getDependencies())
+      Dependencies.push_back(Dep.first);
+    if (UseCache)
+      updateRecordCache(argv0, Records, CacheKey);
+  }
 
-  std::error_code EC;
-  tool_output_file Out(OutputFilename, EC, sys::fs::F_Text);
-  if (EC) {
-    errs() << argv0 << ": error opening " << OutputFilename << ":"
-           << EC.message() << "\n";
+  // Check the extra outputs before doing any work.
+  if (!ExtraOutputs.empty() && !SelectFn) {
+    errs() << argv0 << ": the option -emit is not supported\n";
     return 1;
   }
+  for (StringRef Spec : ExtraOutputs) {
+    if (Spec.split('=').second.empty()) {
+      errs() << argv0 << ": expected -emit=<action>=<file>, got '" << Spec
+             << "'\n";
+      return 1;
+    }
+  }
+
+  // The dependencies are the same for every output; the file only names the
+  // main one.
   if (!DependFilename.empty()) {
-    if (int Ret = createDependencyFile(Parser, argv0))
+    if (int Ret = createDependencyFile(Dependencies, argv0))
       return Ret;
   }
 
-  if (MainFn(Out.os(), Records))
-    return 1;
-
-  if (ErrorsPrinted > 0) {
-    errs() << argv0 << ": " << ErrorsPrinted << " errors.\n";
-    return 1;
+  if (int Ret = emitOutput(argv0, MainFn, Records, OutputFilename))
+    return Ret;
+
+  // Run the extra backends in order on the same records. They are not run
+  // concurrently: the Init uniquing tables they all use are not thread-safe.
+  for (StringRef Spec : ExtraOutputs) {
+    StringRef Name, Filename;
+    std::tie(Name, Filename) = Spec.split('=');
+    if (SelectFn(Name))
+      return 1;
+    if (int Ret = emitOutput(argv0, MainFn, Records, Filename))
+      return Ret;
   }
-
-  // Declare success.
-  Out.keep();
   return 0;
 }
@@ -0,0 +1,837 @@
+//===- RecordCache.cpp - Serialized records for TableGen ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The cache starts with a key and the MD5 hash of the rest of the cache, so
+// that a damaged cache is rejected rather than loaded. Then comes a header
+// naming the source buffers with their MD5 hashes, followed by one entry per
+// record (flags, locations and the size of its body), followed by the record
+// bodies. A body holds the name, template arguments, superclasses and values
+// of its record.
+//
+// Besides the classes and defs of the RecordKeeper, in ID order, the cache
+// holds the records they refer to that the parser owns, such as the
+// prototypes of multiclass defs.
+//
+// Initializers are written in pre-order and numbered in post-order within each
+// body; an initializer that was already written in the same body is replaced
+// by a back-reference to its number. Bodies do not refer to each other's
+// initializers, so that they can be loaded in any order.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RecordCache.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/TableGen/Error.h"
+#include "llvm/TableGen/Record.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+
+static const char CacheMagic[4] = {'T', 'G', 'R', 'C'};
+
+// Bump this whenever the encoding changes.
+static const uint64_t CacheVersion = 2;
+
+namespace {
+
+enum InitTag : uint8_t {
+  IT_Ref,
+  IT_Unset,
+  IT_Bit,
+  IT_Bits,
+  IT_Int,
+  IT_String,
+  IT_Code,
+  IT_List,
+  IT_UnOp,
+  IT_BinOp,
+  IT_TernOp,
+  IT_Var,
+  IT_VarBit,
+  IT_VarListElement,
+  IT_Def,
+  IT_Field,
+  IT_Dag
+};
+
+enum RecordFlags : uint8_t {
+  RF_Class = 1 << 0,
+  RF_Anonymous = 1 << 1,
+  RF_ParserOwned = 1 << 2
+};
+
+} // end anonymous namespace
+
+static void hashBuffer(StringRef Buffer, MD5::MD5Result &Result) {
+  MD5 Hash;
+  Hash.update(Buffer);
+  Hash.final(Result);
+}
+
+//===----------------------------------------------------------------------===//
+// Writer
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class RecordCacheWriter {
+  std::vector<const Record *> Recs;
+  std::vector<uint8_t> RecFlags;
+  DenseMap<const Record *, unsigned> RecordIndex;
+  DenseMap<const Init *, unsigned> InitIndex;
+
+  void addRecord(const Record *R, uint8_t Flags);
+
+  void writeString(raw_ostream &OS, StringRef S);
+  void writeLoc(raw_ostream &OS, SMLoc Loc);
+  void writeRecord(raw_ostream &OS, const Record *R);
+  void writeType(raw_ostream &OS, const RecTy *Ty);
+  void writeInit(raw_ostream &OS, const Init *I);
+  void writeBody(raw_ostream &OS, const Record &R);
+
+public:
+  void write(raw_ostream &OS, const RecordKeeper &Records, StringRef Key);
+};
+
+} // end anonymous namespace
+
+void RecordCacheWriter::addRecord(const Record *R, uint8_t Flags) {
+  RecordIndex[R] = Recs.size();
+  Recs.push_back(R);
+  RecFlags.push_back(Flags | (R->isAnonymous() ? RF_Anonymous : 0));
+}
+
+void RecordCacheWriter::writeString(raw_ostream &OS, StringRef S) {
+  encodeULEB128(S.size(), OS);
+  OS << S;
+}
+
+/// Locations are written as a buffer ID and an offset into that buffer; ID 0
+/// stands for a location outside of the source files.
+void RecordCacheWriter::writeLoc(raw_ostream &OS, SMLoc Loc) {
+  unsigned ID = Loc.isValid() ? SrcMgr.FindBufferContainingLoc(Loc) : 0;
+  encodeULEB128(ID, OS);
+  if (ID)
+    encodeULEB128(Loc.getPointer() -
+                      SrcMgr.getMemoryBuffer(ID)->getBufferStart(),
+                  OS);
+}
+
+void RecordCacheWriter::writeRecord(raw_ostream &OS, const Record *R) {
+  auto It = RecordIndex.find(R);
+  if (It == RecordIndex.end()) {
+    // A record the parser owns; its body is written after the others.
+    addRecord(R, RF_ParserOwned);
+    It = RecordIndex.find(R);
+  }
+  encodeULEB128(It->second, OS);
+}
+
+void RecordCacheWriter::writeType(raw_ostream &OS, const RecTy *Ty) {
+  OS << char(Ty->getRecTyKind());
+  if (const auto *BRT = dyn_cast<BitsRecTy>(Ty))
+    encodeULEB128(BRT->getNumBits(), OS);
+  else if (const auto *LRT = dyn_cast<ListRecTy>(Ty))
+    writeType(OS, LRT->getElementType());
+  else if (const auto *RRT = dyn_cast<RecordRecTy>(Ty))
+    writeRecord(OS, RRT->getRecord());
+}
+
+void RecordCacheWriter::writeInit(raw_ostream &OS, const Init *I) {
+  auto It = InitIndex.find(I);
+  if (It != InitIndex.end()) {
+    OS << char(IT_Ref);
+    encodeULEB128(It->second, OS);
+    return;
+  }
+
+  if (isa<UnsetInit>(I)) {
+    OS << char(IT_Unset);
+  } else if (const auto *BI = dyn_cast<BitInit>(I)) {
+    OS << char(IT_Bit) << char(BI->getValue());
+  } else if (const auto *BI = dyn_cast<BitsInit>(I)) {
+    OS << char(IT_Bits);
+    encodeULEB128(BI->getNumBits(), OS);
+    for (unsigned i = 0, e = BI->getNumBits(); i != e; ++i)
+      writeInit(OS, BI->getBit(i));
+  } else if (const auto *II = dyn_cast<IntInit>(I)) {
+    OS << char(IT_Int);
+    encodeSLEB128(II->getValue(), OS);
+  } else if (const auto *SI = dyn_cast<StringInit>(I)) {
+    OS << char(IT_String);
+    writeString(OS, SI->getValue());
+  } else if (const auto *CI = dyn_cast<CodeInit>(I)) {
+    OS << char(IT_Code);
+    writeString(OS, CI->getValue());
+  } else if (const auto *LI = dyn_cast<ListInit>(I)) {
+    OS << char(IT_List);
+    writeType(OS, cast<ListRecTy>(LI->getType())->getElementType());
+    encodeULEB128(LI->size(), OS);
+    for (const Init *Elt : LI->getValues())
+      writeInit(OS, Elt);
+  } else if (const auto *OI = dyn_cast<OpInit>(I)) {
+    if (const auto *UI = dyn_cast<UnOpInit>(OI))
+      OS << char(IT_UnOp) << char(UI->getOpcode());
+    else if (const auto *BI = dyn_cast<BinOpInit>(OI))
+      OS << char(IT_BinOp) << char(BI->getOpcode());
+    else
+      OS << char(IT_TernOp) << char(cast<TernOpInit>(OI)->getOpcode());
+    writeType(OS, OI->getType());
+    for (unsigned i = 0, e = OI->getNumOperands(); i != e; ++i)
+      writeInit(OS, OI->getOperand(i));
+  } else if (const auto *VI = dyn_cast<VarInit>(I)) {
+    OS << char(IT_Var);
+    writeType(OS, VI->getType());
+    writeInit(OS, VI->getNameInit());
+  } else if (const auto *VBI = dyn_cast<VarBitInit>(I)) {
+    OS << char(IT_VarBit);
+    writeInit(OS, VBI->getBitVar());
+    encodeULEB128(VBI->getBitNum(), OS);
+  } else if (const auto *VLI = dyn_cast<VarListElementInit>(I)) {
+    OS << char(IT_VarListElement);
+    writeInit(OS, VLI->getVariable());
+    encodeULEB128(VLI->getElementNum(), OS);
+  } else if (const auto *DI = dyn_cast<DefInit>(I)) {
+    OS << char(IT_Def);
+    writeRecord(OS, DI->getDef());
+  } else if (const auto *FI = dyn_cast<FieldInit>(I)) {
+    OS << char(IT_Field);
+    writeInit(OS, FI->getRecord());
+    writeString(OS, FI->getFieldName());
+  } else if (const auto *DI = dyn_cast<DagInit>(I)) {
+    OS << char(IT_Dag);
+    writeInit(OS, DI->getOperator());
+    writeString(OS, DI->getName());
+    encodeULEB128(DI->getNumArgs(), OS);
+    for (unsigned i = 0, e = DI->getNumArgs(); i != e; ++i) {
+      writeInit(OS, DI->getArg(i));
+      writeString(OS, DI->getArgName(i));
+    }
+  } else {
+    llvm_unreachable("Unexpected initializer kind");
+  }
+
+  unsigned Index = InitIndex.size();
+  InitIndex[I] = Index;
+}
+
+void RecordCacheWriter::writeBody(raw_ostream &OS, const Record &R) {
+  InitIndex.clear();
+
+  writeInit(OS, R.getNameInit());
+
+  encodeULEB128(R.getTemplateArgs().size(), OS);
+  for (const Init *Arg : R.getTemplateArgs())
+    writeInit(OS, Arg);
+
+  encodeULEB128(R.getSuperClasses().size(), OS);
+  for (const auto &SC : R.getSuperClasses()) {
+    writeRecord(OS, SC.first);
+    writeLoc(OS, SC.second.Start);
+    writeLoc(OS, SC.second.End);
+  }
+
+  encodeULEB128(R.getValues().size(), OS);
+  for (const RecordVal &RV : R.getValues()) {
+    writeInit(OS, RV.getNameInit());
+    OS << char(RV.getPrefix());
+    writeType(OS, RV.getType());
+    writeInit(OS, RV.getValue());
+  }
+}
+
+void RecordCacheWriter::write(raw_ostream &OS, const RecordKeeper &Records,
+                              StringRef Key) {
+  // Records are recreated in this order, which keeps their relative IDs and
+  // so the order that backends see them in.
+  std::vector<std::pair<const Record *, uint8_t>> Owned;
+  for (const auto &C : Records.getClasses())
+    Owned.push_back(std::make_pair(C.second.get(), RF_Class));
+  for (const auto &D : Records.getDefs())
+    Owned.push_back(std::make_pair(D.second.get(), 0));
+  std::sort(Owned.begin(), Owned.end(),
+            [](const std::pair<const Record *, uint8_t> &LHS,
+               const std::pair<const Record *, uint8_t> &RHS) {
+              return LHS.first->getID() < RHS.first->getID();
+            });
+  for (const auto &R : Owned)
+    addRecord(R.first, R.second);
+
+  // The header holds the size of each body, so encode those first. Writing a
+  // body may append parser-owned records to the list.
+  SmallString<0> Bodies;
+  raw_svector_ostream BodyOS(Bodies);
+  std::vector<uint64_t> BodySizes;
+  for (unsigned i = 0; i != Recs.size(); ++i) {
+    size_t Start = Bodies.size();
+    writeBody(BodyOS, *Recs[i]);
+    BodySizes.push_back(Bodies.size() - Start);
+  }
+
+  SmallString<0> Payload;
+  raw_svector_ostream PayloadOS(Payload);
+  encodeULEB128(SrcMgr.getNumBuffers(), PayloadOS);
+  for (unsigned ID = 1, E = SrcMgr.getNumBuffers(); ID <= E; ++ID) {
+    const MemoryBuffer *Buf = SrcMgr.getMemoryBuffer(ID);
+    MD5::MD5Result Hash;
+    hashBuffer(Buf->getBuffer(), Hash);
+    writeString(PayloadOS, Buf->getBufferIdentifier());
+    PayloadOS.write(reinterpret_cast<const char *>(Hash), sizeof(Hash));
+  }
+
+  encodeULEB128(Recs.size(), PayloadOS);
+  for (unsigned i = 0, e = Recs.size(); i != e; ++i) {
+    PayloadOS << char(RecFlags[i]);
+    encodeULEB128(Recs[i]->getLoc().size(), PayloadOS);
+    for (SMLoc Loc : Recs[i]->getLoc())
+      writeLoc(PayloadOS, Loc);
+    encodeULEB128(BodySizes[i], PayloadOS);
+  }
+  PayloadOS << Bodies;
+
+  MD5::MD5Result PayloadHash;
+  hashBuffer(Payload, PayloadHash);
+  OS.write(CacheMagic, sizeof(CacheMagic));
+  encodeULEB128(CacheVersion, OS);
+  writeString(OS, Key);
+  OS.write(reinterpret_cast<const char *>(PayloadHash), sizeof(PayloadHash));
+  OS << Payload;
+}
+
+void llvm::writeRecordCache(raw_ostream &OS, const RecordKeeper &Records,
+                            StringRef Key) {
+  RecordCacheWriter().write(OS, Records, Key);
+}
+
+//===----------------------------------------------------------------------===//
+// Reader
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// A bounds-checked cursor over part of the cache. The first malformed read
+/// sets Failed; every read after that returns an empty value.
+struct CacheCursor {
+  const char *Ptr, *End;
+  bool Failed = false;
+
+  explicit CacheCursor(StringRef Data) : Ptr(Data.begin()), End(Data.end()) {}
+
+  void fail() {
+    Failed = true;
+    Ptr = End;
+  }
+
+  uint8_t readByte() {
+    if (Ptr == End) {
+      fail();
+      return 0;
+    }
+    return *Ptr++;
+  }
+
+  uint64_t readULEB() {
+    uint64_t Value = 0;
+    unsigned Shift = 0;
+    uint8_t Byte;
+    do {
+      if (Shift >= 64) {
+        fail();
+        return 0;
+      }
+      Byte = readByte();
+      Value |= uint64_t(Byte & 0x7f) << Shift;
+      Shift += 7;
+    } while (Byte & 0x80);
+    return Value;
+  }
+
+  int64_t readSLEB() {
+    uint64_t Value = 0;
+    unsigned Shift = 0;
+    uint8_t Byte;
+    do {
+      if (Shift >= 64) {
+        fail();
+        return 0;
+      }
+      Byte = readByte();
+      Value |= uint64_t(Byte & 0x7f) << Shift;
+      Shift += 7;
+    } while (Byte & 0x80);
+    if (Shift < 64 && (Byte & 0x40))
+      Value |= -(uint64_t(1) << Shift);
+    return Value;
+  }
+
+  /// Read a count of items that each take at least one byte, which bounds
+  /// what a corrupt count can make the reader allocate.
+  uint64_t readCount() {
+    uint64_t N = readULEB();
+    if (N > uint64_t(End - Ptr)) {
+      fail();
+      return 0;
+    }
+    return N;
+  }
+
+  StringRef readBytes(uint64_t N) {
+    if (N > uint64_t(End - Ptr)) {
+      fail();
+      return StringRef();
+    }
+    StringRef Bytes(Ptr, N);
+    Ptr += N;
+    return Bytes;
+  }
+
+  StringRef readString() { return readBytes(readULEB()); }
+};
+
+} // end anonymous namespace
+
+namespace llvm {
+
+/// Recreates the records of a cache. Bodies are loaded in order, except that
+/// the record a FieldInit refers to is loaded on demand: FieldInit::get needs
+/// the type of the field.
+class RecordCacheReader {
+  enum LoadState : uint8_t { Unloaded, Loading, Loaded };
+
+  RecordKeeper &Records;
+  std::vector<const MemoryBuffer *> Buffers;
+  std::vector<std::unique_ptr<Record>> NewRecords;
+  std::vector<uint8_t> RecFlags;
+  std::vector<StringRef> Bodies;
+  std::vector<LoadState> States;
+  DenseMap<const Record *, unsigned> RecordIndex;
+
+  SMLoc readLoc(CacheCursor &C);
+  Record *readRecord(CacheCursor &C);
+  RecTy *readType(CacheCursor &C);
+  Init *readInit(CacheCursor &C, SmallVectorImpl<Init *> &Inits);
+  TypedInit *readTypedInit(CacheCursor &C, SmallVectorImpl<Init *> &Inits);
+  bool loadRecord(unsigned Index);
+  bool loadBody(Record &R, StringRef Body);
+
+public:
+  explicit RecordCacheReader(RecordKeeper &Records) : Records(Records) {}
+
+  bool load(StringRef Data, StringRef Key,
+            std::vector<std::unique_ptr<Record>> &ParserRecords,
+            std::vector<std::string> &Dependencies);
+};
+
+} // end namespace llvm
+
+SMLoc RecordCacheReader::readLoc(CacheCursor &C) {
+  uint64_t ID = C.readULEB();
+  if (!ID)
+    return SMLoc();
+  uint64_t Offset = C.readULEB();
+  if (ID > Buffers.size() || Offset > Buffers[ID - 1]->getBufferSize()) {
+    C.fail();
+    return SMLoc();
+  }
+  return SMLoc::getFromPointer(Buffers[ID - 1]->getBufferStart() + Offset);
+}
+
+Record *RecordCacheReader::readRecord(CacheCursor &C) {
+  uint64_t Index = C.readULEB();
+  if (Index >= NewRecords.size()) {
+    C.fail();
+    return nullptr;
+  }
+  return NewRecords[Index].get();
+}
+
+RecTy *RecordCacheReader::readType(CacheCursor &C) {
+  switch (C.readByte()) {
+  case RecTy::BitRecTyKind:
+    return BitRecTy::get();
+  case RecTy::BitsRecTyKind:
+    return BitsRecTy::get(C.readULEB());
+  case RecTy::CodeRecTyKind:
+    return CodeRecTy::get();
+  case RecTy::IntRecTyKind:
+    return IntRecTy::get();
+  case RecTy::StringRecTyKind:
+    return StringRecTy::get();
+  case RecTy::ListRecTyKind:
+    if (RecTy *EltTy = readType(C))
+      return ListRecTy::get(EltTy);
+    return nullptr;
+  case RecTy::DagRecTyKind:
+    return DagRecTy::get();
+  case RecTy::RecordRecTyKind:
+    if (Record *R = readRecord(C))
+      return RecordRecTy::get(R);
+    return nullptr;
+  }
+  C.fail();
+  return nullptr;
+}
+
+TypedInit *RecordCacheReader::readTypedInit(CacheCursor &C,
+                                            SmallVectorImpl<Init *> &Inits) {
+  auto *TI = dyn_cast_or_null<TypedInit>(readInit(C, Inits));
+  if (!TI)
+    C.fail();
+  return TI;
+}
+
+Init *RecordCacheReader::readInit(CacheCursor &C,
+                                  SmallVectorImpl<Init *> &Inits) {
+  Init *I = nullptr;
+  switch (C.readByte()) {
+  case IT_Ref: {
+    uint64_t Index = C.readULEB();
+    if (Index < Inits.size())
+      return Inits[Index];
+    break;
+  }
+  case IT_Unset:
+    I = UnsetInit::get();
+    break;
+  case IT_Bit:
+    I = BitInit::get(C.readByte());
+    break;
+  case IT_Bits: {
+    SmallVector<Init *, 16> Bits(C.readCount());
+    for (Init *&Bit : Bits)
+      if (!(Bit = readInit(C, Inits)))
+        return nullptr;
+    I = BitsInit::get(Bits);
+    break;
+  }
+  case IT_Int:
+    I = IntInit::get(C.readSLEB());
+    break;
+  case IT_String:
+    I = StringInit::get(C.readString());
+    break;
+  case IT_Code:
+    I = CodeInit::get(C.readString());
+    break;
+  case IT_List: {
+    RecTy *EltTy = readType(C);
+    if (!EltTy)
+      break;
+    SmallVector<Init *, 8> Elts(C.readCount());
+    for (Init *&Elt : Elts)
+      if (!(Elt = readInit(C, Inits)))
+        return nullptr;
+    I = ListInit::get(Elts, EltTy);
+    break;
+  }
+  case IT_UnOp: {
+    uint8_t Opc = C.readByte();
+    RecTy *Ty = readType(C);
+    Init *LHS = Ty ? readInit(C, Inits) : nullptr;
+    if (!LHS || Opc > UnOpInit::EMPTY)
+      break;
+    I = UnOpInit::get(UnOpInit::UnaryOp(Opc), LHS, Ty);
+    break;
+  }
+  case IT_BinOp: {
+    uint8_t Opc = C.readByte();
+    RecTy *Ty = readType(C);
+    Init *LHS = Ty ? readInit(C, Inits) : nullptr;
+    Init *RHS = LHS ? readInit(C, Inits) : nullptr;
+    if (!RHS || Opc > BinOpInit::EQ)
+      break;
+    I = BinOpInit::get(BinOpInit::BinaryOp(Opc), LHS, RHS, Ty);
+    break;
+  }
+  case IT_TernOp: {
+    uint8_t Opc = C.readByte();
+    RecTy *Ty = readType(C);
+    Init *LHS = Ty ? readInit(C, Inits) : nullptr;
+    Init *MHS = LHS ? readInit(C, Inits) : nullptr;
+    Init *RHS = MHS ? readInit(C, Inits) : nullptr;
+    if (!RHS || Opc > TernOpInit::IF)
+      break;
+    I = TernOpInit::get(TernOpInit::TernaryOp(Opc), LHS, MHS, RHS, Ty);
+    break;
+  }
+  case IT_Var: {
+    RecTy *Ty = readType(C);
+    Init *Name = Ty ? readInit(C, Inits) : nullptr;
+    if (!Name)
+      break;
+    I = VarInit::get(Name, Ty);
+    break;
+  }
+  case IT_VarBit: {
+    TypedInit *Var = readTypedInit(C, Inits);
+    uint64_t Bit = C.readULEB();
+    if (!Var)
+      break;
+    I = VarBitInit::get(Var, Bit);
+    break;
+  }
+  case IT_VarListElement: {
+    TypedInit *Var = readTypedInit(C, Inits);
+    uint64_t Elt = C.readULEB();
+    if (!Var)
+      break;
+    I = VarListElementInit::get(Var, Elt);
+    break;
+  }
+  case IT_Def:
+    if (Record *R = readRecord(C))
+      I = DefInit::get(R);
+    break;
+  case IT_Field: {
+    TypedInit *Rec = readTypedInit(C, Inits);
+    std::string FieldName = C.readString();
+    if (!Rec)
+      break;
+    auto *RRT = dyn_cast<RecordRecTy>(Rec->getType());
+    if (!RRT)
+      break;
+    auto It = RecordIndex.find(RRT->getRecord());
+    if (It == RecordIndex.end() || !loadRecord(It->second) ||
+        !Rec->getFieldType(FieldName))
+      break;
+    I = FieldInit::get(Rec, FieldName);
+    break;
+  }
+  case IT_Dag: {
+    Init *Op = readInit(C, Inits);
+    std::string Name = C.readString();
+    if (!Op)
+      break;
+    uint64_t NumArgs = C.readCount();
+    SmallVector<Init *, 8> Args;
+    SmallVector<std::string, 8> ArgNames;
+    for (uint64_t i = 0; i != NumArgs; ++i) {
+      Init *Arg = readInit(C, Inits);
+      if (!Arg)
+        return nullptr;
+      Args.push_back(Arg);
+      ArgNames.push_back(C.readString());
+    }
+    I = DagInit::get(Op, Name, Args, ArgNames);
+    break;
+  }
+  }
+
+  if (!I || C.Failed) {
+    C.fail();
+    return nullptr;
+  }
+  Inits.push_back(I);
+  return I;
+}
+
+bool RecordCacheReader::loadRecord(unsigned Index) {
+  if (States[Index] == Loaded)
+    return true;
+  // The parser never makes a record depend on the fields of a record that
+  // depends on it in turn; a cycle means the cache is corrupt.
+  if (States[Index] == Loading)
+    return false;
+  States[Index] = Loading;
+  if (!loadBody(*NewRecords[Index], Bodies[Index]))
+    return false;
+  States[Index] = Loaded;
+  return true;
+}
+
+bool RecordCacheReader::loadBody(Record &R, StringRef Body) {
+  CacheCursor C(Body);
+  SmallVector<Init *, 64> Inits;
+
+  auto *Name = dyn_cast_or_null<TypedInit>(readInit(C, Inits));
+  if (!Name || !isa<StringRecTy>(Name->getType()))
+    return false;
+  R.setName(Name);
+
+  for (uint64_t i = 0, e = C.readCount(); i != e; ++i) {
+    Init *Arg = readInit(C, Inits);
+    if (!Arg || R.isTemplateArg(Arg))
+      return false;
+    R.addTemplateArg(Arg);
+  }
+
+  for (uint64_t i = 0, e = C.readCount(); i != e; ++i) {
+    Record *SC = readRecord(C);
+    SMLoc Start = readLoc(C);
+    SMLoc End = readLoc(C);
+    if (!SC || R.isSubClassOf(SC))
+      return false;
+    SMRange Range;
+    if (Start.isValid() && End.isValid())
+      Range = SMRange(Start, End);
+    R.addSuperClass(SC, Range);
+  }
+
+  // Read every value before adding any, so that a FieldInit in this body
+  // never sees the record half built.
+  SmallVector<RecordVal, 16> Values;
+  for (uint64_t i = 0, e = C.readCount(); i != e; ++i) {
+    Init *Name = readInit(C, Inits);
+    bool Prefix = C.readByte();
+    RecTy *Ty = readType(C);
+    Init *Value = Ty ? readInit(C, Inits) : nullptr;
+    if (!Name || !Value)
+      return false;
+    // The value was converted to the field type when it was set; converting
+    // it again is not always a no-op.
+    Values.push_back(RecordVal(Name, Ty, Prefix));
+    Values.back().Value = Value;
+  }
+  if (C.Failed || C.Ptr != C.End)
+    return false;
+
+  // Every record is created with a NAME value, and addValue keeps the first
+  // value added at the end of the list. Add the last one first to get the
+  // original order back.
+  R.removeValue("NAME");
+  if (!Values.empty()) {
+    std::rotate(Values.begin(), Values.end() - 1, Values.end());
+    for (const RecordVal &RV : Values) {
+      if (R.getValue(RV.getNameInit()))
+        return false;
+      R.addValue(RV);
+    }
+  }
+  return true;
+}
+
+bool RecordCacheReader::load(
+    StringRef Data, StringRef Key,
+    std::vector<std::unique_ptr<Record>> &ParserRecords,
+    std::vector<std::string> &Dependencies) {
+  assert(SrcMgr.getNumBuffers() == 1 && "Expected just the main file");
+  assert(Records.getClasses().empty() && Records.getDefs().empty() &&
+         "Records were already loaded");
+
+  CacheCursor C(Data);
+  if (C.readBytes(sizeof(CacheMagic)) != StringRef(CacheMagic,
+                                                   sizeof(CacheMagic)) ||
+      C.readULEB() != CacheVersion || C.readString() != Key)
+    return false;
+
+  // Reject a cache that was damaged after it was written.
+  StringRef PayloadHash = C.readBytes(sizeof(MD5::MD5Result));
+  if (C.Failed)
+    return false;
+  MD5::MD5Result ActualPayloadHash;
+  hashBuffer(StringRef(C.Ptr, C.End - C.Ptr), ActualPayloadHash);
+  if (std::memcmp(ActualPayloadHash, PayloadHash.data(),
+                  sizeof(ActualPayloadHash)))
+    return false;
+
+  // Check the hash of every source file. The included files are only handed
+  // to SrcMgr once the whole cache has been accepted.
+  uint64_t NumFiles = C.readCount();
+  if (NumFiles == 0)
+    return false;
+  std::vector<std::unique_ptr<MemoryBuffer>> Includes;
+  std::vector<std::string> IncludeNames;
+  for (uint64_t i = 0; i != NumFiles; ++i) {
+    StringRef Name = C.readString();
+    StringRef Hash = C.readBytes(sizeof(MD5::MD5Result));
+    if (C.Failed)
+      return false;
+
+    const MemoryBuffer *Buf;
+    if (i == 0) {
+      Buf = SrcMgr.getMemoryBuffer(SrcMgr.getMainFileID());
+      if (Buf->getBufferIdentifier() != Name)
+        return false;
+    } else {
+      ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
+          MemoryBuffer::getFile(Name);
+      if (!FileOrErr)
+        return false;
+      Includes.push_back(std::move(*FileOrErr));
+      IncludeNames.push_back(Name);
+      Buf = Includes.back().get();
+    }
+
+    MD5::MD5Result Actual;
+    hashBuffer(Buf->getBuffer(), Actual);
+    if (std::memcmp(Actual, Hash.data(), sizeof(Actual)))
+      return false;
+    Buffers.push_back(Buf);
+  }
+
+  // Create every record up front, so that bodies can refer to any of them.
+  // Their names are set when their bodies are loaded.
+  uint64_t NumRecords = C.readCount();
+  std::vector<uint64_t> BodySizes;
+  for (uint64_t i = 0; i != NumRecords; ++i) {
+    uint8_t Flags = C.readByte();
+    SmallVector<SMLoc, 4> Locs(C.readCount());
+    for (SMLoc &Loc : Locs)
+      Loc = readLoc(C);
+    BodySizes.push_back(C.readULEB());
+    if (C.Failed)
+      return false;
+
+    NewRecords.push_back(make_unique<Record>(StringInit::get(""), Locs,
+                                             Records, Flags & RF_Anonymous));
+    RecFlags.push_back(Flags);
+    RecordIndex[NewRecords.back().get()] = i;
+  }
+  for (uint64_t Size : BodySizes)
+    Bodies.push_back(C.readBytes(Size));
+  if (C.Failed || C.Ptr != C.End)
+    return false;
+
+  States.assign(NumRecords, Unloaded);
+  for (unsigned i = 0; i != NumRecords; ++i)
+    if (!loadRecord(i))
+      return false;
+
+  StringSet<> ClassNames, DefNames;
+  for (unsigned i = 0; i != NumRecords; ++i) {
+    if (RecFlags[i] & RF_ParserOwned)
+      continue;
+    auto *Name = dyn_cast<StringInit>(NewRecords[i]->getNameInit());
+    if (!Name ||
+        !(RecFlags[i] & RF_Class ? ClassNames : DefNames)
+             .insert(Name->getValue())
+             .second)
+      return false;
+  }
+
+  for (unsigned i = 0; i != NumRecords; ++i) {
+    if (RecFlags[i] & RF_ParserOwned)
+      ParserRecords.push_back(std::move(NewRecords[i]));
+    else if (RecFlags[i] & RF_Class)
+      Records.addClass(std::move(NewRecords[i]));
+    else
+      Records.addDef(std::move(NewRecords[i]));
+  }
+  for (auto &Buf : Includes)
+    SrcMgr.AddNewSourceBuffer(std::move(Buf), SMLoc());
+  Dependencies = std::move(IncludeNames);
+  return true;
+}
+
+bool llvm::loadRecordCache(MemoryBufferRef Cache, RecordKeeper &Records,
+                           StringRef Key,
+                           std::vector<std::unique_ptr<Record>> &ParserRecords,
+                           std::vector<std::string> &Dependencies) {
+  return RecordCacheReader(Records).load(Cache.getBuffer(), Key, ParserRecords,
+                                         Dependencies);
+}
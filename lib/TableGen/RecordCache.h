@@ -0,0 +1,54 @@
+//===- RecordCache.h - Serialized records for TableGen ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the reader and writer of the record cache: a binary image
+// of a fully elaborated RecordKeeper, together with the names and MD5 hashes
+// of the source buffers it was parsed from. Loading it skips the parser and
+// the instantiation of classes, multiclasses and foreach loops.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TABLEGEN_RECORDCACHE_H
+#define LLVM_LIB_TABLEGEN_RECORDCACHE_H
+
+#include "llvm/ADT/StringRef.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBufferRef;
+class Record;
+class RecordKeeper;
+class raw_ostream;
+
+/// Write \p Records to \p OS. Every buffer in SrcMgr is recorded by name and
+/// content hash; \p Key is an opaque string covering everything else the
+/// records depend on, such as the include path.
+void writeRecordCache(raw_ostream &OS, const RecordKeeper &Records,
+                      StringRef Key);
+
+/// Load the records in \p Cache into \p Records, which must be empty, and add
+/// the included files to SrcMgr so that record locations stay valid. The main
+/// input file must already be SrcMgr's only buffer. \p ParserRecords takes
+/// the records that the parser would own, such as multiclass prototypes,
+/// which the loaded records may still refer to. \p Dependencies receives the
+/// names of the included files.
+///
+/// Returns false, leaving \p Records and SrcMgr untouched, if \p Key or any
+/// of the source files differ from when the cache was written, or if the
+/// cache cannot be read.
+bool loadRecordCache(MemoryBufferRef Cache, RecordKeeper &Records,
+                     StringRef Key,
+                     std::vector<std::unique_ptr<Record>> &ParserRecords,
+                     std::vector<std::string> &Dependencies);
+
+} // end namespace llvm
+
+#endif
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "AArch64InstrInfo.h"
+#include "AArch64MachineFunctionInfo.h"
 #include "AArch64Subtarget.h"
 #include "MCTargetDesc/AArch64AddressingModes.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -4117,3 +4118,70 @@ AArch64InstrInfo::getSerializableBitmaskMachineOperandTargetFlags() const {
       {MO_TLS, "aarch64-tls"}};
   return makeArrayRef(TargetFlags);
 }
+
+AArch64InstrInfo::MachineOutlinerInstrType
+AArch64InstrInfo::getOutliningType(const MachineInstr &MI) const {
+  // Calls to outlined functions save LR on the stack around the BL, so the
+  // outlined code may neither use LR nor address anything relative to SP.
+  if (MI.readsRegister(AArch64::SP, &RI) ||
+      MI.modifiesRegister(AArch64::SP, &RI) ||
+      MI.readsRegister(AArch64::LR, &RI) ||
+      MI.modifiesRegister(AArch64::LR, &RI))
+    return MachineOutlinerInstrType::Illegal;
+
+  // ADR only reaches +/-1MB, which moving it might break.
+  if (MI.getOpcode() == AArch64::ADR)
+    return MachineOutlinerInstrType::Illegal;
+
+  // Linker optimization hints refer to the instructions by address.
+  const AArch64FunctionInfo *AFI =
+      MI.getParent()->getParent()->getInfo<AArch64FunctionInfo>();
+  if (AFI->getLOHRelated().count(&MI))
+    return MachineOutlinerInstrType::Illegal;
+
+  return MachineOutlinerInstrType::Legal;
+}
+
+bool AArch64InstrInfo::isFunctionSafeToOutlineFrom(
+    const MachineFunction &MF) const {
+  // Saving LR around the call would clobber the red zone.
+  return !Subtarget.getFrameLowering()->canUseRedZone(MF);
+}
+
+unsigned AArch64InstrInfo::getOutliningCallOverhead() const {
+  // Save LR, BL, restore LR.
+  return 3;
+}
+
+unsigned AArch64InstrInfo::getOutliningFrameOverhead() const {
+  // A return.
+  return 1;
+}
+
+void AArch64InstrInfo::insertOutlinerEpilogue(MachineBasicBlock &MBB,
+                                              MachineFunction &MF) const {
+  BuildMI(MBB, MBB.end(), DebugLoc(), get(AArch64::RET))
+      .addReg(AArch64::LR);
+}
+
+MachineBasicBlock::iterator
+AArch64InstrInfo::insertOutlinedCall(MachineBasicBlock &MBB,
+                                     MachineBasicBlock::iterator It,
+                                     MachineFunction &MF) const {
+  // str x30, [sp, #-16]!
+  BuildMI(MBB, It, DebugLoc(), get(AArch64::STRXpre))
+      .addReg(AArch64::SP, RegState::Define)
+      .addReg(AArch64::LR)
+      .addReg(AArch64::SP)
+      .addImm(-16);
+  MachineBasicBlock::iterator Call =
+      BuildMI(MBB, It, DebugLoc(), get(AArch64::BL))
+          .addGlobalAddress(MF.getFunction());
+  // ldr x30, [sp], #16
+  BuildMI(MBB, It, DebugLoc(), get(AArch64::LDRXpost))
+      .addReg(AArch64::SP, RegState::Define)
+      .addReg(AArch64::LR, RegState::Define)
+      .addReg(AArch64::SP)
+      .addImm(16);
+  return Call;
+}
@@ -245,6 +245,17 @@ public:
   ArrayRef<std::pair<unsigned, const char *>>
   getSerializableBitmaskMachineOperandTargetFlags() const override;
 
+  MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const override;
+  bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const override;
+  unsigned getOutliningCallOverhead() const override;
+  unsigned getOutliningFrameOverhead() const override;
+  void insertOutlinerEpilogue(MachineBasicBlock &MBB,
+                              MachineFunction &MF) const override;
+  MachineBasicBlock::iterator
+  insertOutlinedCall(MachineBasicBlock &MBB, MachineBasicBlock::iterator It,
+                     MachineFunction &MF) const override;
+
 private:
   void instantiateCondBranch(MachineBasicBlock &MBB, const DebugLoc &DL,
                              MachineBasicBlock *TBB,
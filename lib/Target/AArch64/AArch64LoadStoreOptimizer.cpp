@@ -16,6 +16,7 @@
 #include "AArch64Subtarget.h"
 #include "MCTargetDesc/AArch64AddressingModes.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
@@ -42,10 +43,18 @@ STATISTIC(NumNarrowLoadsPromoted, "Number of narrow loads promoted");
 STATISTIC(NumZeroStoresPromoted, "Number of narrow zero stores promoted");
 STATISTIC(NumLoadsFromStoresPromoted, "Number of loads from stores promoted");
 
-// The LdStLimit limits how far we search for load/store pairs.
+// The LdStLimit limits how far we search for a store to promote a load from,
+// or for narrow loads and stores to merge.
 static cl::opt<unsigned> LdStLimit("aarch64-load-store-scan-limit",
                                    cl::init(20), cl::Hidden);
 
+// The PairLimit limits how far we search for load/store pairs. The search for
+// a pair only starts when the rest of the block has a candidate with the same
+// base register, so the window can be wide without scanning every load and
+// store that far.
+static cl::opt<unsigned> PairLimit("aarch64-load-store-pair-scan-limit",
+                                   cl::init(64), cl::Hidden);
+
 // The UpdateLimit limits how far we search for update instructions when we form
 // pre-/post-index instructions.
 static cl::opt<unsigned> UpdateLimit("aarch64-update-scan-limit", cl::init(100),
@@ -1632,6 +1641,21 @@ bool AArch64LoadStoreOpt::tryToMergeLdStInst(
   return false;
 }
 
+// Loads and stores that can pair with each other have the same base register
+// and, up to sign extension, the same paired opcode.
+static std::pair<unsigned, unsigned> getPairBucket(const MachineInstr &MI) {
+  return std::make_pair(
+      getLdStBaseOp(MI).getReg(),
+      getMatchingPairOpcode(getMatchingNonSExtOpcode(MI.getOpcode())));
+}
+
+// Return true if MI may be the second instruction of a pair, i.e. if
+// findMatchingInsn may accept it.
+static bool mayBePairPartner(MachineInstr &MI, const AArch64InstrInfo *TII) {
+  return TII->isPairableLdStInst(MI) && !MI.hasOrderedMemoryRef() &&
+         !TII->isLdStPairSuppressed(MI) && getLdStOffsetOp(MI).isImm();
+}
+
 // Find loads and stores that can be merged into a single load or store pair
 // instruction.
 bool AArch64LoadStoreOpt::tryToPairLdStInst(MachineBasicBlock::iterator &MBBI) {
@@ -1650,10 +1674,10 @@ bool AArch64LoadStoreOpt::tryToPairLdStInst(MachineBasicBlock::iterator &MBBI) {
   if (!inBoundsForPair(IsUnscaled, Offset, OffsetStride))
     return false;
 
-  // Look ahead up to LdStLimit instructions for a pairable instruction.
+  // Look ahead up to PairLimit instructions for a pairable instruction.
   LdStPairFlags Flags;
   MachineBasicBlock::iterator Paired =
-      findMatchingInsn(MBBI, Flags, LdStLimit, /* FindNarrowMerge = */ false);
+      findMatchingInsn(MBBI, Flags, PairLimit, /* FindNarrowMerge = */ false);
   if (Paired != E) {
     ++NumPairCreated;
     if (TII->isUnscaledLdSt(MI))
@@ -1743,9 +1767,22 @@ bool AArch64LoadStoreOpt::optimizeBlock(MachineBasicBlock &MBB,
   //        ldr x1, [x2, #8]
   //        ; becomes
   //        ldp x0, x1, [x2]
+  //
+  //    Count the candidates of each bucket first, and only look for a pair
+  //    while later instructions in the block may complete it. Instructions
+  //    paired away from below are not uncounted; that only costs a scan.
+  DenseMap<std::pair<unsigned, unsigned>, unsigned> LaterCandidates;
+  for (MachineInstr &MI : MBB)
+    if (mayBePairPartner(MI, TII))
+      ++LaterCandidates[getPairBucket(MI)];
   for (MachineBasicBlock::iterator MBBI = MBB.begin(), E = MBB.end();
        MBBI != E;) {
-    if (TII->isPairableLdStInst(*MBBI) && tryToPairLdStInst(MBBI))
+    bool HasLaterCandidate = false;
+    if (mayBePairPartner(*MBBI, TII)) {
+      unsigned &Count = LaterCandidates[getPairBucket(*MBBI)];
+      HasLaterCandidate = --Count != 0;
+    }
+    if (HasLaterCandidate && tryToPairLdStInst(MBBI))
       Modified = true;
     else
       ++MBBI;
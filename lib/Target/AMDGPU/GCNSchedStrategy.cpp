@@ -17,6 +17,7 @@
 #include "SIInstrInfo.h"
 #include "SIMachineFunctionInfo.h"
 #include "SIRegisterInfo.h"
+#include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/RegisterClassInfo.h"
 
 #define DEBUG_TYPE "misched"
@@ -143,7 +144,9 @@ void GCNMaxOccupancySchedStrategy::pickNodeFromQueue(SchedBoundary &Zone,
       Context->RegClassInfo->getNumAllocatableRegs(&AMDGPU::SGPR_32RegClass);
   unsigned VGPRExcessLimit =
       Context->RegClassInfo->getNumAllocatableRegs(&AMDGPU::VGPR_32RegClass);
-  unsigned MaxWaves = getMaxWaves(SGPRPressure, VGPRPressure, DAG->MF);
+  unsigned MaxWaves = TargetOccupancy
+                          ? TargetOccupancy
+                          : getMaxWaves(SGPRPressure, VGPRPressure, DAG->MF);
   unsigned SGPRCriticalLimit = SRI->getMaxNumSGPRs(ST, MaxWaves);
   unsigned VGPRCriticalLimit = SRI->getMaxNumVGPRs(MaxWaves);
 
@@ -310,3 +313,188 @@ SUnit *GCNMaxOccupancySchedStrategy::pickNode(bool &IsTopNode) {
   DEBUG(dbgs() << "Scheduling SU(" << SU->NodeNum << ") " << *SU->getInstr());
   return SU;
 }
+
+GCNScheduleDAGMILive::GCNScheduleDAGMILive(
+    MachineSchedContext *C, std::unique_ptr<MachineSchedStrategy> S)
+    : ScheduleDAGMILive(C, std::move(S)),
+      StartingOccupancy(getMaxWaves(0, 0, MF)),
+      MinOccupancy(StartingOccupancy) {
+  DEBUG(dbgs() << "Starting occupancy is " << StartingOccupancy << ".\n");
+}
+
+std::pair<unsigned, unsigned> GCNScheduleDAGMILive::getRealRegPressure() const {
+  const SIRegisterInfo *SRI = static_cast<const SIRegisterInfo *>(TRI);
+  unsigned SGPRSet = SRI->getSGPRPressureSet();
+  unsigned VGPRSet = SRI->getVGPRPressureSet();
+
+  IntervalPressure Pressure;
+  RegPressureTracker RPTracker(Pressure);
+  RPTracker.init(&MF, RegClassInfo, LIS, BB, RegionEnd, ShouldTrackLaneMasks,
+                 /*TrackUntiedDefs=*/true);
+  MachineBasicBlock::iterator Top = RegionBegin;
+  while (Top != RegionEnd && Top->isDebugValue())
+    ++Top;
+  while (RPTracker.getPos() != Top)
+    RPTracker.recede();
+  RPTracker.closeRegion();
+
+  unsigned SGPRs = Pressure.MaxSetPressure[SGPRSet];
+  unsigned VGPRs = Pressure.MaxSetPressure[VGPRSet];
+
+  // The tracker only sees registers the region touches. Live-out virtual
+  // registers that the region does not define also live through it, at every
+  // point of it.
+  for (const RegisterMaskPair &P : Pressure.LiveOutRegs) {
+    if (!TargetRegisterInfo::isVirtualRegister(P.RegUnit) ||
+        RPTracker.hasUntiedDef(P.RegUnit))
+      continue;
+    PSetIterator PSetI = MRI.getPressureSets(P.RegUnit);
+    unsigned Weight = PSetI.getWeight();
+    for (; PSetI.isValid(); ++PSetI) {
+      if (*PSetI == SGPRSet)
+        SGPRs += Weight;
+      else if (*PSetI == VGPRSet)
+        VGPRs += Weight;
+    }
+  }
+
+  DEBUG(dbgs() << "  SGPRs: " << SGPRs << ", VGPRs: " << VGPRs << '\n');
+  return std::make_pair(SGPRs, VGPRs);
+}
+
+void GCNScheduleDAGMILive::revertScheduling(ArrayRef<MachineInstr *> Unsched) {
+  RegionEnd = RegionBegin;
+  for (MachineInstr *MI : Unsched) {
+    if (MI->getIterator() != RegionEnd) {
+      BB->remove(MI);
+      BB->insert(RegionEnd, MI);
+      if (!MI->isDebugValue())
+        LIS->handleMove(*MI, true);
+    }
+    RegionEnd = std::next(MI->getIterator());
+    if (MI->isDebugValue())
+      continue;
+    // The scheduler set read-undef and dead flags for the order it picked;
+    // recompute them for this one.
+    for (MachineOperand &Op : MI->operands())
+      if (Op.isReg() && Op.isDef())
+        Op.setIsUndef(false);
+    RegisterOperands RegOpers;
+    RegOpers.collect(*MI, *TRI, MRI, ShouldTrackLaneMasks, false);
+    if (ShouldTrackLaneMasks) {
+      SlotIndex SlotIdx = LIS->getInstructionIndex(*MI).getRegSlot();
+      RegOpers.adjustLaneLiveness(*LIS, MRI, SlotIdx, MI);
+    } else {
+      RegOpers.detectDeadDefs(*MI, *LIS);
+    }
+  }
+  RegionBegin = Unsched.front()->getIterator();
+}
+
+void GCNScheduleDAGMILive::schedule() {
+  std::vector<MachineInstr *> Unsched;
+  Unsched.reserve(NumRegionInstrs);
+  for (MachineInstr &MI : *this)
+    Unsched.push_back(&MI);
+
+  std::pair<unsigned, unsigned> PressureBefore;
+  if (LIS) {
+    DEBUG(dbgs() << "Pressure before scheduling:\n");
+    PressureBefore = getRealRegPressure();
+  }
+
+  ScheduleDAGMILive::schedule();
+  if (Stage == 0)
+    Regions.push_back(std::make_pair(RegionBegin, RegionEnd));
+
+  if (!LIS)
+    return;
+
+  DEBUG(dbgs() << "Pressure after scheduling:\n");
+  std::pair<unsigned, unsigned> PressureAfter = getRealRegPressure();
+  unsigned WavesBefore =
+      getMaxWaves(PressureBefore.first, PressureBefore.second, MF);
+  unsigned WavesAfter =
+      getMaxWaves(PressureAfter.first, PressureAfter.second, MF);
+  DEBUG(dbgs() << "Occupancy before scheduling: " << WavesBefore
+               << ", after " << WavesAfter << ".\n");
+
+  // The first stage lowers the occupancy of the function to whatever the best
+  // order of this region allows. The second stage may give up occupancy it
+  // does not need, but never below MinOccupancy.
+  if (Stage == 0) {
+    unsigned NewOccupancy = std::max(WavesBefore, WavesAfter);
+    if (NewOccupancy < MinOccupancy) {
+      MinOccupancy = NewOccupancy;
+      DEBUG(dbgs() << "Occupancy lowered for the function to " << MinOccupancy
+                   << ".\n");
+    }
+    if (WavesAfter >= WavesBefore)
+      return;
+  } else if (WavesAfter >= std::min(WavesBefore, MinOccupancy)) {
+    return;
+  }
+
+  DEBUG(dbgs() << "Reverting scheduling of the region.\n");
+  revertScheduling(Unsched);
+  if (Stage == 0)
+    Regions.back() = std::make_pair(RegionBegin, RegionEnd);
+}
+
+void GCNScheduleDAGMILive::finalizeSchedule() {
+  // Retry scheduling the function at the lowest occupancy recorded if that is
+  // lower than the one the first stage aimed for. This mirrors
+  // MachineSchedulerBase::scheduleRegions() for the recorded regions.
+  if (!LIS || MinOccupancy >= StartingOccupancy)
+    return;
+
+  DEBUG(dbgs() << "Retrying function scheduling with lowest recorded occupancy "
+               << MinOccupancy << ".\n");
+
+  ++Stage;
+  static_cast<GCNMaxOccupancySchedStrategy &>(*SchedImpl)
+      .setTargetOccupancy(MinOccupancy);
+
+  MachineBasicBlock *MBB = nullptr;
+  for (unsigned I = 0, E = Regions.size(); I != E; ++I) {
+    RegionBegin = Regions[I].first;
+    RegionEnd = Regions[I].second;
+    MachineInstr *OldBegin = &*RegionBegin;
+
+    if (RegionBegin->getParent() != MBB) {
+      if (MBB)
+        finishBlock();
+      MBB = RegionBegin->getParent();
+      startBlock(MBB);
+    }
+
+    unsigned NumRegionInstrs = 0;
+    for (const MachineInstr &MI : make_range(RegionBegin, RegionEnd))
+      if (!MI.isDebugValue())
+        ++NumRegionInstrs;
+    enterRegion(MBB, RegionBegin, RegionEnd, NumRegionInstrs);
+
+    // Skip empty scheduling regions (0 or 1 schedulable instructions).
+    if (NumRegionInstrs < 2) {
+      exitRegion();
+      continue;
+    }
+
+    DEBUG(dbgs() << "********** MI Scheduling **********\n"
+                 << MF.getName() << ":BB#" << MBB->getNumber() << " "
+                 << MBB->getName() << "\n  From: " << *begin() << "    To: ";
+          if (RegionEnd != MBB->end()) dbgs() << *RegionEnd;
+          else dbgs() << "End";
+          dbgs() << " RegionInstrs: " << NumRegionInstrs << '\n');
+
+    schedule();
+
+    // A region cut off at the scheduling window ends at the first instruction
+    // of the region below it, which may just have moved.
+    if (I + 1 != E && Regions[I + 1].second == OldBegin->getIterator())
+      Regions[I + 1].second = RegionBegin;
+
+    exitRegion();
+  }
+  finishBlock();
+}
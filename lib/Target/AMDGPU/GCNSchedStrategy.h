@@ -25,6 +25,11 @@ class SIRegisterInfo;
 /// heuristics to determine excess/critical pressure sets.  Its goal is to
 /// maximize kernel occupancy (i.e. maximum number of waves per simd).
 class GCNMaxOccupancySchedStrategy : public GenericScheduler {
+  friend class GCNScheduleDAGMILive;
+
+  /// The occupancy that register pressure is kept within, or 0 to keep the
+  /// occupancy that the current pressure allows.
+  unsigned TargetOccupancy = 0;
 
   SUnit *pickNodeBidirectional(bool &IsTopNode);
 
@@ -47,6 +52,45 @@ public:
   GCNMaxOccupancySchedStrategy(const MachineSchedContext *C);
 
   SUnit *pickNode(bool &IsTopNode) override;
+
+  void setTargetOccupancy(unsigned Occ) { TargetOccupancy = Occ; }
+};
+
+/// Schedules a function in two stages. The first stage schedules every region
+/// for occupancy and records the lowest occupancy any region ends up with.
+/// Since the kernel cannot run more waves than that, the second stage
+/// reschedules all regions with that occupancy as the target, which leaves
+/// regions that had to keep pressure down for nothing free to schedule for
+/// latency. A schedule that lowers the occupancy of its region below what the
+/// stage allows is reverted to the previous order.
+class GCNScheduleDAGMILive : public ScheduleDAGMILive {
+  /// The occupancy the first stage starts with.
+  unsigned StartingOccupancy;
+
+  /// The lowest occupancy of the regions scheduled so far.
+  unsigned MinOccupancy;
+
+  /// The scheduling stage: 0 for occupancy, 1 for latency at MinOccupancy.
+  unsigned Stage = 0;
+
+  /// The regions recorded by the first stage, bottom-up within each block.
+  SmallVector<std::pair<MachineBasicBlock::iterator,
+                        MachineBasicBlock::iterator>, 32> Regions;
+
+  /// Return the maximum SGPR and VGPR pressure in the current region,
+  /// including the virtual registers that live through it.
+  std::pair<unsigned, unsigned> getRealRegPressure() const;
+
+  /// Put the instructions of the current region back in order \p Unsched.
+  void revertScheduling(ArrayRef<MachineInstr *> Unsched);
+
+public:
+  GCNScheduleDAGMILive(MachineSchedContext *C,
+                       std::unique_ptr<MachineSchedStrategy> S);
+
+  void schedule() override;
+
+  void finalizeSchedule() override;
 };
 
 } // End namespace llvm
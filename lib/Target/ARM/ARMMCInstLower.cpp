@@ -233,8 +233,14 @@ void ARMAsmPrinter::EmitXRayTable()
       "xray_instr_map", ELF::SHT_PROGBITS,
       ELF::SHF_ALLOC | ELF::SHF_GROUP | ELF::SHF_MERGE, 0,
       CurrentFnSym->getName());
+    auto *IdxSection = OutContext.getELFSection(
+      "xray_fn_idx", ELF::SHT_PROGBITS, ELF::SHF_ALLOC | ELF::SHF_GROUP, 0,
+      CurrentFnSym->getName());
     auto PrevSection = OutStreamer->getCurrentSectionOnly();
     OutStreamer->SwitchSection(Section);
+    MCSymbol *SledsStart =
+      OutContext.createTempSymbol("xray_sleds_start", true);
+    OutStreamer->EmitLabel(SledsStart);
     for (const auto &Sled : Sleds) {
       OutStreamer->EmitSymbolValue(Sled.Sled, 4);
       OutStreamer->EmitSymbolValue(CurrentFnSym, 4);
@@ -245,6 +251,15 @@ void ARMAsmPrinter::EmitXRayTable()
         StringRef(reinterpret_cast<const char *>(&Sled.AlwaysInstrument), 1));
       OutStreamer->EmitZeros(6);
     }
+    MCSymbol *SledsEnd = OutContext.createTempSymbol("xray_sleds_end", true);
+    OutStreamer->EmitLabel(SledsEnd);
+
+    // One entry per function with the bounds of its sleds, so that the
+    // runtime can find and patch a function's sleds without a scan.
+    OutStreamer->SwitchSection(IdxSection);
+    OutStreamer->EmitValueToAlignment(8);
+    OutStreamer->EmitSymbolValue(SledsStart, 4);
+    OutStreamer->EmitSymbolValue(SledsEnd, 4);
     OutStreamer->SwitchSection(PrevSection);
   }
   Sleds.clear();
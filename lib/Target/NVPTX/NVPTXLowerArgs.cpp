@@ -85,6 +85,13 @@
 //      ; use %b_generic
 //    }
 //
+// 3. Mark noalias (i.e. __restrict__) pointer arguments of kernels readonly
+//    when nothing is stored through them or through pointers based on them,
+//    and no such pointer escapes. Together with noalias this means the memory
+//    they point to does not change while the kernel runs, so instruction
+//    selection can load from it with ld.global.nc even when the frontend did
+//    not prove the argument readonly itself.
+//
 // TODO: merge this pass with NVPTXFavorNonGenericAddrSpace so that other passes
 // don't cancel the addrspacecast pair this pass emits.
 //===----------------------------------------------------------------------===//
@@ -92,7 +99,9 @@
 #include "NVPTX.h"
 #include "NVPTXUtilities.h"
 #include "NVPTXTargetMachine.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/CallSite.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
@@ -200,6 +209,46 @@ void NVPTXLowerArgs::markPointerAsGlobal(Value *Ptr) {
   PtrInGlobal->setOperand(0, Ptr);
 }
 
+// Return true if no memory is written through Arg or through a pointer based
+// on it, and no pointer based on it escapes where we cannot see such writes.
+static bool isOnlyReadThrough(Argument *Arg) {
+  SmallVector<const Value *, 16> Worklist;
+  SmallPtrSet<const Value *, 16> Visited;
+  Worklist.push_back(Arg);
+  Visited.insert(Arg);
+  while (!Worklist.empty()) {
+    const Value *V = Worklist.pop_back_val();
+    for (const Use &U : V->uses()) {
+      const User *UR = U.getUser();
+      if (isa<GetElementPtrInst>(UR) || isa<BitCastInst>(UR) ||
+          isa<AddrSpaceCastInst>(UR) || isa<PHINode>(UR) ||
+          isa<SelectInst>(UR) ||
+          (isa<ConstantExpr>(UR) && cast<ConstantExpr>(UR)->isCast())) {
+        if (Visited.insert(UR).second)
+          Worklist.push_back(UR);
+        continue;
+      }
+      if (const auto *LI = dyn_cast<LoadInst>(UR)) {
+        if (LI->isVolatile())
+          return false;
+        continue;
+      }
+      if (isa<ICmpInst>(UR))
+        continue;
+      ImmutableCallSite CS(UR);
+      if (CS && CS.isArgOperand(&U)) {
+        unsigned ArgNo = CS.getArgumentNo(&U);
+        if (CS.onlyReadsMemory(ArgNo) && CS.doesNotCapture(ArgNo))
+          continue;
+      }
+      // Stores, atomics, calls that may write or capture, ptrtoint, and
+      // anything else we do not know.
+      return false;
+    }
+  }
+  return true;
+}
+
 // =============================================================================
 // Main function for this pass.
 // =============================================================================
@@ -226,6 +275,11 @@ bool NVPTXLowerArgs::runOnKernelFunction(Function &F) {
 
   for (Argument &Arg : F.args()) {
     if (Arg.getType()->isPointerTy()) {
+      // Infer readonly before the addrspacecasts below hide the uses; they
+      // are looked through anyway.
+      if (Arg.hasNoAliasAttr() && !Arg.hasByValAttr() &&
+          !Arg.onlyReadsMemory() && isOnlyReadThrough(&Arg))
+        Arg.addAttr(Attribute::ReadOnly);
       if (Arg.hasByValAttr())
         handleByValParam(&Arg);
       else if (TM && TM->getDrvInterface() == NVPTX::CUDA)
@@ -24,6 +24,7 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/TargetRegistry.h"
 using namespace llvm;
 
@@ -60,6 +61,36 @@ extern "C" void LLVMInitializeWebAssemblyDisassembler() {
                                          createWebAssemblyDisassembler);
 }
 
+/// Return whether a LEB128 value at \p Pos ends within \p Bytes.
+static bool hasLEB128(ArrayRef<uint8_t> Bytes, uint64_t Pos) {
+  for (; Pos < Bytes.size(); ++Pos)
+    if (!(Bytes[Pos] & 0x80))
+      return true;
+  return false;
+}
+
+/// Read a ULEB128 value from \p Bytes at \p Pos, advancing \p Pos past it.
+static bool readULEB128(ArrayRef<uint8_t> Bytes, uint64_t &Pos,
+                        uint64_t &Val) {
+  if (!hasLEB128(Bytes, Pos))
+    return false;
+  unsigned N;
+  Val = decodeULEB128(Bytes.data() + Pos, &N);
+  Pos += N;
+  return true;
+}
+
+/// Read an SLEB128 value from \p Bytes at \p Pos, advancing \p Pos past it.
+static bool readSLEB128(ArrayRef<uint8_t> Bytes, uint64_t &Pos,
+                        int64_t &Val) {
+  if (!hasLEB128(Bytes, Pos))
+    return false;
+  unsigned N;
+  Val = decodeSLEB128(Bytes.data() + Pos, &N);
+  Pos += N;
+  return true;
+}
+
 MCDisassembler::DecodeStatus WebAssemblyDisassembler::getInstruction(
     MCInst &MI, uint64_t &Size, ArrayRef<uint8_t> Bytes, uint64_t /*Address*/,
     raw_ostream &OS, raw_ostream &CS) const {
@@ -67,10 +98,9 @@ MCDisassembler::DecodeStatus WebAssemblyDisassembler::getInstruction(
   uint64_t Pos = 0;
 
   // Read the opcode.
-  if (Pos + sizeof(uint64_t) > Bytes.size())
+  uint64_t Opcode;
+  if (!readULEB128(Bytes, Pos, Opcode))
     return MCDisassembler::Fail;
-  uint64_t Opcode = support::endian::read64le(Bytes.data() + Pos);
-  Pos += sizeof(uint64_t);
 
   if (Opcode >= WebAssembly::INSTRUCTION_LIST_END)
     return MCDisassembler::Fail;
@@ -80,33 +110,31 @@ MCDisassembler::DecodeStatus WebAssemblyDisassembler::getInstruction(
   unsigned NumFixedOperands = Desc.NumOperands;
 
   // If it's variadic, read the number of extra operands.
-  unsigned NumExtraOperands = 0;
-  if (Desc.isVariadic()) {
-    if (Pos + sizeof(uint64_t) > Bytes.size())
-      return MCDisassembler::Fail;
-    NumExtraOperands = support::endian::read64le(Bytes.data() + Pos);
-    Pos += sizeof(uint64_t);
-  }
+  uint64_t NumExtraOperands = 0;
+  if (Desc.isVariadic() && !readULEB128(Bytes, Pos, NumExtraOperands))
+    return MCDisassembler::Fail;
 
-  // Read the fixed operands. These are described by the MCInstrDesc.
+  // Read the fixed operands. These are described by the MCInstrDesc. Operands
+  // which had a fixup are padded ULEB128 fields and read as immediates.
   for (unsigned i = 0; i < NumFixedOperands; ++i) {
     const MCOperandInfo &Info = Desc.OpInfo[i];
     switch (Info.OperandType) {
     case MCOI::OPERAND_IMMEDIATE:
+    case WebAssembly::OPERAND_I32IMM:
+    case WebAssembly::OPERAND_I64IMM:
     case WebAssembly::OPERAND_P2ALIGN:
+    case WebAssembly::OPERAND_SIGNATURE:
     case WebAssembly::OPERAND_BASIC_BLOCK: {
-      if (Pos + sizeof(uint64_t) > Bytes.size())
+      int64_t Imm;
+      if (!readSLEB128(Bytes, Pos, Imm))
         return MCDisassembler::Fail;
-      uint64_t Imm = support::endian::read64le(Bytes.data() + Pos);
-      Pos += sizeof(uint64_t);
       MI.addOperand(MCOperand::createImm(Imm));
       break;
     }
     case MCOI::OPERAND_REGISTER: {
-      if (Pos + sizeof(uint64_t) > Bytes.size())
+      uint64_t Reg;
+      if (!readULEB128(Bytes, Pos, Reg))
         return MCDisassembler::Fail;
-      uint64_t Reg = support::endian::read64le(Bytes.data() + Pos);
-      Pos += sizeof(uint64_t);
       MI.addOperand(MCOperand::createReg(Reg));
       break;
     }
@@ -130,19 +158,20 @@ MCDisassembler::DecodeStatus WebAssemblyDisassembler::getInstruction(
 
   // Read the extra operands.
   assert(NumExtraOperands == 0 || Desc.isVariadic());
-  for (unsigned i = 0; i < NumExtraOperands; ++i) {
-    if (Pos + sizeof(uint64_t) > Bytes.size())
-      return MCDisassembler::Fail;
+  for (uint64_t i = 0; i < NumExtraOperands; ++i) {
     if (Desc.TSFlags & WebAssemblyII::VariableOpIsImmediate) {
       // Decode extra immediate operands.
-      uint64_t Imm = support::endian::read64le(Bytes.data() + Pos);
+      int64_t Imm;
+      if (!readSLEB128(Bytes, Pos, Imm))
+        return MCDisassembler::Fail;
       MI.addOperand(MCOperand::createImm(Imm));
     } else {
       // Decode extra register operands.
-      uint64_t Reg = support::endian::read64le(Bytes.data() + Pos);
+      uint64_t Reg;
+      if (!readULEB128(Bytes, Pos, Reg))
+        return MCDisassembler::Fail;
       MI.addOperand(MCOperand::createReg(Reg));
     }
-    Pos += sizeof(uint64_t);
   }
 
   Size = Pos;
@@ -12,6 +12,7 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "MCTargetDesc/WebAssemblyFixupKinds.h"
 #include "MCTargetDesc/WebAssemblyMCTargetDesc.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAssembler.h"
@@ -23,6 +24,7 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
@@ -48,11 +50,11 @@ public:
   }
 
   unsigned getNumFixupKinds() const override {
-    // We currently just use the generic fixups in MCFixup.h and don't have any
-    // target-specific fixups.
-    return 0;
+    return WebAssembly::NumTargetFixupKinds;
   }
 
+  const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const override;
+
   bool mayNeedRelaxation(const MCInst &Inst) const override { return false; }
 
   void relaxInstruction(const MCInst &Inst, const MCSubtargetInfo &STI,
@@ -70,6 +72,25 @@ bool WebAssemblyAsmBackend::writeNopData(uint64_t Count,
   return false;
 }
 
+const MCFixupKindInfo &
+WebAssemblyAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
+  const static MCFixupKindInfo Infos[WebAssembly::NumTargetFixupKinds] = {
+      // This table *must* be in the order that the fixup_* kinds are defined
+      // in WebAssemblyFixupKinds.h.
+      //
+      // Name                     Offset (bits) Size (bits)     Flags
+      {"fixup_uleb128_i32", 0, 5 * 8, 0},
+      {"fixup_uleb128_i64", 0, 10 * 8, 0},
+  };
+
+  if (Kind < FirstTargetFixupKind)
+    return MCAsmBackend::getFixupKindInfo(Kind);
+
+  assert(unsigned(Kind - FirstTargetFixupKind) < getNumFixupKinds() &&
+         "Invalid kind!");
+  return Infos[Kind - FirstTargetFixupKind];
+}
+
 void WebAssemblyAsmBackend::applyFixup(const MCFixup &Fixup, char *Data,
                                        unsigned DataSize, uint64_t Value,
                                        bool IsPCRel) const {
@@ -80,6 +101,20 @@ void WebAssemblyAsmBackend::applyFixup(const MCFixup &Fixup, char *Data,
   if (Value == 0)
     return; // Doesn't change encoding.
 
+  // Instruction operands are padded ULEB128s, so the value has to be
+  // re-encoded rather than masked in.
+  if (Fixup.getKind() >= FirstTargetFixupKind) {
+    unsigned Offset = Fixup.getOffset();
+    assert(Offset + NumBytes <= DataSize && "Invalid fixup offset!");
+    uint8_t Buffer[16];
+    unsigned Size = encodeULEB128(Value, Buffer);
+    if (Size > NumBytes)
+      report_fatal_error("fixup value out of range");
+    encodeULEB128(Value, Buffer, NumBytes - Size);
+    memcpy(Data + Offset, Buffer, NumBytes);
+    return;
+  }
+
   // Shift the value into position.
   Value <<= Info.TargetOffset;
 
@@ -13,6 +13,7 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "MCTargetDesc/WebAssemblyFixupKinds.h"
 #include "MCTargetDesc/WebAssemblyMCTargetDesc.h"
 #include "llvm/MC/MCELFObjectWriter.h"
 #include "llvm/MC/MCFixup.h"
@@ -46,11 +47,13 @@ unsigned WebAssemblyELFObjectWriter::getRelocType(MCContext &Ctx,
     if (SyExp->getKind() == MCSymbolRefExpr::VK_WebAssembly_FUNCTION)
       return ELF::R_WEBASSEMBLY_FUNCTION;
 
-  switch (Fixup.getKind()) {
+  switch ((unsigned)Fixup.getKind()) {
   case FK_Data_4:
+  case WebAssembly::fixup_uleb128_i32:
     assert(!is64Bit() && "4-byte relocations only supported on wasm32");
     return ELF::R_WEBASSEMBLY_DATA;
   case FK_Data_8:
+  case WebAssembly::fixup_uleb128_i64:
     assert(is64Bit() && "8-byte relocations only supported on wasm64");
     return ELF::R_WEBASSEMBLY_DATA;
   default:
@@ -12,8 +12,10 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include "MCTargetDesc/WebAssemblyFixupKinds.h"
 #include "MCTargetDesc/WebAssemblyMCTargetDesc.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/MC/MCCodeEmitter.h"
 #include "llvm/MC/MCFixup.h"
@@ -23,6 +25,7 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Support/EndianStream.h"
+#include "llvm/Support/LEB128.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
@@ -56,34 +59,44 @@ MCCodeEmitter *llvm::createWebAssemblyMCCodeEmitter(const MCInstrInfo &MCII) {
 void WebAssemblyMCCodeEmitter::encodeInstruction(
     const MCInst &MI, raw_ostream &OS, SmallVectorImpl<MCFixup> &Fixups,
     const MCSubtargetInfo &STI) const {
-  // FIXME: This is not the real binary encoding. This is an extremely
-  // over-simplified encoding where we just use uint64_t for everything. This
-  // is a temporary measure.
-  support::endian::Writer<support::little>(OS).write<uint64_t>(MI.getOpcode());
+  // FIXME: This is not the real binary encoding yet; opcodes are LLVM's own
+  // and registers are not locals. It does use the binary format's LEB128 for
+  // opcodes, operand counts and integers, which keeps objects several times
+  // smaller than fixed 64-bit fields. Fixups need a fixed width and offset,
+  // so the instruction is built in a buffer to know where each one lands.
+  // Like the binary format's relocatable fields, a fixup is a ULEB128 padded
+  // to the maximum width of its value, so it still decodes as one. It is
+  // left zero here; the asm backend re-encodes any resolved value or
+  // in-place addend in the same form.
+  SmallString<32> Buffer;
+  raw_svector_ostream Enc(Buffer);
+  encodeULEB128(MI.getOpcode(), Enc);
   const MCInstrDesc &Desc = MCII.get(MI.getOpcode());
   if (Desc.isVariadic())
-    support::endian::Writer<support::little>(OS).write<uint64_t>(
-        MI.getNumOperands() - Desc.NumOperands);
+    encodeULEB128(MI.getNumOperands() - Desc.NumOperands, Enc);
   for (unsigned i = 0, e = MI.getNumOperands(); i < e; ++i) {
     const MCOperand &MO = MI.getOperand(i);
     if (MO.isReg()) {
-      support::endian::Writer<support::little>(OS).write<uint64_t>(MO.getReg());
+      encodeULEB128(MO.getReg(), Enc);
     } else if (MO.isImm()) {
-      support::endian::Writer<support::little>(OS).write<uint64_t>(MO.getImm());
+      encodeSLEB128(MO.getImm(), Enc);
     } else if (MO.isFPImm()) {
-      support::endian::Writer<support::little>(OS).write<double>(MO.getFPImm());
+      support::endian::Writer<support::little>(Enc).write<double>(
+          MO.getFPImm());
     } else if (MO.isExpr()) {
-      support::endian::Writer<support::little>(OS).write<uint64_t>(0);
+      bool Is64Bit = STI.getTargetTriple().isArch64Bit();
       Fixups.push_back(MCFixup::create(
-          (1 + MCII.get(MI.getOpcode()).isVariadic() + i) * sizeof(uint64_t),
-          MO.getExpr(),
-          STI.getTargetTriple().isArch64Bit() ? FK_Data_8 : FK_Data_4,
+          Buffer.size(), MO.getExpr(),
+          MCFixupKind(Is64Bit ? WebAssembly::fixup_uleb128_i64
+                              : WebAssembly::fixup_uleb128_i32),
           MI.getLoc()));
+      encodeULEB128(0, Enc, Is64Bit ? 9 : 4);
       ++MCNumFixups;
     } else {
       llvm_unreachable("unexpected operand kind");
     }
   }
+  OS << Buffer;
 
   ++MCNumEmitted; // Keep track of the # of mi's emitted.
 }
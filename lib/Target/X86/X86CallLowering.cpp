@@ -0,0 +1,181 @@
+//===-- llvm/lib/Target/X86/X86CallLowering.cpp - Call lowering -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the lowering of LLVM calls to machine code calls for
+/// GlobalISel.
+///
+//===----------------------------------------------------------------------===//
+
+#include "X86CallLowering.h"
+#include "X86CallingConv.h"
+#include "X86ISelLowering.h"
+#include "X86InstrInfo.h"
+#include "X86Subtarget.h"
+
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "This shouldn't be built without GISel"
+#endif
+
+#include "X86GenCallingConv.inc"
+
+X86CallLowering::X86CallLowering(const X86TargetLowering &TLI)
+    : CallLowering(&TLI) {}
+
+/// Return true if \p Ty is a value the GlobalISel pipeline can pass in a
+/// single general purpose register.
+static bool isSupportedArgType(const Type *Ty) {
+  if (Ty->isPointerTy())
+    return true;
+  if (!Ty->isIntegerTy())
+    return false;
+  unsigned Size = Ty->getIntegerBitWidth();
+  return Size == 8 || Size == 16 || Size == 32 || Size == 64;
+}
+
+bool X86CallLowering::handleAssignments(MachineIRBuilder &MIRBuilder,
+                                        CCAssignFn *AssignFn,
+                                        ArrayRef<ArgInfo> Args,
+                                        MachineInstrBuilder *MIB) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = *MF.getFunction();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const DataLayout &DL = F.getParent()->getDataLayout();
+
+  SmallVector<CCValAssign, 16> ArgLocs;
+  CCState CCInfo(F.getCallingConv(), F.isVarArg(), MF, ArgLocs, F.getContext());
+
+  const X86TargetLowering &TLI = *getTLI<X86TargetLowering>();
+  for (unsigned i = 0, e = Args.size(); i != e; ++i) {
+    MVT CurVT = TLI.getSimpleValueType(DL, Args[i].Ty);
+    if (AssignFn(i, CurVT, CurVT, CCValAssign::Full, Args[i].Flags, CCInfo))
+      return false;
+  }
+
+  for (unsigned i = 0, e = Args.size(); i != e; ++i) {
+    CCValAssign &VA = ArgLocs[i];
+    unsigned ValReg = Args[i].Reg;
+    unsigned ValSize = VA.getValVT().getSizeInBits();
+    unsigned LocSize = VA.getLocVT().getSizeInBits();
+
+    if (VA.isRegLoc()) {
+      unsigned PhysReg = VA.getLocReg();
+      if (MIB) {
+        // Outgoing values would need an explicit extension to honour the
+        // zeroext/signext promotion; leave those to SelectionDAG.
+        if (LocSize != ValSize)
+          return false;
+        MIRBuilder.buildCopy(PhysReg, ValReg);
+        MIB->addUse(PhysReg, RegState::Implicit);
+        continue;
+      }
+
+      MIRBuilder.getMBB().addLiveIn(PhysReg);
+      if (LocSize == ValSize) {
+        MIRBuilder.buildCopy(ValReg, PhysReg);
+        continue;
+      }
+      // i8 and i16 arguments arrive promoted to a 32-bit register; copy the
+      // whole register and truncate it, as copies must not change the size.
+      unsigned LocReg = MRI.createGenericVirtualRegister(LLT::scalar(LocSize));
+      MIRBuilder.buildCopy(LocReg, PhysReg);
+      MIRBuilder.buildTrunc(ValReg, LocReg);
+      continue;
+    }
+
+    // Outgoing stack values only exist for calls, which are not lowered yet.
+    if (!VA.isMemLoc() || MIB)
+      return false;
+
+    MachineFrameInfo &MFI = MF.getFrameInfo();
+    unsigned Size = ValSize / 8;
+    int FI = MFI.CreateFixedObject(Size, VA.getLocMemOffset(), true);
+    MachinePointerInfo MPO = MachinePointerInfo::getFixedStack(MF, FI);
+    unsigned AddrReg = MRI.createGenericVirtualRegister(
+        LLT::pointer(0, DL.getPointerSizeInBits(0)));
+    MIRBuilder.buildFrameIndex(AddrReg, FI);
+    auto *MMO = MF.getMachineMemOperand(
+        MPO, MachineMemOperand::MOLoad | MachineMemOperand::MOInvariant, Size,
+        0);
+    MIRBuilder.buildLoad(ValReg, AddrReg, *MMO);
+  }
+  return true;
+}
+
+bool X86CallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                  const Value *Val, unsigned VReg) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = *MF.getFunction();
+  if (!MF.getSubtarget<X86Subtarget>().is64Bit())
+    return false;
+
+  assert(((Val && VReg) || (!Val && !VReg)) && "Return value without a vreg");
+  if (Val && !isSupportedArgType(Val->getType()))
+    return false;
+
+  // The return pops no bytes off the stack.
+  auto MIB = MIRBuilder.buildInstrNoInsert(X86::RET).addImm(0);
+
+  if (VReg) {
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    ArgInfo OrigArg{VReg, Val->getType()};
+    setArgFlags(OrigArg, AttributeSet::ReturnIndex, DL, F);
+    if (OrigArg.Flags.isSExt() || OrigArg.Flags.isZExt())
+      return false;
+    if (!handleAssignments(MIRBuilder, RetCC_X86, OrigArg, &MIB))
+      return false;
+  }
+
+  MIRBuilder.insertInstr(MIB);
+  return true;
+}
+
+bool X86CallLowering::lowerFormalArguments(MachineIRBuilder &MIRBuilder,
+                                           const Function &F,
+                                           ArrayRef<unsigned> VRegs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  if (!MF.getSubtarget<X86Subtarget>().is64Bit() || F.isVarArg())
+    return false;
+
+  MachineBasicBlock &MBB = MIRBuilder.getMBB();
+  const DataLayout &DL = F.getParent()->getDataLayout();
+
+  SmallVector<ArgInfo, 8> Args;
+  unsigned i = 0;
+  for (auto &Arg : F.getArgumentList()) {
+    if (!isSupportedArgType(Arg.getType()))
+      return false;
+    ArgInfo OrigArg{VRegs[i], Arg.getType()};
+    setArgFlags(OrigArg, i + 1, DL, F);
+    if (OrigArg.Flags.isByVal() || OrigArg.Flags.isInAlloca() ||
+        OrigArg.Flags.isNest() || OrigArg.Flags.isSRet() ||
+        OrigArg.Flags.isSwiftSelf() || OrigArg.Flags.isSwiftError())
+      return false;
+    Args.push_back(OrigArg);
+    ++i;
+  }
+
+  if (!MBB.empty())
+    MIRBuilder.setInstr(*MBB.begin());
+
+  if (!handleAssignments(MIRBuilder, CC_X86, Args, nullptr))
+    return false;
+
+  // Move back to the end of the basic block.
+  MIRBuilder.setMBB(MBB);
+  return true;
+}
@@ -0,0 +1,49 @@
+//===-- llvm/lib/Target/X86/X86CallLowering.h - Call lowering -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file describes how to lower LLVM calls to machine code calls.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_X86_X86CALLLOWERING
+#define LLVM_LIB_TARGET_X86_X86CALLLOWERING
+
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+
+namespace llvm {
+
+class MachineInstrBuilder;
+class X86TargetLowering;
+
+/// Lower function arguments and returns for GlobalISel. Only the x86-64
+/// calling conventions with integer and pointer values that fit a single
+/// register or stack slot are handled; everything else makes the IRTranslator
+/// fail so that the function falls back to SelectionDAG.
+class X86CallLowering : public CallLowering {
+public:
+  X86CallLowering(const X86TargetLowering &TLI);
+
+  bool lowerReturn(MachineIRBuilder &MIRBuiler, const Value *Val,
+                   unsigned VReg) const override;
+
+  bool lowerFormalArguments(MachineIRBuilder &MIRBuilder, const Function &F,
+                            ArrayRef<unsigned> VRegs) const override;
+
+private:
+  /// Assign the locations of \p Args with \p AssignFn, then copy the values
+  /// in or out of them: incoming values for formal arguments when
+  /// \p MIB is null, outgoing values used by \p MIB otherwise.
+  bool handleAssignments(MachineIRBuilder &MIRBuilder, CCAssignFn *AssignFn,
+                         ArrayRef<ArgInfo> Args,
+                         MachineInstrBuilder *MIB) const;
+};
+} // End of namespace llvm;
+#endif
@@ -126,6 +126,8 @@ private:
 
   bool X86SelectTrunc(const Instruction *I);
 
+  bool X86SelectExtractElement(const Instruction *I);
+
   bool X86SelectFPExtOrFPTrunc(const Instruction *I, unsigned Opc,
                                const TargetRegisterClass *RC);
 
@@ -2464,6 +2466,52 @@ bool X86FastISel::X86SelectTrunc(const Instruction *I) {
   return true;
 }
 
+bool X86FastISel::X86SelectExtractElement(const Instruction *I) {
+  const auto *Idx = dyn_cast<ConstantInt>(I->getOperand(1));
+  if (!Idx)
+    return false;
+
+  MVT VecVT, RetVT;
+  if (!isTypeLegal(I->getOperand(0)->getType(), VecVT) ||
+      !isTypeLegal(I->getType(), RetVT) || !VecVT.is128BitVector())
+    return false;
+
+  unsigned VecReg = getRegForValue(I->getOperand(0));
+  if (!VecReg)
+    return false;
+  bool VecIsKill = hasTrivialKill(I->getOperand(0));
+
+  unsigned ResultReg;
+  if (Idx->isZero() && RetVT.isFloatingPoint()) {
+    // The low element of an XMM register is the scalar register itself.
+    ResultReg = createResultReg(TLI.getRegClassFor(RetVT));
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc,
+            TII.get(TargetOpcode::COPY), ResultReg)
+      .addReg(VecReg, getKillRegState(VecIsKill));
+  } else if (Idx->isZero() && !Subtarget->hasAVX512() &&
+             (RetVT == MVT::i32 || RetVT == MVT::i64)) {
+    // movd/movq work on every SSE2 target, unlike pextr.
+    bool HasAVX = Subtarget->hasAVX();
+    unsigned Opc;
+    if (RetVT == MVT::i32)
+      Opc = HasAVX ? X86::VMOVPDI2DIrr : X86::MOVPDI2DIrr;
+    else
+      Opc = HasAVX ? X86::VMOVPQIto64rr : X86::MOVPQIto64rr;
+    ResultReg =
+        fastEmitInst_r(Opc, TLI.getRegClassFor(RetVT), VecReg, VecIsKill);
+  } else {
+    // Other lanes need pextr, which the generated selector knows about.
+    ResultReg = fastEmit_ri(VecVT, RetVT, ISD::EXTRACT_VECTOR_ELT, VecReg,
+                            VecIsKill, Idx->getZExtValue());
+  }
+
+  if (!ResultReg)
+    return false;
+
+  updateValueMap(I, ResultReg);
+  return true;
+}
+
 bool X86FastISel::IsMemcpySmall(uint64_t Len) {
   return Len <= (Subtarget->is64Bit() ? 32 : 16);
 }
@@ -2706,6 +2754,45 @@ bool X86FastISel::fastLowerIntrinsicCall(const IntrinsicInst *II) {
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(X86::TRAP));
     return true;
   }
+  case Intrinsic::bswap:
+  case Intrinsic::ctpop:
+  case Intrinsic::ctlz:
+  case Intrinsic::cttz: {
+    MVT VT;
+    if (!isTypeLegal(II->getType(), VT))
+      return false;
+
+    const Value *SrcVal = II->getArgOperand(0);
+    unsigned SrcReg = getRegForValue(SrcVal);
+    if (SrcReg == 0)
+      return false;
+    bool SrcIsKill = hasTrivialKill(SrcVal);
+
+    unsigned ResultReg;
+    if (II->getIntrinsicID() == Intrinsic::bswap && VT == MVT::i16) {
+      // There is no 16-bit bswap; swap the two bytes with a rotate.
+      ResultReg = fastEmitInst_ri(X86::ROL16ri, &X86::GR16RegClass, SrcReg,
+                                  SrcIsKill, 8);
+    } else {
+      // The generated selector only has patterns for these when the
+      // subtarget has POPCNT, LZCNT or TZCNT. Those are defined for a zero
+      // input, so the zero-is-undef operand of ctlz and cttz can be ignored.
+      ISD::NodeType Opc;
+      switch (II->getIntrinsicID()) {
+      default: llvm_unreachable("Unexpected intrinsic!");
+      case Intrinsic::bswap: Opc = ISD::BSWAP; break;
+      case Intrinsic::ctpop: Opc = ISD::CTPOP; break;
+      case Intrinsic::ctlz:  Opc = ISD::CTLZ;  break;
+      case Intrinsic::cttz:  Opc = ISD::CTTZ;  break;
+      }
+      ResultReg = fastEmit_r(VT, VT, Opc, SrcReg, SrcIsKill);
+    }
+    if (!ResultReg)
+      return false;
+
+    updateValueMap(II, ResultReg);
+    return true;
+  }
   case Intrinsic::sqrt: {
     if (!Subtarget->hasSSE1())
       return false;
@@ -3497,6 +3584,8 @@ X86FastISel::fastSelectInstruction(const Instruction *I)  {
     return X86SelectSelect(I);
   case Instruction::Trunc:
     return X86SelectTrunc(I);
+  case Instruction::ExtractElement:
+    return X86SelectExtractElement(I);
   case Instruction::FPExt:
     return X86SelectFPExt(I);
   case Instruction::FPTrunc:
@@ -41,6 +41,11 @@ public:
 
   StringRef getPassName() const override { return "X86 Fixup SetCC"; }
 
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesCFG();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
   bool runOnMachineFunction(MachineFunction &MF) override;
 
 private:
@@ -32,6 +32,7 @@
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/WinEHFuncInfo.h"
@@ -1916,6 +1917,40 @@ bool X86TargetLowering::useSoftFloat() const {
   return Subtarget.useSoftFloat();
 }
 
+unsigned X86TargetLowering::getPrefLoopAlignment(MachineLoop *ML) const {
+  // Processors with macro-fusion (AVX is the same proxy for SandyBridge+ as in
+  // X86InstrInfo::shouldScheduleAdjacent) decode and cache uops in 32-byte
+  // windows, and a cmp/jcc pair split across two windows is not fused. Align
+  // small innermost loops that end in a fusible branch to 32 bytes so that
+  // the whole loop, including that pair, sits in a single window.
+  if (!ML || !ML->empty() || !Subtarget.hasAVX())
+    return TargetLowering::getPrefLoopAlignment(ML);
+
+  // Sizes are not known before emission; assume 4 bytes an instruction, so
+  // that loops of 5 to 8 instructions are the ones 16 bytes do not hold.
+  const X86InstrInfo *TII = Subtarget.getInstrInfo();
+  unsigned NumInstrs = 0;
+  bool HasFusedBranch = false;
+  for (MachineBasicBlock *MBB : ML->blocks()) {
+    MachineInstr *Prev = nullptr;
+    for (MachineInstr &MI : *MBB) {
+      if (MI.isDebugValue() || MI.isCFIInstruction() || MI.isImplicitDef() ||
+          MI.isKill())
+        continue;
+      if (++NumInstrs > 8)
+        return TargetLowering::getPrefLoopAlignment(ML);
+      if (Prev && MI.isConditionalBranch() &&
+          TII->shouldScheduleAdjacent(*Prev, MI))
+        HasFusedBranch = true;
+      Prev = &MI;
+    }
+  }
+
+  if (NumInstrs > 4 && HasFusedBranch)
+    return 5; // 2^5 bytes.
+  return TargetLowering::getPrefLoopAlignment(ML);
+}
+
 const MCExpr *
 X86TargetLowering::LowerCustomJumpTableEntry(const MachineJumpTableInfo *MJTI,
                                              const MachineBasicBlock *MBB,
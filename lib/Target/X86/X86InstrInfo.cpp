@@ -8728,6 +8728,55 @@ bool X86InstrInfo::isTailCall(const MachineInstr &Inst) const {
   }
 }
 
+X86InstrInfo::MachineOutlinerInstrType
+X86InstrInfo::getOutliningType(const MachineInstr &MI) const {
+  // The call to an outlined function pushes a return address, so nothing in
+  // an outlined sequence may look at or move the stack pointer. Some stack
+  // manipulating instructions are built without explicit RSP operands, so
+  // check the instruction descriptions as well.
+  if (MI.readsRegister(X86::RSP, &RI) || MI.modifiesRegister(X86::RSP, &RI) ||
+      MI.getDesc().hasImplicitUseOfPhysReg(X86::RSP) ||
+      MI.getDesc().hasImplicitDefOfPhysReg(X86::RSP))
+    return MachineOutlinerInstrType::Illegal;
+
+  // Anything reading the instruction pointer depends on where it is.
+  if (MI.readsRegister(X86::RIP, &RI) ||
+      MI.getDesc().hasImplicitUseOfPhysReg(X86::RIP))
+    return MachineOutlinerInstrType::Illegal;
+
+  return MachineOutlinerInstrType::Legal;
+}
+
+bool X86InstrInfo::isFunctionSafeToOutlineFrom(
+    const MachineFunction &MF) const {
+  // The return address pushed by the call would clobber the red zone.
+  return Subtarget.is64Bit() &&
+         !MF.getInfo<X86MachineFunctionInfo>()->getUsesRedZone();
+}
+
+unsigned X86InstrInfo::getOutliningCallOverhead() const {
+  // A call.
+  return 1;
+}
+
+unsigned X86InstrInfo::getOutliningFrameOverhead() const {
+  // A return.
+  return 1;
+}
+
+void X86InstrInfo::insertOutlinerEpilogue(MachineBasicBlock &MBB,
+                                          MachineFunction &MF) const {
+  BuildMI(MBB, MBB.end(), DebugLoc(), get(X86::RETQ));
+}
+
+MachineBasicBlock::iterator
+X86InstrInfo::insertOutlinedCall(MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator It,
+                                 MachineFunction &MF) const {
+  return BuildMI(MBB, It, DebugLoc(), get(X86::CALL64pcrel32))
+      .addGlobalAddress(MF.getFunction());
+}
+
 namespace {
   /// Create Global Base Reg pass. This initializes the PIC
   /// global base register for x86-32.
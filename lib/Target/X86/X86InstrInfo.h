@@ -544,6 +544,22 @@ public:
 
   bool isTailCall(const MachineInstr &Inst) const override;
 
+  MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const override;
+
+  bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const override;
+
+  unsigned getOutliningCallOverhead() const override;
+
+  unsigned getOutliningFrameOverhead() const override;
+
+  void insertOutlinerEpilogue(MachineBasicBlock &MBB,
+                              MachineFunction &MF) const override;
+
+  MachineBasicBlock::iterator
+  insertOutlinedCall(MachineBasicBlock &MBB, MachineBasicBlock::iterator It,
+                     MachineFunction &MF) const override;
+
 protected:
   /// Commutes the operands in the given instruction by changing the operands
   /// order and/or changing the instruction's opcode and/or the immediate value
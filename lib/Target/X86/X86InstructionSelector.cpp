@@ -0,0 +1,406 @@
+//===- X86InstructionSelector.cpp --------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// X86. It covers the integer subset of generic MIR that X86LegalizerInfo
+/// accepts, which is what unoptimized builds mostly consist of.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "X86InstructionSelector.h"
+#include "X86InstrBuilder.h"
+#include "X86InstrInfo.h"
+#include "X86RegisterBankInfo.h"
+#include "X86RegisterInfo.h"
+#include "X86Subtarget.h"
+#include "X86TargetMachine.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "x86-isel"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+X86InstructionSelector::X86InstructionSelector(const X86TargetMachine &TM,
+                                               const X86Subtarget &STI,
+                                               const X86RegisterBankInfo &RBI)
+    : InstructionSelector(), TM(TM), STI(STI), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI) {}
+
+/// Return the general purpose register class holding a value of \p Size bits,
+/// or nullptr if there is none. s1 values live in 8-bit registers.
+static const TargetRegisterClass *getRegClassForSize(unsigned Size) {
+  if (Size <= 8)
+    return &X86::GR8RegClass;
+  if (Size == 16)
+    return &X86::GR16RegClass;
+  if (Size == 32)
+    return &X86::GR32RegClass;
+  if (Size == 64)
+    return &X86::GR64RegClass;
+  return nullptr;
+}
+
+/// Return the index of \p Size in the {8, 16, 32, 64} opcode tables below.
+static unsigned getSizeIdx(unsigned Size) {
+  switch (Size) {
+  case 8:
+    return 0;
+  case 16:
+    return 1;
+  case 32:
+    return 2;
+  default:
+    assert(Size == 64 && "Unexpected operation size");
+    return 3;
+  }
+}
+
+/// Constrain the generic virtual register \p Reg to the register class for
+/// its type. Registers that already have a class are left alone.
+static bool constrainToSizeClass(unsigned Reg, MachineRegisterInfo &MRI,
+                                 const RegisterBankInfo &RBI) {
+  if (!TargetRegisterInfo::isVirtualRegister(Reg) || MRI.getRegClassOrNull(Reg))
+    return true;
+  LLT Ty = MRI.getType(Reg);
+  const TargetRegisterClass *RC =
+      Ty.isValid() ? getRegClassForSize(Ty.getSizeInBits()) : nullptr;
+  if (!RC || !RBI.constrainGenericRegister(Reg, *RC, MRI)) {
+    DEBUG(dbgs() << "Failed to constrain " << PrintReg(Reg) << '\n');
+    return false;
+  }
+  return true;
+}
+
+bool X86InstructionSelector::selectCopy(MachineInstr &I,
+                                        MachineRegisterInfo &MRI) const {
+  // Copies and phis do not have constraints of their own: give every
+  // generic vreg they touch the class of its size. Physical registers come
+  // from the calling convention and already have the right width.
+  for (MachineOperand &MO : I.operands())
+    if (MO.isReg() && !constrainToSizeClass(MO.getReg(), MRI, RBI))
+      return false;
+  return true;
+}
+
+bool X86InstructionSelector::selectBinaryOp(MachineInstr &I,
+                                            MachineRegisterInfo &MRI) const {
+  static const unsigned OpcTable[][4] = {
+      {X86::ADD8rr, X86::ADD16rr, X86::ADD32rr, X86::ADD64rr},
+      {X86::SUB8rr, X86::SUB16rr, X86::SUB32rr, X86::SUB64rr},
+      {X86::AND8rr, X86::AND16rr, X86::AND32rr, X86::AND64rr},
+      {X86::OR8rr, X86::OR16rr, X86::OR32rr, X86::OR64rr},
+      {X86::XOR8rr, X86::XOR16rr, X86::XOR32rr, X86::XOR64rr},
+      {0, X86::IMUL16rr, X86::IMUL32rr, X86::IMUL64rr}};
+
+  unsigned Row;
+  switch (I.getOpcode()) {
+  case TargetOpcode::G_ADD: Row = 0; break;
+  case TargetOpcode::G_SUB: Row = 1; break;
+  case TargetOpcode::G_AND: Row = 2; break;
+  case TargetOpcode::G_OR:  Row = 3; break;
+  case TargetOpcode::G_XOR: Row = 4; break;
+  case TargetOpcode::G_MUL: Row = 5; break;
+  default:
+    llvm_unreachable("Unexpected binary operation");
+  }
+
+  const unsigned DefReg = I.getOperand(0).getReg();
+  const unsigned Size = MRI.getType(DefReg).getSizeInBits();
+  const unsigned Opc = OpcTable[Row][getSizeIdx(Size)];
+  if (!Opc)
+    return false;
+
+  // The x86 instructions are two-address and clobber EFLAGS: build a fresh
+  // instruction so that the tied operands and implicit defs are set up.
+  MachineBasicBlock &MBB = *I.getParent();
+  auto MIB = BuildMI(MBB, I, I.getDebugLoc(), TII.get(Opc), DefReg)
+                 .addReg(I.getOperand(1).getReg())
+                 .addReg(I.getOperand(2).getReg());
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+bool X86InstructionSelector::selectLoadStore(MachineInstr &I,
+                                             MachineRegisterInfo &MRI) const {
+  static const unsigned LoadOpc[] = {X86::MOV8rm, X86::MOV16rm, X86::MOV32rm,
+                                     X86::MOV64rm};
+  static const unsigned StoreOpc[] = {X86::MOV8mr, X86::MOV16mr, X86::MOV32mr,
+                                      X86::MOV64mr};
+
+  const bool IsStore = I.getOpcode() == TargetOpcode::G_STORE;
+  const unsigned ValReg = I.getOperand(0).getReg();
+  const unsigned PtrReg = I.getOperand(1).getReg();
+  if (MRI.getType(PtrReg) != LLT::pointer(0, 64)) {
+    DEBUG(dbgs() << "Load/Store pointer has type: " << MRI.getType(PtrReg)
+                 << ", expected: " << LLT::pointer(0, 64) << '\n');
+    return false;
+  }
+  const unsigned SizeIdx = getSizeIdx(MRI.getType(ValReg).getSizeInBits());
+
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineInstrBuilder MIB;
+  if (IsStore)
+    MIB = addDirectMem(
+              BuildMI(MBB, I, I.getDebugLoc(), TII.get(StoreOpc[SizeIdx])),
+              PtrReg)
+              .addReg(ValReg);
+  else
+    MIB = addDirectMem(BuildMI(MBB, I, I.getDebugLoc(),
+                               TII.get(LoadOpc[SizeIdx]), ValReg),
+                       PtrReg);
+  MIB.setMemRefs(I.memoperands_begin(), I.memoperands_end());
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+static X86::CondCode getX86ConditionCode(CmpInst::Predicate Pred) {
+  switch (Pred) {
+  case CmpInst::ICMP_EQ:  return X86::COND_E;
+  case CmpInst::ICMP_NE:  return X86::COND_NE;
+  case CmpInst::ICMP_UGT: return X86::COND_A;
+  case CmpInst::ICMP_UGE: return X86::COND_AE;
+  case CmpInst::ICMP_ULT: return X86::COND_B;
+  case CmpInst::ICMP_ULE: return X86::COND_BE;
+  case CmpInst::ICMP_SGT: return X86::COND_G;
+  case CmpInst::ICMP_SGE: return X86::COND_GE;
+  case CmpInst::ICMP_SLT: return X86::COND_L;
+  case CmpInst::ICMP_SLE: return X86::COND_LE;
+  default:                return X86::COND_INVALID;
+  }
+}
+
+bool X86InstructionSelector::selectCompare(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  static const unsigned CmpOpc[] = {X86::CMP8rr, X86::CMP16rr, X86::CMP32rr,
+                                    X86::CMP64rr};
+
+  auto Pred = static_cast<CmpInst::Predicate>(I.getOperand(1).getPredicate());
+  X86::CondCode CC = getX86ConditionCode(Pred);
+  if (CC == X86::COND_INVALID)
+    return false;
+
+  const unsigned LHS = I.getOperand(2).getReg();
+  const unsigned RHS = I.getOperand(3).getReg();
+  const unsigned SizeIdx = getSizeIdx(MRI.getType(LHS).getSizeInBits());
+
+  MachineBasicBlock &MBB = *I.getParent();
+  auto Cmp = BuildMI(MBB, I, I.getDebugLoc(), TII.get(CmpOpc[SizeIdx]))
+                 .addReg(LHS)
+                 .addReg(RHS);
+  auto Set = BuildMI(MBB, I, I.getDebugLoc(), TII.get(X86::getSETFromCond(CC)),
+                     I.getOperand(0).getReg());
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*Cmp, TII, TRI, RBI) &&
+         constrainSelectedInstRegOperands(*Set, TII, TRI, RBI);
+}
+
+bool X86InstructionSelector::selectExtend(MachineInstr &I,
+                                          MachineRegisterInfo &MRI) const {
+  // Indexed by [source size: 8, 16, 32][destination size: 16, 32, 64].
+  static const unsigned ZExtOpc[][3] = {
+      {X86::MOVZX16rr8, X86::MOVZX32rr8, X86::MOVZX64rr8},
+      {0, X86::MOVZX32rr16, X86::MOVZX64rr16},
+      {0, 0, 0}};
+  static const unsigned SExtOpc[][3] = {
+      {X86::MOVSX16rr8, X86::MOVSX32rr8, X86::MOVSX64rr8},
+      {0, X86::MOVSX32rr16, X86::MOVSX64rr16},
+      {0, 0, X86::MOVSX64rr32}};
+
+  const unsigned Opcode = I.getOpcode();
+  const unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+  const unsigned DstSize = MRI.getType(DstReg).getSizeInBits();
+  unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  if (!constrainToSizeClass(SrcReg, MRI, RBI))
+    return false;
+
+  // An s1 lives in an 8-bit register whose upper bits are undefined.
+  if (SrcSize == 1) {
+    if (Opcode != TargetOpcode::G_ANYEXT) {
+      unsigned Masked = MRI.createVirtualRegister(&X86::GR8RegClass);
+      BuildMI(MBB, I, DL, TII.get(X86::AND8ri), Masked)
+          .addReg(SrcReg)
+          .addImm(1);
+      SrcReg = Masked;
+      if (Opcode == TargetOpcode::G_SEXT) {
+        unsigned Neg = MRI.createVirtualRegister(&X86::GR8RegClass);
+        BuildMI(MBB, I, DL, TII.get(X86::NEG8r), Neg).addReg(SrcReg);
+        SrcReg = Neg;
+      }
+    }
+    SrcSize = 8;
+  }
+
+  MachineInstrBuilder MIB;
+  if (Opcode != TargetOpcode::G_SEXT && SrcSize == 32) {
+    // 32-bit operations implicitly zero the upper half of the register.
+    unsigned Tmp = MRI.createVirtualRegister(&X86::GR32RegClass);
+    BuildMI(MBB, I, DL, TII.get(X86::MOV32rr), Tmp).addReg(SrcReg);
+    MIB = BuildMI(MBB, I, DL, TII.get(TargetOpcode::SUBREG_TO_REG), DstReg)
+              .addImm(0)
+              .addReg(Tmp)
+              .addImm(X86::sub_32bit);
+    I.eraseFromParent();
+    return constrainToSizeClass(DstReg, MRI, RBI);
+  }
+
+  const unsigned Row = getSizeIdx(SrcSize);
+  const unsigned Col = getSizeIdx(DstSize) - 1;
+  const unsigned Opc =
+      Opcode == TargetOpcode::G_SEXT ? SExtOpc[Row][Col] : ZExtOpc[Row][Col];
+  if (!Opc)
+    return false;
+  MIB = BuildMI(MBB, I, DL, TII.get(Opc), DstReg).addReg(SrcReg);
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+bool X86InstructionSelector::selectTrunc(MachineInstr &I,
+                                         MachineRegisterInfo &MRI) const {
+  const unsigned DstReg = I.getOperand(0).getReg();
+  const unsigned SrcReg = I.getOperand(1).getReg();
+  const unsigned DstSize = std::max(MRI.getType(DstReg).getSizeInBits(), 8U);
+  const unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+
+  if (!constrainToSizeClass(DstReg, MRI, RBI) ||
+      !constrainToSizeClass(SrcReg, MRI, RBI))
+    return false;
+
+  // A truncation is a copy of the low sub-register.
+  I.setDesc(TII.get(TargetOpcode::COPY));
+  if (DstSize != SrcSize) {
+    unsigned SubIdx = DstSize == 8    ? X86::sub_8bit
+                      : DstSize == 16 ? X86::sub_16bit
+                                      : X86::sub_32bit;
+    I.getOperand(1).setSubReg(SubIdx);
+  }
+  return true;
+}
+
+bool X86InstructionSelector::select(MachineInstr &I) const {
+  assert(I.getParent() && "Instruction should be in a basic block!");
+  assert(I.getParent()->getParent() && "Instruction should be in a function!");
+
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  if (!isPreISelGenericOpcode(I.getOpcode()))
+    return (!I.isCopy() && !I.isPHI()) || selectCopy(I, MRI);
+
+  if (I.getNumOperands() != I.getNumExplicitOperands()) {
+    DEBUG(dbgs() << "Generic instruction has unexpected implicit operands\n");
+    return false;
+  }
+
+  switch (I.getOpcode()) {
+  case TargetOpcode::G_ADD:
+  case TargetOpcode::G_SUB:
+  case TargetOpcode::G_AND:
+  case TargetOpcode::G_OR:
+  case TargetOpcode::G_XOR:
+  case TargetOpcode::G_MUL:
+    return selectBinaryOp(I, MRI);
+
+  case TargetOpcode::G_GEP: {
+    auto MIB = BuildMI(MBB, I, I.getDebugLoc(), TII.get(X86::LEA64r),
+                       I.getOperand(0).getReg())
+                   .addReg(I.getOperand(1).getReg())
+                   .addImm(1)
+                   .addReg(I.getOperand(2).getReg())
+                   .addImm(0)
+                   .addReg(0);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_FRAME_INDEX: {
+    auto MIB = BuildMI(MBB, I, I.getDebugLoc(), TII.get(X86::LEA64r),
+                       I.getOperand(0).getReg())
+                   .addFrameIndex(I.getOperand(1).getIndex())
+                   .addImm(1)
+                   .addReg(0)
+                   .addImm(0)
+                   .addReg(0);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_CONSTANT: {
+    static const unsigned MovOpc[] = {X86::MOV8ri, X86::MOV16ri, X86::MOV32ri,
+                                      X86::MOV64ri};
+    const unsigned DefReg = I.getOperand(0).getReg();
+    const MachineOperand &ImmOp = I.getOperand(1);
+    int64_t Val = ImmOp.isCImm() ? ImmOp.getCImm()->getSExtValue()
+                                 : ImmOp.getImm();
+    unsigned Opc = MovOpc[getSizeIdx(MRI.getType(DefReg).getSizeInBits())];
+    if (Opc == X86::MOV64ri && isInt<32>(Val))
+      Opc = X86::MOV64ri32;
+    auto MIB =
+        BuildMI(MBB, I, I.getDebugLoc(), TII.get(Opc), DefReg).addImm(Val);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_LOAD:
+  case TargetOpcode::G_STORE:
+    return selectLoadStore(I, MRI);
+
+  case TargetOpcode::G_ICMP:
+    return selectCompare(I, MRI);
+
+  case TargetOpcode::G_BR:
+    I.setDesc(TII.get(X86::JMP_1));
+    return true;
+
+  case TargetOpcode::G_BRCOND: {
+    const unsigned CondReg = I.getOperand(0).getReg();
+    MachineBasicBlock *DestMBB = I.getOperand(1).getMBB();
+    auto Test = BuildMI(MBB, I, I.getDebugLoc(), TII.get(X86::TEST8ri))
+                    .addReg(CondReg)
+                    .addImm(1);
+    BuildMI(MBB, I, I.getDebugLoc(),
+            TII.get(X86::GetCondBranchFromCond(X86::COND_NE)))
+        .addMBB(DestMBB);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*Test, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_ZEXT:
+  case TargetOpcode::G_SEXT:
+  case TargetOpcode::G_ANYEXT:
+    return selectExtend(I, MRI);
+
+  case TargetOpcode::G_TRUNC:
+    return selectTrunc(I, MRI);
+
+  case TargetOpcode::G_PTRTOINT:
+  case TargetOpcode::G_INTTOPTR:
+    // Pointers and 64-bit integers share the same registers.
+    I.setDesc(TII.get(TargetOpcode::COPY));
+    return selectCopy(I, MRI);
+
+  default:
+    return false;
+  }
+}
@@ -0,0 +1,98 @@
+//===- X86LegalizerInfo.cpp --------------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the Machinelegalizer class for X86.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "X86LegalizerInfo.h"
+#include "X86Subtarget.h"
+#include "llvm/CodeGen/ValueTypes.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+X86LegalizerInfo::X86LegalizerInfo(const X86Subtarget &STI) {
+  using namespace TargetOpcode;
+
+  // Only x86-64 is supported; on other subtargets nothing is legal and every
+  // function falls back to SelectionDAG.
+  if (STI.is64Bit()) {
+    const LLT p0 = LLT::pointer(0, 64);
+    const LLT s1 = LLT::scalar(1);
+    const LLT s8 = LLT::scalar(8);
+    const LLT s16 = LLT::scalar(16);
+    const LLT s32 = LLT::scalar(32);
+    const LLT s64 = LLT::scalar(64);
+
+    for (auto BinOp : {G_ADD, G_SUB, G_AND, G_OR, G_XOR})
+      for (auto Ty : {s8, s16, s32, s64})
+        setAction({BinOp, Ty}, Legal);
+
+    // There is no two-address 8-bit multiply.
+    for (auto Ty : {s16, s32, s64})
+      setAction({G_MUL, Ty}, Legal);
+    setAction({G_MUL, s8}, WidenScalar);
+
+    setAction({G_GEP, p0}, Legal);
+    setAction({G_GEP, 1, s64}, Legal);
+
+    for (auto MemOp : {G_LOAD, G_STORE}) {
+      for (auto Ty : {s8, s16, s32, s64, p0})
+        setAction({MemOp, Ty}, Legal);
+      setAction({MemOp, 1, p0}, Legal);
+    }
+
+    // Constants
+    for (auto Ty : {s8, s16, s32, s64, p0})
+      setAction({G_CONSTANT, Ty}, Legal);
+
+    // Comparisons produce an s1 in an 8-bit register with SETcc.
+    setAction({G_ICMP, s1}, Legal);
+    for (auto Ty : {s8, s16, s32, s64, p0})
+      setAction({G_ICMP, 1, Ty}, Legal);
+
+    // Extensions and truncations between the register sizes.
+    for (auto Ty : {s16, s32, s64}) {
+      setAction({G_ZEXT, Ty}, Legal);
+      setAction({G_SEXT, Ty}, Legal);
+      setAction({G_ANYEXT, Ty}, Legal);
+    }
+    for (auto Ty : {s1, s8, s16, s32}) {
+      setAction({G_ZEXT, 1, Ty}, Legal);
+      setAction({G_SEXT, 1, Ty}, Legal);
+      setAction({G_ANYEXT, 1, Ty}, Legal);
+    }
+
+    for (auto Ty : {s1, s8, s16, s32})
+      setAction({G_TRUNC, Ty}, Legal);
+    for (auto Ty : {s8, s16, s32, s64})
+      setAction({G_TRUNC, 1, Ty}, Legal);
+
+    // Control-flow
+    setAction({G_BRCOND, s1}, Legal);
+
+    // Pointer-handling
+    setAction({G_FRAME_INDEX, p0}, Legal);
+
+    setAction({G_PTRTOINT, 0, s64}, Legal);
+    setAction({G_PTRTOINT, 1, p0}, Legal);
+
+    setAction({G_INTTOPTR, 0, p0}, Legal);
+    setAction({G_INTTOPTR, 1, s64}, Legal);
+  }
+
+  computeTables();
+}
@@ -0,0 +1,30 @@
+//===- X86LegalizerInfo.h ----------------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the Machinelegalizer class for X86.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_X86_X86MACHINELEGALIZER_H
+#define LLVM_LIB_TARGET_X86_X86MACHINELEGALIZER_H
+
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+
+namespace llvm {
+
+class X86Subtarget;
+
+/// This class provides the legalization rules for the x86-64 subset that the
+/// X86 instruction selector handles.
+class X86LegalizerInfo : public LegalizerInfo {
+public:
+  X86LegalizerInfo(const X86Subtarget &STI);
+};
+} // End llvm namespace.
+#endif
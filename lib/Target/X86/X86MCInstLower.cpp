@@ -1120,13 +1120,19 @@ void X86AsmPrinter::EmitXRayTable() {
     auto PrevSection = OutStreamer->getCurrentSectionOnly();
     auto Fn = MF->getFunction();
     MCSection *Section = nullptr;
+    MCSection *IdxSection = nullptr;
     if (Fn->hasComdat()) {
       Section = OutContext.getELFSection("xray_instr_map", ELF::SHT_PROGBITS,
                                          ELF::SHF_ALLOC | ELF::SHF_GROUP, 0,
                                          Fn->getComdat()->getName());
+      IdxSection = OutContext.getELFSection("xray_fn_idx", ELF::SHT_PROGBITS,
+                                            ELF::SHF_ALLOC | ELF::SHF_GROUP, 0,
+                                            Fn->getComdat()->getName());
     } else {
       Section = OutContext.getELFSection("xray_instr_map", ELF::SHT_PROGBITS,
                                          ELF::SHF_ALLOC);
+      IdxSection = OutContext.getELFSection("xray_fn_idx", ELF::SHT_PROGBITS,
+                                            ELF::SHF_ALLOC);
     }
 
     // Before we switch over, we force a reference to a label inside the
@@ -1151,6 +1157,17 @@ void X86AsmPrinter::EmitXRayTable() {
           StringRef(reinterpret_cast<const char *>(&Sled.AlwaysInstrument), 1));
       OutStreamer->EmitZeros(14);
     }
+    MCSymbol *SledsEnd = OutContext.createTempSymbol("xray_sleds_end", true);
+    OutStreamer->EmitLabel(SledsEnd);
+
+    // The function index has one entry per function with the bounds of its
+    // sleds in xray_instr_map. The runtime uses it to find the sleds of a
+    // function id in constant time and to patch functions in batches without
+    // scanning the whole map.
+    OutStreamer->SwitchSection(IdxSection);
+    OutStreamer->EmitValueToAlignment(16);
+    OutStreamer->EmitSymbolValue(Tmp, 8, false);
+    OutStreamer->EmitSymbolValue(SledsEnd, 8, false);
     OutStreamer->SwitchSection(PrevSection);
   }
   Sleds.clear();
@@ -0,0 +1,94 @@
+//===- X86RegisterBankInfo.cpp ---------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the RegisterBankInfo class for X86.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "X86RegisterBankInfo.h"
+#include "X86InstrInfo.h" // For XXXRegClassID.
+#include "llvm/CodeGen/LowLevelType.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBank.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+namespace llvm {
+namespace X86 {
+RegisterBank GPRRegBank;
+
+RegisterBank *RegBanks[] = {&GPRRegBank};
+} // End X86 namespace.
+} // End llvm namespace.
+
+X86RegisterBankInfo::X86RegisterBankInfo(const TargetRegisterInfo &TRI)
+    : RegisterBankInfo(X86::RegBanks, X86::NumRegisterBanks) {
+  static bool AlreadyInit = false;
+  // We have only one set of register banks, whatever the subtarget
+  // is. Therefore, the initialization of the RegBanks table should be
+  // done only once.
+  if (AlreadyInit)
+    return;
+  AlreadyInit = true;
+
+  // The GPR register bank is fully defined by all the registers in
+  // GR64 + its subclasses and sub-register classes.
+  createRegisterBank(X86::GPRRegBankID, "GPR");
+  addRegBankCoverage(X86::GPRRegBankID, X86::GR64RegClassID, TRI);
+  const RegisterBank &RBGPR = getRegBank(X86::GPRRegBankID);
+  (void)RBGPR;
+  assert(&X86::GPRRegBank == &RBGPR && "The order in RegBanks is messed up");
+  assert(RBGPR.covers(*TRI.getRegClass(X86::GR8RegClassID)) &&
+         "Subclass not added?");
+  assert(RBGPR.getSize() == 64 && "GPRs should hold up to 64-bit");
+}
+
+const RegisterBank &X86RegisterBankInfo::getRegBankFromRegClass(
+    const TargetRegisterClass &RC) const {
+  if (X86::GPRRegBank.covers(RC))
+    return getRegBank(X86::GPRRegBankID);
+  llvm_unreachable("Register class not supported");
+}
+
+RegisterBankInfo::InstructionMapping
+X86RegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
+  // Try the default logic for non-generic instructions that are either copies
+  // or already have some operands assigned to banks.
+  if (!isPreISelGenericOpcode(MI.getOpcode())) {
+    RegisterBankInfo::InstructionMapping Mapping = getInstrMappingImpl(MI);
+    if (Mapping.isValid())
+      return Mapping;
+  }
+
+  const MachineFunction &MF = *MI.getParent()->getParent();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  unsigned NumOperands = MI.getNumOperands();
+
+  // Everything that survived legalization is an integer or a pointer and
+  // lives in a general purpose register.
+  SmallVector<const ValueMapping *, 8> OpdsMapping(NumOperands);
+  for (unsigned Idx = 0; Idx < NumOperands; ++Idx) {
+    const MachineOperand &MO = MI.getOperand(Idx);
+    if (!MO.isReg())
+      continue;
+    LLT Ty = MRI.getType(MO.getReg());
+    assert(Ty.isValid() && !Ty.isVector() && "Operation should be illegal");
+    OpdsMapping[Idx] =
+        &getValueMapping(0, Ty.getSizeInBits(), X86::GPRRegBank);
+  }
+
+  return InstructionMapping{DefaultMappingID, /*Cost=*/1,
+                            getOperandsMapping(OpdsMapping), NumOperands};
+}
@@ -0,0 +1,46 @@
+//===- X86RegisterBankInfo -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the RegisterBankInfo class for X86.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_X86_X86REGISTERBANKINFO_H
+#define LLVM_LIB_TARGET_X86_X86REGISTERBANKINFO_H
+
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+
+namespace llvm {
+
+class TargetRegisterInfo;
+
+namespace X86 {
+enum {
+  GPRRegBankID = 0, /// General Purpose Registers: AL, AX, EAX, RAX and co.
+  NumRegisterBanks
+};
+
+extern RegisterBank GPRRegBank;
+} // End X86 namespace.
+
+/// This class provides the information for the target register banks.
+/// Only the general purpose registers are modeled for now: the legalizer
+/// rejects floating point and vector operations, so those functions are
+/// left to SelectionDAG.
+class X86RegisterBankInfo final : public RegisterBankInfo {
+public:
+  X86RegisterBankInfo(const TargetRegisterInfo &TRI);
+
+  const RegisterBank &
+  getRegBankFromRegClass(const TargetRegisterClass &RC) const override;
+
+  InstructionMapping getInstrMapping(const MachineInstr &MI) const override;
+};
+} // End llvm namespace.
+#endif
@@ -40,6 +40,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "X86TargetTransformInfo.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/CodeGen/BasicTTIImpl.h"
 #include "llvm/IR/IntrinsicInst.h"
@@ -110,6 +111,27 @@ unsigned X86TTIImpl::getMaxInterleaveFactor(unsigned VF) {
   return 2;
 }
 
+unsigned X86TTIImpl::getCacheLineSize() {
+  // Every x86 processor we model uses 64 byte lines, so this is also the
+  // answer for CPUs whose scheduling model does not describe its caches.
+  if (unsigned LineSize = BaseT::getCacheLineSize())
+    return LineSize;
+  return 64;
+}
+
+unsigned X86TTIImpl::getPrefetchDistance() {
+  // Software prefetching is only enabled for the subtargets that ask for it.
+  return ST->useLoopDataPrefetch() ? 256 : 0;
+}
+
+unsigned X86TTIImpl::getMinPrefetchStride() {
+  // The hardware stride prefetchers already cover strides within a page, so
+  // only strides beyond that and indirect accesses are left to software.
+  return 4096;
+}
+
+unsigned X86TTIImpl::getMaxPrefetchIterationsAhead() { return 64; }
+
 int X86TTIImpl::getArithmeticInstrCost(
     unsigned Opcode, Type *Ty, TTI::OperandValueKind Op1Info,
     TTI::OperandValueKind Op2Info, TTI::OperandValueProperties Opd1PropInfo,
@@ -1800,3 +1822,12 @@ bool X86TTIImpl::enableInterleavedAccessVectorization() {
   // As a temporary solution, disable on Atom.
   return !(ST->isAtom() || ST->isSLM());
 }
+
+bool X86TTIImpl::hasTargetFeature(StringRef Feature) {
+  return StringSwitch<bool>(Feature)
+      .Case("sse2", ST->hasSSE2())
+      .Case("avx", ST->hasAVX())
+      .Case("avx2", ST->hasAVX2())
+      .Case("avx512f", ST->hasAVX512())
+      .Default(false);
+}
@@ -55,6 +55,10 @@ public:
   unsigned getNumberOfRegisters(bool Vector);
   unsigned getRegisterBitWidth(bool Vector);
   unsigned getMaxInterleaveFactor(unsigned VF);
+  unsigned getCacheLineSize();
+  unsigned getPrefetchDistance();
+  unsigned getMinPrefetchStride();
+  unsigned getMaxPrefetchIterationsAhead();
   int getArithmeticInstrCost(
       unsigned Opcode, Type *Ty,
       TTI::OperandValueKind Opd1Info = TTI::OK_AnyValue,
@@ -95,6 +99,7 @@ public:
                            const Function *Callee) const;
 
   bool enableInterleavedAccessVectorization();
+  bool hasTargetFeature(StringRef Feature);
 private:
   int getGSScalarCost(unsigned Opcode, Type *DataTy, bool VariableMask,
                       unsigned Alignment, unsigned AddressSpace);
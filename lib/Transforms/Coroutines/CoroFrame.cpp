@@ -12,9 +12,8 @@
 // Using the information discovered we form a Coroutine Frame structure to
 // contain those values. All uses of those values are replaced with appropriate
 // GEP + load from the coroutine frame. At the point of the definition we spill
-// the value into the coroutine frame.
-//
-// TODO: pack values tightly using liveness info.
+// the value into the coroutine frame. Spilled values of the same type whose
+// live ranges in the frame do not overlap share a field.
 //===----------------------------------------------------------------------===//
 
 #include "CoroInternal.h"
@@ -23,6 +22,7 @@
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/InstIterator.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/circular_raw_ostream.h"
@@ -37,6 +37,11 @@ using namespace llvm;
 
 enum { SmallVectorThreshold = 32 };
 
+static cl::opt<bool> ReuseFrameSlots(
+    "coro-reuse-frame-slots", cl::Hidden, cl::init(true),
+    cl::desc("Let spilled values whose live ranges in the coroutine frame do "
+             "not overlap share a frame field"));
+
 // Provides two way mapping between the blocks and numbers.
 namespace {
 class BlockToIndexMapping {
@@ -294,6 +299,68 @@ static void dump(StringRef Title, SpillInfo const &Spills) {
 }
 #endif
 
+// Where a spilled value occupies its frame field: for every block, the range
+// of instruction positions from the store after the definition, or the top of
+// the block, to the reload at the top of a use block, or the end of the block.
+using FieldLiveRange =
+    SmallDenseMap<BasicBlock *, std::pair<unsigned, unsigned>, 8>;
+
+// Compute the live range of the field of Def, whose spills are [Begin, End).
+static FieldLiveRange computeFieldLiveRange(Instruction *Def,
+                                            SpillInfo::const_iterator Begin,
+                                            SpillInfo::const_iterator End) {
+  const unsigned BlockEnd = ~0U;
+  BasicBlock *DefBB = Def->getParent();
+  FieldLiveRange Range;
+
+  // The field is reloaded at the top of every use block, and holds the value
+  // on every path to a use block from the definition.
+  SmallVector<BasicBlock *, 8> Worklist;
+  for (auto I = Begin; I != End; ++I)
+    if (Range.insert({I->userBlock(), {0, 0}}).second)
+      Worklist.push_back(I->userBlock());
+  while (!Worklist.empty()) {
+    BasicBlock *BB = Worklist.pop_back_val();
+    for (BasicBlock *Pred : predecessors(BB)) {
+      if (Pred == DefBB)
+        continue;
+      auto Ins = Range.insert({Pred, {0, BlockEnd}});
+      if (Ins.second)
+        Worklist.push_back(Pred);
+      else
+        Ins.first->second.second = BlockEnd;
+    }
+  }
+
+  // The definition block holds it from the store after the definition on,
+  // or all of the time if the definition is in a loop with its uses.
+  unsigned DefPos = std::distance(DefBB->begin(), Def->getIterator()) + 1;
+  auto Ins = Range.insert({DefBB, {DefPos, BlockEnd}});
+  if (!Ins.second)
+    Ins.first->second = {0, BlockEnd};
+  return Range;
+}
+
+static bool overlap(const FieldLiveRange &A, const FieldLiveRange &B) {
+  if (A.size() > B.size())
+    return overlap(B, A);
+  for (const auto &E : A) {
+    auto I = B.find(E.first);
+    if (I != B.end() && E.second.first <= I->second.second &&
+        I->second.first <= E.second.second)
+      return true;
+  }
+  return false;
+}
+
+// Only instructions stored after their definition and reloaded below the top
+// of their use blocks have the live ranges computed above. Allocas live in the
+// frame for the whole coroutine.
+static bool canShareFrameField(Value *Def) {
+  auto *I = dyn_cast<Instruction>(Def);
+  return I && !isa<AllocaInst>(I) && !isa<PHINode>(I) && !I->isEHPad();
+}
+
 // Build a struct that will keep state for an active coroutine.
 //   struct f.frame {
 //     ResumeFnTy ResumeFnAddr;
@@ -302,8 +369,10 @@ static void dump(StringRef Title, SpillInfo const &Spills) {
 //     ... promise (if present) ...
 //     ... spills ...
 //   };
+// and record the field of every spilled value in FieldIndices.
 static StructType *buildFrameType(Function &F, coro::Shape &Shape,
-                                  SpillInfo &Spills) {
+                                  SpillInfo &Spills,
+                                  DenseMap<Value *, unsigned> &FieldIndices) {
   LLVMContext &C = F.getContext();
   SmallString<32> Name(F.getName());
   Name.append(".Frame");
@@ -320,14 +389,23 @@ static StructType *buildFrameType(Function &F, coro::Shape &Shape,
                           : Type::getInt1Ty(C);
   SmallVector<Type *, 8> Types{FnPtrTy, FnPtrTy, PromiseType,
                                Type::getIntNTy(C, IndexBits)};
-  Value *CurrentDef = nullptr;
 
-  // Create an entry for every spilled value.
-  for (auto const &S : Spills) {
-    if (CurrentDef == S.def())
-      continue;
+  // The fields that spilled values may share, with the live ranges of the
+  // values already in them.
+  struct SharedField {
+    unsigned Index;
+    SmallVector<FieldLiveRange, 2> Occupants;
+  };
+  DenseMap<Type *, SmallVector<SharedField, 2>> SharedFields;
+
+  // Create an entry for every spilled value, or reuse one.
+  for (auto I = Spills.begin(), E = Spills.end(); I != E;) {
+    Value *CurrentDef = I->def();
+    auto DefEnd = std::find_if(
+        I, E, [&](const Spill &S) { return S.def() != CurrentDef; });
+    auto DefBegin = I;
+    I = DefEnd;
 
-    CurrentDef = S.def();
     // PromiseAlloca was already added to Types array earlier.
     if (CurrentDef == Shape.PromiseAlloca)
       continue;
@@ -338,7 +416,29 @@ static StructType *buildFrameType(Function &F, coro::Shape &Shape,
     else
       Ty = CurrentDef->getType();
 
-    Types.push_back(Ty);
+    if (!ReuseFrameSlots || !canShareFrameField(CurrentDef)) {
+      FieldIndices[CurrentDef] = Types.size();
+      Types.push_back(Ty);
+      continue;
+    }
+
+    FieldLiveRange Range =
+        computeFieldLiveRange(cast<Instruction>(CurrentDef), DefBegin, DefEnd);
+    auto &Fields = SharedFields[Ty];
+    auto Field = find_if(Fields, [&](const SharedField &F) {
+      return none_of(F.Occupants, [&](const FieldLiveRange &Occupant) {
+        return overlap(Range, Occupant);
+      });
+    });
+    if (Field == Fields.end()) {
+      Fields.push_back({static_cast<unsigned>(Types.size()), {}});
+      Field = std::prev(Fields.end());
+      Types.push_back(Ty);
+    }
+    DEBUG(dbgs() << "frame field " << Field->Index << ": " << *CurrentDef
+                 << "\n");
+    FieldIndices[CurrentDef] = Field->Index;
+    Field->Occupants.push_back(std::move(Range));
   }
   FrameTy->setBody(Types);
 
@@ -367,7 +467,8 @@ static StructType *buildFrameType(Function &F, coro::Shape &Shape,
 //    whatever
 //
 //
-static Instruction *insertSpills(SpillInfo &Spills, coro::Shape &Shape) {
+static Instruction *insertSpills(SpillInfo &Spills, coro::Shape &Shape,
+                                 DenseMap<Value *, unsigned> &FieldIndices) {
   auto *CB = Shape.CoroBegin;
   IRBuilder<> Builder(CB->getNextNode());
   PointerType *FramePtrTy = Shape.FrameTy->getPointerTo();
@@ -378,7 +479,7 @@ static Instruction *insertSpills(SpillInfo &Spills, coro::Shape &Shape) {
   Value *CurrentValue = nullptr;
   BasicBlock *CurrentBlock = nullptr;
   Value *CurrentReload = nullptr;
-  unsigned Index = coro::Shape::LastKnownField;
+  unsigned Index = 0;
 
   // We need to keep track of any allocas that need "spilling"
   // since they will live in the coroutine frame now, all access to them
@@ -410,7 +511,7 @@ static Instruction *insertSpills(SpillInfo &Spills, coro::Shape &Shape) {
       CurrentBlock = nullptr;
       CurrentReload = nullptr;
 
-      ++Index;
+      Index = FieldIndices.lookup(CurrentValue);
 
       if (auto *AI = dyn_cast<AllocaInst>(CurrentValue)) {
         // Spilled AllocaInst will be replaced with GEP from the coroutine frame
@@ -722,6 +823,7 @@ void coro::buildCoroutineFrame(Function &F, Shape &Shape) {
   std::sort(Spills.begin(), Spills.end());
   DEBUG(dump("Spills", Spills));
   moveSpillUsesAfterCoroBegin(F, Spills, Shape.CoroBegin);
-  Shape.FrameTy = buildFrameType(F, Shape, Spills);
-  Shape.FramePtr = insertSpills(Spills, Shape);
+  DenseMap<Value *, unsigned> FieldIndices;
+  Shape.FrameTy = buildFrameType(F, Shape, Spills, FieldIndices);
+  Shape.FramePtr = insertSpills(Spills, Shape, FieldIndices);
 }
@@ -13,6 +13,7 @@
 
 #include "llvm/Transforms/IPO/FunctionImport.h"
 
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSet.h"
@@ -28,6 +29,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
@@ -65,6 +67,11 @@ static cl::opt<float> ImportColdMultiplier(
     "import-cold-multiplier", cl::init(0), cl::Hidden, cl::value_desc("N"),
     cl::desc("Multiply the `import-instr-limit` threshold for cold callsites"));
 
+static cl::opt<bool> ImportReadOnlyGlobals(
+    "import-readonly-globals", cl::init(true), cl::Hidden,
+    cl::desc("Import the definition of global variables found read-only by "
+             "the thin link along with the functions referencing them"));
+
 static cl::opt<bool> PrintImports("print-imports", cl::init(false), cl::Hidden,
                                   cl::desc("Print imported functions"));
 
@@ -277,6 +284,53 @@ static void exportGlobalInModule(const ModuleSummaryIndex &Index,
   }
 }
 
+/// Return a summary of global variable \p GUID that can be imported as a
+/// definition because nothing in the program writes to the variable, or null.
+static const GlobalVarSummary *
+selectReadOnlyVariable(GlobalValue::GUID GUID,
+                       const ModuleSummaryIndex &Index) {
+  auto SummaryList = Index.findGlobalValueSummaryList(GUID);
+  if (SummaryList == Index.end())
+    return nullptr;
+  for (auto &Summary : SummaryList->second) {
+    auto *GVS = dyn_cast<GlobalVarSummary>(Summary.get());
+    if (!GVS || !GVS->isReadOnly())
+      continue;
+    // Pick a copy that the linker keeps.
+    if (GlobalValue::isAvailableExternallyLinkage(GVS->linkage()) ||
+        GlobalValue::isInterposableLinkage(GVS->linkage()))
+      continue;
+    return GVS;
+  }
+  return nullptr;
+}
+
+/// Import the read-only global variables referenced by \p Summary, so that
+/// loads from them can be folded in the importing module.
+static void computeImportForReferencedGlobals(
+    const FunctionSummary &Summary, const ModuleSummaryIndex &Index,
+    const unsigned Threshold, const GVSummaryMapTy &DefinedGVSummaries,
+    FunctionImporter::ImportMapTy &ImportList,
+    StringMap<FunctionImporter::ExportSetTy> *ExportLists) {
+  for (auto &Ref : Summary.refs()) {
+    auto GUID = Ref.getGUID();
+    if (DefinedGVSummaries.count(GUID))
+      continue;
+    auto *GVS = selectReadOnlyVariable(GUID, Index);
+    if (!GVS)
+      continue;
+    auto ExportModulePath = GVS->modulePath();
+    if (!ImportList[ExportModulePath].insert({GUID, Threshold}).second)
+      continue;
+    DEBUG(dbgs() << " ref -> " << GUID << " imported read-only\n");
+    // The imported copy is available_externally: the original definition and
+    // everything its initializer references must stay around.
+    if (ExportLists)
+      exportGlobalInModule(Index, ExportModulePath, GUID,
+                           (*ExportLists)[ExportModulePath]);
+  }
+}
+
 using EdgeInfo = std::pair<const FunctionSummary *, unsigned /* Threshold */>;
 
 /// Compute the list of functions to import for a given caller. Mark these
@@ -288,6 +342,11 @@ static void computeImportForFunction(
     SmallVectorImpl<EdgeInfo> &Worklist,
     FunctionImporter::ImportMapTy &ImportList,
     StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
+  if (ImportReadOnlyGlobals)
+    computeImportForReferencedGlobals(Summary, Index, Threshold,
+                                      DefinedGVSummaries, ImportList,
+                                      ExportLists);
+
   for (auto &Edge : Summary.calls()) {
     auto GUID = Edge.first.getGUID();
     DEBUG(dbgs() << " edge -> " << GUID << " Threshold:" << Threshold << "\n");
@@ -418,14 +477,43 @@ void llvm::ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
-    StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
-  // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
-    DEBUG(dbgs() << "Computing import for Module '"
-                 << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index, ImportList,
-                           &ExportLists);
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists,
+    unsigned ThreadCount) {
+  if (ThreadCount <= 1) {
+    // For each module that has function defined, compute the import/export
+    // lists.
+    for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
+      auto &ImportList = ImportLists[DefinedGVSummaries.first()];
+      DEBUG(dbgs() << "Computing import for Module '"
+                   << DefinedGVSummaries.first() << "'\n");
+      ComputeImportForModule(DefinedGVSummaries.second, Index, ImportList,
+                             &ExportLists);
+    }
+  } else {
+    // The walk for one module only reads the index and writes its own import
+    // list, plus the exports it causes in other modules. Give each walk a
+    // private export map so that they can run concurrently, and merge the
+    // exports once they are all done. The merge is a set union, so the
+    // result does not depend on scheduling.
+    std::vector<std::pair<const GVSummaryMapTy *,
+                          FunctionImporter::ImportMapTy *>> Work;
+    for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries)
+      Work.push_back({&DefinedGVSummaries.second,
+                      &ImportLists[DefinedGVSummaries.first()]});
+    std::vector<StringMap<FunctionImporter::ExportSetTy>> ExportsPerModule(
+        Work.size());
+    {
+      ThreadPool Pool(ThreadCount);
+      for (unsigned I = 0, E = Work.size(); I != E; ++I)
+        Pool.async([&, I]() {
+          ComputeImportForModule(*Work[I].first, Index, *Work[I].second,
+                                 &ExportsPerModule[I]);
+        });
+    }
+    for (auto &Exports : ExportsPerModule)
+      for (auto &ExportList : Exports)
+        ExportLists[ExportList.first()].insert(ExportList.second.begin(),
+                                               ExportList.second.end());
   }
 
 #ifndef NDEBUG
@@ -627,14 +715,11 @@ bool FunctionImporter::importFunctions(
     assert(&DestModule.getContext() == &SrcModule->getContext() &&
            "Context mismatch");
 
-    // If modules were created with lazy metadata loading, materialize it
-    // now, before linking it (otherwise this will be a noop).
-    SrcModule->materializeMetadata();
-    UpgradeDebugInfo(*SrcModule);
-
     auto &ImportGUIDs = FunctionsToImportPerModule->second;
-    // Find the globals to import
-    DenseSet<const GlobalValue *> GlobalsToImport;
+    // Find the globals to import. The selection only needs the names of the
+    // source globals, so nothing is materialized until we know there is
+    // something to import from this module.
+    SetVector<GlobalValue *> GlobalsToMaterialize;
     for (Function &F : *SrcModule) {
       if (!F.hasName())
         continue;
@@ -643,19 +728,8 @@ bool FunctionImporter::importFunctions(
       DEBUG(dbgs() << (Import ? "Is" : "Not") << " importing function " << GUID
                    << " " << F.getName() << " from "
                    << SrcModule->getSourceFileName() << "\n");
-      if (Import) {
-        F.materialize();
-        if (EnableImportMetadata) {
-          // Add 'thinlto_src_module' metadata for statistics and debugging.
-          F.setMetadata(
-              "thinlto_src_module",
-              llvm::MDNode::get(
-                  DestModule.getContext(),
-                  {llvm::MDString::get(DestModule.getContext(),
-                                       SrcModule->getSourceFileName())}));
-        }
-        GlobalsToImport.insert(&F);
-      }
+      if (Import)
+        GlobalsToMaterialize.insert(&F);
     }
     for (GlobalVariable &GV : SrcModule->globals()) {
       if (!GV.hasName())
@@ -665,10 +739,8 @@ bool FunctionImporter::importFunctions(
       DEBUG(dbgs() << (Import ? "Is" : "Not") << " importing global " << GUID
                    << " " << GV.getName() << " from "
                    << SrcModule->getSourceFileName() << "\n");
-      if (Import) {
-        GV.materialize();
-        GlobalsToImport.insert(&GV);
-      }
+      if (Import)
+        GlobalsToMaterialize.insert(&GV);
     }
     for (GlobalAlias &GA : SrcModule->aliases()) {
       if (!GA.hasName())
@@ -687,18 +759,42 @@ bool FunctionImporter::importFunctions(
         assert(GO->hasLinkOnceODRLinkage() &&
                "Unexpected alias to a non-linkonceODR in import list");
 #ifndef NDEBUG
-        if (!GlobalsToImport.count(GO))
+        if (!GlobalsToMaterialize.count(GO))
           DEBUG(dbgs() << " alias triggers importing aliasee " << GO->getGUID()
                        << " " << GO->getName() << " from "
                        << SrcModule->getSourceFileName() << "\n");
 #endif
-        GO->materialize();
-        GlobalsToImport.insert(GO);
-        GA.materialize();
-        GlobalsToImport.insert(&GA);
+        GlobalsToMaterialize.insert(GO);
+        GlobalsToMaterialize.insert(&GA);
       }
     }
 
+    // None of the requested GUIDs is defined by name in this module (e.g. the
+    // summary is stale): don't pay for loading its metadata and linking it.
+    if (GlobalsToMaterialize.empty())
+      continue;
+
+    // If modules were created with lazy metadata loading, materialize it
+    // now, before linking it (otherwise this will be a noop).
+    SrcModule->materializeMetadata();
+    UpgradeDebugInfo(*SrcModule);
+
+    // Only the selected bodies are read from the bitcode.
+    DenseSet<const GlobalValue *> GlobalsToImport;
+    for (GlobalValue *GV : GlobalsToMaterialize) {
+      GV->materialize();
+      if (EnableImportMetadata)
+        if (auto *F = dyn_cast<Function>(GV))
+          // Add 'thinlto_src_module' metadata for statistics and debugging.
+          F->setMetadata(
+              "thinlto_src_module",
+              llvm::MDNode::get(
+                  DestModule.getContext(),
+                  {llvm::MDString::get(DestModule.getContext(),
+                                       SrcModule->getSourceFileName())}));
+      GlobalsToImport.insert(GV);
+    }
+
     // Link in the specified functions.
     if (renameModuleForThinLTO(*SrcModule, Index, &GlobalsToImport))
       return true;
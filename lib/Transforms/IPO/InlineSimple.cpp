@@ -60,7 +60,8 @@ public:
         [&](Function &F) -> AssumptionCache & {
       return ACT->getAssumptionCache(F);
     };
-    return llvm::getInlineCost(CS, Params, TTI, GetAssumptionCache, PSI);
+    return llvm::getInlineCost(CS, Params, TTI, GetAssumptionCache, PSI,
+                               &CostCache);
   }
 
   bool runOnSCC(CallGraphSCC &SCC) override;
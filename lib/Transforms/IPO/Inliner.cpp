@@ -332,9 +332,13 @@ shouldBeDeferred(Function *Caller, CallSite CS, InlineCost IC,
 }
 
 /// Return true if the inliner should attempt to inline at the given CallSite.
+/// If the call site is turned down only because inlining it would make its
+/// caller too expensive to inline elsewhere, set \p Deferred.  That decision
+/// also depends on the bodies of the caller's callers.
 static bool shouldInline(CallSite CS,
                          function_ref<InlineCost(CallSite CS)> GetInlineCost,
-                         OptimizationRemarkEmitter &ORE) {
+                         OptimizationRemarkEmitter &ORE,
+                         bool *Deferred = nullptr) {
   using namespace ore;
   InlineCost IC = GetInlineCost(CS);
   Instruction *Call = CS.getInstruction();
@@ -380,6 +384,8 @@ static bool shouldInline(CallSite CS,
              << "Not inlining. Cost of inlining " << NV("Callee", Callee)
              << " increases the cost of inlining " << NV("Caller", Caller)
              << " in other contexts");
+    if (Deferred)
+      *Deferred = true;
     return false;
   }
 
@@ -428,7 +434,8 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
                 bool InsertLifetime,
                 function_ref<InlineCost(CallSite CS)> GetInlineCost,
                 function_ref<AAResults &(Function &)> AARGetter,
-                ImportedFunctionsInliningStatistics &ImportedFunctionsStats) {
+                ImportedFunctionsInliningStatistics &ImportedFunctionsStats,
+                InlineCostCache &CostCache) {
   SmallPtrSet<Function *, 8> SCCFunctions;
   DEBUG(dbgs() << "Inliner visiting SCC:");
   for (CallGraphNode *Node : SCC) {
@@ -498,6 +505,23 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
   InlinedArrayAllocasTy InlinedArrayAllocas;
   InlineFunctionInfo InlineInfo(&CG, &GetAssumptionCache);
 
+  // Every successful inline sends us around the outer loop again, which used
+  // to recompute the inline cost of every call site that was already turned
+  // down.  The inputs to that decision are the callee's body and the use
+  // lists of the callee and the caller, so we keep a generation counter for
+  // each of those and only reconsider a rejected call site once one of them
+  // has moved on.  Deferred call sites are not remembered: whether they are
+  // deferred depends on the bodies of the caller and its callers as well.
+  DenseMap<Function *, unsigned> BodyGeneration, UsesGeneration;
+  DenseMap<Instruction *, std::pair<unsigned, std::pair<unsigned, unsigned>>>
+      RejectedCallSites;
+  auto getDecisionKey = [&](Function *Caller, Function *Callee) {
+    return std::make_pair(
+        BodyGeneration.lookup(Callee),
+        std::make_pair(UsesGeneration.lookup(Callee),
+                       UsesGeneration.lookup(Caller)));
+  };
+
   // Now that we have all of the call sites, loop over them and inline them if
   // it looks profitable to do so.
   bool Changed = false;
@@ -523,7 +547,11 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         // Update the call graph by deleting the edge from Callee to Caller.
         CG[Caller]->removeCallEdgeFor(CS);
         CS.getInstruction()->eraseFromParent();
+        CostCache.invalidate(Caller);
         ++NumCallsDeleted;
+        ++BodyGeneration[Caller];
+        if (Callee)
+          ++UsesGeneration[Callee];
       } else {
         // We can only inline direct calls to non-declarations.
         if (!Callee || Callee->isDeclaration())
@@ -539,6 +567,12 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
             InlineHistoryIncludes(Callee, InlineHistoryID, InlineHistory))
           continue;
 
+        // Nothing the last rejection depended on has changed since.
+        auto RI = RejectedCallSites.find(CS.getInstruction());
+        if (RI != RejectedCallSites.end() &&
+            RI->second == getDecisionKey(Caller, Callee))
+          continue;
+
         // Get DebugLoc to report. CS will be invalid after Inliner.
         DebugLoc DLoc = CS.getInstruction()->getDebugLoc();
         BasicBlock *Block = CS.getParent();
@@ -550,7 +584,11 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         // If the policy determines that we should inline this function,
         // try to do so.
         using namespace ore;
-        if (!shouldInline(CS, GetInlineCost, ORE)) {
+        bool Deferred = false;
+        if (!shouldInline(CS, GetInlineCost, ORE, &Deferred)) {
+          if (!Deferred)
+            RejectedCallSites[CS.getInstruction()] =
+                getDecisionKey(Caller, Callee);
           ORE.emit(
               OptimizationRemarkMissed(DEBUG_TYPE, "NotInlined", DLoc, Block)
               << NV("Callee", Callee) << " will not be inlined into "
@@ -574,6 +612,9 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         ORE.emit(OptimizationRemark(DEBUG_TYPE, "Inlined", DLoc, Block)
                  << NV("Callee", Callee) << " inlined into "
                  << NV("Caller", Caller));
+        ++BodyGeneration[Caller];
+        CostCache.invalidate(Caller);
+        ++UsesGeneration[Callee];
 
         // If inlining this function gave us any new call sites, throw them
         // onto our worklist to process.  They are useful inline candidates.
@@ -583,8 +624,14 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
           int NewHistoryID = InlineHistory.size();
           InlineHistory.push_back(std::make_pair(Callee, InlineHistoryID));
 
-          for (Value *Ptr : InlineInfo.InlinedCalls)
-            CallSites.push_back(std::make_pair(CallSite(Ptr), NewHistoryID));
+          for (Value *Ptr : InlineInfo.InlinedCalls) {
+            CallSite NewCS(Ptr);
+            // The new call may reuse the storage of an erased rejected one.
+            RejectedCallSites.erase(NewCS.getInstruction());
+            if (Function *F = NewCS.getCalledFunction())
+              ++UsesGeneration[F];
+            CallSites.push_back(std::make_pair(NewCS, NewHistoryID));
+          }
         }
       }
 
@@ -601,6 +648,7 @@ inlineCallsImpl(CallGraphSCC &SCC, CallGraph &CG,
         DEBUG(dbgs() << "    -> Deleting dead function: " << Callee->getName()
                      << "\n");
         CallGraphNode *CalleeNode = CG[Callee];
+        CostCache.invalidate(Callee);
 
         // Remove any call graph edges from the callee to its callees.
         CalleeNode->removeAllCalledFunctions();
@@ -648,9 +696,15 @@ bool Inliner::inlineCalls(CallGraphSCC &SCC) {
   auto GetAssumptionCache = [&](Function &F) -> AssumptionCache & {
     return ACT->getAssumptionCache(F);
   };
-  return inlineCallsImpl(SCC, CG, GetAssumptionCache, PSI, TLI, InsertLifetime,
-                         [this](CallSite CS) { return getInlineCost(CS); },
-                         AARGetter, ImportedFunctionsStats);
+  // Other passes in the CGSCC pipeline may have changed any function since
+  // the last SCC, so nothing cached then can be trusted now.
+  CostCache.clear();
+  bool Changed =
+      inlineCallsImpl(SCC, CG, GetAssumptionCache, PSI, TLI, InsertLifetime,
+                      [this](CallSite CS) { return getInlineCost(CS); },
+                      AARGetter, ImportedFunctionsStats, CostCache);
+  CostCache.clear();
+  return Changed;
 }
 
 /// Remove now-dead linkonce functions at the end of
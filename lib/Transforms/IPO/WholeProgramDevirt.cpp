@@ -54,6 +54,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/Pass.h"
 #include "llvm/PassRegistry.h"
 #include "llvm/PassSupport.h"
@@ -348,6 +349,57 @@ PreservedAnalyses WholeProgramDevirtPass::run(Module &M,
   return PreservedAnalyses::none();
 }
 
+bool llvm::applyThinLTODevirtualization(Module &M,
+                                        const ModuleSummaryIndex &Index) {
+  Function *TypeTestFunc =
+      M.getFunction(Intrinsic::getName(Intrinsic::type_test));
+  if (!TypeTestFunc || TypeTestFunc->use_empty())
+    return false;
+
+  bool Changed = false;
+  for (auto I = TypeTestFunc->use_begin(), E = TypeTestFunc->use_end();
+       I != E;) {
+    auto CI = dyn_cast<CallInst>(I->getUser());
+    ++I;
+    if (!CI)
+      continue;
+
+    SmallVector<DevirtCallSite, 1> DevirtCalls;
+    SmallVector<CallInst *, 1> Assumes;
+    findDevirtualizableCallsForTypeTest(DevirtCalls, Assumes, CI);
+    if (Assumes.empty())
+      continue;
+
+    // Only type identifiers with a name can be matched against the summary.
+    auto *TypeId = dyn_cast<MDString>(
+        cast<MetadataAsValue>(CI->getArgOperand(1))->getMetadata());
+    if (TypeId) {
+      for (DevirtCallSite Call : DevirtCalls) {
+        StringRef Target =
+            Index.getSingleImplementation(TypeId->getString(), Call.Offset);
+        if (Target.empty())
+          continue;
+        Value *Callee = Call.CS.getCalledValue();
+        Constant *Fn = M.getOrInsertFunction(
+            Target, cast<FunctionType>(
+                        Callee->getType()->getPointerElementType()));
+        Call.CS.setCalledFunction(
+            ConstantExpr::getBitCast(Fn, Callee->getType()));
+        Changed = true;
+      }
+    }
+
+    // The type tests are not lowered in the ThinLTO backends, so the
+    // assumptions must not reach code generation.
+    for (auto Assume : Assumes)
+      Assume->eraseFromParent();
+    if (CI->use_empty())
+      CI->eraseFromParent();
+    Changed = true;
+  }
+  return Changed;
+}
+
 void DevirtModule::buildTypeIdentifierMap(
     std::vector<VTableBits> &Bits,
     DenseMap<Metadata *, std::set<TypeMemberInfo>> &TypeIdMap) {
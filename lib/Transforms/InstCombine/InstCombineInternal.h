@@ -170,16 +170,22 @@ private:
   // combining and will be updated to reflect any changes.
   LoopInfo *LI;
 
+  /// Results of the known bits queries made since the IR last changed, or
+  /// null if they are not cached. The worklist clears it on every change it
+  /// sees, and it is cleared before each instruction is visited.
+  KnownBitsCache *KnownBits;
+
   bool MadeIRChange;
 
 public:
   InstCombiner(InstCombineWorklist &Worklist, BuilderTy *Builder,
                bool MinimizeSize, bool ExpensiveCombines, AliasAnalysis *AA,
                AssumptionCache &AC, TargetLibraryInfo &TLI,
-               DominatorTree &DT, const DataLayout &DL, LoopInfo *LI)
+               DominatorTree &DT, const DataLayout &DL, LoopInfo *LI,
+               KnownBitsCache *KnownBits = nullptr)
       : Worklist(Worklist), Builder(Builder), MinimizeSize(MinimizeSize),
         ExpensiveCombines(ExpensiveCombines), AA(AA), AC(AC), TLI(TLI), DT(DT),
-        DL(DL), LI(LI), MadeIRChange(false) {}
+        DL(DL), LI(LI), KnownBits(KnownBits), MadeIRChange(false) {}
 
   /// \brief Run the combiner over the entire worklist until it is empty.
   ///
@@ -453,24 +459,35 @@ public:
     return nullptr; // Don't do anything with FI
   }
 
+  /// Drop the cached known bits results after changing the IR in place,
+  /// without going through the worklist. A visitor that changes its
+  /// instruction in place and returns it straight away doesn't need this:
+  /// the cache is cleared before the next visit. Anything that makes more
+  /// known bits queries after an in-place change does.
+  void forgetKnownBits() {
+    if (KnownBits)
+      KnownBits->clear();
+  }
+
   void computeKnownBits(Value *V, APInt &KnownZero, APInt &KnownOne,
                         unsigned Depth, Instruction *CxtI) const {
     return llvm::computeKnownBits(V, KnownZero, KnownOne, DL, Depth, &AC, CxtI,
-                                  &DT);
+                                  &DT, KnownBits);
   }
 
   bool MaskedValueIsZero(Value *V, const APInt &Mask, unsigned Depth = 0,
                          Instruction *CxtI = nullptr) const {
-    return llvm::MaskedValueIsZero(V, Mask, DL, Depth, &AC, CxtI, &DT);
+    return llvm::MaskedValueIsZero(V, Mask, DL, Depth, &AC, CxtI, &DT,
+                                   KnownBits);
   }
   unsigned ComputeNumSignBits(Value *Op, unsigned Depth = 0,
                               Instruction *CxtI = nullptr) const {
-    return llvm::ComputeNumSignBits(Op, DL, Depth, &AC, CxtI, &DT);
+    return llvm::ComputeNumSignBits(Op, DL, Depth, &AC, CxtI, &DT, KnownBits);
   }
   void ComputeSignBit(Value *V, bool &KnownZero, bool &KnownOne,
                       unsigned Depth = 0, Instruction *CxtI = nullptr) const {
     return llvm::ComputeSignBit(V, KnownZero, KnownOne, DL, Depth, &AC, CxtI,
-                                &DT);
+                                &DT, KnownBits);
   }
   OverflowResult computeOverflowForUnsignedMul(Value *LHS, Value *RHS,
                                                const Instruction *CxtI) {
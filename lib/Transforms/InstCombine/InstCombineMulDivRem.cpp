@@ -72,7 +72,11 @@ static Value *simplifyValueKnownNonZero(Value *V, InstCombiner &IC,
   //    If V is a phi node, we can call this on each of its operands.
   //    "select cond, X, 0" can simplify to "X".
 
-  return MadeChange ? V : nullptr;
+  if (!MadeChange)
+    return nullptr;
+  // I was changed in place, and the caller may keep querying it.
+  IC.forgetKnownBits();
+  return V;
 }
 
 
@@ -925,6 +925,7 @@ Instruction *InstCombiner::visitPHINode(PHINode &PN) {
           if (!NonZeroConst)
             NonZeroConst = GetAnyNonZeroConstInt(PN);
           PN.setIncomingValue(i, NonZeroConst);
+          forgetKnownBits();
         }
       }
     }
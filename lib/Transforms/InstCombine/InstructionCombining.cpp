@@ -82,6 +82,24 @@ static cl::opt<bool>
 EnableExpensiveCombines("expensive-combines",
                         cl::desc("Enable expensive instruction combines"));
 
+static cl::opt<unsigned>
+MaxIterations("instcombine-max-iterations",
+              cl::desc("Limit the maximum number of instruction combining "
+                       "iterations over a function"),
+              cl::init(1000));
+
+static cl::opt<bool>
+SparseIterations("instcombine-sparse-iterations",
+                 cl::desc("Only sweep the whole function once per run and "
+                          "rely on the worklist to revisit changed "
+                          "instructions"),
+                 cl::init(false), cl::Hidden);
+
+static cl::opt<bool>
+CacheKnownBits("instcombine-cache-known-bits",
+               cl::desc("Reuse known bits results until the IR is changed"),
+               cl::init(true), cl::Hidden);
+
 Value *InstCombiner::EmitGEPOffset(User *GEP) {
   return llvm::EmitGEPOffset(Builder, DL, GEP);
 }
@@ -371,7 +389,10 @@ bool InstCombiner::SimplifyAssociativeOrCommutative(BinaryOperator &I) {
       }
     }
 
-    // No further simplifications.
+    // No further simplifications. The operands and flags of I may have
+    // changed in place.
+    if (Changed)
+      forgetKnownBits();
     return Changed;
   } while (1);
 }
@@ -2833,6 +2854,10 @@ bool InstCombiner::run() {
     Instruction *I = Worklist.RemoveOne();
     if (I == nullptr) continue;  // skip null values.
 
+    // The previous visit may have changed the IR in place.
+    if (KnownBits)
+      KnownBits->clear();
+
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I, &TLI)) {
       DEBUG(dbgs() << "IC: DCE: " << *I << '\n');
@@ -3154,24 +3179,41 @@ combineInstructionsOverFunction(Function &F, InstCombineWorklist &Worklist,
   // by instcombiner.
   bool DbgDeclaresChanged = LowerDbgDeclare(F);
 
-  // Iterate while there is work to do.
-  int Iteration = 0;
+  // Iterate while there is work to do, but give up on reaching a fixpoint
+  // once the iteration budget for this function is spent.
+  unsigned Iteration = 0;
+  bool MadeIRChange = false;
   for (;;) {
     ++Iteration;
+    if (Iteration > MaxIterations) {
+      DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION LIMIT #" << MaxIterations
+                   << " REACHED ON " << F.getName() << "\n");
+      break;
+    }
+
     DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION #" << Iteration << " on "
                  << F.getName() << "\n");
 
     bool Changed = prepareICWorklistFromFunction(F, DL, &TLI, Worklist);
 
+    KnownBitsCache KnownBits;
+    KnownBitsCache *Cache = CacheKnownBits ? &KnownBits : nullptr;
+    Worklist.setKnownBitsCache(Cache);
     InstCombiner IC(Worklist, &Builder, F.optForMinSize(), ExpensiveCombines,
-                    AA, AC, TLI, DT, DL, LI);
+                    AA, AC, TLI, DT, DL, LI, Cache);
     Changed |= IC.run();
-
-    if (!Changed)
+    Worklist.setKnownBitsCache(nullptr);
+    MadeIRChange |= Changed;
+
+    // Every instruction a combine touches is pushed back on the worklist, so
+    // after the first sweep the remaining opportunities are the rare ones the
+    // worklist doesn't see. In sparse mode those are left to the next run
+    // instead of paying for another sweep over the whole function.
+    if (!Changed || SparseIterations)
       break;
   }
 
-  return DbgDeclaresChanged || Iteration > 1;
+  return DbgDeclaresChanged || MadeIRChange;
 }
 
 PreservedAnalyses InstCombinePass::run(Function &F,
@@ -25,6 +25,7 @@
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/DataLayout.h"
@@ -246,6 +247,14 @@ static cl::opt<bool> ClOptGlobals("asan-opt-globals",
 static cl::opt<bool> ClOptStack(
     "asan-opt-stack", cl::desc("Don't instrument scalar stack variables"),
     cl::Hidden, cl::init(false));
+static cl::opt<bool> ClOptDominating(
+    "asan-opt-dominating",
+    cl::desc("Don't instrument accesses covered by a dominating check"),
+    cl::Hidden, cl::init(false));
+static cl::opt<unsigned> ClOptDominatingCandidates(
+    "asan-opt-dominating-candidates",
+    cl::desc("Max number of dominating checks examined per access"),
+    cl::Hidden, cl::init(4));
 
 static cl::opt<bool> ClDynamicAllocaStack(
     "asan-stack-dynamic-alloca",
@@ -288,6 +297,8 @@ STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
 STATISTIC(NumOptimizedAccessesToStackVar,
           "Number of optimized accesses to stack vars");
+STATISTIC(NumOptimizedDominatedAccesses,
+          "Number of accesses covered by a dominating check");
 
 namespace {
 /// Frontend-provided metadata for source location.
@@ -539,6 +550,8 @@ struct AddressSanitizer : public FunctionPass {
   bool GlobalIsLinkerInitialized(GlobalVariable *G);
   bool isSafeAccess(ObjectSizeOffsetVisitor &ObjSizeVis, Value *Addr,
                     uint64_t TypeSize) const;
+  void removeDominatedAccesses(Function &F,
+                               SmallVectorImpl<Instruction *> &ToInstrument);
 
   /// Helper to cleanup per-function state.
   struct FunctionStateRAII {
@@ -1960,6 +1973,9 @@ bool AddressSanitizer::runOnFunction(Function &F) {
     }
   }
 
+  if (ClOpt && ClOptDominating)
+    removeDominatedAccesses(F, ToInstrument);
+
   bool UseCalls =
       CompileKernel ||
       (ClInstrumentationWithCallsThreshold >= 0 &&
@@ -2006,6 +2022,140 @@ bool AddressSanitizer::runOnFunction(Function &F) {
   return FunctionModified;
 }
 
+// Returns true if a call may execute after From and before To, where From
+// dominates To. Calls are what may free or poison the memory checked at From;
+// BlocksWithCalls holds the blocks containing one.
+static bool
+mayCallBetween(Instruction *From, Instruction *To,
+               const SmallPtrSetImpl<BasicBlock *> &BlocksWithCalls) {
+  auto HasCall = [](BasicBlock::iterator I, BasicBlock::iterator E) {
+    for (; I != E; ++I)
+      if (CallSite(&*I))
+        return true;
+    return false;
+  };
+  BasicBlock *FromBB = From->getParent();
+  BasicBlock *ToBB = To->getParent();
+  // Within a block, any path that leaves the block re-executes From.
+  if (FromBB == ToBB)
+    return HasCall(std::next(From->getIterator()), To->getIterator());
+
+  if (HasCall(std::next(From->getIterator()), FromBB->end()) ||
+      HasCall(ToBB->begin(), To->getIterator()))
+    return true;
+
+  // The blocks on a path from FromBB to ToBB that does not go through FromBB
+  // again: reachable from FromBB and reaching ToBB.
+  SmallPtrSet<BasicBlock *, 16> Reachable;
+  SmallVector<BasicBlock *, 16> Worklist(succ_begin(FromBB), succ_end(FromBB));
+  while (!Worklist.empty()) {
+    BasicBlock *BB = Worklist.pop_back_val();
+    if (BB == FromBB || !Reachable.insert(BB).second)
+      continue;
+    Worklist.append(succ_begin(BB), succ_end(BB));
+  }
+  SmallPtrSet<BasicBlock *, 16> OnPath;
+  Worklist.append(pred_begin(ToBB), pred_end(ToBB));
+  while (!Worklist.empty()) {
+    BasicBlock *BB = Worklist.pop_back_val();
+    if (BB == FromBB || !Reachable.count(BB) || !OnPath.insert(BB).second)
+      continue;
+    // This includes ToBB itself when a cycle through it avoids FromBB; all
+    // of ToBB then runs before To.
+    if (BlocksWithCalls.count(BB))
+      return true;
+    Worklist.append(pred_begin(BB), pred_end(BB));
+  }
+  return false;
+}
+
+// Remove from ToInstrument the accesses whose whole range was already
+// checked by a dominating access with no call in between. This extends the
+// per-block "instrument the same temp just once" optimization across blocks
+// and to accesses at a constant offset from a wider checked access.
+void AddressSanitizer::removeDominatedAccesses(
+    Function &F, SmallVectorImpl<Instruction *> &ToInstrument) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  SmallPtrSet<BasicBlock *, 16> BlocksWithCalls;
+  for (auto &BB : F)
+    for (auto &I : BB)
+      if (CallSite(&I)) {
+        BlocksWithCalls.insert(&BB);
+        break;
+      }
+
+  struct CheckedRange {
+    Instruction *I;
+    Value *Base;
+    int64_t Begin, End;
+  };
+  SmallVector<CheckedRange, 16> Accesses;
+  for (Instruction *I : ToInstrument) {
+    bool IsWrite;
+    uint64_t TypeSize;
+    unsigned Alignment;
+    Value *Addr =
+        isInterestingMemoryAccess(I, &IsWrite, &TypeSize, &Alignment);
+    if (!Addr || TypeSize % 8 != 0)
+      continue;
+    int64_t Offset = 0;
+    Value *Base = GetPointerBaseWithConstantOffset(Addr, Offset, DL);
+    Accesses.push_back({I, Base, Offset, Offset + (int64_t)(TypeSize / 8)});
+  }
+
+  // Visit the accesses in dominator tree preorder so that the checks that
+  // are kept are seen before the accesses they dominate.
+  DT->updateDFSNumbers();
+  DenseMap<Instruction *, unsigned> Order;
+  for (auto &BB : F) {
+    unsigned N = 0;
+    for (auto &I : BB)
+      Order[&I] = N++;
+  }
+  auto DFSNumIn = [&](Instruction *I) {
+    return DT->getNode(I->getParent())->getDFSNumIn();
+  };
+  std::stable_sort(Accesses.begin(), Accesses.end(),
+                   [&](const CheckedRange &A, const CheckedRange &B) {
+                     if (DFSNumIn(A.I) != DFSNumIn(B.I))
+                       return DFSNumIn(A.I) < DFSNumIn(B.I);
+                     return Order[A.I] < Order[B.I];
+                   });
+
+  DenseMap<Value *, SmallVector<const CheckedRange *, 4>> KeptByBase;
+  SmallPtrSet<Instruction *, 16> Redundant;
+  for (const CheckedRange &A : Accesses) {
+    auto &Kept = KeptByBase[A.Base];
+    unsigned NumExamined = 0;
+    bool Covered = false;
+    for (auto It = Kept.rbegin(), E = Kept.rend();
+         It != E && NumExamined < ClOptDominatingCandidates; ++It) {
+      const CheckedRange *D = *It;
+      if (D->Begin > A.Begin || D->End < A.End)
+        continue;
+      ++NumExamined;
+      if (DT->dominates(D->I, A.I) &&
+          !mayCallBetween(D->I, A.I, BlocksWithCalls)) {
+        Covered = true;
+        break;
+      }
+    }
+    if (Covered)
+      Redundant.insert(A.I);
+    else
+      Kept.push_back(&A);
+  }
+
+  if (Redundant.empty())
+    return;
+  NumOptimizedDominatedAccesses += Redundant.size();
+  ToInstrument.erase(remove_if(ToInstrument,
+                               [&](Instruction *I) {
+                                 return Redundant.count(I);
+                               }),
+                     ToInstrument.end());
+}
+
 // Workaround for bug 11395: we don't want to instrument stack in functions
 // with large assembly blobs (32-bit only), otherwise reg alloc may crash.
 // FIXME: remove once the bug 11395 is fixed.
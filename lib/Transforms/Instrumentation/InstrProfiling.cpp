@@ -14,12 +14,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/InstrProfiling.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/LoopSimplify.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
 
 using namespace llvm;
 
@@ -45,6 +53,38 @@ cl::opt<double> NumCountersPerValueSite(
     // is usually smaller than 2.
     cl::init(1.0));
 
+// Counter updates in loops are a load, an add and a store to a global on
+// every iteration. In multithreaded programs the counters' cache lines then
+// bounce between cores. Promotion keeps the running count in a register and
+// only touches memory on the loop exits.
+cl::opt<bool> DoCounterPromotionOpt(
+    "do-counter-promotion", cl::ZeroOrMore,
+    cl::desc("Promote the counter updates in loops to registers"),
+    cl::init(false));
+cl::opt<unsigned> MaxNumOfPromotionsPerLoop(
+    "max-counter-promotions-per-loop", cl::init(10), cl::ZeroOrMore,
+    cl::desc("Max number of counter promotions per loop to avoid"
+             " increasing register pressure too much"));
+cl::opt<unsigned> MaxNumOfExitsForPromotion(
+    "max-counter-promotion-exits", cl::init(8), cl::ZeroOrMore,
+    cl::desc("Max number of loop exits a promoted counter is flushed on"));
+
+// With sampling, a thread local variable counts the function invocations
+// modulo the sampling period, and the counters are only updated during the
+// first invocations of each period. This bounds the memory traffic on the
+// counters at the cost of precision.
+cl::opt<bool> SampledInstrumentationOpt(
+    "sampled-instrumentation", cl::ZeroOrMore,
+    cl::desc("Only update the profile counters during sampling bursts"),
+    cl::init(false));
+cl::opt<unsigned> SampledInstrPeriod(
+    "sampled-instr-period", cl::init(65536), cl::ZeroOrMore,
+    cl::desc("The number of function invocations in one sampling period"));
+cl::opt<unsigned> SampledInstrBurstDuration(
+    "sampled-instr-burst-duration", cl::init(200), cl::ZeroOrMore,
+    cl::desc("The number of function invocations at the start of each "
+             "sampling period during which the counters are updated"));
+
 class InstrProfilingLegacyPass : public ModulePass {
   InstrProfiling InstrProf;
 
@@ -60,7 +100,9 @@ public:
   bool runOnModule(Module &M) override { return InstrProf.run(M); }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
-    AU.setPreservesCFG();
+    if (!InstrProf.isSamplingEnabled() &&
+        !InstrProf.isCounterPromotionEnabled())
+      AU.setPreservesCFG();
   }
 };
 
@@ -83,6 +125,18 @@ llvm::createInstrProfilingLegacyPass(const InstrProfOptions &Options) {
   return new InstrProfilingLegacyPass(Options);
 }
 
+bool InstrProfiling::isSamplingEnabled() const {
+  if (SampledInstrumentationOpt.getNumOccurrences() > 0)
+    return SampledInstrumentationOpt;
+  return Options.Sampling;
+}
+
+bool InstrProfiling::isCounterPromotionEnabled() const {
+  if (DoCounterPromotionOpt.getNumOccurrences() > 0)
+    return DoCounterPromotionOpt;
+  return Options.DoCounterPromotion;
+}
+
 bool InstrProfiling::isMachO() const {
   return Triple(M->getTargetTriple()).isOSBinFormatMachO();
 }
@@ -141,19 +195,24 @@ bool InstrProfiling::run(Module &M) {
       static_cast<void>(getOrCreateRegionCounters(FirstProfIncInst));
   }
 
-  for (Function &F : M)
+  for (Function &F : M) {
+    SmallVector<InstrProfIncrementInst *, 16> Increments;
     for (BasicBlock &BB : F)
       for (auto I = BB.begin(), E = BB.end(); I != E;) {
         auto Instr = I++;
         InstrProfIncrementInst *Inc = castToIncrementInst(&*Instr);
         if (Inc) {
-          lowerIncrement(Inc);
-          MadeChange = true;
+          Increments.push_back(Inc);
         } else if (auto *Ind = dyn_cast<InstrProfValueProfileInst>(Instr)) {
           lowerValueProfileInst(Ind);
           MadeChange = true;
         }
       }
+    if (!Increments.empty()) {
+      lowerIncrements(F, Increments);
+      MadeChange = true;
+    }
+  }
 
   if (GlobalVariable *CoverageNamesVar =
           M.getNamedGlobal(getCoverageUnusedNamesVarName())) {
@@ -222,16 +281,142 @@ void InstrProfiling::lowerValueProfileInst(InstrProfValueProfileInst *Ind) {
   Ind->eraseFromParent();
 }
 
-void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc) {
+void InstrProfiling::lowerIncrements(
+    Function &F, ArrayRef<InstrProfIncrementInst *> Increments) {
+  Value *Sampled = nullptr;
+  if (isSamplingEnabled() && SampledInstrPeriod > 0)
+    Sampled = emitSamplingCheck(F);
+
+  // Sampled updates are not promoted: the guard is per update and would
+  // have to be carried around the loop. The loops are put in simplified form
+  // first so that their exits are dedicated; promotion itself does not
+  // change the CFG, so the loop info stays valid while the increments are
+  // lowered.
+  std::unique_ptr<DominatorTree> DT;
+  std::unique_ptr<LoopInfo> LI;
+  if (!Sampled && isCounterPromotionEnabled()) {
+    DT = llvm::make_unique<DominatorTree>(F);
+    LI = llvm::make_unique<LoopInfo>(*DT);
+    for (Loop *L : *LI)
+      simplifyLoop(L, DT.get(), LI.get(), nullptr, nullptr, false);
+  }
+
+  DenseMap<Loop *, unsigned> NumPromoted;
+  for (InstrProfIncrementInst *Inc : Increments) {
+    if (LI) {
+      // Flushing on the exits of an inner loop still puts a memory update in
+      // the enclosing loops, so promote out of the outermost loop that can
+      // take it.
+      SmallVector<Loop *, 4> Nest;
+      for (Loop *L = LI->getLoopFor(Inc->getParent()); L;
+           L = L->getParentLoop())
+        Nest.push_back(L);
+      Loop *PromotedOutOf = nullptr;
+      for (Loop *L : reverse(Nest))
+        if (NumPromoted[L] < MaxNumOfPromotionsPerLoop &&
+            promoteIncrement(Inc, L)) {
+          PromotedOutOf = L;
+          break;
+        }
+      if (PromotedOutOf) {
+        ++NumPromoted[PromotedOutOf];
+        continue;
+      }
+    }
+    lowerIncrement(Inc, Sampled);
+  }
+}
+
+void InstrProfiling::lowerIncrement(InstrProfIncrementInst *Inc,
+                                    Value *Sampled) {
   GlobalVariable *Counters = getOrCreateRegionCounters(Inc);
 
-  IRBuilder<> Builder(Inc);
+  Instruction *InsertPt = Inc;
+  if (Sampled) {
+    // Out of every period, the update runs for the burst and is skipped for
+    // the rest.
+    unsigned Period = SampledInstrPeriod;
+    unsigned Burst = std::min<unsigned>(SampledInstrBurstDuration, Period);
+    MDNode *Weights = MDBuilder(M->getContext())
+                          .createBranchWeights(Burst, Period - Burst);
+    InsertPt = SplitBlockAndInsertIfThen(Sampled, Inc, false, Weights);
+  }
+
+  IRBuilder<> Builder(InsertPt);
   uint64_t Index = Inc->getIndex()->getZExtValue();
   Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters, 0, Index);
   Value *Count = Builder.CreateLoad(Addr, "pgocount");
   Count = Builder.CreateAdd(Count, Inc->getStep());
-  Inc->replaceAllUsesWith(Builder.CreateStore(Count, Addr));
+  Builder.CreateStore(Count, Addr);
+  Inc->eraseFromParent();
+}
+
+bool InstrProfiling::promoteIncrement(InstrProfIncrementInst *Inc, Loop *L) {
+  // The running count is flushed in the exit blocks, which therefore must
+  // only be reached from inside the loop and must allow the insertion.
+  if (!L->hasDedicatedExits() || !isa<Constant>(Inc->getStep()))
+    return false;
+  SmallVector<BasicBlock *, 8> ExitBlocks;
+  L->getUniqueExitBlocks(ExitBlocks);
+  if (ExitBlocks.empty() || ExitBlocks.size() > MaxNumOfExitsForPromotion)
+    return false;
+  for (BasicBlock *ExitBB : ExitBlocks)
+    if (ExitBB->getFirstInsertionPt() == ExitBB->end())
+      return false;
+
+  GlobalVariable *Counters = getOrCreateRegionCounters(Inc);
+  uint64_t Index = Inc->getIndex()->getZExtValue();
+  Type *CountTy = Inc->getStep()->getType();
+
+  // The count is zero on entry to the loop and is advanced where the
+  // increment was. The add is created before its input is known because the
+  // input depends on the add itself through the back edges.
+  SmallVector<PHINode *, 8> NewPHIs;
+  SSAUpdater SSA(&NewPHIs);
+  SSA.Initialize(CountTy, "pgocount.promoted");
+  Constant *Zero = ConstantInt::get(CountTy, 0);
+  for (BasicBlock *Pred : predecessors(L->getHeader()))
+    if (!L->contains(Pred))
+      SSA.AddAvailableValue(Pred, Zero);
+  BasicBlock *IncBB = Inc->getParent();
+  Instruction *Add = BinaryOperator::CreateAdd(
+      UndefValue::get(CountTy), Inc->getStep(), "pgocount.promoted", Inc);
+  SSA.AddAvailableValue(IncBB, Add);
+  Add->setOperand(0, SSA.GetValueInMiddleOfBlock(IncBB));
+
+  for (BasicBlock *ExitBB : ExitBlocks) {
+    Value *LiveOut = SSA.GetValueInMiddleOfBlock(ExitBB);
+    IRBuilder<> Builder(&*ExitBB->getFirstInsertionPt());
+    Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters, 0, Index);
+    Value *Count = Builder.CreateLoad(Addr, "pgocount");
+    Count = Builder.CreateAdd(Count, LiveOut);
+    Builder.CreateStore(Count, Addr);
+  }
   Inc->eraseFromParent();
+  return true;
+}
+
+Value *InstrProfiling::emitSamplingCheck(Function &F) {
+  Type *Int32Ty = Type::getInt32Ty(M->getContext());
+  GlobalVariable *SamplingVar =
+      M->getNamedGlobal(getInstrProfSamplingVarName());
+  if (!SamplingVar) {
+    SamplingVar = new GlobalVariable(
+        *M, Int32Ty, false, GlobalValue::LinkOnceODRLinkage,
+        ConstantInt::get(Int32Ty, 0), getInstrProfSamplingVarName(), nullptr,
+        GlobalValue::GeneralDynamicTLSModel);
+    SamplingVar->setVisibility(GlobalValue::HiddenVisibility);
+  }
+
+  IRBuilder<> Builder(&*F.getEntryBlock().getFirstInsertionPt());
+  Value *Cur = Builder.CreateLoad(SamplingVar, "pgo.sampling");
+  Value *Next = Builder.CreateAdd(Cur, Builder.getInt32(1));
+  Value *Wrap =
+      Builder.CreateICmpUGE(Next, Builder.getInt32(SampledInstrPeriod));
+  Builder.CreateStore(Builder.CreateSelect(Wrap, Builder.getInt32(0), Next),
+                      SamplingVar);
+  return Builder.CreateICmpULT(Cur, Builder.getInt32(SampledInstrBurstDuration),
+                               "pgo.sampled");
 }
 
 void InstrProfiling::lowerCoverageData(GlobalVariable *CoverageNamesVar) {
@@ -25,11 +25,11 @@
 //
 // This file contains two passes:
 // (1) Pass PGOInstrumentationGen which instruments the IR to generate edge
-// count profile, and generates the instrumentation for indirect call
-// profiling.
+// count profile, and generates the instrumentation for indirect call and
+// memory intrinsic size profiling.
 // (2) Pass PGOInstrumentationUse which reads the edge count profile and
-// annotates the branch weights. It also reads the indirect call value
-// profiling records and annotate the indirect call instructions.
+// annotates the branch weights. It also reads the indirect call and memory
+// intrinsic size value profiling records and annotate the instructions.
 //
 // To get the precise counter information, These two passes need to invoke at
 // the same compilation point (so they see the same IR). For pass
@@ -94,6 +94,7 @@ STATISTIC(NumOfPGOFunc, "Number of functions having valid profile counts.");
 STATISTIC(NumOfPGOMismatch, "Number of functions having mismatch profile.");
 STATISTIC(NumOfPGOMissing, "Number of functions without profile.");
 STATISTIC(NumOfPGOICall, "Number of indirect call value instrumentations.");
+STATISTIC(NumOfPGOMemOP, "Number of memop size value instrumentations.");
 
 // Command line option to specify the file to read profile from. This is
 // mainly used for testing.
@@ -116,6 +117,13 @@ static cl::opt<unsigned> MaxNumAnnotations(
     cl::desc("Max number of annotations for a single indirect "
              "call callsite"));
 
+// Command line option to set the maximum number of value annotations
+// to write to the metadata for a single memop intrinsic.
+static cl::opt<unsigned> MaxNumMemOPAnnotations(
+    "memop-max-annotations", cl::init(4), cl::Hidden, cl::ZeroOrMore,
+    cl::desc("Max number of value annotations for a single memop "
+             "intrinsic"));
+
 // Command line option to control appending FunctionHash to the name of a COMDAT
 // function. This is to avoid the hash mismatch caused by the preinliner.
 static cl::opt<bool> DoComdatRenaming(
@@ -137,6 +145,15 @@ static cl::opt<bool> NoPGOWarnMismatch("no-pgo-warn-mismatch", cl::init(false),
 // Command line option to enable/disable select instruction instrumentation.
 static cl::opt<bool> PGOInstrSelect("pgo-instr-select", cl::init(true),
                                     cl::Hidden);
+
+// Command line option to enable/disable size profiling of memory intrinsic
+// calls (memcpy, memmove and memset) whose length is not a constant. This
+// must be set identically in the instrumentation and the profile use
+// compilations.
+static cl::opt<bool>
+    PGOInstrMemOP("pgo-instr-memop", cl::init(true), cl::Hidden,
+                  cl::desc("Use this option to turn on/off memory intrinsic "
+                           "size profiling."));
 namespace {
 
 /// The select instruction visitor plays three roles specified
@@ -300,6 +317,19 @@ struct BBInfo {
   }
 };
 
+// Return the memory intrinsic calls in F with a non-constant length. These
+// are the sites that get size value profiling.
+static std::vector<Instruction *> findMemIntrinsicSites(Function &F) {
+  std::vector<Instruction *> Result;
+  if (!PGOInstrMemOP)
+    return Result;
+  for (auto &I : instructions(F))
+    if (auto *MI = dyn_cast<MemIntrinsic>(&I))
+      if (!isa<ConstantInt>(MI->getLength()))
+        Result.push_back(MI);
+  return Result;
+}
+
 // This class implements the CFG edges. Note the CFG can be a multi-graph.
 template <class Edge, class BBInfo> class FuncPGOInstrumentation {
 private:
@@ -311,6 +341,7 @@ private:
 
 public:
   std::vector<Instruction *> IndirectCallSites;
+  std::vector<Instruction *> MemIntrinsicSites;
   SelectInstVisitor SIVisitor;
   std::string FuncName;
   GlobalVariable *FuncNameVar;
@@ -345,6 +376,7 @@ public:
     SIVisitor.countSelects(Func);
     NumOfPGOSelectInsts += SIVisitor.getNumOfSelectInsts();
     IndirectCallSites = findIndirectCallSites(Func);
+    MemIntrinsicSites = findMemIntrinsicSites(Func);
 
     FuncName = getPGOFuncName(F);
     computeCFGHash();
@@ -569,6 +601,22 @@ static void instrumentOneFunc(
          Builder.getInt32(NumIndirectCallSites++)});
   }
   NumOfPGOICall += NumIndirectCallSites;
+
+  unsigned NumMemIntrinsicSites = 0;
+  for (auto &I : FuncInfo.MemIntrinsicSites) {
+    MemIntrinsic *MI = cast<MemIntrinsic>(I);
+    DEBUG(dbgs() << "Instrument one memop size: Site Index = "
+                 << NumMemIntrinsicSites << "\n");
+    IRBuilder<> Builder(MI);
+    Builder.CreateCall(
+        Intrinsic::getDeclaration(M, Intrinsic::instrprof_value_profile),
+        {llvm::ConstantExpr::getBitCast(FuncInfo.FuncNameVar, I8PtrTy),
+         Builder.getInt64(FuncInfo.FunctionHash),
+         Builder.CreateZExtOrTrunc(MI->getLength(), Builder.getInt64Ty()),
+         Builder.getInt32(llvm::InstrProfValueKind::IPVK_MemOPSize),
+         Builder.getInt32(NumMemIntrinsicSites++)});
+  }
+  NumOfPGOMemOP += NumMemIntrinsicSites;
 }
 
 // This class represents a CFG edge in profile use compilation.
@@ -656,6 +704,9 @@ public:
   // Annotate the indirect call sites.
   void annotateIndirectCallSites();
 
+  // Annotate the memory intrinsic sites with their size profile.
+  void annotateMemIntrinsicSites();
+
   // The hotness of the function from the profile count.
   enum FuncFreqAttr { FFA_Normal, FFA_Cold, FFA_Hot };
 
@@ -1026,6 +1077,38 @@ void PGOUseFunc::annotateIndirectCallSites() {
     IndirectCallSiteIndex++;
   }
 }
+
+// Traverse all the memory intrinsic sites and annotate their size profile.
+void PGOUseFunc::annotateMemIntrinsicSites() {
+  if (DisableValueProfiling)
+    return;
+
+  auto &MemIntrinsicSites = FuncInfo.MemIntrinsicSites;
+  unsigned NumValueSites = ProfileRecord.getNumValueSites(IPVK_MemOPSize);
+  // Profiles collected without memop size profiling have no sites of this
+  // kind; there is nothing to annotate.
+  if (NumValueSites == 0)
+    return;
+  if (NumValueSites != MemIntrinsicSites.size()) {
+    std::string Msg =
+        std::string("Inconsistent number of memop size sites: ") +
+        F.getName().str();
+    auto &Ctx = M->getContext();
+    Ctx.diagnose(
+        DiagnosticInfoPGOProfile(M->getName().data(), Msg, DS_Warning));
+    return;
+  }
+
+  unsigned MemIntrinsicSiteIndex = 0;
+  for (auto &I : MemIntrinsicSites) {
+    DEBUG(dbgs() << "Read one memop size instrumentation: Index="
+                 << MemIntrinsicSiteIndex << " out of " << NumValueSites
+                 << "\n");
+    annotateValueSite(*M, *I, ProfileRecord, IPVK_MemOPSize,
+                      MemIntrinsicSiteIndex, MaxNumMemOPAnnotations);
+    MemIntrinsicSiteIndex++;
+  }
+}
 } // end anonymous namespace
 
 // Create a COMDAT variable INSTR_PROF_RAW_VERSION_VAR to make the runtime
@@ -1157,6 +1240,7 @@ static bool annotateAllFunctions(
     Func.populateCounters();
     Func.setBranchWeights();
     Func.annotateIndirectCallSites();
+    Func.annotateMemIntrinsicSites();
     PGOUseFunc::FuncFreqAttr FreqAttr = Func.getFuncFreqAttr();
     if (FreqAttr == PGOUseFunc::FFA_Cold)
       ColdFunctions.push_back(&F);
@@ -0,0 +1,296 @@
+//===-- PGOMemOPSizeOpt.cpp - Optimizations based on value profiling ===//
+//
+//                      The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the transformation that optimizes memory intrinsics
+// such as memcpy using the size value profile. When memory intrinsic size
+// value profile metadata is available, a single memory intrinsic is expanded
+// to a sequence of guarded specialized versions that are called with the
+// hottest size(s), for later expansion into more optimal inline sequences.
+//
+// For example, a call
+//   call void @llvm.memcpy(i8* %dst, i8* %src, i64 %len, ...), !prof !0
+// whose profile says %len is almost always 8 becomes
+//   switch i64 %len, label %default [ i64 8, label %case.8 ]
+//   case.8:  call void @llvm.memcpy(i8* %dst, i8* %src, i64 8, ...)
+//   default: call void @llvm.memcpy(i8* %dst, i8* %src, i64 %len, ...)
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Pass.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/PassSupport.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Transforms/Instrumentation.h"
+#include "llvm/Transforms/PGOInstrumentation.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "pgo-memop-opt"
+
+STATISTIC(NumOfPGOMemOPOpt, "Number of memop intrinsics optimized.");
+STATISTIC(NumOfPGOMemOPAnnotate, "Number of memop intrinsics annotated.");
+
+// The minimum call count to optimize memory intrinsic calls.
+static cl::opt<unsigned>
+    MemOPCountThreshold("pgo-memop-count-threshold", cl::Hidden, cl::ZeroOrMore,
+                        cl::init(1000),
+                        cl::desc("The minimum count to optimize memory "
+                                 "intrinsic calls"));
+
+// Command line option to disable memory intrinsic optimization. The default is
+// false. This is for debug purpose.
+static cl::opt<bool> DisableMemOPOPT("disable-memop-opt", cl::init(false),
+                                     cl::Hidden, cl::desc("Disable optimize"));
+
+// The percent threshold to optimize memory intrinsic calls.
+static cl::opt<unsigned>
+    MemOPPercentThreshold("pgo-memop-percent-threshold", cl::init(40),
+                          cl::Hidden, cl::ZeroOrMore,
+                          cl::desc("The percentage threshold for the "
+                                   "memory intrinsic calls optimization"));
+
+// Maximum number of versions for optimizing memory intrinsic call.
+static cl::opt<unsigned>
+    MemOPMaxVersion("pgo-memop-max-version", cl::init(3), cl::Hidden,
+                    cl::ZeroOrMore,
+                    cl::desc("The max version for the optimized memory "
+                             " intrinsic calls"));
+
+// Sizes larger than this are not worth specializing: the backend lowers them
+// to a library call anyway.
+static cl::opt<unsigned>
+    MemOPMaxSize("pgo-memop-max-size", cl::init(128), cl::Hidden,
+                 cl::ZeroOrMore,
+                 cl::desc("The largest size a memory intrinsic call is "
+                          "specialized for"));
+
+namespace {
+class PGOMemOPSizeOptLegacyPass : public FunctionPass {
+public:
+  static char ID;
+
+  PGOMemOPSizeOptLegacyPass() : FunctionPass(ID) {
+    initializePGOMemOPSizeOptLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  StringRef getPassName() const override { return "PGOMemOPSize"; }
+
+private:
+  bool runOnFunction(Function &F) override;
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addPreserved<GlobalsAAWrapperPass>();
+  }
+};
+} // end anonymous namespace
+
+char PGOMemOPSizeOptLegacyPass::ID = 0;
+INITIALIZE_PASS(PGOMemOPSizeOptLegacyPass, "pgo-memop-opt",
+                "Optimize memory intrinsic using its size value profile",
+                false, false)
+
+FunctionPass *llvm::createPGOMemOPSizeOptLegacyPass() {
+  return new PGOMemOPSizeOptLegacyPass();
+}
+
+namespace {
+// The class that versions one function's memory intrinsics on their hot
+// profiled sizes.
+class MemOPSizeOpt {
+public:
+  MemOPSizeOpt(Function &Func) : Func(Func) {
+    ValueDataArray =
+        llvm::make_unique<InstrProfValueData[]>(MemOPMaxVersion + 2);
+  }
+
+  bool perform() {
+    std::vector<MemIntrinsic *> WorkList;
+    for (auto &I : instructions(Func))
+      if (auto *MI = dyn_cast<MemIntrinsic>(&I))
+        if (!isa<ConstantInt>(MI->getLength()))
+          WorkList.push_back(MI);
+
+    bool Changed = false;
+    for (auto *MI : WorkList)
+      Changed |= perform(*MI);
+    return Changed;
+  }
+
+private:
+  Function &Func;
+  std::unique_ptr<InstrProfValueData[]> ValueDataArray;
+
+  bool perform(MemIntrinsic &MI);
+};
+
+// Scale the counts so that they fit in 32 bits for the branch weights.
+static uint64_t getScaleFactor(uint64_t MaxCount) {
+  if (MaxCount < UINT32_MAX)
+    return 1;
+  return MaxCount / UINT32_MAX + 1;
+}
+
+bool MemOPSizeOpt::perform(MemIntrinsic &MI) {
+  uint32_t NumVals, MaxNumPromotions = MemOPMaxVersion + 2;
+  uint64_t TotalCount;
+  if (!getValueProfDataFromInst(MI, IPVK_MemOPSize, MaxNumPromotions,
+                                ValueDataArray.get(), NumVals, TotalCount))
+    return false;
+  NumOfPGOMemOPAnnotate++;
+
+  if (TotalCount < MemOPCountThreshold)
+    return false;
+  ArrayRef<InstrProfValueData> VDs(ValueDataArray.get(), NumVals);
+  DEBUG(dbgs() << "Read one memory intrinsic profile with count " << TotalCount
+               << "\n");
+  DEBUG(for (auto &VD : VDs) dbgs() << "  (" << VD.Value << "," << VD.Count
+                                    << ")\n";);
+
+  // The value data is sorted by count. Take the hot sizes while they
+  // individually account for a large enough fraction of what is left.
+  IntegerType *LenTy = cast<IntegerType>(MI.getLength()->getType());
+  uint64_t RemainingCount = TotalCount;
+  uint64_t MaxCount = 0;
+  SmallVector<uint64_t, 4> SizeIds;
+  SmallVector<uint64_t, 4> CaseCounts;
+  SmallVector<InstrProfValueData, 4> RemainingVDs;
+  bool Done = false;
+  for (auto &VD : VDs) {
+    uint64_t C = VD.Count;
+    uint64_t V = VD.Value;
+    if (Done || SizeIds.size() == MemOPMaxVersion ||
+        C < MemOPCountThreshold ||
+        C * 100 < (uint64_t)MemOPPercentThreshold * RemainingCount) {
+      Done = true;
+      RemainingVDs.push_back(VD);
+      continue;
+    }
+    // A size that does not fit the length type or is too large to be worth
+    // inlining stays with the original call.
+    if (V > MemOPMaxSize || !isUIntN(LenTy->getBitWidth(), V)) {
+      RemainingVDs.push_back(VD);
+      continue;
+    }
+    SizeIds.push_back(V);
+    CaseCounts.push_back(C);
+    RemainingCount -= std::min(C, RemainingCount);
+    MaxCount = std::max(MaxCount, C);
+  }
+  if (SizeIds.empty())
+    return false;
+
+  DEBUG(dbgs() << "Optimize one memory intrinsic call to " << SizeIds.size()
+               << " sizes\n");
+
+  //   BB: ...
+  //       switch i64 %len, label %DefaultBB [ i64 N, label %CaseBB ... ]
+  //   CaseBB:    the memory intrinsic with length N; br label %MergeBB
+  //   DefaultBB: the original memory intrinsic;      br label %MergeBB
+  //   MergeBB:   the rest of BB
+  BasicBlock *BB = MI.getParent();
+  BasicBlock *DefaultBB = SplitBlock(BB, &MI);
+  BasicBlock::iterator It(&MI);
+  ++It;
+  BasicBlock *MergeBB = SplitBlock(DefaultBB, &*It);
+  DefaultBB->setName("MemOP.Default");
+  MergeBB->setName("MemOP.Merge");
+
+  LLVMContext &Ctx = Func.getContext();
+  BB->getTerminator()->eraseFromParent();
+  IRBuilder<> IRB(BB);
+  SwitchInst *SI = IRB.CreateSwitch(MI.getLength(), DefaultBB, SizeIds.size());
+
+  MaxCount = std::max(MaxCount, RemainingCount);
+  uint64_t Scale = getScaleFactor(MaxCount);
+  SmallVector<uint32_t, 4> Weights;
+  Weights.push_back(RemainingCount / Scale);
+
+  // The versions must not be annotated again; the original keeps only the
+  // sizes that were not versioned.
+  MI.setMetadata(LLVMContext::MD_prof, nullptr);
+  for (unsigned I = 0, E = SizeIds.size(); I != E; ++I) {
+    ConstantInt *CaseSizeId = ConstantInt::get(LenTy, SizeIds[I]);
+    BasicBlock *CaseBB = BasicBlock::Create(
+        Ctx, Twine("MemOP.Case.") + Twine(SizeIds[I]), &Func, DefaultBB);
+    auto *NewMI = cast<MemIntrinsic>(MI.clone());
+    NewMI->setLength(CaseSizeId);
+    CaseBB->getInstList().push_back(NewMI);
+    IRBuilder<> IRBCase(CaseBB);
+    IRBCase.CreateBr(MergeBB);
+    SI->addCase(CaseSizeId, CaseBB);
+    Weights.push_back(CaseCounts[I] / Scale);
+    DEBUG(dbgs() << *CaseBB << "\n");
+  }
+  SI->setMetadata(LLVMContext::MD_prof,
+                  MDBuilder(Ctx).createBranchWeights(Weights));
+
+  if (RemainingCount != 0 && !RemainingVDs.empty())
+    annotateValueSite(*Func.getParent(), MI, RemainingVDs, RemainingCount,
+                      IPVK_MemOPSize, RemainingVDs.size());
+
+  DEBUG(dbgs() << *BB << "\n");
+  DEBUG(dbgs() << *DefaultBB << "\n");
+  DEBUG(dbgs() << *MergeBB << "\n");
+  NumOfPGOMemOPOpt++;
+  return true;
+}
+} // end anonymous namespace
+
+static bool optimizeMemOPSizes(Function &F) {
+  if (DisableMemOPOPT)
+    return false;
+
+  if (F.hasFnAttribute(Attribute::OptimizeForSize))
+    return false;
+  MemOPSizeOpt MemOPSizeOpt(F);
+  return MemOPSizeOpt.perform();
+}
+
+bool PGOMemOPSizeOptLegacyPass::runOnFunction(Function &F) {
+  if (skipFunction(F))
+    return false;
+  return optimizeMemOPSizes(F);
+}
+
+namespace llvm {
+PreservedAnalyses PGOMemOPSizeOpt::run(Function &F,
+                                       FunctionAnalysisManager &FAM) {
+  bool Changed = optimizeMemOPSizes(F);
+  if (!Changed)
+    return PreservedAnalyses::all();
+  auto PA = PreservedAnalyses();
+  PA.preserve<GlobalsAA>();
+  return PA;
+}
+} // namespace llvm
@@ -68,6 +68,11 @@ STATISTIC(NumPRELoad,   "Number of loads PRE'd");
 static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
+static cl::opt<bool>
+    EnableMemorySSALoads("gvn-memssa-loads", cl::init(false), cl::Hidden,
+                         cl::desc("Use MemorySSA to find dominating values "
+                                  "for non-local loads before querying "
+                                  "MemoryDependenceAnalysis"));
 
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
@@ -1593,6 +1598,11 @@ bool GVN::processNonLocalLoad(LoadInst *LI) {
   if (LI->getParent()->getParent()->hasFnAttribute(Attribute::SanitizeAddress))
     return false;
 
+  // A single dominating clobber that provides the value makes the load fully
+  // redundant without having to collect every non-local dependency.
+  if (MSSA && processLoadWithMemorySSA(LI))
+    return true;
+
   // Step 1: Find the non-local dependencies of the load.
   LoadDepVect Deps;
   MD->getNonLocalPointerDependency(LI, Deps);
@@ -1755,6 +1765,37 @@ static void patchAndReplaceAllUsesWith(Instruction *I, Value *Repl) {
   I->replaceAllUsesWith(Repl);
 }
 
+/// Attempt to eliminate a non-local load whose nearest clobber according to
+/// MemorySSA is a single dominating definition that provides its value.
+bool GVN::processLoadWithMemorySSA(LoadInst *LI) {
+  MemoryAccess *MA = MSSA->getMemoryAccess(LI);
+  // Loads inserted by load PRE have no memory access.
+  if (!MA)
+    return false;
+
+  MemoryAccess *Clobber = MSSA->getWalker()->getClobberingMemoryAccess(LI);
+  if (MSSA->isLiveOnEntryDef(Clobber) || !isa<MemoryDef>(Clobber))
+    return false;
+
+  // MemorySSA only tells us the definition may alias the load, so treat it as
+  // a clobber and let the usual analysis decide whether the value can be
+  // extracted from it.
+  Instruction *DepInst = cast<MemoryDef>(Clobber)->getMemoryInst();
+  AvailableValue AV;
+  if (!AnalyzeLoadAvailability(LI, MemDepResult::getClobber(DepInst),
+                               LI->getPointerOperand(), AV))
+    return false;
+
+  DEBUG(dbgs() << "GVN REMOVING NONLOCAL LOAD (MemorySSA): " << *LI << '\n');
+  Value *V = AV.MaterializeAdjustedValue(LI, LI, *this);
+  patchAndReplaceAllUsesWith(LI, V);
+  if (V->getType()->getScalarType()->isPointerTy())
+    MD->invalidateCachedPointerInfo(V);
+  markInstructionForDeletion(LI);
+  ++NumGVNLoad;
+  return true;
+}
+
 /// Attempt to eliminate a load, first by eliminating it
 /// locally, and then attempting non-local elimination if that fails.
 bool GVN::processLoad(LoadInst *L) {
@@ -2198,6 +2239,9 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
     Changed |= removedBlock;
   }
 
+  if (EnableMemorySSALoads && MD)
+    MSSA = make_unique<MemorySSA>(F, &RunAA, DT);
+
   unsigned Iteration = 0;
   while (ShouldContinue) {
     DEBUG(dbgs() << "GVN iteration: " << Iteration << "\n");
@@ -2226,6 +2270,7 @@ bool GVN::runImpl(Function &F, AssumptionCache &RunAC, DominatorTree &RunDT,
   // Do not cleanup DeadBlocks in cleanupGlobalSets() as it's called for each
   // iteration.
   DeadBlocks.clear();
+  MSSA.reset();
 
   return Changed;
 }
@@ -2265,6 +2310,7 @@ bool GVN::processBlock(BasicBlock *BB) {
          E = InstrsToErase.end(); I != E; ++I) {
       DEBUG(dbgs() << "GVN removed: " << **I << '\n');
       if (MD) MD->removeInstruction(*I);
+      removeFromMemorySSA(*I);
       DEBUG(verifyRemoved(*I));
       (*I)->eraseFromParent();
     }
@@ -2486,6 +2532,7 @@ BasicBlock *GVN::splitCriticalEdges(BasicBlock *Pred, BasicBlock *Succ) {
       SplitCriticalEdge(Pred, Succ, CriticalEdgeSplittingOptions(DT));
   if (MD)
     MD->invalidateCachedPredecessors();
+  MSSA.reset();
   return BB;
 }
 
@@ -2500,6 +2547,7 @@ bool GVN::splitCriticalEdges() {
                       CriticalEdgeSplittingOptions(DT));
   } while (!toSplit.empty());
   if (MD) MD->invalidateCachedPredecessors();
+  MSSA.reset();
   return true;
 }
 
@@ -2663,6 +2711,13 @@ bool GVN::processFoldableCondBr(BranchInst *BI) {
   return true;
 }
 
+void GVN::removeFromMemorySSA(Instruction *I) {
+  if (!MSSA)
+    return;
+  if (MemoryAccess *MA = MSSA->getMemoryAccess(I))
+    MSSA->removeMemoryAccess(MA);
+}
+
 // performPRE() will trigger assert if it comes across an instruction without
 // associated val-num. As it normally has far more live instructions than dead
 // instructions, it makes more sense just to "fabricate" a val-number for the
@@ -160,6 +160,22 @@ PreservedAnalyses JumpThreadingPass::run(Function &F,
   return PA;
 }
 
+/// Mark the blocks around a change for the next sweep of runImpl.
+/// \p Neighborhood holds the changed block followed by its predecessors and
+/// successors from before the change. Threading rewires those and creates
+/// blocks between them, so mark the ones that still exist together with their
+/// current successors, and the current predecessors of the changed block.
+static void markNeighborhoodDirty(ArrayRef<WeakVH> Neighborhood,
+                                  SmallPtrSetImpl<BasicBlock *> &Dirty) {
+  if (auto *BB = cast_or_null<BasicBlock>(Neighborhood.front()))
+    Dirty.insert(pred_begin(BB), pred_end(BB));
+  for (Value *V : Neighborhood)
+    if (auto *N = cast_or_null<BasicBlock>(V)) {
+      Dirty.insert(N);
+      Dirty.insert(succ_begin(N), succ_end(N));
+    }
+}
+
 bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
                                 LazyValueInfo *LVI_, bool HasProfileData_,
                                 std::unique_ptr<BlockFrequencyInfo> BFI_,
@@ -190,14 +206,35 @@ bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
 
   FindLoopHeaders(F);
 
+  // After the first sweep, only revisit the blocks near a change. Once a sweep
+  // changes nothing, a full sweep confirms the fixed point, since LVI may now
+  // know more about blocks further away. The set may hold pointers to deleted
+  // blocks; they are never dereferenced.
+  SmallPtrSet<BasicBlock *, 32> Dirty;
+  bool FullSweep = true;
   bool Changed;
   do {
+    if (FullSweep)
+      for (BasicBlock &BB : F)
+        Dirty.insert(&BB);
     Changed = false;
     for (Function::iterator I = F.begin(), E = F.end(); I != E;) {
       BasicBlock *BB = &*I;
+      if (!Dirty.erase(BB)) {
+        ++I;
+        continue;
+      }
+
+      SmallVector<WeakVH, 8> Neighborhood(1, BB);
+      for (BasicBlock *Pred : predecessors(BB))
+        Neighborhood.push_back(Pred);
+      for (BasicBlock *Succ : successors(BB))
+        Neighborhood.push_back(Succ);
+
       // Thread all of the branches we can over this block.
+      bool BBChanged = false;
       while (ProcessBlock(BB))
-        Changed = true;
+        BBChanged = true;
 
       ++I;
 
@@ -211,6 +248,7 @@ bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
         LVI->eraseBlock(BB);
         DeleteDeadBlock(BB);
         Changed = true;
+        markNeighborhoodDirty(Neighborhood, Dirty);
         continue;
       }
 
@@ -238,7 +276,7 @@ bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
         // dangling pointer issues within LazyValueInfo.
         LVI->eraseBlock(BB);
         if (TryToSimplifyUncondBranchFromEmptyBlock(BB)) {
-          Changed = true;
+          BBChanged = true;
           // If we deleted BB and BB was the header of a loop, then the
           // successor is now the header of the loop.
           BB = Succ;
@@ -247,8 +285,20 @@ bool JumpThreadingPass::runImpl(Function &F, TargetLibraryInfo *TLI_,
         if (ErasedFromLoopHeaders)
           LoopHeaders.insert(BB);
       }
+
+      if (BBChanged) {
+        Changed = true;
+        markNeighborhoodDirty(Neighborhood, Dirty);
+      }
     }
     EverChanged |= Changed;
+
+    if (!Changed && !FullSweep) {
+      Dirty.clear();
+      FullSweep = Changed = true;
+    } else {
+      FullSweep = false;
+    }
   } while (Changed);
 
   LoopHeaders.clear();
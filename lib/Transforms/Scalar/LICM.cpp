@@ -63,6 +63,7 @@
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Local.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 #include "llvm/Transforms/Utils/SSAUpdater.h"
 #include <algorithm>
 #include <utility>
@@ -80,14 +81,19 @@ static cl::opt<bool>
     DisablePromotion("disable-licm-promotion", cl::Hidden,
                      cl::desc("Disable memory promotion in LICM pass"));
 
+static cl::opt<bool> EnableMemorySSALoads(
+    "licm-memssa-loads", cl::init(false), cl::Hidden,
+    cl::desc("Use MemorySSA to hoist and sink loads whose alias set is "
+             "modified in the loop"));
+
 static bool inSubLoop(BasicBlock *BB, Loop *CurLoop, LoopInfo *LI);
 static bool isNotUsedInLoop(const Instruction &I, const Loop *CurLoop,
                             const LoopSafetyInfo *SafetyInfo);
 static bool hoist(Instruction &I, const DominatorTree *DT, const Loop *CurLoop,
-                  const LoopSafetyInfo *SafetyInfo);
+                  const LoopSafetyInfo *SafetyInfo, MemorySSA *MSSA);
 static bool sink(Instruction &I, const LoopInfo *LI, const DominatorTree *DT,
                  const Loop *CurLoop, AliasSetTracker *CurAST,
-                 const LoopSafetyInfo *SafetyInfo);
+                 const LoopSafetyInfo *SafetyInfo, MemorySSA *MSSA);
 static bool isSafeToExecuteUnconditionally(const Instruction &Inst,
                                            const DominatorTree *DT,
                                            const Loop *CurLoop,
@@ -96,6 +102,13 @@ static bool isSafeToExecuteUnconditionally(const Instruction &Inst,
 static bool pointerInvalidatedByLoop(Value *V, uint64_t Size,
                                      const AAMDNodes &AAInfo,
                                      AliasSetTracker *CurAST);
+static bool loadInvalidatedByLoop(LoadInst *LI, Loop *CurLoop,
+                                  MemorySSA *MSSA);
+static MemoryAccess *getHoistedDefiningAccess(Instruction &I,
+                                              const Loop *CurLoop,
+                                              MemorySSA *MSSA);
+static void eraseInstruction(Instruction &I, AliasSetTracker *CurAST,
+                             MemorySSA *MSSA);
 static Instruction *
 CloneInstructionInExitBlock(Instruction &I, BasicBlock &ExitBlock, PHINode &PN,
                             const LoopInfo *LI,
@@ -103,20 +116,27 @@ CloneInstructionInExitBlock(Instruction &I, BasicBlock &ExitBlock, PHINode &PN,
 static bool canSinkOrHoistInst(Instruction &I, AliasAnalysis *AA,
                                DominatorTree *DT,
                                Loop *CurLoop, AliasSetTracker *CurAST,
-                               LoopSafetyInfo *SafetyInfo);
+                               LoopSafetyInfo *SafetyInfo, MemorySSA *MSSA);
 
 namespace {
 struct LoopInvariantCodeMotion {
   bool runOnLoop(Loop *L, AliasAnalysis *AA, LoopInfo *LI, DominatorTree *DT,
-                 TargetLibraryInfo *TLI, ScalarEvolution *SE, bool DeleteAST);
+                 TargetLibraryInfo *TLI, ScalarEvolution *SE, bool DeleteAST,
+                 bool KeepMSSA);
 
   DenseMap<Loop *, AliasSetTracker *> &getLoopToAliasSetMap() {
     return LoopToAliasSetMap;
   }
 
+  /// Drop the MemorySSA kept from the previous loops of the function.
+  void forgetMemorySSA() { MSSA.reset(); }
+
 private:
   DenseMap<Loop *, AliasSetTracker *> LoopToAliasSetMap;
 
+  /// MemorySSA of the function, shared by its loops (-licm-memssa-loads).
+  std::unique_ptr<MemorySSA> MSSA;
+
   AliasSetTracker *collectAliasInfoForLoop(Loop *L, LoopInfo *LI,
                                            AliasAnalysis *AA);
 };
@@ -132,12 +152,15 @@ struct LegacyLICMPass : public LoopPass {
       return false;
 
     auto *SE = getAnalysisIfAvailable<ScalarEvolutionWrapperPass>();
+    // Other loop passes do not update MemorySSA, so it can only be kept for
+    // the next loop when LICM runs alone in its pass manager.
     return LICM.runOnLoop(L,
                           &getAnalysis<AAResultsWrapperPass>().getAAResults(),
                           &getAnalysis<LoopInfoWrapperPass>().getLoopInfo(),
                           &getAnalysis<DominatorTreeWrapperPass>().getDomTree(),
                           &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(),
-                          SE ? &SE->getSE() : nullptr, false);
+                          SE ? &SE->getSE() : nullptr, false,
+                          LPM.getNumContainedPasses() == 1);
   }
 
   /// This transformation requires natural loop information & requires that
@@ -154,6 +177,7 @@ struct LegacyLICMPass : public LoopPass {
   bool doFinalization() override {
     assert(LICM.getLoopToAliasSetMap().empty() &&
            "Didn't free loop alias sets");
+    LICM.forgetMemorySSA();
     return false;
   }
 
@@ -174,20 +198,12 @@ private:
 }
 
 PreservedAnalyses LICMPass::run(Loop &L, LoopAnalysisManager &AM) {
-  const auto &FAM =
-      AM.getResult<FunctionAnalysisManagerLoopProxy>(L).getManager();
-  Function *F = L.getHeader()->getParent();
-
-  auto *AA = FAM.getCachedResult<AAManager>(*F);
-  auto *LI = FAM.getCachedResult<LoopAnalysis>(*F);
-  auto *DT = FAM.getCachedResult<DominatorTreeAnalysis>(*F);
-  auto *TLI = FAM.getCachedResult<TargetLibraryAnalysis>(*F);
-  auto *SE = FAM.getCachedResult<ScalarEvolutionAnalysis>(*F);
-  assert((AA && LI && DT && TLI && SE) && "Analyses for LICM not available");
+  LoopStandardAnalysisResults AR = getLoopStandardAnalysisResults(L, AM);
 
   LoopInvariantCodeMotion LICM;
 
-  if (!LICM.runOnLoop(&L, AA, LI, DT, TLI, SE, true))
+  if (!LICM.runOnLoop(&L, &AR.AA, &AR.LI, &AR.DT, &AR.TLI, &AR.SE, true,
+                      false))
     return PreservedAnalyses::all();
 
   // FIXME: There is no setPreservesCFG in the new PM. When that becomes
@@ -214,7 +230,8 @@ Pass *llvm::createLICMPass() { return new LegacyLICMPass(); }
 bool LoopInvariantCodeMotion::runOnLoop(Loop *L, AliasAnalysis *AA,
                                         LoopInfo *LI, DominatorTree *DT,
                                         TargetLibraryInfo *TLI,
-                                        ScalarEvolution *SE, bool DeleteAST) {
+                                        ScalarEvolution *SE, bool DeleteAST,
+                                        bool KeepMSSA) {
   bool Changed = false;
 
   assert(L->isLCSSAForm(*DT) && "Loop is not in LCSSA form.");
@@ -228,6 +245,12 @@ bool LoopInvariantCodeMotion::runOnLoop(Loop *L, AliasAnalysis *AA,
   LoopSafetyInfo SafetyInfo;
   computeLoopSafetyInfo(&SafetyInfo, L);
 
+  // MemorySSA describes the whole function. It is kept up to date while
+  // hoisting and sinking, so the next loop of the function can reuse it if
+  // nothing else changes the function in between, but not through promotion.
+  if (EnableMemorySSALoads && !MSSA)
+    MSSA = make_unique<MemorySSA>(*L->getHeader()->getParent(), AA, DT);
+
   // We want to visit all of the instructions in this loop... that are not parts
   // of our subloops (they have already had their invariants hoisted out of
   // their loop, into this loop, so there is no need to process the BODIES of
@@ -240,13 +263,14 @@ bool LoopInvariantCodeMotion::runOnLoop(Loop *L, AliasAnalysis *AA,
   //
   if (L->hasDedicatedExits())
     Changed |= sinkRegion(DT->getNode(L->getHeader()), AA, LI, DT, TLI, L,
-                          CurAST, &SafetyInfo);
+                          CurAST, &SafetyInfo, MSSA.get());
   if (Preheader)
     Changed |= hoistRegion(DT->getNode(L->getHeader()), AA, LI, DT, TLI, L,
-                           CurAST, &SafetyInfo);
+                           CurAST, &SafetyInfo, MSSA.get());
 
   // Now that all loop invariants have been removed from the loop, promote any
   // memory references to scalars that we can.
+  bool Promoted = false;
   if (!DisablePromotion && (Preheader || L->hasDedicatedExits())) {
     SmallVector<BasicBlock *, 8> ExitBlocks;
     SmallVector<Instruction *, 8> InsertPts;
@@ -254,8 +278,9 @@ bool LoopInvariantCodeMotion::runOnLoop(Loop *L, AliasAnalysis *AA,
 
     // Loop over all of the alias sets in the tracker object.
     for (AliasSet &AS : *CurAST)
-      Changed |= promoteLoopAccessesToScalars(
+      Promoted |= promoteLoopAccessesToScalars(
           AS, ExitBlocks, InsertPts, PIC, LI, DT, TLI, L, CurAST, &SafetyInfo);
+    Changed |= Promoted;
 
     // Once we have promoted values across the loop body we have to recursively
     // reform LCSSA as any nested loop may now have values defined within the
@@ -282,6 +307,9 @@ bool LoopInvariantCodeMotion::runOnLoop(Loop *L, AliasAnalysis *AA,
   else
     delete CurAST;
 
+  if (!KeepMSSA || Promoted)
+    MSSA.reset();
+
   if (Changed && SE)
     SE->forgetLoopDispositions(L);
   return Changed;
@@ -294,7 +322,8 @@ bool LoopInvariantCodeMotion::runOnLoop(Loop *L, AliasAnalysis *AA,
 ///
 bool llvm::sinkRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
                       DominatorTree *DT, TargetLibraryInfo *TLI, Loop *CurLoop,
-                      AliasSetTracker *CurAST, LoopSafetyInfo *SafetyInfo) {
+                      AliasSetTracker *CurAST, LoopSafetyInfo *SafetyInfo,
+                      MemorySSA *MSSA) {
 
   // Verify inputs.
   assert(N != nullptr && AA != nullptr && LI != nullptr && DT != nullptr &&
@@ -310,7 +339,8 @@ bool llvm::sinkRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
   bool Changed = false;
   const std::vector<DomTreeNode *> &Children = N->getChildren();
   for (DomTreeNode *Child : Children)
-    Changed |= sinkRegion(Child, AA, LI, DT, TLI, CurLoop, CurAST, SafetyInfo);
+    Changed |= sinkRegion(Child, AA, LI, DT, TLI, CurLoop, CurAST, SafetyInfo,
+                          MSSA);
 
   // Only need to process the contents of this block if it is not part of a
   // subloop (which would already have been processed).
@@ -325,8 +355,7 @@ bool llvm::sinkRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
     if (isInstructionTriviallyDead(&I, TLI)) {
       DEBUG(dbgs() << "LICM deleting dead inst: " << I << '\n');
       ++II;
-      CurAST->deleteValue(&I);
-      I.eraseFromParent();
+      eraseInstruction(I, CurAST, MSSA);
       Changed = true;
       continue;
     }
@@ -337,9 +366,9 @@ bool llvm::sinkRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
     // operands of the instruction are loop invariant.
     //
     if (isNotUsedInLoop(I, CurLoop, SafetyInfo) &&
-        canSinkOrHoistInst(I, AA, DT, CurLoop, CurAST, SafetyInfo)) {
+        canSinkOrHoistInst(I, AA, DT, CurLoop, CurAST, SafetyInfo, MSSA)) {
       ++II;
-      Changed |= sink(I, LI, DT, CurLoop, CurAST, SafetyInfo);
+      Changed |= sink(I, LI, DT, CurLoop, CurAST, SafetyInfo, MSSA);
     }
   }
   return Changed;
@@ -352,7 +381,8 @@ bool llvm::sinkRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
 ///
 bool llvm::hoistRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
                        DominatorTree *DT, TargetLibraryInfo *TLI, Loop *CurLoop,
-                       AliasSetTracker *CurAST, LoopSafetyInfo *SafetyInfo) {
+                       AliasSetTracker *CurAST, LoopSafetyInfo *SafetyInfo,
+                       MemorySSA *MSSA) {
   // Verify inputs.
   assert(N != nullptr && AA != nullptr && LI != nullptr && DT != nullptr &&
          CurLoop != nullptr && CurAST != nullptr && SafetyInfo != nullptr &&
@@ -378,10 +408,8 @@ bool llvm::hoistRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
         DEBUG(dbgs() << "LICM folding inst: " << I << "  --> " << *C << '\n');
         CurAST->copyValue(&I, C);
         I.replaceAllUsesWith(C);
-        if (isInstructionTriviallyDead(&I, TLI)) {
-          CurAST->deleteValue(&I);
-          I.eraseFromParent();
-        }
+        if (isInstructionTriviallyDead(&I, TLI))
+          eraseInstruction(I, CurAST, MSSA);
         continue;
       }
 
@@ -390,16 +418,17 @@ bool llvm::hoistRegion(DomTreeNode *N, AliasAnalysis *AA, LoopInfo *LI,
       // is safe to hoist the instruction.
       //
       if (CurLoop->hasLoopInvariantOperands(&I) &&
-          canSinkOrHoistInst(I, AA, DT, CurLoop, CurAST, SafetyInfo) &&
+          canSinkOrHoistInst(I, AA, DT, CurLoop, CurAST, SafetyInfo, MSSA) &&
           isSafeToExecuteUnconditionally(
               I, DT, CurLoop, SafetyInfo,
               CurLoop->getLoopPreheader()->getTerminator()))
-        Changed |= hoist(I, DT, CurLoop, SafetyInfo);
+        Changed |= hoist(I, DT, CurLoop, SafetyInfo, MSSA);
     }
 
   const std::vector<DomTreeNode *> &Children = N->getChildren();
   for (DomTreeNode *Child : Children)
-    Changed |= hoistRegion(Child, AA, LI, DT, TLI, CurLoop, CurAST, SafetyInfo);
+    Changed |= hoistRegion(Child, AA, LI, DT, TLI, CurLoop, CurAST, SafetyInfo,
+                           MSSA);
   return Changed;
 }
 
@@ -445,7 +474,7 @@ void llvm::computeLoopSafetyInfo(LoopSafetyInfo *SafetyInfo, Loop *CurLoop) {
 ///
 bool canSinkOrHoistInst(Instruction &I, AAResults *AA, DominatorTree *DT,
                         Loop *CurLoop, AliasSetTracker *CurAST,
-                        LoopSafetyInfo *SafetyInfo) {
+                        LoopSafetyInfo *SafetyInfo, MemorySSA *MSSA) {
   // Loads have extra constraints we have to verify before we can hoist them.
   if (LoadInst *LI = dyn_cast<LoadInst>(&I)) {
     if (!LI->isUnordered())
@@ -466,7 +495,11 @@ bool canSinkOrHoistInst(Instruction &I, AAResults *AA, DominatorTree *DT,
     AAMDNodes AAInfo;
     LI->getAAMetadata(AAInfo);
 
-    return !pointerInvalidatedByLoop(LI->getOperand(0), Size, AAInfo, CurAST);
+    // The alias set may be much coarser than the stores that actually reach
+    // the load.
+    return !pointerInvalidatedByLoop(LI->getOperand(0), Size, AAInfo,
+                                     CurAST) ||
+           (MSSA && !loadInvalidatedByLoop(LI, CurLoop, MSSA));
   } else if (CallInst *CI = dyn_cast<CallInst>(&I)) {
     // Don't sink or hoist dbg info; it's legal, but not useful.
     if (isa<DbgInfoIntrinsic>(I))
@@ -660,7 +693,7 @@ CloneInstructionInExitBlock(Instruction &I, BasicBlock &ExitBlock, PHINode &PN,
 ///
 static bool sink(Instruction &I, const LoopInfo *LI, const DominatorTree *DT,
                  const Loop *CurLoop, AliasSetTracker *CurAST,
-                 const LoopSafetyInfo *SafetyInfo) {
+                 const LoopSafetyInfo *SafetyInfo, MemorySSA *MSSA) {
   DEBUG(dbgs() << "LICM sinking instruction: " << I << "\n");
   bool Changed = false;
   if (isa<LoadInst>(I))
@@ -680,6 +713,12 @@ static bool sink(Instruction &I, const LoopInfo *LI, const DominatorTree *DT,
   // Clones of this instruction. Don't create more than one per exit block!
   SmallDenseMap<BasicBlock *, Instruction *, 32> SunkCopies;
 
+  // Nothing in the loop clobbers the memory read by the instruction, so its
+  // clones read what reaches the loop.
+  MemoryAccess *Def = nullptr;
+  if (MSSA && MSSA->getMemoryAccess(&I))
+    Def = MSSA->getWalker()->getClobberingMemoryAccess(&I);
+
   // If this instruction is only used outside of the loop, then all users are
   // PHI nodes in exit blocks due to LCSSA form. Just RAUW them with clones of
   // the instruction.
@@ -711,16 +750,19 @@ static bool sink(Instruction &I, const LoopInfo *LI, const DominatorTree *DT,
     auto It = SunkCopies.find(ExitBlock);
     if (It != SunkCopies.end())
       New = It->second;
-    else
+    else {
       New = SunkCopies[ExitBlock] =
           CloneInstructionInExitBlock(I, *ExitBlock, *PN, LI, SafetyInfo);
+      if (Def)
+        MSSA->createMemoryAccessInBB(New, Def, ExitBlock,
+                                     MemorySSA::Beginning);
+    }
 
     PN->replaceAllUsesWith(New);
     PN->eraseFromParent();
   }
 
-  CurAST->deleteValue(&I);
-  I.eraseFromParent();
+  eraseInstruction(I, CurAST, MSSA);
   return Changed;
 }
 
@@ -728,7 +770,7 @@ static bool sink(Instruction &I, const LoopInfo *LI, const DominatorTree *DT,
 /// is safe to hoist, this instruction is called to do the dirty work.
 ///
 static bool hoist(Instruction &I, const DominatorTree *DT, const Loop *CurLoop,
-                  const LoopSafetyInfo *SafetyInfo) {
+                  const LoopSafetyInfo *SafetyInfo, MemorySSA *MSSA) {
   auto *Preheader = CurLoop->getLoopPreheader();
   DEBUG(dbgs() << "LICM hoisting to " << Preheader->getName() << ": " << I
                << "\n");
@@ -744,6 +786,14 @@ static bool hoist(Instruction &I, const DominatorTree *DT, const Loop *CurLoop,
       !isGuaranteedToExecute(I, DT, CurLoop, SafetyInfo))
     I.dropUnknownNonDebugMetadata();
 
+  // Move the access along, so that MemorySSA can be used for the outer loops.
+  if (MSSA)
+    if (MemoryAccess *OldMA = MSSA->getMemoryAccess(&I)) {
+      MemoryAccess *Def = getHoistedDefiningAccess(I, CurLoop, MSSA);
+      MSSA->removeMemoryAccess(OldMA);
+      MSSA->createMemoryAccessInBB(&I, Def, Preheader, MemorySSA::End);
+    }
+
   // Move the new node to the Preheader, before its terminator.
   I.moveBefore(Preheader->getTerminator());
 
@@ -1176,6 +1226,42 @@ static bool pointerInvalidatedByLoop(Value *V, uint64_t Size,
   return CurAST->getAliasSetForPointer(V, Size, AAInfo).isMod();
 }
 
+/// Return true if MemorySSA finds a store in the body of this loop that may
+/// clobber the load.
+static bool loadInvalidatedByLoop(LoadInst *LI, Loop *CurLoop,
+                                  MemorySSA *MSSA) {
+  MemoryAccess *Clobber = MSSA->getWalker()->getClobberingMemoryAccess(LI);
+  return !MSSA->isLiveOnEntryDef(Clobber) &&
+         CurLoop->contains(Clobber->getBlock());
+}
+
+/// Return the defining access of the memory read by \p I once it is hoisted
+/// to the preheader of \p CurLoop: its clobber if that is outside of the loop,
+/// or else the definition that enters the loop.
+static MemoryAccess *getHoistedDefiningAccess(Instruction &I,
+                                              const Loop *CurLoop,
+                                              MemorySSA *MSSA) {
+  MemoryAccess *Clobber = MSSA->getWalker()->getClobberingMemoryAccess(&I);
+  if (MSSA->isLiveOnEntryDef(Clobber) ||
+      !CurLoop->contains(Clobber->getBlock()))
+    return Clobber;
+  // The loop defines memory, so its header has a MemoryPhi.
+  MemoryPhi *Phi = MSSA->getMemoryAccess(CurLoop->getHeader());
+  return cast<MemoryAccess>(
+      Phi->getIncomingValueForBlock(CurLoop->getLoopPreheader()));
+}
+
+/// Erase an instruction of the loop, dropping it from the alias set tracker
+/// and from MemorySSA.
+static void eraseInstruction(Instruction &I, AliasSetTracker *CurAST,
+                             MemorySSA *MSSA) {
+  CurAST->deleteValue(&I);
+  if (MSSA)
+    if (MemoryAccess *MA = MSSA->getMemoryAccess(&I))
+      MSSA->removeMemoryAccess(MA);
+  I.eraseFromParent();
+}
+
 /// Little predicate that returns true if the specified basic block is in
 /// a subloop of the current one, not the current one itself.
 ///
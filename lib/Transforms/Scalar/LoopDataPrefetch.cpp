@@ -59,23 +59,52 @@ static cl::opt<unsigned> MaxPrefetchIterationsAhead(
     "max-prefetch-iters-ahead",
     cl::desc("Max number of iterations to prefetch ahead"), cl::Hidden);
 
+static cl::opt<bool>
+    PrefetchIndirect("loop-prefetch-indirect", cl::Hidden, cl::init(true),
+                     cl::desc("Prefetch indirect accesses of the form "
+                              "A[B[i]]"));
+
+static cl::opt<unsigned> MaxIndirectPrefetches(
+    "max-indirect-prefetches", cl::Hidden, cl::init(4),
+    cl::desc("Max number of indirect prefetches inserted per loop"));
+
+// The index load and address computation are duplicated for every indirect
+// prefetch; give up when that costs more than this percentage of the loop.
+static cl::opt<unsigned> IndirectPrefetchMaxOverhead(
+    "indirect-prefetch-max-overhead", cl::Hidden, cl::init(100),
+    cl::desc("Max cost of an indirect prefetch, in percent of the loop size"));
+
 STATISTIC(NumPrefetches, "Number of prefetches inserted");
+STATISTIC(NumIndirectPrefetches, "Number of indirect prefetches inserted");
 
 namespace {
 
 /// Loop prefetch implementation class.
 class LoopDataPrefetch {
 public:
-  LoopDataPrefetch(AssumptionCache *AC, LoopInfo *LI, ScalarEvolution *SE,
-                   const TargetTransformInfo *TTI,
+  LoopDataPrefetch(AssumptionCache *AC, DominatorTree *DT, LoopInfo *LI,
+                   ScalarEvolution *SE, const TargetTransformInfo *TTI,
                    OptimizationRemarkEmitter *ORE)
-      : AC(AC), LI(LI), SE(SE), TTI(TTI), ORE(ORE) {}
+      : AC(AC), DT(DT), LI(LI), SE(SE), TTI(TTI), ORE(ORE) {}
 
   bool run();
 
 private:
   bool runOnLoop(Loop *L);
 
+  /// \brief Check if the iterations ahead of the current one can be
+  /// addressed safely, i.e. whether loads of the index array for those
+  /// iterations may be executed early. Returns the backedge-taken count
+  /// that bounds them, or null.
+  const SCEV *getIndirectPrefetchBound(Loop *L);
+
+  /// \brief Try to prefetch the access \p MemI to \p PtrValue, whose address
+  /// is computed from a value loaded by an affine access, \p ItersAhead
+  /// iterations ahead.
+  bool insertIndirectPrefetch(Loop *L, Instruction *MemI, Value *PtrValue,
+                              const SCEV *BTC, unsigned ItersAhead,
+                              unsigned LoopSize);
+
   /// \brief Check if the the stride of the accesses is large enough to
   /// warrant a prefetch.
   bool isStrideLargeEnough(const SCEVAddRecExpr *AR);
@@ -99,6 +128,7 @@ private:
   }
 
   AssumptionCache *AC;
+  DominatorTree *DT;
   LoopInfo *LI;
   ScalarEvolution *SE;
   const TargetTransformInfo *TTI;
@@ -115,6 +145,7 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<AssumptionCacheTracker>();
+    AU.addRequired<DominatorTreeWrapperPass>();
     AU.addPreserved<DominatorTreeWrapperPass>();
     AU.addRequired<LoopInfoWrapperPass>();
     AU.addPreserved<LoopInfoWrapperPass>();
@@ -134,6 +165,7 @@ char LoopDataPrefetchLegacyPass::ID = 0;
 INITIALIZE_PASS_BEGIN(LoopDataPrefetchLegacyPass, "loop-data-prefetch",
                       "Loop Data Prefetch", false, false)
 INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
@@ -163,6 +195,7 @@ bool LoopDataPrefetch::isStrideLargeEnough(const SCEVAddRecExpr *AR) {
 
 PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
                                             FunctionAnalysisManager &AM) {
+  DominatorTree *DT = &AM.getResult<DominatorTreeAnalysis>(F);
   LoopInfo *LI = &AM.getResult<LoopAnalysis>(F);
   ScalarEvolution *SE = &AM.getResult<ScalarEvolutionAnalysis>(F);
   AssumptionCache *AC = &AM.getResult<AssumptionAnalysis>(F);
@@ -170,7 +203,7 @@ PreservedAnalyses LoopDataPrefetchPass::run(Function &F,
       &AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
   const TargetTransformInfo *TTI = &AM.getResult<TargetIRAnalysis>(F);
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, DT, LI, SE, TTI, ORE);
   bool Changed = LDP.run();
 
   if (Changed) {
@@ -187,6 +220,7 @@ bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   if (skipFunction(F))
     return false;
 
+  DominatorTree *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   LoopInfo *LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
   ScalarEvolution *SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
   AssumptionCache *AC =
@@ -196,7 +230,7 @@ bool LoopDataPrefetchLegacyPass::runOnFunction(Function &F) {
   const TargetTransformInfo *TTI =
       &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
 
-  LoopDataPrefetch LDP(AC, LI, SE, TTI, ORE);
+  LoopDataPrefetch LDP(AC, DT, LI, SE, TTI, ORE);
   return LDP.run();
 }
 
@@ -255,6 +289,7 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
                << " iterations ahead (loop size: " << LoopSize << ") in "
                << L->getHeader()->getParent()->getName() << ": " << *L);
 
+  SmallVector<std::pair<Instruction *, Value *>, 4> IndirectAccesses;
   SmallVector<std::pair<Instruction *, const SCEVAddRecExpr *>, 16> PrefLoads;
   for (const auto BB : L->blocks()) {
     for (auto &I : *BB) {
@@ -279,8 +314,11 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
 
       const SCEV *LSCEV = SE->getSCEV(PtrValue);
       const SCEVAddRecExpr *LSCEVAddRec = dyn_cast<SCEVAddRecExpr>(LSCEV);
-      if (!LSCEVAddRec)
+      if (!LSCEVAddRec) {
+        if (PrefetchIndirect)
+          IndirectAccesses.push_back(std::make_pair(MemI, PtrValue));
         continue;
+      }
 
       // Check if the the stride of the accesses is large enough to warrant a
       // prefetch.
@@ -336,6 +374,169 @@ bool LoopDataPrefetch::runOnLoop(Loop *L) {
     }
   }
 
+  if (IndirectAccesses.empty())
+    return MadeChange;
+  const SCEV *BTC = getIndirectPrefetchBound(L);
+  if (!BTC)
+    return MadeChange;
+
+  // Accesses through the same address need a single prefetch.
+  SmallPtrSet<const SCEV *, 4> IndirectPtrs;
+  unsigned NumIndirect = 0;
+  for (const auto &Access : IndirectAccesses) {
+    if (NumIndirect == MaxIndirectPrefetches)
+      break;
+    if (!IndirectPtrs.insert(SE->getSCEV(Access.second)).second)
+      continue;
+    if (insertIndirectPrefetch(L, Access.first, Access.second, BTC,
+                               ItersAhead, LoopSize)) {
+      ++NumIndirect;
+      MadeChange = true;
+    }
+  }
+
   return MadeChange;
 }
 
+const SCEV *LoopDataPrefetch::getIndirectPrefetchBound(Loop *L) {
+  // The index load is executed early, for a later iteration. That is only
+  // safe if that iteration is known to execute it too: the loop must leave
+  // only through its latch, after a known number of iterations, and must not
+  // be left early by an exception.
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Latch || !L->getLoopPreheader() || L->getExitingBlock() != Latch)
+    return nullptr;
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC))
+    return nullptr;
+  for (const auto BB : L->blocks())
+    for (auto &I : *BB)
+      if (!isGuaranteedToTransferExecutionToSuccessor(&I))
+        return nullptr;
+  return BTC;
+}
+
+bool LoopDataPrefetch::insertIndirectPrefetch(Loop *L, Instruction *MemI,
+                                              Value *PtrValue,
+                                              const SCEV *BTC,
+                                              unsigned ItersAhead,
+                                              unsigned LoopSize) {
+  // Match A[f(B[i])], where A is loop invariant, f is a chain of casts and
+  // arithmetic with loop invariant operands, and B[i] is an affine access.
+  auto *GEP = dyn_cast<GetElementPtrInst>(PtrValue);
+  if (!GEP || !L->contains(GEP) ||
+      !L->isLoopInvariant(GEP->getPointerOperand()))
+    return false;
+  Value *Index = nullptr;
+  for (Value *Op : make_range(GEP->idx_begin(), GEP->idx_end())) {
+    if (L->isLoopInvariant(Op))
+      continue;
+    if (Index)
+      return false;
+    Index = Op;
+  }
+  if (!Index)
+    return false;
+
+  // The chain, from the address back to the index load.
+  SmallVector<Instruction *, 8> Chain;
+  Chain.push_back(GEP);
+  LoadInst *IdxLoad = nullptr;
+  Value *V = Index;
+  while (!IdxLoad) {
+    auto *I = dyn_cast<Instruction>(V);
+    if (!I || !L->contains(I) || Chain.size() > 8)
+      return false;
+    if (auto *Load = dyn_cast<LoadInst>(I)) {
+      IdxLoad = Load;
+    } else if (isa<CastInst>(I)) {
+      Chain.push_back(I);
+      V = I->getOperand(0);
+    } else if (isa<BinaryOperator>(I) && !I->mayHaveSideEffects() &&
+               isSafeToSpeculativelyExecute(I)) {
+      Chain.push_back(I);
+      if (L->isLoopInvariant(I->getOperand(1)))
+        V = I->getOperand(0);
+      else if (L->isLoopInvariant(I->getOperand(0)))
+        V = I->getOperand(1);
+      else
+        return false;
+    } else {
+      return false;
+    }
+  }
+  if (!IdxLoad->isSimple() ||
+      !DT->dominates(IdxLoad->getParent(), L->getLoopLatch()))
+    return false;
+  Value *IdxPtr = IdxLoad->getPointerOperand();
+  if (IdxPtr->getType()->getPointerAddressSpace())
+    return false;
+  const auto *IdxAddRec = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(IdxPtr));
+  if (!IdxAddRec || IdxAddRec->getLoop() != L || !IdxAddRec->isAffine())
+    return false;
+
+  // Duplicating the chain must pay for itself: compare its cost, plus the
+  // prefetch, against the size of the loop.
+  int Cost = TTI->getUserCost(IdxLoad) + 1;
+  for (Instruction *I : Chain)
+    Cost += TTI->getUserCost(I);
+  if ((uint64_t)Cost * 100 > (uint64_t)LoopSize * IndirectPrefetchMaxOverhead) {
+    DEBUG(dbgs() << "  Indirect access too expensive to prefetch: "
+                 << *PtrValue << "\n");
+    return false;
+  }
+
+  // Load B[min(i + ItersAhead, BTC)]: the iteration is clamped to the last
+  // one, so that the index load never reads past what the loop itself reads.
+  Type *BTCTy = BTC->getType();
+  const SCEV *FutureIter = SE->getUMinExpr(
+      SE->getAddRecExpr(SE->getConstant(BTCTy, ItersAhead),
+                        SE->getOne(BTCTy), L, SCEV::FlagAnyWrap),
+      BTC);
+  const SCEV *Step = IdxAddRec->getStepRecurrence(*SE);
+  const SCEV *FutureIdxPtr = SE->getAddExpr(
+      IdxAddRec->getStart(),
+      SE->getMulExpr(Step, SE->getTruncateOrZeroExtend(FutureIter,
+                                                       Step->getType())));
+  if (!isSafeToExpand(FutureIdxPtr, *SE))
+    return false;
+
+  SCEVExpander SCEVE(*SE, MemI->getModule()->getDataLayout(), "prefidx");
+  Value *FutureIdxPtrValue =
+      SCEVE.expandCodeFor(FutureIdxPtr, IdxPtr->getType(), MemI);
+
+  ValueToValueMapTy VMap;
+  Instruction *NewIdxLoad = IdxLoad->clone();
+  NewIdxLoad->setOperand(0, FutureIdxPtrValue);
+  NewIdxLoad->setName("prefidx.load");
+  NewIdxLoad->insertBefore(MemI);
+  VMap[IdxLoad] = NewIdxLoad;
+  Instruction *NewI = NewIdxLoad;
+  for (Instruction *I : reverse(Chain)) {
+    NewI = I->clone();
+    RemapInstruction(NewI, VMap,
+                     RF_NoModuleLevelChanges | RF_IgnoreMissingLocals);
+    NewI->setName(I->getName() + ".pref");
+    NewI->insertBefore(MemI);
+    VMap[I] = NewI;
+  }
+
+  IRBuilder<> Builder(MemI);
+  Module *M = MemI->getModule();
+  Type *I32 = Type::getInt32Ty(MemI->getContext());
+  Value *PrefPtrValue =
+      Builder.CreateBitCast(NewI, Type::getInt8PtrTy(MemI->getContext()));
+  Value *PrefetchFunc = Intrinsic::getDeclaration(M, Intrinsic::prefetch);
+  Builder.CreateCall(
+      PrefetchFunc,
+      {PrefPtrValue, ConstantInt::get(I32, MemI->mayReadFromMemory() ? 0 : 1),
+       ConstantInt::get(I32, 3), ConstantInt::get(I32, 1)});
+  ++NumPrefetches;
+  ++NumIndirectPrefetches;
+  DEBUG(dbgs() << "  Indirect access: " << *PtrValue << ", index: "
+               << *IdxLoad << "\n");
+  ORE->emit(OptimizationRemark(DEBUG_TYPE, "PrefetchedIndirect", MemI)
+            << "prefetched indirect memory access");
+  return true;
+}
+
@@ -0,0 +1,404 @@
+//===- LoopFuse.cpp - Loop Fusion Pass ------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Loop Fusion Pass.  Two loops are fused when
+//
+//   - they are adjacent: the exit block of the first one is the preheader of
+//     the second one and contains nothing but a branch,
+//   - they are innermost loops in simplified and rotated form, which leave
+//     only through their latch,
+//   - SCEV proves that they have the same backedge-taken count,
+//   - fusion does not reverse any dependence between them, and
+//   - they access a common underlying object, so fusion saves bandwidth.
+//
+// The fused loop runs one iteration of the first loop and then one iteration
+// of the second loop. This is legal unless an iteration of the second loop
+// depends on a later iteration of the first loop. DependenceAnalysis tells
+// which pairs of accesses may depend on each other at all. For those pairs,
+// the distance between the accesses is computed with SCEV.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopFuse.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationDiagnosticInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-fusion"
+
+STATISTIC(NumLoopsFused, "Number of loops fused");
+
+static cl::opt<unsigned> FusionMaxInsts(
+    "loop-fusion-max-insts", cl::init(200), cl::Hidden,
+    cl::desc("The maximum number of instructions in a fused loop"));
+
+static cl::opt<bool> FusionRequireReuse(
+    "loop-fusion-require-reuse", cl::init(true), cl::Hidden,
+    cl::desc("Only fuse loops that access a common underlying object"));
+
+static Value *getPointerOperand(Instruction *I) {
+  if (auto *LI = dyn_cast<LoadInst>(I))
+    return LI->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+namespace {
+
+/// \brief Fuses the adjacent loops of one function.
+class LoopFuser {
+public:
+  LoopFuser(Function &F, LoopInfo &LI, DominatorTree &DT, ScalarEvolution &SE,
+            DependenceInfo &DI, OptimizationRemarkEmitter &ORE)
+      : LI(LI), DT(DT), SE(SE), DI(DI), ORE(ORE),
+        DL(F.getParent()->getDataLayout()) {}
+
+  bool run() {
+    bool Changed = false;
+    // Fusing two loops may make the result fusible with the next loop, so
+    // look for candidates again after every fusion.
+    for (bool Fused = true; Fused;) {
+      Fused = false;
+      SmallVector<Loop *, 8> Worklist;
+      for (Loop *TopLevelLoop : LI)
+        for (Loop *L : depth_first(TopLevelLoop))
+          if (L->empty())
+            Worklist.push_back(L);
+
+      for (Loop *L1 : Worklist) {
+        Loop *L2 = getAdjacentLoop(L1);
+        if (L2 && tryFuse(L1, L2)) {
+          Fused = Changed = true;
+          break;
+        }
+      }
+    }
+    return Changed;
+  }
+
+private:
+  /// \brief Returns the loop that \p L1 branches to straight after exiting,
+  /// if there is one.
+  Loop *getAdjacentLoop(Loop *L1) {
+    BasicBlock *ExitBB = L1->getExitBlock();
+    if (!ExitBB || isa<PHINode>(ExitBB->begin()) ||
+        ExitBB->getFirstNonPHIOrDbg() != ExitBB->getTerminator())
+      return nullptr;
+    auto *BI = dyn_cast<BranchInst>(ExitBB->getTerminator());
+    if (!BI || BI->isConditional())
+      return nullptr;
+    Loop *L2 = LI.getLoopFor(BI->getSuccessor(0));
+    if (!L2 || L2 == L1 || !L2->empty() ||
+        L2->getLoopPreheader() != ExitBB ||
+        L2->getParentLoop() != L1->getParentLoop())
+      return nullptr;
+    return L2;
+  }
+
+  /// \brief Checks the shape and contents of \p L, and collects its memory
+  /// accesses into \p Accesses. \p IsFirst is set for the loop that the other
+  /// one is fused into.
+  bool isFusionCandidate(Loop *L, bool IsFirst,
+                         SmallVectorImpl<Instruction *> &Accesses,
+                         unsigned &NumInsts) {
+    BasicBlock *Latch = L->getLoopLatch();
+    if (!L->isLoopSimplifyForm() || L->getExitingBlock() != Latch)
+      return false;
+    auto *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+    if (!BI || !BI->isConditional())
+      return false;
+
+    for (BasicBlock *BB : L->blocks())
+      for (Instruction &I : *BB) {
+        if (isa<DbgInfoIntrinsic>(I))
+          continue;
+        if (!isa<PHINode>(I))
+          ++NumInsts;
+        // Fusion moves the second loop's body before later iterations of the
+        // first one; both must run to completion for that to be correct.
+        if (!isGuaranteedToTransferExecutionToSuccessor(&I))
+          return false;
+        if (auto *CI = dyn_cast<CallInst>(&I))
+          if (CI->isConvergent() || CI->mayReadOrWriteMemory())
+            return false;
+        if (I.mayReadOrWriteMemory()) {
+          if (auto *LI = dyn_cast<LoadInst>(&I)) {
+            if (!LI->isSimple())
+              return false;
+          } else if (auto *SI = dyn_cast<StoreInst>(&I)) {
+            if (!SI->isSimple())
+              return false;
+          } else {
+            return false;
+          }
+          Accesses.push_back(&I);
+        }
+        // Values escaping the first loop would have to be recomputed after
+        // the fused loop.
+        if (IsFirst)
+          for (User *U : I.users())
+            if (!L->contains(cast<Instruction>(U)))
+              return false;
+      }
+    return true;
+  }
+
+  /// \brief Checks that SCEV proves both loops run the same number of
+  /// iterations.
+  bool haveSameTripCount(Loop *L1, Loop *L2) {
+    const SCEV *BTC1 = SE.getBackedgeTakenCount(L1);
+    const SCEV *BTC2 = SE.getBackedgeTakenCount(L2);
+    if (isa<SCEVCouldNotCompute>(BTC1) || isa<SCEVCouldNotCompute>(BTC2))
+      return false;
+    if (SE.getTypeSizeInBits(BTC1->getType()) <
+        SE.getTypeSizeInBits(BTC2->getType()))
+      BTC1 = SE.getZeroExtendExpr(BTC1, BTC2->getType());
+    else
+      BTC2 = SE.getNoopOrZeroExtend(BTC2, BTC1->getType());
+    return BTC1 == BTC2;
+  }
+
+  /// \brief Checks that no iteration of \p L2 accessing what \p I2 accesses
+  /// depends on a later iteration of \p L1 through \p I1.
+  bool isSafeToFuse(Instruction *I1, Loop *L1, Instruction *I2, Loop *L2) {
+    Value *Ptr1 = getPointerOperand(I1);
+    Value *Ptr2 = getPointerOperand(I2);
+    const auto *AR1 = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(Ptr1));
+    const auto *AR2 = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(Ptr2));
+    if (!AR1 || !AR2 || AR1->getLoop() != L1 || AR2->getLoop() != L2 ||
+        !AR1->isAffine() || !AR2->isAffine())
+      return false;
+    const SCEV *Step = AR1->getStepRecurrence(SE);
+    const auto *ConstStep = dyn_cast<SCEVConstant>(Step);
+    if (!ConstStep || Step != AR2->getStepRecurrence(SE))
+      return false;
+    const auto *ConstDist = dyn_cast<SCEVConstant>(
+        SE.getMinusSCEV(AR2->getStart(), AR1->getStart()));
+    if (!ConstDist)
+      return false;
+
+    // Iteration j of L1 accesses [Start1 + Step * j, +Size1), iteration i of
+    // L2 accesses [Start1 + Dist + Step * i, +Size2). These must not overlap
+    // for any j > i.
+    int64_t StepVal = ConstStep->getAPInt().getSExtValue();
+    int64_t Dist = ConstDist->getAPInt().getSExtValue();
+    int64_t Size1 =
+        DL.getTypeStoreSize(Ptr1->getType()->getPointerElementType());
+    int64_t Size2 =
+        DL.getTypeStoreSize(Ptr2->getType()->getPointerElementType());
+    if (StepVal > 0)
+      return Dist <= StepVal - Size2;
+    return Dist >= StepVal + Size1;
+  }
+
+  bool isFusionLegal(Loop *L1, ArrayRef<Instruction *> Accesses1, Loop *L2,
+                     ArrayRef<Instruction *> Accesses2) {
+    for (Instruction *I1 : Accesses1)
+      for (Instruction *I2 : Accesses2) {
+        if (!I1->mayWriteToMemory() && !I2->mayWriteToMemory())
+          continue;
+        if (!DI.depends(I1, I2, true))
+          continue;
+        if (!isSafeToFuse(I1, L1, I2, L2)) {
+          DEBUG(dbgs() << "LoopFuse: Unsafe dependence from " << *I1 << " to "
+                       << *I2 << "\n");
+          return false;
+        }
+      }
+    return true;
+  }
+
+  /// \brief Fusion pays off when the loops stream through common data.
+  bool isFusionProfitable(ArrayRef<Instruction *> Accesses1,
+                          ArrayRef<Instruction *> Accesses2,
+                          unsigned NumInsts) {
+    if (NumInsts > FusionMaxInsts)
+      return false;
+    if (!FusionRequireReuse)
+      return true;
+    for (Instruction *I1 : Accesses1) {
+      Value *Obj1 = GetUnderlyingObject(getPointerOperand(I1), DL);
+      for (Instruction *I2 : Accesses2)
+        if (Obj1 == GetUnderlyingObject(getPointerOperand(I2), DL))
+          return true;
+    }
+    return false;
+  }
+
+  bool tryFuse(Loop *L1, Loop *L2) {
+    DEBUG(dbgs() << "LoopFuse: Trying " << *L1 << "  and " << *L2);
+    SmallVector<Instruction *, 16> Accesses1, Accesses2;
+    unsigned NumInsts = 0;
+    if (!isFusionCandidate(L1, /*IsFirst=*/true, Accesses1, NumInsts) ||
+        !isFusionCandidate(L2, /*IsFirst=*/false, Accesses2, NumInsts)) {
+      DEBUG(dbgs() << "LoopFuse: Unsupported loop shape or contents\n");
+      return false;
+    }
+    if (!haveSameTripCount(L1, L2)) {
+      DEBUG(dbgs() << "LoopFuse: Trip counts differ\n");
+      return false;
+    }
+    if (!isFusionLegal(L1, Accesses1, L2, Accesses2))
+      return false;
+    if (!isFusionProfitable(Accesses1, Accesses2, NumInsts)) {
+      DEBUG(dbgs() << "LoopFuse: Not profitable\n");
+      return false;
+    }
+
+    ORE.emit(OptimizationRemark(DEBUG_TYPE, "Fused", L1->getStartLoc(),
+                                L1->getHeader())
+             << "fused with the following loop");
+    fuse(L1, L2);
+    ++NumLoopsFused;
+    return true;
+  }
+
+  /// \brief Fuses \p L2 into \p L1 and deletes \p L2.
+  void fuse(Loop *L1, Loop *L2) {
+    BasicBlock *Preheader1 = L1->getLoopPreheader();
+    BasicBlock *Header1 = L1->getHeader();
+    BasicBlock *Latch1 = L1->getLoopLatch();
+    BasicBlock *Preheader2 = L2->getLoopPreheader();
+    BasicBlock *Header2 = L2->getHeader();
+    BasicBlock *Latch2 = L2->getLoopLatch();
+    MDNode *LoopID = L1->getLoopID();
+
+    SE.forgetLoop(L1);
+    SE.forgetLoop(L2);
+
+    // The latch of L1 now falls through to the body of L2, and the latch of
+    // L2 takes the backedge to the header of L1 or leaves the fused loop.
+    auto *BI1 = cast<BranchInst>(Latch1->getTerminator());
+    Value *Cond1 = BI1->getCondition();
+    BranchInst::Create(Header2, BI1);
+    BI1->eraseFromParent();
+    RecursivelyDeleteTriviallyDeadInstructions(Cond1);
+    auto *BI2 = cast<BranchInst>(Latch2->getTerminator());
+    for (unsigned I = 0, E = BI2->getNumSuccessors(); I != E; ++I)
+      if (BI2->getSuccessor(I) == Header2)
+        BI2->setSuccessor(I, Header1);
+    BI2->setMetadata(LLVMContext::MD_loop, LoopID);
+
+    // The recurrences of L2 are carried around the fused loop, so their phis
+    // move to its header. Their start values are available in the preheader
+    // of L1, since nothing defined in L1 is used outside of it.
+    for (auto I = Header1->begin(); auto *PN = dyn_cast<PHINode>(I); ++I)
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Latch1), Latch2);
+    while (auto *PN = dyn_cast<PHINode>(Header2->begin())) {
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Preheader2), Preheader1);
+      PN->moveBefore(Header1->getFirstNonPHI());
+    }
+
+    DT.changeImmediateDominator(Header2, Latch1);
+    DT.eraseNode(Preheader2);
+    LI.removeBlock(Preheader2);
+    Preheader2->eraseFromParent();
+
+    for (BasicBlock *BB : L2->blocks()) {
+      L1->addBlockEntry(BB);
+      LI.changeLoopFor(BB, L1);
+    }
+    if (Loop *Parent = L2->getParentLoop())
+      Parent->removeChildLoop(find(*Parent, L2));
+    else
+      LI.removeLoop(find(LI, L2));
+    delete L2;
+  }
+
+  LoopInfo &LI;
+  DominatorTree &DT;
+  ScalarEvolution &SE;
+  DependenceInfo &DI;
+  OptimizationRemarkEmitter &ORE;
+  const DataLayout &DL;
+};
+
+/// \brief The pass class.
+class LoopFuseLegacy : public FunctionPass {
+public:
+  static char ID;
+
+  LoopFuseLegacy() : FunctionPass(ID) {
+    initializeLoopFuseLegacyPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipFunction(F))
+      return false;
+
+    auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    auto &DI = getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+    auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+    return LoopFuser(F, LI, DT, SE, DI, ORE).run();
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addPreserved<GlobalsAAWrapperPass>();
+  }
+};
+} // anonymous namespace
+
+PreservedAnalyses LoopFusePass::run(Function &F, FunctionAnalysisManager &AM) {
+  auto &LI = AM.getResult<LoopAnalysis>(F);
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &SE = AM.getResult<ScalarEvolutionAnalysis>(F);
+  auto &DI = AM.getResult<DependenceAnalysis>(F);
+  auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+
+  if (!LoopFuser(F, LI, DT, SE, DI, ORE).run())
+    return PreservedAnalyses::all();
+  PreservedAnalyses PA;
+  PA.preserve<LoopAnalysis>();
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<GlobalsAA>();
+  return PA;
+}
+
+char LoopFuseLegacy::ID = 0;
+static const char lfuse_name[] = "Loop Fusion";
+
+INITIALIZE_PASS_BEGIN(LoopFuseLegacy, DEBUG_TYPE, lfuse_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_END(LoopFuseLegacy, DEBUG_TYPE, lfuse_name, false, false)
+
+namespace llvm {
+FunctionPass *createLoopFusePass() { return new LoopFuseLegacy(); }
+} // end namespace llvm
@@ -96,6 +96,15 @@ static cl::opt<bool> EnablePhiElim(
   "enable-lsr-phielim", cl::Hidden, cl::init(true),
   cl::desc("Enable LSR phi elimination"));
 
+static cl::opt<unsigned> SolverBudget(
+  "lsr-solver-budget", cl::Hidden, cl::init(200000),
+  cl::desc("Maximum number of formulae the exhaustive LSR solver rates "
+           "before falling back to a beam search"));
+
+static cl::opt<unsigned> SolverBeamWidth(
+  "lsr-solver-beam-width", cl::Hidden, cl::init(16),
+  cl::desc("Number of partial solutions kept by the LSR beam search"));
+
 #ifndef NDEBUG
 // Stress test IV chain generation.
 static cl::opt<bool> StressIVChain(
@@ -888,6 +897,22 @@ public:
                    const LSRUse &LU,
                    SmallPtrSetImpl<const SCEV *> *LoserRegs = nullptr);
 
+  /// Rate the registers of \p F that are not yet in \p Regs.
+  void RateFormulaRegs(const Formula &F,
+                       SmallPtrSetImpl<const SCEV *> &Regs,
+                       const DenseSet<const SCEV *> &VisitedRegs,
+                       const Loop *L,
+                       ScalarEvolution &SE, DominatorTree &DT,
+                       SmallPtrSetImpl<const SCEV *> *LoserRegs = nullptr);
+
+  /// Rate the adds, scales and immediates of \p F. Unlike the register cost,
+  /// this does not depend on the other formulae of a solution.
+  void RateFormulaOperations(const TargetTransformInfo &TTI,
+                             const Formula &F, const LSRUse &LU);
+
+  /// Add the operation costs computed by RateFormulaOperations in \p Other.
+  void addOperationCosts(const Cost &Other);
+
   void print(raw_ostream &OS) const;
   void dump() const;
 
@@ -1115,6 +1140,18 @@ void Cost::RateFormula(const TargetTransformInfo &TTI,
                        ScalarEvolution &SE, DominatorTree &DT,
                        const LSRUse &LU,
                        SmallPtrSetImpl<const SCEV *> *LoserRegs) {
+  RateFormulaRegs(F, Regs, VisitedRegs, L, SE, DT, LoserRegs);
+  if (isLoser())
+    return;
+  RateFormulaOperations(TTI, F, LU);
+}
+
+void Cost::RateFormulaRegs(const Formula &F,
+                           SmallPtrSetImpl<const SCEV *> &Regs,
+                           const DenseSet<const SCEV *> &VisitedRegs,
+                           const Loop *L,
+                           ScalarEvolution &SE, DominatorTree &DT,
+                           SmallPtrSetImpl<const SCEV *> *LoserRegs) {
   assert(F.isCanonical() && "Cost is accurate only for canonical formula");
   // Tally up the registers.
   if (const SCEV *ScaledReg = F.ScaledReg) {
@@ -1135,7 +1172,10 @@ void Cost::RateFormula(const TargetTransformInfo &TTI,
     if (isLoser())
       return;
   }
+}
 
+void Cost::RateFormulaOperations(const TargetTransformInfo &TTI,
+                                 const Formula &F, const LSRUse &LU) {
   // Determine how many (unfolded) adds we'll need inside the loop.
   size_t NumBaseParts = F.getNumRegs();
   if (NumBaseParts > 1)
@@ -1167,6 +1207,13 @@ void Cost::RateFormula(const TargetTransformInfo &TTI,
   assert(isValid() && "invalid cost");
 }
 
+void Cost::addOperationCosts(const Cost &Other) {
+  assert(!isLoser() && "Adding to a losing cost!");
+  NumBaseAdds += Other.NumBaseAdds;
+  ScaleCost += Other.ScaleCost;
+  ImmCost += Other.ImmCost;
+}
+
 /// Set this cost to a losing value.
 void Cost::Lose() {
   NumRegs = ~0u;
@@ -1735,12 +1782,22 @@ class LSRInstance {
   void NarrowSearchSpaceByPickingWinnerRegs();
   void NarrowSearchSpaceUsingHeuristics();
 
+  typedef DenseMap<const Formula *, Cost> OperationCostMap;
+  bool RateInSolution(Cost &C, const Formula &F, const LSRUse &LU,
+                      SmallPtrSetImpl<const SCEV *> &Regs,
+                      const DenseSet<const SCEV *> &VisitedRegs,
+                      OperationCostMap &OperationCosts) const;
   void SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
                     Cost &SolutionCost,
                     SmallVectorImpl<const Formula *> &Workspace,
                     const Cost &CurCost,
                     const SmallPtrSet<const SCEV *, 16> &CurRegs,
-                    DenseSet<const SCEV *> &VisitedRegs) const;
+                    DenseSet<const SCEV *> &VisitedRegs,
+                    OperationCostMap &OperationCosts,
+                    unsigned &Budget) const;
+  void SolveBeam(SmallVectorImpl<const Formula *> &Solution,
+                 Cost &SolutionCost,
+                 OperationCostMap &OperationCosts) const;
   void Solve(SmallVectorImpl<const Formula *> &Solution) const;
 
   BasicBlock::iterator
@@ -4194,13 +4251,51 @@ void LSRInstance::NarrowSearchSpaceUsingHeuristics() {
   NarrowSearchSpaceByPickingWinnerRegs();
 }
 
-/// This is the recursive solver.
+/// Rate \p F as the next formula of a partial solution with cost \p C and
+/// registers \p Regs, updating both. The operation costs of each formula are
+/// computed once and memoized in \p OperationCosts. Returns false if the
+/// resulting cost is a loser.
+bool LSRInstance::RateInSolution(Cost &C, const Formula &F, const LSRUse &LU,
+                                 SmallPtrSetImpl<const SCEV *> &Regs,
+                                 const DenseSet<const SCEV *> &VisitedRegs,
+                                 OperationCostMap &OperationCosts) const {
+  C.RateFormulaRegs(F, Regs, VisitedRegs, L, SE, DT);
+  if (C.isLoser())
+    return false;
+  auto Pair = OperationCosts.insert(std::make_pair(&F, Cost()));
+  if (Pair.second)
+    Pair.first->second.RateFormulaOperations(TTI, F, LU);
+  C.addOperationCosts(Pair.first->second);
+  return true;
+}
+
+/// Return true if \p F references all of the registers in \p ReqRegs, or at
+/// least as many of them as it has registers.
+static bool
+referencesRequiredRegs(const Formula &F,
+                       const SmallSetVector<const SCEV *, 4> &ReqRegs) {
+  int NumReqRegsToFind = std::min(F.getNumRegs(), ReqRegs.size());
+  for (const SCEV *Reg : ReqRegs) {
+    if ((F.ScaledReg && F.ScaledReg == Reg) ||
+        is_contained(F.BaseRegs, Reg)) {
+      --NumReqRegsToFind;
+      if (NumReqRegsToFind == 0)
+        break;
+    }
+  }
+  return NumReqRegsToFind == 0;
+}
+
+/// This is the recursive solver. It gives up once it has rated \p Budget
+/// formulae, leaving the best solution found so far in \p Solution.
 void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
                                Cost &SolutionCost,
                                SmallVectorImpl<const Formula *> &Workspace,
                                const Cost &CurCost,
                                const SmallPtrSet<const SCEV *, 16> &CurRegs,
-                               DenseSet<const SCEV *> &VisitedRegs) const {
+                               DenseSet<const SCEV *> &VisitedRegs,
+                               OperationCostMap &OperationCosts,
+                               unsigned &Budget) const {
   // Some ideas:
   //  - prune more:
   //    - use more aggressive filtering
@@ -4225,19 +4320,13 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
   SmallPtrSet<const SCEV *, 16> NewRegs;
   Cost NewCost;
   for (const Formula &F : LU.Formulae) {
+    if (Budget == 0)
+      return;
+
     // Ignore formulae which may not be ideal in terms of register reuse of
     // ReqRegs.  The formula should use all required registers before
     // introducing new ones.
-    int NumReqRegsToFind = std::min(F.getNumRegs(), ReqRegs.size());
-    for (const SCEV *Reg : ReqRegs) {
-      if ((F.ScaledReg && F.ScaledReg == Reg) ||
-          is_contained(F.BaseRegs, Reg)) {
-        --NumReqRegsToFind;
-        if (NumReqRegsToFind == 0)
-          break;
-      }
-    }
-    if (NumReqRegsToFind != 0) {
+    if (!referencesRequiredRegs(F, ReqRegs)) {
       // If none of the formulae satisfied the required registers, then we could
       // clear ReqRegs and try again. Currently, we simply give up in this case.
       continue;
@@ -4245,14 +4334,16 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
 
     // Evaluate the cost of the current formula. If it's already worse than
     // the current best, prune the search at that point.
+    --Budget;
     NewCost = CurCost;
     NewRegs = CurRegs;
-    NewCost.RateFormula(TTI, F, NewRegs, VisitedRegs, L, SE, DT, LU);
+    if (!RateInSolution(NewCost, F, LU, NewRegs, VisitedRegs, OperationCosts))
+      continue;
     if (NewCost < SolutionCost) {
       Workspace.push_back(&F);
       if (Workspace.size() != Uses.size()) {
         SolveRecurse(Solution, SolutionCost, Workspace, NewCost,
-                     NewRegs, VisitedRegs);
+                     NewRegs, VisitedRegs, OperationCosts, Budget);
         if (F.getNumRegs() == 1 && Workspace.size() == 1)
           VisitedRegs.insert(F.ScaledReg ? F.ScaledReg : F.BaseRegs[0]);
       } else {
@@ -4270,6 +4361,69 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
   }
 }
 
+/// Choose one formula from each use, in order, keeping only the
+/// SolverBeamWidth cheapest partial solutions after each use. This is used
+/// when the search space is too large for SolveRecurse.
+void LSRInstance::SolveBeam(SmallVectorImpl<const Formula *> &Solution,
+                            Cost &SolutionCost,
+                            OperationCostMap &OperationCosts) const {
+  struct PartialSolution {
+    SmallVector<const Formula *, 8> Formulae;
+    SmallPtrSet<const SCEV *, 16> Regs;
+    Cost C;
+  };
+
+  const DenseSet<const SCEV *> NoVisitedRegs;
+  std::vector<PartialSolution> Beam(1), NextBeam;
+  for (const LSRUse &LU : Uses) {
+    NextBeam.clear();
+    for (const PartialSolution &PS : Beam) {
+      SmallSetVector<const SCEV *, 4> ReqRegs;
+      for (const SCEV *S : PS.Regs)
+        if (LU.Regs.count(S))
+          ReqRegs.insert(S);
+
+      // Prefer formulae that reuse the registers of the partial solution, as
+      // SolveRecurse does, but don't let that end the search.
+      bool AnyReuse = any_of(LU.Formulae, [&](const Formula &F) {
+        return referencesRequiredRegs(F, ReqRegs);
+      });
+      for (const Formula &F : LU.Formulae) {
+        if (AnyReuse && !referencesRequiredRegs(F, ReqRegs))
+          continue;
+        PartialSolution Next;
+        Next.C = PS.C;
+        Next.Regs = PS.Regs;
+        if (!RateInSolution(Next.C, F, LU, Next.Regs, NoVisitedRegs,
+                            OperationCosts))
+          continue;
+        Next.Formulae = PS.Formulae;
+        Next.Formulae.push_back(&F);
+        NextBeam.push_back(std::move(Next));
+      }
+    }
+    if (NextBeam.empty())
+      return;
+
+    std::stable_sort(NextBeam.begin(), NextBeam.end(),
+                     [](const PartialSolution &A, const PartialSolution &B) {
+                       return A.C < B.C;
+                     });
+    unsigned Width = std::max(1u, unsigned(SolverBeamWidth));
+    if (NextBeam.size() > Width)
+      NextBeam.resize(Width);
+    Beam.swap(NextBeam);
+  }
+
+  const PartialSolution &Best = Beam.front();
+  if (Best.C < SolutionCost) {
+    DEBUG(dbgs() << "Beam search found a better solution at ";
+          Best.C.print(dbgs()); dbgs() << ".\n");
+    SolutionCost = Best.C;
+    Solution = Best.Formulae;
+  }
+}
+
 /// Choose one formula from each use. Return the results in the given Solution
 /// vector.
 void LSRInstance::Solve(SmallVectorImpl<const Formula *> &Solution) const {
@@ -4279,11 +4433,17 @@ void LSRInstance::Solve(SmallVectorImpl<const Formula *> &Solution) const {
   Cost CurCost;
   SmallPtrSet<const SCEV *, 16> CurRegs;
   DenseSet<const SCEV *> VisitedRegs;
+  OperationCostMap OperationCosts;
+  unsigned Budget = SolverBudget;
   Workspace.reserve(Uses.size());
 
-  // SolveRecurse does all the work.
+  // SolveRecurse does all the work, unless it runs out of budget.
   SolveRecurse(Solution, SolutionCost, Workspace, CurCost,
-               CurRegs, VisitedRegs);
+               CurRegs, VisitedRegs, OperationCosts, Budget);
+  if (Budget == 0) {
+    DEBUG(dbgs() << "\nThe solver ran out of budget; using a beam search.\n");
+    SolveBeam(Solution, SolutionCost, OperationCosts);
+  }
   if (Solution.empty()) {
     DEBUG(dbgs() << "\nNo Satisfactory Solution\n");
     return;
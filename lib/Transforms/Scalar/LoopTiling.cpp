@@ -0,0 +1,524 @@
+//===- LoopTiling.cpp - Loop Tiling Pass ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Loop Tiling Pass. It handles perfect two-deep loop
+// nests whose inner loop runs from 0 to an outer-invariant bound, such as
+//
+//   for (i = ...)                  for (jj = 0; jj < m; jj += T)
+//     for (j = 0; j < m; ++j)  =>    for (i = ...)
+//       S(i, j);                       for (j = jj; j < min(jj + T, m); ++j)
+//                                        S(i, j);
+//
+// The inner loop is strip-mined and the strip loop is moved outside of the
+// nest, so the data the inner loop touches for one strip stays in the cache
+// across the iterations of the outer loop.
+//
+// The transform is legal unless a dependence is carried forward by the outer
+// loop and backward by the inner loop, which is checked with
+// DependenceAnalysis. It is only done when some data is actually reused
+// across the iterations of the outer loop, as recognized from the
+// delinearized access functions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/LoopTiling.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationDiagnosticInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Transforms/Scalar.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "loop-tiling"
+
+STATISTIC(NumLoopsTiled, "Number of loop nests tiled");
+
+static cl::opt<unsigned>
+    TileCacheSize("loop-tiling-cache-size", cl::init(32768), cl::Hidden,
+                  cl::desc("The size in bytes of the cache the tiles are "
+                           "sized for (default = the target's L1 data cache "
+                           "size, or 32768 if unknown)"));
+
+static cl::opt<unsigned>
+    ForceTileSize("loop-tiling-tile-size", cl::init(0), cl::Hidden,
+                  cl::desc("Use this tile size, in iterations, instead of "
+                           "the one computed from the cache size"));
+
+static Value *getPointerOperand(Instruction *I) {
+  if (auto *LI = dyn_cast<LoadInst>(I))
+    return LI->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+namespace {
+
+/// \brief Tiles the inner loop of one perfect two-deep loop nest.
+class LoopTiler {
+public:
+  LoopTiler(Loop *Outer, Loop *Inner, LoopInfo &LI, DominatorTree &DT,
+            ScalarEvolution &SE, DependenceInfo &DI,
+            const TargetTransformInfo &TTI, OptimizationRemarkEmitter &ORE)
+      : Outer(Outer), Inner(Inner), LI(LI), DT(DT), SE(SE), DI(DI), TTI(TTI),
+        ORE(ORE), DL(Outer->getHeader()->getModule()->getDataLayout()) {}
+
+  bool run() {
+    DEBUG(dbgs() << "LoopTiling: Trying " << *Outer);
+    if (!isPerfectNest()) {
+      DEBUG(dbgs() << "LoopTiling: Not a supported perfect nest\n");
+      return false;
+    }
+    if (!isLegal())
+      return false;
+    unsigned TileSize = getTileSize();
+    if (!TileSize) {
+      DEBUG(dbgs() << "LoopTiling: Not profitable\n");
+      return false;
+    }
+
+    ORE.emit(OptimizationRemark(DEBUG_TYPE, "Tiled", Inner->getStartLoc(),
+                                Inner->getHeader())
+             << "tiled loop with tile size " << utostr(TileSize));
+    tile(TileSize);
+    ++NumLoopsTiled;
+    return true;
+  }
+
+private:
+  /// \brief Returns the only phi of \p BB, or null.
+  static PHINode *getSinglePHI(BasicBlock *BB) {
+    auto *PN = dyn_cast<PHINode>(BB->begin());
+    if (!PN || isa<PHINode>(PN->getNextNode()))
+      return nullptr;
+    return PN;
+  }
+
+  bool isPerfectNest() {
+    if (!Outer->isLoopSimplifyForm() || !Inner->isLoopSimplifyForm() ||
+        Outer->getExitingBlock() != Outer->getLoopLatch() ||
+        !Outer->getExitBlock() ||
+        Inner->getExitingBlock() != Inner->getLoopLatch())
+      return false;
+
+    // The outer loop is re-entered for every tile, so it may not carry any
+    // value from one iteration to the next but its induction variable.
+    PHINode *OuterIV = getSinglePHI(Outer->getHeader());
+    if (!OuterIV || !isa<SCEVAddRecExpr>(SE.getSCEV(OuterIV)))
+      return false;
+
+    // Only the inner loop may access memory, and nothing computed in the nest
+    // may be used outside of the loop that computes it.
+    for (BasicBlock *BB : Outer->blocks())
+      for (Instruction &I : *BB) {
+        if (!isGuaranteedToTransferExecutionToSuccessor(&I))
+          return false;
+        if (auto *CI = dyn_cast<CallInst>(&I))
+          if (CI->isConvergent())
+            return false;
+        if (I.mayReadOrWriteMemory()) {
+          if (!Inner->contains(&I))
+            return false;
+          if (auto *LI = dyn_cast<LoadInst>(&I)) {
+            if (!LI->isSimple())
+              return false;
+          } else if (auto *SI = dyn_cast<StoreInst>(&I)) {
+            if (!SI->isSimple())
+              return false;
+          } else {
+            return false;
+          }
+          Accesses.push_back(&I);
+        }
+        Loop *DefLoop = Inner->contains(&I) ? Inner : Outer;
+        for (User *U : I.users())
+          if (!DefLoop->contains(cast<Instruction>(U)))
+            return false;
+      }
+    if (Accesses.empty())
+      return false;
+
+    // The inner loop must be "for (j = 0; j != End; ++j)".
+    InnerIV = getSinglePHI(Inner->getHeader());
+    if (!InnerIV || !InnerIV->getType()->isIntegerTy())
+      return false;
+    const auto *AR = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(InnerIV));
+    if (!AR || AR->getLoop() != Inner || !AR->isAffine() ||
+        !AR->getStart()->isZero() || !AR->getStepRecurrence(SE)->isOne())
+      return false;
+
+    BasicBlock *InnerLatch = Inner->getLoopLatch();
+    auto *BI = dyn_cast<BranchInst>(InnerLatch->getTerminator());
+    if (!BI || !BI->isConditional())
+      return false;
+    InnerCond = dyn_cast<ICmpInst>(BI->getCondition());
+    if (!InnerCond || !InnerCond->isEquality())
+      return false;
+    unsigned ExitIdx = InnerCond->getPredicate() == ICmpInst::ICMP_EQ ? 0 : 1;
+    if (Inner->contains(BI->getSuccessor(ExitIdx)))
+      return false;
+    Value *IVNext = InnerIV->getIncomingValueForBlock(InnerLatch);
+    if (InnerCond->getOperand(0) == IVNext)
+      InnerEnd = InnerCond->getOperand(1);
+    else if (InnerCond->getOperand(1) == IVNext)
+      InnerEnd = InnerCond->getOperand(0);
+    else
+      return false;
+    return Outer->isLoopInvariant(InnerEnd);
+  }
+
+  /// \brief Moving the strip loop outward runs the iterations (i, j) of a
+  /// tile before the iterations (i', j') of the next tiles, for all i' < i.
+  /// This reverses any dependence from (i', j') to (i, j) with i' < i and
+  /// j' > j.
+  bool isLegal() {
+    unsigned OuterLevel = Outer->getLoopDepth();
+    unsigned InnerLevel = Inner->getLoopDepth();
+    for (unsigned I = 0, E = Accesses.size(); I != E; ++I)
+      for (unsigned J = I; J != E; ++J) {
+        Instruction *Src = Accesses[I], *Dst = Accesses[J];
+        if (!Src->mayWriteToMemory() && !Dst->mayWriteToMemory())
+          continue;
+        auto D = DI.depends(Src, Dst, true);
+        if (!D)
+          continue;
+        if (D->isConfused() || D->getLevels() < InnerLevel) {
+          DEBUG(dbgs() << "LoopTiling: Unknown dependence from " << *Src
+                       << " to " << *Dst << "\n");
+          return false;
+        }
+        unsigned OuterDir = D->getDirection(OuterLevel);
+        unsigned InnerDir = D->getDirection(InnerLevel);
+        if (((OuterDir & Dependence::DVEntry::LT) &&
+             (InnerDir & Dependence::DVEntry::GT)) ||
+            ((OuterDir & Dependence::DVEntry::GT) &&
+             (InnerDir & Dependence::DVEntry::LT))) {
+          DEBUG(dbgs() << "LoopTiling: Dependence from " << *Src << " to "
+                       << *Dst << " prevents tiling\n");
+          return false;
+        }
+      }
+    return true;
+  }
+
+  /// \brief Returns true if \p AR1 and \p AR2 access the same elements a few
+  /// iterations of the outer loop apart, such as A[i][j] and A[i + 1][j].
+  bool haveGroupReuse(const SCEVAddRecExpr *AR1, const SCEVAddRecExpr *AR2,
+                      const SCEV *ElementSize) {
+    // Delinearize both accesses with the same array dimensions.
+    const SCEV *Base = SE.getPointerBase(AR1);
+    const SCEV *Fn1 = SE.getMinusSCEV(AR1, Base);
+    const SCEV *Fn2 = SE.getMinusSCEV(AR2, Base);
+    SmallVector<const SCEV *, 4> Terms;
+    SE.collectParametricTerms(Fn1, Terms);
+    SE.collectParametricTerms(Fn2, Terms);
+    SmallVector<const SCEV *, 4> Sizes;
+    SE.findArrayDimensions(Terms, Sizes, ElementSize);
+    SmallVector<const SCEV *, 4> Subscripts1, Subscripts2;
+    SE.computeAccessFunctions(Fn1, Subscripts1, Sizes);
+    SE.computeAccessFunctions(Fn2, Subscripts2, Sizes);
+    if (Subscripts1.size() >= 2 && Subscripts1.size() == Subscripts2.size()) {
+      bool DiffersOutside = false;
+      for (unsigned I = 0, E = Subscripts1.size(); I != E; ++I) {
+        const auto *Diff = dyn_cast<SCEVConstant>(
+            SE.getMinusSCEV(Subscripts1[I], Subscripts2[I]));
+        if (!Diff)
+          return false;
+        if (I + 1 != E && !Diff->isZero())
+          DiffersOutside = true;
+      }
+      return DiffersOutside;
+    }
+
+    // Arrays with constant dimensions are not delinearized: compare the
+    // distance between the rows with the stride of the outer loop instead.
+    const auto *Row1 = dyn_cast<SCEVAddRecExpr>(AR1->getStart());
+    const auto *Row2 = dyn_cast<SCEVAddRecExpr>(AR2->getStart());
+    if (!Row1 || !Row2 || Row1->getLoop() != Outer ||
+        Row2->getLoop() != Outer || !Row1->isAffine() || !Row2->isAffine() ||
+        Row1->getStepRecurrence(SE) != Row2->getStepRecurrence(SE))
+      return false;
+    const SCEV *RowStride = Row1->getStepRecurrence(SE);
+    const SCEV *Dist = SE.getMinusSCEV(Row1->getStart(), Row2->getStart());
+    for (int K = -2; K <= 2; ++K)
+      if (K && Dist == SE.getMulExpr(RowStride,
+                                     SE.getConstant(RowStride->getType(), K)))
+        return true;
+    return false;
+  }
+
+  /// \brief Returns true if some data is accessed again by a later iteration
+  /// of the outer loop, which tiling keeps in the cache.
+  bool hasOuterReuse() {
+    DenseMap<const SCEV *, SmallVector<Instruction *, 4>> AccessesByBase;
+    for (Instruction *I : Accesses) {
+      const auto *AR =
+          dyn_cast<SCEVAddRecExpr>(SE.getSCEV(getPointerOperand(I)));
+      if (!AR || AR->getLoop() != Inner || !AR->isAffine())
+        continue;
+      // Every iteration of the outer loop walks the same addresses.
+      if (SE.isLoopInvariant(AR->getStart(), Outer) &&
+          SE.isLoopInvariant(AR->getStepRecurrence(SE), Outer))
+        return true;
+      AccessesByBase[SE.getPointerBase(AR)].push_back(I);
+    }
+
+    for (auto &Group : AccessesByBase) {
+      ArrayRef<Instruction *> Insts = Group.second;
+      for (unsigned I = 0, E = Insts.size(); I != E; ++I)
+        for (unsigned J = I + 1; J != E; ++J) {
+          const SCEV *ElementSize = SE.getElementSize(Insts[I]);
+          if (ElementSize != SE.getElementSize(Insts[J]))
+            continue;
+          if (haveGroupReuse(
+                  cast<SCEVAddRecExpr>(SE.getSCEV(getPointerOperand(Insts[I]))),
+                  cast<SCEVAddRecExpr>(SE.getSCEV(getPointerOperand(Insts[J]))),
+                  ElementSize))
+            return true;
+        }
+    }
+    return false;
+  }
+
+  /// \brief Returns the number of inner loop iterations of a tile, or zero
+  /// if tiling is not profitable.
+  unsigned getTileSize() {
+    if (!hasOuterReuse())
+      return 0;
+
+    // A tile of the inner loop touches TileSize elements for each access.
+    // Size it so that one tile fills half of the cache, leaving room for
+    // the data that is not reused.
+    uint64_t BytesPerIteration = 0, MinElementSize = UINT64_MAX;
+    for (Instruction *I : Accesses) {
+      uint64_t Size = DL.getTypeStoreSize(
+          getPointerOperand(I)->getType()->getPointerElementType());
+      BytesPerIteration += Size;
+      MinElementSize = std::min(MinElementSize, Size);
+    }
+    unsigned TileSize = ForceTileSize;
+    if (!TileSize) {
+      unsigned LineSize = TTI.getCacheLineSize();
+      if (!LineSize)
+        LineSize = 64;
+      uint64_t LineElements = std::max<uint64_t>(LineSize / MinElementSize, 1);
+      uint64_t CacheSize = TileCacheSize;
+      if (TileCacheSize.getNumOccurrences() == 0)
+        if (Optional<unsigned> L1DSize =
+                TTI.getCacheSize(TargetTransformInfo::CacheLevel::L1D))
+          CacheSize = *L1DSize;
+      TileSize = PowerOf2Floor(CacheSize / 2 / BytesPerIteration);
+      TileSize = std::max<uint64_t>(TileSize, LineElements);
+    }
+
+    // Nothing to gain if the inner loop fits in a tile anyway.
+    const SCEV *BTC = SE.getBackedgeTakenCount(Inner);
+    if (const auto *ConstBTC = dyn_cast<SCEVConstant>(BTC))
+      if (ConstBTC->getAPInt().ult(TileSize))
+        return 0;
+    return TileSize;
+  }
+
+  void tile(unsigned TileSize) {
+    BasicBlock *Preheader = Outer->getLoopPreheader();
+    BasicBlock *Header = Outer->getHeader();
+    BasicBlock *Latch = Outer->getLoopLatch();
+    BasicBlock *Exit = Outer->getExitBlock();
+    BasicBlock *InnerPreheader = Inner->getLoopPreheader();
+    Function *F = Header->getParent();
+    LLVMContext &Ctx = F->getContext();
+    Type *Ty = InnerIV->getType();
+
+    SE.forgetLoop(Outer);
+    SE.forgetLoop(Inner);
+
+    // tile.header:
+    //   %tile.iv = phi [ 0, %preheader ], [ %tile.end, %tile.latch ]
+    //   %tile.end = min(%tile.iv + TileSize, End)
+    //   br label %outer.header
+    BasicBlock *TileHeader = BasicBlock::Create(Ctx, "tile.header", F, Header);
+    BasicBlock *TileLatch = BasicBlock::Create(Ctx, "tile.latch", F, Exit);
+    Preheader->getTerminator()->replaceUsesOfWith(Header, TileHeader);
+    for (auto I = Header->begin(); auto *PN = dyn_cast<PHINode>(I); ++I)
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Preheader), TileHeader);
+
+    IRBuilder<> B(TileHeader);
+    PHINode *TileIV = B.CreatePHI(Ty, 2, "tile.iv");
+    TileIV->addIncoming(ConstantInt::get(Ty, 0), Preheader);
+    Constant *TileSizeC = ConstantInt::get(Ty, TileSize);
+    // End - %tile.iv does not wrap, and neither does %tile.iv + TileSize when
+    // it is selected.
+    Value *Remaining = B.CreateSub(InnerEnd, TileIV, "tile.remaining");
+    Value *IsFull = B.CreateICmpUGT(Remaining, TileSizeC, "tile.full");
+    Value *TileEnd =
+        B.CreateSelect(IsFull, B.CreateNUWAdd(TileIV, TileSizeC, "tile.next"),
+                       InnerEnd, "tile.end");
+    B.CreateBr(Header);
+
+    // tile.latch:
+    //   br (%tile.end == End), label %exit, label %tile.header
+    Latch->getTerminator()->replaceUsesOfWith(Exit, TileLatch);
+    for (auto I = Exit->begin(); auto *PN = dyn_cast<PHINode>(I); ++I)
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Latch), TileLatch);
+    B.SetInsertPoint(TileLatch);
+    B.CreateCondBr(B.CreateICmpEQ(TileEnd, InnerEnd, "tile.done"), Exit,
+                   TileHeader);
+    TileIV->addIncoming(TileEnd, TileLatch);
+
+    // The inner loop now walks one tile.
+    InnerIV->setIncomingValue(InnerIV->getBasicBlockIndex(InnerPreheader),
+                              TileIV);
+    if (!InnerCond->hasOneUse()) {
+      auto *NewCond = cast<ICmpInst>(InnerCond->clone());
+      NewCond->insertBefore(Inner->getLoopLatch()->getTerminator());
+      Inner->getLoopLatch()->getTerminator()->replaceUsesOfWith(InnerCond,
+                                                                NewCond);
+      InnerCond = NewCond;
+    }
+    InnerCond->replaceUsesOfWith(InnerEnd, TileEnd);
+
+    // The tile loop becomes the parent of the outer loop.
+    Loop *TileLoop = new Loop();
+    if (Loop *Parent = Outer->getParentLoop())
+      Parent->replaceChildLoopWith(Outer, TileLoop);
+    else
+      LI.changeTopLevelLoop(Outer, TileLoop);
+    TileLoop->addChildLoop(Outer);
+    TileLoop->addBasicBlockToLoop(TileHeader, LI);
+    for (BasicBlock *BB : Outer->blocks())
+      TileLoop->addBlockEntry(BB);
+    TileLoop->addBasicBlockToLoop(TileLatch, LI);
+
+    DT.recalculate(*F);
+  }
+
+  Loop *Outer;
+  Loop *Inner;
+  LoopInfo &LI;
+  DominatorTree &DT;
+  ScalarEvolution &SE;
+  DependenceInfo &DI;
+  const TargetTransformInfo &TTI;
+  OptimizationRemarkEmitter &ORE;
+  const DataLayout &DL;
+
+  SmallVector<Instruction *, 16> Accesses;
+  PHINode *InnerIV = nullptr;
+  ICmpInst *InnerCond = nullptr;
+  Value *InnerEnd = nullptr;
+};
+} // anonymous namespace
+
+static bool tileLoopNests(LoopInfo &LI, DominatorTree &DT, ScalarEvolution &SE,
+                          DependenceInfo &DI, const TargetTransformInfo &TTI,
+                          OptimizationRemarkEmitter &ORE) {
+  // Collect the nests first: tiling adds loops to the loop forest.
+  SmallVector<Loop *, 8> Worklist;
+  SmallVector<Loop *, 8> Nests;
+  Worklist.append(LI.begin(), LI.end());
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    Worklist.append(L->begin(), L->end());
+    if (L->getSubLoops().size() == 1 && L->getSubLoops()[0]->empty())
+      Nests.push_back(L);
+  }
+
+  bool Changed = false;
+  for (Loop *Outer : Nests)
+    Changed |=
+        LoopTiler(Outer, Outer->getSubLoops()[0], LI, DT, SE, DI, TTI, ORE)
+            .run();
+  return Changed;
+}
+
+namespace {
+class LoopTilingLegacy : public FunctionPass {
+public:
+  static char ID;
+
+  LoopTilingLegacy() : FunctionPass(ID) {
+    initializeLoopTilingLegacyPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipFunction(F))
+      return false;
+
+    auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    auto &DI = getAnalysis<DependenceAnalysisWrapperPass>().getDI();
+    auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+    auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+    return tileLoopNests(LI, DT, SE, DI, TTI, ORE);
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addRequired<DependenceAnalysisWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addPreserved<GlobalsAAWrapperPass>();
+  }
+};
+} // anonymous namespace
+
+PreservedAnalyses LoopTilingPass::run(Function &F,
+                                      FunctionAnalysisManager &AM) {
+  auto &LI = AM.getResult<LoopAnalysis>(F);
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &SE = AM.getResult<ScalarEvolutionAnalysis>(F);
+  auto &DI = AM.getResult<DependenceAnalysis>(F);
+  auto &TTI = AM.getResult<TargetIRAnalysis>(F);
+  auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+
+  if (!tileLoopNests(LI, DT, SE, DI, TTI, ORE))
+    return PreservedAnalyses::all();
+  PreservedAnalyses PA;
+  PA.preserve<LoopAnalysis>();
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<GlobalsAA>();
+  return PA;
+}
+
+char LoopTilingLegacy::ID = 0;
+static const char ltile_name[] = "Loop Tiling";
+
+INITIALIZE_PASS_BEGIN(LoopTilingLegacy, DEBUG_TYPE, ltile_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_END(LoopTilingLegacy, DEBUG_TYPE, ltile_name, false, false)
+
+namespace llvm {
+FunctionPass *createLoopTilingPass() { return new LoopTilingLegacy(); }
+} // end namespace llvm
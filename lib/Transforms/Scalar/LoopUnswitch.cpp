@@ -77,6 +77,15 @@ static cl::opt<unsigned>
 Threshold("loop-unswitch-threshold", cl::desc("Max loop size to unswitch"),
           cl::init(100), cl::Hidden);
 
+// Unswitching a loop also clones its subloops, which get their own quota when
+// they are visited later. Bound the instructions cloned in total on behalf of
+// one loop of the original function, including copies of copies.
+static cl::opt<unsigned>
+MaxClonedSize("loop-unswitch-max-cloned-size",
+              cl::desc("Max number of instructions cloned when unswitching "
+                       "a loop and the loops cloned from it"),
+              cl::init(1000), cl::Hidden);
+
 static cl::opt<bool>
 LoopUnswitchWithBlockFrequency("loop-unswitch-with-block-frequency",
     cl::init(false), cl::Hidden,
@@ -103,6 +112,9 @@ namespace {
       unsigned CanBeUnswitchedCount;
       unsigned WasUnswitchedCount;
       unsigned SizeEstimation;
+      /// Index into ClonedSizes of the loop of the original function this
+      /// loop was cloned from, or of this loop itself.
+      unsigned Origin;
       UnswitchedValsMap UnswitchedVals;
     };
 
@@ -112,6 +124,10 @@ namespace {
     typedef LoopPropsMap::iterator LoopPropsMapIt;
 
     LoopPropsMap LoopsProperties;
+    /// Number of instructions cloned so far on behalf of each original loop.
+    SmallVector<unsigned, 8> ClonedSizes;
+    /// The origin of loops created by cloning that have not been counted yet.
+    DenseMap<const Loop *, unsigned> ClonedLoopOrigins;
     UnswitchedValsMap *CurLoopInstructions;
     LoopProperties *CurrentLoopProperties;
 
@@ -161,6 +177,13 @@ namespace {
     // Note, that new loop data is stored inside the VMap.
     void cloneData(const Loop *NewLoop, const Loop *OldLoop,
                    const ValueToValueMapTy &VMap);
+
+    // Forget the origin of a cloned loop that was deleted before it was
+    // counted.
+    void forgetClonedLoop(const Loop *L);
+
+    // Clean the cloning data of the current function.
+    void forgetClonedLoops();
   };
 
   class LoopUnswitch : public LoopPass {
@@ -211,6 +234,16 @@ namespace {
     bool runOnLoop(Loop *L, LPPassManager &LPM) override;
     bool processCurrentLoop();
 
+    // Loops are only cloned from loops of the same function.
+    bool doFinalization() override {
+      BranchesInfo.forgetClonedLoops();
+      return false;
+    }
+
+    void deleteAnalysisLoop(Loop *L) override {
+      BranchesInfo.forgetClonedLoop(L);
+    }
+
     /// This transformation requires natural loop information & requires that
     /// loop preheaders be inserted into the CFG.
     ///
@@ -290,6 +323,14 @@ bool LUAnalysisCache::countLoop(const Loop *L, const TargetTransformInfo &TTI,
       Metrics.analyzeBasicBlock(*I, TTI, EphValues);
 
     Props.SizeEstimation = Metrics.NumInsts;
+    auto OriginIt = ClonedLoopOrigins.find(L);
+    if (OriginIt != ClonedLoopOrigins.end()) {
+      Props.Origin = OriginIt->second;
+      ClonedLoopOrigins.erase(OriginIt);
+    } else {
+      Props.Origin = ClonedSizes.size();
+      ClonedSizes.push_back(0);
+    }
     Props.CanBeUnswitchedCount = MaxSize / (Props.SizeEstimation);
     Props.WasUnswitchedCount = 0;
     MaxSize -= Props.SizeEstimation * Props.CanBeUnswitchedCount;
@@ -325,6 +366,17 @@ void LUAnalysisCache::forgetLoop(const Loop *L) {
   CurLoopInstructions = nullptr;
 }
 
+// Forget the origin of a cloned loop that was deleted before it was counted.
+void LUAnalysisCache::forgetClonedLoop(const Loop *L) {
+  ClonedLoopOrigins.erase(L);
+}
+
+// Clean the cloning data of the current function.
+void LUAnalysisCache::forgetClonedLoops() {
+  ClonedSizes.clear();
+  ClonedLoopOrigins.clear();
+}
+
 // Mark case value as unswitched.
 // Since SI instruction can be partly unswitched, in order to avoid
 // extra unswitching in cloned loops keep track all unswitched values.
@@ -338,7 +390,10 @@ bool LUAnalysisCache::isUnswitched(const SwitchInst *SI, const Value *V) {
 }
 
 bool LUAnalysisCache::CostAllowsUnswitching() {
-  return CurrentLoopProperties->CanBeUnswitchedCount > 0;
+  return CurrentLoopProperties->CanBeUnswitchedCount > 0 &&
+         ClonedSizes[CurrentLoopProperties->Origin] +
+                 CurrentLoopProperties->SizeEstimation <=
+             MaxClonedSize;
 }
 
 // Clone all loop-unswitch related loop properties.
@@ -362,6 +417,16 @@ void LUAnalysisCache::cloneData(const Loop *NewLoop, const Loop *OldLoop,
 
   NewLoopProps.SizeEstimation = OldLoopProps.SizeEstimation;
 
+  // The clone and its subloops are charged to the same original loop.
+  NewLoopProps.Origin = OldLoopProps.Origin;
+  ClonedSizes[OldLoopProps.Origin] += OldLoopProps.SizeEstimation;
+  SmallVector<const Loop *, 8> SubLoops(NewLoop->begin(), NewLoop->end());
+  while (!SubLoops.empty()) {
+    const Loop *SubLoop = SubLoops.pop_back_val();
+    ClonedLoopOrigins[SubLoop] = OldLoopProps.Origin;
+    SubLoops.append(SubLoop->begin(), SubLoop->end());
+  }
+
   // Clone unswitched values info:
   // for new loop switches we clone info about values that was
   // already unswitched and has redundant successors.
@@ -15,6 +15,7 @@
 #include "llvm/Pass.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/DenseSet.h"
@@ -137,19 +138,24 @@ INITIALIZE_PASS_END(RewriteStatepointsForGC, "rewrite-statepoints-for-gc",
 
 namespace {
 struct GCPtrLivenessData {
+  /// The GC pointers defined in the function, in definition order.  Bit N of
+  /// the sets below stands for Values[N].
+  SmallVector<Value *, 64> Values;
+  DenseMap<Value *, unsigned> ValueIndex;
+
   /// Values defined in this block.
-  MapVector<BasicBlock *, SetVector<Value *>> KillSet;
+  DenseMap<BasicBlock *, BitVector> KillSet;
   /// Values used in this block (and thus live); does not included values
   /// killed within this block.
-  MapVector<BasicBlock *, SetVector<Value *>> LiveSet;
+  DenseMap<BasicBlock *, BitVector> LiveSet;
 
   /// Values live into this basic block (i.e. used by any
   /// instruction in this basic block or ones reachable from here)
-  MapVector<BasicBlock *, SetVector<Value *>> LiveIn;
+  DenseMap<BasicBlock *, BitVector> LiveIn;
 
   /// Values live out of this basic block (i.e. live into
   /// any successor block)
-  MapVector<BasicBlock *, SetVector<Value *>> LiveOut;
+  DenseMap<BasicBlock *, BitVector> LiveOut;
 };
 
 // The type of the internal cache used inside the findBasePointers family
@@ -2478,17 +2484,32 @@ bool RewriteStatepointsForGC::runOnFunction(Function &F) {
 // liveness computation via standard dataflow
 // -------------------------------------------------------------------
 
-// TODO: Consider using bitvectors for liveness, the set of potentially
-// interesting values should be small and easy to pre-compute.
+/// Return true if \p V is a GC pointer whose liveness has to be tracked.
+static bool isTrackedGCPointer(Value *V) {
+  // The choice to exclude all things constant here is slightly subtle.
+  // There are two independent reasons:
+  // - We assume that things which are constant (from LLVM's definition)
+  // do not move at runtime.  For example, the address of a global
+  // variable is fixed, even though it's contents may not be.
+  // - Second, we can't disallow arbitrary inttoptr constants even
+  // if the language frontend does.  Optimization passes are free to
+  // locally exploit facts without respect to global reachability.  This
+  // can create sections of code which are dynamically unreachable and
+  // contain just about anything.  (see constants.ll in tests)
+  return isHandledGCPointerType(V->getType()) && !isa<Constant>(V);
+}
 
 /// Compute the live-in set for the location rbegin starting from
 /// the live-out set of the basic block
 static void computeLiveInValues(BasicBlock::reverse_iterator Begin,
                                 BasicBlock::reverse_iterator End,
-                                SetVector<Value *> &LiveTmp) {
+                                BitVector &LiveTmp,
+                                const GCPtrLivenessData &Data) {
   for (auto &I : make_range(Begin, End)) {
     // KILL/Def - Remove this definition from LiveIn
-    LiveTmp.remove(&I);
+    auto Def = Data.ValueIndex.find(&I);
+    if (Def != Data.ValueIndex.end())
+      LiveTmp.reset(Def->second);
 
     // Don't consider *uses* in PHI nodes, we handle their contribution to
     // predecessor blocks when we seed the LiveOut sets
@@ -2499,24 +2520,16 @@ static void computeLiveInValues(BasicBlock::reverse_iterator Begin,
     for (Value *V : I.operands()) {
       assert(!isUnhandledGCPointerType(V->getType()) &&
              "support for FCA unimplemented");
-      if (isHandledGCPointerType(V->getType()) && !isa<Constant>(V)) {
-        // The choice to exclude all things constant here is slightly subtle.
-        // There are two independent reasons:
-        // - We assume that things which are constant (from LLVM's definition)
-        // do not move at runtime.  For example, the address of a global
-        // variable is fixed, even though it's contents may not be.
-        // - Second, we can't disallow arbitrary inttoptr constants even
-        // if the language frontend does.  Optimization passes are free to
-        // locally exploit facts without respect to global reachability.  This
-        // can create sections of code which are dynamically unreachable and
-        // contain just about anything.  (see constants.ll in tests)
-        LiveTmp.insert(V);
+      if (isTrackedGCPointer(V)) {
+        assert(Data.ValueIndex.count(V) && "use of an untracked GC pointer");
+        LiveTmp.set(Data.ValueIndex.find(V)->second);
       }
     }
   }
 }
 
-static void computeLiveOutSeed(BasicBlock *BB, SetVector<Value *> &LiveTmp) {
+static void computeLiveOutSeed(BasicBlock *BB, BitVector &LiveTmp,
+                               const GCPtrLivenessData &Data) {
   for (BasicBlock *Succ : successors(BB)) {
     for (auto &I : *Succ) {
       PHINode *PN = dyn_cast<PHINode>(&I);
@@ -2526,27 +2539,32 @@ static void computeLiveOutSeed(BasicBlock *BB, SetVector<Value *> &LiveTmp) {
       Value *V = PN->getIncomingValueForBlock(BB);
       assert(!isUnhandledGCPointerType(V->getType()) &&
              "support for FCA unimplemented");
-      if (isHandledGCPointerType(V->getType()) && !isa<Constant>(V))
-        LiveTmp.insert(V);
+      if (isTrackedGCPointer(V)) {
+        assert(Data.ValueIndex.count(V) && "use of an untracked GC pointer");
+        LiveTmp.set(Data.ValueIndex.find(V)->second);
+      }
     }
   }
 }
 
-static SetVector<Value *> computeKillSet(BasicBlock *BB) {
-  SetVector<Value *> KillSet;
-  for (Instruction &I : *BB)
-    if (isHandledGCPointerType(I.getType()))
-      KillSet.insert(&I);
+static BitVector computeKillSet(BasicBlock *BB, const GCPtrLivenessData &Data) {
+  BitVector KillSet(Data.Values.size());
+  for (Instruction &I : *BB) {
+    auto Def = Data.ValueIndex.find(&I);
+    if (Def != Data.ValueIndex.end())
+      KillSet.set(Def->second);
+  }
   return KillSet;
 }
 
 #ifndef NDEBUG
 /// Check that the items in 'Live' dominate 'TI'.  This is used as a basic
 /// sanity check for the liveness computation.
-static void checkBasicSSA(DominatorTree &DT, SetVector<Value *> &Live,
-                          TerminatorInst *TI, bool TermOkay = false) {
-  for (Value *V : Live) {
-    if (auto *I = dyn_cast<Instruction>(V)) {
+static void checkBasicSSA(DominatorTree &DT, const BitVector &Live,
+                          const GCPtrLivenessData &Data, TerminatorInst *TI,
+                          bool TermOkay = false) {
+  for (int Idx = Live.find_first(); Idx != -1; Idx = Live.find_next(Idx)) {
+    if (auto *I = dyn_cast<Instruction>(Data.Values[Idx])) {
       // The terminator can be a member of the LiveOut set.  LLVM's definition
       // of instruction dominance states that V does not dominate itself.  As
       // such, we need to special case this to allow it.
@@ -2563,34 +2581,56 @@ static void checkBasicSSA(DominatorTree &DT, SetVector<Value *> &Live,
 /// a def.
 static void checkBasicSSA(DominatorTree &DT, GCPtrLivenessData &Data,
                           BasicBlock &BB) {
-  checkBasicSSA(DT, Data.LiveSet[&BB], BB.getTerminator());
-  checkBasicSSA(DT, Data.LiveOut[&BB], BB.getTerminator(), true);
-  checkBasicSSA(DT, Data.LiveIn[&BB], BB.getTerminator());
+  checkBasicSSA(DT, Data.LiveSet[&BB], Data, BB.getTerminator());
+  checkBasicSSA(DT, Data.LiveOut[&BB], Data, BB.getTerminator(), true);
+  checkBasicSSA(DT, Data.LiveIn[&BB], Data, BB.getTerminator());
 }
 #endif
 
 static void computeLiveInValues(DominatorTree &DT, Function &F,
                                 GCPtrLivenessData &Data) {
+  // Number the GC pointers so that the sets can be bit vectors.  Only values
+  // defined in the function can be live across a safepoint, so this is
+  // usually a small fraction of the values in the function.
+  Data.Values.clear();
+  Data.ValueIndex.clear();
+  auto Track = [&](Value *V) {
+    if (isTrackedGCPointer(V)) {
+      Data.ValueIndex[V] = Data.Values.size();
+      Data.Values.push_back(V);
+    }
+  };
+  for (Argument &A : F.args())
+    Track(&A);
+  for (Instruction &I : instructions(F))
+    Track(&I);
+  const unsigned NumValues = Data.Values.size();
+
+  Data.KillSet.clear();
+  Data.LiveSet.clear();
+  Data.LiveIn.clear();
+  Data.LiveOut.clear();
   SmallSetVector<BasicBlock *, 32> Worklist;
 
   // Seed the liveness for each individual block
   for (BasicBlock &BB : F) {
-    Data.KillSet[&BB] = computeKillSet(&BB);
-    Data.LiveSet[&BB].clear();
-    computeLiveInValues(BB.rbegin(), BB.rend(), Data.LiveSet[&BB]);
-
-#ifndef NDEBUG
-    for (Value *Kill : Data.KillSet[&BB])
-      assert(!Data.LiveSet[&BB].count(Kill) && "live set contains kill");
-#endif
-
-    Data.LiveOut[&BB] = SetVector<Value *>();
-    computeLiveOutSeed(&BB, Data.LiveOut[&BB]);
-    Data.LiveIn[&BB] = Data.LiveSet[&BB];
-    Data.LiveIn[&BB].set_union(Data.LiveOut[&BB]);
-    Data.LiveIn[&BB].set_subtract(Data.KillSet[&BB]);
-    if (!Data.LiveIn[&BB].empty())
+    BitVector KillSet = computeKillSet(&BB, Data);
+    BitVector LiveSet(NumValues);
+    computeLiveInValues(BB.rbegin(), BB.rend(), LiveSet, Data);
+    assert(!LiveSet.anyCommon(KillSet) && "live set contains kill");
+
+    BitVector LiveOut(NumValues);
+    computeLiveOutSeed(&BB, LiveOut, Data);
+    BitVector LiveIn = LiveSet;
+    LiveIn |= LiveOut;
+    LiveIn.reset(KillSet);
+    if (LiveIn.any())
       Worklist.insert(pred_begin(&BB), pred_end(&BB));
+
+    Data.KillSet[&BB] = std::move(KillSet);
+    Data.LiveSet[&BB] = std::move(LiveSet);
+    Data.LiveOut[&BB] = std::move(LiveOut);
+    Data.LiveIn[&BB] = std::move(LiveIn);
   }
 
   // Propagate that liveness until stable
@@ -2599,31 +2639,30 @@ static void computeLiveInValues(DominatorTree &DT, Function &F,
 
     // Compute our new liveout set, then exit early if it hasn't changed despite
     // the contribution of our successor.
-    SetVector<Value *> LiveOut = Data.LiveOut[BB];
-    const auto OldLiveOutSize = LiveOut.size();
+    assert(Data.LiveOut.count(BB));
+    BitVector &LiveOut = Data.LiveOut.find(BB)->second;
+    bool Changed = false;
     for (BasicBlock *Succ : successors(BB)) {
       assert(Data.LiveIn.count(Succ));
-      LiveOut.set_union(Data.LiveIn[Succ]);
+      const BitVector &SuccLiveIn = Data.LiveIn.find(Succ)->second;
+      if (SuccLiveIn.test(LiveOut)) {
+        LiveOut |= SuccLiveIn;
+        Changed = true;
+      }
     }
-    // assert OutLiveOut is a subset of LiveOut
-    if (OldLiveOutSize == LiveOut.size()) {
-      // If the sets are the same size, then we didn't actually add anything
-      // when unioning our successors LiveIn.  Thus, the LiveIn of this block
-      // hasn't changed.
+    if (!Changed)
       continue;
-    }
-    Data.LiveOut[BB] = LiveOut;
 
     // Apply the effects of this basic block
-    SetVector<Value *> LiveTmp = LiveOut;
-    LiveTmp.set_union(Data.LiveSet[BB]);
-    LiveTmp.set_subtract(Data.KillSet[BB]);
+    BitVector LiveTmp = LiveOut;
+    LiveTmp |= Data.LiveSet.find(BB)->second;
+    LiveTmp.reset(Data.KillSet.find(BB)->second);
 
     assert(Data.LiveIn.count(BB));
-    const SetVector<Value *> &OldLiveIn = Data.LiveIn[BB];
-    // assert: OldLiveIn is a subset of LiveTmp
-    if (OldLiveIn.size() != LiveTmp.size()) {
-      Data.LiveIn[BB] = LiveTmp;
+    BitVector &LiveIn = Data.LiveIn.find(BB)->second;
+    // assert: LiveIn is a subset of LiveTmp
+    if (LiveIn != LiveTmp) {
+      LiveIn = std::move(LiveTmp);
       Worklist.insert(pred_begin(BB), pred_end(BB));
     }
   } // while (!Worklist.empty())
@@ -2643,16 +2682,20 @@ static void findLiveSetAtInst(Instruction *Inst, GCPtrLivenessData &Data,
 
   // Note: The copy is intentional and required
   assert(Data.LiveOut.count(BB));
-  SetVector<Value *> LiveOut = Data.LiveOut[BB];
+  BitVector LiveOut = Data.LiveOut[BB];
 
   // We want to handle the statepoint itself oddly.  It's
   // call result is not live (normal), nor are it's arguments
   // (unless they're used again later).  This adjustment is
   // specifically what we need to relocate
   computeLiveInValues(BB->rbegin(), ++Inst->getIterator().getReverse(),
-                      LiveOut);
-  LiveOut.remove(Inst);
-  Out.insert(LiveOut.begin(), LiveOut.end());
+                      LiveOut, Data);
+  auto Def = Data.ValueIndex.find(Inst);
+  if (Def != Data.ValueIndex.end())
+    LiveOut.reset(Def->second);
+  for (int Idx = LiveOut.find_first(); Idx != -1;
+       Idx = LiveOut.find_next(Idx))
+    Out.insert(Data.Values[Idx]);
 }
 
 static void recomputeLiveInValues(GCPtrLivenessData &RevisedLivenessData,
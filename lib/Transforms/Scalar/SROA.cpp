@@ -75,6 +75,8 @@ STATISTIC(NumPromoted, "Number of allocas promoted to SSA values");
 STATISTIC(NumLoadsSpeculated, "Number of loads speculated to allow promotion");
 STATISTIC(NumDeleted, "Number of instructions deleted");
 STATISTIC(NumVectorized, "Number of vectorized aggregates");
+STATISTIC(NumAllocasTooManySlices,
+          "Number of allocas not split because they have too many slices");
 
 /// Hidden option to enable randomly shuffling the slices to help uncover
 /// instability in their order.
@@ -86,6 +88,14 @@ static cl::opt<bool> SROARandomShuffleSlices("sroa-random-shuffle-slices",
 static cl::opt<bool> SROAStrictInbounds("sroa-strict-inbounds", cl::init(false),
                                         cl::Hidden);
 
+/// Partitioning and rewriting an alloca is superlinear in its number of
+/// slices, which gets out of hand for huge arrays in generated code.  Allocas
+/// above the limit are left alone, so it is off by default.
+static cl::opt<unsigned> SROAMaxAllocaSlices(
+    "sroa-max-alloca-slices", cl::init(0), cl::Hidden,
+    cl::desc("Maximum number of slices of an alloca that SROA splits "
+             "(0 = no limit)"));
+
 namespace {
 /// \brief A custom IRBuilder inserter which prefixes all names, but only in
 /// Assert builds.
@@ -4101,6 +4111,13 @@ bool SROA::runOnAlloca(AllocaInst &AI) {
   if (AS.isEscaped())
     return Changed;
 
+  unsigned NumSlices = std::distance(AS.begin(), AS.end());
+  if (SROAMaxAllocaSlices && NumSlices > SROAMaxAllocaSlices) {
+    DEBUG(dbgs() << "  Too many slices, not splitting\n");
+    ++NumAllocasTooManySlices;
+    return Changed;
+  }
+
   // Delete all the dead users of this alloca before splitting and rewriting it.
   for (Instruction *DeadUser : AS.getDeadUsers()) {
     // Free up everything used by this instruction.
@@ -35,6 +35,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/Scalar.h"
@@ -132,7 +133,7 @@ static bool iterativelySimplifyCFG(Function &F, const TargetTransformInfo &TTI,
                                    AssumptionCache *AC,
                                    unsigned BonusInstThreshold) {
   bool Changed = false;
-  bool LocalChange = true;
+  bool LocalChange;
 
   SmallVector<std::pair<const BasicBlock *, const BasicBlock *>, 32> Edges;
   FindFunctionBackedges(F, Edges);
@@ -140,17 +141,49 @@ static bool iterativelySimplifyCFG(Function &F, const TargetTransformInfo &TTI,
   for (unsigned i = 0, e = Edges.size(); i != e; ++i)
     LoopHeaders.insert(const_cast<BasicBlock *>(Edges[i].second));
 
-  while (LocalChange) {
+  // Simplifying a block can only enable further simplifications around it, so
+  // after the first sweep only revisit the blocks next to a change. The set
+  // may hold pointers to deleted blocks; they are never dereferenced. Once a
+  // sweep changes nothing, a full sweep confirms that nothing was missed.
+  SmallPtrSet<BasicBlock *, 32> Dirty;
+  bool FullSweep = true;
+  while (true) {
+    if (FullSweep)
+      for (BasicBlock &BB : F)
+        Dirty.insert(&BB);
     LocalChange = false;
 
     // Loop over all of the basic blocks and remove them if they are unneeded.
     for (Function::iterator BBIt = F.begin(); BBIt != F.end(); ) {
-      if (SimplifyCFG(&*BBIt++, TTI, BonusInstThreshold, AC, &LoopHeaders)) {
+      BasicBlock *BB = &*BBIt++;
+      if (!Dirty.erase(BB))
+        continue;
+
+      SmallVector<BasicBlock *, 8> Neighbors(pred_begin(BB), pred_end(BB));
+      Neighbors.append(succ_begin(BB), succ_end(BB));
+      WeakVH BBHandle(BB);
+      if (SimplifyCFG(BB, TTI, BonusInstThreshold, AC, &LoopHeaders)) {
         LocalChange = true;
         ++NumSimpl;
+
+        Dirty.insert(Neighbors.begin(), Neighbors.end());
+        if (BBHandle) {
+          Dirty.insert(BB);
+          Dirty.insert(pred_begin(BB), pred_end(BB));
+          Dirty.insert(succ_begin(BB), succ_end(BB));
+        }
       }
     }
     Changed |= LocalChange;
+
+    if (LocalChange)
+      FullSweep = false;
+    else if (FullSweep)
+      break;
+    else {
+      Dirty.clear();
+      FullSweep = true;
+    }
   }
   return Changed;
 }
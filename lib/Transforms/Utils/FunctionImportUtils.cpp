@@ -189,7 +189,30 @@ FunctionImportGlobalProcessing::getLinkage(const GlobalValue *SGV) {
   llvm_unreachable("unknown linkage type");
 }
 
+// Return the summary of global variable \p GV if the thin link found that
+// it is only ever read or only ever written, or null.
+static const GlobalVarSummary *
+getPropagatedVarSummary(const GlobalVariable &GV,
+                        const ModuleSummaryIndex &Index) {
+  if (GV.isDeclaration() || GV.isExternallyInitialized())
+    return nullptr;
+  auto SummaryList = Index.findGlobalValueSummaryList(GV.getGUID());
+  if (SummaryList == Index.end())
+    return nullptr;
+  // The thin link gives every copy of a variable the same attributes.
+  for (auto &Summary : SummaryList->second)
+    if (auto *GVS = dyn_cast<GlobalVarSummary>(Summary.get()))
+      return GVS->isReadOnly() || GVS->isWriteOnly() ? GVS : nullptr;
+  return nullptr;
+}
+
 void FunctionImportGlobalProcessing::processGlobalForThinLTO(GlobalValue &GV) {
+  // Look the summary up before any renaming changes the GUID.
+  const GlobalVarSummary *VarSummary = nullptr;
+  if (auto *GVar = dyn_cast<GlobalVariable>(&GV))
+    if (!isPerformingImport() || GlobalsToImport->count(GVar))
+      VarSummary = getPropagatedVarSummary(*GVar, ImportIndex);
+
   if (GV.hasLocalLinkage() &&
       (doPromoteLocalToGlobal(&GV) || isPerformingImport())) {
     GV.setName(getName(&GV));
@@ -211,6 +234,18 @@ void FunctionImportGlobalProcessing::processGlobalForThinLTO(GlobalValue &GV) {
            "Expected comdat on definition (possibly available external)");
     GO->setComdat(nullptr);
   }
+
+  // Nothing in the program writes a read-only variable, so loads from it,
+  // including from imported copies, can be folded. Nothing reads a
+  // write-only variable, so its initial value does not matter.
+  if (VarSummary) {
+    auto *GVar = cast<GlobalVariable>(&GV);
+    if (VarSummary->isReadOnly())
+      GVar->setConstant(true);
+    else
+      GVar->setInitializer(
+          Constant::getNullValue(GVar->getType()->getElementType()));
+  }
 }
 
 void FunctionImportGlobalProcessing::processGlobalsForThinLTO() {
@@ -19,7 +19,9 @@
 #include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/Analysis/CallGraph.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalAlias.h"
@@ -30,6 +32,7 @@
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include <functional>
 #include <queue>
 
 using namespace llvm;
@@ -40,24 +43,23 @@ typedef DenseMap<const Comdat *, const GlobalValue *> ComdatMembersType;
 typedef DenseMap<const GlobalValue *, unsigned> ClusterIDMapType;
 }
 
-static void addNonConstUser(ClusterMapType &GVtoClusterMap,
-                            const GlobalValue *GV, const User *U) {
+// Returns the global value that a non-constant user belongs to.
+static const GlobalValue *getNonConstUserGlobalValue(const User *U) {
   assert((!isa<Constant>(U) || isa<GlobalValue>(U)) && "Bad user");
 
-  if (const Instruction *I = dyn_cast<Instruction>(U)) {
-    const GlobalValue *F = I->getParent()->getParent();
-    GVtoClusterMap.unionSets(GV, F);
-  } else if (isa<GlobalIndirectSymbol>(U) || isa<Function>(U) ||
-             isa<GlobalVariable>(U)) {
-    GVtoClusterMap.unionSets(GV, cast<GlobalValue>(U));
-  } else {
-    llvm_unreachable("Underimplemented use case");
-  }
+  if (const Instruction *I = dyn_cast<Instruction>(U))
+    return I->getParent()->getParent();
+  if (isa<GlobalIndirectSymbol>(U) || isa<Function>(U) ||
+      isa<GlobalVariable>(U))
+    return cast<GlobalValue>(U);
+  llvm_unreachable("Underimplemented use case");
 }
 
-// Adds all GlobalValue users of V to the same cluster as GV.
-static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
-                                   const GlobalValue *GV, const Value *V) {
+// Calls Fn on the global value of every user of V, looking through constants
+// that are not global values.
+static void
+forEachGlobalValueUser(const Value *V,
+                       function_ref<void(const GlobalValue *)> Fn) {
   for (auto *U : V->users()) {
     SmallVector<const User *, 4> Worklist;
     Worklist.push_back(U);
@@ -68,17 +70,152 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
         Worklist.append(UU->user_begin(), UU->user_end());
         continue;
       }
-      addNonConstUser(GVtoClusterMap, GV, UU);
+      Fn(getNonConstUserGlobalValue(UU));
     }
   }
 }
 
+// Adds all GlobalValue users of V to the same cluster as GV.
+static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
+                                   const GlobalValue *GV, const Value *V) {
+  forEachGlobalValueUser(V, [&](const GlobalValue *U) {
+    GVtoClusterMap.unionSets(GV, U);
+  });
+}
+
+// Estimate the work of code generating GV: the number of instructions of a
+// function, and a nominal one for anything else.
+static uint64_t getCodeGenWeight(const GlobalValue *GV) {
+  uint64_t Weight = 1;
+  if (const Function *F = dyn_cast<Function>(GV))
+    for (const BasicBlock &BB : *F)
+      Weight += BB.size();
+  return Weight;
+}
+
+// Assign every cluster to a partition, heaviest cluster first, and number the
+// partitions from the heaviest to the lightest.
+//
+// A cluster goes to the partition holding most of the clusters it references
+// or is referenced by, to keep calls and other references within a partition,
+// as long as that keeps the partition within about 10% of an even share of
+// the total weight. Otherwise it goes to the lightest partition so far.
+static void balanceBySize(ClusterMapType &GVtoClusterMap,
+                          ClusterIDMapType &ClusterIDMap, unsigned N) {
+  typedef std::pair<uint64_t, ClusterMapType::iterator> SortType;
+  SmallVector<SortType, 64> Sets;
+  for (ClusterMapType::iterator I = GVtoClusterMap.begin(),
+                                E = GVtoClusterMap.end(); I != E; ++I) {
+    if (!I->isLeader())
+      continue;
+    uint64_t Weight = 0;
+    for (ClusterMapType::member_iterator MI = GVtoClusterMap.member_begin(I),
+                                         ME = GVtoClusterMap.member_end();
+         MI != ME; ++MI)
+      Weight += getCodeGenWeight(*MI);
+    Sets.push_back(std::make_pair(Weight, I));
+  }
+
+  // To guarantee determinism, break ties by the leader's name.
+  std::sort(Sets.begin(), Sets.end(), [](const SortType &a, const SortType &b) {
+    if (a.first == b.first)
+      return a.second->getData()->getName() > b.second->getData()->getName();
+    return a.first > b.first;
+  });
+
+  // Number the clusters in the order they are placed, and record which
+  // clusters reference each other.
+  DenseMap<const GlobalValue *, unsigned> ClusterOf;
+  uint64_t TotalWeight = 0;
+  for (unsigned I = 0, E = Sets.size(); I != E; ++I) {
+    TotalWeight += Sets[I].first;
+    for (ClusterMapType::member_iterator
+             MI = GVtoClusterMap.member_begin(Sets[I].second),
+             ME = GVtoClusterMap.member_end();
+         MI != ME; ++MI)
+      ClusterOf[*MI] = I;
+  }
+  std::vector<SmallVector<unsigned, 4>> Neighbors(Sets.size());
+  for (auto &Entry : ClusterOf) {
+    unsigned From = Entry.second;
+    forEachGlobalValueUser(Entry.first, [&](const GlobalValue *U) {
+      auto It = ClusterOf.find(U);
+      if (It == ClusterOf.end() || It->second == From)
+        return;
+      Neighbors[From].push_back(It->second);
+      Neighbors[It->second].push_back(From);
+    });
+  }
+
+  uint64_t Cap = TotalWeight / N + TotalWeight / (10 * N) + 1;
+  std::vector<uint64_t> Load(N, 0);
+  std::vector<unsigned> PartitionOf(Sets.size(), N);
+  for (unsigned I = 0, E = Sets.size(); I != E; ++I) {
+    uint64_t Weight = Sets[I].first;
+
+    // By default, the lightest partition, lowest number first.
+    unsigned Best = 0;
+    for (unsigned P = 1; P < N; ++P)
+      if (Load[P] < Load[Best])
+        Best = P;
+
+    // Prefer the partition with the most references to this cluster, if it
+    // has room for it.
+    DenseMap<unsigned, unsigned> Affinity;
+    for (unsigned Neighbor : Neighbors[I])
+      if (PartitionOf[Neighbor] != N)
+        ++Affinity[PartitionOf[Neighbor]];
+    unsigned BestAffinity = 0;
+    for (auto &A : Affinity) {
+      unsigned P = A.first;
+      if (Load[P] + Weight > Cap)
+        continue;
+      if (A.second > BestAffinity ||
+          (A.second == BestAffinity &&
+           std::make_pair(Load[P], P) < std::make_pair(Load[Best], Best))) {
+        Best = P;
+        BestAffinity = A.second;
+      }
+    }
+
+    DEBUG(dbgs() << "Root[" << Best << "] weight(" << Weight << ") affinity("
+                 << BestAffinity << ") ----> "
+                 << Sets[I].second->getData()->getName() << "\n");
+    PartitionOf[I] = Best;
+    Load[Best] += Weight;
+    for (ClusterMapType::member_iterator
+             MI = GVtoClusterMap.member_begin(Sets[I].second),
+             ME = GVtoClusterMap.member_end();
+         MI != ME; ++MI)
+      ClusterIDMap[*MI] = Best;
+  }
+
+  // Partitions are handed out in order, so callers that code generate them
+  // in parallel start on the heaviest ones first and don't end up waiting for
+  // one that was started last.
+  typedef std::pair<uint64_t, unsigned> PartitionType;
+  std::vector<PartitionType> Partitions;
+  for (unsigned I = 0; I < N; ++I)
+    Partitions.push_back(std::make_pair(Load[I], I));
+  std::sort(Partitions.begin(), Partitions.end(),
+            [](const PartitionType &a, const PartitionType &b) {
+              if (a.first == b.first)
+                return a.second < b.second;
+              return a.first > b.first;
+            });
+  std::vector<unsigned> Rank(N);
+  for (unsigned I = 0; I < N; ++I)
+    Rank[Partitions[I].second] = I;
+  for (auto &Entry : ClusterIDMap)
+    Entry.second = Rank[Entry.second];
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
 // thread balancing for the backend codegen step.
 static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
-                           unsigned N) {
+                           unsigned N, bool BalanceBySize) {
   // At this point module should have the proper mix of globals and locals.
   // As we attempt to partition this module, we must not change any
   // locals to globals.
@@ -86,13 +223,18 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   ClusterMapType GVtoClusterMap;
   ComdatMembersType ComdatMembers;
 
-  auto recordGVSet = [&GVtoClusterMap, &ComdatMembers](GlobalValue &GV) {
+  auto recordGVSet = [&](GlobalValue &GV) {
     if (GV.isDeclaration())
       return;
 
     if (!GV.hasName())
       GV.setName("__llvmsplit_unnamed");
 
+    // When balancing by size, every definition is placed explicitly rather
+    // than by the hash of its name.
+    if (BalanceBySize)
+      GVtoClusterMap.insert(&GV);
+
     // Comdat groups must not be partitioned. For comdat groups that contain
     // locals, record all their members here so we can keep them together.
     // Comdat groups that only contain external globals are already handled by
@@ -129,6 +271,26 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   std::for_each(M->global_begin(), M->global_end(), recordGVSet);
   std::for_each(M->alias_begin(), M->alias_end(), recordGVSet);
 
+  if (BalanceBySize) {
+    // Keep strongly connected components of the call graph together, for
+    // the locality of the calls between them.
+    CallGraph CG(*M);
+    for (scc_iterator<CallGraph *> I = scc_begin(&CG); !I.isAtEnd(); ++I) {
+      const Function *Leader = nullptr;
+      for (CallGraphNode *CGN : *I) {
+        const Function *F = CGN->getFunction();
+        if (!F || F->isDeclaration())
+          continue;
+        if (Leader)
+          GVtoClusterMap.unionSets(Leader, F);
+        else
+          Leader = F;
+      }
+    }
+    balanceBySize(GVtoClusterMap, ClusterIDMap, N);
+    return;
+  }
+
   // Assigned all GVs to merged clusters while balancing number of objects in
   // each.
   auto CompareClusters = [](const std::pair<unsigned, unsigned> &a,
@@ -228,7 +390,7 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, bool BalanceBySize) {
   if (!PreserveLocals) {
     for (Function &F : *M)
       externalize(&F);
@@ -243,7 +405,7 @@ void llvm::SplitModule(
   // This performs splitting without a need for externalization, which might not
   // always be possible.
   ClusterIDMapType ClusterIDMap;
-  findPartitions(M.get(), ClusterIDMap, N);
+  findPartitions(M.get(), ClusterIDMap, N, BalanceBySize);
 
   // FIXME: We should be able to reuse M as the last partition instead of
   // cloning it.
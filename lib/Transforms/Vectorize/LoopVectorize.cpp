@@ -118,6 +118,12 @@ static cl::opt<unsigned> TinyTripCountVectorThreshold(
              "trip count that is smaller than this "
              "value."));
 
+static cl::opt<bool> VectorizeTinyTripCountLoops(
+    "vectorize-tiny-trip-count-loops", cl::init(false), cl::Hidden,
+    cl::desc("Vectorize loops with a trip count below "
+             "vectorizer-min-trip-count if the vector body covers every "
+             "iteration, without runtime checks or a scalar tail."));
+
 static cl::opt<bool> MaximizeBandwidth(
     "vectorizer-maximize-bandwidth", cl::init(false), cl::Hidden,
     cl::desc("Maximize bandwidth when selecting vectorization factor which "
@@ -3643,6 +3649,11 @@ static unsigned getVectorCallCost(CallInst *CI, unsigned VF,
   if (!TLI || !TLI->isFunctionVectorizable(FnName, VF) || CI->isNoBuiltin())
     return Cost;
 
+  // The vector function may need a newer instruction set than the subtarget.
+  StringRef Feature = TLI->getVectorizedFunctionFeature(FnName, VF);
+  if (!Feature.empty() && !TTI.hasTargetFeature(Feature))
+    return Cost;
+
   // If the corresponding vector cost is cheaper, return its cost.
   unsigned VectorCallCost = TTI.getCallInstrCost(nullptr, RetTy, Tys);
   if (VectorCallCost < Cost) {
@@ -7057,14 +7068,20 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   }
 
   // Check the loop for a trip count threshold:
-  // do not vectorize loops with a tiny trip count.
+  // do not vectorize loops with a tiny trip count, unless the vector body can
+  // cover every iteration on its own and that was asked for.
+  bool TinyTripCount = false;
   const unsigned TC = SE->getSmallConstantTripCount(L);
   if (TC > 0u && TC < TinyTripCountVectorThreshold) {
     DEBUG(dbgs() << "LV: Found a loop with a very small trip count. "
                  << "This loop is not worth vectorizing.");
     if (Hints.getForce() == LoopVectorizeHints::FK_Enabled)
       DEBUG(dbgs() << " But vectorizing was explicitly forced.\n");
-    else {
+    else if (VectorizeTinyTripCountLoops && !F->optForSize()) {
+      DEBUG(dbgs() << " But vectorizing it without a scalar tail was "
+                   << "requested.\n");
+      TinyTripCount = true;
+    } else {
       DEBUG(dbgs() << "\n");
       ORE->emit(createMissedAnalysis(Hints.vectorizeAnalysisPassName(),
                                      "NotBeneficial", L)
@@ -7096,6 +7113,12 @@ bool LoopVectorizePass::processLoop(Loop *L) {
   bool OptForSize =
       Hints.getForce() != LoopVectorizeHints::FK_Enabled && F->optForSize();
 
+  // Vectorize loops with a very small trip count as if optimizing for size.
+  // That rules out runtime checks and a scalar tail, so the vector body has to
+  // cover every iteration on its own.
+  if (TinyTripCount)
+    OptForSize = true;
+
   // Compute the weighted frequency of this loop being executed and see if it
   // is less than 20% of the function entry baseline frequency. Note that we
   // always have a canonical loop here because we think we *can* vectorize.
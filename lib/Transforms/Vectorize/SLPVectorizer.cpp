@@ -86,6 +86,11 @@ static cl::opt<unsigned> RecursionMaxDepth(
     "slp-recursion-max-depth", cl::init(12), cl::Hidden,
     cl::desc("Limit the recursion depth when building a vectorizable tree"));
 
+static cl::opt<unsigned> StoreChunkSize(
+    "slp-store-chunk-size", cl::init(16), cl::Hidden,
+    cl::desc("Search for consecutive stores in groups of at most this many "
+             "stores with the same underlying object"));
+
 static cl::opt<unsigned> MinTreeSize(
     "slp-min-tree-size", cl::init(3), cl::Hidden,
     cl::desc("Only vectorize small trees if they are fully vectorizable"));
@@ -3748,6 +3753,30 @@ bool SLPVectorizerPass::vectorizeStores(ArrayRef<StoreInst *> Stores,
   BoUpSLP::ValueSet VectorizedStores;
   bool Changed = false;
 
+  // Most candidate pairs address the same base pointer at different constant
+  // offsets. Strip those offsets once up front so that such pairs can be
+  // decided without going through SCEV.
+  SmallVector<std::pair<Value *, APInt>, 16> BaseAndOffset;
+  for (StoreInst *SI : Stores) {
+    Value *Ptr = SI->getPointerOperand();
+    APInt Offset(DL->getPointerSizeInBits(SI->getPointerAddressSpace()), 0);
+    Value *Base = Ptr->stripAndAccumulateInBoundsConstantOffsets(*DL, Offset);
+    BaseAndOffset.push_back(std::make_pair(Base, Offset));
+  }
+  auto IsConsecutive = [&](unsigned A, unsigned B) {
+    Value *PtrA = Stores[A]->getPointerOperand();
+    Value *PtrB = Stores[B]->getPointerOperand();
+    if (PtrA->getType() != PtrB->getType() ||
+        BaseAndOffset[A].first != BaseAndOffset[B].first)
+      return isConsecutiveAccess(Stores[A], Stores[B], *DL, *SE);
+    // This is what isConsecutiveAccess computes for a shared base.
+    if (PtrA == PtrB)
+      return false;
+    Type *Ty = Stores[A]->getValueOperand()->getType();
+    return BaseAndOffset[B].second - BaseAndOffset[A].second ==
+           DL->getTypeStoreSize(Ty);
+  };
+
   // Do a quadratic search on all of the given stores and find
   // all of the pairs of stores that follow each other.
   SmallVector<unsigned, 16> IndexQueue;
@@ -3764,7 +3793,7 @@ bool SLPVectorizerPass::vectorizeStores(ArrayRef<StoreInst *> Stores,
       IndexQueue.push_back(j - 1);
 
     for (auto &k : IndexQueue) {
-      if (isConsecutiveAccess(Stores[i], Stores[k], *DL, *SE)) {
+      if (IsConsecutive(i, k)) {
         Tails.insert(Stores[k]);
         Heads.insert(Stores[i]);
         ConsecutiveChain[Stores[i]] = Stores[k];
@@ -4759,12 +4788,13 @@ bool SLPVectorizerPass::vectorizeStoreChains(BoUpSLP &R) {
     DEBUG(dbgs() << "SLP: Analyzing a store chain of length "
           << it->second.size() << ".\n");
 
-    // Process the stores in chunks of 16.
-    // TODO: The limit of 16 inhibits greater vectorization factors.
-    //       For example, AVX2 supports v32i8. Increasing this limit, however,
-    //       may cause a significant compile-time increase.
-    for (unsigned CI = 0, CE = it->second.size(); CI < CE; CI+=16) {
-      unsigned Len = std::min<unsigned>(CE - CI, 16);
+    // Process the stores in chunks of StoreChunkSize, 16 by default.
+    // TODO: The default limit of 16 inhibits greater vectorization factors.
+    //       For example, AVX2 supports v32i8. The pairing search is quadratic
+    //       in the chunk size, although pairs with a common base are cheap.
+    unsigned ChunkSize = std::max(2u, (unsigned)StoreChunkSize);
+    for (unsigned CI = 0, CE = it->second.size(); CI < CE; CI += ChunkSize) {
+      unsigned Len = std::min<unsigned>(CE - CI, ChunkSize);
       Changed |= vectorizeStores(makeArrayRef(&it->second[CI], Len), R);
     }
   }
@@ -0,0 +1,70 @@
+; RUN: llvm-as < %s | llvm-dis -asm-writer-threads=1 -o %t.serial
+; RUN: llvm-as < %s | llvm-dis -asm-writer-threads=4 -o %t.parallel
+; RUN: diff %t.serial %t.parallel
+; RUN: FileCheck %s < %t.parallel
+
+; Check that printing function bodies in parallel numbers metadata and
+; attribute groups first seen inside functions the same way as printing them
+; one by one.
+
+%0 = type { i32, i8* }
+
+@0 = global i32 0
+
+; CHECK: define void @f0() #0 !attached !{{[0-9]+}} {
+define void @f0() #0 !attached !3 {
+  %1 = load i32, i32* @0, !tbaa !5
+  call void @f1(%0* null) #1
+  ret void
+}
+
+; CHECK: define void @f1(%0*) {
+define void @f1(%0*) {
+  %sp = call i64 @llvm.read_register.i64(metadata !9)
+  %2 = getelementptr %0, %0* %0, i32 0, i32 0
+  store i32 1, i32* %2, !nontemporal !11
+  ret void
+}
+
+; CHECK: define internal i32 @1(i32) {
+define internal i32 @1(i32) {
+; CHECK: %2 = add i32 %0, 1
+  %2 = add i32 %0, 1
+  br label %3
+
+; <label>:3:
+  %4 = call i32 @1(i32 %2) #2
+  ret i32 %4, !prof !12
+}
+
+; CHECK: declare !attached !{{[0-9]+}} void @f3()
+declare !attached !13 void @f3()
+
+declare i64 @llvm.read_register.i64(metadata)
+
+; The intrinsic's attributes get #1, since declarations are numbered before
+; the attribute groups of call sites.
+; CHECK: attributes #0 = { nounwind }
+; CHECK: attributes #1 = { nounwind readonly }
+; CHECK: attributes #2 = { cold }
+; CHECK: attributes #3 = { noinline }
+attributes #0 = { nounwind }
+attributes #1 = { cold }
+attributes #2 = { noinline }
+
+!named = !{!0, !1}
+
+!0 = !{!"zero"}
+!1 = !{!0}
+!2 = !{!"unused"}
+!3 = !{!"f0"}
+!4 = !{!"root"}
+!5 = !{!6, !6, i64 0}
+!6 = !{!"int", !4}
+!7 = !{!"f1"}
+!8 = !{!7}
+!9 = !{!"sp"}
+!10 = !{!8}
+!11 = !{i32 1}
+!12 = !{!"branch_weights", i32 1}
+!13 = !{!"f3"}
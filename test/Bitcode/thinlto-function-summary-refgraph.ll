@@ -6,25 +6,29 @@
 ; expected value id and other information as appropriate (callsite cout
 ; for calls). Use different linkage types for the various test cases to
 ; distinguish the test cases here (op1 contains the linkage type).
-; Note that op3 contains the # non-call references.
+; Note that op3 contains the # non-call references, op4 the # of those that
+; are only loaded from and op5 the # of those that are only stored to.
 ; This also ensures that we didn't include a call or reference to intrinsic
 ; llvm.ctpop.i8.
 ; CHECK:       <GLOBALVAL_SUMMARY_BLOCK
 ; Function main contains call to func, as well as address reference to func:
-; CHECK-DAG:    <PERMODULE {{.*}} op0=[[MAINID:[0-9]+]] op1=0 {{.*}} op3=1 op4=[[FUNCID:[0-9]+]] op5=[[FUNCID]]/>
+; CHECK-DAG:    <PERMODULE {{.*}} op0=[[MAINID:[0-9]+]] op1=0 {{.*}} op3=1 op4=0 op5=0 op6=[[FUNCID:[0-9]+]] op7=[[FUNCID]]/>
 ; Function W contains a call to func3 as well as a reference to globalvar:
-; CHECK-DAG:    <PERMODULE {{.*}} op0=[[WID:[0-9]+]] op1=5 {{.*}} op3=1 op4=[[GLOBALVARID:[0-9]+]] op5=[[FUNC3ID:[0-9]+]]/>
+; CHECK-DAG:    <PERMODULE {{.*}} op0=[[WID:[0-9]+]] op1=5 {{.*}} op3=1 op4=0 op5=0 op6=[[GLOBALVARID:[0-9]+]] op7=[[FUNC3ID:[0-9]+]]/>
 ; Function X contains call to foo, as well as address reference to foo
 ; which is in the same instruction as the call:
-; CHECK-DAG:    <PERMODULE {{.*}} op0=[[XID:[0-9]+]] op1=1 {{.*}} op3=1 op4=[[FOOID:[0-9]+]] op5=[[FOOID]]/>
+; CHECK-DAG:    <PERMODULE {{.*}} op0=[[XID:[0-9]+]] op1=1 {{.*}} op3=1 op4=0 op5=0 op6=[[FOOID:[0-9]+]] op7=[[FOOID]]/>
 ; Function Y contains call to func2, and ensures we don't incorrectly add
 ; a reference to it when reached while earlier analyzing the phi using its
 ; return value:
-; CHECK-DAG:    <PERMODULE {{.*}} op0=[[YID:[0-9]+]] op1=8 {{.*}} op3=0 op4=[[FUNC2ID:[0-9]+]]/>
+; CHECK-DAG:    <PERMODULE {{.*}} op0=[[YID:[0-9]+]] op1=8 {{.*}} op3=0 op4=0 op5=0 op6=[[FUNC2ID:[0-9]+]]/>
 ; Function Z contains call to func2, and ensures we don't incorrectly add
 ; a reference to it when reached while analyzing subsequent use of its return
 ; value:
-; CHECK-DAG:    <PERMODULE {{.*}} op0=[[ZID:[0-9]+]] op1=3 {{.*}} op3=0 op4=[[FUNC2ID:[0-9]+]]/>
+; CHECK-DAG:    <PERMODULE {{.*}} op0=[[ZID:[0-9]+]] op1=3 {{.*}} op3=0 op4=0 op5=0 op6=[[FUNC2ID:[0-9]+]]/>
+; Function RW only loads from rovar, through a GEP, and only stores to wovar,
+; so they are listed last, in that order:
+; CHECK-DAG:    <PERMODULE {{.*}} op0=[[RWID:[0-9]+]] op1=7 {{.*}} op3=2 op4=1 op5=1 op6=[[ROVARID:[0-9]+]] op7=[[WOVARID:[0-9]+]]/>
 ; Variable bar initialization contains address reference to func:
 ; CHECK-DAG:    <PERMODULE_GLOBALVAR_INIT_REFS {{.*}} op0=[[BARID:[0-9]+]] op1=0 op2=[[FUNCID]]/>
 ; CHECK:  </GLOBALVAL_SUMMARY_BLOCK>
@@ -38,9 +42,12 @@
 ; CHECK-DAG:    <FNENTRY {{.*}} op0=[[XID]] {{.*}} record string = 'X'
 ; CHECK-DAG:    <FNENTRY {{.*}} op0=[[YID]] {{.*}} record string = 'Y'
 ; CHECK-DAG:    <FNENTRY {{.*}} op0=[[ZID]] {{.*}} record string = 'Z'
+; CHECK-DAG:    <FNENTRY {{.*}} op0=[[RWID]] {{.*}} record string = 'RW'
 ; CHECK-DAG:    <ENTRY {{.*}} op0=[[FUNC2ID]] {{.*}} record string = 'func2'
 ; CHECK-DAG:    <ENTRY {{.*}} op0=[[FUNC3ID]] {{.*}} record string = 'func3'
 ; CHECK-DAG:    <ENTRY {{.*}} op0=[[GLOBALVARID]] {{.*}} record string = 'globalvar'
+; CHECK-DAG:    <ENTRY {{.*}} op0=[[ROVARID]] {{.*}} record string = 'rovar'
+; CHECK-DAG:    <ENTRY {{.*}} op0=[[WOVARID]] {{.*}} record string = 'wovar'
 ; CHECK:  </VALUE_SYMTAB>
 
 ; ModuleID = 'thinlto-function-summary-refgraph.ll'
@@ -50,6 +57,8 @@ target triple = "x86_64-unknown-linux-gnu"
 @bar = global void (...)* bitcast (void ()* @func to void (...)*), align 8
 
 @globalvar = global i32 0, align 4
+@rovar = global [2 x i32] [i32 1, i32 2], align 4
+@wovar = global i32 0, align 4
 
 declare void @func() #0
 declare i32 @func2(...) #1
@@ -104,6 +113,14 @@ entry:
   ret i32 %call
 }
 
+; Function Attrs: nounwind uwtable
+define internal void @RW() #0 {
+entry:
+  %0 = load i32, i32* getelementptr inbounds ([2 x i32], [2 x i32]* @rovar, i64 0, i64 1), align 4
+  store i32 %0, i32* @wovar, align 4
+  ret void
+}
+
 declare i8 @llvm.ctpop.i8(i8)
 
 ; Function Attrs: nounwind uwtable
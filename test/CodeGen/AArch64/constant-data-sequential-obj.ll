@@ -0,0 +1,40 @@
+; RUN: llc -mtriple=aarch64-linux-gnu -filetype=obj %s -o - \
+; RUN:   | llvm-objdump -s - | FileCheck %s --check-prefix=LE
+; RUN: llc -mtriple=aarch64_be-linux-gnu -filetype=obj %s -o - \
+; RUN:   | llvm-objdump -s - | FileCheck %s --check-prefix=BE
+
+; Arrays and vectors of simple elements are written to object files in one
+; piece. Check that the elements are in the byte order of the target.
+
+@i16 = constant [3 x i16] [i16 1, i16 2, i16 770], section ".rodata.i16"
+@i32 = constant [2 x i32] [i32 1, i32 -2], section ".rodata.i32"
+@i64 = constant <2 x i64> <i64 1, i64 81985529216486895>, section ".rodata.i64"
+@f16 = constant [2 x half] [half 1.0, half -2.0], section ".rodata.f16"
+@f32 = constant [2 x float] [float 1.0, float -2.0], section ".rodata.f32"
+@f64 = constant [1 x double] [double 1.0], section ".rodata.f64"
+
+; LE:      Contents of section .rodata.i16:
+; LE-NEXT:  0000 01000200 0203
+; LE:      Contents of section .rodata.i32:
+; LE-NEXT:  0000 01000000 feffffff
+; LE:      Contents of section .rodata.i64:
+; LE-NEXT:  0000 01000000 00000000 efcdab89 67452301
+; LE:      Contents of section .rodata.f16:
+; LE-NEXT:  0000 003c00c0
+; LE:      Contents of section .rodata.f32:
+; LE-NEXT:  0000 0000803f 000000c0
+; LE:      Contents of section .rodata.f64:
+; LE-NEXT:  0000 00000000 0000f03f
+
+; BE:      Contents of section .rodata.i16:
+; BE-NEXT:  0000 00010002 0302
+; BE:      Contents of section .rodata.i32:
+; BE-NEXT:  0000 00000001 fffffffe
+; BE:      Contents of section .rodata.i64:
+; BE-NEXT:  0000 00000000 00000001 01234567 89abcdef
+; BE:      Contents of section .rodata.f16:
+; BE-NEXT:  0000 3c00c000
+; BE:      Contents of section .rodata.f32:
+; BE-NEXT:  0000 3f800000 c0000000
+; BE:      Contents of section .rodata.f64:
+; BE-NEXT:  0000 3ff00000 00000000
@@ -0,0 +1,52 @@
+; RUN: llc -enable-machine-outliner -mtriple=aarch64-unknown-linux < %s | FileCheck %s
+
+; The stores repeated in @f1, @f2 and @f3 are outlined. The calls save LR on
+; the stack around the BL.
+
+; CHECK-LABEL: f1:
+; CHECK: str x30, [sp, #-16]!
+; CHECK-NEXT: bl OUTLINED_FUNCTION_0
+; CHECK-NEXT: ldr x30, [sp], #16
+; CHECK-NEXT: ret
+define void @f1(i32* %p) {
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: f2:
+; CHECK: bl OUTLINED_FUNCTION_0
+define void @f2(i32* %p) {
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: f3:
+; CHECK: bl OUTLINED_FUNCTION_0
+define void @f3(i32* %p) {
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: OUTLINED_FUNCTION_0:
+; CHECK-NOT: sp
+; CHECK: str w{{[0-9]+}}, [x0]
+; CHECK: str w{{[0-9]+}}, [x0, #12]
+; CHECK-NEXT: ret
@@ -0,0 +1,29 @@
+; RUN: llc < %s -mtriple=aarch64-linux-gnu -mcpu=cortex-a57 -debug-only=misched -o /dev/null 2>&1 | FileCheck %s --check-prefix=BIDI
+; RUN: llc < %s -mtriple=aarch64-linux-gnu -mcpu=cortex-a57 -misched-bidirectional-limit=4 -debug-only=misched -o /dev/null 2>&1 | FileCheck %s --check-prefix=LIMIT
+; REQUIRES: asserts
+
+; Check that AArch64 schedules regions in both directions, but regions longer
+; than -misched-bidirectional-limit instructions bottom-up only.
+
+; BIDI: GenericScheduler RegionPolicy: {{.*}} OnlyTopDown=0 OnlyBottomUp=0
+; LIMIT: GenericScheduler RegionPolicy: {{.*}} OnlyTopDown=0 OnlyBottomUp=1
+
+define i64 @chain(i64* %p, i64 %a, i64 %b) {
+  %p1 = getelementptr i64, i64* %p, i64 1
+  %p2 = getelementptr i64, i64* %p, i64 2
+  %p3 = getelementptr i64, i64* %p, i64 3
+  %l0 = load i64, i64* %p
+  %l1 = load i64, i64* %p1
+  %l2 = load i64, i64* %p2
+  %l3 = load i64, i64* %p3
+  %m0 = mul i64 %l0, %a
+  %m1 = mul i64 %l1, %b
+  %m2 = mul i64 %l2, %a
+  %m3 = mul i64 %l3, %b
+  %s0 = add i64 %m0, %m1
+  %s1 = add i64 %m2, %m3
+  %d0 = sdiv i64 %s0, %a
+  %d1 = sdiv i64 %s1, %b
+  %r = add i64 %d0, %d1
+  ret i64 %r
+}
@@ -0,0 +1,136 @@
+; RUN: llc -march=amdgcn -mcpu=tonga -verify-machineinstrs < %s | FileCheck -check-prefix=GCN %s
+
+; The entry block needs about 80 VGPRs, which limits the kernel to 3 waves.
+; The first scheduling stage keeps %second within the VGPRs of 10 waves, so
+; only about 20 of its loads are issued before the first add. The second stage
+; reschedules %second for 3 waves and issues all but one of its loads first.
+
+; GCN-LABEL: {{^}}occupancy:
+; GCN: ; %second
+; GCN: v_add_f32_e32 v{{[0-9]+}}, 1.0,
+; GCN: buffer_load_dword
+; GCN-NOT: buffer_load_dword
+; GCN: s_endpgm
+define void @occupancy(<16 x float> addrspace(1)* %out, <16 x float> addrspace(1)* %in, i32 %cond) {
+entry:
+  %pa = getelementptr <16 x float>, <16 x float> addrspace(1)* %in, i32 0
+  %a = load volatile <16 x float>, <16 x float> addrspace(1)* %pa
+  %pb = getelementptr <16 x float>, <16 x float> addrspace(1)* %in, i32 1
+  %b = load volatile <16 x float>, <16 x float> addrspace(1)* %pb
+  %pc = getelementptr <16 x float>, <16 x float> addrspace(1)* %in, i32 2
+  %c = load volatile <16 x float>, <16 x float> addrspace(1)* %pc
+  %pd = getelementptr <16 x float>, <16 x float> addrspace(1)* %in, i32 3
+  %d = load volatile <16 x float>, <16 x float> addrspace(1)* %pd
+  %pe = getelementptr <16 x float>, <16 x float> addrspace(1)* %in, i32 4
+  %e = load volatile <16 x float>, <16 x float> addrspace(1)* %pe
+  %re = shufflevector <16 x float> %e, <16 x float> undef, <16 x i32> <i32 15, i32 14, i32 13, i32 12, i32 11, i32 10, i32 9, i32 8, i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  %m1 = fmul <16 x float> %a, %re
+  %rd = shufflevector <16 x float> %d, <16 x float> undef, <16 x i32> <i32 15, i32 14, i32 13, i32 12, i32 11, i32 10, i32 9, i32 8, i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  %m2 = fmul <16 x float> %b, %rd
+  %rc = shufflevector <16 x float> %c, <16 x float> undef, <16 x i32> <i32 15, i32 14, i32 13, i32 12, i32 11, i32 10, i32 9, i32 8, i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  %m3 = fmul <16 x float> %c, %rc
+  %s1 = fadd <16 x float> %m1, %m2
+  %s2 = fadd <16 x float> %s1, %m3
+  store volatile <16 x float> %s2, <16 x float> addrspace(1)* %out
+  %cc = icmp eq i32 %cond, 0
+  br i1 %cc, label %second, label %done
+
+second:
+  %fin = bitcast <16 x float> addrspace(1)* %in to float addrspace(1)*
+  %fout = bitcast <16 x float> addrspace(1)* %out to float addrspace(1)*
+  %q0 = getelementptr float, float addrspace(1)* %fin, i32 1000
+  %w0 = load float, float addrspace(1)* %q0
+  %q1 = getelementptr float, float addrspace(1)* %fin, i32 1064
+  %w1 = load float, float addrspace(1)* %q1
+  %q2 = getelementptr float, float addrspace(1)* %fin, i32 1128
+  %w2 = load float, float addrspace(1)* %q2
+  %q3 = getelementptr float, float addrspace(1)* %fin, i32 1192
+  %w3 = load float, float addrspace(1)* %q3
+  %q4 = getelementptr float, float addrspace(1)* %fin, i32 1256
+  %w4 = load float, float addrspace(1)* %q4
+  %q5 = getelementptr float, float addrspace(1)* %fin, i32 1320
+  %w5 = load float, float addrspace(1)* %q5
+  %q6 = getelementptr float, float addrspace(1)* %fin, i32 1384
+  %w6 = load float, float addrspace(1)* %q6
+  %q7 = getelementptr float, float addrspace(1)* %fin, i32 1448
+  %w7 = load float, float addrspace(1)* %q7
+  %q8 = getelementptr float, float addrspace(1)* %fin, i32 1512
+  %w8 = load float, float addrspace(1)* %q8
+  %q9 = getelementptr float, float addrspace(1)* %fin, i32 1576
+  %w9 = load float, float addrspace(1)* %q9
+  %q10 = getelementptr float, float addrspace(1)* %fin, i32 1640
+  %w10 = load float, float addrspace(1)* %q10
+  %q11 = getelementptr float, float addrspace(1)* %fin, i32 1704
+  %w11 = load float, float addrspace(1)* %q11
+  %q12 = getelementptr float, float addrspace(1)* %fin, i32 1768
+  %w12 = load float, float addrspace(1)* %q12
+  %q13 = getelementptr float, float addrspace(1)* %fin, i32 1832
+  %w13 = load float, float addrspace(1)* %q13
+  %q14 = getelementptr float, float addrspace(1)* %fin, i32 1896
+  %w14 = load float, float addrspace(1)* %q14
+  %q15 = getelementptr float, float addrspace(1)* %fin, i32 1960
+  %w15 = load float, float addrspace(1)* %q15
+  %q16 = getelementptr float, float addrspace(1)* %fin, i32 2024
+  %w16 = load float, float addrspace(1)* %q16
+  %q17 = getelementptr float, float addrspace(1)* %fin, i32 2088
+  %w17 = load float, float addrspace(1)* %q17
+  %q18 = getelementptr float, float addrspace(1)* %fin, i32 2152
+  %w18 = load float, float addrspace(1)* %q18
+  %q19 = getelementptr float, float addrspace(1)* %fin, i32 2216
+  %w19 = load float, float addrspace(1)* %q19
+  %q20 = getelementptr float, float addrspace(1)* %fin, i32 2280
+  %w20 = load float, float addrspace(1)* %q20
+  %q21 = getelementptr float, float addrspace(1)* %fin, i32 2344
+  %w21 = load float, float addrspace(1)* %q21
+  %q22 = getelementptr float, float addrspace(1)* %fin, i32 2408
+  %w22 = load float, float addrspace(1)* %q22
+  %q23 = getelementptr float, float addrspace(1)* %fin, i32 2472
+  %w23 = load float, float addrspace(1)* %q23
+  %q24 = getelementptr float, float addrspace(1)* %fin, i32 2536
+  %w24 = load float, float addrspace(1)* %q24
+  %q25 = getelementptr float, float addrspace(1)* %fin, i32 2600
+  %w25 = load float, float addrspace(1)* %q25
+  %q26 = getelementptr float, float addrspace(1)* %fin, i32 2664
+  %w26 = load float, float addrspace(1)* %q26
+  %q27 = getelementptr float, float addrspace(1)* %fin, i32 2728
+  %w27 = load float, float addrspace(1)* %q27
+  %q28 = getelementptr float, float addrspace(1)* %fin, i32 2792
+  %w28 = load float, float addrspace(1)* %q28
+  %q29 = getelementptr float, float addrspace(1)* %fin, i32 2856
+  %w29 = load float, float addrspace(1)* %q29
+  %t0 = fadd float 1.0, %w0
+  %t1 = fadd float %t0, %w1
+  %t2 = fadd float %t1, %w2
+  %t3 = fadd float %t2, %w3
+  %t4 = fadd float %t3, %w4
+  %t5 = fadd float %t4, %w5
+  %t6 = fadd float %t5, %w6
+  %t7 = fadd float %t6, %w7
+  %t8 = fadd float %t7, %w8
+  %t9 = fadd float %t8, %w9
+  %t10 = fadd float %t9, %w10
+  %t11 = fadd float %t10, %w11
+  %t12 = fadd float %t11, %w12
+  %t13 = fadd float %t12, %w13
+  %t14 = fadd float %t13, %w14
+  %t15 = fadd float %t14, %w15
+  %t16 = fadd float %t15, %w16
+  %t17 = fadd float %t16, %w17
+  %t18 = fadd float %t17, %w18
+  %t19 = fadd float %t18, %w19
+  %t20 = fadd float %t19, %w20
+  %t21 = fadd float %t20, %w21
+  %t22 = fadd float %t21, %w22
+  %t23 = fadd float %t22, %w23
+  %t24 = fadd float %t23, %w24
+  %t25 = fadd float %t24, %w25
+  %t26 = fadd float %t25, %w26
+  %t27 = fadd float %t26, %w27
+  %t28 = fadd float %t27, %w28
+  %t29 = fadd float %t28, %w29
+  store float %t29, float addrspace(1)* %fout
+  br label %done
+
+done:
+  ret void
+}
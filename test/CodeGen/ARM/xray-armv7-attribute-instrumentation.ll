@@ -22,3 +22,11 @@ define i32 @foo() nounwind noinline uwtable "function-instrument"="xray-always"
 ; CHECK-LABEL: Ltmp1:
 ; CHECK-NEXT:  bx lr
 }
+; CHECK:       .section xray_instr_map,{{.*}}
+; CHECK-LABEL: Lxray_sleds_start0:
+; CHECK:       .long {{.*}}Lxray_sled_0
+; CHECK:       .long {{.*}}Lxray_sled_1
+; CHECK-LABEL: Lxray_sleds_end0:
+; CHECK:       .section xray_fn_idx,{{.*}}
+; CHECK:       .long {{.*}}Lxray_sleds_start0
+; CHECK-NEXT:  .long {{.*}}Lxray_sleds_end0
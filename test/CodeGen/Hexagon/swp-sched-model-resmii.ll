@@ -0,0 +1,53 @@
+; RUN: llc -march=hexagon -mcpu=hexagonv5 -enable-pipeliner \
+; RUN:     -pipeliner-force-sched-model -pipeliner-max-mii=3 < %s \
+; RUN:     | FileCheck %s --check-prefix=PIPE
+; RUN: llc -march=hexagon -mcpu=hexagonv5 -enable-pipeliner \
+; RUN:     -pipeliner-force-sched-model -pipeliner-max-mii=2 < %s \
+; RUN:     | FileCheck %s --check-prefix=NOPIPE
+
+; Model the resources with the itineraries instead of the DFA. The loop has
+; six loads, which can only issue in slots 0 and 1, so its resource
+; constrained MII is 3. Pipelining peels an iteration off the constant trip
+; count.
+
+; PIPE: loop0(.LBB0_{{[0-9]+}}, #99)
+; NOPIPE: loop0(.LBB0_{{[0-9]+}}, #100)
+
+define i32 @foo(i32* %a, i32* %b, i32* %c, i32* %d, i32* %e, i32* %f) {
+entry:
+  br label %for.body
+
+for.body:
+  %sum = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  %pa = phi i32* [ %a, %entry ], [ %pa.inc, %for.body ]
+  %pb = phi i32* [ %b, %entry ], [ %pb.inc, %for.body ]
+  %pc = phi i32* [ %c, %entry ], [ %pc.inc, %for.body ]
+  %pd = phi i32* [ %d, %entry ], [ %pd.inc, %for.body ]
+  %pe = phi i32* [ %e, %entry ], [ %pe.inc, %for.body ]
+  %pf = phi i32* [ %f, %entry ], [ %pf.inc, %for.body ]
+  %i = phi i32 [ 0, %entry ], [ %inc, %for.body ]
+  %a.val = load i32, i32* %pa, align 4
+  %b.val = load i32, i32* %pb, align 4
+  %c.val = load i32, i32* %pc, align 4
+  %d.val = load i32, i32* %pd, align 4
+  %e.val = load i32, i32* %pe, align 4
+  %f.val = load i32, i32* %pf, align 4
+  %ab = add nsw i32 %a.val, %b.val
+  %cd = add nsw i32 %c.val, %d.val
+  %ef = add nsw i32 %e.val, %f.val
+  %abcd = add nsw i32 %ab, %cd
+  %all = add nsw i32 %abcd, %ef
+  %add = add nsw i32 %all, %sum
+  %inc = add nsw i32 %i, 1
+  %exitcond = icmp eq i32 %inc, 100
+  %pa.inc = getelementptr i32, i32* %pa, i32 1
+  %pb.inc = getelementptr i32, i32* %pb, i32 1
+  %pc.inc = getelementptr i32, i32* %pc, i32 1
+  %pd.inc = getelementptr i32, i32* %pd, i32 1
+  %pe.inc = getelementptr i32, i32* %pe, i32 1
+  %pf.inc = getelementptr i32, i32* %pf, i32 1
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %add
+}
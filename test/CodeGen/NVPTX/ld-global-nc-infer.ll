@@ -0,0 +1,58 @@
+; RUN: llc < %s -march=nvptx64 -mcpu=sm_35 | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v16:16:16-v32:32:32-v64:64:64-v128:128:128-n16:32:64"
+target triple = "nvptx64-nvidia-cuda"
+
+; Noalias kernel arguments that are only loaded from are read with
+; ld.global.nc even without the readonly attribute.
+
+; CHECK-LABEL: .visible .entry only_loads(
+; CHECK: ld.global.nc.f32
+; CHECK: st.global.f32
+define void @only_loads(float* noalias %from, float* noalias %to, i64 %i) {
+  %p = getelementptr inbounds float, float* %from, i64 %i
+  %c = bitcast float* %p to i8*
+  %q = bitcast i8* %c to float*
+  %a = load float, float* %q, align 4
+  store float %a, float* %to, align 4
+  ret void
+}
+
+; A store through a pointer based on the argument rules it out.
+; CHECK-LABEL: .visible .entry stores_too(
+; CHECK-NOT: ld.global.nc
+; CHECK: ld.global.f32
+define void @stores_too(float* noalias %buf, i64 %i) {
+  %p = getelementptr inbounds float, float* %buf, i64 %i
+  %a = load float, float* %buf, align 4
+  store float %a, float* %p, align 4
+  ret void
+}
+
+; So does passing it to a function that may write through it.
+; CHECK-LABEL: .visible .entry escapes(
+; CHECK-NOT: ld.global.nc
+; CHECK: ld.global.f32
+declare void @use(float*)
+define void @escapes(float* noalias %buf, float* noalias %to) {
+  call void @use(float* %buf)
+  %a = load float, float* %buf, align 4
+  store float %a, float* %to, align 4
+  ret void
+}
+
+; Without noalias other pointers may write the memory.
+; CHECK-LABEL: .visible .entry not_noalias(
+; CHECK-NOT: ld.global.nc
+; CHECK: ld.global.f32
+define void @not_noalias(float* %from, float* %to) {
+  %a = load float, float* %from, align 4
+  store float %a, float* %to, align 4
+  ret void
+}
+
+!nvvm.annotations = !{!0, !1, !2, !3}
+!0 = !{void (float*, float*, i64)* @only_loads, !"kernel", i32 1}
+!1 = !{void (float*, i64)* @stores_too, !"kernel", i32 1}
+!2 = !{void (float*, float*)* @escapes, !"kernel", i32 1}
+!3 = !{void (float*, float*)* @not_noalias, !"kernel", i32 1}
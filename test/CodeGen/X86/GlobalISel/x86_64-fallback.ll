@@ -0,0 +1,13 @@
+; RUN: not llc -mtriple=x86_64-linux-gnu -O0 -global-isel -verify-machineinstrs %s -o - 2>&1 | FileCheck %s --check-prefix=ERROR
+; RUN: llc -mtriple=x86_64-linux-gnu -O0 -global-isel -global-isel-abort=2 -verify-machineinstrs %s -o - 2>&1 | FileCheck %s --check-prefix=FALLBACK_WITH_REPORT
+; Check that functions GlobalISel cannot handle on X86 fall back to
+; SelectionDAG. This must be updated as the X86 support grows.
+
+; ERROR: Unable to lower arguments
+; FALLBACK_WITH_REPORT: warning: Instruction selection used fallback path for float_arg
+; FALLBACK_WITH_REPORT-LABEL: float_arg:
+; FALLBACK_WITH_REPORT: addss
+define float @float_arg(float %a, float %b) {
+  %r = fadd float %a, %b
+  ret float %r
+}
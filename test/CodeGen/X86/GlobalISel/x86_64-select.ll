@@ -0,0 +1,58 @@
+; RUN: llc -mtriple=x86_64-linux-gnu -O0 -global-isel -global-isel-abort=2 -verify-machineinstrs %s -o - 2>&1 | FileCheck %s
+; Check that simple integer code goes through GlobalISel on x86-64 without
+; falling back to SelectionDAG.
+
+; CHECK-NOT: warning: Instruction selection used fallback path
+
+; CHECK-LABEL: add_i64:
+; CHECK: addq {{%[a-z0-9]+}}, {{%[a-z0-9]+}}
+; CHECK: retq
+define i64 @add_i64(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+; CHECK-LABEL: sub_i32:
+; CHECK: subl {{%[a-z0-9]+}}, {{%[a-z0-9]+}}
+; CHECK: retq
+define i32 @sub_i32(i32 %a, i32 %b) {
+  %r = sub i32 %a, %b
+  ret i32 %r
+}
+
+; CHECK-LABEL: mul_i16:
+; CHECK: imulw {{%[a-z0-9]+}}, {{%[a-z0-9]+}}
+; CHECK: retq
+define i16 @mul_i16(i16 %a, i16 %b) {
+  %r = mul i16 %a, %b
+  ret i16 %r
+}
+
+; CHECK-LABEL: load_store:
+; CHECK: movl ({{%[a-z0-9]+}}), [[VAL:%[a-z0-9]+]]
+; CHECK: movl [[VAL]], ({{%[a-z0-9]+}})
+; CHECK: retq
+define void @load_store(i32* %src, i32* %dst) {
+  %v = load i32, i32* %src
+  store i32 %v, i32* %dst
+  ret void
+}
+
+; CHECK-LABEL: cmp_zext:
+; CHECK: cmpq {{%[a-z0-9]+}}, {{%[a-z0-9]+}}
+; CHECK: setl
+; CHECK: andb $1
+; CHECK: movzbl
+; CHECK: retq
+define i32 @cmp_zext(i64 %a, i64 %b) {
+  %c = icmp slt i64 %a, %b
+  %r = zext i1 %c to i32
+  ret i32 %r
+}
+
+; CHECK-LABEL: constant:
+; CHECK: movq $-1, {{%[a-z0-9]+}}
+; CHECK: retq
+define i64 @constant() {
+  ret i64 -1
+}
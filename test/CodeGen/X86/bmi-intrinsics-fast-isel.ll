@@ -13,13 +13,12 @@ define i16 @test__tzcnt_u16(i16 %a0) {
 ; X32:       # BB#0:
 ; X32-NEXT:    movzwl {{[0-9]+}}(%esp), %eax
 ; X32-NEXT:    movzwl %ax, %ecx
+; X32-NEXT:    tzcntw %cx, %ax
 ; X32-NEXT:    cmpl $0, %ecx
-; X32-NEXT:    jne .LBB0_1
-; X32-NEXT:  # BB#2:
+; X32-NEXT:    jne .LBB0_2
+; X32-NEXT:  # BB#1:
 ; X32-NEXT:    movw $16, %ax
-; X32-NEXT:    retl
-; X32-NEXT:  .LBB0_1:
-; X32-NEXT:    tzcntw %ax, %ax
+; X32-NEXT:  .LBB0_2:
 ; X32-NEXT:    retl
 ;
 ; X64-LABEL: test__tzcnt_u16:
@@ -135,13 +134,11 @@ define i32 @test__tzcnt_u32(i32 %a0) {
 ; X32-LABEL: test__tzcnt_u32:
 ; X32:       # BB#0:
 ; X32-NEXT:    movl {{[0-9]+}}(%esp), %eax
-; X32-NEXT:    cmpl $0, %eax
-; X32-NEXT:    jne .LBB6_1
-; X32-NEXT:  # BB#2:
-; X32-NEXT:    movl $32, %eax
-; X32-NEXT:    retl
-; X32-NEXT:  .LBB6_1:
 ; X32-NEXT:    tzcntl %eax, %eax
+; X32-NEXT:    jae .LBB6_2
+; X32-NEXT:  # BB#1:
+; X32-NEXT:    movl $32, %eax
+; X32-NEXT:  .LBB6_2:
 ; X32-NEXT:    retl
 ;
 ; X64-LABEL: test__tzcnt_u32:
@@ -165,13 +162,12 @@ define i16 @test_tzcnt_u16(i16 %a0) {
 ; X32:       # BB#0:
 ; X32-NEXT:    movzwl {{[0-9]+}}(%esp), %eax
 ; X32-NEXT:    movzwl %ax, %ecx
+; X32-NEXT:    tzcntw %cx, %ax
 ; X32-NEXT:    cmpl $0, %ecx
-; X32-NEXT:    jne .LBB7_1
-; X32-NEXT:  # BB#2:
+; X32-NEXT:    jne .LBB7_2
+; X32-NEXT:  # BB#1:
 ; X32-NEXT:    movw $16, %ax
-; X32-NEXT:    retl
-; X32-NEXT:  .LBB7_1:
-; X32-NEXT:    tzcntw %ax, %ax
+; X32-NEXT:  .LBB7_2:
 ; X32-NEXT:    retl
 ;
 ; X64-LABEL: test_tzcnt_u16:
@@ -300,13 +296,11 @@ define i32 @test_tzcnt_u32(i32 %a0) {
 ; X32-LABEL: test_tzcnt_u32:
 ; X32:       # BB#0:
 ; X32-NEXT:    movl {{[0-9]+}}(%esp), %eax
-; X32-NEXT:    cmpl $0, %eax
-; X32-NEXT:    jne .LBB13_1
-; X32-NEXT:  # BB#2:
-; X32-NEXT:    movl $32, %eax
-; X32-NEXT:    retl
-; X32-NEXT:  .LBB13_1:
 ; X32-NEXT:    tzcntl %eax, %eax
+; X32-NEXT:    jae .LBB13_2
+; X32-NEXT:  # BB#1:
+; X32-NEXT:    movl $32, %eax
+; X32-NEXT:  .LBB13_2:
 ; X32-NEXT:    retl
 ;
 ; X64-LABEL: test_tzcnt_u32:
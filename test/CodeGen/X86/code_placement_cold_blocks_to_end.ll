@@ -0,0 +1,55 @@
+; RUN: llc -mcpu=corei7 -mtriple=x86_64-linux -move-cold-blocks-to-end -entry-to-cold-block-ratio=20 < %s | FileCheck %s
+
+define void @nested_loop(i1 %enter) !prof !1 {
+; Test that a block that is cold in the inner loop but not in the outer loop
+; is still moved to the end of the function when it is cold relative to the
+; function entry. The outer loop is rarely entered, so if.else runs about
+; 0.03 times per call even though it is not cold within the outer loop.
+;
+; CHECK-LABEL: nested_loop:
+; CHECK: callq f
+; CHECK: callq c
+; CHECK: callq d
+; CHECK: callq b
+; CHECK: callq e
+
+entry:
+  br i1 %enter, label %header, label %end, !prof !4
+
+header:
+  call void @b()
+  %call4 = call zeroext i1 @a()
+  br i1 %call4, label %header2, label %end, !prof !5
+
+header2:
+  call void @c()
+  %call = call zeroext i1 @a()
+  br i1 %call, label %if.then, label %if.else, !prof !2
+
+if.then:
+  call void @d()
+  %call3 = call zeroext i1 @a()
+  br i1 %call3, label %header2, label %header, !prof !3
+
+if.else:
+  call void @e()
+  %call2 = call zeroext i1 @a()
+  br i1 %call2, label %header2, label %header, !prof !3
+
+end:
+  call void @f()
+  ret void
+}
+
+declare zeroext i1 @a()
+declare void @b()
+declare void @c()
+declare void @d()
+declare void @e()
+declare void @f()
+
+!1 = !{!"function_entry_count", i64 1}
+!2 = !{!"branch_weights", i32 100, i32 1}
+!3 = !{!"branch_weights", i32 30, i32 1}
+!4 = !{!"branch_weights", i32 1, i32 19}
+!5 = !{!"branch_weights", i32 1, i32 1}
@@ -0,0 +1,55 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -fast-isel -fast-isel-abort=3 -mattr=+popcnt,+lzcnt,+bmi | FileCheck %s
+
+; Check that the bit manipulation intrinsics are selected by FastISel when
+; the subtarget has instructions for them.
+
+; FastISel only lowers i32 and i64 arguments on x86-64.
+define zeroext i16 @bswap16(i32 %x) {
+; CHECK-LABEL: bswap16:
+; CHECK: rolw $8
+  %a = trunc i32 %x to i16
+  %r = call i16 @llvm.bswap.i16(i16 %a)
+  ret i16 %r
+}
+
+define i32 @bswap32(i32 %a) {
+; CHECK-LABEL: bswap32:
+; CHECK: bswapl
+  %r = call i32 @llvm.bswap.i32(i32 %a)
+  ret i32 %r
+}
+
+define i64 @bswap64(i64 %a) {
+; CHECK-LABEL: bswap64:
+; CHECK: bswapq
+  %r = call i64 @llvm.bswap.i64(i64 %a)
+  ret i64 %r
+}
+
+define i32 @ctpop32(i32 %a) {
+; CHECK-LABEL: ctpop32:
+; CHECK: popcntl
+  %r = call i32 @llvm.ctpop.i32(i32 %a)
+  ret i32 %r
+}
+
+define i64 @ctlz64(i64 %a) {
+; CHECK-LABEL: ctlz64:
+; CHECK: lzcntq
+  %r = call i64 @llvm.ctlz.i64(i64 %a, i1 false)
+  ret i64 %r
+}
+
+define i32 @cttz32(i32 %a) {
+; CHECK-LABEL: cttz32:
+; CHECK: tzcntl
+  %r = call i32 @llvm.cttz.i32(i32 %a, i1 true)
+  ret i32 %r
+}
+
+declare i16 @llvm.bswap.i16(i16)
+declare i32 @llvm.bswap.i32(i32)
+declare i64 @llvm.bswap.i64(i64)
+declare i32 @llvm.ctpop.i32(i32)
+declare i64 @llvm.ctlz.i64(i64, i1)
+declare i32 @llvm.cttz.i32(i32, i1)
@@ -0,0 +1,40 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -fast-isel -mattr=+sse2 | FileCheck %s --check-prefix=CHECK --check-prefix=SSE2
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -fast-isel -fast-isel-abort=1 -mattr=+sse4.1 | FileCheck %s --check-prefix=CHECK --check-prefix=SSE41
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -fast-isel -mattr=+sse2 -pass-remarks-missed=sdagisel -o /dev/null 2>&1 | FileCheck %s --check-prefix=REMARK
+
+; Check that extracting scalars from vectors doesn't fall back to
+; SelectionDAG. Lanes other than the first need SSE4.1.
+
+; REMARK-NOT: FastISel missed
+; REMARK: FastISel missed extractelement of type i32
+; REMARK-NOT: FastISel missed
+
+define float @extract_f32(<4 x float> %v) {
+; CHECK-LABEL: extract_f32:
+; CHECK-NOT: mov
+; CHECK: retq
+  %r = extractelement <4 x float> %v, i32 0
+  ret float %r
+}
+
+define i32 @extract_i32(<4 x i32> %v) {
+; CHECK-LABEL: extract_i32:
+; CHECK: movd %xmm0, %eax
+  %r = extractelement <4 x i32> %v, i32 0
+  ret i32 %r
+}
+
+define i64 @extract_i64(<2 x i64> %v) {
+; CHECK-LABEL: extract_i64:
+; CHECK: movd %xmm0, %rax
+  %r = extractelement <2 x i64> %v, i32 0
+  ret i64 %r
+}
+
+define i32 @extract_i32_lane1(<4 x i32> %v) {
+; CHECK-LABEL: extract_i32_lane1:
+; SSE2: pshufd
+; SSE41: pextrd $1, %xmm0, %eax
+  %r = extractelement <4 x i32> %v, i32 1
+  ret i32 %r
+}
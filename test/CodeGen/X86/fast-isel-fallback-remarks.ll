@@ -0,0 +1,28 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -O0 -fast-isel -pass-remarks-missed=sdagisel -o /dev/null 2>&1 | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -O0 -fast-isel -o /dev/null 2>&1 | FileCheck %s --check-prefix=NOREMARKS --allow-empty
+
+; Check that every fallback from FastISel to SelectionDAG is reported as a
+; missed-optimization remark naming the opcode and type that caused it, and
+; that the remarks are only printed when requested.
+
+; NOREMARKS-NOT: remark
+
+; CHECK: remark: <unknown>:0:0: FastISel missed shufflevector of type <4 x i32>
+define <4 x i32> @shuffle(<4 x i32> %a, <4 x i32> %b) {
+  %r = shufflevector <4 x i32> %a, <4 x i32> %b, <4 x i32> <i32 0, i32 4, i32 1, i32 5>
+  ret <4 x i32> %r
+}
+
+; Arguments are lowered before the instructions are selected bottom-up.
+; CHECK: remark: <unknown>:0:0: FastISel didn't lower all arguments
+; CHECK: remark: <unknown>:0:0: FastISel missed ret of type i128
+define i128 @wide(i128 %a, i128 %b) {
+  %r = add i128 %a, %b
+  ret i128 %r
+}
+
+; CHECK-NOT: remark
+define i32 @simple(i32 %a, i32 %b) {
+  %r = add i32 %a, %b
+  ret i32 %r
+}
@@ -0,0 +1,61 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=sandybridge | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=core2 | FileCheck %s -check-prefix=NOFUSION
+
+; Small loops that end in a macro-fused cmp/jcc pair are aligned to 32 bytes
+; on processors that fuse them, so the pair is not split across a 32-byte
+; window.
+
+; CHECK-LABEL: small:
+; CHECK: .p2align 5
+; CHECK-NEXT: .LBB0_1:
+; NOFUSION-LABEL: small:
+; NOFUSION: .p2align 4
+; NOFUSION-NEXT: .LBB0_1:
+define void @small(i32* nocapture %a, i32* nocapture readonly %b, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pb = getelementptr inbounds i32, i32* %b, i64 %i
+  %vb = load i32, i32* %pb, align 4
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  %va = load i32, i32* %pa, align 4
+  %sum = add i32 %va, %vb
+  store i32 %sum, i32* %pa, align 4
+  %i.next = add nuw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; Loops too large for one window keep the default alignment.
+; CHECK-LABEL: large:
+; CHECK: .p2align 4
+; CHECK-NEXT: .LBB1_1:
+define void @large(i32* nocapture %a, i32* nocapture readonly %b, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pb = getelementptr inbounds i32, i32* %b, i64 %i
+  %vb = load volatile i32, i32* %pb, align 4
+  %vb2 = load volatile i32, i32* %pb, align 4
+  %vb3 = load volatile i32, i32* %pb, align 4
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  %va = load i32, i32* %pa, align 4
+  %s1 = mul i32 %va, %vb
+  %s2 = xor i32 %s1, %vb2
+  %s3 = sub i32 %s2, %vb3
+  store volatile i32 %s3, i32* %pa, align 4
+  store volatile i32 %s2, i32* %pa, align 4
+  %i.next = add nuw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,109 @@
+; RUN: llc -enable-machine-outliner -mtriple=x86_64-unknown-linux < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-unknown-linux < %s | FileCheck %s --check-prefix=NOOUTLINE
+
+; The stores repeated in @f1, @f2 and @f3 are outlined. @hot has the same
+; stores, but is hot according to the profile and keeps them.
+
+; CHECK-LABEL: f1:
+; CHECK: callq OUTLINED_FUNCTION_0
+; CHECK-NEXT: retq
+define void @f1(i32* %p) !prof !20 {
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: f2:
+; CHECK: callq OUTLINED_FUNCTION_0
+; CHECK-NEXT: retq
+define void @f2(i32* %p) {
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: f3:
+; CHECK: movl $5, 16(%rdi)
+; CHECK-NEXT: callq OUTLINED_FUNCTION_0
+; CHECK-NEXT: retq
+define void @f3(i32* %p) {
+  %p4 = getelementptr i32, i32* %p, i32 4
+  store volatile i32 5, i32* %p4
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: hot:
+; CHECK-NOT: callq
+; CHECK: movl $1, (%rdi)
+; CHECK: retq
+define void @hot(i32* %p) !prof !21 {
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; A leaf function that keeps data in the red zone can't make calls.
+; CHECK-LABEL: redzone:
+; CHECK-NOT: callq
+; CHECK: retq
+define void @redzone(i32* %p) {
+  %a = alloca i32
+  store volatile i32 0, i32* %a
+  %p1 = getelementptr i32, i32* %p, i32 1
+  %p2 = getelementptr i32, i32* %p, i32 2
+  %p3 = getelementptr i32, i32* %p, i32 3
+  store volatile i32 1, i32* %p
+  store volatile i32 2, i32* %p1
+  store volatile i32 3, i32* %p2
+  store volatile i32 4, i32* %p3
+  ret void
+}
+
+; CHECK-LABEL: OUTLINED_FUNCTION_0:
+; CHECK: movl $1, (%rdi)
+; CHECK-NEXT: movl $2, 4(%rdi)
+; CHECK-NEXT: movl $3, 8(%rdi)
+; CHECK-NEXT: movl $4, 12(%rdi)
+; CHECK-NEXT: retq
+
+; NOOUTLINE-NOT: OUTLINED_FUNCTION
+
+!llvm.module.flags = !{!1}
+!1 = !{i32 1, !"ProfileSummary", !2}
+!2 = !{!3, !4, !5, !6, !7, !8, !9, !10}
+!3 = !{!"ProfileFormat", !"InstrProf"}
+!4 = !{!"TotalCount", i64 10000}
+!5 = !{!"MaxCount", i64 10}
+!6 = !{!"MaxInternalCount", i64 1}
+!7 = !{!"MaxFunctionCount", i64 1000}
+!8 = !{!"NumCounts", i64 3}
+!9 = !{!"NumFunctions", i64 3}
+!10 = !{!"DetailedSummary", !11}
+!11 = !{!12, !13, !14}
+!12 = !{i32 10000, i64 100, i32 1}
+!13 = !{i32 999000, i64 100, i32 1}
+!14 = !{i32 999999, i64 1, i32 2}
+!20 = !{!"function_entry_count", i64 1}
+!21 = !{!"function_entry_count", i64 1000}
@@ -0,0 +1,31 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -enable-misched -misched-window-size=4 -verify-machineinstrs -debug-only=misched -o - 2>&1 | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -enable-misched -misched-window-size=4 -verify-machineinstrs | FileCheck %s --check-prefix=ASM
+; REQUIRES: asserts
+
+; Check that a long straight-line region is scheduled as a series of windows
+; of at most -misched-window-size instructions, and that the result is still
+; correct code.
+
+; CHECK: MI Scheduling
+; CHECK: RegionInstrs: 4
+; CHECK: MI Scheduling
+; CHECK-NOT: RegionInstrs: {{[5-9]|[1-9][0-9]}}
+; CHECK: RegionInstrs: {{[1-4]}}
+; CHECK-NOT: RegionInstrs: {{[5-9]|[1-9][0-9]}}
+
+; ASM-LABEL: chain:
+; ASM: imull
+; ASM: retq
+define i32 @chain(i32 %a, i32 %b, i32 %c, i32 %d) {
+  %1 = add i32 %a, %b
+  %2 = mul i32 %1, %c
+  %3 = xor i32 %2, %d
+  %4 = sub i32 %3, %a
+  %5 = add i32 %4, %b
+  %6 = mul i32 %5, %c
+  %7 = xor i32 %6, %d
+  %8 = sub i32 %7, %a
+  %9 = add i32 %8, %b
+  %10 = mul i32 %9, %c
+  ret i32 %10
+}
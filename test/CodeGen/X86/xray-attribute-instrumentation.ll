@@ -18,6 +18,11 @@ define i32 @foo() nounwind noinline uwtable "function-instrument"="xray-always"
 ; CHECK-LABEL: Lxray_synthetic_0:
 ; CHECK:       .quad .Lxray_sled_0
 ; CHECK:       .quad .Lxray_sled_1
+; CHECK-LABEL: Lxray_sleds_end0:
+; CHECK:       .section xray_fn_idx,{{.*}}
+; CHECK:       .p2align 4
+; CHECK-NEXT:  .quad .Lxray_synthetic_0
+; CHECK-NEXT:  .quad .Lxray_sleds_end0
 
 ; We test multiple returns in a single function to make sure we're getting all
 ; of them with XRay instrumentation.
@@ -50,3 +55,8 @@ NotEqual:
 ; CHECK:       .quad .Lxray_sled_2
 ; CHECK:       .quad .Lxray_sled_3
 ; CHECK:       .quad .Lxray_sled_4
+; CHECK-LABEL: Lxray_sleds_end1:
+; CHECK:       .section xray_fn_idx,{{.*}}
+; CHECK:       .p2align 4
+; CHECK-NEXT:  .quad .Lxray_synthetic_1
+; CHECK-NEXT:  .quad .Lxray_sleds_end1
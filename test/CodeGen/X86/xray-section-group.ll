@@ -6,6 +6,7 @@ define i32 @foo() nounwind noinline uwtable "function-instrument"="xray-always"
 ; CHECK: .section .text.foo,"ax",@progbits
   ret i32 0
 ; CHECK: .section xray_instr_map,"a",@progbits
+; CHECK: .section xray_fn_idx,"a",@progbits
 }
 
 $bar = comdat any
@@ -13,6 +14,8 @@ define i32 @bar() nounwind noinline uwtable "function-instrument"="xray-always"
 ; CHECK: .section .text.bar,"axG",@progbits,bar,comdat
   ret i32 1
 ; CHECK: .section xray_instr_map,"aG",@progbits,bar,comdat
+; CHECK: .section xray_fn_idx,"aG",@progbits,bar,comdat
 }
 
 ; CHECK-OBJ:      section xray_instr_map:
+; CHECK-OBJ:      section xray_fn_idx:
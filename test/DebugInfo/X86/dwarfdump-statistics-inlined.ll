@@ -0,0 +1,86 @@
+; RUN: llc -filetype=obj -o %t.o %s
+; RUN: llvm-dwarfdump -statistics %t.o | FileCheck %s
+
+; Testcase derived from the following, with @bar and @baz kept out of line:
+;; void sink(void);
+;; void use(int);
+;; void bar(int a) { sink(); }
+;; void baz(int c) { use(c); }
+;; void foo(void) {
+;;   bar(0);
+;;   bar(0);
+;;   baz(0);
+;; }
+
+; The abstract "a" and "c" don't count. The three inlined parameters have a
+; constant value and the out-of-line "c" has a location, but the out-of-line
+; "a" is optimized out and only refers to its abstract origin.
+; CHECK: variables with a location: 4 of 5 (80.0%)
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-darwin"
+
+define void @foo() !dbg !4 {
+entry:
+  tail call void @llvm.dbg.value(metadata i32 0, i64 0, metadata !12, metadata !17), !dbg !18
+  tail call void @sink(), !dbg !20
+  tail call void @llvm.dbg.value(metadata i32 0, i64 0, metadata !12, metadata !17), !dbg !21
+  tail call void @sink(), !dbg !23
+  tail call void @llvm.dbg.value(metadata i32 0, i64 0, metadata !27, metadata !17), !dbg !28
+  tail call void @use(i32 0), !dbg !30
+  ret void, !dbg !24
+}
+
+define void @bar(i32 %a) !dbg !7 {
+entry:
+  tail call void @sink(), !dbg !31
+  ret void, !dbg !32
+}
+
+define void @baz(i32 %c) !dbg !25 {
+entry:
+  tail call void @llvm.dbg.value(metadata i32 %c, i64 0, metadata !27, metadata !17), !dbg !33
+  tail call void @use(i32 %c), !dbg !34
+  ret void, !dbg !35
+}
+
+declare void @sink()
+declare void @use(i32)
+declare void @llvm.dbg.value(metadata, i64, metadata, metadata)
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!13, !14}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug, enums: !2)
+!1 = !DIFile(filename: "t.c", directory: "/path/to/dir")
+!2 = !{}
+!4 = distinct !DISubprogram(name: "foo", scope: !1, file: !1, line: 5, type: !5, isLocal: false, isDefinition: true, scopeLine: 5, flags: DIFlagPrototyped, isOptimized: true, unit: !0, variables: !2)
+!5 = !DISubroutineType(types: !6)
+!6 = !{null}
+!7 = distinct !DISubprogram(name: "bar", scope: !1, file: !1, line: 3, type: !8, isLocal: false, isDefinition: true, scopeLine: 3, flags: DIFlagPrototyped, isOptimized: true, unit: !0, variables: !11)
+!8 = !DISubroutineType(types: !9)
+!9 = !{null, !10}
+!10 = !DIBasicType(name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!11 = !{!12}
+!12 = !DILocalVariable(name: "a", arg: 1, scope: !7, file: !1, line: 3, type: !10)
+!13 = !{i32 2, !"Dwarf Version", i32 2}
+!14 = !{i32 2, !"Debug Info Version", i32 3}
+!17 = !DIExpression()
+!18 = !DILocation(line: 3, column: 20, scope: !7, inlinedAt: !19)
+!19 = distinct !DILocation(line: 6, column: 3, scope: !4)
+!20 = !DILocation(line: 3, column: 25, scope: !7, inlinedAt: !19)
+!21 = !DILocation(line: 3, column: 20, scope: !7, inlinedAt: !22)
+!22 = distinct !DILocation(line: 7, column: 3, scope: !4)
+!23 = !DILocation(line: 3, column: 25, scope: !7, inlinedAt: !22)
+!24 = !DILocation(line: 9, column: 1, scope: !4)
+!25 = distinct !DISubprogram(name: "baz", scope: !1, file: !1, line: 4, type: !8, isLocal: false, isDefinition: true, scopeLine: 4, flags: DIFlagPrototyped, isOptimized: true, unit: !0, variables: !26)
+!26 = !{!27}
+!27 = !DILocalVariable(name: "c", arg: 1, scope: !25, file: !1, line: 4, type: !10)
+!28 = !DILocation(line: 4, column: 20, scope: !25, inlinedAt: !29)
+!29 = distinct !DILocation(line: 8, column: 3, scope: !4)
+!30 = !DILocation(line: 4, column: 25, scope: !25, inlinedAt: !29)
+!31 = !DILocation(line: 3, column: 25, scope: !7)
+!32 = !DILocation(line: 3, column: 30, scope: !7)
+!33 = !DILocation(line: 4, column: 20, scope: !25)
+!34 = !DILocation(line: 4, column: 25, scope: !25)
+!35 = !DILocation(line: 4, column: 30, scope: !25)
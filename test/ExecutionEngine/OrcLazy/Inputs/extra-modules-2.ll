@@ -0,0 +1,4 @@
+define i32 @two() {
+entry:
+  ret i32 2
+}
@@ -0,0 +1,8 @@
+declare i32 @two()
+
+define i32 @three() {
+entry:
+  %call = call i32 @two()
+  %ret = add i32 %call, 1
+  ret i32 %ret
+}
@@ -0,0 +1,21 @@
+; RUN: lli -jit-kind=orc-lazy -extra-module %p/Inputs/extra-modules-2.ll \
+; RUN:   -extra-module %p/Inputs/extra-modules-3.ll %s
+; RUN: not lli -jit-kind=orc-lazy -extra-module %p/Inputs/extra-modules-2.ll \
+; RUN:   -extra-module %t.missing.ll %s 2>&1 | FileCheck %s
+;
+; Check that extra modules, which are parsed in parallel, are all linked in,
+; and that a module failing to load is reported.
+
+; CHECK: Could not open input file
+
+declare i32 @two()
+declare i32 @three()
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %a = call i32 @two()
+  %b = call i32 @three()
+  %sum = add i32 %a, %b
+  %ret = sub i32 %sum, 5
+  ret i32 %ret
+}
@@ -0,0 +1,85 @@
+; Test that accesses covered by a dominating check are not instrumented again.
+; RUN: opt < %s -asan -asan-module -asan-opt-dominating -S | FileCheck %s
+; RUN: opt < %s -asan -asan-module -S | FileCheck %s --check-prefix=NOOPT
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @foo()
+
+; The store in %then is dominated by the load of the same address.
+define i32 @cross_block(i32* %a, i1 %c) sanitize_address {
+entry:
+  %x = load i32, i32* %a, align 4
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 1, i32* %a, align 4
+  br label %exit
+
+exit:
+  ret i32 %x
+}
+; CHECK-LABEL: define i32 @cross_block(
+; CHECK: call void @__asan_report_load4
+; CHECK-NOT: call void @__asan_report
+; CHECK: ret i32
+
+; NOOPT-LABEL: define i32 @cross_block(
+; NOOPT: call void @__asan_report_load4
+; NOOPT: call void @__asan_report_store4
+
+; The 4 bytes at offset 4 were checked by the 8 byte load.
+define i32 @wider(i64* %p) sanitize_address {
+entry:
+  %w = load i64, i64* %p, align 8
+  %q = bitcast i64* %p to i32*
+  %q1 = getelementptr i32, i32* %q, i64 1
+  %n = load i32, i32* %q1, align 4
+  ret i32 %n
+}
+; CHECK-LABEL: define i32 @wider(
+; CHECK: call void @__asan_report_load8
+; CHECK-NOT: call void @__asan_report
+; CHECK: ret i32
+
+; A call between the accesses may free the memory.
+define i32 @call_between(i32* %a, i1 %c) sanitize_address {
+entry:
+  %x = load i32, i32* %a, align 4
+  br i1 %c, label %then, label %exit
+
+then:
+  call void @foo()
+  br label %exit
+
+exit:
+  %y = load i32, i32* %a, align 4
+  %r = add i32 %x, %y
+  ret i32 %r
+}
+; CHECK-LABEL: define i32 @call_between(
+; CHECK: call void @__asan_report_load4
+; CHECK: call void @__asan_report_load4
+
+; The call in the loop runs between the check before the loop and the access
+; on the second iteration.
+define void @call_in_loop(i32* %a, i32 %n) sanitize_address {
+entry:
+  store i32 0, i32* %a, align 4
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  store i32 %i, i32* %a, align 4
+  call void @foo()
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+; CHECK-LABEL: define void @call_in_loop(
+; CHECK: call void @__asan_report_store4
+; CHECK: call void @__asan_report_store4
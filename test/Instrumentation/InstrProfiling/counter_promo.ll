@@ -0,0 +1,99 @@
+; RUN: opt < %s -instrprof -do-counter-promotion -S | FileCheck %s
+; RUN: opt < %s -passes=instrprof -do-counter-promotion -S | FileCheck %s
+; RUN: opt < %s -instrprof -S | FileCheck %s --check-prefix=NOPROMO
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@__profn_foo = private constant [3 x i8] c"foo"
+@__profn_nested = private constant [6 x i8] c"nested"
+@__profn_shared_exit = private constant [11 x i8] c"shared_exit"
+
+define void @foo(i32 %n) {
+entry:
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 2, i32 0)
+  br label %loop
+
+; The counter of the loop body is kept in a register in the loop...
+; CHECK-LABEL: loop:
+; CHECK: %[[PHI:pgocount.promoted[0-9]*]] = phi i64 [ 0, %entry ], [ %[[ADD:pgocount.promoted[0-9]*]], %loop ]
+; CHECK-NOT: store
+; CHECK: %[[ADD]] = add i64 %[[PHI]], 1
+; CHECK-NOT: store
+; CHECK: br i1
+
+; NOPROMO-LABEL: loop:
+; NOPROMO: store i64 %{{.*}}, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_foo, i64 0, i64 1)
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 2, i32 1)
+  %inc = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+; ...and added to memory on the loop exit.
+; CHECK-LABEL: {{^}}exit:
+; CHECK: %[[CNT:pgocount[0-9]*]] = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_foo, i64 0, i64 1)
+; CHECK: %[[SUM:[0-9a-z.]+]] = add i64 %[[CNT]], %[[ADD]]
+; CHECK: store i64 %[[SUM]], i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_foo, i64 0, i64 1)
+; CHECK: ret void
+exit:
+  ret void
+}
+
+; The counter of an inner loop is flushed on the exit of the outer loop.
+define void @nested(i32 %n) {
+entry:
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__profn_nested, i32 0, i32 0), i64 0, i32 2, i32 0)
+  br label %outer
+
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ]
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @__profn_nested, i32 0, i32 0), i64 0, i32 2, i32 1)
+  %j.next = add nsw i32 %j, 1
+  %cmp.inner = icmp slt i32 %j.next, %n
+  br i1 %cmp.inner, label %inner, label %outer.latch
+
+; CHECK-LABEL: define void @nested(
+; CHECK-LABEL: outer.latch:
+; CHECK-NOT: store
+; CHECK-LABEL: {{^}}exit:
+; CHECK: load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_nested, i64 0, i64 1)
+; CHECK: store i64 %{{.*}}, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_nested, i64 0, i64 1)
+outer.latch:
+  %i.next = add nsw i32 %i, 1
+  %cmp.outer = icmp slt i32 %i.next, %n
+  br i1 %cmp.outer, label %outer, label %exit
+
+exit:
+  ret void
+}
+
+; The loop exit is shared with the entry block; the loop is given a dedicated
+; exit block and the counter is flushed there.
+define void @shared_exit(i32 %n, i1 %skip) {
+entry:
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([11 x i8], [11 x i8]* @__profn_shared_exit, i32 0, i32 0), i64 0, i32 2, i32 0)
+  br i1 %skip, label %exit, label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([11 x i8], [11 x i8]* @__profn_shared_exit, i32 0, i32 0), i64 0, i32 2, i32 1)
+  %inc = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+; CHECK-LABEL: define void @shared_exit(
+; CHECK-LABEL: exit.loopexit:
+; CHECK: store i64 %{{.*}}, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_shared_exit, i64 0, i64 1)
+; CHECK-LABEL: {{^}}exit:
+; CHECK-NOT: @__profc_shared_exit, i64 0, i64 1
+; CHECK: ret void
+exit:
+  ret void
+}
+
+declare void @llvm.instrprof.increment(i8*, i64, i32, i32)
@@ -0,0 +1,35 @@
+; RUN: opt < %s -instrprof -sampled-instrumentation -S | FileCheck %s
+; RUN: opt < %s -passes=instrprof -sampled-instrumentation -S | FileCheck %s
+; RUN: opt < %s -instrprof -sampled-instrumentation -sampled-instr-period=1000 -sampled-instr-burst-duration=10 -S | FileCheck %s --check-prefix=PERIOD
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@__profn_foo = private constant [3 x i8] c"foo"
+
+; CHECK: @__llvm_profile_sampling = linkonce_odr hidden thread_local global i32 0
+
+define void @foo() {
+entry:
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 1, i32 0)
+  ret void
+}
+
+; CHECK-LABEL: define void @foo()
+; CHECK: %pgo.sampling = load i32, i32* @__llvm_profile_sampling
+; CHECK: %[[NEXT:[0-9]+]] = add i32 %pgo.sampling, 1
+; CHECK: %[[WRAP:[0-9]+]] = icmp uge i32 %[[NEXT]], 65536
+; CHECK: %[[SEL:[0-9]+]] = select i1 %[[WRAP]], i32 0, i32 %[[NEXT]]
+; CHECK: store i32 %[[SEL]], i32* @__llvm_profile_sampling
+; CHECK: %pgo.sampled = icmp ult i32 %pgo.sampling, 200
+; CHECK: br i1 %pgo.sampled, label {{.*}}, !prof ![[BW:[0-9]+]]
+; CHECK: %pgocount = load i64, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @__profc_foo, i64 0, i64 0)
+; CHECK: store i64
+; CHECK: ret void
+; CHECK: ![[BW]] = !{!"branch_weights", i32 200, i32 65336}
+
+; PERIOD: icmp uge i32 %{{.*}}, 1000
+; PERIOD: %pgo.sampled = icmp ult i32 %pgo.sampling, 10
+; PERIOD: br i1 %pgo.sampled, label {{.*}}, !prof ![[BW:[0-9]+]]
+; PERIOD: ![[BW]] = !{!"branch_weights", i32 10, i32 990}
+
+declare void @llvm.instrprof.increment(i8*, i64, i32, i32)
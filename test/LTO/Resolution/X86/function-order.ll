@@ -0,0 +1,87 @@
+; Test profile-guided function ordering in regular LTO.
+; RUN: llvm-as %s -o %t.o
+; RUN: llvm-lto2 -o %t2.o %t.o -profile-function-order \
+; RUN:  -symbol-ordering-file=%t.order \
+; RUN:  -r=%t.o,main,px \
+; RUN:  -r=%t.o,isolated,px \
+; RUN:  -r=%t.o,cold,px \
+; RUN:  -r=%t.o,ext,
+; RUN: FileCheck %s < %t.order
+; RUN: llvm-nm -n %t2.o.0 | FileCheck %s --check-prefix=NM
+
+; The ordering file alone enables the ordering.
+; RUN: llvm-lto2 -o %t3.o %t.o -symbol-ordering-file=%t3.order \
+; RUN:  -r=%t.o,main,px \
+; RUN:  -r=%t.o,isolated,px \
+; RUN:  -r=%t.o,cold,px \
+; RUN:  -r=%t.o,ext,
+; RUN: FileCheck %s < %t3.order
+; RUN: llvm-nm -n %t3.o.0 | FileCheck %s --check-prefix=NM
+
+; @isolated is the densest cluster on its own. The callees of @main follow it
+; in call-chain order. @cold has no profile count and is not ordered.
+; CHECK: isolated
+; CHECK-NEXT: main
+; CHECK-NEXT: hot_a
+; CHECK-NEXT: hot_b
+; CHECK-NEXT: warm
+; CHECK-NOT: cold
+
+; NM: T isolated
+; NM-NEXT: T main
+; NM-NEXT: t hot_a
+; NM-NEXT: t hot_b
+; NM-NEXT: t warm
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @ext()
+
+define void @cold() !prof !0 {
+  call void @ext()
+  ret void
+}
+
+define internal void @warm() noinline !prof !1 {
+  call void @ext()
+  call void @ext()
+  ret void
+}
+
+define internal void @hot_b() noinline !prof !2 {
+  call void @ext()
+  ret void
+}
+
+define internal void @hot_a() noinline !prof !2 {
+  call void @hot_b()
+  ret void
+}
+
+define void @isolated() !prof !3 {
+  call void @ext()
+  ret void
+}
+
+define i32 @main() !prof !1 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  call void @hot_a()
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, 1000
+  br i1 %done, label %exit, label %loop, !prof !4
+
+exit:
+  call void @warm()
+  ret i32 0
+}
+
+!0 = !{!"function_entry_count", i64 0}
+!1 = !{!"function_entry_count", i64 1}
+!2 = !{!"function_entry_count", i64 1000}
+!3 = !{!"function_entry_count", i64 5000}
+!4 = !{!"branch_weights", i32 1, i32 999}
@@ -0,0 +1,19 @@
+; Inputs read ahead with -prefetch are linked exactly like the others.
+; RUN: llvm-as %S/Inputs/basiclink.a.ll -o %t.a.bc
+; RUN: llvm-as %S/Inputs/basiclink.b.ll -o %t.b.bc
+; RUN: llvm-link -S -prefetch=2 %t.a.bc %s %t.b.bc | FileCheck %s
+; RUN: llvm-link -S -prefetch=1 -disable-lazy-loading %t.a.bc %s %t.b.bc \
+; RUN:   | FileCheck %s
+; RUN: not llvm-link -S -prefetch=2 %t.a.bc %t.missing.bc %t.b.bc 2>&1 \
+; RUN:   | FileCheck -check-prefix=MISSING %s
+
+; CHECK-DAG: @baz = global i32 0
+; CHECK-DAG: define i32* @foo(i32 %x)
+; CHECK-DAG: define i32* @bar()
+; CHECK-DAG: define i32 @qux()
+
+; MISSING: Could not open input file
+
+define i32 @qux() {
+  ret i32 0
+}
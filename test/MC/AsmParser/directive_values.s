@@ -81,3 +81,16 @@ TEST9:
 # CHECK: .quad 6510615555426900570
 # CHECK: .quad 4204772546213206618
 
+
+TEST10:
+        .quad 18446744073709551615, 0x8000000000000000
+        .byte 255, 0377, 0b11111111
+        .octa 18446744073709551615
+# CHECK: TEST10
+# CHECK: .quad -1
+# CHECK: .quad -9223372036854775808
+# CHECK: .byte 255
+# CHECK: .byte 255
+# CHECK: .byte 255
+# CHECK: .quad -1
+# CHECK: .quad 0
@@ -0,0 +1,46 @@
+; RUN: llc -filetype=obj %s -o - | llvm-objdump -d -r - | FileCheck %s
+
+; Check that the LEB128 instruction encoding disassembles back to the same
+; instructions, including multi-byte and negative immediates and operands
+; carrying a relocation.
+
+target datalayout = "e-m:e-p:32:32-i64:64-n32:64-S128"
+target triple = "wasm32-unknown-unknown"
+
+@g = global i32 7
+
+define internal i32 @callee(i32 %x) {
+  ret i32 %x
+}
+
+; CHECK-LABEL: f:
+; CHECK:      i32.const $push[[C:[0-9]+]]=, -5000000
+; CHECK-NEXT: i32.add $push[[A:[0-9]+]]=, $pop{{[0-9]+}}, $pop[[C]]
+; CHECK-NEXT: i32.call $push[[R:[0-9]+]]=, 0, $pop[[A]]
+; CHECK-NEXT: R_WEBASSEMBLY_FUNCTION .text
+; CHECK-NEXT: i32.const $push[[Z:[0-9]+]]=, 0
+; CHECK-NEXT: i32.load $push[[L:[0-9]+]]=, 0($pop[[Z]])
+; CHECK-NEXT: R_WEBASSEMBLY_DATA g+0
+; CHECK-NEXT: i32.add $push{{[0-9]+}}=, $pop[[R]], $pop[[L]]
+define i32 @f(i32 %x) {
+  %m = mul i32 %x, 1000000
+  %a = add i32 %m, -5000000
+  %c = call i32 @callee(i32 %a)
+  %l = load i32, i32* @g
+  %r = add i32 %c, %l
+  ret i32 %r
+}
+
+; The in-place addend of a relocated operand is re-encoded as a padded
+; ULEB128 rather than masked into its bytes.
+
+@arr = global [1000 x i32] zeroinitializer
+
+; CHECK-LABEL: large_offset:
+; CHECK:      i32.load $push{{[0-9]+}}=, 1200($pop{{[0-9]+}})
+; CHECK-NEXT: R_WEBASSEMBLY_DATA arr+0
+define i32 @large_offset() {
+  %p = getelementptr [1000 x i32], [1000 x i32]* @arr, i32 0, i32 300
+  %l = load i32, i32* %p
+  ret i32 %l
+}
@@ -0,0 +1,16 @@
+; The loop pass adaptor doesn't compute the loop analyses for a function
+; without loops.
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='loop(no-op-loop)' %s 2>&1 | FileCheck %s
+; CHECK: Running pass: FunctionToLoopPassAdaptor
+; CHECK-NEXT: Running analysis: InnerAnalysisManagerProxy<{{.*}}>
+; CHECK-NEXT: Running analysis: LoopAnalysis
+; CHECK-NEXT: Running analysis: DominatorTreeAnalysis
+; CHECK-NOT: ScalarEvolutionAnalysis
+; CHECK-NOT: Running pass: NoOpLoopPass
+; CHECK: Finished {{.*}}Function pass manager run
+
+define void @f() {
+entry:
+  ret void
+}
@@ -0,0 +1,49 @@
+; Check that -batch optimizes each listed module as a separate opt run would.
+; RUN: rm -rf %t && mkdir -p %t
+; RUN: echo "%s %t/a.bc" > %t/batch.txt
+; RUN: echo "# Comments and blank lines are skipped." >> %t/batch.txt
+; RUN: echo "" >> %t/batch.txt
+; RUN: echo "%s %t/b.bc" >> %t/batch.txt
+; RUN: opt -batch %t/batch.txt -batch-threads=2 -deadargelim
+; RUN: opt -deadargelim %s -o %t/single.bc
+; RUN: cmp %t/single.bc %t/a.bc
+; RUN: cmp %t/single.bc %t/b.bc
+; RUN: llvm-dis < %t/a.bc | FileCheck %s
+
+; RUN: echo "%s" > %t/bad.txt
+; RUN: not opt -batch %t/bad.txt -deadargelim 2>&1 \
+; RUN:   | FileCheck --check-prefix=BAD %s
+; BAD: bad.txt:1: expected an input and an output file
+
+; RUN: echo "%t/missing.ll %t/c.bc" > %t/missing.txt
+; RUN: echo "%s %t/d.bc" >> %t/missing.txt
+; RUN: not opt -batch %t/missing.txt -deadargelim 2>&1 \
+; RUN:   | FileCheck --check-prefix=MISSING %s
+; RUN: cmp %t/single.bc %t/d.bc
+; MISSING: missing.ll: error: Could not open input file
+
+; RUN: not opt -batch %t/batch.txt -deadargelim -print-after-all 2>&1 \
+; RUN:   | FileCheck --check-prefix=PRINT %s
+; PRINT: -batch cannot be used with -print-after-all
+
+; RUN: not opt -batch %t/batch.txt -deadargelim -o %t/e.bc 2>&1 \
+; RUN:   | FileCheck --check-prefix=OUTPUT %s
+; RUN: not opt -batch %t/batch.txt -deadargelim %s 2>&1 \
+; RUN:   | FileCheck --check-prefix=OUTPUT %s
+; OUTPUT: -batch cannot be used with an input file or -o
+
+; RUN: echo "%s %t/f.bc" > %t/duplicate.txt
+; RUN: echo "%s %t/f.bc" >> %t/duplicate.txt
+; RUN: not opt -batch %t/duplicate.txt -deadargelim 2>&1 \
+; RUN:   | FileCheck --check-prefix=DUPLICATE %s
+; DUPLICATE: duplicate.txt:2: output file '{{.*}}f.bc' is written more than once
+
+; CHECK: define internal void @test
+define internal {} @test() {
+  ret {} undef
+}
+
+define void @caller() {
+  call {} @test()
+  ret void
+}
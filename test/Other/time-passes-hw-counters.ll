@@ -0,0 +1,17 @@
+; Hardware counters may not be available on the host, in which case their
+; columns are left out; either way the report must still be printed.
+; RUN: opt < %s -instcombine -time-passes -track-hw-counters -info-output-file=- -disable-output | FileCheck %s
+; RUN: opt < %s -instcombine -time-passes -track-hw-counters -timers-json -info-output-file=- -disable-output | FileCheck %s --check-prefix=JSON
+
+; CHECK: Pass execution timing report
+; CHECK: ---Wall Time---
+; CHECK: Combine redundant instructions
+; CHECK: Total
+
+; JSON: {"group":"... Pass execution timing report ...","timers":[
+; JSON-SAME: {"name":"Combine redundant instructions","wall":{{[0-9.]+}},"user":{{[0-9.]+}},"sys":{{[0-9.]+}},"mem":{{-?[0-9]+}},"cycles":{{-?[0-9]+}},"instructions":{{-?[0-9]+}},"cache-misses":{{-?[0-9]+}},"branch-misses":{{-?[0-9]+}}}
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
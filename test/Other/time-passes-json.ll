@@ -0,0 +1,10 @@
+; RUN: opt < %s -instcombine -time-passes -timers-json -info-output-file=- -disable-output | FileCheck %s
+
+; CHECK: {"group":"... Pass execution timing report ...","timers":[
+; CHECK-SAME: {"name":"Combine redundant instructions","wall":{{[0-9.]+}},"user":{{[0-9.]+}},"sys":{{[0-9.]+}},"mem":{{-?[0-9]+}}}
+; CHECK-SAME: ],"total":{"wall":{{[0-9.]+}},"user":{{[0-9.]+}},"sys":{{[0-9.]+}},"mem":{{-?[0-9]+}}}}{{$}}
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
@@ -0,0 +1,11 @@
+; RUN: opt < %s -o /dev/null -instsimplify -track-pass-memory 2>&1 | FileCheck %s
+; RUN: opt < %s -o /dev/null -instsimplify -track-pass-memory -info-output-file %t && FileCheck %s < %t
+
+; CHECK: ... Pass memory usage report ...
+; CHECK: Peak malloc usage: {{[0-9]+}} bytes, after '{{.*}}' on '{{.*}}'
+; CHECK: Largest growth: {{[0-9]+}} bytes, during '{{.*}}' on '{{.*}}'
+
+define i32 @foo(i32 %x) {
+  %add = add i32 %x, 0
+  ret i32 %add
+}
@@ -0,0 +1,21 @@
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@vt1 = constant [1 x i8*] [i8* bitcast (i32 (i8*)* @vf1 to i8*)], !type !0
+@vt2a = constant [1 x i8*] [i8* bitcast (i32 (i8*)* @vf2a to i8*)], !type !1
+@vt2b = constant [1 x i8*] [i8* bitcast (i32 (i8*)* @vf2b to i8*)], !type !1
+
+define i32 @vf1(i8* %this) {
+  ret i32 1
+}
+
+define i32 @vf2a(i8* %this) {
+  ret i32 2
+}
+
+define i32 @vf2b(i8* %this) {
+  ret i32 3
+}
+
+!0 = !{i64 0, !"typeid1"}
+!1 = !{i64 0, !"typeid2"}
@@ -0,0 +1,15 @@
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@cfg = external global i32
+
+; A local used by inline assembly prevents renaming, so the module gets no
+; summaries and the store below is not seen by the thin link.
+@local = internal global i32 0
+@llvm.used = appending global [1 x i8*] [i8* bitcast (i32* @local to i8*)], section "llvm.metadata"
+
+define void @setcfg() {
+  call void asm sideeffect "", ""()
+  store i32 1, i32* @cfg
+  ret void
+}
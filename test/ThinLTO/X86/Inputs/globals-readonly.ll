@@ -0,0 +1,16 @@
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@cfg = global i32 42
+@wo = global i32 7
+@escaped = global i32 3
+
+define void @setwo(i32 %v) {
+  store i32 %v, i32* @wo
+  ret void
+}
+
+define i32 @getescaped() {
+  %v = load i32, i32* @escaped
+  ret i32 %v
+}
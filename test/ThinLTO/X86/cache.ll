@@ -29,6 +29,29 @@
 ; RUN: ls %t.cache/llvmcache.timestamp
 ; RUN: ls %t.cache | count 3
 
+; Verify that summaries are cached as well when requested, and that a second
+; link reuses them.
+; RUN: rm -Rf %t.cache && mkdir %t.cache
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=globalfunc %t2.bc  %t.bc -thinlto-cache-dir %t.cache -thinlto-cache-summaries
+; RUN: ls %t.cache | count 5
+; RUN: ls %t.cache | grep summary- | count 2
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=globalfunc %t2.bc  %t.bc -thinlto-cache-dir %t.cache -thinlto-cache-summaries
+; RUN: ls %t.cache | count 5
+
+; Verify that objects are also cached by optimized module when requested, and
+; that a second link doesn't add entries.
+; RUN: rm -Rf %t.cache && mkdir %t.cache
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=globalfunc %t2.bc  %t.bc -thinlto-cache-dir %t.cache -thinlto-cache-codegen
+; RUN: ls %t.cache | count 5
+; RUN: ls %t.cache | grep codegen- | count 2
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=globalfunc %t2.bc  %t.bc -thinlto-cache-dir %t.cache -thinlto-cache-codegen
+; RUN: ls %t.cache | count 5
+; Different target options must not reuse those objects. The per-module
+; entries do not depend on them, so drop them to reach the codegen cache.
+; RUN: rm %t.cache/[0-9A-F]*
+; RUN: llvm-lto -thinlto-action=run -exported-symbol=globalfunc %t2.bc  %t.bc -thinlto-cache-dir %t.cache -thinlto-cache-codegen -function-sections
+; RUN: ls %t.cache | grep codegen- | count 4
+
 ; Verify that enabling caching is working with llvm-lto2
 ; RUN: rm -Rf %t.cache && mkdir %t.cache
 ; RUN: llvm-lto2 -o %t.o %t2.bc  %t.bc -cache-dir %t.cache \
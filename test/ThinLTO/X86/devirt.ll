@@ -0,0 +1,62 @@
+; Check that the ThinLTO backends devirtualize a virtual call when every vtable
+; of its type identifier, whichever module defines it, holds the same function.
+
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/devirt.ll -o %t2.bc
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.o -save-temps \
+; RUN:     -r=%t1.bc,call1,px \
+; RUN:     -r=%t1.bc,call2,px \
+; RUN:     -r=%t2.bc,vt1,p \
+; RUN:     -r=%t2.bc,vt2a,p \
+; RUN:     -r=%t2.bc,vt2b,p \
+; RUN:     -r=%t2.bc,vf1,p \
+; RUN:     -r=%t2.bc,vf2a,p \
+; RUN:     -r=%t2.bc,vf2b,p
+; RUN: llvm-dis %t.o.0.3.import.bc -o - | FileCheck %s
+; RUN: llvm-dis %t.o.1.3.import.bc -o - | FileCheck %s --check-prefix=TARGET
+
+; The assumptions are dropped whether or not the call was devirtualized.
+; CHECK-NOT: llvm.assume
+
+; CHECK-LABEL: define i32 @call1(
+; CHECK: call i32 @vf1(i8* %obj)
+
+; typeid2 has two implementations, so the call stays indirect.
+; CHECK-LABEL: define i32 @call2(
+; CHECK: call i32 %fptr_casted(i8* %obj)
+
+; The devirtualized target must not be internalized in its module.
+; TARGET: define i32 @vf1(
+; TARGET: define internal i32 @vf2a(
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @call1(i8* %obj) {
+  %vtableptr = bitcast i8* %obj to [1 x i8*]**
+  %vtable = load [1 x i8*]*, [1 x i8*]** %vtableptr
+  %vtablei8 = bitcast [1 x i8*]* %vtable to i8*
+  %p = call i1 @llvm.type.test(i8* %vtablei8, metadata !"typeid1")
+  call void @llvm.assume(i1 %p)
+  %fptrptr = getelementptr [1 x i8*], [1 x i8*]* %vtable, i32 0, i32 0
+  %fptr = load i8*, i8** %fptrptr
+  %fptr_casted = bitcast i8* %fptr to i32 (i8*)*
+  %result = call i32 %fptr_casted(i8* %obj)
+  ret i32 %result
+}
+
+define i32 @call2(i8* %obj) {
+  %vtableptr = bitcast i8* %obj to [1 x i8*]**
+  %vtable = load [1 x i8*]*, [1 x i8*]** %vtableptr
+  %vtablei8 = bitcast [1 x i8*]* %vtable to i8*
+  %p = call i1 @llvm.type.test(i8* %vtablei8, metadata !"typeid2")
+  call void @llvm.assume(i1 %p)
+  %fptrptr = getelementptr [1 x i8*], [1 x i8*]* %vtable, i32 0, i32 0
+  %fptr = load i8*, i8** %fptrptr
+  %fptr_casted = bitcast i8* %fptr to i32 (i8*)*
+  %result = call i32 %fptr_casted(i8* %obj)
+  ret i32 %result
+}
+
+declare i1 @llvm.type.test(i8*, metadata)
+declare void @llvm.assume(i1)
@@ -0,0 +1,50 @@
+; Check that the distributed backend indexes can be written in the flat format
+; and that consumers see the same summaries as with the bitcode format.
+
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/emit_imports.ll -o %t2.bc
+
+; RUN: rm -f %t1.bc.thinlto.bc %t2.bc.thinlto.bc
+; RUN: rm -f %t1.bc.thinlto.fsi %t2.bc.thinlto.fsi
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.o -thinlto-distributed-indexes \
+; RUN:     -r=%t1.bc,g, \
+; RUN:     -r=%t1.bc,f,px \
+; RUN:     -r=%t2.bc,g,px
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.o -thinlto-distributed-indexes \
+; RUN:     -thinlto-flat-index \
+; RUN:     -r=%t1.bc,g, \
+; RUN:     -r=%t1.bc,f,px \
+; RUN:     -r=%t2.bc,g,px
+
+; The slice for %t1.bc holds f and the imported g; the one for %t2.bc only g.
+; RUN: llvm-lto -thinlto-index-stats %t1.bc.thinlto.bc %t1.bc.thinlto.fsi \
+; RUN:     %t2.bc.thinlto.bc %t2.bc.thinlto.fsi | FileCheck %s --check-prefix=STATS
+; STATS: thinlto.bc contains 2 nodes (2 functions, 0 alias, 0 globals) and 1 edges (0 refs and 1 calls)
+; STATS: thinlto.fsi contains 2 nodes (2 functions, 0 alias, 0 globals) and 1 edges (0 refs and 1 calls)
+; STATS: thinlto.bc contains 1 nodes (1 functions, 0 alias, 0 globals) and 0 edges (0 refs and 0 calls)
+; STATS: thinlto.fsi contains 1 nodes (1 functions, 0 alias, 0 globals) and 0 edges (0 refs and 0 calls)
+
+; Importing with either index gives the same module.
+; RUN: llvm-lto -thinlto-action=import %t1.bc -thinlto-index=%t1.bc.thinlto.bc \
+; RUN:     -o %t1.bc.imported
+; RUN: llvm-lto -thinlto-action=import %t1.bc -thinlto-index=%t1.bc.thinlto.fsi \
+; RUN:     -o %t1.fsi.imported
+; RUN: llvm-dis %t1.bc.imported -o - | FileCheck %s --check-prefix=IMPORT
+; RUN: llvm-dis %t1.fsi.imported -o - | FileCheck %s --check-prefix=IMPORT
+; IMPORT: define available_externally void @g()
+
+; A truncated flat index is rejected.
+; RUN: head -c 40 %t1.bc.thinlto.fsi > %t.bad.fsi
+; RUN: not llvm-lto -thinlto-index-stats %t.bad.fsi 2>&1 | FileCheck %s --check-prefix=BAD
+; BAD: error loading file
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @g(...)
+
+define void @f() {
+entry:
+  call void (...) @g()
+  ret void
+}
@@ -28,6 +28,15 @@
 ; IMPORTGLOB1-NOT: @linkoncefunc
 ; IMPORTGLOB1-NOT: declare void @globalfunc2
 
+; The import and export lists come out the same when they are computed for
+; several modules at once.
+; RUN: llvm-lto -thinlto-action=import -threads=1 %t2.bc -thinlto-index=%t3.bc -o %t2.import1.bc
+; RUN: llvm-lto -thinlto-action=import -threads=4 %t2.bc -thinlto-index=%t3.bc -o %t2.import4.bc
+; RUN: cmp %t2.import1.bc %t2.import4.bc
+; RUN: llvm-lto -thinlto-action=internalize -threads=1 %t.bc -thinlto-index=%t3.bc -o %t.internalize1.bc
+; RUN: llvm-lto -thinlto-action=internalize -threads=4 %t.bc -thinlto-index=%t3.bc -o %t.internalize4.bc
+; RUN: cmp %t.internalize1.bc %t.internalize4.bc
+
 ; Verify that the optimizer run
 ; RUN: llvm-lto -thinlto-action=optimize %t2.bc -o - | llvm-dis -o - | FileCheck %s --check-prefix=OPTIMIZED
 ; OPTIMIZED: define i32 @main()
@@ -0,0 +1,69 @@
+; Check that the thin link finds the global variables that are never written,
+; or never read, and that the backends use it.
+
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/globals-readonly.ll -o %t2.bc
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.o -save-temps \
+; RUN:     -r=%t1.bc,readcfg,px \
+; RUN:     -r=%t1.bc,cfg, \
+; RUN:     -r=%t2.bc,cfg,p \
+; RUN:     -r=%t2.bc,wo,p \
+; RUN:     -r=%t2.bc,escaped,px \
+; RUN:     -r=%t2.bc,setwo,px \
+; RUN:     -r=%t2.bc,getescaped,px
+; RUN: llvm-dis %t.o.0.3.import.bc -o - | FileCheck %s --check-prefix=IMPORT
+; RUN: llvm-dis %t.o.1.3.import.bc -o - | FileCheck %s --check-prefix=DEF
+
+; The read-only @cfg is imported along with its initializer.
+; IMPORT: @cfg = available_externally constant i32 42
+
+; DEF: @cfg = constant i32 42
+; The initializer of the write-only @wo is dropped.
+; DEF: @wo = {{.*}}global i32 0
+; @escaped is visible to a regular object, which may write to it.
+; DEF: @escaped = global i32 3
+
+; With -import-readonly-globals=false, @cfg stays a declaration.
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.noimport.o -save-temps \
+; RUN:     -import-readonly-globals=false \
+; RUN:     -r=%t1.bc,readcfg,px \
+; RUN:     -r=%t1.bc,cfg, \
+; RUN:     -r=%t2.bc,cfg,p \
+; RUN:     -r=%t2.bc,wo,p \
+; RUN:     -r=%t2.bc,escaped,px \
+; RUN:     -r=%t2.bc,setwo,px \
+; RUN:     -r=%t2.bc,getescaped,px
+; RUN: llvm-dis %t.noimport.o.0.3.import.bc -o - \
+; RUN:     | FileCheck %s --check-prefix=NOIMPORT
+; NOIMPORT: @cfg = external global i32
+
+; A module without summaries that writes @cfg makes the index incomplete, so
+; nothing is inferred.
+; RUN: opt -module-summary %p/Inputs/globals-readonly-asm.ll -o %t3.bc
+; RUN: llvm-bcanalyzer -dump %t3.bc | FileCheck %s --check-prefix=BCAN
+; BCAN: <GLOBALVAL_SUMMARY_BLOCK
+; BCAN-NEXT: <VERSION
+; BCAN-NEXT: <INCOMPLETE/>
+; RUN: llvm-lto2 %t1.bc %t2.bc %t3.bc -o %t.asm.o -save-temps \
+; RUN:     -r=%t1.bc,readcfg,px \
+; RUN:     -r=%t1.bc,cfg, \
+; RUN:     -r=%t2.bc,cfg,p \
+; RUN:     -r=%t2.bc,wo,p \
+; RUN:     -r=%t2.bc,escaped,px \
+; RUN:     -r=%t2.bc,setwo,px \
+; RUN:     -r=%t2.bc,getescaped,px \
+; RUN:     -r=%t3.bc,cfg, \
+; RUN:     -r=%t3.bc,setcfg,px
+; RUN: llvm-dis %t.asm.o.1.3.import.bc -o - \
+; RUN:     | FileCheck %s --check-prefix=ASM
+; ASM: @cfg = global i32 42
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@cfg = external global i32
+
+define i32 @readcfg() {
+  %v = load i32, i32* @cfg
+  ret i32 %v
+}
@@ -0,0 +1,53 @@
+; Check that running the backend jobs out of process, with llvm-lto2 itself as
+; the worker, produces the same objects as running them in process.
+
+; RUN: opt -module-hash -module-summary %s -o %t.bc
+; RUN: opt -module-hash -module-summary %p/Inputs/cache.ll -o %t2.bc
+
+; RUN: llvm-lto2 -o %t.inproc %t2.bc %t.bc \
+; RUN:  -r=%t2.bc,_main,plx \
+; RUN:  -r=%t2.bc,_globalfunc,lx \
+; RUN:  -r=%t.bc,_globalfunc,plx
+; RUN: llvm-lto2 -o %t.outproc %t2.bc %t.bc -thinlto-job-command=llvm-lto2 \
+; RUN:  -r=%t2.bc,_main,plx \
+; RUN:  -r=%t2.bc,_globalfunc,lx \
+; RUN:  -r=%t.bc,_globalfunc,plx
+; RUN: cmp %t.inproc.0 %t.outproc.0
+; RUN: cmp %t.inproc.1 %t.outproc.1
+; RUN: llvm-nm %t.outproc.0 | FileCheck %s --check-prefix=NM0
+; RUN: llvm-nm %t.outproc.1 | FileCheck %s --check-prefix=NM1
+
+; NM0: T _main
+; NM1: T _globalfunc
+
+; Jobs are only dispatched on a cache miss: once the cache is warm, a bogus
+; job command is never invoked.
+; RUN: rm -Rf %t.cache && mkdir %t.cache
+; RUN: llvm-lto2 -o %t.cached %t2.bc %t.bc -thinlto-job-command=llvm-lto2 \
+; RUN:  -cache-dir %t.cache \
+; RUN:  -r=%t2.bc,_main,plx \
+; RUN:  -r=%t2.bc,_globalfunc,lx \
+; RUN:  -r=%t.bc,_globalfunc,plx
+; RUN: ls %t.cache | count 2
+; RUN: llvm-lto2 -o %t.cached %t2.bc %t.bc -thinlto-job-command=false \
+; RUN:  -cache-dir %t.cache \
+; RUN:  -r=%t2.bc,_main,plx \
+; RUN:  -r=%t2.bc,_globalfunc,lx \
+; RUN:  -r=%t.bc,_globalfunc,plx
+; RUN: cmp %t.inproc.0 %t.cached.0
+; RUN: cmp %t.inproc.1 %t.cached.1
+
+; A job the worker cannot run is reported as a link error.
+; RUN: not llvm-lto2 -o %t.bad %t2.bc %t.bc -thinlto-job-command=false \
+; RUN:  -r=%t2.bc,_main,plx \
+; RUN:  -r=%t2.bc,_globalfunc,lx \
+; RUN:  -r=%t.bc,_globalfunc,plx 2>&1 | FileCheck %s --check-prefix=ERR
+; ERR: backend job for '{{.*}}' failed
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+define void @globalfunc() {
+entry:
+  ret void
+}
@@ -0,0 +1,34 @@
+; RUN: opt -codegenprepare -S < %s | FileCheck %s
+
+; The zext can only be moved next to the load, to form an extending load,
+; once the load has no other users. The other user is a trivial PHI in a later
+; block, which CodeGenPrepare removes only after it has already visited the
+; zext's block, so the zext moves in the next sweep even though nothing in
+; %use itself changed.
+
+target triple = "nvptx64-nvidia-cuda"
+
+; CHECK-LABEL: @foo(
+; CHECK: entry:
+; CHECK-NEXT: %ld = load i16, i16* %p
+; CHECK-NEXT: %z = zext i16 %ld to i32
+; CHECK: use:
+; CHECK-NEXT: store i32 %z, i32* %q
+; CHECK: merge:
+; CHECK-NOT: phi
+; CHECK: ret void
+
+define void @foo(i16* %p, i32* %q, i1 %c) {
+entry:
+  %ld = load i16, i16* %p
+  br i1 %c, label %use, label %merge
+
+use:
+  %z = zext i16 %ld to i32
+  store i32 %z, i32* %q
+  br label %merge
+
+merge:
+  %phi = phi i16 [ %ld, %entry ], [ %ld, %use ]
+  ret void
+}
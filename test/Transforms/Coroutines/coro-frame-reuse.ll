@@ -0,0 +1,130 @@
+; Tests that spilled values whose live ranges in the coroutine frame do not
+; overlap share a frame field.
+; RUN: opt < %s -coro-split -S | FileCheck %s
+; RUN: opt < %s -coro-split -coro-reuse-frame-slots=false -S \
+; RUN:     | FileCheck %s -check-prefix=NOREUSE
+
+; %a is reloaded after every suspend of the loop, so its field stays live
+; around the back edge and can't be shared. %b and %c are each live across
+; one suspend of an iteration and share a field.
+define i8* @loop() "coroutine.presplit"="1" {
+entry:
+  %id = call token @llvm.coro.id(i32 0, i8* null, i8* null, i8* null)
+  %size = call i32 @llvm.coro.size.i32()
+  %alloc = call i8* @malloc(i32 %size)
+  %hdl = call i8* @llvm.coro.begin(token %id, i8* %alloc)
+  %a = call i32 @get()
+  br label %loop
+loop:
+  %b = call i32 @get()
+  %0 = call i8 @llvm.coro.suspend(token none, i1 false)
+  switch i8 %0, label %suspend [i8 0, label %resume1
+                                i8 1, label %cleanup]
+resume1:
+  call void @print(i32 %a)
+  call void @print(i32 %b)
+  %c = call i32 @get()
+  %1 = call i8 @llvm.coro.suspend(token none, i1 false)
+  switch i8 %1, label %suspend [i8 0, label %resume2
+                                i8 1, label %cleanup]
+resume2:
+  call void @print(i32 %a)
+  call void @print(i32 %c)
+  br label %loop
+
+cleanup:
+  %mem = call i8* @llvm.coro.free(token %id, i8* %hdl)
+  call void @free(i8* %mem)
+  br label %suspend
+suspend:
+  call void @llvm.coro.end(i8* %hdl, i1 0)
+  ret i8* %hdl
+}
+
+; CHECK: %loop.Frame = type { void (%loop.Frame*)*, void (%loop.Frame*)*, i1, i1, i32, i32 }
+; NOREUSE: %loop.Frame = type { void (%loop.Frame*)*, void (%loop.Frame*)*, i1, i1, i32, i32, i32 }
+
+; %a and %b are both live across the same suspend.
+define i8* @overlap() "coroutine.presplit"="1" {
+entry:
+  %id = call token @llvm.coro.id(i32 0, i8* null, i8* null, i8* null)
+  %size = call i32 @llvm.coro.size.i32()
+  %alloc = call i8* @malloc(i32 %size)
+  %hdl = call i8* @llvm.coro.begin(token %id, i8* %alloc)
+  %a = call i32 @get()
+  %b = call i32 @get()
+  %0 = call i8 @llvm.coro.suspend(token none, i1 false)
+  switch i8 %0, label %suspend [i8 0, label %resume
+                                i8 1, label %cleanup]
+resume:
+  call void @print(i32 %a)
+  call void @print(i32 %b)
+  br label %cleanup
+
+cleanup:
+  %mem = call i8* @llvm.coro.free(token %id, i8* %hdl)
+  call void @free(i8* %mem)
+  br label %suspend
+suspend:
+  call void @llvm.coro.end(i8* %hdl, i1 0)
+  ret i8* %hdl
+}
+
+; CHECK: %overlap.Frame = type { void (%overlap.Frame*)*, void (%overlap.Frame*)*, i1, i1, i32, i32 }
+; NOREUSE: %overlap.Frame = type { void (%overlap.Frame*)*, void (%overlap.Frame*)*, i1, i1, i32, i32 }
+
+define i8* @f() "coroutine.presplit"="1" {
+entry:
+  %id = call token @llvm.coro.id(i32 0, i8* null, i8* null, i8* null)
+  %size = call i32 @llvm.coro.size.i32()
+  %alloc = call i8* @malloc(i32 %size)
+  %hdl = call i8* @llvm.coro.begin(token %id, i8* %alloc)
+  %a = call i32 @get()
+  %0 = call i8 @llvm.coro.suspend(token none, i1 false)
+  switch i8 %0, label %suspend [i8 0, label %resume1
+                                i8 1, label %cleanup]
+resume1:
+  call void @print(i32 %a)
+  %b = call i32 @get()
+  %1 = call i8 @llvm.coro.suspend(token none, i1 false)
+  switch i8 %1, label %suspend [i8 0, label %resume2
+                                i8 1, label %cleanup]
+resume2:
+  call void @print(i32 %b)
+  br label %cleanup
+
+cleanup:
+  %mem = call i8* @llvm.coro.free(token %id, i8* %hdl)
+  call void @free(i8* %mem)
+  br label %suspend
+suspend:
+  call void @llvm.coro.end(i8* %hdl, i1 0)
+  ret i8* %hdl
+}
+
+; %a is dead in the frame by the time %b is stored into it.
+; CHECK: %f.Frame = type { void (%f.Frame*)*, void (%f.Frame*)*, i1, i1, i32 }
+; NOREUSE: %f.Frame = type { void (%f.Frame*)*, void (%f.Frame*)*, i1, i1, i32, i32 }
+
+; CHECK-LABEL: @f.resume(
+; CHECK: %[[ADDR:.+]] = getelementptr inbounds %f.Frame, %f.Frame* %FramePtr, i32 0, i32 4
+; CHECK: %[[A:.+]] = load i32, i32* %[[ADDR]]
+; CHECK: call void @print(i32 %[[A]])
+; CHECK: %b = call i32 @get()
+; CHECK: store i32 %b, i32* %[[ADDR]]
+
+declare i8* @llvm.coro.free(token, i8*)
+declare i32 @llvm.coro.size.i32()
+declare i8  @llvm.coro.suspend(token, i1)
+declare void @llvm.coro.resume(i8*)
+declare void @llvm.coro.destroy(i8*)
+
+declare token @llvm.coro.id(i32, i8*, i8*, i8*)
+declare i1 @llvm.coro.alloc(token)
+declare i8* @llvm.coro.begin(token, i8*)
+declare void @llvm.coro.end(i8*, i1)
+
+declare noalias i8* @malloc(i32)
+declare i32 @get()
+declare void @print(i32)
+declare void @free(i8*)
@@ -1,4 +1,5 @@
 ; RUN: opt < %s -correlated-propagation -S | FileCheck %s
+; RUN: opt < %s -correlated-propagation -lvi-max-cache-entries=1 -S | FileCheck %s
 ; PR2581
 
 ; CHECK-LABEL: @test1(
@@ -5,6 +5,9 @@
 
 ; Do the import now and confirm that metadata is linked for imported function.
 ; RUN: opt -function-import -summary-file %t3.thinlto.bc %t.bc -S | FileCheck %s
+; Same when the metadata records of the source module are loaded on demand.
+; RUN: opt -function-import -summary-file %t3.thinlto.bc %t.bc -S \
+; RUN:   -bitcode-lazy-metadata-records | FileCheck %s
 
 ; CHECK: define available_externally void @func()
 
@@ -0,0 +1,60 @@
+; RUN: opt < %s -gvn -gvn-memssa-loads -S | FileCheck %s
+
+; A store in a dominating block provides the value of the loads below, and
+; nothing on the paths in between writes memory.
+define i32 @dominating_store(i32* %p, i32 %x, i1 %c) {
+; CHECK-LABEL: @dominating_store(
+; CHECK-NOT:     load
+; CHECK:         ret i32 %x
+entry:
+  store i32 %x, i32* %p
+  br i1 %c, label %left, label %right
+
+left:
+  br label %merge
+
+right:
+  br label %merge
+
+merge:
+  %v = load i32, i32* %p
+  ret i32 %v
+}
+
+; A narrower load is extracted from the wider dominating store.
+define i8 @dominating_wider_store(i32* %p, i1 %c) {
+; CHECK-LABEL: @dominating_wider_store(
+; CHECK-NOT:     load
+; CHECK:         ret i8
+entry:
+  store i32 42, i32* %p
+  br i1 %c, label %left, label %merge
+
+left:
+  br label %merge
+
+merge:
+  %q = bitcast i32* %p to i8*
+  %v = load i8, i8* %q
+  ret i8 %v
+}
+
+; A store on one of the incoming paths makes the clobber a MemoryPhi, so the
+; load is left to the MemoryDependenceAnalysis based load PRE.
+define i32 @clobbered_on_one_path(i32* %p, i32 %y, i1 %c) {
+; CHECK-LABEL: @clobbered_on_one_path(
+; CHECK:       merge:
+; CHECK-NEXT:    %v = phi i32
+; CHECK-NEXT:    ret i32 %v
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %left, label %merge
+
+left:
+  store i32 %y, i32* %p
+  br label %merge
+
+merge:
+  %v = load i32, i32* %p
+  ret i32 %v
+}
@@ -0,0 +1,14 @@
+; RUN: opt < %s -instcombine -S | FileCheck %s --check-prefix=DEFAULT
+; RUN: opt < %s -instcombine -instcombine-max-iterations=0 -S | FileCheck %s --check-prefix=NOITER
+
+; Check that instcombine stops iterating once its per-function budget is used.
+
+define i32 @foo(i32 %x) {
+; DEFAULT-LABEL: @foo(
+; DEFAULT-NEXT:    ret i32 %x
+; NOITER-LABEL: @foo(
+; NOITER-NEXT:    %add = add i32 %x, 0
+; NOITER-NEXT:    ret i32 %add
+  %add = add i32 %x, 0
+  ret i32 %add
+}
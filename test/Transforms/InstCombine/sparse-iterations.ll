@@ -0,0 +1,41 @@
+; RUN: opt < %s -instcombine -S | FileCheck %s --check-prefixes=CHECK,DEFAULT
+; RUN: opt < %s -instcombine -instcombine-sparse-iterations -S \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,SPARSE
+
+; Check that a chain of folds still reaches its result in a single sweep when
+; later iterations are left to the worklist.
+
+define i32 @foo(i32 %x) {
+; CHECK-LABEL: @foo(
+; CHECK-NEXT:    ret i32 %x
+  %a = add i32 %x, 0
+  %b = mul i32 %a, 1
+  %c = xor i32 %b, 0
+  %d = or i32 %c, 0
+  ret i32 %d
+}
+
+; The known bits of a phi only look one level into its incoming values, so the
+; return only folds to 0 once the xor is gone, and that leaves %t dead. Nothing
+; puts %t back on the worklist when that happens: the default mode erases it in
+; its second iteration, the sparse mode leaves it for a later run.
+
+define i32 @bar(i32 %x, i1 %c) {
+; CHECK-LABEL: @bar(
+; CHECK:       exit:
+; DEFAULT-NEXT:  ret i32 0
+; SPARSE-NEXT:   %t = and i32 %p, 1
+; SPARSE-NEXT:   ret i32 0
+entry:
+  br label %loop
+
+loop:
+  %p = phi i32 [ 0, %entry ], [ %n, %loop ]
+  %t = and i32 %p, 1
+  %m = shl i32 %x, 1
+  %n = xor i32 %m, 0
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %t
+}
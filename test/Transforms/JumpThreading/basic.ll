@@ -1,4 +1,5 @@
 ; RUN: opt -jump-threading -S < %s | FileCheck %s
+; RUN: opt -jump-threading -lvi-max-cache-entries=1 -S < %s | FileCheck %s
 
 declare i32 @f1()
 declare i32 @f2()
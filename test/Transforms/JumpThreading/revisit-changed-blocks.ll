@@ -0,0 +1,80 @@
+; RUN: opt < %s -jump-threading -S | FileCheck %s
+
+; After the first sweep, JumpThreading only revisits the blocks near a change.
+; Check that threading which enables more threading in blocks laid out before
+; the change still reaches a fixed point.
+
+declare void @f1()
+declare void @f2()
+declare void @g1()
+declare void @g2()
+
+; Threading %m1 to %t1 and %e1 exposes the constant incoming values of %q
+; in %m2, which is laid out first; both branches get threaded to entry.
+; CHECK-LABEL: @chain(
+; CHECK: entry:
+; CHECK-NEXT: %c = icmp eq i32 %x, 0
+; CHECK-NEXT: br i1 %c, label %t2, label %e2
+; CHECK: t2:
+; CHECK-NEXT: call void @f1()
+; CHECK-NEXT: call void @g1()
+; CHECK-NEXT: ret i32 1
+; CHECK: e2:
+; CHECK-NEXT: call void @f2()
+; CHECK-NEXT: call void @g2()
+; CHECK-NEXT: ret i32 2
+define i32 @chain(i32 %x) {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %a, label %b
+m2:
+  %q = phi i1 [ true, %t1 ], [ false, %e1 ]
+  br i1 %q, label %t2, label %e2
+t2:
+  call void @g1()
+  ret i32 1
+e2:
+  call void @g2()
+  ret i32 2
+a:
+  br label %m1
+b:
+  br label %m1
+m1:
+  %p = phi i1 [ true, %a ], [ false, %b ]
+  br i1 %p, label %t1, label %e1
+t1:
+  call void @f1()
+  br label %m2
+e1:
+  call void @f2()
+  br label %m2
+}
+
+; LVI knows %x > 5 on the path through %l1, which gets threaded past %join,
+; laid out before it, straight to %big.
+; CHECK-LABEL: @lvi(
+; CHECK: entry:
+; CHECK-NEXT: %c = icmp sgt i32 %x, 10
+; CHECK-NEXT: br i1 %c, label %join.thread, label %join
+; CHECK: join.thread:
+; CHECK-NEXT: call void @f1()
+; CHECK-NEXT: br label %big
+define i32 @lvi(i32 %x) {
+entry:
+  %c = icmp sgt i32 %x, 10
+  br i1 %c, label %l1, label %l2
+join:
+  %d = icmp sgt i32 %x, 5
+  br i1 %d, label %big, label %small
+big:
+  ret i32 1
+small:
+  ret i32 2
+l1:
+  call void @f1()
+  br label %join
+l2:
+  call void @f2()
+  br label %join
+}
@@ -0,0 +1,81 @@
+; RUN: opt < %s -basicaa -licm -S | FileCheck %s --check-prefix=AST
+; RUN: opt < %s -basicaa -licm -licm-memssa-loads -S | FileCheck %s --check-prefix=MSSA
+
+@a = global i32 0
+@b = global i32 0
+
+; %x may alias both @a and @b, so the alias set tracker puts all three in one
+; modified set. Only MemorySSA sees that the store to %b can't clobber @a.
+define i32 @test(i32* %x, i32 %n) {
+; AST-LABEL: @test(
+; AST: loop:
+; AST: load i32, i32* @a
+; MSSA-LABEL: @test(
+; MSSA: entry:
+; MSSA-NEXT: load i32, i32* @a
+; MSSA: loop:
+; MSSA-NOT: load i32, i32* @a
+; MSSA: load i32, i32* %x
+; MSSA: store i32 %i, i32* @b
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %va = load i32, i32* @a
+  %vx = load i32, i32* %x
+  store i32 %i, i32* @b
+  %sum = add i32 %va, %vx
+  %acc.next = add i32 %acc, %sum
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ %acc.next, %loop ]
+  ret i32 %r
+}
+
+; The load of @a is hoisted out of the inner loop, then out of the outer loop
+; with the MemorySSA kept from the inner loop.
+define i32 @nest(i32* %x, i32 %n) {
+; AST-LABEL: @nest(
+; AST: inner:
+; AST: load i32, i32* @a
+; MSSA-LABEL: @nest(
+; MSSA: entry:
+; MSSA-NEXT: load i32, i32* @a
+; MSSA: outer:
+; MSSA-NOT: load i32, i32* @a
+; MSSA: exit:
+entry:
+  br label %outer
+
+outer:
+  %j = phi i32 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %acc.outer = phi i32 [ 0, %entry ], [ %acc.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %i = phi i32 [ 0, %outer ], [ %i.next, %inner ]
+  %acc = phi i32 [ %acc.outer, %outer ], [ %acc.next, %inner ]
+  %va = load i32, i32* @a
+  %vx = load i32, i32* %x
+  store i32 %i, i32* @b
+  %sum = add i32 %va, %vx
+  %acc.next = add i32 %acc, %sum
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %inner, label %outer.latch
+
+outer.latch:
+  store i32 %j, i32* @b
+  %j.next = add i32 %j, 1
+  %cmp.outer = icmp slt i32 %j.next, %n
+  br i1 %cmp.outer, label %outer, label %exit
+
+exit:
+  %r = phi i32 [ %acc.next, %outer.latch ]
+  ret i32 %r
+}
@@ -0,0 +1,96 @@
+; RUN: opt -mcpu=skylake-avx512 -loop-data-prefetch -S < %s | FileCheck %s --check-prefix=PREFETCH --check-prefix=ALL
+; RUN: opt -mcpu=skylake-avx512 -passes=loop-data-prefetch -S < %s | FileCheck %s --check-prefix=PREFETCH --check-prefix=ALL
+; RUN: opt -mcpu=skylake-avx512 -loop-data-prefetch -loop-prefetch-indirect=false -S < %s | FileCheck %s --check-prefix=NO_PREFETCH --check-prefix=ALL
+; RUN: opt -mcpu=haswell -loop-data-prefetch -S < %s | FileCheck %s --check-prefix=NO_PREFETCH --check-prefix=ALL
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Prefetch a[b[min(i + d, n - 1)]] while loading a[b[i]].
+; ALL-LABEL: @indirect(
+define i32 @indirect(i32* nocapture readonly %a, i32* nocapture readonly %b, i64 %n) {
+entry:
+  br label %for.body
+
+; ALL: for.body:
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %sum = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  %arrayidx = getelementptr inbounds i32, i32* %b, i64 %i
+  %idx = load i32, i32* %arrayidx, align 4
+  %idxprom = sext i32 %idx to i64
+  %arrayidx2 = getelementptr inbounds i32, i32* %a, i64 %idxprom
+; PREFETCH: select
+; PREFETCH: %prefidx.load = load i32, i32* %{{.*}}, align 4
+; PREFETCH-NEXT: %idxprom.pref = sext i32 %prefidx.load to i64
+; PREFETCH-NEXT: %arrayidx2.pref = getelementptr inbounds i32, i32* %a, i64 %idxprom.pref
+; PREFETCH-NEXT: [[PTR:%.*]] = bitcast i32* %arrayidx2.pref to i8*
+; PREFETCH-NEXT: call void @llvm.prefetch(i8* [[PTR]], i32 0, i32 3, i32 1)
+; PREFETCH-NEXT: %v = load i32, i32* %arrayidx2
+; NO_PREFETCH-NOT: call void @llvm.prefetch
+  %v = load i32, i32* %arrayidx2, align 4
+  %add = add nsw i32 %v, %sum
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+; ALL: for.end:
+for.end:
+  ret i32 %add
+}
+
+; The loop may be left before reaching the iteration whose index would be
+; loaded early.
+; ALL-LABEL: @early_exit(
+define i32 @early_exit(i32* nocapture readonly %a, i32* nocapture readonly %b, i64 %n) {
+entry:
+  br label %for.body
+
+; ALL: for.body:
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.inc ]
+  %sum = phi i32 [ 0, %entry ], [ %add, %for.inc ]
+  %arrayidx = getelementptr inbounds i32, i32* %b, i64 %i
+  %idx = load i32, i32* %arrayidx, align 4
+  %cmp = icmp slt i32 %idx, 0
+  br i1 %cmp, label %for.end, label %for.inc
+
+; ALL: for.inc:
+for.inc:
+  %idxprom = sext i32 %idx to i64
+  %arrayidx2 = getelementptr inbounds i32, i32* %a, i64 %idxprom
+; ALL-NOT: call void @llvm.prefetch
+  %v = load i32, i32* %arrayidx2, align 4
+  %add = add nsw i32 %v, %sum
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+; ALL: for.end:
+for.end:
+  %ret = phi i32 [ %sum, %for.body ], [ %add, %for.inc ]
+  ret i32 %ret
+}
+
+; Small strides are left to the hardware prefetcher.
+; ALL-LABEL: @strided(
+define void @strided(i32* nocapture %a, i32* nocapture readonly %b) {
+entry:
+  br label %for.body
+
+; ALL: for.body:
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %arrayidx = getelementptr inbounds i32, i32* %b, i64 %i
+; ALL-NOT: call void @llvm.prefetch
+  %v = load i32, i32* %arrayidx, align 4
+  %arrayidx2 = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %v, i32* %arrayidx2, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, 1600
+  br i1 %exitcond, label %for.end, label %for.body
+
+; ALL: for.end:
+for.end:
+  ret void
+}
@@ -0,0 +1,159 @@
+; RUN: opt -basicaa -loop-fusion -S < %s | FileCheck %s
+; RUN: opt -aa-pipeline=basic-aa -passes=loop-fusion -S < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; a[i] = b[i] + 1 followed by c[i] = a[i] * 2: the second loop only reads what
+; the same iteration of the first loop wrote.
+; CHECK-LABEL: @fuse(
+; CHECK: loop1:
+; CHECK-NEXT: %i = phi i64 [ 0, %entry ], [ %i.next, %loop2 ]
+; CHECK-NEXT: %j = phi i64 [ 0, %entry ], [ %j.next, %loop2 ]
+; CHECK: store i32 %add, i32* %a.gep
+; CHECK: br label %loop2
+; CHECK-NOT: between:
+; CHECK: loop2:
+; CHECK: %a.val = load i32, i32* %a.gep2
+; CHECK: br i1 %cond2, label %exit, label %loop1
+define void @fuse(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %b.gep = getelementptr inbounds i32, i32* %b, i64 %i
+  %b.val = load i32, i32* %b.gep, align 4
+  %add = add nsw i32 %b.val, 1
+  %a.gep = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %add, i32* %a.gep, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp eq i64 %i.next, 100
+  br i1 %cond1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %a.gep2 = getelementptr inbounds i32, i32* %a, i64 %j
+  %a.val = load i32, i32* %a.gep2, align 4
+  %mul = mul nsw i32 %a.val, 2
+  %c.gep = getelementptr inbounds i32, i32* %c, i64 %j
+  store i32 %mul, i32* %c.gep, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp eq i64 %j.next, 100
+  br i1 %cond2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; The second loop reads a[j + 1], which a later iteration of the first loop
+; writes.
+; CHECK-LABEL: @backward_dep(
+; CHECK: br i1 %cond1, label %between, label %loop1
+; CHECK: between:
+; CHECK: br i1 %cond2, label %exit, label %loop2
+define void @backward_dep(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %b.gep = getelementptr inbounds i32, i32* %b, i64 %i
+  %b.val = load i32, i32* %b.gep, align 4
+  %a.gep = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %b.val, i32* %a.gep, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp eq i64 %i.next, 100
+  br i1 %cond1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %j.next = add nuw nsw i64 %j, 1
+  %a.gep2 = getelementptr inbounds i32, i32* %a, i64 %j.next
+  %a.val = load i32, i32* %a.gep2, align 4
+  %c.gep = getelementptr inbounds i32, i32* %c, i64 %j
+  store i32 %a.val, i32* %c.gep, align 4
+  %cond2 = icmp eq i64 %j.next, 100
+  br i1 %cond2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; The trip counts differ.
+; CHECK-LABEL: @trip_count(
+; CHECK: br i1 %cond1, label %between, label %loop1
+; CHECK: between:
+; CHECK: br i1 %cond2, label %exit, label %loop2
+define void @trip_count(i32* noalias %a, i32* noalias %b, i32* noalias %c) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %b.gep = getelementptr inbounds i32, i32* %b, i64 %i
+  %b.val = load i32, i32* %b.gep, align 4
+  %a.gep = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %b.val, i32* %a.gep, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp eq i64 %i.next, 100
+  br i1 %cond1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %a.gep2 = getelementptr inbounds i32, i32* %a, i64 %j
+  %a.val = load i32, i32* %a.gep2, align 4
+  %c.gep = getelementptr inbounds i32, i32* %c, i64 %j
+  store i32 %a.val, i32* %c.gep, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp eq i64 %j.next, 99
+  br i1 %cond2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; The loops do not share any data, so there is nothing to gain.
+; CHECK-LABEL: @no_reuse(
+; CHECK: br i1 %cond1, label %between, label %loop1
+; CHECK: between:
+; CHECK: br i1 %cond2, label %exit, label %loop2
+define void @no_reuse(i32* noalias %a, i32* noalias %b, i32* noalias %c,
+                      i32* noalias %d) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop1 ]
+  %b.gep = getelementptr inbounds i32, i32* %b, i64 %i
+  %b.val = load i32, i32* %b.gep, align 4
+  %a.gep = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %b.val, i32* %a.gep, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %cond1 = icmp eq i64 %i.next, 100
+  br i1 %cond1, label %between, label %loop1
+
+between:
+  br label %loop2
+
+loop2:
+  %j = phi i64 [ 0, %between ], [ %j.next, %loop2 ]
+  %d.gep = getelementptr inbounds i32, i32* %d, i64 %j
+  %d.val = load i32, i32* %d.gep, align 4
+  %c.gep = getelementptr inbounds i32, i32* %c, i64 %j
+  store i32 %d.val, i32* %c.gep, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %cond2 = icmp eq i64 %j.next, 100
+  br i1 %cond2, label %exit, label %loop2
+
+exit:
+  ret void
+}
@@ -0,0 +1,35 @@
+; RUN: opt < %s -loop-reduce -S | FileCheck %s
+; RUN: opt < %s -loop-reduce -lsr-solver-budget=0 -S | FileCheck %s
+; RUN: opt < %s -loop-reduce -lsr-solver-budget=0 -lsr-solver-beam-width=1 -S \
+; RUN:   | FileCheck %s
+;
+; With no budget for the exhaustive solver, LSR falls back to a beam search,
+; which must still find a complete solution for the loop.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK-LABEL: @copy(
+; CHECK: loop:
+; CHECK: %lsr.iv.next = add i64 %lsr.iv, -1
+; CHECK: %done = icmp eq i64 %lsr.iv.next, 0
+define void @copy(float* %a, float* %b, float* %c, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr inbounds float, float* %a, i64 %i
+  %pb = getelementptr inbounds float, float* %b, i64 %i
+  %pc = getelementptr inbounds float, float* %c, i64 %i
+  %va = load float, float* %pa
+  %vb = load float, float* %pb
+  %s = fadd float %va, %vb
+  store float %s, float* %pc
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
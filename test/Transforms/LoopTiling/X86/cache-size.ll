@@ -0,0 +1,48 @@
+; RUN: opt -mtriple=x86_64-unknown-linux -mcpu=haswell -basicaa -loop-tiling -S < %s | FileCheck %s --check-prefix=L1D32K
+; RUN: opt -mtriple=x86_64-unknown-linux -mcpu=atom -basicaa -loop-tiling -S < %s | FileCheck %s --check-prefix=L1D24K
+; RUN: opt -mtriple=x86_64-unknown-linux -mcpu=atom -loop-tiling-cache-size=65536 -basicaa -loop-tiling -S < %s | FileCheck %s --check-prefix=L1D64K
+
+; The tile size comes from the L1 data cache described by the CPU's machine
+; model. Every inner iteration touches 16 bytes, so half of a 32KB cache holds
+; 1024 iterations and half of Atom's 24KB cache rounds down to 512.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; L1D32K-LABEL: @tile(
+; L1D32K: %tile.next = add nuw i64 %tile.iv, 1024
+; L1D24K-LABEL: @tile(
+; L1D24K: %tile.next = add nuw i64 %tile.iv, 512
+; L1D64K-LABEL: @tile(
+; L1D64K: %tile.next = add nuw i64 %tile.iv, 2048
+define void @tile([4096 x float]* noalias %a, float* noalias %b,
+                  float* noalias %c, i64 %n, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %b.gep = getelementptr inbounds float, float* %b, i64 %j
+  %b.val = load float, float* %b.gep, align 4
+  %c.gep = getelementptr inbounds float, float* %c, i64 %j
+  %c.val = load float, float* %c.gep, align 4
+  %a.gep = getelementptr inbounds [4096 x float], [4096 x float]* %a, i64 %i, i64 %j
+  %a.val = load float, float* %a.gep, align 4
+  %bc = fadd float %b.val, %c.val
+  %add = fadd float %a.val, %bc
+  store float %add, float* %a.gep, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, %m
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %n
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
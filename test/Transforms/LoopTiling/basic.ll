@@ -0,0 +1,122 @@
+; RUN: opt -basicaa -loop-tiling -S < %s | FileCheck %s
+; RUN: opt -aa-pipeline=basic-aa -passes=loop-tiling -S < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; for (i = 0; i < n; ++i)
+;   for (j = 0; j < m; ++j)
+;     a[i][j] += b[j];
+; b[0..m) is read again by every iteration of the outer loop.
+; CHECK-LABEL: @tile(
+; CHECK: tile.header:
+; CHECK-NEXT: %tile.iv = phi i64 [ 0, %entry ], [ %tile.end, %tile.latch ]
+; CHECK-NEXT: %tile.remaining = sub i64 %m, %tile.iv
+; CHECK-NEXT: %tile.full = icmp ugt i64 %tile.remaining, 1024
+; CHECK-NEXT: %tile.next = add nuw i64 %tile.iv, 1024
+; CHECK-NEXT: %tile.end = select i1 %tile.full, i64 %tile.next, i64 %m
+; CHECK-NEXT: br label %outer
+; CHECK: outer:
+; CHECK-NEXT: %i = phi i64 [ 0, %tile.header ], [ %i.next, %outer.latch ]
+; CHECK: inner:
+; CHECK-NEXT: %j = phi i64 [ %tile.iv, %outer ], [ %j.next, %inner ]
+; CHECK: %inner.cond = icmp eq i64 %j.next, %tile.end
+; CHECK: br i1 %outer.cond, label %tile.latch, label %outer
+; CHECK: tile.latch:
+; CHECK-NEXT: %tile.done = icmp eq i64 %tile.end, %m
+; CHECK-NEXT: br i1 %tile.done, label %exit, label %tile.header
+define void @tile([4096 x float]* noalias %a, float* noalias %b, i64 %n,
+                  i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %b.gep = getelementptr inbounds float, float* %b, i64 %j
+  %b.val = load float, float* %b.gep, align 4
+  %a.gep = getelementptr inbounds [4096 x float], [4096 x float]* %a, i64 %i, i64 %j
+  %a.val = load float, float* %a.gep, align 4
+  %add = fadd float %a.val, %b.val
+  store float %add, float* %a.gep, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, %m
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %n
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+; a[i][j] = a[i - 1][j + 1] * 2: iteration (i, j) reads what (i - 1, j + 1)
+; wrote, which would run later once tiled.
+; CHECK-LABEL: @illegal(
+; CHECK-NOT: tile.header:
+; CHECK: ret void
+define void @illegal([4096 x float]* noalias %a, i64 %n, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 1, %entry ], [ %i.next, %outer.latch ]
+  %i.prev = add nsw i64 %i, -1
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %j.next = add nuw nsw i64 %j, 1
+  %src.gep = getelementptr inbounds [4096 x float], [4096 x float]* %a, i64 %i.prev, i64 %j.next
+  %src = load float, float* %src.gep, align 4
+  %mul = fmul float %src, 2.000000e+00
+  %dst.gep = getelementptr inbounds [4096 x float], [4096 x float]* %a, i64 %i, i64 %j
+  store float %mul, float* %dst.gep, align 4
+  %inner.cond = icmp eq i64 %j.next, %m
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %n
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+; a[i][j] = c[i][j] * 2 touches every element once.
+; CHECK-LABEL: @no_reuse(
+; CHECK-NOT: tile.header:
+; CHECK: ret void
+define void @no_reuse([4096 x float]* noalias %a, [4096 x float]* noalias %c,
+                      i64 %n, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %c.gep = getelementptr inbounds [4096 x float], [4096 x float]* %c, i64 %i, i64 %j
+  %c.val = load float, float* %c.gep, align 4
+  %mul = fmul float %c.val, 2.000000e+00
+  %a.gep = getelementptr inbounds [4096 x float], [4096 x float]* %a, i64 %i, i64 %j
+  store float %mul, float* %a.gep, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, %m
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %n
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
@@ -0,0 +1,40 @@
+; RUN: opt -loop-unswitch -S < %s | FileCheck %s --check-prefix=DEFAULT
+; RUN: opt -loop-unswitch -loop-unswitch-max-cloned-size=0 -S < %s | FileCheck %s --check-prefix=NONE
+
+declare void @f()
+declare void @g()
+
+; Both invariant conditions are unswitched, and the copy made for the first
+; one is unswitched again, unless the cloning budget runs out.
+define void @test(i1 %a, i1 %b, i32 %n) {
+; DEFAULT-LABEL: @test(
+; DEFAULT: loop.us.us:
+; NONE-LABEL: @test(
+; NONE-NOT: .us
+; NONE: ret void
+entry:
+  br label %loop
+
+loop:
+  %iv = phi i32 [ 0, %entry ], [ %iv.next, %latch ]
+  br i1 %a, label %call.f, label %check.b
+
+call.f:
+  call void @f()
+  br label %check.b
+
+check.b:
+  br i1 %b, label %call.g, label %latch
+
+call.g:
+  call void @g()
+  br label %latch
+
+latch:
+  %iv.next = add i32 %iv, 1
+  %cmp = icmp slt i32 %iv.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,128 @@
+; RUN: opt -vector-library=LIBMVEC -loop-vectorize -S < %s | FileCheck %s
+; RUN: opt -vector-library=LIBMVEC -loop-vectorize -mattr=+avx2 -S < %s \
+; RUN:     | FileCheck %s -check-prefix=AVX2
+; SSE2 only makes 2 x double calls profitable when the width is forced.
+; RUN: opt -vector-library=LIBMVEC -loop-vectorize -force-vector-width=2 -S \
+; RUN:     < %s | FileCheck %s -check-prefix=VF2
+; The AVX2 and AVX-512 variants are not called without those features, even
+; when the width is forced.
+; RUN: opt -vector-library=LIBMVEC -loop-vectorize -force-vector-width=4 -S \
+; RUN:     < %s | FileCheck %s -check-prefix=NOAVX2
+; RUN: opt -vector-library=LIBMVEC -loop-vectorize -force-vector-width=8 \
+; RUN:     -mattr=+avx2 -S < %s | FileCheck %s -check-prefix=NOAVX512
+; RUN: opt -vector-library=LIBMVEC -loop-vectorize -force-vector-width=8 \
+; RUN:     -mattr=+avx512f -S < %s | FileCheck %s -check-prefix=AVX512
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare double @sin(double) #0
+declare float @expf(float) #0
+declare double @llvm.log.f64(double) #0
+declare float @llvm.pow.f32(float, float) #0
+
+; VF2-LABEL: @sin_f64
+; VF2: <2 x double> @_ZGVbN2v_sin
+; VF2: ret
+; AVX2-LABEL: @sin_f64
+; AVX2: <4 x double> @_ZGVdN4v_sin
+; NOAVX2-LABEL: @sin_f64
+; NOAVX2-NOT: @_ZGVdN4v_sin
+; NOAVX2: ret
+; NOAVX512-LABEL: @sin_f64
+; NOAVX512-NOT: @_ZGVeN8v_sin
+; NOAVX512: ret
+; AVX512-LABEL: @sin_f64
+; AVX512: <8 x double> @_ZGVeN8v_sin
+
+define void @sin_f64(double* nocapture %varray) {
+entry:
+  br label %for.body
+
+for.body:                                         ; preds = %for.body, %entry
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %tmp = trunc i64 %indvars.iv to i32
+  %conv = sitofp i32 %tmp to double
+  %call = tail call fast double @sin(double %conv)
+  %arrayidx = getelementptr inbounds double, double* %varray, i64 %indvars.iv
+  store double %call, double* %arrayidx, align 8
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1000
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:                                          ; preds = %for.body
+  ret void
+}
+
+; CHECK-LABEL: @exp_f32
+; CHECK: <4 x float> @_ZGVbN4v_expf
+; AVX2-LABEL: @exp_f32
+; AVX2: <8 x float> @_ZGVdN8v_expf
+; CHECK: ret
+
+define void @exp_f32(float* nocapture %varray) {
+entry:
+  br label %for.body
+
+for.body:                                         ; preds = %for.body, %entry
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %tmp = trunc i64 %indvars.iv to i32
+  %conv = sitofp i32 %tmp to float
+  %call = tail call fast float @expf(float %conv)
+  %arrayidx = getelementptr inbounds float, float* %varray, i64 %indvars.iv
+  store float %call, float* %arrayidx, align 4
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1000
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:                                          ; preds = %for.body
+  ret void
+}
+
+; VF2-LABEL: @log_f64_intrinsic
+; VF2: <2 x double> @_ZGVbN2v_log
+; VF2: ret
+
+define void @log_f64_intrinsic(double* nocapture %varray) {
+entry:
+  br label %for.body
+
+for.body:                                         ; preds = %for.body, %entry
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %tmp = trunc i64 %indvars.iv to i32
+  %conv = sitofp i32 %tmp to double
+  %call = tail call fast double @llvm.log.f64(double %conv)
+  %arrayidx = getelementptr inbounds double, double* %varray, i64 %indvars.iv
+  store double %call, double* %arrayidx, align 8
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1000
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:                                          ; preds = %for.body
+  ret void
+}
+
+; CHECK-LABEL: @pow_f32_intrinsic
+; CHECK: <4 x float> @_ZGVbN4vv_powf
+; CHECK: ret
+
+define void @pow_f32_intrinsic(float* nocapture %varray) {
+entry:
+  br label %for.body
+
+for.body:                                         ; preds = %for.body, %entry
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %tmp = trunc i64 %indvars.iv to i32
+  %conv = sitofp i32 %tmp to float
+  %call = tail call fast float @llvm.pow.f32(float %conv, float %conv)
+  %arrayidx = getelementptr inbounds float, float* %varray, i64 %indvars.iv
+  store float %call, float* %arrayidx, align 4
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1000
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:                                          ; preds = %for.body
+  ret void
+}
+
+attributes #0 = { nounwind readnone }
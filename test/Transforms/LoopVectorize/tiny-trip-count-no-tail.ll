@@ -0,0 +1,84 @@
+; RUN: opt < %s -loop-vectorize -vectorize-tiny-trip-count-loops -force-vector-interleave=1 -force-vector-width=4 -dce -instcombine -pass-remarks-analysis=loop-vectorize -S 2>%t.remarks | FileCheck %s
+; RUN: FileCheck %s --check-prefix=REMARK < %t.remarks
+; RUN: opt < %s -loop-vectorize -force-vector-interleave=1 -force-vector-width=4 -S | FileCheck %s --check-prefix=DEFAULT
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@a = common global [2048 x i32] zeroinitializer, align 16
+@b = common global [2048 x i32] zeroinitializer, align 16
+@c = common global [2048 x i32] zeroinitializer, align 16
+
+;; With -vectorize-tiny-trip-count-loops, a loop with a tiny trip count is
+;; vectorized if the vector body covers every iteration.
+; CHECK-LABEL: @covered(
+; CHECK: load <4 x i32>
+; CHECK: ret void
+; DEFAULT-LABEL: @covered(
+; DEFAULT-NOT: load <4 x i32>
+; DEFAULT: ret void
+define void @covered() nounwind uwtable ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %b.addr = getelementptr inbounds [2048 x i32], [2048 x i32]* @b, i64 0, i64 %iv
+  %b.val = load i32, i32* %b.addr, align 4
+  %c.addr = getelementptr inbounds [2048 x i32], [2048 x i32]* @c, i64 0, i64 %iv
+  %c.val = load i32, i32* %c.addr, align 4
+  %add = add nsw i32 %c.val, %b.val
+  %a.addr = getelementptr inbounds [2048 x i32], [2048 x i32]* @a, i64 0, i64 %iv
+  store i32 %add, i32* %a.addr, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 8
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+;; Vectorizing this one would need a runtime alias check.
+; CHECK-LABEL: @needs_check(
+; CHECK-NOT: load <4 x i32>
+; CHECK: ret void
+define void @needs_check(i32* %a, i32* %b) nounwind uwtable ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %b.addr = getelementptr inbounds i32, i32* %b, i64 %iv
+  %b.val = load i32, i32* %b.addr, align 4
+  %add = add nsw i32 %b.val, 1
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %iv
+  store i32 %add, i32* %a.addr, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 8
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+;; Functions optimized for size still reject loops with a tiny trip count.
+; CHECK-LABEL: @optsize(
+; CHECK-NOT: load <4 x i32>
+; CHECK: ret void
+; REMARK: remark: {{.*}} vectorization is not beneficial and is not explicitly forced
+define void @optsize() nounwind uwtable ssp optsize {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %b.addr = getelementptr inbounds [2048 x i32], [2048 x i32]* @b, i64 0, i64 %iv
+  %b.val = load i32, i32* %b.addr, align 4
+  %a.addr = getelementptr inbounds [2048 x i32], [2048 x i32]* @a, i64 0, i64 %iv
+  store i32 %b.val, i32* %a.addr, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 8
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
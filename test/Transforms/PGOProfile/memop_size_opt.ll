@@ -0,0 +1,49 @@
+; RUN: opt < %s -pgo-memop-opt -S | FileCheck %s
+; RUN: opt < %s -passes=pgo-memop-opt -S | FileCheck %s
+; RUN: opt < %s -pgo-memop-opt -pgo-memop-count-threshold=100 -S | FileCheck %s --check-prefix=LOWTHRESHOLD
+; RUN: opt < %s -pgo-memop-opt -disable-memop-opt -S | FileCheck %s --check-prefix=DISABLE
+; The pass only runs in the standard pipeline when enabled.
+; RUN: opt < %s -O2 -enable-pgo-memop-opt -S | FileCheck %s --check-prefix=PIPELINE
+; RUN: opt < %s -O2 -S | FileCheck %s --check-prefix=NOPIPELINE
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define void @foo(i8* %dst, i8* %src, i64 %n) {
+entry:
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %n, i32 1, i1 false), !prof !0
+  ret void
+}
+
+; CHECK-LABEL: @foo(
+; CHECK: switch i64 %n, label %[[DEFAULT:.*]] [
+; CHECK-NEXT: i64 8, label %[[CASE8:.*]]
+; CHECK-NEXT: ], !prof ![[SWITCH_BW:[0-9]+]]
+; CHECK: [[CASE8]]:
+; CHECK-NEXT: call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 8, i32 1, i1 false){{$}}
+; CHECK-NEXT: br label %[[MERGE:.*]]
+; CHECK: [[DEFAULT]]:
+; CHECK-NEXT: call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %n, i32 1, i1 false), !prof ![[NEWVP:[0-9]+]]
+; CHECK-NEXT: br label %[[MERGE]]
+; CHECK: [[MERGE]]:
+; CHECK-NEXT: ret void
+; CHECK: ![[SWITCH_BW]] = !{!"branch_weights", i32 500, i32 1500}
+; CHECK: ![[NEWVP]] = !{!"VP", i32 1, i64 500, i64 16, i64 300, i64 1000, i64 200}
+
+; With a lower count threshold size 16 is versioned too; 1000 is above the
+; default maximum size and stays with the original call.
+; LOWTHRESHOLD: switch i64 %n, label %{{.*}} [
+; LOWTHRESHOLD-NEXT: i64 8, label
+; LOWTHRESHOLD-NEXT: i64 16, label
+; LOWTHRESHOLD-NEXT: ], !prof ![[SWITCH_BW:[0-9]+]]
+; LOWTHRESHOLD: call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %n, i32 1, i1 false), !prof ![[NEWVP:[0-9]+]]
+; LOWTHRESHOLD: ![[SWITCH_BW]] = !{!"branch_weights", i32 200, i32 1500, i32 300}
+; LOWTHRESHOLD: ![[NEWVP]] = !{!"VP", i32 1, i64 200, i64 1000, i64 200}
+
+; DISABLE-NOT: switch
+
+; PIPELINE: MemOP.Case.8:
+; NOPIPELINE-NOT: MemOP
+
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* nocapture writeonly, i8* nocapture readonly, i64, i32, i1)
+
+!0 = !{!"VP", i32 1, i64 2000, i64 8, i64 1500, i64 16, i64 300, i64 1000, i64 200}
@@ -7,9 +7,9 @@ define i64 addrspace(1)* @test(<2 x i64 addrspace(1)*> %vec, i32 %idx) gc "state
 ; CHECK: extractelement
 ; CHECK: statepoint
 ; CHECK: gc.relocate
-; CHECK-DAG: ; (%base_ee, %obj)
-; CHECK: gc.relocate
 ; CHECK-DAG: ; (%base_ee, %base_ee)
+; CHECK: gc.relocate
+; CHECK-DAG: ; (%base_ee, %obj)
 ; Note that the second extractelement is actually redundant here.  A correct output would
 ; be to reuse the existing obj as a base since it is actually a base pointer.
 entry:
@@ -49,9 +49,9 @@ merge2:                                           ; preds = %untaken2, %taken2
 ; CHECK: %obj = phi i64 addrspace(1)*
 ; CHECK: statepoint
 ; CHECK: gc.relocate
-; CHECK-DAG: ; (%obj.base, %obj)
-; CHECK: gc.relocate
 ; CHECK-DAG: ; (%obj.base, %obj.base)
+; CHECK: gc.relocate
+; CHECK-DAG: ; (%obj.base, %obj)
   %obj = phi i64 addrspace(1)* [ %obj0, %taken2 ], [ %obj1, %untaken2 ]
   call void @do_safepoint() [ "deopt"() ]
   ret i64 addrspace(1)* %obj
@@ -100,18 +100,18 @@ entry:
 ; CHECK-LABEL: entry:
 ; CHECK-NEXT:  %derived = getelementptr
 ; CHECK-NEXT:  gc.statepoint
-; CHECK-NEXT:  %derived.relocated =
-; CHECK-NEXT:  bitcast 
 ; CHECK-NEXT:  %obj.relocated =
 ; CHECK-NEXT:  bitcast
-; CHECK-NEXT:  gc.statepoint
-; CHECK-NEXT:  %derived.relocated2 =
+; CHECK-NEXT:  %derived.relocated =
 ; CHECK-NEXT:  bitcast 
+; CHECK-NEXT:  gc.statepoint
 
 ; Note: It's legal to relocate obj again, but not strictly needed
-; CHECK-NEXT:  %obj.relocated3 =
+; CHECK-NEXT:  %obj.relocated2 =
 ; CHECK-NEXT:  bitcast
-; CHECK-NEXT:  ret i64 addrspace(1)* %derived.relocated2.casted
+; CHECK-NEXT:  %derived.relocated3 =
+; CHECK-NEXT:  bitcast 
+; CHECK-NEXT:  ret i64 addrspace(1)* %derived.relocated3.casted
 ; 
 ; Make sure that a phi def visited during iteration is considered a kill.
 ; Also, liveness after base pointer analysis can change based on new uses,
@@ -0,0 +1,156 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -S | FileCheck %s --check-prefix=CHUNK16
+; RUN: opt < %s -basicaa -slp-vectorizer -slp-store-chunk-size=32 -S | FileCheck %s --check-prefix=CHUNK32
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@A = common global [64 x i32] zeroinitializer, align 16
+@B = common global [64 x i32] zeroinitializer, align 16
+
+; The 32 stores below cover A[0..31], but adjacent elements are written eight
+; stores apart. Split into the default groups of 16, no group holds four
+; consecutive stores.
+; CHUNK16-LABEL: @copy_strided_order(
+; CHUNK16-NOT: store <4 x i32>
+; CHUNK16: ret void
+; CHUNK32-LABEL: @copy_strided_order(
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: store <4 x i32>
+; CHUNK32: ret void
+define void @copy_strided_order() {
+entry:
+  %b0 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 0
+  %l0 = load i32, i32* %b0, align 4
+  %a0 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 0
+  store i32 %l0, i32* %a0, align 4
+  %b4 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 4
+  %l4 = load i32, i32* %b4, align 4
+  %a4 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 4
+  store i32 %l4, i32* %a4, align 4
+  %b8 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 8
+  %l8 = load i32, i32* %b8, align 4
+  %a8 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 8
+  store i32 %l8, i32* %a8, align 4
+  %b12 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 12
+  %l12 = load i32, i32* %b12, align 4
+  %a12 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 12
+  store i32 %l12, i32* %a12, align 4
+  %b16 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 16
+  %l16 = load i32, i32* %b16, align 4
+  %a16 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 16
+  store i32 %l16, i32* %a16, align 4
+  %b20 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 20
+  %l20 = load i32, i32* %b20, align 4
+  %a20 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 20
+  store i32 %l20, i32* %a20, align 4
+  %b24 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 24
+  %l24 = load i32, i32* %b24, align 4
+  %a24 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 24
+  store i32 %l24, i32* %a24, align 4
+  %b28 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 28
+  %l28 = load i32, i32* %b28, align 4
+  %a28 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 28
+  store i32 %l28, i32* %a28, align 4
+  %b1 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 1
+  %l1 = load i32, i32* %b1, align 4
+  %a1 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 1
+  store i32 %l1, i32* %a1, align 4
+  %b5 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 5
+  %l5 = load i32, i32* %b5, align 4
+  %a5 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 5
+  store i32 %l5, i32* %a5, align 4
+  %b9 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 9
+  %l9 = load i32, i32* %b9, align 4
+  %a9 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 9
+  store i32 %l9, i32* %a9, align 4
+  %b13 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 13
+  %l13 = load i32, i32* %b13, align 4
+  %a13 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 13
+  store i32 %l13, i32* %a13, align 4
+  %b17 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 17
+  %l17 = load i32, i32* %b17, align 4
+  %a17 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 17
+  store i32 %l17, i32* %a17, align 4
+  %b21 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 21
+  %l21 = load i32, i32* %b21, align 4
+  %a21 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 21
+  store i32 %l21, i32* %a21, align 4
+  %b25 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 25
+  %l25 = load i32, i32* %b25, align 4
+  %a25 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 25
+  store i32 %l25, i32* %a25, align 4
+  %b29 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 29
+  %l29 = load i32, i32* %b29, align 4
+  %a29 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 29
+  store i32 %l29, i32* %a29, align 4
+  %b2 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 2
+  %l2 = load i32, i32* %b2, align 4
+  %a2 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 2
+  store i32 %l2, i32* %a2, align 4
+  %b6 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 6
+  %l6 = load i32, i32* %b6, align 4
+  %a6 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 6
+  store i32 %l6, i32* %a6, align 4
+  %b10 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 10
+  %l10 = load i32, i32* %b10, align 4
+  %a10 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 10
+  store i32 %l10, i32* %a10, align 4
+  %b14 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 14
+  %l14 = load i32, i32* %b14, align 4
+  %a14 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 14
+  store i32 %l14, i32* %a14, align 4
+  %b18 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 18
+  %l18 = load i32, i32* %b18, align 4
+  %a18 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 18
+  store i32 %l18, i32* %a18, align 4
+  %b22 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 22
+  %l22 = load i32, i32* %b22, align 4
+  %a22 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 22
+  store i32 %l22, i32* %a22, align 4
+  %b26 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 26
+  %l26 = load i32, i32* %b26, align 4
+  %a26 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 26
+  store i32 %l26, i32* %a26, align 4
+  %b30 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 30
+  %l30 = load i32, i32* %b30, align 4
+  %a30 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 30
+  store i32 %l30, i32* %a30, align 4
+  %b3 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 3
+  %l3 = load i32, i32* %b3, align 4
+  %a3 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 3
+  store i32 %l3, i32* %a3, align 4
+  %b7 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 7
+  %l7 = load i32, i32* %b7, align 4
+  %a7 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 7
+  store i32 %l7, i32* %a7, align 4
+  %b11 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 11
+  %l11 = load i32, i32* %b11, align 4
+  %a11 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 11
+  store i32 %l11, i32* %a11, align 4
+  %b15 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 15
+  %l15 = load i32, i32* %b15, align 4
+  %a15 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 15
+  store i32 %l15, i32* %a15, align 4
+  %b19 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 19
+  %l19 = load i32, i32* %b19, align 4
+  %a19 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 19
+  store i32 %l19, i32* %a19, align 4
+  %b23 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 23
+  %l23 = load i32, i32* %b23, align 4
+  %a23 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 23
+  store i32 %l23, i32* %a23, align 4
+  %b27 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 27
+  %l27 = load i32, i32* %b27, align 4
+  %a27 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 27
+  store i32 %l27, i32* %a27, align 4
+  %b31 = getelementptr inbounds [64 x i32], [64 x i32]* @B, i64 0, i64 31
+  %l31 = load i32, i32* %b31, align 4
+  %a31 = getelementptr inbounds [64 x i32], [64 x i32]* @A, i64 0, i64 31
+  store i32 %l31, i32* %a31, align 4
+  ret void
+}
@@ -0,0 +1,15 @@
+# Print a function whose alloca has more slices than SROA used to split by
+# default: one store to each of its 1100 elements and two loads.
+N = 1100
+print('define i32 @many_slices() {')
+print('entry:')
+print('  %%a = alloca [%d x i32]' % N)
+for i in range(N):
+    print('  %%p%d = getelementptr [%d x i32], [%d x i32]* %%a, i64 0, i64 %d'
+          % (i, N, N, i))
+    print('  store i32 %d, i32* %%p%d' % (i, i))
+print('  %%v0 = load i32, i32* %%p%d' % 7)
+print('  %%v1 = load i32, i32* %%p%d' % (N - 1))
+print('  %sum = add i32 %v0, %v1')
+print('  ret i32 %sum')
+print('}')
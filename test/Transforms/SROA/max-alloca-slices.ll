@@ -0,0 +1,37 @@
+; RUN: opt < %s -sroa -S | FileCheck %s --check-prefix=SPLIT
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=3 -S | FileCheck %s --check-prefix=CAPPED
+
+; There is no limit by default, so an alloca with more than a thousand
+; slices is still promoted.
+; RUN: %python %S/Inputs/many-slices.py | opt -sroa -S | FileCheck %s --check-prefix=MANY
+; RUN: %python %S/Inputs/many-slices.py | opt -sroa -sroa-max-alloca-slices=1024 -S \
+; RUN:   | FileCheck %s --check-prefix=MANY-CAPPED
+; MANY-LABEL: @many_slices(
+; MANY-NOT: alloca
+; MANY: %sum = add i32 7, 1099
+; MANY-CAPPED-LABEL: @many_slices(
+; MANY-CAPPED: %a = alloca [1100 x i32]
+
+target datalayout = "e-p:64:64:64-i32:32:32-i64:32:64-n8:16:32:64"
+
+; The alloca has four slices, so it is only split without the cap.
+define i32 @test() {
+; SPLIT-LABEL: @test(
+; SPLIT-NOT: alloca
+; SPLIT: ret i32
+; CAPPED-LABEL: @test(
+; CAPPED: %a = alloca [4 x i32]
+; CAPPED: ret i32
+entry:
+  %a = alloca [4 x i32]
+  %p0 = getelementptr [4 x i32], [4 x i32]* %a, i64 0, i64 0
+  %p1 = getelementptr [4 x i32], [4 x i32]* %a, i64 0, i64 1
+  %p2 = getelementptr [4 x i32], [4 x i32]* %a, i64 0, i64 2
+  %p3 = getelementptr [4 x i32], [4 x i32]* %a, i64 0, i64 3
+  store i32 0, i32* %p0
+  store i32 1, i32* %p1
+  %v2 = load i32, i32* %p2
+  %v3 = load i32, i32* %p3
+  %sum = add i32 %v2, %v3
+  ret i32 %sum
+}
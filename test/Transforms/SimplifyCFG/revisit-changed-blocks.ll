@@ -0,0 +1,51 @@
+; RUN: opt < %s -simplifycfg -S | FileCheck %s
+
+; After the first sweep, iterativelySimplifyCFG only revisits the blocks next
+; to a change. Check that changes which enable folds in blocks laid out
+; before them still reach a fixed point.
+
+; Folding the constant branch in %b3 makes %b2, %b1 and %b0 foldable in
+; turn, each one laid out before the block that enabled it.
+; CHECK-LABEL: @reverse_chain(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: ret i32 1
+define i32 @reverse_chain(i1 %c) {
+entry:
+  br label %b3
+b1:
+  br i1 %c, label %b0, label %b0
+b0:
+  ret i32 1
+b2:
+  br label %b1
+b3:
+  br i1 false, label %dead, label %b2
+dead:
+  ret i32 2
+}
+
+; Folding the branch in %sel leaves %join with one predecessor, which turns
+; the branch in %use into a select.
+; CHECK-LABEL: @phi_chain(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: %t = icmp eq i32 7, 7
+; CHECK-NEXT: %merge = select i1 %t, i32 10, i32 20
+; CHECK-NEXT: ret i32 %merge
+define i32 @phi_chain(i1 %c) {
+entry:
+  br label %sel
+use:
+  %t = icmp eq i32 %p, 7
+  br i1 %t, label %yes, label %no
+yes:
+  ret i32 10
+no:
+  ret i32 20
+join:
+  %p = phi i32 [ 7, %sel ], [ 8, %other ]
+  br label %use
+sel:
+  br i1 true, label %join, label %other
+other:
+  br label %join
+}
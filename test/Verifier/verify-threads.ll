@@ -0,0 +1,57 @@
+; RUN: not llvm-as -verify-threads=1 %s -o /dev/null 2> %t.serial
+; RUN: not llvm-as -verify-threads=3 %s -o /dev/null 2> %t.parallel
+; RUN: diff %t.serial %t.parallel
+; RUN: FileCheck %s < %t.parallel
+
+; Check that verifying functions on several threads reports errors in function
+; order, and that module level checks see what every function recorded.
+
+declare void @llvm.localescape(...)
+declare i8* @llvm.localrecover(i8*, i8*, i32)
+
+define void @escapes_one() {
+  %a = alloca i8
+  call void (...) @llvm.localescape(i8* %a)
+  ret void
+}
+
+define void @bad_attrs() readnone readonly {
+  ret void
+}
+; CHECK: Attributes 'readnone and readonly' are incompatible!
+; CHECK-NEXT: void ()* @bad_attrs
+
+define void @good(i32 %x) {
+  %y = add i32 %x, 1
+  ret void
+}
+
+define void @bad_intrinsic() {
+  call void @llvm.trap(i32 0)
+  ret void
+}
+; CHECK-NEXT: Intrinsic has incorrect argument type!
+; CHECK-NEXT: void (i32)* @llvm.trap
+
+declare void @llvm.trap(i32)
+
+; Metadata shared by functions on different threads is reported once.
+define void @md_one() !foo !0 {
+  ret void
+}
+define void @md_two() !foo !0 {
+  ret void
+}
+; CHECK-NEXT: location requires a valid scope
+; CHECK-NEXT: !{{[0-9]+}} = !DILocation(line: 1, scope: !{{[0-9]+}})
+; CHECK-NEXT: !{{[0-9]+}} = !{}
+
+define void @recovers_two() {
+  %p = call i8* @llvm.localrecover(i8* bitcast (void ()* @escapes_one to i8*), i8* null, i32 1)
+  ret void
+}
+; CHECK-NEXT: all indices passed to llvm.localrecover must be less than the number of arguments passed ot llvm.localescape in the parent function
+; CHECK-NEXT: void ()* @escapes_one
+
+!0 = !DILocation(line: 1, scope: !1)
+!1 = !{}
@@ -0,0 +1,41 @@
+; RUN: llvm-as %s -o %t.o
+
+; RUN: %gold -m elf_x86_64 -plugin %llvmshlibdir/LLVMgold.so \
+; RUN:    -plugin-opt=profile-function-order \
+; RUN:    -plugin-opt=symbol-ordering-file=%t.order \
+; RUN:    -shared %t.o -o %t2.so
+; RUN: FileCheck %s < %t.order
+
+; The ordering file alone enables the ordering, as with llvm-lto2.
+; RUN: %gold -m elf_x86_64 -plugin %llvmshlibdir/LLVMgold.so \
+; RUN:    -plugin-opt=symbol-ordering-file=%t3.order \
+; RUN:    -shared %t.o -o %t3.so
+; RUN: FileCheck %s < %t3.order
+
+; CHECK: hot
+; CHECK-NEXT: f
+; CHECK-NOT: cold
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @ext()
+
+define void @cold() !prof !0 {
+  call void @ext()
+  ret void
+}
+
+define void @f() !prof !1 {
+  call void @ext()
+  ret void
+}
+
+define void @hot() !prof !2 {
+  call void @ext()
+  ret void
+}
+
+!0 = !{!"function_entry_count", i64 0}
+!1 = !{!"function_entry_count", i64 10}
+!2 = !{!"function_entry_count", i64 1000}
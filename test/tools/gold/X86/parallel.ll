@@ -24,6 +24,5 @@ define void @foo() {
 ; CHECK1: T bar
 ; CHECK1-NOT: foo
 define void @bar() {
-  call void @foo()
   ret void
 }
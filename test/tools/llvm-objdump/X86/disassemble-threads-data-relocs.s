@@ -0,0 +1,51 @@
+// RUN: llvm-mc %s -filetype=obj -triple=x86_64-pc-linux -o %t.o
+// RUN: llvm-objdump -d -r %t.o > %t.serial
+// RUN: llvm-objdump -d -r -disassemble-threads=4 %t.o > %t.parallel
+// RUN: diff %t.serial %t.parallel
+// RUN: FileCheck %s < %t.parallel
+
+// The relocations in the data objects are not reached by any instruction of
+// their own chunk. They are printed after the next instruction, as in the
+// serial output.
+
+        .text
+        .globl  f1
+f1:
+        callq   ext1
+        retq
+
+        .type   table,@object
+table:
+        .quad   f1
+        .quad   ext2
+        .size   table, 16
+
+        .globl  f2
+        .type   f2,@function
+f2:
+        movl    $1, %eax
+        callq   ext3
+        retq
+
+        .type   table2,@object
+table2:
+        .quad   f2
+        .size   table2, 8
+
+        .type   empty,@object
+empty:
+        .type   f3,@function
+f3:
+        callq   ext4
+        retq
+
+// CHECK:      f2:
+// CHECK-NEXT:   16: b8 01 00 00 00 movl $1, %eax
+// CHECK-NEXT:   0000000000000006: R_X86_64_64 f1+0
+// CHECK-NEXT:   000000000000000e: R_X86_64_64 ext2+0
+// CHECK-NEXT:   1b: e8 00 00 00 00 callq
+// CHECK-NEXT:   000000000000001c: R_X86_64_PC32 ext3-4-P
+// CHECK:      f3:
+// CHECK-NEXT:   29: e8 00 00 00 00 callq
+// CHECK-NEXT:   0000000000000021: R_X86_64_64 f2+0
+// CHECK-NEXT:   000000000000002a: R_X86_64_PC32 ext4-4-P
@@ -0,0 +1,45 @@
+// RUN: llvm-mc %s -filetype=obj -triple=x86_64-pc-linux -o %t.o
+// RUN: llvm-objdump -d -r %t.o > %t.serial
+// RUN: llvm-objdump -d -r -disassemble-threads=4 %t.o > %t.parallel
+// RUN: diff %t.serial %t.parallel
+// RUN: FileCheck %s < %t.parallel
+
+        .text
+        .globl  f1
+f1:
+        callq   ext1
+        jmp     f2
+
+        .globl  f2
+f2:
+        movl    $1, %eax
+        callq   ext2
+        retq
+
+        .globl  f3
+f3:
+        leaq    data(%rip), %rax
+        callq   f1
+        retq
+
+        .globl  f4
+f4:
+        pushq   %rbp
+        callq   ext3
+        popq    %rbp
+        jmp     f3
+
+        .data
+data:
+        .long   0
+
+// CHECK:      f1:
+// CHECK-NEXT:   0: e8 00 00 00 00 callq 0 <f1+0x5>
+// CHECK-NEXT:   1: R_X86_64_PC32 ext1-4-P
+// CHECK:      f2:
+// CHECK:        R_X86_64_PC32 ext2-4-P
+// CHECK:      f3:
+// CHECK:        R_X86_64_PC32 .data-4-P
+// CHECK:        callq -30 <f1>
+// CHECK:      f4:
+// CHECK:        R_X86_64_PC32 ext3-4-P
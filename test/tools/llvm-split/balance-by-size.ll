@@ -0,0 +1,67 @@
+; RUN: llvm-split -j=3 -balance-by-size -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+; RUN: llvm-dis -o - %t2 | FileCheck --check-prefix=CHECK2 %s
+
+; The partitions are balanced by instruction count and numbered from the
+; heaviest to the lightest. The recursive @even and @odd stay together.
+
+; CHECK0-DAG: define i32 @even
+; CHECK0-DAG: define i32 @odd
+; CHECK0-DAG: declare i32 @big
+; CHECK0-DAG: declare i32 @small
+
+; CHECK1: define i32 @big
+; CHECK1-NOT: define
+
+; CHECK2: @g = global
+; CHECK2: define i32 @small
+; CHECK2-NOT: define
+
+@g = global i32 0
+
+define i32 @big(i32 %x) {
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %a
+  %c = add i32 %b, %a
+  %d = mul i32 %c, %b
+  %e = add i32 %d, %c
+  %f = mul i32 %e, %d
+  %g = add i32 %f, %e
+  %h = mul i32 %g, %f
+  %i = add i32 %h, %g
+  %j = mul i32 %i, %h
+  ret i32 %j
+}
+
+define i32 @even(i32 %x) {
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %done, label %rec
+
+rec:
+  %y = sub i32 %x, 1
+  %r = call i32 @odd(i32 %y)
+  ret i32 %r
+
+done:
+  ret i32 1
+}
+
+define i32 @odd(i32 %x) {
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %done, label %rec
+
+rec:
+  %y = sub i32 %x, 1
+  %r = call i32 @even(i32 %y)
+  ret i32 %r
+
+done:
+  ret i32 0
+}
+
+define i32 @small(i32 %x) {
+  %v = load i32, i32* @g
+  %r = add i32 %v, %x
+  ret i32 %r
+}
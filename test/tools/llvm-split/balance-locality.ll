@@ -0,0 +1,43 @@
+; RUN: llvm-split -j=2 -balance-by-size -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; Balancing by size alone would put @f2 and @g2 together and @f1 and @g1
+; together. Each callee is instead placed with its caller, which keeps the
+; partitions just as balanced.
+
+; CHECK0-DAG: define i32 @f2
+; CHECK0-DAG: define i32 @g1
+; CHECK0-DAG: declare i32 @g2
+
+; CHECK1-DAG: define i32 @f1
+; CHECK1-DAG: define i32 @g2
+; CHECK1-DAG: declare i32 @g1
+
+define i32 @f1(i32 %x) {
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  %r = call i32 @g2(i32 %c)
+  ret i32 %r
+}
+
+define i32 @f2(i32 %x) {
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  %r = call i32 @g1(i32 %c)
+  ret i32 %r
+}
+
+define i32 @g1(i32 %x) {
+  %a = mul i32 %x, 3
+  %b = mul i32 %a, 5
+  ret i32 %b
+}
+
+define i32 @g2(i32 %x) {
+  %a = mul i32 %x, 5
+  %b = mul i32 %a, 7
+  ret i32 %b
+}
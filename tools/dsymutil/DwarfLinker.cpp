@@ -36,6 +36,8 @@
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include <string>
@@ -1150,6 +1152,10 @@ private:
 
     DwarfLinker &Linker;
 
+    /// \brief If not null, warnings are queued here instead of being
+    /// reported right away.
+    std::vector<std::string> *DeferredWarnings;
+
     /// \brief The valid relocations for the current DebugMapObject.
     /// This vector is sorted by relocation offset.
     std::vector<ValidReloc> ValidRelocs;
@@ -1163,7 +1169,20 @@ private:
 
   public:
     RelocationManager(DwarfLinker &Linker)
-        : Linker(Linker), NextValidReloc(0) {}
+        : Linker(Linker), DeferredWarnings(nullptr), NextValidReloc(0) {}
+
+    /// \brief Queue the warnings into \p Warnings instead of reporting them,
+    /// or report them right away again if \p Warnings is null.
+    void deferWarnings(std::vector<std::string> *Warnings) {
+      DeferredWarnings = Warnings;
+    }
+
+    void reportWarning(const Twine &Warning) {
+      if (DeferredWarnings)
+        DeferredWarnings->push_back(Warning.str());
+      else
+        Linker.reportWarning(Warning);
+    }
 
     bool hasValidRelocs() const { return !ValidRelocs.empty(); }
     /// \brief Reset the NextValidReloc counter.
@@ -1419,12 +1438,39 @@ private:
   /// @{
   bool createStreamer(const Triple &TheTriple, StringRef OutputFilename);
 
-  /// \brief Attempt to load a debug object from disk.
-  ErrorOr<const object::ObjectFile &> loadObject(BinaryHolder &BinaryHolder,
-                                                 DebugMapObject &Obj,
-                                                 const DebugMap &Map);
+  /// \brief Attempt to load a debug object from disk. Warnings are queued
+  /// into \p DeferredWarnings if it is not null.
+  ErrorOr<const object::ObjectFile &>
+  loadObject(BinaryHolder &BinaryHolder, DebugMapObject &Obj,
+             const DebugMap &Map,
+             std::vector<std::string> *DeferredWarnings = nullptr);
   /// @}
 
+  /// Everything that is read from a debug map object before its DIEs are
+  /// linked. Filling one in does not depend on any other object, so the
+  /// contexts of the next objects are loaded on a thread pool while the
+  /// current one is linked.
+  struct LinkContext {
+    DebugMapObject &DMO;
+    std::unique_ptr<BinaryHolder> OwnedBinHolder;
+    const object::ObjectFile *ObjectFile = nullptr;
+    std::unique_ptr<RelocationManager> RelocMgr;
+    bool HasValidRelocs = false;
+    std::unique_ptr<DWARFContextInMemory> DwarfContext;
+    /// Warnings found while loading, reported when the object is linked.
+    std::vector<std::string> Warnings;
+
+    LinkContext(DebugMapObject &DMO) : DMO(DMO) {}
+  };
+
+  /// \brief Load the object file of \p Ctx, find its valid relocations and
+  /// parse its debug info. This only modifies \p Ctx and \p BinaryHolder.
+  void loadContext(LinkContext &Ctx, BinaryHolder &BinaryHolder,
+                   const DebugMap &Map);
+
+  /// \brief Link the debug info of the loaded \p Ctx into the output.
+  void linkContext(LinkContext &Ctx, DebugMap &ModuleMap);
+
   std::string OutputFilename;
   LinkOptions Options;
   BinaryHolder BinHolder;
@@ -1927,14 +1973,14 @@ findValidRelocsMachO(const object::SectionRef &Section,
     if (isMachOPairedReloc(Obj.getAnyRelocationType(MachOReloc),
                            Obj.getArch())) {
       SkipNext = true;
-      Linker.reportWarning(" unsupported relocation in debug_info section.");
+      reportWarning(" unsupported relocation in debug_info section.");
       continue;
     }
 
     unsigned RelocSize = 1 << Obj.getAnyRelocationLength(MachOReloc);
     uint64_t Offset64 = Reloc.getOffset();
     if ((RelocSize != 4 && RelocSize != 8)) {
-      Linker.reportWarning(" unsupported relocation in debug_info section.");
+      reportWarning(" unsupported relocation in debug_info section.");
       continue;
     }
     uint32_t Offset = Offset64;
@@ -1959,7 +2005,7 @@ findValidRelocsMachO(const object::SectionRef &Section,
       Expected<StringRef> SymbolName = Sym->getName();
       if (!SymbolName) {
         consumeError(SymbolName.takeError());
-        Linker.reportWarning("error getting relocation symbol name.");
+        reportWarning("error getting relocation symbol name.");
         continue;
       }
       if (const auto *Mapping = DMO.lookupSymbol(*SymbolName))
@@ -1982,8 +2028,8 @@ bool DwarfLinker::RelocationManager::findValidRelocs(
   if (auto *MachOObj = dyn_cast<object::MachOObjectFile>(&Obj))
     findValidRelocsMachO(Section, *MachOObj, DMO);
   else
-    Linker.reportWarning(Twine("unsupported object file type: ") +
-                         Obj.getFileName());
+    reportWarning(Twine("unsupported object file type: ") +
+                  Obj.getFileName());
 
   if (ValidRelocs.empty())
     return false;
@@ -3276,19 +3322,49 @@ bool DwarfLinker::registerModuleReference(
 
 ErrorOr<const object::ObjectFile &>
 DwarfLinker::loadObject(BinaryHolder &BinaryHolder, DebugMapObject &Obj,
-                        const DebugMap &Map) {
+                        const DebugMap &Map,
+                        std::vector<std::string> *DeferredWarnings) {
+  auto Warn = [&](std::error_code EC) {
+    std::string Warning =
+        (Twine(Obj.getObjectFilename()) + ": " + EC.message()).str();
+    if (DeferredWarnings)
+      DeferredWarnings->push_back(Warning);
+    else
+      reportWarning(Warning);
+  };
   auto ErrOrObjs =
       BinaryHolder.GetObjectFiles(Obj.getObjectFilename(), Obj.getTimestamp());
   if (std::error_code EC = ErrOrObjs.getError()) {
-    reportWarning(Twine(Obj.getObjectFilename()) + ": " + EC.message());
+    Warn(EC);
     return EC;
   }
   auto ErrOrObj = BinaryHolder.Get(Map.getTriple());
   if (std::error_code EC = ErrOrObj.getError())
-    reportWarning(Twine(Obj.getObjectFilename()) + ": " + EC.message());
+    Warn(EC);
   return ErrOrObj;
 }
 
+void DwarfLinker::loadContext(LinkContext &Ctx, BinaryHolder &BinaryHolder,
+                              const DebugMap &Map) {
+  auto ErrOrObj = loadObject(BinaryHolder, Ctx.DMO, Map, &Ctx.Warnings);
+  if (!ErrOrObj)
+    return;
+  Ctx.ObjectFile = &*ErrOrObj;
+
+  // Look for relocations that correspond to debug map entries.
+  Ctx.RelocMgr = llvm::make_unique<RelocationManager>(*this);
+  Ctx.RelocMgr->deferWarnings(&Ctx.Warnings);
+  Ctx.HasValidRelocs =
+      Ctx.RelocMgr->findValidRelocsInDebugInfo(*Ctx.ObjectFile, Ctx.DMO);
+  if (!Ctx.HasValidRelocs)
+    return;
+
+  // Setup access to the debug info and extract all the DIEs.
+  Ctx.DwarfContext = llvm::make_unique<DWARFContextInMemory>(*Ctx.ObjectFile);
+  for (const auto &CU : Ctx.DwarfContext->compile_units())
+    CU->getUnitDIE(false);
+}
+
 void DwarfLinker::loadClangModule(StringRef Filename, StringRef ModulePath,
                                   StringRef ModuleName, uint64_t DwoId,
                                   DebugMap &ModuleMap, unsigned Indent) {
@@ -3422,6 +3498,65 @@ void DwarfLinker::DIECloner::cloneAllCompileUnits(
   }
 }
 
+void DwarfLinker::linkContext(LinkContext &Ctx, DebugMap &ModuleMap) {
+  for (const std::string &Warning : Ctx.Warnings)
+    reportWarning(Warning);
+  if (!Ctx.ObjectFile)
+    return;
+
+  if (!Ctx.HasValidRelocs) {
+    if (Options.Verbose)
+      outs() << "No valid relocations found. Skipping.\n";
+    return;
+  }
+
+  RelocationManager &RelocMgr = *Ctx.RelocMgr;
+  RelocMgr.deferWarnings(nullptr);
+  DebugMapObject &Obj = Ctx.DMO;
+  DWARFContextInMemory &DwarfContext = *Ctx.DwarfContext;
+  startDebugObject(DwarfContext, Obj);
+
+  // In a first phase, just read in the debug info and load all clang modules.
+  for (const auto &CU : DwarfContext.compile_units()) {
+    auto *CUDie = CU->getUnitDIE(false);
+    if (Options.Verbose) {
+      outs() << "Input compilation unit:";
+      CUDie->dump(outs(), CU.get(), 0);
+    }
+
+    if (!registerModuleReference(*CUDie, *CU, ModuleMap))
+      Units.emplace_back(*CU, UnitID++, !Options.NoODR, "");
+  }
+
+  // Now build the DIE parent links that we will use during the next phase.
+  for (auto &CurrentUnit : Units)
+    analyzeContextInfo(CurrentUnit.getOrigUnit().getUnitDIE(), 0, CurrentUnit,
+                       &ODRContexts.getRoot(), StringPool, ODRContexts);
+
+  // Then mark all the DIEs that need to be present in the linked
+  // output and collect some information about them. Note that this
+  // loop can not be merged with the previous one becaue cross-cu
+  // references require the ParentIdx to be setup for every CU in
+  // the object file before calling this.
+  for (auto &CurrentUnit : Units)
+    lookForDIEsToKeep(RelocMgr, *CurrentUnit.getOrigUnit().getUnitDIE(), Obj,
+                      CurrentUnit, 0);
+
+  // The calls to applyValidRelocs inside cloneDIE will walk the
+  // reloc array again (in the same way findValidRelocsInDebugInfo()
+  // did). We need to reset the NextValidReloc index to the beginning.
+  RelocMgr.resetValidRelocs();
+  if (RelocMgr.hasValidRelocs())
+    DIECloner(*this, RelocMgr, DIEAlloc, Units, Options)
+        .cloneAllCompileUnits(DwarfContext);
+  if (!Options.NoOutput && !Units.empty())
+    patchFrameInfoForObject(Obj, DwarfContext,
+                            Units[0].getOrigUnit().getAddressByteSize());
+
+  // Clean-up before starting working on the next object.
+  endDebugObject();
+}
+
 bool DwarfLinker::link(const DebugMap &Map) {
 
   if (!createStreamer(Map.getTriple(), OutputFilename))
@@ -3433,66 +3568,54 @@ bool DwarfLinker::link(const DebugMap &Map) {
   UnitID = 0;
   DebugMap ModuleMap(Map.getTriple(), Map.getBinaryPath());
 
-  for (const auto &Obj : Map.objects()) {
-    CurrentDebugObject = Obj.get();
-
-    if (Options.Verbose)
-      outs() << "DEBUG MAP OBJECT: " << Obj->getObjectFilename() << "\n";
-    auto ErrOrObj = loadObject(BinHolder, *Obj, Map);
-    if (!ErrOrObj)
-      continue;
-
-    // Look for relocations that correspond to debug map entries.
-    RelocationManager RelocMgr(*this);
-    if (!RelocMgr.findValidRelocsInDebugInfo(*ErrOrObj, *Obj)) {
-      if (Options.Verbose)
-        outs() << "No valid relocations found. Skipping.\n";
-      continue;
-    }
-
-    // Setup access to the debug info.
-    DWARFContextInMemory DwarfContext(*ErrOrObj);
-    startDebugObject(DwarfContext, *Obj);
+  // Loading an object file, finding its valid relocations and parsing its
+  // debug info does not depend on any other object, so that is done ahead of
+  // time on a thread pool. The ODR uniquing, the cloning and the emission are
+  // done here, one object at a time in debug map order, which keeps the
+  // output and the diagnostics the same whatever the number of threads.
+  unsigned NumThreads = Options.Verbose ? 1 : Options.Threads;
+  if (!NumThreads)
+    NumThreads = heavyweight_hardware_concurrency();
+
+  std::vector<std::unique_ptr<LinkContext>> Contexts;
+  for (const auto &Obj : Map.objects())
+    Contexts.push_back(llvm::make_unique<LinkContext>(*Obj));
+
+  // Only a few objects are loaded ahead of the one being linked, to bound
+  // the memory used by the mapped files and the parsed DIEs.
+  std::unique_ptr<ThreadPool> Pool;
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Loaded(Contexts.size());
+  size_t Lookahead = 2 * NumThreads;
+  auto LoadAhead = [&](size_t I) {
+    if (I >= Contexts.size())
+      return;
+    LinkContext &Ctx = *Contexts[I];
+    Loaded[I] = Pool->async([this, &Ctx, &Map] {
+      Ctx.OwnedBinHolder = llvm::make_unique<BinaryHolder>(Options.Verbose);
+      loadContext(Ctx, *Ctx.OwnedBinHolder, Map);
+    });
+  };
+  if (NumThreads > 1 && Contexts.size() > 1) {
+    Pool = llvm::make_unique<ThreadPool>(NumThreads);
+    for (size_t I = 0; I != Lookahead; ++I)
+      LoadAhead(I);
+  }
 
-    // In a first phase, just read in the debug info and load all clang modules.
-    for (const auto &CU : DwarfContext.compile_units()) {
-      auto *CUDie = CU->getUnitDIE(false);
-      if (Options.Verbose) {
-        outs() << "Input compilation unit:";
-        CUDie->dump(outs(), CU.get(), 0);
-      }
+  for (size_t I = 0, E = Contexts.size(); I != E; ++I) {
+    LinkContext &Ctx = *Contexts[I];
+    CurrentDebugObject = &Ctx.DMO;
 
-      if (!registerModuleReference(*CUDie, *CU, ModuleMap))
-        Units.emplace_back(*CU, UnitID++, !Options.NoODR, "");
+    if (Options.Verbose)
+      outs() << "DEBUG MAP OBJECT: " << Ctx.DMO.getObjectFilename() << "\n";
+    if (Pool) {
+      Loaded[I].wait();
+      LoadAhead(I + Lookahead);
+    } else {
+      loadContext(Ctx, BinHolder, Map);
     }
 
-    // Now build the DIE parent links that we will use during the next phase.
-    for (auto &CurrentUnit : Units)
-      analyzeContextInfo(CurrentUnit.getOrigUnit().getUnitDIE(), 0, CurrentUnit,
-                         &ODRContexts.getRoot(), StringPool, ODRContexts);
-
-    // Then mark all the DIEs that need to be present in the linked
-    // output and collect some information about them. Note that this
-    // loop can not be merged with the previous one becaue cross-cu
-    // references require the ParentIdx to be setup for every CU in
-    // the object file before calling this.
-    for (auto &CurrentUnit : Units)
-      lookForDIEsToKeep(RelocMgr, *CurrentUnit.getOrigUnit().getUnitDIE(), *Obj,
-                        CurrentUnit, 0);
-
-    // The calls to applyValidRelocs inside cloneDIE will walk the
-    // reloc array again (in the same way findValidRelocsInDebugInfo()
-    // did). We need to reset the NextValidReloc index to the beginning.
-    RelocMgr.resetValidRelocs();
-    if (RelocMgr.hasValidRelocs())
-      DIECloner(*this, RelocMgr, DIEAlloc, Units, Options)
-          .cloneAllCompileUnits(DwarfContext);
-    if (!Options.NoOutput && !Units.empty())
-      patchFrameInfoForObject(*Obj, DwarfContext,
-                              Units[0].getOrigUnit().getAddressByteSize());
-
-    // Clean-up before starting working on the next object.
-    endDebugObject();
+    linkContext(Ctx, ModuleMap);
+    Contexts[I].reset();
   }
 
   // Emit everything that's global.
@@ -19,11 +19,14 @@
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/LTO/Caching.h"
 #include "llvm/LTO/LTO.h"
+#include "llvm/Object/IRObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <list>
 #include <map>
@@ -57,6 +60,9 @@ struct claimed_file {
   void *handle;
   void *leader_handle;
   std::vector<ld_plugin_symbol> syms;
+  /// The symbols as read in claim_file_hook, checked against the InputFile
+  /// the module is eventually added to LTO with.
+  std::vector<object::IRSymbol> IRSyms;
   off_t filesize;
   std::string name;
 };
@@ -166,6 +172,11 @@ namespace options {
   static std::string thinlto_prefix_replace;
   // Optional path to a directory for caching ThinLTO objects.
   static std::string cache_dir;
+  // Order the hot functions of the regular LTO module using its profile data.
+  static bool profile_function_order = false;
+  // Optional path to a file to which the profile-guided function order is
+  // written, one symbol per line. Implies profile_function_order.
+  static std::string symbol_ordering_file;
   // Additional options to pass into the code generator.
   // Note: This array will contain all plugin options which are not claimed
   // as plugin exclusive to pass to the code generator.
@@ -206,6 +217,10 @@ namespace options {
         message(LDPL_FATAL, "thinlto-prefix-replace expects 'old;new' format");
     } else if (opt.startswith("cache-dir=")) {
       cache_dir = opt.substr(strlen("cache-dir="));
+    } else if (opt == "profile-function-order") {
+      profile_function_order = true;
+    } else if (opt.startswith("symbol-ordering-file=")) {
+      symbol_ordering_file = opt.substr(strlen("symbol-ordering-file="));
     } else if (opt.size() == 2 && opt[0] == 'O') {
       if (opt[1] < '0' || opt[1] > '3')
         message(LDPL_FATAL, "Optimization level must be between 0 and 3");
@@ -445,23 +460,39 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
 
   *claimed = 1;
 
-  Expected<std::unique_ptr<InputFile>> ObjOrErr = InputFile::create(BufferRef);
-  if (!ObjOrErr) {
-    handleAllErrors(ObjOrErr.takeError(), [&](const ErrorInfoBase &EI) {
-      std::error_code EC = EI.convertToErrorCode();
-      if (EC == object::object_error::invalid_file_type ||
-          EC == object::object_error::bitcode_section_not_found)
-        *claimed = 0;
-      else
-        message(LDPL_ERROR,
-                "LLVM gold plugin has failed to create LTO module: %s",
-                EI.message().c_str());
-    });
-
-    return *claimed ? LDPS_ERR : LDPS_OK;
-  }
+  // Gold calls this hook serially for every input file, so avoid creating a
+  // Module: most files can be read from the module-level bitcode records.
+  std::string SourceFileName;
+  std::vector<object::IRSymbol> Symbols;
+  ErrorOr<std::vector<object::IRSymbol>> SymbolsOrErr =
+      object::IRObjectFile::readLinkerSymbols(BufferRef, SourceFileName);
+  if (SymbolsOrErr) {
+    Symbols = std::move(*SymbolsOrErr);
+  } else {
+    Expected<std::unique_ptr<InputFile>> ObjOrErr =
+        InputFile::create(BufferRef);
+    if (!ObjOrErr) {
+      handleAllErrors(ObjOrErr.takeError(), [&](const ErrorInfoBase &EI) {
+        std::error_code EC = EI.convertToErrorCode();
+        if (EC == object::object_error::invalid_file_type ||
+            EC == object::object_error::bitcode_section_not_found)
+          *claimed = 0;
+        else
+          message(LDPL_ERROR,
+                  "LLVM gold plugin has failed to create LTO module: %s",
+                  EI.message().c_str());
+      });
+
+      return *claimed ? LDPS_ERR : LDPS_OK;
+    }
 
-  std::unique_ptr<InputFile> Obj = std::move(*ObjOrErr);
+    std::unique_ptr<InputFile> Obj = std::move(*ObjOrErr);
+    SourceFileName = Obj->getSourceFileName();
+    for (auto &Sym : Obj->symbols())
+      Symbols.push_back({Sym.getName().str(), Sym.getFlags(),
+                         Sym.getVisibility(), Sym.canBeOmittedFromSymbolTable(),
+                         check(Sym.getComdat()).str()});
+  }
 
   Modules.resize(Modules.size() + 1);
   claimed_file &cf = Modules.back();
@@ -483,23 +514,22 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
   cf.name = file->name;
   if (file->offset)
     cf.name += ".llvm." + std::to_string(file->offset) + "." +
-               sys::path::filename(Obj->getSourceFileName()).str();
+               sys::path::filename(SourceFileName).str();
 
-  for (auto &Sym : Obj->symbols()) {
-    uint32_t Symflags = Sym.getFlags();
+  for (const object::IRSymbol &Sym : Symbols) {
+    uint32_t Symflags = Sym.Flags;
 
     cf.syms.push_back(ld_plugin_symbol());
     ld_plugin_symbol &sym = cf.syms.back();
     sym.version = nullptr;
-    StringRef Name = Sym.getName();
-    sym.name = strdup(Name.str().c_str());
+    sym.name = strdup(Sym.Name.c_str());
 
-    ResolutionInfo &Res = ResInfo[Name];
+    ResolutionInfo &Res = ResInfo[Sym.Name];
 
-    Res.CanOmitFromDynSym &= Sym.canBeOmittedFromSymbolTable();
+    Res.CanOmitFromDynSym &= Sym.CanOmitFromDynSym;
 
     sym.visibility = LDPV_DEFAULT;
-    GlobalValue::VisibilityTypes Vis = Sym.getVisibility();
+    GlobalValue::VisibilityTypes Vis = Sym.Visibility;
     if (Vis != GlobalValue::DefaultVisibility)
       Res.DefaultVisibility = false;
     switch (Vis) {
@@ -526,13 +556,14 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
 
     sym.size = 0;
     sym.comdat_key = nullptr;
-    StringRef C = check(Sym.getComdat());
-    if (!C.empty())
-      sym.comdat_key = strdup(C.str().c_str());
+    if (!Sym.Comdat.empty())
+      sym.comdat_key = strdup(Sym.Comdat.c_str());
 
     sym.resolution = LDPR_UNKNOWN;
   }
 
+  cf.IRSyms = std::move(Symbols);
+
   if (!cf.syms.empty()) {
     if (add_symbols(cf.handle, cf.syms.size(), cf.syms.data()) != LDPS_OK) {
       message(LDPL_ERROR, "Unable to add symbols!");
@@ -566,17 +597,36 @@ static const void *getSymbolsAndView(claimed_file &F) {
   return View;
 }
 
-static void addModule(LTO &Lto, claimed_file &F, const void *View) {
-  MemoryBufferRef BufferRef(StringRef((const char *)View, F.filesize), F.name);
-  Expected<std::unique_ptr<InputFile>> ObjOrErr = InputFile::create(BufferRef);
-
-  if (!ObjOrErr)
-    message(LDPL_FATAL, "Could not read bitcode from file : %s",
-            toString(ObjOrErr.takeError()).c_str());
+/// Whether \p Sym, as read in claim_file_hook, is \p ObjSym with the same
+/// properties that gold was told about.
+static bool isSameSymbol(const object::IRSymbol &Sym,
+                         const InputFile::Symbol &ObjSym) {
+  Expected<StringRef> ComdatOrErr = ObjSym.getComdat();
+  if (!ComdatOrErr) {
+    consumeError(ComdatOrErr.takeError());
+    return false;
+  }
+  return Sym.Name == ObjSym.getName() && Sym.Flags == ObjSym.getFlags() &&
+         Sym.Visibility == ObjSym.getVisibility() &&
+         Sym.CanOmitFromDynSym == ObjSym.canBeOmittedFromSymbolTable() &&
+         Sym.Comdat == *ComdatOrErr;
+}
 
+static void addModule(LTO &Lto, claimed_file &F,
+                      std::unique_ptr<InputFile> Obj) {
   unsigned SymNum = 0;
   std::vector<SymbolResolution> Resols(F.syms.size());
+  // The symbols given to gold were usually read without creating a Module.
+  // Make sure that they are the ones LTO resolves, with the same properties.
+  auto ObjSyms = Obj->symbols();
+  auto ObjSym = ObjSyms.begin();
   for (ld_plugin_symbol &Sym : F.syms) {
+    if (!(ObjSym != ObjSyms.end()) ||
+        !isSameSymbol(F.IRSyms[SymNum], *ObjSym))
+      message(LDPL_FATAL, "Symbol table mismatch in file : %s",
+              F.name.c_str());
+    ++ObjSym;
+
     SymbolResolution &R = Resols[SymNum++];
 
     ld_plugin_symbol_resolution Resolution =
@@ -618,11 +668,53 @@ static void addModule(LTO &Lto, claimed_file &F, const void *View) {
 
     freeSymName(Sym);
   }
+  if (ObjSym != ObjSyms.end())
+    message(LDPL_FATAL, "Symbol table mismatch in file : %s", F.name.c_str());
 
-  check(Lto.add(std::move(*ObjOrErr), Resols),
+  check(Lto.add(std::move(Obj), Resols),
         std::string("Failed to link module ") + F.name);
 }
 
+/// Create the InputFiles for \p Files on a thread pool, since this parses the
+/// module-level records of each file, and add them to \p Lto in order. The
+/// files are processed a window at a time to bound the memory held by parsed
+/// but not yet added files.
+static void addModules(LTO &Lto, ArrayRef<claimed_file *> Files,
+                       ArrayRef<const void *> Views) {
+  unsigned Threads = options::Parallelism
+                         ? options::Parallelism
+                         : llvm::heavyweight_hardware_concurrency();
+  ThreadPool Pool(Threads);
+  const size_t WindowSize = 4 * Threads;
+
+  for (size_t Begin = 0; Begin < Files.size(); Begin += WindowSize) {
+    size_t End = std::min(Files.size(), Begin + WindowSize);
+    std::vector<std::unique_ptr<InputFile>> Objs(End - Begin);
+    std::vector<std::string> Errors(End - Begin);
+    for (size_t I = Begin; I != End; ++I)
+      Pool.async([&, I]() {
+        claimed_file &F = *Files[I];
+        MemoryBufferRef BufferRef(
+            StringRef((const char *)Views[I], F.filesize), F.name);
+        Expected<std::unique_ptr<InputFile>> ObjOrErr =
+            InputFile::create(BufferRef);
+        if (ObjOrErr)
+          Objs[I - Begin] = std::move(*ObjOrErr);
+        else
+          Errors[I - Begin] = toString(ObjOrErr.takeError());
+      });
+    Pool.wait();
+
+    // Gold's callbacks, including message(), are only used from this thread.
+    for (size_t I = Begin; I != End; ++I) {
+      if (!Objs[I - Begin])
+        message(LDPL_FATAL, "Could not read bitcode from file : %s",
+                Errors[I - Begin].c_str());
+      addModule(Lto, *Files[I], std::move(Objs[I - Begin]));
+    }
+  }
+}
+
 static void recordFile(std::string Filename, bool TempOutFile) {
   if (add_input_file(Filename.c_str()) != LDPS_OK)
     message(LDPL_FATAL,
@@ -701,6 +793,9 @@ static std::unique_ptr<LTO> createLTO() {
         options::thinlto_linked_objects_file);
   }
 
+  Conf.ProfileFunctionOrder = options::profile_function_order;
+  Conf.SymbolOrderingFile = options::symbol_ordering_file;
+
   Conf.OverrideTriple = options::triple;
   Conf.DefaultTriple = sys::getDefaultTargetTriple();
 
@@ -786,6 +881,8 @@ static ld_plugin_status allSymbolsReadHook() {
   if (options::thinlto_index_only)
     getThinLTOOldAndNewPrefix(OldPrefix, NewPrefix);
 
+  std::vector<claimed_file *> Files;
+  std::vector<const void *> Views;
   for (claimed_file &F : Modules) {
     if (options::thinlto && !HandleToInputFile.count(F.leader_handle))
       HandleToInputFile.insert(std::make_pair(
@@ -798,8 +895,10 @@ static ld_plugin_status allSymbolsReadHook() {
         writeEmptyDistributedBuildOutputs(F.name, OldPrefix, NewPrefix);
       continue;
     }
-    addModule(*Lto, F, View);
+    Files.push_back(&F);
+    Views.push_back(View);
   }
+  addModules(*Lto, Files, Views);
 
   SmallString<128> Filename;
   // Note that getOutputFileName will append a unique ID for each task
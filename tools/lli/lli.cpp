@@ -51,6 +51,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Instrumentation.h"
 #include <cerrno>
@@ -382,6 +383,27 @@ int main(int argc, char **argv, char * const *envp) {
   if (DisableCoreFiles)
     sys::Process::PreventCoreFiles();
 
+  // The lazy JIT keeps every module in its own context, so the extra modules
+  // can be parsed on other threads while the main one is. They must outlive
+  // the JIT, which owns their modules.
+  std::vector<std::unique_ptr<LLVMContext>> ExtraContexts;
+  std::vector<std::unique_ptr<Module>> ExtraMods(ExtraModules.size());
+  std::vector<SMDiagnostic> ExtraErrs(ExtraModules.size());
+  std::unique_ptr<ThreadPool> ExtraModulePool;
+  if (UseJITKind == JITKind::OrcLazy && !ExtraModules.empty()) {
+    unsigned Threads = std::min((unsigned)ExtraModules.size(),
+                                std::max(1u, thread::hardware_concurrency()));
+    ExtraModulePool = llvm::make_unique<ThreadPool>(Threads);
+    for (unsigned I = 0, E = ExtraModules.size(); I != E; ++I) {
+      ExtraContexts.push_back(llvm::make_unique<LLVMContext>());
+      LLVMContext *ExtraContext = ExtraContexts.back().get();
+      ExtraModulePool->async([&, I, ExtraContext] {
+        ExtraMods[I] =
+            parseIRFile(ExtraModules[I], ExtraErrs[I], *ExtraContext);
+      });
+    }
+  }
+
   LLVMContext Context;
 
   // Load the bitcode...
@@ -396,12 +418,14 @@ int main(int argc, char **argv, char * const *envp) {
   if (UseJITKind == JITKind::OrcLazy) {
     std::vector<std::unique_ptr<Module>> Ms;
     Ms.push_back(std::move(Owner));
-    for (auto &ExtraMod : ExtraModules) {
-      Ms.push_back(parseIRFile(ExtraMod, Err, Context));
-      if (!Ms.back()) {
-        Err.print(argv[0], errs());
+    if (ExtraModulePool)
+      ExtraModulePool->wait();
+    for (unsigned I = 0, E = ExtraModules.size(); I != E; ++I) {
+      if (!ExtraMods[I]) {
+        ExtraErrs[I].print(argv[0], errs());
         return 1;
       }
+      Ms.push_back(std::move(ExtraMods[I]));
     }
     return runOrcLazyJIT(std::move(Ms), argc, argv);
   }
@@ -546,6 +570,8 @@ int main(int argc, char **argv, char * const *envp) {
                 JITEventListener::createOProfileJITEventListener());
   EE->RegisterJITEventListener(
                 JITEventListener::createIntelJITEventListener());
+  EE->RegisterJITEventListener(
+                JITEventListener::createPerfJITEventListener());
 
   if (!NoLazyCompilation && RemoteMCJIT) {
     errs() << "warning: remote mcjit does not support lazy compilation\n";
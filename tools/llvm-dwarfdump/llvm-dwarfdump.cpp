@@ -12,6 +12,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -26,9 +28,11 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstring>
+#include <map>
 #include <string>
 #include <system_error>
 
@@ -78,6 +82,22 @@ static cl::opt<bool>
     SummarizeTypes("summarize-types",
                    cl::desc("Abbreviate the description of type unit entries"));
 
+static cl::list<std::string>
+    FindNames("find",
+              cl::desc("Print the debug info entries with this exact name, "
+                       "looked up in the .apple_names accelerator table"),
+              cl::value_desc("name"));
+
+static cl::opt<bool>
+    Statistics("statistics",
+               cl::desc("Print a summary of the size of the .debug_info "
+                        "section by tag and attribute instead of dumping"));
+
+static cl::opt<unsigned>
+    NumThreads("j", cl::init(0),
+               cl::desc("Number of threads used to gather statistics "
+                        "(default = number of cores)"));
+
 static void error(StringRef Filename, std::error_code EC) {
   if (!EC)
     return;
@@ -85,11 +105,183 @@ static void error(StringRef Filename, std::error_code EC) {
   exit(1);
 }
 
+namespace {
+/// Size statistics of one or more compile units.
+struct DebugInfoStats {
+  struct Entry {
+    uint64_t Count = 0;
+    uint64_t Bytes = 0;
+  };
+  uint64_t NumUnits = 0;
+  uint64_t NumDIEs = 0;
+  uint64_t Bytes = 0;
+  /// Variables and parameters, and how many of them have a location or a
+  /// constant value.
+  uint64_t NumVars = 0;
+  uint64_t NumVarsWithLocation = 0;
+  std::map<uint32_t, Entry> Tags;
+  std::map<uint16_t, Entry> Attributes;
+
+  void add(const DebugInfoStats &Other) {
+    NumUnits += Other.NumUnits;
+    NumDIEs += Other.NumDIEs;
+    Bytes += Other.Bytes;
+    NumVars += Other.NumVars;
+    NumVarsWithLocation += Other.NumVarsWithLocation;
+    for (const auto &Tag : Other.Tags) {
+      Tags[Tag.first].Count += Tag.second.Count;
+      Tags[Tag.first].Bytes += Tag.second.Bytes;
+    }
+    for (const auto &Attr : Other.Attributes) {
+      Attributes[Attr.first].Count += Attr.second.Count;
+      Attributes[Attr.first].Bytes += Attr.second.Bytes;
+    }
+  }
+};
+}
+
+/// Gather the statistics of a single unit. This only touches the unit itself,
+/// so units can be processed in parallel.
+static void collectUnitStats(DWARFUnit &U, DebugInfoStats &Stats) {
+  DataExtractor Data = U.getDebugInfoExtractor();
+  unsigned NumDIEs = U.getNumDIEs();
+  Stats.NumUnits = 1;
+  Stats.NumDIEs = NumDIEs;
+  Stats.Bytes = U.getNextUnitOffset() - U.getOffset();
+
+  // Whether each enclosing DIE is part of an abstract instance tree, that is
+  // a DW_TAG_subprogram with DW_AT_inline or one of its descendants.
+  SmallVector<bool, 8> InAbstractTree;
+  for (unsigned I = 0; I != NumDIEs; ++I) {
+    const DWARFDebugInfoEntryMinimal *Die = U.getDIEAtIndex(I);
+    uint32_t End = I + 1 != NumDIEs ? U.getDIEAtIndex(I + 1)->getOffset()
+                                    : U.getNextUnitOffset();
+    DebugInfoStats::Entry &Tag = Stats.Tags[Die->getTag()];
+    ++Tag.Count;
+    Tag.Bytes += End - Die->getOffset();
+
+    const DWARFAbbreviationDeclaration *Abbrev =
+        Die->getAbbreviationDeclarationPtr();
+    if (!Abbrev) {
+      // A NULL entry ends the children of the innermost open DIE.
+      if (!InAbstractTree.empty())
+        InAbstractTree.pop_back();
+      continue;
+    }
+
+    bool IsAbstract = !InAbstractTree.empty() && InAbstractTree.back();
+    bool IsVar = Die->getTag() == dwarf::DW_TAG_variable ||
+                 Die->getTag() == dwarf::DW_TAG_formal_parameter;
+    bool HasLocation = false;
+    uint32_t Offset = Die->getOffset();
+    Data.getULEB128(&Offset);
+    for (const auto &Spec : Abbrev->attributes()) {
+      uint32_t Start = Offset;
+      if (!DWARFFormValue::skipValue(Spec.Form, Data, &Offset, &U))
+        break;
+      DebugInfoStats::Entry &Attr = Stats.Attributes[Spec.Attr];
+      ++Attr.Count;
+      Attr.Bytes += Offset - Start;
+      if (Spec.Attr == dwarf::DW_AT_location ||
+          Spec.Attr == dwarf::DW_AT_const_value)
+        HasLocation = true;
+      else if (Spec.Attr == dwarf::DW_AT_inline &&
+               Die->getTag() == dwarf::DW_TAG_subprogram)
+        IsAbstract = true;
+    }
+    if (Abbrev->hasChildren())
+      InAbstractTree.push_back(IsAbstract);
+
+    // Abstract variables only hold the attributes their concrete instances
+    // share and declarations describe variables defined elsewhere; neither
+    // has a location of its own. Every other variable, including concrete
+    // instances that refer to an abstract one with DW_AT_abstract_origin,
+    // is expected to have one unless it was optimized out.
+    if (IsVar && !IsAbstract &&
+        !Die->getAttributeValueAsUnsignedConstant(&U, dwarf::DW_AT_declaration,
+                                                  0)) {
+      ++Stats.NumVars;
+      if (HasLocation)
+        ++Stats.NumVarsWithLocation;
+    }
+  }
+}
+
+static void printDebugInfoStats(raw_ostream &OS, DWARFContext &DICtx) {
+  std::vector<DWARFUnit *> Units;
+  for (const auto &CU : DICtx.compile_units())
+    Units.push_back(CU.get());
+  for (const auto &TUS : DICtx.type_unit_sections())
+    for (const auto &TU : TUS)
+      Units.push_back(TU.get());
+
+  std::vector<DebugInfoStats> UnitStats(Units.size());
+  {
+    std::unique_ptr<ThreadPool> Pool(NumThreads ? new ThreadPool(NumThreads)
+                                                : new ThreadPool());
+    for (unsigned I = 0, E = Units.size(); I != E; ++I)
+      Pool->async([&, I] { collectUnitStats(*Units[I], UnitStats[I]); });
+    Pool->wait();
+  }
+
+  DebugInfoStats Total;
+  for (const DebugInfoStats &Stats : UnitStats)
+    Total.add(Stats);
+
+  OS << "Debug info statistics:\n"
+     << "  units: " << Total.NumUnits << '\n'
+     << "  DIEs: " << Total.NumDIEs << '\n'
+     << "  bytes: " << Total.Bytes << '\n'
+     << "  variables with a location: " << Total.NumVarsWithLocation
+     << " of " << Total.NumVars;
+  if (Total.NumVars)
+    OS << format(" (%.1f%%)", 100.0 * Total.NumVarsWithLocation /
+                                  Total.NumVars);
+  OS << "\n\nBytes by tag:\n";
+  for (const auto &Tag : Total.Tags) {
+    StringRef Name = Tag.first ? dwarf::TagString(Tag.first) : "NULL";
+    std::string Unknown;
+    if (Name.empty())
+      Name = Unknown = "DW_TAG_Unknown_" + utohexstr(Tag.first);
+    OS << format("  %-36s %10" PRIu64 " %10" PRIu64 "\n", Name.str().c_str(),
+                 Tag.second.Count, Tag.second.Bytes);
+  }
+  OS << "\nBytes by attribute:\n";
+  for (const auto &Attr : Total.Attributes) {
+    StringRef Name = dwarf::AttributeString(Attr.first);
+    std::string Unknown;
+    if (Name.empty())
+      Name = Unknown = "DW_AT_Unknown_" + utohexstr(Attr.first);
+    OS << format("  %-36s %10" PRIu64 " %10" PRIu64 "\n", Name.str().c_str(),
+                 Attr.second.Count, Attr.second.Bytes);
+  }
+}
+
 static void DumpObjectFile(ObjectFile &Obj, Twine Filename) {
-  std::unique_ptr<DIContext> DICtx(new DWARFContextInMemory(Obj));
+  std::unique_ptr<DWARFContext> DICtx(new DWARFContextInMemory(Obj));
 
   outs() << Filename.str() << ":\tfile format " << Obj.getFileFormatName()
          << "\n\n";
+
+  if (Statistics) {
+    printDebugInfoStats(outs(), *DICtx);
+    return;
+  }
+
+  if (!FindNames.empty()) {
+    for (const std::string &Name : FindNames) {
+      SmallVector<std::pair<DWARFCompileUnit *,
+                            const DWARFDebugInfoEntryMinimal *>, 4> DIEs;
+      if (!DICtx->findDIEsByName(Name, DIEs)) {
+        errs() << Filename << ": no usable .apple_names accelerator table\n";
+        return;
+      }
+      for (const auto &CUAndDie : DIEs)
+        CUAndDie.second->dump(outs(), CUAndDie.first, 0);
+    }
+    return;
+  }
+
   // Dump the complete DWARF structure.
   DICtx->dump(outs(), DumpType, false, SummarizeTypes);
 }
@@ -487,18 +487,18 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
   std::deque<SmallString<32>> UncompressedSections;
 
+  // Each input is released once its contents have been handed to the
+  // streamer: nothing recorded across iterations refers back into it, so
+  // only one input (and its decompressed sections) is live at a time.
   for (const auto &Input : Inputs) {
     auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
     if (!ErrOrObj)
       return ErrOrObj.takeError();
 
     auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+    UncompressedSections.clear();
 
     UnitIndexEntry CurEntry = {};
 
@@ -27,11 +27,13 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
@@ -85,6 +87,10 @@ static cl::opt<bool>
     DisableLazyLoad("disable-lazy-loading",
                     cl::desc("Disable lazy module loading"));
 
+static cl::opt<unsigned> PrefetchInputs(
+    "prefetch", cl::init(0), cl::value_desc("N"),
+    cl::desc("Read the next N input files on other threads while linking"));
+
 static cl::opt<bool>
     OutputAssembly("S", cl::desc("Write output as LLVM assembly"), cl::Hidden);
 
@@ -109,16 +115,22 @@ static cl::opt<bool> PreserveAssemblyUseListOrder(
     cl::init(false), cl::Hidden);
 
 // Read the specified bitcode file in and return it. This routine searches the
-// link path for the specified file to try to find it...
+// link path for the specified file to try to find it... If the contents of the
+// file have already been read into \p Buffer, they are used instead.
 //
-static std::unique_ptr<Module> loadFile(const char *argv0,
-                                        const std::string &FN,
-                                        LLVMContext &Context,
-                                        bool MaterializeMetadata = true) {
+static std::unique_ptr<Module>
+loadFile(const char *argv0, const std::string &FN, LLVMContext &Context,
+         bool MaterializeMetadata = true,
+         std::unique_ptr<MemoryBuffer> Buffer = nullptr) {
   SMDiagnostic Err;
   if (Verbose) errs() << "Loading '" << FN << "'\n";
   std::unique_ptr<Module> Result;
-  if (DisableLazyLoad)
+  if (Buffer && DisableLazyLoad)
+    Result = parseIR(Buffer->getMemBufferRef(), Err, Context);
+  else if (Buffer)
+    Result = getLazyIRModule(std::move(Buffer), Err, Context,
+                             !MaterializeMetadata);
+  else if (DisableLazyLoad)
     Result = parseIRFile(FN, Err, Context);
   else
     Result = getLazyIRFileModule(FN, Err, Context, !MaterializeMetadata);
@@ -297,10 +309,57 @@ static bool importFunctions(const char *argv0, LLVMContext &Context,
 static bool linkFiles(const char *argv0, LLVMContext &Context, Linker &L,
                       const cl::list<std::string> &Files,
                       unsigned Flags) {
+  // If a module summary index is supplied, load it so linkInModule can treat
+  // local functions/variables as exported and promote if necessary.
+  std::unique_ptr<ModuleSummaryIndex> Index;
+  if (!SummaryIndex.empty()) {
+    ErrorOr<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+        llvm::getModuleSummaryIndexForFile(SummaryIndex, diagnosticHandler);
+    std::error_code EC = IndexOrErr.getError();
+    if (EC) {
+      errs() << EC.message() << '\n';
+      return false;
+    }
+    Index = std::move(IndexOrErr.get());
+  }
+
+  // With -prefetch, the next input files are read into memory on other
+  // threads while the current one is linked, so that reading them overlaps
+  // with linking. Files are read rather than mapped (hence IsVolatileSize), as
+  // mapping them would leave the actual I/O to this thread. If reading a file
+  // fails, it is simply loaded again below, which reports the error.
+  std::vector<std::unique_ptr<MemoryBuffer>> Buffers(Files.size());
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Reads(Files.size());
+  std::unique_ptr<ThreadPool> Pool;
+  auto StartRead = [&](unsigned I) {
+    if (I >= Files.size() || Files[I] == "-")
+      return;
+    Reads[I] = Pool->async([&Files, &Buffers, I] {
+      ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+          MemoryBuffer::getFile(Files[I], /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/true,
+                                /*IsVolatileSize=*/true);
+      if (BufferOrErr)
+        Buffers[I] = std::move(*BufferOrErr);
+    });
+  };
+  if (PrefetchInputs) {
+    Pool = llvm::make_unique<ThreadPool>(PrefetchInputs);
+    for (unsigned I = 0; I != PrefetchInputs; ++I)
+      StartRead(I);
+  }
+
   // Filter out flags that don't apply to the first file we load.
   unsigned ApplicableFlags = Flags & Linker::Flags::OverrideFromSrc;
-  for (const auto &File : Files) {
-    std::unique_ptr<Module> M = loadFile(argv0, File, Context);
+  for (unsigned I = 0, E = Files.size(); I != E; ++I) {
+    const std::string &File = Files[I];
+    if (Pool) {
+      StartRead(I + PrefetchInputs);
+      if (Reads[I].valid())
+        Reads[I].wait();
+    }
+    std::unique_ptr<Module> M =
+        loadFile(argv0, File, Context, true, std::move(Buffers[I]));
     if (!M.get()) {
       errs() << argv0 << ": error loading file '" << File << "'\n";
       return false;
@@ -314,22 +373,9 @@ static bool linkFiles(const char *argv0, LLVMContext &Context, Linker &L,
       return false;
     }
 
-    // If a module summary index is supplied, load it so linkInModule can treat
-    // local functions/variables as exported and promote if necessary.
-    if (!SummaryIndex.empty()) {
-      ErrorOr<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
-          llvm::getModuleSummaryIndexForFile(SummaryIndex, diagnosticHandler);
-      std::error_code EC = IndexOrErr.getError();
-      if (EC) {
-        errs() << EC.message() << '\n';
-        return false;
-      }
-      auto Index = std::move(IndexOrErr.get());
-
-      // Promotion
-      if (renameModuleForThinLTO(*M, *Index))
-        return true;
-    }
+    // Promotion
+    if (Index && renameModuleForThinLTO(*M, *Index))
+      return true;
 
     if (Verbose)
       errs() << "Linking in '" << File << "'\n";
@@ -124,6 +124,15 @@ static cl::opt<std::string> ThinLTOModuleId(
 static cl::opt<std::string>
     ThinLTOCacheDir("thinlto-cache-dir", cl::desc("Enable ThinLTO caching."));
 
+static cl::opt<bool> ThinLTOCacheSummaries(
+    "thinlto-cache-summaries",
+    cl::desc("Also cache per-module summaries in the ThinLTO cache."));
+
+static cl::opt<bool> ThinLTOCacheCodeGen(
+    "thinlto-cache-codegen",
+    cl::desc("Also cache objects keyed on the optimized module in the ThinLTO "
+             "cache."));
+
 static cl::opt<std::string> ThinLTOSaveTempsPrefix(
     "thinlto-save-temps",
     cl::desc("Save ThinLTO temp files using filenames created by adding "
@@ -440,6 +449,8 @@ public:
     ThinGenerator.setCodePICModel(getRelocModel());
     ThinGenerator.setTargetOptions(Options);
     ThinGenerator.setCacheDir(ThinLTOCacheDir);
+    ThinGenerator.setCacheSummaries(ThinLTOCacheSummaries);
+    ThinGenerator.setCacheCodeGen(ThinLTOCacheCodeGen);
 
     // Add all the exported symbols to the table of symbols to preserve.
     for (unsigned i = 0; i < ExportedSymbols.size(); ++i)
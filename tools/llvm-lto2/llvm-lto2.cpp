@@ -19,6 +19,8 @@
 #include "llvm/LTO/Caching.h"
 #include "llvm/LTO/LTO.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Threading.h"
 
@@ -52,6 +54,33 @@ static cl::opt<bool>
                                        "import files for the "
                                        "distributed backend case"));
 
+static cl::opt<bool> ThinLTOFlatIndex(
+    "thinlto-flat-index", cl::init(false),
+    cl::desc("With -thinlto-distributed-indexes, write the individual indexes "
+             "in the flat, mmap-able format (.thinlto.fsi)"));
+
+static cl::opt<std::string> ThinLTOJobCommand(
+    "thinlto-job-command",
+    cl::desc("Run each ThinLTO backend job by invoking this program as "
+             "'<program> -run-thinlto-job <job> -o <object>'"),
+    cl::value_desc("program"));
+
+static cl::opt<bool>
+    RunThinLTOJob("run-thinlto-job", cl::init(false),
+                  cl::desc("Treat the input as a serialized ThinLTO backend "
+                           "job, run it and write the object to -o"));
+
+static cl::opt<bool>
+    ProfileFunctionOrder("profile-function-order", cl::init(false),
+                         cl::desc("Order hot functions using the profile "
+                                  "data in the regular LTO module"));
+
+static cl::opt<std::string>
+    SymbolOrderingFile("symbol-ordering-file",
+                       cl::desc("Write the profile-guided function order to "
+                                "this file (implies -profile-function-order)"),
+                       cl::value_desc("filename"));
+
 static cl::opt<int> Threads("-thinlto-threads",
                             cl::init(llvm::heavyweight_hardware_concurrency()));
 
@@ -96,6 +125,51 @@ template <typename T> static T check(ErrorOr<T> E, std::string Msg) {
   return T();
 }
 
+// Run \p Job by handing it to \p Program in a fresh process, through a pair
+// of temporary files.
+static Expected<std::unique_ptr<MemoryBuffer>>
+runThinLTOJobCommand(StringRef Program, const ThinBackendJob &Job) {
+  SmallString<128> JobPath, ObjPath;
+  int FD;
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("thinlto-job", "job", FD, JobPath))
+    return errorCodeToError(EC);
+  FileRemover JobRemover(JobPath);
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    writeThinBackendJob(Job, OS);
+  }
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("thinlto-job", "o", ObjPath))
+    return errorCodeToError(EC);
+  FileRemover ObjRemover(ObjPath);
+
+  std::vector<std::string> Args = {Program, "-run-thinlto-job", JobPath.str(),
+                                   "-o", ObjPath.str()};
+  if (!OptPipeline.empty())
+    Args.push_back("-opt-pipeline=" + OptPipeline);
+  if (!AAPipeline.empty())
+    Args.push_back("-aa-pipeline=" + AAPipeline);
+  std::vector<const char *> ArgPtrs;
+  for (const std::string &A : Args)
+    ArgPtrs.push_back(A.c_str());
+  ArgPtrs.push_back(nullptr);
+
+  std::string ErrMsg;
+  if (sys::ExecuteAndWait(Program, ArgPtrs.data(), nullptr, nullptr, 0, 0,
+                          &ErrMsg) != 0)
+    return make_error<StringError>(
+        "backend job for '" + Job.Module.getBufferIdentifier() + "' failed" +
+            (ErrMsg.empty() ? "" : ": " + ErrMsg),
+        inconvertibleErrorCode());
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> ObjOrErr =
+      MemoryBuffer::getFile(ObjPath);
+  if (!ObjOrErr)
+    return errorCodeToError(ObjOrErr.getError());
+  return std::move(*ObjOrErr);
+}
+
 int main(int argc, char **argv) {
   InitializeAllTargets();
   InitializeAllTargetMCs();
@@ -145,11 +219,44 @@ int main(int argc, char **argv) {
   Conf.OptPipeline = OptPipeline;
   Conf.AAPipeline = AAPipeline;
 
+  Conf.ProfileFunctionOrder = ProfileFunctionOrder;
+  Conf.SymbolOrderingFile = SymbolOrderingFile;
+
+  if (RunThinLTOJob) {
+    if (InputFilenames.size() != 1) {
+      llvm::errs() << argv[0] << ": -run-thinlto-job expects one job file\n";
+      return 1;
+    }
+    std::string F = InputFilenames[0];
+    std::unique_ptr<MemoryBuffer> MB = check(MemoryBuffer::getFile(F), F);
+    ThinBackendJob Job = check(readThinBackendJob(MB->getMemBufferRef()), F);
+    auto AddStream =
+        [&](size_t Task) -> std::unique_ptr<lto::NativeObjectStream> {
+      std::error_code EC;
+      auto S = llvm::make_unique<raw_fd_ostream>(OutputFilename, EC,
+                                                 sys::fs::F_None);
+      check(EC, OutputFilename);
+      return llvm::make_unique<lto::NativeObjectStream>(std::move(S));
+    };
+    check(runThinBackendJob(Conf, Job, AddStream), F);
+    return 0;
+  }
+
   ThinBackend Backend;
-  if (ThinLTODistributedIndexes)
-    Backend = createWriteIndexesThinBackend("", "", true, "");
-  else
+  if (ThinLTODistributedIndexes) {
+    Backend =
+        createWriteIndexesThinBackend("", "", true, "", ThinLTOFlatIndex);
+  } else if (!ThinLTOJobCommand.empty()) {
+    std::string Program =
+        check(sys::findProgramByName(ThinLTOJobCommand), ThinLTOJobCommand);
+    Backend = createOutOfProcessThinBackend(
+        [=](const ThinBackendJob &Job) {
+          return runThinLTOJobCommand(Program, Job);
+        },
+        Threads);
+  } else {
     Backend = createInProcessThinBackend(Threads);
+  }
   LTO Lto(std::move(Conf), std::move(Backend));
 
   bool HasErrors = false;
@@ -38,6 +38,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 
 using namespace llvm;
@@ -68,6 +69,11 @@ CompressDebugSections("compress-debug-sections", cl::ValueOptional,
     clEnumValN(DebugCompressionType::DCT_ZlibGnu, "zlib-gnu",
       "Use zlib-gnu compression (deprecated)")));
 
+static cl::opt<unsigned>
+CompressDebugSectionsThreads("compress-debug-sections-threads", cl::init(0),
+  cl::desc("Number of threads to compress large debug sections on "
+           "(0 = number of hardware threads)"));
+
 static cl::opt<bool>
 ShowInst("show-inst", cl::desc("Show internal instruction representation"));
 
@@ -501,6 +507,9 @@ int main(int argc, char **argv) {
       return 1;
     }
     MAI->setCompressDebugSections(CompressDebugSections);
+    MAI->setCompressDebugSectionsThreads(
+        CompressDebugSectionsThreads ? CompressDebugSectionsThreads
+                                     : heavyweight_hardware_concurrency());
   }
   MAI->setPreserveAsmComments(PreserveComments);
 
@@ -39,8 +39,10 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <cstring>
@@ -168,23 +170,31 @@ cl::opt<bool> FormatMachOasHex("x", cl::desc("Print symbol entry in hex, "
 cl::opt<bool> NoLLVMBitcode("no-llvm-bc",
                             cl::desc("Disable LLVM bitcode reader"));
 
+cl::opt<unsigned>
+    Threads("threads",
+            cl::desc("Number of threads used to read the members of an "
+                     "archive (0 = one per hardware thread)"),
+            cl::init(1));
+
 bool PrintAddress = true;
 
 bool MultipleFiles = false;
 
-bool HadError = false;
+std::atomic<bool> HadError(false);
 
 std::string ToolName;
 } // anonymous namespace
 
-static void error(Twine Message, Twine Path = Twine()) {
+static void error(Twine Message, Twine Path = Twine(),
+                  raw_ostream &OS = errs()) {
   HadError = true;
-  errs() << ToolName << ": " << Path << ": " << Message << ".\n";
+  OS << ToolName << ": " << Path << ": " << Message << ".\n";
 }
 
-static bool error(std::error_code EC, Twine Path = Twine()) {
+static bool error(std::error_code EC, Twine Path = Twine(),
+                  raw_ostream &OS = errs()) {
   if (EC) {
-    error(EC.message(), Path);
+    error(EC.message(), Path, OS);
     return true;
   }
   return false;
@@ -194,9 +204,10 @@ static bool error(std::error_code EC, Twine Path = Twine()) {
 // "libx.a(foo.o)" after the ToolName before the error message.  It sets
 // HadError but returns allowing the code to move on to other archive members. 
 static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
-                  StringRef ArchitectureName = StringRef()) {
+                  StringRef ArchitectureName = StringRef(),
+                  raw_ostream &ErrOS = errs()) {
   HadError = true;
-  errs() << ToolName << ": " << FileName;
+  ErrOS << ToolName << ": " << FileName;
 
   Expected<StringRef> NameOrErr = C.getName();
   // TODO: if we have a error getting the name then it would be nice to print
@@ -204,18 +215,18 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
   // archive instead of "???" as the name.
   if (!NameOrErr) {
     consumeError(NameOrErr.takeError());
-    errs() << "(" << "???" << ")";
+    ErrOS << "(" << "???" << ")";
   } else
-    errs() << "(" << NameOrErr.get() << ")";
+    ErrOS << "(" << NameOrErr.get() << ")";
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    ErrOS << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS, "");
   OS.flush();
-  errs() << " " << Buf << "\n";
+  ErrOS << " " << Buf << "\n";
 }
 
 // This version of error() prints the file name and which architecture slice it
@@ -280,9 +291,7 @@ static char isSymbolList64Bit(SymbolicFile &Obj) {
   return cast<ELFObjectFileBase>(Obj).getBytesInAddress() == 8;
 }
 
-static StringRef CurrentFilename;
 typedef std::vector<NMSymbol> SymbolListT;
-static SymbolListT SymbolList;
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 
@@ -293,7 +302,8 @@ static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 // darwin's nm(1) -x format.
 static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
                               char *SymbolAddrStr, const char *printBlanks,
-                              const char *printDashes, const char *printFormat) {
+                              const char *printDashes, const char *printFormat,
+                              raw_ostream &OS) {
   MachO::mach_header H;
   MachO::mach_header_64 H_64;
   uint32_t Filetype = MachO::MH_OBJECT;
@@ -355,16 +365,16 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
   if (FormatMachOasHex) {
     char Str[18] = "";
     format(printFormat, NValue).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%02x", NType).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%02x", NSect).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%04x", NDesc).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%08x", NStrx).print(Str, sizeof(Str));
-    outs() << Str << ' ';
-    outs() << I->Name << "\n";
+    OS << Str << ' ';
+    OS << I->Name << "\n";
     return;
   }
 
@@ -373,58 +383,58 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
       strcpy(SymbolAddrStr, printBlanks);
     if (Obj.isIR() && (NType & MachO::N_TYPE) == MachO::N_TYPE)
       strcpy(SymbolAddrStr, printDashes);
-    outs() << SymbolAddrStr << ' ';
+    OS << SymbolAddrStr << ' ';
   }
 
   switch (NType & MachO::N_TYPE) {
   case MachO::N_UNDF:
     if (NValue != 0) {
-      outs() << "(common) ";
+      OS << "(common) ";
       if (MachO::GET_COMM_ALIGN(NDesc) != 0)
-        outs() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
+        OS << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
     } else {
       if ((NType & MachO::N_TYPE) == MachO::N_PBUD)
-        outs() << "(prebound ";
+        OS << "(prebound ";
       else
-        outs() << "(";
+        OS << "(";
       if ((NDesc & MachO::REFERENCE_TYPE) ==
           MachO::REFERENCE_FLAG_UNDEFINED_LAZY)
-        outs() << "undefined [lazy bound]) ";
+        OS << "undefined [lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_LAZY)
-        outs() << "undefined [private lazy bound]) ";
+        OS << "undefined [private lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_NON_LAZY)
-        outs() << "undefined [private]) ";
+        OS << "undefined [private]) ";
       else
-        outs() << "undefined) ";
+        OS << "undefined) ";
     }
     break;
   case MachO::N_ABS:
-    outs() << "(absolute) ";
+    OS << "(absolute) ";
     break;
   case MachO::N_INDR:
-    outs() << "(indirect) ";
+    OS << "(indirect) ";
     break;
   case MachO::N_SECT: {
     if (Obj.isIR()) {
       // For llvm bitcode files print out a fake section name using the values
       // use 1, 2 and 3 for section numbers as set above.
       if (NSect == 1)
-        outs() << "(LTO,CODE) ";
+        OS << "(LTO,CODE) ";
       else if (NSect == 2)
-        outs() << "(LTO,DATA) ";
+        OS << "(LTO,DATA) ";
       else if (NSect == 3)
-        outs() << "(LTO,RODATA) ";
+        OS << "(LTO,RODATA) ";
       else
-        outs() << "(?,?) ";
+        OS << "(?,?) ";
       break;
     }
     Expected<section_iterator> SecOrErr =
       MachO->getSymbolSection(I->Sym.getRawDataRefImpl());
     if (!SecOrErr) {
       consumeError(SecOrErr.takeError());
-      outs() << "(?,?) ";
+      OS << "(?,?) ";
       break;
     }
     section_iterator Sec = *SecOrErr;
@@ -432,67 +442,67 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
     StringRef SectionName;
     MachO->getSectionName(Ref, SectionName);
     StringRef SegmentName = MachO->getSectionFinalSegmentName(Ref);
-    outs() << "(" << SegmentName << "," << SectionName << ") ";
+    OS << "(" << SegmentName << "," << SectionName << ") ";
     break;
   }
   default:
-    outs() << "(?) ";
+    OS << "(?) ";
     break;
   }
 
   if (NType & MachO::N_EXT) {
     if (NDesc & MachO::REFERENCED_DYNAMICALLY)
-      outs() << "[referenced dynamically] ";
+      OS << "[referenced dynamically] ";
     if (NType & MachO::N_PEXT) {
       if ((NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF)
-        outs() << "weak private external ";
+        OS << "weak private external ";
       else
-        outs() << "private external ";
+        OS << "private external ";
     } else {
       if ((NDesc & MachO::N_WEAK_REF) == MachO::N_WEAK_REF ||
           (NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF) {
         if ((NDesc & (MachO::N_WEAK_REF | MachO::N_WEAK_DEF)) ==
             (MachO::N_WEAK_REF | MachO::N_WEAK_DEF))
-          outs() << "weak external automatically hidden ";
+          OS << "weak external automatically hidden ";
         else
-          outs() << "weak external ";
+          OS << "weak external ";
       } else
-        outs() << "external ";
+        OS << "external ";
     }
   } else {
     if (NType & MachO::N_PEXT)
-      outs() << "non-external (was a private external) ";
+      OS << "non-external (was a private external) ";
     else
-      outs() << "non-external ";
+      OS << "non-external ";
   }
 
   if (Filetype == MachO::MH_OBJECT &&
       (NDesc & MachO::N_NO_DEAD_STRIP) == MachO::N_NO_DEAD_STRIP)
-    outs() << "[no dead strip] ";
+    OS << "[no dead strip] ";
 
   if (Filetype == MachO::MH_OBJECT &&
       ((NType & MachO::N_TYPE) != MachO::N_UNDF) &&
       (NDesc & MachO::N_SYMBOL_RESOLVER) == MachO::N_SYMBOL_RESOLVER)
-    outs() << "[symbol resolver] ";
+    OS << "[symbol resolver] ";
 
   if (Filetype == MachO::MH_OBJECT &&
       ((NType & MachO::N_TYPE) != MachO::N_UNDF) &&
       (NDesc & MachO::N_ALT_ENTRY) == MachO::N_ALT_ENTRY)
-    outs() << "[alt entry] ";
+    OS << "[alt entry] ";
 
   if ((NDesc & MachO::N_ARM_THUMB_DEF) == MachO::N_ARM_THUMB_DEF)
-    outs() << "[Thumb] ";
+    OS << "[Thumb] ";
 
   if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-    outs() << I->Name << " (for ";
+    OS << I->Name << " (for ";
     StringRef IndirectName;
     if (!MachO ||
         MachO->getIndirectName(I->Sym.getRawDataRefImpl(), IndirectName))
-      outs() << "?)";
+      OS << "?)";
     else
-      outs() << IndirectName << ")";
+      OS << IndirectName << ")";
   } else
-    outs() << I->Name;
+    OS << I->Name;
 
   if ((Flags & MachO::MH_TWOLEVEL) == MachO::MH_TWOLEVEL &&
       (((NType & MachO::N_TYPE) == MachO::N_UNDF && NValue == 0) ||
@@ -500,21 +510,21 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
     uint32_t LibraryOrdinal = MachO::GET_LIBRARY_ORDINAL(NDesc);
     if (LibraryOrdinal != 0) {
       if (LibraryOrdinal == MachO::EXECUTABLE_ORDINAL)
-        outs() << " (from executable)";
+        OS << " (from executable)";
       else if (LibraryOrdinal == MachO::DYNAMIC_LOOKUP_ORDINAL)
-        outs() << " (dynamically looked up)";
+        OS << " (dynamically looked up)";
       else {
         StringRef LibraryName;
         if (!MachO ||
             MachO->getLibraryShortNameByIndex(LibraryOrdinal - 1, LibraryName))
-          outs() << " (from bad library ordinal " << LibraryOrdinal << ")";
+          OS << " (from bad library ordinal " << LibraryOrdinal << ")";
         else
-          outs() << " (from " << LibraryName << ")";
+          OS << " (from " << LibraryName << ")";
       }
     }
   }
 
-  outs() << "\n";
+  OS << "\n";
 }
 
 // Table that maps Darwin's Mach-O stab constants to strings to allow printing.
@@ -566,7 +576,8 @@ static const char *getDarwinStabString(uint8_t NType) {
 
 // darwinPrintStab() prints the n_sect, n_desc along with a symbolic name of
 // a stab n_type value in a Mach-O file.
-static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I) {
+static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I,
+                            raw_ostream &OS) {
   MachO::nlist_64 STE_64;
   MachO::nlist STE;
   uint8_t NType;
@@ -587,19 +598,22 @@ static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I) {
 
   char Str[18] = "";
   format("%02x", NSect).print(Str, sizeof(Str));
-  outs() << ' ' << Str << ' ';
+  OS << ' ' << Str << ' ';
   format("%04x", NDesc).print(Str, sizeof(Str));
-  outs() << Str << ' ';
+  OS << Str << ' ';
   if (const char *stabString = getDarwinStabString(NType))
     format("%5.5s", stabString).print(Str, sizeof(Str));
   else
     format("   %02x", NType).print(Str, sizeof(Str));
-  outs() << Str;
+  OS << Str;
 }
 
 static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
                                    const std::string &ArchiveName,
-                                   const std::string &ArchitectureName) {
+                                   const std::string &ArchitectureName,
+                                   SymbolListT &SymbolList,
+                                   raw_ostream &OS) {
+  StringRef CurrentFilename = Obj.getFileName();
   if (!NoSort) {
     std::function<bool(const NMSymbol &, const NMSymbol &)> Cmp;
     if (NumericSort)
@@ -616,11 +630,11 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
 
   if (!PrintFileName) {
     if (OutputFormat == posix && MultipleFiles && printName) {
-      outs() << '\n' << CurrentFilename << ":\n";
+      OS << '\n' << CurrentFilename << ":\n";
     } else if (OutputFormat == bsd && MultipleFiles && printName) {
-      outs() << "\n" << CurrentFilename << ":\n";
+      OS << "\n" << CurrentFilename << ":\n";
     } else if (OutputFormat == sysv) {
-      outs() << "\n\nSymbols from " << CurrentFilename << ":\n\n"
+      OS << "\n\nSymbols from " << CurrentFilename << ":\n\n"
              << "Name                  Value   Class        Type"
              << "         Size   Line  Section\n";
     }
@@ -665,18 +679,18 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       continue;
     if (PrintFileName) {
       if (!ArchitectureName.empty())
-        outs() << "(for architecture " << ArchitectureName << "):";
+        OS << "(for architecture " << ArchitectureName << "):";
       if (OutputFormat == posix && !ArchiveName.empty())
-        outs() << ArchiveName << "[" << CurrentFilename << "]: ";
+        OS << ArchiveName << "[" << CurrentFilename << "]: ";
       else {
         if (!ArchiveName.empty())
-          outs() << ArchiveName << ":";
-        outs() << CurrentFilename << ": ";
+          OS << ArchiveName << ":";
+        OS << CurrentFilename << ": ";
       }
     }
     if ((JustSymbolName || (UndefinedOnly && isa<MachOObjectFile>(Obj) &&
                             OutputFormat != darwin)) && OutputFormat != posix) {
-      outs() << I->Name << "\n";
+      OS << I->Name << "\n";
       continue;
     }
 
@@ -710,34 +724,32 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
     MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(&Obj);
     if ((OutputFormat == darwin || FormatMachOasHex) && (MachO || Obj.isIR())) {
       darwinPrintSymbol(Obj, I, SymbolAddrStr, printBlanks, printDashes,
-                        printFormat);
+                        printFormat, OS);
     } else if (OutputFormat == posix) {
-      outs() << I->Name << " " << I->TypeChar << " ";
+      OS << I->Name << " " << I->TypeChar << " ";
       if (MachO)
-        outs() << SymbolAddrStr << " " << "0" /* SymbolSizeStr */ << "\n";
+        OS << SymbolAddrStr << " " << "0" /* SymbolSizeStr */ << "\n";
       else
-        outs() << SymbolAddrStr << " " << SymbolSizeStr << "\n";
+        OS << SymbolAddrStr << " " << SymbolSizeStr << "\n";
     } else if (OutputFormat == bsd || (OutputFormat == darwin && !MachO)) {
       if (PrintAddress)
-        outs() << SymbolAddrStr << ' ';
+        OS << SymbolAddrStr << ' ';
       if (PrintSize) {
-        outs() << SymbolSizeStr;
-        outs() << ' ';
+        OS << SymbolSizeStr;
+        OS << ' ';
       }
-      outs() << I->TypeChar;
+      OS << I->TypeChar;
       if (I->TypeChar == '-' && MachO)
-        darwinPrintStab(MachO, I);
-      outs() << " " << I->Name << "\n";
+        darwinPrintStab(MachO, I, OS);
+      OS << " " << I->Name << "\n";
     } else if (OutputFormat == sysv) {
       std::string PaddedName(I->Name);
       while (PaddedName.length() < 20)
         PaddedName += " ";
-      outs() << PaddedName << "|" << SymbolAddrStr << "|   " << I->TypeChar
+      OS << PaddedName << "|" << SymbolAddrStr << "|   " << I->TypeChar
              << "  |                  |" << SymbolSizeStr << "|     |\n";
     }
   }
-
-  SymbolList.clear();
 }
 
 static char getSymbolNMTypeChar(ELFObjectFileBase &Obj,
@@ -967,20 +979,24 @@ static unsigned getNsectInMachO(MachOObjectFile &Obj, BasicSymbolRef Sym) {
 static void
 dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
                           const std::string &ArchiveName = std::string(),
-                          const std::string &ArchitectureName = std::string()) {
+                          const std::string &ArchitectureName = std::string(),
+                          raw_ostream &OS = outs(),
+                          raw_ostream &ErrOS = errs()) {
   auto Symbols = Obj.symbols();
   if (DynamicSyms) {
     const auto *E = dyn_cast<ELFObjectFileBase>(&Obj);
     if (!E) {
-      error("File format has no dynamic symbol table", Obj.getFileName());
+      error("File format has no dynamic symbol table", Obj.getFileName(),
+            ErrOS);
       return;
     }
     auto DynSymbols = E->getDynamicSymbolIterators();
     Symbols =
         make_range<basic_symbol_iterator>(DynSymbols.begin(), DynSymbols.end());
   }
+  SymbolListT SymbolList;
   std::string NameBuffer;
-  raw_string_ostream OS(NameBuffer);
+  raw_string_ostream NameOS(NameBuffer);
   // If a "-s segname sectname" option was specified and this is a Mach-O
   // file get the section number for that section in this object file.
   unsigned int Nsect = 0;
@@ -1024,25 +1040,25 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
       S.Address = *AddressOrErr;
     }
     S.TypeChar = getNMTypeChar(Obj, Sym);
-    std::error_code EC = Sym.printName(OS);
+    std::error_code EC = Sym.printName(NameOS);
     if (EC && MachO)
-      OS << "bad string index";
+      NameOS << "bad string index";
     else
-      error(EC);
-    OS << '\0';
+      error(EC, Twine(), ErrOS);
+    NameOS << '\0';
     S.Sym = Sym;
     SymbolList.push_back(S);
   }
 
-  OS.flush();
+  NameOS.flush();
   const char *P = NameBuffer.c_str();
   for (unsigned I = 0; I < SymbolList.size(); ++I) {
     SymbolList[I].Name = P;
     P += strlen(P) + 1;
   }
 
-  CurrentFilename = Obj.getFileName();
-  sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName);
+  sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName,
+                         SymbolList, OS);
 }
 
 // checkMachOAndArchFlags() checks to see if the SymbolicFile is a Mach-O file
@@ -1050,7 +1066,8 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
 // check to make sure this Mach-O file is one of those architectures or all
 // architectures was specificed.  If not then an error is generated and this
 // routine returns false.  Else it returns true.
-static bool checkMachOAndArchFlags(SymbolicFile *O, std::string &Filename) {
+static bool checkMachOAndArchFlags(SymbolicFile *O, std::string &Filename,
+                                   raw_ostream &ErrOS = errs()) {
   MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(O);
 
   if (!MachO || ArchAll || ArchFlags.size() == 0)
@@ -1069,12 +1086,84 @@ static bool checkMachOAndArchFlags(SymbolicFile *O, std::string &Filename) {
   if (none_of(ArchFlags, [&](const std::string &Name) {
         return Name == T.getArchName();
       })) {
-    error("No architecture specified", Filename);
+    error("No architecture specified", Filename, ErrOS);
     return false;
   }
   return true;
 }
 
+/// Print the symbols of archive member \p C of \p Filename to \p OS, and
+/// errors to \p ErrOS. Returns false if the member is a Mach-O file for an
+/// architecture that was not requested, in which case no further members
+/// should be dumped.
+static bool dumpArchiveMember(const Archive::Child &C, std::string &Filename,
+                              LLVMContext *Context, raw_ostream &OS,
+                              raw_ostream &ErrOS) {
+  Expected<std::unique_ptr<Binary>> ChildOrErr = C.getAsBinary(Context);
+  if (!ChildOrErr) {
+    if (auto E = isNotObjectErrorInvalidFileType(ChildOrErr.takeError()))
+      error(std::move(E), Filename, C, StringRef(), ErrOS);
+    return true;
+  }
+  if (SymbolicFile *O = dyn_cast<SymbolicFile>(&*ChildOrErr.get())) {
+    if (!checkMachOAndArchFlags(O, Filename, ErrOS))
+      return false;
+    if (!PrintFileName) {
+      OS << "\n";
+      if (isa<MachOObjectFile>(O)) {
+        OS << Filename << "(" << O->getFileName() << ")";
+      } else
+        OS << O->getFileName();
+      OS << ":\n";
+    }
+    dumpSymbolNamesFromObject(*O, false, Filename, std::string(), OS, ErrOS);
+  }
+  return true;
+}
+
+/// Dump the members of \p A on a thread pool. Each member is read with its
+/// own LLVMContext and its output is buffered, then printed in member order
+/// as soon as it and all the members before it are done, so the output is
+/// the same as with a single thread. Returns false if a member stopped the
+/// dump.
+static bool dumpArchiveMembersInParallel(const Archive &A,
+                                         std::string &Filename, Error &Err) {
+  struct MemberOutput {
+    std::string Out;
+    std::string Err;
+    bool Continue = true;
+  };
+
+  std::vector<Archive::Child> Members;
+  for (auto &C : A.children(Err))
+    Members.push_back(C);
+
+  std::vector<MemberOutput> Outputs(Members.size());
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Futures;
+  Futures.reserve(Members.size());
+  ThreadPool Pool(Threads ? Threads : heavyweight_hardware_concurrency());
+  for (size_t I = 0, E = Members.size(); I != E; ++I) {
+    Futures.push_back(Pool.async([&, I] {
+      LLVMContext Context;
+      raw_string_ostream OS(Outputs[I].Out), ErrOS(Outputs[I].Err);
+      Outputs[I].Continue =
+          dumpArchiveMember(Members[I], Filename, &Context, OS, ErrOS);
+    }));
+  }
+
+  for (size_t I = 0, E = Members.size(); I != E; ++I) {
+    Futures[I].wait();
+    errs() << Outputs[I].Err;
+    outs() << Outputs[I].Out;
+    // Release the buffers as we go; archives can have many members.
+    std::string().swap(Outputs[I].Out);
+    std::string().swap(Outputs[I].Err);
+    if (!Outputs[I].Continue)
+      return false;
+  }
+  return true;
+}
+
 static void dumpSymbolNamesFromFile(std::string &Filename) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
       MemoryBuffer::getFileOrSTDIN(Filename);
@@ -1114,27 +1203,12 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
 
     {
       Error Err;
-      for (auto &C : A->children(Err)) {
-        Expected<std::unique_ptr<Binary>> ChildOrErr = C.getAsBinary(&Context);
-        if (!ChildOrErr) {
-          if (auto E = isNotObjectErrorInvalidFileType(ChildOrErr.takeError()))
-            error(std::move(E), Filename, C);
-          continue;
-        }
-        if (SymbolicFile *O = dyn_cast<SymbolicFile>(&*ChildOrErr.get())) {
-          if (!checkMachOAndArchFlags(O, Filename))
+      if (Threads == 1) {
+        for (auto &C : A->children(Err))
+          if (!dumpArchiveMember(C, Filename, &Context, outs(), errs()))
             return;
-          if (!PrintFileName) {
-            outs() << "\n";
-            if (isa<MachOObjectFile>(O)) {
-              outs() << Filename << "(" << O->getFileName() << ")";
-            } else
-              outs() << O->getFileName();
-            outs() << ":\n";
-          }
-          dumpSymbolNamesFromObject(*O, false, Filename);
-        }
-      }
+      } else if (!dumpArchiveMembersInParallel(*A, Filename, Err))
+        return;
       if (Err)
         error(std::move(Err), A->getFileName());
     }
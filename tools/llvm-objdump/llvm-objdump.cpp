@@ -56,10 +56,14 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <limits>
+#include <mutex>
 #include <system_error>
 #include <utility>
 #include <unordered_map>
@@ -211,6 +215,11 @@ cl::opt<unsigned long long>
 cl::opt<unsigned long long>
     StopAddress("stop-address", cl::desc("Stop disassembly at address"),
                 cl::value_desc("address"), cl::init(UINT64_MAX));
+static cl::opt<unsigned> DisassembleThreads(
+    "disassemble-threads",
+    cl::desc("Number of threads to disassemble with (0 = one per hardware "
+             "thread)"),
+    cl::init(1));
 static StringRef ToolName;
 
 namespace {
@@ -1066,6 +1075,374 @@ static uint8_t getElfSymbolType(const ObjectFile *Obj, const SymbolRef &Sym) {
   llvm_unreachable("Unsupported binary format");
 }
 
+namespace {
+typedef std::vector<std::tuple<uint64_t, StringRef, uint8_t>> SectionSymbolsTy;
+
+/// The parts of the state of DisassembleObject that are needed to disassemble
+/// the symbols of one section. They are only read while disassembling, so the
+/// symbols of a section can be disassembled on several threads at once.
+struct SectionDisassembly {
+  const ObjectFile *Obj;
+  SectionRef Section;
+  uint64_t SectionAddr;
+  uint64_t SectSize;
+  ArrayRef<uint8_t> Bytes;
+  const SectionSymbolsTy &Symbols;
+  const std::map<SectionRef, SectionSymbolsTy> &AllSymbols;
+  const std::vector<std::pair<uint64_t, SectionRef>> &SectionAddresses;
+  const std::vector<uint64_t> &DataMappingSymsAddr;
+  const std::vector<uint64_t> &TextMappingSymsAddr;
+  const MCSubtargetInfo &STI;
+  const MCInstrAnalysis *MIA;
+  PrettyPrinter &PIP;
+  SourcePrinter *SP;
+  StringRef Fmt;
+};
+
+/// A disassembler and instruction printer for one worker thread. Neither is
+/// safe to share between threads.
+struct ThreadDisassembler {
+  MCObjectFileInfo MOFI;
+  MCContext Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+
+  ThreadDisassembler(const Target *TheTarget, const MCAsmInfo *AsmInfo,
+                     const MCRegisterInfo *MRI, const MCSubtargetInfo &STI,
+                     const MCInstrInfo &MII)
+      : Ctx(AsmInfo, MRI, &MOFI) {
+    MOFI.InitMCObjectFileInfo(Triple(TripleName), false, CodeModel::Default,
+                              Ctx);
+    DisAsm.reset(TheTarget->createMCDisassembler(STI, Ctx));
+    IP.reset(TheTarget->createMCInstPrinter(Triple(TripleName),
+                                            AsmInfo->getAssemblerDialect(),
+                                            *AsmInfo, MII, *MRI));
+    IP->setPrintImmHex(PrintImmHex);
+  }
+};
+}
+
+typedef std::vector<RelocationRef>::const_iterator RelocIterator;
+
+// Print the relocations from rel_cur on that lie before the section offset
+// Limit, skipping hidden ones, and advance rel_cur past them.
+static std::error_code printInlineRelocations(const SectionDisassembly &SD,
+                                              RelocIterator &rel_cur,
+                                              RelocIterator rel_end,
+                                              uint64_t Limit,
+                                              raw_ostream &OS) {
+  while (rel_cur != rel_end) {
+    bool hidden = getHidden(*rel_cur);
+    uint64_t addr = rel_cur->getOffset();
+    SmallString<16> name;
+    SmallString<32> val;
+
+    // If this relocation is hidden, skip it.
+    if (hidden || ((SD.SectionAddr + addr) < StartAddress)) {
+      ++rel_cur;
+      continue;
+    }
+
+    // Stop when rel_cur's address is past the current instruction.
+    if (addr >= Limit) break;
+    rel_cur->getTypeName(name);
+    if (std::error_code EC = getRelocationValueString(*rel_cur, val))
+      return EC;
+    OS << format(SD.Fmt.data(), SD.SectionAddr + addr) << name
+           << "\t" << val << "\n";
+    ++rel_cur;
+  }
+  return std::error_code();
+}
+
+// Disassemble the symbols [SymBegin, SymEnd) of a section to OS. Relocations
+// from [rel_cur, rel_end) are printed after the instructions they apply to.
+// Relocations that no instruction reaches, e.g. those in data at the end of
+// the last symbol, are left over; if RelLeft is given it is set to the first
+// of them. If FirstInstEnd is given it is set to the output position right
+// after the first instruction, where the serial output would print the
+// leftovers of the symbols before SymBegin, or to std::string::npos.
+// This may run on a worker thread, so errors are returned rather than
+// reported; the output stops at the first one.
+static std::error_code
+disassembleSymbols(const SectionDisassembly &SD, MCDisassembler &DisAsm,
+                   MCInstPrinter &IP, unsigned SymBegin, unsigned SymEnd,
+                   RelocIterator rel_cur, RelocIterator rel_end,
+                   raw_ostream &OS, RelocIterator *RelLeft = nullptr,
+                   size_t *FirstInstEnd = nullptr) {
+  const ObjectFile *Obj = SD.Obj;
+  const SectionRef &Section = SD.Section;
+  uint64_t SectionAddr = SD.SectionAddr;
+  uint64_t SectSize = SD.SectSize;
+  ArrayRef<uint8_t> Bytes = SD.Bytes;
+  const SectionSymbolsTy &Symbols = SD.Symbols;
+  const auto &AllSymbols = SD.AllSymbols;
+  const auto &SectionAddresses = SD.SectionAddresses;
+  const std::vector<uint64_t> &DataMappingSymsAddr = SD.DataMappingSymsAddr;
+  const std::vector<uint64_t> &TextMappingSymsAddr = SD.TextMappingSymsAddr;
+  const MCSubtargetInfo &STI = SD.STI;
+  const MCInstrAnalysis *MIA = SD.MIA;
+  PrettyPrinter &PIP = SD.PIP;
+  SourcePrinter *SP = SD.SP;
+
+  SmallString<40> Comments;
+  raw_svector_ostream CommentStream(Comments);
+
+  uint64_t Size;
+  uint64_t Index;
+
+  unsigned se = Symbols.size();
+  // Disassemble symbol by symbol.
+  for (unsigned si = SymBegin; si != SymEnd; ++si) {
+    uint64_t Start = std::get<0>(Symbols[si]) - SectionAddr;
+    // The end is either the section end or the beginning of the next
+    // symbol.
+    uint64_t End =
+        (si == se - 1) ? SectSize : std::get<0>(Symbols[si + 1]) - SectionAddr;
+    // Don't try to disassemble beyond the end of section contents.
+    if (End > SectSize)
+      End = SectSize;
+    // If this symbol has the same address as the next symbol, then skip it.
+    if (Start >= End)
+      continue;
+
+    // Check if we need to skip symbol
+    // Skip if the symbol's data is not between StartAddress and StopAddress
+    if (End + SectionAddr < StartAddress ||
+        Start + SectionAddr > StopAddress) {
+      continue;
+    }
+
+    // Stop disassembly at the stop address specified
+    if (End + SectionAddr > StopAddress)
+      End = StopAddress - SectionAddr;
+
+    if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
+      // make size 4 bytes folded
+      End = Start + ((End - Start) & ~0x3ull);
+      if (std::get<2>(Symbols[si]) == ELF::STT_AMDGPU_HSA_KERNEL) {
+        // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
+        Start += 256;
+      }
+      if (si == se - 1 ||
+          std::get<2>(Symbols[si + 1]) == ELF::STT_AMDGPU_HSA_KERNEL) {
+        // cut trailing zeroes at the end of kernel
+        // cut up to 256 bytes
+        const uint64_t EndAlign = 256;
+        const auto Limit = End - (std::min)(EndAlign, End - Start);
+        while (End > Limit &&
+          *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
+          End -= 4;
+      }
+    }
+
+    OS << '\n' << std::get<1>(Symbols[si]) << ":\n";
+
+#ifndef NDEBUG
+    raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+#else
+    raw_ostream &DebugOut = nulls();
+#endif
+
+    for (Index = Start; Index < End; Index += Size) {
+      MCInst Inst;
+
+      if (Index + SectionAddr < StartAddress ||
+          Index + SectionAddr > StopAddress) {
+        // skip byte by byte till StartAddress is reached
+        Size = 1;
+        continue;
+      }
+      // AArch64 ELF binaries can interleave data and text in the
+      // same section. We rely on the markers introduced to
+      // understand what we need to dump. If the data marker is within a
+      // function, it is denoted as a word/short etc
+      if (isArmElf(Obj) && std::get<2>(Symbols[si]) != ELF::STT_OBJECT &&
+          !DisassembleAll) {
+        uint64_t Stride = 0;
+
+        auto DAI = std::lower_bound(DataMappingSymsAddr.begin(),
+                                    DataMappingSymsAddr.end(), Index);
+        if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
+          // Switch to data.
+          while (Index < End) {
+            OS << format("%8" PRIx64 ":", SectionAddr + Index);
+            OS << "\t";
+            if (Index + 4 <= End) {
+              Stride = 4;
+              dumpBytes(Bytes.slice(Index, 4), OS);
+              OS << "\t.word\t";
+              uint32_t Data = 0;
+              if (Obj->isLittleEndian()) {
+                const auto Word =
+                    reinterpret_cast<const support::ulittle32_t *>(
+                        Bytes.data() + Index);
+                Data = *Word;
+              } else {
+                const auto Word = reinterpret_cast<const support::ubig32_t *>(
+                    Bytes.data() + Index);
+                Data = *Word;
+              }
+              OS << "0x" << format("%08" PRIx32, Data);
+            } else if (Index + 2 <= End) {
+              Stride = 2;
+              dumpBytes(Bytes.slice(Index, 2), OS);
+              OS << "\t\t.short\t";
+              uint16_t Data = 0;
+              if (Obj->isLittleEndian()) {
+                const auto Short =
+                    reinterpret_cast<const support::ulittle16_t *>(
+                        Bytes.data() + Index);
+                Data = *Short;
+              } else {
+                const auto Short =
+                    reinterpret_cast<const support::ubig16_t *>(Bytes.data() +
+                                                                Index);
+                Data = *Short;
+              }
+              OS << "0x" << format("%04" PRIx16, Data);
+            } else {
+              Stride = 1;
+              dumpBytes(Bytes.slice(Index, 1), OS);
+              OS << "\t\t.byte\t";
+              OS << "0x" << format("%02" PRIx8, Bytes.slice(Index, 1)[0]);
+            }
+            Index += Stride;
+            OS << "\n";
+            auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
+                                        TextMappingSymsAddr.end(), Index);
+            if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
+              break;
+          }
+        }
+      }
+
+      // If there is a data symbol inside an ELF text section and we are only
+      // disassembling text (applicable all architectures),
+      // we are in a situation where we must print the data and not
+      // disassemble it.
+      if (Obj->isELF() && std::get<2>(Symbols[si]) == ELF::STT_OBJECT &&
+          !DisassembleAll && Section.isText()) {
+        // print out data up to 8 bytes at a time in hex and ascii
+        uint8_t AsciiData[9] = {'\0'};
+        uint8_t Byte;
+        int NumBytes = 0;
+
+        for (Index = Start; Index < End; Index += 1) {
+          if (((SectionAddr + Index) < StartAddress) ||
+              ((SectionAddr + Index) > StopAddress))
+            continue;
+          if (NumBytes == 0) {
+            OS << format("%8" PRIx64 ":", SectionAddr + Index);
+            OS << "\t";
+          }
+          Byte = Bytes.slice(Index)[0];
+          OS << format(" %02x", Byte);
+          AsciiData[NumBytes] = isprint(Byte) ? Byte : '.';
+
+          uint8_t IndentOffset = 0;
+          NumBytes++;
+          if (Index == End - 1 || NumBytes > 8) {
+            // Indent the space for less than 8 bytes data.
+            // 2 spaces for byte and one for space between bytes
+            IndentOffset = 3 * (8 - NumBytes);
+            for (int Excess = 8 - NumBytes; Excess < 8; Excess++)
+              AsciiData[Excess] = '\0';
+            NumBytes = 8;
+          }
+          if (NumBytes == 8) {
+            AsciiData[8] = '\0';
+            OS << std::string(IndentOffset, ' ') << "         ";
+            OS << reinterpret_cast<char *>(AsciiData);
+            OS << '\n';
+            NumBytes = 0;
+          }
+        }
+      }
+      if (Index >= End)
+        break;
+
+      // Disassemble a real instruction or a data when disassemble all is
+      // provided
+      bool Disassembled = DisAsm.getInstruction(Inst, Size, Bytes.slice(Index),
+                                                SectionAddr + Index, DebugOut,
+                                                CommentStream);
+      if (Size == 0)
+        Size = 1;
+
+      PIP.printInst(IP, Disassembled ? &Inst : nullptr,
+                    Bytes.slice(Index, Size), SectionAddr + Index, OS, "",
+                    STI, SP);
+      OS << CommentStream.str();
+      Comments.clear();
+
+      // Try to resolve the target of a call, tail call, etc. to a specific
+      // symbol.
+      if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
+                  MIA->isConditionalBranch(Inst))) {
+        uint64_t Target;
+        if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
+          // In a relocatable object, the target's section must reside in
+          // the same section as the call instruction or it is accessed
+          // through a relocation.
+          //
+          // In a non-relocatable object, the target may be in any section.
+          //
+          // N.B. We don't walk the relocations in the relocatable case yet.
+          auto *TargetSectionSymbols = &Symbols;
+          if (!Obj->isRelocatableObject()) {
+            auto SectionAddress = std::upper_bound(
+                SectionAddresses.begin(), SectionAddresses.end(), Target,
+                [](uint64_t LHS,
+                    const std::pair<uint64_t, SectionRef> &RHS) {
+                  return LHS < RHS.first;
+                });
+            TargetSectionSymbols = nullptr;
+            if (SectionAddress != SectionAddresses.begin()) {
+              --SectionAddress;
+              auto I = AllSymbols.find(SectionAddress->second);
+              if (I != AllSymbols.end())
+                TargetSectionSymbols = &I->second;
+            }
+          }
+
+          // Find the first symbol in the section whose offset is less than
+          // or equal to the target.
+          if (TargetSectionSymbols) {
+            auto TargetSym = std::upper_bound(
+                TargetSectionSymbols->begin(), TargetSectionSymbols->end(),
+                Target, [](uint64_t LHS,
+                           const std::tuple<uint64_t, StringRef, uint8_t> &RHS) {
+                  return LHS < std::get<0>(RHS);
+                });
+            if (TargetSym != TargetSectionSymbols->begin()) {
+              --TargetSym;
+              uint64_t TargetAddress = std::get<0>(*TargetSym);
+              StringRef TargetName = std::get<1>(*TargetSym);
+              OS << " <" << TargetName;
+              uint64_t Disp = Target - TargetAddress;
+              if (Disp)
+                OS << "+0x" << utohexstr(Disp);
+              OS << '>';
+            }
+          }
+        }
+      }
+      OS << "\n";
+      if (FirstInstEnd && *FirstInstEnd == std::string::npos)
+        *FirstInstEnd = OS.tell();
+
+      // Print relocation for instruction.
+      if (std::error_code EC =
+              printInlineRelocations(SD, rel_cur, rel_end, Index + Size, OS))
+        return EC;
+    }
+  }
+  if (RelLeft)
+    *RelLeft = rel_cur;
+  return std::error_code();
+}
+
 static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   if (StartAddress > StopAddress)
     error("Start address should be less than stop address");
@@ -1135,7 +1512,6 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
   // Create a mapping from virtual address to symbol name.  This is used to
   // pretty print the symbols while disassembling.
-  typedef std::vector<std::tuple<uint64_t, StringRef, uint8_t>> SectionSymbolsTy;
   std::map<SectionRef, SectionSymbolsTy> AllSymbols;
   for (const SymbolRef &Symbol : Obj->symbols()) {
     Expected<uint64_t> AddressOrErr = Symbol.getAddress();
@@ -1199,6 +1575,24 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   for (std::pair<const SectionRef, SectionSymbolsTy> &SecSyms : AllSymbols)
     array_pod_sort(SecSyms.second.begin(), SecSyms.second.end());
 
+  // Source printing keeps state from one instruction to the next, the AMDGPU
+  // symbolizer is tied to the shared disassembler, and printing MachO
+  // relocations can abort on malformed input, so those are always
+  // disassembled on this thread.
+  unsigned ThreadCount = DisassembleThreads
+                             ? unsigned(DisassembleThreads)
+                             : heavyweight_hardware_concurrency();
+  std::unique_ptr<ThreadPool> Pool;
+  std::mutex IdleMutex;
+  std::vector<std::unique_ptr<ThreadDisassembler>> IdleDisassemblers;
+  if (ThreadCount > 1 && !PrintSource && !PrintLines && !Obj->isMachO() &&
+      !(Obj->isELF() && Obj->getArch() == Triple::amdgcn)) {
+    Pool = llvm::make_unique<ThreadPool>(ThreadCount);
+    for (unsigned I = 0; I != ThreadCount; ++I)
+      IdleDisassemblers.push_back(llvm::make_unique<ThreadDisassembler>(
+          TheTarget, AsmInfo.get(), MRI.get(), *STI, *MII));
+  }
+
   for (const SectionRef &Section : ToolSectionFilter(*Obj)) {
     if (!DisassembleAll && (!Section.isText() || Section.isVirtual()))
       continue;
@@ -1279,277 +1673,107 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                                                             : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     StringRef BytesStr;
     error(Section.getContents(BytesStr));
     ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
                             BytesStr.size());
 
-    uint64_t Size;
-    uint64_t Index;
-
-    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
-      uint64_t Start = std::get<0>(Symbols[si]) - SectionAddr;
-      // The end is either the section end or the beginning of the next
-      // symbol.
-      uint64_t End =
-          (si == se - 1) ? SectSize : std::get<0>(Symbols[si + 1]) - SectionAddr;
-      // Don't try to disassemble beyond the end of section contents.
-      if (End > SectSize)
-        End = SectSize;
-      // If this symbol has the same address as the next symbol, then skip it.
-      if (Start >= End)
-        continue;
-
-      // Check if we need to skip symbol
-      // Skip if the symbol's data is not between StartAddress and StopAddress
-      if (End + SectionAddr < StartAddress ||
-          Start + SectionAddr > StopAddress) {
-        continue;
-      }
-
-      // Stop disassembly at the stop address specified
-      if (End + SectionAddr > StopAddress)
-        End = StopAddress - SectionAddr;
+    SectionDisassembly SD = {Obj,
+                             Section,
+                             SectionAddr,
+                             SectSize,
+                             Bytes,
+                             Symbols,
+                             AllSymbols,
+                             SectionAddresses,
+                             DataMappingSymsAddr,
+                             TextMappingSymsAddr,
+                             *STI,
+                             MIA.get(),
+                             PIP,
+                             &SP,
+                             Fmt};
+
+    if (!Pool) {
+      error(disassembleSymbols(SD, *DisAsm, *IP, 0, Symbols.size(),
+                               Rels.begin(), Rels.end(), outs()));
+      continue;
+    }
 
-      if (Obj->isELF() && Obj->getArch() == Triple::amdgcn) {
-        // make size 4 bytes folded
-        End = Start + ((End - Start) & ~0x3ull);
-        if (std::get<2>(Symbols[si]) == ELF::STT_AMDGPU_HSA_KERNEL) {
-          // skip amd_kernel_code_t at the begining of kernel symbol (256 bytes)
-          Start += 256;
-        }
-        if (si == se - 1 ||
-            std::get<2>(Symbols[si + 1]) == ELF::STT_AMDGPU_HSA_KERNEL) {
-          // cut trailing zeroes at the end of kernel
-          // cut up to 256 bytes
-          const uint64_t EndAlign = 256;
-          const auto Limit = End - (std::min)(EndAlign, End - Start);
-          while (End > Limit &&
-            *reinterpret_cast<const support::ulittle32_t*>(&Bytes[End - 4]) == 0)
-            End -= 4;
+    // Split the symbols into chunks of roughly equal size and disassemble
+    // them concurrently, each into its own buffer. A chunk prints the
+    // relocations inside its own address range. The buffers are written out
+    // in order as soon as they are complete. Relocations a chunk leaves over
+    // are printed after the first instruction of the next chunk that has
+    // one, where the serial output has them.
+    uint64_t ChunkSize = SectSize / (ThreadCount * 4) + 1;
+    std::vector<unsigned> ChunkBegins;
+    for (unsigned si = 0, se = Symbols.size(); si != se; ++si)
+      if (ChunkBegins.empty() ||
+          std::get<0>(Symbols[si]) - std::get<0>(Symbols[ChunkBegins.back()]) >=
+              ChunkSize)
+        ChunkBegins.push_back(si);
+    ChunkBegins.push_back(Symbols.size());
+
+    std::vector<RelocIterator> ChunkRels;
+    ChunkRels.push_back(Rels.begin());
+    for (unsigned I = 1, E = ChunkBegins.size() - 1; I != E; ++I) {
+      uint64_t ChunkStart = std::get<0>(Symbols[ChunkBegins[I]]) - SectionAddr;
+      ChunkRels.push_back(std::lower_bound(
+          ChunkRels.back(), Rels.cend(), ChunkStart,
+          [](const RelocationRef &R, uint64_t Offset) {
+            return R.getOffset() < Offset;
+          }));
+    }
+    ChunkRels.push_back(Rels.end());
+
+    unsigned NumChunks = ChunkBegins.size() - 1;
+    std::vector<std::string> Buffers(NumChunks);
+    std::vector<std::error_code> Errors(NumChunks);
+    std::vector<RelocIterator> RelLeft(NumChunks);
+    std::vector<size_t> FirstInstEnd(NumChunks, std::string::npos);
+    std::vector<std::shared_future<ThreadPool::VoidTy>> Done;
+    for (unsigned I = 0; I != NumChunks; ++I)
+      Done.push_back(Pool->async([&, I] {
+        std::unique_ptr<ThreadDisassembler> TD;
+        {
+          std::lock_guard<std::mutex> Lock(IdleMutex);
+          TD = std::move(IdleDisassemblers.back());
+          IdleDisassemblers.pop_back();
         }
+        raw_string_ostream OS(Buffers[I]);
+        Errors[I] = disassembleSymbols(SD, *TD->DisAsm, *TD->IP, ChunkBegins[I],
+                                       ChunkBegins[I + 1], ChunkRels[I],
+                                       ChunkRels[I + 1], OS, &RelLeft[I],
+                                       &FirstInstEnd[I]);
+        OS.flush();
+        std::lock_guard<std::mutex> Lock(IdleMutex);
+        IdleDisassemblers.push_back(std::move(TD));
+      }));
+    // Errors are reported here, after the output that precedes them, as
+    // the serial path would. The other chunks are finished first so that no
+    // worker is still running when error() exits.
+    RelocIterator Leftover = Rels.begin();
+    for (unsigned I = 0; I != NumChunks; ++I) {
+      Done[I].wait();
+      std::error_code EC;
+      if (FirstInstEnd[I] == std::string::npos) {
+        outs() << Buffers[I];
+      } else {
+        StringRef Buffer = Buffers[I];
+        outs() << Buffer.substr(0, FirstInstEnd[I]);
+        EC = printInlineRelocations(SD, Leftover, ChunkRels[I],
+                                    std::numeric_limits<uint64_t>::max(),
+                                    outs());
+        outs() << Buffer.substr(FirstInstEnd[I]);
+        Leftover = RelLeft[I];
       }
-
-      outs() << '\n' << std::get<1>(Symbols[si]) << ":\n";
-
-#ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
-#else
-      raw_ostream &DebugOut = nulls();
-#endif
-
-      for (Index = Start; Index < End; Index += Size) {
-        MCInst Inst;
-
-        if (Index + SectionAddr < StartAddress ||
-            Index + SectionAddr > StopAddress) {
-          // skip byte by byte till StartAddress is reached
-          Size = 1;
-          continue;
-        }
-        // AArch64 ELF binaries can interleave data and text in the
-        // same section. We rely on the markers introduced to
-        // understand what we need to dump. If the data marker is within a
-        // function, it is denoted as a word/short etc
-        if (isArmElf(Obj) && std::get<2>(Symbols[si]) != ELF::STT_OBJECT &&
-            !DisassembleAll) {
-          uint64_t Stride = 0;
-
-          auto DAI = std::lower_bound(DataMappingSymsAddr.begin(),
-                                      DataMappingSymsAddr.end(), Index);
-          if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
-            // Switch to data.
-            while (Index < End) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
-              if (Index + 4 <= End) {
-                Stride = 4;
-                dumpBytes(Bytes.slice(Index, 4), outs());
-                outs() << "\t.word\t";
-                uint32_t Data = 0;
-                if (Obj->isLittleEndian()) {
-                  const auto Word =
-                      reinterpret_cast<const support::ulittle32_t *>(
-                          Bytes.data() + Index);
-                  Data = *Word;
-                } else {
-                  const auto Word = reinterpret_cast<const support::ubig32_t *>(
-                      Bytes.data() + Index);
-                  Data = *Word;
-                }
-                outs() << "0x" << format("%08" PRIx32, Data);
-              } else if (Index + 2 <= End) {
-                Stride = 2;
-                dumpBytes(Bytes.slice(Index, 2), outs());
-                outs() << "\t\t.short\t";
-                uint16_t Data = 0;
-                if (Obj->isLittleEndian()) {
-                  const auto Short =
-                      reinterpret_cast<const support::ulittle16_t *>(
-                          Bytes.data() + Index);
-                  Data = *Short;
-                } else {
-                  const auto Short =
-                      reinterpret_cast<const support::ubig16_t *>(Bytes.data() +
-                                                                  Index);
-                  Data = *Short;
-                }
-                outs() << "0x" << format("%04" PRIx16, Data);
-              } else {
-                Stride = 1;
-                dumpBytes(Bytes.slice(Index, 1), outs());
-                outs() << "\t\t.byte\t";
-                outs() << "0x" << format("%02" PRIx8, Bytes.slice(Index, 1)[0]);
-              }
-              Index += Stride;
-              outs() << "\n";
-              auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
-                                          TextMappingSymsAddr.end(), Index);
-              if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
-                break;
-            }
-          }
-        }
-
-        // If there is a data symbol inside an ELF text section and we are only
-        // disassembling text (applicable all architectures),
-        // we are in a situation where we must print the data and not
-        // disassemble it.
-        if (Obj->isELF() && std::get<2>(Symbols[si]) == ELF::STT_OBJECT &&
-            !DisassembleAll && Section.isText()) {
-          // print out data up to 8 bytes at a time in hex and ascii
-          uint8_t AsciiData[9] = {'\0'};
-          uint8_t Byte;
-          int NumBytes = 0;
-
-          for (Index = Start; Index < End; Index += 1) {
-            if (((SectionAddr + Index) < StartAddress) ||
-                ((SectionAddr + Index) > StopAddress))
-              continue;
-            if (NumBytes == 0) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
-            }
-            Byte = Bytes.slice(Index)[0];
-            outs() << format(" %02x", Byte);
-            AsciiData[NumBytes] = isprint(Byte) ? Byte : '.';
-
-            uint8_t IndentOffset = 0;
-            NumBytes++;
-            if (Index == End - 1 || NumBytes > 8) {
-              // Indent the space for less than 8 bytes data.
-              // 2 spaces for byte and one for space between bytes
-              IndentOffset = 3 * (8 - NumBytes);
-              for (int Excess = 8 - NumBytes; Excess < 8; Excess++)
-                AsciiData[Excess] = '\0';
-              NumBytes = 8;
-            }
-            if (NumBytes == 8) {
-              AsciiData[8] = '\0';
-              outs() << std::string(IndentOffset, ' ') << "         ";
-              outs() << reinterpret_cast<char *>(AsciiData);
-              outs() << '\n';
-              NumBytes = 0;
-            }
-          }
-        }
-        if (Index >= End)
-          break;
-
-        // Disassemble a real instruction or a data when disassemble all is
-        // provided
-        bool Disassembled = DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
-                                                   SectionAddr + Index, DebugOut,
-                                                   CommentStream);
-        if (Size == 0)
-          Size = 1;
-
-        PIP.printInst(*IP, Disassembled ? &Inst : nullptr,
-                      Bytes.slice(Index, Size), SectionAddr + Index, outs(), "",
-                      *STI, &SP);
-        outs() << CommentStream.str();
-        Comments.clear();
-
-        // Try to resolve the target of a call, tail call, etc. to a specific
-        // symbol.
-        if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
-                    MIA->isConditionalBranch(Inst))) {
-          uint64_t Target;
-          if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
-            // In a relocatable object, the target's section must reside in
-            // the same section as the call instruction or it is accessed
-            // through a relocation.
-            //
-            // In a non-relocatable object, the target may be in any section.
-            //
-            // N.B. We don't walk the relocations in the relocatable case yet.
-            auto *TargetSectionSymbols = &Symbols;
-            if (!Obj->isRelocatableObject()) {
-              auto SectionAddress = std::upper_bound(
-                  SectionAddresses.begin(), SectionAddresses.end(), Target,
-                  [](uint64_t LHS,
-                      const std::pair<uint64_t, SectionRef> &RHS) {
-                    return LHS < RHS.first;
-                  });
-              if (SectionAddress != SectionAddresses.begin()) {
-                --SectionAddress;
-                TargetSectionSymbols = &AllSymbols[SectionAddress->second];
-              } else {
-                TargetSectionSymbols = nullptr;
-              }
-            }
-
-            // Find the first symbol in the section whose offset is less than
-            // or equal to the target.
-            if (TargetSectionSymbols) {
-              auto TargetSym = std::upper_bound(
-                  TargetSectionSymbols->begin(), TargetSectionSymbols->end(),
-                  Target, [](uint64_t LHS,
-                             const std::tuple<uint64_t, StringRef, uint8_t> &RHS) {
-                    return LHS < std::get<0>(RHS);
-                  });
-              if (TargetSym != TargetSectionSymbols->begin()) {
-                --TargetSym;
-                uint64_t TargetAddress = std::get<0>(*TargetSym);
-                StringRef TargetName = std::get<1>(*TargetSym);
-                outs() << " <" << TargetName;
-                uint64_t Disp = Target - TargetAddress;
-                if (Disp)
-                  outs() << "+0x" << utohexstr(Disp);
-                outs() << '>';
-              }
-            }
-          }
-        }
-        outs() << "\n";
-
-        // Print relocation for instruction.
-        while (rel_cur != rel_end) {
-          bool hidden = getHidden(*rel_cur);
-          uint64_t addr = rel_cur->getOffset();
-          SmallString<16> name;
-          SmallString<32> val;
-
-          // If this relocation is hidden, skip it.
-          if (hidden || ((SectionAddr + addr) < StartAddress)) {
-            ++rel_cur;
-            continue;
-          }
-
-          // Stop when rel_cur's address is past the current instruction.
-          if (addr >= Index + Size) break;
-          rel_cur->getTypeName(name);
-          error(getRelocationValueString(*rel_cur, val));
-          outs() << format(Fmt.data(), SectionAddr + addr) << name
-                 << "\t" << val << "\n";
-          ++rel_cur;
-        }
+      std::string().swap(Buffers[I]);
+      if (!EC)
+        EC = Errors[I];
+      if (EC) {
+        Pool->wait();
+        error(EC);
       }
     }
   }
@@ -8,14 +8,15 @@
 //===----------------------------------------------------------------------===//
 ///
 /// \file
-/// \brief This file implements a tool that can parse the YAML optimization
-/// records and generate an optimization summary annotated source listing
-/// report.
+/// \brief This file implements a tool that can parse the YAML or binary
+/// optimization records and generate an optimization summary annotated source
+/// listing report.
 ///
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Demangle/Demangle.h"
+#include "llvm/Support/BinaryRemarks.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
@@ -27,6 +28,8 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/YAMLTraits.h"
 #include <cstdlib>
 #include <map>
@@ -42,9 +45,9 @@ static cl::opt<bool> Help("h", cl::desc("Alias for -help"), cl::Hidden);
 static cl::OptionCategory
     OptReportCategory("llvm-opt-report options");
 
-static cl::opt<std::string>
-  InputFileName(cl::Positional, cl::desc("<input>"), cl::init("-"),
-                cl::cat(OptReportCategory));
+static cl::list<std::string>
+  InputFileNames(cl::Positional, cl::desc("<input>..."), cl::ZeroOrMore,
+                 cl::cat(OptReportCategory));
 
 static cl::opt<std::string>
   OutputFileName("o", cl::desc("Output file"), cl::init("-"),
@@ -62,6 +65,11 @@ static cl::opt<bool>
   NoDemangle("no-demangle", cl::desc("Don't demangle function names"),
              cl::init(false), cl::cat(OptReportCategory));
 
+static cl::opt<unsigned>
+  NumThreads("j", cl::desc("Number of input files to read in parallel "
+                           "(0 = number of cores)"),
+             cl::init(0), cl::cat(OptReportCategory));
+
 namespace {
 // For each location in the source file, the common per-transformation state
 // collected.
@@ -142,6 +150,37 @@ typedef std::map<std::string, std::map<int, std::map<std::string, std::map<int,
           OptReportLocationInfo>>>> LocationInfoTy;
 } // anonymous namespace
 
+static void addRemark(LocationInfoTy &LocationInfo, bool Transformed,
+                      StringRef Pass, StringRef File, StringRef Function,
+                      int Line, int Column, int VectorizationFactor,
+                      int InterleaveCount, int UnrollCount) {
+  if (Line < 1 || File.empty())
+    return;
+
+  // We track information on both actual and potential transformations. This
+  // way, if there are multiple possible things on a line that are, or could
+  // have been transformed, we can indicate that explicitly in the output.
+  auto UpdateLLII = [Transformed](OptReportLocationItemInfo &LLII) {
+    LLII.Analyzed = true;
+    if (Transformed)
+      LLII.Transformed = true;
+  };
+
+  if (Pass == "inline") {
+    auto &LI = LocationInfo[File][Line][Function][Column];
+    UpdateLLII(LI.Inlined);
+  } else if (Pass == "loop-unroll") {
+    auto &LI = LocationInfo[File][Line][Function][Column];
+    LI.UnrollCount = UnrollCount;
+    UpdateLLII(LI.Unrolled);
+  } else if (Pass == "loop-vectorize") {
+    auto &LI = LocationInfo[File][Line][Function][Column];
+    LI.VectorizationFactor = VectorizationFactor;
+    LI.InterleaveCount = InterleaveCount;
+    UpdateLLII(LI.Vectorized);
+  }
+}
+
 static void collectLocationInfo(yaml::Stream &Stream,
                                 LocationInfoTy &LocationInfo) {
   SmallVector<char, 8> Tmp;
@@ -242,43 +281,57 @@ static void collectLocationInfo(yaml::Stream &Stream,
       }
     }
 
-    if (Line < 1 || File.empty())
-      continue;
+    addRemark(LocationInfo, Transformed, Pass, File, Function, Line, Column,
+              VectorizationFactor, InterleaveCount, UnrollCount);
+  }
+}
 
-    // We track information on both actual and potential transformations. This
-    // way, if there are multiple possible things on a line that are, or could
-    // have been transformed, we can indicate that explicitly in the output.
-    auto UpdateLLII = [Transformed](OptReportLocationItemInfo &LLII) {
-      LLII.Analyzed = true;
-      if (Transformed)
-        LLII.Transformed = true;
-    };
-
-    if (Pass == "inline") {
-      auto &LI = LocationInfo[File][Line][Function][Column];
-      UpdateLLII(LI.Inlined);
-    } else if (Pass == "loop-unroll") {
-      auto &LI = LocationInfo[File][Line][Function][Column];
-      LI.UnrollCount = UnrollCount;
-      UpdateLLII(LI.Unrolled);
-    } else if (Pass == "loop-vectorize") {
-      auto &LI = LocationInfo[File][Line][Function][Column];
-      LI.VectorizationFactor = VectorizationFactor;
-      LI.InterleaveCount = InterleaveCount;
-      UpdateLLII(LI.Vectorized);
+static bool collectBinaryLocationInfo(StringRef FileName, StringRef Buffer,
+                                      LocationInfoTy &LocationInfo) {
+  remarks::BinaryRemarkReader Reader(Buffer);
+  remarks::Remark R;
+  while (true) {
+    Expected<bool> More = Reader.next(R);
+    if (!More) {
+      logAllUnhandledErrors(More.takeError(), errs(),
+                            "error: " + FileName + ": ");
+      return false;
+    }
+    if (!*More)
+      return true;
+
+    int VectorizationFactor = 1;
+    int InterleaveCount = 1;
+    int UnrollCount = 1;
+    for (const remarks::Argument &Arg : R.Args) {
+      if (Arg.Key == "VectorizationFactor")
+        Arg.Val.getAsInteger(10, VectorizationFactor);
+      else if (Arg.Key == "InterleaveCount")
+        Arg.Val.getAsInteger(10, InterleaveCount);
+      else if (Arg.Key == "UnrollCount")
+        Arg.Val.getAsInteger(10, UnrollCount);
     }
+
+    addRemark(LocationInfo, R.Kind == remarks::RemarkKind::Passed, R.PassName,
+              R.File, R.FunctionName, R.Line, R.Column, VectorizationFactor,
+              InterleaveCount, UnrollCount);
   }
 }
 
-static bool readLocationInfo(LocationInfoTy &LocationInfo) {
+static bool readLocationInfo(StringRef FileName,
+                             LocationInfoTy &LocationInfo) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
-      MemoryBuffer::getFileOrSTDIN(InputFileName);
+      MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = Buf.getError()) {
-    errs() << "error: Can't open file " << InputFileName << ": " <<
+    errs() << "error: Can't open file " << FileName << ": " <<
               EC.message() << "\n";
     return false;
   }
 
+  if (remarks::isBinaryRemarkFile(Buf.get()->getBuffer()))
+    return collectBinaryLocationInfo(FileName, Buf.get()->getBuffer(),
+                                     LocationInfo);
+
   SourceMgr SM;
   yaml::Stream Stream(Buf.get()->getBuffer(), SM);
   collectLocationInfo(Stream, LocationInfo);
@@ -286,6 +339,53 @@ static bool readLocationInfo(LocationInfoTy &LocationInfo) {
   return true; 
 }
 
+// Adds everything in From to To. Where both have a location, the result is
+// the same as if all the remarks had been read into one LocationInfoTy, except
+// that counts (such as the unroll count) are the largest seen rather than the
+// last one.
+static void mergeLocationInfo(LocationInfoTy &To, LocationInfoTy &From) {
+  if (To.empty()) {
+    To.swap(From);
+    return;
+  }
+  for (auto &FI : From)
+    for (auto &LI : FI.second)
+      for (auto &FuncI : LI.second)
+        for (auto &CI : FuncI.second)
+          To[FI.first][LI.first][FuncI.first][CI.first] |= CI.second;
+  From.clear();
+}
+
+// Reads all the input files, each on its own thread, and merges what they
+// have into LocationInfo.
+static bool readAllLocationInfo(LocationInfoTy &LocationInfo) {
+  std::vector<std::string> FileNames(InputFileNames.begin(),
+                                     InputFileNames.end());
+  if (FileNames.empty())
+    FileNames.push_back("-");
+  if (FileNames.size() == 1)
+    return readLocationInfo(FileNames[0], LocationInfo);
+
+  std::vector<LocationInfoTy> PerFile(FileNames.size());
+  std::vector<char> Succeeded(FileNames.size());
+  {
+    ThreadPool Pool(NumThreads ? NumThreads
+                               : heavyweight_hardware_concurrency());
+    for (size_t I = 0, E = FileNames.size(); I != E; ++I)
+      Pool.async([&, I] {
+        Succeeded[I] = readLocationInfo(FileNames[I], PerFile[I]);
+      });
+    Pool.wait();
+  }
+
+  for (size_t I = 0, E = FileNames.size(); I != E; ++I) {
+    if (!Succeeded[I])
+      return false;
+    mergeLocationInfo(LocationInfo, PerFile[I]);
+  }
+  return true;
+}
+
 static bool writeReport(LocationInfoTy &LocationInfo) {
   std::error_code EC;
   llvm::raw_fd_ostream OS(OutputFileName, EC,
@@ -503,14 +603,14 @@ int main(int argc, const char **argv) {
   cl::HideUnrelatedOptions(OptReportCategory);
   cl::ParseCommandLineOptions(
       argc, argv,
-      "A tool to generate an optimization report from YAML optimization"
-      " record files.\n");
+      "A tool to generate an optimization report from YAML or binary"
+      " optimization record files.\n");
 
   if (Help)
     cl::PrintHelpMessage();
 
   LocationInfoTy LocationInfo;
-  if (!readLocationInfo(LocationInfo))
+  if (!readAllLocationInfo(LocationInfo))
     return 1;
   if (!writeReport(LocationInfo))
     return 1; 
@@ -114,6 +114,9 @@ Error LLVMOutputStyle::dump() {
   if (auto EC = dumpTpiStream(StreamIPI))
     return EC;
 
+  if (auto EC = dumpTpiTypes())
+    return EC;
+
   if (auto EC = dumpDbiStream())
     return EC;
 
@@ -551,6 +554,31 @@ Error LLVMOutputStyle::dumpTpiStream(uint32_t StreamIdx) {
   return Error::success();
 }
 
+Error LLVMOutputStyle::dumpTpiTypes() {
+  if (opts::raw::DumpTpiTypes.empty())
+    return Error::success();
+
+  auto Tpi = File.getPDBTpiStream();
+  if (!Tpi)
+    return Tpi.takeError();
+
+  // The records are looked up individually rather than visited in order, so
+  // only their kind and bytes are printed; the type names they refer to are
+  // not known.
+  ListScope L(P, "Type Lookups");
+  for (uint32_t Index : opts::raw::DumpTpiTypes) {
+    auto Type = Tpi->getType(TypeIndex(Index));
+    if (!Type)
+      return Type.takeError();
+    DictScope D(P, "");
+    P.printHex("Index", Index);
+    P.printEnum("Kind", uint16_t(Type->kind()), getTypeLeafNames());
+    P.printBinaryBlock("Bytes", Type->content());
+  }
+  P.flush();
+  return Error::success();
+}
+
 Error LLVMOutputStyle::dumpDbiStream() {
   bool DumpModules = opts::raw::DumpModules || opts::raw::DumpModuleSyms ||
                      opts::raw::DumpModuleFiles || opts::raw::DumpLineInfo;
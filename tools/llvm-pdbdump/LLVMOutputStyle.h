@@ -36,6 +36,7 @@ private:
   Error dumpStreamBlocks();
   Error dumpInfoStream();
   Error dumpTpiStream(uint32_t StreamIdx);
+  Error dumpTpiTypes();
   Error dumpDbiStream();
   Error dumpSectionContribs();
   Error dumpSectionMap();
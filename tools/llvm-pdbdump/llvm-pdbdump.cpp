@@ -196,6 +196,11 @@ cl::opt<bool> DumpTpiRecordBytes(
     cl::cat(TypeOptions), cl::sub(RawSubcommand));
 cl::opt<bool> DumpTpiHash("tpi-hash", cl::desc("dump CodeView TPI hash stream"),
                           cl::cat(TypeOptions), cl::sub(RawSubcommand));
+cl::list<uint32_t>
+    DumpTpiTypes("tpi-types", cl::CommaSeparated, cl::ZeroOrMore,
+                 cl::desc("dump the TPI type records with the specified "
+                          "indices"),
+                 cl::cat(TypeOptions), cl::sub(RawSubcommand));
 cl::opt<bool>
     DumpIpiRecords("ipi-records",
                    cl::desc("dump CodeView type records from IPI stream"),
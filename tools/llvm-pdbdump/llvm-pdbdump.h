@@ -42,6 +42,7 @@ struct BlockRange {
 
 extern llvm::Optional<BlockRange> DumpBlockRange;
 extern llvm::cl::list<uint32_t> DumpStreamData;
+extern llvm::cl::list<uint32_t> DumpTpiTypes;
 
 extern llvm::cl::opt<bool> DumpGlobals;
 extern llvm::cl::opt<bool> DumpHeaders;
@@ -13,6 +13,7 @@
 
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/ProfileData/InstrProfReader.h"
@@ -653,6 +654,163 @@ static int show_main(int argc, const char *argv[]) {
                              ShowFunction, OS);
 }
 
+namespace {
+/// The block counts of one function of a profile.
+struct FuncCounts {
+  uint64_t Hash;
+  std::vector<uint64_t> Counts;
+};
+} // end anonymous namespace
+
+static uint64_t sumCounts(ArrayRef<uint64_t> Counts) {
+  uint64_t Sum = 0;
+  for (uint64_t C : Counts)
+    Sum = SaturatingAdd(Sum, C);
+  return Sum;
+}
+
+/// Returns the overlap of the block count distributions \p Base and \p Test,
+/// each normalized by the given total: 1.0 if they are proportional, 0.0 if
+/// no block is hot in both.
+static double countOverlap(ArrayRef<uint64_t> Base, uint64_t BaseTotal,
+                           ArrayRef<uint64_t> Test, uint64_t TestTotal) {
+  if (!BaseTotal || !TestTotal)
+    return !BaseTotal && !TestTotal ? 1.0 : 0.0;
+  double Overlap = 0.0;
+  for (size_t I = 0, E = std::min(Base.size(), Test.size()); I != E; ++I)
+    Overlap += std::min((double)Base[I] / BaseTotal,
+                        (double)Test[I] / TestTotal);
+  return Overlap;
+}
+
+static std::unique_ptr<InstrProfReader>
+createInstrProfReader(const std::string &Filename) {
+  auto ReaderOrErr = InstrProfReader::create(Filename);
+  if (Error E = ReaderOrErr.takeError())
+    exitWithError(std::move(E), Filename);
+  return std::move(ReaderOrErr.get());
+}
+
+static int overlapInstrProfile(const std::string &BaseFilename,
+                               const std::string &TestFilename,
+                               double SimilarityCutoff,
+                               const std::string &ShowFunction,
+                               raw_fd_ostream &OS) {
+  // Load the block counts of the test profile. The base profile is streamed
+  // twice instead: once for its total count and once for the comparison.
+  StringMap<SmallVector<FuncCounts, 1>> TestFuncs;
+  uint64_t TestTotal = 0;
+  bool TestIsIR;
+  {
+    auto Reader = createInstrProfReader(TestFilename);
+    TestIsIR = Reader->isIRLevelProfile();
+    for (const auto &Func : *Reader) {
+      TestTotal = SaturatingAdd(TestTotal, sumCounts(Func.Counts));
+      TestFuncs[Func.Name].push_back({Func.Hash, Func.Counts});
+    }
+    if (Reader->hasError())
+      exitWithError(Reader->getError(), TestFilename);
+  }
+
+  uint64_t BaseTotal = 0;
+  {
+    auto Reader = createInstrProfReader(BaseFilename);
+    if (Reader->isIRLevelProfile() != TestIsIR)
+      exitWithError("cannot compare front-end and IR level profiles",
+                    BaseFilename);
+    for (const auto &Func : *Reader)
+      BaseTotal = SaturatingAdd(BaseTotal, sumCounts(Func.Counts));
+    if (Reader->hasError())
+      exitWithError(Reader->getError(), BaseFilename);
+  }
+
+  size_t NumBaseFuncs = 0, NumMatched = 0, NumMismatched = 0, NumShown = 0;
+  double ProgramOverlap = 0.0;
+  auto Reader = createInstrProfReader(BaseFilename);
+  for (const auto &Func : *Reader) {
+    ++NumBaseFuncs;
+    const FuncCounts *Match = nullptr;
+    bool NameFound = false;
+    auto It = TestFuncs.find(Func.Name);
+    if (It != TestFuncs.end()) {
+      NameFound = true;
+      for (const FuncCounts &FC : It->second)
+        if (FC.Hash == Func.Hash && FC.Counts.size() == Func.Counts.size()) {
+          Match = &FC;
+          break;
+        }
+    }
+
+    double Similarity = 0.0;
+    if (Match) {
+      ++NumMatched;
+      ProgramOverlap +=
+          countOverlap(Func.Counts, BaseTotal, Match->Counts, TestTotal);
+      Similarity = countOverlap(Func.Counts, sumCounts(Func.Counts),
+                                Match->Counts, sumCounts(Match->Counts));
+    } else if (NameFound)
+      ++NumMismatched;
+
+    bool Show = Similarity < SimilarityCutoff ||
+                (!ShowFunction.empty() &&
+                 Func.Name.find(ShowFunction) != Func.Name.npos);
+    if (!Show)
+      continue;
+    if (!NumShown++)
+      OS << "Functions:\n";
+    OS << "  " << Func.Name << ": ";
+    if (Match)
+      OS << format("%.2f%%", Similarity * 100) << " similar\n";
+    else if (NameFound)
+      OS << "hash mismatch\n";
+    else
+      OS << "not in test profile\n";
+  }
+  if (Reader->hasError())
+    exitWithError(Reader->getError(), BaseFilename);
+
+  size_t NumTestFuncs = 0;
+  for (const auto &Entry : TestFuncs)
+    NumTestFuncs += Entry.second.size();
+
+  OS << "Base profile: " << BaseFilename << "\n"
+     << "Test profile: " << TestFilename << "\n"
+     << "Program similarity: " << format("%.2f%%", ProgramOverlap * 100)
+     << "\n"
+     << "Functions in base profile: " << NumBaseFuncs << "\n"
+     << "Functions in test profile: " << NumTestFuncs << "\n"
+     << "Functions in both profiles: " << NumMatched << "\n"
+     << "Functions with mismatched hash: " << NumMismatched << "\n";
+  return 0;
+}
+
+static int overlap_main(int argc, const char *argv[]) {
+  cl::opt<std::string> BaseFilename(cl::Positional, cl::Required,
+                                    cl::desc("<base profile file>"));
+  cl::opt<std::string> TestFilename(cl::Positional, cl::Required,
+                                    cl::desc("<test profile file>"));
+  cl::opt<double> SimilarityCutoff(
+      "similarity-cutoff", cl::init(0.0),
+      cl::desc("Show the functions whose block counts are less similar than "
+               "this, from 0 to 1"));
+  cl::opt<std::string> ShowFunction("function",
+                                    cl::desc("Details for matching functions"));
+  cl::opt<std::string> OutputFilename("output", cl::value_desc("output"),
+                                      cl::init("-"), cl::desc("Output file"));
+  cl::alias OutputFilenameA("o", cl::desc("Alias for --output"),
+                            cl::aliasopt(OutputFilename));
+
+  cl::ParseCommandLineOptions(argc, argv, "LLVM profile data overlap\n");
+
+  std::error_code EC;
+  raw_fd_ostream OS(OutputFilename.data(), EC, sys::fs::F_Text);
+  if (EC)
+    exitWithErrorCode(EC, OutputFilename);
+
+  return overlapInstrProfile(BaseFilename, TestFilename, SimilarityCutoff,
+                             ShowFunction, OS);
+}
+
 int main(int argc, const char *argv[]) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -667,6 +825,8 @@ int main(int argc, const char *argv[]) {
       func = merge_main;
     else if (strcmp(argv[1], "show") == 0)
       func = show_main;
+    else if (strcmp(argv[1], "overlap") == 0)
+      func = overlap_main;
 
     if (func) {
       std::string Invocation(ProgName.str() + " " + argv[1]);
@@ -681,7 +841,7 @@ int main(int argc, const char *argv[]) {
              << "USAGE: " << ProgName << " <command> [args...]\n"
              << "USAGE: " << ProgName << " <command> -help\n\n"
              << "See each individual command --help for more details.\n"
-             << "Available commands: merge, show\n";
+             << "Available commands: merge, show, overlap\n";
       return 0;
     }
   }
@@ -691,6 +851,6 @@ int main(int argc, const char *argv[]) {
   else
     errs() << ProgName << ": Unknown command!\n";
 
-  errs() << "USAGE: " << ProgName << " <merge|show> [args...]\n";
+  errs() << "USAGE: " << ProgName << " <merge|show|overlap> [args...]\n";
   return 1;
 }
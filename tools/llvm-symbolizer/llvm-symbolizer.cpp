@@ -29,7 +29,9 @@
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
 #include <cstring>
+#include <map>
 #include <string>
+#include <tuple>
 
 using namespace llvm;
 using namespace symbolize;
@@ -85,6 +87,27 @@ static cl::opt<int> ClPrintSourceContextLines(
     "print-source-context-lines", cl::init(0),
     cl::desc("Print N number of source file context"));
 
+static cl::opt<bool>
+    ClBatch("batch", cl::init(false),
+            cl::desc("Read all the input before answering, and symbolize "
+                     "each distinct address once, in module and address "
+                     "order"));
+
+static cl::opt<unsigned>
+    ClDWARFThreads("dwarf-threads", cl::init(1),
+                   cl::desc("Number of threads used to index the compile "
+                            "units of an object file"));
+
+static cl::opt<bool>
+    ClUseSymbolIndex("use-symbol-index", cl::init(true),
+                     cl::desc("Use the symbol index of a binary instead of "
+                              "its debug info when it is up to date"));
+
+static cl::opt<bool>
+    ClBuildSymbolIndex("build-symbol-index", cl::init(false),
+                       cl::desc("Write the symbol index of the binary given "
+                                "by -obj next to it, and exit"));
+
 template<typename T>
 static bool error(Expected<T> &ResOrErr) {
   if (ResOrErr)
@@ -137,6 +160,30 @@ static bool parseCommand(StringRef InputString, bool &IsData,
   return !StringRef(pos, offset_length).getAsInteger(0, ModuleOffset);
 }
 
+static void symbolizeInput(LLVMSymbolizer &Symbolizer, DIPrinter &Printer,
+                           raw_ostream &OS, bool IsData,
+                           const std::string &ModuleName,
+                           uint64_t ModuleOffset) {
+  if (ClPrintAddress) {
+    OS << "0x";
+    OS.write_hex(ModuleOffset);
+    StringRef Delimiter = (ClPrettyPrint == true) ? ": " : "\n";
+    OS << Delimiter;
+  }
+  if (IsData) {
+    auto ResOrErr = Symbolizer.symbolizeData(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr) ? DIGlobal() : ResOrErr.get());
+  } else if (ClPrintInlining) {
+    auto ResOrErr = Symbolizer.symbolizeInlinedCode(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr) ? DIInliningInfo()
+                                           : ResOrErr.get());
+  } else {
+    auto ResOrErr = Symbolizer.symbolizeCode(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get());
+  }
+  OS << "\n";
+}
+
 int main(int argc, char **argv) {
   // Print stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -148,6 +195,8 @@ int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(argc, argv, "llvm-symbolizer\n");
   LLVMSymbolizer::Options Opts(ClPrintFunctions, ClUseSymbolTable, ClDemangle,
                                ClUseRelativeAddress, ClDefaultArch);
+  Opts.DWARFThreads = ClDWARFThreads;
+  Opts.UseSymbolIndex = ClUseSymbolIndex;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -159,12 +208,59 @@ int main(int argc, char **argv) {
   }
   LLVMSymbolizer Symbolizer(Opts);
 
+  if (ClBuildSymbolIndex) {
+    if (ClBinaryName.empty()) {
+      errs() << "-build-symbol-index requires -obj\n";
+      return 1;
+    }
+    if (auto Err = Symbolizer.buildSymbolIndex(ClBinaryName)) {
+      logAllUnhandledErrors(std::move(Err), errs(),
+                            "LLVMSymbolizer: error building symbol index: ");
+      return 1;
+    }
+    return 0;
+  }
+
   DIPrinter Printer(outs(), ClPrintFunctions != FunctionNameKind::None,
                     ClPrettyPrint, ClPrintSourceContextLines);
 
   const int kMaxInputStringLength = 1024;
   char InputString[kMaxInputStringLength];
 
+  if (ClBatch) {
+    // Read all the requests first, then answer them sorted by module and
+    // address so that the debug info of each module is walked in order, and
+    // so that repeated addresses are only symbolized once.
+    typedef std::tuple<std::string, uint64_t, bool> RequestTy;
+    std::vector<std::pair<std::string, const std::string *>> Lines;
+    std::map<RequestTy, std::string> Results;
+    while (fgets(InputString, sizeof(InputString), stdin)) {
+      bool IsData = false;
+      std::string ModuleName;
+      uint64_t ModuleOffset = 0;
+      if (!parseCommand(StringRef(InputString), IsData, ModuleName,
+                        ModuleOffset)) {
+        Lines.emplace_back(InputString, nullptr);
+        continue;
+      }
+      auto It = Results.insert(std::make_pair(
+          std::make_tuple(ModuleName, ModuleOffset, IsData), std::string()));
+      Lines.emplace_back(std::string(), &It.first->second);
+    }
+
+    for (auto &Result : Results) {
+      raw_string_ostream OS(Result.second);
+      DIPrinter ResultPrinter(OS, ClPrintFunctions != FunctionNameKind::None,
+                              ClPrettyPrint, ClPrintSourceContextLines);
+      symbolizeInput(Symbolizer, ResultPrinter, OS, std::get<2>(Result.first),
+                     std::get<0>(Result.first), std::get<1>(Result.first));
+    }
+
+    for (const auto &Line : Lines)
+      outs() << (Line.second ? *Line.second : Line.first);
+    return 0;
+  }
+
   while (true) {
     if (!fgets(InputString, sizeof(InputString), stdin))
       break;
@@ -178,24 +274,8 @@ int main(int argc, char **argv) {
       continue;
     }
 
-    if (ClPrintAddress) {
-      outs() << "0x";
-      outs().write_hex(ModuleOffset);
-      StringRef Delimiter = (ClPrettyPrint == true) ? ": " : "\n";
-      outs() << Delimiter;
-    }
-    if (IsData) {
-      auto ResOrErr = Symbolizer.symbolizeData(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr) ? DIGlobal() : ResOrErr.get());
-    } else if (ClPrintInlining) {
-      auto ResOrErr = Symbolizer.symbolizeInlinedCode(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr) ? DIInliningInfo()
-                                             : ResOrErr.get());
-    } else {
-      auto ResOrErr = Symbolizer.symbolizeCode(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get());
-    }
-    outs() << "\n";
+    symbolizeInput(Symbolizer, Printer, outs(), IsData, ModuleName,
+                   ModuleOffset);
     outs().flush();
   }
 
@@ -22,10 +22,14 @@
 #include "llvm/Analysis/RegionPass.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DebugInfo.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -37,10 +41,13 @@
 #include "llvm/LinkAllIR.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/BinaryRemarks.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/LineIterator.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PluginLoader.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
@@ -48,6 +55,8 @@
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Target/TargetMachine.h"
@@ -57,6 +66,7 @@
 #include "llvm/Transforms/Utils/Cloning.h"
 #include <algorithm>
 #include <memory>
+#include <vector>
 using namespace llvm;
 using namespace opt_tool;
 
@@ -237,6 +247,26 @@ static cl::opt<std::string>
                     cl::desc("YAML output filename for pass remarks"),
                     cl::value_desc("filename"));
 
+enum RemarksFormatTy { RF_YAML, RF_Binary };
+static cl::opt<RemarksFormatTy> RemarksFormat(
+    "pass-remarks-format", cl::desc("Format of the -pass-remarks-output file"),
+    cl::init(RF_YAML),
+    cl::values(clEnumValN(RF_YAML, "yaml", "YAML documents (default)"),
+               clEnumValN(RF_Binary, "binary",
+                          "Binary remarks with interned strings")));
+
+static cl::opt<std::string> BatchFilename(
+    "batch",
+    cl::desc("Optimize the modules listed in <filename>, one input and output "
+             "file per line, instead of a single input"),
+    cl::value_desc("filename"));
+
+static cl::opt<unsigned> BatchThreads(
+    "batch-threads",
+    cl::desc("Number of modules to optimize in parallel with -batch "
+             "(default: the number of cores)"),
+    cl::init(0));
+
 static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
   // Add the pass to the pass manager...
   PM.add(P);
@@ -342,95 +372,29 @@ static TargetMachine* GetTargetMachine(Triple TheTriple, StringRef CPUStr,
                                         CMModel, GetCodeGenOptLevel());
 }
 
-#ifdef LINK_POLLY_INTO_TOOLS
-namespace polly {
-void initializePollyPasses(llvm::PassRegistry &Registry);
-}
-#endif
-
-//===----------------------------------------------------------------------===//
-// main for opt
-//
-int main(int argc, char **argv) {
-  sys::PrintStackTraceOnErrorSignal(argv[0]);
-  llvm::PrettyStackTraceProgram X(argc, argv);
-
-  // Enable debug stream buffering.
-  EnableDebugBuffering = true;
-
-  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
-  LLVMContext Context;
-
-  InitializeAllTargets();
-  InitializeAllTargetMCs();
-  InitializeAllAsmPrinters();
-
-  // Initialize passes
-  PassRegistry &Registry = *PassRegistry::getPassRegistry();
-  initializeCore(Registry);
-  initializeCoroutines(Registry);
-  initializeScalarOpts(Registry);
-  initializeObjCARCOpts(Registry);
-  initializeVectorization(Registry);
-  initializeIPO(Registry);
-  initializeAnalysis(Registry);
-  initializeTransformUtils(Registry);
-  initializeInstCombine(Registry);
-  initializeInstrumentation(Registry);
-  initializeTarget(Registry);
-  // For codegen passes, only passes that do IR to IR transformation are
-  // supported.
-  initializeCodeGenPreparePass(Registry);
-  initializeAtomicExpandPass(Registry);
-  initializeRewriteSymbolsLegacyPassPass(Registry);
-  initializeWinEHPreparePass(Registry);
-  initializeDwarfEHPreparePass(Registry);
-  initializeSafeStackPass(Registry);
-  initializeSjLjEHPreparePass(Registry);
-  initializePreISelIntrinsicLoweringLegacyPassPass(Registry);
-  initializeGlobalMergePass(Registry);
-  initializeInterleavedAccessPass(Registry);
-  initializeCountingFunctionInserterPass(Registry);
-  initializeUnreachableBlockElimLegacyPassPass(Registry);
-
-#ifdef LINK_POLLY_INTO_TOOLS
-  polly::initializePollyPasses(Registry);
-#endif
-
-  cl::ParseCommandLineOptions(argc, argv,
-    "llvm .bc -> .bc modular optimizer and analysis printer\n");
-
-  if (AnalyzeOnly && NoOutput) {
-    errs() << argv[0] << ": analyze mode conflicts with no-output mode.\n";
-    return 1;
-  }
-
-  SMDiagnostic Err;
-
+/// Set up a context for an input module as requested on the command line.
+static void configureContext(LLVMContext &Context) {
   Context.setDiscardValueNames(DiscardValueNames);
   if (!DisableDITypeMap)
     Context.enableDebugTypeODRUniquing();
 
   if (PassRemarksWithHotness)
     Context.setDiagnosticHotnessRequested(true);
+}
 
-  std::unique_ptr<tool_output_file> YamlFile;
-  if (RemarksFilename != "") {
-    std::error_code EC;
-    YamlFile = llvm::make_unique<tool_output_file>(RemarksFilename, EC,
-                                                   sys::fs::F_None);
-    if (EC) {
-      errs() << EC.message() << '\n';
-      return 1;
-    }
-    Context.setDiagnosticsOutputFile(new yaml::Output(YamlFile->os()));
-  }
+/// Optimize the module in \p InputFile as requested on the command line and
+/// write the result to \p OutputFile.  Errors are reported to \p Errs, and
+/// remarks to \p RemarksFile if there is one.  Returns the exit code of opt.
+static int optimizeModule(const char *Argv0, LLVMContext &Context,
+                          StringRef InputFile, std::string OutputFile,
+                          raw_ostream &Errs, tool_output_file *RemarksFile) {
+  SMDiagnostic Err;
 
   // Load the input module...
-  std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
+  std::unique_ptr<Module> M = parseIRFile(InputFile, Err, Context);
 
   if (!M) {
-    Err.print(argv[0], errs());
+    Err.print(Argv0, Errs);
     return 1;
   }
 
@@ -441,9 +405,8 @@ int main(int argc, char **argv) {
   // Immediately run the verifier to catch any problems before starting up the
   // pass pipelines.  Otherwise we can crash on broken code during
   // doInitialization().
-  if (!NoVerify && verifyModule(*M, &errs())) {
-    errs() << argv[0] << ": " << InputFilename
-           << ": error: input module is broken!\n";
+  if (!NoVerify && verifyModule(*M, &Errs)) {
+    Errs << Argv0 << ": " << InputFile << ": error: input module is broken!\n";
     return 1;
   }
 
@@ -453,19 +416,20 @@ int main(int argc, char **argv) {
 
   // Figure out what stream we are supposed to write to...
   std::unique_ptr<tool_output_file> Out;
+  bool NoOutput = ::NoOutput;
   if (NoOutput) {
-    if (!OutputFilename.empty())
-      errs() << "WARNING: The -o (output filename) option is ignored when\n"
+    if (!OutputFile.empty())
+      Errs << "WARNING: The -o (output filename) option is ignored when\n"
                 "the --disable-output option is used.\n";
   } else {
     // Default to standard output.
-    if (OutputFilename.empty())
-      OutputFilename = "-";
+    if (OutputFile.empty())
+      OutputFile = "-";
 
     std::error_code EC;
-    Out.reset(new tool_output_file(OutputFilename, EC, sys::fs::F_None));
+    Out.reset(new tool_output_file(OutputFile, EC, sys::fs::F_None));
     if (EC) {
-      errs() << EC.message() << '\n';
+      Errs << EC.message() << '\n';
       return 1;
     }
   }
@@ -508,7 +472,7 @@ int main(int argc, char **argv) {
     // The user has asked to use the new pass manager and provided a pipeline
     // string. Hand off the rest of the functionality to the new code for that
     // layer.
-    return runPassPipeline(argv[0], *M, TM.get(), Out.get(),
+    return runPassPipeline(Argv0, *M, TM.get(), Out.get(),
                            PassPipeline, OK, VK, PreserveAssemblyUseListOrder,
                            PreserveBitcodeUseListOrder, EmitSummaryIndex,
                            EmitModuleHash)
@@ -550,14 +514,14 @@ int main(int argc, char **argv) {
   if (PrintBreakpoints) {
     // Default to standard output.
     if (!Out) {
-      if (OutputFilename.empty())
-        OutputFilename = "-";
+      if (OutputFile.empty())
+        OutputFile = "-";
 
       std::error_code EC;
-      Out = llvm::make_unique<tool_output_file>(OutputFilename, EC,
+      Out = llvm::make_unique<tool_output_file>(OutputFile, EC,
                                                 sys::fs::F_None);
       if (EC) {
-        errs() << EC.message() << '\n';
+        Errs << EC.message() << '\n';
         return 1;
       }
     }
@@ -565,40 +529,47 @@ int main(int argc, char **argv) {
     NoOutput = true;
   }
 
+  // The standard pipelines still to be added, in front of the first pass
+  // named after them on the command line or at the end.
+  bool StandardLinkOpts = ::StandardLinkOpts;
+  bool OptLevelO0 = ::OptLevelO0, OptLevelO1 = ::OptLevelO1,
+       OptLevelO2 = ::OptLevelO2, OptLevelOs = ::OptLevelOs,
+       OptLevelOz = ::OptLevelOz, OptLevelO3 = ::OptLevelO3;
+
   // Create a new optimization pass for each one specified on the command line
   for (unsigned i = 0; i < PassList.size(); ++i) {
     if (StandardLinkOpts &&
-        StandardLinkOpts.getPosition() < PassList.getPosition(i)) {
+        ::StandardLinkOpts.getPosition() < PassList.getPosition(i)) {
       AddStandardLinkPasses(Passes);
       StandardLinkOpts = false;
     }
 
-    if (OptLevelO0 && OptLevelO0.getPosition() < PassList.getPosition(i)) {
+    if (OptLevelO0 && ::OptLevelO0.getPosition() < PassList.getPosition(i)) {
       AddOptimizationPasses(Passes, *FPasses, TM.get(), 0, 0);
       OptLevelO0 = false;
     }
 
-    if (OptLevelO1 && OptLevelO1.getPosition() < PassList.getPosition(i)) {
+    if (OptLevelO1 && ::OptLevelO1.getPosition() < PassList.getPosition(i)) {
       AddOptimizationPasses(Passes, *FPasses, TM.get(), 1, 0);
       OptLevelO1 = false;
     }
 
-    if (OptLevelO2 && OptLevelO2.getPosition() < PassList.getPosition(i)) {
+    if (OptLevelO2 && ::OptLevelO2.getPosition() < PassList.getPosition(i)) {
       AddOptimizationPasses(Passes, *FPasses, TM.get(), 2, 0);
       OptLevelO2 = false;
     }
 
-    if (OptLevelOs && OptLevelOs.getPosition() < PassList.getPosition(i)) {
+    if (OptLevelOs && ::OptLevelOs.getPosition() < PassList.getPosition(i)) {
       AddOptimizationPasses(Passes, *FPasses, TM.get(), 2, 1);
       OptLevelOs = false;
     }
 
-    if (OptLevelOz && OptLevelOz.getPosition() < PassList.getPosition(i)) {
+    if (OptLevelOz && ::OptLevelOz.getPosition() < PassList.getPosition(i)) {
       AddOptimizationPasses(Passes, *FPasses, TM.get(), 2, 2);
       OptLevelOz = false;
     }
 
-    if (OptLevelO3 && OptLevelO3.getPosition() < PassList.getPosition(i)) {
+    if (OptLevelO3 && ::OptLevelO3.getPosition() < PassList.getPosition(i)) {
       AddOptimizationPasses(Passes, *FPasses, TM.get(), 3, 0);
       OptLevelO3 = false;
     }
@@ -610,7 +581,7 @@ int main(int argc, char **argv) {
     else if (PassInf->getNormalCtor())
       P = PassInf->getNormalCtor()();
     else
-      errs() << argv[0] << ": cannot create pass: "
+      Errs << Argv0 << ": cannot create pass: "
              << PassInf->getPassName() << "\n";
     if (P) {
       PassKind Kind = P->getPassKind();
@@ -707,9 +678,6 @@ int main(int argc, char **argv) {
                                          EmitSummaryIndex, EmitModuleHash));
   }
 
-  // Before executing passes, print the final values of the LLVM options.
-  cl::PrintOptionValues();
-
   // If requested, run all passes again with the same pass manager to catch
   // bugs caused by persistent state in the passes
   if (RunTwice) {
@@ -728,14 +696,16 @@ int main(int argc, char **argv) {
     if (Buffer.size() != CompileTwiceBuffer.size() ||
         (memcmp(Buffer.data(), CompileTwiceBuffer.data(), Buffer.size()) !=
          0)) {
-      errs() << "Running the pass manager twice changed the output.\n"
+      Errs << "Running the pass manager twice changed the output.\n"
                 "Writing the result of the second run to the specified output.\n"
                 "To generate the one-run comparison binary, just run without\n"
                 "the compile-twice option\n";
       Out->os() << BOS->str();
       Out->keep();
-      if (YamlFile)
-        YamlFile->keep();
+      if (RemarksFile) {
+        Context.setDiagnosticsBinaryOutput(nullptr);
+        RemarksFile->keep();
+      }
       return 1;
     }
     Out->os() << BOS->str();
@@ -745,8 +715,239 @@ int main(int argc, char **argv) {
   if (!NoOutput || PrintBreakpoints)
     Out->keep();
 
-  if (YamlFile)
-    YamlFile->keep();
+  if (RemarksFile) {
+    // Write out the last block of binary remarks.
+    Context.setDiagnosticsBinaryOutput(nullptr);
+    RemarksFile->keep();
+  }
 
   return 0;
 }
+
+/// One module of a -batch run.
+struct BatchJob {
+  std::string InputFile;
+  std::string OutputFile;
+  /// The errors and diagnostics for the module, printed once all modules are
+  /// done so that they come out in the order of the batch file.
+  std::string Log;
+  int Result = 0;
+};
+
+namespace {
+/// Collects the diagnostics of a BatchJob, the way LLVMContext would print
+/// them.
+struct BatchDiagnostics {
+  raw_ostream &OS;
+  bool HasErrors;
+};
+} // end anonymous namespace
+
+static void handleBatchDiagnostic(const DiagnosticInfo &DI, void *Context) {
+  auto *Diags = static_cast<BatchDiagnostics *>(Context);
+  DiagnosticPrinterRawOStream DP(Diags->OS);
+  Diags->OS << LLVMContext::getDiagnosticMessagePrefix(DI.getSeverity())
+            << ": ";
+  DI.print(DP);
+  Diags->OS << "\n";
+  // Rather than exiting, just fail this module.
+  if (DI.getSeverity() == DS_Error)
+    Diags->HasErrors = true;
+}
+
+static void runBatchJob(const char *Argv0, BatchJob &Job) {
+  LLVMContext Context;
+  configureContext(Context);
+  raw_string_ostream Log(Job.Log);
+  BatchDiagnostics Diags = {Log, false};
+  Context.setDiagnosticHandler(handleBatchDiagnostic, &Diags,
+                               /*RespectFilters=*/true);
+
+  Job.Result = optimizeModule(Argv0, Context, Job.InputFile, Job.OutputFile,
+                              Log, nullptr);
+  if (Diags.HasErrors) {
+    Job.Result = 1;
+    // With -disable-output the job never opened its output file, so whatever
+    // is there belongs to somebody else.
+    if (!NoOutput)
+      sys::fs::remove(Job.OutputFile);
+  }
+  Log.flush();
+}
+
+/// Optimize every module listed in the -batch file on a thread pool, each in
+/// its own LLVMContext.  Each module is optimized exactly as if opt was run on
+/// it alone, so the outputs do not depend on the number of threads.
+static int runBatch(const char *Argv0) {
+  if (AnalyzeOnly || PrintEachXForm || PrintBreakpoints ||
+      !RemarksFilename.empty()) {
+    errs() << Argv0 << ": -batch cannot be used with -analyze, -p, "
+                       "-print-breakpoints-for-testing or "
+                       "-pass-remarks-output\n";
+    return 1;
+  }
+  // The batch file names the inputs and outputs of every job.
+  if (InputFilename.getNumOccurrences() || OutputFilename.getNumOccurrences()) {
+    errs() << Argv0 << ": -batch cannot be used with an input file or -o\n";
+    return 1;
+  }
+  // These print from every job straight to the shared error stream, where the
+  // output of concurrent modules would interleave. -debug and -debug-only
+  // only exist in builds with assertions.
+  StringMap<cl::Option *> &Options = cl::getRegisteredOptions();
+  for (const char *Name : {"print-before", "print-after", "print-before-all",
+                           "print-after-all", "debug-pass", "debug",
+                           "debug-only"}) {
+    auto I = Options.find(Name);
+    if (I != Options.end() && I->second->getNumOccurrences()) {
+      errs() << Argv0 << ": -batch cannot be used with -" << Name << "\n";
+      return 1;
+    }
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFileOrSTDIN(BatchFilename);
+  if (std::error_code EC = BufOrErr.getError()) {
+    errs() << Argv0 << ": " << BatchFilename << ": " << EC.message() << '\n';
+    return 1;
+  }
+
+  // Each line names an input module and the file to write it to.
+  std::vector<BatchJob> Jobs;
+  StringSet<> Outputs;
+  for (line_iterator I(**BufOrErr, /*SkipBlanks=*/true, '#'); !I.is_at_eof();
+       ++I) {
+    StringRef Input, Output, Rest;
+    std::tie(Input, Rest) = getToken(*I);
+    std::tie(Output, Rest) = getToken(Rest);
+    if (Output.empty() || !Rest.trim().empty() || Input == "-" ||
+        Output == "-") {
+      errs() << Argv0 << ": " << BatchFilename << ":" << I.line_number()
+             << ": expected an input and an output file\n";
+      return 1;
+    }
+    if (!Outputs.insert(Output).second) {
+      errs() << Argv0 << ": " << BatchFilename << ":" << I.line_number()
+             << ": output file '" << Output << "' is written more than once\n";
+      return 1;
+    }
+    Jobs.emplace_back();
+    Jobs.back().InputFile = Input;
+    Jobs.back().OutputFile = Output;
+  }
+
+  if (Jobs.empty())
+    return 0;
+
+  // Print the options once, rather than once per module.
+  cl::PrintOptionValues();
+
+  unsigned NumThreads = BatchThreads;
+  if (!NumThreads)
+    NumThreads = heavyweight_hardware_concurrency();
+  {
+    ThreadPool Pool(std::min<unsigned>(NumThreads, Jobs.size()));
+    for (BatchJob &Job : Jobs)
+      Pool.async([Argv0, &Job] { runBatchJob(Argv0, Job); });
+    Pool.wait();
+  }
+
+  int Result = 0;
+  for (const BatchJob &Job : Jobs) {
+    errs() << Job.Log;
+    if (Job.Result)
+      Result = 1;
+  }
+  return Result;
+}
+
+#ifdef LINK_POLLY_INTO_TOOLS
+namespace polly {
+void initializePollyPasses(llvm::PassRegistry &Registry);
+}
+#endif
+
+//===----------------------------------------------------------------------===//
+// main for opt
+//
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  llvm::PrettyStackTraceProgram X(argc, argv);
+
+  // Enable debug stream buffering.
+  EnableDebugBuffering = true;
+
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+  InitializeAllAsmPrinters();
+
+  // Initialize passes
+  PassRegistry &Registry = *PassRegistry::getPassRegistry();
+  initializeCore(Registry);
+  initializeCoroutines(Registry);
+  initializeScalarOpts(Registry);
+  initializeObjCARCOpts(Registry);
+  initializeVectorization(Registry);
+  initializeIPO(Registry);
+  initializeAnalysis(Registry);
+  initializeTransformUtils(Registry);
+  initializeInstCombine(Registry);
+  initializeInstrumentation(Registry);
+  initializeTarget(Registry);
+  // For codegen passes, only passes that do IR to IR transformation are
+  // supported.
+  initializeCodeGenPreparePass(Registry);
+  initializeAtomicExpandPass(Registry);
+  initializeRewriteSymbolsLegacyPassPass(Registry);
+  initializeWinEHPreparePass(Registry);
+  initializeDwarfEHPreparePass(Registry);
+  initializeSafeStackPass(Registry);
+  initializeSjLjEHPreparePass(Registry);
+  initializePreISelIntrinsicLoweringLegacyPassPass(Registry);
+  initializeGlobalMergePass(Registry);
+  initializeInterleavedAccessPass(Registry);
+  initializeCountingFunctionInserterPass(Registry);
+  initializeUnreachableBlockElimLegacyPassPass(Registry);
+
+#ifdef LINK_POLLY_INTO_TOOLS
+  polly::initializePollyPasses(Registry);
+#endif
+
+  cl::ParseCommandLineOptions(argc, argv,
+    "llvm .bc -> .bc modular optimizer and analysis printer\n");
+
+  if (AnalyzeOnly && NoOutput) {
+    errs() << argv[0] << ": analyze mode conflicts with no-output mode.\n";
+    return 1;
+  }
+
+  if (!BatchFilename.empty())
+    return runBatch(argv[0]);
+
+  LLVMContext Context;
+  configureContext(Context);
+
+  std::unique_ptr<tool_output_file> YamlFile;
+  if (RemarksFilename != "") {
+    std::error_code EC;
+    YamlFile = llvm::make_unique<tool_output_file>(RemarksFilename, EC,
+                                                   sys::fs::F_None);
+    if (EC) {
+      errs() << EC.message() << '\n';
+      return 1;
+    }
+    if (RemarksFormat == RF_Binary)
+      Context.setDiagnosticsBinaryOutput(
+          new remarks::BinaryRemarkWriter(YamlFile->os()));
+    else
+      Context.setDiagnosticsOutputFile(new yaml::Output(YamlFile->os()));
+  }
+
+  // Before executing passes, print the final values of the LLVM options.
+  cl::PrintOptionValues();
+
+  return optimizeModule(argv[0], Context, InputFilename, OutputFilename, errs(),
+                        YamlFile.get());
+}
@@ -10,6 +10,7 @@
 // This file is a command-line tool for reading and analyzing sanitizer
 // coverage.
 //===----------------------------------------------------------------------===//
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Twine.h"
@@ -48,11 +49,13 @@
 #include "llvm/Support/SpecialCaseList.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
+#include <mutex>
 #include <set>
 #include <stdio.h>
 #include <string>
@@ -906,8 +909,58 @@ static bool isSymbolizedCoverageFile(const std::string &FileName) {
   return SymcovFileRegex.match(ShortFileName);
 }
 
+// Read the given .sancov files of a binary in parallel and merge them into a
+// bitmap over the binary's coverage points, which are given in sorted order.
+static BitVector readCoverageBitmap(const std::vector<std::string> &FileNames,
+                                    const std::vector<uint64_t> &AllAddrs) {
+  struct FileResult {
+    std::error_code EC;
+    bool Matches = true;
+  };
+  std::vector<FileResult> Results(FileNames.size());
+  BitVector Covered(AllAddrs.size());
+  std::mutex CoveredMutex;
+
+  {
+    ThreadPool Pool;
+    for (size_t I = 0, E = FileNames.size(); I != E; ++I) {
+      Pool.async([&, I] {
+        auto DataOrError = RawCoverage::read(FileNames[I]);
+        if (!DataOrError) {
+          Results[I].EC = DataOrError.getError();
+          return;
+        }
+        BitVector Bits(AllAddrs.size());
+        for (uint64_t Addr : *DataOrError.get()->Addrs) {
+          auto It = std::lower_bound(AllAddrs.begin(), AllAddrs.end(), Addr);
+          if (It == AllAddrs.end() || *It != Addr) {
+            Results[I].Matches = false;
+            return;
+          }
+          Bits.set(It - AllAddrs.begin());
+        }
+        std::lock_guard<std::mutex> Lock(CoveredMutex);
+        Covered |= Bits;
+      });
+    }
+    Pool.wait();
+  }
+
+  // Report errors in input order.
+  for (const FileResult &Result : Results) {
+    failIfError(Result.EC);
+    if (!Result.Matches)
+      fail("Coverage points in binary and .sancov file do not match.");
+  }
+  return Covered;
+}
+
+// Symbolize the coverage points of ObjectFile and merge the coverage of all
+// of its .sancov files. The points are symbolized once per binary, however
+// many coverage files there are.
 static std::unique_ptr<SymbolizedCoverage>
-symbolize(const RawCoverage &Data, const std::string ObjectFile) {
+symbolize(const std::vector<std::string> &CoverageFiles,
+          const std::string ObjectFile) {
   auto Coverage = make_unique<SymbolizedCoverage>();
 
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
@@ -917,15 +970,12 @@ symbolize(const RawCoverage &Data, const std::string ObjectFile) {
   Hasher.update((*BufOrErr)->getBuffer());
   Coverage->BinaryHash = toHex(Hasher.final());
 
-  for (uint64_t Addr : *Data.Addrs) {
-    Coverage->CoveredIds.insert(utohexstr(Addr, true));
-  }
-
   std::set<uint64_t> AllAddrs = findCoveragePointAddrs(ObjectFile);
-  if (!std::includes(AllAddrs.begin(), AllAddrs.end(), Data.Addrs->begin(),
-                     Data.Addrs->end())) {
-    fail("Coverage points in binary and .sancov file do not match.");
-  }
+  std::vector<uint64_t> SortedAddrs(AllAddrs.begin(), AllAddrs.end());
+  BitVector Covered = readCoverageBitmap(CoverageFiles, SortedAddrs);
+  for (int I = Covered.find_first(); I != -1; I = Covered.find_next(I))
+    Coverage->CoveredIds.insert(utohexstr(SortedAddrs[I], true));
+
   Coverage->Points = getCoveragePoints(ObjectFile, AllAddrs, true);
   return Coverage;
 }
@@ -1145,11 +1195,7 @@ readSymbolizeAndMergeCmdArguments(std::vector<std::string> FileNames) {
         continue;
       }
 
-      for (const std::string &CoverageFile : Pair.second) {
-        auto DataOrError = RawCoverage::read(CoverageFile);
-        failIfError(DataOrError);
-        Coverages.push_back(symbolize(*DataOrError.get(), Pair.first));
-      }
+      Coverages.push_back(symbolize(Pair.second, Pair.first));
     }
   }
 
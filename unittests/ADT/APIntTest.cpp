@@ -682,6 +682,32 @@ TEST(APIntTest, divrem_big7) {
           {224, "80000000800000010000000f", 16});
 }
 
+TEST(APIntTest, divrem_twoWords) {
+  // Values of 65 to 128 bits are divided natively where possible.
+  testDiv({128, "ffffffffffffffff", 16},
+          {128, "fffffffffffff1", 16},
+          {128, "fffffffffffff0", 16});
+  testDiv({96, "1234567890abcdef", 16},
+          {96, "80000000", 16},
+          {96, 7919});
+}
+
+TEST(APIntTest, twoWordShiftsAndMul) {
+  // Check the two word paths against the same operations on three words.
+  for (unsigned Width : {65u, 100u, 127u, 128u}) {
+    uint64_t XWords[] = {0x9e3779b97f4a7c15ULL, 0xf39cc0605cedc834ULL};
+    uint64_t YWords[] = {0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL};
+    APInt X(Width, XWords), Y(Width, YWords);
+    APInt WideX = X.zext(192), WideY = Y.zext(192);
+    EXPECT_EQ((WideX * WideY).trunc(Width), X * Y);
+    for (unsigned Shift = 0; Shift <= Width; ++Shift) {
+      EXPECT_EQ(WideX.shl(Shift).trunc(Width), X.shl(Shift));
+      EXPECT_EQ(WideX.lshr(Shift).trunc(Width), X.lshr(Shift));
+      EXPECT_EQ(X.sext(192).ashr(Shift).trunc(Width), X.ashr(Shift));
+    }
+  }
+}
+
 TEST(APIntTest, fromString) {
   EXPECT_EQ(APInt(32, 0), APInt(32,   "0", 2));
   EXPECT_EQ(APInt(32, 1), APInt(32,   "1", 2));
@@ -96,5 +96,33 @@ TEST(DeltaAlgorithmTest, Basic) {
   EXPECT_EQ(11U, FDA.getNumTests());  
 }
 
+class ConcurrentDeltaAlgorithm final : public DeltaAlgorithm {
+  changeset_ty FailingSet;
+
+protected:
+  bool ExecuteOneTest(const changeset_ty &Changes) override {
+    return std::includes(Changes.begin(), Changes.end(),
+                         FailingSet.begin(), FailingSet.end());
+  }
+
+public:
+  ConcurrentDeltaAlgorithm(const changeset_ty &FailingSet, unsigned N)
+      : FailingSet(FailingSet) {
+    setTestConcurrency(N);
+  }
+};
+
+TEST(DeltaAlgorithmTest, Concurrent) {
+  // Testing several candidates at once must reduce to the same set, at the
+  // cost of some speculative tests.
+  for (unsigned N : {2, 3, 8}) {
+    ConcurrentDeltaAlgorithm CDA(fixed_set(3, 3, 5, 7), N);
+    EXPECT_EQ(fixed_set(3, 3, 5, 7), CDA.Run(range(20)));
+
+    ConcurrentDeltaAlgorithm CDA2(fixed_set(2, 0, 19), N);
+    EXPECT_EQ(fixed_set(2, 0, 19), CDA2.Run(range(20)));
+  }
+}
+
 }
 
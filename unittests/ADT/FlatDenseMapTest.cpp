@@ -0,0 +1,145 @@
+//===- llvm/unittest/ADT/FlatDenseMapTest.cpp - FlatDenseMap unit tests ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/FlatDenseMap.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(FlatDenseMapTest, EmptyMap) {
+  FlatDenseMap<unsigned, unsigned> M;
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ(0u, M.size());
+  EXPECT_TRUE(M.begin() == M.end());
+  EXPECT_EQ(0u, M.count(1));
+  EXPECT_TRUE(M.find(1) == M.end());
+  EXPECT_EQ(0u, M.lookup(1));
+  EXPECT_FALSE(M.erase(1));
+}
+
+TEST(FlatDenseMapTest, InsertFindErase) {
+  FlatDenseMap<unsigned, unsigned> M;
+  EXPECT_TRUE(M.insert(std::make_pair(1u, 2u)).second);
+  EXPECT_FALSE(M.insert(std::make_pair(1u, 3u)).second);
+  EXPECT_EQ(1u, M.size());
+  EXPECT_EQ(2u, M.lookup(1));
+  EXPECT_EQ(2u, M.find(1)->second);
+
+  M[4] = 5;
+  EXPECT_EQ(2u, M.size());
+  EXPECT_EQ(5u, M[4]);
+
+  EXPECT_TRUE(M.erase(1));
+  EXPECT_FALSE(M.erase(1));
+  EXPECT_EQ(0u, M.count(1));
+  EXPECT_EQ(1u, M.size());
+
+  M.erase(M.find(4));
+  EXPECT_TRUE(M.empty());
+  EXPECT_TRUE(M.begin() == M.end());
+}
+
+// DenseMapInfo<unsigned> reserves ~0U and ~0U - 1; FlatDenseMap doesn't.
+TEST(FlatDenseMapTest, ReservedDenseMapKeys) {
+  FlatDenseMap<unsigned, unsigned> M;
+  M[DenseMapInfo<unsigned>::getEmptyKey()] = 1;
+  M[DenseMapInfo<unsigned>::getTombstoneKey()] = 2;
+  EXPECT_EQ(2u, M.size());
+  EXPECT_EQ(1u, M.lookup(DenseMapInfo<unsigned>::getEmptyKey()));
+  EXPECT_EQ(2u, M.lookup(DenseMapInfo<unsigned>::getTombstoneKey()));
+}
+
+// Compare against std::map through growth, erasure and tombstone reuse.
+TEST(FlatDenseMapTest, MatchesStdMap) {
+  FlatDenseMap<unsigned, unsigned> M;
+  std::map<unsigned, unsigned> Ref;
+  uint32_t Seed = 1;
+  for (unsigned I = 0; I != 20000; ++I) {
+    Seed = Seed * 1103515245 + 12345;
+    unsigned Key = (Seed >> 8) % 3000;
+    if (Seed & 1) {
+      M[Key] = I;
+      Ref[Key] = I;
+    } else {
+      EXPECT_EQ(Ref.erase(Key) != 0, M.erase(Key));
+    }
+  }
+  EXPECT_EQ(Ref.size(), M.size());
+  for (const auto &KV : Ref)
+    EXPECT_EQ(KV.second, M.lookup(KV.first));
+
+  unsigned Visited = 0;
+  for (const auto &KV : M) {
+    EXPECT_EQ(Ref[KV.first], KV.second);
+    ++Visited;
+  }
+  EXPECT_EQ(Ref.size(), Visited);
+}
+
+TEST(FlatDenseMapTest, EraseWhileIterating) {
+  FlatDenseMap<unsigned, unsigned> M;
+  for (unsigned I = 0; I != 100; ++I)
+    M[I] = I;
+  for (auto I = M.begin(), E = M.end(); I != E;) {
+    auto Cur = I++;
+    if (Cur->first % 2)
+      M.erase(Cur);
+  }
+  EXPECT_EQ(50u, M.size());
+  for (unsigned I = 0; I != 100; ++I)
+    EXPECT_EQ(I % 2 == 0, M.count(I) == 1);
+}
+
+TEST(FlatDenseMapTest, Reserve) {
+  FlatDenseMap<unsigned, unsigned> M;
+  M.reserve(1000);
+  size_t MemorySize = M.getMemorySize();
+  for (unsigned I = 0; I != 1000; ++I)
+    M[I] = I;
+  EXPECT_EQ(MemorySize, M.getMemorySize());
+}
+
+TEST(FlatDenseMapTest, CopyMoveClear) {
+  FlatDenseMap<unsigned, std::string> M;
+  for (unsigned I = 0; I != 40; ++I)
+    M[I] = std::to_string(I);
+
+  FlatDenseMap<unsigned, std::string> Copy(M);
+  EXPECT_EQ(40u, Copy.size());
+  EXPECT_EQ("17", Copy.lookup(17));
+
+  FlatDenseMap<unsigned, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(40u, Moved.size());
+  EXPECT_TRUE(Copy.empty());
+
+  Copy = Moved;
+  EXPECT_EQ("39", Copy.lookup(39));
+
+  M.clear();
+  EXPECT_TRUE(M.empty());
+  EXPECT_EQ(0u, M.count(17));
+  M[17] = "x";
+  EXPECT_EQ("x", M.lookup(17));
+}
+
+TEST(FlatDenseMapTest, MoveOnlyValues) {
+  FlatDenseMap<int *, std::unique_ptr<int>> M;
+  int Keys[64];
+  for (int &K : Keys)
+    M.try_emplace(&K, new int(&K - Keys));
+  for (int &K : Keys)
+    EXPECT_EQ(&K - Keys, *M.find(&K)->second);
+}
+
+} // end anonymous namespace
@@ -14,6 +14,7 @@
 #include "gtest/gtest.h"
 #include "llvm/ADT/FoldingSet.h"
 #include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -189,5 +190,47 @@ TEST(FoldingSetTest, SmallReserveChangesNothing) {
   EXPECT_EQ(Trivial.capacity(), OldCapacity);
 }
 
+struct CachedHashPair : public CachedHashFoldingSetNode {
+  unsigned Key = 0;
+  unsigned Value = 0;
+  CachedHashPair(unsigned K, unsigned V) : Key(K), Value(V) {}
+
+  void Profile(FoldingSetNodeID &ID) const {
+    ID.AddInteger(Key);
+    ID.AddInteger(Value);
+  }
+};
+
+TEST(FoldingSetTest, CachedHashes) {
+  std::vector<CachedHashPair> Pairs;
+  for (unsigned I = 0; I != 1000; ++I)
+    Pairs.emplace_back(I, I * 7);
+
+  // Growing the folding set must keep every node reachable.
+  FoldingSet<CachedHashPair> Set;
+  for (CachedHashPair &P : Pairs)
+    EXPECT_EQ(&P, Set.GetOrInsertNode(&P));
+  EXPECT_EQ(Pairs.size(), Set.size());
+  for (CachedHashPair &P : Pairs) {
+    CachedHashPair Copy(P.Key, P.Value);
+    EXPECT_EQ(&P, Set.GetOrInsertNode(&Copy));
+  }
+
+  // A node changed while out of the set is found under its new profile only.
+  CachedHashPair &P = Pairs[42];
+  EXPECT_TRUE(Set.RemoveNode(&P));
+  P.Value = 1;
+  Set.InsertNode(&P);
+  void *InsertPos = nullptr;
+  FoldingSetNodeID ID;
+  ID.AddInteger(42U);
+  ID.AddInteger(1U);
+  EXPECT_EQ(&P, Set.FindNodeOrInsertPos(ID, InsertPos));
+  ID.clear();
+  ID.AddInteger(42U);
+  ID.AddInteger(42U * 7);
+  EXPECT_EQ(nullptr, Set.FindNodeOrInsertPos(ID, InsertPos));
+}
+
 }
 
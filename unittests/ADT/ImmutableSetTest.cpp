@@ -201,4 +201,20 @@ TEST_F(ImmutableSetTest, IterLongSetTest) {
   ASSERT_EQ(6, i);
 }
 
+TEST_F(ImmutableSetTest, CanonicalizeTest) {
+  ImmutableSet<int>::Factory f;
+  ImmutableSet<int> Base = f.getEmptySet();
+  for (int i = 0; i < 64; i += 2)
+    Base = f.add(Base, i);
+
+  // Equal sets built in different orders share a single canonical root.
+  ImmutableSet<int> S1 = f.add(f.add(Base, 7), 21);
+  ImmutableSet<int> S2 = f.add(f.add(Base, 21), 7);
+  EXPECT_EQ(S1.getRoot(), S2.getRoot());
+
+  ImmutableSet<int> S3 = f.add(f.add(Base, 7), 23);
+  EXPECT_NE(S1.getRoot(), S3.getRoot());
+  EXPECT_EQ(S3.getRoot(), f.remove(f.add(S3, 5), 5).getRoot());
+}
+
 }
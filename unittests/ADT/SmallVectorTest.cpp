@@ -924,4 +924,18 @@ TEST(SmallVectorTest, InitializerList) {
   EXPECT_TRUE(makeArrayRef(V2).equals({4, 5, 3, 2}));
 }
 
+TEST(SmallVectorTest, HeaderSize) {
+  // The header is a pointer and two 32-bit counts, followed directly by the
+  // inline elements.
+  EXPECT_EQ(sizeof(void *) + 2 * sizeof(unsigned) + 4 * sizeof(void *),
+            sizeof(SmallVector<void *, 4>));
+
+  SmallVector<void *, 4> V;
+  EXPECT_EQ(4u, V.capacity());
+  V.resize(5);
+  EXPECT_LE(5u, V.capacity());
+  EXPECT_EQ(5 * sizeof(void *), V.size_in_bytes());
+  EXPECT_EQ(V.capacity() * sizeof(void *), V.capacity_in_bytes());
+}
+
 } // end namespace
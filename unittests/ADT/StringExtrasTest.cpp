@@ -50,3 +50,22 @@ TEST(StringExtrasTest, JoinItems) {
 
   EXPECT_EQ("foo/bar/baz/x", join_items('/', Foo, Bar, Baz, X));
 }
+
+TEST(StringExtrasTest, HashString) {
+  // The hash is persisted by on-disk hash tables, so it must stay the plain
+  // Bernstein hash however it is computed.
+  auto Reference = [](StringRef Str, unsigned Result) {
+    for (unsigned char C : Str.bytes())
+      Result = Result * 33 + C;
+    return Result;
+  };
+
+  EXPECT_EQ(0U, HashString(""));
+  EXPECT_EQ(5U, HashString("", 5));
+  std::string Str;
+  for (unsigned I = 0; I != 20; ++I) {
+    EXPECT_EQ(Reference(Str, 0), HashString(Str));
+    EXPECT_EQ(Reference(Str, 42), HashString(Str, 42));
+    Str.push_back(char(0x80 + I * 7));
+  }
+}
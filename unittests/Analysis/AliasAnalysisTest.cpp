@@ -204,6 +204,49 @@ TEST_F(AliasAnalysisTest, getModRefInfo) {
   EXPECT_EQ(AA.getModRefInfo(AtomicRMW), MRI_ModRef);
 }
 
+TEST_F(AliasAnalysisTest, BatchMode) {
+  FunctionType *FTy =
+      FunctionType::get(Type::getVoidTy(C), std::vector<Type *>(), false);
+  auto *F = cast<Function>(M.getOrInsertFunction("f", FTy));
+  auto *BB = BasicBlock::Create(C, "entry", F);
+  auto *IntType = Type::getInt32Ty(C);
+  auto *A = new AllocaInst(IntType, "a", BB);
+  auto *B = new AllocaInst(IntType, "b", BB);
+  ReturnInst::Create(C, nullptr, BB);
+
+  AAResults AA(TLI);
+  unsigned NumQueries = 0;
+  TestCustomAAResult CustomAA([&] { ++NumQueries; });
+  AA.addAAResult(CustomAA);
+
+  MemoryLocation LocA(A, 4), LocB(B, 4);
+  AA.alias(LocA, LocB);
+  AA.alias(LocA, LocB);
+  EXPECT_EQ(2u, NumQueries);
+
+  {
+    AABatchModeScope BatchAA(AA);
+    // Queries are memoized, in either order.
+    NumQueries = 0;
+    EXPECT_EQ(MayAlias, AA.alias(LocA, LocB));
+    EXPECT_EQ(MayAlias, AA.alias(LocA, LocB));
+    EXPECT_EQ(MayAlias, AA.alias(LocB, LocA));
+    EXPECT_EQ(1u, NumQueries);
+
+    // Nested scopes keep batch mode on.
+    { AABatchModeScope Nested(AA); }
+    EXPECT_TRUE(AA.isBatchMode());
+    AA.alias(LocA, LocB);
+    EXPECT_EQ(1u, NumQueries);
+  }
+
+  // Leaving batch mode drops the memoized results.
+  EXPECT_FALSE(AA.isBatchMode());
+  NumQueries = 0;
+  AA.alias(LocA, LocB);
+  EXPECT_EQ(1u, NumQueries);
+}
+
 class AAPassInfraTest : public testing::Test {
 protected:
   LLVMContext C;
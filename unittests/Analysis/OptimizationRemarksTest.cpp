@@ -0,0 +1,140 @@
+//===- OptimizationRemarksTest.cpp - Optimization remark output tests -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/OptimizationDiagnosticInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/BinaryRemarks.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+const char *ModuleString =
+    "define i32 @foo() !dbg !4 {\n"
+    "  ret i32 1, !dbg !7\n"
+    "}\n"
+    "define i32 @bar() !dbg !6 {\n"
+    "  %call = call i32 @foo(), !dbg !8\n"
+    "  ret i32 %call, !dbg !8\n"
+    "}\n"
+    "!llvm.dbg.cu = !{!0}\n"
+    "!llvm.module.flags = !{!3}\n"
+    "!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, "
+    "isOptimized: true, emissionKind: LineTablesOnly, enums: !2)\n"
+    "!1 = !DIFile(filename: \"s.c\", directory: \"/tmp\")\n"
+    "!2 = !{}\n"
+    "!3 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+    "!4 = distinct !DISubprogram(name: \"foo\", scope: !1, file: !1, line: 1, "
+    "type: !5, isDefinition: true, scopeLine: 2, unit: !0)\n"
+    "!5 = !DISubroutineType(types: !2)\n"
+    "!6 = distinct !DISubprogram(name: \"bar\", scope: !1, file: !1, line: 5, "
+    "type: !5, isDefinition: true, scopeLine: 5, unit: !0)\n"
+    "!7 = !DILocation(line: 2, column: 3, scope: !4)\n"
+    "!8 = !DILocation(line: 6, column: 10, scope: !6)\n";
+
+// The YAML and the binary output of the same remarks describe them alike,
+// including the source locations of the values the arguments name.
+TEST(OptimizationRemarksTest, YAMLAndBinaryAgree) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(ModuleString, Err, C);
+  ASSERT_TRUE(M != nullptr);
+  Function *Foo = M->getFunction("foo");
+  Function *Bar = M->getFunction("bar");
+  auto *Call = cast<CallInst>(&Bar->getEntryBlock().front());
+
+  std::string YAML, Binary;
+  raw_string_ostream YOS(YAML), BOS(Binary);
+  C.setDiagnosticsOutputFile(new yaml::Output(YOS));
+  C.setDiagnosticsBinaryOutput(new remarks::BinaryRemarkWriter(BOS));
+  OptimizationRemarkEmitter ORE(Bar);
+  ORE.emit(OptimizationRemark("inline", "Inlined", Call)
+           << ore::NV("Callee", Foo) << " inlined into "
+           << ore::NV("Caller", Bar));
+  ORE.emit(OptimizationRemarkMissed("inline", "NotInlined", Call)
+           << ore::NV("Call", Call));
+  C.setDiagnosticsOutputFile(nullptr);
+  C.setDiagnosticsBinaryOutput(nullptr);
+
+  EXPECT_EQ("--- !Passed\n"
+            "Pass:            inline\n"
+            "Name:            Inlined\n"
+            "DebugLoc:        { File: s.c, Line: 6, Column: 10 }\n"
+            "Function:        bar\n"
+            "Args:            \n"
+            "  - Callee:          foo\n"
+            "    DebugLoc:        { File: s.c, Line: 2, Column: 0 }\n"
+            "  - String:          ' inlined into '\n"
+            "  - Caller:          bar\n"
+            "    DebugLoc:        { File: s.c, Line: 5, Column: 0 }\n"
+            "...\n"
+            "--- !Missed\n"
+            "Pass:            inline\n"
+            "Name:            NotInlined\n"
+            "DebugLoc:        { File: s.c, Line: 6, Column: 10 }\n"
+            "Function:        bar\n"
+            "Args:            \n"
+            "  - Call:            call\n"
+            "    DebugLoc:        { File: s.c, Line: 6, Column: 10 }\n"
+            "...\n",
+            YOS.str());
+
+  remarks::BinaryRemarkReader Reader(BOS.str());
+  remarks::Remark R;
+  Expected<bool> More = Reader.next(R);
+  ASSERT_TRUE(bool(More));
+  ASSERT_TRUE(*More);
+  EXPECT_EQ(remarks::RemarkKind::Passed, R.Kind);
+  EXPECT_EQ("!Passed", remarks::getRemarkTag(R.Kind));
+  EXPECT_EQ("inline", R.PassName);
+  EXPECT_EQ("Inlined", R.RemarkName);
+  EXPECT_EQ("bar", R.FunctionName);
+  EXPECT_EQ("s.c", R.File);
+  EXPECT_EQ(6u, R.Line);
+  EXPECT_EQ(10u, R.Column);
+  ASSERT_EQ(3u, R.Args.size());
+  EXPECT_EQ("Callee", R.Args[0].Key);
+  EXPECT_EQ("foo", R.Args[0].Val);
+  EXPECT_EQ("s.c", R.Args[0].File);
+  EXPECT_EQ(2u, R.Args[0].Line);
+  EXPECT_EQ(0u, R.Args[0].Column);
+  EXPECT_EQ("String", R.Args[1].Key);
+  EXPECT_EQ(" inlined into ", R.Args[1].Val);
+  EXPECT_TRUE(R.Args[1].File.empty());
+  EXPECT_EQ("Caller", R.Args[2].Key);
+  EXPECT_EQ("bar", R.Args[2].Val);
+  EXPECT_EQ("s.c", R.Args[2].File);
+  EXPECT_EQ(5u, R.Args[2].Line);
+
+  More = Reader.next(R);
+  ASSERT_TRUE(bool(More));
+  ASSERT_TRUE(*More);
+  EXPECT_EQ(remarks::RemarkKind::Missed, R.Kind);
+  EXPECT_EQ("NotInlined", R.RemarkName);
+  ASSERT_EQ(1u, R.Args.size());
+  EXPECT_EQ("Call", R.Args[0].Key);
+  EXPECT_EQ("call", R.Args[0].Val);
+  EXPECT_EQ("s.c", R.Args[0].File);
+  EXPECT_EQ(6u, R.Args[0].Line);
+  EXPECT_EQ(10u, R.Args[0].Column);
+
+  More = Reader.next(R);
+  ASSERT_TRUE(bool(More));
+  EXPECT_FALSE(*More);
+}
+
+} // end anonymous namespace
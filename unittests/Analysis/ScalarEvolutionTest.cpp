@@ -441,5 +441,97 @@ TEST_F(ScalarEvolutionsTest, CommutativeExprOperandOrder) {
   }
 }
 
+// Adding a loop invariant to an add recurrence folds it into the start. Check
+// that once an operand becomes invariant, a cached fold from before is not
+// handed out again.
+static const char *HoistableLoopIR =
+    "define void @f(i32* %p, i32 %n) { "
+    "entry: "
+    "  br label %loop "
+    "loop: "
+    "  %iv = phi i32 [ 0, %entry ], [ %iv.next, %loop ] "
+    "  %x = load i32, i32* %p "
+    "  %y = sdiv i32 %iv, %n "
+    "  %iv.next = add i32 %iv, 1 "
+    "  %cond = icmp slt i32 %iv.next, %n "
+    "  br i1 %cond, label %loop, label %exit "
+    "exit: "
+    "  ret void "
+    "} ";
+
+TEST_F(ScalarEvolutionsTest, FoldCacheForgetValue) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(HoistableLoopIR, Err, C);
+  assert(M && "Could not parse module?");
+
+  Function *F = M->getFunction("f");
+  ScalarEvolution SE = buildSE(*F);
+  Instruction *X = getInstructionByName(*M, "x");
+  const SCEV *IV = SE.getSCEV(getInstructionByName(*M, "iv"));
+  const SCEV *SX = SE.getSCEV(X);
+  EXPECT_TRUE(isa<SCEVAddExpr>(SE.getAddExpr(IV, SX)));
+
+  X->moveBefore(F->getEntryBlock().getTerminator());
+  SE.forgetValue(X);
+
+  const SCEV *Sum = SE.getAddExpr(SE.getSCEV(getInstructionByName(*M, "iv")),
+                                  SE.getSCEV(X));
+  ASSERT_TRUE(isa<SCEVAddRecExpr>(Sum));
+  EXPECT_EQ(cast<SCEVAddRecExpr>(Sum)->getStart(), SX);
+}
+
+TEST_F(ScalarEvolutionsTest, FoldCacheForgetLoop) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(HoistableLoopIR, Err, C);
+  assert(M && "Could not parse module?");
+
+  Function *F = M->getFunction("f");
+  ScalarEvolution SE = buildSE(*F);
+  Instruction *Y = getInstructionByName(*M, "y");
+  const SCEV *IV = SE.getSCEV(getInstructionByName(*M, "iv"));
+  const SCEV *SY = SE.getSCEV(Y);
+  EXPECT_TRUE(isa<SCEVAddExpr>(SE.getAddExpr(IV, SY)));
+
+  // Forget the loop before rewriting it, as loop passes do.
+  SE.forgetLoop(LI->getLoopFor(Y->getParent()));
+  Y->setOperand(0, Y->getOperand(1));
+  Y->moveBefore(F->getEntryBlock().getTerminator());
+
+  const SCEV *Sum = SE.getAddExpr(SE.getSCEV(getInstructionByName(*M, "iv")),
+                                  SE.getSCEV(Y));
+  ASSERT_TRUE(isa<SCEVAddRecExpr>(Sum));
+  EXPECT_EQ(cast<SCEVAddRecExpr>(Sum)->getStart(), SY);
+}
+
+// Folding an invariant into a recurrence propagates the recurrence's no-wrap
+// flags, so a fold cached before those flags were strengthened is stale.
+TEST_F(ScalarEvolutionsTest, FoldCacheSetNoWrapFlags) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(HoistableLoopIR, Err, C);
+  assert(M && "Could not parse module?");
+
+  Function *F = M->getFunction("f");
+  ScalarEvolution SE = buildSE(*F);
+  const Loop *L = LI->getLoopFor(getInstructionByName(*M, "iv")->getParent());
+  Type *Ty = Type::getInt32Ty(C);
+  const SCEV *N = SE.getSCEV(&*std::next(F->arg_begin()));
+  const SCEV *AR = SE.getAddRecExpr(SE.getConstant(Ty, 0),
+                                    SE.getConstant(Ty, 1), L,
+                                    SCEV::FlagAnyWrap);
+
+  const SCEV *Sum = SE.getAddExpr(AR, N, SCEV::FlagNSW);
+  ASSERT_TRUE(isa<SCEVAddRecExpr>(Sum));
+  EXPECT_FALSE(cast<SCEVAddRecExpr>(Sum)->hasNoSignedWrap());
+
+  SE.setNoWrapFlags(const_cast<SCEVAddRecExpr *>(cast<SCEVAddRecExpr>(AR)),
+                    SCEV::FlagNSW);
+  Sum = SE.getAddExpr(AR, N, SCEV::FlagNSW);
+  ASSERT_TRUE(isa<SCEVAddRecExpr>(Sum));
+  EXPECT_TRUE(cast<SCEVAddRecExpr>(Sum)->hasNoSignedWrap());
+}
+
 }  // end anonymous namespace
 }  // end namespace llvm
@@ -188,3 +188,54 @@ TEST_F(MatchSelectPatternTest, DoubleCastBad) {
   // The cast types here aren't the same, so we cannot match an UMIN.
   expectPattern({SPF_UNKNOWN, SPNB_NA, false});
 }
+
+TEST(ValueTracking, KnownBitsCache) {
+  LLVMContext Context;
+  SMDiagnostic Error;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define i32 @test(i8 %a, i32 %b) {\n"
+      "  %1 = zext i8 %a to i32\n"
+      "  %2 = shl i32 %1, 4\n"
+      "  %3 = and i32 %b, -256\n"
+      "  %4 = or i32 %2, %3\n"
+      "  %5 = add i32 %4, %4\n"
+      "  %A = ashr i32 %5, 3\n"
+      "  ret i32 %A\n"
+      "}\n",
+      Error, Context);
+  ASSERT_TRUE(M != nullptr);
+  const DataLayout &DL = M->getDataLayout();
+
+  // Cached queries give the same answers as uncached ones.
+  KnownBitsCache Cache;
+  for (Instruction &I : instructions(*M->getFunction("test"))) {
+    if (!I.getType()->isIntegerTy())
+      continue;
+    APInt KnownZero(32, 0), KnownOne(32, 0);
+    APInt CachedZero(32, 0), CachedOne(32, 0);
+    computeKnownBits(&I, KnownZero, KnownOne, DL);
+    for (int Repeat = 0; Repeat != 2; ++Repeat) {
+      computeKnownBits(&I, CachedZero, CachedOne, DL, 0, nullptr, nullptr,
+                       nullptr, &Cache);
+      EXPECT_EQ(KnownZero, CachedZero);
+      EXPECT_EQ(KnownOne, CachedOne);
+      EXPECT_EQ(ComputeNumSignBits(&I, DL),
+                ComputeNumSignBits(&I, DL, 0, nullptr, nullptr, nullptr,
+                                   &Cache));
+    }
+  }
+  EXPECT_FALSE(Cache.empty());
+
+  // A cached result is returned as is.
+  Instruction *A = M->getFunction("test")->getEntryBlock().getTerminator();
+  A = cast<Instruction>(A->getOperand(0));
+  Cache.insertKnownBits(A, A, 0, APInt(32, 1), APInt(32, 2));
+  APInt KnownZero(32, 0), KnownOne(32, 0);
+  computeKnownBits(A, KnownZero, KnownOne, DL, 0, nullptr, nullptr, nullptr,
+                   &Cache);
+  EXPECT_EQ(1u, KnownZero.getZExtValue());
+  EXPECT_EQ(2u, KnownOne.getZExtValue());
+
+  Cache.clear();
+  EXPECT_TRUE(Cache.empty());
+}
@@ -9,15 +9,18 @@
 
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DataStream.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -51,14 +54,15 @@ static void writeModuleToBuffer(std::unique_ptr<Module> Mod,
   WriteBitcodeToFile(Mod.get(), OS);
 }
 
-static std::unique_ptr<Module> getLazyModuleFromAssembly(LLVMContext &Context,
-                                                         SmallString<1024> &Mem,
-                                                         const char *Assembly) {
+static std::unique_ptr<Module>
+getLazyModuleFromAssembly(LLVMContext &Context, SmallString<1024> &Mem,
+                          const char *Assembly,
+                          bool ShouldLazyLoadMetadata = false) {
   writeModuleToBuffer(parseAssembly(Context, Assembly), Mem);
   std::unique_ptr<MemoryBuffer> Buffer =
       MemoryBuffer::getMemBuffer(Mem.str(), "test", false);
   ErrorOr<std::unique_ptr<Module>> ModuleOrErr =
-      getLazyBitcodeModule(std::move(Buffer), Context);
+      getLazyBitcodeModule(std::move(Buffer), Context, ShouldLazyLoadMetadata);
   return std::move(ModuleOrErr.get());
 }
 
@@ -204,6 +208,135 @@ TEST(BitReaderTest, MaterializeFunctionsOutOfOrder) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+/// Turn on the on-demand loading of module metadata records, which is off by
+/// default, for as long as this object lives.
+class LazyMetadataRecordsScope {
+  cl::opt<bool> *Option;
+  bool OldValue;
+
+public:
+  LazyMetadataRecordsScope()
+      : Option(static_cast<cl::opt<bool> *>(
+            cl::getRegisteredOptions()["bitcode-lazy-metadata-records"])),
+        OldValue(*Option) {
+    *Option = true;
+  }
+  ~LazyMetadataRecordsScope() { *Option = OldValue; }
+};
+
+// Tests that module metadata can be loaded one function at a time.
+TEST(BitReaderTest, MaterializeMetadataLazily) {
+  LazyMetadataRecordsScope LazyRecords;
+  const char *Assembly =
+      "define void @f(i32* %p) !dbg !6 {\n"
+      "  store i32 0, i32* %p, !dbg !8, !tbaa !13\n"
+      "  ret void, !dbg !8\n"
+      "}\n"
+      "define void @g() !dbg !9 {\n"
+      "  ret void, !dbg !12\n"
+      "}\n"
+      "!llvm.dbg.cu = !{!0}\n"
+      "!llvm.module.flags = !{!3, !4}\n"
+      "!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, "
+      "producer: \"clang\", isOptimized: false, runtimeVersion: 0, "
+      "emissionKind: FullDebug, enums: !2)\n"
+      "!1 = !DIFile(filename: \"t.c\", directory: \"/\")\n"
+      "!2 = !{}\n"
+      "!3 = !{i32 2, !\"Dwarf Version\", i32 4}\n"
+      "!4 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+      "!5 = !DISubroutineType(types: !2)\n"
+      "!6 = distinct !DISubprogram(name: \"f\", scope: !1, file: !1, "
+      "line: 1, type: !5, isLocal: false, isDefinition: true, scopeLine: 1, "
+      "isOptimized: false, unit: !0, variables: !2)\n"
+      "!7 = distinct !DILexicalBlock(scope: !6, file: !1, line: 2)\n"
+      "!8 = !DILocation(line: 2, column: 3, scope: !7)\n"
+      "!9 = distinct !DISubprogram(name: \"g\", scope: !1, file: !1, "
+      "line: 4, type: !10, isLocal: false, isDefinition: true, scopeLine: 4, "
+      "isOptimized: false, unit: !0, variables: !2)\n"
+      "!10 = !DISubroutineType(types: !11)\n"
+      "!11 = !{null}\n"
+      "!12 = !DILocation(line: 5, column: 3, scope: !9)\n"
+      "!13 = !{!14, !14, i64 0}\n"
+      "!14 = !{!\"int\", !15, i64 0}\n"
+      "!15 = !{!\"omnipotent char\", !16, i64 0}\n"
+      "!16 = !{!\"Simple C/C++ TBAA\"}\n";
+
+  SmallString<1024> Mem;
+  LLVMContext Context;
+  std::unique_ptr<Module> M = getLazyModuleFromAssembly(
+      Context, Mem, Assembly, /*ShouldLazyLoadMetadata=*/true);
+  ASSERT_FALSE(M->materializeMetadata());
+  EXPECT_EQ(1u, M->getNamedMetadata("llvm.dbg.cu")->getNumOperands());
+
+  Function *F = M->getFunction("f");
+  Function *G = M->getFunction("g");
+  ASSERT_FALSE(F->materialize());
+  ASSERT_TRUE(F->getSubprogram() != nullptr);
+  EXPECT_EQ("f", F->getSubprogram()->getName());
+  Instruction &Store = F->getEntryBlock().front();
+  EXPECT_EQ(2u, Store.getDebugLoc().getLine());
+  EXPECT_EQ(F->getSubprogram(),
+            cast<DILexicalBlock>(Store.getDebugLoc().getScope())->getScope());
+  MDNode *TBAA = Store.getMetadata(LLVMContext::MD_tbaa);
+  ASSERT_TRUE(TBAA != nullptr);
+  EXPECT_TRUE(TBAA->isResolved());
+  EXPECT_EQ(3u, TBAA->getNumOperands());
+  EXPECT_TRUE(G->isMaterializable());
+
+  ASSERT_FALSE(M->materializeAll());
+  EXPECT_EQ("g", G->getSubprogram()->getName());
+  EXPECT_FALSE(verifyModule(*M, &dbgs()));
+
+  // The result must match reading the whole module at once.
+  LLVMContext EagerContext;
+  ErrorOr<std::unique_ptr<Module>> EagerOrErr =
+      parseBitcodeFile(MemoryBufferRef(Mem.str(), "test"), EagerContext);
+  ASSERT_TRUE(bool(EagerOrErr));
+  std::string Lazy, Eager;
+  raw_string_ostream LazyOS(Lazy), EagerOS(Eager);
+  LazyOS << *M;
+  EagerOS << **EagerOrErr;
+  EXPECT_EQ(EagerOS.str(), LazyOS.str());
+}
+
+// Tests that an attachment whose operands nest deeper than the reader loads
+// recursively is complete once it is attached.
+TEST(BitReaderTest, MaterializeDeepMetadataLazily) {
+  LazyMetadataRecordsScope LazyRecords;
+  // An old-style scalar TBAA chain, which is upgraded when it is attached.
+  const unsigned Depth = 200;
+  std::string Assembly = "define void @f(i32* %p) {\n"
+                         "  store i32 0, i32* %p, !tbaa !0\n"
+                         "  ret void\n"
+                         "}\n";
+  for (unsigned I = 0; I != Depth; ++I)
+    Assembly += "!" + utostr(I) + " = !{!\"t" + utostr(I) + "\", !" +
+                utostr(I + 1) + "}\n";
+  Assembly += "!" + utostr(Depth) + " = !{!\"root\"}\n";
+
+  SmallString<1024> Mem;
+  LLVMContext Context;
+  std::unique_ptr<Module> M = getLazyModuleFromAssembly(
+      Context, Mem, Assembly.c_str(), /*ShouldLazyLoadMetadata=*/true);
+  ASSERT_FALSE(M->materializeMetadata());
+  Function *F = M->getFunction("f");
+  ASSERT_FALSE(F->materialize());
+
+  MDNode *TBAA = F->getEntryBlock().front().getMetadata(LLVMContext::MD_tbaa);
+  ASSERT_TRUE(TBAA != nullptr);
+  EXPECT_TRUE(TBAA->isResolved());
+  unsigned NumTypes = 0;
+  for (auto *Ty = dyn_cast<MDNode>(TBAA->getOperand(0)); Ty;
+       Ty = Ty->getNumOperands() > 1 ? dyn_cast<MDNode>(Ty->getOperand(1))
+                                     : nullptr) {
+    EXPECT_FALSE(Ty->isTemporary());
+    EXPECT_TRUE(Ty->isResolved());
+    ++NumTypes;
+  }
+  EXPECT_EQ(Depth + 1, NumTypes);
+  EXPECT_FALSE(verifyModule(*M, &dbgs()));
+}
+
 TEST(BitReaderTest, MaterializeFunctionsForBlockAddr) { // PR11677
   SmallString<1024> Mem;
 
@@ -272,4 +405,64 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+TEST(BitReaderTest, ReadSymbolTable) {
+  SmallString<1024> Mem;
+
+  LLVMContext Context;
+  writeModuleToBuffer(
+      parseAssembly(Context,
+                    "source_filename = \"symtab.c\"\n"
+                    "$c = comdat any\n"
+                    "@var = global i32 0, comdat($c)\n"
+                    "@cst = hidden constant i32 1, section \"sec\"\n"
+                    "@ext = external thread_local global i32\n"
+                    "@internal = internal global i32 2\n"
+                    "@alias = weak alias i32, i32* @var\n"
+                    "@chain = alias i32, i32* @alias\n"
+                    "define linkonce_odr void @func() unnamed_addr "
+                    "comdat($c) {\n"
+                    "  ret void\n"
+                    "}\n"
+                    "declare x86_stdcallcc void @decl()\n"),
+      Mem);
+
+  ErrorOr<BitcodeSymbolTable> SymtabOrErr =
+      readBitcodeSymbolTable(MemoryBufferRef(Mem.str(), "test"));
+  ASSERT_TRUE(bool(SymtabOrErr));
+  const BitcodeSymbolTable &Symtab = *SymtabOrErr;
+  EXPECT_EQ("symtab.c", Symtab.SourceFileName);
+  EXPECT_FALSE(Symtab.HasModuleAsm);
+
+  // Functions, then variables, then aliases, like the Module lists them.
+  auto &GVs = Symtab.GlobalValues;
+  ASSERT_EQ(8u, GVs.size());
+  const char *Names[] = {"func", "decl",     "var",   "cst",
+                         "ext",  "internal", "alias", "chain"};
+  for (unsigned I = 0; I != GVs.size(); ++I)
+    EXPECT_EQ(Names[I], GVs[I].Name);
+
+  EXPECT_EQ(GlobalValue::LinkOnceODRLinkage, GVs[0].Linkage);
+  EXPECT_EQ(GlobalValue::UnnamedAddr::Global, GVs[0].UnnamedAddr);
+  EXPECT_EQ("c", GVs[0].Comdat);
+  EXPECT_FALSE(GVs[0].IsDeclaration);
+  EXPECT_TRUE(GVs[1].IsDeclaration);
+  EXPECT_EQ(unsigned(CallingConv::X86_StdCall), GVs[1].CallingConv);
+
+  EXPECT_TRUE(GVs[2].IsVariable);
+  EXPECT_FALSE(GVs[2].IsConstant);
+  EXPECT_EQ("c", GVs[2].Comdat);
+  EXPECT_TRUE(GVs[3].IsConstant);
+  EXPECT_EQ(GlobalValue::HiddenVisibility, GVs[3].Visibility);
+  EXPECT_EQ("sec", GVs[3].Section);
+  EXPECT_TRUE(GVs[4].IsDeclaration);
+  EXPECT_TRUE(GVs[4].IsThreadLocal);
+  EXPECT_EQ(GlobalValue::InternalLinkage, GVs[5].Linkage);
+
+  // Aliases take the comdat of their base object.
+  EXPECT_FALSE(GVs[6].IsVariable);
+  EXPECT_EQ(GlobalValue::WeakAnyLinkage, GVs[6].Linkage);
+  EXPECT_EQ("c", GVs[6].Comdat);
+  EXPECT_EQ("c", GVs[7].Comdat);
+}
+
 } // end namespace
@@ -71,6 +71,26 @@ TEST(BitstreamReaderTest, AtEndOfStreamEmpty) {
   EXPECT_TRUE(Cursor.AtEndOfStream());
 }
 
+TEST(BitstreamReaderTest, ReadAcrossPartialWord) {
+  // Twelve bytes: one full word on 64-bit hosts, then a partial one.
+  uint8_t Bytes[12] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                       0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b};
+  BitstreamReader Reader(std::begin(Bytes), std::end(Bytes));
+  BitstreamCursor Cursor(Reader);
+
+  for (unsigned I = 0, E = sizeof(Bytes); I != E; ++I) {
+    EXPECT_FALSE(Cursor.AtEndOfStream());
+    EXPECT_EQ(I, Cursor.Read(8));
+  }
+  EXPECT_TRUE(Cursor.AtEndOfStream());
+
+  // Fields straddling the word boundary.
+  Cursor.JumpToBit(60);
+  EXPECT_EQ(0x080u, Cursor.Read(12));
+  EXPECT_EQ(0x0b0a09u, Cursor.Read(24));
+  EXPECT_TRUE(Cursor.AtEndOfStream());
+}
+
 TEST(BitstreamReaderTest, getCurrentByteNo) {
   uint8_t Bytes[] = {0x00, 0x01, 0x02, 0x03};
   BitstreamReader Reader(std::begin(Bytes), std::end(Bytes));
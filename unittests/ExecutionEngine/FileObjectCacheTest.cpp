@@ -0,0 +1,101 @@
+//===- FileObjectCacheTest.cpp - Unit tests for FileObjectCache -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/FileObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(FileObjectCacheTest, RoundTrip) {
+  SmallString<128> CacheDir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("objcache", CacheDir));
+
+  LLVMContext Context;
+  Module M("test", Context);
+  M.getOrInsertFunction("f", FunctionType::get(Type::getVoidTy(Context),
+                                               false));
+
+  {
+    FileObjectCache Cache(CacheDir, "x86_64-unknown-linux-gnu,generic");
+    Cache.setPruningInterval(-1);
+    EXPECT_EQ(nullptr, Cache.getObject(&M));
+    Cache.notifyObjectCompiled(
+        &M, MemoryBufferRef("object bytes", "test"));
+  }
+
+  // A new cache on the same directory, e.g. in another process, finds it.
+  FileObjectCache Cache(CacheDir, "x86_64-unknown-linux-gnu,generic");
+  Cache.setPruningInterval(-1);
+  std::unique_ptr<MemoryBuffer> Obj = Cache.getObject(&M);
+  ASSERT_NE(nullptr, Obj);
+  EXPECT_EQ("object bytes", Obj->getBuffer());
+  std::string FirstEntryPath = Cache.getEntryPath(M);
+
+  // A different target or different IR misses.
+  FileObjectCache OtherTarget(CacheDir, "x86_64-unknown-linux-gnu,haswell");
+  EXPECT_EQ(nullptr, OtherTarget.getObject(&M));
+  M.getOrInsertFunction("g", FunctionType::get(Type::getVoidTy(Context),
+                                               false));
+  EXPECT_EQ(nullptr, Cache.getObject(&M));
+
+  std::string EntryPath = Cache.getEntryPath(M);
+  Cache.notifyObjectCompiled(&M, MemoryBufferRef("other bytes", "test"));
+  EXPECT_TRUE(sys::fs::exists(EntryPath));
+
+  sys::fs::remove(FirstEntryPath);
+  sys::fs::remove(EntryPath);
+  sys::fs::remove(CacheDir);
+}
+
+TEST(FileObjectCacheTest, Prune) {
+  SmallString<128> CacheDir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("objcache", CacheDir));
+
+  LLVMContext Context;
+  Module M("test", Context);
+  M.getOrInsertFunction("f", FunctionType::get(Type::getVoidTy(Context),
+                                               false));
+
+  // An entry that has not been used for two weeks.
+  SmallString<128> OldEntryPath(CacheDir);
+  sys::path::append(OldEntryPath, "llvmobj-old.o");
+  {
+    int FD;
+    ASSERT_FALSE(sys::fs::openFileForWrite(OldEntryPath, FD, sys::fs::F_None));
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << "old bytes";
+    OS.flush();
+    ASSERT_FALSE(sys::fs::setLastModificationAndAccessTime(
+        FD, std::chrono::system_clock::now() - std::chrono::hours(24 * 14)));
+  }
+
+  // Writing an entry prunes the directory with the default policy.
+  FileObjectCache Cache(CacheDir, "x86_64-unknown-linux-gnu,generic");
+  std::string EntryPath = Cache.getEntryPath(M);
+  Cache.notifyObjectCompiled(&M, MemoryBufferRef("object bytes", "test"));
+  EXPECT_TRUE(sys::fs::exists(EntryPath));
+  EXPECT_FALSE(sys::fs::exists(OldEntryPath));
+
+  SmallString<128> TimestampPath(CacheDir);
+  sys::path::append(TimestampPath, "llvmcache.timestamp");
+  sys::fs::remove(TimestampPath);
+  sys::fs::remove(EntryPath);
+  sys::fs::remove(CacheDir);
+}
+
+} // end anonymous namespace
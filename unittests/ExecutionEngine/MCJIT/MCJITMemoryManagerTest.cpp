@@ -47,6 +47,36 @@ TEST(MCJITMemoryManagerTest, BasicAllocations) {
   EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
 }
 
+TEST(MCJITMemoryManagerTest, SlabAllocations) {
+  const uintptr_t SlabSize = 0x100000;
+  std::unique_ptr<SectionMemoryManager> MemMgr(
+      new SectionMemoryManager(SlabSize));
+
+  // Code from several "objects", finalized in between, is packed into the
+  // first slab.
+  uint8_t *code1 = MemMgr->allocateCodeSection(256, 0, 1, "");
+  uint8_t *data1 = MemMgr->allocateDataSection(256, 0, 2, "", false);
+  code1[0] = 1;
+  data1[0] = 1;
+  std::string Error;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+
+  uint8_t *code2 = MemMgr->allocateCodeSection(256, 0, 3, "");
+  uint8_t *code3 = MemMgr->allocateCodeSection(256, 0, 4, "");
+  ASSERT_NE((uint8_t*)nullptr, code2);
+  ASSERT_NE((uint8_t*)nullptr, code3);
+  code2[0] = 2;
+  code3[0] = 3;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+
+  EXPECT_LT((uintptr_t)code1, (uintptr_t)code2);
+  EXPECT_LT((uintptr_t)code3 - (uintptr_t)code1, SlabSize);
+  EXPECT_EQ(1, code1[0]);
+  EXPECT_EQ(2, code2[0]);
+  EXPECT_EQ(3, code3[0]);
+  EXPECT_EQ(1, data1[0]);
+}
+
 TEST(MCJITMemoryManagerTest, LargeAllocations) {
   std::unique_ptr<SectionMemoryManager> MemMgr(new SectionMemoryManager());
 
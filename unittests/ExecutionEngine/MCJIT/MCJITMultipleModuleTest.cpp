@@ -420,4 +420,49 @@ TEST_F(MCJITMultipleModuleTest, FindFunctionNamed_test) {
   EXPECT_EQ(FB1, TheJIT->FindFunctionNamed(FB1->getName().data()));
 }
 
+// Module A { Function FA },
+// Module B { Extern FA, Function FB which calls FA },
+// Module C { Extern FA, Function FC which calls FA },
+// each in its own LLVMContext, so that finalizeObject may compile them
+// concurrently. Execute FC, FB, FA.
+TEST_F(MCJITMultipleModuleTest, three_module_three_context_case) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  LLVMContext Contexts[3];
+  std::unique_ptr<Module> Ms[3];
+  const char *Names[3] = {"FA", "FB", "FC"};
+  for (unsigned I = 0; I != 3; ++I) {
+    LLVMContext &C = Contexts[I];
+    Ms[I] = llvm::make_unique<Module>(Names[I], C);
+    Ms[I]->setTargetTriple(Triple::normalize(BuilderTriple));
+    Type *Int32Ty = Type::getInt32Ty(C);
+    FunctionType *FTy = FunctionType::get(Int32Ty, {Int32Ty, Int32Ty}, false);
+    Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage, Names[I],
+                                   Ms[I].get());
+    IRBuilder<> B(BasicBlock::Create(C, "entry", F));
+    Value *Args[2] = {&*F->arg_begin(), &*std::next(F->arg_begin())};
+    if (I == 0) {
+      B.CreateRet(B.CreateAdd(Args[0], Args[1]));
+      continue;
+    }
+    Function *FA = Function::Create(FTy, GlobalValue::ExternalLinkage, "FA",
+                                    Ms[I].get());
+    B.CreateRet(B.CreateCall(FA, Args));
+  }
+
+  createJIT(std::move(Ms[0]));
+  // Use a thread per context whatever the number of cores of the host.
+  TheJIT->setCompileThreads(3);
+  TheJIT->addModule(std::move(Ms[1]));
+  TheJIT->addModule(std::move(Ms[2]));
+  TheJIT->finalizeObject();
+
+  checkAdd(TheJIT->getFunctionAddress("FC"));
+  checkAdd(TheJIT->getFunctionAddress("FB"));
+  checkAdd(TheJIT->getFunctionAddress("FA"));
+
+  // The modules must go before their contexts.
+  TheJIT.reset();
+}
+
 } // end anonymous namespace
@@ -9,6 +9,9 @@
 
 #include "OrcTestCommon.h"
 #include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
+#include "llvm/ExecutionEngine/Orc/NullResolver.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Module.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -70,4 +73,86 @@ TEST(CompileOnDemandLayerTest, FindSymbol) {
   EXPECT_TRUE(!!Sym) << "CompileOnDemand::findSymbol should call findSymbol in "
                         "the base layer.";
 }
+
+class GrowingCallbackManager : public orc::JITCompileCallbackManager {
+public:
+  GrowingCallbackManager() : JITCompileCallbackManager(0) {}
+
+  void grow() override { AvailableTrampolines.push_back(++NextTrampoline); }
+
+private:
+  JITTargetAddress NextTrampoline = 0x1000;
+};
+
+class RecordingStubsManager : public orc::IndirectStubsManager {
+public:
+  RecordingStubsManager(StringMap<JITTargetAddress> &Pointers)
+      : Pointers(Pointers) {}
+
+  Error createStub(StringRef StubName, JITTargetAddress InitAddr,
+                   JITSymbolFlags Flags) override {
+    Pointers[StubName] = InitAddr;
+    return Error::success();
+  }
+
+  Error createStubs(const StubInitsMap &StubInits) override {
+    for (auto &Entry : StubInits)
+      Pointers[Entry.first()] = Entry.second.first;
+    return Error::success();
+  }
+
+  JITSymbol findStub(StringRef Name, bool ExportedStubsOnly) override {
+    if (!Pointers.count(Name))
+      return nullptr;
+    return JITSymbol(1, JITSymbolFlags::Exported);
+  }
+
+  JITSymbol findPointer(StringRef Name) override {
+    llvm_unreachable("Not implemented");
+  }
+
+  Error updatePointer(StringRef Name, JITTargetAddress NewAddr) override {
+    Pointers[Name] = NewAddr;
+    return Error::success();
+  }
+
+private:
+  StringMap<JITTargetAddress> &Pointers;
+};
+
+TEST(CompileOnDemandLayerTest, UpdatePointer) {
+  // The layer owns the module, so the context has to outlive it.
+  LLVMContext Context;
+  auto MockBaseLayer = createMockBaseLayer<int>(
+      DoNothingAndReturn<int>(0), DoNothingAndReturn<void>(),
+      DoNothingAndReturn<JITSymbol>(nullptr),
+      DoNothingAndReturn<JITSymbol>(nullptr));
+
+  typedef decltype(MockBaseLayer) MockBaseLayerT;
+  GrowingCallbackManager CallbackMgr;
+  StringMap<JITTargetAddress> Pointers;
+
+  llvm::orc::CompileOnDemandLayer<MockBaseLayerT> COD(
+      MockBaseLayer, [](Function &F) { return std::set<Function *>{&F}; },
+      CallbackMgr,
+      [&] { return llvm::make_unique<RecordingStubsManager>(Pointers); },
+      true);
+
+  auto M = llvm::make_unique<Module>("", Context);
+  Function *F = Function::Create(
+      FunctionType::get(Type::getVoidTy(Context), false),
+      GlobalValue::ExternalLinkage, "foo", M.get());
+  ReturnInst::Create(Context, BasicBlock::Create(Context, "entry", F));
+
+  std::vector<std::unique_ptr<Module>> Ms;
+  Ms.push_back(std::move(M));
+  COD.addModuleSet(std::move(Ms), llvm::make_unique<SectionMemoryManager>(),
+                   std::unique_ptr<JITSymbolResolver>(new NullResolver()));
+
+  ASSERT_EQ(1u, Pointers.count("foo"));
+  EXPECT_TRUE(COD.updatePointer("foo", 0x42))
+      << "CompileOnDemand::updatePointer should find the stub for foo";
+  EXPECT_EQ(0x42u, Pointers["foo"]);
+  EXPECT_FALSE(COD.updatePointer("bar", 0x43));
+}
 }
@@ -0,0 +1,121 @@
+//===- OrcRemoteTargetTest.cpp - Unit tests for the remote target client --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "QueueChannel.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/Orc/OrcABISupport.h"
+#include "llvm/ExecutionEngine/Orc/OrcRemoteTargetClient.h"
+#include "llvm/ExecutionEngine/Orc/OrcRemoteTargetServer.h"
+#include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+using namespace llvm::orc::remote;
+
+namespace {
+
+class OrcRemoteTargetExecutionTest : public testing::Test,
+                                     public OrcExecutionTest {};
+
+typedef OrcRemoteTargetClient<RPCByteChannel> Client;
+typedef OrcRemoteTargetServer<RPCByteChannel, OrcX86_64_SysV> Server;
+
+// Serve requests on the channel until the client terminates the session.
+static void runServer(RPCByteChannel &Channel) {
+  auto SymbolLookup = [](const std::string &Name) {
+    return RTDyldMemoryManager::getSymbolAddressInProcess(Name);
+  };
+  auto RegisterEHFrames = [](uint8_t *Addr, uint32_t Size) {
+    RTDyldMemoryManager::registerEHFramesInProcess(Addr, Size);
+  };
+  auto DeregisterEHFrames = [](uint8_t *Addr, uint32_t Size) {
+    RTDyldMemoryManager::deregisterEHFramesInProcess(Addr, Size);
+  };
+  Server S(Channel, SymbolLookup, RegisterEHFrames, DeregisterEHFrames);
+
+  while (true) {
+    uint32_t RawId;
+    if (auto Err = S.startReceivingFunction(Channel, RawId)) {
+      ADD_FAILURE() << toString(std::move(Err));
+      return;
+    }
+    auto Id = static_cast<Server::JITFuncId>(RawId);
+    Error Err = Id == Server::TerminateSessionId
+                    ? S.handleTerminateSession()
+                    : S.handleKnownFunction(Id);
+    if (Err) {
+      ADD_FAILURE() << toString(std::move(Err));
+      return;
+    }
+    if (Id == Server::TerminateSessionId)
+      return;
+  }
+}
+
+// Finalizing a remote memory manager queues the section writes, the
+// permission changes and the EH frame registration, then flushes them in one
+// batch. The code must have reached the target intact for the call to work.
+TEST_F(OrcRemoteTargetExecutionTest, FinalizeFlushesPendingCalls) {
+  if (!TM || TM->getTargetTriple().getArch() != Triple::x86_64)
+    return;
+
+  Queue Q1, Q2;
+  QueueChannel ClientChannel(Q1, Q2);
+  QueueChannel ServerChannel(Q2, Q1);
+  std::thread ServerThread(runServer, std::ref(ServerChannel));
+
+  {
+    auto RemoteOrErr = Client::Create(ClientChannel);
+    ASSERT_TRUE(!!RemoteOrErr) << toString(RemoteOrErr.takeError());
+    Client &Remote = *RemoteOrErr;
+
+    ModuleBuilder MB(Context, TM->getTargetTriple().str(), "dummy");
+    {
+      MB.getModule()->setDataLayout(TM->createDataLayout());
+      Function *Foo = MB.createFunctionDecl<int32_t(void)>("foo");
+      BasicBlock *Entry = BasicBlock::Create(Context, "entry", Foo);
+      IRBuilder<> Builder(Entry);
+      Builder.CreateRet(ConstantInt::getSigned(Builder.getInt32Ty(), 42));
+    }
+    auto Obj = SimpleCompiler(*TM)(*MB.getModule());
+    std::vector<object::ObjectFile *> ObjSet;
+    ObjSet.push_back(Obj.getBinary());
+
+    auto Resolver = createLambdaResolver(
+        [](const std::string &Name) { return JITSymbol(nullptr); },
+        [](const std::string &Name) { return JITSymbol(nullptr); });
+
+    {
+      std::unique_ptr<Client::RCMemoryManager> MemMgr;
+      EXPECT_FALSE(!!Remote.createRemoteMemoryManager(MemMgr));
+
+      ObjectLinkingLayer<> ObjLayer;
+      auto H = ObjLayer.addObjectSet(std::move(ObjSet), MemMgr.get(),
+                                     &*Resolver);
+      ObjLayer.emitAndFinalize(H);
+      JITTargetAddress FooAddr =
+          ObjLayer.findSymbolIn(H, "foo", true).getAddress();
+      EXPECT_NE(0u, FooAddr);
+
+      auto ResultOrErr = Remote.callIntVoid(FooAddr);
+      ASSERT_TRUE(!!ResultOrErr) << toString(ResultOrErr.takeError());
+      EXPECT_EQ(42, *ResultOrErr);
+    }
+
+    EXPECT_FALSE(!!Remote.terminateSession());
+  }
+
+  ServerThread.join();
+}
+
+} // end anonymous namespace
@@ -0,0 +1,70 @@
+//===----------------------- Queue channel for Orc tests --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// An in-memory RPC channel for the Orc unit tests.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_UNITTESTS_EXECUTIONENGINE_ORC_QUEUECHANNEL_H
+#define LLVM_UNITTESTS_EXECUTIONENGINE_ORC_QUEUECHANNEL_H
+
+#include "llvm/ExecutionEngine/Orc/RPCByteChannel.h"
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace llvm {
+
+class Queue : public std::queue<char> {
+public:
+  std::mutex &getLock() { return Lock; }
+
+private:
+  std::mutex Lock;
+};
+
+class QueueChannel : public orc::remote::RPCByteChannel {
+public:
+  QueueChannel(Queue &InQueue, Queue &OutQueue)
+      : InQueue(InQueue), OutQueue(OutQueue) {}
+
+  Error readBytes(char *Dst, unsigned Size) override {
+    while (Size != 0) {
+      // If there's nothing to read then yield.
+      while (InQueue.empty())
+        std::this_thread::yield();
+
+      // Lock the channel and read what we can.
+      std::lock_guard<std::mutex> Lock(InQueue.getLock());
+      while (!InQueue.empty() && Size) {
+        *Dst++ = InQueue.front();
+        --Size;
+        InQueue.pop();
+      }
+    }
+    return Error::success();
+  }
+
+  Error appendBytes(const char *Src, unsigned Size) override {
+    std::lock_guard<std::mutex> Lock(OutQueue.getLock());
+    while (Size--)
+      OutQueue.push(*Src++);
+    return Error::success();
+  }
+
+  Error send() override { return Error::success(); }
+
+private:
+  Queue &InQueue;
+  Queue &OutQueue;
+};
+
+} // end namespace llvm
+
+#endif
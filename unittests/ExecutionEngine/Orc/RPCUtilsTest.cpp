@@ -7,60 +7,14 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "llvm/ExecutionEngine/Orc/RPCByteChannel.h"
+#include "QueueChannel.h"
 #include "llvm/ExecutionEngine/Orc/RPCUtils.h"
 #include "gtest/gtest.h"
 
-#include <queue>
-
 using namespace llvm;
 using namespace llvm::orc;
 using namespace llvm::orc::remote;
 
-class Queue : public std::queue<char> {
-public:
-  std::mutex &getLock() { return Lock; }
-
-private:
-  std::mutex Lock;
-};
-
-class QueueChannel : public RPCByteChannel {
-public:
-  QueueChannel(Queue &InQueue, Queue &OutQueue)
-      : InQueue(InQueue), OutQueue(OutQueue) {}
-
-  Error readBytes(char *Dst, unsigned Size) override {
-    while (Size != 0) {
-      // If there's nothing to read then yield.
-      while (InQueue.empty())
-        std::this_thread::yield();
-
-      // Lock the channel and read what we can.
-      std::lock_guard<std::mutex> Lock(InQueue.getLock());
-      while (!InQueue.empty() && Size) {
-        *Dst++ = InQueue.front();
-        --Size;
-        InQueue.pop();
-      }
-    }
-    return Error::success();
-  }
-
-  Error appendBytes(const char *Src, unsigned Size) override {
-    std::lock_guard<std::mutex> Lock(OutQueue.getLock());
-    while (Size--)
-      OutQueue.push(*Src++);
-    return Error::success();
-  }
-
-  Error send() override { return Error::success(); }
-
-private:
-  Queue &InQueue;
-  Queue &OutQueue;
-};
-
 class DummyRPC : public testing::Test, public RPC<QueueChannel> {
 public:
   enum FuncId : uint32_t {
@@ -183,6 +137,58 @@ TEST_F(DummyRPC, TestSerialization) {
   EXPECT_FALSE(!!Err) << "Remote void function failed to execute.";
 }
 
+TEST_F(DummyRPC, TestBatchedCalls) {
+  Queue Q1, Q2;
+  QueueChannel C1(Q1, Q2);
+  QueueChannel C2(Q2, Q1);
+
+  // Queue several calls without waiting for any of them.
+  auto Res1OrErr = appendCallNB<IntInt>(C1, 1);
+  EXPECT_TRUE(!!Res1OrErr) << "First batched call failed";
+  auto Res2OrErr = appendCallNB<VoidBool>(C1, true);
+  EXPECT_TRUE(!!Res2OrErr) << "Second batched call failed";
+  auto Res3OrErr = appendCallNB<IntInt>(C1, 3);
+  EXPECT_TRUE(!!Res3OrErr) << "Third batched call failed";
+
+  // The other end sees the calls in order.
+  {
+    auto EC = expect<IntInt>(C2, [&](int32_t I) -> Expected<int32_t> {
+      EXPECT_EQ(I, 1) << "First batched call has the wrong argument";
+      return 2 * I;
+    });
+    EXPECT_FALSE(EC) << "First batched expect failed";
+  }
+  {
+    auto EC = expect<VoidBool>(C2, [&](bool &B) {
+      EXPECT_EQ(B, true) << "Second batched call has the wrong argument";
+      return Error::success();
+    });
+    EXPECT_FALSE(EC) << "Second batched expect failed";
+  }
+  {
+    auto EC = expect<IntInt>(C2, [&](int32_t I) -> Expected<int32_t> {
+      EXPECT_EQ(I, 3) << "Third batched call has the wrong argument";
+      return 2 * I;
+    });
+    EXPECT_FALSE(EC) << "Third batched expect failed";
+  }
+
+  {
+    // Collect all of the results at once.
+    auto EC = sendAndWaitForAllResults(C1);
+    EXPECT_FALSE(EC) << "Could not read batched results.";
+  }
+
+  auto Val1 = Res1OrErr->get();
+  EXPECT_TRUE(!!Val1) << "First batched call failed to execute.";
+  EXPECT_EQ(*Val1, 2) << "First batched call returned the wrong value.";
+  auto Err2 = Res2OrErr->get();
+  EXPECT_FALSE(!!Err2) << "Second batched call failed to execute.";
+  auto Val3 = Res3OrErr->get();
+  EXPECT_TRUE(!!Val3) << "Third batched call failed to execute.";
+  EXPECT_EQ(*Val3, 6) << "Third batched call returned the wrong value.";
+}
+
 // Test the synchronous call API.
 // FIXME: Re-enable once deadlock encountered on S390 has been debugged / fixed,
 //        see http://lab.llvm.org:8011/builders/clang-s390x-linux/builds/3459
@@ -53,4 +53,36 @@ TEST(Attributes, Ordering) {
   EXPECT_NE(SetA, SetB);
 }
 
+TEST(Attributes, IndexLookup) {
+  LLVMContext C;
+
+  AttributeSet ASs[] = {
+    AttributeSet::get(C, AttributeSet::FunctionIndex, Attribute::NoUnwind),
+    AttributeSet::get(C, AttributeSet::ReturnIndex, Attribute::NoAlias),
+    AttributeSet::get(C, 1, Attribute::NonNull),
+    AttributeSet::get(C, 3, {Attribute::NoCapture, Attribute::ReadOnly})
+  };
+  AttributeSet AS = AttributeSet::get(C, ASs);
+  AS = AS.addDereferenceableAttr(C, 5, 8);
+
+  EXPECT_TRUE(AS.hasFnAttribute(Attribute::NoUnwind));
+  EXPECT_TRUE(AS.hasAttribute(AttributeSet::ReturnIndex, Attribute::NoAlias));
+  EXPECT_TRUE(AS.hasAttribute(1, Attribute::NonNull));
+  EXPECT_FALSE(AS.hasAttributes(2));
+  EXPECT_TRUE(AS.hasAttribute(3, Attribute::NoCapture));
+  EXPECT_TRUE(AS.hasAttribute(3, Attribute::ReadOnly));
+  EXPECT_FALSE(AS.hasAttribute(3, Attribute::NonNull));
+  EXPECT_FALSE(AS.hasAttributes(4));
+  EXPECT_EQ(8u, AS.getDereferenceableBytes(5));
+  EXPECT_EQ(0u, AS.getDereferenceableBytes(3));
+  EXPECT_FALSE(AS.hasAttributes(6));
+
+  unsigned Index;
+  EXPECT_TRUE(AS.hasAttrSomewhere(Attribute::NoCapture, &Index));
+  EXPECT_EQ(3u, Index);
+  EXPECT_TRUE(AS.hasAttrSomewhere(Attribute::Dereferenceable, &Index));
+  EXPECT_EQ(5u, Index);
+  EXPECT_FALSE(AS.hasAttrSomewhere(Attribute::Returned));
+}
+
 } // end anonymous namespace
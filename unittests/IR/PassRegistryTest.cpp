@@ -0,0 +1,98 @@
+//===- llvm/unittest/IR/PassRegistryTest.cpp - PassRegistry tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/PassRegistry.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/PassSupport.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+// Enough passes to force the lookup tables to grow a few times.
+const unsigned NumPasses = 2000;
+
+struct CountingListener : public PassRegistrationListener {
+  unsigned Count = 0;
+  void passEnumerate(const PassInfo *) override { ++Count; }
+};
+
+TEST(PassRegistryTest, LookupAfterGrowth) {
+  PassRegistry Registry;
+  std::vector<char> IDs(NumPasses);
+  std::vector<std::string> Args;
+  for (unsigned i = 0; i != NumPasses; ++i)
+    Args.push_back("pass-" + std::to_string(i));
+
+  for (unsigned i = 0; i != NumPasses; ++i)
+    Registry.registerPass(*new PassInfo("Test pass", Args[i], &IDs[i], nullptr,
+                                        false, false),
+                          /*ShouldFree=*/true);
+
+  for (unsigned i = 0; i != NumPasses; ++i) {
+    const PassInfo *PI = Registry.getPassInfo(&IDs[i]);
+    ASSERT_TRUE(PI);
+    EXPECT_EQ(Args[i], PI->getPassArgument());
+    EXPECT_EQ(PI, Registry.getPassInfo(Args[i]));
+  }
+  char Unregistered;
+  EXPECT_EQ(nullptr, Registry.getPassInfo(&Unregistered));
+  EXPECT_EQ(nullptr, Registry.getPassInfo(StringRef("no-such-pass")));
+
+  CountingListener L;
+  Registry.enumerateWith(&L);
+  EXPECT_EQ(NumPasses, L.Count);
+}
+
+TEST(PassRegistryTest, LastArgumentWins) {
+  PassRegistry Registry;
+  char ID1, ID2;
+  PassInfo PI1("First", "same-arg", &ID1, nullptr, false, false);
+  PassInfo PI2("Second", "same-arg", &ID2, nullptr, false, false);
+  Registry.registerPass(PI1);
+  Registry.registerPass(PI2);
+  EXPECT_EQ(&PI1, Registry.getPassInfo(&ID1));
+  EXPECT_EQ(&PI2, Registry.getPassInfo(&ID2));
+  EXPECT_EQ(&PI2, Registry.getPassInfo(StringRef("same-arg")));
+}
+
+#if LLVM_ENABLE_THREADS != 0
+TEST(PassRegistryTest, ConcurrentLookup) {
+  PassRegistry Registry;
+  std::vector<char> IDs(NumPasses);
+  std::vector<std::string> Args;
+  std::vector<std::unique_ptr<PassInfo>> Infos;
+  for (unsigned i = 0; i != NumPasses; ++i)
+    Args.push_back("pass-" + std::to_string(i));
+  for (unsigned i = 0; i != NumPasses; ++i)
+    Infos.push_back(make_unique<PassInfo>("Test pass", Args[i], &IDs[i],
+                                          nullptr, false, false));
+
+  // Look up each pass while the tables grow underneath; once a registration
+  // has returned, the pass must stay visible.
+  std::thread Reader([&] {
+    for (unsigned i = 0; i != NumPasses; ++i) {
+      const PassInfo *PI;
+      while (!(PI = Registry.getPassInfo(&IDs[i])))
+        std::this_thread::yield();
+      EXPECT_EQ(Infos[i].get(), PI);
+      EXPECT_EQ(Infos[i / 2].get(), Registry.getPassInfo(&IDs[i / 2]));
+      EXPECT_EQ(Infos[i / 2].get(), Registry.getPassInfo(Args[i / 2]));
+    }
+  });
+  for (unsigned i = 0; i != NumPasses; ++i)
+    Registry.registerPass(*Infos[i]);
+  Reader.join();
+}
+#endif
+
+} // end anonymous namespace
@@ -109,4 +109,50 @@ TEST(UseTest, reverse) {
   ASSERT_EQ(8u, I);
 }
 
+TEST(UseTest, replaceAllUsesWithOrder) {
+  LLVMContext C;
+
+  const char *ModuleString =
+      "@a = global i32 0\n"
+      "@b = global i32 0\n"
+      "define void @f(i32 %x, i32 %y) {\n"
+      "entry:\n"
+      "  %v0 = load i32, i32* @a\n"
+      "  %v1 = load i32, i32* @a\n"
+      "  %v2 = load i32, i32* getelementptr (i32, i32* @a, i64 1)\n"
+      "  %v3 = load i32, i32* @a\n"
+      "  %w0 = load i32, i32* @b\n"
+      "  ret void\n"
+      "}\n";
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(ModuleString, Err, C);
+  ASSERT_TRUE(M != nullptr);
+  GlobalVariable *A = M->getGlobalVariable("a");
+  GlobalVariable *B = M->getGlobalVariable("b");
+
+  // Record the users B should end up with if every use of A were moved over
+  // one at a time with Use::set, pushing each onto the front of B's list.
+  std::vector<User *> Expected(B->user_begin(), B->user_end());
+  for (User *U : A->users())
+    Expected.insert(Expected.begin(), U);
+
+  A->replaceAllUsesWith(B);
+  EXPECT_TRUE(A->use_empty());
+
+  // The constant expression was rebuilt around B rather than moved, so it
+  // can't be compared by identity; check its position through its own user.
+  std::vector<User *> Actual(B->user_begin(), B->user_end());
+  ASSERT_EQ(Expected.size(), Actual.size());
+  for (unsigned I = 0, E = Actual.size(); I != E; ++I) {
+    if (isa<Constant>(Actual[I])) {
+      EXPECT_TRUE(isa<Constant>(Expected[I]));
+      auto *GEP = cast<Constant>(Actual[I]);
+      ASSERT_TRUE(GEP->hasOneUse());
+      EXPECT_EQ("v2", GEP->user_back()->getName());
+      continue;
+    }
+    EXPECT_EQ(Expected[I], Actual[I]);
+  }
+}
+
 } // end anonymous namespace
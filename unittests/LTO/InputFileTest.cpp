@@ -0,0 +1,110 @@
+//===- InputFileTest.cpp - Unit tests for LTO input files -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/LTO/LTO.h"
+#include "llvm/Object/IRObjectFile.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::lto;
+
+namespace {
+
+void writeModule(StringRef Assembly, SmallVectorImpl<char> &Buffer) {
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(Assembly, Err, Context);
+  ASSERT_TRUE(M != nullptr) << Err.getMessage().str();
+  raw_svector_ostream OS(Buffer);
+  WriteBitcodeToFile(M.get(), OS);
+}
+
+// The symbols the gold plugin reads from the module-level bitcode records
+// must be the ones an InputFile lists, with the same properties.
+TEST(InputFileTest, LinkerSymbolsMatchInputFile) {
+  SmallString<1024> Mem;
+  writeModule("target triple = \"x86_64-unknown-linux-gnu\"\n"
+              "$c = comdat any\n"
+              "@def = global i32 0\n"
+              "@common = common global i32 0\n"
+              "@weak = weak global i32 1, comdat($c)\n"
+              "@hidden = hidden global i32 2\n"
+              "@protected = protected constant i32 3\n"
+              "@undef = external global i32\n"
+              "@extern_weak = extern_weak global i32\n"
+              "@internal = internal global i32 4\n"
+              "@tls = thread_local global i32 5\n"
+              "@alias = alias i32, i32* @def\n"
+              "@hidden_alias = hidden alias i32, i32* @weak\n"
+              "define linkonce_odr void @odr() unnamed_addr {\n"
+              "  ret void\n"
+              "}\n"
+              "define weak_odr hidden void @weak_hidden() comdat($c) {\n"
+              "  ret void\n"
+              "}\n"
+              "declare void @undef_func()\n",
+              Mem);
+  MemoryBufferRef Buffer(Mem.str(), "test");
+
+  std::string SourceFileName;
+  ErrorOr<std::vector<object::IRSymbol>> SymsOrErr =
+      object::IRObjectFile::readLinkerSymbols(Buffer, SourceFileName);
+  ASSERT_TRUE(bool(SymsOrErr));
+  std::vector<object::IRSymbol> &Syms = *SymsOrErr;
+
+  Expected<std::unique_ptr<InputFile>> ObjOrErr = InputFile::create(Buffer);
+  ASSERT_TRUE(bool(ObjOrErr)) << toString(ObjOrErr.takeError());
+  InputFile &Obj = **ObjOrErr;
+  EXPECT_EQ(Obj.getSourceFileName(), SourceFileName);
+
+  unsigned I = 0;
+  for (const InputFile::Symbol &ObjSym : Obj.symbols()) {
+    ASSERT_LT(I, Syms.size());
+    const object::IRSymbol &Sym = Syms[I++];
+    SCOPED_TRACE(Sym.Name);
+    EXPECT_EQ(ObjSym.getName(), Sym.Name);
+    EXPECT_EQ(ObjSym.getFlags(), Sym.Flags);
+    EXPECT_EQ(ObjSym.getVisibility(), Sym.Visibility);
+    EXPECT_EQ(ObjSym.canBeOmittedFromSymbolTable(), Sym.CanOmitFromDynSym);
+    Expected<StringRef> ComdatOrErr = ObjSym.getComdat();
+    ASSERT_TRUE(bool(ComdatOrErr)) << toString(ComdatOrErr.takeError());
+    EXPECT_EQ(*ComdatOrErr, Sym.Comdat);
+  }
+  EXPECT_EQ(Syms.size(), I);
+
+  // Spot check the properties that resolution depends on.
+  auto Find = [&](StringRef Name) -> const object::IRSymbol & {
+    for (const object::IRSymbol &Sym : Syms)
+      if (Sym.Name == Name)
+        return Sym;
+    ADD_FAILURE() << "no symbol " << Name.str();
+    return Syms.front();
+  };
+  EXPECT_TRUE(Find("common").Flags & object::BasicSymbolRef::SF_Common);
+  EXPECT_TRUE(Find("weak").Flags & object::BasicSymbolRef::SF_Weak);
+  EXPECT_EQ("c", Find("weak").Comdat);
+  EXPECT_EQ(GlobalValue::HiddenVisibility, Find("hidden").Visibility);
+  EXPECT_EQ(GlobalValue::ProtectedVisibility, Find("protected").Visibility);
+  EXPECT_TRUE(Find("undef").Flags & object::BasicSymbolRef::SF_Undefined);
+  EXPECT_TRUE(Find("extern_weak").Flags & object::BasicSymbolRef::SF_Weak);
+  EXPECT_TRUE(Find("undef_func").Flags & object::BasicSymbolRef::SF_Undefined);
+  EXPECT_TRUE(Find("odr").CanOmitFromDynSym);
+  EXPECT_FALSE(Find("def").CanOmitFromDynSym);
+  for (const object::IRSymbol &Sym : Syms)
+    EXPECT_NE("internal", Sym.Name);
+}
+
+} // end anonymous namespace
@@ -227,6 +227,36 @@ TEST_F(InstrProfTest, test_writer_merge) {
   ASSERT_EQ(0U, R->Counts[1]);
 }
 
+TEST_F(InstrProfTest, test_writer_reuses_merged_record) {
+  // A reader hands out the same record for every function, and the name it
+  // points to only lives until the next one is read.
+  std::string Name = "foo";
+  InstrProfRecord Record(Name, 0x1234, {1, 2});
+  NoError(Writer.addRecord(std::move(Record)));
+  Name = "bar";
+
+  // Merging into a function the writer already has leaves the record alone,
+  // so its counts storage can be reused for the next one.
+  std::string Name2 = "foo";
+  Record.Name = Name2;
+  Record.Hash = 0x1234;
+  Record.Counts.assign({3, 4});
+  const uint64_t *Storage = Record.Counts.data();
+  NoError(Writer.addRecord(std::move(Record)));
+  ASSERT_EQ(2U, Record.Counts.size());
+  ASSERT_EQ(Storage, Record.Counts.data());
+  Name2 = "baz";
+
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  Expected<InstrProfRecord> R = Reader->getInstrProfRecord("foo", 0x1234);
+  ASSERT_TRUE(NoError(R.takeError()));
+  ASSERT_EQ(2U, R->Counts.size());
+  ASSERT_EQ(4U, R->Counts[0]);
+  ASSERT_EQ(6U, R->Counts[1]);
+}
+
 static const char callee1[] = "callee1";
 static const char callee2[] = "callee2";
 static const char callee3[] = "callee3";
@@ -9,6 +9,8 @@
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
@@ -168,6 +170,56 @@ TEST_F(SampleProfTest, roundtrip_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Binary);
 }
 
+TEST_F(SampleProfTest, binary_profile_reads_only_module_functions) {
+  createWriter(SampleProfileFormat::SPF_Binary);
+
+  StringRef FooName("_Z3fooi");
+  FunctionSamples FooSamples;
+  FooSamples.setName(FooName);
+  FooSamples.addTotalSamples(7711);
+  FooSamples.addHeadSamples(610);
+  FooSamples.addBodySamples(1, 0, 610);
+
+  StringRef BarName("_Z3bari");
+  FunctionSamples BarSamples;
+  BarSamples.setName(BarName);
+  BarSamples.addTotalSamples(20301);
+  BarSamples.addHeadSamples(1437);
+  BarSamples.addBodySamples(1, 0, 1437);
+  BarSamples.addCalledTargetSamples(2, 0, FooName, 1000);
+  FunctionSamples &Inlined = BarSamples.functionSamplesAt(LineLocation(3, 0));
+  Inlined.setName(FooName);
+  Inlined.addTotalSamples(300);
+  Inlined.addBodySamples(1, 0, 300);
+
+  StringMap<FunctionSamples> Profiles;
+  Profiles[FooName] = std::move(FooSamples);
+  Profiles[BarName] = std::move(BarSamples);
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  Module M("my_module", Context);
+  Function *Foo =
+      Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                       GlobalValue::ExternalLinkage, FooName, &M);
+  ReturnInst::Create(Context, BasicBlock::Create(Context, "entry", Foo));
+  Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                   GlobalValue::ExternalLinkage, BarName, &M);
+
+  auto Profile = MemoryBuffer::getMemBufferCopy(Data);
+  readProfile(Profile);
+  Reader->collectFuncsToUse(M);
+  ASSERT_TRUE(NoError(Reader->read()));
+
+  // Only the profile of the function defined in the module is read.
+  StringMap<FunctionSamples> &ReadProfiles = Reader->getProfiles();
+  ASSERT_EQ(1u, ReadProfiles.size());
+  FunctionSamples &ReadFooSamples = ReadProfiles[FooName];
+  ASSERT_EQ(7711u, ReadFooSamples.getTotalSamples());
+  ASSERT_EQ(610u, ReadFooSamples.getHeadSamples());
+  ASSERT_EQ(2u, Reader->getSummary().getNumFunctions());
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
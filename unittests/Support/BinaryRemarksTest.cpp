@@ -0,0 +1,119 @@
+//===- unittests/Support/BinaryRemarksTest.cpp ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/BinaryRemarks.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace llvm;
+using namespace llvm::remarks;
+
+namespace {
+
+Remark makeRemark(unsigned N) {
+  Remark R;
+  R.Kind = static_cast<RemarkKind>(N % (unsigned(RemarkKind::LastKind) + 1));
+  R.PassName = "inline";
+  R.RemarkName = N % 2 ? "Inlined" : "NoDefinition";
+  R.FunctionName = "caller";
+  if (N % 3) {
+    R.File = "a.c";
+    R.Line = N;
+    R.Column = 200;
+  }
+  if (N % 4)
+    R.Hotness = uint64_t(1) << N;
+  Argument Callee("Callee", "callee");
+  if (N % 5) {
+    Callee.File = "b.c";
+    Callee.Line = 3 * N;
+    Callee.Column = N % 7;
+  }
+  R.Args.push_back(Callee);
+  R.Args.push_back(Argument("String", " inlined into "));
+  R.Args.push_back(Argument("String", ""));
+  return R;
+}
+
+void expectSameRemark(const Remark &A, const Remark &B) {
+  EXPECT_EQ(A.Kind, B.Kind);
+  EXPECT_EQ(A.PassName, B.PassName);
+  EXPECT_EQ(A.RemarkName, B.RemarkName);
+  EXPECT_EQ(A.FunctionName, B.FunctionName);
+  EXPECT_EQ(A.File, B.File);
+  EXPECT_EQ(A.Line, B.Line);
+  EXPECT_EQ(A.Column, B.Column);
+  EXPECT_EQ(A.Hotness, B.Hotness);
+  EXPECT_EQ(A.Args, B.Args);
+}
+
+TEST(BinaryRemarksTest, RoundTrip) {
+  const unsigned NumRemarks = 40;
+  std::string Buffer;
+  {
+    raw_string_ostream OS(Buffer);
+    // Small blocks, so that the remarks span several of them.
+    BinaryRemarkWriter W(OS, 128);
+    for (unsigned N = 0; N != NumRemarks; ++N)
+      W.write(makeRemark(N));
+  }
+  EXPECT_TRUE(isBinaryRemarkFile(Buffer));
+  EXPECT_GT(Buffer.size(), 128u);
+
+  BinaryRemarkReader Reader(Buffer);
+  Remark R;
+  for (unsigned N = 0; N != NumRemarks; ++N) {
+    Expected<bool> More = Reader.next(R);
+    ASSERT_TRUE(bool(More));
+    ASSERT_TRUE(*More);
+    expectSameRemark(makeRemark(N), R);
+  }
+  Expected<bool> More = Reader.next(R);
+  ASSERT_TRUE(bool(More));
+  EXPECT_FALSE(*More);
+}
+
+TEST(BinaryRemarksTest, Empty) {
+  std::string Buffer;
+  {
+    raw_string_ostream OS(Buffer);
+    BinaryRemarkWriter W(OS);
+  }
+  EXPECT_TRUE(Buffer.empty());
+  EXPECT_FALSE(isBinaryRemarkFile(Buffer));
+  EXPECT_FALSE(isBinaryRemarkFile("--- !Passed\n"));
+}
+
+TEST(BinaryRemarksTest, Malformed) {
+  std::string Buffer;
+  {
+    raw_string_ostream OS(Buffer);
+    BinaryRemarkWriter W(OS);
+    W.write(makeRemark(1));
+  }
+
+  // Every proper prefix of a block is an error, not a crash.
+  for (size_t Size = 1; Size != Buffer.size(); ++Size) {
+    BinaryRemarkReader Reader(StringRef(Buffer).take_front(Size));
+    Remark R;
+    Expected<bool> More = Reader.next(R);
+    EXPECT_FALSE(bool(More)) << "prefix of " << Size << " bytes";
+    if (!More)
+      consumeError(More.takeError());
+  }
+
+  BinaryRemarkReader Reader(StringRef(Buffer).drop_front());
+  Remark R;
+  Expected<bool> More = Reader.next(R);
+  ASSERT_FALSE(bool(More));
+  consumeError(More.takeError());
+}
+
+} // end anonymous namespace
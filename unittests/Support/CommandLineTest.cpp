@@ -505,4 +505,49 @@ TEST(CommandLineTest, GetRegisteredSubcommands) {
   }
 }
 
+TEST(CommandLineTest, RenameOptionBeforeParsing) {
+  cl::ResetCommandLineParser();
+
+  StackSubCommand SC("sc", "Subcommand");
+  StackOption<bool> AllOpt("old-name", cl::sub(*cl::AllSubCommands),
+                           cl::init(false));
+  StackOption<std::string> Input(cl::Positional, cl::sub(SC));
+
+  // Options reach the option maps lazily; renaming one first must still
+  // leave it under its new name only, in every subcommand.
+  AllOpt.setArgStr("new-name");
+
+  const char *args[] = {"prog", "sc", "-new-name", "input"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(4, args, StringRef(), true));
+  EXPECT_TRUE(AllOpt);
+  EXPECT_EQ("input", Input);
+  EXPECT_EQ(0u, cl::getRegisteredOptions(SC).count("old-name"));
+  EXPECT_EQ(0u, cl::getRegisteredOptions().count("old-name"));
+  EXPECT_EQ(1u, cl::getRegisteredOptions().count("new-name"));
+}
+
+// Stands in for the -load option: loading a plugin constructs its options
+// while the command line is being parsed.
+static std::unique_ptr<StackOption<bool>> LateOption;
+
+struct LateOptionLoader {
+  void operator=(const std::string &) {
+    LateOption = llvm::make_unique<StackOption<bool>>("late-option");
+  }
+};
+
+TEST(CommandLineTest, LookupOptionRegisteredDuringParsing) {
+  cl::ResetCommandLineParser();
+
+  cl::opt<LateOptionLoader, false, cl::parser<std::string>> Load("load-late");
+
+  const char *args[] = {"prog", "-load-late=plugin", "-late-option"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(3, args, StringRef(), true));
+  ASSERT_TRUE(LateOption != nullptr);
+  EXPECT_TRUE(*LateOption);
+
+  LateOption.reset();
+  Load.removeArgument();
+}
+
 }  // anonymous namespace
@@ -59,6 +59,38 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+TEST(CompressionTest, ZlibChunked) {
+  // Big enough that several chunks reach back into the previous one's window.
+  std::string Input;
+  for (unsigned I = 0; Input.size() < 200000; ++I)
+    Input += "line " + std::to_string(I % 997) + " of the input\n";
+
+  for (zlib::CompressionLevel Level :
+       {zlib::NoCompression, zlib::BestSpeedCompression,
+        zlib::DefaultCompression, zlib::BestSizeCompression}) {
+    SmallString<32> Compressed;
+    SmallString<32> Uncompressed;
+    EXPECT_EQ(zlib::StatusOK,
+              zlib::compressChunked(Input, Compressed, Level, 40000));
+    EXPECT_EQ(zlib::StatusOK,
+              zlib::uncompress(Compressed, Uncompressed, Input.size()));
+    EXPECT_EQ(Input, Uncompressed);
+
+    // The chunks come out the same no matter how many threads deflate them.
+    SmallString<32> Threaded;
+    EXPECT_EQ(zlib::StatusOK,
+              zlib::compressChunked(Input, Threaded, Level, 40000, 4));
+    EXPECT_EQ(Compressed, Threaded);
+  }
+
+  // Inputs that fit in a single chunk are compressed exactly like compress().
+  SmallString<32> Chunked;
+  SmallString<32> Plain;
+  EXPECT_EQ(zlib::StatusOK, zlib::compressChunked("hello, world!", Chunked));
+  EXPECT_EQ(zlib::StatusOK, zlib::compress("hello, world!", Plain));
+  EXPECT_EQ(Plain, Chunked);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
@@ -164,6 +164,46 @@ TEST_F(RegexTest, NoArgConstructor) {
   EXPECT_TRUE(r1.isValid(Error));
 }
 
+TEST_F(RegexTest, Anchors) {
+  // The answers must not depend on what was matched before, whatever states
+  // the DFA has cached.
+  for (int i = 0; i != 2; ++i) {
+    Regex r1("^foo$|^bar$");
+    EXPECT_TRUE(r1.match("foo"));
+    EXPECT_TRUE(r1.match("bar"));
+    EXPECT_FALSE(r1.match("foobar"));
+    EXPECT_FALSE(r1.match("xfoo"));
+    EXPECT_FALSE(r1.match(""));
+
+    Regex r2("^b", Regex::Newline);
+    EXPECT_TRUE(r2.match("a\nb"));
+    EXPECT_FALSE(r2.match("ab"));
+
+    Regex r3("a$", Regex::Newline);
+    EXPECT_TRUE(r3.match("a\nb"));
+    EXPECT_FALSE(r3.match("ab\nb"));
+
+    Regex r4("[[:<:]]ab[[:>:]]");
+    EXPECT_TRUE(r4.match("x ab y"));
+    EXPECT_TRUE(r4.match("ab"));
+    EXPECT_FALSE(r4.match("xab"));
+    EXPECT_FALSE(r4.match("abx"));
+  }
+}
+
+TEST_F(RegexTest, ManyStates) {
+  // The DFA for this has more states than fit in its cache.
+  Regex r1("a[ab][ab][ab][ab][ab][ab][ab][ab][ab][ab][ab][ab]$");
+  std::string String;
+  unsigned Seed = 1;
+  for (int i = 0; i != 3000; ++i) {
+    Seed = Seed * 1103515245 + 12345;
+    String += (Seed >> 16) & 1 ? 'a' : 'b';
+    if (i >= 12)
+      EXPECT_EQ(String[i - 12] == 'a', r1.match(String));
+  }
+}
+
 TEST_F(RegexTest, MatchInvalid) {
   Regex r1;
   std::string Error;
@@ -0,0 +1,95 @@
+//===- unittests/Support/SizeClassAllocatorTest.cpp -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SizeClassAllocator.h"
+#include "gtest/gtest.h"
+#include <cstdint>
+
+using namespace llvm;
+
+namespace {
+
+TEST(SizeClassAllocatorTest, Recycle) {
+  SizeClassAllocator<> A;
+  void *P1 = A.Allocate(24, 8);
+  void *P2 = A.Allocate(32, 16);
+  EXPECT_NE(P1, P2);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(P1) & 15);
+  EXPECT_EQ(64u, A.getBytesInUse());
+
+  // Any size in the same class reuses the block.
+  A.Deallocate(P1, 24);
+  EXPECT_EQ(32u, A.getBytesInUse());
+  EXPECT_EQ(32u, A.getBytesFree());
+  EXPECT_EQ(P1, A.Allocate(17, 4));
+  EXPECT_EQ(0u, A.getBytesFree());
+
+  // Blocks of other classes do not.
+  A.Deallocate(P2, 32);
+  void *P3 = A.Allocate(33, 8);
+  EXPECT_NE(P2, P3);
+  EXPECT_EQ(P2, A.Allocate(20, 1));
+}
+
+TEST(SizeClassAllocatorTest, SmallAndLarge) {
+  SizeClassAllocator<BumpPtrAllocator, 256> A;
+  // Zero-sized and tiny blocks share the smallest class.
+  void *P1 = A.Allocate(0, 1);
+  A.Deallocate(P1, 0);
+  EXPECT_EQ(P1, A.Allocate(16, 16));
+
+  // Blocks over the limit go straight to the underlying allocator.
+  void *P2 = A.Allocate(1000, 8);
+  EXPECT_EQ(1016u, A.getBytesInUse());
+  A.Deallocate(P2, 1000);
+  EXPECT_EQ(16u, A.getBytesInUse());
+  EXPECT_EQ(0u, A.getBytesFree());
+  EXPECT_EQ(1016u, A.Allocator.getBytesAllocated());
+}
+
+TEST(SizeClassAllocatorTest, OverAligned) {
+  SizeClassAllocator<> A;
+  void *P1 = A.Allocate(40, 8);
+  A.Deallocate(P1, 40);
+
+  // A free block is not reused for a stricter alignment than the allocator
+  // guarantees.
+  void *P2 = A.Allocate(40, 256);
+  EXPECT_NE(P1, P2);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(P2) & 255);
+  EXPECT_EQ(64u, A.getBytesInUse());
+  EXPECT_EQ(64u, A.getBytesFree());
+
+  // Once freed, it is recycled like any other block of its class.
+  A.Deallocate(P2, 40);
+  EXPECT_EQ(P2, A.Allocate(64, 16));
+  EXPECT_EQ(P1, A.Allocate(33, 1));
+}
+
+TEST(SizeClassAllocatorTest, TypedAllocate) {
+  SizeClassAllocator<> A;
+  struct Node {
+    Node *Left, *Right;
+    int Value;
+  };
+  Node *N = A.Allocate<Node>();
+  A.Deallocate(N);
+  Node *M = A.Allocate<Node>();
+  EXPECT_EQ(N, M);
+
+  int *Array = A.Allocate<int>(100);
+  A.Deallocate(Array, 100);
+  EXPECT_EQ(Array, A.Allocate<int>(70));
+
+  A.Reset();
+  EXPECT_EQ(0u, A.getBytesInUse());
+  EXPECT_EQ(0u, A.getBytesFree());
+}
+
+} // end anonymous namespace
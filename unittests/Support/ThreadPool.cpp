@@ -164,3 +164,45 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, Priorities) {
+  CHECK_UNSUPPORTED();
+  // Test that pending tasks are started by decreasing priority, and in
+  // submission order within a priority.
+  std::vector<int> Order;
+  std::mutex OrderLock;
+  auto Record = [&](int I) {
+    std::unique_lock<std::mutex> LockGuard(OrderLock);
+    Order.push_back(I);
+  };
+
+  ThreadPool Pool(1);
+  // Keep the only thread busy until everything is queued.
+  Pool.async([this] { waitForMainThread(); });
+  Pool.asyncWithPriority(ThreadPool::Priority::Low, [&] { Record(0); });
+  Pool.async([&] { Record(1); });
+  Pool.asyncWithPriority(ThreadPool::Priority::High, [&] { Record(2); });
+  Pool.async([&] { Record(3); });
+  Pool.asyncWithPriority(ThreadPool::Priority::High, [&] { Record(4); });
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(std::vector<int>({2, 4, 1, 3, 0}), Order);
+}
+
+TEST_F(ThreadPoolTest, NestedWait) {
+  CHECK_UNSUPPORTED();
+  // Test that a task waiting on the pool runs the pending tasks instead of
+  // blocking the only thread of the pool.
+  std::atomic_int checked_in{0};
+
+  ThreadPool Pool(1);
+  Pool.async([&] {
+    for (size_t i = 0; i < 5; ++i)
+      Pool.async([&checked_in] { ++checked_in; });
+    Pool.wait();
+    ASSERT_EQ(5, checked_in);
+    ++checked_in;
+  });
+  Pool.wait();
+  ASSERT_EQ(6, checked_in);
+}
@@ -0,0 +1,70 @@
+//===- unittests/TimeTraceTest.cpp - Trace event recording tests ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeTrace.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+/// Record trace events for the lifetime of the object only, so that the rest
+/// of the process is not traced.
+struct TimeTraceEnabler {
+  TimeTraceEnabler() { enableTimeTrace(); }
+  ~TimeTraceEnabler() { disableTimeTrace(); }
+};
+
+TEST(TimeTrace, NestedEvents) {
+  // Nothing is recorded before tracing is enabled.
+  beginTimeTraceEvent("ignored");
+  endTimeTraceEvent();
+
+  TimeTraceEnabler Enabler;
+  EXPECT_TRUE(isTimeTraceEnabled());
+  {
+    TimeTraceScope Outer("outer", "with \"quotes\"");
+    TimeTraceScope Inner("inner");
+  }
+
+  std::string Trace;
+  raw_string_ostream OS(Trace);
+  writeTimeTrace(OS);
+  OS.flush();
+
+  EXPECT_EQ(0u, Trace.find("{\"traceEvents\":["));
+  EXPECT_EQ(std::string::npos, Trace.find("ignored"));
+  // The inner event completes first and is written first.
+  size_t InnerPos = Trace.find("\"name\":\"inner\"");
+  size_t OuterPos = Trace.find("\"name\":\"outer\"");
+  ASSERT_NE(std::string::npos, InnerPos);
+  ASSERT_NE(std::string::npos, OuterPos);
+  EXPECT_LT(InnerPos, OuterPos);
+  EXPECT_NE(std::string::npos,
+            Trace.find("\"args\":{\"detail\":\"with \\\"quotes\\\"\"}"));
+}
+
+TEST(TimeTrace, Disable) {
+  {
+    TimeTraceEnabler Enabler;
+    TimeTraceScope Event("discarded");
+  }
+  EXPECT_FALSE(isTimeTraceEnabled());
+
+  // Disabling drops the events recorded so far.
+  std::string Trace;
+  raw_string_ostream OS(Trace);
+  writeTimeTrace(OS);
+  OS.flush();
+  EXPECT_EQ(std::string::npos, Trace.find("discarded"));
+}
+
+} // end anonymous namespace
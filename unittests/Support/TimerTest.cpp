@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 #if LLVM_ON_WIN32
@@ -62,4 +63,35 @@ TEST(Timer, CheckIfTriggered) {
   EXPECT_FALSE(T1.hasTriggered());
 }
 
+TEST(Timer, PrintJSON) {
+  TimerGroup TG("Group \"G\"");
+  Timer T1("T1", TG);
+  Timer T2("T2", TG);
+  Timer T3("Unused", TG);
+
+  T1.startTimer();
+  SleepMS();
+  T1.stopTimer();
+  T2.startTimer();
+  T2.stopTimer();
+
+  std::string Buffer;
+  raw_string_ostream OS(Buffer);
+  TG.printJSON(OS);
+  OS.str();
+
+  EXPECT_EQ(0u, Buffer.find("{\"group\":\"Group \\\"G\\\"\",\"timers\":["
+                            "{\"name\":\"T1\",\"wall\":"));
+  EXPECT_NE(std::string::npos, Buffer.find("{\"name\":\"T2\",\"wall\":"));
+  EXPECT_EQ(std::string::npos, Buffer.find("Unused"));
+  EXPECT_NE(std::string::npos, Buffer.find("],\"total\":{\"wall\":"));
+  EXPECT_EQ("}}\n", Buffer.substr(Buffer.size() - 3));
+
+  // Printing zeroes the timers.
+  EXPECT_FALSE(T1.hasTriggered());
+  Buffer.clear();
+  TG.printJSON(OS);
+  EXPECT_EQ("", OS.str());
+}
+
 } // end anon namespace
@@ -0,0 +1,88 @@
+//===- TrigramIndexTest.cpp - Unit tests for TrigramIndex -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/TrigramIndex.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+class TrigramIndexTest : public ::testing::Test {
+protected:
+  std::unique_ptr<TrigramIndex>
+  makeTrigramIndex(const std::vector<std::string> &Rules) {
+    std::unique_ptr<TrigramIndex> TI = make_unique<TrigramIndex>();
+    for (auto &Rule : Rules)
+      TI->insert(Rule);
+    return TI;
+  }
+};
+
+TEST_F(TrigramIndexTest, Empty) {
+  std::unique_ptr<TrigramIndex> TI = makeTrigramIndex({});
+  EXPECT_FALSE(TI->isDefeated());
+  EXPECT_TRUE(TI->isDefinitelyOut("foo"));
+}
+
+TEST_F(TrigramIndexTest, Basic) {
+  std::unique_ptr<TrigramIndex> TI =
+      makeTrigramIndex({"*hello*", "*wor.d*"});
+  EXPECT_TRUE(TI->isDefeated());
+
+  TI = makeTrigramIndex({".*hello.*", ".*world.*"});
+  EXPECT_FALSE(TI->isDefeated());
+  EXPECT_FALSE(TI->isDefinitelyOut("hello"));
+  EXPECT_FALSE(TI->isDefinitelyOut("xxhelloxx"));
+  EXPECT_FALSE(TI->isDefinitelyOut("in the world"));
+  EXPECT_TRUE(TI->isDefinitelyOut("hell"));
+  EXPECT_TRUE(TI->isDefinitelyOut("word"));
+  EXPECT_TRUE(TI->isDefinitelyOut(""));
+}
+
+TEST_F(TrigramIndexTest, AllTrigramsNeeded) {
+  std::unique_ptr<TrigramIndex> TI = makeTrigramIndex({"foo.*bar"});
+  EXPECT_FALSE(TI->isDefeated());
+  EXPECT_FALSE(TI->isDefinitelyOut("foobar"));
+  EXPECT_FALSE(TI->isDefinitelyOut("foo::bar"));
+  EXPECT_TRUE(TI->isDefinitelyOut("foo"));
+  EXPECT_TRUE(TI->isDefinitelyOut("bar"));
+}
+
+TEST_F(TrigramIndexTest, Escapes) {
+  std::unique_ptr<TrigramIndex> TI = makeTrigramIndex({"a\\+b\\+c"});
+  EXPECT_FALSE(TI->isDefeated());
+  EXPECT_FALSE(TI->isDefinitelyOut("a+b+c"));
+  EXPECT_TRUE(TI->isDefinitelyOut("abc"));
+
+  TI = makeTrigramIndex({"(abc)\\1"});
+  EXPECT_TRUE(TI->isDefeated());
+}
+
+TEST_F(TrigramIndexTest, TooShort) {
+  std::unique_ptr<TrigramIndex> TI = makeTrigramIndex({"ab.*", ".*hello.*"});
+  EXPECT_TRUE(TI->isDefeated());
+  EXPECT_FALSE(TI->isDefinitelyOut("xyz"));
+}
+
+TEST_F(TrigramIndexTest, Defeated) {
+  std::unique_ptr<TrigramIndex> TI =
+      makeTrigramIndex({".*hello.*", "^foo$", ".*world.*"});
+  EXPECT_TRUE(TI->isDefeated());
+  EXPECT_FALSE(TI->isDefinitelyOut("xyz"));
+
+  TI = makeTrigramIndex({"fo[or]bar"});
+  EXPECT_TRUE(TI->isDefeated());
+}
+
+}  // namespace
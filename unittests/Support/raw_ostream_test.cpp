@@ -9,8 +9,12 @@
 
 #include "gtest/gtest.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <thread>
 
 using namespace llvm;
 
@@ -181,5 +185,50 @@ TEST(raw_ostreamTest, FormatDecimal) {
                           printToString(format_decimal(INT64_MIN, 21), 21));
 }
 
+TEST(raw_ostreamTest, AtomicWrite) {
+  SmallString<64> Path;
+  int FD;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("foo", "bar", FD, Path));
+  FileRemover Cleanup(Path);
+
+  // Each thread writes its records a piece at a time; none of them may be
+  // split up in the file.
+  const unsigned NumThreads = 4, NumRecords = 1000;
+  {
+    raw_fd_ostream OS(FD, true);
+    auto WriteRecords = [&OS](unsigned Thread) {
+      atomic_write_ostream Record(OS);
+      for (unsigned i = 0; i != NumRecords; ++i) {
+        Record << "begin " << Thread;
+        for (unsigned j = 0; j != 10; ++j)
+          Record << ' ' << j;
+        Record << " end\n";
+        Record.commit();
+      }
+    };
+#if LLVM_ENABLE_THREADS != 0
+    std::vector<std::thread> Threads;
+    for (unsigned i = 0; i != NumThreads; ++i)
+      Threads.emplace_back(WriteRecords, i);
+    for (std::thread &T : Threads)
+      T.join();
+#else
+    for (unsigned i = 0; i != NumThreads; ++i)
+      WriteRecords(i);
+#endif
+    EXPECT_EQ(NumThreads * NumRecords * 32, OS.tell());
+  }
+
+  auto Buffer = MemoryBuffer::getFile(Path);
+  ASSERT_TRUE(!!Buffer);
+  SmallVector<StringRef, 0> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  ASSERT_EQ(NumThreads * NumRecords, Lines.size());
+  for (StringRef Line : Lines) {
+    ASSERT_TRUE(Line.startswith("begin "));
+    EXPECT_EQ(Line.substr(7), " 0 1 2 3 4 5 6 7 8 9 end");
+  }
+}
+
 
 }
@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <cctype>
 #include <map>
+#include <memory>
 #include <string>
 #include <system_error>
 #include <vector>
@@ -107,6 +108,14 @@ class Pattern {
   /// RegEx - If non-empty, this is a regex pattern.
   std::string RegExStr;
 
+  /// CompiledRegEx - RegExStr compiled once, if it does not use variables.
+  /// Copies of the pattern share it.
+  std::shared_ptr<Regex> CompiledRegEx;
+
+  /// RegExPrefix - If non-empty, a fixed string that every match of the regex
+  /// starts with. Matching starts at its first occurrence.
+  StringRef RegExPrefix;
+
   /// VariableUses - Entries in this vector map to uses of a variable in the
   /// pattern, e.g. "foo[[bar]]baz".  In this case, the RegExStr will contain
   /// "foobaz" and we'll get an entry in this vector that tells us to insert the
@@ -344,6 +353,8 @@ bool Pattern::ParsePattern(StringRef PatternStr,
     // Find the end, which is the start of the next regex.
     size_t FixedMatchEnd = PatternStr.find("{{");
     FixedMatchEnd = std::min(FixedMatchEnd, PatternStr.find("[["));
+    if (RegExStr.empty() && VariableUses.empty())
+      RegExPrefix = PatternStr.substr(0, FixedMatchEnd);
     RegExStr += Regex::escape(PatternStr.substr(0, FixedMatchEnd));
     PatternStr = PatternStr.substr(FixedMatchEnd);
   }
@@ -354,6 +365,8 @@ bool Pattern::ParsePattern(StringRef PatternStr,
     RegExStr += '$';
   }
 
+  if (VariableUses.empty())
+    CompiledRegEx = std::make_shared<Regex>(RegExStr, Regex::Newline);
   return false;
 }
 
@@ -452,8 +465,23 @@ size_t Pattern::Match(StringRef Buffer, size_t &MatchLen,
   }
 
 
+  // Skip to the first place a match can start. The regex can't look behind
+  // its start, since it starts with a fixed string, so this doesn't change
+  // the result.
+  StringRef Searched = Buffer;
+  if (!RegExPrefix.empty()) {
+    size_t PrefixPos = Buffer.find(RegExPrefix);
+    if (PrefixPos == StringRef::npos)
+      return StringRef::npos;
+    Searched = Buffer.substr(PrefixPos);
+  }
+
   SmallVector<StringRef, 4> MatchInfo;
-  if (!Regex(RegExToMatch, Regex::Newline).match(Buffer, &MatchInfo))
+  bool Matched = CompiledRegEx
+                     ? CompiledRegEx->match(Searched, &MatchInfo)
+                     : Regex(RegExToMatch, Regex::Newline).match(Searched,
+                                                                 &MatchInfo);
+  if (!Matched)
     return StringRef::npos;
 
   // Successful regex match.
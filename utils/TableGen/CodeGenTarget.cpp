@@ -155,6 +155,9 @@ CodeGenTarget::CodeGenTarget(RecordKeeper &records)
 }
 
 CodeGenTarget::~CodeGenTarget() {
+  // Reversing the bits again restores them.
+  if (InstBitsReversed)
+    reverseBitsForLittleEndianEncoding();
 }
 
 const std::string &CodeGenTarget::getName() const {
@@ -342,6 +345,7 @@ bool CodeGenTarget::isLittleEndianEncoding() const {
 void CodeGenTarget::reverseBitsForLittleEndianEncoding() {
   if (!isLittleEndianEncoding())
     return;
+  InstBitsReversed = !InstBitsReversed;
 
   std::vector<Record*> Insts = Records.getAllDerivedDefinitions("Instruction");
   for (Record *R : Insts) {
@@ -363,7 +367,7 @@ void CodeGenTarget::reverseBitsForLittleEndianEncoding() {
       NewBits[bitSwapIdx] = OrigBit;
     }
     if (numBits % 2) {
-      unsigned middle = (numBits + 1) / 2;
+      unsigned middle = numBits / 2;
       NewBits[middle] = BI->getBit(middle);
     }
 
@@ -77,6 +77,10 @@ class CodeGenTarget {
   mutable std::unique_ptr<CodeGenSchedModels> SchedModels;
 
   mutable std::vector<const CodeGenInstruction*> InstrsByEnum;
+
+  /// Whether reverseBitsForLittleEndianEncoding changed the records, which
+  /// the destructor then undoes.
+  bool InstBitsReversed = false;
 public:
   CodeGenTarget(RecordKeeper &Records);
   ~CodeGenTarget();
@@ -177,7 +181,9 @@ public:
   bool isLittleEndianEncoding() const;
 
   /// reverseBitsForLittleEndianEncoding - For little-endian instruction bit
-  /// encodings, reverse the bit order of all instructions.
+  /// encodings, reverse the bit order of all instructions.  The records are
+  /// restored when this CodeGenTarget is destroyed, so that backends run
+  /// later on the same records see the original encodings.
   void reverseBitsForLittleEndianEncoding();
 
   /// guessInstructionProperties - should we just guess unset instruction
@@ -1150,6 +1150,24 @@ void SubtargetEmitter::EmitProcessorModels(raw_ostream &OS) {
       PrintFatalError(PM.ModelDef->getLoc(), "SchedMachineModel defines "
                     "ProcResources without defining WriteRes SchedWriteRes");
 
+    RecVec CacheLevels;
+    if (PM.ModelDef)
+      CacheLevels = PM.ModelDef->getValueAsListOfDefs("DataCacheLevels");
+    if (!CacheLevels.empty()) {
+      OS << "\n// {Size, Associativity, LineSize, Latency}\n";
+      OS << "static const llvm::MCCacheLevel " << PM.ModelName
+         << "CacheLevels[] = {\n";
+      for (unsigned i = 0, e = CacheLevels.size(); i < e; ++i) {
+        Record *CL = CacheLevels[i];
+        OS << "  {" << CL->getValueAsInt("Size") << ", "
+           << CL->getValueAsInt("Associativity") << ", "
+           << CL->getValueAsInt("LineSize") << ", "
+           << CL->getValueAsInt("Latency") << "}"
+           << (i + 1 < e ? ',' : ' ') << " // L" << (i + 1) << "\n";
+      }
+      OS << "};\n";
+    }
+
     // Begin processor itinerary properties
     OS << "\n";
     OS << "static const llvm::MCSchedModel " << PM.ModelName << " = {\n";
@@ -1183,9 +1201,14 @@ void SubtargetEmitter::EmitProcessorModels(raw_ostream &OS) {
       OS << "  nullptr, nullptr, 0, 0,"
          << " // No instruction-level machine model.\n";
     if (PM.hasItineraries())
-      OS << "  " << PM.ItinsDef->getName() << "};\n";
+      OS << "  " << PM.ItinsDef->getName() << ",\n";
+    else
+      OS << "  nullptr, // No Itinerary\n";
+    if (!CacheLevels.empty())
+      OS << "  " << PM.ModelName << "CacheLevels, " << CacheLevels.size()
+         << "};\n";
     else
-      OS << "  nullptr}; // No Itinerary\n";
+      OS << "  nullptr, 0}; // No cache model\n";
   }
 }
 
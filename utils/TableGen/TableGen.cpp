@@ -183,6 +183,16 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 }
 }
 
+/// Make the action named \p Name, as in the -gen-* options, current.
+static bool selectAction(StringRef Name) {
+  ActionType Val;
+  // Action has no name of its own, so its values are matched as option names.
+  if (Action.getParser().parse(Action, Name, Name, Val))
+    return true;
+  Action = Val;
+  return false;
+}
+
 int main(int argc, char **argv) {
   sys::PrintStackTraceOnErrorSignal(argv[0]);
   PrettyStackTraceProgram X(argc, argv);
@@ -190,7 +200,7 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  return TableGenMain(argv[0], &LLVMTableGenMain, &selectAction);
 }
 
 #ifdef __has_feature
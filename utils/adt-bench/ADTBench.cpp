@@ -0,0 +1,485 @@
+//===- ADTBench - Benchmark ADT containers and Support primitives ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program times the ADT containers and Support utilities that dominate
+// compile time, using access patterns typical of the compiler: pointer keys,
+// small sizes, growth from empty, and interleaved insertion and erasure.
+//
+// Each benchmark is a Timer in a single TimerGroup, so the report can be
+// printed as text or, with -timers-json, as JSON for regression tracking.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/ImmutableMap.h"
+#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+    Scale("scale", cl::desc("Multiply the amount of work of each benchmark"),
+          cl::init(100));
+
+static cl::opt<unsigned>
+    Repetitions("repetitions",
+                cl::desc("Number of times to run each benchmark"),
+                cl::init(1));
+
+static cl::opt<std::string>
+    Filter("filter", cl::desc("Only run the benchmarks whose name matches "
+                              "this regular expression"),
+           cl::value_desc("regex"));
+
+static cl::opt<bool> List("list", cl::desc("List the benchmarks and exit"));
+
+/// Results are accumulated here so that the work cannot be optimized away.
+static volatile uint64_t Sink;
+
+/// Containers whose contents are otherwise never read escape through here, so
+/// that their construction cannot be optimized away either.
+static const void *volatile EscapedObject;
+
+template <typename T> static void escape(const T &Object) {
+  EscapedObject = &Object;
+}
+
+/// A cheap deterministic sequence, so that runs are comparable.
+static unsigned nextRandom(unsigned &State) {
+  State = State * 1103515245 + 12345;
+  return State >> 8;
+}
+
+/// Distinct, stable pointers to use as keys.
+static std::vector<int> &getKeyStorage() {
+  static std::vector<int> Storage(1 << 16);
+  return Storage;
+}
+
+static int *getKey(unsigned I) {
+  std::vector<int> &Storage = getKeyStorage();
+  return &Storage[I % Storage.size()];
+}
+
+//===----------------------------------------------------------------------===//
+// SmallVector
+//===----------------------------------------------------------------------===//
+
+static void smallVectorSmallPushBack(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    SmallVector<unsigned, 8> V;
+    for (unsigned J = 0; J != 6; ++J)
+      V.push_back(J + I);
+    escape(V);
+    Sum += V.back();
+  }
+  Sink += Sum;
+}
+
+static void smallVectorGrowth(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10; ++I) {
+    SmallVector<void *, 4> V;
+    for (unsigned J = 0; J != 10000; ++J)
+      V.push_back(getKey(J));
+    escape(V);
+    Sum += V.size();
+  }
+  Sink += Sum;
+}
+
+static void smallVectorIterate(unsigned N) {
+  SmallVector<unsigned, 16> V;
+  for (unsigned J = 0; J != 10000; ++J)
+    V.push_back(J);
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 100; ++I) {
+    escape(V);
+    for (unsigned X : V)
+      Sum += X;
+  }
+  Sink += Sum;
+}
+
+static void smallVectorEraseFront(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 100; ++I) {
+    SmallVector<unsigned, 32> V(256, I);
+    escape(V);
+    while (!V.empty()) {
+      Sum += V.front();
+      V.erase(V.begin());
+    }
+  }
+  Sink += Sum;
+}
+
+//===----------------------------------------------------------------------===//
+// DenseMap
+//===----------------------------------------------------------------------===//
+
+static void denseMapInsertPointers(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N; ++I) {
+    DenseMap<void *, unsigned> M;
+    for (unsigned J = 0; J != 10000; ++J)
+      M[getKey(J)] = J;
+    Sum += M.size();
+  }
+  Sink += Sum;
+}
+
+static void denseMapInsertSmall(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    DenseMap<void *, unsigned> M;
+    for (unsigned J = 0; J != 8; ++J)
+      M[getKey(I + J)] = J;
+    escape(M);
+    Sum += M.size();
+  }
+  Sink += Sum;
+}
+
+static void denseMapLookup(unsigned N) {
+  DenseMap<void *, unsigned> M;
+  for (unsigned J = 0; J != 10000; ++J)
+    M[getKey(J * 2)] = J;
+  unsigned State = 0;
+  uint64_t Sum = 0;
+  // Half of the lookups miss.
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    auto It = M.find(getKey(nextRandom(State) % 20000));
+    if (It != M.end())
+      Sum += It->second;
+  }
+  Sink += Sum;
+}
+
+static void denseMapEraseHeavy(unsigned N) {
+  DenseMap<void *, unsigned> M;
+  unsigned State = 0;
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    M[getKey(nextRandom(State) % 1024)] = I;
+    M.erase(getKey(nextRandom(State) % 1024));
+    Sum += M.size();
+  }
+  Sink += Sum;
+}
+
+static void denseMapIterate(unsigned N) {
+  DenseMap<unsigned, unsigned> M;
+  for (unsigned J = 0; J != 10000; ++J)
+    M[J] = J;
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10; ++I)
+    for (auto &KV : M)
+      Sum += KV.second;
+  Sink += Sum;
+}
+
+//===----------------------------------------------------------------------===//
+// StringMap
+//===----------------------------------------------------------------------===//
+
+static std::vector<std::string> makeNames(unsigned Count) {
+  std::vector<std::string> Names;
+  for (unsigned I = 0; I != Count; ++I)
+    Names.push_back(("_ZN4llvm" + Twine(I) + "functionEv").str());
+  return Names;
+}
+
+static void stringMapInsert(unsigned N) {
+  std::vector<std::string> Names = makeNames(10000);
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N; ++I) {
+    StringMap<unsigned> M;
+    for (const std::string &Name : Names)
+      M[Name] = I;
+    Sum += M.size();
+  }
+  Sink += Sum;
+}
+
+static void stringMapLookup(unsigned N) {
+  std::vector<std::string> Names = makeNames(10000);
+  StringMap<unsigned> M;
+  for (unsigned J = 0; J != Names.size(); J += 2)
+    M[Names[J]] = J;
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N; ++I)
+    for (const std::string &Name : Names) {
+      auto It = M.find(Name);
+      if (It != M.end())
+        Sum += It->second;
+    }
+  Sink += Sum;
+}
+
+//===----------------------------------------------------------------------===//
+// SmallPtrSet
+//===----------------------------------------------------------------------===//
+
+static void smallPtrSetSmall(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    SmallPtrSet<void *, 8> S;
+    for (unsigned J = 0; J != 8; ++J)
+      S.insert(getKey(I + J % 5));
+    escape(S);
+    Sum += S.size() + S.count(getKey(I));
+  }
+  Sink += Sum;
+}
+
+static void smallPtrSetLarge(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N; ++I) {
+    SmallPtrSet<void *, 16> S;
+    for (unsigned J = 0; J != 10000; ++J)
+      S.insert(getKey(J));
+    for (unsigned J = 0; J != 20000; ++J)
+      Sum += S.count(getKey(J * 3));
+  }
+  Sink += Sum;
+}
+
+static void smallPtrSetEraseHeavy(unsigned N) {
+  SmallPtrSet<void *, 16> S;
+  unsigned State = 0;
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    S.insert(getKey(nextRandom(State) % 64));
+    S.erase(getKey(nextRandom(State) % 64));
+    Sum += S.size();
+  }
+  Sink += Sum;
+}
+
+//===----------------------------------------------------------------------===//
+// FoldingSet
+//===----------------------------------------------------------------------===//
+
+namespace {
+struct PairNode : FoldingSetNode {
+  unsigned A, B;
+  PairNode(unsigned A, unsigned B) : A(A), B(B) {}
+  void Profile(FoldingSetNodeID &ID) const {
+    ID.AddInteger(A);
+    ID.AddInteger(B);
+  }
+};
+} // end anonymous namespace
+
+static void foldingSetUniquing(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N; ++I) {
+    BumpPtrAllocator Alloc;
+    FoldingSet<PairNode> S;
+    unsigned State = 0;
+    // Roughly half of the requests find an existing node.
+    for (unsigned J = 0; J != 20000; ++J) {
+      unsigned A = nextRandom(State) % 100, B = nextRandom(State) % 100;
+      FoldingSetNodeID ID;
+      ID.AddInteger(A);
+      ID.AddInteger(B);
+      void *InsertPos;
+      if (PairNode *Node = S.FindNodeOrInsertPos(ID, InsertPos)) {
+        Sum += Node->A;
+        continue;
+      }
+      S.InsertNode(new (Alloc.Allocate<PairNode>()) PairNode(A, B), InsertPos);
+    }
+    Sum += S.size();
+  }
+  Sink += Sum;
+}
+
+//===----------------------------------------------------------------------===//
+// ImmutableMap
+//===----------------------------------------------------------------------===//
+
+static void immutableMapAdd(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N; ++I) {
+    ImmutableMap<unsigned, unsigned>::Factory F;
+    ImmutableMap<unsigned, unsigned> M = F.getEmptyMap();
+    unsigned State = 0;
+    for (unsigned J = 0; J != 2000; ++J)
+      M = F.add(M, nextRandom(State) % 4096, J);
+    Sum += M.getHeight();
+  }
+  Sink += Sum;
+}
+
+static void immutableMapLookup(unsigned N) {
+  ImmutableMap<unsigned, unsigned>::Factory F;
+  ImmutableMap<unsigned, unsigned> M = F.getEmptyMap();
+  for (unsigned J = 0; J != 4096; J += 2)
+    M = F.add(M, J, J);
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10; ++I)
+    for (unsigned J = 0; J != 4096; ++J)
+      if (const unsigned *V = M.lookup(J))
+        Sum += *V;
+  Sink += Sum;
+}
+
+// Canonicalizing factories look up every new root in their cache. Add the
+// same elements to a common base in two orders so that most lookups hit an
+// equal tree that shares most of its nodes with the new one.
+static void immutableSetCanonicalize(unsigned N) {
+  ImmutableSet<unsigned>::Factory F;
+  ImmutableSet<unsigned> Base = F.getEmptySet();
+  for (unsigned J = 0; J != 1024; ++J)
+    Base = F.add(Base, J * 2);
+  uint64_t Sum = 0;
+  unsigned State = 0;
+  for (unsigned I = 0; I != N * 200; ++I) {
+    unsigned A = (nextRandom(State) % 1024) * 2 + 1;
+    unsigned B = (nextRandom(State) % 1024) * 2 + 1;
+    ImmutableSet<unsigned> S1 = F.add(F.add(Base, A), B);
+    ImmutableSet<unsigned> S2 = F.add(F.add(Base, B), A);
+    Sum += S1 == S2;
+  }
+  Sink += Sum;
+}
+
+//===----------------------------------------------------------------------===//
+// Support
+//===----------------------------------------------------------------------===//
+
+static void rawOstreamWrite(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10; ++I) {
+    SmallString<256> Buffer;
+    raw_svector_ostream OS(Buffer);
+    for (unsigned J = 0; J != 1000; ++J)
+      OS << "  %" << J << " = add i32 %" << (J * 7) << ", " << I << '\n';
+    Sum += Buffer.size();
+  }
+  Sink += Sum;
+}
+
+static void rawOstreamFormat(unsigned N) {
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10; ++I) {
+    std::string Buffer;
+    raw_string_ostream OS(Buffer);
+    const char *Name = "name";
+    for (unsigned J = 0; J != 1000; ++J)
+      OS << format("%-20s %8.3f %5u\n", Name, J * 0.5, I);
+    Sum += OS.str().size();
+  }
+  Sink += Sum;
+}
+
+static void apIntArithmetic(unsigned N, unsigned BitWidth) {
+  APInt A(BitWidth, 0x12345678), B(BitWidth, 0x9abcdef), C(BitWidth, 1);
+  uint64_t Sum = 0;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    C = C * A + B;
+    C ^= C.lshr(3);
+    Sum += C.getLoBits(32).getZExtValue();
+  }
+  Sink += Sum;
+}
+
+static void apInt64(unsigned N) { apIntArithmetic(N, 64); }
+static void apInt128(unsigned N) { apIntArithmetic(N, 128); }
+
+static void twineConcat(unsigned N) {
+  uint64_t Sum = 0;
+  SmallString<64> Storage;
+  for (unsigned I = 0; I != N * 10000; ++I) {
+    Storage.clear();
+    StringRef Name = (Twine("prefix.") + "block" + Twine(I) + ".suffix")
+                         .toStringRef(Storage);
+    Sum += Name.size();
+  }
+  Sink += Sum;
+}
+
+namespace {
+struct Benchmark {
+  const char *Name;
+  void (*Run)(unsigned Scale);
+};
+} // end anonymous namespace
+
+static const Benchmark Benchmarks[] = {
+    {"SmallVector/small-push-back", smallVectorSmallPushBack},
+    {"SmallVector/growth", smallVectorGrowth},
+    {"SmallVector/iterate", smallVectorIterate},
+    {"SmallVector/erase-front", smallVectorEraseFront},
+    {"DenseMap/insert-pointers", denseMapInsertPointers},
+    {"DenseMap/insert-small", denseMapInsertSmall},
+    {"DenseMap/lookup", denseMapLookup},
+    {"DenseMap/erase-heavy", denseMapEraseHeavy},
+    {"DenseMap/iterate", denseMapIterate},
+    {"StringMap/insert", stringMapInsert},
+    {"StringMap/lookup", stringMapLookup},
+    {"SmallPtrSet/small", smallPtrSetSmall},
+    {"SmallPtrSet/large", smallPtrSetLarge},
+    {"SmallPtrSet/erase-heavy", smallPtrSetEraseHeavy},
+    {"FoldingSet/uniquing", foldingSetUniquing},
+    {"ImmutableMap/add", immutableMapAdd},
+    {"ImmutableMap/lookup", immutableMapLookup},
+    {"ImmutableSet/canonicalize", immutableSetCanonicalize},
+    {"raw_ostream/write", rawOstreamWrite},
+    {"raw_ostream/format", rawOstreamFormat},
+    {"APInt/64", apInt64},
+    {"APInt/128", apInt128},
+    {"Twine/concat", twineConcat},
+};
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "ADT and Support benchmarks\n");
+
+  Regex FilterRE(Filter);
+  std::string Error;
+  if (!Filter.empty() && !FilterRE.isValid(Error)) {
+    errs() << argv[0] << ": invalid -filter: " << Error << "\n";
+    return 1;
+  }
+
+  TimerGroup Group("ADT benchmark");
+  std::vector<std::unique_ptr<Timer>> Timers;
+  for (const Benchmark &B : Benchmarks) {
+    if (!Filter.empty() && !FilterRE.match(B.Name))
+      continue;
+    if (List) {
+      outs() << B.Name << "\n";
+      continue;
+    }
+    Timers.emplace_back(new Timer(B.Name, Group));
+    for (unsigned I = 0; I != Repetitions; ++I) {
+      TimeRegion Region(*Timers.back());
+      B.Run(Scale);
+    }
+  }
+
+  Group.print(outs());
+  return 0;
+}
@@ -0,0 +1,209 @@
+#!/usr/bin/env python2.7
+
+"""Measure the compile time and memory of the standard opt and llc pipelines.
+
+Each input (.ll or .bc) is run through:
+
+  opt   -O0/-O1/...          the PassManagerBuilder pipelines
+  opt   -passes=default<On>  the PassBuilder pipelines
+  llc   -On                  on the output of the matching opt -On run
+
+Every configuration is run --repeat times and the fastest run is kept. For each
+one the script records wall, user and system time, the peak resident set size
+of the tool, and, for the legacy pass manager and llc, the time spent in each
+pass (from -time-passes -timers-json). The new pass manager has no per-pass
+timers yet, so only its totals are recorded.
+
+The results are written as JSON. Given --baseline, the script compares against
+an earlier result file and exits with status 1 if any configuration exceeds
+its baseline by more than --budget percent, which makes it usable as a gate
+when updating a toolchain:
+
+  compile_time_bench.py --bindir=build/bin -o base.json inputs/*.bc
+  ... update ...
+  compile_time_bench.py --bindir=build/bin -o new.json --baseline=base.json \\
+      --budget=5 inputs/*.bc
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+FORMAT_VERSION = 1
+
+# Metrics compared against the baseline. Times below MIN_TIME seconds are too
+# noisy to gate on.
+GATED_METRICS = ['user', 'max_rss_kb']
+MIN_TIME = 0.05
+
+# llc only has -O0 to -O3.
+LLC_LEVELS = {'Os': 'O2', 'Oz': 'O2'}
+
+
+def run(cmd, info_file=None):
+  """Run cmd and return (user, sys, wall, max_rss_kb, timer_groups)."""
+  if info_file is not None:
+    # The timer reports are appended to this file.
+    open(info_file, 'w').close()
+  with open(os.devnull, 'w') as devnull:
+    start = time.time()
+    proc = subprocess.Popen(cmd, stdout=devnull)
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.time() - start
+  if status != 0:
+    sys.stderr.write('error: command failed: %s\n' % ' '.join(cmd))
+    sys.exit(2)
+  groups = []
+  if info_file is not None:
+    with open(info_file) as f:
+      for line in f:
+        if line.startswith('{'):
+          groups.append(json.loads(line))
+  # ru_maxrss is in kilobytes on Linux and in bytes on Darwin.
+  max_rss_kb = usage.ru_maxrss
+  if sys.platform == 'darwin':
+    max_rss_kb //= 1024
+  return usage.ru_utime, usage.ru_stime, wall, max_rss_kb, groups
+
+
+def pass_times(groups):
+  """Sum the user time of each pass over all timer groups and instances."""
+  passes = {}
+  for group in groups:
+    for timer in group['timers']:
+      key = '%s: %s' % (group['group'], timer['name'])
+      passes[key] = passes.get(key, 0.0) + timer['user']
+  return passes
+
+
+def measure(cmd, repeat, tmpdir, timers):
+  info_file = os.path.join(tmpdir, 'timers.json') if timers else None
+  if timers:
+    cmd = cmd + ['-time-passes', '-timers-json',
+                 '-info-output-file=' + info_file]
+  best = None
+  min_rss = None
+  for _ in range(repeat):
+    user, sys_time, wall, rss, groups = run(cmd, info_file)
+    if best is None or user < best['user']:
+      best = {'user': user, 'sys': sys_time, 'wall': wall}
+      if timers:
+        best['passes'] = pass_times(groups)
+    min_rss = rss if min_rss is None else min(rss, min_rss)
+  best['max_rss_kb'] = min_rss
+  return best
+
+
+def bench_input(args, path, tmpdir):
+  results = []
+  name = os.path.basename(path)
+  for level in args.levels.split(','):
+    optimized = os.path.join(tmpdir, 'opt-%s.bc' % level)
+    legacy_cmd = [args.opt, path, '-o', optimized]
+    if level != 'O0':
+      legacy_cmd.append('-' + level)
+    configs = [
+        ('opt', 'legacy-' + level, legacy_cmd, True),
+        ('opt', 'new-' + level,
+         [args.opt, path, '-o', os.devnull, '-passes=default<%s>' % level],
+         False),
+        ('llc', level,
+         [args.llc, optimized, '-o', os.devnull, '-filetype=obj',
+          '-' + LLC_LEVELS.get(level, level)] + args.llc_args,
+         True),
+    ]
+    for tool, pipeline, cmd, timers in configs:
+      result = measure(cmd, args.repeat, tmpdir, timers)
+      result.update({'input': name, 'tool': tool, 'pipeline': pipeline})
+      results.append(result)
+      if args.verbose:
+        sys.stderr.write('%-30s %-4s %-10s %8.3fs %8d KB\n' %
+                         (name, tool, pipeline, result['user'],
+                          result['max_rss_kb']))
+  return results
+
+
+def key(result):
+  return (result['input'], result['tool'], result['pipeline'])
+
+
+def compare(baseline, results, budget):
+  """Print the configurations that are over budget and return their number."""
+  base = dict((key(r), r) for r in baseline['results'])
+  failures = 0
+  for result in results:
+    old = base.get(key(result))
+    if old is None:
+      continue
+    for metric in GATED_METRICS:
+      if metric != 'max_rss_kb' and old[metric] < MIN_TIME:
+        continue
+      limit = old[metric] * (1.0 + budget / 100.0)
+      if result[metric] > limit:
+        failures += 1
+        print('%s %s %s: %s %.3f -> %.3f (%+.1f%%, budget %.1f%%)' %
+              (result['input'], result['tool'], result['pipeline'], metric,
+               old[metric], result[metric],
+               100.0 * (result[metric] / old[metric] - 1.0), budget))
+  return failures
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+  parser.add_argument('inputs', nargs='+', help='.ll or .bc files')
+  parser.add_argument('--bindir', default='',
+                      help='directory containing opt and llc')
+  parser.add_argument('--opt', help='opt binary (default: BINDIR/opt)')
+  parser.add_argument('--llc', help='llc binary (default: BINDIR/llc)')
+  parser.add_argument('--llc-args', default='',
+                      help='extra llc arguments, e.g. -mtriple=...')
+  parser.add_argument('--levels', default='O0,O2,O3',
+                      help='comma separated optimization levels')
+  parser.add_argument('--repeat', type=int, default=3,
+                      help='runs per configuration; the fastest is kept')
+  parser.add_argument('-o', '--output', help='write the results to this file')
+  parser.add_argument('--baseline', help='results file to compare against')
+  parser.add_argument('--budget', type=float, default=5.0,
+                      help='allowed regression over the baseline, in percent')
+  parser.add_argument('-v', '--verbose', action='store_true')
+  args = parser.parse_args()
+
+  args.opt = args.opt or os.path.join(args.bindir, 'opt')
+  args.llc = args.llc or os.path.join(args.bindir, 'llc')
+  args.llc_args = args.llc_args.split()
+
+  results = []
+  tmpdir = tempfile.mkdtemp(prefix='compile-time-bench-')
+  try:
+    for path in args.inputs:
+      results.extend(bench_input(args, path, tmpdir))
+  finally:
+    shutil.rmtree(tmpdir)
+
+  output = {'version': FORMAT_VERSION, 'results': results}
+  if args.output:
+    with open(args.output, 'w') as f:
+      json.dump(output, f, indent=2, sort_keys=True)
+  else:
+    json.dump(output, sys.stdout, indent=2, sort_keys=True)
+    sys.stdout.write('\n')
+
+  if args.baseline:
+    with open(args.baseline) as f:
+      baseline = json.load(f)
+    if baseline.get('version') != FORMAT_VERSION:
+      sys.stderr.write('error: baseline has an unsupported format version\n')
+      return 2
+    if compare(baseline, results, args.budget):
+      return 1
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -7,8 +7,7 @@ class SmallStringPrinter:
 
   def to_string(self):
     begin = self.val['BeginX']
-    end = self.val['EndX']
-    return begin.cast(gdb.lookup_type("char").pointer()).string(length = end - begin)
+    return begin.cast(gdb.lookup_type("char").pointer()).string(length = self.val['Size'])
 
   def display_hint (self):
     return 'string'
@@ -54,15 +53,13 @@ class SmallVectorPrinter:
   def children(self):
     t = self.val.type.template_argument(0).pointer()
     begin = self.val['BeginX'].cast(t)
-    end = self.val['EndX'].cast(t)
+    end = begin + self.val['Size']
     return self._iterator(begin, end)
 
   def to_string(self):
-    t = self.val.type.template_argument(0).pointer()
-    begin = self.val['BeginX'].cast(t)
-    end = self.val['EndX'].cast(t)
-    capacity = self.val['CapacityX'].cast(t)
-    return 'llvm::SmallVector of length %d, capacity %d' % (end - begin, capacity - begin)
+    size = self.val['Size']
+    capacity = self.val['Capacity']
+    return 'llvm::SmallVector of length %d, capacity %d' % (size, capacity)
 
   def display_hint (self):
     return 'array'
@@ -4,18 +4,28 @@ from __future__ import print_function
 
 desc = '''Generate HTML output to visualize optimization records from the YAML files
 generated with -fsave-optimization-record and -fdiagnostics-show-hotness.
+Binary remark files (-pass-remarks-format=binary) are accepted as well.
 
 The tools requires PyYAML to be installed.'''
 
 import yaml
 import argparse
+import multiprocessing
 import os.path
 import subprocess
 import shutil
+try:
+    # The libyaml-based loader is much faster when PyYAML was built with it.
+    from yaml import CLoader as Loader
+except ImportError:
+    from yaml import Loader
 
 parser = argparse.ArgumentParser(description=desc)
 parser.add_argument('yaml_files', nargs='+')
 parser.add_argument('output_dir')
+parser.add_argument('-j', dest='jobs', type=int, default=None,
+                    help='number of input files to read in parallel '
+                         '(default: number of cores)')
 args = parser.parse_args()
 
 p = subprocess.Popen(['c++filt', '-n'], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
@@ -24,6 +34,7 @@ def demangle(name):
     return p.stdout.readline().rstrip()
 
 class Remark(yaml.YAMLObject):
+    yaml_loader = Loader
     max_hotness = 0
 
     @property
@@ -58,8 +69,10 @@ class Remark(yaml.YAMLObject):
     @property
     def message(self):
         # Args is a list of mappings (dictionaries) with each dictionary with
-        # exactly one key-value pair.
-        values = [self.getArgString(mapping.items()[0]) for mapping in self.Args]
+        # one key-value pair, plus the DebugLoc of the value if it has one.
+        values = [self.getArgString([(k, v) for (k, v) in mapping.items()
+                                     if k != 'DebugLoc'][0])
+                  for mapping in self.Args]
         return "".join(values)
 
     @property
@@ -90,6 +103,76 @@ class Missed(Remark):
     @property
     def color(self): return "red"
 
+class Failure(Missed):
+    yaml_tag = '!Failure'
+
+# In the order of llvm::remarks::RemarkKind.
+binary_remark_kinds = [Passed, Missed, Analysis, AnalysisFPCommute,
+                       AnalysisAliasing, Failure]
+
+def read_uleb(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+# Decodes the format described in llvm/Support/BinaryRemarks.h into the same
+# objects the YAML loader creates.
+def load_binary_remarks(data):
+    data = bytearray(data)
+    pos = 0
+    while pos < len(data):
+        if data[pos:pos + 4] != b'RMRK':
+            raise ValueError("malformed binary remark file")
+        version, pos = read_uleb(data, pos + 4)
+        size, pos = read_uleb(data, pos)
+        end = pos + size
+        count, pos = read_uleb(data, pos)
+        strings = []
+        for i in range(count):
+            length, pos = read_uleb(data, pos)
+            strings.append(str(data[pos:pos + length].decode('utf-8')))
+            pos += length
+
+        def read_string(pos):
+            index, pos = read_uleb(data, pos)
+            return strings[index], pos
+
+        def read_debug_loc(pos):
+            loc = dict()
+            loc['File'], pos = read_string(pos)
+            loc['Line'], pos = read_uleb(data, pos)
+            loc['Column'], pos = read_uleb(data, pos)
+            return loc, pos
+
+        while pos < end:
+            cls = binary_remark_kinds[data[pos]]
+            remark = cls.__new__(cls)
+            remark.Pass, pos = read_string(pos + 1)
+            remark.Name, pos = read_string(pos)
+            remark.Function, pos = read_string(pos)
+            flags, pos = read_uleb(data, pos)
+            if flags & 1:
+                remark.DebugLoc, pos = read_debug_loc(pos)
+            if flags & 2:
+                remark.Hotness, pos = read_uleb(data, pos)
+            num_args, pos = read_uleb(data, pos)
+            remark.Args = []
+            for i in range(num_args):
+                key, pos = read_string(pos)
+                value, pos = read_string(pos)
+                arg = {key: value}
+                arg_flags, pos = read_uleb(data, pos)
+                if arg_flags & 1:
+                    arg['DebugLoc'], pos = read_debug_loc(pos)
+                remark.Args.append(arg)
+            yield remark
+
 class SourceFileRenderer:
     def __init__(self, filename):
         self.source_stream = open(filename)
@@ -177,17 +260,32 @@ class IndexRenderer:
 </html>''', file=self.stream)
 
 
+# Returns the remarks with hotness in one input file.
+def load_remarks(input_file):
+    f = open(input_file, 'rb')
+    if f.read(4) == b'RMRK':
+        f.seek(0)
+        docs = load_binary_remarks(f.read())
+    else:
+        f.seek(0)
+        docs = yaml.load_all(f, Loader=Loader)
+    return [remark for remark in docs if hasattr(remark, 'Hotness')]
+
 all_remarks = []
 file_remarks  = dict()
 
-for input_file in args.yaml_files:
-    f = open(input_file)
-    docs = yaml.load_all(f)
-    for remark in docs:
-        if hasattr(remark, 'Hotness'):
-            file_remarks.setdefault(remark.File, dict()).setdefault(remark.Line, []).append(remark);
-            all_remarks.append(remark)
-            Remark.max_hotness = max(Remark.max_hotness, remark.Hotness)
+if len(args.yaml_files) > 1:
+    pool = multiprocessing.Pool(args.jobs)
+    remarks_per_file = pool.map(load_remarks, args.yaml_files)
+    pool.close()
+else:
+    remarks_per_file = [load_remarks(args.yaml_files[0])]
+
+for remarks in remarks_per_file:
+    for remark in remarks:
+        file_remarks.setdefault(remark.File, dict()).setdefault(remark.Line, []).append(remark);
+        all_remarks.append(remark)
+        Remark.max_hotness = max(Remark.max_hotness, remark.Hotness)
 
 all_remarks = sorted(all_remarks, key=lambda r: r.Hotness, reverse=True)
 